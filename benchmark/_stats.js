@@ -0,0 +1,62 @@
+'use strict';
+// Statistics shared by ab.js and regression.js.
+
+// The 97.5% quantiles of Student's t distribution, for two-sided 95%
+// confidence intervals.
+const tTable = [
+  12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+  2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+  2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042
+];
+
+function tQuantile(df) {
+  if (df <= tTable.length)
+    return tTable[Math.max(Math.round(df), 1) - 1];
+  // First order Cornish-Fisher expansion around the normal quantile.
+  return 1.96 + 2.37 / df;
+}
+
+function mean(list) {
+  return list.reduce((a, b) => a + b, 0) / list.length;
+}
+
+function stddev(list) {
+  const m = mean(list);
+  const sum = list.reduce((a, b) => a + (b - m) * (b - m), 0);
+  return Math.sqrt(sum / (list.length - 1));
+}
+
+function quantile(sorted, q) {
+  const pos = (sorted.length - 1) * q;
+  const lo = Math.floor(pos);
+  const hi = Math.ceil(pos);
+  return sorted[lo] + (sorted[hi] - sorted[lo]) * (pos - lo);
+}
+
+function summary(list) {
+  return {
+    samples: list,
+    mean: mean(list),
+    stddev: stddev(list),
+    cv: stddev(list) / mean(list)
+  };
+}
+
+// Returns the values of |list| within Tukey's fences.
+function withoutOutliers(list) {
+  const sorted = list.slice().sort((a, b) => a - b);
+  const q1 = quantile(sorted, 0.25);
+  const q3 = quantile(sorted, 0.75);
+  const lo = q1 - 1.5 * (q3 - q1);
+  const hi = q3 + 1.5 * (q3 - q1);
+  return list.filter((d) => d >= lo && d <= hi);
+}
+
+module.exports = {
+  tQuantile,
+  mean,
+  stddev,
+  quantile,
+  summary,
+  withoutOutliers
+};
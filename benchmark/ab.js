@@ -0,0 +1,294 @@
+'use strict';
+// Compares two node binaries on a set of benchmarks.  The runs of the two
+// binaries are interleaved in a random order per round so that changes of the
+// machine state affect both of them alike, and the result of each config is
+// the mean ratio of the paired runs with its 95% confidence interval.
+
+const child_process = require('child_process');
+const fs = require('fs');
+const path = require('path');
+const stats = require('./_stats.js');
+
+const usage = `usage: node benchmark/ab.js --old <node> --new <node> [options] \
+<category>...
+
+  --old <node>         the baseline binary
+  --new <node>         the binary that is compared with it
+  --runs <n>           measured runs per binary, default 10
+  --warmup <n>         runs per binary that are discarded first, default 1
+  --filter <string>    only run the benchmark files whose name contains it
+  --cpu <list>         pin the benchmarks to these CPUs with taskset(1)
+  --profile perf|v8    after measuring a file, run it once more per binary
+                       under \`perf record\` or with \`--prof\`
+  --profile-dir <dir>  where the profiles go, default ./benchmark-profiles
+  --json <file>        also write the results as JSON to <file>`;
+
+const opts = {
+  old: null,
+  new: null,
+  runs: 10,
+  warmup: 1,
+  filter: null,
+  cpu: null,
+  profile: null,
+  profileDir: 'benchmark-profiles',
+  json: null,
+  categories: []
+};
+
+function optionValue(args, i, name) {
+  if (i + 1 >= args.length)
+    fail(`${name} needs a value`);
+  return args[i + 1];
+}
+
+function fail(message) {
+  console.error(message);
+  console.error(usage);
+  process.exit(1);
+}
+
+const args = process.argv.slice(2);
+for (var i = 0; i < args.length; i++) {
+  const arg = args[i];
+  switch (arg) {
+    case '--old': opts.old = optionValue(args, i++, arg); break;
+    case '--new': opts.new = optionValue(args, i++, arg); break;
+    case '--runs': opts.runs = +optionValue(args, i++, arg); break;
+    case '--warmup': opts.warmup = +optionValue(args, i++, arg); break;
+    case '--filter': opts.filter = optionValue(args, i++, arg); break;
+    case '--cpu': opts.cpu = optionValue(args, i++, arg); break;
+    case '--profile': opts.profile = optionValue(args, i++, arg); break;
+    case '--profile-dir': opts.profileDir = optionValue(args, i++, arg); break;
+    case '--json': opts.json = optionValue(args, i++, arg); break;
+    case '-h': case '--help':
+      console.log(usage);
+      process.exit(0);
+      break;
+    default:
+      if (arg.startsWith('-'))
+        fail(`unknown option ${arg}`);
+      opts.categories.push(arg);
+  }
+}
+
+if (!opts.old || !opts.new || opts.categories.length === 0)
+  fail('--old, --new and at least one category are required');
+if (!Number.isInteger(opts.runs) || opts.runs < 2)
+  fail('--runs must be an integer of at least 2');
+if (!Number.isInteger(opts.warmup) || opts.warmup < 0)
+  fail('--warmup must be a non-negative integer');
+if (opts.profile !== null && opts.profile !== 'perf' && opts.profile !== 'v8')
+  fail('--profile must be perf or v8');
+
+const binaries = [
+  { label: 'old', node: path.resolve(opts.old) },
+  { label: 'new', node: path.resolve(opts.new) }
+];
+
+const files = [];
+opts.categories.forEach((category) => {
+  const dir = path.join(__dirname, category);
+  fs.readdirSync(dir).sort().forEach((name) => {
+    if (/^[._]/.test(name) || !name.endsWith('.js'))
+      return;
+    if (opts.filter !== null && name.indexOf(opts.filter) === -1)
+      return;
+    files.push({ name: `${category}/${name}`, file: path.join(dir, name) });
+  });
+});
+
+if (files.length === 0)
+  fail('no benchmark matches');
+
+// results[config][label] holds the rates of the measured runs, in the order
+// of the rounds so that the i-th entries of both binaries form a pair.
+const results = {};
+const order = [];
+
+// Wraps a command line in taskset and a profiler as requested.
+function commandLine(node, argv, profile) {
+  var cmd = [node].concat(argv);
+  if (profile === 'v8')
+    cmd.splice(1, 0, '--prof');
+  else if (profile)
+    cmd = ['perf', 'record', '-g', '-o', profile, '--',
+           cmd[0], '--perf-basic-prof'].concat(cmd.slice(1));
+  if (opts.cpu !== null)
+    cmd = ['taskset', '-c', opts.cpu].concat(cmd);
+  return cmd;
+}
+
+// Runs one benchmark file, which runs all of its configs in child processes
+// that inherit the flags and the CPU affinity, and collects their output.
+function runFile(binary, bench, profile, cwd, cb) {
+  const cmd = commandLine(binary.node, [bench.file], profile);
+  const child = child_process.spawn(cmd[0], cmd.slice(1), {
+    cwd: cwd || process.cwd(),
+    stdio: ['ignore', 'pipe', 'inherit']
+  });
+  var out = '';
+  child.stdout.setEncoding('utf8');
+  child.stdout.on('data', (chunk) => { out += chunk; });
+  child.on('error', (err) => {
+    console.error(`${cmd[0]}: ${err.message}`);
+    process.exit(1);
+  });
+  child.on('close', (code) => {
+    if (code !== 0) {
+      console.error(`${bench.name} failed on ${binary.node} (${code})`);
+      process.exit(1);
+    }
+    const rates = {};
+    out.split(/\r?\n/).forEach((line) => {
+      const match = /^(.+): ([0-9.eE+-]+)$/.exec(line.trim());
+      if (match)
+        rates[match[1]] = +match[2];
+    });
+    cb(rates);
+  });
+}
+
+function runRound(bench, round, cb) {
+  const pair = Math.random() < 0.5 ? binaries : binaries.slice().reverse();
+  const measured = round >= opts.warmup;
+  var next = 0;
+  (function runNext() {
+    if (next === pair.length)
+      return cb();
+    const binary = pair[next++];
+    runFile(binary, bench, null, null, (rates) => {
+      if (measured) {
+        Object.keys(rates).forEach((config) => {
+          if (!results[config]) {
+            results[config] = { old: [], new: [] };
+            order.push(config);
+          }
+          results[config][binary.label].push(rates[config]);
+        });
+      }
+      runNext();
+    });
+  })();
+}
+
+function mkdirp(dir) {
+  try {
+    fs.mkdirSync(dir);
+  } catch (err) {
+    if (err.code === 'ENOENT') {
+      mkdirp(path.dirname(dir));
+      fs.mkdirSync(dir);
+    } else if (err.code !== 'EEXIST') {
+      throw err;
+    }
+  }
+}
+
+// V8 writes its logs to the working directory of each process, perf writes
+// one file for the whole process tree.
+function runProfiles(bench, cb) {
+  if (opts.profile === null)
+    return cb();
+  var next = 0;
+  (function runNext() {
+    if (next === binaries.length)
+      return cb();
+    const binary = binaries[next++];
+    const base = bench.name.replace(/[\/\\]/g, '-').replace(/\.js$/, '');
+    const dir = path.resolve(opts.profileDir, binary.label, base);
+    mkdirp(dir);
+    const profile =
+        opts.profile === 'v8' ? 'v8' : path.join(dir, 'perf.data');
+    console.error(`profiling ${bench.name} on ${binary.label}`);
+    runFile(binary, bench, profile, dir, runNext);
+  })();
+}
+
+function runBenchmarks(index) {
+  if (index === files.length)
+    return report();
+  const bench = files[index];
+  const rounds = opts.warmup + opts.runs;
+  var round = 0;
+  (function runNext() {
+    if (round === rounds)
+      return runProfiles(bench, () => runBenchmarks(index + 1));
+    console.error(`${bench.name} round ${round + 1}/${rounds}`);
+    runRound(bench, round++, runNext);
+  })();
+}
+
+// Works on the logarithms of the ratios of the pairs, which makes a change
+// and its inverse symmetric.  Pairs outside of Tukey's fences are dropped.
+function analyze(config) {
+  const res = results[config];
+  const n = Math.min(res.old.length, res.new.length);
+  var logs = [];
+  for (var i = 0; i < n; i++) {
+    if (res.old[i] > 0 && res.new[i] > 0)
+      logs.push(Math.log(res.new[i] / res.old[i]));
+  }
+
+  const kept = stats.withoutOutliers(logs);
+
+  const result = {
+    benchmark: config,
+    old: stats.summary(res.old),
+    new: stats.summary(res.new),
+    pairs: kept.length,
+    outliers: logs.length - kept.length,
+    change: null,
+    confidenceInterval: null,
+    significant: false
+  };
+  if (kept.length < 2)
+    return result;
+
+  const m = stats.mean(kept);
+  const margin = stats.tQuantile(kept.length - 1) * stats.stddev(kept) /
+                 Math.sqrt(kept.length);
+  result.change = Math.exp(m) - 1;
+  result.confidenceInterval = [Math.exp(m - margin) - 1,
+                               Math.exp(m + margin) - 1];
+  result.significant = m - margin > 0 || m + margin < 0;
+  return result;
+}
+
+function percent(value) {
+  return (value >= 0 ? '+' : '') + (value * 100).toFixed(2) + '%';
+}
+
+function report() {
+  const analyzed = order.map(analyze);
+
+  analyzed.forEach((r) => {
+    const change = r.change === null ? 'n/a' :
+        `${percent(r.change)} [${percent(r.confidenceInterval[0])}, ` +
+        `${percent(r.confidenceInterval[1])}]${r.significant ? ' *' : ''}`;
+    console.log(`${r.benchmark}: ` +
+                `old ${r.old.mean.toPrecision(5)} ` +
+                `±${(r.old.cv * 100).toFixed(1)}% ` +
+                `new ${r.new.mean.toPrecision(5)} ` +
+                `±${(r.new.cv * 100).toFixed(1)}% ` +
+                `${change}` +
+                (r.outliers ? ` (${r.outliers} outliers)` : ''));
+  });
+  console.log('\nChanges marked with * have a 95% confidence interval that ' +
+              'excludes zero.');
+
+  if (opts.json !== null) {
+    const json = {
+      old: binaries[0].node,
+      new: binaries[1].node,
+      runs: opts.runs,
+      warmup: opts.warmup,
+      cpu: opts.cpu,
+      confidence: 0.95,
+      results: analyzed
+    };
+    fs.writeFileSync(opts.json, JSON.stringify(json, null, 2) + '\n');
+  }
+}
+
+runBenchmarks(0);
@@ -0,0 +1,23 @@
+// Measure the cost of creating Buffers in C++.
+'use strict';
+
+var common = require('../common.js');
+var binding = process.binding('bench');
+
+var bench = common.createBenchmark(main, {
+  type: ['alloc', 'copy', 'own'],
+  len: [16, 1024, 65536],
+  millions: [1]
+});
+
+var kinds = {
+  alloc: binding.kAlloc,
+  copy: binding.kCopy,
+  own: binding.kOwn
+};
+
+function main(conf) {
+  bench.start();
+  binding.createBuffers(conf.millions * 1e6, conf.len, kinds[conf.type]);
+  bench.end(conf.millions);
+}
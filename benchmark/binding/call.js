@@ -0,0 +1,45 @@
+// Measure the cost of calling into C++ through a binding.
+'use strict';
+
+var common = require('../common.js');
+var binding = process.binding('bench');
+
+var bench = common.createBenchmark(main, {
+  type: ['function', 'method', 'js'],
+  millions: [10]
+});
+
+function jsNoop() {}
+
+function main(conf) {
+  var n = conf.millions * 1e6;
+  var i;
+
+  switch (conf.type) {
+    case 'function':
+      // A function set with env->SetMethod().
+      var noop = binding.noop;
+      bench.start();
+      for (i = 0; i < n; i++)
+        noop();
+      bench.end(conf.millions);
+      break;
+    case 'method':
+      // A method set with env->SetProtoMethod() that unwraps its receiver.
+      var obj = new binding.BenchObject();
+      bench.start();
+      for (i = 0; i < n; i++)
+        obj.noop();
+      bench.end(conf.millions);
+      break;
+    case 'js':
+      // The same loop without leaving JS, for reference.
+      bench.start();
+      for (i = 0; i < n; i++)
+        jsNoop();
+      bench.end(conf.millions);
+      break;
+    default:
+      throw new Error('Unexpected type');
+  }
+}
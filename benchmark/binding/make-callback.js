@@ -0,0 +1,41 @@
+// Measure the cost of node::MakeCallback() from the event loop, with the
+// next tick queue it runs afterwards.
+'use strict';
+
+var common = require('../common.js');
+var binding = process.binding('bench');
+
+var bench = common.createBenchmark(main, {
+  hooks: ['none', 'async_wrap', 'domain'],
+  ticks: [0, 1, 8],
+  millions: [1]
+});
+
+function noop() {}
+
+function main(conf) {
+  var n = conf.millions * 1e6;
+  var ticks = conf.ticks;
+  var recv = {};
+
+  if (conf.hooks === 'async_wrap') {
+    // MakeCallback() calls the pre and post hooks for receivers that were
+    // seen by the init hook.
+    var async_wrap = process.binding('async_wrap');
+    async_wrap.setupHooks({ init: noop, pre: noop, post: noop });
+    async_wrap.enable();
+    recv._asyncQueue = {};
+  } else if (conf.hooks === 'domain') {
+    recv.domain = require('domain').create();
+  }
+
+  function callback() {
+    for (var i = 0; i < ticks; i++)
+      process.nextTick(noop);
+  }
+
+  bench.start();
+  binding.makeCallback(recv, callback, n, function() {
+    bench.end(conf.millions);
+  });
+}
@@ -0,0 +1,31 @@
+'use strict';
+const common = require('../common.js');
+
+const bench = common.createBenchmark(main, {
+  encoding: ['base64', 'hex'],
+  op: ['encode', 'decode'],
+  len: [64, 1024, 1024 * 1024],
+  n: [1024]
+});
+
+function main(conf) {
+  const encoding = conf.encoding;
+  const len = conf.len | 0;
+  const n = (conf.n | 0) * Math.max(1, (64 * 1024 / len) | 0);
+  const buf = Buffer.allocUnsafe(len);
+  for (var i = 0; i < len; i += 1)
+    buf[i] = (i * 7) & 255;
+  const str = buf.toString(encoding);
+
+  if (conf.op === 'encode') {
+    bench.start();
+    for (i = 0; i < n; i += 1)
+      buf.toString(encoding);
+    bench.end(n);
+  } else {
+    bench.start();
+    for (i = 0; i < n; i += 1)
+      buf.write(str, encoding);
+    bench.end(n);
+  }
+}
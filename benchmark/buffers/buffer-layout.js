@@ -0,0 +1,54 @@
+'use strict';
+const common = require('../common.js');
+const BufferLayout = require('buffer').BufferLayout;
+
+const bench = common.createBenchmark(main, {
+  method: ['readMethods', 'read', 'readMany'],
+  n: [1e6]
+});
+
+const layout = new BufferLayout([
+  { name: 'id', type: 'uint32le' },
+  { name: 'flags', type: 'uint16le' },
+  { name: 'kind', type: 'uint8' },
+  { name: 'priority', type: 'int8' },
+  { name: 'x', type: 'doublele' },
+  { name: 'y', type: 'doublele' }
+]);
+
+function main(conf) {
+  const n = conf.n | 0;
+  const count = 1000;
+  const buf = Buffer.alloc(layout.size * count, 1);
+  var i, j;
+
+  bench.start();
+  switch (conf.method) {
+    case 'readMethods':
+      for (i = 0; i < n; i += count) {
+        for (j = 0; j < count; j++) {
+          const offset = j * layout.size;
+          ({
+            id: buf.readUInt32LE(offset),
+            flags: buf.readUInt16LE(offset + 4),
+            kind: buf.readUInt8(offset + 6),
+            priority: buf.readInt8(offset + 7),
+            x: buf.readDoubleLE(offset + 8),
+            y: buf.readDoubleLE(offset + 16)
+          });
+        }
+      }
+      break;
+    case 'read':
+      for (i = 0; i < n; i += count) {
+        for (j = 0; j < count; j++)
+          layout.read(buf, j * layout.size);
+      }
+      break;
+    case 'readMany':
+      for (i = 0; i < n; i += count)
+        layout.readMany(buf);
+      break;
+  }
+  bench.end(n);
+}
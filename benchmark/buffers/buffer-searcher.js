@@ -0,0 +1,36 @@
+'use strict';
+const common = require('../common.js');
+const BufferSearcher = require('buffer').BufferSearcher;
+
+const bench = common.createBenchmark(main, {
+  method: ['indexOf', 'searcher'],
+  size: [256, 4096, 65536],
+  n: [1e5]
+});
+
+// A multipart boundary, looked for in many chunks of body data.
+const boundary = '\r\n------WebKitFormBoundary7MA4YWxkTrZu0gW';
+
+function main(conf) {
+  const n = conf.n | 0;
+  const chunks = [];
+  for (var i = 0; i < 16; i++) {
+    const chunk = Buffer.alloc(conf.size | 0, 'Content-Disposition: form-data');
+    chunk.write(boundary, chunk.length - boundary.length - i);
+    chunks.push(chunk);
+  }
+  const pattern = Buffer.from(boundary);
+  const searcher = new BufferSearcher(pattern);
+
+  if (conf.method === 'indexOf') {
+    bench.start();
+    for (i = 0; i < n; i++)
+      chunks[i & 15].indexOf(pattern);
+    bench.end(n);
+  } else {
+    bench.start();
+    for (i = 0; i < n; i++)
+      searcher.findFirst(chunks[i & 15]);
+    bench.end(n);
+  }
+}
@@ -0,0 +1,28 @@
+'use strict';
+
+const common = require('../common.js');
+
+const chunks = {
+  ascii: 'hello world, ',
+  latin1: 'héllo wörld, ',
+  cjk: '你好世界, '
+};
+
+const bench = common.createBenchmark(main, {
+  content: Object.keys(chunks),
+  len: [64, 1024, 65536],
+  n: [1e5]
+});
+
+function main(conf) {
+  const len = conf.len | 0;
+  const n = conf.n | 0;
+  const chunk = chunks[conf.content];
+  const buf = Buffer.from(chunk.repeat(Math.ceil(len / chunk.length)))
+                .slice(0, len);
+
+  bench.start();
+  for (var i = 0; i < n; i += 1)
+    buf.toString('utf8');
+  bench.end(n);
+}
@@ -242,6 +242,22 @@ Benchmark.prototype.report = function(value) {
   process.exit(0);
 };
 
+// Reports several values of one run, such as latency percentiles, on one line
+// each with a `metric` after the config.
+Benchmark.prototype.reportAll = function(values) {
+  var heading = this.getHeading();
+
+  Object.keys(values).forEach(function(metric) {
+    var value = values[metric].toFixed(5);
+    if (outputFormat == 'default')
+      console.log('%s metric=%s: %s', heading, metric, value);
+    else if (outputFormat == 'csv')
+      console.log('%s,%s,%s', heading, metric, value);
+  });
+
+  process.exit(0);
+};
+
 Benchmark.prototype.getHeading = function() {
   var conf = this.config;
 
@@ -0,0 +1,47 @@
+'use strict';
+var common = require('../common.js');
+var EventEmitter = require('events').EventEmitter;
+
+var bench = common.createBenchmark(main, {
+  n: [2e6],
+  listeners: [1, 2, 10],
+  args: [0, 1, 3, 5]
+});
+
+function main(conf) {
+  var n = conf.n | 0;
+  var listeners = conf.listeners | 0;
+  var args = conf.args | 0;
+
+  var ee = new EventEmitter();
+
+  for (var k = 0; k < listeners; k += 1)
+    ee.on('dummy', function() {});
+
+  var i;
+  switch (args) {
+    case 0:
+      bench.start();
+      for (i = 0; i < n; i += 1)
+        ee.emit('dummy');
+      bench.end(n);
+      break;
+    case 1:
+      bench.start();
+      for (i = 0; i < n; i += 1)
+        ee.emit('dummy', i);
+      bench.end(n);
+      break;
+    case 3:
+      bench.start();
+      for (i = 0; i < n; i += 1)
+        ee.emit('dummy', i, true, 'x');
+      bench.end(n);
+      break;
+    default:
+      bench.start();
+      for (i = 0; i < n; i += 1)
+        ee.emit('dummy', i, true, 'x', null, 5);
+      bench.end(n);
+  }
+}
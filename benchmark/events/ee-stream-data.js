@@ -0,0 +1,27 @@
+'use strict';
+var common = require('../common.js');
+var Readable = require('stream').Readable;
+
+// The 'data' events of a flowing stream.
+var bench = common.createBenchmark(main, {
+  n: [1e6],
+  listeners: [1, 2]
+});
+
+function main(conf) {
+  var n = conf.n | 0;
+  var listeners = conf.listeners | 0;
+  var chunk = Buffer.alloc(16);
+
+  var r = new Readable({ read: function() {} });
+  for (var k = 0; k < listeners; k += 1)
+    r.on('data', function() {});
+
+  // Wait for the stream to start flowing.
+  setImmediate(function() {
+    bench.start();
+    for (var i = 0; i < n; i += 1)
+      r.push(chunk);
+    bench.end(n);
+  });
+}
@@ -0,0 +1,229 @@
+'use strict';
+// An open loop load generator.  Requests are due at a fixed rate whatever the
+// latency of the server, and the latency of a request is measured from the
+// time it was due rather than from the time it was sent.  A client that waits
+// for each response before it sends the next request would leave out the time
+// that requests spend queued behind a slow one, which is where the high
+// percentiles come from ("coordinated omission").
+
+const net = require('net');
+const tls = require('tls');
+
+const CRLF = Buffer.from('\r\n');
+const HEADERS_END = Buffer.from('\r\n\r\n');
+
+// Microseconds, process.hrtime.now() is not available in older binaries.
+const now = process.hrtime.now || function now() {
+  const t = process.hrtime();
+  return t[0] * 1e6 + t[1] / 1e3;
+};
+
+// Builds the bytes of a request, which are sent as they are for each one.
+exports.request = function request(options) {
+  const lines = [
+    `${options.upload > 0 ? 'POST' : 'GET'} ${options.path} HTTP/1.1`,
+    'Host: 127.0.0.1'
+  ];
+  if (!options.keepAlive)
+    lines.push('Connection: close');
+  for (var i = 0; i < options.headers; i++)
+    lines.push(`X-Header-${i}: value-${i}`);
+  if (options.upload > 0)
+    lines.push(`Content-Length: ${options.upload}`);
+  const head = Buffer.from(lines.join('\r\n') + '\r\n\r\n', 'latin1');
+  return Buffer.concat([head, Buffer.alloc(options.upload, 'x')]);
+};
+
+// Finds the end of the responses in a stream of bytes.  It only handles what
+// the benchmark server sends: a Content-Length or a chunked body without
+// trailers.
+function ResponseParser(onResponse) {
+  this.onResponse = onResponse;
+  this.buffer = null;
+  this.remaining = -1;  // Bytes left of a fixed body, -1 between responses.
+  this.chunked = false;
+}
+
+ResponseParser.prototype.execute = function execute(data) {
+  var buf = this.buffer === null ? data : Buffer.concat([this.buffer, data]);
+  var pos = 0;
+  for (;;) {
+    if (this.remaining > 0) {
+      const n = Math.min(this.remaining, buf.length - pos);
+      this.remaining -= n;
+      pos += n;
+      if (this.remaining > 0)
+        break;
+      if (!this.chunked) {
+        this.remaining = -1;
+        this.onResponse();
+      }
+      continue;
+    }
+
+    if (this.chunked) {
+      // The CRLF after the previous chunk, if any, is part of the size line.
+      const end = buf.indexOf(CRLF, pos + (this.remaining === 0 ? 2 : 0));
+      if (end === -1)
+        break;
+      const size = parseInt(buf.toString('latin1', pos, end).trim(), 16);
+      if (size === 0) {
+        // The empty line that ends the (empty) trailers.
+        if (buf.length - end < 4)
+          break;
+        pos = end + 4;
+        this.chunked = false;
+        this.remaining = -1;
+        this.onResponse();
+      } else {
+        pos = end + 2;
+        this.remaining = size;
+      }
+      continue;
+    }
+
+    const end = buf.indexOf(HEADERS_END, pos);
+    if (end === -1)
+      break;
+    const head = buf.toString('latin1', pos, end);
+    pos = end + 4;
+    const length = /\r\ncontent-length: *(\d+)/i.exec(head);
+    if (/\r\ntransfer-encoding: *chunked/i.test(head)) {
+      this.chunked = true;
+      this.remaining = -1;
+    } else if (length !== null && +length[1] > 0) {
+      this.remaining = +length[1];
+    } else {
+      this.onResponse();
+    }
+  }
+  this.buffer = pos < buf.length ? buf.slice(pos) : null;
+};
+
+// Sends `rate` requests per second for `duration` seconds and calls back with
+// the latencies in milliseconds once all responses arrived.  With keepAlive,
+// `connections` connections are opened first and each has up to `pipeline`
+// requests in flight.  Without it, each request opens its own connection and
+// at most `connections` are open at a time.
+exports.run = function run(options, cb) {
+  const total = Math.round(options.rate * options.duration);
+  const interval = 1e6 / options.rate;
+  const pipeline = options.keepAlive ? options.pipeline : 1;
+  const latencies = new Float64Array(total);
+  const connections = [];
+  var start;
+  var sent = 0;
+  var completed = 0;
+  var open = 0;
+  var timer = null;
+  var done = false;
+
+  function finish(err) {
+    if (done)
+      return;
+    done = true;
+    clearTimeout(timer);
+    clearTimeout(deadline);
+    connections.forEach((conn) => conn.socket.destroy());
+    if (err)
+      return cb(err);
+    latencies.sort();
+    cb(null, latencies);
+  }
+
+  function connect() {
+    const connectOptions = { port: options.port, host: '127.0.0.1' };
+    var socket;
+    if (options.tls) {
+      connectOptions.rejectUnauthorized = false;
+      socket = tls.connect(connectOptions);
+    } else {
+      socket = net.connect(connectOptions);
+    }
+    socket.setNoDelay(true);
+    const conn = { socket: socket, inflight: [], parser: null };
+    conn.parser = new ResponseParser(() => onResponse(conn));
+    socket.on('data', (data) => conn.parser.execute(data));
+    socket.on('error', finish);
+    socket.on('close', () => {
+      connections.splice(connections.indexOf(conn), 1);
+      open--;
+      if (conn.inflight.length > 0)
+        return finish(new Error('connection closed with requests in flight'));
+      dispatch();
+    });
+    connections.push(conn);
+    open++;
+    return conn;
+  }
+
+  function onResponse(conn) {
+    latencies[completed++] = (now() - conn.inflight.shift()) / 1e3;
+    if (completed === total)
+      return finish(null);
+    if (!options.keepAlive)
+      conn.socket.destroy();
+    else
+      dispatch();
+  }
+
+  function send(conn) {
+    conn.inflight.push(start + sent * interval);
+    sent++;
+    conn.socket.write(options.request);
+  }
+
+  // Sends the requests that are due, as far as there are connections that can
+  // take them.  The others wait for a response or a closed connection, their
+  // latency is counted all the same.
+  function dispatch() {
+    if (done)
+      return;
+    const due = Math.min(total, Math.floor((now() - start) / interval) + 1);
+    if (options.keepAlive) {
+      for (var i = 0; sent < due && i < connections.length; i++) {
+        const conn = connections[i];
+        while (sent < due && conn.inflight.length < pipeline)
+          send(conn);
+      }
+    } else {
+      while (sent < due && open < options.connections)
+        send(connect());
+    }
+  }
+
+  function tick() {
+    dispatch();
+    if (sent < total) {
+      const next = start + sent * interval - now();
+      timer = setTimeout(tick, Math.max(0, Math.floor(next / 1e3)));
+    }
+  }
+
+  const deadline = setTimeout(() => {
+    finish(new Error(`${total - completed} requests did not complete`));
+  }, (options.duration + 60) * 1e3);
+
+  function begin() {
+    start = now();
+    tick();
+  }
+
+  if (!options.keepAlive)
+    return begin();
+
+  var connected = 0;
+  for (var i = 0; i < options.connections; i++) {
+    const conn = connect();
+    conn.socket.once(options.tls ? 'secureConnect' : 'connect', () => {
+      if (++connected === options.connections)
+        begin();
+    });
+  }
+};
+
+// `sorted` holds the latencies in ascending order.
+exports.percentile = function percentile(sorted, p) {
+  const rank = Math.ceil(p * sorted.length) - 1;
+  return sorted[Math.min(sorted.length - 1, Math.max(0, rank))];
+};
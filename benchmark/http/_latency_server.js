@@ -0,0 +1,48 @@
+'use strict';
+// The server of latency.js, which runs in its own process so that it doesn't
+// compete with the load generator for the event loop.
+// Usage: node _latency_server.js <port> <tcp|tls> <fixed|chunked> <length>
+
+const fs = require('fs');
+const http = require('http');
+const https = require('https');
+const path = require('path');
+
+const port = +process.argv[2];
+const transport = process.argv[3];
+const chunked = process.argv[4] === 'chunked';
+const length = +process.argv[5];
+
+// Chunked responses are written in four parts.
+const body = Buffer.alloc(length, 'x');
+const parts = [0, 1, 2, 3].map((i) => body.slice(i * length / 4,
+                                                 (i + 1) * length / 4));
+
+function onRequest(req, res) {
+  req.resume();
+  req.on('end', () => {
+    if (chunked) {
+      res.writeHead(200, { 'Content-Type': 'text/plain' });
+      parts.forEach((part) => res.write(part));
+      res.end();
+    } else {
+      res.writeHead(200, { 'Content-Type': 'text/plain',
+                           'Content-Length': length });
+      res.end(body);
+    }
+  });
+}
+
+var server;
+if (transport === 'tls') {
+  const certDir = path.resolve(__dirname, '../../test/fixtures');
+  server = https.createServer({
+    key: fs.readFileSync(path.join(certDir, 'test_key.pem')),
+    cert: fs.readFileSync(path.join(certDir, 'test_cert.pem'))
+  }, onRequest);
+} else {
+  server = http.createServer(onRequest);
+}
+
+server.listen(port, () => process.send('listening'));
+process.on('disconnect', () => process.exit(0));
@@ -11,6 +11,8 @@ const CRLF = '\r\n';
 
 const bench = common.createBenchmark(main, {
   fields: [4, 8, 16, 32],
+  path: [5, 1000],
+  cookie: [0, 4096],
   n: [1e5],
 });
 
@@ -18,7 +20,11 @@ const bench = common.createBenchmark(main, {
 function main(conf) {
   const fields = conf.fields >>> 0;
   const n = conf.n >>> 0;
-  var header = `GET /hello HTTP/1.1${CRLF}Content-Type: text/plain${CRLF}`;
+  const path = '/' + 'hello'.repeat(conf.path / 5);
+  var header = `GET ${path} HTTP/1.1${CRLF}Content-Type: text/plain${CRLF}`;
+
+  if (conf.cookie > 0)
+    header += `Cookie: ${'a=b; '.repeat(conf.cookie / 5)}${CRLF}`;
 
   for (var i = 0; i < fields; i++) {
     header += `X-Filler${i}: ${Math.random().toString(36).substr(2)}${CRLF}`;
@@ -0,0 +1,56 @@
+// Measure the latency percentiles of HTTP requests sent at a fixed rate.
+'use strict';
+
+var common = require('../common.js');
+var child_process = require('child_process');
+var path = require('path');
+var load = require('./_latency_load.js');
+
+// Requests in flight per connection with connection=pipeline.
+var PIPELINE = 16;
+
+var bench = common.createBenchmark(main, {
+  connection: ['keepalive', 'close', 'pipeline'],
+  transport: ['tcp', 'tls'],
+  body: ['fixed', 'chunked'],
+  headers: [4, 64],
+  upload: [0, 1048576],
+  rate: [500],
+  c: [50],
+  dur: [5]
+});
+
+function main(conf) {
+  var keepAlive = conf.connection !== 'close';
+  var server = child_process.fork(
+    path.join(__dirname, '_latency_server.js'),
+    [common.PORT, conf.transport, conf.body, 1024]
+  );
+
+  server.on('message', function() {
+    load.run({
+      port: common.PORT,
+      tls: conf.transport === 'tls',
+      rate: conf.rate,
+      duration: conf.dur,
+      connections: conf.c,
+      keepAlive: keepAlive,
+      pipeline: conf.connection === 'pipeline' ? PIPELINE : 1,
+      request: load.request({
+        path: '/',
+        keepAlive: keepAlive,
+        headers: conf.headers,
+        upload: conf.upload
+      })
+    }, function(err, latencies) {
+      server.kill();
+      if (err)
+        throw err;
+      bench.reportAll({
+        p50: load.percentile(latencies, 0.5),
+        p99: load.percentile(latencies, 0.99),
+        p999: load.percentile(latencies, 0.999)
+      });
+    });
+  });
+}
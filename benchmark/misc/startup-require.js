@@ -0,0 +1,64 @@
+'use strict';
+var common = require('../common.js');
+var spawn = require('child_process').spawn;
+var fs = require('fs');
+var os = require('os');
+var path = require('path');
+
+// Start-up time of a process that loads some core modules, with and without
+// the on-disk code cache (NODE_CODE_CACHE_DIR).  Builds configured with
+// --code-cache-path use the embedded code cache in both cases.
+var bench = common.createBenchmark(startNode, {
+  module: ['none', 'http', 'net,fs,child_process'],
+  cache: ['none', 'dir'],
+  dur: [1]
+});
+
+function startNode(conf) {
+  var dur = +conf.dur;
+  var go = true;
+  var starts = 0;
+
+  var script = conf.module === 'none' ? '' :
+      conf.module.split(',').map((id) => `require('${id}');`).join('');
+  var env = Object.assign({}, process.env);
+  var dir = null;
+  delete env.NODE_CODE_CACHE_DIR;
+  if (conf.cache === 'dir') {
+    dir = path.join(os.tmpdir(), `node-bench-code-cache-${process.pid}`);
+    env.NODE_CODE_CACHE_DIR = dir;
+  }
+
+  // Warm up so that the cache, if any, is filled before measuring.
+  spawn(process.execPath, ['-e', script], { env: env }).on('exit', function() {
+    setTimeout(function() {
+      go = false;
+    }, dur * 1000);
+
+    bench.start();
+    start();
+  });
+
+  function start() {
+    var node = spawn(process.execPath, ['-e', script], { env: env });
+    node.on('exit', function(exitCode) {
+      if (exitCode !== 0) {
+        throw new Error('Error during node startup');
+      }
+      starts++;
+
+      if (go) {
+        start();
+      } else {
+        if (dir !== null)
+          removeDir(dir);
+        bench.end(starts);
+      }
+    });
+  }
+}
+
+function removeDir(dir) {
+  fs.readdirSync(dir).forEach((f) => fs.unlinkSync(path.join(dir, f)));
+  fs.rmdirSync(dir);
+}
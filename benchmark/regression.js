@@ -0,0 +1,309 @@
+'use strict';
+// Runs a fixed set of benchmark configs with one node binary, writes the
+// results as JSON and compares them with the results of an earlier run, the
+// baseline.  Exits with 1 when a config got slower by more than the threshold
+// and the 95% confidence interval of the change excludes zero.  `make bench-ci`
+// runs it, `make bench-ci-baseline` records the baseline.
+//
+// The rounds run every config once, so that changes of the machine state are
+// spread over all of them.  Unlike with ab.js the runs of the baseline are not
+// paired with the current ones, the change is the ratio of the geometric means
+// with Welch's confidence interval.
+
+const child_process = require('child_process');
+const fs = require('fs');
+const path = require('path');
+const stats = require('./_stats.js');
+
+// Configs that take a few seconds at most and vary little between runs.  All
+// options are given so that each entry runs exactly the listed configs.
+// |lowerIsBetter| is for the benchmarks that report times instead of rates.
+const suite = [
+  { file: 'misc/startup.js', args: ['dur=1'] },
+  { file: 'http/client-request-body.js',
+    args: ['dur=2', 'type=buf', 'bytes=1024', 'method=end'] },
+  { file: 'http/latency.js',
+    args: ['connection=keepalive', 'transport=tcp', 'body=fixed',
+           'headers=4', 'upload=0', 'rate=500', 'c=50', 'dur=3'],
+    lowerIsBetter: true },
+  { file: 'buffers/buffer-creation.js',
+    args: ['type=fast-allocUnsafe', 'len=1024', 'n=1024'] },
+  { file: 'buffers/buffer-tostring-utf8.js',
+    args: ['content=latin1', 'len=1024', 'n=100000'] },
+  { file: 'buffers/buffer-compare.js', args: ['size=1024', 'millions=1'] },
+  { file: 'fs/readfile.js', args: ['dur=2', 'len=1024', 'concurrent=10'] },
+  { file: 'fs/readfile.js',
+    args: ['dur=2', 'len=16777216', 'concurrent=1'] },
+  { file: 'crypto/hash-stream-throughput.js',
+    args: ['writes=500', 'algo=sha256', 'type=buf', 'len=102400',
+           'api=stream'] },
+  { file: 'zlib/deflate.js',
+    args: ['method=deflate', 'api=sync', 'len=102400', 'n=256'] },
+  { file: 'zlib/deflate.js',
+    args: ['method=inflate', 'api=async', 'len=102400', 'n=256'] }
+];
+
+const usage = `usage: node benchmark/regression.js [options]
+
+  --node <node>        the binary to measure, default the one running this
+  --runs <n>           measured rounds, default 10
+  --warmup <n>         rounds that are discarded first, default 1
+  --filter <string>    only run the benchmark files whose name contains it
+  --cpu <list>         pin the benchmarks to these CPUs with taskset(1)
+  --json <file>        write the results as JSON to <file>
+  --baseline <file>    compare with the results in <file>, which an earlier
+                       --json wrote
+  --threshold <pct>    the slowdown in percent that fails, default 5`;
+
+const opts = {
+  node: process.execPath,
+  runs: 10,
+  warmup: 1,
+  filter: null,
+  cpu: null,
+  json: null,
+  baseline: null,
+  threshold: 5
+};
+
+function optionValue(args, i, name) {
+  if (i + 1 >= args.length)
+    fail(`${name} needs a value`);
+  return args[i + 1];
+}
+
+function fail(message) {
+  console.error(message);
+  console.error(usage);
+  process.exit(1);
+}
+
+const args = process.argv.slice(2);
+for (var i = 0; i < args.length; i++) {
+  const arg = args[i];
+  switch (arg) {
+    case '--node': opts.node = optionValue(args, i++, arg); break;
+    case '--runs': opts.runs = +optionValue(args, i++, arg); break;
+    case '--warmup': opts.warmup = +optionValue(args, i++, arg); break;
+    case '--filter': opts.filter = optionValue(args, i++, arg); break;
+    case '--cpu': opts.cpu = optionValue(args, i++, arg); break;
+    case '--json': opts.json = optionValue(args, i++, arg); break;
+    case '--baseline': opts.baseline = optionValue(args, i++, arg); break;
+    case '--threshold': opts.threshold = +optionValue(args, i++, arg); break;
+    case '-h': case '--help':
+      console.log(usage);
+      process.exit(0);
+      break;
+    default:
+      fail(`unknown argument ${arg}`);
+  }
+}
+
+if (!Number.isInteger(opts.runs) || opts.runs < 2)
+  fail('--runs must be an integer of at least 2');
+if (!Number.isInteger(opts.warmup) || opts.warmup < 0)
+  fail('--warmup must be a non-negative integer');
+if (!(opts.threshold >= 0))
+  fail('--threshold must be a non-negative number');
+
+// Read it first, a missing baseline should not take a whole run to notice.
+var baseline = null;
+if (opts.baseline !== null) {
+  try {
+    baseline = JSON.parse(fs.readFileSync(opts.baseline, 'utf8'));
+  } catch (err) {
+    console.error(`cannot read the baseline ${opts.baseline}: ${err.message}`);
+    console.error('`make bench-ci-baseline` records one.');
+    process.exit(1);
+  }
+}
+
+const node = path.resolve(opts.node);
+const entries = suite.filter((entry) => {
+  return opts.filter === null || entry.file.indexOf(opts.filter) !== -1;
+});
+
+if (entries.length === 0)
+  fail('no benchmark matches');
+
+// results[config] holds the values of the measured rounds.
+const results = {};
+const order = [];
+
+function runEntry(entry, cb) {
+  var cmd = [node, path.join(__dirname, entry.file)].concat(entry.args);
+  if (opts.cpu !== null)
+    cmd = ['taskset', '-c', opts.cpu].concat(cmd);
+  const child = child_process.spawn(cmd[0], cmd.slice(1), {
+    stdio: ['ignore', 'pipe', 'inherit']
+  });
+  var out = '';
+  child.stdout.setEncoding('utf8');
+  child.stdout.on('data', (chunk) => { out += chunk; });
+  child.on('error', (err) => {
+    console.error(`${cmd[0]}: ${err.message}`);
+    process.exit(1);
+  });
+  child.on('close', (code) => {
+    if (code !== 0) {
+      console.error(`${entry.file} failed on ${node} (${code})`);
+      process.exit(1);
+    }
+    const values = {};
+    out.split(/\r?\n/).forEach((line) => {
+      const match = /^(.+): ([0-9.eE+-]+)$/.exec(line.trim());
+      if (match)
+        values[match[1]] = +match[2];
+    });
+    if (Object.keys(values).length === 0) {
+      console.error(`${entry.file} reported nothing`);
+      process.exit(1);
+    }
+    cb(values);
+  });
+}
+
+function runRound(round, cb) {
+  const measured = round >= opts.warmup;
+  var next = 0;
+  (function runNext() {
+    if (next === entries.length)
+      return cb();
+    const entry = entries[next++];
+    runEntry(entry, (values) => {
+      if (!measured)
+        return runNext();
+      Object.keys(values).forEach((config) => {
+        if (!results[config]) {
+          results[config] = {
+            values: [],
+            lowerIsBetter: entry.lowerIsBetter === true
+          };
+          order.push(config);
+        }
+        results[config].values.push(values[config]);
+      });
+      runNext();
+    });
+  })();
+}
+
+function runRounds(round) {
+  const rounds = opts.warmup + opts.runs;
+  if (round === rounds)
+    return report();
+  console.error(`round ${round + 1}/${rounds}`);
+  runRound(round, () => runRounds(round + 1));
+}
+
+function logs(list) {
+  return stats.withoutOutliers(list.filter((v) => v > 0).map(Math.log));
+}
+
+// Compares the logarithms of the values of both runs, which makes the change
+// the ratio of their geometric means.  Outliers are dropped per run.
+function compare(current, base) {
+  const result = {
+    change: null,
+    confidenceInterval: null,
+    significant: false,
+    regression: false
+  };
+  const a = logs(base.samples);
+  const b = logs(current.samples);
+  if (a.length < 2 || b.length < 2)
+    return result;
+
+  const va = stats.stddev(a) * stats.stddev(a) / a.length;
+  const vb = stats.stddev(b) * stats.stddev(b) / b.length;
+  const d = stats.mean(b) - stats.mean(a);
+  const se = Math.sqrt(va + vb);
+  // Welch-Satterthwaite, with a floor for runs without any variance.
+  const df = se === 0 ? Infinity :
+      (va + vb) * (va + vb) /
+      (va * va / (a.length - 1) + vb * vb / (b.length - 1));
+  const margin = stats.tQuantile(Math.max(df, 1)) * se;
+
+  result.change = Math.exp(d) - 1;
+  result.confidenceInterval = [Math.exp(d - margin) - 1,
+                               Math.exp(d + margin) - 1];
+  result.significant = d - margin > 0 || d + margin < 0;
+  const slowdown = current.lowerIsBetter ? result.change : -result.change;
+  result.regression = result.significant &&
+                      slowdown * 100 > opts.threshold;
+  return result;
+}
+
+function percent(value) {
+  return (value >= 0 ? '+' : '') + (value * 100).toFixed(2) + '%';
+}
+
+function report() {
+  const analyzed = order.map((config) => {
+    const r = stats.summary(results[config].values);
+    r.benchmark = config;
+    r.lowerIsBetter = results[config].lowerIsBetter;
+    return r;
+  });
+
+  const base = {};
+  if (baseline !== null)
+    baseline.results.forEach((r) => { base[r.benchmark] = r; });
+
+  var regressions = 0;
+  analyzed.forEach((r) => {
+    var line = `${r.benchmark}: ${r.mean.toPrecision(5)} ` +
+               `±${(r.cv * 100).toFixed(1)}%`;
+    if (baseline !== null) {
+      if (base[r.benchmark] === undefined) {
+        line += ' not in the baseline';
+      } else {
+        r.baseline = compare(r, base[r.benchmark]);
+        const c = r.baseline;
+        if (c.change === null) {
+          line += ' n/a';
+        } else {
+          const ci = c.confidenceInterval;
+          line += ` ${percent(c.change)} ` +
+                  `[${percent(ci[0])}, ${percent(ci[1])}]`;
+          if (c.significant)
+            line += ' *';
+          if (c.regression)
+            line += ' REGRESSION';
+        }
+        if (c.regression)
+          regressions++;
+      }
+    }
+    console.log(line);
+  });
+
+  if (opts.json !== null) {
+    const json = {
+      node: node,
+      version: child_process.execFileSync(node, ['-p', 'process.version'],
+                                          { encoding: 'utf8' }).trim(),
+      date: new Date().toISOString(),
+      runs: opts.runs,
+      warmup: opts.warmup,
+      cpu: opts.cpu,
+      confidence: 0.95,
+      baseline: opts.baseline,
+      threshold: opts.threshold,
+      results: analyzed
+    };
+    fs.writeFileSync(opts.json, JSON.stringify(json, null, 2) + '\n');
+  }
+
+  if (baseline === null)
+    return;
+  console.log('\nChanges marked with * have a 95% confidence interval that ' +
+              'excludes zero.');
+  if (regressions > 0) {
+    console.log(`${regressions} regression(s) of more than ` +
+                `${opts.threshold}% against ${opts.baseline}.`);
+    process.exitCode = 1;
+  }
+}
+
+runRounds(0);
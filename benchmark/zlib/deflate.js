@@ -0,0 +1,42 @@
+// Throughput of zlib.deflate() and zlib.inflate() on compressible input.
+'use strict';
+var common = require('../common.js');
+var zlib = require('zlib');
+
+var bench = common.createBenchmark(main, {
+  method: ['deflate', 'inflate'],
+  api: ['sync', 'async'],
+  len: [1024, 102400, 1024 * 1024],
+  n: [256]
+});
+
+function main(conf) {
+  var n = +conf.n;
+  var len = +conf.len;
+
+  var words = 'lorem ipsum dolor sit amet consectetur adipiscing elit ';
+  var input = Buffer.alloc(len, words);
+  if (conf.method === 'inflate')
+    input = zlib.deflateSync(input);
+
+  var sync = conf.method === 'deflate' ? zlib.deflateSync : zlib.inflateSync;
+  var async = conf.method === 'deflate' ? zlib.deflate : zlib.inflate;
+
+  var i = 0;
+  if (conf.api === 'sync') {
+    bench.start();
+    for (; i < n; i++)
+      sync(input);
+    bench.end(len * n / (1024 * 1024));
+    return;
+  }
+
+  bench.start();
+  (function next(err) {
+    if (err)
+      throw err;
+    if (i++ === n)
+      return bench.end(len * n / (1024 * 1024));
+    async(input, next);
+  })();
+}
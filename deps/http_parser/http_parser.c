@@ -29,6 +29,14 @@
 #include <string.h>
 #include <limits.h>
 
+#if defined(__SSE2__) || defined(_M_X64)
+# include <emmintrin.h>
+# define HTTP_PARSER_SSE2 1
+# if defined(_MSC_VER)
+#  include <intrin.h>
+# endif
+#endif
+
 #ifndef ULLONG_MAX
 # define ULLONG_MAX ((uint64_t) -1) /* 2^64-1 */
 #endif
@@ -472,6 +480,100 @@ static struct {
 
 int http_message_needs_eof(const http_parser *parser);
 
+#if HTTP_PARSER_SSE2
+/* Index of the lowest set bit of a non-zero mask. */
+static int
+first_bit(unsigned int mask)
+{
+#if defined(_MSC_VER)
+  unsigned long index;
+  _BitScanForward(&index, mask);
+  return (int) index;
+#else
+  return __builtin_ctz(mask);
+#endif
+}
+#endif
+
+
+/* Returns the first CR or LF in [p, end), or end if there is none.  Header
+ * values can be long, like cookies, so this looks at 16 bytes at a time
+ * instead of making a memchr() pass for each of CR and LF.
+ */
+static const char*
+find_crlf(const char* p, const char* end)
+{
+#if HTTP_PARSER_SSE2
+  const __m128i cr = _mm_set1_epi8(CR);
+  const __m128i lf = _mm_set1_epi8(LF);
+  for (; end - p >= 16; p += 16) {
+    const __m128i v = _mm_loadu_si128((const __m128i*) p);
+    const __m128i found = _mm_or_si128(_mm_cmpeq_epi8(v, cr),
+                                       _mm_cmpeq_epi8(v, lf));
+    const unsigned int mask = (unsigned int) _mm_movemask_epi8(found);
+    if (mask != 0)
+      return p + first_bit(mask);
+  }
+#endif
+  for (; p != end; p++) {
+    if (*p == CR || *p == LF)
+      break;
+  }
+  return p;
+}
+
+
+/* Returns the first character in [p, end) that would make parse_url_char()
+ * leave the state s, or end if there is none.  Only for s_req_path,
+ * s_req_query_string and s_req_fragment, where all URL characters but '?'
+ * and '#' keep the state.  Tabs and form feeds are allowed in lenient mode
+ * but stop the scan too, the caller handles them one at a time.
+ */
+static const char*
+skip_url_chars(const char* p, const char* end, enum state s)
+{
+  /* The characters that leave the state, beside the ones that can't be in
+   * a URL.  NUL is never a URL character, so it stands for none.
+   */
+  const char stop1 = (s == s_req_fragment) ? '\0' : '#';
+  const char stop2 = (s == s_req_path) ? '?' : '\0';
+#if HTTP_PARSER_SSE2
+  const __m128i space = _mm_set1_epi8(' ');
+  const __m128i del = _mm_set1_epi8(0x7f);
+  const __m128i v1 = _mm_set1_epi8(stop1);
+  const __m128i v2 = _mm_set1_epi8(stop2);
+  for (; end - p >= 16; p += 16) {
+    const __m128i v = _mm_loadu_si128((const __m128i*) p);
+    /* v <= ' ' as unsigned bytes */
+    const __m128i control = _mm_cmpeq_epi8(_mm_min_epu8(v, space), v);
+#if HTTP_PARSER_STRICT
+    /* v >= 0x7f as unsigned bytes */
+    const __m128i high = _mm_cmpeq_epi8(_mm_max_epu8(v, del), v);
+#else
+    const __m128i high = _mm_cmpeq_epi8(v, del);
+#endif
+    const __m128i stop = _mm_or_si128(_mm_cmpeq_epi8(v, v1),
+                                      _mm_cmpeq_epi8(v, v2));
+    const unsigned int mask = (unsigned int) _mm_movemask_epi8(
+        _mm_or_si128(_mm_or_si128(control, high), stop));
+    if (mask != 0)
+      return p + first_bit(mask);
+  }
+#endif
+  for (; p != end; p++) {
+    const unsigned char ch = (unsigned char) *p;
+#if HTTP_PARSER_STRICT
+    if (ch <= ' ' || ch >= 0x7f || ch == stop1 || ch == stop2)
+      break;
+#else
+    if (ch <= ' ' || ch == 0x7f || ch == stop1 || ch == stop2)
+      break;
+#endif
+  }
+  return p;
+}
+
+
 /* Our URL parser.
  *
  * This is designed to be shared by http_parser_execute() for URL validation,
@@ -1099,6 +1201,24 @@ reexecute:
       case s_req_fragment_start:
       case s_req_fragment:
       {
+        if (CURRENT_STATE() == s_req_path ||
+            CURRENT_STATE() == s_req_query_string ||
+            CURRENT_STATE() == s_req_fragment) {
+          /* Skip the characters that keep the state at once, but not past
+           * the header size limit so that it is hit at the same byte.
+           */
+          const char* end;
+          size_t limit = data + len - (p + 1);
+
+          limit = MIN(limit, HTTP_MAX_HEADER_SIZE - parser->nread);
+          end = skip_url_chars(p, p + 1 + limit, CURRENT_STATE());
+          if (end != p) {
+            COUNT_HEADER_SIZE(end - (p + 1));
+            p = end - 1;
+            break;
+          }
+        }
+
         switch (ch) {
           case ' ':
             UPDATE_STATE(s_req_http_start);
@@ -1533,24 +1653,11 @@ reexecute:
           switch (h_state) {
             case h_general:
             {
-              const char* p_cr;
-              const char* p_lf;
               size_t limit = data + len - p;
 
               limit = MIN(limit, HTTP_MAX_HEADER_SIZE);
 
-              p_cr = (const char*) memchr(p, CR, limit);
-              p_lf = (const char*) memchr(p, LF, limit);
-              if (p_cr != NULL) {
-                if (p_lf != NULL && p_cr >= p_lf)
-                  p = p_lf;
-                else
-                  p = p_cr;
-              } else if (UNLIKELY(p_lf != NULL)) {
-                p = p_lf;
-              } else {
-                p = data + len;
-              }
+              p = find_crlf(p, p + limit);
               --p;
 
               break;
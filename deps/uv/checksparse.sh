@@ -84,6 +84,7 @@ test/runner.h
 test/task.h
 test/test-active.c
 test/test-async.c
+test/test-async-queue.c
 test/test-barrier.c
 test/test-callback-order.c
 test/test-callback-stack.c
@@ -96,6 +97,7 @@ test/test-embed.c
 test/test-error.c
 test/test-fail-always.c
 test/test-fs-event.c
+test/test-fs-io-uring.c
 test/test-fs-poll.c
 test/test-fs.c
 test/test-get-currentexe.c
@@ -111,6 +113,7 @@ test/test-ip6-addr.c
 test/test-ipc-send-recv.c
 test/test-ipc.c
 test/test-loop-handles.c
+test/test-loop-metrics.c
 test/test-multiple-listen.c
 test/test-mutexes.c
 test/test-pass-always.c
@@ -134,6 +137,7 @@ test/test-signal.c
 test/test-spawn.c
 test/test-stdio-over-pipes.c
 test/test-tcp-bind-error.c
+test/test-tcp-bind-reuseport.c
 test/test-tcp-bind6-error.c
 test/test-tcp-close-while-connecting.c
 test/test-tcp-close-accept.c
@@ -145,6 +149,8 @@ test/test-tcp-connect6-error.c
 test/test-tcp-flags.c
 test/test-tcp-open.c
 test/test-tcp-read-stop.c
+test/test-tcp-sendfile.c
+test/test-tcp-splice.c
 test/test-tcp-shutdown-after-write.c
 test/test-tcp-unexpected-read.c
 test/test-tcp-oob.c
@@ -153,13 +159,18 @@ test/test-tcp-write-to-half-open-connection.c
 test/test-tcp-writealot.c
 test/test-thread.c
 test/test-threadpool-cancel.c
+test/test-threadpool-priority.c
+test/test-threadpool-size.c
+test/test-threadpool-stats.c
 test/test-threadpool.c
 test/test-timer-again.c
 test/test-timer.c
 test/test-tmpdir.c
 test/test-tty.c
 test/test-udp-dgram-too-big.c
+test/test-udp-gso.c
 test/test-udp-ipv6.c
+test/test-udp-mmsg.c
 test/test-udp-multicast-join.c
 test/test-udp-multicast-ttl.c
 test/test-udp-open.c
@@ -203,6 +214,7 @@ Linux)
            include/uv-linux.h
            src/unix/linux-inotify.c
            src/unix/linux-core.c
+           src/unix/linux-iouring.c
            src/unix/linux-syscalls.c
            src/unix/linux-syscalls.h"
   ;;
@@ -26,6 +26,10 @@
   uv__io_t inotify_read_watcher;                                              \
   void* inotify_watchers;                                                     \
   int inotify_fd;                                                             \
+  void* iou;                                                                  \
+  void* poll_events;                                                          \
+  unsigned int npoll_events;                                                  \
+  unsigned int busy_poll;                                                     \
 
 #define UV_PLATFORM_FS_EVENT_FIELDS                                           \
   void* watchers[2];                                                          \
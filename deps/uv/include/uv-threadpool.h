@@ -32,6 +32,9 @@ struct uv__work {
   void (*done)(struct uv__work *w, int status);
   struct uv_loop_s* loop;
   void* wq[2];
+  void* done_next;
+  uint64_t submit_time;
+  unsigned int kind;
 };
 
 #endif /* UV_THREADPOOL_H_ */
@@ -214,8 +214,7 @@ typedef struct {
   uv__io_t** watchers;                                                        \
   unsigned int nwatchers;                                                     \
   unsigned int nfds;                                                          \
-  void* wq[2];                                                                \
-  uv_mutex_t wq_mutex;                                                        \
+  void* volatile wq_done;                                                     \
   uv_async_t wq_async;                                                        \
   uv_rwlock_t cloexec_lock;                                                   \
   uv_handle_t* closing_handles;                                               \
@@ -230,6 +229,7 @@ typedef struct {
     unsigned int nelts;                                                       \
   } timer_heap;                                                               \
   uint64_t timer_counter;                                                     \
+  void* timer_wheel;                                                          \
   uint64_t time;                                                              \
   int signal_pipefd[2];                                                       \
   uv__io_t signal_io_watcher;                                                 \
@@ -250,6 +250,8 @@ typedef struct {
   unsigned int nbufs;                                                         \
   int error;                                                                  \
   uv_buf_t bufsml[4];                                                         \
+  uv_file send_file;                                                          \
+  int64_t send_offset;                                                        \
 
 #define UV_CONNECT_PRIVATE_FIELDS                                             \
   void* queue[2];                                                             \
@@ -264,6 +266,7 @@ typedef struct {
   ssize_t status;                                                             \
   uv_udp_send_cb send_cb;                                                     \
   uv_buf_t bufsml[4];                                                         \
+  unsigned int segment_size;                                                  \
 
 #define UV_HANDLE_PRIVATE_FIELDS                                              \
   uv_handle_t* next_closing;                                                  \
@@ -279,6 +282,8 @@ typedef struct {
   int delayed_error;                                                          \
   int accepted_fd;                                                            \
   void* queued_fds;                                                           \
+  void* splice_out;                                                           \
+  void* splice_in;                                                            \
   UV_STREAM_PRIVATE_PLATFORM_FIELDS                                           \
 
 #define UV_TCP_PRIVATE_FIELDS /* empty */
@@ -289,6 +294,7 @@ typedef struct {
   uv__io_t io_watcher;                                                        \
   void* write_queue[2];                                                       \
   void* write_completed_queue[2];                                             \
+  unsigned int recv_segment_size;                                             \
 
 #define UV_PIPE_PRIVATE_FIELDS                                                \
   const char* pipe_fname; /* strdup'ed */
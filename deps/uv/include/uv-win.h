@@ -341,8 +341,7 @@ RB_HEAD(uv_timer_tree_s, uv_timer_s);
   /* Counter to started timer */                                              \
   uint64_t timer_counter;                                                     \
   /* Threadpool */                                                            \
-  void* wq[2];                                                                \
-  uv_mutex_t wq_mutex;                                                        \
+  void* volatile wq_done;                                                     \
   uv_async_t wq_async;
 
 #define UV_REQ_TYPE_PRIVATE                                                   \
@@ -210,6 +210,8 @@ typedef struct uv_prepare_s uv_prepare_t;
 typedef struct uv_check_s uv_check_t;
 typedef struct uv_idle_s uv_idle_t;
 typedef struct uv_async_s uv_async_t;
+typedef struct uv_async_queue_s uv_async_queue_t;
+typedef struct uv_async_item_s uv_async_item_t;
 typedef struct uv_process_s uv_process_t;
 typedef struct uv_fs_event_s uv_fs_event_t;
 typedef struct uv_fs_poll_s uv_fs_poll_t;
@@ -231,11 +233,27 @@ typedef struct uv_cpu_info_s uv_cpu_info_t;
 typedef struct uv_interface_address_s uv_interface_address_t;
 typedef struct uv_dirent_s uv_dirent_t;
 typedef struct uv_passwd_s uv_passwd_t;
+typedef struct uv_loop_metrics_s uv_loop_metrics_t;
 
 typedef enum {
-  UV_LOOP_BLOCK_SIGNAL
+  UV_LOOP_BLOCK_SIGNAL,
+  UV_LOOP_METRICS,
+  UV_LOOP_POLL_EVENTS,
+  UV_LOOP_TIMER_WHEEL,
+  UV_LOOP_BUSY_POLL
 } uv_loop_option;
 
+typedef enum {
+  UV_LOOP_PHASE_TIMERS,
+  UV_LOOP_PHASE_PENDING,
+  UV_LOOP_PHASE_IDLE,
+  UV_LOOP_PHASE_PREPARE,
+  UV_LOOP_PHASE_POLL,
+  UV_LOOP_PHASE_CHECK,
+  UV_LOOP_PHASE_CLOSING,
+  UV_LOOP_PHASE_MAX
+} uv_loop_phase;
+
 typedef enum {
   UV_RUN_DEFAULT = 0,
   UV_RUN_ONCE,
@@ -275,6 +293,25 @@ UV_EXTERN size_t uv_loop_size(void);
 UV_EXTERN int uv_loop_alive(const uv_loop_t* loop);
 UV_EXTERN int uv_loop_configure(uv_loop_t* loop, uv_loop_option option, ...);
 
+/*
+ * Filled in by the loop when it is passed to uv_loop_configure() with
+ * UV_LOOP_METRICS. All times are in nanoseconds.
+ */
+struct uv_loop_metrics_s {
+  uint64_t iterations;
+  /* Time spent in each phase, not counting the time blocked for I/O. */
+  uint64_t phase_time[UV_LOOP_PHASE_MAX];
+  /* Time spent blocked for I/O in the poll phase. */
+  uint64_t idle_time;
+  /* Time that the last complete iteration spent outside of idle_time. */
+  uint64_t last_iteration_time;
+  /* private */
+  unsigned int phase;
+  uint64_t phase_start;
+  uint64_t iteration_start;
+  uint64_t iteration_idle;
+};
+
 UV_EXTERN int uv_run(uv_loop_t*, uv_run_mode mode);
 UV_EXTERN void uv_stop(uv_loop_t*);
 
@@ -295,6 +332,9 @@ typedef void (*uv_read_cb)(uv_stream_t* stream,
                            ssize_t nread,
                            const uv_buf_t* buf);
 typedef void (*uv_write_cb)(uv_write_t* req, int status);
+typedef void (*uv_splice_cb)(uv_stream_t* source,
+                             int read_status,
+                             int write_status);
 typedef void (*uv_connect_cb)(uv_connect_t* req, int status);
 typedef void (*uv_shutdown_cb)(uv_shutdown_t* req, int status);
 typedef void (*uv_connection_cb)(uv_stream_t* server, int status);
@@ -302,6 +342,8 @@ typedef void (*uv_close_cb)(uv_handle_t* handle);
 typedef void (*uv_poll_cb)(uv_poll_t* handle, int status, int events);
 typedef void (*uv_timer_cb)(uv_timer_t* handle);
 typedef void (*uv_async_cb)(uv_async_t* handle);
+typedef void (*uv_async_queue_cb)(uv_async_queue_t* queue,
+                                  uv_async_item_t* item);
 typedef void (*uv_prepare_cb)(uv_prepare_t* handle);
 typedef void (*uv_check_cb)(uv_check_t* handle);
 typedef void (*uv_idle_cb)(uv_idle_t* handle);
@@ -482,6 +524,16 @@ UV_EXTERN int uv_write2(uv_write_t* req,
 UV_EXTERN int uv_try_write(uv_stream_t* handle,
                            const uv_buf_t bufs[],
                            unsigned int nbufs);
+UV_EXTERN int uv_sendfile(uv_write_t* req,
+                          uv_stream_t* handle,
+                          uv_file file,
+                          int64_t offset,
+                          size_t length,
+                          uv_write_cb cb);
+UV_EXTERN int uv_splice_start(uv_stream_t* source,
+                              uv_stream_t* sink,
+                              uv_splice_cb cb);
+UV_EXTERN int uv_splice_stop(uv_stream_t* source);
 
 /* uv_write_t is a subclass of uv_req_t. */
 struct uv_write_s {
@@ -519,11 +571,15 @@ UV_EXTERN int uv_tcp_nodelay(uv_tcp_t* handle, int enable);
 UV_EXTERN int uv_tcp_keepalive(uv_tcp_t* handle,
                                int enable,
                                unsigned int delay);
+UV_EXTERN int uv_tcp_busy_poll(uv_tcp_t* handle, unsigned int usec);
 UV_EXTERN int uv_tcp_simultaneous_accepts(uv_tcp_t* handle, int enable);
 
 enum uv_tcp_flags {
   /* Used with uv_tcp_bind, when an IPv6 address is used. */
-  UV_TCP_IPV6ONLY = 1
+  UV_TCP_IPV6ONLY = 1,
+  /* Used with uv_tcp_bind, lets sockets share the address and port and
+   * balances incoming connections over them. Linux and FreeBSD only. */
+  UV_TCP_REUSEPORT = 2
 };
 
 UV_EXTERN int uv_tcp_bind(uv_tcp_t* handle,
@@ -569,7 +625,24 @@ enum uv_udp_flags {
    * (provided they all set the flag) but only the last one to bind will receive
    * any traffic, in effect "stealing" the port from the previous listener.
    */
-  UV_UDP_REUSEADDR = 4
+  UV_UDP_REUSEADDR = 4,
+  /*
+   * Indicates that the message was received by recvmmsg, so the buffer
+   * provided must not be freed by the recv_cb callback.
+   */
+  UV_UDP_MMSG_CHUNK = 8,
+  /*
+   * Indicates that the buffer provided has been fully utilized by recvmmsg
+   * and that it should now be freed by the recv_cb callback.  When this flag
+   * is set in uv_udp_recv_cb, nread will always be 0 and addr will always be
+   * NULL.
+   */
+  UV_UDP_MMSG_FREE = 16,
+  /*
+   * Indicates that recvmmsg should be used, if available.  Used in
+   * uv_udp_init_ex.
+   */
+  UV_UDP_RECVMMSG = 256
 };
 
 typedef void (*uv_udp_send_cb)(uv_udp_send_t* req, int status);
@@ -629,6 +702,13 @@ UV_EXTERN int uv_udp_send(uv_udp_send_t* req,
                           unsigned int nbufs,
                           const struct sockaddr* addr,
                           uv_udp_send_cb send_cb);
+UV_EXTERN int uv_udp_send_gso(uv_udp_send_t* req,
+                              uv_udp_t* handle,
+                              const uv_buf_t bufs[],
+                              unsigned int nbufs,
+                              const struct sockaddr* addr,
+                              unsigned int segment_size,
+                              uv_udp_send_cb send_cb);
 UV_EXTERN int uv_udp_try_send(uv_udp_t* handle,
                               const uv_buf_t bufs[],
                               unsigned int nbufs,
@@ -636,6 +716,10 @@ UV_EXTERN int uv_udp_try_send(uv_udp_t* handle,
 UV_EXTERN int uv_udp_recv_start(uv_udp_t* handle,
                                 uv_alloc_cb alloc_cb,
                                 uv_udp_recv_cb recv_cb);
+UV_EXTERN int uv_udp_using_recvmmsg(const uv_udp_t* handle);
+UV_EXTERN int uv_udp_set_gro(uv_udp_t* handle, int on);
+UV_EXTERN int uv_udp_set_busy_poll(uv_udp_t* handle, unsigned int usec);
+UV_EXTERN unsigned int uv_udp_get_recv_segment_size(const uv_udp_t* handle);
 UV_EXTERN int uv_udp_recv_stop(uv_udp_t* handle);
 
 
@@ -768,6 +852,37 @@ UV_EXTERN int uv_async_init(uv_loop_t*,
 UV_EXTERN int uv_async_send(uv_async_t* async);
 
 
+/*
+ * uv_async_queue_t is a multi-producer, single-consumer queue on top of an
+ * async handle.
+ *
+ * Any thread can push items; the loop thread pops them in the order they
+ * were pushed and passes them to the callback one at a time. Pushing is
+ * lock-free and only the push that finds the queue empty wakes up the loop.
+ */
+struct uv_async_item_s {
+  void* data;
+  /* Private, don't touch. */
+  void* next;
+};
+
+struct uv_async_queue_s {
+  uv_async_t async;
+  void* data;
+  /* Private, don't touch. */
+  uv_async_queue_cb cb;
+  void* volatile head;
+};
+
+UV_EXTERN int uv_async_queue_init(uv_loop_t* loop,
+                                  uv_async_queue_t* queue,
+                                  uv_async_queue_cb cb);
+UV_EXTERN void uv_async_queue_push(uv_async_queue_t* queue,
+                                   uv_async_item_t* item);
+UV_EXTERN void uv_async_queue_close(uv_async_queue_t* queue,
+                                    uv_close_cb close_cb);
+
+
 /*
  * uv_timer_t is a subclass of uv_handle_t.
  *
@@ -968,13 +1083,78 @@ struct uv_work_s {
   UV_WORK_PRIVATE_FIELDS
 };
 
+typedef enum {
+  UV_PRIORITY_HIGH,
+  UV_PRIORITY_NORMAL,
+  UV_PRIORITY_LOW
+} uv_work_priority;
+
 UV_EXTERN int uv_queue_work(uv_loop_t* loop,
                             uv_work_t* req,
                             uv_work_cb work_cb,
                             uv_after_work_cb after_work_cb);
+UV_EXTERN int uv_queue_work_priority(uv_loop_t* loop,
+                                     uv_work_t* req,
+                                     uv_work_cb work_cb,
+                                     uv_after_work_cb after_work_cb,
+                                     uv_work_priority priority);
+
+typedef enum {
+  UV_THREADPOOL_CPU,
+  UV_THREADPOOL_FS,
+  UV_THREADPOOL_DNS,
+  UV_THREADPOOL_CRYPTO
+} uv_threadpool_queue;
+
+UV_EXTERN int uv_queue_work_ex(uv_loop_t* loop,
+                               uv_work_t* req,
+                               uv_work_cb work_cb,
+                               uv_after_work_cb after_work_cb,
+                               uv_threadpool_queue queue,
+                               uv_work_priority priority);
+
+/*
+ * uv_threadpool_task_t is work that runs on the threadpool without a loop,
+ * it is not a uv_req_t.
+ */
+typedef struct uv_threadpool_task_s uv_threadpool_task_t;
+typedef void (*uv_threadpool_task_cb)(uv_threadpool_task_t* task);
+
+struct uv_threadpool_task_s {
+  void* data;
+  uv_threadpool_task_cb task_cb;
+  UV_WORK_PRIVATE_FIELDS
+};
+
+UV_EXTERN int uv_threadpool_submit(uv_threadpool_task_t* task,
+                                   uv_threadpool_task_cb task_cb,
+                                   uv_threadpool_queue queue,
+                                   uv_work_priority priority);
 
 UV_EXTERN int uv_cancel(uv_req_t* req);
 
+UV_EXTERN int uv_threadpool_set_size(uv_threadpool_queue queue,
+                                     unsigned int size);
+UV_EXTERN int uv_threadpool_get_size(uv_threadpool_queue queue);
+UV_EXTERN int uv_threadpool_set_affinity(uv_threadpool_queue queue,
+                                         const char* cpumask,
+                                         size_t mask_size);
+
+typedef struct {
+  uint64_t submitted;
+  uint64_t completed;
+  uint64_t queued;
+  uint64_t max_queued;
+  uint64_t running;
+  uint64_t wait_time;
+  uint64_t max_wait_time;
+  uint64_t run_time;
+  uint64_t max_run_time;
+} uv_threadpool_stats_t;
+
+UV_EXTERN int uv_threadpool_get_stats(uv_threadpool_queue queue,
+                                      uv_threadpool_stats_t* stats);
+
 
 struct uv_cpu_info_s {
   char* model;
@@ -1443,6 +1623,14 @@ UV_EXTERN int uv_thread_create(uv_thread_t* tid, uv_thread_cb entry, void* arg);
 UV_EXTERN uv_thread_t uv_thread_self(void);
 UV_EXTERN int uv_thread_join(uv_thread_t *tid);
 UV_EXTERN int uv_thread_equal(const uv_thread_t* t1, const uv_thread_t* t2);
+UV_EXTERN int uv_cpumask_size(void);
+UV_EXTERN int uv_thread_setaffinity(uv_thread_t* tid,
+                                    char* cpumask,
+                                    char* oldmask,
+                                    size_t mask_size);
+UV_EXTERN int uv_thread_getaffinity(uv_thread_t* tid,
+                                    char* cpumask,
+                                    size_t mask_size);
 
 /* The presence of these unions force similar struct layout. */
 #define XX(_, name) uv_ ## name ## _t name;
@@ -1465,6 +1653,8 @@ struct uv_loop_s {
   void* active_reqs[2];
   /* Internal flag to signal loop stop. */
   unsigned int stop_flag;
+  /* Internal, set with UV_LOOP_METRICS. */
+  uv_loop_metrics_t* metrics;
   UV_LOOP_PRIVATE_FIELDS
 };
 
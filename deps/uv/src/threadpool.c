@@ -38,18 +38,62 @@ static void uv__req_init(uv_loop_t* loop,
 #endif
 
 #include <stdlib.h>
+#include <string.h>
 
 #define MAX_THREADPOOL_SIZE 128
+#define DEFAULT_THREADPOOL_SIZE 4
+
+#define UV__THREADPOOL_QUEUES 4
+#define UV__PRIORITIES 3
+
+/* Number of requests taken in a row from higher priority lanes while a lower
+ * priority lane has work waiting, before one request of the latter is run.
+ */
+#define MAX_PRIORITY_BURST 16
+
+/* Every queue has its own threads, except that the fs and dns queues share
+ * the threads of the cpu queue while their size is zero, which is the
+ * default. Queues are resized with uv_threadpool_set_size(); their threads
+ * are started the first time work is posted to them.
+ *
+ * A queue may have a CPU affinity for its threads, which is set on the
+ * threads that are running when it changes and on those that start later.
+ *
+ * Each queue has a lane per uv_work_priority. Threads take work from the
+ * highest priority lane that has any, but never pass over waiting lower
+ * priority work more than MAX_PRIORITY_BURST times in a row.
+ */
+struct work_queue {
+  uv_cond_t cond;
+  QUEUE wq[UV__PRIORITIES];
+  unsigned int burst;
+  unsigned int idle_threads;
+  unsigned int nthreads;
+  unsigned int size;
+  char* affinity;  /* NULL, or a mask of uv_cpumask_size() CPUs. */
+};
+
+enum {
+  SLOT_UNUSED,
+  SLOT_RUNNING,
+  SLOT_EXITED
+};
+
+struct worker_slot {
+  uv_thread_t thread;
+  struct work_queue* queue;
+  int state;
+};
 
 static uv_once_t once = UV_ONCE_INIT;
-static uv_cond_t cond;
 static uv_mutex_t mutex;
-static unsigned int idle_threads;
-static unsigned int nthreads;
-static uv_thread_t* threads;
-static uv_thread_t default_threads[4];
-static QUEUE exit_message;
-static QUEUE wq;
+static struct work_queue queues[UV__THREADPOOL_QUEUES];
+/* Indexed by the queue that the work was submitted for, which is not the
+ * queue that runs it when that one has no threads of its own.
+ */
+static uv_threadpool_stats_t stats[UV__THREADPOOL_QUEUES];
+static struct worker_slot slots[UV__THREADPOOL_QUEUES * MAX_THREADPOOL_SIZE];
+static int exiting;
 static volatile int initialized;
 
 
@@ -58,57 +102,188 @@ static void uv__cancelled(struct uv__work* w) {
 }
 
 
-/* To avoid deadlock with uv_cancel() it's crucial that the worker
- * never holds the global mutex and the loop-local mutex at the same time.
+static int queue_empty(struct work_queue* queue) {
+  unsigned int i;
+
+  for (i = 0; i < UV__PRIORITIES; i++)
+    if (!QUEUE_EMPTY(&queue->wq[i]))
+      return 0;
+  return 1;
+}
+
+
+/* Must be called with the mutex held, on a queue that is not empty. */
+static QUEUE* next_work(struct work_queue* queue) {
+  unsigned int lane;
+  unsigned int i;
+
+  for (lane = 0; QUEUE_EMPTY(&queue->wq[lane]); lane++);
+
+  for (i = lane + 1; i < UV__PRIORITIES; i++)
+    if (!QUEUE_EMPTY(&queue->wq[i]))
+      break;
+
+  if (i == UV__PRIORITIES)
+    queue->burst = 0;
+  else if (++queue->burst > MAX_PRIORITY_BURST) {
+    queue->burst = 0;
+    lane = i;
+  }
+
+  return QUEUE_HEAD(&queue->wq[lane]);
+}
+
+
+/* The global mutex only guards the queues; it is released before the work
+ * runs. Finished work goes back to its loop through loop->wq_done, a lock-free
+ * multi-producer, single-consumer list: workers and uv_cancel() push with
+ * uv__mpsc_push() and only the push that finds the list empty sends
+ * wq_async. The loop thread takes the whole list at once in uv__work_done()
+ * with uv__mpsc_take(), which hands it back in the order of the pushes.
  */
 static void worker(void* arg) {
+  struct worker_slot* slot;
+  struct work_queue* queue;
+  uv_threadpool_stats_t* s;
   struct uv__work* w;
+  uv_loop_t* loop;
+  uint64_t start_time;
+  uint64_t run_time;
   QUEUE* q;
 
-  (void) arg;
+  slot = arg;
+  queue = slot->queue;
+  s = NULL;
+  run_time = 0;
 
   for (;;) {
     uv_mutex_lock(&mutex);
 
-    while (QUEUE_EMPTY(&wq)) {
-      idle_threads += 1;
-      uv_cond_wait(&cond, &mutex);
-      idle_threads -= 1;
+    /* Account for the previous request now that the mutex is held anyway. */
+    if (s != NULL) {
+      s->running -= 1;
+      s->completed += 1;
+      s->run_time += run_time;
+      if (s->max_run_time < run_time)
+        s->max_run_time = run_time;
+      s = NULL;
     }
 
-    q = QUEUE_HEAD(&wq);
-
-    if (q == &exit_message)
-      uv_cond_signal(&cond);
-    else {
-      QUEUE_REMOVE(q);
-      QUEUE_INIT(q);  /* Signal uv_cancel() that the work req is
-                             executing. */
+    while (queue_empty(queue) &&
+           queue->nthreads <= queue->size &&
+           !exiting) {
+      queue->idle_threads += 1;
+      uv_cond_wait(&queue->cond, &mutex);
+      queue->idle_threads -= 1;
     }
 
-    uv_mutex_unlock(&mutex);
-
-    if (q == &exit_message)
+    /* The queue was shrunk, or the process is exiting and there is no work
+     * left. The thread is joined when its slot is reused, or on exit.
+     */
+    if (queue->nthreads > queue->size || queue_empty(queue)) {
+      queue->nthreads -= 1;
+      slot->state = SLOT_EXITED;
+      uv_mutex_unlock(&mutex);
       break;
+    }
+
+    q = next_work(queue);
+    QUEUE_REMOVE(q);
+    QUEUE_INIT(q);  /* Signal uv_cancel() that the work req is
+                           executing. */
 
     w = QUEUE_DATA(q, struct uv__work, wq);
+    start_time = uv_hrtime();
+    s = &stats[w->kind];
+    s->queued -= 1;
+    s->running += 1;
+    s->wait_time += start_time - w->submit_time;
+    if (s->max_wait_time < start_time - w->submit_time)
+      s->max_wait_time = start_time - w->submit_time;
+
+    uv_mutex_unlock(&mutex);
+
+    loop = w->loop;
     w->work(w);
+    run_time = uv_hrtime() - start_time;
+
+    /* A uv_threadpool_task_t has no loop to complete on, and may have been
+     * freed by its callback.
+     */
+    if (loop == NULL)
+      continue;
 
-    uv_mutex_lock(&w->loop->wq_mutex);
-    w->work = NULL;  /* Signal uv_cancel() that the work req is done
-                        executing. */
-    QUEUE_INSERT_TAIL(&w->loop->wq, &w->wq);
-    uv_async_send(&w->loop->wq_async);
-    uv_mutex_unlock(&w->loop->wq_mutex);
+    w->work = NULL;
+    if (uv__mpsc_push(&loop->wq_done, &w->done_next))
+      uv_async_send(&loop->wq_async);
   }
 }
 
 
-static void post(QUEUE* q) {
+/* Must be called with the mutex held. */
+static void start_threads(struct work_queue* queue) {
+  struct worker_slot* slot;
+  unsigned int i;
+
+  for (i = 0; i < ARRAY_SIZE(slots) && queue->nthreads < queue->size; i++) {
+    slot = slots + i;
+    if (slot->state == SLOT_RUNNING)
+      continue;
+
+    if (slot->state == SLOT_EXITED)
+      if (uv_thread_join(&slot->thread))
+        abort();
+
+    slot->queue = queue;
+    slot->state = SLOT_RUNNING;
+    queue->nthreads += 1;
+    if (uv_thread_create(&slot->thread, worker, slot))
+      abort();
+
+    /* Best effort, the thread runs all the same when it fails. */
+    if (queue->affinity != NULL)
+      uv_thread_setaffinity(&slot->thread,
+                            queue->affinity,
+                            NULL,
+                            uv_cpumask_size());
+  }
+}
+
+
+static int valid_queue(uv_threadpool_queue kind) {
+  return kind == UV_THREADPOOL_CPU ||
+         kind == UV_THREADPOOL_FS ||
+         kind == UV_THREADPOOL_DNS ||
+         kind == UV_THREADPOOL_CRYPTO;
+}
+
+
+static struct work_queue* get_queue(uv_threadpool_queue kind) {
+  if (queues[kind].size == 0)
+    return &queues[UV_THREADPOOL_CPU];
+  return &queues[kind];
+}
+
+
+static void post(QUEUE* q,
+                 uv_threadpool_queue kind,
+                 uv_work_priority priority) {
+  struct work_queue* queue;
+  uv_threadpool_stats_t* s;
+
   uv_mutex_lock(&mutex);
-  QUEUE_INSERT_TAIL(&wq, q);
-  if (idle_threads > 0)
-    uv_cond_signal(&cond);
+  s = &stats[kind];
+  s->submitted += 1;
+  s->queued += 1;
+  if (s->max_queued < s->queued)
+    s->max_queued = s->queued;
+
+  queue = get_queue(kind);
+  if (queue->nthreads < queue->size)
+    start_threads(queue);
+  QUEUE_INSERT_TAIL(&queue->wq[priority], q);
+  if (queue->idle_threads > 0)
+    uv_cond_signal(&queue->cond);
   uv_mutex_unlock(&mutex);
 }
 
@@ -120,72 +295,208 @@ UV_DESTRUCTOR(static void cleanup(void)) {
   if (initialized == 0)
     return;
 
-  post(&exit_message);
+  uv_mutex_lock(&mutex);
+  exiting = 1;
+  for (i = 0; i < ARRAY_SIZE(queues); i++)
+    uv_cond_broadcast(&queues[i].cond);
+  uv_mutex_unlock(&mutex);
 
-  for (i = 0; i < nthreads; i++)
-    if (uv_thread_join(threads + i))
+  for (i = 0; i < ARRAY_SIZE(slots); i++) {
+    if (slots[i].state == SLOT_UNUSED)
+      continue;
+    if (uv_thread_join(&slots[i].thread))
       abort();
+    slots[i].state = SLOT_UNUSED;
+  }
 
-  if (threads != default_threads)
-    uv__free(threads);
-
+  for (i = 0; i < ARRAY_SIZE(queues); i++) {
+    uv_cond_destroy(&queues[i].cond);
+    uv__free(queues[i].affinity);
+    queues[i].affinity = NULL;
+  }
   uv_mutex_destroy(&mutex);
-  uv_cond_destroy(&cond);
 
-  threads = NULL;
-  nthreads = 0;
+  exiting = 0;
   initialized = 0;
 }
 #endif
 
 
-static void init_once(void) {
-  unsigned int i;
+static unsigned int size_from_env(const char* name, unsigned int size) {
   const char* val;
 
-  nthreads = ARRAY_SIZE(default_threads);
-  val = getenv("UV_THREADPOOL_SIZE");
+  val = getenv(name);
   if (val != NULL)
-    nthreads = atoi(val);
-  if (nthreads == 0)
-    nthreads = 1;
-  if (nthreads > MAX_THREADPOOL_SIZE)
-    nthreads = MAX_THREADPOOL_SIZE;
-
-  threads = default_threads;
-  if (nthreads > ARRAY_SIZE(default_threads)) {
-    threads = uv__malloc(nthreads * sizeof(threads[0]));
-    if (threads == NULL) {
-      nthreads = ARRAY_SIZE(default_threads);
-      threads = default_threads;
-    }
-  }
+    size = atoi(val);
+  if (size > MAX_THREADPOOL_SIZE)
+    size = MAX_THREADPOOL_SIZE;
+  return size;
+}
 
-  if (uv_cond_init(&cond))
-    abort();
+
+static void init_once(void) {
+  unsigned int i;
+  unsigned int j;
 
   if (uv_mutex_init(&mutex))
     abort();
 
-  QUEUE_INIT(&wq);
-
-  for (i = 0; i < nthreads; i++)
-    if (uv_thread_create(threads + i, worker, NULL))
+  for (i = 0; i < ARRAY_SIZE(queues); i++) {
+    if (uv_cond_init(&queues[i].cond))
       abort();
+    for (j = 0; j < UV__PRIORITIES; j++)
+      QUEUE_INIT(&queues[i].wq[j]);
+  }
+
+  queues[UV_THREADPOOL_CPU].size =
+      size_from_env("UV_THREADPOOL_SIZE", DEFAULT_THREADPOOL_SIZE);
+  if (queues[UV_THREADPOOL_CPU].size == 0)
+    queues[UV_THREADPOOL_CPU].size = 1;
+  queues[UV_THREADPOOL_FS].size = size_from_env("UV_THREADPOOL_FS_SIZE", 0);
+  queues[UV_THREADPOOL_DNS].size = size_from_env("UV_THREADPOOL_DNS_SIZE", 0);
+  queues[UV_THREADPOOL_CRYPTO].size =
+      size_from_env("UV_THREADPOOL_CRYPTO_SIZE", 0);
 
   initialized = 1;
 }
 
 
+int uv_threadpool_set_size(uv_threadpool_queue kind, unsigned int size) {
+  struct work_queue* queue;
+  struct work_queue* cpu;
+  unsigned int i;
+
+  if (!valid_queue(kind))
+    return UV_EINVAL;
+  if (size > MAX_THREADPOOL_SIZE || (size == 0 && kind == UV_THREADPOOL_CPU))
+    return UV_EINVAL;
+
+  uv_once(&once, init_once);
+  uv_mutex_lock(&mutex);
+
+  queue = &queues[kind];
+  cpu = &queues[UV_THREADPOOL_CPU];
+  queue->size = size;
+
+  if (size == 0 && !queue_empty(queue)) {
+    /* Hand the pending work over to the shared threads. */
+    for (i = 0; i < UV__PRIORITIES; i++) {
+      if (QUEUE_EMPTY(&queue->wq[i]))
+        continue;
+      QUEUE_ADD(&cpu->wq[i], &queue->wq[i]);
+      QUEUE_INIT(&queue->wq[i]);
+    }
+    if (cpu->nthreads < cpu->size)
+      start_threads(cpu);
+    uv_cond_broadcast(&cpu->cond);
+  } else if (queue->nthreads > 0 && queue->nthreads < size) {
+    start_threads(queue);
+  }
+
+  /* Wake up idle threads so the surplus ones exit. */
+  uv_cond_broadcast(&queue->cond);
+  uv_mutex_unlock(&mutex);
+
+  return 0;
+}
+
+
+int uv_threadpool_get_size(uv_threadpool_queue kind) {
+  int size;
+
+  if (!valid_queue(kind))
+    return UV_EINVAL;
+
+  uv_once(&once, init_once);
+  uv_mutex_lock(&mutex);
+  size = queues[kind].size;
+  uv_mutex_unlock(&mutex);
+
+  return size;
+}
+
+
+int uv_threadpool_set_affinity(uv_threadpool_queue kind,
+                               const char* cpumask,
+                               size_t mask_size) {
+  struct work_queue* queue;
+  struct worker_slot* slot;
+  char* affinity;
+  unsigned int i;
+  int size;
+  int err;
+  int r;
+
+  if (!valid_queue(kind))
+    return UV_EINVAL;
+
+  size = uv_cpumask_size();
+  if (size < 0)
+    return size;
+  if (cpumask != NULL && mask_size < (size_t) size)
+    return UV_EINVAL;
+
+  affinity = NULL;
+  if (cpumask != NULL) {
+    affinity = uv__malloc(size);
+    if (affinity == NULL)
+      return UV_ENOMEM;
+    memcpy(affinity, cpumask, size);
+  }
+
+  uv_once(&once, init_once);
+  uv_mutex_lock(&mutex);
+
+  queue = &queues[kind];
+  uv__free(queue->affinity);
+  queue->affinity = affinity;
+
+  /* Threads that are already running keep their affinity when it is reset. */
+  err = 0;
+  for (i = 0; affinity != NULL && i < ARRAY_SIZE(slots); i++) {
+    slot = slots + i;
+    if (slot->state != SLOT_RUNNING || slot->queue != queue)
+      continue;
+    r = uv_thread_setaffinity(&slot->thread, affinity, NULL, size);
+    if (err == 0)
+      err = r;
+  }
+
+  uv_mutex_unlock(&mutex);
+
+  return err;
+}
+
+
+int uv_threadpool_get_stats(uv_threadpool_queue kind,
+                            uv_threadpool_stats_t* s) {
+  if (!valid_queue(kind))
+    return UV_EINVAL;
+  if (s == NULL)
+    return UV_EINVAL;
+
+  uv_once(&once, init_once);
+  uv_mutex_lock(&mutex);
+  *s = stats[kind];
+  uv_mutex_unlock(&mutex);
+
+  return 0;
+}
+
+
 void uv__work_submit(uv_loop_t* loop,
                      struct uv__work* w,
+                     uv_threadpool_queue kind,
+                     uv_work_priority priority,
                      void (*work)(struct uv__work* w),
                      void (*done)(struct uv__work* w, int status)) {
   uv_once(&once, init_once);
   w->loop = loop;
   w->work = work;
   w->done = done;
-  post(&w->wq);
+  w->kind = kind;
+  w->submit_time = uv_hrtime();
+  post(&w->wq, kind, priority);
 }
 
 
@@ -193,23 +504,25 @@ static int uv__work_cancel(uv_loop_t* loop, uv_req_t* req, struct uv__work* w) {
   int cancelled;
 
   uv_mutex_lock(&mutex);
-  uv_mutex_lock(&w->loop->wq_mutex);
 
-  cancelled = !QUEUE_EMPTY(&w->wq) && w->work != NULL;
-  if (cancelled)
+  /* Workers dequeue requests with the mutex held, a request that is still
+   * linked into a work queue has not started executing yet.
+   */
+  cancelled = !QUEUE_EMPTY(&w->wq);
+  if (cancelled) {
     QUEUE_REMOVE(&w->wq);
+    QUEUE_INIT(&w->wq);
+    stats[w->kind].queued -= 1;
+    w->work = uv__cancelled;
+  }
 
-  uv_mutex_unlock(&w->loop->wq_mutex);
   uv_mutex_unlock(&mutex);
 
   if (!cancelled)
     return UV_EBUSY;
 
-  w->work = uv__cancelled;
-  uv_mutex_lock(&loop->wq_mutex);
-  QUEUE_INSERT_TAIL(&loop->wq, &w->wq);
-  uv_async_send(&loop->wq_async);
-  uv_mutex_unlock(&loop->wq_mutex);
+  if (uv__mpsc_push(&loop->wq_done, &w->done_next))
+    uv_async_send(&loop->wq_async);
 
   return 0;
 }
@@ -218,20 +531,15 @@ static int uv__work_cancel(uv_loop_t* loop, uv_req_t* req, struct uv__work* w) {
 void uv__work_done(uv_async_t* handle) {
   struct uv__work* w;
   uv_loop_t* loop;
-  QUEUE* q;
-  QUEUE wq;
+  void** node;
+  void** next;
   int err;
 
   loop = container_of(handle, uv_loop_t, wq_async);
-  uv_mutex_lock(&loop->wq_mutex);
-  QUEUE_MOVE(&loop->wq, &wq);
-  uv_mutex_unlock(&loop->wq_mutex);
 
-  while (!QUEUE_EMPTY(&wq)) {
-    q = QUEUE_HEAD(&wq);
-    QUEUE_REMOVE(q);
-
-    w = container_of(q, struct uv__work, wq);
+  for (node = uv__mpsc_take(&loop->wq_done); node != NULL; node = next) {
+    next = *node;
+    w = container_of(node, struct uv__work, done_next);
     err = (w->work == uv__cancelled) ? UV_ECANCELED : 0;
     w->done(w, err);
   }
@@ -262,14 +570,80 @@ int uv_queue_work(uv_loop_t* loop,
                   uv_work_t* req,
                   uv_work_cb work_cb,
                   uv_after_work_cb after_work_cb) {
+  return uv_queue_work_priority(loop,
+                                req,
+                                work_cb,
+                                after_work_cb,
+                                UV_PRIORITY_NORMAL);
+}
+
+
+int uv_queue_work_priority(uv_loop_t* loop,
+                           uv_work_t* req,
+                           uv_work_cb work_cb,
+                           uv_after_work_cb after_work_cb,
+                           uv_work_priority priority) {
+  return uv_queue_work_ex(loop,
+                          req,
+                          work_cb,
+                          after_work_cb,
+                          UV_THREADPOOL_CPU,
+                          priority);
+}
+
+
+int uv_queue_work_ex(uv_loop_t* loop,
+                     uv_work_t* req,
+                     uv_work_cb work_cb,
+                     uv_after_work_cb after_work_cb,
+                     uv_threadpool_queue queue,
+                     uv_work_priority priority) {
   if (work_cb == NULL)
     return UV_EINVAL;
+  if (!valid_queue(queue))
+    return UV_EINVAL;
+  if (priority != UV_PRIORITY_HIGH &&
+      priority != UV_PRIORITY_NORMAL &&
+      priority != UV_PRIORITY_LOW)
+    return UV_EINVAL;
 
   uv__req_init(loop, req, UV_WORK);
   req->loop = loop;
   req->work_cb = work_cb;
   req->after_work_cb = after_work_cb;
-  uv__work_submit(loop, &req->work_req, uv__queue_work, uv__queue_done);
+  uv__work_submit(loop,
+                  &req->work_req,
+                  queue,
+                  priority,
+                  uv__queue_work,
+                  uv__queue_done);
+  return 0;
+}
+
+
+static void uv__threadpool_task(struct uv__work* w) {
+  uv_threadpool_task_t* task = container_of(w, uv_threadpool_task_t, work_req);
+
+  task->task_cb(task);
+}
+
+
+int uv_threadpool_submit(uv_threadpool_task_t* task,
+                         uv_threadpool_task_cb task_cb,
+                         uv_threadpool_queue queue,
+                         uv_work_priority priority) {
+  if (task_cb == NULL)
+    return UV_EINVAL;
+  if (!valid_queue(queue))
+    return UV_EINVAL;
+  if (priority != UV_PRIORITY_HIGH &&
+      priority != UV_PRIORITY_NORMAL &&
+      priority != UV_PRIORITY_LOW)
+    return UV_EINVAL;
+
+  task->task_cb = task_cb;
+  uv__work_submit(NULL, &task->work_req, queue, priority,
+                  uv__threadpool_task, NULL);
   return 0;
 }
 
@@ -194,10 +194,12 @@ void uv__io_poll(uv_loop_t* loop, int timeout) {
   count = 48; /* Benchmarks suggest this gives the best throughput. */
 
   for (;;) {
+    uv__metrics_block(loop);
     nfds = pollset_poll(loop->backend_fd,
                         events,
                         ARRAY_SIZE(events),
                         timeout);
+    SAVE_ERRNO(uv__metrics_unblock(loop));
 
     /* Update loop->time unconditionally. It's tempting to skip the update when
      * timeout == 0 (i.e. non-blocking poll) but there is no guarantee that the
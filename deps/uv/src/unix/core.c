@@ -342,17 +342,24 @@ int uv_run(uv_loop_t* loop, uv_run_mode mode) {
 
   while (r != 0 && loop->stop_flag == 0) {
     uv__update_time(loop);
+    uv__metrics_phase(loop, UV_LOOP_PHASE_TIMERS);
     uv__run_timers(loop);
+    uv__metrics_phase(loop, UV_LOOP_PHASE_PENDING);
     ran_pending = uv__run_pending(loop);
+    uv__metrics_phase(loop, UV_LOOP_PHASE_IDLE);
     uv__run_idle(loop);
+    uv__metrics_phase(loop, UV_LOOP_PHASE_PREPARE);
     uv__run_prepare(loop);
 
     timeout = 0;
     if ((mode == UV_RUN_ONCE && !ran_pending) || mode == UV_RUN_DEFAULT)
       timeout = uv_backend_timeout(loop);
 
+    uv__metrics_phase(loop, UV_LOOP_PHASE_POLL);
     uv__io_poll(loop, timeout);
+    uv__metrics_phase(loop, UV_LOOP_PHASE_CHECK);
     uv__run_check(loop);
+    uv__metrics_phase(loop, UV_LOOP_PHASE_CLOSING);
     uv__run_closing_handles(loop);
 
     if (mode == UV_RUN_ONCE) {
@@ -365,9 +372,11 @@ int uv_run(uv_loop_t* loop, uv_run_mode mode) {
        * the check.
        */
       uv__update_time(loop);
+      uv__metrics_phase(loop, UV_LOOP_PHASE_TIMERS);
       uv__run_timers(loop);
     }
 
+    uv__metrics_iteration_done(loop);
     r = uv__loop_alive(loop);
     if (mode == UV_RUN_ONCE || mode == UV_RUN_NOWAIT)
       break;
@@ -841,7 +850,19 @@ void uv__io_start(uv_loop_t* loop, uv__io_t* w, unsigned int events) {
   w->pevents |= events;
   maybe_resize(loop, w->fd + 1);
 
-#if !defined(__sun)
+#if defined(__linux__)
+  /* The epoll backend keeps the events that were stopped in the interest set
+   * until one of them is reported, see uv__io_stop(), so there's nothing to
+   * do when they're started again in the meantime.
+   */
+  if (w->events != 0 && (w->pevents & ~w->events) == 0) {
+    if (!QUEUE_EMPTY(&w->watcher_queue) && w->events == w->pevents) {
+      QUEUE_REMOVE(&w->watcher_queue);
+      QUEUE_INIT(&w->watcher_queue);
+    }
+    return;
+  }
+#elif !defined(__sun)
   /* The event ports backend needs to rearm all file descriptors on each and
    * every tick of the event loop but the other backends allow us to
    * short-circuit here if the event mask is unchanged.
@@ -892,8 +913,16 @@ void uv__io_stop(uv_loop_t* loop, uv__io_t* w, unsigned int events) {
       w->events = 0;
     }
   }
-  else if (QUEUE_EMPTY(&w->watcher_queue))
+  else if (QUEUE_EMPTY(&w->watcher_queue)) {
+#if defined(__linux__)
+    /* Leave the interest set as it is, uv__io_poll() updates it if one of the
+     * events that are no longer watched is reported.
+     */
+    if (w->events != 0 && (w->pevents & ~w->events) == 0)
+      return;
+#endif
     QUEUE_INSERT_TAIL(&loop->watcher_queue, &w->watcher_queue);
+  }
 }
 
 
@@ -109,6 +109,8 @@ int uv_getnameinfo(uv_loop_t* loop,
   if (getnameinfo_cb) {
     uv__work_submit(loop,
                     &req->work_req,
+                    UV_THREADPOOL_DNS,
+                    UV_PRIORITY_HIGH,
                     uv__getnameinfo_work,
                     uv__getnameinfo_done);
     return 0;
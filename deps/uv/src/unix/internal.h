@@ -154,7 +154,9 @@ enum {
   UV_TCP_KEEPALIVE        = 0x800,  /* Turn on keep-alive. */
   UV_TCP_SINGLE_ACCEPT    = 0x1000, /* Only accept() when idle. */
   UV_HANDLE_IPV6          = 0x10000, /* Handle is bound to a IPv6 socket. */
-  UV_UDP_PROCESSING       = 0x20000  /* Handle is running the send callback queue. */
+  UV_UDP_PROCESSING       = 0x20000, /* Handle is running the send callback queue. */
+  UV_HANDLE_UDP_RECVMMSG  = 0x40000, /* Handle receives with recvmmsg(). */
+  UV_HANDLE_UDP_GRO       = 0x80000  /* Handle receives with UDP_GRO. */
 };
 
 /* loop flags */
@@ -228,6 +230,8 @@ int uv_pipe_listen(uv_pipe_t* handle, int backlog, uv_connection_cb cb);
 
 /* timer */
 void uv__run_timers(uv_loop_t* loop);
+int uv__timer_wheel_init(uv_loop_t* loop);
+void uv__timer_wheel_delete(uv_loop_t* loop);
 int uv__next_timeout(const uv_loop_t* loop);
 
 /* signal */
@@ -241,6 +245,19 @@ int uv__kqueue_init(uv_loop_t* loop);
 int uv__platform_loop_init(uv_loop_t* loop);
 void uv__platform_loop_delete(uv_loop_t* loop);
 void uv__platform_invalidate_fd(uv_loop_t* loop, int fd);
+#if defined(__linux__)
+int uv__io_poll_configure(uv_loop_t* loop, unsigned int nevents);
+int uv__io_poll_busy(uv_loop_t* loop, unsigned int usec);
+#endif
+
+/* io_uring */
+#if defined(__linux__)
+int uv__iou_fs_submit(uv_loop_t* loop, uv_fs_t* req);
+void uv__iou_flush(uv_loop_t* loop);
+void uv__iou_delete(uv_loop_t* loop);
+#else
+# define uv__iou_fs_submit(loop, req) 0
+#endif
 
 /* various */
 void uv__async_close(uv_async_t* handle);
@@ -92,6 +92,9 @@ int uv__platform_loop_init(uv_loop_t* loop) {
   loop->backend_fd = fd;
   loop->inotify_fd = -1;
   loop->inotify_watchers = NULL;
+  loop->iou = NULL;
+  loop->poll_events = NULL;
+  loop->npoll_events = 0;
 
   if (fd == -1)
     return -errno;
@@ -101,6 +104,9 @@ int uv__platform_loop_init(uv_loop_t* loop) {
 
 
 void uv__platform_loop_delete(uv_loop_t* loop) {
+  uv__iou_delete(loop);
+  uv__free(loop->poll_events);
+  loop->poll_events = NULL;
   if (loop->inotify_fd == -1) return;
   uv__io_stop(loop, &loop->inotify_read_watcher, UV__POLLIN);
   uv__close(loop->inotify_fd);
@@ -160,6 +166,43 @@ int uv__io_check_fd(uv_loop_t* loop, int fd) {
 }
 
 
+/* Sets the number of events that one epoll_wait() can return, 0 goes back to
+ * the default of 1024.  A larger array lets a busy loop drain more ready file
+ * descriptors per system call.
+ */
+int uv__io_poll_configure(uv_loop_t* loop, unsigned int nevents) {
+  struct uv__epoll_event* events;
+
+  if (nevents > 65536)
+    return -EINVAL;
+
+  /* The events of the current poll are still being dispatched. */
+  if (loop->watchers != NULL && loop->watchers[loop->nwatchers] != NULL)
+    return -EBUSY;
+
+  events = NULL;
+  if (nevents != 0) {
+    events = uv__malloc(nevents * sizeof(*events));
+    if (events == NULL)
+      return -ENOMEM;
+  }
+
+  uv__free(loop->poll_events);
+  loop->poll_events = events;
+  loop->npoll_events = nevents;
+  return 0;
+}
+
+
+int uv__io_poll_busy(uv_loop_t* loop, unsigned int usec) {
+  if (usec > 1000000)
+    return -EINVAL;
+
+  loop->busy_poll = usec;
+  return 0;
+}
+
+
 void uv__io_poll(uv_loop_t* loop, int timeout) {
   /* A bug in kernels < 2.6.37 makes timeouts larger than ~30 minutes
    * effectively infinite on 32 bits architectures.  To avoid blocking
@@ -172,10 +215,13 @@ void uv__io_poll(uv_loop_t* loop, int timeout) {
   static const int max_safe_timeout = 1789569;
   static int no_epoll_pwait;
   static int no_epoll_wait;
-  struct uv__epoll_event events[1024];
+  struct uv__epoll_event default_events[1024];
+  struct uv__epoll_event* events;
   struct uv__epoll_event* pe;
   struct uv__epoll_event e;
   int real_timeout;
+  int poll_timeout;
+  uint64_t spin_until;
   QUEUE* q;
   uv__io_t* w;
   sigset_t sigset;
@@ -184,6 +230,7 @@ void uv__io_poll(uv_loop_t* loop, int timeout) {
   int nevents;
   int count;
   int nfds;
+  int maxevents;
   int fd;
   int op;
   int i;
@@ -193,6 +240,14 @@ void uv__io_poll(uv_loop_t* loop, int timeout) {
     return;
   }
 
+  if (loop->poll_events != NULL) {
+    events = loop->poll_events;
+    maxevents = loop->npoll_events;
+  } else {
+    events = default_events;
+    maxevents = ARRAY_SIZE(default_events);
+  }
+
   while (!QUEUE_EMPTY(&loop->watcher_queue)) {
     q = QUEUE_HEAD(&loop->watcher_queue);
     QUEUE_REMOVE(q);
@@ -211,9 +266,6 @@ void uv__io_poll(uv_loop_t* loop, int timeout) {
     else
       op = UV__EPOLL_CTL_MOD;
 
-    /* XXX Future optimization: do EPOLL_CTL_MOD lazily if we stop watching
-     * events, skip the syscall and squelch the events after epoll_wait().
-     */
     if (uv__epoll_ctl(loop->backend_fd, op, w->fd, &e)) {
       if (errno != EEXIST)
         abort();
@@ -240,34 +292,51 @@ void uv__io_poll(uv_loop_t* loop, int timeout) {
   count = 48; /* Benchmarks suggest this gives the best throughput. */
   real_timeout = timeout;
 
+  /* With UV_LOOP_BUSY_POLL, poll without blocking until there are events or
+   * the time to spin is up, and only block for the rest of the timeout then.
+   * That saves the wakeup latency of the scheduler when events come quickly.
+   */
+  spin_until = 0;
+  if (loop->busy_poll != 0 && timeout != 0)
+    spin_until = uv__hrtime(UV_CLOCK_FAST) + loop->busy_poll * (uint64_t) 1000;
+
   for (;;) {
+    /* Submit the io_uring requests that were queued since the last poll. */
+    uv__iou_flush(loop);
+
     /* See the comment for max_safe_timeout for an explanation of why
      * this is necessary.  Executive summary: kernel bug workaround.
      */
     if (sizeof(int32_t) == sizeof(long) && timeout >= max_safe_timeout)
       timeout = max_safe_timeout;
 
+    poll_timeout = spin_until != 0 ? 0 : timeout;
+
     if (sigmask != 0 && no_epoll_pwait != 0)
       if (pthread_sigmask(SIG_BLOCK, &sigset, NULL))
         abort();
 
+    uv__metrics_block(loop);
+
     if (no_epoll_wait != 0 || (sigmask != 0 && no_epoll_pwait == 0)) {
       nfds = uv__epoll_pwait(loop->backend_fd,
                              events,
-                             ARRAY_SIZE(events),
-                             timeout,
+                             maxevents,
+                             poll_timeout,
                              sigmask);
       if (nfds == -1 && errno == ENOSYS)
         no_epoll_pwait = 1;
     } else {
       nfds = uv__epoll_wait(loop->backend_fd,
                             events,
-                            ARRAY_SIZE(events),
-                            timeout);
+                            maxevents,
+                            poll_timeout);
       if (nfds == -1 && errno == ENOSYS)
         no_epoll_wait = 1;
     }
 
+    SAVE_ERRNO(uv__metrics_unblock(loop));
+
     if (sigmask != 0 && no_epoll_pwait != 0)
       if (pthread_sigmask(SIG_UNBLOCK, &sigset, NULL))
         abort();
@@ -278,6 +347,20 @@ void uv__io_poll(uv_loop_t* loop, int timeout) {
      */
     SAVE_ERRNO(uv__update_time(loop));
 
+    if (nfds == 0 && spin_until != 0 && timeout != 0) {
+      if (timeout != -1 && loop->time - base >= (uint64_t) real_timeout)
+        return;
+
+      if (uv__hrtime(UV_CLOCK_FAST) < spin_until)
+        continue;
+
+      spin_until = 0;
+      if (timeout == -1)
+        continue;
+
+      goto update_timeout;
+    }
+
     if (nfds == 0) {
       assert(timeout != -1);
 
@@ -336,6 +419,19 @@ void uv__io_poll(uv_loop_t* loop, int timeout) {
         continue;
       }
 
+      /* uv__io_stop() leaves the events that a watcher stops watching in the
+       * interest set, which saves a system call for each watcher that starts
+       * and stops them in turn, like a stream whose writes sometimes block.
+       * Now that one of them is reported, drop them or level-triggered epoll
+       * reports them again on each poll.
+       */
+      if (pe->events & ~(w->pevents | UV__POLLERR | UV__POLLHUP)) {
+        e.events = w->pevents;
+        e.data = fd;
+        if (uv__epoll_ctl(loop->backend_fd, UV__EPOLL_CTL_MOD, fd, &e) == 0)
+          w->events = w->pevents;
+      }
+
       /* Give users only events they're interested in. Prevents spurious
        * callbacks when previous callback invocation in this loop has stopped
        * the current watcher. Also, filters out events that users has not
@@ -370,7 +466,7 @@ void uv__io_poll(uv_loop_t* loop, int timeout) {
     loop->watchers[loop->nwatchers + 1] = NULL;
 
     if (nevents != 0) {
-      if (nfds == ARRAY_SIZE(events) && --count != 0) {
+      if (nfds == maxevents && --count != 0) {
         /* Poll for more events but don't block this time. */
         timeout = 0;
         continue;
@@ -0,0 +1,444 @@
+/* Copyright libuv project contributors. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/* Optional io_uring backend for file system requests.
+ *
+ * When UV_USE_IO_URING=1 is set in the environment and the kernel is recent
+ * enough (5.6 or newer), asynchronous open, close, read, write, fsync,
+ * fdatasync, stat, lstat and fstat requests are submitted to a per-loop
+ * io_uring instead of the threadpool.  The ring's file descriptor is watched
+ * by the event loop and completions are reaped from uv__io_poll().
+ *
+ * Requests that cannot be expressed as a single io_uring operation, or that
+ * arrive while the ring is full, silently fall back to the threadpool.
+ */
+
+#include "uv.h"
+#include "internal.h"
+
+#include <assert.h>
+#include <errno.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <sys/mman.h>
+#include <sys/sysmacros.h>
+#include <unistd.h>
+
+#define UV__IOU_ENTRIES 64
+
+struct uv__iou {
+  uv__io_t watcher;
+  uint32_t* sqhead;
+  uint32_t* sqtail;
+  uint32_t* sqarray;
+  uint32_t sqmask;
+  uint32_t* cqhead;
+  uint32_t* cqtail;
+  uint32_t cqmask;
+  struct uv__io_uring_sqe* sqes;
+  struct uv__io_uring_cqe* cqes;
+  void* ring;
+  size_t ringlen;
+  size_t sqelen;
+  unsigned int sqentries;
+  unsigned int cqentries;
+  unsigned int unsubmitted;
+  unsigned int in_flight;
+};
+
+static uv_once_t once = UV_ONCE_INIT;
+static int enabled;
+
+
+static void uv__iou_io(uv_loop_t* loop, uv__io_t* w, unsigned int events);
+
+
+static void init_once(void) {
+  const char* val;
+
+  val = getenv("UV_USE_IO_URING");
+  enabled = (val != NULL && atoi(val) != 0);
+}
+
+
+/* Returns NULL when io_uring isn't available.  A failed setup is remembered
+ * with a sentinel so that the loop doesn't retry on every request.
+ */
+static struct uv__iou* uv__iou_get(uv_loop_t* loop) {
+  struct uv__io_uring_params params;
+  struct uv__iou* iou;
+  uint32_t required;
+  size_t sqlen;
+  size_t cqlen;
+  char* ring;
+  void* sqes;
+  int fd;
+
+  if (loop->iou != NULL)
+    return loop->iou == loop ? NULL : loop->iou;
+
+  uv_once(&once, init_once);
+  loop->iou = loop;  /* Sentinel: unavailable. */
+
+  if (enabled == 0)
+    return NULL;
+
+  memset(&params, 0, sizeof(params));
+  fd = uv__io_uring_setup(UV__IOU_ENTRIES, &params);
+  if (fd == -1)
+    return NULL;
+
+  /* The file position support (-1 offsets) and the openat, close and statx
+   * operations all arrived in 5.6, checking for the feature bit is enough.
+   */
+  required = UV__IORING_FEAT_SINGLE_MMAP |
+             UV__IORING_FEAT_NODROP |
+             UV__IORING_FEAT_RW_CUR_POS;
+  if ((params.features & required) != required)
+    goto fail_fd;
+
+  sqlen = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+  cqlen = params.cq_off.cqes +
+          params.cq_entries * sizeof(struct uv__io_uring_cqe);
+  if (cqlen > sqlen)
+    sqlen = cqlen;
+
+  ring = mmap(NULL,
+              sqlen,
+              PROT_READ | PROT_WRITE,
+              MAP_SHARED | MAP_POPULATE,
+              fd,
+              UV__IORING_OFF_SQ_RING);
+  if (ring == MAP_FAILED)
+    goto fail_fd;
+
+  sqes = mmap(NULL,
+              params.sq_entries * sizeof(struct uv__io_uring_sqe),
+              PROT_READ | PROT_WRITE,
+              MAP_SHARED | MAP_POPULATE,
+              fd,
+              UV__IORING_OFF_SQES);
+  if (sqes == MAP_FAILED)
+    goto fail_ring;
+
+  iou = uv__malloc(sizeof(*iou));
+  if (iou == NULL)
+    goto fail_sqes;
+
+  iou->sqhead = (uint32_t*) (ring + params.sq_off.head);
+  iou->sqtail = (uint32_t*) (ring + params.sq_off.tail);
+  iou->sqarray = (uint32_t*) (ring + params.sq_off.array);
+  iou->sqmask = *(uint32_t*) (ring + params.sq_off.ring_mask);
+  iou->cqhead = (uint32_t*) (ring + params.cq_off.head);
+  iou->cqtail = (uint32_t*) (ring + params.cq_off.tail);
+  iou->cqmask = *(uint32_t*) (ring + params.cq_off.ring_mask);
+  iou->cqes = (struct uv__io_uring_cqe*) (ring + params.cq_off.cqes);
+  iou->sqes = sqes;
+  iou->ring = ring;
+  iou->ringlen = sqlen;
+  iou->sqelen = params.sq_entries * sizeof(struct uv__io_uring_sqe);
+  iou->sqentries = params.sq_entries;
+  iou->cqentries = params.cq_entries;
+  iou->unsubmitted = 0;
+  iou->in_flight = 0;
+
+  uv__io_init(&iou->watcher, uv__iou_io, fd);
+  uv__io_start(loop, &iou->watcher, UV__POLLIN);
+  loop->iou = iou;
+
+  return iou;
+
+fail_sqes:
+  munmap(sqes, params.sq_entries * sizeof(struct uv__io_uring_sqe));
+fail_ring:
+  munmap(ring, sqlen);
+fail_fd:
+  uv__close(fd);
+  return NULL;
+}
+
+
+void uv__iou_delete(uv_loop_t* loop) {
+  struct uv__iou* iou;
+
+  iou = loop->iou;
+  loop->iou = NULL;
+
+  if (iou == NULL || iou == (struct uv__iou*) loop)
+    return;
+
+  uv__io_stop(loop, &iou->watcher, UV__POLLIN);
+  uv__close(iou->watcher.fd);
+  munmap(iou->sqes, iou->sqelen);
+  munmap(iou->ring, iou->ringlen);
+  uv__free(iou);
+}
+
+
+void uv__iou_flush(uv_loop_t* loop) {
+  struct uv__iou* iou;
+  int rc;
+
+  iou = loop->iou;
+  if (iou == NULL || iou == (struct uv__iou*) loop || iou->unsubmitted == 0)
+    return;
+
+  do
+    rc = uv__io_uring_enter(iou->watcher.fd, iou->unsubmitted, 0, 0);
+  while (rc == -1 && errno == EINTR);
+
+  if (rc == -1) {
+    /* Out of kernel resources, the entries stay queued for the next poll. */
+    if (errno == EAGAIN || errno == EBUSY)
+      return;
+    abort();
+  }
+
+  iou->unsubmitted -= rc;
+}
+
+
+static struct uv__io_uring_sqe* uv__iou_get_sqe(struct uv__iou* iou,
+                                                uv_fs_t* req) {
+  struct uv__io_uring_sqe* sqe;
+  uint32_t head;
+  uint32_t tail;
+  uint32_t slot;
+
+  /* Never have more requests in flight than there are completion slots. */
+  if (iou->in_flight >= iou->cqentries)
+    return NULL;
+
+  head = __atomic_load_n(iou->sqhead, __ATOMIC_ACQUIRE);
+  tail = *iou->sqtail;
+  if (tail - head >= iou->sqentries)
+    return NULL;
+
+  slot = tail & iou->sqmask;
+  sqe = &iou->sqes[slot];
+  memset(sqe, 0, sizeof(*sqe));
+  sqe->user_data = (uintptr_t) req;
+
+  return sqe;
+}
+
+
+static void uv__iou_submit(struct uv__iou* iou) {
+  uint32_t tail;
+
+  tail = *iou->sqtail;
+  iou->sqarray[tail & iou->sqmask] = tail & iou->sqmask;
+  __atomic_store_n(iou->sqtail, tail + 1, __ATOMIC_RELEASE);
+
+  iou->unsubmitted++;
+  iou->in_flight++;
+}
+
+
+int uv__iou_fs_submit(uv_loop_t* loop, uv_fs_t* req) {
+  struct uv__io_uring_sqe* sqe;
+  struct uv__iou* iou;
+  void* statxbuf;
+
+  switch (req->fs_type) {
+  case UV_FS_CLOSE:
+  case UV_FS_FDATASYNC:
+  case UV_FS_FSTAT:
+  case UV_FS_FSYNC:
+  case UV_FS_LSTAT:
+  case UV_FS_OPEN:
+  case UV_FS_STAT:
+    break;
+  case UV_FS_READ:
+  case UV_FS_WRITE:
+    if (req->nbufs > (unsigned int) uv__getiovmax())
+      return 0;
+    break;
+  default:
+    return 0;
+  }
+
+  iou = uv__iou_get(loop);
+  if (iou == NULL)
+    return 0;
+
+  statxbuf = NULL;
+  if (req->fs_type == UV_FS_STAT ||
+      req->fs_type == UV_FS_LSTAT ||
+      req->fs_type == UV_FS_FSTAT) {
+    statxbuf = uv__malloc(sizeof(struct uv__statx));
+    if (statxbuf == NULL)
+      return 0;
+  }
+
+  sqe = uv__iou_get_sqe(iou, req);
+  if (sqe == NULL) {
+    uv__free(statxbuf);
+    return 0;
+  }
+
+  switch (req->fs_type) {
+  case UV_FS_CLOSE:
+    sqe->opcode = UV__IORING_OP_CLOSE;
+    sqe->fd = req->file;
+    break;
+  case UV_FS_FDATASYNC:
+  case UV_FS_FSYNC:
+    sqe->opcode = UV__IORING_OP_FSYNC;
+    sqe->fd = req->file;
+    if (req->fs_type == UV_FS_FDATASYNC)
+      sqe->op_flags = UV__IORING_FSYNC_DATASYNC;
+    break;
+  case UV_FS_OPEN:
+    /* Kernels with io_uring all support O_CLOEXEC, no need for the
+     * cloexec_lock dance that uv__fs_open() does.
+     */
+    sqe->opcode = UV__IORING_OP_OPENAT;
+    sqe->fd = UV__AT_FDCWD;
+    sqe->addr = (uintptr_t) req->path;
+    sqe->len = req->mode;
+    sqe->op_flags = req->flags | UV__O_CLOEXEC;
+    break;
+  case UV_FS_READ:
+  case UV_FS_WRITE:
+    sqe->opcode = req->fs_type == UV_FS_READ ? UV__IORING_OP_READV
+                                             : UV__IORING_OP_WRITEV;
+    sqe->fd = req->file;
+    sqe->addr = (uintptr_t) req->bufs;
+    sqe->len = req->nbufs;
+    sqe->off = req->off < 0 ? (uint64_t) -1 : (uint64_t) req->off;
+    break;
+  default:
+    sqe->opcode = UV__IORING_OP_STATX;
+    sqe->off = (uintptr_t) statxbuf;
+    sqe->len = UV__STATX_BASIC_STATS;
+    if (req->fs_type == UV_FS_FSTAT) {
+      sqe->fd = req->file;
+      sqe->addr = (uintptr_t) "";
+      sqe->op_flags = UV__AT_EMPTY_PATH;
+    } else {
+      sqe->fd = UV__AT_FDCWD;
+      sqe->addr = (uintptr_t) req->path;
+      if (req->fs_type == UV_FS_LSTAT)
+        sqe->op_flags = UV__AT_SYMLINK_NOFOLLOW;
+    }
+    req->ptr = statxbuf;
+    break;
+  }
+
+  /* Make uv_cancel() report UV_EBUSY, the kernel owns the request now. */
+  req->work_req.loop = loop;
+  req->work_req.work = NULL;
+  QUEUE_INIT(&req->work_req.wq);
+
+  uv__iou_submit(iou);
+
+  return 1;
+}
+
+
+static void uv__iou_statx_to_stat(const struct uv__statx* src,
+                                  uv_stat_t* dst) {
+  dst->st_dev = makedev(src->stx_dev_major, src->stx_dev_minor);
+  dst->st_mode = src->stx_mode;
+  dst->st_nlink = src->stx_nlink;
+  dst->st_uid = src->stx_uid;
+  dst->st_gid = src->stx_gid;
+  dst->st_rdev = makedev(src->stx_rdev_major, src->stx_rdev_minor);
+  dst->st_ino = src->stx_ino;
+  dst->st_size = src->stx_size;
+  dst->st_blksize = src->stx_blksize;
+  dst->st_blocks = src->stx_blocks;
+  dst->st_atim.tv_sec = src->stx_atime.tv_sec;
+  dst->st_atim.tv_nsec = src->stx_atime.tv_nsec;
+  dst->st_mtim.tv_sec = src->stx_mtime.tv_sec;
+  dst->st_mtim.tv_nsec = src->stx_mtime.tv_nsec;
+  dst->st_ctim.tv_sec = src->stx_ctime.tv_sec;
+  dst->st_ctim.tv_nsec = src->stx_ctime.tv_nsec;
+  /* Report the change time like the stat(2) code path does, so results
+   * don't depend on which backend served the request.
+   */
+  dst->st_birthtim.tv_sec = src->stx_ctime.tv_sec;
+  dst->st_birthtim.tv_nsec = src->stx_ctime.tv_nsec;
+  dst->st_flags = 0;
+  dst->st_gen = 0;
+}
+
+
+static void uv__iou_fs_done(uv_fs_t* req, int res) {
+  req->result = res;
+
+  switch (req->fs_type) {
+  case UV_FS_READ:
+  case UV_FS_WRITE:
+    if (req->bufs != req->bufsml)
+      uv__free(req->bufs);
+    req->bufs = NULL;
+    req->nbufs = 0;
+    break;
+  case UV_FS_FSTAT:
+  case UV_FS_LSTAT:
+  case UV_FS_STAT:
+    if (res == 0)
+      uv__iou_statx_to_stat(req->ptr, &req->statbuf);
+    uv__free(req->ptr);
+    req->ptr = res == 0 ? &req->statbuf : NULL;
+    break;
+  default:
+    break;
+  }
+
+  uv__req_unregister(req->loop, req);
+  req->cb(req);
+}
+
+
+static void uv__iou_io(uv_loop_t* loop, uv__io_t* w, unsigned int events) {
+  struct uv__io_uring_cqe* cqe;
+  struct uv__iou* iou;
+  uv_fs_t* req;
+  uint32_t head;
+  uint32_t tail;
+  int res;
+
+  iou = container_of(w, struct uv__iou, watcher);
+
+  head = *iou->cqhead;
+  tail = __atomic_load_n(iou->cqtail, __ATOMIC_ACQUIRE);
+
+  while (head != tail) {
+    cqe = &iou->cqes[head & iou->cqmask];
+    req = (uv_fs_t*) (uintptr_t) cqe->user_data;
+    res = cqe->res;
+
+    /* Release the slot before running the callback, it may submit more. */
+    head++;
+    __atomic_store_n(iou->cqhead, head, __ATOMIC_RELEASE);
+    iou->in_flight--;
+
+    uv__iou_fs_done(req, res);
+
+    if (head == tail)
+      tail = __atomic_load_n(iou->cqtail, __ATOMIC_ACQUIRE);
+  }
+}
@@ -237,6 +237,25 @@
 # endif
 #endif /* __NR_pwritev */
 
+/* io_uring was added after the syscall tables were unified, most
+ * architectures share the same numbers.
+ */
+#ifndef __NR_io_uring_setup
+# if defined(__x86_64__) || defined(__i386__) || defined(__aarch64__)
+#  define __NR_io_uring_setup 425
+# elif defined(__arm__)
+#  define __NR_io_uring_setup (UV_SYSCALL_BASE + 425)
+# endif
+#endif /* __NR_io_uring_setup */
+
+#ifndef __NR_io_uring_enter
+# if defined(__x86_64__) || defined(__i386__) || defined(__aarch64__)
+#  define __NR_io_uring_enter 426
+# elif defined(__arm__)
+#  define __NR_io_uring_enter (UV_SYSCALL_BASE + 426)
+# endif
+#endif /* __NR_io_uring_enter */
+
 
 int uv__accept4(int fd, struct sockaddr* addr, socklen_t* addrlen, int flags) {
 #if defined(__i386__)
@@ -469,3 +488,31 @@ int uv__dup3(int oldfd, int newfd, int flags) {
   return errno = ENOSYS, -1;
 #endif
 }
+
+
+int uv__io_uring_setup(unsigned int entries, struct uv__io_uring_params* p) {
+#if defined(__NR_io_uring_setup)
+  return syscall(__NR_io_uring_setup, entries, p);
+#else
+  return errno = ENOSYS, -1;
+#endif
+}
+
+
+int uv__io_uring_enter(int fd,
+                       unsigned int to_submit,
+                       unsigned int min_complete,
+                       unsigned int flags) {
+#if defined(__NR_io_uring_enter)
+  /* The last two arguments are the signal mask and its size. */
+  return syscall(__NR_io_uring_enter,
+                 fd,
+                 to_submit,
+                 min_complete,
+                 flags,
+                 NULL,
+                 0L);
+#else
+  return errno = ENOSYS, -1;
+#endif
+}
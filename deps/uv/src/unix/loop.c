@@ -34,7 +34,6 @@ int uv_loop_init(uv_loop_t* loop) {
 
   memset(loop, 0, sizeof(*loop));
   heap_init((struct heap*) &loop->timer_heap);
-  QUEUE_INIT(&loop->wq);
   QUEUE_INIT(&loop->active_reqs);
   QUEUE_INIT(&loop->idle_handles);
   QUEUE_INIT(&loop->async_handles);
@@ -57,6 +56,7 @@ int uv_loop_init(uv_loop_t* loop) {
   loop->emfile_fd = -1;
 
   loop->timer_counter = 0;
+  loop->timer_wheel = NULL;
   loop->stop_flag = 0;
 
   err = uv__platform_loop_init(loop);
@@ -75,10 +75,6 @@ int uv_loop_init(uv_loop_t* loop) {
   if (err)
     goto fail_rwlock_init;
 
-  err = uv_mutex_init(&loop->wq_mutex);
-  if (err)
-    goto fail_mutex_init;
-
   err = uv_async_init(loop, &loop->wq_async, uv__work_done);
   if (err)
     goto fail_async_init;
@@ -89,9 +85,6 @@ int uv_loop_init(uv_loop_t* loop) {
   return 0;
 
 fail_async_init:
-  uv_mutex_destroy(&loop->wq_mutex);
-
-fail_mutex_init:
   uv_rwlock_destroy(&loop->cloexec_lock);
 
 fail_rwlock_init:
@@ -108,6 +101,7 @@ void uv__loop_close(uv_loop_t* loop) {
   uv__signal_loop_cleanup(loop);
   uv__platform_loop_delete(loop);
   uv__async_stop(loop, &loop->async_watcher);
+  uv__timer_wheel_delete(loop);
 
   if (loop->emfile_fd != -1) {
     uv__close(loop->emfile_fd);
@@ -119,11 +113,8 @@ void uv__loop_close(uv_loop_t* loop) {
     loop->backend_fd = -1;
   }
 
-  uv_mutex_lock(&loop->wq_mutex);
-  assert(QUEUE_EMPTY(&loop->wq) && "thread pool work queue not empty!");
+  assert(loop->wq_done == NULL && "thread pool work queue not empty!");
   assert(!uv__has_active_reqs(loop));
-  uv_mutex_unlock(&loop->wq_mutex);
-  uv_mutex_destroy(&loop->wq_mutex);
 
   /*
    * Note that all thread pool stuff is finished at this point and
@@ -144,6 +135,16 @@ void uv__loop_close(uv_loop_t* loop) {
 
 
 int uv__loop_configure(uv_loop_t* loop, uv_loop_option option, va_list ap) {
+#if defined(__linux__)
+  if (option == UV_LOOP_POLL_EVENTS)
+    return uv__io_poll_configure(loop, va_arg(ap, unsigned int));
+  if (option == UV_LOOP_BUSY_POLL)
+    return uv__io_poll_busy(loop, va_arg(ap, unsigned int));
+#endif
+
+  if (option == UV_LOOP_TIMER_WHEEL)
+    return uv__timer_wheel_init(loop);
+
   if (option != UV_LOOP_BLOCK_SIGNAL)
     return UV_ENOSYS;
 
@@ -44,6 +44,27 @@ extern char **environ;
 # include <grp.h>
 #endif
 
+/* posix_spawn() is a fast path for the spawns that don't need the child to
+ * run code of its own between fork() and exec(). Where it is implemented
+ * with vfork() or clone(CLONE_VM), its cost doesn't grow with the size of
+ * the parent, and where it reports exec() errors directly, the signal pipe
+ * isn't needed either. That is glibc 2.24 and newer, and macOS.
+ */
+#if defined(__APPLE__) && !(TARGET_OS_TV || TARGET_OS_WATCH)
+# define UV__HAVE_POSIX_SPAWN 1
+#elif defined(__linux__) && defined(__GLIBC__) && \
+    (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 24))
+# define UV__HAVE_POSIX_SPAWN 1
+# if __GLIBC__ > 2 || __GLIBC_MINOR__ >= 29
+#  define UV__HAVE_POSIX_SPAWN_CHDIR 1
+# endif
+#endif
+
+#ifdef UV__HAVE_POSIX_SPAWN
+# include <spawn.h>
+# include <string.h>
+#endif
+
 
 static void uv__chld(uv_signal_t* handle, int signum) {
   uv_process_t* process;
@@ -383,6 +404,159 @@ static void uv__process_child_init(const uv_process_options_t* options,
 #endif
 
 
+#ifdef UV__HAVE_POSIX_SPAWN
+static const char* uv__process_env_path(char** env) {
+  for (; *env != NULL; env++)
+    if (strncmp(*env, "PATH=", 5) == 0)
+      return *env + 5;
+  return NULL;
+}
+
+
+/* Does what uv__process_child_init() does with file actions and starts the
+ * child with posix_spawn(). Returns UV_ENOSYS without starting anything if
+ * the options need fork(), otherwise 0 or the error of exec() or of one of
+ * the file actions.
+ */
+static int uv__process_posix_spawn(const uv_process_options_t* options,
+                                   int stdio_count,
+                                   int (*pipes)[2],
+                                   pid_t* pid) {
+  posix_spawn_file_actions_t actions;
+  const char* env_path;
+  const char* path;
+  char** env;
+  int* dups;
+  int use_fd;
+  int fd;
+  int i;
+  int err;
+
+  if (options->flags & (UV_PROCESS_DETACHED |
+                        UV_PROCESS_SETUID |
+                        UV_PROCESS_SETGID)) {
+    return UV_ENOSYS;
+  }
+
+#ifndef UV__HAVE_POSIX_SPAWN_CHDIR
+  if (options->cwd != NULL)
+    return UV_ENOSYS;
+#endif
+
+  /* posix_spawnp() searches the PATH of the parent, execvp() in the child
+   * the one of the new environment.
+   */
+  env = options->env != NULL ? options->env : environ;
+  if (strchr(options->file, '/') == NULL && env != environ) {
+    env_path = uv__process_env_path(env);
+    path = getenv("PATH");
+    if (env_path == NULL || path == NULL || strcmp(env_path, path) != 0)
+      return UV_ENOSYS;
+  }
+
+  /* An fd that is inherited under its own number keeps FD_CLOEXEC, which the
+   * child would otherwise clear.
+   */
+  for (fd = 0; fd < stdio_count; fd++) {
+    if (pipes[fd][1] == fd && (fcntl(fd, F_GETFD) & FD_CLOEXEC))
+      return UV_ENOSYS;
+  }
+
+  dups = uv__malloc(stdio_count * sizeof(*dups));
+  if (dups == NULL)
+    return -ENOMEM;
+  for (fd = 0; fd < stdio_count; fd++)
+    dups[fd] = -1;
+
+  err = posix_spawn_file_actions_init(&actions);
+  if (err != 0) {
+    uv__free(dups);
+    return -err;
+  }
+
+  /* As in uv__process_child_init(), low numbered fds that are about to be
+   * replaced are duplicated first. The copies are made in the parent and
+   * close on exec.
+   */
+  for (fd = 0; fd < stdio_count; fd++) {
+    use_fd = pipes[fd][1];
+    if (use_fd < 0 || use_fd >= fd)
+      continue;
+    dups[fd] = fcntl(use_fd, F_DUPFD, stdio_count);
+    if (dups[fd] == -1) {
+      err = errno;
+      goto out;
+    }
+    uv__cloexec(dups[fd], 1);
+  }
+
+  for (fd = 0; fd < stdio_count && err == 0; fd++) {
+    use_fd = dups[fd] != -1 ? dups[fd] : pipes[fd][1];
+
+    if (use_fd < 0) {
+      if (fd < 3)
+        err = posix_spawn_file_actions_addopen(&actions,
+                                               fd,
+                                               "/dev/null",
+                                               fd == 0 ? O_RDONLY : O_RDWR,
+                                               0);
+      continue;
+    }
+
+    /* The child's stdio is blocking. The flag belongs to the open file
+     * description that the parent shares, so it is cleared here, where the
+     * child would have cleared it too.
+     */
+    if (fd <= 2)
+      uv__nonblock(use_fd, 0);
+
+    if (fd != use_fd)
+      err = posix_spawn_file_actions_adddup2(&actions, use_fd, fd);
+  }
+
+  /* Close the fds above the stdio range once, even if they are used twice. */
+  for (fd = 0; fd < stdio_count && err == 0; fd++) {
+    use_fd = pipes[fd][1];
+    if (use_fd < stdio_count)
+      continue;
+    for (i = 0; i < fd; i++)
+      if (pipes[i][1] == use_fd)
+        break;
+    if (i == fd)
+      err = posix_spawn_file_actions_addclose(&actions, use_fd);
+  }
+
+#ifdef UV__HAVE_POSIX_SPAWN_CHDIR
+  if (err == 0 && options->cwd != NULL)
+    err = posix_spawn_file_actions_addchdir_np(&actions, options->cwd);
+#endif
+
+  if (err == 0) {
+    if (strchr(options->file, '/') != NULL)
+      err = posix_spawn(pid, options->file, &actions, NULL,
+                        options->args, env);
+    else
+      err = posix_spawnp(pid, options->file, &actions, NULL,
+                         options->args, env);
+  }
+
+  /* execvp() runs a file without a #! line with /bin/sh, posix_spawn()
+   * doesn't, so that case is left to fork().
+   */
+  if (err == ENOEXEC)
+    err = -UV_ENOSYS;
+
+out:
+  posix_spawn_file_actions_destroy(&actions);
+  for (fd = 0; fd < stdio_count; fd++)
+    if (dups[fd] != -1)
+      uv__close(dups[fd]);
+  uv__free(dups);
+  return -err;
+}
+#endif
+
+
 int uv_spawn(uv_loop_t* loop,
              uv_process_t* process,
              const uv_process_options_t* options) {
@@ -430,6 +604,24 @@ int uv_spawn(uv_loop_t* loop,
       goto error;
   }
 
+#ifdef UV__HAVE_POSIX_SPAWN
+  uv_signal_start(&loop->child_watcher, uv__chld, SIGCHLD);
+
+  /* The lock keeps worker threads from opening fds that the child would
+   * inherit, as below.
+   */
+  uv_rwlock_wrlock(&loop->cloexec_lock);
+  exec_errorno = uv__process_posix_spawn(options, stdio_count, pipes, &pid);
+  uv_rwlock_wrunlock(&loop->cloexec_lock);
+
+  if (exec_errorno != UV_ENOSYS) {
+    if (exec_errorno != 0)
+      pid = 0;
+    process->status = 0;
+    goto spawned;
+  }
+#endif
+
   /* This pipe is used by the parent to wait until
    * the child has called `execve()`. We need this
    * to avoid the following race condition:
@@ -500,6 +692,9 @@ int uv_spawn(uv_loop_t* loop,
 
   uv__close_nocheckstdio(signal_pipe[0]);
 
+#ifdef UV__HAVE_POSIX_SPAWN
+spawned:
+#endif
   for (i = 0; i < options->stdio_count; i++) {
     err = uv__process_open_stream(options->stdio + i, pipes[i], i == 0);
     if (err == 0)
@@ -35,6 +35,11 @@
 #include <unistd.h>
 #include <limits.h> /* IOV_MAX */
 
+#if defined(__linux__)
+# include <fcntl.h>
+# include <sys/sendfile.h>
+#endif
+
 #if defined(__APPLE__)
 # include <sys/event.h>
 # include <sys/time.h>
@@ -60,12 +65,42 @@ struct uv__stream_select_s {
 };
 #endif /* defined(__APPLE__) */
 
+#if defined(__linux__)
+/* A uv_splice_start() pipe. The data is moved from the source into a kernel
+ * pipe with splice() and written from there to the sink with a write
+ * request, so it never passes through user space.
+ */
+typedef struct {
+  uv_write_t req;
+  uv_stream_t* source;  /* NULL once the source is no longer read. */
+  uv_stream_t* sink;    /* NULL once nothing more is written to the sink. */
+  uv_splice_cb cb;
+  int fds[2];
+  size_t capacity;  /* Size of the kernel pipe. */
+  size_t buffered;  /* Bytes in the kernel pipe. */
+  size_t writing;   /* Bytes in req, 0 if req is not queued. */
+  int eof;
+} uv__stream_splice_t;
+
+static void uv__sendfile_queue(uv_write_t* req,
+                               uv_stream_t* stream,
+                               uv_file file,
+                               int64_t offset,
+                               size_t length,
+                               uv_write_cb cb);
+static void uv__splice_read(uv_stream_t* stream);
+static void uv__splice_close(uv_stream_t* stream);
+#endif /* defined(__linux__) */
+
 static void uv__stream_connect(uv_stream_t*);
 static void uv__write(uv_stream_t* stream);
 static void uv__read(uv_stream_t* stream);
 static void uv__stream_io(uv_loop_t* loop, uv__io_t* w, unsigned int events);
 static void uv__write_callbacks(uv_stream_t* stream);
 static size_t uv__write_req_size(uv_write_t* req);
+static void uv__write_queue(uv_stream_t* stream,
+                            uv_write_t* req,
+                            int empty_queue);
 
 
 void uv__stream_init(uv_loop_t* loop,
@@ -82,6 +117,8 @@ void uv__stream_init(uv_loop_t* loop,
   stream->shutdown_req = NULL;
   stream->accepted_fd = -1;
   stream->queued_fds = NULL;
+  stream->splice_out = NULL;
+  stream->splice_in = NULL;
   stream->delayed_error = 0;
   QUEUE_INIT(&stream->write_queue);
   QUEUE_INIT(&stream->write_completed_queue);
@@ -739,6 +776,37 @@ static int uv__handle_fd(uv_handle_t* handle) {
   }
 }
 
+static ssize_t uv__write_file(uv_stream_t* stream, uv_write_t* req) {
+#if defined(__linux__)
+  ssize_t n;
+  off_t off;
+
+  /* The remaining length is tracked in bufs[0] so that the write queue
+   * accounting is the same as for regular writes.
+   */
+  if (req->send_offset < 0) {
+    /* A pipe, see uv_splice_start(). */
+    return splice(req->send_file,
+                  NULL,
+                  uv__stream_fd(stream),
+                  NULL,
+                  req->bufs[0].len,
+                  SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+  }
+
+  off = req->send_offset;
+  n = sendfile(uv__stream_fd(stream), req->send_file, &off, req->bufs[0].len);
+  if (n > 0)
+    req->send_offset += n;
+
+  return n;
+#else
+  errno = ENOSYS;
+  return -1;
+#endif
+}
+
+
 static void uv__write(uv_stream_t* stream) {
   struct iovec* iov;
   QUEUE* q;
@@ -777,7 +845,17 @@ start:
    * inside the iov each time we write. So there is no need to offset it.
    */
 
-  if (req->send_handle) {
+  if (req->send_file >= 0) {
+    do
+      n = uv__write_file(stream, req);
+    while (n == -1 && errno == EINTR);
+
+    if (n == 0 && req->bufs[0].len > 0) {
+      /* The file is shorter than the requested length. */
+      req->error = UV_EOF;
+      goto error;
+    }
+  } else if (req->send_handle) {
     struct msghdr msg;
     struct cmsghdr *cmsg;
     int fd_to_send = uv__handle_fd((uv_handle_t*) req->send_handle);
@@ -845,12 +923,7 @@ start:
     if (errno != EAGAIN && errno != EWOULDBLOCK) {
       /* Error */
       req->error = -errno;
-      uv__write_req_finish(req);
-      uv__io_stop(stream->loop, &stream->io_watcher, UV__POLLOUT);
-      if (!uv__io_active(&stream->io_watcher, UV__POLLIN))
-        uv__handle_stop(stream);
-      uv__stream_osx_interrupt_select(stream);
-      return;
+      goto error;
     } else if (stream->flags & UV_STREAM_BLOCKING) {
       /* If this is a blocking stream, try again. */
       goto start;
@@ -865,7 +938,8 @@ start:
       assert(req->write_index < req->nbufs);
 
       if ((size_t)n < len) {
-        buf->base += n;
+        if (buf->base != NULL)
+          buf->base += n;
         buf->len -= n;
         stream->write_queue_size -= n;
         n = 0;
@@ -914,6 +988,14 @@ start:
 
   /* Notify select() thread about state change */
   uv__stream_osx_interrupt_select(stream);
+  return;
+
+error:
+  uv__write_req_finish(req);
+  uv__io_stop(stream->loop, &stream->io_watcher, UV__POLLOUT);
+  if (!uv__io_active(&stream->io_watcher, UV__POLLIN))
+    uv__handle_stop(stream);
+  uv__stream_osx_interrupt_select(stream);
 }
 
 
@@ -1114,6 +1196,13 @@ static void uv__read(uv_stream_t* stream) {
 
   is_ipc = stream->type == UV_NAMED_PIPE && ((uv_pipe_t*) stream)->ipc;
 
+#if defined(__linux__)
+  if (stream->splice_out != NULL) {
+    uv__splice_read(stream);
+    return;
+  }
+#endif
+
   /* XXX: Maybe instead of having UV_STREAM_READING we just test if
    * tcp->read_cb is NULL or not?
    */
@@ -1400,8 +1489,17 @@ int uv_write2(uv_write_t* req,
   memcpy(req->bufs, bufs, nbufs * sizeof(bufs[0]));
   req->nbufs = nbufs;
   req->write_index = 0;
+  req->send_file = -1;
   stream->write_queue_size += uv__count_bufs(bufs, nbufs);
 
+  uv__write_queue(stream, req, empty_queue);
+  return 0;
+}
+
+
+static void uv__write_queue(uv_stream_t* stream,
+                            uv_write_t* req,
+                            int empty_queue) {
   /* Append the request to write_queue. */
   QUEUE_INSERT_TAIL(&stream->write_queue, &req->queue);
 
@@ -1425,8 +1523,357 @@ int uv_write2(uv_write_t* req,
     uv__io_start(stream->loop, &stream->io_watcher, UV__POLLOUT);
     uv__stream_osx_interrupt_select(stream);
   }
+}
+
+
+/* Queues `length` bytes of `file`, starting at `offset`, for writing to the
+ * stream. The data is copied by the kernel with sendfile(); it is ordered
+ * with respect to regular writes like any other write request.
+ */
+int uv_sendfile(uv_write_t* req,
+                uv_stream_t* stream,
+                uv_file file,
+                int64_t offset,
+                size_t length,
+                uv_write_cb cb) {
+#if defined(__linux__)
+  if (stream->type != UV_TCP &&
+      stream->type != UV_NAMED_PIPE &&
+      stream->type != UV_TTY)
+    return -EINVAL;
+
+  if (uv__stream_fd(stream) < 0)
+    return -EBADF;
+
+  if (file < 0 || offset < 0)
+    return -EINVAL;
+
+  uv__sendfile_queue(req, stream, file, offset, length, cb);
+  return 0;
+#else
+  return -ENOSYS;
+#endif
+}
+
+
+#if defined(__linux__)
+/* A negative `offset` makes the request splice() from `file`, which must be
+ * a pipe then.
+ */
+static void uv__sendfile_queue(uv_write_t* req,
+                               uv_stream_t* stream,
+                               uv_file file,
+                               int64_t offset,
+                               size_t length,
+                               uv_write_cb cb) {
+  int empty_queue;
+
+  /* See uv_write2(). */
+  empty_queue = (stream->write_queue_size == 0);
+
+  uv__req_init(stream->loop, req, UV_WRITE);
+  req->cb = cb;
+  req->handle = stream;
+  req->error = 0;
+  req->send_handle = NULL;
+  QUEUE_INIT(&req->queue);
+
+  req->bufs = req->bufsml;
+  req->bufs[0].base = NULL;
+  req->bufs[0].len = length;
+  req->nbufs = 1;
+  req->write_index = 0;
+  req->send_file = file;
+  req->send_offset = offset;
+  stream->write_queue_size += length;
+
+  uv__write_queue(stream, req, empty_queue);
+}
+
+
+static void uv__splice_write_cb(uv_write_t* req, int status);
+
+
+static void uv__splice_free(uv__stream_splice_t* s) {
+  assert(s->source == NULL);
+  assert(s->sink == NULL);
+  assert(s->writing == 0);
+  uv__close(s->fds[0]);
+  uv__close(s->fds[1]);
+  uv__free(s);
+}
+
+
+static void uv__splice_detach_source(uv__stream_splice_t* s) {
+  uv_stream_t* source;
+
+  source = s->source;
+  if (source == NULL)
+    return;
+
+  uv__io_stop(source->loop, &source->io_watcher, UV__POLLIN);
+  if (!uv__io_active(&source->io_watcher, UV__POLLOUT))
+    uv__handle_stop(source);
+  source->splice_out = NULL;
+  s->source = NULL;
+}
+
+
+static void uv__splice_detach_sink(uv__stream_splice_t* s) {
+  if (s->sink == NULL)
+    return;
+
+  s->sink->splice_in = NULL;
+  s->sink = NULL;
+}
+
+
+/* Ends the splice. A request that is still queued on the sink completes on
+ * its own and frees the state then. The callback isn't called for a splice
+ * that has been stopped.
+ */
+static void uv__splice_finish(uv__stream_splice_t* s,
+                              int read_status,
+                              int write_status) {
+  uv_stream_t* source;
+  uv_splice_cb cb;
+
+  source = s->source;
+  cb = s->cb;
+  uv__splice_detach_source(s);
+  uv__splice_detach_sink(s);
+  if (s->writing == 0)
+    uv__splice_free(s);
+
+  if (source != NULL && cb != NULL)
+    cb(source, read_status, write_status);
+}
+
+
+/* Queues what is in the kernel pipe for writing to the sink, unless a write
+ * is queued already.
+ */
+static void uv__splice_flush(uv__stream_splice_t* s) {
+  if (s->sink == NULL || s->writing != 0 || s->buffered == 0)
+    return;
+
+  s->writing = s->buffered;
+  uv__sendfile_queue(&s->req,
+                     s->sink,
+                     s->fds[0],
+                     -1,
+                     s->writing,
+                     uv__splice_write_cb);
+}
+
+
+static void uv__splice_write_cb(uv_write_t* req, int status) {
+  uv__stream_splice_t* s;
+  uv_stream_t* source;
+
+  s = container_of(req, uv__stream_splice_t, req);
+  s->buffered -= s->writing;
+  s->writing = 0;
+
+  /* The splice is over, the sink may even be closed already. */
+  if (s->sink == NULL) {
+    uv__splice_free(s);
+    return;
+  }
+
+  if (status < 0) {
+    uv__splice_finish(s, 0, status);
+    return;
+  }
+
+  source = s->source;
+  if (source == NULL) {
+    /* Stopped, what has been read already still goes to the sink. */
+    if (s->buffered > 0) {
+      uv__splice_flush(s);
+    } else {
+      uv__splice_detach_sink(s);
+      uv__splice_free(s);
+    }
+    return;
+  }
+
+  if (!s->eof) {
+    /* Reading may have stopped because the kernel pipe was full. */
+    uv__io_start(source->loop, &source->io_watcher, UV__POLLIN);
+  }
+
+  uv__splice_flush(s);
+  if (s->eof && s->writing == 0)
+    uv__splice_finish(s, UV_EOF, 0);
+}
+
+
+static void uv__splice_read(uv_stream_t* stream) {
+  uv__stream_splice_t* s;
+  ssize_t n;
+  int count;
+
+  s = stream->splice_out;
+  if (s->eof)
+    return;
+
+  /* See uv__read(). */
+  count = 32;
+
+  while (s->buffered < s->capacity && count-- > 0) {
+    do {
+      n = splice(uv__stream_fd(stream),
+                 NULL,
+                 s->fds[1],
+                 NULL,
+                 s->capacity - s->buffered,
+                 SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+    }
+    while (n < 0 && errno == EINTR);
+
+    if (n < 0) {
+      if (errno != EAGAIN && errno != EWOULDBLOCK) {
+        uv__splice_finish(s, -errno, 0);
+        return;
+      }
+
+      /* Either there is nothing to read, or the kernel pipe ran out of
+       * slots before it ran out of bytes. Wait for the write to the sink
+       * in the latter case, it starts reading again.
+       */
+      if (s->buffered > 0)
+        uv__io_stop(stream->loop, &stream->io_watcher, UV__POLLIN);
+      break;
+    }
+
+    if (n == 0) {
+      s->eof = 1;
+      stream->flags |= UV_STREAM_READ_EOF;
+      uv__io_stop(stream->loop, &stream->io_watcher, UV__POLLIN);
+      break;
+    }
+
+    s->buffered += n;
+  }
+
+  if (s->buffered >= s->capacity)
+    uv__io_stop(stream->loop, &stream->io_watcher, UV__POLLIN);
+
+  uv__splice_flush(s);
+  if (s->eof && s->writing == 0)
+    uv__splice_finish(s, UV_EOF, 0);
+}
+
+
+/* Closing the sink ends the splice, closing the source stops it. Neither
+ * calls the splice callback.
+ */
+static void uv__splice_close(uv_stream_t* stream) {
+  uv__stream_splice_t* s;
+
+  s = stream->splice_in;
+  if (s != NULL) {
+    uv__splice_detach_source(s);
+    uv__splice_detach_sink(s);
+    if (s->writing == 0)
+      uv__splice_free(s);
+  }
+
+  uv_splice_stop(stream);
+}
+#endif /* defined(__linux__) */
+
+
+/* Moves everything that is read from `source` to `sink` in the kernel. See
+ * uv__stream_splice_t.
+ */
+int uv_splice_start(uv_stream_t* source,
+                    uv_stream_t* sink,
+                    uv_splice_cb cb) {
+#if defined(__linux__)
+  uv__stream_splice_t* s;
+  int size;
+  int err;
+
+  if (source == sink)
+    return -EINVAL;
+
+  if ((source->type != UV_TCP &&
+       source->type != UV_NAMED_PIPE &&
+       source->type != UV_TTY) ||
+      (sink->type != UV_TCP &&
+       sink->type != UV_NAMED_PIPE &&
+       sink->type != UV_TTY))
+    return -EINVAL;
+
+  if (uv__is_closing(source) || uv__is_closing(sink))
+    return -EINVAL;
+
+  if (uv__stream_fd(source) < 0 || uv__stream_fd(sink) < 0)
+    return -EBADF;
+
+  if ((source->flags & UV_STREAM_READING) ||
+      source->splice_out != NULL ||
+      sink->splice_in != NULL)
+    return -EBUSY;
+
+  s = uv__malloc(sizeof(*s));
+  if (s == NULL)
+    return -ENOMEM;
+
+  err = uv__make_pipe(s->fds, UV__F_NONBLOCK);
+  if (err) {
+    uv__free(s);
+    return err;
+  }
+
+  size = -1;
+#if defined(F_GETPIPE_SZ)
+  size = fcntl(s->fds[1], F_GETPIPE_SZ);
+#endif
+  s->capacity = size > 0 ? size : 64 * 1024;
+  s->source = source;
+  s->sink = sink;
+  s->cb = cb;
+  s->buffered = 0;
+  s->writing = 0;
+  s->eof = 0;
+  source->splice_out = s;
+  sink->splice_in = s;
+
+  uv__io_start(source->loop, &source->io_watcher, UV__POLLIN);
+  uv__handle_start(source);
 
   return 0;
+#else
+  return -ENOSYS;
+#endif
+}
+
+
+int uv_splice_stop(uv_stream_t* source) {
+#if defined(__linux__)
+  uv__stream_splice_t* s;
+
+  s = source->splice_out;
+  if (s == NULL)
+    return 0;
+
+  uv__splice_detach_source(s);
+
+  /* What has been read already still goes to the sink. */
+  if (s->writing == 0 && s->buffered == 0) {
+    uv__splice_detach_sink(s);
+    uv__splice_free(s);
+  } else {
+    uv__splice_flush(s);
+  }
+
+  return 0;
+#else
+  return -ENOSYS;
+#endif
 }
 
 
@@ -1505,6 +1952,9 @@ int uv_read_start(uv_stream_t* stream,
   if (stream->flags & UV_CLOSING)
     return -EINVAL;
 
+  if (stream->splice_out != NULL)
+    return -EBUSY;
+
   /* The UV_STREAM_READING flag is irrelevant of the state of the tcp - it just
    * expresses the desired state of the user.
    */
@@ -1596,6 +2046,10 @@ void uv__stream_close(uv_stream_t* handle) {
   }
 #endif /* defined(__APPLE__) */
 
+#if defined(__linux__)
+  uv__splice_close(handle);
+#endif
+
   uv__io_close(handle->loop, &handle->io_watcher);
   uv_read_stop(handle);
   uv__handle_stop(handle);
@@ -1626,8 +2080,19 @@ void uv__stream_close(uv_stream_t* handle) {
 
 
 int uv_stream_set_blocking(uv_stream_t* handle, int blocking) {
+  int err;
+
   /* Don't need to check the file descriptor, uv__nonblock()
    * will fail with EBADF if it's not valid.
    */
-  return uv__nonblock(uv__stream_fd(handle), !blocking);
+  err = uv__nonblock(uv__stream_fd(handle), !blocking);
+
+  /* A tty that uv_tty_init() could not reopen is written synchronously.
+   * Once it is non-blocking, writes that don't fit have to be queued like
+   * on any other stream rather than retried in a loop.
+   */
+  if (err == 0 && !blocking)
+    handle->flags &= ~UV_STREAM_BLOCKING;
+
+  return err;
 }
@@ -26,6 +26,7 @@
 #include <unistd.h>
 #include <assert.h>
 #include <errno.h>
+#include <limits.h>
 
 
 static int maybe_new_socket(uv_tcp_t* handle, int domain, int flags) {
@@ -97,6 +98,12 @@ int uv__tcp_bind(uv_tcp_t* tcp,
   if ((flags & UV_TCP_IPV6ONLY) && addr->sa_family != AF_INET6)
     return -EINVAL;
 
+  /* Elsewhere, SO_REUSEPORT doesn't balance connections. */
+#if !defined(SO_REUSEPORT_LB) && !(defined(__linux__) && defined(SO_REUSEPORT))
+  if (flags & UV_TCP_REUSEPORT)
+    return -ENOTSUP;
+#endif
+
   err = maybe_new_socket(tcp,
                          addr->sa_family,
                          UV_STREAM_READABLE | UV_STREAM_WRITABLE);
@@ -107,6 +114,26 @@ int uv__tcp_bind(uv_tcp_t* tcp,
   if (setsockopt(tcp->io_watcher.fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on)))
     return -errno;
 
+  if (flags & UV_TCP_REUSEPORT) {
+#if defined(SO_REUSEPORT_LB)
+    if (setsockopt(tcp->io_watcher.fd,
+                   SOL_SOCKET,
+                   SO_REUSEPORT_LB,
+                   &on,
+                   sizeof(on))) {
+      return -errno;
+    }
+#elif defined(__linux__) && defined(SO_REUSEPORT)
+    if (setsockopt(tcp->io_watcher.fd,
+                   SOL_SOCKET,
+                   SO_REUSEPORT,
+                   &on,
+                   sizeof(on))) {
+      return -errno;
+    }
+#endif
+  }
+
 #ifdef IPV6_V6ONLY
   if (addr->sa_family == AF_INET6) {
     on = (flags & UV_TCP_IPV6ONLY) != 0;
@@ -348,6 +375,29 @@ int uv_tcp_keepalive(uv_tcp_t* handle, int on, unsigned int delay) {
 }
 
 
+int uv_tcp_busy_poll(uv_tcp_t* handle, unsigned int usec) {
+#if defined(__linux__) && defined(SO_BUSY_POLL)
+  int val;
+
+  if (usec > INT_MAX)
+    return -EINVAL;
+
+  val = usec;
+  if (setsockopt(uv__stream_fd(handle),
+                 SOL_SOCKET,
+                 SO_BUSY_POLL,
+                 &val,
+                 sizeof(val))) {
+    return -errno;
+  }
+
+  return 0;
+#else
+  return -ENOTSUP;
+#endif
+}
+
+
 int uv_tcp_simultaneous_accepts(uv_tcp_t* handle, int enable) {
   if (enable)
     handle->flags &= ~UV_TCP_SINGLE_ACCEPT;
@@ -117,6 +117,71 @@ int uv_thread_equal(const uv_thread_t* t1, const uv_thread_t* t2) {
 }
 
 
+int uv_cpumask_size(void) {
+#if defined(__linux__)
+  return CPU_SETSIZE;
+#else
+  return -ENOTSUP;
+#endif
+}
+
+
+int uv_thread_setaffinity(uv_thread_t* tid,
+                          char* cpumask,
+                          char* oldmask,
+                          size_t mask_size) {
+#if defined(__linux__)
+  cpu_set_t cpuset;
+  int err;
+  int i;
+
+  if (mask_size < CPU_SETSIZE)
+    return -EINVAL;
+
+  if (oldmask != NULL) {
+    err = uv_thread_getaffinity(tid, oldmask, mask_size);
+    if (err)
+      return err;
+  }
+
+  CPU_ZERO(&cpuset);
+  for (i = 0; i < CPU_SETSIZE; i++)
+    if (cpumask[i])
+      CPU_SET(i, &cpuset);
+
+  return -pthread_setaffinity_np(*tid, sizeof(cpuset), &cpuset);
+#else
+  return -ENOTSUP;
+#endif
+}
+
+
+int uv_thread_getaffinity(uv_thread_t* tid,
+                          char* cpumask,
+                          size_t mask_size) {
+#if defined(__linux__)
+  cpu_set_t cpuset;
+  int err;
+  int i;
+
+  if (mask_size < CPU_SETSIZE)
+    return -EINVAL;
+
+  CPU_ZERO(&cpuset);
+  err = pthread_getaffinity_np(*tid, sizeof(cpuset), &cpuset);
+  if (err)
+    return -err;
+
+  for (i = 0; i < CPU_SETSIZE; i++)
+    cpumask[i] = !!CPU_ISSET(i, &cpuset);
+
+  return 0;
+#else
+  return -ENOTSUP;
+#endif
+}
+
+
 int uv_mutex_init(uv_mutex_t* mutex) {
 #if defined(NDEBUG) || !defined(PTHREAD_MUTEX_ERRORCHECK)
   return -pthread_mutex_init(mutex, NULL);
@@ -24,6 +24,32 @@
 
 #include <assert.h>
 #include <limits.h>
+#include <stdlib.h>
+
+/* The timer wheel, see UV_LOOP_TIMER_WHEEL, is a hierarchy of wheels of 64
+ * slots with a resolution of 1, 64, 64^2, ... ms.  A timer goes to the lowest
+ * level at which its timeout and the current time of the wheel have the same
+ * slot above, so that the timers in a slot of level 0 are all due at the same
+ * millisecond and those in the higher levels are moved down one level when
+ * the wheel gets to their slot.  Timers are queued in the order in which they
+ * were started, which keeps the order of those that are due at the same time.
+ */
+#define TIMER_WHEEL_BITS 6
+#define TIMER_WHEEL_SLOTS (1 << TIMER_WHEEL_BITS)
+#define TIMER_WHEEL_MASK (TIMER_WHEEL_SLOTS - 1)
+#define TIMER_WHEEL_LEVELS 8  /* Up to 2^48 ms ahead, the rest overflows. */
+
+struct uv__timer_wheel {
+  uint64_t now;  /* The time up to which the wheel has been run. */
+  uint64_t pending[TIMER_WHEEL_LEVELS];  /* Bit masks of non-empty slots. */
+  QUEUE slots[TIMER_WHEEL_LEVELS][TIMER_WHEEL_SLOTS];
+  QUEUE overflow;
+};
+
+/* A timer is in the heap or in the wheel, never in both, so the storage of
+ * its heap node doubles as its queue node in the wheel.
+ */
+#define timer_wheel_node(handle) ((QUEUE*) &(handle)->heap_node)
 
 
 static int timer_less_than(const struct heap_node* ha,
@@ -51,6 +77,240 @@ static int timer_less_than(const struct heap_node* ha,
 }
 
 
+static unsigned int timer_wheel_level(const struct uv__timer_wheel* wheel,
+                                      uint64_t timeout) {
+  uint64_t diff;
+  unsigned int level;
+
+  diff = (wheel->now ^ timeout) >> TIMER_WHEEL_BITS;
+  for (level = 0; diff != 0 && level < TIMER_WHEEL_LEVELS; level++)
+    diff >>= TIMER_WHEEL_BITS;
+
+  return level;
+}
+
+
+static unsigned int timer_wheel_slot(uint64_t timeout, unsigned int level) {
+  return (timeout >> (level * TIMER_WHEEL_BITS)) & TIMER_WHEEL_MASK;
+}
+
+
+/* Index of the lowest bit that is set in a non-zero mask. */
+static unsigned int timer_wheel_first(uint64_t mask) {
+  unsigned int n;
+
+  n = 0;
+  if ((mask & 0xFFFFFFFF) == 0) {
+    n += 32;
+    mask >>= 32;
+  }
+  if ((mask & 0xFFFF) == 0) {
+    n += 16;
+    mask >>= 16;
+  }
+  if ((mask & 0xFF) == 0) {
+    n += 8;
+    mask >>= 8;
+  }
+  if ((mask & 0xF) == 0) {
+    n += 4;
+    mask >>= 4;
+  }
+  if ((mask & 0x3) == 0) {
+    n += 2;
+    mask >>= 2;
+  }
+  if ((mask & 0x1) == 0)
+    n += 1;
+
+  return n;
+}
+
+
+static void timer_wheel_insert(struct uv__timer_wheel* wheel,
+                               uv_timer_t* handle) {
+  unsigned int level;
+  unsigned int slot;
+
+  level = timer_wheel_level(wheel, handle->timeout);
+  if (level == TIMER_WHEEL_LEVELS) {
+    QUEUE_INSERT_TAIL(&wheel->overflow, timer_wheel_node(handle));
+    return;
+  }
+
+  slot = timer_wheel_slot(handle->timeout, level);
+  QUEUE_INSERT_TAIL(&wheel->slots[level][slot], timer_wheel_node(handle));
+  wheel->pending[level] |= (uint64_t) 1 << slot;
+}
+
+
+static void timer_wheel_remove(struct uv__timer_wheel* wheel,
+                               uv_timer_t* handle) {
+  unsigned int level;
+  unsigned int slot;
+
+  QUEUE_REMOVE(timer_wheel_node(handle));
+
+  level = timer_wheel_level(wheel, handle->timeout);
+  if (level == TIMER_WHEEL_LEVELS)
+    return;
+
+  slot = timer_wheel_slot(handle->timeout, level);
+  if (QUEUE_EMPTY(&wheel->slots[level][slot]))
+    wheel->pending[level] &= ~((uint64_t) 1 << slot);
+}
+
+
+/* Finds the slot that the wheel gets to next, which is the slot of the
+ * lowest non-empty level that comes first, and the time at which it starts.
+ * Returns its level, TIMER_WHEEL_LEVELS for the overflow list or -1 if there
+ * are no timers.
+ */
+static int timer_wheel_next(const struct uv__timer_wheel* wheel,
+                            unsigned int* slot,
+                            uint64_t* time) {
+  unsigned int level;
+  unsigned int shift;
+
+  for (level = 0; level < TIMER_WHEEL_LEVELS; level++) {
+    if (wheel->pending[level] == 0)
+      continue;
+
+    shift = level * TIMER_WHEEL_BITS;
+    *slot = timer_wheel_first(wheel->pending[level]);
+    *time = wheel->now >> (shift + TIMER_WHEEL_BITS);
+    *time <<= shift + TIMER_WHEEL_BITS;
+    *time |= (uint64_t) *slot << shift;
+    return level;
+  }
+
+  if (QUEUE_EMPTY(&wheel->overflow))
+    return -1;
+
+  shift = TIMER_WHEEL_LEVELS * TIMER_WHEEL_BITS;
+  *time = wheel->now >> shift;
+  if (*time == ((uint64_t) -1 >> shift))
+    *time = (uint64_t) -1;
+  else
+    *time = (*time + 1) << shift;
+
+  return TIMER_WHEEL_LEVELS;
+}
+
+
+/* The first of the timers that are due next, which is in the slot that the
+ * wheel gets to next.  Only a slot of level 0 holds a single timeout.
+ */
+static uint64_t timer_wheel_min(const struct uv__timer_wheel* wheel,
+                                int level,
+                                unsigned int slot,
+                                uint64_t time) {
+  const QUEUE* head;
+  const QUEUE* q;
+  const uv_timer_t* handle;
+  uint64_t min;
+
+  if (level == 0)
+    return time;
+
+  if (level == TIMER_WHEEL_LEVELS)
+    head = &wheel->overflow;
+  else
+    head = &wheel->slots[level][slot];
+
+  min = (uint64_t) -1;
+  QUEUE_FOREACH(q, head) {
+    handle = QUEUE_DATA(q, const uv_timer_t, heap_node);
+    if (handle->timeout < min)
+      min = handle->timeout;
+  }
+
+  return min;
+}
+
+
+static void timer_wheel_run(uv_loop_t* loop, struct uv__timer_wheel* wheel) {
+  uv_timer_t* handle;
+  unsigned int slot;
+  uint64_t time;
+  QUEUE queue;
+  QUEUE* q;
+  int level;
+
+  for (;;) {
+    level = timer_wheel_next(wheel, &slot, &time);
+    if (level == -1 || time > loop->time)
+      break;
+
+    wheel->now = time;
+
+    if (level == 0) {
+      /* The callbacks may stop and start any timer, including those in this
+       * slot, and those that they start for now join the end of it.
+       */
+      q = &wheel->slots[0][slot];
+      while (!QUEUE_EMPTY(q)) {
+        handle = QUEUE_DATA(QUEUE_HEAD(q), uv_timer_t, heap_node);
+        uv_timer_stop(handle);
+        uv_timer_again(handle);
+        handle->timer_cb(handle);
+      }
+      continue;
+    }
+
+    if (level == TIMER_WHEEL_LEVELS) {
+      QUEUE_MOVE(&wheel->overflow, &queue);
+    } else {
+      QUEUE_MOVE(&wheel->slots[level][slot], &queue);
+      wheel->pending[level] &= ~((uint64_t) 1 << slot);
+    }
+
+    while (!QUEUE_EMPTY(&queue)) {
+      q = QUEUE_HEAD(&queue);
+      QUEUE_REMOVE(q);
+      timer_wheel_insert(wheel, QUEUE_DATA(q, uv_timer_t, heap_node));
+    }
+  }
+
+  /* No slot starts before loop->time, so no timer changes its slot. */
+  wheel->now = loop->time;
+}
+
+
+int uv__timer_wheel_init(uv_loop_t* loop) {
+  struct uv__timer_wheel* wheel;
+  unsigned int level;
+  unsigned int slot;
+
+  if (loop->timer_wheel != NULL)
+    return 0;
+
+  if (heap_min((const struct heap*) &loop->timer_heap) != NULL)
+    return -EBUSY;
+
+  wheel = uv__malloc(sizeof(*wheel));
+  if (wheel == NULL)
+    return -ENOMEM;
+
+  wheel->now = loop->time;
+  for (level = 0; level < TIMER_WHEEL_LEVELS; level++) {
+    wheel->pending[level] = 0;
+    for (slot = 0; slot < TIMER_WHEEL_SLOTS; slot++)
+      QUEUE_INIT(&wheel->slots[level][slot]);
+  }
+  QUEUE_INIT(&wheel->overflow);
+
+  loop->timer_wheel = wheel;
+  return 0;
+}
+
+
+void uv__timer_wheel_delete(uv_loop_t* loop) {
+  uv__free(loop->timer_wheel);
+  loop->timer_wheel = NULL;
+}
+
+
 int uv_timer_init(uv_loop_t* loop, uv_timer_t* handle) {
   uv__handle_init(loop, (uv_handle_t*)handle, UV_TIMER);
   handle->timer_cb = NULL;
@@ -81,9 +341,12 @@ int uv_timer_start(uv_timer_t* handle,
   /* start_id is the second index to be compared in uv__timer_cmp() */
   handle->start_id = handle->loop->timer_counter++;
 
-  heap_insert((struct heap*) &handle->loop->timer_heap,
-              (struct heap_node*) &handle->heap_node,
-              timer_less_than);
+  if (handle->loop->timer_wheel != NULL)
+    timer_wheel_insert(handle->loop->timer_wheel, handle);
+  else
+    heap_insert((struct heap*) &handle->loop->timer_heap,
+                (struct heap_node*) &handle->heap_node,
+                timer_less_than);
   uv__handle_start(handle);
 
   return 0;
@@ -94,9 +357,12 @@ int uv_timer_stop(uv_timer_t* handle) {
   if (!uv__is_active(handle))
     return 0;
 
-  heap_remove((struct heap*) &handle->loop->timer_heap,
-              (struct heap_node*) &handle->heap_node,
-              timer_less_than);
+  if (handle->loop->timer_wheel != NULL)
+    timer_wheel_remove(handle->loop->timer_wheel, handle);
+  else
+    heap_remove((struct heap*) &handle->loop->timer_heap,
+                (struct heap_node*) &handle->heap_node,
+                timer_less_than);
   uv__handle_stop(handle);
 
   return 0;
@@ -129,17 +395,28 @@ uint64_t uv_timer_get_repeat(const uv_timer_t* handle) {
 int uv__next_timeout(const uv_loop_t* loop) {
   const struct heap_node* heap_node;
   const uv_timer_t* handle;
+  unsigned int slot;
+  uint64_t timeout;
   uint64_t diff;
+  int level;
+
+  if (loop->timer_wheel != NULL) {
+    level = timer_wheel_next(loop->timer_wheel, &slot, &timeout);
+    if (level == -1)
+      return -1; /* block indefinitely */
+    timeout = timer_wheel_min(loop->timer_wheel, level, slot, timeout);
+  } else {
+    heap_node = heap_min((const struct heap*) &loop->timer_heap);
+    if (heap_node == NULL)
+      return -1; /* block indefinitely */
+    handle = container_of(heap_node, const uv_timer_t, heap_node);
+    timeout = handle->timeout;
+  }
 
-  heap_node = heap_min((const struct heap*) &loop->timer_heap);
-  if (heap_node == NULL)
-    return -1; /* block indefinitely */
-
-  handle = container_of(heap_node, const uv_timer_t, heap_node);
-  if (handle->timeout <= loop->time)
+  if (timeout <= loop->time)
     return 0;
 
-  diff = handle->timeout - loop->time;
+  diff = timeout - loop->time;
   if (diff > INT_MAX)
     diff = INT_MAX;
 
@@ -151,6 +428,11 @@ void uv__run_timers(uv_loop_t* loop) {
   struct heap_node* heap_node;
   uv_timer_t* handle;
 
+  if (loop->timer_wheel != NULL) {
+    timer_wheel_run(loop, loop->timer_wheel);
+    return;
+  }
+
   for (;;) {
     heap_node = heap_min((struct heap*) &loop->timer_heap);
     if (heap_node == NULL)
@@ -25,6 +25,7 @@
 #include <assert.h>
 #include <string.h>
 #include <errno.h>
+#include <limits.h>
 #include <stdlib.h>
 #include <unistd.h>
 
@@ -36,6 +37,93 @@
 # define IPV6_DROP_MEMBERSHIP IPV6_LEAVE_GROUP
 #endif
 
+#if defined(__linux__)
+# define HAVE_MMSG 1
+# define HAVE_UDP_GSO 1
+# include <netinet/udp.h>
+# ifndef SOL_UDP
+#  define SOL_UDP 17
+# endif
+# ifndef UDP_SEGMENT
+#  define UDP_SEGMENT 103
+# endif
+# ifndef UDP_GRO
+#  define UDP_GRO 104
+# endif
+#endif
+
+/* The largest datagram, and the most datagrams that one recvmmsg() or
+ * sendmmsg() call handles.
+ */
+#define UV__UDP_DGRAM_MAXSIZE (64 * 1024)
+#define UV__MMSG_MAXWIDTH 20
+
+#if HAVE_MMSG
+static uv_once_t once = UV_ONCE_INIT;
+static int uv__recvmmsg_avail;
+static int uv__sendmmsg_avail;
+
+static void uv__udp_mmsg_init(void) {
+  int ret;
+  int s;
+
+  /* Older kernels return ENOSYS, there is no need for a socket that works. */
+  s = uv__socket(AF_INET, SOCK_DGRAM, 0);
+  if (s < 0)
+    return;
+  ret = uv__sendmmsg(s, NULL, 0, 0);
+  if (ret == 0 || errno != ENOSYS) {
+    uv__sendmmsg_avail = 1;
+    uv__recvmmsg_avail = 1;
+  } else {
+    ret = uv__recvmmsg(s, NULL, 0, 0, NULL);
+    if (ret == 0 || errno != ENOSYS)
+      uv__recvmmsg_avail = 1;
+  }
+  uv__close(s);
+}
+#endif
+
+#if HAVE_UDP_GSO
+/* Room for the UDP_SEGMENT and UDP_GRO control messages.  Control messages
+ * are aligned to size_t, see CMSG_ALIGN().  Not struct cmsghdr, that has a
+ * flexible array member and these are used in arrays.
+ */
+typedef union {
+  char buf[CMSG_SPACE(sizeof(int))];
+  size_t align;
+} uv__udp_cmsg_t;
+
+static void uv__udp_set_segment_cmsg(struct msghdr* h,
+                                     uv__udp_cmsg_t* control,
+                                     unsigned int segment_size) {
+  struct cmsghdr* cm;
+  uint16_t size;
+
+  h->msg_control = control->buf;
+  h->msg_controllen = CMSG_SPACE(sizeof(size));
+  cm = CMSG_FIRSTHDR(h);
+  cm->cmsg_level = SOL_UDP;
+  cm->cmsg_type = UDP_SEGMENT;
+  cm->cmsg_len = CMSG_LEN(sizeof(size));
+  size = segment_size;
+  memcpy(CMSG_DATA(cm), &size, sizeof(size));
+}
+
+static unsigned int uv__udp_get_gro_cmsg(struct msghdr* h) {
+  struct cmsghdr* cm;
+  int size;
+
+  for (cm = CMSG_FIRSTHDR(h); cm != NULL; cm = CMSG_NXTHDR(h, cm)) {
+    if (cm->cmsg_level == SOL_UDP && cm->cmsg_type == UDP_GRO) {
+      memcpy(&size, CMSG_DATA(cm), sizeof(size));
+      return size;
+    }
+  }
+  return 0;
+}
+#endif
+
 
 static void uv__udp_run_completed(uv_udp_t* handle);
 static void uv__udp_io(uv_loop_t* loop, uv__io_t* w, unsigned int revents);
@@ -145,8 +233,82 @@ static void uv__udp_io(uv_loop_t* loop, uv__io_t* w, unsigned int revents) {
 }
 
 
+#if HAVE_MMSG
+static int uv__udp_recvmmsg(uv_udp_t* handle, uv_buf_t* buf) {
+  struct sockaddr_in6 peers[UV__MMSG_MAXWIDTH];
+  struct iovec iov[UV__MMSG_MAXWIDTH];
+  struct uv__mmsghdr msgs[UV__MMSG_MAXWIDTH];
+#if HAVE_UDP_GSO
+  uv__udp_cmsg_t control[UV__MMSG_MAXWIDTH];
+#endif
+  ssize_t nread;
+  uv_buf_t chunk_buf;
+  size_t chunks;
+  int flags;
+  size_t k;
+
+  /* prepare structures for recvmmsg */
+  chunks = buf->len / UV__UDP_DGRAM_MAXSIZE;
+  if (chunks > ARRAY_SIZE(iov))
+    chunks = ARRAY_SIZE(iov);
+  for (k = 0; k < chunks; ++k) {
+    iov[k].iov_base = buf->base + k * UV__UDP_DGRAM_MAXSIZE;
+    iov[k].iov_len = UV__UDP_DGRAM_MAXSIZE;
+    memset(&msgs[k].msg_hdr, 0, sizeof(msgs[k].msg_hdr));
+    msgs[k].msg_hdr.msg_iov = iov + k;
+    msgs[k].msg_hdr.msg_iovlen = 1;
+    msgs[k].msg_hdr.msg_name = peers + k;
+    msgs[k].msg_hdr.msg_namelen = sizeof(peers[0]);
+#if HAVE_UDP_GSO
+    if (handle->flags & UV_HANDLE_UDP_GRO) {
+      msgs[k].msg_hdr.msg_control = control[k].buf;
+      msgs[k].msg_hdr.msg_controllen = sizeof(control[k].buf);
+    }
+#endif
+  }
+
+  do
+    nread = uv__recvmmsg(handle->io_watcher.fd, msgs, chunks, 0, NULL);
+  while (nread == -1 && errno == EINTR);
+
+  if (nread < 1) {
+    if (nread == 0 || errno == EAGAIN || errno == EWOULDBLOCK)
+      handle->recv_cb(handle, 0, buf, NULL, 0);
+    else
+      handle->recv_cb(handle, -errno, buf, NULL, 0);
+  } else {
+    /* pass each chunk to the application */
+    for (k = 0; k < (size_t) nread && handle->recv_cb != NULL; k++) {
+      flags = UV_UDP_MMSG_CHUNK;
+      if (msgs[k].msg_hdr.msg_flags & MSG_TRUNC)
+        flags |= UV_UDP_PARTIAL;
+
+      chunk_buf = uv_buf_init(iov[k].iov_base, iov[k].iov_len);
+#if HAVE_UDP_GSO
+      if (handle->flags & UV_HANDLE_UDP_GRO)
+        handle->recv_segment_size = uv__udp_get_gro_cmsg(&msgs[k].msg_hdr);
+#endif
+      handle->recv_cb(handle,
+                      msgs[k].msg_len,
+                      &chunk_buf,
+                      msgs[k].msg_hdr.msg_name,
+                      flags);
+    }
+
+    /* one last callback so the original buffer is freed */
+    handle->recv_segment_size = 0;
+    if (handle->recv_cb != NULL)
+      handle->recv_cb(handle, 0, buf, NULL, UV_UDP_MMSG_FREE);
+  }
+  return nread;
+}
+#endif
+
 static void uv__udp_recvmsg(uv_udp_t* handle) {
   struct sockaddr_storage peer;
+#if HAVE_UDP_GSO
+  uv__udp_cmsg_t control;
+#endif
   struct msghdr h;
   ssize_t nread;
   uv_buf_t buf;
@@ -165,16 +327,31 @@ static void uv__udp_recvmsg(uv_udp_t* handle) {
   h.msg_name = &peer;
 
   do {
-    handle->alloc_cb((uv_handle_t*) handle, 64 * 1024, &buf);
+    handle->alloc_cb((uv_handle_t*) handle, UV__UDP_DGRAM_MAXSIZE, &buf);
     if (buf.len == 0) {
       handle->recv_cb(handle, UV_ENOBUFS, &buf, NULL, 0);
       return;
     }
     assert(buf.base != NULL);
 
+#if HAVE_MMSG
+    if (uv_udp_using_recvmmsg(handle)) {
+      nread = uv__udp_recvmmsg(handle, &buf);
+      if (nread > 0)
+        count -= nread;
+      continue;
+    }
+#endif
+
     h.msg_namelen = sizeof(peer);
     h.msg_iov = (void*) &buf;
     h.msg_iovlen = 1;
+#if HAVE_UDP_GSO
+    if (handle->flags & UV_HANDLE_UDP_GRO) {
+      h.msg_control = control.buf;
+      h.msg_controllen = sizeof(control.buf);
+    }
+#endif
 
     do {
       nread = recvmsg(handle->io_watcher.fd, &h, 0);
@@ -198,7 +375,12 @@ static void uv__udp_recvmsg(uv_udp_t* handle) {
       if (h.msg_flags & MSG_TRUNC)
         flags |= UV_UDP_PARTIAL;
 
+#if HAVE_UDP_GSO
+      if (handle->flags & UV_HANDLE_UDP_GRO)
+        handle->recv_segment_size = uv__udp_get_gro_cmsg(&h);
+#endif
       handle->recv_cb(handle, nread, &buf, addr, flags);
+      handle->recv_segment_size = 0;
     }
   }
   /* recv_cb callback may decide to pause or close the handle */
@@ -209,12 +391,95 @@ static void uv__udp_recvmsg(uv_udp_t* handle) {
 }
 
 
+#if HAVE_MMSG
+static void uv__udp_sendmmsg(uv_udp_t* handle) {
+  uv_udp_send_t* req;
+  struct uv__mmsghdr h[UV__MMSG_MAXWIDTH];
+#if HAVE_UDP_GSO
+  uv__udp_cmsg_t control[UV__MMSG_MAXWIDTH];
+#endif
+  struct uv__mmsghdr *p;
+  QUEUE* q;
+  ssize_t npkts;
+  size_t pkts;
+  size_t i;
+
+  if (QUEUE_EMPTY(&handle->write_queue))
+    return;
+
+write_queue_drain:
+  for (pkts = 0, q = QUEUE_HEAD(&handle->write_queue);
+       pkts < UV__MMSG_MAXWIDTH && q != &handle->write_queue;
+       ++pkts, q = QUEUE_NEXT(q)) {
+    req = QUEUE_DATA(q, uv_udp_send_t, queue);
+
+    p = &h[pkts];
+    memset(p, 0, sizeof(*p));
+    p->msg_hdr.msg_name = &req->addr;
+    p->msg_hdr.msg_namelen = (req->addr.ss_family == AF_INET6 ?
+      sizeof(struct sockaddr_in6) : sizeof(struct sockaddr_in));
+    p->msg_hdr.msg_iov = (struct iovec*) req->bufs;
+    p->msg_hdr.msg_iovlen = req->nbufs;
+#if HAVE_UDP_GSO
+    if (req->segment_size != 0)
+      uv__udp_set_segment_cmsg(&p->msg_hdr, &control[pkts], req->segment_size);
+#endif
+  }
+
+  do
+    npkts = uv__sendmmsg(handle->io_watcher.fd, h, pkts, 0);
+  while (npkts == -1 && errno == EINTR);
+
+  if (npkts < 1) {
+    if (errno == EAGAIN || errno == EWOULDBLOCK || errno == ENOBUFS)
+      return;
+    /* The first datagram failed, the ones after it may still go out. */
+    q = QUEUE_HEAD(&handle->write_queue);
+    req = QUEUE_DATA(q, uv_udp_send_t, queue);
+    req->status = -errno;
+    QUEUE_REMOVE(&req->queue);
+    QUEUE_INSERT_TAIL(&handle->write_completed_queue, &req->queue);
+    uv__io_feed(handle->loop, &handle->io_watcher);
+    if (!QUEUE_EMPTY(&handle->write_queue))
+      goto write_queue_drain;
+    return;
+  }
+
+  /* Sending a datagram is an atomic operation: either all data is written
+   * or nothing is, see uv__udp_sendmsg().
+   */
+  for (i = 0; i < (size_t) npkts; ++i) {
+    q = QUEUE_HEAD(&handle->write_queue);
+    req = QUEUE_DATA(q, uv_udp_send_t, queue);
+    req->status = h[i].msg_len;
+    QUEUE_REMOVE(&req->queue);
+    QUEUE_INSERT_TAIL(&handle->write_completed_queue, &req->queue);
+  }
+  uv__io_feed(handle->loop, &handle->io_watcher);
+
+  /* All datagrams went out, there may be more to send. */
+  if ((size_t) npkts == pkts && !QUEUE_EMPTY(&handle->write_queue))
+    goto write_queue_drain;
+}
+#endif
+
 static void uv__udp_sendmsg(uv_udp_t* handle) {
   uv_udp_send_t* req;
   QUEUE* q;
+#if HAVE_UDP_GSO
+  uv__udp_cmsg_t control;
+#endif
   struct msghdr h;
   ssize_t size;
 
+#if HAVE_MMSG
+  uv_once(&once, uv__udp_mmsg_init);
+  if (uv__sendmmsg_avail) {
+    uv__udp_sendmmsg(handle);
+    return;
+  }
+#endif
+
   while (!QUEUE_EMPTY(&handle->write_queue)) {
     q = QUEUE_HEAD(&handle->write_queue);
     assert(q != NULL);
@@ -228,6 +493,10 @@ static void uv__udp_sendmsg(uv_udp_t* handle) {
       sizeof(struct sockaddr_in6) : sizeof(struct sockaddr_in));
     h.msg_iov = (struct iovec*) req->bufs;
     h.msg_iovlen = req->nbufs;
+#if HAVE_UDP_GSO
+    if (req->segment_size != 0)
+      uv__udp_set_segment_cmsg(&h, &control, req->segment_size);
+#endif
 
     do {
       size = sendmsg(handle->io_watcher.fd, &h, 0);
@@ -377,13 +646,14 @@ static int uv__udp_maybe_deferred_bind(uv_udp_t* handle,
 }
 
 
-int uv__udp_send(uv_udp_send_t* req,
-                 uv_udp_t* handle,
-                 const uv_buf_t bufs[],
-                 unsigned int nbufs,
-                 const struct sockaddr* addr,
-                 unsigned int addrlen,
-                 uv_udp_send_cb send_cb) {
+static int uv__udp_queue_send(uv_udp_send_t* req,
+                              uv_udp_t* handle,
+                              const uv_buf_t bufs[],
+                              unsigned int nbufs,
+                              const struct sockaddr* addr,
+                              unsigned int addrlen,
+                              unsigned int segment_size,
+                              uv_udp_send_cb send_cb) {
   int err;
   int empty_queue;
 
@@ -405,6 +675,7 @@ int uv__udp_send(uv_udp_send_t* req,
   req->send_cb = send_cb;
   req->handle = handle;
   req->nbufs = nbufs;
+  req->segment_size = segment_size;
 
   req->bufs = req->bufsml;
   if (nbufs > ARRAY_SIZE(req->bufsml))
@@ -423,6 +694,10 @@ int uv__udp_send(uv_udp_send_t* req,
 
   if (empty_queue && !(handle->flags & UV_UDP_PROCESSING)) {
     uv__udp_sendmsg(handle);
+
+    /* The socket may not have taken everything, wait for it to drain. */
+    if (!QUEUE_EMPTY(&handle->write_queue))
+      uv__io_start(handle->loop, &handle->io_watcher, UV__POLLOUT);
   } else {
     uv__io_start(handle->loop, &handle->io_watcher, UV__POLLOUT);
   }
@@ -431,6 +706,40 @@ int uv__udp_send(uv_udp_send_t* req,
 }
 
 
+int uv__udp_send(uv_udp_send_t* req,
+                 uv_udp_t* handle,
+                 const uv_buf_t bufs[],
+                 unsigned int nbufs,
+                 const struct sockaddr* addr,
+                 unsigned int addrlen,
+                 uv_udp_send_cb send_cb) {
+  return uv__udp_queue_send(req, handle, bufs, nbufs, addr, addrlen, 0, send_cb);
+}
+
+
+int uv__udp_send_gso(uv_udp_send_t* req,
+                     uv_udp_t* handle,
+                     const uv_buf_t bufs[],
+                     unsigned int nbufs,
+                     const struct sockaddr* addr,
+                     unsigned int addrlen,
+                     unsigned int segment_size,
+                     uv_udp_send_cb send_cb) {
+#if HAVE_UDP_GSO
+  return uv__udp_queue_send(req,
+                            handle,
+                            bufs,
+                            nbufs,
+                            addr,
+                            addrlen,
+                            segment_size,
+                            send_cb);
+#else
+  return -ENOTSUP;
+#endif
+}
+
+
 int uv__udp_try_send(uv_udp_t* handle,
                      const uv_buf_t bufs[],
                      unsigned int nbufs,
@@ -567,7 +876,7 @@ int uv_udp_init_ex(uv_loop_t* loop, uv_udp_t* handle, unsigned int flags) {
   if (domain != AF_INET && domain != AF_INET6 && domain != AF_UNSPEC)
     return -EINVAL;
 
-  if (flags & ~0xFF)
+  if (flags & ~0xFF & ~UV_UDP_RECVMMSG)
     return -EINVAL;
 
   if (domain != AF_UNSPEC) {
@@ -584,10 +893,68 @@ int uv_udp_init_ex(uv_loop_t* loop, uv_udp_t* handle, unsigned int flags) {
   handle->recv_cb = NULL;
   handle->send_queue_size = 0;
   handle->send_queue_count = 0;
+  handle->recv_segment_size = 0;
   uv__io_init(&handle->io_watcher, uv__udp_io, fd);
   QUEUE_INIT(&handle->write_queue);
   QUEUE_INIT(&handle->write_completed_queue);
+  if (flags & UV_UDP_RECVMMSG)
+    handle->flags |= UV_HANDLE_UDP_RECVMMSG;
+  return 0;
+}
+
+
+int uv_udp_using_recvmmsg(const uv_udp_t* handle) {
+#if HAVE_MMSG
+  if (handle->flags & UV_HANDLE_UDP_RECVMMSG) {
+    uv_once(&once, uv__udp_mmsg_init);
+    return uv__recvmmsg_avail;
+  }
+#endif
+  return 0;
+}
+
+
+int uv_udp_set_gro(uv_udp_t* handle, int on) {
+#if HAVE_UDP_GSO
+  if (setsockopt(handle->io_watcher.fd, SOL_UDP, UDP_GRO, &on, sizeof(on)))
+    return -errno;
+
+  if (on)
+    handle->flags |= UV_HANDLE_UDP_GRO;
+  else
+    handle->flags &= ~UV_HANDLE_UDP_GRO;
+  return 0;
+#else
+  return -ENOTSUP;
+#endif
+}
+
+
+int uv_udp_set_busy_poll(uv_udp_t* handle, unsigned int usec) {
+#if defined(__linux__) && defined(SO_BUSY_POLL)
+  int val;
+
+  if (usec > INT_MAX)
+    return -EINVAL;
+
+  val = usec;
+  if (setsockopt(handle->io_watcher.fd,
+                 SOL_SOCKET,
+                 SO_BUSY_POLL,
+                 &val,
+                 sizeof(val))) {
+    return -errno;
+  }
+
   return 0;
+#else
+  return -ENOTSUP;
+#endif
+}
+
+
+unsigned int uv_udp_get_recv_segment_size(const uv_udp_t* handle) {
+  return handle->recv_segment_size;
 }
 
 
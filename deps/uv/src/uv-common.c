@@ -298,6 +298,39 @@ int uv_udp_send(uv_udp_send_t* req,
 }
 
 
+int uv_udp_send_gso(uv_udp_send_t* req,
+                    uv_udp_t* handle,
+                    const uv_buf_t bufs[],
+                    unsigned int nbufs,
+                    const struct sockaddr* addr,
+                    unsigned int segment_size,
+                    uv_udp_send_cb send_cb) {
+  unsigned int addrlen;
+
+  if (handle->type != UV_UDP)
+    return UV_EINVAL;
+
+  if (segment_size == 0 || segment_size > 0xFFFF)
+    return UV_EINVAL;
+
+  if (addr->sa_family == AF_INET)
+    addrlen = sizeof(struct sockaddr_in);
+  else if (addr->sa_family == AF_INET6)
+    addrlen = sizeof(struct sockaddr_in6);
+  else
+    return UV_EINVAL;
+
+  return uv__udp_send_gso(req,
+                          handle,
+                          bufs,
+                          nbufs,
+                          addr,
+                          addrlen,
+                          segment_size,
+                          send_cb);
+}
+
+
 int uv_udp_try_send(uv_udp_t* handle,
                     const uv_buf_t bufs[],
                     unsigned int nbufs,
@@ -475,6 +508,50 @@ static unsigned int* uv__get_nbufs(uv_fs_t* req) {
 #endif
 }
 
+static uv_buf_t* uv__get_bufs(uv_fs_t* req) {
+#ifdef _WIN32
+  return req->fs.info.bufs;
+#else
+  return req->bufs;
+#endif
+}
+
+/* Metadata requests are usually quick and on the critical path of a
+ * request, so they skip ahead of bulk reads and writes.
+ */
+#define UV__FS_BULK_SIZE (64 * 1024)
+
+uv_work_priority uv__fs_work_priority(uv_fs_t* req) {
+  uv_buf_t* bufs;
+  unsigned int nbufs;
+  size_t size;
+  unsigned int i;
+
+  switch (req->fs_type) {
+  case UV_FS_STAT:
+  case UV_FS_LSTAT:
+  case UV_FS_FSTAT:
+  case UV_FS_ACCESS:
+  case UV_FS_CLOSE:
+  case UV_FS_READLINK:
+  case UV_FS_REALPATH:
+    return UV_PRIORITY_HIGH;
+  case UV_FS_SENDFILE:
+    return UV_PRIORITY_LOW;
+  case UV_FS_READ:
+  case UV_FS_WRITE:
+    bufs = uv__get_bufs(req);
+    nbufs = *uv__get_nbufs(req);
+    size = 0;
+    for (i = 0; i < nbufs; i++)
+      size += bufs[i].len;
+    return size >= UV__FS_BULK_SIZE ? UV_PRIORITY_LOW : UV_PRIORITY_NORMAL;
+  default:
+    return UV_PRIORITY_NORMAL;
+  }
+}
+
+
 void uv__fs_scandir_cleanup(uv_fs_t* req) {
   uv__dirent_t** dents;
 
@@ -550,13 +627,187 @@ int uv_loop_configure(uv_loop_t* loop, uv_loop_option option, ...) {
 
   va_start(ap, option);
   /* Any platform-agnostic options should be handled here. */
-  err = uv__loop_configure(loop, option, ap);
+  if (option == UV_LOOP_METRICS) {
+    loop->metrics = va_arg(ap, uv_loop_metrics_t*);
+    if (loop->metrics != NULL) {
+      memset(loop->metrics, 0, sizeof(*loop->metrics));
+      /* Nothing is counted until the next iteration starts. */
+      loop->metrics->phase = UV_LOOP_PHASE_MAX;
+    }
+    err = 0;
+  } else {
+    err = uv__loop_configure(loop, option, ap);
+  }
   va_end(ap);
 
   return err;
 }
 
 
+static void uv__metrics_charge(uv_loop_metrics_t* metrics, uint64_t now) {
+  if (metrics->phase < UV_LOOP_PHASE_MAX)
+    metrics->phase_time[metrics->phase] += now - metrics->phase_start;
+  metrics->phase_start = now;
+}
+
+
+void uv__metrics_enter_phase(uv_loop_t* loop, unsigned int phase) {
+  uv_loop_metrics_t* metrics;
+  uint64_t now;
+
+  metrics = loop->metrics;
+  now = uv_hrtime();
+  uv__metrics_charge(metrics, now);
+
+  if (metrics->iteration_start == 0 && phase == UV_LOOP_PHASE_TIMERS) {
+    metrics->iteration_start = now;
+    metrics->iteration_idle = 0;
+  }
+
+  if (metrics->iteration_start != 0)
+    metrics->phase = phase;
+}
+
+
+void uv__metrics_end_iteration(uv_loop_t* loop) {
+  uv_loop_metrics_t* metrics;
+  uint64_t now;
+
+  metrics = loop->metrics;
+  now = uv_hrtime();
+  uv__metrics_charge(metrics, now);
+
+  if (metrics->iteration_start != 0) {
+    metrics->iterations++;
+    metrics->last_iteration_time =
+        now - metrics->iteration_start - metrics->iteration_idle;
+  }
+
+  metrics->phase = UV_LOOP_PHASE_MAX;
+  metrics->iteration_start = 0;
+}
+
+
+void uv__metrics_wait_start(uv_loop_t* loop) {
+  uv__metrics_charge(loop->metrics, uv_hrtime());
+}
+
+
+void uv__metrics_wait_end(uv_loop_t* loop) {
+  uv_loop_metrics_t* metrics;
+  uint64_t now;
+  uint64_t idle;
+
+  metrics = loop->metrics;
+  now = uv_hrtime();
+  idle = now - metrics->phase_start;
+  metrics->phase_start = now;
+
+  if (metrics->iteration_start != 0) {
+    metrics->idle_time += idle;
+    metrics->iteration_idle += idle;
+  }
+}
+
+
+#if defined(_WIN32)
+# define uv__cas_ptr(p, oldval, newval)                                       \
+  InterlockedCompareExchangePointer((p), (newval), (oldval))
+#else
+# define uv__cas_ptr(p, oldval, newval)                                       \
+  __sync_val_compare_and_swap((p), (oldval), (newval))
+#endif
+
+
+int uv__mpsc_push(void* volatile* head, void** node) {
+  void* first;
+  void* prev;
+
+  /* Producers only ever push and the consumer takes the whole list at once,
+   * so a compare-and-swap on the head is all it takes; there is no ABA
+   * problem to worry about.
+   */
+  first = *head;
+  for (;;) {
+    *node = first;
+    prev = uv__cas_ptr(head, first, (void*) node);
+    if (prev == first)
+      break;
+    first = prev;
+  }
+
+  return first == NULL;
+}
+
+
+void** uv__mpsc_take(void* volatile* head) {
+  void** node;
+  void** next;
+  void** prev;
+  void* first;
+
+  first = *head;
+  while (first != NULL) {
+    prev = uv__cas_ptr(head, first, NULL);
+    if (prev == first)
+      break;
+    first = prev;
+  }
+
+  /* The list is in LIFO order, reverse it. */
+  prev = NULL;
+  for (node = first; node != NULL; node = next) {
+    next = *node;
+    *node = prev;
+    prev = node;
+  }
+
+  return prev;
+}
+
+
+static void uv__async_queue_cb(uv_async_t* handle) {
+  uv_async_queue_t* queue;
+  uv_async_item_t* item;
+  void** node;
+  void** next;
+
+  queue = container_of(handle, uv_async_queue_t, async);
+  for (node = uv__mpsc_take(&queue->head); node != NULL; node = next) {
+    /* Read the link first, the callback is allowed to free the item. */
+    next = *node;
+    item = container_of(node, uv_async_item_t, next);
+    queue->cb(queue, item);
+  }
+}
+
+
+int uv_async_queue_init(uv_loop_t* loop,
+                        uv_async_queue_t* queue,
+                        uv_async_queue_cb cb) {
+  if (cb == NULL)
+    return UV_EINVAL;
+
+  queue->cb = cb;
+  queue->head = NULL;
+  return uv_async_init(loop, &queue->async, uv__async_queue_cb);
+}
+
+
+void uv_async_queue_push(uv_async_queue_t* queue, uv_async_item_t* item) {
+  /* Only the push that makes the queue non-empty needs to wake up the loop;
+   * the items that follow are picked up by the same callback.
+   */
+  if (uv__mpsc_push(&queue->head, &item->next))
+    uv_async_send(&queue->async);
+}
+
+
+void uv_async_queue_close(uv_async_queue_t* queue, uv_close_cb close_cb) {
+  uv_close((uv_handle_t*) &queue->async, close_cb);
+}
+
+
 static uv_loop_t default_loop_struct;
 static uv_loop_t* default_loop_ptr;
 
@@ -95,6 +95,15 @@ int uv__udp_send(uv_udp_send_t* req,
                  unsigned int addrlen,
                  uv_udp_send_cb send_cb);
 
+int uv__udp_send_gso(uv_udp_send_t* req,
+                     uv_udp_t* handle,
+                     const uv_buf_t bufs[],
+                     unsigned int nbufs,
+                     const struct sockaddr* addr,
+                     unsigned int addrlen,
+                     unsigned int segment_size,
+                     uv_udp_send_cb send_cb);
+
 int uv__udp_try_send(uv_udp_t* handle,
                      const uv_buf_t bufs[],
                      unsigned int nbufs,
@@ -112,11 +121,55 @@ int uv__getaddrinfo_translate_error(int sys_err);    /* EAI_* error. */
 
 void uv__work_submit(uv_loop_t* loop,
                      struct uv__work *w,
+                     uv_threadpool_queue kind,
+                     uv_work_priority priority,
                      void (*work)(struct uv__work *w),
                      void (*done)(struct uv__work *w, int status));
 
 void uv__work_done(uv_async_t* handle);
 
+/* Lock-free multi-producer, single-consumer list. Nodes are pointers to the
+ * link field of the pushed structures. uv__mpsc_push() returns non-zero when
+ * the list was empty, uv__mpsc_take() empties the list and returns its nodes
+ * in the order in which they were pushed, linked through their link fields.
+ */
+int uv__mpsc_push(void* volatile* head, void** node);
+void** uv__mpsc_take(void* volatile* head);
+
+uv_work_priority uv__fs_work_priority(uv_fs_t* req);
+
+/* Loop metrics, see UV_LOOP_METRICS. The macros are no-ops unless the loop
+ * has been configured to collect them.
+ */
+void uv__metrics_enter_phase(uv_loop_t* loop, unsigned int phase);
+void uv__metrics_end_iteration(uv_loop_t* loop);
+void uv__metrics_wait_start(uv_loop_t* loop);
+void uv__metrics_wait_end(uv_loop_t* loop);
+
+#define uv__metrics_phase(loop, phase)                                        \
+  do {                                                                        \
+    if ((loop)->metrics != NULL)                                              \
+      uv__metrics_enter_phase((loop), (phase));                               \
+  } while (0)
+
+#define uv__metrics_iteration_done(loop)                                      \
+  do {                                                                        \
+    if ((loop)->metrics != NULL)                                              \
+      uv__metrics_end_iteration((loop));                                      \
+  } while (0)
+
+#define uv__metrics_block(loop)                                               \
+  do {                                                                        \
+    if ((loop)->metrics != NULL)                                              \
+      uv__metrics_wait_start((loop));                                         \
+  } while (0)
+
+#define uv__metrics_unblock(loop)                                             \
+  do {                                                                        \
+    if ((loop)->metrics != NULL)                                              \
+      uv__metrics_wait_end((loop));                                           \
+  } while (0)
+
 size_t uv__count_bufs(const uv_buf_t bufs[], unsigned int nbufs);
 
 int uv__socket_sockopt(uv_handle_t* handle, int optname, int* value);
@@ -140,7 +140,7 @@ int uv_loop_init(uv_loop_t* loop) {
   loop->time = 0;
   uv_update_time(loop);
 
-  QUEUE_INIT(&loop->wq);
+  loop->wq_done = NULL;
   QUEUE_INIT(&loop->handle_queue);
   QUEUE_INIT(&loop->active_reqs);
   loop->active_handles = 0;
@@ -166,10 +166,7 @@ int uv_loop_init(uv_loop_t* loop) {
 
   loop->timer_counter = 0;
   loop->stop_flag = 0;
-
-  err = uv_mutex_init(&loop->wq_mutex);
-  if (err)
-    goto fail_mutex_init;
+  loop->metrics = NULL;
 
   err = uv_async_init(loop, &loop->wq_async, uv__work_done);
   if (err)
@@ -181,9 +178,6 @@ int uv_loop_init(uv_loop_t* loop) {
   return 0;
 
 fail_async_init:
-  uv_mutex_destroy(&loop->wq_mutex);
-
-fail_mutex_init:
   CloseHandle(loop->iocp);
   loop->iocp = INVALID_HANDLE_VALUE;
 
@@ -211,11 +205,8 @@ void uv__loop_close(uv_loop_t* loop) {
       closesocket(sock);
   }
 
-  uv_mutex_lock(&loop->wq_mutex);
-  assert(QUEUE_EMPTY(&loop->wq) && "thread pool work queue not empty!");
+  assert(loop->wq_done == NULL && "thread pool work queue not empty!");
   assert(!uv__has_active_reqs(loop));
-  uv_mutex_unlock(&loop->wq_mutex);
-  uv_mutex_destroy(&loop->wq_mutex);
 
   CloseHandle(loop->iocp);
 }
@@ -262,11 +253,13 @@ static void uv_poll(uv_loop_t* loop, DWORD timeout) {
   timeout_time = loop->time + timeout;
 
   for (repeat = 0; ; repeat++) {
+    uv__metrics_block(loop);
     GetQueuedCompletionStatus(loop->iocp,
                               &bytes,
                               &key,
                               &overlapped,
                               timeout);
+    uv__metrics_unblock(loop);
 
     if (overlapped) {
       /* Package was dequeued */
@@ -314,12 +307,14 @@ static void uv_poll_ex(uv_loop_t* loop, DWORD timeout) {
   timeout_time = loop->time + timeout;
 
   for (repeat = 0; ; repeat++) {
+    uv__metrics_block(loop);
     success = pGetQueuedCompletionStatusEx(loop->iocp,
                                            overlappeds,
                                            ARRAY_SIZE(overlappeds),
                                            &count,
                                            timeout,
                                            FALSE);
+    uv__metrics_unblock(loop);
 
     if (success) {
       for (i = 0; i < count; i++) {
@@ -386,19 +381,26 @@ int uv_run(uv_loop_t *loop, uv_run_mode mode) {
 
   while (r != 0 && loop->stop_flag == 0) {
     uv_update_time(loop);
+    uv__metrics_phase(loop, UV_LOOP_PHASE_TIMERS);
     uv_process_timers(loop);
 
+    uv__metrics_phase(loop, UV_LOOP_PHASE_PENDING);
     ran_pending = uv_process_reqs(loop);
+    uv__metrics_phase(loop, UV_LOOP_PHASE_IDLE);
     uv_idle_invoke(loop);
+    uv__metrics_phase(loop, UV_LOOP_PHASE_PREPARE);
     uv_prepare_invoke(loop);
 
     timeout = 0;
     if ((mode == UV_RUN_ONCE && !ran_pending) || mode == UV_RUN_DEFAULT)
       timeout = uv_backend_timeout(loop);
 
+    uv__metrics_phase(loop, UV_LOOP_PHASE_POLL);
     (*poll)(loop, timeout);
 
+    uv__metrics_phase(loop, UV_LOOP_PHASE_CHECK);
     uv_check_invoke(loop);
+    uv__metrics_phase(loop, UV_LOOP_PHASE_CLOSING);
     uv_process_endgames(loop);
 
     if (mode == UV_RUN_ONCE) {
@@ -410,9 +412,11 @@ int uv_run(uv_loop_t *loop, uv_run_mode mode) {
        * UV_RUN_NOWAIT makes no guarantees about progress so it's omitted from
        * the check.
        */
+      uv__metrics_phase(loop, UV_LOOP_PHASE_TIMERS);
       uv_process_timers(loop);
     }
 
+    uv__metrics_iteration_done(loop);
     r = uv__loop_alive(loop);
     if (mode == UV_RUN_ONCE || mode == UV_RUN_NOWAIT)
       break;
@@ -367,6 +367,8 @@ int uv_getaddrinfo(uv_loop_t* loop,
   if (getaddrinfo_cb) {
     uv__work_submit(loop,
                     &req->work_req,
+                    UV_THREADPOOL_DNS,
+                    UV_PRIORITY_HIGH,
                     uv__getaddrinfo_work,
                     uv__getaddrinfo_done);
     return 0;
@@ -203,6 +203,28 @@ int uv_try_write(uv_stream_t* stream,
 }
 
 
+int uv_sendfile(uv_write_t* req,
+                uv_stream_t* handle,
+                uv_file file,
+                int64_t offset,
+                size_t length,
+                uv_write_cb cb) {
+  return UV_ENOSYS;
+}
+
+
+int uv_splice_start(uv_stream_t* source,
+                    uv_stream_t* sink,
+                    uv_splice_cb cb) {
+  return UV_ENOSYS;
+}
+
+
+int uv_splice_stop(uv_stream_t* source) {
+  return UV_ENOSYS;
+}
+
+
 int uv_shutdown(uv_shutdown_t* req, uv_stream_t* handle, uv_shutdown_cb cb) {
   uv_loop_t* loop = handle->loop;
 
@@ -301,6 +301,9 @@ static int uv_tcp_try_bind(uv_tcp_t* handle,
   DWORD err;
   int r;
 
+  if (flags & UV_TCP_REUSEPORT)
+    return ERROR_NOT_SUPPORTED;
+
   if (handle->socket == INVALID_SOCKET) {
     SOCKET sock;
 
@@ -1269,6 +1272,11 @@ int uv_tcp_keepalive(uv_tcp_t* handle, int enable, unsigned int delay) {
 }
 
 
+int uv_tcp_busy_poll(uv_tcp_t* handle, unsigned int usec) {
+  return UV_ENOTSUP;
+}
+
+
 int uv_tcp_duplicate_socket(uv_tcp_t* handle, int pid,
     LPWSAPROTOCOL_INFOW protocol_info) {
   if (!(handle->flags & UV_HANDLE_CONNECTION)) {
@@ -131,7 +131,8 @@ int uv_udp_init_ex(uv_loop_t* loop, uv_udp_t* handle, unsigned int flags) {
   if (domain != AF_INET && domain != AF_INET6 && domain != AF_UNSPEC)
     return UV_EINVAL;
 
-  if (flags & ~0xFF)
+  /* recvmmsg() is a Linux thing, UV_UDP_RECVMMSG is ignored. */
+  if (flags & ~0xFF & ~UV_UDP_RECVMMSG)
     return UV_EINVAL;
 
   uv__handle_init(loop, (uv_handle_t*) handle, UV_UDP);
@@ -178,6 +179,27 @@ int uv_udp_init(uv_loop_t* loop, uv_udp_t* handle) {
 }
 
 
+int uv_udp_using_recvmmsg(const uv_udp_t* handle) {
+  return 0;
+}
+
+
+/* Windows has no UDP segmentation offload. */
+int uv_udp_set_gro(uv_udp_t* handle, int on) {
+  return UV_ENOTSUP;
+}
+
+
+int uv_udp_set_busy_poll(uv_udp_t* handle, unsigned int usec) {
+  return UV_ENOTSUP;
+}
+
+
+unsigned int uv_udp_get_recv_segment_size(const uv_udp_t* handle) {
+  return 0;
+}
+
+
 void uv_udp_close(uv_loop_t* loop, uv_udp_t* handle) {
   uv_udp_recv_stop(handle);
   closesocket(handle->socket);
@@ -917,6 +939,18 @@ int uv__udp_send(uv_udp_send_t* req,
 }
 
 
+int uv__udp_send_gso(uv_udp_send_t* req,
+                     uv_udp_t* handle,
+                     const uv_buf_t bufs[],
+                     unsigned int nbufs,
+                     const struct sockaddr* addr,
+                     unsigned int addrlen,
+                     unsigned int segment_size,
+                     uv_udp_send_cb send_cb) {
+  return UV_ENOTSUP;
+}
+
+
 int uv__udp_try_send(uv_udp_t* handle,
                      const uv_buf_t bufs[],
                      unsigned int nbufs,
@@ -0,0 +1,100 @@
+/* Copyright Joyent, Inc. and other Node contributors. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "uv.h"
+#include "task.h"
+
+#define NUM_THREADS 4
+#define NUM_ITEMS 10000
+
+typedef struct {
+  uv_async_item_t item;
+  unsigned int thread;
+  unsigned int seq;
+} item_t;
+
+static uv_async_queue_t queue;
+static uv_thread_t threads[NUM_THREADS];
+static item_t items[NUM_THREADS][NUM_ITEMS];
+static unsigned int next_seq[NUM_THREADS];
+static unsigned int queue_cb_called;
+static unsigned int close_cb_called;
+
+
+static void thread_cb(void* arg) {
+  unsigned int thread;
+  unsigned int i;
+
+  thread = (unsigned int) (uintptr_t) arg;
+  for (i = 0; i < NUM_ITEMS; i++) {
+    items[thread][i].thread = thread;
+    items[thread][i].seq = i;
+    items[thread][i].item.data = &items[thread][i];
+    uv_async_queue_push(&queue, &items[thread][i].item);
+  }
+}
+
+
+static void close_cb(uv_handle_t* handle) {
+  ASSERT(handle == (uv_handle_t*) &queue.async);
+  close_cb_called++;
+}
+
+
+static void queue_cb(uv_async_queue_t* handle, uv_async_item_t* item) {
+  item_t* it;
+
+  ASSERT(handle == &queue);
+  it = item->data;
+  ASSERT(&it->item == item);
+  ASSERT(it->thread < NUM_THREADS);
+
+  /* Items from one thread arrive in the order in which they were pushed. */
+  ASSERT(it->seq == next_seq[it->thread]);
+  next_seq[it->thread]++;
+
+  if (++queue_cb_called == NUM_THREADS * NUM_ITEMS)
+    uv_async_queue_close(&queue, close_cb);
+}
+
+
+TEST_IMPL(async_queue) {
+  uintptr_t i;
+
+  ASSERT(UV_EINVAL == uv_async_queue_init(uv_default_loop(), &queue, NULL));
+  ASSERT(0 == uv_async_queue_init(uv_default_loop(), &queue, queue_cb));
+
+  for (i = 0; i < NUM_THREADS; i++)
+    ASSERT(0 == uv_thread_create(&threads[i], thread_cb, (void*) i));
+
+  ASSERT(0 == uv_run(uv_default_loop(), UV_RUN_DEFAULT));
+
+  for (i = 0; i < NUM_THREADS; i++) {
+    ASSERT(0 == uv_thread_join(&threads[i]));
+    ASSERT(next_seq[i] == NUM_ITEMS);
+  }
+
+  ASSERT(queue_cb_called == NUM_THREADS * NUM_ITEMS);
+  ASSERT(close_cb_called == 1);
+
+  MAKE_VALGRIND_HAPPY();
+  return 0;
+}
@@ -0,0 +1,142 @@
+/* Copyright Joyent, Inc. and other Node contributors. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "uv.h"
+#include "task.h"
+
+#if defined(__linux__)
+# include <sys/socket.h>
+# include <unistd.h>
+
+static uv_poll_t poll_handle;
+static uv_timer_t timer_handle;
+static int fds[2];
+static uint64_t timer_start;
+static int poll_cb_called;
+static int timer_cb_called;
+
+
+static void writer(void* arg) {
+  uv_sleep(20);
+  ASSERT(1 == write(fds[1], "x", 1));
+}
+
+
+static void poll_cb(uv_poll_t* handle, int status, int events) {
+  char c;
+
+  ASSERT(status == 0);
+  ASSERT(events == UV_READABLE);
+  ASSERT(1 == read(fds[0], &c, 1));
+  poll_cb_called++;
+  uv_close((uv_handle_t*) handle, NULL);
+}
+
+
+static void timer_cb(uv_timer_t* handle) {
+  /* The spinning does not cut the timeout short. */
+  ASSERT(uv_now(handle->loop) - timer_start >= 10);
+  timer_cb_called++;
+  uv_close((uv_handle_t*) handle, NULL);
+}
+#endif
+
+
+TEST_IMPL(loop_busy_poll) {
+#if defined(__linux__)
+  uv_thread_t thread;
+  uv_loop_t loop;
+
+  ASSERT(0 == uv_loop_init(&loop));
+  ASSERT(UV_EINVAL == uv_loop_configure(&loop, UV_LOOP_BUSY_POLL, 1000001u));
+  ASSERT(0 == uv_loop_configure(&loop, UV_LOOP_BUSY_POLL, 2000u));
+
+  /* A timeout that is longer than the time to spin, then one that is
+   * shorter.
+   */
+  ASSERT(0 == uv_timer_init(&loop, &timer_handle));
+  timer_start = uv_now(&loop);
+  ASSERT(0 == uv_timer_start(&timer_handle, timer_cb, 10, 0));
+  ASSERT(0 == uv_run(&loop, UV_RUN_DEFAULT));
+  ASSERT(timer_cb_called == 1);
+
+  ASSERT(0 == uv_loop_configure(&loop, UV_LOOP_BUSY_POLL, 50000u));
+  ASSERT(0 == uv_timer_init(&loop, &timer_handle));
+  uv_update_time(&loop);
+  timer_start = uv_now(&loop);
+  ASSERT(0 == uv_timer_start(&timer_handle, timer_cb, 10, 0));
+  ASSERT(0 == uv_run(&loop, UV_RUN_DEFAULT));
+  ASSERT(timer_cb_called == 2);
+
+  /* Events that come while it spins, and after it blocked. */
+  ASSERT(0 == uv_loop_configure(&loop, UV_LOOP_BUSY_POLL, 1000u));
+  ASSERT(0 == socketpair(AF_UNIX, SOCK_STREAM, 0, fds));
+  ASSERT(0 == uv_poll_init(&loop, &poll_handle, fds[0]));
+  ASSERT(0 == uv_poll_start(&poll_handle, UV_READABLE, poll_cb));
+  ASSERT(0 == uv_thread_create(&thread, writer, NULL));
+  ASSERT(0 == uv_run(&loop, UV_RUN_DEFAULT));
+  ASSERT(0 == uv_thread_join(&thread));
+  ASSERT(poll_cb_called == 1);
+  close(fds[0]);
+  close(fds[1]);
+
+  ASSERT(0 == uv_loop_configure(&loop, UV_LOOP_BUSY_POLL, 0u));
+  ASSERT(0 == uv_loop_close(&loop));
+  return 0;
+#else
+  RETURN_SKIP("UV_LOOP_BUSY_POLL is only implemented on Linux");
+#endif
+}
+
+
+TEST_IMPL(socket_busy_poll) {
+  struct sockaddr_in addr;
+  uv_tcp_t tcp;
+  uv_udp_t udp;
+  int r;
+
+  ASSERT(0 == uv_ip4_addr("127.0.0.1", 0, &addr));
+  ASSERT(0 == uv_tcp_init(uv_default_loop(), &tcp));
+  ASSERT(0 == uv_tcp_bind(&tcp, (const struct sockaddr*) &addr, 0));
+  ASSERT(0 == uv_udp_init(uv_default_loop(), &udp));
+  ASSERT(0 == uv_udp_bind(&udp, (const struct sockaddr*) &addr, 0));
+
+  /* Raising the value above net.core.busy_read needs CAP_NET_ADMIN. */
+  r = uv_tcp_busy_poll(&tcp, 50);
+#if defined(__linux__)
+  ASSERT(r == 0 || r == UV_EPERM);
+#else
+  ASSERT(r == UV_ENOTSUP);
+#endif
+  r = uv_udp_set_busy_poll(&udp, 50);
+#if defined(__linux__)
+  ASSERT(r == 0 || r == UV_EPERM);
+#else
+  ASSERT(r == UV_ENOTSUP);
+#endif
+
+  uv_close((uv_handle_t*) &tcp, NULL);
+  uv_close((uv_handle_t*) &udp, NULL);
+  ASSERT(0 == uv_run(uv_default_loop(), UV_RUN_DEFAULT));
+
+  MAKE_VALGRIND_HAPPY();
+  return 0;
+}
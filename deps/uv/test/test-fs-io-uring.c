@@ -0,0 +1,163 @@
+/* Copyright libuv project contributors. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#ifndef _WIN32
+
+#include "uv.h"
+#include "task.h"
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define FILENAME "test_file_io_uring"
+
+static uv_fs_t req;
+static uv_file file;
+static char buf[32];
+static int steps;
+
+
+static void next_step(uv_fs_t* req);
+
+
+static void check_size(uv_fs_t* req) {
+  ASSERT(req->result == 0);
+  ASSERT(req->ptr == &req->statbuf);
+  ASSERT(req->statbuf.st_size == 11);
+}
+
+
+static void next_step(uv_fs_t* req) {
+  uv_loop_t* loop;
+  uv_buf_t bufs[2];
+  int r;
+
+  loop = req->loop;
+
+  switch (steps++) {
+  case 0:
+    ASSERT(req->result >= 0);
+    file = req->result;
+    uv_fs_req_cleanup(req);
+    bufs[0] = uv_buf_init("hello ", 6);
+    bufs[1] = uv_buf_init("world", 5);
+    r = uv_fs_write(loop, req, file, bufs, 2, -1, next_step);
+    break;
+  case 1:
+    ASSERT(req->result == 11);
+    uv_fs_req_cleanup(req);
+    r = uv_fs_fsync(loop, req, file, next_step);
+    break;
+  case 2:
+    ASSERT(req->result == 0);
+    uv_fs_req_cleanup(req);
+    r = uv_fs_fdatasync(loop, req, file, next_step);
+    break;
+  case 3:
+    ASSERT(req->result == 0);
+    uv_fs_req_cleanup(req);
+    r = uv_fs_fstat(loop, req, file, next_step);
+    break;
+  case 4:
+    check_size(req);
+    ASSERT(S_ISREG(req->statbuf.st_mode));
+    uv_fs_req_cleanup(req);
+    bufs[0] = uv_buf_init(buf, sizeof(buf));
+    r = uv_fs_read(loop, req, file, bufs, 1, 6, next_step);
+    break;
+  case 5:
+    ASSERT(req->result == 5);
+    ASSERT(0 == memcmp(buf, "world", 5));
+    uv_fs_req_cleanup(req);
+    r = uv_fs_close(loop, req, file, next_step);
+    break;
+  case 6:
+    ASSERT(req->result == 0);
+    uv_fs_req_cleanup(req);
+    r = uv_fs_stat(loop, req, FILENAME, next_step);
+    break;
+  case 7:
+    check_size(req);
+    uv_fs_req_cleanup(req);
+    r = uv_fs_lstat(loop, req, FILENAME, next_step);
+    break;
+  case 8:
+    check_size(req);
+    uv_fs_req_cleanup(req);
+    r = uv_fs_stat(loop, req, "no_such_file", next_step);
+    break;
+  case 9:
+    ASSERT(req->result == UV_ENOENT);
+    ASSERT(req->ptr == NULL);
+    uv_fs_req_cleanup(req);
+    /* Not supported by the io_uring backend, goes to the threadpool. */
+    r = uv_fs_unlink(loop, req, FILENAME, next_step);
+    break;
+  case 10:
+    ASSERT(req->result == 0);
+    uv_fs_req_cleanup(req);
+    return;
+  default:
+    ASSERT(0 && "unreachable");
+    return;
+  }
+
+  ASSERT(r == 0);
+}
+
+
+TEST_IMPL(fs_io_uring) {
+  uv_threadpool_stats_t stats;
+  uv_loop_t* loop;
+  int r;
+
+  /* Read once per process, each test runs in a process of its own. */
+  ASSERT(0 == setenv("UV_USE_IO_URING", "1", 1));
+
+  loop = uv_default_loop();
+  unlink(FILENAME);
+
+  r = uv_fs_open(loop,
+                 &req,
+                 FILENAME,
+                 O_RDWR | O_CREAT | O_TRUNC,
+                 S_IRUSR | S_IWUSR,
+                 next_step);
+  ASSERT(r == 0);
+
+  ASSERT(0 == uv_run(loop, UV_RUN_DEFAULT));
+  ASSERT(steps == 11);
+
+  ASSERT(0 == uv_threadpool_get_stats(UV_THREADPOOL_FS, &stats));
+  if (stats.submitted == 11) {
+    MAKE_VALGRIND_HAPPY();
+    RETURN_SKIP("io_uring is not available.");
+  }
+
+  /* Everything but the unlink request bypassed the threadpool. */
+  ASSERT(stats.submitted == 1);
+
+  MAKE_VALGRIND_HAPPY();
+  return 0;
+}
+
+#endif  /* !_WIN32 */
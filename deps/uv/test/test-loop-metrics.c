@@ -0,0 +1,77 @@
+/* Copyright Joyent, Inc. and other Node contributors. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "uv.h"
+#include "task.h"
+
+#define NS_PER_MS ((uint64_t) 1000000)
+
+static uv_loop_metrics_t metrics;
+static unsigned int timer_cb_called;
+
+
+static void timer_cb(uv_timer_t* handle) {
+  uint64_t start;
+
+  /* Keep the timers phase busy for 20 ms. */
+  start = uv_hrtime();
+  while (uv_hrtime() - start < 20 * NS_PER_MS);
+
+  timer_cb_called++;
+  uv_close((uv_handle_t*) handle, NULL);
+}
+
+
+TEST_IMPL(loop_metrics) {
+  uv_timer_t timer_handle;
+  uv_loop_t loop;
+  uint64_t busy;
+  int i;
+
+  ASSERT(0 == uv_loop_init(&loop));
+  ASSERT(0 == uv_loop_configure(&loop, UV_LOOP_METRICS, &metrics));
+  ASSERT(0 == uv_timer_init(&loop, &timer_handle));
+  ASSERT(0 == uv_timer_start(&timer_handle, timer_cb, 50, 0));
+  ASSERT(0 == uv_run(&loop, UV_RUN_DEFAULT));
+  ASSERT(1 == timer_cb_called);
+
+  ASSERT(metrics.iterations > 0);
+  ASSERT(metrics.phase_time[UV_LOOP_PHASE_TIMERS] >= 20 * NS_PER_MS);
+  ASSERT(metrics.idle_time >= 30 * NS_PER_MS);
+  ASSERT(metrics.last_iteration_time >= 20 * NS_PER_MS);
+
+  busy = 0;
+  for (i = 0; i < UV_LOOP_PHASE_MAX; i++)
+    busy += metrics.phase_time[i];
+  ASSERT(busy >= metrics.last_iteration_time);
+  /* Blocking for I/O is not counted in the poll phase. */
+  ASSERT(metrics.phase_time[UV_LOOP_PHASE_POLL] < 20 * NS_PER_MS);
+
+  /* Nothing is counted once the metrics are switched off. */
+  ASSERT(0 == uv_loop_configure(&loop, UV_LOOP_METRICS, NULL));
+  i = metrics.iterations;
+  ASSERT(0 == uv_run(&loop, UV_RUN_NOWAIT));
+  ASSERT(i == (int) metrics.iterations);
+
+  ASSERT(0 == uv_loop_close(&loop));
+  MAKE_VALGRIND_HAPPY();
+  return 0;
+}
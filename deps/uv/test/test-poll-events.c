@@ -0,0 +1,94 @@
+/* Copyright Joyent, Inc. and other Node contributors. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "uv.h"
+#include "task.h"
+
+#ifndef _WIN32
+# include <sys/socket.h>
+# include <unistd.h>
+#endif
+
+#define NUM_SOCKETS 16
+
+static uv_poll_t poll_handles[NUM_SOCKETS];
+static int fds[NUM_SOCKETS][2];
+static int poll_cb_called;
+static int close_cb_called;
+
+
+static void close_cb(uv_handle_t* handle) {
+  close_cb_called++;
+}
+
+
+static void poll_cb(uv_poll_t* handle, int status, int events) {
+  char c;
+  int i;
+
+  ASSERT(status == 0);
+  ASSERT(events == UV_READABLE);
+
+  i = handle - poll_handles;
+  ASSERT(1 == read(fds[i][0], &c, 1));
+  poll_cb_called++;
+  uv_close((uv_handle_t*) handle, close_cb);
+}
+
+
+TEST_IMPL(loop_poll_events) {
+#if defined(__linux__)
+  uv_loop_t loop;
+  int i;
+
+  ASSERT(0 == uv_loop_init(&loop));
+  ASSERT(UV_EINVAL == uv_loop_configure(&loop, UV_LOOP_POLL_EVENTS, 65537u));
+  ASSERT(0 == uv_loop_configure(&loop, UV_LOOP_POLL_EVENTS, 4096u));
+
+  /* With room for a single event, each poll returns one of the ready file
+   * descriptors, and the others are returned by the next polls.
+   */
+  ASSERT(0 == uv_loop_configure(&loop, UV_LOOP_POLL_EVENTS, 1u));
+
+  for (i = 0; i < NUM_SOCKETS; i++) {
+    ASSERT(0 == socketpair(AF_UNIX, SOCK_STREAM, 0, fds[i]));
+    ASSERT(1 == write(fds[i][1], "x", 1));
+    ASSERT(0 == uv_poll_init(&loop, &poll_handles[i], fds[i][0]));
+    ASSERT(0 == uv_poll_start(&poll_handles[i], UV_READABLE, poll_cb));
+  }
+
+  ASSERT(0 == uv_run(&loop, UV_RUN_DEFAULT));
+  ASSERT(poll_cb_called == NUM_SOCKETS);
+  ASSERT(close_cb_called == NUM_SOCKETS);
+
+  for (i = 0; i < NUM_SOCKETS; i++) {
+    close(fds[i][0]);
+    close(fds[i][1]);
+  }
+
+  /* Back to the default array. */
+  ASSERT(0 == uv_loop_configure(&loop, UV_LOOP_POLL_EVENTS, 0u));
+  ASSERT(0 == uv_loop_close(&loop));
+  return 0;
+#else
+  RETURN_SKIP("UV_LOOP_POLL_EVENTS is only implemented on Linux");
+#endif
+}
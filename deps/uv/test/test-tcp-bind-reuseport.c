@@ -0,0 +1,89 @@
+/* Copyright Joyent, Inc. and other Node contributors. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "uv.h"
+#include "task.h"
+
+static int close_cb_called = 0;
+
+
+static void close_cb(uv_handle_t* handle) {
+  ASSERT(handle != NULL);
+  close_cb_called++;
+}
+
+
+static void connection_cb(uv_stream_t* server, int status) {
+  ASSERT(0 && "should not be called");
+}
+
+
+TEST_IMPL(tcp_bind_reuseport) {
+  struct sockaddr_in addr;
+  uv_tcp_t server1;
+  uv_tcp_t server2;
+  uv_tcp_t server3;
+  int r;
+
+  ASSERT(0 == uv_ip4_addr("127.0.0.1", TEST_PORT, &addr));
+
+  ASSERT(0 == uv_tcp_init(uv_default_loop(), &server1));
+  ASSERT(0 == uv_tcp_init(uv_default_loop(), &server2));
+  ASSERT(0 == uv_tcp_init(uv_default_loop(), &server3));
+
+  r = uv_tcp_bind(&server1, (const struct sockaddr*) &addr, UV_TCP_REUSEPORT);
+#if defined(__linux__) || defined(__FreeBSD__)
+  if (r == UV_ENOTSUP)
+    RETURN_SKIP("SO_REUSEPORT not available");
+#else
+  ASSERT(r == UV_ENOTSUP);
+  uv_close((uv_handle_t*) &server1, close_cb);
+  uv_close((uv_handle_t*) &server2, close_cb);
+  uv_close((uv_handle_t*) &server3, close_cb);
+  uv_run(uv_default_loop(), UV_RUN_DEFAULT);
+  ASSERT(close_cb_called == 3);
+  MAKE_VALGRIND_HAPPY();
+  return 0;
+#endif
+  ASSERT(r == 0);
+  ASSERT(0 == uv_listen((uv_stream_t*) &server1, 128, connection_cb));
+
+  /* Sockets that are bound with the flag share the port. */
+  r = uv_tcp_bind(&server2, (const struct sockaddr*) &addr, UV_TCP_REUSEPORT);
+  ASSERT(r == 0);
+  ASSERT(0 == uv_listen((uv_stream_t*) &server2, 128, connection_cb));
+
+  /* Others don't. */
+  r = uv_tcp_bind(&server3, (const struct sockaddr*) &addr, 0);
+  if (r == 0)
+    r = uv_listen((uv_stream_t*) &server3, 128, connection_cb);
+  ASSERT(r == UV_EADDRINUSE);
+
+  uv_close((uv_handle_t*) &server1, close_cb);
+  uv_close((uv_handle_t*) &server2, close_cb);
+  uv_close((uv_handle_t*) &server3, close_cb);
+
+  ASSERT(0 == uv_run(uv_default_loop(), UV_RUN_DEFAULT));
+  ASSERT(close_cb_called == 3);
+
+  MAKE_VALGRIND_HAPPY();
+  return 0;
+}
@@ -0,0 +1,217 @@
+/* Copyright Joyent, Inc. and other Node contributors. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "uv.h"
+#include "task.h"
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define FILENAME "test_file_sendfile"
+#define FILE_SIZE (1024 * 1024)
+#define FILE_OFFSET 7
+#define EOF_OFFSET (FILE_SIZE - 2)
+
+static uv_tcp_t server;
+static uv_tcp_t client;
+static uv_tcp_t incoming;
+static uv_connect_t connect_req;
+static uv_write_t write_reqs[4];
+static uv_file file;
+static char* expected;
+static size_t expected_len;
+static size_t bytes_read;
+static int write_cb_called;
+static int close_cb_called;
+
+
+static char file_byte(size_t offset) {
+  return (char) (offset % 251);
+}
+
+
+static void close_cb(uv_handle_t* handle) {
+  close_cb_called++;
+}
+
+
+static void write_cb(uv_write_t* req, int status) {
+  /* The requests complete in the order they were queued. */
+  ASSERT(req == &write_reqs[write_cb_called]);
+  write_cb_called++;
+
+  if (req == &write_reqs[3]) {
+    ASSERT(status == UV_EOF);
+    uv_close((uv_handle_t*) &client, close_cb);
+  } else {
+    ASSERT(status == 0);
+  }
+}
+
+
+static void connect_cb(uv_connect_t* req, int status) {
+  uv_buf_t buf;
+
+  ASSERT(status == 0);
+
+  buf = uv_buf_init("head", 4);
+  ASSERT(0 == uv_write(&write_reqs[0],
+                       (uv_stream_t*) &client,
+                       &buf,
+                       1,
+                       write_cb));
+  ASSERT(0 == uv_sendfile(&write_reqs[1],
+                          (uv_stream_t*) &client,
+                          file,
+                          FILE_OFFSET,
+                          FILE_SIZE - FILE_OFFSET,
+                          write_cb));
+  buf = uv_buf_init("tail", 4);
+  ASSERT(0 == uv_write(&write_reqs[2],
+                       (uv_stream_t*) &client,
+                       &buf,
+                       1,
+                       write_cb));
+  /* Asks for more than what is left in the file. */
+  ASSERT(0 == uv_sendfile(&write_reqs[3],
+                          (uv_stream_t*) &client,
+                          file,
+                          EOF_OFFSET,
+                          10,
+                          write_cb));
+}
+
+
+static void alloc_cb(uv_handle_t* handle, size_t size, uv_buf_t* buf) {
+  static char base[64 * 1024];
+
+  buf->base = base;
+  buf->len = sizeof(base);
+}
+
+
+static void read_cb(uv_stream_t* tcp, ssize_t nread, const uv_buf_t* buf) {
+  if (nread < 0) {
+    ASSERT(nread == UV_EOF);
+    uv_close((uv_handle_t*) tcp, close_cb);
+    uv_close((uv_handle_t*) &server, close_cb);
+    return;
+  }
+
+  ASSERT(bytes_read + nread <= expected_len);
+  ASSERT(0 == memcmp(buf->base, expected + bytes_read, nread));
+  bytes_read += nread;
+}
+
+
+static void connection_cb(uv_stream_t* tcp, int status) {
+  ASSERT(status == 0);
+
+  ASSERT(0 == uv_tcp_init(tcp->loop, &incoming));
+  ASSERT(0 == uv_accept(tcp, (uv_stream_t*) &incoming));
+  ASSERT(0 == uv_read_start((uv_stream_t*) &incoming, alloc_cb, read_cb));
+}
+
+
+static void create_file(uv_loop_t* loop) {
+  uv_fs_t req;
+  uv_buf_t buf;
+  char* data;
+  size_t i;
+  int r;
+
+  data = malloc(FILE_SIZE);
+  ASSERT(data != NULL);
+  for (i = 0; i < FILE_SIZE; i++)
+    data[i] = file_byte(i);
+
+  r = uv_fs_open(loop,
+                 &req,
+                 FILENAME,
+                 O_RDWR | O_CREAT | O_TRUNC,
+                 S_IRUSR | S_IWUSR,
+                 NULL);
+  ASSERT(r >= 0);
+  file = r;
+  uv_fs_req_cleanup(&req);
+
+  buf = uv_buf_init(data, FILE_SIZE);
+  r = uv_fs_write(loop, &req, file, &buf, 1, 0, NULL);
+  ASSERT(r == FILE_SIZE);
+  uv_fs_req_cleanup(&req);
+
+  /* What the server should see: "head", the file from FILE_OFFSET on,
+   * "tail" and the two bytes sent before the last request hit EOF.
+   */
+  expected_len = 4 + (FILE_SIZE - FILE_OFFSET) + 4 + (FILE_SIZE - EOF_OFFSET);
+  expected = malloc(expected_len);
+  ASSERT(expected != NULL);
+  memcpy(expected, "head", 4);
+  memcpy(expected + 4, data + FILE_OFFSET, FILE_SIZE - FILE_OFFSET);
+  memcpy(expected + 4 + FILE_SIZE - FILE_OFFSET, "tail", 4);
+  memcpy(expected + expected_len - (FILE_SIZE - EOF_OFFSET),
+         data + EOF_OFFSET,
+         FILE_SIZE - EOF_OFFSET);
+
+  free(data);
+}
+
+
+TEST_IMPL(tcp_sendfile) {
+#if !defined(__linux__)
+  RETURN_SKIP("uv_sendfile() is only implemented on Linux.");
+#else
+  struct sockaddr_in addr;
+  uv_loop_t* loop;
+  uv_fs_t req;
+
+  loop = uv_default_loop();
+  create_file(loop);
+
+  ASSERT(0 == uv_ip4_addr("0.0.0.0", TEST_PORT, &addr));
+  ASSERT(0 == uv_tcp_init(loop, &server));
+  ASSERT(0 == uv_tcp_bind(&server, (struct sockaddr*) &addr, 0));
+  ASSERT(0 == uv_listen((uv_stream_t*) &server, 128, connection_cb));
+
+  ASSERT(0 == uv_ip4_addr("127.0.0.1", TEST_PORT, &addr));
+  ASSERT(0 == uv_tcp_init(loop, &client));
+  ASSERT(0 == uv_tcp_connect(&connect_req,
+                             &client,
+                             (struct sockaddr*) &addr,
+                             connect_cb));
+
+  ASSERT(0 == uv_run(loop, UV_RUN_DEFAULT));
+
+  ASSERT(write_cb_called == 4);
+  ASSERT(close_cb_called == 3);
+  ASSERT(bytes_read == expected_len);
+
+  ASSERT(0 == uv_fs_close(loop, &req, file, NULL));
+  uv_fs_req_cleanup(&req);
+  ASSERT(0 == uv_fs_unlink(loop, &req, FILENAME, NULL));
+  uv_fs_req_cleanup(&req);
+  free(expected);
+
+  MAKE_VALGRIND_HAPPY();
+  return 0;
+#endif
+}
@@ -0,0 +1,218 @@
+/* Copyright Joyent, Inc. and other Node contributors. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "uv.h"
+#include "task.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define DATA_SIZE (4 * 1024 * 1024)
+
+/* The writer connects to server A and the reader to server B. Everything
+ * the writer sends is spliced from the connection accepted by server A to
+ * the one accepted by server B.
+ */
+static uv_tcp_t server_a;
+static uv_tcp_t server_b;
+static uv_tcp_t writer;
+static uv_tcp_t reader;
+static uv_tcp_t incoming_a;
+static uv_tcp_t incoming_b;
+static uv_connect_t connect_reqs[2];
+static uv_write_t write_req;
+static uv_shutdown_t shutdown_reqs[2];
+static char* data;
+static size_t bytes_read;
+static int accepted;
+static int splice_cb_called;
+static int shutdown_cb_called;
+static int close_cb_called;
+
+
+static void close_cb(uv_handle_t* handle) {
+  close_cb_called++;
+}
+
+
+static void alloc_cb(uv_handle_t* handle, size_t size, uv_buf_t* buf) {
+  static char base[64 * 1024];
+
+  buf->base = base;
+  buf->len = sizeof(base);
+}
+
+
+static void read_cb(uv_stream_t* tcp, ssize_t nread, const uv_buf_t* buf) {
+  if (nread < 0) {
+    ASSERT(nread == UV_EOF);
+    ASSERT(bytes_read == DATA_SIZE);
+    uv_close((uv_handle_t*) &reader, close_cb);
+    uv_close((uv_handle_t*) &writer, close_cb);
+    uv_close((uv_handle_t*) &incoming_a, close_cb);
+    uv_close((uv_handle_t*) &incoming_b, close_cb);
+    uv_close((uv_handle_t*) &server_a, close_cb);
+    uv_close((uv_handle_t*) &server_b, close_cb);
+    return;
+  }
+
+  ASSERT(bytes_read + nread <= DATA_SIZE);
+  ASSERT(0 == memcmp(buf->base, data + bytes_read, nread));
+  bytes_read += nread;
+}
+
+
+static void shutdown_cb(uv_shutdown_t* req, int status) {
+  ASSERT(status == 0);
+  shutdown_cb_called++;
+}
+
+
+static void splice_cb(uv_stream_t* source,
+                      int read_status,
+                      int write_status) {
+  ASSERT(source == (uv_stream_t*) &incoming_a);
+  ASSERT(read_status == UV_EOF);
+  ASSERT(write_status == 0);
+  splice_cb_called++;
+
+  /* Stopping a splice that is over already does nothing. */
+  ASSERT(0 == uv_splice_stop(source));
+  ASSERT(0 == uv_shutdown(&shutdown_reqs[1],
+                          (uv_stream_t*) &incoming_b,
+                          shutdown_cb));
+}
+
+
+static void start_splice(void) {
+  ASSERT(UV_EINVAL == uv_splice_start((uv_stream_t*) &incoming_a,
+                                      (uv_stream_t*) &incoming_a,
+                                      splice_cb));
+  ASSERT(0 == uv_splice_start((uv_stream_t*) &incoming_a,
+                              (uv_stream_t*) &incoming_b,
+                              splice_cb));
+  ASSERT(UV_EBUSY == uv_splice_start((uv_stream_t*) &incoming_a,
+                                     (uv_stream_t*) &writer,
+                                     splice_cb));
+  ASSERT(UV_EBUSY == uv_splice_start((uv_stream_t*) &writer,
+                                     (uv_stream_t*) &incoming_b,
+                                     splice_cb));
+  ASSERT(UV_EBUSY == uv_read_start((uv_stream_t*) &incoming_a,
+                                   alloc_cb,
+                                   read_cb));
+}
+
+
+static void connection_cb(uv_stream_t* server, int status) {
+  uv_tcp_t* incoming;
+
+  ASSERT(status == 0);
+
+  if (server == (uv_stream_t*) &server_a)
+    incoming = &incoming_a;
+  else
+    incoming = &incoming_b;
+
+  ASSERT(0 == uv_tcp_init(server->loop, incoming));
+  ASSERT(0 == uv_accept(server, (uv_stream_t*) incoming));
+
+  if (++accepted == 2)
+    start_splice();
+}
+
+
+static void write_cb(uv_write_t* req, int status) {
+  ASSERT(status == 0);
+}
+
+
+static void connect_cb(uv_connect_t* req, int status) {
+  uv_buf_t buf;
+
+  ASSERT(status == 0);
+
+  if (req->handle == (uv_stream_t*) &reader) {
+    ASSERT(0 == uv_read_start(req->handle, alloc_cb, read_cb));
+    return;
+  }
+
+  buf = uv_buf_init(data, DATA_SIZE);
+  ASSERT(0 == uv_write(&write_req, req->handle, &buf, 1, write_cb));
+  ASSERT(0 == uv_shutdown(&shutdown_reqs[0], req->handle, shutdown_cb));
+}
+
+
+static void listen_on(uv_loop_t* loop, uv_tcp_t* server, int port) {
+  struct sockaddr_in addr;
+
+  ASSERT(0 == uv_ip4_addr("0.0.0.0", port, &addr));
+  ASSERT(0 == uv_tcp_init(loop, server));
+  ASSERT(0 == uv_tcp_bind(server, (struct sockaddr*) &addr, 0));
+  ASSERT(0 == uv_listen((uv_stream_t*) server, 128, connection_cb));
+}
+
+
+static void connect_to(uv_loop_t* loop,
+                       uv_connect_t* req,
+                       uv_tcp_t* client,
+                       int port) {
+  struct sockaddr_in addr;
+
+  ASSERT(0 == uv_ip4_addr("127.0.0.1", port, &addr));
+  ASSERT(0 == uv_tcp_init(loop, client));
+  ASSERT(0 == uv_tcp_connect(req,
+                             client,
+                             (struct sockaddr*) &addr,
+                             connect_cb));
+}
+
+
+TEST_IMPL(tcp_splice) {
+#if !defined(__linux__)
+  RETURN_SKIP("uv_splice_start() is only implemented on Linux.");
+#else
+  uv_loop_t* loop;
+  size_t i;
+
+  data = malloc(DATA_SIZE);
+  ASSERT(data != NULL);
+  for (i = 0; i < DATA_SIZE; i++)
+    data[i] = (char) (i % 251);
+
+  loop = uv_default_loop();
+  listen_on(loop, &server_a, TEST_PORT);
+  listen_on(loop, &server_b, TEST_PORT_2);
+  connect_to(loop, &connect_reqs[0], &writer, TEST_PORT);
+  connect_to(loop, &connect_reqs[1], &reader, TEST_PORT_2);
+
+  ASSERT(0 == uv_run(loop, UV_RUN_DEFAULT));
+
+  ASSERT(splice_cb_called == 1);
+  ASSERT(shutdown_cb_called == 2);
+  ASSERT(close_cb_called == 6);
+  ASSERT(bytes_read == DATA_SIZE);
+
+  free(data);
+
+  MAKE_VALGRIND_HAPPY();
+  return 0;
+#endif
+}
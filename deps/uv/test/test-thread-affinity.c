@@ -0,0 +1,165 @@
+/* Copyright Joyent, Inc. and other Node contributors. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "uv.h"
+#include "task.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+static char* expected_mask;
+static int mask_size;
+static int work_cb_called;
+static int after_work_cb_called;
+
+
+static int first_cpu(const char* mask) {
+  int i;
+
+  for (i = 0; i < mask_size; i++)
+    if (mask[i])
+      return i;
+
+  return -1;
+}
+
+
+static void check_affinity(void* arg) {
+  uv_thread_t self;
+  char* mask;
+
+  mask = malloc(mask_size);
+  ASSERT(mask != NULL);
+  self = uv_thread_self();
+  ASSERT(0 == uv_thread_getaffinity(&self, mask, mask_size));
+  ASSERT(0 == memcmp(mask, expected_mask, mask_size));
+  free(mask);
+}
+
+
+static void work_cb(uv_work_t* req) {
+  check_affinity(NULL);
+  work_cb_called++;
+}
+
+
+static void after_work_cb(uv_work_t* req, int status) {
+  ASSERT(status == 0);
+  after_work_cb_called++;
+}
+
+
+TEST_IMPL(thread_affinity) {
+  uv_thread_t self;
+  uv_thread_t thread;
+  char* mask;
+  char* oldmask;
+  int cpu;
+
+  mask_size = uv_cpumask_size();
+  if (mask_size == UV_ENOTSUP)
+    RETURN_SKIP("CPU affinity is not supported on this platform");
+  ASSERT(mask_size > 0);
+
+  mask = calloc(1, mask_size);
+  oldmask = calloc(1, mask_size);
+  expected_mask = calloc(1, mask_size);
+  ASSERT(mask != NULL && oldmask != NULL && expected_mask != NULL);
+
+  self = uv_thread_self();
+  ASSERT(UV_EINVAL == uv_thread_getaffinity(&self, mask, mask_size - 1));
+  ASSERT(0 == uv_thread_getaffinity(&self, mask, mask_size));
+  cpu = first_cpu(mask);
+  ASSERT(cpu >= 0);
+
+  /* Pin the thread to its first CPU, and get the old mask back. */
+  expected_mask[cpu] = 1;
+  ASSERT(0 == uv_thread_setaffinity(&self, expected_mask, oldmask, mask_size));
+  ASSERT(0 == memcmp(mask, oldmask, mask_size));
+  check_affinity(NULL);
+
+  /* New threads inherit it. */
+  ASSERT(0 == uv_thread_create(&thread, check_affinity, NULL));
+  ASSERT(0 == uv_thread_join(&thread));
+
+  ASSERT(0 == uv_thread_setaffinity(&self, oldmask, NULL, mask_size));
+  memcpy(expected_mask, oldmask, mask_size);
+  check_affinity(NULL);
+
+  free(mask);
+  free(oldmask);
+  free(expected_mask);
+  return 0;
+}
+
+
+TEST_IMPL(threadpool_affinity) {
+  uv_thread_t self;
+  uv_work_t req;
+  int cpu;
+
+  mask_size = uv_cpumask_size();
+  if (mask_size == UV_ENOTSUP) {
+    ASSERT(UV_ENOTSUP == uv_threadpool_set_affinity(UV_THREADPOOL_CPU,
+                                                    NULL,
+                                                    0));
+    RETURN_SKIP("CPU affinity is not supported on this platform");
+  }
+
+  expected_mask = calloc(1, mask_size);
+  ASSERT(expected_mask != NULL);
+  self = uv_thread_self();
+  ASSERT(0 == uv_thread_getaffinity(&self, expected_mask, mask_size));
+  cpu = first_cpu(expected_mask);
+  ASSERT(cpu >= 0);
+  memset(expected_mask, 0, mask_size);
+  expected_mask[cpu] = 1;
+
+  ASSERT(UV_EINVAL == uv_threadpool_set_affinity(UV_THREADPOOL_CPU,
+                                                 expected_mask,
+                                                 mask_size - 1));
+  ASSERT(UV_EINVAL == uv_threadpool_set_affinity((uv_threadpool_queue) 42,
+                                                 expected_mask,
+                                                 mask_size));
+
+  /* Before the threads start, then for the threads that are running. */
+  ASSERT(0 == uv_threadpool_set_affinity(UV_THREADPOOL_CPU,
+                                         expected_mask,
+                                         mask_size));
+  ASSERT(0 == uv_queue_work(uv_default_loop(), &req, work_cb, after_work_cb));
+  ASSERT(0 == uv_run(uv_default_loop(), UV_RUN_DEFAULT));
+
+  memset(expected_mask, 0, mask_size);
+  ASSERT(0 == uv_thread_getaffinity(&self, expected_mask, mask_size));
+  ASSERT(0 == uv_threadpool_set_affinity(UV_THREADPOOL_CPU,
+                                         expected_mask,
+                                         mask_size));
+  ASSERT(0 == uv_queue_work(uv_default_loop(), &req, work_cb, after_work_cb));
+  ASSERT(0 == uv_run(uv_default_loop(), UV_RUN_DEFAULT));
+
+  ASSERT(work_cb_called == 2);
+  ASSERT(after_work_cb_called == 2);
+  ASSERT(0 == uv_threadpool_set_affinity(UV_THREADPOOL_CPU, NULL, 0));
+
+  free(expected_mask);
+  MAKE_VALGRIND_HAPPY();
+  return 0;
+}
@@ -0,0 +1,100 @@
+/* Copyright Joyent, Inc. and other Node contributors. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+
+#include "uv.h"
+#include "task.h"
+
+static uv_mutex_t wait_mutex;
+static uv_sem_t started;
+static uv_work_t blocker_req;
+static uv_work_t work_reqs[6];
+static int order[ARRAY_SIZE(work_reqs)];
+static int nrun;
+
+
+static void blocker_cb(uv_work_t* req) {
+  uv_sem_post(&started);
+  uv_mutex_lock(&wait_mutex);
+  uv_mutex_unlock(&wait_mutex);
+}
+
+
+static void work_cb(uv_work_t* req) {
+  /* There is a single thread, so no locking is needed. */
+  order[nrun++] = (int) (req - work_reqs);
+}
+
+
+static void done_cb(uv_work_t* req, int status) {
+  ASSERT(status == 0);
+}
+
+
+TEST_IMPL(threadpool_priority) {
+  static const uv_work_priority priorities[] = {
+    UV_PRIORITY_LOW,
+    UV_PRIORITY_NORMAL,
+    UV_PRIORITY_HIGH,
+    UV_PRIORITY_LOW,
+    UV_PRIORITY_HIGH,
+    UV_PRIORITY_NORMAL
+  };
+  static const int expected[] = { 2, 4, 1, 5, 0, 3 };
+  unsigned int i;
+
+  ASSERT(0 == uv_mutex_init(&wait_mutex));
+  ASSERT(0 == uv_sem_init(&started, 0));
+  ASSERT(0 == uv_threadpool_set_size(UV_THREADPOOL_CPU, 1));
+
+  /* Keep the only thread busy until all the work is queued. */
+  uv_mutex_lock(&wait_mutex);
+  ASSERT(0 == uv_queue_work(uv_default_loop(),
+                            &blocker_req,
+                            blocker_cb,
+                            done_cb));
+  uv_sem_wait(&started);
+
+  for (i = 0; i < ARRAY_SIZE(work_reqs); i++)
+    ASSERT(0 == uv_queue_work_priority(uv_default_loop(),
+                                       work_reqs + i,
+                                       work_cb,
+                                       done_cb,
+                                       priorities[i]));
+  uv_mutex_unlock(&wait_mutex);
+
+  ASSERT(0 == uv_run(uv_default_loop(), UV_RUN_DEFAULT));
+  ASSERT(nrun == ARRAY_SIZE(work_reqs));
+  for (i = 0; i < ARRAY_SIZE(expected); i++)
+    ASSERT(order[i] == expected[i]);
+
+  ASSERT(UV_EINVAL == uv_queue_work_priority(uv_default_loop(),
+                                             work_reqs,
+                                             work_cb,
+                                             done_cb,
+                                             (uv_work_priority) 42));
+
+  uv_sem_destroy(&started);
+  uv_mutex_destroy(&wait_mutex);
+
+  MAKE_VALGRIND_HAPPY();
+  return 0;
+}
@@ -0,0 +1,151 @@
+/* Copyright Joyent, Inc. and other Node contributors. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+
+#include "uv.h"
+#include "task.h"
+
+static uv_mutex_t wait_mutex;
+static uv_work_t work_reqs[16];
+static uv_fs_t fs_req;
+static int done_cb_called;
+static int fs_cb_called;
+static uv_work_t crypto_req;
+static int crypto_cb_called;
+
+
+static void work_cb(uv_work_t* req) {
+  uv_mutex_lock(&wait_mutex);
+  uv_mutex_unlock(&wait_mutex);
+}
+
+
+static void done_cb(uv_work_t* req, int status) {
+  ASSERT(status == 0);
+  done_cb_called++;
+}
+
+
+static void crypto_work_cb(uv_work_t* req) {
+  ASSERT(req == &crypto_req);
+}
+
+
+static void crypto_done_cb(uv_work_t* req, int status) {
+  ASSERT(status == 0);
+  /* The cpu queue is still blocked. */
+  ASSERT(done_cb_called == 0);
+  crypto_cb_called++;
+  if (fs_cb_called > 0)
+    uv_mutex_unlock(&wait_mutex);
+}
+
+
+static void fs_cb(uv_fs_t* req) {
+  ASSERT(req == &fs_req);
+  ASSERT(req->result == 0);
+  /* The cpu queue is still blocked. */
+  ASSERT(done_cb_called == 0);
+  uv_fs_req_cleanup(req);
+  fs_cb_called++;
+  if (crypto_cb_called > 0)
+    uv_mutex_unlock(&wait_mutex);
+}
+
+
+TEST_IMPL(threadpool_size) {
+  ASSERT(uv_threadpool_get_size(UV_THREADPOOL_FS) == 0);
+  ASSERT(uv_threadpool_get_size(UV_THREADPOOL_DNS) == 0);
+  ASSERT(uv_threadpool_get_size(UV_THREADPOOL_CRYPTO) == 0);
+  ASSERT(uv_threadpool_get_size(UV_THREADPOOL_CPU) > 0);
+
+  ASSERT(uv_threadpool_set_size(UV_THREADPOOL_CPU, 0) == UV_EINVAL);
+  ASSERT(uv_threadpool_set_size(UV_THREADPOOL_CPU, 129) == UV_EINVAL);
+  ASSERT(uv_threadpool_set_size((uv_threadpool_queue) 42, 1) == UV_EINVAL);
+  ASSERT(uv_threadpool_get_size((uv_threadpool_queue) 42) == UV_EINVAL);
+
+  ASSERT(uv_threadpool_set_size(UV_THREADPOOL_CPU, 2) == 0);
+  ASSERT(uv_threadpool_get_size(UV_THREADPOOL_CPU) == 2);
+  ASSERT(uv_threadpool_set_size(UV_THREADPOOL_DNS, 1) == 0);
+  ASSERT(uv_threadpool_get_size(UV_THREADPOOL_DNS) == 1);
+  ASSERT(uv_threadpool_set_size(UV_THREADPOOL_DNS, 0) == 0);
+
+  ASSERT(uv_queue_work_ex(uv_default_loop(),
+                          work_reqs,
+                          work_cb,
+                          done_cb,
+                          (uv_threadpool_queue) 42,
+                          UV_PRIORITY_NORMAL) == UV_EINVAL);
+
+  MAKE_VALGRIND_HAPPY();
+  return 0;
+}
+
+
+TEST_IMPL(threadpool_size_separate_queues) {
+  unsigned int i;
+
+  ASSERT(0 == uv_mutex_init(&wait_mutex));
+  ASSERT(0 == uv_threadpool_set_size(UV_THREADPOOL_CPU, 2));
+  ASSERT(0 == uv_threadpool_set_size(UV_THREADPOOL_FS, 1));
+  ASSERT(0 == uv_threadpool_set_size(UV_THREADPOOL_CRYPTO, 1));
+
+  /* Block every cpu thread; the fs request must still complete. */
+  uv_mutex_lock(&wait_mutex);
+  for (i = 0; i < ARRAY_SIZE(work_reqs); i++)
+    ASSERT(0 == uv_queue_work(uv_default_loop(),
+                              work_reqs + i,
+                              work_cb,
+                              done_cb));
+  ASSERT(0 == uv_fs_stat(uv_default_loop(), &fs_req, ".", fs_cb));
+
+  /* So does work queued to the crypto queue, it has its own thread. */
+  ASSERT(0 == uv_queue_work_ex(uv_default_loop(),
+                               &crypto_req,
+                               crypto_work_cb,
+                               crypto_done_cb,
+                               UV_THREADPOOL_CRYPTO,
+                               UV_PRIORITY_NORMAL));
+
+  /* Shrinking and growing the cpu queue while it is busy. */
+  ASSERT(0 == uv_threadpool_set_size(UV_THREADPOOL_CPU, 1));
+  ASSERT(0 == uv_threadpool_set_size(UV_THREADPOOL_CPU, 4));
+
+  ASSERT(0 == uv_run(uv_default_loop(), UV_RUN_DEFAULT));
+  ASSERT(fs_cb_called == 1);
+  ASSERT(crypto_cb_called == 1);
+  ASSERT(done_cb_called == ARRAY_SIZE(work_reqs));
+  ASSERT(0 == uv_threadpool_set_size(UV_THREADPOOL_CRYPTO, 0));
+
+  /* Without threads of its own, fs work runs on the cpu threads again. */
+  ASSERT(0 == uv_threadpool_set_size(UV_THREADPOOL_FS, 0));
+  uv_mutex_lock(&wait_mutex);
+  fs_cb_called = 0;
+  done_cb_called = 0;
+  ASSERT(0 == uv_fs_stat(uv_default_loop(), &fs_req, ".", fs_cb));
+  ASSERT(0 == uv_run(uv_default_loop(), UV_RUN_DEFAULT));
+  ASSERT(fs_cb_called == 1);
+
+  uv_mutex_destroy(&wait_mutex);
+
+  MAKE_VALGRIND_HAPPY();
+  return 0;
+}
@@ -0,0 +1,89 @@
+/* Copyright Joyent, Inc. and other Node contributors. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+
+#include "uv.h"
+#include "task.h"
+
+static uv_work_t work_reqs[8];
+static uv_fs_t fs_req;
+
+
+static void work_cb(uv_work_t* req) {
+  uv_sleep(10);
+}
+
+
+static void done_cb(uv_work_t* req, int status) {
+  ASSERT(status == 0);
+}
+
+
+static void fs_cb(uv_fs_t* req) {
+  ASSERT(req->result == 0);
+  uv_fs_req_cleanup(req);
+}
+
+
+TEST_IMPL(threadpool_stats) {
+  uv_threadpool_stats_t stats;
+  unsigned int i;
+
+  ASSERT(UV_EINVAL == uv_threadpool_get_stats((uv_threadpool_queue) 42,
+                                              &stats));
+  ASSERT(UV_EINVAL == uv_threadpool_get_stats(UV_THREADPOOL_CPU, NULL));
+
+  ASSERT(0 == uv_threadpool_set_size(UV_THREADPOOL_CPU, 2));
+  for (i = 0; i < ARRAY_SIZE(work_reqs); i++)
+    ASSERT(0 == uv_queue_work(uv_default_loop(),
+                              work_reqs + i,
+                              work_cb,
+                              done_cb));
+  ASSERT(0 == uv_fs_stat(uv_default_loop(), &fs_req, ".", fs_cb));
+
+  ASSERT(0 == uv_threadpool_get_stats(UV_THREADPOOL_CPU, &stats));
+  ASSERT(stats.submitted == ARRAY_SIZE(work_reqs));
+  ASSERT(stats.max_queued >= ARRAY_SIZE(work_reqs) - 2);
+
+  ASSERT(0 == uv_run(uv_default_loop(), UV_RUN_DEFAULT));
+
+  ASSERT(0 == uv_threadpool_get_stats(UV_THREADPOOL_CPU, &stats));
+  ASSERT(stats.submitted == ARRAY_SIZE(work_reqs));
+  ASSERT(stats.completed == ARRAY_SIZE(work_reqs));
+  ASSERT(stats.queued == 0);
+  ASSERT(stats.running == 0);
+  ASSERT(stats.run_time >= ARRAY_SIZE(work_reqs) * 10 * 1000000ULL);
+  ASSERT(stats.max_run_time >= 10 * 1000000ULL);
+  ASSERT(stats.max_run_time <= stats.run_time);
+  /* With two threads, the last requests waited for at least three others. */
+  ASSERT(stats.max_wait_time >= 30 * 1000000ULL);
+  ASSERT(stats.max_wait_time <= stats.wait_time);
+
+  /* The fs request ran on the shared threads, but is counted separately. */
+  ASSERT(0 == uv_threadpool_get_stats(UV_THREADPOOL_FS, &stats));
+  ASSERT(stats.submitted == 1);
+  ASSERT(stats.completed == 1);
+  ASSERT(0 == uv_threadpool_get_stats(UV_THREADPOOL_DNS, &stats));
+  ASSERT(stats.submitted == 0);
+
+  MAKE_VALGRIND_HAPPY();
+  return 0;
+}
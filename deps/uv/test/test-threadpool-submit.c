@@ -0,0 +1,99 @@
+/* Copyright Joyent, Inc. and other Node contributors. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+
+#include "uv.h"
+#include "task.h"
+
+#define NUM_TASKS 16
+
+static uv_sem_t done;
+static uv_thread_t thread;
+static uv_threadpool_task_t* tasks;
+static int nrun[NUM_TASKS];
+
+
+static void task_cb(uv_threadpool_task_t* task) {
+  nrun[(int) (task - tasks)] += 1;
+  uv_sem_post(&done);
+}
+
+
+static void free_cb(uv_threadpool_task_t* task) {
+  free(task);
+  uv_sem_post(&done);
+}
+
+
+static void submit(void* arg) {
+  unsigned int i;
+
+  for (i = 0; i < NUM_TASKS; i++)
+    ASSERT(0 == uv_threadpool_submit(tasks + i,
+                                     task_cb,
+                                     UV_THREADPOOL_CPU,
+                                     UV_PRIORITY_HIGH));
+}
+
+
+TEST_IMPL(threadpool_submit) {
+  uv_threadpool_task_t* task;
+  unsigned int i;
+
+  ASSERT(0 == uv_sem_init(&done, 0));
+  tasks = malloc(NUM_TASKS * sizeof(*tasks));
+  ASSERT(tasks != NULL);
+
+  /* Not from a loop thread. */
+  ASSERT(0 == uv_thread_create(&thread, submit, NULL));
+  ASSERT(0 == uv_thread_join(&thread));
+  for (i = 0; i < NUM_TASKS; i++)
+    uv_sem_wait(&done);
+  for (i = 0; i < NUM_TASKS; i++)
+    ASSERT(nrun[i] == 1);
+
+  /* The callback may free the task. */
+  task = malloc(sizeof(*task));
+  ASSERT(task != NULL);
+  ASSERT(0 == uv_threadpool_submit(task,
+                                   free_cb,
+                                   UV_THREADPOOL_FS,
+                                   UV_PRIORITY_LOW));
+  uv_sem_wait(&done);
+
+  ASSERT(UV_EINVAL == uv_threadpool_submit(tasks, NULL,
+                                           UV_THREADPOOL_CPU,
+                                           UV_PRIORITY_NORMAL));
+  ASSERT(UV_EINVAL == uv_threadpool_submit(tasks, task_cb,
+                                           (uv_threadpool_queue) 42,
+                                           UV_PRIORITY_NORMAL));
+  ASSERT(UV_EINVAL == uv_threadpool_submit(tasks, task_cb,
+                                           UV_THREADPOOL_CPU,
+                                           (uv_work_priority) 42));
+
+  /* Tasks don't keep the loop alive. */
+  ASSERT(0 == uv_run(uv_default_loop(), UV_RUN_DEFAULT));
+
+  free(tasks);
+  uv_sem_destroy(&done);
+  MAKE_VALGRIND_HAPPY();
+  return 0;
+}
@@ -0,0 +1,133 @@
+/* Copyright Joyent, Inc. and other Node contributors. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "uv.h"
+#include "task.h"
+
+#include <limits.h>
+#include <stdlib.h>
+
+#define NUM_TIMERS 256
+
+static uv_timer_t timers[NUM_TIMERS];
+static uint64_t timeouts[NUM_TIMERS];
+static uint64_t start_time;
+static uv_timer_t* last_fired;
+static int timer_cb_called;
+static int close_cb_called;
+
+
+static void close_cb(uv_handle_t* handle) {
+  close_cb_called++;
+}
+
+
+static void timer_cb(uv_timer_t* handle) {
+  int i;
+  int j;
+
+  i = handle - timers;
+  ASSERT(uv_now(handle->loop) >= start_time + timeouts[i]);
+
+  /* In the order of the timeouts, and of the starts for equal timeouts. */
+  if (last_fired != NULL) {
+    j = last_fired - timers;
+    ASSERT(timeouts[j] < timeouts[i] || (timeouts[j] == timeouts[i] && j < i));
+  }
+
+  last_fired = handle;
+  timer_cb_called++;
+  uv_close((uv_handle_t*) handle, close_cb);
+}
+
+
+static void never_cb(uv_timer_t* handle) {
+  FATAL("never_cb should not have been called");
+}
+
+
+TEST_IMPL(timer_wheel) {
+#ifndef _WIN32
+  uv_timer_t far_timer;
+  uv_loop_t loop;
+  int i;
+
+  ASSERT(0 == uv_loop_init(&loop));
+  ASSERT(0 == uv_loop_configure(&loop, UV_LOOP_TIMER_WHEEL));
+  ASSERT(0 == uv_loop_configure(&loop, UV_LOOP_TIMER_WHEEL));
+
+  /* The poll timeout is that of the first timer, wherever it is in the wheel.
+   * 100 s is in the third level, 2^60 ms beyond the last.
+   */
+  ASSERT(0 == uv_timer_init(&loop, &far_timer));
+  ASSERT(0 == uv_timer_start(&far_timer, never_cb, (uint64_t) 1 << 60, 0));
+  ASSERT(INT_MAX == uv_backend_timeout(&loop));
+  ASSERT(0 == uv_timer_start(&far_timer, never_cb, 100000, 0));
+  ASSERT(100000 == uv_backend_timeout(&loop));
+  ASSERT(0 == uv_timer_stop(&far_timer));
+
+  /* Timeouts across the first two levels, with some of them repeated. */
+  srand(42);
+  start_time = uv_now(&loop);
+  for (i = 0; i < NUM_TIMERS; i++) {
+    timeouts[i] = i % 4 == 0 ? 100 : rand() % 300;
+    ASSERT(0 == uv_timer_init(&loop, &timers[i]));
+    ASSERT(0 == uv_timer_start(&timers[i], timer_cb, timeouts[i], 0));
+  }
+
+  /* Stopped timers leave the wheel. */
+  ASSERT(0 == uv_timer_start(&far_timer, never_cb, 150, 0));
+  ASSERT(0 == uv_timer_stop(&far_timer));
+  uv_close((uv_handle_t*) &far_timer, close_cb);
+
+  ASSERT(0 == uv_run(&loop, UV_RUN_DEFAULT));
+  ASSERT(timer_cb_called == NUM_TIMERS);
+  ASSERT(close_cb_called == NUM_TIMERS + 1);
+
+  ASSERT(0 == uv_loop_close(&loop));
+  return 0;
+#else
+  RETURN_SKIP("UV_LOOP_TIMER_WHEEL is not implemented on Windows");
+#endif
+}
+
+
+TEST_IMPL(timer_wheel_busy) {
+#ifndef _WIN32
+  uv_timer_t timer;
+  uv_loop_t loop;
+
+  ASSERT(0 == uv_loop_init(&loop));
+  ASSERT(0 == uv_timer_init(&loop, &timer));
+  ASSERT(0 == uv_timer_start(&timer, never_cb, 1000, 0));
+  ASSERT(UV_EBUSY == uv_loop_configure(&loop, UV_LOOP_TIMER_WHEEL));
+
+  ASSERT(0 == uv_timer_stop(&timer));
+  ASSERT(0 == uv_loop_configure(&loop, UV_LOOP_TIMER_WHEEL));
+  uv_close((uv_handle_t*) &timer, NULL);
+  ASSERT(0 == uv_run(&loop, UV_RUN_DEFAULT));
+
+  ASSERT(0 == uv_loop_close(&loop));
+  return 0;
+#else
+  RETURN_SKIP("UV_LOOP_TIMER_WHEEL is not implemented on Windows");
+#endif
+}
@@ -0,0 +1,159 @@
+/* Copyright libuv project contributors. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "uv.h"
+#include "task.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define CHECK_HANDLE(handle) \
+  ASSERT((uv_udp_t*)(handle) == &recver || (uv_udp_t*)(handle) == &sender)
+
+#define SEGMENT_SIZE 100
+#define NUM_SEGMENTS 4
+
+static uv_udp_t recver;
+static uv_udp_t sender;
+static uv_udp_send_t send_req;
+static char payload[SEGMENT_SIZE * NUM_SEGMENTS];
+static char recv_base[64 * 1024];
+static size_t bytes_received;
+static int send_status = 1;  /* Not called yet. */
+static int recv_cb_called;
+static int coalesced;
+static int close_cb_called;
+
+
+static void alloc_cb(uv_handle_t* handle,
+                     size_t suggested_size,
+                     uv_buf_t* buf) {
+  CHECK_HANDLE(handle);
+  *buf = uv_buf_init(recv_base, sizeof(recv_base));
+}
+
+
+static void close_cb(uv_handle_t* handle) {
+  CHECK_HANDLE(handle);
+  close_cb_called++;
+}
+
+
+static void close_both(void) {
+  uv_close((uv_handle_t*) &recver, close_cb);
+  uv_close((uv_handle_t*) &sender, close_cb);
+}
+
+
+static void send_cb(uv_udp_send_t* req, int status) {
+  CHECK_HANDLE(req->handle);
+  send_status = status;
+  /* Kernels older than 4.18 don't know UDP_SEGMENT. */
+  if (status != 0)
+    close_both();
+}
+
+
+static void recv_cb(uv_udp_t* handle,
+                    ssize_t nread,
+                    const uv_buf_t* rcvbuf,
+                    const struct sockaddr* addr,
+                    unsigned flags) {
+  unsigned int segment_size;
+
+  ASSERT(nread >= 0);
+  if (nread == 0)
+    return;
+
+  /* Segments arrive one by one, or together when they were coalesced. */
+  segment_size = uv_udp_get_recv_segment_size(handle);
+  if (segment_size != 0) {
+    ASSERT(segment_size == SEGMENT_SIZE);
+    coalesced++;
+  } else {
+    ASSERT(nread == SEGMENT_SIZE);
+  }
+  ASSERT(nread % SEGMENT_SIZE == 0);
+  ASSERT(memcmp(payload + bytes_received, rcvbuf->base, nread) == 0);
+
+  recv_cb_called++;
+  bytes_received += nread;
+  if (bytes_received == sizeof(payload))
+    close_both();
+}
+
+
+TEST_IMPL(udp_gso) {
+#if !defined(__linux__)
+  RETURN_SKIP("UDP segmentation offload is Linux-only.");
+#else
+  struct sockaddr_in addr;
+  uv_buf_t buf;
+  size_t i;
+  int r;
+
+  for (i = 0; i < sizeof(payload); i++)
+    payload[i] = 'a' + i / SEGMENT_SIZE;
+
+  ASSERT(0 == uv_ip4_addr("0.0.0.0", TEST_PORT, &addr));
+  ASSERT(0 == uv_udp_init(uv_default_loop(), &recver));
+  ASSERT(0 == uv_udp_bind(&recver, (const struct sockaddr*) &addr, 0));
+  r = uv_udp_set_gro(&recver, 1);
+  ASSERT(r == 0 || r == UV_ENOPROTOOPT);
+  ASSERT(0 == uv_udp_recv_start(&recver, alloc_cb, recv_cb));
+
+  ASSERT(0 == uv_ip4_addr("127.0.0.1", TEST_PORT, &addr));
+  ASSERT(0 == uv_udp_init(uv_default_loop(), &sender));
+
+  ASSERT(UV_EINVAL == uv_udp_send_gso(&send_req,
+                                      &sender,
+                                      &buf,
+                                      1,
+                                      (const struct sockaddr*) &addr,
+                                      0,
+                                      send_cb));
+
+  buf = uv_buf_init(payload, sizeof(payload));
+  ASSERT(0 == uv_udp_send_gso(&send_req,
+                              &sender,
+                              &buf,
+                              1,
+                              (const struct sockaddr*) &addr,
+                              SEGMENT_SIZE,
+                              send_cb));
+
+  ASSERT(0 == uv_run(uv_default_loop(), UV_RUN_DEFAULT));
+  ASSERT(close_cb_called == 2);
+
+  if (send_status != 0) {
+    MAKE_VALGRIND_HAPPY();
+    RETURN_SKIP("The kernel doesn't support UDP_SEGMENT.");
+  }
+
+  ASSERT(bytes_received == sizeof(payload));
+  ASSERT(recv_cb_called == NUM_SEGMENTS || coalesced > 0);
+  ASSERT(uv_udp_get_recv_segment_size(&recver) == 0);
+
+  MAKE_VALGRIND_HAPPY();
+  return 0;
+#endif
+}
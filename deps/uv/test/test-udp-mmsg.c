@@ -0,0 +1,155 @@
+/* Copyright libuv project contributors. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "uv.h"
+#include "task.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define CHECK_HANDLE(handle) \
+  ASSERT((uv_udp_t*)(handle) == &recver || (uv_udp_t*)(handle) == &sender)
+
+#define BUFFER_MULTIPLIER 20
+#define MAX_DGRAM_SIZE (64 * 1024)
+#define NUM_SENDS 8
+
+static uv_udp_t recver;
+static uv_udp_t sender;
+static uv_udp_send_t send_reqs[NUM_SENDS];
+static int recv_cb_called;
+static int send_cb_called;
+static int close_cb_called;
+static int free_cb_called;
+
+
+static void alloc_cb(uv_handle_t* handle,
+                     size_t suggested_size,
+                     uv_buf_t* buf) {
+  size_t buffer_size;
+  CHECK_HANDLE(handle);
+
+  /* Only allocate room for multiple datagrams if they can be received. */
+  buffer_size = MAX_DGRAM_SIZE;
+  if (uv_udp_using_recvmmsg((uv_udp_t*) handle))
+    buffer_size *= BUFFER_MULTIPLIER;
+
+  buf->base = malloc(buffer_size);
+  ASSERT(buf->base != NULL);
+  buf->len = buffer_size;
+}
+
+
+static void close_cb(uv_handle_t* handle) {
+  CHECK_HANDLE(handle);
+  ASSERT(uv_is_closing(handle));
+  close_cb_called++;
+}
+
+
+static void send_cb(uv_udp_send_t* req, int status) {
+  ASSERT(status == 0);
+  CHECK_HANDLE(req->handle);
+  send_cb_called++;
+}
+
+
+static void recv_cb(uv_udp_t* handle,
+                    ssize_t nread,
+                    const uv_buf_t* rcvbuf,
+                    const struct sockaddr* addr,
+                    unsigned flags) {
+  ASSERT(nread >= 0);
+
+  if (flags & UV_UDP_MMSG_FREE) {
+    ASSERT(nread == 0);
+    ASSERT(addr == NULL);
+    free_cb_called++;
+    free(rcvbuf->base);
+    return;
+  }
+
+  /* A chunk lives in a buffer that is freed by the UV_UDP_MMSG_FREE call. */
+  if (!(flags & UV_UDP_MMSG_CHUNK)) {
+    ASSERT(uv_udp_using_recvmmsg(handle) == 0 || nread == 0);
+    free(rcvbuf->base);
+  }
+
+  if (nread == 0) {
+    ASSERT(addr == NULL);
+    return;
+  }
+
+  ASSERT(nread == 4);
+  ASSERT(addr != NULL);
+  ASSERT(memcmp("PING", rcvbuf->base, nread) == 0);
+
+  recv_cb_called++;
+  if (recv_cb_called == NUM_SENDS) {
+    uv_close((uv_handle_t*) handle, close_cb);
+    uv_close((uv_handle_t*) &sender, close_cb);
+  }
+}
+
+
+TEST_IMPL(udp_mmsg) {
+  struct sockaddr_in addr;
+  uv_buf_t buf;
+  int i;
+
+  ASSERT(0 == uv_ip4_addr("0.0.0.0", TEST_PORT, &addr));
+  ASSERT(0 == uv_udp_init_ex(uv_default_loop(),
+                             &recver,
+                             AF_UNSPEC | UV_UDP_RECVMMSG));
+  ASSERT(0 == uv_udp_bind(&recver, (const struct sockaddr*) &addr, 0));
+  ASSERT(0 == uv_udp_recv_start(&recver, alloc_cb, recv_cb));
+
+  ASSERT(0 == uv_ip4_addr("127.0.0.1", TEST_PORT, &addr));
+  ASSERT(0 == uv_udp_init(uv_default_loop(), &sender));
+
+  /* All but the first one are queued, and go out together. */
+  buf = uv_buf_init("PING", 4);
+  for (i = 0; i < NUM_SENDS; i++) {
+    ASSERT(0 == uv_udp_send(&send_reqs[i],
+                            &sender,
+                            &buf,
+                            1,
+                            (const struct sockaddr*) &addr,
+                            send_cb));
+  }
+
+  ASSERT(0 == uv_run(uv_default_loop(), UV_RUN_DEFAULT));
+
+  ASSERT(close_cb_called == 2);
+  ASSERT(send_cb_called == NUM_SENDS);
+  ASSERT(recv_cb_called == NUM_SENDS);
+  ASSERT(sender.send_queue_size == 0);
+  ASSERT(recver.send_queue_size == 0);
+
+  if (uv_udp_using_recvmmsg(&recver))
+    ASSERT(free_cb_called > 0);
+  else
+    ASSERT(free_cb_called == 0);
+
+  MAKE_VALGRIND_HAPPY();
+  return 0;
+}
@@ -200,6 +200,7 @@
           'sources': [
             'src/unix/linux-core.c',
             'src/unix/linux-inotify.c',
+            'src/unix/linux-iouring.c',
             'src/unix/linux-syscalls.c',
             'src/unix/linux-syscalls.h',
           ],
@@ -211,6 +212,7 @@
           'sources': [
             'src/unix/linux-core.c',
             'src/unix/linux-inotify.c',
+            'src/unix/linux-iouring.c',
             'src/unix/linux-syscalls.c',
             'src/unix/linux-syscalls.h',
             'src/unix/pthread-fixes.c',
@@ -287,6 +289,8 @@
         'test/test-active.c',
         'test/test-async.c',
         'test/test-async-null-cb.c',
+        'test/test-async-queue.c',
+        'test/test-busy-poll.c',
         'test/test-callback-stack.c',
         'test/test-callback-order.c',
         'test/test-close-fd.c',
@@ -302,6 +306,7 @@
         'test/test-fail-always.c',
         'test/test-fs.c',
         'test/test-fs-event.c',
+        'test/test-fs-io-uring.c',
         'test/test-get-currentexe.c',
         'test/test-get-memory.c',
         'test/test-get-passwd.c',
@@ -322,6 +327,7 @@
         'test/test-loop-stop.c',
         'test/test-loop-time.c',
         'test/test-loop-configure.c',
+        'test/test-loop-metrics.c',
         'test/test-walk-handles.c',
         'test/test-watcher-cross-stop.c',
         'test/test-multiple-listen.c',
@@ -343,6 +349,7 @@
         'test/test-poll-close.c',
         'test/test-poll-close-doesnt-corrupt-stack.c',
         'test/test-poll-closesocket.c',
+        'test/test-poll-events.c',
         'test/test-process-title.c',
         'test/test-queue-foreach-delete.c',
         'test/test-ref.c',
@@ -359,6 +366,7 @@
         'test/test-fs-poll.c',
         'test/test-stdio-over-pipes.c',
         'test/test-tcp-bind-error.c',
+        'test/test-tcp-bind-reuseport.c',
         'test/test-tcp-bind6-error.c',
         'test/test-tcp-close.c',
         'test/test-tcp-close-accept.c',
@@ -376,12 +384,19 @@
         'test/test-tcp-writealot.c',
         'test/test-tcp-write-fail.c',
         'test/test-tcp-try-write.c',
+        'test/test-tcp-sendfile.c',
+        'test/test-tcp-splice.c',
         'test/test-tcp-unexpected-read.c',
         'test/test-tcp-oob.c',
         'test/test-tcp-read-stop.c',
         'test/test-tcp-write-queue-order.c',
         'test/test-threadpool.c',
         'test/test-threadpool-cancel.c',
+        'test/test-threadpool-priority.c',
+        'test/test-threadpool-size.c',
+        'test/test-threadpool-stats.c',
+        'test/test-threadpool-submit.c',
+        'test/test-thread-affinity.c',
         'test/test-thread-equal.c',
         'test/test-tmpdir.c',
         'test/test-mutexes.c',
@@ -391,11 +406,14 @@
         'test/test-timer-again.c',
         'test/test-timer-from-check.c',
         'test/test-timer.c',
+        'test/test-timer-wheel.c',
         'test/test-tty.c',
         'test/test-udp-bind.c',
         'test/test-udp-create-socket-early.c',
         'test/test-udp-dgram-too-big.c',
+        'test/test-udp-gso.c',
         'test/test-udp-ipv6.c',
+        'test/test-udp-mmsg.c',
         'test/test-udp-open.c',
         'test/test-udp-options.c',
         'test/test-udp-send-and-recv.c',
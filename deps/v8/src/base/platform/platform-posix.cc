@@ -132,6 +132,13 @@ void OS::Guard(void* address, const size_t size) {
 }
 
 
+void OS::AdviseHugePages(void* address, const size_t size) {
+#if defined(MADV_HUGEPAGE)
+  madvise(address, size, MADV_HUGEPAGE);
+#endif
+}
+
+
 static LazyInstance<RandomNumberGenerator>::type
     platform_random_number_generator = LAZY_INSTANCE_INITIALIZER;
 
@@ -822,6 +822,9 @@ void OS::Guard(void* address, const size_t size) {
 }
 
 
+void OS::AdviseHugePages(void* address, const size_t size) {}
+
+
 void OS::Sleep(TimeDelta interval) {
   ::Sleep(static_cast<DWORD>(interval.InMilliseconds()));
 }
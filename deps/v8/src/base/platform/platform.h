@@ -184,6 +184,10 @@ class OS {
   // Assign memory as a guard page so that access will cause an exception.
   static void Guard(void* address, const size_t size);
 
+  // Ask the OS to back the range with huge pages.  A hint only, which is
+  // ignored where the OS has no transparent huge pages.
+  static void AdviseHugePages(void* address, const size_t size);
+
   // Generate a random address to be used for hinting mmap().
   static void* GetRandomMmapAddr();
 
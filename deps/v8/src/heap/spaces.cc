@@ -229,12 +229,20 @@ Address CodeRange::AllocateRawMemory(const size_t requested_size,
     ReleaseBlock(&current);
     return NULL;
   }
+  if (FLAG_huge_code_pages) {
+    base::OS::AdviseHugePages(current.start, *allocated);
+  }
   return current.start;
 }
 
 
 bool CodeRange::CommitRawMemory(Address start, size_t length) {
-  return isolate_->memory_allocator()->CommitMemory(start, length, EXECUTABLE);
+  if (!isolate_->memory_allocator()->CommitMemory(start, length, EXECUTABLE)) {
+    return false;
+  }
+  // Committing maps the range again, so the advice has to follow each commit.
+  if (FLAG_huge_code_pages) base::OS::AdviseHugePages(start, length);
+  return true;
 }
 
 
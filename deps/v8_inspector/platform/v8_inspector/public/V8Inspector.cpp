@@ -121,6 +121,12 @@ void V8Inspector::dispatchMessageFromFrontend(const String16& message)
         m_dispatcher->dispatch(1, message);
 }
 
+void V8Inspector::dispatchMessageFromFrontend(PassOwnPtr<protocol::DictionaryValue> message)
+{
+    if (m_dispatcher)
+        m_dispatcher->dispatch(1, message);
+}
+
 int V8Inspector::ensureDefaultContextInGroup(int contextGroupId) {
     return 1;
 }
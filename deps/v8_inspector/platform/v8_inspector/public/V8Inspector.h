@@ -14,6 +14,7 @@
 namespace blink {
 
 namespace protocol {
+class DictionaryValue;
 class Dispatcher;
 class Frontend;
 class FrontendChannel;
@@ -52,6 +53,8 @@ public:
     void connectFrontend(protocol::FrontendChannel*);
     void disconnectFrontend();
     void dispatchMessageFromFrontend(const String16& message);
+    // The message must have been parsed with protocol::parseJSON().
+    void dispatchMessageFromFrontend(PassOwnPtr<protocol::DictionaryValue> message);
 
 private:
     v8::Isolate* m_isolate;
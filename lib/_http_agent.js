@@ -17,6 +17,65 @@ const debug = util.debuglog('http');
 // ClientRequest.onSocket(). The Agent is now *strictly*
 // concerned with managing a connection pool.
 
+// Sockets in use are kept in no particular order, a socket is removed by
+// moving the last one into its place.  Free sockets are a stack: the one
+// that was used last is reused first, so that the sockets that stay idle
+// are the ones that time out.
+const kPoolIndex = Symbol('poolIndex');
+const kRequestOptions = Symbol('requestOptions');
+const kUsed = Symbol('used');
+
+function addActive(sockets, name, socket) {
+  var list = sockets[name];
+  if (!list)
+    list = sockets[name] = [];
+  socket[kPoolIndex] = list.length;
+  list.push(socket);
+}
+
+function removeActive(sockets, name, socket) {
+  const list = sockets[name];
+  if (!list)
+    return false;
+  var index = socket[kPoolIndex];
+  if (list[index] !== socket) {
+    index = list.indexOf(socket);
+    if (index === -1)
+      return false;
+  }
+  const last = list.pop();
+  if (last !== socket) {
+    list[index] = last;
+    last[kPoolIndex] = index;
+  }
+  // Don't leak
+  if (list.length === 0)
+    delete sockets[name];
+  return true;
+}
+
+// Puts a socket into the pool of free sockets of |name|.
+function addFree(agent, name, socket) {
+  var freeSockets = agent.freeSockets[name];
+  if (!freeSockets)
+    freeSockets = agent.freeSockets[name] = [];
+  socket.setKeepAlive(true, agent.keepAliveMsecs);
+  socket.unref();
+  if (agent.freeSocketTimeout > 0) {
+    socket.setTimeout(agent.freeSocketTimeout);
+    socket.once('timeout', agent._onFreeSocketTimeout);
+  }
+  freeSockets.push(socket);
+  agent._freeSocketCount++;
+}
+
+// Sockets that were opened in advance have no request to report their
+// errors to.
+function warmSocketErrorListener(err) {
+  debug('SOCKET ERROR on warm socket:', err.message);
+  this.destroy();
+}
+
 function Agent(options) {
   if (!(this instanceof Agent))
     return new Agent(options);
@@ -39,6 +98,35 @@ function Agent(options) {
   self.keepAlive = self.options.keepAlive || false;
   self.maxSockets = self.options.maxSockets || Agent.defaultMaxSockets;
   self.maxFreeSockets = self.options.maxFreeSockets || 256;
+  self.maxTotalSockets = self.options.maxTotalSockets || Infinity;
+  self.freeSocketTimeout = self.options.freeSocketTimeout || 0;
+  self.minFreeSockets = self.options.minFreeSockets || 0;
+  self.scheduling = self.options.scheduling || 'lifo';
+  if (self.scheduling !== 'lifo' && self.scheduling !== 'fifo')
+    throw new TypeError('"scheduling" must be either "lifo" or "fifo"');
+
+  // Sockets in use and free, and requests waiting for a socket, of all
+  // origins.
+  self.totalSocketCount = 0;
+  self._freeSocketCount = 0;
+  self._pendingRequestCount = 0;
+  // The options of the origins to keep minFreeSockets open for.
+  self._warmOptions = {};
+  self._warmScheduled = {};
+  self._stats = {
+    created: 0,
+    reused: 0,
+    queued: 0,
+    timedOut: 0
+  };
+
+  self._onFreeSocketTimeout = function() {
+    debug('free socket timed out');
+    self._stats.timedOut++;
+    // Idle sockets that time out are not replaced.
+    this[kUsed] = false;
+    this.destroy();
+  };
 
   self.on('free', function(socket, options) {
     var name = self.getName(options);
@@ -46,6 +134,8 @@ function Agent(options) {
 
     if (socket.writable &&
         self.requests[name] && self.requests[name].length) {
+      self._pendingRequestCount--;
+      socket[kUsed] = true;
       self.requests[name].shift().onSocket(socket);
       if (self.requests[name].length === 0) {
         // don't leak
@@ -65,16 +155,15 @@ function Agent(options) {
         if (self.sockets[name])
           count += self.sockets[name].length;
 
-        if (count > self.maxSockets || freeLen >= self.maxFreeSockets) {
+        if (count > self.maxSockets || freeLen >= self.maxFreeSockets ||
+            (self._pendingRequestCount > 0 &&
+             self.totalSocketCount >= self.maxTotalSockets)) {
+          // The last case leaves room for a request of another origin.
           socket.destroy();
         } else {
-          freeSockets = freeSockets || [];
-          self.freeSockets[name] = freeSockets;
-          socket.setKeepAlive(true, self.keepAliveMsecs);
-          socket.unref();
           socket._httpMessage = null;
-          self.removeSocket(socket, options);
-          freeSockets.push(socket);
+          removeActive(self.sockets, name, socket);
+          addFree(self, name, socket);
         }
       } else {
         socket.destroy();
@@ -119,26 +208,40 @@ Agent.prototype.addRequest = function(req, options) {
   options = util._extend(options, this.options);
 
   var name = this.getName(options);
-  if (!this.sockets[name]) {
-    this.sockets[name] = [];
-  }
-
-  var freeLen = this.freeSockets[name] ? this.freeSockets[name].length : 0;
-  var sockLen = freeLen + this.sockets[name].length;
+  var freeSockets = this.freeSockets[name];
+  var freeLen = freeSockets ? freeSockets.length : 0;
+  var sockLen = freeLen;
+  if (this.sockets[name])
+    sockLen += this.sockets[name].length;
 
   if (freeLen) {
     // we have a free socket, so use that.
-    var socket = this.freeSockets[name].shift();
+    var socket;
+    if (this.scheduling === 'lifo')
+      socket = freeSockets.pop();
+    else
+      socket = freeSockets.shift();
     debug('have free socket');
 
     // don't leak
-    if (!this.freeSockets[name].length)
+    if (!freeSockets.length)
       delete this.freeSockets[name];
+    this._freeSocketCount--;
+    this._stats.reused++;
 
+    if (this.freeSocketTimeout > 0) {
+      socket.setTimeout(0);
+      socket.removeListener('timeout', this._onFreeSocketTimeout);
+    }
+    socket.removeListener('error', warmSocketErrorListener);
+    socket[kUsed] = true;
     socket.ref();
     req.onSocket(socket);
-    this.sockets[name].push(socket);
-  } else if (sockLen < this.maxSockets) {
+    addActive(this.sockets, name, socket);
+    if (this.minFreeSockets > 0)
+      this._scheduleWarmUp(name, options);
+  } else if (sockLen < this.maxSockets &&
+             this.totalSocketCount < this.maxTotalSockets) {
     debug('call onSocket', sockLen, freeLen);
     // If we are under maxSockets create a new one.
     this.createSocket(req, options, function(err, newSocket) {
@@ -148,15 +251,36 @@ Agent.prototype.addRequest = function(req, options) {
         });
         return;
       }
+      newSocket[kUsed] = true;
       req.onSocket(newSocket);
     });
+    if (this.minFreeSockets > 0)
+      this._scheduleWarmUp(name, options);
   } else {
     debug('wait for socket');
     // We are over limit so we'll add it to the queue.
     if (!this.requests[name]) {
       this.requests[name] = [];
     }
+    req[kRequestOptions] = options;
     this.requests[name].push(req);
+    this._pendingRequestCount++;
+    this._stats.queued++;
+
+    // Only the limit of all origins stands in the way, make room by closing
+    // a free socket of another origin.
+    if (sockLen < this.maxSockets && this._freeSocketCount > 0)
+      this._destroyFreeSocket();
+  }
+};
+
+// Destroys the free socket that was used longest ago of some origin.
+Agent.prototype._destroyFreeSocket = function() {
+  for (var name in this.freeSockets) {
+    debug('destroy free socket', name);
+    // Its 'close' removes it and creates a socket for a waiting request.
+    this.freeSockets[name][0].destroy();
+    return;
   }
 };
 
@@ -167,7 +291,7 @@ Agent.prototype.createSocket = function(req, options, cb) {
 
   if (!options.servername) {
     options.servername = options.host;
-    const hostHeader = req.getHeader('host');
+    const hostHeader = req && req.getHeader('host');
     if (hostHeader) {
       options.servername = hostHeader.replace(/:.*$/, '');
     }
@@ -188,10 +312,9 @@ Agent.prototype.createSocket = function(req, options, cb) {
     called = true;
     if (err)
       return cb(err);
-    if (!self.sockets[name]) {
-      self.sockets[name] = [];
-    }
-    self.sockets[name].push(s);
+    addActive(self.sockets, name, s);
+    self.totalSocketCount++;
+    self._stats.created++;
     debug('sockets', name, self.sockets[name].length);
 
     function onFree() {
@@ -226,29 +349,55 @@ Agent.prototype.createSocket = function(req, options, cb) {
 Agent.prototype.removeSocket = function(s, options) {
   var name = this.getName(options);
   debug('removeSocket', name, 'writable:', s.writable);
-  var sets = [this.sockets];
+  var removed = removeActive(this.sockets, name, s);
 
   // If the socket was destroyed, remove it from the free buffers too.
-  if (!s.writable)
-    sets.push(this.freeSockets);
-
-  for (var sk = 0; sk < sets.length; sk++) {
-    var sockets = sets[sk];
-
-    if (sockets[name]) {
-      var index = sockets[name].indexOf(s);
-      if (index !== -1) {
-        sockets[name].splice(index, 1);
-        // Don't leak
-        if (sockets[name].length === 0)
-          delete sockets[name];
-      }
+  if (!s.writable) {
+    var freeSockets = this.freeSockets[name];
+    var index = freeSockets ? freeSockets.lastIndexOf(s) : -1;
+    if (index !== -1) {
+      freeSockets.splice(index, 1);
+      // Don't leak
+      if (freeSockets.length === 0)
+        delete this.freeSockets[name];
+      this._freeSocketCount--;
+      removed = true;
     }
   }
 
+  if (removed) {
+    this.totalSocketCount--;
+    // Replace sockets that served requests, like ones the server closed
+    // while they were free.  Sockets that were never used aren't, so that
+    // an origin that refuses connections isn't tried again and again.
+    if (this.minFreeSockets > 0 && s[kUsed] && this._warmOptions[name])
+      this._scheduleWarmUp(name, this._warmOptions[name]);
+  }
+
+  var req;
   if (this.requests[name] && this.requests[name].length) {
     debug('removeSocket, have a request, make a socket');
-    var req = this.requests[name][0];
+    req = this.requests[name][0];
+  } else if (this._pendingRequestCount > 0 &&
+             this.totalSocketCount < this.maxTotalSockets) {
+    // The socket made room for a request of another origin that waits for
+    // the limit of all origins rather than its own.
+    for (var key in this.requests) {
+      var sockLen = 0;
+      if (this.sockets[key])
+        sockLen += this.sockets[key].length;
+      if (this.freeSockets[key])
+        sockLen += this.freeSockets[key].length;
+      if (sockLen < this.maxSockets) {
+        debug('removeSocket, make a socket for', key);
+        req = this.requests[key][0];
+        options = req[kRequestOptions];
+        break;
+      }
+    }
+  }
+
+  if (req) {
     // If we have pending requests and a socket gets closed make a new one
     this.createSocket(req, options, function(err, newSocket) {
       if (err) {
@@ -262,7 +411,91 @@ Agent.prototype.removeSocket = function(s, options) {
   }
 };
 
+// Opens sockets to the origin of |options| in the background, up to
+// minFreeSockets free ones or at least |count|, so that the requests to it
+// don't wait for a connection to be established.
+Agent.prototype.prewarm = function(options, count) {
+  options = util._extend({}, options);
+  options = util._extend(options, this.options);
+  if (count === undefined)
+    count = Math.max(this.minFreeSockets, 1);
+  else if (!Number.isInteger(count) || count < 0)
+    throw new TypeError('"count" must be a non-negative integer');
+  const name = this.getName(options);
+  this._warmOptions[name] = options;
+  this._warmUp(name, count);
+};
+
+Agent.prototype._scheduleWarmUp = function(name, options) {
+  this._warmOptions[name] = options;
+  if (this._warmScheduled[name])
+    return;
+  this._warmScheduled[name] = true;
+  // After the request that got here has its socket.
+  setImmediate(() => {
+    delete this._warmScheduled[name];
+    this._warmUp(name, this.minFreeSockets);
+  });
+};
+
+Agent.prototype._warmUp = function(name, count) {
+  const options = this._warmOptions[name];
+  if (!options)
+    return;
+  var freeLen = this.freeSockets[name] ? this.freeSockets[name].length : 0;
+  var sockLen = freeLen;
+  if (this.sockets[name])
+    sockLen += this.sockets[name].length;
+
+  const self = this;
+  while (freeLen < count &&
+         freeLen < this.maxFreeSockets &&
+         sockLen < this.maxSockets &&
+         this.totalSocketCount < this.maxTotalSockets) {
+    debug('warm up', name);
+    this.createSocket(null, options, onWarmSocket);
+    freeLen++;
+    sockLen++;
+  }
+
+  function onWarmSocket(err, socket) {
+    if (err) {
+      debug('warm up failed', name, err.message);
+      return;
+    }
+    const requests = self.requests[name];
+    if (requests && requests.length) {
+      // A request started waiting in the meantime.
+      self._pendingRequestCount--;
+      socket[kUsed] = true;
+      requests.shift().onSocket(socket);
+      if (requests.length === 0)
+        delete self.requests[name];
+      return;
+    }
+    socket.on('error', warmSocketErrorListener);
+    removeActive(self.sockets, name, socket);
+    addFree(self, name, socket);
+  }
+};
+
+// Returns the number of sockets and requests of all origins, and what
+// happened to them so far.
+Agent.prototype.getStats = function() {
+  return {
+    sockets: this.totalSocketCount - this._freeSocketCount,
+    freeSockets: this._freeSocketCount,
+    pendingRequests: this._pendingRequestCount,
+    created: this._stats.created,
+    reused: this._stats.reused,
+    queued: this._stats.queued,
+    timedOut: this._stats.timedOut
+  };
+};
+
 Agent.prototype.destroy = function() {
+  // Don't open new sockets for the ones that are being closed.
+  this._warmOptions = {};
   var sets = [this.freeSockets, this.sockets];
   for (var s = 0; s < sets.length; s++) {
     var set = sets[s];
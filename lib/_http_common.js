@@ -7,6 +7,7 @@ const HTTPParser = binding.HTTPParser;
 const FreeList = require('internal/freelist').FreeList;
 const incoming = require('_http_incoming');
 const IncomingMessage = incoming.IncomingMessage;
+const LazyHeaders = incoming.LazyHeaders;
 const readStart = incoming.readStart;
 const readStop = incoming.readStop;
 
@@ -23,6 +24,8 @@ const kOnHeadersComplete = HTTPParser.kOnHeadersComplete | 0;
 const kOnBody = HTTPParser.kOnBody | 0;
 const kOnMessageComplete = HTTPParser.kOnMessageComplete | 0;
 const kOnExecute = HTTPParser.kOnExecute | 0;
+const kOnBatch = HTTPParser.kOnBatch | 0;
+const kOnTimeout = HTTPParser.kOnTimeout | 0;
 
 // Only called in the slow case where slow means
 // that the request headers were either fragmented
@@ -42,9 +45,11 @@ function parserOnHeaders(headers, url) {
 // this request.
 // `url` is not set for response parsers but that's not applicable here since
 // all our parsers are request parsers.
+// `headerBuffer` is only set when lazy headers are enabled, in which case
+// `headers` is a Uint32Array of offsets into `headerBuffer`.
 function parserOnHeadersComplete(versionMajor, versionMinor, headers, method,
                                  url, statusCode, statusMessage, upgrade,
-                                 shouldKeepAlive) {
+                                 shouldKeepAlive, headerBuffer) {
   var parser = this;
 
   if (!headers) {
@@ -63,13 +68,18 @@ function parserOnHeadersComplete(versionMajor, versionMinor, headers, method,
   parser.incoming.httpVersion = versionMajor + '.' + versionMinor;
   parser.incoming.url = url;
 
-  var n = headers.length;
+  var n = headerBuffer !== undefined ? headers.length >>> 1 : headers.length;
 
   // If parser.maxHeaderPairs <= 0 assume that there's no limit.
   if (parser.maxHeaderPairs > 0)
     n = Math.min(n, parser.maxHeaderPairs);
 
-  parser.incoming._addHeaderLines(headers, n);
+  if (headerBuffer !== undefined) {
+    parser.incoming._lazyHeaders =
+        new LazyHeaders(headerBuffer, headers, n >>> 1);
+  } else {
+    parser.incoming._addHeaderLines(headers, n);
+  }
 
   if (typeof method === 'number') {
     // server only
@@ -154,6 +164,37 @@ function parserOnMessageComplete() {
   readStart(parser.socket);
 }
 
+// Only called for batched parsers.  `events` holds the callbacks for all
+// messages in the last buffer that was parsed as a flat list of
+// [kOnHeadersComplete, <10 arguments>], [kOnBody, <3 arguments>] and
+// [kOnMessageComplete] entries.
+function parserOnBatch(events, length) {
+  var parser = this;
+  var i = 0;
+  while (i < length) {
+    switch (events[i]) {
+      case kOnHeadersComplete:
+        parser[kOnHeadersComplete](events[i + 1], events[i + 2],
+                                   events[i + 3], events[i + 4],
+                                   events[i + 5], events[i + 6],
+                                   events[i + 7], events[i + 8],
+                                   events[i + 9], events[i + 10]);
+        i += 11;
+        break;
+      case kOnBody:
+        parser[kOnBody](events[i + 1], events[i + 2], events[i + 3]);
+        i += 4;
+        break;
+      case kOnMessageComplete:
+        parser[kOnMessageComplete]();
+        i += 1;
+        break;
+      default:
+        throw new Error('Unknown parser event: ' + events[i]);
+    }
+  }
+}
+
 
 var parsers = new FreeList('parsers', 1000, function() {
   var parser = new HTTPParser(HTTPParser.REQUEST);
@@ -176,11 +217,16 @@ var parsers = new FreeList('parsers', 1000, function() {
   parser[kOnBody] = parserOnBody;
   parser[kOnMessageComplete] = parserOnMessageComplete;
   parser[kOnExecute] = null;
+  parser[kOnBatch] = parserOnBatch;
 
   return parser;
 });
 exports.parsers = parsers;
 
+require('internal/process/memory_pressure').addTrimHandler(function() {
+  parsers.clear((parser) => parser.close());
+});
+
 
 // Free the parser and also break any links that it
 // might have to any other things.
@@ -192,6 +238,7 @@ exports.parsers = parsers;
 function freeParser(parser, req, socket) {
   if (parser) {
     parser._headers = [];
+    parser._url = '';
     parser.onIncoming = null;
     if (parser._consumed)
       parser.unconsume();
@@ -202,6 +249,10 @@ function freeParser(parser, req, socket) {
     parser.incoming = null;
     parser.outgoing = null;
     parser[kOnExecute] = null;
+    if (parser[kOnTimeout]) {
+      parser[kOnTimeout] = null;
+      parser.setTimeouts(0, 0);
+    }
     if (parsers.free(parser) === false)
       parser.close();
     parser = null;
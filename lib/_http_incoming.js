@@ -27,8 +27,10 @@ function IncomingMessage(socket) {
   this.httpVersionMinor = null;
   this.httpVersion = null;
   this.complete = false;
-  this.headers = {};
-  this.rawHeaders = [];
+  this._headersObject = {};
+  this._rawHeaders = [];
+  this._lazyHeaders = null;
+  this._headersPending = false;
   this.trailers = {};
   this.rawTrailers = [];
 
@@ -58,6 +60,96 @@ util.inherits(IncomingMessage, Stream.Readable);
 exports.IncomingMessage = IncomingMessage;
 
 
+// When the parser runs in lazy headers mode, `headers` and `rawHeaders` are
+// only materialized on first access.  Until then the header fields and values
+// stay in the Buffer they were received in, see LazyHeaders below.  Otherwise
+// `rawHeaders` is the array that the parser made, and `headers` is only built
+// from it on first access.
+Object.defineProperty(IncomingMessage.prototype, 'headers', {
+  configurable: true,
+  enumerable: true,
+  get: function() {
+    if (this._lazyHeaders !== null || this._headersPending)
+      this._materializeHeaders();
+    return this._headersObject;
+  },
+  set: function(val) {
+    if (this._lazyHeaders !== null)
+      this._materializeHeaders();
+    this._headersPending = false;
+    this._headersObject = val;
+  }
+});
+
+
+Object.defineProperty(IncomingMessage.prototype, 'rawHeaders', {
+  configurable: true,
+  enumerable: true,
+  get: function() {
+    if (this._lazyHeaders !== null)
+      this._materializeHeaders();
+    return this._rawHeaders;
+  },
+  set: function(val) {
+    if (this._lazyHeaders !== null || this._headersPending)
+      this._materializeHeaders();
+    this._rawHeaders = val;
+  }
+});
+
+
+IncomingMessage.prototype._materializeHeaders = function() {
+  var lazy = this._lazyHeaders;
+  var raw = this._rawHeaders;
+  var dest = this._headersObject;
+  var i;
+
+  if (this._headersPending) {
+    this._headersPending = false;
+    for (i = 0; i < raw.length; i += 2)
+      this._addHeaderLine(raw[i], raw[i + 1], dest);
+    if (lazy === null)
+      return;
+  }
+
+  this._lazyHeaders = null;
+  for (i = 0; i < lazy.length; i++) {
+    var k = lazy.field(i);
+    var v = lazy.value(i);
+    raw.push(k);
+    raw.push(v);
+    this._addHeaderLine(k, v, dest);
+  }
+};
+
+
+// Returns the value of a single request header without materializing the
+// other ones when lazy headers are enabled.  `name` is case-insensitive.
+IncomingMessage.prototype.getHeader = function(name) {
+  if (typeof name !== 'string')
+    throw new TypeError('"name" argument must be a string');
+
+  name = name.toLowerCase();
+
+  if (this._lazyHeaders !== null)
+    return this._lazyHeaders.get(name, this);
+  if (!this._headersPending)
+    return this._headersObject[name];
+
+  var raw = this._rawHeaders;
+  var dest;
+  for (var i = 0; i < raw.length; i += 2) {
+    var field = raw[i];
+    if (field.length === name.length && field.toLowerCase() === name) {
+      if (dest === undefined)
+        dest = {};
+      this._addHeaderLine(name, raw[i + 1], dest);
+    }
+  }
+  return dest === undefined ? undefined : dest[name];
+};
+
+
 IncomingMessage.prototype.setTimeout = function(msecs, callback) {
   if (callback)
     this.on('timeout', callback);
@@ -93,6 +185,16 @@ IncomingMessage.prototype.destroy = function(error) {
 
 IncomingMessage.prototype._addHeaderLines = function(headers, n) {
   if (headers && headers.length) {
+    if (!this.complete &&
+        this._lazyHeaders === null &&
+        this._rawHeaders.length === 0) {
+      // The parser made `headers` for this message alone, so it becomes
+      // `rawHeaders` as it is, and `headers` waits until it is used.
+      this._rawHeaders = n === headers.length ? headers : headers.slice(0, n);
+      this._headersPending = true;
+      return;
+    }
+
     var raw, dest;
     if (this.complete) {
       raw = this.rawTrailers;
@@ -113,6 +215,116 @@ IncomingMessage.prototype._addHeaderLines = function(headers, n) {
 };
 
 
+// Maps the canonical and the lowercase spelling of well-known header names to
+// their lowercase form without calling toLowerCase().  The parser interns
+// these spellings (see PER_ISOLATE_HTTP_HEADER_STRING_PROPERTIES in
+// src/env.h), which makes the comparisons cheap.
+function matchKnownFields(field) {
+  switch (field) {
+    case 'Accept':
+    case 'accept':
+      return 'accept';
+    case 'Accept-Encoding':
+    case 'accept-encoding':
+      return 'accept-encoding';
+    case 'Accept-Language':
+    case 'accept-language':
+      return 'accept-language';
+    case 'Authorization':
+    case 'authorization':
+      return 'authorization';
+    case 'Cache-Control':
+    case 'cache-control':
+      return 'cache-control';
+    case 'Connection':
+    case 'connection':
+      return 'connection';
+    case 'Content-Encoding':
+    case 'content-encoding':
+      return 'content-encoding';
+    case 'Content-Length':
+    case 'content-length':
+      return 'content-length';
+    case 'Content-Type':
+    case 'content-type':
+      return 'content-type';
+    case 'Cookie':
+    case 'cookie':
+      return 'cookie';
+    case 'Date':
+    case 'date':
+      return 'date';
+    case 'ETag':
+    case 'etag':
+      return 'etag';
+    case 'Expect':
+    case 'expect':
+      return 'expect';
+    case 'Expires':
+    case 'expires':
+      return 'expires';
+    case 'Host':
+    case 'host':
+      return 'host';
+    case 'If-Modified-Since':
+    case 'if-modified-since':
+      return 'if-modified-since';
+    case 'If-None-Match':
+    case 'if-none-match':
+      return 'if-none-match';
+    case 'Keep-Alive':
+    case 'keep-alive':
+      return 'keep-alive';
+    case 'Last-Modified':
+    case 'last-modified':
+      return 'last-modified';
+    case 'Location':
+    case 'location':
+      return 'location';
+    case 'Origin':
+    case 'origin':
+      return 'origin';
+    case 'Pragma':
+    case 'pragma':
+      return 'pragma';
+    case 'Range':
+    case 'range':
+      return 'range';
+    case 'Referer':
+    case 'referer':
+      return 'referer';
+    case 'Server':
+    case 'server':
+      return 'server';
+    case 'Set-Cookie':
+    case 'set-cookie':
+      return 'set-cookie';
+    case 'Transfer-Encoding':
+    case 'transfer-encoding':
+      return 'transfer-encoding';
+    case 'Upgrade':
+    case 'upgrade':
+      return 'upgrade';
+    case 'User-Agent':
+    case 'user-agent':
+      return 'user-agent';
+    case 'Vary':
+    case 'vary':
+      return 'vary';
+    case 'Via':
+    case 'via':
+      return 'via';
+    case 'X-Forwarded-For':
+    case 'x-forwarded-for':
+      return 'x-forwarded-for';
+    case 'X-Requested-With':
+    case 'x-requested-with':
+      return 'x-requested-with';
+  }
+  return field.toLowerCase();
+}
+
+
 // Add the given (field, value) pair to the message
 //
 // Per RFC2616, section 4.2 it is acceptable to join multiple instances of the
@@ -121,7 +333,7 @@ IncomingMessage.prototype._addHeaderLines = function(headers, n) {
 // and drop the second. Extended header fields (those beginning with 'x-') are
 // always joined.
 IncomingMessage.prototype._addHeaderLine = function(field, value, dest) {
-  field = field.toLowerCase();
+  field = matchKnownFields(field);
   switch (field) {
     // Array headers:
     case 'set-cookie':
@@ -170,6 +382,64 @@ IncomingMessage.prototype._addHeaderLine = function(field, value, dest) {
 };
 
 
+// Header fields and values that are still stored in the receive buffer.
+// `offsets` holds a [field start, field length, value start, value length]
+// quadruple per header, relative to `buffer`.  Strings are only created for
+// the headers that are actually looked up.
+function LazyHeaders(buffer, offsets, length) {
+  this.buffer = buffer;
+  this.offsets = offsets;
+  this.length = length;
+}
+exports.LazyHeaders = LazyHeaders;
+
+
+LazyHeaders.prototype.field = function(i) {
+  var start = this.offsets[i * 4];
+  return this.buffer.binarySlice(start, start + this.offsets[i * 4 + 1]);
+};
+
+
+LazyHeaders.prototype.value = function(i) {
+  var start = this.offsets[i * 4 + 2];
+  return this.buffer.binarySlice(start, start + this.offsets[i * 4 + 3]);
+};
+
+
+// Compares header field `i` against the lowercase string `name` without
+// creating a string for the field.
+LazyHeaders.prototype.fieldEquals = function(i, name) {
+  var start = this.offsets[i * 4];
+  var len = this.offsets[i * 4 + 1];
+  if (len !== name.length)
+    return false;
+  var buffer = this.buffer;
+  for (var j = 0; j < len; j++) {
+    var ch = buffer[start + j];
+    if (ch >= 65 && ch <= 90)  // A-Z
+      ch |= 0x20;
+    if (ch !== name.charCodeAt(j))
+      return false;
+  }
+  return true;
+};
+
+
+// `name` must be lowercase.  Duplicates are combined the same way as they are
+// in `message.headers`.
+LazyHeaders.prototype.get = function(name, message) {
+  var dest;
+  for (var i = 0; i < this.length; i++) {
+    if (this.fieldEquals(i, name)) {
+      if (dest === undefined)
+        dest = {};
+      message._addHeaderLine(name, this.value(i), dest);
+    }
+  }
+  return dest === undefined ? undefined : dest[name];
+};
+
+
 // Call this instead of resume() if we want to just
 // dump all the data to /dev/null
 IncomingMessage.prototype._dump = function() {
@@ -2,23 +2,34 @@
 
 const assert = require('assert').ok;
 const Stream = require('stream');
-const timers = require('timers');
 const util = require('util');
 const internalUtil = require('internal/util');
 const Buffer = require('buffer').Buffer;
+const ChunkList = require('buffer').ChunkList;
 const common = require('_http_common');
+const internalNet = require('internal/net');
 
 const CRLF = common.CRLF;
-const chunkExpression = common.chunkExpression;
 const debug = common.debug;
-
-const connectionExpression = /^Connection$/i;
-const transferEncodingExpression = /^Transfer-Encoding$/i;
-const closeExpression = /close/i;
-const contentLengthExpression = /^Content-Length$/i;
-const dateExpression = /^Date$/i;
-const expectExpression = /^Expect$/i;
-const trailerExpression = /^Trailer$/i;
+const kSendFile = internalNet.kSendFile;
+const ChunkedPayload = internalNet.ChunkedPayload;
+
+const headersBinding = process.binding('http_headers');
+const storeHeader = headersBinding.storeHeader;
+const storeHeaderState = new Uint32Array(1);
+
+const kSendDate = headersBinding.kSendDate;
+const kShouldKeepAlive = headersBinding.kShouldKeepAlive;
+const kUseChunkedEncodingByDefault =
+    headersBinding.kUseChunkedEncodingByDefault;
+const kHasAgent = headersBinding.kHasAgent;
+const kRemovedConnection = headersBinding.kRemovedConnection;
+const kRemovedContentLength = headersBinding.kRemovedContentLength;
+const kRemovedTransferEncoding = headersBinding.kRemovedTransferEncoding;
+const kHasBody = headersBinding.kHasBody;
+const kChunkedEncoding = headersBinding.kChunkedEncoding;
+const kLast = headersBinding.kLast;
+const kSentExpect = headersBinding.kSentExpect;
 
 const automaticHeaders = {
   connection: true,
@@ -28,21 +39,6 @@ const automaticHeaders = {
 };
 
 
-var dateCache;
-function utcDate() {
-  if (!dateCache) {
-    var d = new Date();
-    dateCache = d.toUTCString();
-    timers.enroll(utcDate, 1000 - d.getMilliseconds());
-    timers._unrefActive(utcDate);
-  }
-  return dateCache;
-}
-utcDate._onTimeout = function() {
-  dateCache = undefined;
-};
-
-
 function OutgoingMessage() {
   Stream.call(this);
 
@@ -76,7 +72,8 @@ function OutgoingMessage() {
 
   this.socket = null;
   this.connection = null;
-  this._header = null;
+  this._headerBuffer = null;
+  this._headerString = null;
   this._headers = null;
   this._headerNames = {};
 
@@ -120,23 +117,27 @@ OutgoingMessage.prototype.destroy = function(error) {
 
 // This abstract either writing directly to the socket or buffering it.
 OutgoingMessage.prototype._send = function(data, encoding, callback) {
-  // This is a shameful hack to get the headers and first body chunk onto
-  // the same packet. Future versions of Node are going to take care of
-  // this at a lower level and in a more general way.
+  // Get the headers and first body chunk onto the same packet: when the
+  // socket is ours, cork it so that both end up in a single writev().
   if (!this._headerSent) {
-    if (typeof data === 'string' &&
-        encoding !== 'hex' &&
-        encoding !== 'base64') {
-      data = this._header + data;
-    } else {
-      this.output.unshift(this._header);
-      this.outputEncodings.unshift('binary');
-      this.outputCallbacks.unshift(null);
-      this.outputSize += this._header.length;
-      if (typeof this._onPendingData === 'function')
-        this._onPendingData(this._header.length);
-    }
     this._headerSent = true;
+    var connection = this.connection;
+    if (connection &&
+        connection._httpMessage === this &&
+        connection.writable &&
+        !connection.destroyed) {
+      connection.cork();
+      this._writeRaw(this._headerBuffer, null, null);
+      var ret = this._writeRaw(data, encoding, callback);
+      connection.uncork();
+      return ret;
+    }
+    this.output.unshift(this._headerBuffer);
+    this.outputEncodings.unshift(null);
+    this.outputCallbacks.unshift(null);
+    this.outputSize += this._headerBuffer.length;
+    if (typeof this._onPendingData === 'function')
+      this._onPendingData(this._headerBuffer.length);
   }
   return this._writeRaw(data, encoding, callback);
 };
@@ -157,7 +158,7 @@ OutgoingMessage.prototype._writeRaw = function(data, encoding, callback) {
     var outputLength = this.output.length;
     if (outputLength > 0) {
       this._flushOutput(connection);
-    } else if (data.length === 0) {
+    } else if (data.length === 0 && data[kSendFile] === undefined) {
       if (typeof callback === 'function')
         process.nextTick(callback);
       return true;
@@ -190,149 +191,41 @@ OutgoingMessage.prototype._buffer = function(data, encoding, callback) {
 OutgoingMessage.prototype._storeHeader = function(firstLine, headers) {
   // firstLine in the case of request is: 'GET /index.html HTTP/1.1\r\n'
   // in the case of response it is: 'HTTP/1.1 200 OK\r\n'
-  var state = {
-    sentConnectionHeader: false,
-    sentContentLengthHeader: false,
-    sentTransferEncodingHeader: false,
-    sentDateHeader: false,
-    sentExpect: false,
-    sentTrailer: false,
-    messageHeader: firstLine
-  };
-
-  if (headers) {
-    var keys = Object.keys(headers);
-    var isArray = Array.isArray(headers);
-    var field, value;
-
-    for (var i = 0, l = keys.length; i < l; i++) {
-      var key = keys[i];
-      if (isArray) {
-        field = headers[key][0];
-        value = headers[key][1];
-      } else {
-        field = key;
-        value = headers[key];
-      }
-
-      if (Array.isArray(value)) {
-        for (var j = 0; j < value.length; j++) {
-          storeHeader(this, state, field, value[j]);
-        }
-      } else {
-        storeHeader(this, state, field, value);
-      }
-    }
-  }
-
-  // Date header
-  if (this.sendDate === true && state.sentDateHeader === false) {
-    state.messageHeader += 'Date: ' + utcDate() + CRLF;
-  }
-
-  // Force the connection to close when the response is a 204 No Content or
-  // a 304 Not Modified and the user has set a "Transfer-Encoding: chunked"
-  // header.
-  //
-  // RFC 2616 mandates that 204 and 304 responses MUST NOT have a body but
-  // node.js used to send out a zero chunk anyway to accommodate clients
-  // that don't have special handling for those responses.
-  //
-  // It was pointed out that this might confuse reverse proxies to the point
-  // of creating security liabilities, so suppress the zero chunk and force
-  // the connection to close.
-  var statusCode = this.statusCode;
-  if ((statusCode === 204 || statusCode === 304) &&
-      this.chunkedEncoding === true) {
-    debug(statusCode + ' response should not use chunked encoding,' +
-          ' closing connection.');
-    this.chunkedEncoding = false;
-    this.shouldKeepAlive = false;
-  }
-
-  // keep-alive logic
-  if (this._removedHeader.connection) {
-    this._last = true;
-    this.shouldKeepAlive = false;
-  } else if (state.sentConnectionHeader === false) {
-    var shouldSendKeepAlive = this.shouldKeepAlive &&
-        (state.sentContentLengthHeader ||
-         this.useChunkedEncodingByDefault ||
-         this.agent);
-    if (shouldSendKeepAlive) {
-      state.messageHeader += 'Connection: keep-alive\r\n';
-    } else {
-      this._last = true;
-      state.messageHeader += 'Connection: close\r\n';
-    }
-  }
-
-  if (state.sentContentLengthHeader === false &&
-      state.sentTransferEncodingHeader === false) {
-    if (!this._hasBody) {
-      // Make sure we don't end the 0\r\n\r\n at the end of the message.
-      this.chunkedEncoding = false;
-    } else if (!this.useChunkedEncodingByDefault) {
-      this._last = true;
-    } else {
-      if (!state.sentTrailer &&
-          !this._removedHeader['content-length'] &&
-          typeof this._contentLength === 'number') {
-        state.messageHeader += 'Content-Length: ' + this._contentLength +
-                               '\r\n';
-      } else if (!this._removedHeader['transfer-encoding']) {
-        state.messageHeader += 'Transfer-Encoding: chunked\r\n';
-        this.chunkedEncoding = true;
-      } else {
-        // We should only be able to get here if both Content-Length and
-        // Transfer-Encoding are removed by the user.
-        // See: test/parallel/test-http-remove-header-stays-removed.js
-        debug('Both Content-Length and Transfer-Encoding are removed');
-      }
-    }
-  }
-
-  this._header = state.messageHeader + CRLF;
+  var flags = 0;
+  if (this.sendDate === true) flags |= kSendDate;
+  if (this.shouldKeepAlive) flags |= kShouldKeepAlive;
+  if (this.useChunkedEncodingByDefault) flags |= kUseChunkedEncodingByDefault;
+  if (this.agent) flags |= kHasAgent;
+  if (this._removedHeader.connection) flags |= kRemovedConnection;
+  if (this._removedHeader['content-length']) flags |= kRemovedContentLength;
+  if (this._removedHeader['transfer-encoding'])
+    flags |= kRemovedTransferEncoding;
+  if (this._hasBody) flags |= kHasBody;
+  if (this.chunkedEncoding) flags |= kChunkedEncoding;
+  storeHeaderState[0] = flags;
+
+  // Validates the headers and renders them, along with the automatic
+  // Date, Connection and Content-Length or Transfer-Encoding headers,
+  // into a single Buffer.  The Date header value is cached natively.
+  this._headerString = null;
+  this._headerBuffer = storeHeader(firstLine,
+                                   headers,
+                                   storeHeaderState,
+                                   typeof this._contentLength === 'number' ?
+                                       this._contentLength : null,
+                                   this.statusCode);
   this._headerSent = false;
 
+  flags = storeHeaderState[0];
+  if (flags & kLast) this._last = true;
+  this.shouldKeepAlive = (flags & kShouldKeepAlive) !== 0;
+  this.chunkedEncoding = (flags & kChunkedEncoding) !== 0;
+
   // wait until the first body chunk, or close(), is sent to flush,
   // UNLESS we're sending Expect: 100-continue.
-  if (state.sentExpect) this._send('');
+  if (flags & kSentExpect) this._send('');
 };
 
-function storeHeader(self, state, field, value) {
-  if (!common._checkIsHttpToken(field)) {
-    throw new TypeError(
-      'Header name must be a valid HTTP Token ["' + field + '"]');
-  }
-  if (common._checkInvalidHeaderChar(value) === true) {
-    throw new TypeError('The header content contains invalid characters');
-  }
-  state.messageHeader += field + ': ' + escapeHeaderValue(value) + CRLF;
-
-  if (connectionExpression.test(field)) {
-    state.sentConnectionHeader = true;
-    if (closeExpression.test(value)) {
-      self._last = true;
-    } else {
-      self.shouldKeepAlive = true;
-    }
-
-  } else if (transferEncodingExpression.test(field)) {
-    state.sentTransferEncodingHeader = true;
-    if (chunkExpression.test(value)) self.chunkedEncoding = true;
-
-  } else if (contentLengthExpression.test(field)) {
-    state.sentContentLengthHeader = true;
-  } else if (dateExpression.test(field)) {
-    state.sentDateHeader = true;
-  } else if (expectExpression.test(field)) {
-    state.sentExpect = true;
-  } else if (trailerExpression.test(field)) {
-    state.sentTrailer = true;
-  }
-}
-
 
 OutgoingMessage.prototype.setHeader = function(name, value) {
   if (!common._checkIsHttpToken(name))
@@ -342,7 +235,7 @@ OutgoingMessage.prototype.setHeader = function(name, value) {
     throw new TypeError('"name" should be a string in setHeader(name, value)');
   if (value === undefined)
     throw new Error('"value" required in setHeader("' + name + '", value)');
-  if (this._header)
+  if (this._headerBuffer)
     throw new Error('Can\'t set headers after they are sent.');
   if (common._checkInvalidHeaderChar(value) === true) {
     throw new TypeError('The header content contains invalid characters');
@@ -376,7 +269,7 @@ OutgoingMessage.prototype.removeHeader = function(name) {
     throw new Error('"name" argument is required for removeHeader(name)');
   }
 
-  if (this._header) {
+  if (this._headerBuffer) {
     throw new Error('Can\'t remove headers after they are sent');
   }
 
@@ -395,7 +288,7 @@ OutgoingMessage.prototype.removeHeader = function(name) {
 
 
 OutgoingMessage.prototype._renderHeaders = function() {
-  if (this._header) {
+  if (this._headerBuffer) {
     throw new Error('Can\'t render headers after they are sent to the client');
   }
 
@@ -417,7 +310,27 @@ OutgoingMessage.prototype._renderHeaders = function() {
 Object.defineProperty(OutgoingMessage.prototype, 'headersSent', {
   configurable: true,
   enumerable: true,
-  get: function() { return !!this._header; }
+  get: function() { return this._headerBuffer !== null; }
+});
+
+
+// The header block is kept as the Buffer that storeHeader() rendered, but
+// _header has always been a string and userland modules read it, so it is
+// decoded on first access.
+Object.defineProperty(OutgoingMessage.prototype, '_header', {
+  configurable: true,
+  enumerable: true,
+  get: function() {
+    if (this._headerString === null && this._headerBuffer !== null) {
+      this._headerString =
+          this._headerBuffer.binarySlice(0, this._headerBuffer.length);
+    }
+    return this._headerString;
+  },
+  set: function(val) {
+    this._headerString = val ? '' + val : null;
+    this._headerBuffer = val ? Buffer.from(this._headerString, 'binary') : null;
+  }
 });
 
 
@@ -429,7 +342,7 @@ OutgoingMessage.prototype.write = function(chunk, encoding, callback) {
     return true;
   }
 
-  if (!this._header) {
+  if (!this._headerBuffer) {
     this._implicitHeader();
   }
 
@@ -439,8 +352,10 @@ OutgoingMessage.prototype.write = function(chunk, encoding, callback) {
     return true;
   }
 
-  if (typeof chunk !== 'string' && !(chunk instanceof Buffer)) {
-    throw new TypeError('First argument must be a string or Buffer');
+  if (typeof chunk !== 'string' &&
+      !(chunk instanceof Buffer) &&
+      !(chunk instanceof ChunkList)) {
+    throw new TypeError('First argument must be a string, Buffer or ChunkList');
   }
 
 
@@ -457,21 +372,23 @@ OutgoingMessage.prototype.write = function(chunk, encoding, callback) {
       len = Buffer.byteLength(chunk, encoding);
       chunk = len.toString(16) + CRLF + chunk + CRLF;
       ret = this._send(chunk, encoding, callback);
-    } else {
-      // buffer, or a non-toString-friendly encoding
-      if (typeof chunk === 'string')
-        len = Buffer.byteLength(chunk, encoding);
-      else
-        len = chunk.length;
-
+    } else if (chunk instanceof ChunkList) {
       if (this.connection && !this.connection.corked) {
         this.connection.cork();
         process.nextTick(connectionCorkNT, this.connection);
       }
-      this._send(len.toString(16), 'binary', null);
+      this._send(chunk.length.toString(16), 'binary', null);
       this._send(crlf_buf, null, null);
-      this._send(chunk, encoding, null);
+      this._send(chunk, null, null);
       ret = this._send(crlf_buf, null, callback);
+    } else {
+      // buffer, or a non-toString-friendly encoding.  The socket adds the
+      // size line and the CRLF to the payload when it writes it.
+      if (typeof chunk === 'string') {
+        chunk = Buffer.from(chunk, encoding);
+        if (chunk.length === 0) return true;
+      }
+      ret = this._send(new ChunkedPayload(chunk), null, callback);
     }
   } else {
     ret = this._send(chunk, encoding, callback);
@@ -482,6 +399,51 @@ OutgoingMessage.prototype.write = function(chunk, encoding, callback) {
 };
 
 
+// Like write(), but the body data is `length` bytes of the file `fd`,
+// starting at `offset`. The socket hands the file to sendfile() once the
+// data queued before it has been written, so it is never copied into
+// JavaScript.
+OutgoingMessage.prototype.sendFile = function(fd, offset, length, callback) {
+  var chunk = internalNet.fileChunk(fd, offset, length);
+
+  if (this.finished) {
+    var err = new Error('write after end');
+    process.nextTick(writeAfterEndNT, this, err, callback);
+
+    return true;
+  }
+
+  if (!this._headerBuffer) {
+    this._implicitHeader();
+  }
+
+  if (!this._hasBody) {
+    debug('This type of response MUST NOT have a body. ' +
+          'Ignoring sendFile() calls.');
+    return true;
+  }
+
+  if (length === 0) {
+    if (typeof callback === 'function')
+      process.nextTick(callback);
+    return true;
+  }
+
+  if (this.chunkedEncoding) {
+    if (this.connection && !this.connection.corked) {
+      this.connection.cork();
+      process.nextTick(connectionCorkNT, this.connection);
+    }
+    this._send(length.toString(16), 'binary', null);
+    this._send(crlf_buf, null, null);
+    this._send(chunk, null, null);
+    return this._send(crlf_buf, null, callback);
+  }
+
+  return this._send(chunk, null, callback);
+};
+
+
 function writeAfterEndNT(self, err, callback) {
   self.emit('error', err);
   if (callback) callback(err);
@@ -538,8 +500,11 @@ OutgoingMessage.prototype.end = function(data, encoding, callback) {
     encoding = null;
   }
 
-  if (data && typeof data !== 'string' && !(data instanceof Buffer)) {
-    throw new TypeError('First argument must be a string or Buffer');
+  if (data &&
+      typeof data !== 'string' &&
+      !(data instanceof Buffer) &&
+      !(data instanceof ChunkList)) {
+    throw new TypeError('First argument must be a string, Buffer or ChunkList');
   }
 
   if (this.finished) {
@@ -554,7 +519,7 @@ OutgoingMessage.prototype.end = function(data, encoding, callback) {
   if (typeof callback === 'function')
     this.once('finish', callback);
 
-  if (!this._header) {
+  if (!this._headerBuffer) {
     if (data) {
       if (typeof data === 'string')
         this._contentLength = Buffer.byteLength(data, encoding);
@@ -677,7 +642,7 @@ OutgoingMessage.prototype._flushOutput = function _flushOutput(socket) {
 
 
 OutgoingMessage.prototype.flushHeaders = function() {
-  if (!this._header) {
+  if (!this._headerBuffer) {
     this._implicitHeader();
   }
 
@@ -2,7 +2,8 @@
 
 const util = require('util');
 const net = require('net');
-const HTTPParser = process.binding('http_parser').HTTPParser;
+const parserBinding = process.binding('http_parser');
+const HTTPParser = parserBinding.HTTPParser;
 const assert = require('assert').ok;
 const common = require('_http_common');
 const parsers = common.parsers;
@@ -80,6 +81,9 @@ const STATUS_CODES = exports.STATUS_CODES = {
 };
 
 const kOnExecute = HTTPParser.kOnExecute | 0;
+const kOnTimeout = HTTPParser.kOnTimeout | 0;
+const kActiveConnections = parserBinding.kActiveConnections;
+const kConnections = parserBinding.kConnections;
 
 
 function ServerResponse(req) {
@@ -90,7 +94,8 @@ function ServerResponse(req) {
   this.sendDate = true;
 
   if (req.httpVersionMajor < 1 || req.httpVersionMinor < 1) {
-    this.useChunkedEncodingByDefault = chunkExpression.test(req.headers.te);
+    this.useChunkedEncodingByDefault =
+        chunkExpression.test(req.getHeader('te'));
     this.shouldKeepAlive = false;
   }
 }
@@ -241,8 +246,13 @@ function Server(requestListener) {
   this.addListener('connection', connectionListener);
 
   this.timeout = 2 * 60 * 1000;
+  this.headersTimeout = 0;
+  this.bodyTimeout = 0;
+  this.lazyHeaders = false;
+  this.batchPipelinedRequests = false;
 
   this._pendingResponseData = 0;
+  this._stats = new Float64Array(parserBinding.kStatsFieldsCount);
 }
 util.inherits(Server, net.Server);
 
@@ -255,6 +265,23 @@ Server.prototype.setTimeout = function(msecs, callback) {
 };
 
 
+// The parsers of the connections count into this._stats as they go, so that
+// the numbers can be read at any time without listening for events.
+Server.prototype.getStats = function() {
+  const stats = this._stats;
+  return {
+    activeConnections: stats[kActiveConnections],
+    connections: stats[kConnections],
+    requests: stats[parserBinding.kRequests],
+    maxRequestsPerConnection: stats[parserBinding.kMaxRequestsPerConnection],
+    parseErrors: stats[parserBinding.kParseErrors],
+    headersTime: stats[parserBinding.kHeadersTime],
+    handlerTime: stats[parserBinding.kHandlerTime],
+    parseTime: stats[parserBinding.kParseTime]
+  };
+};
+
+
 exports.Server = Server;
 
 
@@ -285,6 +312,7 @@ function connectionListener(socket) {
 
   function serverSocketCloseListener() {
     debug('server socket close');
+    self._stats[kActiveConnections]--;
     // mark this parser as reusable
     if (this.parser) {
       freeParser(this.parser, null, this);
@@ -313,8 +341,12 @@ function connectionListener(socket) {
       socket.destroy();
   });
 
+  self._stats[kActiveConnections]++;
+  self._stats[kConnections]++;
+
   var parser = parsers.alloc();
   parser.reinitialize(HTTPParser.REQUEST);
+  parser.setStats(self._stats);
   parser.socket = socket;
   socket.parser = parser;
   parser.incoming = null;
@@ -327,6 +359,17 @@ function connectionListener(socket) {
     parser.maxHeaderPairs = 2000;
   }
 
+  if (this.lazyHeaders)
+    parser.setLazyHeaders(true);
+  if (this.slabReads)
+    parser.setReadSlab(true);
+  if (this.batchPipelinedRequests)
+    parser.setBatched(true);
+  if (this.headersTimeout > 0 || this.bodyTimeout > 0) {
+    parser.setTimeouts(this.headersTimeout, this.bodyTimeout);
+    parser[kOnTimeout] = onParserTimeout;
+  }
+
   socket.addListener('error', socketOnError);
   socket.addListener('close', serverSocketCloseListener);
   parser.onIncoming = parserOnIncoming;
@@ -360,6 +403,12 @@ function connectionListener(socket) {
       this.destroy(e);
   }
 
+  function onParserTimeout(part) {
+    const err = new Error(`Timed out reading the request ${part}`);
+    err.code = part === 'headers' ? 'HEADERS_TIMEOUT' : 'BODY_TIMEOUT';
+    socketOnError.call(socket, err);
+  }
+
   function socketOnData(d) {
     assert(!socket._paused);
     debug('SERVER socketOnData %d', d.length);
@@ -520,9 +569,10 @@ function connectionListener(socket) {
       }
     }
 
-    if (req.headers.expect !== undefined &&
+    var expect = req.getHeader('expect');
+    if (expect !== undefined &&
         (req.httpVersionMajor == 1 && req.httpVersionMinor == 1)) {
-      if (continueExpression.test(req.headers.expect)) {
+      if (continueExpression.test(expect)) {
         res._expect_continue = true;
 
         if (self.listenerCount('checkContinue') > 0) {
@@ -8,6 +8,8 @@ const Stream = require('stream');
 const Buffer = require('buffer').Buffer;
 const util = require('util');
 const debug = util.debuglog('stream');
+const RingBuffer = require('internal/streams/ring_buffer');
+const internalEvents = require('internal/events');
 var StringDecoder;
 
 util.inherits(Readable, Stream);
@@ -50,7 +52,7 @@ function ReadableState(options, stream) {
   // cast to ints.
   this.highWaterMark = ~~this.highWaterMark;
 
-  this.buffer = [];
+  this.buffer = new RingBuffer();
   this.length = 0;
   this.pipes = null;
   this.pipesCount = 0;
@@ -87,6 +89,9 @@ function ReadableState(options, stream) {
   // if true, a maybeReadMore has been scheduled
   this.readingMore = false;
 
+  // Set by the first readChunks().
+  this.chunkReader = null;
+
   this.decoder = null;
   this.encoding = null;
   if (options.encoding) {
@@ -136,6 +141,60 @@ Readable.prototype.unshift = function(chunk) {
   return readableAddChunk(this, state, chunk, '', true);
 };
 
+// Same as calling push() for each of the chunks, but the 'data' or 'readable'
+// events and the next _read() are only scheduled once for the whole batch.
+Readable.prototype.pushBatch = function(chunks) {
+  if (!Array.isArray(chunks))
+    throw new TypeError('"chunks" argument must be an Array');
+
+  var state = this._readableState;
+  var i = 0;
+
+  if (!state.ended && !state.decoder) {
+    var emitted = false;
+    var buffered = false;
+
+    for (; i < chunks.length; i++) {
+      var chunk = chunks[i];
+      var len;
+      if (state.objectMode)
+        len = 1;
+      else if (chunk instanceof Buffer)
+        len = chunk.length;
+      else
+        break;  // push() deals with strings, nulls and invalid chunks.
+      if (chunk === null)
+        break;
+
+      if (len === 0)
+        continue;
+      if (state.flowing && state.length === 0 && !state.sync) {
+        internalEvents.emitOne(this, 'data', chunk);
+        emitted = true;
+      } else {
+        state.length += len;
+        state.buffer.push(chunk);
+        buffered = true;
+      }
+    }
+
+    if (i > 0) {
+      state.reading = false;
+      if (emitted)
+        this.read(0);
+      if (buffered && state.needReadable)
+        emitReadable(this);
+      if (emitted || buffered)
+        maybeReadMore(this, state);
+    }
+  }
+
+  for (; i < chunks.length; i++)
+    this.push(chunks[i]);
+
+  return needMoreData(state);
+};
+
 Readable.prototype.isPaused = function() {
   return this._readableState.flowing === false;
 };
@@ -169,7 +228,7 @@ function readableAddChunk(stream, state, chunk, encoding, addToFront) {
       if (!skipAdd) {
         // if we want the data now, just emit it.
         if (state.flowing && state.length === 0 && !state.sync) {
-          stream.emit('data', chunk);
+          internalEvents.emitOne(stream, 'data', chunk);
           stream.read(0);
         } else {
           // update the buffer info.
@@ -245,7 +304,7 @@ function howMuchToRead(n, state) {
   if (n === null || isNaN(n)) {
     // only flow one buffer at a time
     if (state.flowing && state.buffer.length)
-      return state.buffer[0].length;
+      return state.buffer.first().length;
     else
       return state.length;
   }
@@ -384,7 +443,7 @@ Readable.prototype.read = function(n) {
     endReadable(this);
 
   if (ret !== null)
-    this.emit('data', ret);
+    internalEvents.emitOne(this, 'data', ret);
 
   return ret;
 };
@@ -435,7 +494,7 @@ function emitReadable(stream) {
 
 function emitReadable_(stream) {
   debug('emit readable');
-  stream.emit('readable');
+  internalEvents.emitNone(stream, 'readable');
   flow(stream);
 }
 
@@ -709,6 +768,100 @@ Readable.prototype.on = function(ev, fn) {
 };
 Readable.prototype.addListener = Readable.prototype.on;
 
+// Resolves to an array of all the chunks that are buffered once there are
+// any, or to null at the end of the stream.  The chunks are the ones that
+// were pushed, they are not concatenated or copied, so a consumer that waits
+// for them pays for one promise per batch rather than one per chunk.
+Readable.prototype.readChunks = function() {
+  var state = this._readableState;
+  if (state.chunkReader === null)
+    state.chunkReader = new ChunkReader(this);
+  var reader = state.chunkReader;
+
+  if (reader.error !== null)
+    return Promise.reject(reader.error);
+  if (reader.resolve !== null)
+    throw new Error('readChunks() called while another one is pending');
+  if (state.length > 0)
+    return Promise.resolve(takeChunks(this, state));
+  if (state.ended) {
+    this.read(0);
+    return Promise.resolve(null);
+  }
+  return new Promise(function(resolve, reject) {
+    reader.resolve = resolve;
+    reader.reject = reject;
+  });
+};
+
+if (typeof Symbol.asyncIterator === 'symbol') {
+  Readable.prototype[Symbol.asyncIterator] = function() {
+    var stream = this;
+    var iterator = {
+      next: function() {
+        return stream.readChunks().then(function(chunks) {
+          return { value: chunks === null ? undefined : chunks,
+                   done: chunks === null };
+        });
+      }
+    };
+    iterator[Symbol.asyncIterator] = function() {
+      return iterator;
+    };
+    return iterator;
+  };
+}
+
+// Waits for 'readable' on behalf of readChunks().  The listeners stay, so
+// that waiting for the next batch adds and removes none.
+function ChunkReader(stream) {
+  var reader = this;
+  this.resolve = null;
+  this.reject = null;
+  this.error = null;
+
+  stream.on('readable', function() {
+    var state = stream._readableState;
+    if (state.length > 0)
+      reader.settle(takeChunks(stream, state));
+    else if (state.ended)
+      reader.settle(null);
+  });
+  stream.on('end', function() {
+    reader.settle(null);
+  });
+  stream.on('error', function(er) {
+    reader.error = er;
+    var reject = reader.reject;
+    reader.resolve = reader.reject = null;
+    if (reject !== null)
+      reject(er);
+  });
+}
+
+ChunkReader.prototype.settle = function(chunks) {
+  var resolve = this.resolve;
+  if (resolve === null)
+    return;
+  this.resolve = this.reject = null;
+  resolve(chunks);
+};
+
+function takeChunks(stream, state) {
+  var chunks = state.buffer.toArray();
+  state.buffer.clear();
+  state.length = 0;
+  if (!state.ended)
+    state.needReadable = true;
+  if (stream.listenerCount('data') > 0) {
+    for (var i = 0; i < chunks.length; i++)
+      internalEvents.emitOne(stream, 'data', chunks[i]);
+  }
+  // Start reading the next batch, or end the stream if this was the last.
+  stream.read(0);
+  return chunks;
+}
+
 function nReadingNextTick(self) {
   debug('readable nexttick read 0');
   self.read(0);
@@ -836,7 +989,7 @@ Readable.prototype.wrap = function(stream) {
 // exposed for testing purposes only.
 Readable._fromList = fromList;
 
-// Pluck off n bytes from an array of buffers.
+// Pluck off n bytes from a RingBuffer of buffers.
 // Length is the combined lengths of all the buffers in the list.
 function fromList(n, state) {
   var list = state.buffer;
@@ -854,23 +1007,24 @@ function fromList(n, state) {
   else if (objectMode)
     ret = list.shift();
   else if (!n || n >= length) {
-    // read it all, truncate the array.
+    // read it all, empty the list.
     if (stringMode)
       ret = list.join('');
     else if (list.length === 1)
-      ret = list[0];
+      ret = list.first();
     else
-      ret = Buffer.concat(list, length);
-    list.length = 0;
+      ret = list.concat(length);
+    list.clear();
   } else {
     // read just some of it.
-    if (n < list[0].length) {
+    const first = list.first();
+    if (n < first.length) {
       // just take a part of the first list item.
       // slice is the same for buffers and strings.
-      const buf = list[0];
-      ret = buf.slice(0, n);
-      list[0] = buf.slice(n);
-    } else if (n === list[0].length) {
+      ret = first.slice(0, n);
+      list.shift();
+      list.unshift(first.slice(n));
+    } else if (n === first.length) {
       // first list is a perfect match
       ret = list.shift();
     } else {
@@ -883,7 +1037,7 @@ function fromList(n, state) {
 
       var c = 0;
       for (var i = 0, l = list.length; i < l && c < n; i++) {
-        const buf = list[0];
+        const buf = list.shift();
         var cpy = Math.min(n - c, buf.length);
 
         if (stringMode)
@@ -892,9 +1046,7 @@ function fromList(n, state) {
           buf.copy(ret, c, 0, cpy);
 
         if (cpy < buf.length)
-          list[0] = buf.slice(cpy);
-        else
-          list.shift();
+          list.unshift(buf.slice(cpy));
 
         c += cpy;
       }
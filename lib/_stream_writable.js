@@ -11,6 +11,9 @@ const util = require('util');
 const internalUtil = require('internal/util');
 const Stream = require('stream');
 const Buffer = require('buffer').Buffer;
+const ChunkList = require('buffer').ChunkList;
+const RingBuffer = require('internal/streams/ring_buffer');
+const internalEvents = require('internal/events');
 
 util.inherits(Writable, Stream);
 
@@ -20,7 +23,6 @@ function WriteReq(chunk, encoding, cb) {
   this.chunk = chunk;
   this.encoding = encoding;
   this.callback = cb;
-  this.next = null;
 }
 
 function WritableState(options, stream) {
@@ -95,8 +97,9 @@ function WritableState(options, stream) {
   // the amount that is being written when _write is called.
   this.writelen = 0;
 
-  this.bufferedRequest = null;
-  this.lastBufferedRequest = null;
+  // the writes that wait for their turn, as chunk, encoding and callback
+  // triples, so that buffering a write doesn't allocate anything
+  this.bufferedRequests = new RingBuffer();
 
   // number of pending user-supplied write callbacks
   // this must be 0 before 'finish' can be emitted
@@ -118,11 +121,12 @@ function WritableState(options, stream) {
 }
 
 WritableState.prototype.getBuffer = function writableStateGetBuffer() {
-  var current = this.bufferedRequest;
-  var out = [];
-  while (current) {
-    out.push(current);
-    current = current.next;
+  var buffered = this.bufferedRequests;
+  var out = new Array(this.bufferedRequestCount);
+  for (var i = 0; i < out.length; i++) {
+    out[i] = new WriteReq(buffered.get(3 * i),
+                          buffered.get(3 * i + 1),
+                          buffered.get(3 * i + 2));
   }
   return out;
 };
@@ -183,6 +187,7 @@ function validChunk(stream, state, chunk, cb) {
   if (chunk === null) {
     er = new TypeError('May not write null values to stream');
   } else if (!(chunk instanceof Buffer) &&
+      !(chunk instanceof ChunkList) &&
       typeof chunk !== 'string' &&
       chunk !== undefined &&
       !state.objectMode) {
@@ -213,6 +218,13 @@ Writable.prototype.write = function(chunk, encoding, cb) {
   if (typeof cb !== 'function')
     cb = nop;
 
+  if (chunk instanceof ChunkList && !state.objectMode) {
+    // Streams that can't write a ChunkList as a whole get its Buffers.
+    if (!this._writableChunkList && !state.ended)
+      return writeChunkList(this, chunk, cb);
+    encoding = 'buffer';
+  }
+
   if (state.ended)
     writeAfterEnd(this, cb);
   else if (validChunk(this, state, chunk, cb)) {
@@ -223,6 +235,46 @@ Writable.prototype.write = function(chunk, encoding, cb) {
   return ret;
 };
 
+function writeChunkList(stream, list, cb) {
+  const chunks = list.chunks;
+  if (chunks.length === 0)
+    return stream.write(Buffer.alloc(0), cb);
+  stream.cork();
+  for (var i = 0; i < chunks.length - 1; i++)
+    stream.write(chunks[i]);
+  const ret = stream.write(chunks[chunks.length - 1], cb);
+  stream.uncork();
+  return ret;
+}
+
+// Writes all of the chunks in order, like a write() for each of them while
+// the stream is corked.  The callback is called once they have all been
+// written.
+Writable.prototype.writeBatch = function(chunks, encoding, cb) {
+  if (!Array.isArray(chunks))
+    throw new TypeError('"chunks" argument must be an Array');
+
+  if (typeof encoding === 'function') {
+    cb = encoding;
+    encoding = null;
+  }
+
+  if (chunks.length === 0) {
+    if (typeof cb === 'function')
+      process.nextTick(cb);
+    var state = this._writableState;
+    return state.length < state.highWaterMark;
+  }
+
+  var ret;
+  this.cork();
+  for (var i = 0; i < chunks.length - 1; i++)
+    this.write(chunks[i], encoding);
+  ret = this.write(chunks[chunks.length - 1], encoding, cb);
+  this.uncork();
+  return ret;
+};
+
 Writable.prototype.cork = function() {
   var state = this._writableState;
 
@@ -239,7 +291,7 @@ Writable.prototype.uncork = function() {
         !state.corked &&
         !state.finished &&
         !state.bufferProcessing &&
-        state.bufferedRequest)
+        state.bufferedRequestCount > 0)
       clearBuffer(this, state);
   }
 };
@@ -281,13 +333,9 @@ function writeOrBuffer(stream, state, chunk, encoding, cb) {
     state.needDrain = true;
 
   if (state.writing || state.corked) {
-    var last = state.lastBufferedRequest;
-    state.lastBufferedRequest = new WriteReq(chunk, encoding, cb);
-    if (last) {
-      last.next = state.lastBufferedRequest;
-    } else {
-      state.bufferedRequest = state.lastBufferedRequest;
-    }
+    state.bufferedRequests.push(chunk);
+    state.bufferedRequests.push(encoding);
+    state.bufferedRequests.push(cb);
     state.bufferedRequestCount += 1;
   } else {
     doWrite(stream, state, false, len, chunk, encoding, cb);
@@ -342,7 +390,7 @@ function onwrite(stream, er) {
     if (!finished &&
         !state.corked &&
         !state.bufferProcessing &&
-        state.bufferedRequest) {
+        state.bufferedRequestCount > 0) {
       clearBuffer(stream, state);
     }
 
@@ -368,35 +416,38 @@ function afterWrite(stream, state, finished, cb) {
 function onwriteDrain(stream, state) {
   if (state.length === 0 && state.needDrain) {
     state.needDrain = false;
-    stream.emit('drain');
+    internalEvents.emitNone(stream, 'drain');
   }
 }
 
 // if there's something in the buffer waiting, then process it
 function clearBuffer(stream, state) {
   state.bufferProcessing = true;
-  var entry = state.bufferedRequest;
+  var buffered = state.bufferedRequests;
 
-  if (stream._writev && entry && entry.next) {
+  if (stream._writev && state.bufferedRequestCount > 1) {
     // Fast case, write everything using _writev()
-    var l = state.bufferedRequestCount;
-    var buffer = new Array(l);
     var holder = state.corkedRequestsFree;
-    holder.entry = entry;
-
-    var count = 0;
-    while (entry) {
-      buffer[count] = entry;
-      entry = entry.next;
-      count += 1;
+    var entries = holder.entries;
+    var count = state.bufferedRequestCount;
+
+    entries.length = count;
+    for (var i = 0; i < count; i++) {
+      var entry = holder.pool[i];
+      if (entry === undefined)
+        entry = holder.pool[i] = new WriteReq(null, '', null);
+      entry.chunk = buffered.shift();
+      entry.encoding = buffered.shift();
+      entry.callback = buffered.shift();
+      entries[i] = entry;
     }
+    state.bufferedRequestCount = 0;
 
-    doWrite(stream, state, true, state.length, buffer, '', holder.finish);
+    doWrite(stream, state, true, state.length, entries, '', holder.finish);
 
     // doWrite is almost always async, defer these to save a bit of time
     // as the hot path ends with doWrite
     state.pendingcb++;
-    state.lastBufferedRequest = null;
     if (holder.next) {
       state.corkedRequestsFree = holder.next;
       holder.next = null;
@@ -405,14 +456,14 @@ function clearBuffer(stream, state) {
     }
   } else {
     // Slow case, write chunks one-by-one
-    while (entry) {
-      var chunk = entry.chunk;
-      var encoding = entry.encoding;
-      var cb = entry.callback;
+    while (state.bufferedRequestCount > 0) {
+      var chunk = buffered.shift();
+      var encoding = buffered.shift();
+      var cb = buffered.shift();
       var len = state.objectMode ? 1 : chunk.length;
+      state.bufferedRequestCount -= 1;
 
       doWrite(stream, state, false, len, chunk, encoding, cb);
-      entry = entry.next;
       // if we didn't call the onwrite immediately, then
       // it means that we need to wait until it does.
       // also, that means that the chunk and cb are currently
@@ -421,13 +472,8 @@ function clearBuffer(stream, state) {
         break;
       }
     }
-
-    if (entry === null)
-      state.lastBufferedRequest = null;
   }
 
-  state.bufferedRequestCount = 0;
-  state.bufferedRequest = entry;
   state.bufferProcessing = false;
 }
 
@@ -437,6 +483,9 @@ Writable.prototype._write = function(chunk, encoding, cb) {
 
 Writable.prototype._writev = null;
 
+// Set to true by streams whose _write() and _writev() accept ChunkLists.
+Writable.prototype._writableChunkList = false;
+
 Writable.prototype.end = function(chunk, encoding, cb) {
   var state = this._writableState;
 
@@ -467,7 +516,7 @@ Writable.prototype.end = function(chunk, encoding, cb) {
 function needFinish(state) {
   return (state.ending &&
           state.length === 0 &&
-          state.bufferedRequest === null &&
+          state.bufferedRequestCount === 0 &&
           !state.finished &&
           !state.writing);
 }
@@ -507,20 +556,25 @@ function endWritable(stream, state, cb) {
 }
 
 // It seems a linked list but it is not
-// there will be only 2 of these for each stream
+// there will be only 2 of these for each stream.  The entries that are
+// passed to _writev() come from the pool, which only grows as needed and
+// is reused for every _writev() call with this holder.
 function CorkedRequest(state) {
   this.next = null;
-  this.entry = null;
+  this.entries = [];
+  this.pool = [];
 
   this.finish = (err) => {
-    var entry = this.entry;
-    this.entry = null;
-    while (entry) {
+    var entries = this.entries;
+    for (var i = 0; i < entries.length; i++) {
+      var entry = entries[i];
       var cb = entry.callback;
+      entry.chunk = null;
+      entry.callback = null;
       state.pendingcb--;
       cb(err);
-      entry = entry.next;
     }
+    entries.length = 0;
     if (state.corkedRequestsFree) {
       state.corkedRequestsFree.next = this;
     } else {
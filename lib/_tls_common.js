@@ -44,6 +44,10 @@ exports.createSecureContext = function createSecureContext(options, context) {
 
   if (context) return c;
 
+  // The engine only applies to private keys that are set after it.
+  if (options.engine)
+    c.context.setEngine(options.engine);
+
   // NOTE: It's important to add CA before the cert to be able to load
   // cert's issuer in C++ code.
   if (options.ca) {
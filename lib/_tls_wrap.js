@@ -407,6 +407,11 @@ TLSSocket.prototype._init = function(socket, wrap) {
       if (this.server.listenerCount('OCSPRequest') > 0)
         ssl.enableCertCb();
     }
+
+    if (options.adaptiveRecordSize)
+      ssl.enableAdaptiveRecordSize();
+    if (options.asyncHandshake)
+      ssl.enableAsyncHandshake();
   } else {
     ssl.onhandshakestart = function() {};
     ssl.onhandshakedone = () => this._finishInit();
@@ -416,6 +421,9 @@ TLSSocket.prototype._init = function(socket, wrap) {
       ssl.setSession(options.session);
   }
 
+  if (options.kernelTLS)
+    ssl.enableKernelTLS();
+
   ssl.onerror = function(err) {
     if (self._writableState.errorEmitted)
       return;
@@ -625,6 +633,10 @@ TLSSocket.prototype.getSession = function() {
   return null;
 };
 
+TLSSocket.prototype.isKernelTLS = function() {
+  return this._handle ? this._handle.isKernelTLS() : false;
+};
+
 TLSSocket.prototype.isSessionReused = function() {
   if (this._handle) {
     return this._handle.isSessionReused();
@@ -755,7 +767,8 @@ function Server(/* [options], listener */) {
     secureOptions: self.secureOptions,
     honorCipherOrder: self.honorCipherOrder,
     crl: self.crl,
-    sessionIdContext: self.sessionIdContext
+    sessionIdContext: self.sessionIdContext,
+    engine: self.engine
   });
   this._sharedCreds = sharedCreds;
 
@@ -784,7 +797,10 @@ function Server(/* [options], listener */) {
       handshakeTimeout: timeout,
       NPNProtocols: self.NPNProtocols,
       ALPNProtocols: self.ALPNProtocols,
-      SNICallback: options.SNICallback || SNICallback
+      SNICallback: options.SNICallback || SNICallback,
+      adaptiveRecordSize: self.adaptiveRecordSize,
+      kernelTLS: self.kernelTLS,
+      asyncHandshake: self.asyncHandshake
     });
 
     socket.on('secure', function() {
@@ -830,6 +846,27 @@ function Server(/* [options], listener */) {
   if (listener) {
     this.on('secureConnection', listener);
   }
+
+  if (this.ticketKeyRotation) {
+    if (typeof this.ticketKeyRotation !== 'number')
+      throw new TypeError('ticketKeyRotation must be a number');
+    this.on('listening', startTicketKeyRotation);
+    this.on('close', stopTicketKeyRotation);
+  }
+
+  if (this.fetchOCSP) {
+    if (typeof this.fetchOCSP !== 'function')
+      throw new TypeError('fetchOCSP must be a function');
+    this._ocspTimers = null;
+    this.on('listening', startOCSPRefresh);
+    this.on('close', stopOCSPRefresh);
+  }
+
+  if (this.sessionCache) {
+    this._sessionCache = new Map();
+    this.on('newSession', storeCachedSession);
+    this.on('resumeSession', loadCachedSession);
+  }
 }
 
 util.inherits(Server, net.Server);
@@ -841,16 +878,120 @@ exports.createServer = function(options, listener) {
 
 Server.prototype._getServerData = function() {
   return {
-    ticketKeys: this.getTicketKeys().toString('hex')
+    ticketKeys: this.getTicketKeys().toString('hex'),
+    ticketKeyRotation: this.ticketKeyRotation || 0
   };
 };
 
 
 Server.prototype._setServerData = function(data) {
-  this.setTicketKeys(Buffer.from(data.ticketKeys, 'hex'));
+  const keys = Buffer.from(data.ticketKeys, 'hex');
+  if (!this._clusterTicketKeys)
+    this.setTicketKeys(keys);
+  else if (!keys.equals(this.getTicketKeys()))
+    this._sharedCreds.context.rotateTicketKeys(keys);
+
+  // Running in a cluster worker, the master rotates the keys and holds the
+  // session cache.
+  this._clusterTicketKeys = data.ticketKeyRotation > 0;
+  this._clusterSessionCache = true;
 };
 
 
+// Session ticket keys are replaced every `ticketKeyRotation` milliseconds.
+// Tickets that were issued with the previous keys are still accepted.
+function startTicketKeyRotation() {
+  if (this._clusterTicketKeys || this._ticketKeyTimer)
+    return;
+  this._ticketKeyTimer = setInterval(() => {
+    this._sharedCreds.context.rotateTicketKeys(crypto.randomBytes(48));
+  }, this.ticketKeyRotation);
+  this._ticketKeyTimer.unref();
+}
+
+
+function stopTicketKeyRotation() {
+  clearInterval(this._ticketKeyTimer);
+  this._ticketKeyTimer = null;
+}
+
+
+// Servers created with a `fetchOCSP` function keep the OCSP response of each
+// of their contexts in the context, which staples it without calling into JS.
+// It is fetched again when half of its lifetime is over.
+const kOCSPRetryDelay = 60 * 1000;
+
+function startOCSPRefresh() {
+  if (this._ocspTimers)
+    return;
+  this._ocspTimers = new Map();
+  refreshOCSP(this, this._sharedCreds.context);
+  this._contexts.forEach((elem) => refreshOCSP(this, elem[1]));
+}
+
+
+function stopOCSPRefresh() {
+  this._ocspTimers.forEach((timer) => clearTimeout(timer));
+  this._ocspTimers = null;
+}
+
+
+function refreshOCSP(server, context) {
+  const cert = context.getCertificate();
+  if (!cert)
+    return;
+
+  server.fetchOCSP(cert, context.getIssuer(), (err, response, maxAge) => {
+    const timers = server._ocspTimers;
+    if (!timers)
+      return;
+
+    // The response that is cached is kept until it expires.
+    var delay = kOCSPRetryDelay;
+    if (!err) {
+      context.setStapledOCSPResponse(response, maxAge);
+      delay = maxAge / 2;
+    }
+
+    const timer = setTimeout(() => refreshOCSP(server, context), delay);
+    timer.unref();
+    timers.set(context, timer);
+  });
+}
+
+
+// Built-in session cache for servers created with `sessionCache: true`,
+// shared by all workers when running in a cluster.
+const kMaxCachedSessions = 10000;
+var cluster = null;
+
+function storeCachedSession(id, session, cb) {
+  if (this._clusterSessionCache) {
+    if (cluster === null) cluster = require('cluster');
+    cluster._storeSession(this, id.toString('hex'), session.toString('hex'));
+  } else {
+    const key = id.toString('hex');
+    this._sessionCache.delete(key);
+    if (this._sessionCache.size >= kMaxCachedSessions)
+      this._sessionCache.delete(this._sessionCache.keys().next().value);
+    this._sessionCache.set(key, session);
+  }
+  cb();
+}
+
+
+function loadCachedSession(id, cb) {
+  if (this._clusterSessionCache) {
+    if (cluster === null) cluster = require('cluster');
+    cluster._loadSession(this, id.toString('hex'), (session) => {
+      cb(null, session === null ? null : Buffer.from(session, 'hex'));
+    });
+  } else {
+    cb(null, this._sessionCache.get(id.toString('hex')) || null);
+  }
+}
+
+
 Server.prototype.getTicketKeys = function getTicketKeys(keys) {
   return this._sharedCreds.context.getTicketKeys(keys);
 };
@@ -861,6 +1002,12 @@ Server.prototype.setTicketKeys = function setTicketKeys(keys) {
 };
 
 
+Server.prototype.getEngineStats = function getEngineStats() {
+  const context = this._sharedCreds.context;
+  return context.getEngineStats ? context.getEngineStats() : null;
+};
+
+
 Server.prototype.setOptions = function(options) {
   if (typeof options.requestCert === 'boolean') {
     this.requestCert = options.requestCert;
@@ -881,12 +1028,20 @@ Server.prototype.setOptions = function(options) {
   if (options.ca) this.ca = options.ca;
   if (options.secureProtocol) this.secureProtocol = options.secureProtocol;
   if (options.crl) this.crl = options.crl;
+  if (options.engine) this.engine = options.engine;
   if (options.ciphers) this.ciphers = options.ciphers;
   if (options.ecdhCurve !== undefined)
     this.ecdhCurve = options.ecdhCurve;
   if (options.dhparam) this.dhparam = options.dhparam;
   if (options.sessionTimeout) this.sessionTimeout = options.sessionTimeout;
   if (options.ticketKeys) this.ticketKeys = options.ticketKeys;
+  this.adaptiveRecordSize = !!options.adaptiveRecordSize;
+  this.kernelTLS = !!options.kernelTLS;
+  this.asyncHandshake = !!options.asyncHandshake;
+  if (options.ticketKeyRotation)
+    this.ticketKeyRotation = options.ticketKeyRotation;
+  this.sessionCache = !!options.sessionCache;
+  if (options.fetchOCSP) this.fetchOCSP = options.fetchOCSP;
   var secureOptions = options.secureOptions || 0;
   if (options.honorCipherOrder !== undefined)
     this.honorCipherOrder = !!options.honorCipherOrder;
@@ -916,7 +1071,10 @@ Server.prototype.addContext = function(servername, context) {
                       servername.replace(/([\.^$+?\-\\[\]{}])/g, '\\$1')
                                 .replace(/\*/g, '[^\.]*') +
                       '$');
-  this._contexts.push([re, tls.createSecureContext(context).context]);
+  const secureContext = tls.createSecureContext(context).context;
+  this._contexts.push([re, secureContext]);
+  if (this._ocspTimers)
+    refreshOCSP(this, secureContext);
 };
 
 function SNICallback(servername, callback) {
@@ -961,6 +1119,41 @@ function normalizeConnectArgs(listArgs) {
   return (cb) ? [options, cb] : [options];
 }
 
+// Sessions of the client connections made with `sessionCache: true`, keyed
+// by everything that decides whether the server is trusted, so that a session
+// is never resumed by a connection that would not have accepted the server.
+const kMaxClientSessions = 100;
+const clientSessions = new Map();
+
+function clientSessionKey(options, hostname) {
+  if (!options.sessionCache || options.session || options.secureContext ||
+      options.socket) {
+    return null;
+  }
+  return [
+    hostname,
+    options.host,
+    options.port,
+    options.path,
+    options.ca,
+    options.cert,
+    options.key,
+    options.pfx,
+    options.ciphers,
+    options.secureProtocol,
+    options.rejectUnauthorized
+  ].join(':');
+}
+
+
+function cacheClientSession(key, session) {
+  clientSessions.delete(key);
+  if (clientSessions.size >= kMaxClientSessions)
+    clientSessions.delete(clientSessions.keys().next().value);
+  clientSessions.set(key, session);
+}
+
+
 exports.connect = function(/* [port, host], options, cb */) {
   const argsLen = arguments.length;
   var args = new Array(argsLen);
@@ -992,6 +1185,10 @@ exports.connect = function(/* [port, host], options, cb */) {
                  options.host ||
                  (options.socket && options.socket._host) ||
                  'localhost';
+  const sessionKey = clientSessionKey(options, hostname);
+  if (sessionKey !== null)
+    options.session = clientSessions.get(sessionKey);
+
   const NPN = {};
   const ALPN = {};
   const context = options.secureContext || tls.createSecureContext(options);
@@ -1007,9 +1204,20 @@ exports.connect = function(/* [port, host], options, cb */) {
     session: options.session,
     NPNProtocols: NPN.NPNProtocols,
     ALPNProtocols: ALPN.ALPNProtocols,
-    requestOCSP: options.requestOCSP
+    requestOCSP: options.requestOCSP,
+    kernelTLS: options.kernelTLS
   });
 
+  if (sessionKey !== null) {
+    socket.once('secureConnect', () => {
+      cacheClientSession(sessionKey, socket.getSession());
+    });
+    socket.once('close', (hadError) => {
+      if (hadError)
+        clientSessions.delete(sessionKey);
+    });
+  }
+
   if (cb)
     socket.once('secureConnect', cb);
 
@@ -6,6 +6,9 @@ const bindingObj = {};
 
 exports.Buffer = Buffer;
 exports.SlowBuffer = SlowBuffer;
+exports.BufferSearcher = BufferSearcher;
+exports.ChunkList = ChunkList;
+exports.BufferLayout = BufferLayout;
 exports.INSPECT_MAX_BYTES = 50;
 exports.kMaxLength = binding.kMaxLength;
 
@@ -80,6 +83,13 @@ function createPool() {
 }
 createPool();
 
+require('internal/process/memory_pressure').addTrimHandler(function() {
+  // The next allocation starts a new pool, this one is freed once the
+  // Buffers that were sliced from it are gone.
+  allocPool = undefined;
+  poolOffset = poolSize;
+});
+
 
 function alignPool() {
   // Ensure aligned slices
@@ -225,6 +235,13 @@ function fromString(string, encoding) {
   if (!Buffer.isEncoding(encoding))
     throw new TypeError('"encoding" must be a valid string encoding');
 
+  // A string takes at least as many bytes of UTF-8 as it has characters, so
+  // a long one goes past the pool without being measured here first.
+  if (string.length >= (Buffer.poolSize >>> 1) &&
+      (encoding === 'utf8' || encoding === 'utf-8')) {
+    return binding.createFromString(string, encoding);
+  }
+
   var length = byteLength(string, encoding);
 
   if (length === 0)
@@ -337,6 +354,8 @@ Buffer.isEncoding = function(encoding) {
 
 Buffer.concat = function(list, length) {
   var i;
+  if (list instanceof ChunkList)
+    list = list.chunks;
   if (!Array.isArray(list))
     throw new TypeError('"list" argument must be an Array of Buffers');
 
@@ -530,6 +549,44 @@ Buffer.prototype.toString = function() {
 };
 
 
+// Like toString() but for the encodings whose characters V8 can read from
+// the bytes as they are, the string shares the memory of the Buffer.
+Buffer.prototype.toStringExternal = function toStringExternal(encoding,
+                                                              start,
+                                                              end) {
+  if (start === undefined || start < 0)
+    start = 0;
+  if (start > this.length)
+    return '';
+  if (end === undefined || end > this.length)
+    end = this.length;
+  if (end <= 0)
+    return '';
+  end >>>= 0;
+  start >>>= 0;
+  if (end <= start)
+    return '';
+
+  switch (encoding === undefined ? 'binary' : (encoding + '').toLowerCase()) {
+    case 'binary':
+      return this.binaryExternalSlice(start, end);
+
+    case 'ascii':
+      return this.asciiExternalSlice(start, end);
+
+    case 'ucs2':
+    case 'ucs-2':
+    case 'utf16le':
+    case 'utf-16le':
+      return this.ucs2ExternalSlice(start, end);
+
+    default:
+      throw new TypeError('Unsupported encoding for toStringExternal(): ' +
+                          encoding);
+  }
+};
+
+
 Buffer.prototype.equals = function equals(b) {
   if (!(b instanceof Buffer))
     throw new TypeError('Argument must be a Buffer');
@@ -680,6 +737,249 @@ Buffer.prototype.includes = function includes(val, byteOffset, encoding) {
 };
 
 
+// A list of Buffers that is written as if it were one Buffer, with a single
+// writev() and without concatenating the Buffers first.
+function ChunkList(chunks) {
+  if (!(this instanceof ChunkList))
+    return new ChunkList(chunks);
+
+  this.chunks = [];
+  this.length = 0;
+  if (chunks !== undefined) {
+    if (!Array.isArray(chunks))
+      throw new TypeError('"chunks" argument must be an Array');
+    for (var i = 0; i < chunks.length; i++)
+      this.append(chunks[i]);
+  }
+}
+
+
+ChunkList.prototype.append = function append(chunk, encoding) {
+  if (typeof chunk === 'string') {
+    chunk = Buffer.from(chunk, encoding);
+  } else if (chunk instanceof ChunkList) {
+    for (var i = 0; i < chunk.chunks.length; i++)
+      this.append(chunk.chunks[i]);
+    return this;
+  } else if (!(chunk instanceof Buffer)) {
+    throw new TypeError(
+        '"chunk" argument must be a string, Buffer or ChunkList');
+  }
+  if (chunk.length > 0) {
+    this.chunks.push(chunk);
+    this.length += chunk.length;
+  }
+  return this;
+};
+
+
+ChunkList.prototype.toBuffer = function toBuffer() {
+  return Buffer.concat(this.chunks, this.length);
+};
+
+
+function isUcs2(encoding) {
+  switch (('' + encoding).toLowerCase()) {
+    case 'ucs2':
+    case 'ucs-2':
+    case 'utf16le':
+    case 'utf-16le':
+      return true;
+  }
+  return false;
+}
+
+
+// A pattern that is searched for in many buffers.  The search tables are
+// built once, in the constructor, instead of on every buf.indexOf() call.
+function BufferSearcher(pattern, encoding) {
+  if (!(this instanceof BufferSearcher))
+    return new BufferSearcher(pattern, encoding);
+
+  if (typeof pattern === 'string') {
+    pattern = Buffer.from(pattern, encoding);
+  } else if (!(pattern instanceof Uint8Array)) {
+    throw new TypeError(
+        '"pattern" argument must be a string, Buffer or Uint8Array');
+  }
+  if (pattern.length === 0)
+    throw new RangeError('"pattern" argument must not be empty');
+
+  this._handle = new binding.BufferSearcher(pattern, isUcs2(encoding));
+}
+
+
+BufferSearcher.prototype.findFirst = function findFirst(buffer, byteOffset) {
+  return this._handle.findFirst(buffer, byteOffset);
+};
+
+
+BufferSearcher.prototype.findAll = function findAll(buffer, byteOffset) {
+  return this._handle.findAll(buffer, byteOffset);
+};
+
+
+// Converting between encodings uses ICU, and is only available when node is
+// built with it and ICU has its converters.  The bundled ICU does not.
+if (process.binding('config').hasIntl &&
+    process.binding('icu').transcode !== undefined) {
+  const icu = process.binding('icu');
+
+  // Node's names for the encodings that ICU knows under a different one,
+  // all others are passed to ICU as they are.
+  const icuEncodings = {
+    __proto__: null,
+    'utf8': 'utf-8',
+    'ucs2': 'utf-16le',
+    'ucs-2': 'utf-16le',
+    'utf16le': 'utf-16le',
+    'latin1': 'iso-8859-1',
+    'binary': 'iso-8859-1',
+    'ascii': 'us-ascii'
+  };
+
+  const icuEncoding = function icuEncoding(encoding) {
+    if (typeof encoding !== 'string')
+      throw new TypeError('"encoding" argument must be a string');
+    return icuEncodings[encoding.toLowerCase()] || encoding;
+  };
+
+  const transcodeError = function transcodeError(code) {
+    const name = typeof code === 'number' ? icu.icuErrName(code) : code;
+    const err = new Error(`Unable to transcode Buffer [${name}]`);
+    err.code = name;
+    return err;
+  };
+
+  exports.transcode = function transcode(source, fromEncoding, toEncoding) {
+    if (!(source instanceof Uint8Array))
+      throw new TypeError('"source" argument must be a Buffer or Uint8Array');
+    const result = icu.transcode(source,
+                                 icuEncoding(fromEncoding),
+                                 icuEncoding(toEncoding));
+    if (typeof result === 'number')
+      throw transcodeError(result);
+    return result;
+  };
+
+  // Converts a stream of Buffers, sequences that are split between two of
+  // them are completed by the next one.
+  exports.Transcoder = function Transcoder(fromEncoding, toEncoding) {
+    if (!(this instanceof Transcoder))
+      return new Transcoder(fromEncoding, toEncoding);
+    this._handle = new icu.Transcoder(icuEncoding(fromEncoding),
+                                      icuEncoding(toEncoding));
+    if (this._handle.code !== undefined)
+      throw transcodeError(this._handle.code);
+  };
+
+  const convert = function convert(transcoder, chunk, flush) {
+    if (!(chunk instanceof Uint8Array))
+      throw new TypeError('"chunk" argument must be a Buffer or Uint8Array');
+    const result = transcoder._handle.convert(chunk, flush);
+    if (typeof result === 'number')
+      throw transcodeError(result);
+    return result;
+  };
+
+  exports.Transcoder.prototype.write = function write(chunk) {
+    return convert(this, chunk, false);
+  };
+
+  exports.Transcoder.prototype.end = function end(chunk) {
+    return convert(this, chunk === undefined ? Buffer.alloc(0) : chunk, true);
+  };
+}
+
+
+const layoutTypeSizes = {
+  __proto__: null,
+  int8: 1, uint8: 1,
+  int16le: 2, int16be: 2, uint16le: 2, uint16be: 2,
+  int32le: 4, int32be: 4, uint32le: 4, uint32be: 4,
+  floatle: 4, floatbe: 4, doublele: 8, doublebe: 8
+};
+
+
+// A struct layout that is compiled once. Reading a struct, or a run of
+// structs, from a Buffer is then a single native call.
+function BufferLayout(fields, size) {
+  if (!(this instanceof BufferLayout))
+    return new BufferLayout(fields, size);
+  if (!Array.isArray(fields))
+    throw new TypeError('"fields" argument must be an Array');
+
+  const names = new Array(fields.length);
+  const types = new Array(fields.length);
+  const offsets = new Array(fields.length);
+  var end = 0;
+  var minSize = 0;
+  for (var i = 0; i < fields.length; i++) {
+    const field = fields[i];
+    if (field === null || typeof field !== 'object')
+      throw new TypeError('fields must be objects');
+    const type = ('' + field.type).toLowerCase();
+    const fieldSize = layoutTypeSizes[type];
+    if (fieldSize === undefined)
+      throw new TypeError('Unknown field type: ' + field.type);
+    const offset = field.offset === undefined ? end : field.offset;
+    if (offset !== (offset >>> 0))
+      throw new RangeError('"offset" must be a non-negative integer');
+    names[i] = '' + field.name;
+    types[i] = type;
+    offsets[i] = offset;
+    end = offset + fieldSize;
+    minSize = Math.max(minSize, end);
+  }
+
+  if (size === undefined)
+    size = minSize;
+  else if (size !== (size >>> 0) || size < minSize)
+    throw new RangeError('"size" must be an integer that fits all fields');
+
+  this.size = size;
+  this._handle = new binding.BufferLayout(names, types, offsets, size);
+}
+
+
+function checkLayoutRange(layout, buf, offset, count) {
+  if (!(buf instanceof Uint8Array))
+    throw new TypeError('argument should be a Buffer');
+  if (offset !== (offset >>> 0) || count !== (count >>> 0) ||
+      count > 0x7fffffff)
+    throw new RangeError('Index out of range');
+  checkOffset(offset, layout.size * count, buf.length);
+}
+
+
+BufferLayout.prototype.read = function read(buf, offset) {
+  if (offset === undefined)
+    offset = 0;
+  checkLayoutRange(this, buf, offset, 1);
+  return this._handle.read(buf, offset, -1);
+};
+
+
+BufferLayout.prototype.readArray = function readArray(buf, offset) {
+  if (offset === undefined)
+    offset = 0;
+  checkLayoutRange(this, buf, offset, 1);
+  return this._handle.readArray(buf, offset);
+};
+
+
+BufferLayout.prototype.readMany = function readMany(buf, offset, count) {
+  if (offset === undefined)
+    offset = 0;
+  if (count === undefined && buf instanceof Uint8Array) {
+    count = this.size === 0 || offset > buf.length ?
+        0 : Math.floor((buf.length - offset) / this.size);
+  }
+  checkLayoutRange(this, buf, offset, count);
+  return this._handle.read(buf, offset, count);
+};
+
+
 // Usage:
 //    buffer.fill(number[, offset[, end]])
 //    buffer.fill(buffer[, offset[, end]])
@@ -55,12 +55,15 @@ exports.fork = function(modulePath /*, args, options*/) {
 };
 
 
-exports._forkChild = function(fd) {
+exports.createZygote = require('internal/zygote').createZygote;
+
+
+exports._forkChild = function(fd, serialization) {
   // set process.send()
   var p = new Pipe(true);
   p.open(fd);
   p.unref();
-  const control = setupChannel(process, p);
+  const control = setupChannel(process, p, serialization);
   process.on('newListener', function(name) {
     if (name === 'message' || name === 'disconnect') control.ref();
   });
@@ -373,7 +376,8 @@ var spawn = exports.spawn = function(/*file, args, options*/) {
     envPairs: opts.envPairs,
     stdio: options.stdio,
     uid: options.uid,
-    gid: options.gid
+    gid: options.gid,
+    serialization: options.serialization
   });
 
   return child;
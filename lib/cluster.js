@@ -4,10 +4,19 @@ const EventEmitter = require('events');
 const assert = require('assert');
 const dgram = require('dgram');
 const fork = require('child_process').fork;
+const fs = require('fs');
 const net = require('net');
 const util = require('util');
 const SCHED_NONE = 1;
 const SCHED_RR = 2;
+const SCHED_REUSEPORT = 3;
+const SCHED_LEAST = 4;
+
+// With SCHED_LEAST, workers report their load this often, in milliseconds.
+// Workers whose event loop lags more than LOAD_LAG_THRESHOLD milliseconds are
+// given connections only when all of them do.
+const LOAD_REPORT_INTERVAL = 500;
+const LOAD_LAG_THRESHOLD = 50;
 
 const uv = process.binding('uv');
 
@@ -110,6 +119,56 @@ SharedHandle.prototype.remove = function(worker) {
 };
 
 
+// Every worker listens on a socket of its own that is bound with SO_REUSEPORT
+// and the kernel balances the connections over them. The master keeps a bound
+// socket that doesn't listen, it holds on to the port while workers come and
+// go, and picks the port that all workers bind to when it is 0.
+function ReusePortHandle(key, address, port, addressType) {
+  this.key = key;
+  this.workers = [];
+  this.handle = null;
+  this.errno = 0;
+  this.port = port;
+
+  var rval = net._createServerHandle(address, port, addressType, undefined,
+                                     true);
+  if (typeof rval === 'number') {
+    this.errno = rval;
+    return;
+  }
+
+  this.handle = rval;
+
+  // EADDRINUSE isn't reported until listen() is called, see net.js.
+  var out = {};
+  var err = rval.getsockname(out);
+  if (err === 0 && port > 0 && port !== out.port)
+    err = uv.UV_EADDRINUSE;
+  if (err === 0)
+    this.port = out.port;
+  else
+    this.errno = err;
+}
+
+ReusePortHandle.prototype.add = function(worker, send) {
+  assert(this.workers.indexOf(worker) === -1);
+  this.workers.push(worker);
+  send(this.errno, { reusePort: true, port: this.port }, null);
+};
+
+ReusePortHandle.prototype.remove = function(worker) {
+  var index = this.workers.indexOf(worker);
+  if (index === -1) return false; // The worker wasn't sharing this handle.
+  this.workers.splice(index, 1);
+  if (this.workers.length !== 0) return false;
+  if (this.handle !== null) {
+    this.handle.close();
+    this.handle = null;
+  }
+  return true;
+};
+
+
 // Start a round-robin server. Master accepts connections and distributes
 // them over the workers.
 function RoundRobinHandle(key, address, port, addressType, backlog, fd) {
@@ -204,6 +263,62 @@ RoundRobinHandle.prototype.handoff = function(worker) {
 };
 
 
+// Like round-robin, but each connection goes to the free worker with the
+// fewest open connections, according to the last report of the worker and
+// the connections that were handed to it since.
+function LeastLoadedHandle(key, address, port, addressType, backlog, fd) {
+  RoundRobinHandle.call(this, key, address, port, addressType, backlog, fd);
+}
+util.inherits(LeastLoadedHandle, RoundRobinHandle);
+
+LeastLoadedHandle.prototype.distribute = function(err, handle) {
+  this.handles.push(handle);
+  this.dispatch();
+};
+
+LeastLoadedHandle.prototype.handoff = function(worker) {
+  if (worker.id in this.all === false) {
+    return;  // Worker is closing (or has closed) the server.
+  }
+  if (this.free.indexOf(worker) === -1)
+    this.free.push(worker);
+  this.dispatch();
+};
+
+LeastLoadedHandle.prototype.dispatch = function() {
+  while (this.handles.length > 0 && this.free.length > 0) {
+    var best = 0;
+    for (var i = 1; i < this.free.length; i++) {
+      if (compareLoad(this.free[i].load, this.free[best].load) < 0)
+        best = i;
+    }
+    var worker = this.free.splice(best, 1)[0];
+    this.send(worker, this.handles.shift());
+  }
+};
+
+LeastLoadedHandle.prototype.send = function(worker, handle) {
+  var message = { act: 'newconn', key: this.key };
+  var self = this;
+  worker.load.connections++;
+  sendHelper(worker.process, message, handle, function(reply) {
+    if (reply.accepted) {
+      handle.close();
+    } else {
+      worker.load.connections--;
+      self.distribute(0, handle);  // Worker is shutting down.
+    }
+    self.handoff(worker);
+  });
+};
+
+function compareLoad(a, b) {
+  return (a.lag > LOAD_LAG_THRESHOLD) - (b.lag > LOAD_LAG_THRESHOLD) ||
+         a.connections - b.connections ||
+         a.lag - b.lag;
+}
+
+
 if (cluster.isMaster)
   masterInit();
 else
@@ -218,7 +333,9 @@ function masterInit() {
   // XXX(bnoordhuis) Fold cluster.schedulingPolicy into cluster.settings?
   var schedulingPolicy = {
     'none': SCHED_NONE,
-    'rr': SCHED_RR
+    'rr': SCHED_RR,
+    'reuseport': SCHED_REUSEPORT,
+    'least': SCHED_LEAST
   }[process.env.NODE_CLUSTER_SCHED_POLICY];
 
   if (schedulingPolicy === undefined) {
@@ -230,6 +347,10 @@ function masterInit() {
   cluster.schedulingPolicy = schedulingPolicy;
   cluster.SCHED_NONE = SCHED_NONE;  // Leave it to the operating system.
   cluster.SCHED_RR = SCHED_RR;      // Master distributes connections.
+  // Workers listen with SO_REUSEPORT, the kernel distributes connections.
+  cluster.SCHED_REUSEPORT = SCHED_REUSEPORT;
+  // Master distributes connections to the workers with the fewest of them.
+  cluster.SCHED_LEAST = SCHED_LEAST;
 
   // Keyed on address:port:etc. When a worker dies, we walk over the handles
   // and remove() the worker from each one. remove() may do a linear scan
@@ -255,11 +376,20 @@ function masterInit() {
       settings.execArgv = settings.execArgv.concat(['--logfile=v8-%p.log']);
     }
     cluster.settings = settings;
+    // The cache outlives the workers, its name goes away with the master.
+    if (settings.sharedCacheSize !== undefined && !cluster.sharedCache) {
+      cluster.sharedCache = require('internal/shared_cache')
+          .createSharedCache(settings.sharedCacheSize);
+      process.once('exit', () => cluster.sharedCache.close());
+    }
     if (initialized === true)
       return process.nextTick(setupSettingsNT, settings);
     initialized = true;
     schedulingPolicy = cluster.schedulingPolicy;  // Freeze policy.
-    assert(schedulingPolicy === SCHED_NONE || schedulingPolicy === SCHED_RR,
+    assert(schedulingPolicy === SCHED_NONE ||
+           schedulingPolicy === SCHED_RR ||
+           schedulingPolicy === SCHED_REUSEPORT ||
+           schedulingPolicy === SCHED_LEAST,
            'Bad cluster.schedulingPolicy: ' + schedulingPolicy);
 
     var hasDebugArg = process.execArgv.some(function(argv) {
@@ -294,14 +424,40 @@ function masterInit() {
     cluster.emit('setup', settings);
   }
 
+  // With settings.affinity, each worker is pinned to the CPU with the fewest
+  // live workers, taking the CPUs NUMA node by node, and its threadpool to the
+  // CPUs of the same node.  cpuLoad counts the live workers of each CPU.
+  var cpuTopology = null;
+  const cpuLoad = {};
+
+  function assignCpu() {
+    if (cpuTopology === null)
+      cpuTopology = readCpuTopology();
+
+    var best = -1;
+    cpuTopology.cpus.forEach((cpu) => {
+      if (best === -1 || (cpuLoad[cpu] | 0) < (cpuLoad[best] | 0))
+        best = cpu;
+    });
+    if (best !== -1)
+      cpuLoad[best] = (cpuLoad[best] | 0) + 1;
+    return best;
+  }
+
   var debugPortOffset = 1;
 
-  function createWorkerProcess(id, env) {
+  function createWorkerProcess(id, env, cpu) {
     var workerEnv = util._extend({}, process.env);
     var execArgv = cluster.settings.execArgv.slice();
 
     workerEnv = util._extend(workerEnv, env);
     workerEnv.NODE_UNIQUE_ID = '' + id;
+    if (cpu !== -1) {
+      workerEnv.NODE_CLUSTER_AFFINITY =
+          cpu + ':' + cpuTopology.nodeCpus[cpu].join(',');
+    }
+    if (cluster.sharedCache)
+      workerEnv.NODE_CLUSTER_SHARED_CACHE = cluster.sharedCache.name;
 
     for (var i = 0; i < execArgv.length; i++) {
       var match = execArgv[i].match(/^(--debug|--debug-(brk|port))(=\d+)?$/);
@@ -318,7 +474,8 @@ function masterInit() {
       silent: cluster.settings.silent,
       execArgv: execArgv,
       gid: cluster.settings.gid,
-      uid: cluster.settings.uid
+      uid: cluster.settings.uid,
+      serialization: cluster.settings.serialization
     });
   }
 
@@ -340,24 +497,36 @@ function masterInit() {
 
     for (var key in handles) {
       var handle = handles[key];
-      if (handle.remove(worker)) delete handles[key];
+      if (handle.remove(worker)) removeHandle(key);
     }
   }
 
+  function removeHandle(key) {
+    var handle = handles[key];
+    if (handle.ticketKeyTimer) clearInterval(handle.ticketKeyTimer);
+    delete handles[key];
+  }
+
   cluster.fork = function(env) {
     cluster.setupMaster();
     const id = ++ids;
-    const workerProcess = createWorkerProcess(id, env);
+    const cpu = cluster.settings.affinity ? assignCpu() : -1;
+    const workerProcess = createWorkerProcess(id, env, cpu);
     const worker = new Worker({
       id: id,
       process: workerProcess
     });
+    // Reported by the worker with SCHED_LEAST.
+    worker.load = { connections: 0, lag: 0 };
 
     worker.on('message', function(message, handle) {
       cluster.emit('message', this, message, handle);
     });
 
     worker.process.once('exit', function(exitCode, signalCode) {
+      if (cpu !== -1)
+        cpuLoad[cpu] -= 1;
+
       /*
        * Remove the worker from the workers list only
        * if it has disconnected, otherwise we might
@@ -449,6 +618,12 @@ function masterInit() {
       exitedAfterDisconnect(worker, message);
     else if (message.act === 'close')
       close(worker, message);
+    else if (message.act === 'storeSession')
+      storeSession(worker, message);
+    else if (message.act === 'loadSession')
+      loadSession(worker, message);
+    else if (message.act === 'load')
+      load(worker, message);
   }
 
   function online(worker) {
@@ -475,14 +650,23 @@ function masterInit() {
     var handle = handles[key];
     if (handle === undefined) {
       var constructor = RoundRobinHandle;
+      if (schedulingPolicy === SCHED_LEAST)
+        constructor = LeastLoadedHandle;
       // UDP is exempt from round-robin connection balancing for what should
       // be obvious reasons: it's connectionless. There is nothing to send to
       // the workers except raw datagrams and that's pointless.
-      if (schedulingPolicy !== SCHED_RR ||
+      if ((schedulingPolicy !== SCHED_RR &&
+           schedulingPolicy !== SCHED_LEAST) ||
           message.addressType === 'udp4' ||
           message.addressType === 'udp6') {
         constructor = SharedHandle;
       }
+      // SO_REUSEPORT only applies to TCP sockets that the workers create.
+      if (schedulingPolicy === SCHED_REUSEPORT &&
+          (message.addressType === 4 || message.addressType === 6) &&
+          !(message.fd >= 0)) {
+        constructor = ReusePortHandle;
+      }
       handles[key] = handle = new constructor(key,
                                               message.address,
                                               message.port,
@@ -491,7 +675,11 @@ function masterInit() {
                                               message.fd,
                                               message.flags);
     }
-    if (!handle.data) handle.data = message.data;
+    if (!handle.data) {
+      handle.data = message.data;
+      if (handle.data && handle.data.ticketKeyRotation > 0)
+        rotateTicketKeys(key, handle, handle.data.ticketKeyRotation);
+    }
 
     // Set custom server data
     handle.add(worker, function(errno, reply, handle) {
@@ -499,13 +687,58 @@ function masterInit() {
         errno: errno,
         key: key,
         ack: message.seq,
-        data: handles[key].data
+        data: handles[key].data,
+        reportLoad: handles[key] instanceof LeastLoadedHandle
       }, reply);
-      if (errno) delete handles[key];  // Gives other workers a chance to retry.
+      if (errno) removeHandle(key);  // Gives other workers a chance to retry.
       send(worker, reply, handle);
     });
   }
 
+  // TLS servers in the workers share their session ticket keys.  The master
+  // replaces the keys periodically and pushes them to all workers, which keep
+  // accepting tickets that were issued with the previous keys.
+  function rotateTicketKeys(key, handle, interval) {
+    const crypto = require('crypto');
+    handle.ticketKeyTimer = setInterval(function() {
+      handle.data.ticketKeys = crypto.randomBytes(48).toString('hex');
+      for (var id in cluster.workers) {
+        var worker = cluster.workers[id];
+        if (worker.isConnected())
+          send(worker, { act: 'serverData', key: key, data: handle.data });
+      }
+    }, interval);
+    handle.ticketKeyTimer.unref();
+  }
+
+  // The TLS session cache that is shared by the workers.  Sessions are keyed
+  // by session ID, the oldest ones are evicted first.
+  const MAX_CACHED_SESSIONS = 10000;
+
+  function storeSession(worker, message) {
+    var handle = handles[message.key];
+    if (handle === undefined) return;
+    if (handle.sessions === undefined) handle.sessions = new Map();
+    var sessions = handle.sessions;
+    sessions.delete(message.id);
+    if (sessions.size >= MAX_CACHED_SESSIONS)
+      sessions.delete(sessions.keys().next().value);
+    sessions.set(message.id, message.session);
+  }
+
+  function loadSession(worker, message) {
+    var handle = handles[message.key];
+    var session = null;
+    if (handle !== undefined && handle.sessions !== undefined)
+      session = handle.sessions.get(message.id) || null;
+    send(worker, { ack: message.seq, session: session });
+  }
+
+  function load(worker, message) {
+    worker.load.connections = message.connections;
+    worker.load.lag = message.lag;
+  }
+
   function listening(worker, message) {
     var info = {
       addressType: message.addressType,
@@ -523,7 +756,7 @@ function masterInit() {
   function close(worker, message) {
     var key = message.key;
     var handle = handles[key];
-    if (handle && handle.remove(worker)) delete handles[key];
+    if (handle && handle.remove(worker)) removeHandle(key);
   }
 
   function send(worker, message, handle, cb) {
@@ -532,9 +765,82 @@ function masterInit() {
 }
 
 
+// Parses a list of CPUs in the format of sysfs, such as "0-3,8-11".
+function parseCpuList(list) {
+  const cpus = [];
+  list.trim().split(',').forEach((range) => {
+    if (range === '')
+      return;
+    const bounds = range.split('-');
+    const last = +bounds[bounds.length - 1];
+    for (var cpu = +bounds[0]; cpu <= last; cpu++)
+      cpus.push(cpu);
+  });
+  return cpus;
+}
+
+
+// Returns the CPUs that the process may run on, ordered by NUMA node, and the
+// CPUs of the node of each of them.  Without NUMA information, all CPUs are
+// on the same node; without CPU affinity, there are none.
+function readCpuTopology() {
+  const nodeDir = '/sys/devices/system/node';
+  var allowed;
+  try {
+    allowed = process.getAffinity();
+  } catch (err) {
+    return { cpus: [], nodeCpus: {} };
+  }
+
+  const nodeOf = {};
+  try {
+    fs.readdirSync(nodeDir).forEach((name) => {
+      const match = /^node(\d+)$/.exec(name);
+      if (match === null)
+        return;
+      const list = fs.readFileSync(`${nodeDir}/${name}/cpulist`, 'latin1');
+      parseCpuList(list).forEach((cpu) => { nodeOf[cpu] = +match[1]; });
+    });
+  } catch (err) {
+    // Not Linux, or a kernel without NUMA support.
+  }
+
+  const node = (cpu) => nodeOf[cpu] | 0;
+  const cpus = allowed.slice().sort((a, b) => node(a) - node(b) || a - b);
+  const byNode = {};
+  const nodeCpus = {};
+  cpus.forEach((cpu) => {
+    if (byNode[node(cpu)] === undefined)
+      byNode[node(cpu)] = [];
+    byNode[node(cpu)].push(cpu);
+    nodeCpus[cpu] = byNode[node(cpu)];
+  });
+  return { cpus: cpus, nodeCpus: nodeCpus };
+}
+
+
+// Applies the NODE_CLUSTER_AFFINITY of the master, "cpu:threadpool cpus".
+// The threadpool goes first, or threads that start later would inherit the
+// single CPU of the main thread.
+function pinWorker(affinity) {
+  const parts = affinity.split(':');
+  const threadpool = parseCpuList(parts[1]);
+  try {
+    ['cpu', 'fs', 'dns'].forEach((queue) => {
+      process.setThreadpoolAffinity(threadpool, queue);
+    });
+    process.setAffinity([+parts[0]]);
+  } catch (err) {
+    process.emitWarning(
+        `Could not pin the worker to CPU ${parts[0]}: ${err.message}`);
+  }
+}
+
+
 function workerInit() {
   var handles = {};
   var indexes = {};
+  var servers = {};
 
   // Called from src/node.js
   cluster._setupWorker = function() {
@@ -544,6 +850,20 @@ function workerInit() {
       state: 'online'
     });
     cluster.worker = worker;
+
+    const affinity = process.env.NODE_CLUSTER_AFFINITY;
+    if (affinity !== undefined) {
+      delete process.env.NODE_CLUSTER_AFFINITY;
+      pinWorker(affinity);
+    }
+
+    const sharedCache = process.env.NODE_CLUSTER_SHARED_CACHE;
+    if (sharedCache !== undefined) {
+      delete process.env.NODE_CLUSTER_SHARED_CACHE;
+      cluster.sharedCache =
+          require('internal/shared_cache').openSharedCache(sharedCache);
+    }
+
     process.once('disconnect', function() {
       worker.emit('disconnect');
       if (!worker.exitedAfterDisconnect) {
@@ -559,6 +879,8 @@ function workerInit() {
         onconnection(message, handle);
       else if (message.act === 'disconnect')
         _disconnect.call(worker, true);
+      else if (message.act === 'serverData')
+        serverData(message);
     }
   };
 
@@ -583,11 +905,17 @@ function workerInit() {
     if (obj._getServerData) message.data = obj._getServerData();
     send(message, function(reply, handle) {
       if (obj._setServerData) obj._setServerData(reply.data);
+      if (!reply.errno) servers[reply.key] = obj;
+
+      if (reply.reportLoad)
+        startLoadReports();
 
       if (handle)
-        shared(reply, handle, cb);  // Shared listen socket.
+        shared(reply, handle, cb);      // Shared listen socket.
+      else if (reply.reusePort)
+        reusePort(reply, options, cb);  // Listen socket of its own.
       else
-        rr(reply, cb);              // Round-robin.
+        rr(reply, cb);                  // Round-robin.
     });
     obj.once('listening', function() {
       cluster.worker.state = 'listening';
@@ -598,6 +926,87 @@ function workerInit() {
     });
   };
 
+  // Tells the master how many connections the servers have and how late the
+  // timer of the reports runs, which is how much the event loop lags.
+  var loadTimer = null;
+
+  function startLoadReports() {
+    if (loadTimer !== null)
+      return;
+    var expected = Date.now() + LOAD_REPORT_INTERVAL;
+    loadTimer = setInterval(function() {
+      const now = Date.now();
+      const lag = Math.max(0, now - expected);
+      expected = now + LOAD_REPORT_INTERVAL;
+      if (!process.connected)
+        return;
+      var connections = 0;
+      for (var key in servers)
+        connections += servers[key]._connections | 0;
+      send({ act: 'load', connections: connections, lag: lag });
+    }, LOAD_REPORT_INTERVAL);
+    loadTimer.unref();
+  }
+
+  // Updated custom data, i.e. rotated TLS ticket keys.
+  function serverData(message) {
+    var obj = servers[message.key];
+    if (obj !== undefined && obj._setServerData)
+      obj._setServerData(message.data);
+  }
+
+  // TLS session cache in the master, see storeSession() and loadSession().
+  cluster._storeSession = function(obj, id, session) {
+    var key = serverKey(obj);
+    if (key !== undefined)
+      send({ act: 'storeSession', key: key, id: id, session: session });
+  };
+
+  cluster._loadSession = function(obj, id, cb) {
+    var key = serverKey(obj);
+    if (key === undefined)
+      return process.nextTick(cb, null);
+    send({ act: 'loadSession', key: key, id: id }, function(reply) {
+      cb(reply.session);
+    });
+  };
+
+  function serverKey(obj) {
+    for (var key in servers)
+      if (servers[key] === obj && handles[key] !== undefined) return key;
+  }
+
+  // Listen socket of the worker's own, bound with SO_REUSEPORT to the port
+  // that the master picked.
+  function reusePort(message, options, cb) {
+    var key = message.key;
+    if (message.errno)
+      return cb(message.errno, null);
+
+    var handle = net._createServerHandle(options.address,
+                                         message.port,
+                                         options.addressType,
+                                         undefined,
+                                         true);
+    if (typeof handle === 'number') {
+      send({ act: 'close', key: key });
+      delete servers[key];
+      return cb(handle, null);
+    }
+
+    // Tells the master when it is closed, like shared() does.
+    var close = handle.close;
+    handle.close = function() {
+      send({ act: 'close', key: key });
+      delete handles[key];
+      delete servers[key];
+      return close.apply(this, arguments);
+    };
+    assert(handles[key] === undefined);
+    handles[key] = handle;
+    cb(0, handle);
+  }
+
   // Shared listen socket.
   function shared(message, handle, cb) {
     var key = message.key;
@@ -607,6 +1016,7 @@ function workerInit() {
     handle.close = function() {
       send({ act: 'close', key: key });
       delete handles[key];
+      delete servers[key];
       return close.apply(this, arguments);
     };
     assert(handles[key] === undefined);
@@ -636,6 +1046,7 @@ function workerInit() {
       if (key === undefined) return;
       send({ act: 'close', key: key });
       delete handles[key];
+      delete servers[key];
       key = undefined;
     }
 
@@ -1,6 +1,12 @@
 'use strict';
 
 const util = require('util');
+const Buffer = require('buffer').Buffer;
+const LogWriter = process.binding('log_writer').LogWriter;
+const NativeBinaryLogger = process.binding('binary_log').BinaryLogger;
+
+const kDefaultBufferSize = 1024 * 1024;
+const kMaxBufferSize = 1024 * 1024 * 1024;
 
 function Console(stdout, stderr) {
   if (!(this instanceof Console)) {
@@ -97,5 +103,222 @@ Console.prototype.assert = function(expression, ...args) {
 };
 
 
-module.exports = new Console(process.stdout, process.stderr);
+function validateBufferSize(bufferSize) {
+  if (bufferSize === undefined)
+    return kDefaultBufferSize;
+  if (!Number.isInteger(bufferSize) || bufferSize < 1 ||
+      bufferSize > kMaxBufferSize) {
+    throw new RangeError('"bufferSize" must be an integer between 1 and ' +
+                         kMaxBufferSize);
+  }
+  return bufferSize;
+}
+
+
+function getWriterStats(handle, stats) {
+  handle.getStats(stats);
+  return {
+    dropped: stats[0],
+    droppedBytes: stats[1],
+    errors: stats[2],
+    lastError: stats[3] === 0 ? null : process.binding('uv').errname(stats[3])
+  };
+}
+
+
+// Writes to a file descriptor from a thread of its own, through a buffer of
+// a fixed size.  Writes that don't fit into the buffer are dropped.
+function BufferedWriter(fd, options) {
+  if (!(this instanceof BufferedWriter))
+    return new BufferedWriter(fd, options);
+  if (!Number.isInteger(fd) || fd < 0 || fd > 0x7fffffff)
+    throw new TypeError('"fd" must be a file descriptor');
+
+  options = options || {};
+  const bufferSize = validateBufferSize(options.bufferSize);
+
+  this.fd = fd;
+  this._handle = new LogWriter(fd, bufferSize);
+  this._stats = [0, 0, 0, 0];
+  this._onexit = () => this.end();
+  process.on('exit', this._onexit);
+}
+
+
+// Returns false if the chunk was dropped.
+BufferedWriter.prototype.write = function(chunk, encoding) {
+  if (typeof chunk === 'string') {
+    if (encoding && encoding !== 'utf8' && encoding !== 'utf-8')
+      chunk = Buffer.from(chunk, encoding);
+  } else if (!(chunk instanceof Buffer)) {
+    throw new TypeError('"chunk" must be a string or Buffer');
+  }
+  return this._handle.write(chunk);
+};
+
+
+// Blocks until everything that was written so far is written out.
+BufferedWriter.prototype.flush = function() {
+  this._handle.flush();
+};
+
+
+BufferedWriter.prototype.end = function(chunk, encoding) {
+  if (chunk !== undefined && chunk !== null)
+    this.write(chunk, encoding);
+  this._handle.close();
+  process.removeListener('exit', this._onexit);
+};
+
+
+BufferedWriter.prototype.getStats = function() {
+  return getWriterStats(this._handle, this._stats);
+};
+
+
+// Logs records of a registered format and typed arguments to a file
+// descriptor.  The arguments are serialized into a buffer of a fixed size
+// and written out by a thread of their own, nothing is formatted.  See
+// src/node_binary_log.cc for the layout of the records.
+function BinaryLogger(fd, options) {
+  if (!(this instanceof BinaryLogger))
+    return new BinaryLogger(fd, options);
+  if (!Number.isInteger(fd) || fd < 0 || fd > 0x7fffffff)
+    throw new TypeError('"fd" must be a file descriptor');
+
+  options = options || {};
+  const bufferSize = validateBufferSize(options.bufferSize);
+
+  this.fd = fd;
+  this._handle = new NativeBinaryLogger(fd, bufferSize, !!options.gc);
+  this._ended = false;
+  this._stats = [0, 0, 0, 0];
+  this._onexit = () => this.end();
+  process.on('exit', this._onexit);
+}
+
+
+BinaryLogger.prototype.register = function(format) {
+  if (typeof format !== 'string')
+    throw new TypeError('"format" must be a string');
+  if (this._ended)
+    throw new Error('The logger was ended');
+  const id = this._handle.registerFormat(format);
+  if (id === 0)
+    throw new RangeError('"format" is too long for the buffer');
+  return id;
+};
+
+
+// Returns false if the record was dropped.  The common arities avoid
+// .apply().
+BinaryLogger.prototype.log = function(id, a, b, c) {
+  if (!Number.isInteger(id) || id < 1 || id > 0xffffffff)
+    throw new TypeError('"id" must be a format id');
+  const handle = this._handle;
+  switch (arguments.length) {
+    case 1: return handle.log(id);
+    case 2: return handle.log(id, a);
+    case 3: return handle.log(id, a, b);
+    case 4: return handle.log(id, a, b, c);
+    default: return handle.log.apply(handle, arguments);
+  }
+};
+
+
+// Blocks until everything that was logged so far is written out.
+BinaryLogger.prototype.flush = function() {
+  this._handle.flush();
+};
+
+
+BinaryLogger.prototype.end = function() {
+  this._ended = true;
+  this._handle.close();
+  process.removeListener('exit', this._onexit);
+};
+
+
+BinaryLogger.prototype.getStats = function() {
+  return getWriterStats(this._handle, this._stats);
+};
+
+
+const kRecordHeaderSize = 16;
+
+// Returns the records in |buffer| as { id, format, time, args } objects,
+// where time is in nanoseconds.  Registrations of formats are not returned,
+// and an incomplete record at the end is ignored.
+BinaryLogger.decode = function decode(buffer) {
+  if (!(buffer instanceof Buffer))
+    throw new TypeError('"buffer" must be a Buffer');
+
+  const formats = new Map();
+  const records = [];
+  var offset = 0;
+  while (offset + kRecordHeaderSize <= buffer.length) {
+    const length = buffer.readUInt32LE(offset);
+    const end = offset + length;
+    if (length < kRecordHeaderSize || end > buffer.length)
+      break;
+    const id = buffer.readUInt32LE(offset + 4);
+    const time = buffer.readUInt32LE(offset + 12) * 0x100000000 +
+                 buffer.readUInt32LE(offset + 8);
+
+    const args = [];
+    var pos = offset + kRecordHeaderSize;
+    while (pos < end) {
+      switch (buffer[pos++]) {
+        case 1:
+          args.push(buffer.readInt32LE(pos));
+          pos += 4;
+          break;
+        case 2:
+          args.push(buffer.readDoubleLE(pos));
+          pos += 8;
+          break;
+        case 3: {
+          const stringLength = buffer.readUInt32LE(pos);
+          pos += 4;
+          args.push(buffer.toString('utf8', pos, pos + stringLength));
+          pos += stringLength;
+          break;
+        }
+        case 4: args.push(true); break;
+        case 5: args.push(false); break;
+        case 6: args.push(null); break;
+        default:
+          throw new Error('Invalid argument at offset ' + (pos - 1));
+      }
+    }
+
+    if (id === 0)
+      formats.set(args[0], args[1]);
+    else
+      records.push({ id, format: formats.get(id), time, args });
+    offset = end;
+  }
+  return records;
+};
+
+
+const globalConsole = module.exports = new Console(process.stdout,
+                                                   process.stderr);
 module.exports.Console = Console;
+module.exports.BufferedWriter = BufferedWriter;
+module.exports.BinaryLogger = BinaryLogger;
+
+
+module.exports.enableBuffering = function enableBuffering(options) {
+  if (!(globalConsole._stdout instanceof BufferedWriter))
+    globalConsole._stdout = new BufferedWriter(1, options);
+  return globalConsole._stdout;
+};
+
+
+module.exports.disableBuffering = function disableBuffering() {
+  if (globalConsole._stdout instanceof BufferedWriter) {
+    globalConsole._stdout.end();
+    globalConsole._stdout = process.stdout;
+  }
+};
@@ -9,7 +9,8 @@ internalUtil.assertCrypto(exports);
 exports.DEFAULT_ENCODING = 'buffer';
 
 const binding = process.binding('crypto');
-const randomBytes = binding.randomBytes;
+const uv = process.binding('uv');
+const randomBytesPooled = binding.randomBytesPooled;
 const getCiphers = binding.getCiphers;
 const getHashes = binding.getHashes;
 const getCurves = binding.getCurves;
@@ -24,6 +25,9 @@ const LazyTransform = require('internal/streams/lazy_transform');
 
 const DH_GENERATOR = 2;
 
+// Smaller updateAsync() chunks are not worth a trip to the threadpool.
+const kMinAsyncUpdateSize = 64 * 1024;
+
 // This is here because many functions accepted binary strings without
 // any explicit encoding in older versions of node, and we don't want
 // to break them unnecessarily.
@@ -75,6 +79,50 @@ Hash.prototype.digest = function(outputEncoding) {
 };
 
 
+Hash.prototype.digestStream = function(stream, outputEncoding, callback) {
+  if (typeof outputEncoding === 'function') {
+    callback = outputEncoding;
+    outputEncoding = undefined;
+  }
+  if (typeof callback !== 'function')
+    throw new TypeError('"callback" argument must be a function');
+  outputEncoding = outputEncoding || exports.DEFAULT_ENCODING;
+
+  const handle = this._handle;
+  const streamHandle = stream._handle;
+  const state = stream._readableState;
+
+  // Sockets are read natively, without passing the data through JS.
+  if (streamHandle && streamHandle._externalStream && state && !state.ended) {
+    stream.pause();
+    let chunk;
+    while ((chunk = stream.read()) !== null)
+      handle.update(chunk);
+    streamHandle.readStop();
+
+    handle.oncomplete = function(status) {
+      stream.destroy();
+      if (status !== uv.UV_EOF)
+        return callback(util._errnoException(status, 'read'));
+      callback(null, handle.digest(outputEncoding));
+    };
+    const err = handle.consume(streamHandle._externalStream);
+    if (err)
+      process.nextTick(handle.oncomplete, err);
+    return;
+  }
+
+  stream.on('data', function(chunk) {
+    handle.update(chunk);
+  });
+  stream.once('error', callback);
+  stream.once('end', function() {
+    stream.removeListener('error', callback);
+    callback(null, handle.digest(outputEncoding));
+  });
+};
+
+
 exports.createHmac = exports.Hmac = Hmac;
 
 function Hmac(hmac, key, options) {
@@ -89,6 +137,7 @@ util.inherits(Hmac, LazyTransform);
 
 Hmac.prototype.update = Hash.prototype.update;
 Hmac.prototype.digest = Hash.prototype.digest;
+Hmac.prototype.digestStream = Hash.prototype.digestStream;
 Hmac.prototype._flush = Hash.prototype._flush;
 Hmac.prototype._transform = Hash.prototype._transform;
 
@@ -131,6 +180,8 @@ Cipher.prototype._flush = function(callback) {
 };
 
 Cipher.prototype.update = function(data, inputEncoding, outputEncoding) {
+  if (this._updateQueue && this._updateQueue.length > 0)
+    throw new Error('Asynchronous update in progress');
   inputEncoding = inputEncoding || exports.DEFAULT_ENCODING;
   outputEncoding = outputEncoding || exports.DEFAULT_ENCODING;
 
@@ -145,7 +196,57 @@ Cipher.prototype.update = function(data, inputEncoding, outputEncoding) {
 };
 
 
+Cipher.prototype.updateAsync = function(data, inputEncoding, callback) {
+  if (typeof inputEncoding === 'function') {
+    callback = inputEncoding;
+    inputEncoding = undefined;
+  }
+  if (typeof callback !== 'function')
+    throw new TypeError('"callback" argument must be a function');
+  if (typeof data !== 'string' && !(data instanceof Buffer))
+    throw new TypeError('Cipher data must be a string or a buffer');
+
+  inputEncoding = inputEncoding || exports.DEFAULT_ENCODING;
+  data = toBuf(data, inputEncoding);
+
+  // Updates run one at a time, in the order in which they were made.
+  if (!this._updateQueue)
+    this._updateQueue = [];
+  this._updateQueue.push(data, callback);
+  if (this._updateQueue.length === 2)
+    runUpdate(this);
+};
+
+
+function runUpdate(cipher) {
+  const queue = cipher._updateQueue;
+  const data = queue[0];
+  const callback = queue[1];
+
+  function done(err, ret) {
+    queue.shift();
+    queue.shift();
+    if (queue.length > 0)
+      runUpdate(cipher);
+    callback(err, ret);
+  }
+
+  if (data.length >= kMinAsyncUpdateSize)
+    return cipher._handle.updateAsync(data, done);
+
+  var ret;
+  try {
+    ret = cipher._handle.update(data);
+  } catch (err) {
+    return process.nextTick(done, err);
+  }
+  process.nextTick(done, null, ret);
+}
+
+
 Cipher.prototype.final = function(outputEncoding) {
+  if (this._updateQueue && this._updateQueue.length > 0)
+    throw new Error('Asynchronous update in progress');
   outputEncoding = outputEncoding || exports.DEFAULT_ENCODING;
   var ret = this._handle.final();
 
@@ -192,6 +293,7 @@ util.inherits(Cipheriv, LazyTransform);
 Cipheriv.prototype._transform = Cipher.prototype._transform;
 Cipheriv.prototype._flush = Cipher.prototype._flush;
 Cipheriv.prototype.update = Cipher.prototype.update;
+Cipheriv.prototype.updateAsync = Cipher.prototype.updateAsync;
 Cipheriv.prototype.final = Cipher.prototype.final;
 Cipheriv.prototype.setAutoPadding = Cipher.prototype.setAutoPadding;
 Cipheriv.prototype.getAuthTag = Cipher.prototype.getAuthTag;
@@ -215,6 +317,7 @@ util.inherits(Decipher, LazyTransform);
 Decipher.prototype._transform = Cipher.prototype._transform;
 Decipher.prototype._flush = Cipher.prototype._flush;
 Decipher.prototype.update = Cipher.prototype.update;
+Decipher.prototype.updateAsync = Cipher.prototype.updateAsync;
 Decipher.prototype.final = Cipher.prototype.final;
 Decipher.prototype.finaltol = Cipher.prototype.final;
 Decipher.prototype.setAutoPadding = Cipher.prototype.setAutoPadding;
@@ -240,6 +343,7 @@ util.inherits(Decipheriv, LazyTransform);
 Decipheriv.prototype._transform = Cipher.prototype._transform;
 Decipheriv.prototype._flush = Cipher.prototype._flush;
 Decipheriv.prototype.update = Cipher.prototype.update;
+Decipheriv.prototype.updateAsync = Cipher.prototype.updateAsync;
 Decipheriv.prototype.final = Cipher.prototype.final;
 Decipheriv.prototype.finaltol = Cipher.prototype.final;
 Decipheriv.prototype.setAutoPadding = Cipher.prototype.setAutoPadding;
@@ -248,6 +352,41 @@ Decipheriv.prototype.setAuthTag = Cipher.prototype.setAuthTag;
 Decipheriv.prototype.setAAD = Cipher.prototype.setAAD;
 
 
+exports.createPublicKey = function(key) {
+  return new KeyObject('public', key, null);
+};
+
+exports.createPrivateKey = function(options) {
+  if (!options)
+    throw new Error('No key provided');
+
+  var key = options.key || options;
+  var passphrase = options.passphrase || null;
+  return new KeyObject('private', key, passphrase);
+};
+
+function KeyObject(type, key, passphrase) {
+  if (typeof key !== 'string' && !(key instanceof Buffer))
+    throw new TypeError('Key must be a string or a buffer');
+
+  this._handle = new binding.KeyObject(type === 'private',
+                                       toBuf(key),
+                                       passphrase);
+  this.type = type;
+}
+exports.KeyObject = KeyObject;
+
+// Keys are passed to the binding as KeyObject handles or PEM buffers.
+function toKey(key, type) {
+  if (key instanceof KeyObject) {
+    if (type === 'private' && key.type !== 'private')
+      throw new TypeError('A private key is required');
+    return key._handle;
+  }
+  return toBuf(key);
+}
+
+
 exports.createSign = exports.Sign = Sign;
 function Sign(algorithm, options) {
   if (!(this instanceof Sign))
@@ -273,7 +412,7 @@ Sign.prototype.sign = function(options, encoding) {
 
   var key = options.key || options;
   var passphrase = options.passphrase || null;
-  var ret = this._handle.sign(toBuf(key), null, passphrase);
+  var ret = this._handle.sign(toKey(key, 'private'), null, passphrase);
 
   encoding = encoding || exports.DEFAULT_ENCODING;
   if (encoding && encoding !== 'buffer')
@@ -301,7 +440,29 @@ Verify.prototype.update = Sign.prototype.update;
 
 Verify.prototype.verify = function(object, signature, sigEncoding) {
   sigEncoding = sigEncoding || exports.DEFAULT_ENCODING;
-  return this._handle.verify(toBuf(object), toBuf(signature, sigEncoding));
+  return this._handle.verify(toKey(object),
+                             toBuf(signature, sigEncoding));
+};
+
+
+exports.verifyBatch = function(algorithm, object, items, callback) {
+  if (typeof algorithm !== 'string')
+    throw new TypeError('"algorithm" argument must be a string');
+  if (!Array.isArray(items))
+    throw new TypeError('"items" argument must be an array');
+  if (callback !== undefined && typeof callback !== 'function')
+    throw new TypeError('"callback" argument must be a function');
+
+  const flat = new Array(items.length * 2);
+  for (var i = 0; i < items.length; i++) {
+    const item = items[i];
+    if (!Array.isArray(item) || item.length !== 2)
+      throw new TypeError('Items must be [data, signature] pairs');
+    flat[2 * i] = toBuf(item[0]);
+    flat[2 * i + 1] = toBuf(item[1]);
+  }
+
+  return binding.verifyBatch(algorithm, toKey(object), flat, callback);
 };
 
 function rsaPublic(method, defaultPadding) {
@@ -309,7 +470,7 @@ function rsaPublic(method, defaultPadding) {
     var key = options.key || options;
     var padding = options.padding || defaultPadding;
     var passphrase = options.passphrase || null;
-    return method(toBuf(key), buffer, padding, passphrase);
+    return method(toKey(key), buffer, padding, passphrase);
   };
 }
 
@@ -318,7 +479,7 @@ function rsaPrivate(method, defaultPadding) {
     var key = options.key || options;
     var passphrase = options.passphrase || null;
     var padding = options.padding || defaultPadding;
-    return method(toBuf(key), buffer, padding, passphrase);
+    return method(toKey(key, 'private'), buffer, padding, passphrase);
   };
 }
 
@@ -401,6 +562,29 @@ function dhGenerateKeys(encoding) {
 }
 
 
+DiffieHellmanGroup.prototype.generateKeysAsync =
+    DiffieHellman.prototype.generateKeysAsync =
+    dhGenerateKeysAsync;
+
+function dhGenerateKeysAsync(encoding, callback) {
+  if (typeof encoding === 'function') {
+    callback = encoding;
+    encoding = undefined;
+  }
+  if (typeof callback !== 'function')
+    throw new TypeError('"callback" argument must be a function');
+
+  encoding = encoding || exports.DEFAULT_ENCODING;
+  this._handle.generateKeysAsync(function(err, keys) {
+    if (err)
+      return callback(err);
+    if (encoding && encoding !== 'buffer')
+      keys = keys.toString(encoding);
+    callback(null, keys);
+  });
+}
+
+
 DiffieHellmanGroup.prototype.computeSecret =
     DiffieHellman.prototype.computeSecret =
     dhComputeSecret;
@@ -415,6 +599,33 @@ function dhComputeSecret(key, inEnc, outEnc) {
 }
 
 
+DiffieHellmanGroup.prototype.computeSecretAsync =
+    DiffieHellman.prototype.computeSecretAsync =
+    dhComputeSecretAsync;
+
+function dhComputeSecretAsync(key, inEnc, outEnc, callback) {
+  if (typeof inEnc === 'function') {
+    callback = inEnc;
+    inEnc = undefined;
+  } else if (typeof outEnc === 'function') {
+    callback = outEnc;
+    outEnc = undefined;
+  }
+  if (typeof callback !== 'function')
+    throw new TypeError('"callback" argument must be a function');
+
+  inEnc = inEnc || exports.DEFAULT_ENCODING;
+  outEnc = outEnc || exports.DEFAULT_ENCODING;
+  this._handle.computeSecretAsync(toBuf(key, inEnc), function(err, secret) {
+    if (err)
+      return callback(err);
+    if (outEnc && outEnc !== 'buffer')
+      secret = secret.toString(outEnc);
+    callback(null, secret);
+  });
+}
+
+
 DiffieHellmanGroup.prototype.getPrime =
     DiffieHellman.prototype.getPrime =
     dhGetPrime;
@@ -493,6 +704,7 @@ exports.createECDH = function createECDH(curve) {
 };
 
 ECDH.prototype.computeSecret = DiffieHellman.prototype.computeSecret;
+ECDH.prototype.computeSecretAsync = DiffieHellman.prototype.computeSecretAsync;
 ECDH.prototype.setPrivateKey = DiffieHellman.prototype.setPrivateKey;
 ECDH.prototype.setPublicKey = DiffieHellman.prototype.setPublicKey;
 ECDH.prototype.getPrivateKey = DiffieHellman.prototype.getPrivateKey;
@@ -503,6 +715,33 @@ ECDH.prototype.generateKeys = function generateKeys(encoding, format) {
   return this.getPublicKey(encoding, format);
 };
 
+ECDH.prototype.generateKeysAsync = function generateKeysAsync(encoding,
+                                                              format,
+                                                              callback) {
+  if (typeof encoding === 'function') {
+    callback = encoding;
+    encoding = undefined;
+  } else if (typeof format === 'function') {
+    callback = format;
+    format = undefined;
+  }
+  if (typeof callback !== 'function')
+    throw new TypeError('"callback" argument must be a function');
+
+  const self = this;
+  this._handle.generateKeysAsync(function(err) {
+    if (err)
+      return callback(err);
+    var key;
+    try {
+      key = self.getPublicKey(encoding, format);
+    } catch (e) {
+      return callback(e);
+    }
+    callback(null, key);
+  });
+};
+
 ECDH.prototype.getPublicKey = function getPublicKey(encoding, format) {
   var f;
   if (format) {
@@ -584,6 +823,35 @@ function pbkdf2(password, salt, iterations, keylen, digest, callback) {
 }
 
 
+exports.pbkdf2Batch = function(items, iterations, keylen, digest, callback) {
+  if (!Array.isArray(items))
+    throw new TypeError('"items" argument must be an array');
+  if (typeof digest !== 'string')
+    throw new TypeError('"digest" argument must be a string');
+  if (callback !== undefined && typeof callback !== 'function')
+    throw new TypeError('"callback" argument must be a function');
+
+  const flat = new Array(items.length * 2);
+  for (var i = 0; i < items.length; i++) {
+    const item = items[i];
+    if (!Array.isArray(item) || item.length !== 2)
+      throw new TypeError('Items must be [password, salt] pairs');
+    flat[2 * i] = toBuf(item[0]);
+    flat[2 * i + 1] = toBuf(item[1]);
+  }
+
+  const encoding = exports.DEFAULT_ENCODING;
+  if (encoding === 'buffer')
+    return binding.pbkdf2Batch(flat, iterations, keylen, digest, callback);
+
+  const toStrings = (keys) => keys.map((key) => key.toString(encoding));
+  if (callback) {
+    const next = (err, keys) => callback(err, keys && toStrings(keys));
+    return binding.pbkdf2Batch(flat, iterations, keylen, digest, next);
+  }
+  return toStrings(binding.pbkdf2Batch(flat, iterations, keylen, digest));
+};
+
 exports.Certificate = Certificate;
 
 function Certificate() {
@@ -622,6 +890,18 @@ exports.setEngine = function setEngine(id, flags) {
   return binding.setEngine(id, flags);
 };
 
+// Small requests are copied from a pool of random bytes that is refilled
+// in the threadpool, rather than waiting for a request of their own.
+function randomBytes(size, callback) {
+  const async = typeof callback === 'function';
+  const buf = randomBytesPooled(size, !async);
+  if (buf === undefined)
+    return binding.randomBytes(size, callback);
+  if (!async)
+    return buf;
+  process.nextTick(callback, null, buf);
+}
+
 exports.randomBytes = exports.pseudoRandomBytes = randomBytes;
 
 exports.rng = exports.prng = randomBytes;
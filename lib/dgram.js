@@ -8,6 +8,7 @@ const constants = require('constants');
 
 const UDP = process.binding('udp_wrap').UDP;
 const SendWrap = process.binding('udp_wrap').SendWrap;
+const isIP = process.binding('cares_wrap').isIP;
 
 const BIND_STATE_UNBOUND = 0;
 const BIND_STATE_BINDING = 1;
@@ -38,18 +39,19 @@ function lookup6(address, callback) {
 }
 
 
-function newHandle(type) {
+function newHandle(type, recvBatch) {
   if (type == 'udp4') {
-    const handle = new UDP();
+    const handle = new UDP(!!recvBatch);
     handle.lookup = lookup4;
     return handle;
   }
 
   if (type == 'udp6') {
-    const handle = new UDP();
+    const handle = new UDP(!!recvBatch);
     handle.lookup = lookup6;
     handle.bind = handle.bind6;
     handle.send = handle.send6;
+    handle.sendBatch = handle.sendBatch6;
     return handle;
   }
 
@@ -86,7 +88,7 @@ function Socket(type, listener) {
     type = options.type;
   }
 
-  var handle = newHandle(type);
+  var handle = newHandle(type, options && options.recvBatch);
   handle.owner = this;
 
   this._handle = handle;
@@ -112,6 +114,7 @@ exports.createSocket = function(type, listener) {
 
 function startListening(socket) {
   socket._handle.onmessage = onMessage;
+  socket._handle.onmessages = onMessages;
   // Todo: handle errors
   socket._handle.recvStart();
   socket._receiving = true;
@@ -127,6 +130,7 @@ function replaceHandle(self, newHandle) {
   newHandle.lookup = self._handle.lookup;
   newHandle.bind = self._handle.bind;
   newHandle.send = self._handle.send;
+  newHandle.sendBatch = self._handle.sendBatch;
   newHandle.owner = self;
 
   // Replace the existing handle by the handle we got from master.
@@ -283,8 +287,10 @@ function enqueue(self, toEnqueue) {
     self._sendQueue = [];
     self.once('listening', function() {
       // Flush the send queue.
-      for (var i = 0; i < this._sendQueue.length; i++)
-        this.send.apply(self, this._sendQueue[i]);
+      for (var i = 0; i < this._sendQueue.length; i++) {
+        const entry = this._sendQueue[i];
+        entry[0].apply(self, entry[1]);
+      }
       this._sendQueue = undefined;
     });
   }
@@ -345,7 +351,7 @@ Socket.prototype.send = function(buffer,
   // If the socket hasn't been bound yet, push the outbound packet onto the
   // send queue and send after binding is complete.
   if (self._bindState != BIND_STATE_BOUND) {
-    enqueue(self, [buffer, port, address, callback]);
+    enqueue(self, [self.send, [buffer, port, address, callback]]);
     return;
   }
 
@@ -355,7 +361,59 @@ Socket.prototype.send = function(buffer,
 };
 
 
-function doSend(ex, self, ip, buffer, address, port, callback) {
+// Sends buffer as datagrams of segmentSize bytes that the kernel splits it
+// up into, with UDP segmentation offload.
+Socket.prototype.sendSegmented = function(buffer,
+                                          segmentSize,
+                                          port,
+                                          address,
+                                          callback) {
+  var self = this;
+
+  if (typeof address === 'function') {
+    callback = address;
+    address = undefined;
+  }
+
+  if (typeof buffer === 'string') {
+    buffer = [ Buffer.from(buffer) ];
+  } else if (buffer instanceof Buffer) {
+    buffer = [ buffer ];
+  } else if (!Array.isArray(buffer) || !fixBuffer(buffer)) {
+    throw new TypeError('First argument must be a buffer, a string or ' +
+                        'an array of them');
+  }
+
+  if (!Number.isInteger(segmentSize) || segmentSize <= 0 ||
+      segmentSize > 65535) {
+    throw new RangeError('"segmentSize" should be > 0 and < 65536');
+  }
+
+  port = port >>> 0;
+  if (port === 0 || port > 65535)
+    throw new RangeError('Port should be > 0 and < 65536');
+
+  if (typeof callback !== 'function')
+    callback = undefined;
+
+  self._healthCheck();
+
+  if (self._bindState == BIND_STATE_UNBOUND)
+    self.bind({port: 0, exclusive: true}, null);
+
+  if (self._bindState != BIND_STATE_BOUND) {
+    enqueue(self, [self.sendSegmented,
+                   [buffer, segmentSize, port, address, callback]]);
+    return;
+  }
+
+  self._handle.lookup(address, function afterDns(ex, ip) {
+    doSend(ex, self, ip, buffer, address, port, callback, segmentSize);
+  });
+};
+
+
+function doSend(ex, self, ip, buffer, address, port, callback, segmentSize) {
   if (ex) {
     if (typeof callback === 'function') {
       callback(ex);
@@ -381,7 +439,8 @@ function doSend(ex, self, ip, buffer, address, port, callback) {
                               buffer.length,
                               port,
                               ip,
-                              !!callback);
+                              !!callback,
+                              segmentSize);
   if (err && callback) {
     // don't emit as error, dgram_legacy.js compatibility
     const ex = exceptionWithHostPort(err, 'send', address, port);
@@ -400,6 +459,86 @@ function afterSend(err, sent) {
 }
 
 
+// sendBatch(list[, callback]), where every entry of list is an object with
+// msg, port and address.  The addresses aren't looked up.
+Socket.prototype.sendBatch = function(list, callback) {
+  if (!Array.isArray(list))
+    throw new TypeError('First argument must be an array');
+
+  const family = this.type === 'udp6' ? 6 : 4;
+  const defaultAddress = family === 6 ? '::1' : '127.0.0.1';
+  const count = list.length;
+  const buffers = new Array(count);
+  const ports = new Array(count);
+  const addresses = new Array(count);
+
+  for (var i = 0; i < count; i++) {
+    const entry = list[i];
+    if (entry === null || typeof entry !== 'object')
+      throw new TypeError('Batch entries must be objects');
+
+    var msg = entry.msg;
+    if (typeof msg === 'string')
+      msg = Buffer.from(msg);
+    else if (!(msg instanceof Buffer))
+      throw new TypeError('"msg" must be a buffer or a string');
+
+    const port = entry.port >>> 0;
+    if (port === 0 || port > 65535)
+      throw new RangeError('Port should be > 0 and < 65536');
+
+    const address = entry.address || defaultAddress;
+    if (isIP(address) !== family)
+      throw new TypeError(`"address" must be an IPv${family} address`);
+
+    buffers[i] = msg;
+    ports[i] = port;
+    addresses[i] = address;
+  }
+
+  if (typeof callback !== 'function')
+    callback = undefined;
+
+  this._healthCheck();
+
+  if (count === 0) {
+    if (callback)
+      process.nextTick(callback, null, 0);
+    return;
+  }
+
+  if (this._bindState == BIND_STATE_UNBOUND)
+    this.bind({port: 0, exclusive: true}, null);
+
+  if (this._bindState != BIND_STATE_BOUND) {
+    enqueue(this, [doSendBatch, [this, buffers, ports, addresses, callback]]);
+    return;
+  }
+
+  doSendBatch(this, buffers, ports, addresses, callback);
+};
+
+
+function doSendBatch(self, buffers, ports, addresses, callback) {
+  if (!self._handle)
+    return;
+
+  var req = new SendWrap();
+  req.buffers = buffers;  // Keep reference alive.
+  if (callback) {
+    req.callback = callback;
+    req.oncomplete = afterSendBatch;
+  }
+  var err = self._handle.sendBatch(req, buffers, ports, addresses, !!callback);
+  if (err && callback)
+    process.nextTick(callback, errnoException(err, 'send'));
+}
+
+function afterSendBatch(err, sent) {
+  this.callback(err ? errnoException(err, 'send') : null, sent);
+}
+
+
 Socket.prototype.close = function(callback) {
   if (typeof callback === 'function')
     this.on('close', callback);
@@ -439,6 +578,26 @@ Socket.prototype.setBroadcast = function(arg) {
 };
 
 
+Socket.prototype.setGRO = function(arg) {
+  var err = this._handle.setGRO(arg ? 1 : 0);
+  if (err) {
+    throw errnoException(err, 'setGRO');
+  }
+};
+
+
+Socket.prototype.setBusyPoll = function(usecs) {
+  if (usecs !== (usecs >>> 0)) {
+    throw new TypeError('Argument must be a non-negative integer');
+  }
+
+  var err = this._handle.setBusyPoll(usecs);
+  if (err) {
+    throw errnoException(err, 'setBusyPoll');
+  }
+};
+
+
 Socket.prototype.setTTL = function(arg) {
   if (typeof arg !== 'number') {
     throw new TypeError('Argument must be a number');
@@ -533,6 +692,20 @@ function onMessage(nread, handle, buf, rinfo) {
 }
 
 
+// All datagrams from one recvmmsg() call, see the recvBatch option.
+function onMessages(handle, buffers, addresses) {
+  var self = handle.owner;
+  for (var i = 0; i < buffers.length; i++) {
+    // A listener may have closed the socket.
+    if (self._handle === null)
+      return;
+    const rinfo = addresses[i];
+    rinfo.size = buffers[i].length; // compatibility
+    self.emit('message', buffers[i], rinfo);
+  }
+}
+
+
 Socket.prototype.ref = function() {
   if (this._handle)
     this._handle.ref();
@@ -13,6 +13,9 @@ const QueryReqWrap = cares.QueryReqWrap;
 const isIP = cares.isIP;
 const isLegalPort = internalNet.isLegalPort;
 
+var lookupCacheEnabled = false;
+var defaultLookupResolver = 'getaddrinfo';
+
 
 function errnoException(err, syscall, hostname) {
   // FIXME(bnoordhuis) Remove this backwards compatibility nonsense and pass
@@ -103,12 +106,68 @@ function onlookupall(err, addresses) {
 }
 
 
+function validateLookupResolver(resolver) {
+  if (resolver !== 'getaddrinfo' && resolver !== 'cares') {
+    throw new TypeError('Invalid argument: ' +
+                        'resolver must be "getaddrinfo" or "cares"');
+  }
+}
+
+
+// Queries the A records first, then the AAAA records when they are wanted
+// too.  The addresses are reported in the same order as getaddrinfo's.
+function onlookupcares(err, addresses) {
+  const lookup = this.lookup;
+
+  if (err) {
+    if (lookup.error === null)
+      lookup.error = err;
+  } else {
+    for (var i = 0; i < addresses.length; i++) {
+      lookup.addresses.push({
+        address: addresses[i],
+        family: this.queryFamily
+      });
+    }
+  }
+
+  if (this.queryFamily === 4 && lookup.family === 0 &&
+      (lookup.all || lookup.addresses.length === 0)) {
+    queryCares(lookup, 6);
+    return;
+  }
+
+  if (lookup.addresses.length === 0) {
+    return lookup.callback(errnoException(lookup.error,
+                                          'getHostByName',
+                                          lookup.hostname));
+  }
+
+  if (lookup.all) {
+    lookup.callback(null, lookup.addresses);
+  } else {
+    const first = lookup.addresses[0];
+    lookup.callback(null, first.address, first.family);
+  }
+}
+
+
+function queryCares(lookup, family) {
+  var req = new QueryReqWrap();
+  req.lookup = lookup;
+  req.queryFamily = family;
+  req.oncomplete = onlookupcares;
+  return cares.getHostByName(req, lookup.hostname, family);
+}
+
+
 // Easy DNS A/AAAA look up
 // lookup(hostname, [options,] callback)
 exports.lookup = function lookup(hostname, options, callback) {
   var hints = 0;
   var family = -1;
   var all = false;
+  var resolver = defaultLookupResolver;
 
   // Parse arguments
   if (hostname && typeof hostname !== 'string') {
@@ -123,6 +182,10 @@ exports.lookup = function lookup(hostname, options, callback) {
     hints = options.hints >>> 0;
     family = options.family >>> 0;
     all = options.all === true;
+    if (options.resolver !== undefined) {
+      resolver = options.resolver;
+      validateLookupResolver(resolver);
+    }
 
     if (hints !== 0 &&
         hints !== exports.ADDRCONFIG &&
@@ -158,11 +221,40 @@ exports.lookup = function lookup(hostname, options, callback) {
     return {};
   }
 
+  if (resolver === 'cares') {
+    const lookup = {
+      callback,
+      hostname,
+      family,
+      all,
+      addresses: [],
+      error: null
+    };
+    const err = queryCares(lookup, family === 6 ? 6 : 4);
+    if (err) {
+      callback(errnoException(err, 'getHostByName', hostname));
+      return {};
+    }
+    callback.immediately = true;
+    return lookup;
+  }
+
+  const oncomplete = all ? onlookupall : onlookup;
+
+  if (lookupCacheEnabled) {
+    const addresses = cares.getCachedAddrInfo(hostname, family, hints);
+    if (addresses !== undefined) {
+      // The callback is not called synchronously, see makeAsync().
+      oncomplete.call({ callback, family, hostname }, 0, addresses);
+      return {};
+    }
+  }
+
   var req = new GetAddrInfoReqWrap();
   req.callback = callback;
   req.family = family;
   req.hostname = hostname;
-  req.oncomplete = all ? onlookupall : onlookup;
+  req.oncomplete = oncomplete;
 
   var err = cares.getaddrinfo(req, hostname, family, hints);
   if (err) {
@@ -219,10 +311,18 @@ function onresolve(err, result) {
 }
 
 
-function resolver(bindingName) {
+// The queries that can be |packable| take an optional options object before
+// the callback, with `packed: true` they answer in typed arrays.
+function resolver(bindingName, packable) {
   var binding = cares[bindingName];
 
-  return function query(name, callback) {
+  return function query(name, options, callback) {
+    var packed = false;
+    if (packable && options !== null && typeof options === 'object')
+      packed = options.packed === true;
+    else
+      callback = options;
+
     if (typeof name !== 'string') {
       throw new Error('"name" argument must be a string');
     } else if (typeof callback !== 'function') {
@@ -235,7 +335,7 @@ function resolver(bindingName) {
     req.callback = callback;
     req.hostname = name;
     req.oncomplete = onresolve;
-    var err = binding(req, name);
+    var err = binding(req, name, packed);
     if (err) throw errnoException(err, bindingName);
     callback.immediately = true;
     return req;
@@ -244,13 +344,13 @@ function resolver(bindingName) {
 
 
 var resolveMap = Object.create(null);
-exports.resolve4 = resolveMap.A = resolver('queryA');
-exports.resolve6 = resolveMap.AAAA = resolver('queryAaaa');
+exports.resolve4 = resolveMap.A = resolver('queryA', true);
+exports.resolve6 = resolveMap.AAAA = resolver('queryAaaa', true);
 exports.resolveCname = resolveMap.CNAME = resolver('queryCname');
 exports.resolveMx = resolveMap.MX = resolver('queryMx');
 exports.resolveNs = resolveMap.NS = resolver('queryNs');
 exports.resolveTxt = resolveMap.TXT = resolver('queryTxt');
-exports.resolveSrv = resolveMap.SRV = resolver('querySrv');
+exports.resolveSrv = resolveMap.SRV = resolver('querySrv', true);
 exports.resolvePtr = resolveMap.PTR = resolver('queryPtr');
 exports.resolveNaptr = resolveMap.NAPTR = resolver('queryNaptr');
 exports.resolveSoa = resolveMap.SOA = resolver('querySoa');
@@ -320,6 +420,85 @@ exports.setServers = function(servers) {
   }
 };
 
+function resolverOption(options, name, min, max) {
+  const value = options[name];
+  if (value === undefined)
+    return -1;
+  if (!Number.isInteger(value) || value < min || value > max)
+    throw new TypeError(`"${name}" must be an integer from ${min} to ${max}`);
+  return value;
+}
+
+exports.setResolverOptions = function(options) {
+  if (options === null || typeof options !== 'object')
+    throw new TypeError('"options" argument must be an object');
+
+  const timeout = resolverOption(options, 'timeout', 1, 0x7fffffff);
+  const tries = resolverOption(options, 'tries', 1, 255);
+  const ednsBufferSize = resolverOption(options, 'ednsBufferSize', 512, 65535);
+  var channels = resolverOption(options, 'channels', 1, 16);
+  if (channels === -1)
+    channels = 1;
+
+  const applied = cares.setResolverOptions(timeout,
+                                           tries,
+                                           options.rotate === true,
+                                           options.stayOpen === true,
+                                           ednsBufferSize,
+                                           channels);
+  if (!applied)
+    throw new Error('Resolver options cannot be set while queries are pending');
+};
+
+exports.setDefaultLookupResolver = function(resolver) {
+  validateLookupResolver(resolver);
+  defaultLookupResolver = resolver;
+};
+
+
+exports.enableLookupCache = function(options) {
+  var ttl = 1000;
+  var maxEntries = 1000;
+
+  if (options !== undefined) {
+    if (options === null || typeof options !== 'object')
+      throw new TypeError('"options" argument must be an object');
+    if (options.ttl !== undefined) {
+      ttl = options.ttl;
+      if (typeof ttl !== 'number' || !(ttl >= 0) || !isFinite(ttl))
+        throw new TypeError('"ttl" must be a non-negative number');
+    }
+    if (options.maxEntries !== undefined) {
+      maxEntries = options.maxEntries;
+      if (!Number.isInteger(maxEntries) || maxEntries < 1 ||
+          maxEntries > 0xffffffff) {
+        throw new TypeError('"maxEntries" must be a positive integer');
+      }
+    }
+  }
+
+  cares.enableLookupCache(ttl, maxEntries);
+  lookupCacheEnabled = true;
+};
+
+
+exports.disableLookupCache = function() {
+  cares.disableLookupCache();
+  lookupCacheEnabled = false;
+};
+
+
+exports.getLookupCacheStats = function() {
+  const stats = [];
+  cares.getLookupCacheStats(stats);
+  return {
+    hits: stats[0],
+    misses: stats[1],
+    coalesced: stats[2],
+    size: stats[3]
+  };
+};
+
 // uv_getaddrinfo flags
 exports.ADDRCONFIG = cares.AI_ADDRCONFIG;
 exports.V4MAPPED = cares.AI_V4MAPPED;
@@ -1,5 +1,6 @@
 'use strict';
 
+const internalEvents = require('internal/events');
 var domain;
 
 // This constructor is used to store event handlers. Instantiating this is
@@ -81,14 +82,17 @@ EventEmitter.prototype.getMaxListeners = function getMaxListeners() {
 // arguments and can be deoptimized because of that. These functions always have
 // the same number of arguments and thus do not get deoptimized, so the code
 // inside them can execute faster.
+//
+// Arrays of listeners are never modified once they are in _events, adding or
+// removing a listener replaces the array. A listener that is added or removed
+// during an emit() therefore doesn't change who is called, without cloning.
 function emitNone(handler, isFn, self) {
   if (isFn)
     handler.call(self);
   else {
     var len = handler.length;
-    var listeners = arrayClone(handler, len);
     for (var i = 0; i < len; ++i)
-      listeners[i].call(self);
+      handler[i].call(self);
   }
 }
 function emitOne(handler, isFn, self, arg1) {
@@ -96,9 +100,8 @@ function emitOne(handler, isFn, self, arg1) {
     handler.call(self, arg1);
   else {
     var len = handler.length;
-    var listeners = arrayClone(handler, len);
     for (var i = 0; i < len; ++i)
-      listeners[i].call(self, arg1);
+      handler[i].call(self, arg1);
   }
 }
 function emitTwo(handler, isFn, self, arg1, arg2) {
@@ -106,9 +109,8 @@ function emitTwo(handler, isFn, self, arg1, arg2) {
     handler.call(self, arg1, arg2);
   else {
     var len = handler.length;
-    var listeners = arrayClone(handler, len);
     for (var i = 0; i < len; ++i)
-      listeners[i].call(self, arg1, arg2);
+      handler[i].call(self, arg1, arg2);
   }
 }
 function emitThree(handler, isFn, self, arg1, arg2, arg3) {
@@ -116,9 +118,8 @@ function emitThree(handler, isFn, self, arg1, arg2, arg3) {
     handler.call(self, arg1, arg2, arg3);
   else {
     var len = handler.length;
-    var listeners = arrayClone(handler, len);
     for (var i = 0; i < len; ++i)
-      listeners[i].call(self, arg1, arg2, arg3);
+      handler[i].call(self, arg1, arg2, arg3);
   }
 }
 
@@ -127,9 +128,8 @@ function emitMany(handler, isFn, self, args) {
     handler.apply(self, args);
   else {
     var len = handler.length;
-    var listeners = arrayClone(handler, len);
     for (var i = 0; i < len; ++i)
-      listeners[i].apply(self, args);
+      handler[i].apply(self, args);
   }
 }
 
@@ -207,6 +207,8 @@ EventEmitter.prototype.emit = function emit(type) {
   return true;
 };
 
+internalEvents.setDefaultEmit(EventEmitter.prototype.emit);
+
 function _addListener(target, type, listener, prepend) {
   var m;
   var events;
@@ -243,12 +245,8 @@ function _addListener(target, type, listener, prepend) {
       existing = events[type] = prepend ? [listener, existing] :
                                           [existing, listener];
     } else {
-      // If we've already got an array, just append.
-      if (prepend) {
-        existing.unshift(listener);
-      } else {
-        existing.push(listener);
-      }
+      // If we've already got an array, replace it with a longer one.
+      existing = events[type] = arrayAdd(existing, listener, prepend);
     }
 
     // Check for listener leak
@@ -345,7 +343,6 @@ EventEmitter.prototype.removeListener =
           return this;
 
         if (list.length === 1) {
-          list[0] = undefined;
           if (--this._eventsCount === 0) {
             this._events = new EventHandlers();
             return this;
@@ -353,7 +350,7 @@ EventEmitter.prototype.removeListener =
             delete events[type];
           }
         } else {
-          spliceOne(list, position);
+          events[type] = arrayRemove(list, position);
         }
 
         if (events.removeListener)
@@ -405,9 +402,8 @@ EventEmitter.prototype.removeAllListeners =
         this.removeListener(type, listeners);
       } else if (listeners) {
         // LIFO order
-        do {
-          this.removeListener(type, listeners[listeners.length - 1]);
-        } while (listeners[0]);
+        for (var j = listeners.length - 1; j >= 0; j--)
+          this.removeListener(type, listeners[j]);
       }
 
       return this;
@@ -462,11 +458,30 @@ EventEmitter.prototype.eventNames = function eventNames() {
   return this._eventsCount > 0 ? Reflect.ownKeys(this._events) : [];
 };
 
-// About 1.5x faster than the two-arg version of Array#splice().
-function spliceOne(list, index) {
-  for (var i = index, k = i + 1, n = list.length; k < n; i += 1, k += 1)
-    list[i] = list[k];
-  list.pop();
+// A copy of `list` with `listener` at the front or at the end.
+function arrayAdd(list, listener, prepend) {
+  const n = list.length;
+  const copy = new Array(n + 1);
+  const offset = prepend ? 1 : 0;
+  for (var i = 0; i < n; ++i)
+    copy[i + offset] = list[i];
+  copy[prepend ? 0 : n] = listener;
+  if (list.warned)
+    copy.warned = true;
+  return copy;
+}
+
+// A copy of `list` without the listener at `index`.
+function arrayRemove(list, index) {
+  const n = list.length - 1;
+  const copy = new Array(n);
+  for (var i = 0; i < index; ++i)
+    copy[i] = list[i];
+  for (; i < n; ++i)
+    copy[i] = list[i + 1];
+  if (list.warned)
+    copy.warned = true;
+  return copy;
 }
 
 function arrayClone(arr, i) {
@@ -10,13 +10,16 @@ const binding = process.binding('fs');
 const constants = require('constants');
 const fs = exports;
 const Buffer = require('buffer').Buffer;
-const Stream = require('stream').Stream;
+const ChunkList = require('buffer').ChunkList;
 const EventEmitter = require('events');
 const FSReqWrap = binding.FSReqWrap;
 const FSEvent = process.binding('fs_event_wrap').FSEvent;
 
-const Readable = Stream.Readable;
-const Writable = Stream.Writable;
+// The stream module is loaded when the first stream is created.  See
+// lazyStreams() below.
+var Stream;
+var Readable;
+var Writable;
 
 const kMinPoolSpace = 128;
 const kMaxLength = require('buffer').kMaxLength;
@@ -118,6 +121,27 @@ function makeCallback(cb) {
   };
 }
 
+// Requests on file descriptors without a callback don't need a request
+// object, the binding recycles them as soon as they complete and reports only
+// their errors, through the function set below.  In debug mode they keep
+// their object so that rethrow() can report where they were made.
+function makeReq(callback) {
+  if (callback === undefined && !DEBUG)
+    return true;
+  var req = new FSReqWrap();
+  req.oncomplete = makeCallback(callback);
+  return req;
+}
+
+function throwError(err) {
+  throw err;
+}
+
+binding.setDetachedErrorsCallback(function(errors) {
+  for (var i = 0; i < errors.length; i++)
+    process.nextTick(throwError, errors[i]);
+});
+
 function assertEncoding(encoding) {
   if (encoding && !Buffer.isEncoding(encoding)) {
     throw new Error('Unknown encoding: ' + encoding);
@@ -207,6 +231,43 @@ fs.Stats.prototype.isSocket = function() {
   return this._checkModeProperty(constants.S_IFSOCK);
 };
 
+const kType = Symbol('type');
+
+// A directory entry and its type, as reported by the directory listing.
+function Dirent(name, type) {
+  this.name = name;
+  this[kType] = type;
+}
+fs.Dirent = Dirent;
+
+Dirent.prototype.isDirectory = function() {
+  return this[kType] === binding.UV_DIRENT_DIR;
+};
+
+Dirent.prototype.isFile = function() {
+  return this[kType] === binding.UV_DIRENT_FILE;
+};
+
+Dirent.prototype.isBlockDevice = function() {
+  return this[kType] === binding.UV_DIRENT_BLOCK;
+};
+
+Dirent.prototype.isCharacterDevice = function() {
+  return this[kType] === binding.UV_DIRENT_CHAR;
+};
+
+Dirent.prototype.isSymbolicLink = function() {
+  return this[kType] === binding.UV_DIRENT_LINK;
+};
+
+Dirent.prototype.isFIFO = function() {
+  return this[kType] === binding.UV_DIRENT_FIFO;
+};
+
+Dirent.prototype.isSocket = function() {
+  return this[kType] === binding.UV_DIRENT_SOCKET;
+};
+
 // Don't allow mode to accidentally be overwritten.
 ['F_OK', 'R_OK', 'W_OK', 'X_OK'].forEach(function(key) {
   Object.defineProperty(fs, key, {
@@ -281,27 +342,43 @@ fs.readFile = function(path, options, callback_) {
   if (!nullCheck(path, callback))
     return;
 
-  var context = new ReadFileContext(callback, encoding);
-  context.isUserFd = isFd(path); // file descriptor ownership
   var req = new FSReqWrap();
-  req.context = context;
-  req.oncomplete = readFileAfterOpen;
 
-  if (context.isUserFd) {
+  if (isFd(path)) {
+    // The file descriptor is the caller's, and so is its position.
+    var context = new ReadFileContext(callback, encoding);
+    context.isUserFd = true;
+    req.context = context;
+    req.oncomplete = readFileAfterOpen;
     process.nextTick(function() {
       req.oncomplete(null, path);
     });
     return;
   }
 
-  binding.open(pathModule._makeLong(path),
-               stringToFlags(flag),
-               0o666,
-               req);
+  // Opens, reads and closes the file in a single threadpool request, which
+  // also decodes large files if it can.
+  req.oncomplete = function(err, data) {
+    if (data === undefined)
+      return callback(err);
+    if (err)
+      return callback(err, data);
+    if (encoding && typeof data !== 'string')
+      return tryToString(data, encoding, callback);
+    callback(null, data);
+  };
+  binding.readFile(pathModule._makeLong(path),
+                   stringToFlags(flag),
+                   encoding,
+                   req);
 };
 
 const kReadFileBufferLength = 8 * 1024;
 
+// Strings of at least this many characters are converted to bytes on the
+// threadpool by fs.writeFile().
+const kOffThreadStringLength = 1024 * 1024;
+
 function ReadFileContext(callback, encoding) {
   this.fd = undefined;
   this.isUserFd = undefined;
@@ -594,9 +671,7 @@ Object.defineProperty(exports, '_stringToFlags', {
 // list to make the arguments clear.
 
 fs.close = function(fd, callback) {
-  var req = new FSReqWrap();
-  req.oncomplete = makeCallback(callback);
-  binding.close(fd, req);
+  binding.close(fd, makeReq(callback));
 };
 
 fs.closeSync = function(fd) {
@@ -769,6 +844,40 @@ fs.write = function(fd, buffer, offset, length, position, callback) {
   return binding.writeString(fd, buffer, offset, length, req);
 };
 
+function writevChunks(buffers) {
+  if (buffers instanceof ChunkList)
+    buffers = buffers.chunks;
+  else if (!Array.isArray(buffers))
+    throw new TypeError('"buffers" argument must be an Array or ChunkList');
+  // uv_fs_write() rejects an empty list of buffers.
+  return buffers.length === 0 ? [Buffer.alloc(0)] : buffers;
+}
+
+// usage:
+//  fs.writev(fd, buffers[, position], callback);
+fs.writev = function(fd, buffers, position, callback) {
+  if (typeof position === 'function') {
+    callback = position;
+    position = null;
+  }
+  callback = maybeCallback(callback);
+
+  var req = new FSReqWrap();
+  req.oncomplete = function(err, written) {
+    // Retain a reference to buffers so that they can't be GC'ed too soon.
+    callback(err, written || 0, buffers);
+  };
+  binding.writeBuffers(fd, writevChunks(buffers), position, req);
+};
+
+// usage:
+//  fs.writevSync(fd, buffers[, position]);
+fs.writevSync = function(fd, buffers, position) {
+  if (position === undefined)
+    position = null;
+  return binding.writeBuffers(fd, writevChunks(buffers), position);
+};
+
 // usage:
 //  fs.writeSync(fd, buffer, offset, length[, position]);
 // OR
@@ -855,9 +964,7 @@ fs.ftruncate = function(fd, len, callback) {
   } else if (len === undefined) {
     len = 0;
   }
-  var req = new FSReqWrap();
-  req.oncomplete = makeCallback(callback);
-  binding.ftruncate(fd, len, req);
+  binding.ftruncate(fd, len, makeReq(callback));
 };
 
 fs.ftruncateSync = function(fd, len) {
@@ -881,9 +988,7 @@ fs.rmdirSync = function(path) {
 };
 
 fs.fdatasync = function(fd, callback) {
-  var req = new FSReqWrap();
-  req.oncomplete = makeCallback(callback);
-  binding.fdatasync(fd, req);
+  binding.fdatasync(fd, makeReq(callback));
 };
 
 fs.fdatasyncSync = function(fd) {
@@ -891,9 +996,7 @@ fs.fdatasyncSync = function(fd) {
 };
 
 fs.fsync = function(fd, callback) {
-  var req = new FSReqWrap();
-  req.oncomplete = makeCallback(callback);
-  binding.fsync(fd, req);
+  binding.fsync(fd, makeReq(callback));
 };
 
 fs.fsyncSync = function(fd) {
@@ -931,8 +1034,16 @@ fs.readdir = function(path, options, callback) {
   callback = makeCallback(callback);
   if (!nullCheck(path, callback)) return;
   var req = new FSReqWrap();
-  req.oncomplete = callback;
-  binding.readdir(pathModule._makeLong(path), options.encoding, req);
+  if (options.withFileTypes) {
+    req.oncomplete = function(err, names, types) {
+      if (err) return callback(err);
+      getDirents(path, names, types, callback);
+    };
+  } else {
+    req.oncomplete = callback;
+  }
+  binding.readdir(pathModule._makeLong(path), options.encoding, req,
+                  !!options.withFileTypes);
 };
 
 fs.readdirSync = function(path, options) {
@@ -942,8 +1053,70 @@ fs.readdirSync = function(path, options) {
   if (typeof options !== 'object')
     throw new TypeError('"options" must be a string or an object');
   nullCheck(path);
-  return binding.readdir(pathModule._makeLong(path), options.encoding);
-};
+  if (!options.withFileTypes)
+    return binding.readdir(pathModule._makeLong(path), options.encoding);
+
+  const result = binding.readdir(pathModule._makeLong(path),
+                                 options.encoding, undefined, true);
+  const names = result[0];
+  const types = result[1];
+  for (var i = 0; i < names.length; i++) {
+    if (types[i] === binding.UV_DIRENT_UNKNOWN)
+      types[i] = direntType(fs.lstatSync(direntPath(path, names[i])));
+  }
+  return toDirents(names, types);
+};
+
+// Some file systems don't report entry types, those entries need an lstat.
+function direntType(stats) {
+  if (stats.isFile()) return binding.UV_DIRENT_FILE;
+  if (stats.isDirectory()) return binding.UV_DIRENT_DIR;
+  if (stats.isSymbolicLink()) return binding.UV_DIRENT_LINK;
+  if (stats.isFIFO()) return binding.UV_DIRENT_FIFO;
+  if (stats.isSocket()) return binding.UV_DIRENT_SOCKET;
+  if (stats.isCharacterDevice()) return binding.UV_DIRENT_CHAR;
+  if (stats.isBlockDevice()) return binding.UV_DIRENT_BLOCK;
+  return binding.UV_DIRENT_UNKNOWN;
+}
+
+function direntPath(path, name) {
+  return pathModule.join(path.toString(), name.toString());
+}
+
+function toDirents(names, types) {
+  const dirents = new Array(names.length);
+  for (var i = 0; i < names.length; i++)
+    dirents[i] = new Dirent(names[i], types[i]);
+  return dirents;
+}
+
+function getDirents(path, names, types, callback) {
+  var pending = 1;
+  var failed = false;
+
+  function done(err) {
+    if (failed)
+      return;
+    if (err) {
+      failed = true;
+      return callback(err);
+    }
+    if (--pending === 0)
+      callback(null, toDirents(names, types));
+  }
+
+  for (let i = 0; i < names.length; i++) {
+    if (types[i] !== binding.UV_DIRENT_UNKNOWN)
+      continue;
+    pending++;
+    fs.lstat(direntPath(path, names[i]), function(err, stats) {
+      if (!err)
+        types[i] = direntType(stats);
+      done(err);
+    });
+  }
+  done(null);
+}
 
 fs.fstat = function(fd, callback) {
   var req = new FSReqWrap();
@@ -967,6 +1140,48 @@ fs.stat = function(path, callback) {
   binding.stat(pathModule._makeLong(path), req);
 };
 
+// Must match StatManyRequest::kStatsFields in node_file.cc.
+const kStatsFields = 14;
+
+function statsFromFields(f, i) {
+  return new fs.Stats(f[i], f[i + 1], f[i + 2], f[i + 3], f[i + 4], f[i + 5],
+                      isWindows ? undefined : f[i + 6],
+                      f[i + 7], f[i + 8],
+                      isWindows ? undefined : f[i + 9],
+                      f[i + 10], f[i + 11], f[i + 12], f[i + 13]);
+}
+
+function statMany(paths, lstat, callback) {
+  callback = makeCallback(callback);
+  if (!Array.isArray(paths))
+    throw new TypeError('"paths" argument must be an array');
+  const longPaths = new Array(paths.length);
+  for (var i = 0; i < paths.length; i++) {
+    if (!nullCheck(paths[i], callback)) return;
+    longPaths[i] = pathModule._makeLong(paths[i]);
+  }
+  var req = new FSReqWrap();
+  req.oncomplete = function(err, fields, errors) {
+    const results = new Array(errors.length);
+    for (var i = 0; i < results.length; i++) {
+      if (errors[i] !== undefined)
+        results[i] = errors[i];
+      else
+        results[i] = statsFromFields(fields, i * kStatsFields);
+    }
+    callback(null, results);
+  };
+  binding.statMany(longPaths, lstat, req);
+}
+
+fs.lstatMany = function(paths, callback) {
+  statMany(paths, true, callback);
+};
+
+fs.statMany = function(paths, callback) {
+  statMany(paths, false, callback);
+};
+
 fs.fstatSync = function(fd) {
   return binding.fstat(fd);
 };
@@ -1084,9 +1299,7 @@ fs.unlinkSync = function(path) {
 };
 
 fs.fchmod = function(fd, mode, callback) {
-  var req = new FSReqWrap();
-  req.oncomplete = makeCallback(callback);
-  binding.fchmod(fd, modeNum(mode), req);
+  binding.fchmod(fd, modeNum(mode), makeReq(callback));
 };
 
 fs.fchmodSync = function(fd, mode) {
@@ -1167,9 +1380,7 @@ if (constants.hasOwnProperty('O_SYMLINK')) {
 }
 
 fs.fchown = function(fd, uid, gid, callback) {
-  var req = new FSReqWrap();
-  req.oncomplete = makeCallback(callback);
-  binding.fchown(fd, uid, gid, req);
+  binding.fchown(fd, uid, gid, makeReq(callback));
 };
 
 fs.fchownSync = function(fd, uid, gid) {
@@ -1231,9 +1442,7 @@ fs.utimesSync = function(path, atime, mtime) {
 fs.futimes = function(fd, atime, mtime, callback) {
   atime = toUnixTimestamp(atime);
   mtime = toUnixTimestamp(mtime);
-  var req = new FSReqWrap();
-  req.oncomplete = makeCallback(callback);
-  binding.futimes(fd, atime, mtime, req);
+  binding.futimes(fd, atime, mtime, makeReq(callback));
 };
 
 fs.futimesSync = function(fd, atime, mtime) {
@@ -1303,9 +1512,29 @@ fs.writeFile = function(path, data, options, callback_) {
   });
 
   function writeFd(fd, isUserFd) {
+    var position = /a/.test(flag) ? null : 0;
+
+    if (typeof data === 'string' && data.length >= kOffThreadStringLength) {
+      var encoding = ('' + (options.encoding || 'utf8')).toLowerCase();
+      if (encoding === 'utf8' || encoding === 'utf-8' ||
+          encoding === 'base64') {
+        // Large strings are converted on the threadpool.
+        var req = new FSReqWrap();
+        req.oncomplete = function(err, buffer) {
+          if (err) {
+            if (isUserFd)
+              return callback(err);
+            return fs.close(fd, () => callback(err));
+          }
+          writeAll(fd, isUserFd, buffer, 0, buffer.length, position, callback);
+        };
+        binding.encodeString(data, encoding, req);
+        return;
+      }
+    }
+
     var buffer = (data instanceof Buffer) ?
         data : Buffer.from('' + data, options.encoding || 'utf8');
-    var position = /a/.test(flag) ? null : 0;
 
     writeAll(fd, isUserFd, buffer, 0, buffer.length, position, callback);
   }
@@ -1406,18 +1635,31 @@ function FSWatcher() {
       self.emit('change', event, filename);
     }
   };
+
+  // The events of a coalescing window, merged per filename.
+  this._handle.onchanges = function(events, filenames) {
+    const changes = new Array(events.length);
+    for (var i = 0; i < events.length; i++)
+      changes[i] = { eventType: events[i], filename: filenames[i] };
+    self.emit('changes', changes);
+    for (i = 0; i < changes.length && !self._closed; i++)
+      self.emit('change', events[i], filenames[i]);
+  };
+  this._closed = false;
 }
 util.inherits(FSWatcher, EventEmitter);
 
 FSWatcher.prototype.start = function(filename,
                                      persistent,
                                      recursive,
-                                     encoding) {
+                                     encoding,
+                                     coalesce) {
   nullCheck(filename);
   var err = this._handle.start(pathModule._makeLong(filename),
                                persistent,
                                recursive,
-                               encoding);
+                               encoding,
+                               coalesce);
   if (err) {
     this._handle.close();
     const error = errnoException(err, `watch ${filename}`);
@@ -1427,6 +1669,7 @@ FSWatcher.prototype.start = function(filename,
 };
 
 FSWatcher.prototype.close = function() {
+  this._closed = true;
   this._handle.close();
 };
 
@@ -1445,12 +1688,21 @@ fs.watch = function(filename, options, listener) {
 
   if (options.persistent === undefined) options.persistent = true;
   if (options.recursive === undefined) options.recursive = false;
+  if (options.coalesce === undefined) {
+    options.coalesce = 0;
+  } else if (typeof options.coalesce !== 'number' ||
+             !Number.isInteger(options.coalesce) ||
+             options.coalesce < 0 ||
+             options.coalesce > 0xffffffff) {
+    throw new TypeError('"coalesce" option must be a non-negative integer');
+  }
 
   const watcher = new FSWatcher();
   watcher.start(filename,
                 options.persistent,
                 options.recursive,
-                options.encoding);
+                options.encoding,
+                options.coalesce);
 
   if (listener) {
     watcher.addListener('change', listener);
@@ -1598,17 +1850,41 @@ function allocNewPool(poolSize) {
 }
 
 
+// Loading fs doesn't load the stream module, which most programs only need
+// once they create a stream.  The stream classes below get their parent
+// classes when the first of them is constructed.
+function lazyStreams() {
+  if (Stream !== undefined)
+    return;
+  Stream = require('stream');
+  Readable = Stream.Readable;
+  Writable = Stream.Writable;
+  setParent(ReadStream, Readable);
+  setParent(WriteStream, Writable);
+  setParent(Walker, Readable);
+  setParent(SyncWriteStream, Stream);
+  // There is no shutdown() for files.
+  WriteStream.prototype.destroySoon = WriteStream.prototype.end;
+}
+
+// Like util.inherits() but keeps the methods already on ctor.prototype.
+function setParent(ctor, superCtor) {
+  ctor.super_ = superCtor;
+  Object.setPrototypeOf(ctor.prototype, superCtor.prototype);
+}
+
 fs.createReadStream = function(path, options) {
   return new ReadStream(path, options);
 };
 
-util.inherits(ReadStream, Readable);
 fs.ReadStream = ReadStream;
 
 function ReadStream(path, options) {
   if (!(this instanceof ReadStream))
     return new ReadStream(path, options);
 
+  lazyStreams();
+
   if (options === undefined)
     options = {};
   else if (typeof options === 'string')
@@ -1632,6 +1908,14 @@ function ReadStream(path, options) {
   this.end = options.end;
   this.autoClose = options.autoClose === undefined ? true : options.autoClose;
   this.pos = undefined;
+  this.readAhead = options.readAhead === undefined ? 0 : options.readAhead;
+  // The reads in flight when reading ahead, in file order.
+  this._reads = [];
+  this._readEOF = false;
+  this._advised = false;
+
+  if (!Number.isSafeInteger(this.readAhead) || this.readAhead < 0)
+    throw new TypeError('"readAhead" option must be a non-negative integer');
 
   if (this.start !== undefined) {
     if (typeof this.start !== 'number') {
@@ -1674,50 +1958,76 @@ ReadStream.prototype.open = function() {
     }
 
     self.fd = fd;
+    if (self.readAhead > 0 && self.pos === undefined) {
+      // Reads that are in flight together need explicit positions, which
+      // only regular files have.
+      fs.fstat(fd, function(er, stats) {
+        if (!er && stats.isFile()) {
+          self.pos = 0;
+          self.end = Infinity;
+        }
+        self.emit('open', fd);
+        self.read();
+      });
+      return;
+    }
     self.emit('open', fd);
     // start the flow of data.
     self.read();
   });
 };
 
-ReadStream.prototype._read = function(n) {
-  if (typeof this.fd !== 'number')
-    return this.once('open', function() {
-      this._read(n);
-    });
-
-  if (this.destroyed)
-    return;
-
+// Takes up to n bytes from the shared pool, returns null if there is nothing
+// left to read.
+ReadStream.prototype._allocRead = function(n) {
   if (!pool || pool.length - pool.used < kMinPoolSpace) {
     // discard the old pool.
     pool = null;
     allocNewPool(this._readableState.highWaterMark);
   }
 
-  // Grab another reference to the pool in the case that while we're
-  // in the thread pool another read() finishes up the pool, and
-  // allocates a new one.
-  var thisPool = pool;
   var toRead = Math.min(pool.length - pool.used, n);
-  var start = pool.used;
 
   if (this.pos !== undefined)
     toRead = Math.min(this.end - this.pos + 1, toRead);
 
-  // already read everything we were supposed to read!
-  // treat as EOF.
   if (toRead <= 0)
-    return this.push(null);
+    return null;
 
-  // the actual read.
-  var self = this;
-  fs.read(this.fd, pool, pool.used, toRead, this.pos, onread);
+  // Grab another reference to the pool in the case that while we're
+  // in the thread pool another read() finishes up the pool, and
+  // allocates a new one.
+  var read = { pool: pool, start: pool.used, length: toRead, pos: this.pos };
 
   // move the pool positions, and internal position for reading.
   if (this.pos !== undefined)
     this.pos += toRead;
   pool.used += toRead;
+  return read;
+};
+
+ReadStream.prototype._read = function(n) {
+  if (typeof this.fd !== 'number')
+    return this.once('open', function() {
+      this._read(n);
+    });
+
+  if (this.destroyed)
+    return;
+
+  if (this.readAhead > 0 && this.pos !== undefined)
+    return this._fillReads();
+
+  var read = this._allocRead(n);
+
+  // already read everything we were supposed to read!
+  // treat as EOF.
+  if (read === null)
+    return this.push(null);
+
+  // the actual read.
+  var self = this;
+  fs.read(this.fd, read.pool, read.start, read.length, read.pos, onread);
 
   function onread(er, bytesRead) {
     if (er) {
@@ -1728,13 +2038,73 @@ ReadStream.prototype._read = function(n) {
     } else {
       var b = null;
       if (bytesRead > 0)
-        b = thisPool.slice(start, start + bytesRead);
+        b = read.pool.slice(read.start, read.start + bytesRead);
 
       self.push(b);
     }
   }
 };
 
+// Keeps up to readAhead reads of highWaterMark bytes in flight, so the disk
+// stays busy while the consumer works through the data read so far.  Their
+// results are pushed in order as they come in, and new reads are only
+// started while the stream wants more data.
+ReadStream.prototype._fillReads = function() {
+  if (!this._advised) {
+    binding.fadviseSequential(this.fd);
+    this._advised = true;
+  }
+
+  var self = this;
+  var size = this._readableState.highWaterMark;
+  while (this._reads.length < this.readAhead && !this._readEOF) {
+    var read = this._allocRead(size);
+    if (read === null) {
+      if (this._reads.length === 0) {
+        this._readEOF = true;
+        this.push(null);
+      }
+      return;
+    }
+    read.done = false;
+    read.error = null;
+    read.bytesRead = 0;
+    this._reads.push(read);
+    fs.read(this.fd, read.pool, read.start, read.length, read.pos,
+            onread.bind(null, read));
+  }
+
+  function onread(read, er, bytesRead) {
+    read.done = true;
+    read.error = er;
+    read.bytesRead = bytesRead;
+    self._flushReads();
+  }
+};
+
+ReadStream.prototype._flushReads = function() {
+  while (this._reads.length > 0 && this._reads[0].done) {
+    var read = this._reads.shift();
+    if (this.destroyed || this._readEOF)
+      continue;
+    if (read.error) {
+      this._readEOF = true;
+      if (this.autoClose)
+        this.destroy();
+      this.emit('error', read.error);
+    } else if (read.bytesRead === 0) {
+      this._readEOF = true;
+      this.push(null);
+    } else {
+      var start = read.start;
+      this.push(read.pool.slice(start, start + read.bytesRead));
+    }
+  }
+  var state = this._readableState;
+  if (!this.destroyed && state.length < state.highWaterMark)
+    this._fillReads();
+};
+
 
 ReadStream.prototype.destroy = function() {
   if (this.destroyed)
@@ -1774,12 +2144,13 @@ fs.createWriteStream = function(path, options) {
   return new WriteStream(path, options);
 };
 
-util.inherits(WriteStream, Writable);
 fs.WriteStream = WriteStream;
 function WriteStream(path, options) {
   if (!(this instanceof WriteStream))
     return new WriteStream(path, options);
 
+  lazyStreams();
+
   if (options === undefined)
     options = {};
   else if (typeof options === 'string')
@@ -1800,6 +2171,11 @@ function WriteStream(path, options) {
   this.autoClose = options.autoClose === undefined ? true : !!options.autoClose;
   this.pos = undefined;
   this.bytesWritten = 0;
+  // Callbacks of sync() calls, waiting for the fdatasync() in progress and
+  // for the next one.
+  this._syncing = null;
+  this._syncQueue = [];
+  this._closeAfterSync = false;
 
   if (this.start !== undefined) {
     if (typeof this.start !== 'number') {
@@ -1821,7 +2197,11 @@ function WriteStream(path, options) {
   // dispose on finish.
   this.once('finish', function() {
     if (this.autoClose) {
-      this.close();
+      // The file stays open for the syncs that are in progress.
+      if (this._syncing !== null)
+        this._closeAfterSync = true;
+      else
+        this.close();
     }
   });
 }
@@ -1845,7 +2225,13 @@ WriteStream.prototype.open = function() {
 };
 
 
+WriteStream.prototype._writableChunkList = true;
+
+
 WriteStream.prototype._write = function(data, encoding, cb) {
+  if (data instanceof ChunkList)
+    return this._writev([{ chunk: data, encoding: 'buffer' }], cb);
+
   if (!(data instanceof Buffer))
     return this.emit('error', new Error('Invalid data'));
 
@@ -1854,6 +2240,9 @@ WriteStream.prototype._write = function(data, encoding, cb) {
       this._write(data, encoding, cb);
     });
 
+  if (data === kSyncMarker)
+    return cb();
+
   var self = this;
   fs.write(this.fd, data, 0, data.length, this.pos, function(er, bytes) {
     if (er) {
@@ -1891,15 +2280,29 @@ WriteStream.prototype._writev = function(data, cb) {
 
   const self = this;
   const len = data.length;
-  const chunks = new Array(len);
+  const chunks = [];
   var size = 0;
+  var markers = 0;
 
   for (var i = 0; i < len; i++) {
     var chunk = data[i].chunk;
 
-    chunks[i] = chunk;
+    if (chunk === kSyncMarker) {
+      markers++;
+      continue;
+    }
+    if (chunk instanceof ChunkList) {
+      for (var j = 0; j < chunk.chunks.length; j++)
+        chunks.push(chunk.chunks[j]);
+    } else {
+      chunks.push(chunk);
+    }
     size += chunk.length;
   }
+  if (markers === len)
+    return cb();
+  if (chunks.length === 0)
+    chunks.push(Buffer.alloc(0));  // Only empty ChunkLists.
 
   writev(this.fd, chunks, this.pos, function(er, bytes) {
     if (er) {
@@ -1915,16 +2318,105 @@ WriteStream.prototype._writev = function(data, cb) {
 };
 
 
+// Written by sync() to find out when the data written before it is in the
+// file, it's skipped by _write() and _writev().
+const kSyncMarker = Buffer.alloc(0);
+
+// Flushes the data written so far to the storage device with fdatasync().
+// The calls made while an fdatasync() is in progress share the next one,
+// so many writers that each want their data durable cost few syncs.
+WriteStream.prototype.sync = function(callback) {
+  if (typeof callback !== 'function')
+    throw new TypeError('"callback" argument must be a function');
+
+  this.write(kSyncMarker, function(er) {
+    if (er)
+      return callback(er);
+    this._syncQueue.push(callback);
+    if (this._syncing === null)
+      this._flushSync();
+  }.bind(this));
+};
+
+WriteStream.prototype._flushSync = function() {
+  const callbacks = this._syncing = this._syncQueue;
+  this._syncQueue = [];
+  fs.fdatasync(this.fd, function(er) {
+    this._syncing = null;
+    if (this._syncQueue.length > 0)
+      this._flushSync();
+    else if (this._closeAfterSync)
+      this.close();
+    for (var i = 0; i < callbacks.length; i++)
+      callbacks[i](er || null);
+  }.bind(this));
+};
+
 WriteStream.prototype.destroy = ReadStream.prototype.destroy;
 WriteStream.prototype.close = ReadStream.prototype.close;
 
-// There is no shutdown() for files.
-WriteStream.prototype.destroySoon = WriteStream.prototype.end;
+
+fs.walk = function(root, options) {
+  return new Walker(root, options);
+};
+
+fs.Walker = Walker;
+
+function Walker(root, options) {
+  if (!(this instanceof Walker))
+    return new Walker(root, options);
+
+  lazyStreams();
+
+  options = options || {};
+  if (typeof options !== 'object')
+    throw new TypeError('"options" must be an object');
+
+  var batchSize = options.batchSize === undefined ? 512 : options.batchSize;
+  if (typeof batchSize !== 'number' || batchSize < 1 ||
+      batchSize > 0xffffffff || Math.floor(batchSize) !== batchSize) {
+    throw new RangeError('"batchSize" must be a positive integer');
+  }
+
+  nullCheck(root);
+  Readable.call(this, { objectMode: true, highWaterMark: batchSize });
+
+  this.root = root;
+  this.batchSize = batchSize;
+  this._reading = false;
+  this._handle = new binding.DirWalker(pathModule._makeLong(root));
+  this._handle.owner = this;
+  this._handle.ondone = onwalk;
+}
+
+Walker.prototype._read = function() {
+  if (this._reading)
+    return;
+  this._reading = true;
+  this._handle.read(this.batchSize);
+};
+
+function onwalk(err, paths, types) {
+  const walker = this.owner;
+  walker._reading = false;
+
+  for (var i = 0; i < paths.length; i++) {
+    const dirent = new Dirent(pathModule.basename(paths[i]), types[i]);
+    dirent.path = paths[i];
+    walker.push(dirent);
+  }
+
+  if (err)
+    walker.emit('error', err);
+  else if (paths.length === 0)
+    walker.push(null);
+}
 
 
 // SyncWriteStream is internal. DO NOT USE.
 // Temporary hack for process.stdout and process.stderr when piped to files.
 function SyncWriteStream(fd, options) {
+  lazyStreams();
   Stream.call(this);
 
   options = options || {};
@@ -1935,8 +2427,6 @@ function SyncWriteStream(fd, options) {
   this.autoClose = options.autoClose === undefined ? true : options.autoClose;
 }
 
-util.inherits(SyncWriteStream, Stream);
-
 
 // Export
 Object.defineProperty(fs, 'SyncWriteStream', {
@@ -2031,3 +2521,275 @@ fs.mkdtempSync = function(prefix, options) {
 
   return binding.mkdtemp(prefix + 'XXXXXX', options.encoding);
 };
+
+
+function isNonNegativeInteger(value) {
+  return typeof value === 'number' && value >= 0 &&
+         value <= Number.MAX_SAFE_INTEGER && Math.floor(value) === value;
+}
+
+fs.mmap = function(fd, offset, length) {
+  if (offset === undefined)
+    offset = 0;
+  if (!isNonNegativeInteger(offset))
+    throw new TypeError('"offset" argument must be a non-negative integer');
+  if (length !== undefined && !isNonNegativeInteger(length))
+    throw new TypeError('"length" argument must be a non-negative integer');
+
+  // Touching a page past the end of the file raises SIGBUS, so the mapping
+  // has to stay within the file.
+  const size = fs.fstatSync(fd).size;
+  if (offset > size)
+    throw new RangeError('"offset" is beyond the end of the file');
+  if (length === undefined)
+    length = size - offset;
+  else if (offset + length > size)
+    throw new RangeError('"length" extends beyond the end of the file');
+
+  if (length === 0)
+    return Buffer.alloc(0);
+  return binding.mmap(fd, offset, length);
+};
+
+
+// fs.promises.  The binding settles the promise of each request itself, so
+// there is no callback, and no closure to make one, between the threadpool
+// and the code that awaits the result.
+const kUsePromises = binding.kUsePromises;
+
+function checkPaths(path) {
+  for (var i = 0; i < arguments.length; i++) {
+    if (('' + arguments[i]).indexOf('\u0000') !== -1) {
+      var er = new Error('Path must be a string without null bytes');
+      er.code = 'ENOENT';
+      return Promise.reject(er);
+    }
+  }
+  return null;
+}
+
+function encodingOption(options) {
+  if (typeof options === 'string')
+    return options;
+  if (options === undefined || options === null)
+    return undefined;
+  if (typeof options !== 'object')
+    throw new TypeError('"options" must be a string or an object');
+  return options.encoding;
+}
+
+function settledCallback(resolve, reject) {
+  return (err, result) => {
+    if (err)
+      reject(err);
+    else
+      resolve(result);
+  };
+}
+
+fs.promises = {
+  access(path, mode) {
+    return checkPaths(path) ||
+        binding.access(pathModule._makeLong(path),
+                       mode === undefined ? fs.F_OK : mode | 0,
+                       kUsePromises);
+  },
+
+  open(path, flags, mode) {
+    return checkPaths(path) ||
+        binding.open(pathModule._makeLong(path),
+                     stringToFlags(flags === undefined ? 'r' : flags),
+                     modeNum(mode, 0o666),
+                     kUsePromises);
+  },
+
+  close(fd) {
+    return binding.close(fd, kUsePromises);
+  },
+
+  // Resolves to the number of bytes read.
+  read(fd, buffer, offset, length, position) {
+    if (!(buffer instanceof Buffer))
+      throw new TypeError('"buffer" argument must be a Buffer');
+    if (length === 0)
+      return Promise.resolve(0);
+    return binding.read(fd, buffer, offset, length, position, kUsePromises);
+  },
+
+  // write(fd, buffer[, offset[, length[, position]]]) or
+  // write(fd, string[, position[, encoding]]).  Resolves to the number of
+  // bytes written.
+  write(fd, buffer, offset, length, position) {
+    if (typeof buffer === 'string') {
+      const encoding = typeof length === 'string' ? length : 'utf8';
+      position = offset;
+      buffer = Buffer.from(buffer, encoding);
+      offset = 0;
+      length = buffer.length;
+    }
+    if (!(buffer instanceof Buffer))
+      throw new TypeError('"buffer" argument must be a string or Buffer');
+    if (typeof offset !== 'number')
+      offset = 0;
+    if (typeof length !== 'number')
+      length = buffer.length - offset;
+    if (typeof position !== 'number')
+      position = null;
+    return binding.writeBuffer(fd, buffer, offset, length, position,
+                               kUsePromises);
+  },
+
+  stat(path) {
+    return checkPaths(path) ||
+        binding.stat(pathModule._makeLong(path), kUsePromises);
+  },
+
+  lstat(path) {
+    return checkPaths(path) ||
+        binding.lstat(pathModule._makeLong(path), kUsePromises);
+  },
+
+  fstat(fd) {
+    return binding.fstat(fd, kUsePromises);
+  },
+
+  readdir(path, options) {
+    const rejected = checkPaths(path);
+    if (rejected)
+      return rejected;
+    const withFileTypes = !!(options && options.withFileTypes);
+    const result = binding.readdir(pathModule._makeLong(path),
+                                   encodingOption(options),
+                                   kUsePromises,
+                                   withFileTypes);
+    if (!withFileTypes)
+      return result;
+    return result.then((results) => new Promise((resolve, reject) => {
+      getDirents(path, results[0], results[1],
+                 settledCallback(resolve, reject));
+    }));
+  },
+
+  mkdir(path, mode) {
+    return checkPaths(path) ||
+        binding.mkdir(pathModule._makeLong(path), modeNum(mode, 0o777),
+                      kUsePromises);
+  },
+
+  mkdtemp(prefix, options) {
+    if (!prefix || typeof prefix !== 'string')
+      throw new TypeError('filename prefix is required');
+    return checkPaths(prefix) ||
+        binding.mkdtemp(prefix + 'XXXXXX', encodingOption(options),
+                        kUsePromises);
+  },
+
+  rmdir(path) {
+    return checkPaths(path) ||
+        binding.rmdir(pathModule._makeLong(path), kUsePromises);
+  },
+
+  unlink(path) {
+    return checkPaths(path) ||
+        binding.unlink(pathModule._makeLong(path), kUsePromises);
+  },
+
+  rename(oldPath, newPath) {
+    return checkPaths(oldPath, newPath) ||
+        binding.rename(pathModule._makeLong(oldPath),
+                       pathModule._makeLong(newPath),
+                       kUsePromises);
+  },
+
+  link(srcpath, dstpath) {
+    return checkPaths(srcpath, dstpath) ||
+        binding.link(pathModule._makeLong(srcpath),
+                     pathModule._makeLong(dstpath),
+                     kUsePromises);
+  },
+
+  symlink(target, path, type) {
+    type = (typeof type === 'string' ? type : null);
+    return checkPaths(target, path) ||
+        binding.symlink(preprocessSymlinkDestination(target, type, path),
+                        pathModule._makeLong(path),
+                        type,
+                        kUsePromises);
+  },
+
+  readlink(path, options) {
+    return checkPaths(path) ||
+        binding.readlink(pathModule._makeLong(path), encodingOption(options),
+                         kUsePromises);
+  },
+
+  realpath(path, options) {
+    return checkPaths(path) ||
+        binding.realpath(pathModule._makeLong(path), encodingOption(options),
+                         kUsePromises);
+  },
+
+  chmod(path, mode) {
+    return checkPaths(path) ||
+        binding.chmod(pathModule._makeLong(path), modeNum(mode),
+                      kUsePromises);
+  },
+
+  fchmod(fd, mode) {
+    return binding.fchmod(fd, modeNum(mode), kUsePromises);
+  },
+
+  chown(path, uid, gid) {
+    return checkPaths(path) ||
+        binding.chown(pathModule._makeLong(path), uid, gid, kUsePromises);
+  },
+
+  fchown(fd, uid, gid) {
+    return binding.fchown(fd, uid, gid, kUsePromises);
+  },
+
+  ftruncate(fd, len) {
+    return binding.ftruncate(fd, len === undefined ? 0 : len, kUsePromises);
+  },
+
+  fsync(fd) {
+    return binding.fsync(fd, kUsePromises);
+  },
+
+  fdatasync(fd) {
+    return binding.fdatasync(fd, kUsePromises);
+  },
+
+  utimes(path, atime, mtime) {
+    return checkPaths(path) ||
+        binding.utimes(pathModule._makeLong(path),
+                       toUnixTimestamp(atime),
+                       toUnixTimestamp(mtime),
+                       kUsePromises);
+  },
+
+  futimes(fd, atime, mtime) {
+    return binding.futimes(fd, toUnixTimestamp(atime), toUnixTimestamp(mtime),
+                           kUsePromises);
+  },
+
+  // These are made of several requests, or requests of their own kind, and
+  // use the callback versions.
+  readFile(path, options) {
+    return new Promise((resolve, reject) => {
+      fs.readFile(path, options, settledCallback(resolve, reject));
+    });
+  },
+
+  writeFile(path, data, options) {
+    return new Promise((resolve, reject) => {
+      fs.writeFile(path, data, options, settledCallback(resolve, reject));
+    });
+  },
+
+  appendFile(path, data, options) {
+    return new Promise((resolve, reject) => {
+      fs.appendFile(path, data, options, settledCallback(resolve, reject));
+    });
+  }
+};
@@ -0,0 +1,595 @@
+'use strict';
+
+const EventEmitter = require('events');
+const net = require('net');
+const url = require('url');
+const util = require('util');
+const Buffer = require('buffer').Buffer;
+const Duplex = require('stream').Duplex;
+const tls = process.versions.openssl ? require('tls') : null;
+const binding = process.binding('http2');
+const debug = util.debuglog('http2');
+
+const Handle = binding.Http2Session;
+const kOnHeaders = Handle.kOnHeaders | 0;
+const kOnData = Handle.kOnData | 0;
+const kOnStreamEnd = Handle.kOnStreamEnd | 0;
+const kOnStreamClose = Handle.kOnStreamClose | 0;
+const kOnStreamDrain = Handle.kOnStreamDrain | 0;
+const kOnGoaway = Handle.kOnGoaway | 0;
+const kOnError = Handle.kOnError | 0;
+
+const kServer = 0;
+const kClient = 1;
+
+const codes = binding.codes;
+const codeNames = {};
+Object.keys(codes).forEach((name) => { codeNames[codes[name]] = name; });
+
+const kEmpty = Buffer.alloc(0);
+
+// RFC 7540 8.1.2.2, HTTP/2 has no connection-specific headers.
+const kConnectionHeaders = {
+  'connection': true,
+  'keep-alive': true,
+  'proxy-connection': true,
+  'transfer-encoding': true,
+  'upgrade': true
+};
+
+// The order that src/node_http2.cc expects.
+const kSettingsNames = [
+  'headerTableSize',
+  'maxConcurrentStreams',
+  'initialWindowSize',
+  'maxFrameSize',
+  'maxHeaderListSize'
+];
+
+function settingsToArray(settings) {
+  settings = util._extend(util._extend({}, binding.defaultSettings), settings);
+  return kSettingsNames.map((name) => {
+    const value = settings[name];
+    if (typeof value !== 'number' || value % 1 !== 0 ||
+        value < 0 || value > 0xffffffff) {
+      throw new TypeError(`"${name}" must be an unsigned 32-bit integer`);
+    }
+    if (name === 'initialWindowSize' && value > 0x7fffffff)
+      throw new RangeError('"initialWindowSize" must be at most 2^31-1');
+    if (name === 'maxFrameSize' && (value < 16384 || value > 0xffffff))
+      throw new RangeError('"maxFrameSize" must be between 2^14 and 2^24-1');
+    return value;
+  });
+}
+
+// Pseudo-headers have to come first in a header block.
+function toHeaderList(headers) {
+  const pseudo = [];
+  const list = [];
+  Object.keys(headers).forEach((key) => {
+    const value = headers[key];
+    if (value === undefined)
+      return;
+    const name = key.toLowerCase();
+    if (kConnectionHeaders[name] || (name === 'te' && value !== 'trailers'))
+      throw new TypeError(`Header "${name}" is not valid in HTTP/2`);
+    const target = name[0] === ':' ? pseudo : list;
+    if (Array.isArray(value)) {
+      for (var i = 0; i < value.length; i++)
+        target.push(name, String(value[i]));
+    } else {
+      target.push(name, String(value));
+    }
+  });
+  return pseudo.concat(list);
+}
+
+// Repeated headers are joined like http.IncomingMessage does it.
+function toHeaderObject(list) {
+  const headers = {};
+  for (var i = 0; i < list.length; i += 2) {
+    const name = list[i];
+    const value = list[i + 1];
+    if (name === '__proto__')
+      continue;
+    if (!Object.prototype.hasOwnProperty.call(headers, name)) {
+      headers[name] = name === 'set-cookie' ? [value] : value;
+    } else if (name === 'set-cookie') {
+      headers[name].push(value);
+    } else {
+      headers[name] += (name === 'cookie' ? '; ' : ', ') + value;
+    }
+  }
+  return headers;
+}
+
+function codeError(code) {
+  const name = codeNames[code] || `0x${code.toString(16)}`;
+  const err = new Error(`HTTP/2 session failed with ${name}`);
+  err.code = name;
+  err.errno = code;
+  return err;
+}
+
+
+function Http2Session(type, socket, options) {
+  EventEmitter.call(this);
+  options = options || {};
+
+  const handle = this._handle =
+      new Handle(type, settingsToArray(options.settings));
+  handle.owner = this;
+  handle[kOnHeaders] = onheaders;
+  handle[kOnData] = ondata;
+  handle[kOnStreamEnd] = onstreamend;
+  handle[kOnStreamClose] = onstreamclose;
+  handle[kOnStreamDrain] = ondrain;
+  handle[kOnGoaway] = ongoaway;
+  handle[kOnError] = onerror;
+
+  this.type = type;
+  this.socket = socket;
+  this.destroyed = false;
+  this._streams = new Map();
+  this._closing = false;
+
+  socket.on('error', onsocketerror.bind(this));
+  socket.on('close', onsocketclose.bind(this));
+}
+util.inherits(Http2Session, EventEmitter);
+
+// Hands the socket's reads over to the binding.  Whatever the socket has
+// read already is passed on first.
+Http2Session.prototype._attach = function() {
+  const socket = this.socket;
+  var chunk;
+  while ((chunk = socket.read()) !== null)
+    this._handle.receive(chunk);
+  if (this.destroyed)
+    return;
+  const err = this._handle.consume(socket._handle._externalStream);
+  if (err)
+    this.destroy(util._errnoException(err, 'read'));
+};
+
+// Sends a GOAWAY and closes the connection once the open streams are done.
+Http2Session.prototype.close = function(callback) {
+  if (callback)
+    this.once('close', callback);
+  if (this._closing || this.destroyed)
+    return;
+  this._closing = true;
+  this._handle.goaway(codes.NO_ERROR);
+  maybeShutdown(this);
+};
+
+Http2Session.prototype.destroy = function(err) {
+  if (this.destroyed)
+    return;
+  debug('destroy session', err);
+  this.destroyed = true;
+  this._handle.destroy();
+  abortStreams(this);
+  this.socket.destroy();
+  if (err)
+    this.emit('error', err);
+};
+
+function maybeShutdown(session) {
+  if (!session._closing || session._streams.size > 0 || session.destroyed)
+    return;
+  session.destroyed = true;
+  session._handle.destroy();
+  session.socket.end();
+}
+
+function abortStreams(session) {
+  session._streams.forEach((stream) => {
+    stream._onclose(codes.CANCEL);
+  });
+}
+
+function onsocketerror(err) {
+  if (this.destroyed)
+    return;
+  this.destroy(err);
+}
+
+function onsocketclose() {
+  if (!this.destroyed) {
+    this.destroyed = true;
+    this._handle.destroy();
+    abortStreams(this);
+  }
+  this.emit('close');
+}
+
+function onheaders(id, list, endStream) {
+  const session = this.owner;
+  const headers = toHeaderObject(list);
+  var stream = session._streams.get(id);
+  if (stream === undefined) {
+    // Only servers see new streams.
+    stream = new ServerHttp2Stream(session, id, headers);
+    session._streams.set(id, stream);
+    session.emit('stream', stream, headers);
+    return;
+  }
+  if (stream._headersReceived) {
+    stream.emit('trailers', headers);
+    return;
+  }
+  if (session.type === kClient && +headers[':status'] < 200) {
+    stream.emit('headers', headers);
+    return;
+  }
+  stream._headersReceived = true;
+  stream.headers = headers;
+  if (session.type === kClient)
+    stream.emit('response', headers);
+}
+
+function ondata(id, chunk) {
+  const stream = this.owner._streams.get(id);
+  if (stream === undefined)
+    return;
+  // The flow control windows are opened again as the data is read.
+  stream._unconsumed += chunk.length;
+  if (stream.push(chunk))
+    stream._consume();
+}
+
+function onstreamend(id) {
+  const stream = this.owner._streams.get(id);
+  if (stream !== undefined)
+    stream.push(null);
+}
+
+function onstreamclose(id, code) {
+  const stream = this.owner._streams.get(id);
+  if (stream !== undefined)
+    stream._onclose(code);
+}
+
+function ondrain(id) {
+  const stream = this.owner._streams.get(id);
+  if (stream === undefined || stream._writeCallback === null)
+    return;
+  const cb = stream._writeCallback;
+  stream._writeCallback = null;
+  cb();
+}
+
+function ongoaway(code, lastStreamId) {
+  this.owner.emit('goaway', code, lastStreamId);
+}
+
+function onerror(code, status) {
+  const session = this.owner;
+  const err = status ? util._errnoException(status, 'write') : codeError(code);
+  // The GOAWAY that the binding queued goes out before the socket ends.
+  process.nextTick(() => {
+    if (session.destroyed)
+      return;
+    session.destroyed = true;
+    session._handle.destroy();
+    abortStreams(session);
+    session.socket.end();
+    session.emit('error', err);
+  });
+}
+
+
+function Http2Stream(session, id) {
+  Duplex.call(this);
+  this.session = session;
+  this.id = id;
+  this.headers = null;
+  this.rstCode = undefined;
+  this._headersReceived = false;
+  this._headersSent = false;
+  this._endSent = false;
+  this._closed = false;
+  this._trailers = null;
+  this._unconsumed = 0;
+  this._writeCallback = null;
+  this.on('finish', onfinish);
+}
+util.inherits(Http2Stream, Duplex);
+
+Http2Stream.prototype._read = function() {
+  this._consume();
+};
+
+Http2Stream.prototype._consume = function() {
+  if (this._unconsumed === 0 || this.session.destroyed)
+    return;
+  this.session._handle.consumed(this.id, this._unconsumed);
+  this._unconsumed = 0;
+};
+
+Http2Stream.prototype._write = function(chunk, encoding, cb) {
+  if (this._closed)
+    return cb();
+  if (!this._headersSent)
+    this._respondImplicitly(false);
+  if (chunk.length === 0)
+    return process.nextTick(cb);
+  if (!this.session._handle.write(this.id, chunk, false))
+    return cb();
+  // Called back by ondrain() once the data is out.
+  this._writeCallback = cb;
+};
+
+Http2Stream.prototype._respondImplicitly = function(endStream) {
+  this._headersSent = true;
+};
+
+// Ends the stream with trailers instead of an empty DATA frame.
+Http2Stream.prototype.sendTrailers = function(headers) {
+  if (this._endSent || this._trailers !== null)
+    throw new Error('The stream has already ended');
+  this._trailers = toHeaderList(headers || {});
+  this.end();
+};
+
+Http2Stream.prototype.rstStream = function(code) {
+  if (this._closed)
+    return;
+  if (code === undefined)
+    code = codes.CANCEL;
+  this.session._handle.rstStream(this.id, code >>> 0);
+  this._onclose(code);
+};
+
+Http2Stream.prototype._onclose = function(code) {
+  if (this._closed)
+    return;
+  this._closed = true;
+  this.rstCode = code;
+  const session = this.session;
+  session._streams.delete(this.id);
+  // Data that nobody read still has to be given back to the connection.
+  if (this._unconsumed > 0 && !session.destroyed)
+    session._handle.consumed(this.id, this._unconsumed);
+  this._unconsumed = 0;
+  if (this._writeCallback !== null) {
+    const cb = this._writeCallback;
+    this._writeCallback = null;
+    cb();
+  }
+  if (code !== codes.NO_ERROR)
+    this.emit('aborted', code);
+  process.nextTick(() => this.emit('close', code));
+  maybeShutdown(session);
+};
+
+function onfinish() {
+  if (this._endSent || this._closed)
+    return;
+  this._endSent = true;
+  const handle = this.session._handle;
+  if (!this._headersSent && this._trailers === null) {
+    this._respondImplicitly(true);
+  } else {
+    if (!this._headersSent)
+      this._respondImplicitly(false);
+    if (this._trailers !== null)
+      handle.respond(this.id, this._trailers, true);
+    else
+      handle.write(this.id, kEmpty, true);
+  }
+}
+
+
+function ServerHttp2Stream(session, id, headers) {
+  Http2Stream.call(this, session, id);
+  this._headersReceived = true;
+  this.headers = headers;
+}
+util.inherits(ServerHttp2Stream, Http2Stream);
+
+ServerHttp2Stream.prototype.respond = function(headers, options) {
+  if (this._headersSent)
+    throw new Error('The response headers have already been sent');
+  headers = util._extend({}, headers);
+  if (headers[':status'] === undefined)
+    headers[':status'] = 200;
+  const endStream = !!(options && options.endStream);
+  this._headersSent = true;
+  if (this._closed)
+    return;
+  this.session._handle.respond(this.id, toHeaderList(headers), endStream);
+  if (endStream) {
+    this._endSent = true;
+    this.end();
+  }
+};
+
+ServerHttp2Stream.prototype._respondImplicitly = function(endStream) {
+  this._headersSent = true;
+  if (this._closed)
+    return;
+  this.session._handle.respond(this.id, [':status', '200'], endStream);
+};
+
+
+function ClientHttp2Stream(session, id) {
+  Http2Stream.call(this, session, id);
+  this._headersSent = true;
+}
+util.inherits(ClientHttp2Stream, Http2Stream);
+
+
+function ServerHttp2Session(socket, options) {
+  Http2Session.call(this, kServer, socket, options);
+  this._attach();
+}
+util.inherits(ServerHttp2Session, Http2Session);
+
+
+function ClientHttp2Session(socket, options, authority, scheme) {
+  Http2Session.call(this, kClient, socket, options);
+  this._authority = authority;
+  this._scheme = scheme;
+}
+util.inherits(ClientHttp2Session, Http2Session);
+
+// Requests can be made before the connection is up, they go out once it
+// is.  GET and HEAD requests end the request stream, unless
+// options.endStream says otherwise.
+ClientHttp2Session.prototype.request = function(headers, options) {
+  if (this.destroyed || this._closing)
+    throw new Error('The session has been closed');
+  headers = util._extend({}, headers);
+  if (headers[':method'] === undefined)
+    headers[':method'] = 'GET';
+  if (headers[':path'] === undefined)
+    headers[':path'] = '/';
+  if (headers[':scheme'] === undefined)
+    headers[':scheme'] = this._scheme;
+  if (headers[':authority'] === undefined)
+    headers[':authority'] = this._authority;
+
+  const method = headers[':method'];
+  var endStream = method === 'GET' || method === 'HEAD';
+  if (options && options.endStream !== undefined)
+    endStream = !!options.endStream;
+
+  const id = this._handle.request(toHeaderList(headers), endStream);
+  if (id === 0)
+    throw new Error('No more streams can be opened on this session');
+  const stream = new ClientHttp2Stream(this, id);
+  this._streams.set(id, stream);
+  if (endStream) {
+    stream._endSent = true;
+    stream.end();
+  }
+  return stream;
+};
+
+
+function connectionListener(socket) {
+  debug('new session');
+  const session = new ServerHttp2Session(socket, this._http2Options);
+  session.on('stream', (stream, headers) => {
+    this.emit('stream', stream, headers);
+  });
+  session.on('error', (err) => {
+    this.emit('sessionError', err, session);
+  });
+  this.emit('session', session);
+}
+
+function Server(options, onStream) {
+  if (!(this instanceof Server))
+    return new Server(options, onStream);
+  if (typeof options === 'function') {
+    onStream = options;
+    options = {};
+  }
+  net.Server.call(this, { allowHalfOpen: false }, connectionListener);
+  this._http2Options = options || {};
+  settingsToArray(this._http2Options.settings);
+  if (onStream)
+    this.on('stream', onStream);
+}
+util.inherits(Server, net.Server);
+
+// HTTP/2 over TLS is negotiated with ALPN, other protocols are turned
+// away.
+function secureConnectionListener(socket) {
+  if (socket.alpnProtocol !== 'h2') {
+    if (!this.emit('unknownProtocol', socket))
+      socket.destroy();
+    return;
+  }
+  connectionListener.call(this, socket);
+}
+
+function SecureServer(options, onStream) {
+  if (!(this instanceof SecureServer))
+    return new SecureServer(options, onStream);
+  options = util._extend({}, options);
+  if (!options.ALPNProtocols)
+    options.ALPNProtocols = ['h2'];
+  tls.Server.call(this, options, secureConnectionListener);
+  this._http2Options = options;
+  settingsToArray(options.settings);
+  if (onStream)
+    this.on('stream', onStream);
+}
+if (tls !== null)
+  util.inherits(SecureServer, tls.Server);
+
+// Without crypto there is only HTTP/2 over cleartext TCP.
+function assertTLS() {
+  if (tls === null)
+    throw new Error('Node.js is not compiled with openssl crypto support');
+  if (!process.features.tls_alpn)
+    throw new Error('HTTP/2 over TLS needs ALPN support');
+}
+
+function createServer(options, onStream) {
+  return new Server(options, onStream);
+}
+
+function createSecureServer(options, onStream) {
+  assertTLS();
+  return new SecureServer(options, onStream);
+}
+
+// connect('http://localhost:8000') for HTTP/2 over cleartext TCP,
+// connect('https://...') for HTTP/2 over TLS.
+function connect(authority, options, listener) {
+  if (typeof options === 'function') {
+    listener = options;
+    options = {};
+  }
+  options = util._extend({}, options);
+  const parsed = typeof authority === 'string' ? url.parse(authority)
+                                               : authority;
+  const secure = parsed.protocol === 'https:';
+  const host = parsed.hostname || 'localhost';
+  const port = +parsed.port || (secure ? 443 : 80);
+
+  var socket;
+  if (secure) {
+    assertTLS();
+    socket = tls.connect(util._extend({
+      host: host,
+      port: port,
+      servername: host,
+      ALPNProtocols: ['h2']
+    }, options));
+  } else {
+    socket = net.connect({ host: host, port: port });
+  }
+
+  const session = new ClientHttp2Session(socket,
+                                         options,
+                                         `${host}:${port}`,
+                                         secure ? 'https' : 'http');
+  socket.once(secure ? 'secureConnect' : 'connect', () => {
+    if (secure && socket.alpnProtocol !== 'h2') {
+      session.destroy(new Error('The server does not speak HTTP/2'));
+      return;
+    }
+    session._attach();
+    session.emit('connect', session);
+  });
+  if (listener)
+    session.once('connect', listener);
+  return session;
+}
+
+module.exports = {
+  codes: codes,
+  Server: Server,
+  SecureServer: SecureServer,
+  Http2Session: Http2Session,
+  Http2Stream: Http2Stream,
+  createServer: createServer,
+  createSecureServer: createSecureServer,
+  connect: connect
+};
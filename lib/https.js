@@ -37,11 +37,14 @@ function Server(opts, requestListener) {
   });
 
   this.timeout = 2 * 60 * 1000;
+  this._stats = new Float64Array(process.binding('http_parser')
+                                     .kStatsFieldsCount);
 }
 inherits(Server, tls.Server);
 exports.Server = Server;
 
 Server.prototype.setTimeout = http.Server.prototype.setTimeout;
+Server.prototype.getStats = http.Server.prototype.getStats;
 
 exports.createServer = function(opts, requestListener) {
   return new Server(opts, requestListener);
@@ -10,6 +10,7 @@
 (function(process) {
 
   function startup() {
+    const startupStart = traceStartup ? traceNow() : 0;
     var EventEmitter = NativeModule.require('events');
     process._eventsCount = 0;
 
@@ -48,12 +49,18 @@
 
     _process.setup_hrtime();
     _process.setup_cpuUsage();
+    _process.setupThreadpool();
+    _process.setupAffinity();
+    _process.setupBusyPoll();
     _process.setupConfig(NativeModule._source);
     NativeModule.require('internal/process/warning').setup();
+    NativeModule.require('internal/process/memory_pressure').setup();
     NativeModule.require('internal/process/next_tick').setup();
     NativeModule.require('internal/process/stdio').setup();
     _process.setupKillAndExit();
     _process.setupSignalHandlers();
+    if (NativeModule._codeCache !== null)
+      process.on('exit', NativeModule.saveCodeCache);
 
     // Do not initialize channel in debugger agent, it deletes env variable
     // and the main thread won't see it.
@@ -64,6 +71,11 @@
 
     process.argv[0] = process.execPath;
 
+    if (traceStartup) {
+      traceLine(`bootstrap: ${formatTime(traceNow() - startupStart)}, ` +
+                `${process.moduleLoadList.length} modules and bindings`);
+    }
+
     // There are various modes that Node can run in. The most common two
     // are running from a script and running the REPL - but there are a few
     // others like the debugger or running --eval arguments. Here we decide
@@ -92,6 +104,21 @@
     } else if (process.profProcess) {
       NativeModule.require('internal/v8_prof_processor');
 
+    } else if (!process.binding('worker').isMainThread) {
+      // A worker runs its script and nothing else, the flags on the command
+      // line of the process are not meant for it.
+      NativeModule.require('worker')._setupChild();
+      process.argv[1] = NativeModule.require('path').resolve(process.argv[1]);
+      NativeModule.require('module').runMain();
+
+    } else if (!process.argv[1] && process._eval == null &&
+               process.env.NODE_ZYGOTE_CHILD && process.send) {
+      // A pre-started process of child_process.createZygote(), it waits for
+      // the module to run on its IPC channel.
+      delete process.env.NODE_ZYGOTE_CHILD;
+      preloadModules();
+      NativeModule.require('internal/zygote').setupChild();
+
     } else {
       // There is user code to be run
 
@@ -245,13 +272,31 @@
   }
 
   function setupGlobalTimeouts() {
-    const timers = NativeModule.require('timers');
-    global.clearImmediate = timers.clearImmediate;
-    global.clearInterval = timers.clearInterval;
-    global.clearTimeout = timers.clearTimeout;
-    global.setImmediate = timers.setImmediate;
-    global.setInterval = timers.setInterval;
-    global.setTimeout = timers.setTimeout;
+    // Loading the timers module is deferred until a timer function is
+    // first used.  The accessors turn themselves back into plain data
+    // properties on first access, so assigning over them still works.
+    const names = ['clearImmediate', 'clearInterval', 'clearTimeout',
+                   'setImmediate', 'setInterval', 'setTimeout'];
+    names.forEach(function(name) {
+      function define(value) {
+        Object.defineProperty(global, name, {
+          configurable: true,
+          enumerable: true,
+          writable: true,
+          value: value
+        });
+      }
+      Object.defineProperty(global, name, {
+        configurable: true,
+        enumerable: true,
+        get() {
+          const value = NativeModule.require('timers')[name];
+          define(value);
+          return value;
+        },
+        set: define
+      });
+    });
   }
 
   function setupGlobalConsole() {
@@ -352,6 +397,31 @@
     return script.runInThisContext();
   }
 
+  // --trace-startup prints how long it takes to compile and evaluate each
+  // core module.  process.hrtime and process._rawDebug are still the raw
+  // bindings at this point; they are wrapped by lib/internal/process.js.
+  const traceStartup = process._traceStartup === true;
+  const rawHrtime = process.hrtime;
+  const rawDebug = process._rawDebug;
+  const hrValues = traceStartup ? new Uint32Array(3) : null;
+  var traceDepth = 0;
+  var traceChildTime = 0;
+
+  // Returns the time in milliseconds.
+  function traceNow() {
+    rawHrtime(hrValues);
+    return (hrValues[0] * 0x100000000 + hrValues[1]) * 1e3 +
+           hrValues[2] / 1e6;
+  }
+
+  function formatTime(ms) {
+    return `${ms.toFixed(3)} ms`;
+  }
+
+  function traceLine(line) {
+    rawDebug(`[startup] ${'  '.repeat(traceDepth)}${line}`);
+  }
+
   function NativeModule(id) {
     this.filename = `${id}.js`;
     this.id = id;
@@ -362,6 +432,128 @@
   NativeModule._source = process.binding('natives');
   NativeModule._cache = {};
 
+  // With NODE_CODE_CACHE_DIR set, the code cache for the core modules lives
+  // in a single file per node version: a list of (id, cached data) pairs,
+  // every length a 32-bit little endian integer.  It is read here, before
+  // anything else is compiled, and rewritten on exit when modules were
+  // compiled without usable cached data.
+  const codeCacheDir = process.env.NODE_CODE_CACHE_DIR;
+  NativeModule._codeCache = null;
+  NativeModule._codeCacheMisses = [];
+
+  function readUInt32(bytes, offset) {
+    return (bytes[offset] | bytes[offset + 1] << 8 |
+            bytes[offset + 2] << 16) + bytes[offset + 3] * 0x1000000;
+  }
+
+  NativeModule.codeCacheFile = function() {
+    const name = `node-${process.version}-${process.arch}.cache`;
+    return codeCacheDir.replace(/[\\/]*$/, '/') + name;
+  };
+
+  // Only the fs binding is available this early; it accepts typed arrays.
+  function readCodeCache() {
+    const fs = process.binding('fs');
+    var fd;
+    try {
+      fd = fs.open(NativeModule.codeCacheFile(), 0 /* O_RDONLY */, 0);
+    } catch (e) {
+      return {};
+    }
+    var bytes = new Uint8Array(1024 * 1024);
+    var length = 0;
+    try {
+      for (;;) {
+        if (length === bytes.length) {
+          const grown = new Uint8Array(bytes.length * 2);
+          grown.set(bytes);
+          bytes = grown;
+        }
+        const n = fs.read(fd, bytes, length, bytes.length - length, -1);
+        if (n === 0)
+          break;
+        length += n;
+      }
+    } catch (e) {
+      length = 0;
+    } finally {
+      fs.close(fd);
+    }
+
+    const cache = {};
+    var offset = 0;
+    while (offset + 4 <= length) {
+      const idLength = readUInt32(bytes, offset);
+      if (offset + 4 + idLength + 4 > length)
+        break;
+      const id = String.fromCharCode.apply(
+          null, bytes.subarray(offset + 4, offset + 4 + idLength));
+      offset += 4 + idLength;
+      const dataLength = readUInt32(bytes, offset);
+      if (offset + 4 + dataLength > length)
+        break;
+      cache[id] = bytes.subarray(offset + 4, offset + 4 + dataLength);
+      offset += 4 + dataLength;
+    }
+    return cache;
+  }
+
+  if (codeCacheDir)
+    NativeModule._codeCache = readCodeCache();
+
+  // Code cache compiled into the binary, see tools/generate_code_cache.js.
+  // Empty unless node was configured with --code-cache-path.
+  NativeModule._embeddedCodeCache = process.binding('code_cache');
+
+  // Producing cached data creates a Buffer, which needs the buffer module, so
+  // it is done at exit, by compiling the missing modules once more.
+  NativeModule.saveCodeCache = function() {
+    const misses = NativeModule._codeCacheMisses;
+    if (misses.length === 0)
+      return;
+    NativeModule._codeCacheMisses = [];
+
+    const cache = NativeModule._codeCache;
+    for (var i = 0; i < misses.length; i++) {
+      const id = misses[i];
+      const script = new ContextifyScript(
+          NativeModule.wrap(NativeModule.getSource(id)),
+          { filename: `${id}.js`, produceCachedData: true });
+      if (script.cachedDataProduced)
+        cache[id] = script.cachedData;
+    }
+
+    const Buffer = NativeModule.require('buffer').Buffer;
+    const fs = NativeModule.require('fs');
+    const chunks = [];
+    for (const id in cache) {
+      const header = Buffer.allocUnsafe(4);
+      header.writeUInt32LE(id.length, 0);
+      chunks.push(header, Buffer.from(id));
+      const data = Buffer.from(cache[id].buffer,
+                               cache[id].byteOffset,
+                               cache[id].byteLength);
+      const dataHeader = Buffer.allocUnsafe(4);
+      dataHeader.writeUInt32LE(data.length, 0);
+      chunks.push(dataHeader, data);
+    }
+
+    // Concurrent processes must never see a partial file.
+    const file = NativeModule.codeCacheFile();
+    const tmp = `${file}.${process.pid}.tmp`;
+    try {
+      try {
+        fs.mkdirSync(codeCacheDir);
+      } catch (e) {
+        if (e.code !== 'EEXIST') throw e;
+      }
+      fs.writeFileSync(tmp, Buffer.concat(chunks));
+      fs.renameSync(tmp, file);
+    } catch (e) {
+      // The cache is best effort.
+    }
+  };
+
   NativeModule.require = function(id) {
     if (id == 'native_module') {
       return NativeModule;
@@ -429,19 +621,63 @@
   ];
 
   NativeModule.prototype.compile = function() {
+    const start = traceStartup ? traceNow() : 0;
     var source = NativeModule.getSource(this.id);
     source = NativeModule.wrap(source);
 
-    var fn = runInThisContext(source, {
-      filename: this.filename,
-      lineOffset: 0,
-      displayErrors: true
-    });
+    var fn;
+    if (NativeModule._codeCache !== null ||
+        NativeModule._embeddedCodeCache[this.id] !== undefined) {
+      fn = this.compileWithCodeCache(source);
+    } else {
+      fn = runInThisContext(source, {
+        filename: this.filename,
+        lineOffset: 0,
+        displayErrors: true
+      });
+    }
+
+    if (!traceStartup) {
+      fn(this.exports, NativeModule.require, this, this.filename);
+      this.loaded = true;
+      return;
+    }
+
+    // Modules required while this one is evaluated are reported on their
+    // own, nested below it, and not counted in its evaluation time.
+    const compiled = traceNow();
+    const outerChildTime = traceChildTime;
+    traceChildTime = 0;
+    traceDepth += 1;
     fn(this.exports, NativeModule.require, this, this.filename);
+    traceDepth -= 1;
+    const end = traceNow();
+    traceLine(`${this.id}: compile ${formatTime(compiled - start)}, ` +
+              `evaluate ${formatTime(end - compiled - traceChildTime)}`);
+    traceChildTime = outerChildTime + (end - start);
 
     this.loaded = true;
   };
 
+  NativeModule.prototype.compileWithCodeCache = function(source) {
+    const diskCache = NativeModule._codeCache;
+    var cachedData = diskCache !== null ? diskCache[this.id] : undefined;
+    if (cachedData === undefined)
+      cachedData = NativeModule._embeddedCodeCache[this.id];
+    const script = new ContextifyScript(source, {
+      filename: this.filename,
+      lineOffset: 0,
+      displayErrors: true,
+      cachedData: cachedData
+    });
+    if (diskCache !== null &&
+        (cachedData === undefined || script.cachedDataRejected === true)) {
+      delete diskCache[this.id];
+      NativeModule._codeCacheMisses.push(this.id);
+    }
+    return script.runInThisContext();
+  };
+
   NativeModule.prototype.cache = function() {
     NativeModule._cache[this.id] = this;
   };
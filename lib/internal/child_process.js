@@ -11,12 +11,19 @@ const assert = require('assert');
 
 const Process = process.binding('process_wrap').Process;
 const WriteWrap = process.binding('stream_wrap').WriteWrap;
+const writeInfo = process.binding('stream_wrap').writeInfo;
+// Index into writeInfo, see Environment::WriteInfo.
+const kLastWriteWasAsync = 1;
 const uv = process.binding('uv');
 const Pipe = process.binding('pipe_wrap').Pipe;
+// How many handles one message can carry.
+const kMaxHandles = Pipe.kMaxHandles;
 const TTY = process.binding('tty_wrap').TTY;
 const TCP = process.binding('tcp_wrap').TCP;
 const UDP = process.binding('udp_wrap').UDP;
+const serdes = process.binding('serdes');
 const SocketList = require('internal/socket_list');
+const sharedRing = require('internal/shared_ring');
 
 const errnoException = util._errnoException;
 const SocketListSend = SocketList.SocketListSend;
@@ -259,6 +266,10 @@ ChildProcess.prototype.spawn = function(options) {
   var ipcFd;
   // If no `stdio` option was given - use default
   var stdio = options.stdio || 'pipe';
+  const serialization = options.serialization || 'json';
+
+  if (serialization !== 'json' && serialization !== 'binary')
+    throw new TypeError('"serialization" must be "json" or "binary"');
 
   stdio = _validateStdio(stdio, false);
 
@@ -270,6 +281,10 @@ ChildProcess.prototype.spawn = function(options) {
     // Let child process know about opened IPC channel
     options.envPairs = options.envPairs || [];
     options.envPairs.push('NODE_CHANNEL_FD=' + ipcFd);
+    if (serialization !== 'json') {
+      options.envPairs.push('NODE_CHANNEL_SERIALIZATION_MODE=' +
+                            serialization);
+    }
   }
 
   this.spawnfile = options.file;
@@ -338,7 +353,7 @@ ChildProcess.prototype.spawn = function(options) {
   });
 
   // Add .send() method and start listening for IPC data
-  if (ipc !== undefined) setupChannel(this, ipc);
+  if (ipc !== undefined) setupChannel(this, ipc, serialization);
 
   return err;
 };
@@ -397,9 +412,11 @@ ChildProcess.prototype.unref = function() {
 };
 
 
-function setupChannel(target, channel) {
+function setupChannel(target, channel, serialization) {
   target._channel = channel;
   target._handleQueue = null;
+  target._sharedRings = {};
+  target._sharedRingId = 0;
 
   const control = new class extends EventEmitter {
     constructor() {
@@ -420,12 +437,47 @@ function setupChannel(target, channel) {
     }
   };
 
+  const binary = serialization === 'binary';
   var decoder = new StringDecoder('utf8');
   var jsonBuffer = '';
+  var pending = null;
+  // Handles that came in and wait for their message, in order.
+  var pendingHandles = [];
+  // The handles of a send() of several of them, when they come one by one.
+  var handleParts = [];
   channel.buffering = false;
   channel.onread = function(nread, pool, recvHandle) {
     // TODO(bnoordhuis) Check that nread > 0.
-    if (pool) {
+    if (pool && binary) {
+      if (pending !== null) {
+        pool = Buffer.concat([pending, pool]);
+        pending = null;
+      }
+      // The handle comes with the first chunk of its message, which need
+      // not be the chunk that completes it.
+      if (recvHandle)
+        pendingHandles.push(recvHandle);
+
+      // Every message is preceded by its length.
+      var offset = 0;
+      while (pool.length - offset >= serdes.kHeaderSize) {
+        const size = pool.readUInt32LE(offset, true);
+        if (pool.length - offset - serdes.kHeaderSize < size)
+          break;
+        const message = serdes.deserialize(pool,
+                                           offset + serdes.kHeaderSize,
+                                           size);
+        offset += serdes.kHeaderSize + size;
+
+        handleMessage(target, message, takeHandles(message));
+      }
+      if (offset < pool.length)
+        pending = pool.slice(offset);
+      this.buffering = pending !== null;
+
+    } else if (pool) {
+      if (recvHandle)
+        pendingHandles.push(recvHandle);
       jsonBuffer += decoder.write(pool);
 
       var i, start = 0;
@@ -434,14 +486,7 @@ function setupChannel(target, channel) {
       while ((i = jsonBuffer.indexOf('\n', start)) >= 0) {
         var json = jsonBuffer.slice(start, i);
         var message = JSON.parse(json);
-
-        // There will be at most one NODE_HANDLE message in every chunk we
-        // read because SCM_RIGHTS messages don't get coalesced. Make sure
-        // that we deliver the handle with the right message however.
-        if (message && message.cmd === 'NODE_HANDLE')
-          handleMessage(target, message, recvHandle);
-        else
-          handleMessage(target, message, undefined);
+        handleMessage(target, message, takeHandles(message));
 
         start = i + 1;
       }
@@ -458,6 +503,28 @@ function setupChannel(target, channel) {
     }
   };
 
+  // The handles that belong to a message: one for NODE_HANDLE, all of them
+  // for NODE_HANDLES.  A read hands out one handle, the others of a message
+  // with several wait in the channel.
+  function takeHandles(message) {
+    if (!message || typeof message.cmd !== 'string')
+      return undefined;
+    if (message.cmd === 'NODE_HANDLE')
+      return pendingHandles.shift();
+    if (message.cmd !== 'NODE_HANDLES' || !Array.isArray(message.handles))
+      return undefined;
+
+    const count = message.handles.length;
+    const handles = pendingHandles.splice(0, count);
+    while (handles.length < count) {
+      const handle = channel.acceptPending();
+      if (!handle)
+        break;
+      handles.push(handle);
+    }
+    return handles;
+  }
+
   // object where socket lists will live
   channel.sockets = { got: {}, send: {} };
 
@@ -480,6 +547,17 @@ function setupChannel(target, channel) {
       return;
     }
 
+    if (message.cmd === 'NODE_SHARED_RING' ||
+        message.cmd === 'NODE_SHARED_RING_ACK') {
+      sharedRing.handleRingMessage(target, message, handle);
+      return;
+    }
+
+    if (message.cmd === 'NODE_HANDLES') {
+      gotHandles(target, message, handle);
+      return;
+    }
+
     if (message.cmd !== 'NODE_HANDLE') return;
 
     // Acknowledge handle receival. Don't emit error events (for example if
@@ -488,6 +566,13 @@ function setupChannel(target, channel) {
     // a message.
     target._send({ cmd: 'NODE_HANDLE_ACK' }, null, true);
 
+    // One of several handles that are sent without writeHandles(), the
+    // NODE_HANDLES message that follows them hands them out.
+    if (message.msg && message.msg.cmd === 'NODE_HANDLES_PART') {
+      handleParts.push({ message: message, handle: handle });
+      return;
+    }
+
     var obj = handleConversion[message.type];
 
     // Update simultaneous accepts on Windows
@@ -502,6 +587,41 @@ function setupChannel(target, channel) {
     });
   });
 
+  // Converts the handles of a NODE_HANDLES message and emits the message
+  // with the Array of them, in the order in which they were sent.
+  function gotHandles(target, message, handles) {
+    var types;
+    if (Array.isArray(message.handles)) {
+      // They came with the message, it waits for one ACK.
+      target._send({ cmd: 'NODE_HANDLE_ACK' }, null, true);
+      types = message.handles;
+    } else {
+      types = handleParts.map((part) => part.message);
+      handles = handleParts.map((part) => part.handle);
+      handleParts = [];
+    }
+
+    const result = new Array(handles.length);
+    var left = handles.length;
+    if (left === 0)
+      return handleMessage(target, message.msg, result);
+
+    handles.forEach(function(handle, i) {
+      // Update simultaneous accepts on Windows
+      if (process.platform === 'win32') {
+        handle._simultaneousAccepts = false;
+        net._setSimultaneousAccepts(handle);
+      }
+
+      const obj = handleConversion[types[i].type];
+      obj.got.call(target, types[i], handle, function(handle) {
+        result[i] = handle;
+        if (--left === 0)
+          handleMessage(target, message.msg, result);
+      });
+    });
+  }
+
   target.send = function(message, handle, options, callback) {
     if (typeof handle === 'function') {
       callback = handle;
@@ -529,6 +649,10 @@ function setupChannel(target, channel) {
     return false;
   };
 
+  target.createSharedRing = function(options) {
+    return sharedRing.createSharedRing(this, options);
+  };
+
   target._send = function(message, handle, options, callback) {
     assert(this.connected || this._channel);
 
@@ -540,29 +664,18 @@ function setupChannel(target, channel) {
       options = {swallowErrors: options};
     }
 
+    if (Array.isArray(handle))
+      return this._sendHandles(message, handle, options, callback);
+
     // package messages with a handle object
     if (handle) {
       // this message will be handled by an internalMessage event handler
       message = {
         cmd: 'NODE_HANDLE',
-        type: null,
+        type: handleType(handle),
         msg: message
       };
 
-      if (handle instanceof net.Socket) {
-        message.type = 'net.Socket';
-      } else if (handle instanceof net.Server) {
-        message.type = 'net.Server';
-      } else if (handle instanceof TCP || handle instanceof Pipe) {
-        message.type = 'net.Native';
-      } else if (handle instanceof dgram.Socket) {
-        message.type = 'dgram.Socket';
-      } else if (handle instanceof UDP) {
-        message.type = 'dgram.Native';
-      } else {
-        throw new TypeError('This handle type can\'t be sent');
-      }
-
       // Queue-up message and handle if we haven't received ACK yet.
       if (this._handleQueue) {
         this._handleQueue.push({
@@ -604,19 +717,114 @@ function setupChannel(target, channel) {
     }
 
     var req = new WriteWrap();
-    req.async = false;
 
-    var string = JSON.stringify(message) + '\n';
-    var err = channel.writeUtf8String(req, string, handle);
+    var err;
+    if (binary) {
+      // serialize() throws for values that can't be cloned.
+      req.buffer = serdes.serialize(message);
+      err = channel.writeBuffer(req, req.buffer, handle);
+    } else {
+      var string = JSON.stringify(message) + '\n';
+      err = channel.writeUtf8String(req, string, handle);
+    }
 
+    if (err === 0 && handle && !this._handleQueue)
+      this._handleQueue = [];
+    afterSend(this, req, err, options, callback, function() {
+      if (obj && obj.postSend)
+        obj.postSend(handle, options);
+    });
+
+    /* If the master is > 2 read() calls behind, please stop sending. */
+    return channel.writeQueueSize < (65536 * 2);
+  };
+
+  // Sends several handles with one message, which waits for one ACK
+  // instead of one for every handle.
+  target._sendHandles = function(message, handles, options, callback) {
+    if (handles.length > kMaxHandles) {
+      throw new RangeError(`At most ${kMaxHandles} handles can be sent ` +
+                           'at once');
+    }
+    const types = handles.map(handleType);
+    if (handles.length === 0)
+      return this._send(message, null, options, callback);
+
+    if (this._handleQueue) {
+      this._handleQueue.push({
+        callback: callback,
+        handle: handles,
+        options: options,
+        message: message,
+      });
+      return this._handleQueue.length === 1;
+    }
+
+    // Without writeHandles() every handle is sent on its own, with its own
+    // ACK, and the message follows them.
+    if (typeof channel.writeHandles !== 'function') {
+      handles.forEach((handle) => {
+        this._send({ cmd: 'NODE_HANDLES_PART' }, handle, options);
+      });
+      return this._send({ cmd: 'NODE_HANDLES', msg: message }, null, options,
+                        callback);
+    }
+
+    const sent = [];
+    const natives = [];
+    handles.forEach((handle, i) => {
+      const obj = handleConversion[types[i]];
+      const meta = { type: types[i] };
+      const native = obj.send.call(this, meta, handle, options);
+      // Handles that can't be sent, for example sockets that were sent
+      // already, are left out.
+      if (!native)
+        return;
+      if (obj.simultaneousAccepts)
+        net._setSimultaneousAccepts(native);
+      sent.push(meta);
+      natives.push(native);
+    });
+
+    if (natives.length === 0)
+      return this._send(message, null, options, callback);
+
+    message = {
+      cmd: 'NODE_HANDLES',
+      handles: sent,
+      msg: message
+    };
+
+    var req = new WriteWrap();
+    // serialize() throws for values that can't be cloned.
+    if (binary)
+      req.buffer = serdes.serialize(message);
+    else
+      req.buffer = Buffer.from(JSON.stringify(message) + '\n');
+    const err = channel.writeHandles(req, req.buffer, natives);
+
+    if (err === 0)
+      this._handleQueue = [];
+    afterSend(this, req, err, options, callback, function() {
+      natives.forEach((native, i) => {
+        const obj = handleConversion[sent[i].type];
+        if (obj.postSend)
+          obj.postSend(native, options);
+      });
+    });
+
+    return channel.writeQueueSize < (65536 * 2);
+  };
+
+  // Completes a write of _send() or _sendHandles().  cleanup() lets go of
+  // the handles that were sent, once they are written or failed to be.
+  function afterSend(target, req, err, options, callback, cleanup) {
     if (err === 0) {
-      if (handle && !this._handleQueue)
-        this._handleQueue = [];
+      req.async = writeInfo[kLastWriteWasAsync] === 1;
       req.oncomplete = function() {
         if (this.async === true)
           control.unref();
-        if (obj && obj.postSend)
-          obj.postSend(handle, options);
+        cleanup();
         if (typeof callback === 'function')
           callback(null);
       };
@@ -627,22 +835,18 @@ function setupChannel(target, channel) {
       }
     } else {
       // Cleanup handle on error
-      if (obj && obj.postSend)
-        obj.postSend(handle, options);
+      cleanup();
 
       if (!options.swallowErrors) {
         const ex = errnoException(err, 'write');
         if (typeof callback === 'function') {
           process.nextTick(callback, ex);
         } else {
-          this.emit('error', ex);  // FIXME(bnoordhuis) Defer to next tick.
+          target.emit('error', ex);  // FIXME(bnoordhuis) Defer to next tick.
         }
       }
     }
-
-    /* If the master is > 2 read() calls behind, please stop sending. */
-    return channel.writeQueueSize < (65536 * 2);
-  };
+  }
 
   // connected will be set to false immediately when a disconnect() is
   // requested, even though the channel might still be alive internally to
@@ -702,6 +906,21 @@ function setupChannel(target, channel) {
 }
 
 
+function handleType(handle) {
+  if (handle instanceof net.Socket)
+    return 'net.Socket';
+  if (handle instanceof net.Server)
+    return 'net.Server';
+  if (handle instanceof TCP || handle instanceof Pipe)
+    return 'net.Native';
+  if (handle instanceof dgram.Socket)
+    return 'dgram.Socket';
+  if (handle instanceof UDP)
+    return 'dgram.Native';
+  throw new TypeError('This handle type can\'t be sent');
+}
+
+
 const INTERNAL_PREFIX = 'NODE_';
 function handleMessage(target, message, handle) {
   if (!target._channel)
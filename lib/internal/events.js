@@ -0,0 +1,62 @@
+'use strict';
+
+// Fixed-arity versions of EventEmitter#emit() for the events that core
+// streams emit for every chunk, like 'data' and 'readable'.  They don't
+// touch `arguments` and skip the 'error' and domain handling of emit(), so
+// they are only used for emitters that have no domain and still have the
+// default emit().  Emitters with an emit() of their own, or an emit() that
+// was patched into EventEmitter.prototype, get the event through their
+// emit().  Never use these for 'error'.
+
+// The original EventEmitter.prototype.emit, set by lib/events.js.
+var defaultEmit = null;
+
+function setDefaultEmit(emit) {
+  defaultEmit = emit;
+}
+exports.setDefaultEmit = setDefaultEmit;
+
+
+function emitNone(emitter, type) {
+  if (emitter.emit !== defaultEmit || emitter.domain)
+    return emitter.emit(type);
+
+  const events = emitter._events;
+  if (!events)
+    return false;
+  const handler = events[type];
+  if (!handler)
+    return false;
+
+  if (typeof handler === 'function') {
+    handler.call(emitter);
+  } else {
+    // The array is never modified, see lib/events.js.
+    for (var i = 0; i < handler.length; ++i)
+      handler[i].call(emitter);
+  }
+  return true;
+}
+exports.emitNone = emitNone;
+
+
+function emitOne(emitter, type, arg) {
+  if (emitter.emit !== defaultEmit || emitter.domain)
+    return emitter.emit(type, arg);
+
+  const events = emitter._events;
+  if (!events)
+    return false;
+  const handler = events[type];
+  if (!handler)
+    return false;
+
+  if (typeof handler === 'function') {
+    handler.call(emitter, arg);
+  } else {
+    for (var i = 0; i < handler.length; ++i)
+      handler[i].call(emitter, arg);
+  }
+  return true;
+}
+exports.emitOne = emitOne;
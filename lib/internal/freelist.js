@@ -15,6 +15,17 @@ exports.FreeList.prototype.alloc = function() {
 };
 
 
+// Empties the list, |dispose| is called with every object in it.
+exports.FreeList.prototype.clear = function(dispose) {
+  const list = this.list;
+  this.list = [];
+  if (typeof dispose === 'function') {
+    for (var i = 0; i < list.length; i++)
+      dispose(list[i]);
+  }
+};
+
+
 exports.FreeList.prototype.free = function(obj) {
   if (this.list.length < this.max) {
     this.list.push(obj);
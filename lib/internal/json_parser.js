@@ -0,0 +1,71 @@
+'use strict';
+
+const Writable = require('stream').Writable;
+const util = require('util');
+const binding = process.binding('json_parser');
+
+// Chunks below this size are scanned on the main thread even in threadpool
+// mode, handing them over would cost more than it saves.
+const kThreadpoolThreshold = 16 * 1024;
+
+function JSONParser(options) {
+  if (!(this instanceof JSONParser))
+    return new JSONParser(options);
+
+  options = options || {};
+  Writable.call(this, { highWaterMark: options.highWaterMark });
+
+  this._handle = new binding.JSONParser();
+  this._handle.oncomplete = oncomplete;
+  this._handle.owner = this;
+  this._handle.buffer = null;
+  this._handle.callback = null;
+  this._threadpool = !!options.threadpool;
+  this._failed = false;
+  this.value = undefined;
+
+  this.once('prefinish', onprefinish);
+}
+util.inherits(JSONParser, Writable);
+
+JSONParser.prototype._write = function(chunk, encoding, cb) {
+  if (this._failed)
+    return cb();
+  const handle = this._handle;
+  if (this._threadpool && chunk.length >= kThreadpoolThreshold) {
+    handle.buffer = chunk;
+    handle.callback = cb;
+    handle.pushAsync(chunk);
+    return;
+  }
+  afterPush(this, handle.push(chunk), cb);
+};
+
+// The 'error' of a failed write is the only one, end() does not report the
+// same error again.
+function afterPush(self, err, cb) {
+  if (err)
+    self._failed = true;
+  cb(err);
+}
+
+function oncomplete(err) {
+  const cb = this.callback;
+  this.buffer = null;
+  this.callback = null;
+  afterPush(this.owner, err, cb);
+}
+
+function onprefinish() {
+  if (this._failed)
+    return;
+  const err = this._handle.finish();
+  if (err)
+    return this.emit('error', err);
+  this.value = this._handle.getValue();
+  this.emit('value', this.value);
+}
+
+module.exports = {
+  JSONParser: JSONParser
+};
@@ -54,7 +54,7 @@ function stripBOM(content) {
 exports.builtinLibs = ['assert', 'buffer', 'child_process', 'cluster',
   'crypto', 'dgram', 'dns', 'domain', 'events', 'fs', 'http', 'https', 'net',
   'os', 'path', 'punycode', 'querystring', 'readline', 'repl', 'stream',
-  'string_decoder', 'tls', 'tty', 'url', 'util', 'v8', 'vm', 'zlib'];
+  'string_decoder', 'tls', 'tty', 'url', 'util', 'v8', 'vm', 'worker', 'zlib'];
 
 function addBuiltinLibsToObject(object) {
   // Make built-in modules available directly (loaded lazily).
@@ -0,0 +1,190 @@
+'use strict';
+
+// Module archives are zip files that the module loader treats as read-only
+// directories: once /app/bundle.zip is mounted, require('/app/bundle.zip/a')
+// loads the entry "a.js" from it.  An archive is memory-mapped and its
+// central directory indexed when it is mounted, so that resolving and
+// loading modules from it doesn't make any further system calls.  Entries
+// must be stored or deflated; zip64, multi-disk and encrypted archives are
+// not supported.
+
+const fs = require('fs');
+const path = require('path');
+const UV_ENOENT = process.binding('uv').UV_ENOENT;
+
+exports = module.exports = {
+  mount,
+  contains,
+  stat,
+  readFile,
+  mounted: false
+};
+
+const archives = [];
+
+const kEndOfCentralDirectory = 0x06054b50;
+const kCentralDirectoryEntry = 0x02014b50;
+const kLocalFileHeader = 0x04034b50;
+const kStored = 0;
+const kDeflated = 8;
+
+function Archive(filename, data) {
+  this.path = filename;
+  this.prefix = filename + path.sep;
+  this.data = data;
+  this.files = new Map();
+  this.dirs = new Set();
+}
+
+function invalid(filename, reason) {
+  return new Error(`Invalid module archive ${filename}: ${reason}`);
+}
+
+function map(filename) {
+  const fd = fs.openSync(filename, 'r');
+  try {
+    return fs.mmap(fd);
+  } catch (e) {
+    // fs.mmap() is not available on Windows.
+    if (e.code !== 'ENOSYS') throw e;
+    return fs.readFileSync(filename);
+  } finally {
+    fs.closeSync(fd);
+  }
+}
+
+function findEndOfCentralDirectory(data) {
+  // The record is 22 bytes, followed by a comment of up to 64 KB.
+  const last = Math.max(0, data.length - 22 - 0xffff);
+  for (var i = data.length - 22; i >= last; i--) {
+    if (data.readUInt32LE(i) === kEndOfCentralDirectory)
+      return i;
+  }
+  return -1;
+}
+
+function index(archive) {
+  const data = archive.data;
+  const end = findEndOfCentralDirectory(data);
+  if (end === -1)
+    throw invalid(archive.path, 'end of central directory not found');
+
+  const count = data.readUInt16LE(end + 10);
+  const size = data.readUInt32LE(end + 12);
+  var offset = data.readUInt32LE(end + 16);
+  if (count === 0xffff || offset === 0xffffffff)
+    throw invalid(archive.path, 'zip64 is not supported');
+  if (offset + size > end)
+    throw invalid(archive.path, 'bad central directory');
+
+  for (var i = 0; i < count; i++) {
+    if (offset + 46 > end ||
+        data.readUInt32LE(offset) !== kCentralDirectoryEntry) {
+      throw invalid(archive.path, 'bad central directory entry');
+    }
+    const flags = data.readUInt16LE(offset + 8);
+    const method = data.readUInt16LE(offset + 10);
+    const compressedSize = data.readUInt32LE(offset + 20);
+    const uncompressedSize = data.readUInt32LE(offset + 24);
+    const nameLength = data.readUInt16LE(offset + 28);
+    const extraLength = data.readUInt16LE(offset + 30);
+    const commentLength = data.readUInt16LE(offset + 32);
+    const headerOffset = data.readUInt32LE(offset + 42);
+    const name = data.toString('utf8', offset + 46, offset + 46 + nameLength);
+    offset += 46 + nameLength + extraLength + commentLength;
+
+    if (flags & 1)
+      throw invalid(archive.path, `${name} is encrypted`);
+
+    // Entry names are relative and use forward slashes.  Names that would
+    // point outside of the archive are ignored.
+    const parts = name.split('/').filter((part) => part !== '');
+    if (parts.length === 0 || name[0] === '/' || parts.indexOf('..') !== -1)
+      continue;
+
+    var dir = archive.path;
+    for (var j = 0; j < parts.length - 1; j++) {
+      dir += path.sep + parts[j];
+      archive.dirs.add(dir);
+    }
+    const filename = dir + path.sep + parts[parts.length - 1];
+    if (name[name.length - 1] === '/') {
+      archive.dirs.add(filename);
+    } else {
+      archive.files.set(filename, {
+        method: method,
+        headerOffset: headerOffset,
+        compressedSize: compressedSize,
+        uncompressedSize: uncompressedSize
+      });
+    }
+  }
+}
+
+// Mounts the archive at |filename|, which must be an absolute path.
+function mount(filename) {
+  const archive = new Archive(filename, map(filename));
+  index(archive);
+  archives.push(archive);
+  exports.mounted = true;
+}
+
+function find(filename) {
+  for (var i = 0; i < archives.length; i++) {
+    const archive = archives[i];
+    if (filename === archive.path || filename.startsWith(archive.prefix))
+      return archive;
+  }
+  return null;
+}
+
+// Returns true when |filename| is the path of an archive or of something
+// inside one.
+function contains(filename) {
+  return find(filename) !== null;
+}
+
+// Like internalModuleStat(): 0 for a file, 1 for a directory and
+// a negative number when |filename| doesn't exist in the archive.  Returns
+// undefined when |filename| is not inside an archive.
+function stat(filename) {
+  const archive = find(filename);
+  if (archive === null)
+    return undefined;
+  if (archive.files.has(filename))
+    return 0;
+  if (filename === archive.path || archive.dirs.has(filename))
+    return 1;
+  return UV_ENOENT;
+}
+
+// Returns the contents of |filename| as a string, undefined when it doesn't
+// exist in the archive.
+function readFile(filename) {
+  const archive = find(filename);
+  const entry = archive && archive.files.get(filename);
+  if (!entry)
+    return undefined;
+
+  const data = archive.data;
+  const header = entry.headerOffset;
+  if (header + 30 > data.length ||
+      data.readUInt32LE(header) !== kLocalFileHeader) {
+    throw invalid(archive.path, `bad local header for ${filename}`);
+  }
+  const start = header + 30 + data.readUInt16LE(header + 26) +
+                data.readUInt16LE(header + 28);
+  const end = start + entry.compressedSize;
+  if (end > data.length)
+    throw invalid(archive.path, `${filename} is truncated`);
+
+  if (entry.method === kStored)
+    return data.toString('utf8', start, end);
+  if (entry.method === kDeflated) {
+    const zlib = require('zlib');
+    return zlib.inflateRawSync(data.slice(start, end)).toString('utf8');
+  }
+  throw invalid(archive.path,
+                `${filename} uses unsupported compression method ` +
+                entry.method);
+}
@@ -1,6 +1,25 @@
 'use strict';
 
-module.exports = { isLegalPort, assertPort };
+const Buffer = require('buffer').Buffer;
+const ChunkList = require('buffer').ChunkList;
+const util = require('util');
+
+// Tags the zero-length Buffers that stand in for a range of a file in a
+// socket's write queue. See Socket.prototype.sendFile().
+const kSendFile = Symbol('sendFile');
+
+// Tags the ChunkLists that frame a Buffer as one chunk of the chunked
+// transfer coding. See ChunkedPayload.
+const kChunkedPayload = Symbol('chunkedPayload');
+
+module.exports = {
+  isLegalPort,
+  assertPort,
+  kSendFile,
+  fileChunk,
+  kChunkedPayload,
+  ChunkedPayload
+};
 
 // Check that the port number is not NaN when coerced to a number,
 // is an integer and that it falls within the legal range of port numbers.
@@ -16,3 +35,51 @@ function assertPort(port) {
   if (typeof port !== 'undefined' && !isLegalPort(port))
     throw new RangeError('"port" argument must be >= 0 and < 65536');
 }
+
+
+function isNonNegativeInteger(value) {
+  return typeof value === 'number' && value >= 0 &&
+         value <= Number.MAX_SAFE_INTEGER && Math.floor(value) === value;
+}
+
+
+// Returns a chunk that can be passed to socket.write() and that sends
+// `length` bytes of `fd`, starting at `offset`, when it reaches the socket.
+function fileChunk(fd, offset, length) {
+  if (!isNonNegativeInteger(fd) || fd > 0x7fffffff)
+    throw new TypeError('"fd" argument must be a file descriptor');
+  if (!isNonNegativeInteger(offset))
+    throw new TypeError('"offset" argument must be a non-negative integer');
+  if (!isNonNegativeInteger(length))
+    throw new TypeError('"length" argument must be a non-negative integer');
+  const chunk = Buffer.alloc(0);
+  chunk[kSendFile] = { fd, offset, length };
+  return chunk;
+}
+
+
+const crlf_buf = Buffer.from('\r\n');
+
+// A ChunkList of the size line, `payload` and a CRLF.  Sockets whose handle
+// has writeChunked() frame the payload natively, in the same write as the
+// data, so the Buffers of the list are only created for other streams.
+function ChunkedPayload(payload) {
+  this[kChunkedPayload] = payload;
+  this._chunks = null;
+  this.length = payload.length.toString(16).length + 4 + payload.length;
+}
+util.inherits(ChunkedPayload, ChunkList);
+
+Object.defineProperty(ChunkedPayload.prototype, 'chunks', {
+  configurable: true,
+  enumerable: true,
+  get: function() {
+    if (this._chunks === null) {
+      const payload = this[kChunkedPayload];
+      const sizeLine = Buffer.from(payload.length.toString(16) + '\r\n',
+                                   'latin1');
+      this._chunks = [sizeLine, payload, crlf_buf];
+    }
+    return this._chunks;
+  }
+});
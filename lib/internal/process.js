@@ -11,6 +11,9 @@ function lazyConstants() {
 
 exports.setup_cpuUsage = setup_cpuUsage;
 exports.setup_hrtime = setup_hrtime;
+exports.setupThreadpool = setupThreadpool;
+exports.setupAffinity = setupAffinity;
+exports.setupBusyPoll = setupBusyPoll;
 exports.setupConfig = setupConfig;
 exports.setupKillAndExit = setupKillAndExit;
 exports.setupSignalHandlers = setupSignalHandlers;
@@ -96,6 +99,125 @@ function setup_hrtime() {
       hrValues[2]
     ];
   };
+
+  // The forms below don't allocate, for measurements in tight loops.
+  process.hrtime.now = function now() {
+    _hrtime(hrValues);
+    return (hrValues[0] * 0x100000000 + hrValues[1]) * 1e6 +
+           hrValues[2] / 1e3;
+  };
+
+  process.hrtime.into = function into(array, index) {
+    if (!ArrayBuffer.isView(array) || array instanceof DataView)
+      throw new TypeError('"array" argument must be a TypedArray');
+    if (index === undefined)
+      index = 0;
+    if (!Number.isInteger(index) || index < 0 || index + 2 > array.length)
+      throw new RangeError('"index" argument is out of range');
+
+    _hrtime(hrValues);
+    array[index] = hrValues[0] * 0x100000000 + hrValues[1];
+    array[index + 1] = hrValues[2];
+    return array;
+  };
+}
+
+
+// Set up process.setThreadpoolSize(), process.getThreadpoolSize(),
+// process.setThreadpoolAffinity() and process.threadpoolStats().
+function setupThreadpool() {
+  const _setThreadpoolSize = process.setThreadpoolSize;
+  const _setThreadpoolAffinity = process.setThreadpoolAffinity;
+  const _getThreadpoolSize = process.getThreadpoolSize;
+  const _threadpoolStats = process.threadpoolStats;
+
+  // In the order of libuv's uv_threadpool_queue.
+  const queues = ['cpu', 'fs', 'dns', 'crypto'];
+
+  function queueIndex(queue) {
+    if (queue === undefined)
+      return 0;
+    const index = queues.indexOf(queue);
+    if (index === -1)
+      throw new TypeError('Unknown threadpool queue: ' + queue);
+    return index;
+  }
+
+  process.setThreadpoolSize = function setThreadpoolSize(size, queue) {
+    const index = queueIndex(queue);
+    if (size !== (size >>> 0) || _setThreadpoolSize(index, size) !== 0)
+      throw new RangeError('Invalid threadpool size: ' + size);
+  };
+
+  process.getThreadpoolSize = function getThreadpoolSize(queue) {
+    return _getThreadpoolSize(queueIndex(queue));
+  };
+
+  process.setThreadpoolAffinity = function setThreadpoolAffinity(cpus, queue) {
+    const index = queueIndex(queue);
+    if (!Array.isArray(cpus) && cpus !== null)
+      throw new TypeError('"cpus" argument must be an array or null');
+    const err = _setThreadpoolAffinity(index, cpus);
+    if (err !== 0)
+      throw require('util')._errnoException(err, 'setThreadpoolAffinity');
+  };
+
+  const statsValues = new Float64Array(queues.length * 9);
+
+  process.threadpoolStats = function threadpoolStats() {
+    _threadpoolStats(statsValues);
+    const result = {};
+    for (var i = 0; i < queues.length; i++) {
+      const offset = i * 9;
+      result[queues[i]] = {
+        submitted: statsValues[offset],
+        completed: statsValues[offset + 1],
+        queued: statsValues[offset + 2],
+        maxQueued: statsValues[offset + 3],
+        running: statsValues[offset + 4],
+        waitTime: statsValues[offset + 5],
+        maxWaitTime: statsValues[offset + 6],
+        runTime: statsValues[offset + 7],
+        maxRunTime: statsValues[offset + 8]
+      };
+    }
+    return result;
+  };
+}
+
+
+// Set up process.setAffinity() and process.getAffinity().
+function setupAffinity() {
+  const _setAffinity = process.setAffinity;
+  const _getAffinity = process.getAffinity;
+
+  process.setAffinity = function setAffinity(cpus) {
+    if (!Array.isArray(cpus))
+      throw new TypeError('"cpus" argument must be an array');
+    const err = _setAffinity(cpus);
+    if (err !== 0)
+      throw require('util')._errnoException(err, 'setAffinity');
+  };
+
+  process.getAffinity = function getAffinity() {
+    const cpus = _getAffinity();
+    if (typeof cpus === 'number')
+      throw require('util')._errnoException(cpus, 'getAffinity');
+    return cpus;
+  };
+}
+
+
+// Set up process.setBusyPoll().
+function setupBusyPoll() {
+  const _setBusyPoll = process.setBusyPoll;
+
+  process.setBusyPoll = function setBusyPoll(usecs) {
+    if (usecs !== (usecs >>> 0) || usecs > 1e6)
+      throw new RangeError('Invalid busy poll time: ' + usecs);
+    // Fails only where the event loop can't busy poll, where it's a no-op.
+    _setBusyPoll(usecs);
+  };
 }
 
 
@@ -198,7 +320,9 @@ function setupSignalHandlers() {
 
       wrap.unref();
 
-      wrap.onsignal = function() { process.emit(type); };
+      // Signals that arrive in the same loop iteration are counted and
+      // emitted once.
+      wrap.onsignal = function(signum, count) { process.emit(type, count); };
 
       var signum = lazyConstants()[type];
       var err = wrap.start(signum);
@@ -228,8 +352,12 @@ function setupChannel() {
     var fd = parseInt(process.env.NODE_CHANNEL_FD, 10);
     assert(fd >= 0);
 
+    const serialization =
+        process.env.NODE_CHANNEL_SERIALIZATION_MODE || 'json';
+
     // Make sure it's not accidentally inherited by child processes.
     delete process.env.NODE_CHANNEL_FD;
+    delete process.env.NODE_CHANNEL_SERIALIZATION_MODE;
 
     var cp = require('child_process');
 
@@ -238,7 +366,7 @@ function setupChannel() {
     // FIXME is this really necessary?
     process.binding('tcp_wrap');
 
-    cp._forkChild(fd);
+    cp._forkChild(fd, serialization);
     assert(process.send);
   }
 }
@@ -0,0 +1,34 @@
+'use strict';
+
+// Caches in lib/ register a handler that lets go of what they hold.  The
+// handlers run before the native pools are trimmed, so that a full garbage
+// collection at the critical level also frees what they dropped.
+const trimHandlers = [];
+
+exports.setup = setupMemoryPressure;
+exports.addTrimHandler = addTrimHandler;
+
+function addTrimHandler(fn) {
+  trimHandlers.push(fn);
+}
+
+function setupMemoryPressure() {
+  const binding = process.binding('memory_pressure');
+
+  // Called from --memory-pressure-threshold as well.
+  function onMemoryPressure(critical) {
+    for (var i = 0; i < trimHandlers.length; i++)
+      trimHandlers[i](critical);
+    binding.trim(critical);
+    process.emit('memoryPressure', critical ? 'critical' : 'moderate');
+  }
+  binding.setup(onMemoryPressure);
+
+  process.notifyMemoryPressure = function notifyMemoryPressure(level) {
+    if (level === undefined)
+      level = 'moderate';
+    if (level !== 'moderate' && level !== 'critical')
+      throw new TypeError('"level" must be "moderate" or "critical"');
+    onMemoryPressure(level === 'critical');
+  };
+}
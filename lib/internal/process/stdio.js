@@ -1,5 +1,7 @@
 'use strict';
 
+const Buffer = require('buffer').Buffer;
+
 exports.setup = setupStdio;
 
 function setupStdio() {
@@ -152,6 +154,14 @@ function createWritableStdioStream(fd) {
       throw new Error('Implement me. Unknown stream file type!');
   }
 
+  if (stream._type !== 'fs') {
+    stream.droppedBytes = 0;
+    stream._bufferLimit = Infinity;
+    stream._dropWrites = false;
+    stream.write = writeOrDrop;
+    stream.setBufferLimit = setBufferLimit;
+  }
+
   // For supporting legacy API we put the FD here.
   stream.fd = fd;
 
@@ -159,3 +169,49 @@ function createWritableStdioStream(fd) {
 
   return stream;
 }
+
+
+// Makes the writes of a TTY or pipe stdio stream non-blocking, and bounds
+// how much of them may wait to be written.  With the 'drop' policy, writes
+// that would go past the limit are left out whole.  With 'backpressure',
+// write() returns false once the limit is reached, and keeps the data.
+function setBufferLimit(limit, policy) {
+  if (typeof limit !== 'number' || !(limit >= 0))
+    throw new TypeError('"limit" must be a non-negative number');
+  if (policy === undefined)
+    policy = 'drop';
+  if (policy !== 'drop' && policy !== 'backpressure')
+    throw new TypeError('"policy" must be \'drop\' or \'backpressure\'');
+
+  // TTYs on Windows are always written synchronously, that fails and is
+  // fine.
+  if (this._handle && this._handle.setBlocking)
+    this._handle.setBlocking(false);
+
+  const state = this._writableState;
+  if (this._highWaterMark === undefined)
+    this._highWaterMark = state.highWaterMark;
+  this._bufferLimit = limit;
+  this._dropWrites = policy === 'drop' && limit !== Infinity;
+  state.highWaterMark = policy === 'backpressure' ? limit : this._highWaterMark;
+}
+
+function writeOrDrop(chunk, encoding, cb) {
+  if (this._dropWrites) {
+    var length = chunk.length;
+    if (typeof chunk === 'string') {
+      length = Buffer.byteLength(chunk, typeof encoding === 'string' ?
+                                        encoding :
+                                        this._writableState.defaultEncoding);
+    }
+    if (this.bufferSize + length > this._bufferLimit) {
+      this.droppedBytes += length;
+      if (typeof encoding === 'function')
+        cb = encoding;
+      if (typeof cb === 'function')
+        process.nextTick(cb);
+      return true;
+    }
+  }
+  return Object.getPrototypeOf(this).write.call(this, chunk, encoding, cb);
+}
@@ -0,0 +1,103 @@
+'use strict';
+
+const Buffer = require('buffer').Buffer;
+const util = require('util');
+
+const binding = process.binding('shared_cache');
+
+const errnoException = util._errnoException;
+
+module.exports = {
+  createSharedCache,
+  openSharedCache
+};
+
+
+// A hash table in shared memory that every process of a cluster maps.  Each
+// get() and set() takes the lock of one shard and copies the value in or out,
+// messages are never involved.
+function SharedCache(handle, name) {
+  this._handle = handle;
+  this.name = name;
+  this.maxEntrySize = handle.maxEntrySize();
+}
+
+
+function checkKey(key) {
+  if (typeof key !== 'string' && !(key instanceof Buffer))
+    throw new TypeError('"key" argument must be a string or Buffer');
+}
+
+
+function checkOpen(cache) {
+  if (cache._handle === null)
+    throw new Error('Cache is closed');
+}
+
+
+SharedCache.prototype.get = function(key) {
+  checkKey(key);
+  checkOpen(this);
+  return this._handle.get(key);
+};
+
+
+SharedCache.prototype.set = function(key, value) {
+  checkKey(key);
+  if (typeof value === 'string')
+    value = Buffer.from(value);
+  else if (!(value instanceof Buffer))
+    throw new TypeError('"value" argument must be a string or Buffer');
+  checkOpen(this);
+  return this._handle.set(key, value);
+};
+
+
+SharedCache.prototype.delete = function(key) {
+  checkKey(key);
+  checkOpen(this);
+  return this._handle.delete(key);
+};
+
+
+SharedCache.prototype.stats = function() {
+  checkOpen(this);
+  const totals = [];
+  this._handle.stats(totals);
+  return {
+    entries: totals[0],
+    hits: totals[1],
+    misses: totals[2],
+    evictions: totals[3]
+  };
+};
+
+
+SharedCache.prototype.close = function() {
+  if (this._handle === null)
+    return;
+  this._handle.unlink();
+  this._handle.close();
+  this._handle = null;
+};
+
+
+function createSharedCache(size) {
+  if (typeof size !== 'number' || !(size > 0))
+    throw new RangeError('"sharedCacheSize" must be a positive number');
+
+  const handle = new binding.SharedCache();
+  const name = handle.create(size);
+  if (typeof name === 'number')
+    throw errnoException(name, 'shm_open');
+  return new SharedCache(handle, name);
+}
+
+
+function openSharedCache(name) {
+  const handle = new binding.SharedCache();
+  const err = handle.open(name);
+  if (err)
+    throw errnoException(err, 'shm_open');
+  return new SharedCache(handle, name);
+}
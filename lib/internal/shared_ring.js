@@ -0,0 +1,242 @@
+'use strict';
+
+const Buffer = require('buffer').Buffer;
+const EventEmitter = require('events');
+const util = require('util');
+
+const Pipe = process.binding('pipe_wrap').Pipe;
+const WriteWrap = process.binding('stream_wrap').WriteWrap;
+const binding = process.binding('shared_ring');
+
+const errnoException = util._errnoException;
+
+const kDefaultSize = 1024 * 1024;
+
+// The content of a wakeup doesn't matter, only that there is one.
+const wakeup = Buffer.from([0]);
+
+module.exports = {
+  createSharedRing,
+  handleRingMessage
+};
+
+
+// A single-producer, single-consumer ring buffer in shared memory.  Both
+// ends hold one end of a socket pair that carries a byte when the other end
+// was waiting for messages or for space, and nothing otherwise.
+function SharedRing(handle, pipe, producer) {
+  EventEmitter.call(this);
+  this._handle = handle;
+  this._pipe = pipe;
+  this._producer = producer;
+  this._queue = [];
+  this._draining = false;
+  this.maxMessageSize = handle.maxMessageSize();
+
+  pipe.owner = this;
+  pipe.onread = onwakeup;
+  pipe.readStart();
+}
+util.inherits(SharedRing, EventEmitter);
+
+
+SharedRing.prototype.write = function(data) {
+  if (!this._producer)
+    throw new Error('Only the end that created the ring can write to it');
+  if (this._handle === null)
+    throw new Error('Ring is closed');
+
+  if (typeof data === 'string')
+    data = Buffer.from(data);
+  else if (!(data instanceof Buffer))
+    throw new TypeError('"data" argument must be a string or Buffer');
+
+  if (data.length > this.maxMessageSize)
+    throw new RangeError('"data" does not fit into the ring');
+
+  if (this._queue.length === 0 && push(this, data))
+    return true;
+  this._queue.push(data);
+  return false;
+};
+
+
+SharedRing.prototype.close = function() {
+  if (this._handle === null)
+    return;
+
+  this._handle.unlink();
+  this._handle.close();
+  this._handle = null;
+  this._queue = [];
+  this._pipe.close(() => this.emit('close'));
+};
+
+
+SharedRing.prototype.ref = function() {
+  if (this._handle !== null)
+    this._pipe.ref();
+};
+
+
+SharedRing.prototype.unref = function() {
+  if (this._handle !== null)
+    this._pipe.unref();
+};
+
+
+function push(ring, data) {
+  const result = ring._handle.write(data);
+  if (result === binding.kFull)
+    return false;
+  if (result === binding.kWrittenWake)
+    wake(ring);
+  return true;
+}
+
+
+function wake(ring) {
+  const req = new WriteWrap();
+  // A peer that went away is noticed by onwakeup().
+  ring._pipe.writeBuffer(req, wakeup);
+}
+
+
+function onwakeup(nread, buffer) {
+  const ring = this.owner;
+  if (ring._handle === null)
+    return;
+
+  if (nread < 0) {
+    // The other end is gone, deliver what it left behind.
+    if (!ring._producer) {
+      while (drain(ring) > 0);
+      ring.emit('end');
+    }
+    ring.close();
+    return;
+  }
+
+  if (ring._producer)
+    flush(ring);
+  else
+    drain(ring);
+}
+
+
+function flush(ring) {
+  if (ring._queue.length === 0)
+    return;
+  while (ring._queue.length > 0) {
+    if (!push(ring, ring._queue[0]))
+      return;
+    ring._queue.shift();
+  }
+  ring.emit('drain');
+}
+
+
+// Emits the messages that are in the ring.  If there were any, reads again
+// after other I/O had a chance to run instead of waiting for a wakeup; a
+// read that comes back empty arms the wakeup.
+function drain(ring) {
+  ring._draining = false;
+  if (ring._handle === null)
+    return 0;
+
+  const list = [];
+  if (ring._handle.read(list))
+    wake(ring);
+  for (var i = 0; i < list.length; i++)
+    ring.emit('data', list[i]);
+
+  if (list.length > 0 && !ring._draining && ring._handle !== null) {
+    ring._draining = true;
+    setImmediate(drain, ring);
+  }
+  return list.length;
+}
+
+
+function createSharedRing(target, options) {
+  if (options === undefined)
+    options = {};
+  else if (options === null || typeof options !== 'object')
+    throw new TypeError('"options" argument must be an object');
+
+  const size = options.size === undefined ? kDefaultSize : options.size;
+  if (typeof size !== 'number' || !(size > 0) || size > 0xffffffff)
+    throw new RangeError('"size" must be a positive number');
+
+  if (!target.connected)
+    throw new Error('channel closed');
+
+  const handle = new binding.SharedRing();
+  const name = handle.create(size >>> 0);
+  if (typeof name === 'number')
+    throw errnoException(name, 'shm_open');
+
+  const fds = [];
+  const err = binding.socketpair(fds);
+  if (err) {
+    handle.unlink();
+    handle.close();
+    throw errnoException(err, 'socketpair');
+  }
+
+  const local = new Pipe(false);
+  const remote = new Pipe(false);
+  local.open(fds[0]);
+  remote.open(fds[1]);
+
+  const ring = new SharedRing(handle, local, true);
+  const id = target._sharedRingId++;
+  target._sharedRings[id] = ring;
+
+  const message = { cmd: 'NODE_SHARED_RING', id, name };
+  target._send(message, remote, {}, function(err) {
+    remote.close();
+    if (err) {
+      delete target._sharedRings[id];
+      ring.close();
+      ring.emit('error', err);
+    }
+  });
+
+  return ring;
+}
+
+
+function handleRingMessage(target, message, handle) {
+  if (message.cmd === 'NODE_SHARED_RING_ACK') {
+    const ring = target._sharedRings[message.id];
+    if (ring === undefined)
+      return;
+    delete target._sharedRings[message.id];
+    if (ring._handle === null)
+      return;
+    // Both ends have it mapped now, the name is no longer needed.
+    ring._handle.unlink();
+    if (message.err) {
+      ring.close();
+      ring.emit('error', errnoException(message.err, 'shm_open'));
+    }
+    return;
+  }
+
+  const ringHandle = new binding.SharedRing();
+  const err = ringHandle.open(message.name);
+  target._send({ cmd: 'NODE_SHARED_RING_ACK', id: message.id, err },
+               null,
+               true);
+  if (err) {
+    handle.close();
+    return;
+  }
+
+  const ring = new SharedRing(ringHandle, handle, false);
+  if (target.listenerCount('sharedRing') === 0)
+    ring.close();
+  else
+    target.emit('sharedRing', ring);
+}
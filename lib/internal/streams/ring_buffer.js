@@ -0,0 +1,97 @@
+'use strict';
+
+const Buffer = require('buffer').Buffer;
+
+module.exports = RingBuffer;
+
+const kInitialCapacity = 16;
+
+// A double-ended queue in a power-of-two sized array that doubles when it is
+// full.  Unlike Array#shift(), taking from the front never moves the other
+// items, and the array is reused for as long as the queue lives.
+function RingBuffer() {
+  this._items = new Array(kInitialCapacity);
+  this._mask = kInitialCapacity - 1;
+  this._head = 0;
+  this.length = 0;
+}
+
+RingBuffer.prototype.push = function(item) {
+  if (this.length === this._items.length)
+    grow(this);
+  this._items[(this._head + this.length) & this._mask] = item;
+  this.length++;
+};
+
+RingBuffer.prototype.unshift = function(item) {
+  if (this.length === this._items.length)
+    grow(this);
+  this._head = (this._head - 1) & this._mask;
+  this._items[this._head] = item;
+  this.length++;
+};
+
+RingBuffer.prototype.shift = function() {
+  if (this.length === 0)
+    return undefined;
+  const item = this._items[this._head];
+  this._items[this._head] = undefined;
+  this._head = (this._head + 1) & this._mask;
+  this.length--;
+  return item;
+};
+
+// The item at `index`, counted from the front.
+RingBuffer.prototype.get = function(index) {
+  if (index < 0 || index >= this.length)
+    return undefined;
+  return this._items[(this._head + index) & this._mask];
+};
+
+RingBuffer.prototype.first = function() {
+  return this.get(0);
+};
+
+RingBuffer.prototype.clear = function() {
+  while (this.length > 0)
+    this.shift();
+  this._head = 0;
+};
+
+RingBuffer.prototype.toArray = function() {
+  const out = new Array(this.length);
+  for (var i = 0; i < this.length; i++)
+    out[i] = this._items[(this._head + i) & this._mask];
+  return out;
+};
+
+RingBuffer.prototype.join = function(separator) {
+  if (this.length === 0)
+    return '';
+  var ret = '' + this.get(0);
+  for (var i = 1; i < this.length; i++)
+    ret += separator + this._items[(this._head + i) & this._mask];
+  return ret;
+};
+
+// Copies all of the Buffers into one that is `length` bytes long.
+RingBuffer.prototype.concat = function(length) {
+  const ret = Buffer.allocUnsafe(length);
+  var offset = 0;
+  for (var i = 0; i < this.length && offset < length; i++) {
+    const buf = this._items[(this._head + i) & this._mask];
+    offset += buf.copy(ret, offset);
+  }
+  return ret;
+};
+
+function grow(ring) {
+  const items = ring._items;
+  const capacity = items.length;
+  const grown = new Array(capacity * 2);
+  for (var i = 0; i < capacity; i++)
+    grown[i] = items[(ring._head + i) & ring._mask];
+  ring._items = grown;
+  ring._mask = grown.length - 1;
+  ring._head = 0;
+}
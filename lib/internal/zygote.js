@@ -0,0 +1,215 @@
+'use strict';
+
+const EventEmitter = require('events');
+const path = require('path');
+const util = require('util');
+
+module.exports = {
+  createZygote,
+  setupChild
+};
+
+
+// A pool of Node.js processes that were started and bootstrapped ahead of
+// time and wait on their IPC channel for the module to run.  Forking the
+// parent would be cheaper still, but V8 and the event loop don't survive
+// fork(2): the children would share the random number generator and hash
+// seed of the parent and the file descriptors of its loop.
+function Zygote(options) {
+  EventEmitter.call(this);
+
+  var size = options.size === undefined ? 1 : options.size;
+  if (typeof size !== 'number')
+    throw new TypeError('"size" option must be a number');
+  if (!Number.isInteger(size) || size < 0)
+    throw new RangeError('"size" option must be a non-negative integer');
+
+  var execArgv = options.execArgv === undefined ? process.execArgv :
+                                                  options.execArgv;
+  if (!Array.isArray(execArgv))
+    throw new TypeError('"execArgv" option must be an array');
+
+  if (execArgv === process.execArgv && process._eval != null) {
+    const index = execArgv.lastIndexOf(process._eval);
+    if (index > 0) {
+      // Remove the -e switch to avoid fork bombing ourselves.
+      execArgv = execArgv.slice();
+      execArgv.splice(index - 1, 2);
+    }
+  }
+
+  this.size = size;
+  this._execPath = options.execPath || process.execPath;
+  this._execArgv = execArgv;
+  this._options = {
+    cwd: options.cwd,
+    env: util._extend({ NODE_ZYGOTE_CHILD: '1' }, options.env || process.env),
+    stdio: options.silent ? ['pipe', 'pipe', 'pipe', 'ipc'] : [0, 1, 2, 'ipc'],
+    serialization: options.serialization
+  };
+  // The pre-started processes, oldest first.
+  this._idle = [];
+  this._fillScheduled = false;
+  this._closed = false;
+
+  fill(this);
+}
+util.inherits(Zygote, EventEmitter);
+
+
+// The number of pre-started processes that wait for a module to run.
+Object.defineProperty(Zygote.prototype, 'idle', {
+  get: function() {
+    return this._idle.length;
+  }
+});
+
+
+Zygote.prototype.fork = function(modulePath /*, args, options*/) {
+  if (this._closed)
+    throw new Error('Zygote is closed');
+  if (typeof modulePath !== 'string')
+    throw new TypeError('"modulePath" argument must be a string');
+
+  var options, args;
+  if (Array.isArray(arguments[1])) {
+    args = arguments[1];
+    options = arguments[2] || {};
+  } else if (arguments[1] && typeof arguments[1] !== 'object') {
+    throw new TypeError('Incorrect value of args option');
+  } else {
+    args = [];
+    options = arguments[1] || {};
+  }
+
+  var child = this._idle.shift() || start(this);
+  child.removeListener('exit', onidleexit);
+  setRef(child, true);
+
+  var job = {
+    cmd: 'NODE_ZYGOTE_RUN',
+    modulePath: modulePath,
+    args: args.map(String),
+    cwd: options.cwd,
+    env: null
+  };
+  if (options.env) {
+    job.env = {};
+    for (var key in options.env)
+      job.env[key] = String(options.env[key]);
+  }
+  child.send(job);
+
+  child.spawnargs = [this._execPath].concat(this._execArgv,
+                                            [modulePath],
+                                            job.args);
+  scheduleFill(this);
+  return child;
+};
+
+
+Zygote.prototype.close = function() {
+  this._closed = true;
+  var idle = this._idle;
+  this._idle = [];
+  for (var i = 0; i < idle.length; i++) {
+    idle[i].removeListener('exit', onidleexit);
+    idle[i].kill();
+  }
+};
+
+
+function start(zygote) {
+  const spawn = require('child_process').spawn;
+  return spawn(zygote._execPath, zygote._execArgv, zygote._options);
+}
+
+
+function fill(zygote) {
+  while (!zygote._closed && zygote._idle.length < zygote.size) {
+    var child = start(zygote);
+    child._zygote = zygote;
+    child.on('exit', onidleexit);
+    setRef(child, false);
+    zygote._idle.push(child);
+  }
+}
+
+
+function scheduleFill(zygote) {
+  if (zygote._fillScheduled)
+    return;
+  zygote._fillScheduled = true;
+  setImmediate(function() {
+    zygote._fillScheduled = false;
+    fill(zygote);
+  });
+}
+
+
+// A pre-started process that dies before it got a module to run isn't
+// replaced until the next fork(), so that one that can't start doesn't
+// make the pool respawn it in a loop.
+function onidleexit(code, signal) {
+  const zygote = this._zygote;
+  const index = zygote._idle.indexOf(this);
+  if (index !== -1)
+    zygote._idle.splice(index, 1);
+  zygote.emit('error', new Error('Pre-started process ' + this.pid +
+                                 ' exited with ' +
+                                 (signal ? 'signal ' + signal :
+                                           'code ' + code)));
+}
+
+
+// Idle processes don't keep the event loop of the parent alive.
+function setRef(child, ref) {
+  const method = ref ? 'ref' : 'unref';
+  child[method]();
+  if (child._channel)
+    child._channel[method]();
+  for (var i = 0; i < child.stdio.length; i++) {
+    const stream = child.stdio[i];
+    if (stream && typeof stream[method] === 'function')
+      stream[method]();
+  }
+}
+
+
+function createZygote(options) {
+  if (options === undefined)
+    options = {};
+  else if (options === null || typeof options !== 'object')
+    throw new TypeError('"options" argument must be an object');
+  return new Zygote(options);
+}
+
+
+// Runs in a pre-started process, before any user code.  The channel is only
+// referenced while there are 'message' or 'disconnect' listeners, it has to
+// be kept alive by hand until the module to run arrives.
+function setupChild() {
+  const Module = require('module');
+
+  process._channel.ref();
+  process.on('internalMessage', function onjob(message) {
+    if (message.cmd !== 'NODE_ZYGOTE_RUN')
+      return;
+    process.removeListener('internalMessage', onjob);
+    process._channel.unref();
+
+    if (message.env !== null) {
+      var key;
+      for (key in process.env)
+        delete process.env[key];
+      for (key in message.env)
+        process.env[key] = message.env[key];
+    }
+    if (message.cwd)
+      process.chdir(message.cwd);
+
+    process.argv = [process.argv[0], path.resolve(message.modulePath)]
+        .concat(message.args);
+    Module.runMain();
+  });
+}
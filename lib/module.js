@@ -3,13 +3,42 @@
 const NativeModule = require('native_module');
 const util = require('util');
 const internalModule = require('internal/module');
+const moduleArchive = require('internal/module_archive');
 const internalUtil = require('internal/util');
 const vm = require('vm');
 const assert = require('assert').ok;
 const fs = require('fs');
 const path = require('path');
+const Buffer = require('buffer').Buffer;
 const internalModuleReadFile = process.binding('fs').internalModuleReadFile;
 const internalModuleStat = process.binding('fs').internalModuleStat;
+const internalModuleResolve = process.binding('fs').internalModuleResolve;
+const internalModuleRealpath = process.binding('fs').internalModuleRealpath;
+const setModuleCacheEnabled = process.binding('fs').setModuleCacheEnabled;
+
+// The results of the stat() and realpath() calls made while resolving
+// modules are cached in src/node_file.cc for the duration of a top-level
+// require(), or for the lifetime of the process when
+// NODE_PERSISTENT_MODULE_CACHE=1.  Paths longer than this are resolved in
+// JS because they need path._makeLong() on Windows.
+const persistentModuleCache = process.env.NODE_PERSISTENT_MODULE_CACHE === '1';
+const kMaxNativeResolvePath = process.platform === 'win32' ? 200 : Infinity;
+
+var moduleCacheEnabled = false;
+
+function enableModuleCache(enabled) {
+  moduleCacheEnabled = enabled;
+  setModuleCacheEnabled(enabled);
+}
+
+if (persistentModuleCache) enableModuleCache(true);
+
+// Zip archives to load modules from, see lib/internal/module_archive.js.
+if (process.env.NODE_MODULE_ARCHIVE) {
+  process.env.NODE_MODULE_ARCHIVE.split(path.delimiter).forEach((file) => {
+    if (file) moduleArchive.mount(path.resolve(file));
+  });
+}
 
 // If obj.hasOwnProperty has been overridden, then calling
 // obj.hasOwnProperty(prop) will break.
@@ -20,17 +49,35 @@ function hasOwnProperty(obj, prop) {
 
 
 function stat(filename) {
-  filename = path._makeLong(filename);
-  const cache = stat.cache;
-  if (cache !== null) {
-    const result = cache.get(filename);
-    if (result !== undefined) return result;
-  }
-  const result = internalModuleStat(filename);
-  if (cache !== null) cache.set(filename, result);
-  return result;
+  if (moduleArchive.mounted) {
+    const rc = moduleArchive.stat(filename);
+    if (rc !== undefined) return rc;
+  }
+  return internalModuleStat(path._makeLong(filename));
+}
+
+function realpath(filename) {
+  if (moduleArchive.mounted && moduleArchive.contains(filename))
+    return filename;
+  return internalModuleRealpath(filename) || fs.realpathSync(filename);
+}
+
+// Returns the contents of a module's file, undefined when it can't be read.
+function readModuleFile(filename) {
+  if (moduleArchive.mounted && moduleArchive.contains(filename)) {
+    const content = moduleArchive.readFile(filename);
+    return content === undefined ? content : internalModule.stripBOM(content);
+  }
+  return internalModuleReadFile(path._makeLong(filename));
+}
+
+function readSource(filename) {
+  if (moduleArchive.mounted && moduleArchive.contains(filename)) {
+    const content = moduleArchive.readFile(filename);
+    if (content !== undefined) return content;
+  }
+  return fs.readFileSync(filename, 'utf8');
 }
-stat.cache = null;
 
 
 function Module(id, parent) {
@@ -81,7 +128,7 @@ function readPackage(requestPath) {
   }
 
   const jsonPath = path.resolve(requestPath, 'package.json');
-  const json = internalModuleReadFile(path._makeLong(jsonPath));
+  const json = readModuleFile(jsonPath);
 
   if (json === undefined) {
     return false;
@@ -114,7 +161,7 @@ function tryPackage(requestPath, exts, isMain) {
 function tryFile(requestPath, isMain) {
   const rc = stat(requestPath);
   if (isMain) {
-    return rc === 0 && fs.realpathSync(requestPath);
+    return rc === 0 && realpath(requestPath);
   }
   return rc === 0 && path.resolve(requestPath);
 }
@@ -131,6 +178,41 @@ function tryExtensions(p, exts, isMain) {
   return false;
 }
 
+// The JS version of internalModuleResolve(), used when it cannot handle
+// basePath.
+function findFile(basePath, exts, trailingSlash, isMain) {
+  var filename;
+
+  if (!trailingSlash) {
+    const rc = stat(basePath);
+    if (rc === 0) {  // File.
+      if (!isMain) {
+        filename = path.resolve(basePath);
+      } else {
+        filename = realpath(basePath);
+      }
+    } else if (rc === 1) {  // Directory.
+      filename = tryPackage(basePath, exts, isMain);
+    }
+
+    if (!filename) {
+      // try it with each of the extensions
+      filename = tryExtensions(basePath, exts, isMain);
+    }
+  }
+
+  if (!filename) {
+    filename = tryPackage(basePath, exts, isMain);
+  }
+
+  if (!filename) {
+    // try it with each of the extensions at "index"
+    filename = tryExtensions(path.resolve(basePath, 'index'), exts, isMain);
+  }
+
+  return filename;
+}
+
 var warned = false;
 Module._findPath = function(request, paths, isMain) {
   if (path.isAbsolute(request)) {
@@ -144,7 +226,7 @@ Module._findPath = function(request, paths, isMain) {
     return Module._pathCache[cacheKey];
   }
 
-  var exts;
+  const exts = Object.keys(Module._extensions);
   const trailingSlash = request.length > 0 &&
                         request.charCodeAt(request.length - 1) === 47/*/*/;
 
@@ -155,41 +237,17 @@ Module._findPath = function(request, paths, isMain) {
     if (curPath && stat(curPath) < 1) continue;
     var basePath = path.resolve(curPath, request);
     var filename;
-
-    if (!trailingSlash) {
-      const rc = stat(basePath);
-      if (rc === 0) {  // File.
-        if (!isMain) {
-          filename = path.resolve(basePath);
-        } else {
-          filename = fs.realpathSync(basePath);
-        }
-      } else if (rc === 1) {  // Directory.
-        if (exts === undefined)
-          exts = Object.keys(Module._extensions);
-        filename = tryPackage(basePath, exts, isMain);
-      }
-
-      if (!filename) {
-        // try it with each of the extensions
-        if (exts === undefined)
-          exts = Object.keys(Module._extensions);
-        filename = tryExtensions(basePath, exts, isMain);
-      }
-    }
-
-    if (!filename) {
-      if (exts === undefined)
-        exts = Object.keys(Module._extensions);
-      filename = tryPackage(basePath, exts, isMain);
+    if (basePath.length < kMaxNativeResolvePath &&
+        !(moduleArchive.mounted && moduleArchive.contains(basePath))) {
+      filename = internalModuleResolve(basePath, exts, trailingSlash);
+    } else {
+      filename = undefined;
     }
 
-    if (!filename) {
-      // try it with each of the extensions at "index"
-      if (exts === undefined)
-        exts = Object.keys(Module._extensions);
-      filename = tryExtensions(path.resolve(basePath, 'index'), exts, isMain);
-    }
+    if (filename === undefined)
+      filename = findFile(basePath, exts, trailingSlash, isMain);
+    else if (filename && isMain)
+      filename = realpath(filename);
 
     if (filename) {
       // Warn once if '.' resolved outside the module dir
@@ -508,11 +566,16 @@ Module.prototype._compile = function(content, filename) {
   // create wrapper function
   var wrapper = Module.wrap(content);
 
-  var compiledWrapper = vm.runInThisContext(wrapper, {
-    filename: filename,
-    lineOffset: 0,
-    displayErrors: true
-  });
+  var compiledWrapper;
+  if (codeCacheDir) {
+    compiledWrapper = compileWithCodeCache(wrapper, filename);
+  } else {
+    compiledWrapper = vm.runInThisContext(wrapper, {
+      filename: filename,
+      lineOffset: 0,
+      displayErrors: true
+    });
+  }
 
   if (process._debugWaitConnect) {
     if (!resolvedArgv) {
@@ -535,23 +598,124 @@ Module.prototype._compile = function(content, filename) {
   var require = internalModule.makeRequireFunction.call(this);
   var args = [this.exports, require, this, filename, dirname];
   var depth = internalModule.requireDepth;
-  if (depth === 0) stat.cache = new Map();
+  const cacheScope = depth === 0 && !persistentModuleCache;
+  if (cacheScope) enableModuleCache(true);
   var result = compiledWrapper.apply(this.exports, args);
-  if (depth === 0) stat.cache = null;
+  if (cacheScope) enableModuleCache(false);
   return result;
 };
 
 
 // Native extension for .js
+// On-disk V8 code cache, enabled by pointing NODE_CODE_CACHE_DIR at a
+// directory.  There is one file per module.  Each file starts with a key made
+// of the module's path, mtime and size and the V8 version, followed by the
+// data from produceCachedData.  Entries with a different key are stale and
+// get overwritten.
+const codeCacheDir = process.env.NODE_CODE_CACHE_DIR;
+
+function codeCacheFile(filename) {
+  // 32-bit FNV-1a.  Collisions are caught by the key in the file.
+  var hash = 0x811c9dc5;
+  for (var i = 0; i < filename.length; i++) {
+    hash ^= filename.charCodeAt(i);
+    hash = Math.imul(hash, 0x01000193) >>> 0;
+  }
+  return path.join(codeCacheDir, hash.toString(16) + '.cache');
+}
+
+function codeCacheKey(filename) {
+  try {
+    const stats = fs.statSync(filename);
+    return JSON.stringify([filename,
+                           stats.mtime.getTime(),
+                           stats.size,
+                           process.versions.v8,
+                           process.arch]);
+  } catch (e) {
+    return null;
+  }
+}
+
+function readCodeCache(file, key) {
+  var data;
+  try {
+    data = fs.readFileSync(file);
+  } catch (e) {
+    return undefined;
+  }
+  if (data.length < 4)
+    return undefined;
+  const keyLength = data.readUInt32LE(0);
+  if (data.length < 4 + keyLength ||
+      data.toString('utf8', 4, 4 + keyLength) !== key)
+    return undefined;
+  return data.slice(4 + keyLength);
+}
+
+function writeCodeCache(file, key, cachedData) {
+  const keyLength = Buffer.byteLength(key);
+  const data = Buffer.allocUnsafe(4 + keyLength + cachedData.length);
+  data.writeUInt32LE(keyLength, 0);
+  data.write(key, 4);
+  cachedData.copy(data, 4 + keyLength);
+  // Write to a temporary file and rename it so that concurrent processes
+  // never see a partial entry.
+  const tmp = `${file}.${process.pid}.tmp`;
+  try {
+    fs.writeFileSync(tmp, data);
+    fs.renameSync(tmp, file);
+  } catch (e) {
+    if (e.code === 'ENOENT') {
+      // The cache directory doesn't exist yet.
+      try {
+        fs.mkdirSync(codeCacheDir);
+        fs.writeFileSync(tmp, data);
+        fs.renameSync(tmp, file);
+      } catch (e) {
+        // The cache is best effort.
+      }
+    }
+  }
+}
+
+function compileWithCodeCache(wrapper, filename) {
+  const key = codeCacheKey(filename);
+  const file = codeCacheFile(filename);
+  const cachedData = key === null ? undefined : readCodeCache(file, key);
+  const script = new vm.Script(wrapper, {
+    filename: filename,
+    lineOffset: 0,
+    displayErrors: true,
+    cachedData: cachedData,
+    produceCachedData: key !== null && cachedData === undefined
+  });
+  const compiledWrapper = script.runInThisContext({ displayErrors: true });
+  if (script.cachedDataRejected === true) {
+    // Produced by a differently configured V8, for example one with other
+    // flags.  Compile once more to get data that matches this process.
+    const fresh = new vm.Script(wrapper, {
+      filename: filename,
+      produceCachedData: true
+    });
+    if (fresh.cachedDataProduced)
+      writeCodeCache(file, key, fresh.cachedData);
+  } else if (script.cachedDataProduced) {
+    writeCodeCache(file, key, script.cachedData);
+  }
+  return compiledWrapper;
+}
+
+
 Module._extensions['.js'] = function(module, filename) {
-  var content = fs.readFileSync(filename, 'utf8');
+  var content = readSource(filename);
   module._compile(internalModule.stripBOM(content), filename);
 };
 
 
 // Native extension for .json
 Module._extensions['.json'] = function(module, filename) {
-  var content = fs.readFileSync(filename, 'utf8');
+  var content = readSource(filename);
   try {
     module.exports = JSON.parse(internalModule.stripBOM(content));
   } catch (err) {
@@ -563,6 +727,8 @@ Module._extensions['.json'] = function(module, filename) {
 
 //Native extension for .node
 Module._extensions['.node'] = function(module, filename) {
+  if (moduleArchive.mounted && moduleArchive.contains(filename))
+    throw new Error(`Cannot load addon ${filename} from a module archive`);
   return process.dlopen(module, path._makeLong(filename));
 };
 
@@ -575,6 +741,15 @@ Module.runMain = function() {
   process._tickCallback();
 };
 
+// Drops the cached results of the file system lookups done while resolving
+// modules, for when files have been added or removed since.
+Module._clearStatCache = function() {
+  setModuleCacheEnabled(moduleCacheEnabled, true);
+  for (var key in packageMainCache)
+    delete packageMainCache[key];
+  Module._pathCache = {};
+};
+
 Module._initPaths = function() {
   const isWindows = process.platform === 'win32';
 
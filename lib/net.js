@@ -11,6 +11,7 @@ const cares = process.binding('cares_wrap');
 const uv = process.binding('uv');
 
 const Buffer = require('buffer').Buffer;
+const ChunkList = require('buffer').ChunkList;
 const TTYWrap = process.binding('tty_wrap');
 const TCP = process.binding('tcp_wrap').TCP;
 const Pipe = process.binding('pipe_wrap').Pipe;
@@ -18,6 +19,9 @@ const TCPConnectWrap = process.binding('tcp_wrap').TCPConnectWrap;
 const PipeConnectWrap = process.binding('pipe_wrap').PipeConnectWrap;
 const ShutdownWrap = process.binding('stream_wrap').ShutdownWrap;
 const WriteWrap = process.binding('stream_wrap').WriteWrap;
+const writeInfo = process.binding('stream_wrap').writeInfo;
+const broadcastHandles = process.binding('stream_wrap').broadcast;
+const StreamPipe = process.binding('stream_pipe').StreamPipe;
 
 
 var cluster;
@@ -25,6 +29,31 @@ const errnoException = util._errnoException;
 const exceptionWithHostPort = util._exceptionWithHostPort;
 const isLegalPort = internalNet.isLegalPort;
 const assertPort = internalNet.assertPort;
+const kSendFile = internalNet.kSendFile;
+const kChunkedPayload = internalNet.kChunkedPayload;
+
+// Size of the reads done when a file has to be copied through user space.
+const kSendFileChunkSize = 64 * 1024;
+const kDefaultAutoSelectFamilyAttemptTimeout = 250;
+
+// Indexes into writeInfo, see Environment::WriteInfo.
+const kBytesWritten = 0;
+const kLastWriteWasAsync = 1;
+
+// A write request that C++ did not keep because the write completed right
+// away, the next write can use it again.
+var spareWriteReq = null;
+
+function newWriteReq(handle) {
+  var req = spareWriteReq;
+  if (req === null)
+    req = new WriteWrap();
+  else
+    spareWriteReq = null;
+  req.handle = handle;
+  req.oncomplete = afterWrite;
+  return req;
+}
 
 function noop() {}
 
@@ -105,6 +134,14 @@ function initSocketHandle(self) {
   if (self._handle) {
     self._handle.owner = self;
     self._handle.onread = onread;
+    self._handle.onidletimeout = onidletimeout;
+
+    // A timeout that was set before the handle existed moves to the handle.
+    if (self._idleTimeout > 0 && self._handle.setIdleTimeout) {
+      const msecs = self._idleTimeout;
+      timers.unenroll(self);
+      self._handle.setIdleTimeout(msecs);
+    }
 
     // If handle doesn't support writev - neither do we
     if (!self._handle.writev)
@@ -124,6 +161,9 @@ function Socket(options) {
   this._handle = null;
   this._parent = null;
   this._host = null;
+  this._nativePipeIn = null;
+  this._nativePipeOut = null;
+  this._connectRace = null;
 
   if (typeof options === 'number')
     options = { fd: options }; // Legacy interface.
@@ -167,6 +207,10 @@ function Socket(options) {
   // default to *not* allowing half open sockets
   this.allowHalfOpen = options && options.allowHalfOpen || false;
 
+  // Writes made in the same tick are corked and flushed together.
+  this._coalesceWrites = !!options.coalesceWrites;
+  this._coalescing = false;
+
   // if we have a handle, then start the flow of data into the
   // buffer.  if not, then this will happen when we connect
   if (this._handle && options.readable !== false) {
@@ -314,12 +358,22 @@ Socket.prototype.listen = function() {
 Socket.prototype.setTimeout = function(msecs, callback) {
   if (msecs === 0) {
     timers.unenroll(this);
+    if (this._handle && this._handle.setIdleTimeout)
+      this._handle.setIdleTimeout(0);
     if (callback) {
       this.removeListener('timeout', callback);
     }
   } else {
     timers.enroll(this, msecs);
-    timers._unrefActive(this);
+    if (this._handle && this._handle.setIdleTimeout) {
+      // The handle keeps the timeout and refreshes it on every read and
+      // write itself.  enroll() has validated and clamped msecs.
+      msecs = this._idleTimeout;
+      timers.unenroll(this);
+      this._handle.setIdleTimeout(msecs);
+    } else {
+      timers._unrefActive(this);
+    }
     if (callback) {
       this.once('timeout', callback);
     }
@@ -334,6 +388,13 @@ Socket.prototype._onTimeout = function() {
 };
 
 
+function onidletimeout() {
+  var self = this.owner;
+  if (self._handle === this)
+    self._onTimeout();
+}
+
+
 Socket.prototype.setNoDelay = function(enable) {
   if (!this._handle) {
     this.once('connect',
@@ -362,6 +423,22 @@ Socket.prototype.setKeepAlive = function(setting, msecs) {
 };
 
 
+Socket.prototype.setBusyPoll = function(usecs) {
+  if (usecs !== (usecs >>> 0))
+    throw new TypeError('"usecs" argument must be a non-negative integer');
+
+  if (!this._handle) {
+    this.once('connect', () => this.setBusyPoll(usecs));
+    return this;
+  }
+
+  if (this._handle.setBusyPoll)
+    this._handle.setBusyPoll(usecs);
+
+  return this;
+};
+
+
 Socket.prototype.address = function() {
   return this._getsockname();
 };
@@ -479,6 +556,15 @@ Socket.prototype._destroy = function(exception, cb) {
   for (var s = this; s !== null; s = s._parent)
     timers.unenroll(s);
 
+  // A native pipe must not use a handle that is going away.
+  if (this._nativePipeOut)
+    unpipeNative(this._nativePipeOut);
+  if (this._nativePipeIn)
+    unpipeNative(this._nativePipeIn);
+
+  if (this._connectRace)
+    this._handle = abortConnectRace(this);
+
   debug('close');
   if (this._handle) {
     if (this !== process.stderr)
@@ -486,6 +572,8 @@ Socket.prototype._destroy = function(exception, cb) {
     var isException = exception ? true : false;
     // `bytesRead` should be accessible after `.destroy()`
     this[BYTES_READ] = this._handle.bytesRead;
+    if (this._handle.setIdleTimeout)
+      this._handle.setIdleTimeout(0);
 
     this._handle.close(() => {
       debug('emit close');
@@ -643,14 +731,27 @@ protoGetter('localPort', function localPort() {
 
 
 Socket.prototype.write = function(chunk, encoding, cb) {
-  if (typeof chunk !== 'string' && !(chunk instanceof Buffer)) {
+  if (typeof chunk !== 'string' &&
+      !(chunk instanceof Buffer) &&
+      !(chunk instanceof ChunkList)) {
     throw new TypeError(
       'Invalid data, chunk must be a string or buffer, not ' + typeof chunk);
   }
+  if (this._coalesceWrites && !this._coalescing) {
+    this._coalescing = true;
+    this.cork();
+    process.nextTick(uncorkCoalescedNT, this);
+  }
   return stream.Duplex.prototype.write.apply(this, arguments);
 };
 
 
+function uncorkCoalescedNT(self) {
+  self._coalescing = false;
+  self.uncork();
+}
+
+
 Socket.prototype._writeGeneric = function(writev, data, encoding, cb) {
   // If we are still connecting, then buffer this for later.
   // The Writable logic will buffer up any more writes while
@@ -673,53 +774,310 @@ Socket.prototype._writeGeneric = function(writev, data, encoding, cb) {
     return false;
   }
 
-  var req = new WriteWrap();
-  req.handle = this._handle;
-  req.oncomplete = afterWrite;
-  req.async = false;
+  if (!writev && data[kSendFile] !== undefined)
+    return this._sendFile(data[kSendFile], cb);
+
+  var req = newWriteReq(this._handle);
   var err;
 
+  var chunked;
+  if (!writev && this._handle.writeChunked)
+    chunked = data[kChunkedPayload];
+
+  if (!writev && chunked === undefined && data instanceof ChunkList) {
+    if (this._handle.writev) {
+      writev = true;
+      data = [{ chunk: data, encoding: 'buffer' }];
+    } else {
+      data = data.toBuffer();
+    }
+  }
+
   if (writev) {
-    var chunks = new Array(data.length << 1);
+    var chunks = [];
     for (var i = 0; i < data.length; i++) {
       var entry = data[i];
-      chunks[i * 2] = entry.chunk;
-      chunks[i * 2 + 1] = entry.encoding;
+      if (entry.chunk instanceof ChunkList) {
+        // The Buffers go to the handle as they are, in one iovec.
+        var list = entry.chunk.chunks;
+        for (var j = 0; j < list.length; j++)
+          chunks.push(list[j], 'buffer');
+      } else {
+        chunks.push(entry.chunk, entry.encoding);
+      }
     }
+    if (chunks.length === 0)
+      chunks.push(Buffer.alloc(0), 'buffer');  // Only empty ChunkLists.
     err = this._handle.writev(req, chunks);
-
-    // Retain chunks
-    if (err === 0) req._chunks = chunks;
+  } else if (chunked !== undefined) {
+    err = this._handle.writeChunked(req, chunked);
   } else {
-    var enc;
-    if (data instanceof Buffer) {
-      req.buffer = data;  // Keep reference alive.
-      enc = 'buffer';
-    } else {
-      enc = encoding;
-    }
+    var enc = data instanceof Buffer ? 'buffer' : encoding;
     err = createWriteReq(req, this._handle, data, enc);
   }
 
   if (err)
     return this._destroy(errnoException(err, 'write', req.error), cb);
 
-  this._bytesDispatched += req.bytes;
+  this._bytesDispatched += writeInfo[kBytesWritten];
+
+  if (writeInfo[kLastWriteWasAsync] === 0) {
+    spareWriteReq = req;
+    return cb();
+  }
+
+  // Keep the data alive until the write is done.
+  if (writev)
+    req._chunks = chunks;
+  else if (chunked !== undefined)
+    req.buffer = chunked;
+  else if (data instanceof Buffer)
+    req.buffer = data;
 
   // If it was entirely flushed, we can write some more right now.
   // However, if more is left in the queue, then wait until that clears.
-  if (req.async && this._handle.writeQueueSize != 0)
+  if (this._handle.writeQueueSize != 0)
     req.cb = cb;
   else
     cb();
 };
 
 
+Socket.prototype._writableChunkList = true;
+
+
 Socket.prototype._writev = function(chunks, cb) {
+  for (var i = 0; i < chunks.length; i++) {
+    // Files can't be part of a writev(), send everything in order instead.
+    if (chunks[i].chunk[kSendFile] !== undefined)
+      return writeChunks(this, chunks, 0, cb);
+  }
   this._writeGeneric(true, chunks, '', cb);
 };
 
 
+function writeChunks(self, chunks, index, cb) {
+  if (index === chunks.length)
+    return cb();
+  var entry = chunks[index];
+  self._writeGeneric(false, entry.chunk, entry.encoding, function(err) {
+    if (err)
+      return cb(err);
+    writeChunks(self, chunks, index + 1, cb);
+  });
+}
+
+
+// Writes `length` bytes of the file `fd`, starting at `offset`, to the
+// socket. The data is queued after everything that was written before and
+// is copied by the kernel where the handle supports it.
+Socket.prototype.sendFile = function(fd, offset, length, cb) {
+  return this.write(internalNet.fileChunk(fd, offset, length), cb);
+};
+
+
+Socket.prototype._sendFile = function(file, cb) {
+  if (typeof this._handle.sendFile !== 'function')
+    return sendFileFallback(this, file, cb);
+
+  var req = new WriteWrap();
+  req.handle = this._handle;
+  req.oncomplete = afterWrite;
+
+  var err = this._handle.sendFile(req, file.fd, file.offset, file.length);
+  if (err === uv.UV_ENOSYS)
+    return sendFileFallback(this, file, cb);
+  if (err)
+    return this._destroy(errnoException(err, 'sendfile'), cb);
+
+  this._bytesDispatched += writeInfo[kBytesWritten];
+
+  if (this._handle.writeQueueSize != 0)
+    req.cb = cb;
+  else
+    cb();
+};
+
+
+// Used for handles that can't send files directly, like TLS sockets.
+function sendFileFallback(self, file, cb) {
+  const fs = require('fs');
+  const size = Math.min(file.length, kSendFileChunkSize);
+  const buffer = Buffer.allocUnsafe(size);
+  var offset = file.offset;
+  var remaining = file.length;
+
+  function next() {
+    if (remaining === 0)
+      return cb();
+    const toRead = Math.min(remaining, size);
+    fs.read(file.fd, buffer, 0, toRead, offset, function(err, bytesRead) {
+      if (err)
+        return self._destroy(err, cb);
+      if (bytesRead === 0)
+        return self._destroy(errnoException(uv.UV_EOF, 'sendfile'), cb);
+      if (!self._handle)
+        return self._destroy(new Error('This socket is closed'), cb);
+      offset += bytesRead;
+      remaining -= bytesRead;
+      // The buffer is reused once the previous chunk has been written out.
+      self._writeGeneric(false, buffer.slice(0, bytesRead), 'buffer', next);
+    });
+  }
+
+  next();
+}
+
+
+// Forwards everything that is read from this socket to destination in C++,
+// without emitting it.  callback(err) is called when this socket ends or
+// when reading or writing fails.
+Socket.prototype.pipeNative = function(destination, options, callback) {
+  if (typeof options === 'function') {
+    callback = options;
+    options = undefined;
+  }
+
+  if (!(destination instanceof Socket))
+    throw new TypeError('"destination" argument must be a net.Socket');
+  if (destination === this)
+    throw new Error('A socket can\'t be piped to itself');
+  if (this._nativePipeOut || destination._nativePipeIn)
+    throw new Error('Socket is already piped natively');
+  if (callback !== undefined && typeof callback !== 'function')
+    throw new TypeError('"callback" argument must be a function');
+
+  const state = {
+    pipe: null,
+    spliced: false,
+    source: this,
+    destination: destination,
+    end: !options || options.end !== false,
+    callback: callback || noop
+  };
+  this._nativePipeOut = state;
+  destination._nativePipeIn = state;
+
+  waitForNativePipe(state);
+  return destination;
+};
+
+
+Socket.prototype.unpipeNative = function() {
+  if (this._nativePipeOut)
+    unpipeNative(this._nativePipeOut);
+};
+
+
+function waitForNativePipe(state) {
+  const source = state.source;
+  const destination = state.destination;
+
+  if (source.connecting)
+    return source.once('connect', () => startNativePipe(state));
+  if (destination.connecting)
+    return destination.once('connect', () => startNativePipe(state));
+
+  // What has been read already is written the normal way, everything else
+  // goes out after it.
+  var chunk;
+  while ((chunk = source.read()) !== null)
+    destination.write(chunk);
+
+  if (destination._writableState.length === 0)
+    startNativePipe(state);
+  else
+    destination.write(Buffer.alloc(0), () => startNativePipe(state));
+}
+
+
+function startNativePipe(state) {
+  const source = state.source;
+  const destination = state.destination;
+
+  if (source._nativePipeOut !== state)
+    return;  // Unpiped in the meantime.
+  if (source.connecting || destination.connecting)
+    return waitForNativePipe(state);
+  if (!source._handle || !destination._handle ||
+      !source._handle._externalStream || !destination._handle._externalStream) {
+    return finishNativePipe(state, new Error('This socket is closed'));
+  }
+
+  // Between two TCP sockets the data can stay in the kernel, that is tried
+  // first. It fails with ENOSYS where splice() isn't available.
+  if (source._handle instanceof TCP && destination._handle instanceof TCP) {
+    source._handle.onsplice = function(status, writeFailed) {
+      onNativePipeComplete(state, status, writeFailed);
+    };
+    if (source._handle.spliceStart(destination._handle) === 0) {
+      state.spliced = true;
+      source._handle.reading = true;
+      return;
+    }
+  }
+
+  const pipe = new StreamPipe(source._handle._externalStream,
+                              destination._handle._externalStream);
+  pipe.oncomplete = function(status, writeFailed) {
+    onNativePipeComplete(state, status, writeFailed);
+  };
+  state.pipe = pipe;
+
+  // The pipe does the reading, net.Socket#_read() must not start it again.
+  source._handle.reading = true;
+  const err = pipe.start();
+  if (err)
+    finishNativePipe(state, errnoException(err, 'read'));
+}
+
+
+function onNativePipeComplete(state, status, writeFailed) {
+  const source = state.source;
+  const destination = state.destination;
+
+  if (status === 0) {
+    // The source has seen the EOF already.
+    if (state.end)
+      destination.end();
+    return finishNativePipe(state, null);
+  }
+
+  var err;
+  if (writeFailed) {
+    err = errnoException(status, 'write');
+    if (source._handle)
+      source._handle.reading = false;
+    finishNativePipe(state, err);
+    destination._destroy(err);
+  } else {
+    // The source has been destroyed with the error already.
+    err = errnoException(status, 'read');
+    finishNativePipe(state, err);
+  }
+}
+
+
+function finishNativePipe(state, err) {
+  state.source._nativePipeOut = null;
+  state.destination._nativePipeIn = null;
+  state.callback(err);
+}
+
+
+function unpipeNative(state) {
+  state.source._nativePipeOut = null;
+  state.destination._nativePipeIn = null;
+  if (state.pipe !== null) {
+    state.pipe.unpipe();
+  } else if (state.spliced && state.source._handle) {
+    // The source is left reading, like it is after a StreamPipe.
+    state.source._handle.spliceStop();
+    state.source._handle.readStart();
+  }
+}
+
+
 Socket.prototype._write = function(data, encoding, cb) {
   this._writeGeneric(false, data, encoding, cb);
 };
@@ -761,14 +1119,14 @@ protoGetter('bytesWritten', function bytesWritten() {
     return undefined;
 
   state.getBuffer().forEach(function(el) {
-    if (el.chunk instanceof Buffer)
+    if (el.chunk instanceof Buffer || el.chunk instanceof ChunkList)
       bytes += el.chunk.length;
     else
       bytes += Buffer.byteLength(el.chunk, el.encoding);
   });
 
   if (data) {
-    if (data instanceof Buffer)
+    if (data instanceof Buffer || data instanceof ChunkList)
       bytes += data.length;
     else
       bytes += Buffer.byteLength(data, encoding);
@@ -973,6 +1331,9 @@ function lookupAndConnect(self, options) {
     hints: options.hints || 0
   };
 
+  if (options.resolver !== undefined)
+    dnsopts.resolver = options.resolver;
+
   if (dnsopts.family !== 4 && dnsopts.family !== 6 && dnsopts.hints === 0) {
     dnsopts.hints = dns.ADDRCONFIG;
   }
@@ -981,7 +1342,51 @@ function lookupAndConnect(self, options) {
   debug('connect: dns options', dnsopts);
   self._host = host;
   var lookup = options.lookup || dns.lookup;
-  lookup(host, dnsopts, function(err, ip, addressType) {
+
+  if (options.autoSelectFamily && !dnsopts.family && !localAddress &&
+      !localPort) {
+    var delay = options.autoSelectFamilyAttemptTimeout;
+    if (delay === undefined)
+      delay = kDefaultAutoSelectFamilyAttemptTimeout;
+    else if (typeof delay !== 'number' || !(delay >= 0))
+      throw new TypeError('"autoSelectFamilyAttemptTimeout" option must be ' +
+                          'a non-negative number');
+    dnsopts.all = true;
+    lookup(host, dnsopts, function(err, addresses, addressType) {
+      // A lookup function of its own may ignore `all`.
+      if (err || !Array.isArray(addresses)) {
+        onlookup(err, addresses, addressType);
+        return;
+      }
+      if (addresses.length === 0) {
+        onlookup(new Error('No addresses found'));
+        return;
+      }
+
+      const first = addresses[0];
+      var second = null;
+      for (var i = 1; i < addresses.length; i++) {
+        if (addresses[i].family !== first.family) {
+          second = addresses[i];
+          break;
+        }
+      }
+      if (second === null) {
+        onlookup(null, first.address, first.family);
+        return;
+      }
+
+      self.emit('lookup', null, first.address, first.family, host);
+      if (!self.connecting) return;
+      self._unrefTimer();
+      connectRace(self, [first, second], port, delay);
+    });
+    return;
+  }
+
+  lookup(host, dnsopts, onlookup);
+
+  function onlookup(err, ip, addressType) {
     self.emit('lookup', err, ip, addressType, host);
 
     // It's possible we were destroyed while looking this up.
@@ -1007,7 +1412,116 @@ function lookupAndConnect(self, options) {
               localAddress,
               localPort);
     }
-  });
+  }
+}
+
+
+// Races a connection to an address of each family, the second attempt
+// starting |delay| ms after the first or as soon as it fails, as in RFC
+// 8305.  The first one to connect wins and the other one is closed.  Until
+// then the socket has no handle, so options like setNoDelay() that are set
+// in the meantime wait for 'connect' and end up on the winning handle.
+function connectRace(self, addresses, port, delay) {
+  const race = {
+    addresses: addresses,
+    port: port,
+    delay: delay,
+    next: 0,
+    attempts: [],
+    timer: null
+  };
+  self._connectRace = race;
+  self._handle.close();
+  self._handle = null;
+  startRaceAttempt(self, race);
+}
+
+
+function startRaceAttempt(self, race) {
+  clearTimeout(race.timer);
+  race.timer = null;
+
+  const address = race.addresses[race.next++];
+  debug('connect: attempt', address.address);
+  const handle = new TCP();
+  handle.owner = self;
+  const req = new TCPConnectWrap();
+  req.oncomplete = afterRaceConnect;
+  req.address = address.address;
+  req.port = race.port;
+
+  var err;
+  if (address.family === 4)
+    err = handle.connect(req, address.address, race.port);
+  else
+    err = handle.connect6(req, address.address, race.port);
+
+  if (err) {
+    handle.close();
+    raceAttemptFailed(self, race, err, req);
+    return;
+  }
+
+  race.attempts.push(handle);
+  if (race.next < race.addresses.length)
+    race.timer = setTimeout(startRaceAttempt, race.delay, self, race);
+}
+
+
+function afterRaceConnect(status, handle, req, readable, writable) {
+  const self = handle.owner;
+  const race = self._connectRace;
+  // The race may have been decided or aborted, which closed the handle.
+  if (!race)
+    return;
+  const index = race.attempts.indexOf(handle);
+  if (index === -1)
+    return;
+  race.attempts.splice(index, 1);
+
+  if (status !== 0) {
+    handle.close();
+    raceAttemptFailed(self, race, status, req);
+    return;
+  }
+
+  debug('connect: attempt won', req.address);
+  endRace(self, race);
+  self._handle = handle;
+  initSocketHandle(self);
+  afterConnect(status, handle, req, readable, writable);
+}
+
+
+function raceAttemptFailed(self, race, status, req) {
+  debug('connect: attempt failed', req.address);
+  if (race.next < race.addresses.length) {
+    startRaceAttempt(self, race);
+  } else if (race.attempts.length === 0) {
+    // All of them failed, report the last one.
+    endRace(self, race);
+    self._handle = new TCP();
+    initSocketHandle(self);
+    afterConnect(status, self._handle, req, false, false);
+  }
+}
+
+
+function endRace(self, race) {
+  clearTimeout(race.timer);
+  for (var i = 0; i < race.attempts.length; i++)
+    race.attempts[i].close();
+  race.attempts.length = 0;
+  self._connectRace = null;
+}
+
+
+function abortConnectRace(self) {
+  endRace(self, self._connectRace);
+  // A handle to close, so that 'close' is emitted as usual.
+  const handle = new TCP();
+  handle.owner = self;
+  return handle;
 }
 
 
@@ -1135,6 +1649,10 @@ function Server(options, connectionListener) {
 
   this.allowHalfOpen = options.allowHalfOpen || false;
   this.pauseOnConnect = !!options.pauseOnConnect;
+  this.coalesceWrites = !!options.coalesceWrites;
+  this.slabReads = !!options.slabReads;
+  this.sharedReadBuffer = !!options.sharedReadBuffer;
+  this.acceptBatch = options.acceptBatch >>> 0;
 }
 util.inherits(Server, EventEmitter);
 exports.Server = Server;
@@ -1149,7 +1667,8 @@ function _listen(handle, backlog) {
   return handle.listen(backlog || 511);
 }
 
-function createServerHandle(address, port, addressType, fd) {
+// With reusePort, the socket is bound with SO_REUSEPORT, see cluster.js.
+function createServerHandle(address, port, addressType, fd, reusePort) {
   var err = 0;
   // assign handle in listen, and clean up if bind or listen fails
   var handle;
@@ -1185,16 +1704,16 @@ function createServerHandle(address, port, addressType, fd) {
     debug('bind to ' + (address || 'anycast'));
     if (!address) {
       // Try binding to ipv6 first
-      err = handle.bind6('::', port);
+      err = handle.bind6('::', port, reusePort);
       if (err) {
         handle.close();
         // Fallback to ipv4
-        return createServerHandle('0.0.0.0', port);
+        return createServerHandle('0.0.0.0', port, 4, undefined, reusePort);
       }
     } else if (addressType === 6) {
-      err = handle.bind6(address, port);
+      err = handle.bind6(address, port, reusePort);
     } else {
-      err = handle.bind(address, port);
+      err = handle.bind(address, port, reusePort);
     }
   }
 
@@ -1245,8 +1764,13 @@ Server.prototype._listen2 = function(address, port, addressType, backlog, fd) {
   }
 
   this._handle.onconnection = onconnection;
+  this._handle.onconnections = onconnections;
   this._handle.owner = this;
 
+  // Pipes and handles that were passed in by the cluster master don't batch.
+  if (this.acceptBatch > 1 && typeof this._handle.setAcceptBatch === 'function')
+    this._handle.setAcceptBatch(this.acceptBatch);
+
   var err = _listen(this._handle, backlog);
 
   if (err) {
@@ -1436,15 +1960,44 @@ function onconnection(err, clientHandle) {
     return;
   }
 
+  acceptConnection(self, clientHandle);
+}
+
+
+// The connections that were accepted in one turn of the event loop, see
+// server.acceptBatch.
+function onconnections(err, clientHandles) {
+  var handle = this;
+  var self = handle.owner;
+
+  debug('onconnections', clientHandles.length);
+
+  for (var i = 0; i < clientHandles.length; i++) {
+    // The server may have been closed by one of the 'connection' listeners.
+    if (self._handle === null)
+      clientHandles[i].close();
+    else
+      acceptConnection(self, clientHandles[i]);
+  }
+}
+
+
+function acceptConnection(self, clientHandle) {
   if (self.maxConnections && self._connections >= self.maxConnections) {
     clientHandle.close();
     return;
   }
 
+  if (self.slabReads)
+    clientHandle.setReadSlab(true);
+  if (self.sharedReadBuffer)
+    clientHandle.setSharedReadBuffer(true);
+
   var socket = new Socket({
     handle: clientHandle,
     allowHalfOpen: self.allowHalfOpen,
-    pauseOnCreate: self.pauseOnConnect
+    pauseOnCreate: self.pauseOnConnect,
+    coalesceWrites: self.coalesceWrites
   });
   socket.readable = socket.writable = true;
 
@@ -1578,6 +2131,59 @@ Server.prototype.unref = function() {
 };
 
 
+// Sockets whose handle can take the data right now without it overtaking
+// writes that wait in JS.
+function canBroadcast(socket) {
+  const state = socket._writableState;
+  return socket._handle !== null &&
+         socket._handle._externalStream !== undefined &&
+         !socket.connecting &&
+         socket.writable &&
+         state.length === 0 &&
+         state.corked === 0;
+}
+
+// Writes the same data to many sockets with one call into C++, where the
+// sockets share the Buffer.  Sockets that are still connecting or have
+// writes waiting get a plain write() to keep their data in order.
+exports.broadcast = function(sockets, data, encoding) {
+  if (!Array.isArray(sockets))
+    throw new TypeError('"sockets" argument must be an Array of sockets');
+  if (typeof data === 'string')
+    data = Buffer.from(data, encoding);
+  else if (!(data instanceof Buffer))
+    throw new TypeError('"data" argument must be a string or a Buffer');
+
+  const handles = [];
+  const targets = [];
+  for (var i = 0; i < sockets.length; i++) {
+    const socket = sockets[i];
+    if (!(socket instanceof Socket))
+      throw new TypeError('"sockets" argument must be an Array of sockets');
+    if (data.length > 0 && canBroadcast(socket)) {
+      socket._unrefTimer();
+      handles.push(socket._handle._externalStream);
+      targets.push(socket);
+    } else if (socket.writable) {
+      socket.write(data);
+    }
+  }
+  if (handles.length === 0)
+    return;
+
+  const errors = broadcastHandles(handles, data);
+  for (i = 0; i < targets.length; i++)
+    targets[i]._bytesDispatched += data.length;
+  if (errors === undefined)
+    return;
+  for (i = 0; i < errors.length; i += 2) {
+    const socket = targets[errors[i]];
+    socket._bytesDispatched -= data.length;
+    socket._destroy(errnoException(errors[i + 1], 'write'));
+  }
+};
+
+
 exports.isIP = cares.isIP;
 
 
@@ -2,6 +2,7 @@
 
 const binding = process.binding('os');
 const internalUtil = require('internal/util');
+const util = require('util');
 const isWindows = process.platform === 'win32';
 
 exports.hostname = binding.getHostname;
@@ -17,6 +18,32 @@ exports.homedir = binding.getHomeDirectory;
 exports.userInfo = binding.getUserInfo;
 
 
+// user, nice, sys, idle and irq, see CPUTimesField in src/node_os.cc.
+const kCPUTimesFieldCount = 5;
+var cpuTimesLength = 0;
+
+exports.cpuTimes = function cpuTimes(array) {
+  if (array !== undefined && !(array instanceof Float64Array))
+    throw new TypeError('"array" argument must be a Float64Array');
+  if (array === undefined)
+    array = new Float64Array(cpuTimesLength);
+
+  var count = binding.getCPUTimes(array);
+  if (count < 0)
+    throw util._errnoException(count, 'cpuTimes');
+  // A CPU came online, or this is the first call.
+  if (count * kCPUTimesFieldCount > array.length) {
+    cpuTimesLength = count * kCPUTimesFieldCount;
+    array = new Float64Array(cpuTimesLength);
+    count = binding.getCPUTimes(array);
+    if (count < 0)
+      throw util._errnoException(count, 'cpuTimes');
+  }
+  return array.length === count * kCPUTimesFieldCount ?
+      array : array.subarray(0, count * kCPUTimesFieldCount);
+};
+
+
 exports.arch = function() {
   return process.arch;
 };
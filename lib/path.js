@@ -1,6 +1,12 @@
 'use strict';
 
 const inspect = require('util').inspect;
+const binding = process.binding('path');
+
+// Shorter paths are normalized by the JS loop, for which the call into C++
+// costs more than it saves.
+const kNativeMinLength = 64;
+const kResolverMaxEntries = 1000;
 
 function assertPath(path) {
   if (typeof path !== 'string') {
@@ -76,6 +82,9 @@ function normalizeStringWin32(path, allowAboveRoot) {
 
 // Resolves . and .. elements in a path with directory names
 function normalizeStringPosix(path, allowAboveRoot) {
+  if (path.length >= kNativeMinLength)
+    return binding.normalizeStringPosix(path, allowAboveRoot);
+
   var res = '';
   var lastSlash = -1;
   var dots = 0;
@@ -140,6 +149,49 @@ function normalizeStringPosix(path, allowAboveRoot) {
   return res;
 }
 
+// Memoizes posix.resolve() for the paths that follow the last absolute
+// argument, or that follow the current directory when they are all relative.
+function createPosixResolver(maxEntries) {
+  const cache = new Map();
+  return function resolve() {
+    var key = '';
+    var absolute = false;
+    for (var i = arguments.length - 1; i >= 0; i--) {
+      const path = arguments[i];
+      assertPath(path);
+      // NUL can't be told apart from the separator of the key.
+      if (path.indexOf('\u0000') !== -1)
+        return posix.resolve.apply(null, arguments);
+      key = i === arguments.length - 1 ? path : path + '\u0000' + key;
+      if (path.charCodeAt(0) === 47/*/*/) {
+        absolute = true;
+        break;
+      }
+    }
+    if (!absolute)
+      key = process.cwd() + '\u0000' + key;
+
+    var resolved = cache.get(key);
+    if (resolved === undefined) {
+      resolved = posix.resolve.apply(null, arguments);
+      if (cache.size >= maxEntries)
+        cache.delete(cache.keys().next().value);
+      cache.set(key, resolved);
+    }
+    return resolved;
+  };
+}
+
+function validateMaxEntries(maxEntries) {
+  if (maxEntries === undefined)
+    return kResolverMaxEntries;
+  if (typeof maxEntries !== 'number' || maxEntries < 1 ||
+      !Number.isInteger(maxEntries)) {
+    throw new TypeError('"maxEntries" must be a positive integer');
+  }
+  return maxEntries;
+}
+
 function _format(sep, pathObject) {
   const dir = pathObject.dir || pathObject.root;
   const base = pathObject.base ||
@@ -1119,6 +1171,15 @@ const win32 = {
   },
 
 
+  // The result depends on per-drive directories too, so nothing is cached.
+  createResolver: function createResolver(maxEntries) {
+    validateMaxEntries(maxEntries);
+    return function resolve() {
+      return win32.resolve.apply(null, arguments);
+    };
+  },
+
+
   sep: '\\',
   delimiter: ';',
   win32: null,
@@ -1578,6 +1639,11 @@ const posix = {
   },
 
 
+  createResolver: function createResolver(maxEntries) {
+    return createPosixResolver(validateMaxEntries(maxEntries));
+  },
+
+
   sep: '/',
   delimiter: ':',
   win32: null,
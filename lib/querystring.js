@@ -4,6 +4,11 @@
 
 const QueryString = exports;
 const Buffer = require('buffer').Buffer;
+const binding = process.binding('querystring');
+
+// Strings shorter than this are handled in JS, where they are faster than a
+// call into C++.
+const kNativeMinLength = 256;
 
 // This constructor is used to store parsed query string values. Instantiating
 // this is faster than explicitly calling `Object.create(null)` to get a
@@ -14,6 +19,9 @@ ParsedQueryString.prototype = Object.create(null);
 
 // a safe fast alternative to decodeURIComponent
 QueryString.unescapeBuffer = function(s, decodeSpaces) {
+  if (typeof s === 'string' && s.length >= kNativeMinLength)
+    return binding.unescapeBuffer(s, !!decodeSpaces);
+
   var out = Buffer.allocUnsafe(s.length);
   var state = 0;
   var n, m, hexchar;
@@ -102,6 +110,12 @@ QueryString.escape = function(str) {
     else
       str += '';
   }
+  if (str.length >= kNativeMinLength) {
+    const escaped = binding.escape(str);
+    if (escaped === undefined)
+      throw new URIError('URI malformed');
+    return escaped;
+  }
   var out = '';
   var lastPos = 0;
 
@@ -224,7 +238,8 @@ QueryString.parse = QueryString.decode = function(qs, sep, eq, options) {
 
   const obj = new ParsedQueryString();
 
-  if (typeof qs !== 'string' || qs.length === 0) {
+  const isBuffer = qs instanceof Buffer;
+  if ((typeof qs !== 'string' && !isBuffer) || qs.length === 0) {
     return obj;
   }
 
@@ -249,6 +264,17 @@ QueryString.parse = QueryString.decode = function(qs, sep, eq, options) {
   }
   const customDecode = (decode !== qsUnescape);
 
+  // Buffers are parsed as UTF-8, and always natively unless the JS code is
+  // needed for a custom decoder or separators that are not one ASCII
+  // character.
+  if ((isBuffer || qs.length >= kNativeMinLength) && !customDecode &&
+      isAsciiChar(sep) && typeof eq === 'string' && isAsciiChar(eq) &&
+      binding.parse(obj, qs, sep, eq, pairs)) {
+    return obj;
+  }
+  if (isBuffer)
+    qs = qs.toString();
+
   const keys = [];
   var lastPos = 0;
   var sepIdx = 0;
@@ -401,6 +427,11 @@ QueryString.parse = QueryString.decode = function(qs, sep, eq, options) {
 };
 
 
+function isAsciiChar(str) {
+  return str.length === 1 && str.charCodeAt(0) < 0x80;
+}
+
+
 // v8 does not optimize functions with try-catch blocks, so we isolate them here
 // to minimize the damage
 function decodeStr(s, decoder) {
@@ -18,6 +18,7 @@ const emitKeys = internalReadline.emitKeys;
 const getStringWidth = internalReadline.getStringWidth;
 const isFullWidthCodePoint = internalReadline.isFullWidthCodePoint;
 const stripVTControlCharacters = internalReadline.stripVTControlCharacters;
+const splitLines = process.binding('buffer').splitLines;
 
 
 exports.createInterface = function(input, output, completer, terminal) {
@@ -40,6 +41,8 @@ function Interface(input, output, completer, terminal) {
   }
 
   this._sawReturn = false;
+  // The Buffers with the start of a line that hasn't ended yet.
+  this._lineChunks = [];
 
   EventEmitter.call(this);
   var historySize;
@@ -95,6 +98,7 @@ function Interface(input, output, completer, terminal) {
   }
 
   function onend() {
+    flushLineChunks(self);
     if (typeof self._line_buffer === 'string' &&
         self._line_buffer.length > 0) {
       self.emit('line', self._line_buffer);
@@ -326,6 +330,10 @@ Interface.prototype._normalWrite = function(b) {
   if (b === undefined) {
     return;
   }
+  if (b instanceof Buffer && !this._line_buffer)
+    return splitWrite(this, b);
+
+  flushLineChunks(this);
   var string = this._decoder.write(b);
   if (this._sawReturn) {
     string = string.replace(/^\n/, '');
@@ -356,6 +364,41 @@ Interface.prototype._normalWrite = function(b) {
   }
 };
 
+// Splits Buffers into lines in C++, without decoding the chunks into strings
+// first.  The bytes of '\r' and '\n' never occur inside of UTF-8 sequences,
+// so the line endings can be looked for in the raw bytes.
+function splitWrite(self, b) {
+  var start = 0;
+  if (self._sawReturn) {
+    self._sawReturn = false;
+    if (b[0] === 0x0a)
+      start = 1;
+  }
+
+  const lines = [];
+  const end = splitLines(b, start, self._lineChunks, lines);
+  if (end === -1) {
+    if (start < b.length)
+      self._lineChunks.push(start === 0 ? b : b.slice(start));
+    return;
+  }
+
+  self._lineChunks = end < b.length ? [b.slice(end)] : [];
+  self._sawReturn = end === b.length && b[end - 1] === 0x0d;
+  for (var i = 0; i < lines.length; i++)
+    self._onLine(lines[i]);
+}
+
+// Decodes the start of the unfinished line, for when it continues in a
+// string or the input ends.
+function flushLineChunks(self) {
+  if (self._lineChunks.length === 0)
+    return;
+  const string = self._decoder.write(Buffer.concat(self._lineChunks));
+  self._lineChunks = [];
+  self._line_buffer = (self._line_buffer || '') + string;
+}
+
 Interface.prototype._insertString = function(c) {
   if (this.cursor < this.line.length) {
     var beg = this.line.slice(0, this.cursor);
@@ -1,11 +1,15 @@
 'use strict';
 
-const TimerWrap = process.binding('timer_wrap').Timer;
+const timerWrap = process.binding('timer_wrap');
+const TimerWrap = timerWrap.Timer;
+const timerInfo = timerWrap.timerInfo;
 const L = require('internal/linkedlist');
 const assert = require('assert');
 const util = require('util');
 const debug = util.debuglog('timer');
 const kOnTimeout = TimerWrap.kOnTimeout | 0;
+// Index of the loop time in timerInfo, see Environment::TimerInfo.
+const kNow = 0;
 
 // Timeout values > TIMEOUT_MAX are set to 1.
 const TIMEOUT_MAX = 2147483647; // 2^31-1
@@ -120,7 +124,11 @@ function insert(item, unrefed) {
   const msecs = item._idleTimeout;
   if (msecs < 0 || msecs === undefined) return;
 
-  item._idleStart = TimerWrap.now();
+  // Refed timers must never fire early, so they read the clock.  The unrefed
+  // lists keep the idle timeouts that are re-inserted on every bit of
+  // activity, the loop time as of the last call into JS is close enough for
+  // those and doesn't need a call into the binding.
+  item._idleStart = unrefed === true ? timerInfo[kNow] : TimerWrap.now();
 
   const lists = unrefed === true ? unrefedLists : refedLists;
 
@@ -632,3 +640,85 @@ exports.clearImmediate = function(immediate) {
     process._needImmediateCallback = false;
   }
 };
+
+
+// Idle callbacks run while the event loop has nothing else to do, from the
+// idle scheduler of the Environment (src/node_idle_scheduler.h).
+var idleBinding = null;
+const idleQueue = [];
+
+function IdleCallback(callback, budget) {
+  this._onIdle = callback;
+  this._budget = budget;
+}
+
+
+function IdleDeadline(deadline) {
+  this._deadline = deadline;
+}
+
+IdleDeadline.prototype.timeRemaining = function() {
+  return Math.max(0, this._deadline - idleBinding.now());
+};
+
+
+function runIdleCallbacks(deadline) {
+  // Callbacks that are added by the ones that run wait for the next period.
+  const count = idleQueue.length;
+  var threw = true;
+  try {
+    for (var i = 0; i < count && idleBinding.now() < deadline; i++) {
+      const item = idleQueue.shift();
+      const callback = item._onIdle;
+      item._onIdle = null;
+      const own = Math.min(deadline, idleBinding.now() + item._budget);
+      callback(new IdleDeadline(own));
+    }
+    threw = false;
+  } finally {
+    if (idleQueue.length === 0)
+      idleBinding.unref();
+    else if (threw)
+      idleBinding.schedule();
+  }
+  return idleQueue.length > 0;
+}
+
+
+exports.setIdleCallback = function(callback, options) {
+  if (typeof callback !== 'function')
+    throw new TypeError('"callback" argument must be a function');
+
+  var budget = Infinity;
+  if (options !== undefined && options !== null &&
+      options.budgetMs !== undefined) {
+    budget = options.budgetMs;
+    if (typeof budget !== 'number' || !(budget >= 0))
+      throw new RangeError('"budgetMs" must be a non-negative number');
+  }
+
+  if (idleBinding === null) {
+    idleBinding = process.binding('idle_scheduler');
+    idleBinding.setup(runIdleCallbacks);
+  }
+
+  const item = new IdleCallback(callback, budget);
+  if (idleQueue.length === 0) {
+    idleBinding.ref();
+    idleBinding.schedule();
+  }
+  idleQueue.push(item);
+  return item;
+};
+
+
+exports.clearIdleCallback = function(item) {
+  if (!(item instanceof IdleCallback) || item._onIdle === null)
+    return;
+  item._onIdle = null;
+  const index = idleQueue.indexOf(item);
+  if (index !== -1)
+    idleQueue.splice(index, 1);
+  if (idleQueue.length === 0)
+    idleBinding.unref();
+};
@@ -1,6 +1,7 @@
 'use strict';
 
 const punycode = require('punycode');
+const binding = process.binding('url');
 
 exports.parse = urlParse;
 exports.resolve = urlResolve;
@@ -60,6 +61,9 @@ const slashedProtocol = {
 };
 const querystring = require('querystring');
 
+// Filled by binding.parse() with the offsets of the URL components.
+const nativeOffsets = new Int32Array(binding.kOffsetsCount);
+
 // This constructor is used to store parsed query string values. Instantiating
 // this is faster than explicitly calling `Object.create(null)` to get a
 // "clean" empty object (tested with v8 v4.9).
@@ -79,6 +83,11 @@ Url.prototype.parse = function(url, parseQueryString, slashesDenoteHost) {
     throw new TypeError('Parameter "url" must be a string, not ' + typeof url);
   }
 
+  // Common URLs are split natively, the rest below.
+  const flags = binding.parse(url, nativeOffsets);
+  if (flags !== undefined)
+    return parseFromOffsets(this, url, flags, parseQueryString);
+
   // Copy chrome, IE, opera backslash-handling behavior.
   // Back slashes before the query string get converted to forward slashes
   // See: https://code.google.com/p/chromium/issues/detail?id=25916
@@ -394,6 +403,72 @@ Url.prototype.parse = function(url, parseQueryString, slashesDenoteHost) {
   return this;
 };
 
+// Sets the fields like the JS parser does, from the offsets that
+// binding.parse() found.  The URL has nothing to trim, escape or decode.
+function parseFromOffsets(self, url, flags, parseQueryString) {
+  const protocolEnd = nativeOffsets[binding.kProtocolEnd];
+  const hostEnd = nativeOffsets[binding.kHostEnd];
+  const searchStart = nativeOffsets[binding.kSearchStart];
+  const hashStart = nativeOffsets[binding.kHashStart];
+  var pathStart = 0;
+
+  if (protocolEnd !== -1) {
+    const authStart = nativeOffsets[binding.kAuthStart];
+    const hostStart = nativeOffsets[binding.kHostStart];
+    const hostnameEnd = nativeOffsets[binding.kHostnameEnd];
+
+    var protocol = url.slice(0, protocolEnd);
+    if (flags & binding.kUpperCaseProtocol)
+      protocol = protocol.toLowerCase();
+    self.protocol = protocol;
+    self.slashes = true;
+    if (authStart !== -1)
+      self.auth = url.slice(authStart, hostStart - 1);
+
+    var hostname = url.slice(hostStart, hostnameEnd);
+    if (flags & binding.kUpperCaseHostname)
+      hostname = hostname.toLowerCase();
+    self.hostname = hostname;
+    if (hostEnd - hostnameEnd > 1)
+      self.port = url.slice(hostnameEnd + 1, hostEnd);
+    self.host = self.port ? hostname + ':' + self.port : hostname;
+    pathStart = hostEnd;
+  }
+
+  const end = hashStart === -1 ? url.length : hashStart;
+  if (hashStart !== -1)
+    self.hash = url.slice(hashStart);
+
+  if (searchStart !== -1) {
+    self.search = url.slice(searchStart, end);
+    self.query = url.slice(searchStart + 1, end);
+    if (parseQueryString)
+      self.query = querystring.parse(self.query);
+  } else if (parseQueryString) {
+    self.search = '';
+    self.query = new ParsedQueryString();
+  }
+
+  const pathEnd = searchStart === -1 ? end : searchStart;
+  if (pathEnd > pathStart)
+    self.pathname = url.slice(pathStart, pathEnd);
+  else if (protocolEnd !== -1)
+    self.pathname = '/';
+
+  if (self.pathname || self.search)
+    self.path = (self.pathname || '') + (self.search || '');
+
+  if (protocolEnd === -1) {
+    self.href = url;
+  } else {
+    // There always is a pathname, so there always is a path.
+    const auth = self.auth ? self.auth + '@' : '';
+    const hash = self.hash || '';
+    self.href = self.protocol + '//' + auth + self.host + self.path + hash;
+  }
+  return self;
+}
+
 function validateHostname(self, rest, hostname) {
   for (var i = 0, lastPos; i <= hostname.length; ++i) {
     var code;
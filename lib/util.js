@@ -896,6 +896,15 @@ exports.inherits = function(ctor, superCtor) {
   Object.setPrototypeOf(ctor.prototype, superCtor.prototype);
 };
 
+// Loaded on first use, the streams module needs util itself.
+Object.defineProperty(exports, 'JSONParser', {
+  configurable: true,
+  enumerable: true,
+  get: function() {
+    return require('internal/json_parser').JSONParser;
+  }
+});
+
 exports._extend = function(origin, add) {
   // Don't do anything if add isn't an object
   if (add === null || typeof add !== 'object') return origin;
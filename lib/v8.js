@@ -53,6 +53,26 @@ exports.getHeapStatistics = function() {
   };
 };
 
+// Properties for buffer arena statistics extraction, see BufferArena in
+// src/buffer_arena.h.
+const bufferArenaStatisticsBuffer =
+    new Float64Array(v8binding.kBufferArenaStatisticsPropertiesCount);
+
+exports.getBufferArenaStatistics = function() {
+  const buffer = bufferArenaStatisticsBuffer;
+
+  v8binding.updateBufferArenaStatistics(buffer);
+
+  return {
+    'reserved_size': buffer[v8binding.kArenaReservedSizeIndex],
+    'mapped_size': buffer[v8binding.kArenaMappedSizeIndex],
+    'used_size': buffer[v8binding.kArenaUsedSizeIndex],
+    'cached_size': buffer[v8binding.kArenaCachedSizeIndex],
+    'free_size': buffer[v8binding.kArenaFreeSizeIndex],
+    'released_size': buffer[v8binding.kArenaReleasedSizeIndex]
+  };
+};
+
 exports.setFlagsFromString = v8binding.setFlagsFromString;
 
 exports.getHeapSpaceStatistics = function() {
@@ -73,3 +93,145 @@ exports.getHeapSpaceStatistics = function() {
 
   return heapSpaceStatistics;
 };
+
+function validateUint32(value, name) {
+  if (typeof value !== 'number' || !(value > 0) || value !== (value >>> 0))
+    throw new TypeError(name + ' must be a positive integer');
+}
+
+var profiling = false;
+
+exports.startProfiling = function(samplingIntervalUs) {
+  if (samplingIntervalUs === undefined)
+    samplingIntervalUs = 1000;
+  validateUint32(samplingIntervalUs, 'samplingIntervalUs');
+  if (profiling)
+    throw new Error('CPU profiling is already running');
+
+  v8binding.startCpuProfiling(samplingIntervalUs);
+  profiling = true;
+};
+
+exports.stopProfiling = function() {
+  if (!profiling)
+    throw new Error('CPU profiling is not running');
+
+  profiling = false;
+  return v8binding.stopCpuProfiling();
+};
+
+var heapProfiling = false;
+
+exports.startSamplingHeapProfiler = function(sampleInterval, stackDepth) {
+  if (sampleInterval === undefined)
+    sampleInterval = 512 * 1024;
+  if (stackDepth === undefined)
+    stackDepth = 16;
+  validateUint32(sampleInterval, 'sampleInterval');
+  validateUint32(stackDepth, 'stackDepth');
+  if (heapProfiling || !v8binding.startSamplingHeapProfiler(sampleInterval,
+                                                             stackDepth)) {
+    throw new Error('The sampling heap profiler is already running');
+  }
+  heapProfiling = true;
+};
+
+exports.getSamplingHeapProfile = function() {
+  if (!heapProfiling)
+    throw new Error('The sampling heap profiler is not running');
+  return v8binding.getSamplingHeapProfile();
+};
+
+exports.stopSamplingHeapProfiler = function() {
+  const profile = exports.getSamplingHeapProfile();
+  v8binding.stopSamplingHeapProfiler();
+  heapProfiling = false;
+  return profile;
+};
+
+exports.writeHeapSnapshot = function(fd) {
+  if (typeof fd !== 'number' || fd !== (fd | 0) || fd < 0)
+    throw new TypeError('fd must be a file descriptor');
+  v8binding.writeHeapSnapshot(fd);
+};
+
+// Indexes into gcStatisticsArray, see GCStats in src/node_gc_stats.h.
+const gcStatistics = v8binding.gcStatisticsArray;
+const kGCFieldsPerType = v8binding.kGCFieldsPerType;
+const kGCCount = v8binding.kCount;
+const kGCDuration = v8binding.kDuration;
+const kGCMaxDuration = v8binding.kMaxDuration;
+const kGCFreed = v8binding.kFreed;
+const kGCTypeNames = [];
+kGCTypeNames[v8binding.kScavenge] = 'scavenge';
+kGCTypeNames[v8binding.kMarkSweepCompact] = 'markSweepCompact';
+kGCTypeNames[v8binding.kIncrementalMarking] = 'incrementalMarking';
+kGCTypeNames[v8binding.kProcessWeakCallbacks] = 'processWeakCallbacks';
+
+var gcTracking = false;
+
+exports.startGCTracking = function(listener) {
+  if (listener !== undefined && typeof listener !== 'function')
+    throw new TypeError('listener must be a function');
+  if (gcTracking)
+    throw new Error('GC tracking is already running');
+
+  if (listener) {
+    // The pauses come in batches of [type, startTime, duration, freed].
+    v8binding.setGCEventsFunction(function(events) {
+      const pauses = new Array(events.length / 4);
+      for (var i = 0; i < pauses.length; i++) {
+        pauses[i] = {
+          type: kGCTypeNames[events[i * 4]],
+          startTime: events[i * 4 + 1],
+          duration: events[i * 4 + 2],
+          freed: events[i * 4 + 3]
+        };
+      }
+      listener(pauses);
+    });
+  }
+  v8binding.startGCTracking();
+  gcTracking = true;
+};
+
+exports.stopGCTracking = function() {
+  if (!gcTracking)
+    throw new Error('GC tracking is not running');
+
+  gcTracking = false;
+  v8binding.stopGCTracking();
+  v8binding.setGCEventsFunction();
+};
+
+exports.getGCStatistics = function() {
+  const stats = {};
+  for (var i = 0; i < kGCTypeNames.length; i++) {
+    const offset = i * kGCFieldsPerType;
+    stats[kGCTypeNames[i]] = {
+      count: gcStatistics[offset + kGCCount],
+      duration: gcStatistics[offset + kGCDuration],
+      maxDuration: gcStatistics[offset + kGCMaxDuration],
+      freed: gcStatistics[offset + kGCFreed]
+    };
+  }
+  return stats;
+};
+
+exports.resetGCStatistics = v8binding.resetGCStatistics;
+
+// Indexes into heapSizerArray, see HeapSizer in src/node_heap_sizer.h.  The
+// array only exists with --adaptive-heap.
+const heapSizer = v8binding.heapSizerArray;
+
+exports.getAdaptiveHeapStatistics = function() {
+  if (heapSizer === undefined)
+    return null;
+  return {
+    scavenges: heapSizer[v8binding.kScavengeCount],
+    scavengeOverhead: heapSizer[v8binding.kScavengeOverhead],
+    promotionRate: heapSizer[v8binding.kPromotionRate],
+    fastGrowth: heapSizer[v8binding.kFastGrowth] === 1,
+    newSpaceSize: heapSizer[v8binding.kNewSpaceSize]
+  };
+};
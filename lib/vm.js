@@ -9,8 +9,9 @@ const Script = binding.ContextifyScript;
 //   with methods:
 //   - runInThisContext({ displayErrors = true } = {})
 //   - runInContext(sandbox, { displayErrors = true, timeout = undefined } = {})
-// - makeContext(sandbox)
+// - makeContext(sandbox[, pooled[, frozen]])
 // - isContext(sandbox)
+// - detachContext(sandbox), attachContext(holder, sandbox)
 // From this we build the entire documented API.
 
 Script.prototype.runInNewContext = function(sandbox, options) {
@@ -24,17 +25,66 @@ exports.createScript = function(code, options) {
   return new Script(code, options);
 };
 
-exports.createContext = function(sandbox) {
+exports.createContext = function(sandbox, options) {
   if (sandbox === undefined) {
     sandbox = {};
   } else if (binding.isContext(sandbox)) {
     return sandbox;
   }
 
-  binding.makeContext(sandbox);
+  var frozen = options !== undefined && options !== null && !!options.frozen;
+  binding.makeContext(sandbox, false, frozen);
   return sandbox;
 };
 
+// Keeps the V8 contexts of released sandboxes, so that acquire() can give
+// them to new sandboxes instead of creating a context every time.
+function ContextPool(options) {
+  if (!(this instanceof ContextPool))
+    return new ContextPool(options);
+
+  var max = 16;
+  if (options !== undefined && options.max !== undefined)
+    max = options.max;
+  if (typeof max !== 'number' || max < 0 || max !== (max | 0))
+    throw new TypeError('options.max must be a non-negative integer');
+
+  this.max = max;
+  this._free = [];
+  this._acquired = new WeakSet();
+}
+
+ContextPool.prototype.acquire = function(sandbox) {
+  if (sandbox === undefined) {
+    sandbox = {};
+  } else if (sandbox === null || typeof sandbox !== 'object') {
+    throw new TypeError('sandbox argument must be an object');
+  } else if (binding.isContext(sandbox)) {
+    throw new Error('sandbox argument is already a context');
+  }
+
+  if (this._free.length > 0)
+    binding.attachContext(this._free.pop(), sandbox);
+  else
+    binding.makeContext(sandbox, true);
+  this._acquired.add(sandbox);
+  return sandbox;
+};
+
+ContextPool.prototype.release = function(sandbox) {
+  if (sandbox === null || typeof sandbox !== 'object' ||
+      !this._acquired.has(sandbox)) {
+    throw new TypeError('sandbox argument was not acquired from this pool');
+  }
+  this._acquired.delete(sandbox);
+
+  var holder = binding.detachContext(sandbox);
+  if (holder !== undefined && this._free.length < this.max)
+    this._free.push(holder);
+};
+
+exports.ContextPool = ContextPool;
+
 exports.runInDebugContext = function(code) {
   return binding.runInDebugContext(code);
 };
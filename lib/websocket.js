@@ -0,0 +1,305 @@
+'use strict';
+
+const EventEmitter = require('events');
+const util = require('util');
+const buffer = require('buffer');
+const Buffer = buffer.Buffer;
+const crypto = process.versions.openssl ? require('crypto') : null;
+const binding = process.binding('websocket_wrap');
+const debug = util.debuglog('websocket');
+
+const Handle = binding.WebSocketWrap;
+const kOnMessage = Handle.kOnMessage | 0;
+const kOnPing = Handle.kOnPing | 0;
+const kOnPong = Handle.kOnPong | 0;
+const kOnClose = Handle.kOnClose | 0;
+const kOnError = Handle.kOnError | 0;
+const kOnDrain = Handle.kOnDrain | 0;
+
+const kGuid = '258EAFA5-E914-47DA-95CA-C5AB0DC85B11';
+const kDefaultMaxPayload = 100 * 1024 * 1024;
+// send() returns false once this much is waiting to be written.
+const kHighWaterMark = 16 * 1024;
+const kEmpty = Buffer.alloc(0);
+// What is answered to a permessage-deflate offer, the only form that
+// src/websocket_wrap.cc implements.
+const kDeflateResponse = 'permessage-deflate; server_no_context_takeover; ' +
+                         'client_no_context_takeover';
+
+
+function WebSocket(socket, options) {
+  if (!(this instanceof WebSocket))
+    return new WebSocket(socket, options);
+  EventEmitter.call(this);
+  options = options || {};
+
+  if (!socket || !socket._handle || !socket._handle._externalStream)
+    throw new TypeError('"socket" must be a connected net.Socket');
+  var maxPayload = options.maxPayload;
+  if (maxPayload === undefined)
+    maxPayload = kDefaultMaxPayload;
+  if (typeof maxPayload !== 'number' || maxPayload < 0 ||
+      maxPayload > buffer.kMaxLength) {
+    throw new RangeError('"maxPayload" must be a number between 0 and ' +
+                         buffer.kMaxLength);
+  }
+
+  const handle = this._handle = new Handle(!!options.client,
+                                           maxPayload,
+                                           !!options.perMessageDeflate);
+  handle.owner = this;
+  handle[kOnMessage] = onmessage;
+  handle[kOnPing] = onping;
+  handle[kOnPong] = onpong;
+  handle[kOnClose] = onclose;
+  handle[kOnError] = onerror;
+  handle[kOnDrain] = ondrain;
+
+  this.socket = socket;
+  this.client = !!options.client;
+  this.perMessageDeflate = !!options.perMessageDeflate;
+  this.readyState = 'open';
+  this.bufferedAmount = 0;
+  this._closeCode = 1006;
+  this._closeReason = '';
+
+  if (typeof socket.setNoDelay === 'function')
+    socket.setNoDelay(true);
+  socket.setTimeout(0);
+  socket.on('error', onsocketerror.bind(this));
+  socket.on('end', onsocketend.bind(this));
+  socket.on('close', onsocketclose.bind(this));
+
+  this._attach(options.head);
+}
+util.inherits(WebSocket, EventEmitter);
+
+// Hands the socket's reads over to the binding, then passes on `head` and
+// whatever the socket has read already.  The binding doesn't read before
+// the next turn of the event loop, so the order is kept.
+WebSocket.prototype._attach = function(head) {
+  const socket = this.socket;
+  const err = this._handle.consume(socket._handle._externalStream);
+  if (err)
+    return this._destroy(util._errnoException(err, 'read'));
+  if (head && head.length > 0)
+    this._handle.receive(head);
+  var chunk;
+  while (this.readyState !== 'closed' && (chunk = socket.read()) !== null)
+    this._handle.receive(chunk);
+};
+
+// Sends a text message for strings, a binary one for Buffers.
+WebSocket.prototype.send = function(data, options) {
+  options = options || {};
+  if (typeof data !== 'string' && !(data instanceof Buffer))
+    throw new TypeError('"data" must be a string or a Buffer');
+  if (this.readyState !== 'open')
+    throw new Error('WebSocket is not open');
+
+  var opcode = data instanceof Buffer ? Handle.kBinary : Handle.kText;
+  if (options.binary !== undefined)
+    opcode = options.binary ? Handle.kBinary : Handle.kText;
+  const compress = options.compress !== false;
+  const pending = this._handle.send(data, opcode, compress);
+  if (pending < 0)
+    return false;
+  this.bufferedAmount = pending;
+  return pending < kHighWaterMark;
+};
+
+WebSocket.prototype.ping = function(data) {
+  sendControl(this, Handle.kPing, data);
+};
+
+WebSocket.prototype.pong = function(data) {
+  sendControl(this, Handle.kPong, data);
+};
+
+function sendControl(ws, opcode, data) {
+  if (data === undefined)
+    data = kEmpty;
+  else if (typeof data === 'string')
+    data = Buffer.from(data);
+  else if (!(data instanceof Buffer))
+    throw new TypeError('"data" must be a string or a Buffer');
+  if (data.length > 125)
+    throw new RangeError('Control frames carry at most 125 bytes');
+  if (ws.readyState !== 'open')
+    throw new Error('WebSocket is not open');
+  const pending = ws._handle.send(data, opcode, false);
+  if (pending >= 0)
+    ws.bufferedAmount = pending;
+}
+
+// Starts the closing handshake.  The connection is closed once the peer
+// has answered.
+WebSocket.prototype.close = function(code, reason) {
+  if (this.readyState !== 'open')
+    return;
+  if (code !== undefined &&
+      (typeof code !== 'number' || code < 1000 || code > 4999 ||
+       code === 1004 || code === 1005 || code === 1006)) {
+    throw new RangeError('"code" must be a valid close code');
+  }
+  reason = Buffer.from(reason === undefined ? '' : String(reason));
+  if (reason.length > 123)
+    throw new RangeError('"reason" must be at most 123 bytes');
+  if (code === undefined && reason.length > 0)
+    code = 1000;
+  this.readyState = 'closing';
+  this._handle.close(code | 0, reason);
+};
+
+// Closes the connection without a closing handshake.
+WebSocket.prototype.terminate = function() {
+  this._destroy();
+};
+
+WebSocket.prototype._destroy = function(err) {
+  if (this.readyState === 'closed')
+    return;
+  debug('destroy', err);
+  this.readyState = 'closed';
+  this._handle.destroy();
+  this.socket.destroy();
+  if (err)
+    this.emit('error', err);
+};
+
+function onmessage(data, isBinary) {
+  this.owner.emit('message', data, isBinary);
+}
+
+function onping(data) {
+  this.owner.emit('ping', data);
+}
+
+function onpong(data) {
+  this.owner.emit('pong', data);
+}
+
+// The binding has answered the close frame already.  Servers close the
+// TCP connection, clients wait for the server to do so.
+function onclose(code, reason) {
+  const ws = this.owner;
+  ws._closeCode = code;
+  ws._closeReason = reason;
+  if (ws.readyState === 'open')
+    ws.readyState = 'closing';
+  if (!ws.client)
+    ws.socket.end();
+}
+
+// onerror(closeCode, message) for protocol errors, the binding has sent
+// the close frame.  onerror(uvError) for failed writes.
+function onerror(code, message) {
+  const ws = this.owner;
+  if (message === undefined)
+    return ws._destroy(util._errnoException(code, 'write'));
+  const err = new Error(message);
+  err.code = 'WEBSOCKET_PROTOCOL_ERROR';
+  err.closeCode = code;
+  ws._closeCode = code;
+  ws.readyState = 'closing';
+  ws.socket.end();
+  ws.emit('error', err);
+}
+
+function ondrain() {
+  const ws = this.owner;
+  ws.bufferedAmount = 0;
+  ws.emit('drain');
+}
+
+function onsocketerror(err) {
+  this._destroy(err);
+}
+
+function onsocketend() {
+  if (this.readyState !== 'closed')
+    this.socket.end();
+}
+
+function onsocketclose() {
+  if (this.readyState !== 'closed') {
+    this.readyState = 'closed';
+    this._handle.destroy();
+  }
+  this.emit('close', this._closeCode, this._closeReason);
+}
+
+
+// Whether one of the offers in Sec-WebSocket-Extensions is a
+// permessage-deflate that works without context takeover and with the
+// full window for what the server sends.
+function acceptsDeflate(header) {
+  if (typeof header !== 'string')
+    return false;
+  return header.split(',').some((offer) => {
+    const params = offer.split(';').map((param) => param.trim());
+    if (params[0] !== 'permessage-deflate')
+      return false;
+    return params.slice(1).every((param) => {
+      const pair = param.split('=');
+      const name = pair[0].trim();
+      const value = pair[1] === undefined ? undefined :
+                    pair[1].trim().replace(/^"|"$/g, '');
+      switch (name) {
+        case 'server_no_context_takeover':
+        case 'client_no_context_takeover':
+          return value === undefined;
+        case 'client_max_window_bits':
+          return value === undefined || /^(8|9|1[0-5])$/.test(value);
+        case 'server_max_window_bits':
+          return value === '15';
+        default:
+          return false;
+      }
+    });
+  });
+}
+
+// Completes the handshake of an 'upgrade' event of an http.Server and
+// returns the WebSocket, or null when the request was turned away.
+function upgrade(req, socket, head, options) {
+  options = options || {};
+  if (!crypto)
+    throw new Error('WebSocket handshakes need crypto support');
+
+  const key = req.headers['sec-websocket-key'];
+  if (req.method !== 'GET' ||
+      !/^websocket$/i.test(req.headers.upgrade) ||
+      req.headers['sec-websocket-version'] !== '13' ||
+      typeof key !== 'string' ||
+      !/^[A-Za-z0-9+/]{22}==$/.test(key.trim())) {
+    debug('bad handshake');
+    socket.end('HTTP/1.1 400 Bad Request\r\nConnection: close\r\n\r\n');
+    return null;
+  }
+
+  const accept = crypto.createHash('sha1')
+                       .update(key.trim() + kGuid)
+                       .digest('base64');
+  const deflate = !!options.perMessageDeflate &&
+                  acceptsDeflate(req.headers['sec-websocket-extensions']);
+  var response = 'HTTP/1.1 101 Switching Protocols\r\n' +
+                 'Upgrade: websocket\r\n' +
+                 'Connection: Upgrade\r\n' +
+                 `Sec-WebSocket-Accept: ${accept}\r\n`;
+  if (deflate)
+    response += `Sec-WebSocket-Extensions: ${kDeflateResponse}\r\n`;
+  socket.write(response + '\r\n');
+
+  return new WebSocket(socket, {
+    maxPayload: options.maxPayload,
+    perMessageDeflate: deflate,
+    head: head
+  });
+}
+
+
+module.exports = {
+  WebSocket,
+  upgrade
+};
@@ -0,0 +1,153 @@
+'use strict';
+
+const EventEmitter = require('events');
+const path = require('path');
+const util = require('util');
+
+const binding = process.binding('worker');
+
+const errnoException = util._errnoException;
+
+const isMainThread = binding.isMainThread;
+var parentPort = null;
+
+
+function Worker(filename) {
+  if (!(this instanceof Worker))
+    return new Worker(filename);
+
+  if (typeof filename !== 'string')
+    throw new TypeError('"filename" argument must be a string');
+
+  EventEmitter.call(this);
+
+  const handle = new binding.Worker(process.execPath, path.resolve(filename));
+  handle.owner = this;
+  handle.onmessage = onmessage;
+  handle.onerror = onerror;
+  handle.onexit = onexit;
+
+  const err = handle.start();
+  if (err)
+    throw errnoException(err, 'uv_thread_create');
+
+  this._handle = handle;
+}
+util.inherits(Worker, EventEmitter);
+
+
+Worker.prototype.postMessage = function(value) {
+  // Messages to a worker that exited are dropped, like the ones that are
+  // still queued when it exits.
+  if (this._handle !== null)
+    this._handle.postMessage(value);
+};
+
+
+Worker.prototype.terminate = function(callback) {
+  if (typeof callback === 'function')
+    this.once('exit', callback);
+  if (this._handle !== null)
+    this._handle.terminate();
+};
+
+
+Worker.prototype.ref = function() {
+  if (this._handle !== null)
+    this._handle.ref();
+};
+
+
+Worker.prototype.unref = function() {
+  if (this._handle !== null)
+    this._handle.unref();
+};
+
+
+function onmessage(value) {
+  this.owner.emit('message', value);
+}
+
+
+function onerror(value) {
+  this.owner.emit('error', toError(value));
+}
+
+
+function onexit(code) {
+  const worker = this.owner;
+  worker._handle = null;
+  worker.emit('exit', code);
+}
+
+
+// Errors don't survive serialization as such, they cross as plain objects.
+function fromError(er) {
+  if (!(er instanceof Error))
+    return { value: er };
+  return {
+    error: true,
+    name: er.name,
+    message: er.message,
+    stack: er.stack
+  };
+}
+
+
+function toError(value) {
+  if (!value.error)
+    return value.value;
+  const er = new Error(value.message);
+  er.name = value.name;
+  er.stack = value.stack;
+  return er;
+}
+
+
+// Called from the bootstrap code of a worker before its script runs.
+function _setupChild() {
+  parentPort = new EventEmitter();
+  module.exports.parentPort = parentPort;
+
+  parentPort.postMessage = function(value) {
+    binding.postMessageToParent(value);
+  };
+
+  // A 'message' listener keeps the worker alive.
+  parentPort.on('newListener', function(event) {
+    if (event === 'message' && this.listenerCount('message') === 0)
+      binding.setOnMessage(onparentmessage);
+  });
+  parentPort.on('removeListener', function(event) {
+    if (event === 'message' && this.listenerCount('message') === 0)
+      binding.setOnMessage(undefined);
+  });
+
+  // An uncaught exception ends the worker and becomes an 'error' event on
+  // the Worker object in the parent, instead of being printed.
+  const fatalException = process._fatalException;
+  process._fatalException = function(er) {
+    if (fatalException(er))
+      return true;
+    try {
+      binding.reportError(fromError(er));
+    } catch (e) {
+      binding.reportError(fromError(new Error(String(er))));
+    }
+    process.reallyExit(1);
+    return true;
+  };
+}
+
+
+function onparentmessage(value) {
+  parentPort.emit('message', value);
+}
+
+
+module.exports = {
+  Worker,
+  isMainThread,
+  parentPort,
+  _setupChild
+};
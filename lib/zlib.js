@@ -26,6 +26,12 @@ binding.Z_MIN_MEMLEVEL = 1;
 binding.Z_MAX_MEMLEVEL = 9;
 binding.Z_DEFAULT_MEMLEVEL = 8;
 
+// pigz-style parallel gzip.  Blocks are primed with the 32 KiB that precede
+// them, so they should be a lot larger than that.
+binding.Z_MIN_BLOCK = 32 * 1024;
+binding.Z_DEFAULT_BLOCK = 128 * 1024;
+binding.Z_DEFAULT_PARALLEL = 4;
+
 binding.Z_MIN_LEVEL = -1;
 binding.Z_MAX_LEVEL = 9;
 binding.Z_DEFAULT_LEVEL = binding.Z_DEFAULT_COMPRESSION;
@@ -71,6 +77,7 @@ exports.Gunzip = Gunzip;
 exports.DeflateRaw = DeflateRaw;
 exports.InflateRaw = InflateRaw;
 exports.Unzip = Unzip;
+exports.ParallelGzip = ParallelGzip;
 
 exports.createDeflate = function(o) {
   return new Deflate(o);
@@ -100,6 +107,35 @@ exports.createUnzip = function(o) {
   return new Unzip(o);
 };
 
+exports.createParallelGzip = function(o) {
+  return new ParallelGzip(o);
+};
+
+// Preset dictionaries that are shared by every stream that refers to them
+// by id, instead of being copied into each one.
+const dictionaries = new Set();
+
+exports.registerDictionary = function(dictionary) {
+  if (!(dictionary instanceof Buffer))
+    throw new TypeError('"dictionary" argument must be a Buffer');
+  var id = binding.registerDictionary(dictionary);
+  dictionaries.add(id);
+  return id;
+};
+
+exports.unregisterDictionary = function(id) {
+  if (!dictionaries.delete(id))
+    return false;
+
+  for (var entry of compressorPool) {
+    if (entry[1]._dictionary === id) {
+      entry[1].close();
+      compressorPool.delete(entry[0]);
+    }
+  }
+  return binding.unregisterDictionary(id);
+};
+
 
 // Convenience methods.
 // compress/decompress a string or buffer in one step.
@@ -112,7 +148,7 @@ exports.deflate = function(buffer, opts, callback) {
 };
 
 exports.deflateSync = function(buffer, opts) {
-  return zlibBufferSync(new Deflate(opts), buffer);
+  return compressSync(binding.DEFLATE, buffer, opts);
 };
 
 exports.gzip = function(buffer, opts, callback) {
@@ -124,7 +160,7 @@ exports.gzip = function(buffer, opts, callback) {
 };
 
 exports.gzipSync = function(buffer, opts) {
-  return zlibBufferSync(new Gzip(opts), buffer);
+  return compressSync(binding.GZIP, buffer, opts);
 };
 
 exports.deflateRaw = function(buffer, opts, callback) {
@@ -136,7 +172,7 @@ exports.deflateRaw = function(buffer, opts, callback) {
 };
 
 exports.deflateRawSync = function(buffer, opts) {
-  return zlibBufferSync(new DeflateRaw(opts), buffer);
+  return compressSync(binding.DEFLATERAW, buffer, opts);
 };
 
 exports.unzip = function(buffer, opts, callback) {
@@ -228,6 +264,51 @@ function zlibBuffer(engine, buffer, callback) {
   }
 }
 
+// The compression convenience methods share a Compressor for each
+// combination of options, unless the buffer is large enough for the setup
+// cost of a new zlib stream not to matter.  Registered dictionaries are part
+// of the options; dictionary buffers are not pooled.
+const kMaxPooledLength = 1024 * 1024;
+const compressorPool = new Map();
+
+function compressSync(mode, buffer, opts) {
+  if (typeof buffer === 'string')
+    buffer = Buffer.from(buffer);
+  if (!(buffer instanceof Buffer))
+    throw new TypeError('Not a string or buffer');
+
+  opts = opts || {};
+  if (buffer.length > kMaxPooledLength ||
+      opts.output !== undefined ||
+      opts.chunkSize !== undefined ||
+      opts.dictionary instanceof Buffer ||
+      opts.finishFlush !== undefined) {
+    var engine;
+    if (mode === binding.DEFLATE)
+      engine = new Deflate(opts);
+    else if (mode === binding.GZIP)
+      engine = new Gzip(opts);
+    else
+      engine = new DeflateRaw(opts);
+    return zlibBufferSync(engine, buffer);
+  }
+
+  var key = mode + ':' + opts.windowBits + ':' + opts.level + ':' +
+            opts.memLevel + ':' + opts.strategy + ':' + opts.dictionary;
+  var compressor = compressorPool.get(key);
+  if (compressor === undefined) {
+    compressor = new Compressor(mode, opts);
+    compressorPool.set(key, compressor);
+  }
+
+  try {
+    return compressor.compress(buffer);
+  } catch (err) {
+    compressorPool.delete(key);
+    throw err;
+  }
+}
+
 function zlibBufferSync(engine, buffer) {
   if (typeof buffer === 'string')
     buffer = Buffer.from(buffer);
@@ -291,35 +372,7 @@ function isValidFlushFlag(flag) {
          flag === binding.Z_BLOCK;
 }
 
-// the Zlib class they all inherit from
-// This thing manages the queue of requests, and returns
-// true or false if there is anything in the queue when
-// you call the .write() method.
-
-function Zlib(opts, mode) {
-  this._opts = opts = opts || {};
-  this._chunkSize = opts.chunkSize || exports.Z_DEFAULT_CHUNK;
-
-  Transform.call(this, opts);
-
-  if (opts.flush && !isValidFlushFlag(opts.flush)) {
-    throw new Error('Invalid flush flag: ' + opts.flush);
-  }
-  if (opts.finishFlush && !isValidFlushFlag(opts.finishFlush)) {
-    throw new Error('Invalid flush flag: ' + opts.finishFlush);
-  }
-
-  this._flushFlag = opts.flush || binding.Z_NO_FLUSH;
-  this._finishFlushFlag = typeof opts.finishFlush !== 'undefined' ?
-    opts.finishFlush : binding.Z_FINISH;
-
-  if (opts.chunkSize) {
-    if (opts.chunkSize < exports.Z_MIN_CHUNK ||
-        opts.chunkSize > exports.Z_MAX_CHUNK) {
-      throw new Error('Invalid chunk size: ' + opts.chunkSize);
-    }
-  }
-
+function validateOptions(opts) {
   if (opts.windowBits) {
     if (opts.windowBits < exports.Z_MIN_WINDOWBITS ||
         opts.windowBits > exports.Z_MAX_WINDOWBITS) {
@@ -352,10 +405,72 @@ function Zlib(opts, mode) {
   }
 
   if (opts.dictionary) {
-    if (!(opts.dictionary instanceof Buffer)) {
+    if (typeof opts.dictionary === 'number') {
+      if (!dictionaries.has(opts.dictionary))
+        throw new Error('Unknown dictionary: ' + opts.dictionary);
+    } else if (!(opts.dictionary instanceof Buffer)) {
       throw new Error('Invalid dictionary: it should be a Buffer instance');
     }
   }
+}
+
+// Thread pool priority of the asynchronous work of a stream.
+function priorityFlag(priority) {
+  if (priority === undefined || priority === 'normal')
+    return binding.UV_PRIORITY_NORMAL;
+  if (priority === 'high')
+    return binding.UV_PRIORITY_HIGH;
+  if (priority === 'low')
+    return binding.UV_PRIORITY_LOW;
+  throw new Error('Invalid priority: ' + priority);
+}
+
+// the Zlib class they all inherit from
+// This thing manages the queue of requests, and returns
+// true or false if there is anything in the queue when
+// you call the .write() method.
+
+function Zlib(opts, mode) {
+  this._opts = opts = opts || {};
+  this._chunkSize = opts.chunkSize || exports.Z_DEFAULT_CHUNK;
+
+  Transform.call(this, opts);
+
+  if (opts.flush && !isValidFlushFlag(opts.flush)) {
+    throw new Error('Invalid flush flag: ' + opts.flush);
+  }
+  if (opts.finishFlush && !isValidFlushFlag(opts.finishFlush)) {
+    throw new Error('Invalid flush flag: ' + opts.finishFlush);
+  }
+
+  this._flushFlag = opts.flush || binding.Z_NO_FLUSH;
+  this._finishFlushFlag = typeof opts.finishFlush !== 'undefined' ?
+    opts.finishFlush : binding.Z_FINISH;
+
+  if (opts.chunkSize) {
+    if (opts.chunkSize < exports.Z_MIN_CHUNK ||
+        opts.chunkSize > exports.Z_MAX_CHUNK) {
+      throw new Error('Invalid chunk size: ' + opts.chunkSize);
+    }
+  }
+
+  validateOptions(opts);
+  var priority = priorityFlag(opts.priority);
+
+  // Caller supplied output memory, used instead of allocating a new
+  // chunkSize buffer every time the current one fills up.
+  this._output = null;
+  if (opts.output !== undefined) {
+    var output = opts.output;
+    if (output instanceof Buffer)
+      output = [output];
+    if (!Array.isArray(output) || output.length === 0 ||
+        !output.every((b) => b instanceof Buffer && b.length > 0)) {
+      throw new TypeError('Invalid output: it should be a non-empty Buffer ' +
+                          'or an array of non-empty Buffers');
+    }
+    this._output = output;
+  }
 
   this._handle = new binding.Zlib(mode);
 
@@ -384,8 +499,12 @@ function Zlib(opts, mode) {
                     opts.memLevel || exports.Z_DEFAULT_MEMLEVEL,
                     strategy,
                     opts.dictionary);
+  if (priority !== binding.UV_PRIORITY_NORMAL)
+    this._handle.setPriority(priority);
 
-  this._buffer = Buffer.allocUnsafe(this._chunkSize);
+  this._outputIndex = 0;
+  this._buffer = this._output !== null ? this._output[0] :
+                                         Buffer.allocUnsafe(this._chunkSize);
   this._offset = 0;
   this._closed = false;
   this._level = level;
@@ -484,6 +603,23 @@ function emitCloseNT(self) {
   self.emit('close');
 }
 
+// Returns the buffer to continue writing the output into once the current
+// one is full.  Streams cycle through the caller's buffers; a synchronous
+// call runs out of room at the last one and gets null.
+Zlib.prototype._nextBuffer = function(async) {
+  if (this._output === null)
+    return Buffer.allocUnsafe(this._chunkSize);
+
+  var index = this._outputIndex + 1;
+  if (index === this._output.length) {
+    if (!async)
+      return null;
+    index = 0;
+  }
+  this._outputIndex = index;
+  return this._output[index];
+};
+
 Zlib.prototype._transform = function(chunk, encoding, cb) {
   var flushFlag;
   var ws = this._writableState;
@@ -517,7 +653,7 @@ Zlib.prototype._transform = function(chunk, encoding, cb) {
 
 Zlib.prototype._processChunk = function(chunk, flushFlag, cb) {
   var availInBefore = chunk && chunk.length;
-  var availOutBefore = this._chunkSize - this._offset;
+  var availOutBefore = this._buffer.length - this._offset;
   var inOff = 0;
 
   var self = this;
@@ -527,6 +663,7 @@ Zlib.prototype._processChunk = function(chunk, flushFlag, cb) {
   if (!async) {
     var buffers = [];
     var nread = 0;
+    var outOfRoom = false;
 
     var error;
     this.on('error', function(er) {
@@ -548,6 +685,13 @@ Zlib.prototype._processChunk = function(chunk, flushFlag, cb) {
       throw error;
     }
 
+    if (this._output !== null) {
+      _close(this);
+      if (outOfRoom)
+        throw new RangeError('Output buffers are too small');
+      return nread;
+    }
+
     if (nread >= kMaxLength) {
       _close(this);
       throw new RangeError(kRangeErrorMessage);
@@ -579,22 +723,27 @@ Zlib.prototype._processChunk = function(chunk, flushFlag, cb) {
     assert(have >= 0, 'have should not go down');
 
     if (have > 0) {
-      var out = self._buffer.slice(self._offset, self._offset + have);
-      self._offset += have;
       // serve some output to the consumer.
       if (async) {
-        self.push(out);
+        self.push(self._buffer.slice(self._offset, self._offset + have));
       } else {
-        buffers.push(out);
-        nread += out.length;
+        if (self._output === null)
+          buffers.push(self._buffer.slice(self._offset, self._offset + have));
+        nread += have;
       }
+      self._offset += have;
     }
 
     // exhausted the output buffer, or used all the input create a new one.
-    if (availOutAfter === 0 || self._offset >= self._chunkSize) {
-      availOutBefore = self._chunkSize;
+    if (availOutAfter === 0 || self._offset >= self._buffer.length) {
+      var next = self._nextBuffer(async);
+      if (next === null) {
+        outOfRoom = availOutAfter === 0;
+        return false;
+      }
+      self._buffer = next;
       self._offset = 0;
-      self._buffer = Buffer.allocUnsafe(self._chunkSize);
+      availOutBefore = next.length;
     }
 
     if (availOutAfter === 0) {
@@ -614,7 +763,7 @@ Zlib.prototype._processChunk = function(chunk, flushFlag, cb) {
                                       availInBefore,
                                       self._buffer,
                                       self._offset,
-                                      self._chunkSize);
+                                      availOutBefore);
       newReq.callback = callback; // this same function
       newReq.buffer = chunk;
       return;
@@ -628,6 +777,271 @@ Zlib.prototype._processChunk = function(chunk, flushFlag, cb) {
   }
 };
 
+// Parallel gzip.  The input is split into blocks that are deflated
+// concurrently in the thread pool, and the outputs are concatenated in order
+// into a single gzip member.
+const kGzipHeader = [0x1f, 0x8b, 8, 0, 0, 0, 0, 0, 0, 3];
+const kDictionarySize = 32 * 1024;
+
+function ParallelGzip(opts) {
+  if (!(this instanceof ParallelGzip)) return new ParallelGzip(opts);
+  opts = opts || {};
+
+  Transform.call(this, opts);
+
+  this._blockSize = opts.blockSize || exports.Z_DEFAULT_BLOCK;
+  this._parallel = opts.parallel || exports.Z_DEFAULT_PARALLEL;
+
+  if (this._blockSize < exports.Z_MIN_BLOCK)
+    throw new Error('Invalid block size: ' + opts.blockSize);
+  if (this._parallel !== (this._parallel >>> 0))
+    throw new Error('Invalid parallel: ' + opts.parallel);
+
+  this._level = exports.Z_DEFAULT_COMPRESSION;
+  if (typeof opts.level === 'number') this._level = opts.level;
+  if (this._level < exports.Z_MIN_LEVEL || this._level > exports.Z_MAX_LEVEL)
+    throw new Error('Invalid compression level: ' + opts.level);
+
+  this._memLevel = opts.memLevel || exports.Z_DEFAULT_MEMLEVEL;
+  if (this._memLevel < exports.Z_MIN_MEMLEVEL ||
+      this._memLevel > exports.Z_MAX_MEMLEVEL)
+    throw new Error('Invalid memLevel: ' + opts.memLevel);
+
+  this._strategy = exports.Z_DEFAULT_STRATEGY;
+  if (typeof opts.strategy === 'number') this._strategy = opts.strategy;
+
+  this._priority = priorityFlag(opts.priority);
+
+  this._input = [];
+  this._inputLength = 0;
+  this._dictionary = null;
+  this._blocks = [];
+  this._ending = false;
+  this._lastQueued = false;
+  this._callback = null;
+  this._crc = 0;
+  this._length = 0;
+  this._hadError = false;
+
+  this.push(Buffer.from(kGzipHeader));
+}
+util.inherits(ParallelGzip, Transform);
+
+ParallelGzip.prototype._transform = function(chunk, encoding, cb) {
+  if (!(chunk instanceof Buffer))
+    return cb(new Error('invalid input'));
+
+  this._input.push(chunk);
+  this._inputLength += chunk.length;
+  this._callback = cb;
+  this._pump();
+};
+
+ParallelGzip.prototype._flush = function(cb) {
+  this._ending = true;
+  this._callback = cb;
+  this._pump();
+};
+
+// Queues as many blocks as the parallelism allows, and calls back when the
+// remaining input does not fill a block, or when the stream is complete.
+ParallelGzip.prototype._pump = function() {
+  while (!this._hadError && this._blocks.length < this._parallel) {
+    if (this._inputLength >= this._blockSize &&
+        !(this._ending && this._inputLength === this._blockSize)) {
+      this._deflateBlock(takeInput(this, this._blockSize), false);
+    } else if (this._ending && !this._lastQueued) {
+      this._lastQueued = true;
+      this._deflateBlock(takeInput(this, this._inputLength), true);
+    } else {
+      break;
+    }
+  }
+
+  if (this._hadError || this._callback === null)
+    return;
+
+  if (this._ending) {
+    if (!this._lastQueued || this._blocks.length > 0)
+      return;
+    var trailer = Buffer.allocUnsafe(8);
+    trailer.writeUInt32LE(this._crc, 0);
+    trailer.writeUInt32LE(this._length % 0x100000000, 4);
+    this.push(trailer);
+  } else if (this._inputLength >= this._blockSize) {
+    return;
+  }
+
+  var cb = this._callback;
+  this._callback = null;
+  cb();
+};
+
+ParallelGzip.prototype._deflateBlock = function(input, last) {
+  var self = this;
+  var block = { done: false, out: null, crc: 0, length: input.length };
+  var req = binding.deflateBlock(input,
+                                 this._dictionary,
+                                 this._level,
+                                 this._memLevel,
+                                 this._strategy,
+                                 last,
+                                 this._priority);
+  req.buffer = input;
+  req.dictionary = this._dictionary;
+  req.oncomplete = function(errno, out, crc) {
+    if (self._hadError)
+      return;
+    if (errno !== binding.Z_OK)
+      return self._error(errno);
+    block.done = true;
+    block.out = out;
+    block.crc = crc;
+    self._emitBlocks();
+  };
+
+  this._blocks.push(block);
+  if (input.length >= kDictionarySize)
+    this._dictionary = input.slice(input.length - kDictionarySize);
+};
+
+// Blocks may complete out of order, output them in stream order.
+ParallelGzip.prototype._emitBlocks = function() {
+  while (this._blocks.length > 0 && this._blocks[0].done) {
+    var block = this._blocks.shift();
+    this._crc = binding.crc32Combine(this._crc, block.crc, block.length);
+    this._length += block.length;
+    this.push(block.out);
+  }
+  this._pump();
+};
+
+ParallelGzip.prototype._error = function(errno) {
+  this._hadError = true;
+  var error = new Error('Zlib error');
+  error.errno = errno;
+  error.code = exports.codes[errno];
+
+  var cb = this._callback;
+  this._callback = null;
+  if (cb)
+    cb(error);
+  else
+    this.emit('error', error);
+};
+
+// Removes the first n bytes from the pending input, without copying them
+// when they are in a single chunk.
+function takeInput(self, n) {
+  var block;
+  if (n === 0) {
+    block = Buffer.alloc(0);
+  } else if (self._input[0].length >= n) {
+    block = self._input[0].slice(0, n);
+    if (self._input[0].length === n)
+      self._input.shift();
+    else
+      self._input[0] = self._input[0].slice(n);
+  } else {
+    block = Buffer.allocUnsafe(n);
+    var offset = 0;
+    while (offset < n) {
+      var chunk = self._input[0];
+      var length = Math.min(chunk.length, n - offset);
+      chunk.copy(block, offset, 0, length);
+      offset += length;
+      if (length === chunk.length)
+        self._input.shift();
+      else
+        self._input[0] = chunk.slice(length);
+    }
+  }
+  self._inputLength -= n;
+  return block;
+}
+
+// A synchronous compressor that keeps its zlib stream and output memory
+// between calls.  Much cheaper than the convenience methods for compressing
+// many small payloads.
+const compressorModes = {
+  deflate: binding.DEFLATE,
+  deflateRaw: binding.DEFLATERAW,
+  gzip: binding.GZIP
+};
+
+exports.createCompressor = function(format, opts) {
+  var mode = compressorModes[format];
+  if (typeof mode !== 'number')
+    throw new TypeError('Unknown format: ' + format);
+  return new Compressor(mode, opts);
+};
+
+function Compressor(mode, opts) {
+  opts = opts || {};
+  validateOptions(opts);
+
+  var self = this;
+  this._error = null;
+  this._handle = new binding.Zlib(mode);
+  this._handle.onerror = function(message, errno) {
+    var error = new Error(message);
+    error.errno = errno;
+    error.code = exports.codes[errno];
+    self._error = error;
+  };
+
+  var level = exports.Z_DEFAULT_COMPRESSION;
+  if (typeof opts.level === 'number') level = opts.level;
+
+  var strategy = exports.Z_DEFAULT_STRATEGY;
+  if (typeof opts.strategy === 'number') strategy = opts.strategy;
+
+  this._handle.init(opts.windowBits || exports.Z_DEFAULT_WINDOWBITS,
+                    level,
+                    opts.memLevel || exports.Z_DEFAULT_MEMLEVEL,
+                    strategy,
+                    opts.dictionary);
+  this._dictionary = opts.dictionary;
+  this._closed = false;
+  this._checkError();
+}
+
+Compressor.prototype.compress = function(input, output, offset) {
+  if (this._closed)
+    throw new Error('zlib binding closed');
+  if (typeof input === 'string')
+    input = Buffer.from(input);
+  if (!(input instanceof Buffer))
+    throw new TypeError('Not a string or buffer');
+
+  if (output !== undefined) {
+    if (!(output instanceof Buffer))
+      throw new TypeError('"output" argument must be a Buffer');
+    offset = offset >>> 0;
+    if (offset > output.length)
+      throw new RangeError('"offset" is outside of buffer bounds');
+  }
+
+  var result = this._handle.compressSync(input, output, offset);
+  this._checkError();
+  return result;
+};
+
+Compressor.prototype.close = function() {
+  if (this._closed)
+    return;
+  this._closed = true;
+  this._handle.close();
+};
+
+Compressor.prototype._checkError = function() {
+  if (this._error === null)
+    return;
+  var error = this._error;
+  this.close();
+  throw error;
+};
+
 util.inherits(Deflate, Zlib);
 util.inherits(Inflate, Zlib);
 util.inherits(Gzip, Zlib);
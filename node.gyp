@@ -16,6 +16,7 @@
     'node_enable_v8_vtunejit%': 'false',
     'node_target_type%': 'executable',
     'node_core_target_name%': 'node',
+    'node_code_cache_path%': '',
     'library_files': [
       'lib/internal/bootstrap_node.js',
       'lib/_debug_agent.js',
@@ -33,6 +34,7 @@
       'lib/events.js',
       'lib/fs.js',
       'lib/http.js',
+      'lib/http2.js',
       'lib/_http_agent.js',
       'lib/_http_client.js',
       'lib/_http_common.js',
@@ -69,13 +71,19 @@
       'lib/util.js',
       'lib/v8.js',
       'lib/vm.js',
+      'lib/websocket.js',
+      'lib/worker.js',
       'lib/zlib.js',
       'lib/internal/child_process.js',
       'lib/internal/cluster.js',
+      'lib/internal/events.js',
       'lib/internal/freelist.js',
+      'lib/internal/json_parser.js',
       'lib/internal/linkedlist.js',
       'lib/internal/net.js',
       'lib/internal/module.js',
+      'lib/internal/module_archive.js',
+      'lib/internal/process/memory_pressure.js',
       'lib/internal/process/next_tick.js',
       'lib/internal/process/promises.js',
       'lib/internal/process/stdio.js',
@@ -83,11 +91,15 @@
       'lib/internal/process.js',
       'lib/internal/readline.js',
       'lib/internal/repl.js',
+      'lib/internal/shared_cache.js',
+      'lib/internal/shared_ring.js',
       'lib/internal/socket_list.js',
       'lib/internal/util.js',
       'lib/internal/v8_prof_polyfill.js',
       'lib/internal/v8_prof_processor.js',
+      'lib/internal/zygote.js',
       'lib/internal/streams/lazy_transform.js',
+      'lib/internal/streams/ring_buffer.js',
       'deps/v8/tools/splaytree.js',
       'deps/v8/tools/codemap.js',
       'deps/v8/tools/consarray.js',
@@ -123,33 +135,62 @@
       'sources': [
         'src/debug-agent.cc',
         'src/async-wrap.cc',
+        'src/buffer_arena.cc',
         'src/env.cc',
         'src/fs_event_wrap.cc',
         'src/cares_wrap.cc',
         'src/handle_wrap.cc',
         'src/js_stream.cc',
         'src/node.cc',
+        'src/node_async_accounting.cc',
+        'src/node_binary_log.cc',
         'src/node_buffer.cc',
+        'src/node_bench.cc',
         'src/node_config.cc',
         'src/node_constants.cc',
         'src/node_contextify.cc',
         'src/node_file.cc',
+        'src/node_gc_stats.cc',
+        'src/node_heap_sizer.cc',
+        'src/node_task_pool.cc',
+        'src/node_trace.cc',
+        'src/node_http_headers.cc',
+        'src/node_http2.cc',
+        'src/node_http2_core.cc',
         'src/node_http_parser.cc',
+        'src/node_idle_scheduler.cc',
+        'src/node_json_parser.cc',
+        'src/node_dns_cache.cc',
+        'src/node_log_writer.cc',
+        'src/node_loop_stats.cc',
+        'src/node_memory_pressure.cc',
         'src/node_javascript.cc',
         'src/node_main.cc',
         'src/node_os.cc',
+        'src/node_path.cc',
+        'src/node_platform.cc',
+        'src/node_querystring.cc',
         'src/node_revert.cc',
+        'src/node_script_cache.cc',
+        'src/node_serdes.cc',
+        'src/node_shared_cache.cc',
+        'src/node_shared_ring.cc',
+        'src/node_string_decoder.cc',
+        'src/node_url.cc',
         'src/node_util.cc',
         'src/node_v8.cc',
+        'src/node_worker.cc',
         'src/node_stat_watcher.cc',
         'src/node_watchdog.cc',
         'src/node_zlib.cc',
         'src/node_i18n.cc',
         'src/pipe_wrap.cc',
         'src/signal_wrap.cc',
+        'src/slab_allocator.cc',
         'src/spawn_sync.cc',
         'src/string_bytes.cc',
         'src/stream_base.cc',
+        'src/stream_pipe.cc',
         'src/stream_wrap.cc',
         'src/tcp_wrap.cc',
         'src/timer_wrap.cc',
@@ -157,26 +198,41 @@
         'src/process_wrap.cc',
         'src/udp_wrap.cc',
         'src/uv.cc',
+        'src/websocket_wrap.cc',
         # headers to make for a more pleasant IDE experience
         'src/async-wrap.h',
         'src/async-wrap-inl.h',
         'src/base-object.h',
         'src/base-object-inl.h',
+        'src/buffer_arena.h',
         'src/debug-agent.h',
         'src/env.h',
         'src/env-inl.h',
         'src/handle_wrap.h',
         'src/js_stream.h',
         'src/node.h',
+        'src/node_async_accounting.h',
         'src/node_buffer.h',
         'src/node_constants.h',
         'src/node_file.h',
+        'src/node_gc_stats.h',
+        'src/node_heap_sizer.h',
+        'src/node_http2_core.h',
         'src/node_http_parser.h',
         'src/node_internals.h',
+        'src/node_platform.h',
+        'src/node_idle_scheduler.h',
         'src/node_javascript.h',
+        'src/node_dns_cache.h',
+        'src/node_loop_stats.h',
+        'src/node_memory_pressure.h',
         'src/node_root_certs.h',
+        'src/node_script_cache.h',
+        'src/node_serdes.h',
+        'src/node_trace.h',
         'src/node_version.h',
         'src/node_watchdog.h',
+        'src/node_worker.h',
         'src/node_wrap.h',
         'src/node_revert.h',
         'src/node_i18n.h',
@@ -186,13 +242,17 @@
         'src/udp_wrap.h',
         'src/req-wrap.h',
         'src/req-wrap-inl.h',
+        'src/slab_allocator.h',
         'src/string_bytes.h',
         'src/stream_base.h',
         'src/stream_base-inl.h',
+        'src/stream_pipe.h',
         'src/stream_wrap.h',
+        'src/timer_wrap.h',
         'src/tree.h',
         'src/util.h',
         'src/util-inl.h',
+        'src/websocket_wrap.h',
         'src/util.cc',
         'src/string_search.cc',
         'deps/http_parser/http_parser.h',
@@ -270,6 +330,11 @@
             '<(SHARED_INTERMEDIATE_DIR)/blink', # for inspector
           ],
         }],
+        [ 'node_code_cache_path==""', {
+          'sources': [ 'src/node_code_cache_stub.cc' ],
+        }, {
+          'sources': [ '<(node_code_cache_path)' ],
+        }],
         [ 'node_use_openssl=="true"', {
           'defines': [ 'HAVE_OPENSSL=1' ],
           'sources': [
@@ -607,6 +672,16 @@
               'action_name': 'node_dtrace_provider_o',
               'inputs': [
                 '<(OBJ_DIR)/node/src/node_dtrace.o',
+                '<(OBJ_DIR)/node/src/async-wrap.o',
+                '<(OBJ_DIR)/node/src/node_file.o',
+                '<(OBJ_DIR)/node/src/node_http2.o',
+                '<(OBJ_DIR)/node/src/node_task_pool.o',
+                '<(OBJ_DIR)/node/src/pipe_wrap.o',
+                '<(OBJ_DIR)/node/src/stream_base.o',
+                '<(OBJ_DIR)/node/src/stream_pipe.o',
+                '<(OBJ_DIR)/node/src/stream_wrap.o',
+                '<(OBJ_DIR)/node/src/timer_wrap.o',
+                '<(OBJ_DIR)/node/src/websocket_wrap.o',
               ],
               'outputs': [
                 '<(OBJ_DIR)/node/src/node_dtrace_provider.o'
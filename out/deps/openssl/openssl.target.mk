@@ -0,0 +1,912 @@
+# This file is generated by gyp; do not edit.
+
+TOOLSET := target
+TARGET := openssl
+DEFS_Debug := \
+	'-D_REENTRANT' \
+	'-DPURIFY' \
+	'-DOPENSSL_NO_COMP' \
+	'-DOPENSSL_NO_SSL3' \
+	'-DOPENSSL_NO_HEARTBEATS' \
+	'-DENGINESDIR="/dev/null"' \
+	'-DTERMIOS' \
+	'-DOPENSSLDIR="/etc/ssl"' \
+	'-DL_ENDIAN' \
+	'-DAES_ASM' \
+	'-DCPUID_ASM' \
+	'-DOPENSSL_BN_ASM_MONT' \
+	'-DOPENSSL_CPUID_OBJ' \
+	'-DSHA1_ASM' \
+	'-DSHA256_ASM' \
+	'-DSHA512_ASM' \
+	'-DGHASH_ASM' \
+	'-DVPAES_ASM' \
+	'-DBN_ASM' \
+	'-DBF_ASM' \
+	'-DBNCO_ASM' \
+	'-DDES_ASM' \
+	'-DLIB_BN_ASM' \
+	'-DMD5_ASM' \
+	'-DOPENSSL_BN_ASM' \
+	'-DRIP_ASM' \
+	'-DRMD160_ASM' \
+	'-DWHIRLPOOL_ASM' \
+	'-DWP_ASM' \
+	'-DOPENSSL_BN_ASM_MONT5' \
+	'-DOPENSSL_BN_ASM_GF2m' \
+	'-DOPENSSL_IA32_SSE2' \
+	'-DBSAES_ASM' \
+	'-DDSO_DLFCN' \
+	'-DHAVE_DLFCN_H' \
+	'-DDEBUG' \
+	'-D_DEBUG'
+
+# Flags passed to all source files.
+CFLAGS_Debug := \
+	-Wno-missing-field-initializers \
+	-pthread \
+	-Wall \
+	-Wextra \
+	-Wno-unused-parameter \
+	-m64 \
+	-pthread \
+	-Wall \
+	-Wextra \
+	-Wno-unused-parameter \
+	-m64 \
+	-g \
+	-O0 \
+	-g \
+	-O0
+
+# Flags passed to only C files.
+CFLAGS_C_Debug :=
+
+# Flags passed to only C++ files.
+CFLAGS_CC_Debug := \
+	-fno-rtti \
+	-fno-exceptions \
+	-std=gnu++0x \
+	-fno-rtti \
+	-fno-exceptions \
+	-std=gnu++0x
+
+INCS_Debug := \
+	-I$(srcdir)/deps/openssl \
+	-I$(srcdir)/deps/openssl/openssl \
+	-I$(srcdir)/deps/openssl/openssl/crypto \
+	-I$(srcdir)/deps/openssl/openssl/crypto/asn1 \
+	-I$(srcdir)/deps/openssl/openssl/crypto/evp \
+	-I$(srcdir)/deps/openssl/openssl/crypto/md2 \
+	-I$(srcdir)/deps/openssl/openssl/crypto/modes \
+	-I$(srcdir)/deps/openssl/openssl/crypto/store \
+	-I$(srcdir)/deps/openssl/openssl/include
+
+DEFS_Release := \
+	'-D_REENTRANT' \
+	'-DPURIFY' \
+	'-DOPENSSL_NO_COMP' \
+	'-DOPENSSL_NO_SSL3' \
+	'-DOPENSSL_NO_HEARTBEATS' \
+	'-DENGINESDIR="/dev/null"' \
+	'-DTERMIOS' \
+	'-DOPENSSLDIR="/etc/ssl"' \
+	'-DL_ENDIAN' \
+	'-DAES_ASM' \
+	'-DCPUID_ASM' \
+	'-DOPENSSL_BN_ASM_MONT' \
+	'-DOPENSSL_CPUID_OBJ' \
+	'-DSHA1_ASM' \
+	'-DSHA256_ASM' \
+	'-DSHA512_ASM' \
+	'-DGHASH_ASM' \
+	'-DVPAES_ASM' \
+	'-DBN_ASM' \
+	'-DBF_ASM' \
+	'-DBNCO_ASM' \
+	'-DDES_ASM' \
+	'-DLIB_BN_ASM' \
+	'-DMD5_ASM' \
+	'-DOPENSSL_BN_ASM' \
+	'-DRIP_ASM' \
+	'-DRMD160_ASM' \
+	'-DWHIRLPOOL_ASM' \
+	'-DWP_ASM' \
+	'-DOPENSSL_BN_ASM_MONT5' \
+	'-DOPENSSL_BN_ASM_GF2m' \
+	'-DOPENSSL_IA32_SSE2' \
+	'-DBSAES_ASM' \
+	'-DDSO_DLFCN' \
+	'-DHAVE_DLFCN_H'
+
+# Flags passed to all source files.
+CFLAGS_Release := \
+	-Wno-missing-field-initializers \
+	-pthread \
+	-Wall \
+	-Wextra \
+	-Wno-unused-parameter \
+	-m64 \
+	-pthread \
+	-Wall \
+	-Wextra \
+	-Wno-unused-parameter \
+	-m64 \
+	-O3 \
+	-O3 \
+	-fno-omit-frame-pointer \
+	-fno-omit-frame-pointer
+
+# Flags passed to only C files.
+CFLAGS_C_Release :=
+
+# Flags passed to only C++ files.
+CFLAGS_CC_Release := \
+	-fno-rtti \
+	-fno-exceptions \
+	-std=gnu++0x \
+	-fno-rtti \
+	-fno-exceptions \
+	-std=gnu++0x
+
+INCS_Release := \
+	-I$(srcdir)/deps/openssl \
+	-I$(srcdir)/deps/openssl/openssl \
+	-I$(srcdir)/deps/openssl/openssl/crypto \
+	-I$(srcdir)/deps/openssl/openssl/crypto/asn1 \
+	-I$(srcdir)/deps/openssl/openssl/crypto/evp \
+	-I$(srcdir)/deps/openssl/openssl/crypto/md2 \
+	-I$(srcdir)/deps/openssl/openssl/crypto/modes \
+	-I$(srcdir)/deps/openssl/openssl/crypto/store \
+	-I$(srcdir)/deps/openssl/openssl/include
+
+OBJS := \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/ssl/bio_ssl.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/ssl/d1_both.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/ssl/d1_clnt.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/ssl/d1_lib.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/ssl/d1_meth.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/ssl/d1_pkt.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/ssl/d1_srtp.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/ssl/d1_srvr.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/ssl/kssl.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/ssl/s23_clnt.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/ssl/s23_lib.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/ssl/s23_meth.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/ssl/s23_pkt.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/ssl/s23_srvr.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/ssl/s2_clnt.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/ssl/s2_enc.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/ssl/s2_lib.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/ssl/s2_meth.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/ssl/s2_pkt.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/ssl/s2_srvr.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/ssl/s3_both.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/ssl/s3_cbc.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/ssl/s3_clnt.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/ssl/s3_enc.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/ssl/s3_lib.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/ssl/s3_meth.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/ssl/s3_pkt.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/ssl/s3_srvr.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/ssl/ssl_algs.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/ssl/ssl_asn1.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/ssl/ssl_cert.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/ssl/ssl_ciph.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/ssl/ssl_conf.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/ssl/ssl_err.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/ssl/ssl_err2.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/ssl/ssl_lib.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/ssl/ssl_rsa.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/ssl/ssl_sess.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/ssl/ssl_stat.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/ssl/ssl_txt.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/ssl/ssl_utst.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/ssl/t1_clnt.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/ssl/t1_enc.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/ssl/t1_ext.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/ssl/t1_lib.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/ssl/t1_meth.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/ssl/t1_reneg.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/ssl/t1_srvr.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/ssl/t1_trce.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/ssl/tls_srp.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/aes/aes_cfb.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/aes/aes_ctr.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/aes/aes_ecb.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/aes/aes_ige.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/aes/aes_misc.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/aes/aes_ofb.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/aes/aes_wrap.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/asn1/a_bitstr.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/asn1/a_bool.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/asn1/a_bytes.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/asn1/a_d2i_fp.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/asn1/a_digest.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/asn1/a_dup.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/asn1/a_enum.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/asn1/a_gentm.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/asn1/a_i2d_fp.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/asn1/a_int.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/asn1/a_mbstr.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/asn1/a_object.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/asn1/a_octet.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/asn1/a_print.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/asn1/a_set.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/asn1/a_sign.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/asn1/a_strex.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/asn1/a_strnid.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/asn1/a_time.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/asn1/a_type.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/asn1/a_utctm.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/asn1/a_utf8.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/asn1/a_verify.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/asn1/ameth_lib.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/asn1/asn1_err.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/asn1/asn1_gen.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/asn1/asn1_lib.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/asn1/asn1_par.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/asn1/asn_mime.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/asn1/asn_moid.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/asn1/asn_pack.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/asn1/bio_asn1.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/asn1/bio_ndef.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/asn1/d2i_pr.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/asn1/d2i_pu.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/asn1/evp_asn1.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/asn1/f_enum.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/asn1/f_int.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/asn1/f_string.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/asn1/i2d_pr.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/asn1/i2d_pu.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/asn1/n_pkey.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/asn1/nsseq.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/asn1/p5_pbe.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/asn1/p5_pbev2.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/asn1/p8_pkey.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/asn1/t_bitst.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/asn1/t_crl.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/asn1/t_pkey.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/asn1/t_req.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/asn1/t_spki.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/asn1/t_x509.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/asn1/t_x509a.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/asn1/tasn_dec.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/asn1/tasn_enc.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/asn1/tasn_fre.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/asn1/tasn_new.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/asn1/tasn_prn.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/asn1/tasn_typ.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/asn1/tasn_utl.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/asn1/x_algor.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/asn1/x_attrib.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/asn1/x_bignum.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/asn1/x_crl.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/asn1/x_exten.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/asn1/x_info.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/asn1/x_long.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/asn1/x_name.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/asn1/x_nx509.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/asn1/x_pkey.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/asn1/x_pubkey.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/asn1/x_req.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/asn1/x_sig.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/asn1/x_spki.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/asn1/x_val.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/asn1/x_x509.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/asn1/x_x509a.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/bf/bf_cfb64.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/bf/bf_ecb.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/bf/bf_ofb64.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/bf/bf_skey.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/bio/b_dump.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/bio/b_print.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/bio/b_sock.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/bio/bf_buff.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/bio/bf_nbio.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/bio/bf_null.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/bio/bio_cb.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/bio/bio_err.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/bio/bio_lib.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/bio/bss_acpt.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/bio/bss_bio.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/bio/bss_conn.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/bio/bss_dgram.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/bio/bss_fd.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/bio/bss_file.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/bio/bss_log.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/bio/bss_mem.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/bio/bss_null.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/bio/bss_sock.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/bn/bn_add.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/bn/bn_blind.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/bn/bn_const.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/bn/bn_ctx.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/bn/bn_depr.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/bn/bn_div.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/bn/bn_err.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/bn/bn_exp.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/bn/bn_exp2.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/bn/bn_gcd.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/bn/bn_gf2m.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/bn/bn_kron.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/bn/bn_lib.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/bn/bn_mod.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/bn/bn_mont.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/bn/bn_mpi.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/bn/bn_mul.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/bn/bn_nist.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/bn/bn_prime.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/bn/bn_print.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/bn/bn_rand.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/bn/bn_recp.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/bn/bn_shift.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/bn/bn_sqr.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/bn/bn_sqrt.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/bn/bn_word.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/bn/bn_x931p.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/buffer/buf_err.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/buffer/buf_str.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/buffer/buffer.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/camellia/cmll_cfb.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/camellia/cmll_ctr.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/camellia/cmll_ecb.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/camellia/cmll_ofb.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/camellia/cmll_utl.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/cast/c_cfb64.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/cast/c_ecb.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/cast/c_ofb64.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/cast/c_skey.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/cmac/cm_ameth.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/cmac/cm_pmeth.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/cmac/cmac.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/cms/cms_asn1.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/cms/cms_att.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/cms/cms_cd.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/cms/cms_dd.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/cms/cms_enc.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/cms/cms_env.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/cms/cms_err.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/cms/cms_ess.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/cms/cms_io.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/cms/cms_kari.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/cms/cms_lib.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/cms/cms_pwri.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/cms/cms_sd.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/cms/cms_smime.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/conf/conf_api.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/conf/conf_def.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/conf/conf_err.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/conf/conf_lib.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/conf/conf_mall.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/conf/conf_mod.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/conf/conf_sap.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/cpt_err.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/cryptlib.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/cversion.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/des/cbc_cksm.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/des/cbc_enc.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/des/cfb64ede.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/des/cfb64enc.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/des/cfb_enc.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/des/des_old.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/des/des_old2.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/des/ecb3_enc.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/des/ecb_enc.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/des/ede_cbcm_enc.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/des/enc_read.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/des/enc_writ.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/des/fcrypt.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/des/ofb64ede.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/des/ofb64enc.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/des/ofb_enc.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/des/pcbc_enc.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/des/qud_cksm.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/des/rand_key.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/des/read2pwd.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/des/rpc_enc.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/des/set_key.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/des/str2key.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/des/xcbc_enc.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/dh/dh_ameth.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/dh/dh_asn1.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/dh/dh_check.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/dh/dh_depr.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/dh/dh_err.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/dh/dh_gen.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/dh/dh_kdf.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/dh/dh_key.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/dh/dh_lib.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/dh/dh_pmeth.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/dh/dh_prn.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/dh/dh_rfc5114.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/dsa/dsa_ameth.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/dsa/dsa_asn1.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/dsa/dsa_depr.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/dsa/dsa_err.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/dsa/dsa_gen.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/dsa/dsa_key.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/dsa/dsa_lib.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/dsa/dsa_ossl.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/dsa/dsa_pmeth.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/dsa/dsa_prn.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/dsa/dsa_sign.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/dsa/dsa_vrf.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/dso/dso_beos.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/dso/dso_dl.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/dso/dso_dlfcn.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/dso/dso_err.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/dso/dso_lib.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/dso/dso_null.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/dso/dso_openssl.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/dso/dso_vms.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/dso/dso_win32.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/ebcdic.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/ec/ec2_mult.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/ec/ec2_oct.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/ec/ec2_smpl.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/ec/ec_ameth.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/ec/ec_asn1.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/ec/ec_check.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/ec/ec_curve.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/ec/ec_cvt.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/ec/ec_err.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/ec/ec_key.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/ec/ec_lib.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/ec/ec_mult.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/ec/ec_oct.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/ec/ec_pmeth.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/ec/ec_print.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/ec/eck_prn.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/ec/ecp_mont.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/ec/ecp_nist.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/ec/ecp_nistp224.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/ec/ecp_nistp256.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/ec/ecp_nistp521.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/ec/ecp_nistputil.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/ec/ecp_oct.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/ec/ecp_smpl.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/ecdh/ech_err.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/ecdh/ech_kdf.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/ecdh/ech_key.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/ecdh/ech_lib.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/ecdh/ech_ossl.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/ecdsa/ecs_asn1.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/ecdsa/ecs_err.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/ecdsa/ecs_lib.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/ecdsa/ecs_ossl.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/ecdsa/ecs_sign.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/ecdsa/ecs_vrf.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/engine/eng_all.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/engine/eng_cnf.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/engine/eng_cryptodev.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/engine/eng_ctrl.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/engine/eng_dyn.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/engine/eng_err.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/engine/eng_fat.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/engine/eng_init.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/engine/eng_lib.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/engine/eng_list.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/engine/eng_openssl.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/engine/eng_pkey.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/engine/eng_rdrand.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/engine/eng_table.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/engine/tb_asnmth.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/engine/tb_cipher.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/engine/tb_dh.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/engine/tb_digest.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/engine/tb_dsa.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/engine/tb_ecdh.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/engine/tb_ecdsa.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/engine/tb_pkmeth.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/engine/tb_rand.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/engine/tb_rsa.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/engine/tb_store.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/err/err.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/err/err_all.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/err/err_prn.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/evp/bio_b64.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/evp/bio_enc.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/evp/bio_md.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/evp/bio_ok.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/evp/c_all.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/evp/c_allc.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/evp/c_alld.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/evp/digest.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/evp/e_aes.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/evp/e_aes_cbc_hmac_sha1.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/evp/e_aes_cbc_hmac_sha256.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/evp/e_bf.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/evp/e_camellia.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/evp/e_cast.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/evp/e_des.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/evp/e_des3.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/evp/e_idea.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/evp/e_null.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/evp/e_old.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/evp/e_rc2.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/evp/e_rc4.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/evp/e_rc4_hmac_md5.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/evp/e_rc5.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/evp/e_seed.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/evp/e_xcbc_d.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/evp/encode.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/evp/evp_acnf.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/evp/evp_cnf.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/evp/evp_enc.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/evp/evp_err.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/evp/evp_key.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/evp/evp_lib.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/evp/evp_pbe.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/evp/evp_pkey.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/evp/m_dss.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/evp/m_dss1.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/evp/m_ecdsa.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/evp/m_md2.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/evp/m_md4.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/evp/m_md5.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/evp/m_mdc2.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/evp/m_null.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/evp/m_ripemd.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/evp/m_sha.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/evp/m_sha1.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/evp/m_sigver.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/evp/m_wp.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/evp/names.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/evp/p5_crpt.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/evp/p5_crpt2.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/evp/p_dec.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/evp/p_enc.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/evp/p_lib.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/evp/p_open.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/evp/p_seal.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/evp/p_sign.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/evp/p_verify.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/evp/pmeth_fn.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/evp/pmeth_gn.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/evp/pmeth_lib.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/ex_data.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/fips_ers.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/hmac/hm_ameth.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/hmac/hm_pmeth.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/hmac/hmac.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/idea/i_cbc.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/idea/i_cfb64.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/idea/i_ecb.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/idea/i_ofb64.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/idea/i_skey.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/krb5/krb5_asn.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/lhash/lh_stats.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/lhash/lhash.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/md4/md4_dgst.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/md4/md4_one.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/md5/md5_dgst.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/md5/md5_one.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/mdc2/mdc2_one.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/mdc2/mdc2dgst.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/mem.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/mem_dbg.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/modes/cbc128.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/modes/ccm128.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/modes/cfb128.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/modes/ctr128.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/modes/cts128.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/modes/gcm128.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/modes/ofb128.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/modes/wrap128.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/modes/xts128.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/o_dir.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/o_fips.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/o_init.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/o_str.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/o_time.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/objects/o_names.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/objects/obj_dat.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/objects/obj_err.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/objects/obj_lib.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/objects/obj_xref.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/ocsp/ocsp_asn.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/ocsp/ocsp_cl.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/ocsp/ocsp_err.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/ocsp/ocsp_ext.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/ocsp/ocsp_ht.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/ocsp/ocsp_lib.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/ocsp/ocsp_prn.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/ocsp/ocsp_srv.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/ocsp/ocsp_vfy.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/pem/pem_all.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/pem/pem_err.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/pem/pem_info.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/pem/pem_lib.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/pem/pem_oth.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/pem/pem_pk8.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/pem/pem_pkey.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/pem/pem_seal.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/pem/pem_sign.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/pem/pem_x509.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/pem/pem_xaux.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/pem/pvkfmt.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/pkcs12/p12_add.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/pkcs12/p12_asn.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/pkcs12/p12_attr.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/pkcs12/p12_crpt.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/pkcs12/p12_crt.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/pkcs12/p12_decr.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/pkcs12/p12_init.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/pkcs12/p12_key.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/pkcs12/p12_kiss.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/pkcs12/p12_mutl.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/pkcs12/p12_npas.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/pkcs12/p12_p8d.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/pkcs12/p12_p8e.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/pkcs12/p12_utl.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/pkcs12/pk12err.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/pkcs7/bio_pk7.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/pkcs7/pk7_asn1.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/pkcs7/pk7_attr.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/pkcs7/pk7_doit.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/pkcs7/pk7_lib.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/pkcs7/pk7_mime.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/pkcs7/pk7_smime.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/pkcs7/pkcs7err.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/pqueue/pqueue.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/rand/md_rand.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/rand/rand_egd.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/rand/rand_err.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/rand/rand_lib.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/rand/rand_nw.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/rand/rand_os2.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/rand/rand_unix.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/rand/rand_win.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/rand/randfile.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/rc2/rc2_cbc.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/rc2/rc2_ecb.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/rc2/rc2_skey.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/rc2/rc2cfb64.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/rc2/rc2ofb64.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/rc4/rc4_utl.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/ripemd/rmd_dgst.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/ripemd/rmd_one.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/rsa/rsa_ameth.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/rsa/rsa_asn1.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/rsa/rsa_chk.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/rsa/rsa_crpt.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/rsa/rsa_depr.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/rsa/rsa_eay.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/rsa/rsa_err.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/rsa/rsa_gen.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/rsa/rsa_lib.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/rsa/rsa_none.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/rsa/rsa_null.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/rsa/rsa_oaep.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/rsa/rsa_pk1.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/rsa/rsa_pmeth.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/rsa/rsa_prn.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/rsa/rsa_pss.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/rsa/rsa_saos.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/rsa/rsa_sign.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/rsa/rsa_ssl.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/rsa/rsa_x931.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/seed/seed.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/seed/seed_cbc.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/seed/seed_cfb.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/seed/seed_ecb.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/seed/seed_ofb.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/sha/sha1_one.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/sha/sha1dgst.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/sha/sha256.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/sha/sha512.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/sha/sha_dgst.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/sha/sha_one.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/srp/srp_lib.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/srp/srp_vfy.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/stack/stack.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/ts/ts_asn1.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/ts/ts_conf.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/ts/ts_err.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/ts/ts_lib.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/ts/ts_req_print.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/ts/ts_req_utils.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/ts/ts_rsp_print.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/ts/ts_rsp_sign.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/ts/ts_rsp_utils.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/ts/ts_rsp_verify.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/ts/ts_verify_ctx.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/txt_db/txt_db.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/ui/ui_err.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/ui/ui_lib.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/ui/ui_openssl.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/ui/ui_util.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/uid.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/whrlpool/wp_dgst.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/x509/by_dir.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/x509/by_file.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/x509/x509_att.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/x509/x509_cmp.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/x509/x509_d2.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/x509/x509_def.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/x509/x509_err.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/x509/x509_ext.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/x509/x509_lu.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/x509/x509_obj.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/x509/x509_r2x.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/x509/x509_req.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/x509/x509_set.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/x509/x509_trs.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/x509/x509_txt.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/x509/x509_v3.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/x509/x509_vfy.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/x509/x509_vpm.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/x509/x509cset.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/x509/x509name.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/x509/x509rset.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/x509/x509spki.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/x509/x509type.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/x509/x_all.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/x509v3/pcy_cache.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/x509v3/pcy_data.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/x509v3/pcy_lib.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/x509v3/pcy_map.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/x509v3/pcy_node.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/x509v3/pcy_tree.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/x509v3/v3_addr.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/x509v3/v3_akey.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/x509v3/v3_akeya.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/x509v3/v3_alt.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/x509v3/v3_asid.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/x509v3/v3_bcons.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/x509v3/v3_bitst.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/x509v3/v3_conf.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/x509v3/v3_cpols.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/x509v3/v3_crld.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/x509v3/v3_enum.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/x509v3/v3_extku.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/x509v3/v3_genn.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/x509v3/v3_ia5.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/x509v3/v3_info.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/x509v3/v3_int.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/x509v3/v3_lib.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/x509v3/v3_ncons.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/x509v3/v3_ocsp.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/x509v3/v3_pci.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/x509v3/v3_pcia.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/x509v3/v3_pcons.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/x509v3/v3_pku.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/x509v3/v3_pmaps.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/x509v3/v3_prn.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/x509v3/v3_purp.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/x509v3/v3_scts.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/x509v3/v3_skey.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/x509v3/v3_sxnet.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/x509v3/v3_utl.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/x509v3/v3err.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/engines/e_4758cca.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/engines/e_aep.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/engines/e_atalla.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/engines/e_capi.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/engines/e_chil.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/engines/e_cswift.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/engines/e_gmp.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/engines/e_nuron.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/engines/e_sureware.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/engines/e_ubsec.o \
+	$(obj).target/$(TARGET)/deps/openssl/asm/x64-elf-gas/aes/aes-x86_64.o \
+	$(obj).target/$(TARGET)/deps/openssl/asm/x64-elf-gas/aes/aesni-mb-x86_64.o \
+	$(obj).target/$(TARGET)/deps/openssl/asm/x64-elf-gas/aes/aesni-sha256-x86_64.o \
+	$(obj).target/$(TARGET)/deps/openssl/asm/x64-elf-gas/aes/aesni-x86_64.o \
+	$(obj).target/$(TARGET)/deps/openssl/asm/x64-elf-gas/aes/vpaes-x86_64.o \
+	$(obj).target/$(TARGET)/deps/openssl/asm/x64-elf-gas/aes/bsaes-x86_64.o \
+	$(obj).target/$(TARGET)/deps/openssl/asm/x64-elf-gas/aes/aesni-sha1-x86_64.o \
+	$(obj).target/$(TARGET)/deps/openssl/asm/x64-elf-gas/bn/rsaz-avx2.o \
+	$(obj).target/$(TARGET)/deps/openssl/asm/x64-elf-gas/bn/rsaz-x86_64.o \
+	$(obj).target/$(TARGET)/deps/openssl/asm/x64-elf-gas/bn/x86_64-mont.o \
+	$(obj).target/$(TARGET)/deps/openssl/asm/x64-elf-gas/bn/x86_64-mont5.o \
+	$(obj).target/$(TARGET)/deps/openssl/asm/x64-elf-gas/bn/x86_64-gf2m.o \
+	$(obj).target/$(TARGET)/deps/openssl/asm/x64-elf-gas/camellia/cmll-x86_64.o \
+	$(obj).target/$(TARGET)/deps/openssl/asm/x64-elf-gas/ec/ecp_nistz256-x86_64.o \
+	$(obj).target/$(TARGET)/deps/openssl/asm/x64-elf-gas/md5/md5-x86_64.o \
+	$(obj).target/$(TARGET)/deps/openssl/asm/x64-elf-gas/rc4/rc4-x86_64.o \
+	$(obj).target/$(TARGET)/deps/openssl/asm/x64-elf-gas/rc4/rc4-md5-x86_64.o \
+	$(obj).target/$(TARGET)/deps/openssl/asm/x64-elf-gas/sha/sha1-mb-x86_64.o \
+	$(obj).target/$(TARGET)/deps/openssl/asm/x64-elf-gas/sha/sha1-x86_64.o \
+	$(obj).target/$(TARGET)/deps/openssl/asm/x64-elf-gas/sha/sha256-mb-x86_64.o \
+	$(obj).target/$(TARGET)/deps/openssl/asm/x64-elf-gas/sha/sha256-x86_64.o \
+	$(obj).target/$(TARGET)/deps/openssl/asm/x64-elf-gas/sha/sha512-x86_64.o \
+	$(obj).target/$(TARGET)/deps/openssl/asm/x64-elf-gas/whrlpool/wp-x86_64.o \
+	$(obj).target/$(TARGET)/deps/openssl/asm/x64-elf-gas/modes/aesni-gcm-x86_64.o \
+	$(obj).target/$(TARGET)/deps/openssl/asm/x64-elf-gas/modes/ghash-x86_64.o \
+	$(obj).target/$(TARGET)/deps/openssl/asm/x64-elf-gas/x86_64cpuid.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/bn/asm/x86_64-gcc.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/bf/bf_enc.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/bn/rsaz_exp.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/cast/c_enc.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/camellia/cmll_misc.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/des/des_enc.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/des/fcrypt_b.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/ec/ecp_nistz256.o \
+	$(obj).target/$(TARGET)/deps/openssl/openssl/crypto/ui/ui_compat.o
+
+# Add to the list of files we specially track dependencies for.
+all_deps += $(OBJS)
+
+# CFLAGS et al overrides must be target-local.
+# See "Target-specific Variable Values" in the GNU Make manual.
+$(OBJS): TOOLSET := $(TOOLSET)
+$(OBJS): GYP_CFLAGS := $(DEFS_$(BUILDTYPE)) $(INCS_$(BUILDTYPE))  $(CFLAGS_$(BUILDTYPE)) $(CFLAGS_C_$(BUILDTYPE))
+$(OBJS): GYP_CXXFLAGS := $(DEFS_$(BUILDTYPE)) $(INCS_$(BUILDTYPE))  $(CFLAGS_$(BUILDTYPE)) $(CFLAGS_CC_$(BUILDTYPE))
+
+# Suffix rules, putting all outputs into $(obj).
+
+$(obj).$(TOOLSET)/$(TARGET)/%.o: $(srcdir)/%.c FORCE_DO_CMD
+	@$(call do_cmd,cc,1)
+
+$(obj).$(TOOLSET)/$(TARGET)/%.o: $(srcdir)/%.s FORCE_DO_CMD
+	@$(call do_cmd,cc,1)
+
+# Try building from generated source, too.
+
+$(obj).$(TOOLSET)/$(TARGET)/%.o: $(obj).$(TOOLSET)/%.c FORCE_DO_CMD
+	@$(call do_cmd,cc,1)
+
+$(obj).$(TOOLSET)/$(TARGET)/%.o: $(obj).$(TOOLSET)/%.s FORCE_DO_CMD
+	@$(call do_cmd,cc,1)
+
+$(obj).$(TOOLSET)/$(TARGET)/%.o: $(obj)/%.c FORCE_DO_CMD
+	@$(call do_cmd,cc,1)
+
+$(obj).$(TOOLSET)/$(TARGET)/%.o: $(obj)/%.s FORCE_DO_CMD
+	@$(call do_cmd,cc,1)
+
+# End of this set of suffix rules
+### Rules for final target.
+LDFLAGS_Debug := \
+	-pthread \
+	-rdynamic \
+	-m64 \
+	-pthread \
+	-rdynamic \
+	-m64
+
+LDFLAGS_Release := \
+	-pthread \
+	-rdynamic \
+	-m64 \
+	-pthread \
+	-rdynamic \
+	-m64
+
+LIBS :=
+
+$(obj).target/deps/openssl/libopenssl.a: GYP_LDFLAGS := $(LDFLAGS_$(BUILDTYPE))
+$(obj).target/deps/openssl/libopenssl.a: LIBS := $(LIBS)
+$(obj).target/deps/openssl/libopenssl.a: TOOLSET := $(TOOLSET)
+$(obj).target/deps/openssl/libopenssl.a: $(OBJS) FORCE_DO_CMD
+	$(call do_cmd,alink)
+
+all_deps += $(obj).target/deps/openssl/libopenssl.a
+# Add target alias
+.PHONY: openssl
+openssl: $(obj).target/deps/openssl/libopenssl.a
+
+# Add target alias to "all" target.
+.PHONY: all
+all: openssl
+
+# Add target alias
+.PHONY: openssl
+openssl: $(builddir)/libopenssl.a
+
+# Copy this to the static library output path.
+$(builddir)/libopenssl.a: TOOLSET := $(TOOLSET)
+$(builddir)/libopenssl.a: $(obj).target/deps/openssl/libopenssl.a FORCE_DO_CMD
+	$(call do_cmd,copy)
+
+all_deps += $(builddir)/libopenssl.a
+# Short alias for building this static library.
+.PHONY: libopenssl.a
+libopenssl.a: $(obj).target/deps/openssl/libopenssl.a $(builddir)/libopenssl.a
+
+# Add static library to "all" target.
+.PHONY: all
+all: $(builddir)/libopenssl.a
+
@@ -0,0 +1,191 @@
+# This file is generated by gyp; do not edit.
+
+TOOLSET := target
+TARGET := mksnapshot
+DEFS_Debug := \
+	'-DV8_TARGET_ARCH_X64' \
+	'-DENABLE_DISASSEMBLER' \
+	'-DV8_I18N_SUPPORT' \
+	'-DUCONFIG_NO_TRANSLITERATION=1' \
+	'-DUCONFIG_NO_SERVICE=1' \
+	'-DUCONFIG_NO_REGULAR_EXPRESSIONS=1' \
+	'-DU_ENABLE_DYLOAD=0' \
+	'-DU_STATIC_IMPLEMENTATION=1' \
+	'-DU_HAVE_STD_STRING=0' \
+	'-DUCONFIG_NO_BREAK_ITERATION=0' \
+	'-DUCONFIG_NO_LEGACY_CONVERSION=1' \
+	'-DUCONFIG_NO_IDNA=1' \
+	'-DUCONFIG_NO_CONVERSION=1' \
+	'-DV8_ENABLE_CHECKS' \
+	'-DOBJECT_PRINT' \
+	'-DVERIFY_HEAP' \
+	'-DDEBUG' \
+	'-DTRACE_MAPS' \
+	'-D_GLIBCXX_DEBUG=1' \
+	'-DENABLE_HANDLE_ZAPPING' \
+	'-DENABLE_SLOW_DCHECKS' \
+	'-D_DEBUG'
+
+# Flags passed to all source files.
+CFLAGS_Debug := \
+	-pthread \
+	-Wall \
+	-Wextra \
+	-Wno-unused-parameter \
+	-m64 \
+	-pthread \
+	-Wall \
+	-Wextra \
+	-Wno-unused-parameter \
+	-m64 \
+	-fno-strict-aliasing \
+	-m64 \
+	-Woverloaded-virtual \
+	 \
+	-fdata-sections \
+	-ffunction-sections \
+	-g \
+	-O0 \
+	-g \
+	-O0
+
+# Flags passed to only C files.
+CFLAGS_C_Debug :=
+
+# Flags passed to only C++ files.
+CFLAGS_CC_Debug := \
+	-fno-rtti \
+	-fno-exceptions \
+	-std=gnu++0x \
+	-fno-rtti \
+	-fno-exceptions \
+	-std=gnu++0x
+
+INCS_Debug := \
+	-I$(srcdir)/deps/v8 \
+	-I$(srcdir)/deps/icu-small/source/i18n \
+	-I$(srcdir)/deps/icu-small/source/common
+
+DEFS_Release := \
+	'-DV8_TARGET_ARCH_X64' \
+	'-DENABLE_DISASSEMBLER' \
+	'-DV8_I18N_SUPPORT' \
+	'-DUCONFIG_NO_TRANSLITERATION=1' \
+	'-DUCONFIG_NO_SERVICE=1' \
+	'-DUCONFIG_NO_REGULAR_EXPRESSIONS=1' \
+	'-DU_ENABLE_DYLOAD=0' \
+	'-DU_STATIC_IMPLEMENTATION=1' \
+	'-DU_HAVE_STD_STRING=0' \
+	'-DUCONFIG_NO_BREAK_ITERATION=0' \
+	'-DUCONFIG_NO_LEGACY_CONVERSION=1' \
+	'-DUCONFIG_NO_IDNA=1' \
+	'-DUCONFIG_NO_CONVERSION=1'
+
+# Flags passed to all source files.
+CFLAGS_Release := \
+	-pthread \
+	-Wall \
+	-Wextra \
+	-Wno-unused-parameter \
+	-m64 \
+	-pthread \
+	-Wall \
+	-Wextra \
+	-Wno-unused-parameter \
+	-m64 \
+	-fno-strict-aliasing \
+	-m64 \
+	-O3 \
+	-O3 \
+	-fno-omit-frame-pointer \
+	-fno-omit-frame-pointer \
+	-fdata-sections \
+	-ffunction-sections \
+	 \
+	-O3
+
+# Flags passed to only C files.
+CFLAGS_C_Release :=
+
+# Flags passed to only C++ files.
+CFLAGS_CC_Release := \
+	-fno-rtti \
+	-fno-exceptions \
+	-std=gnu++0x \
+	-fno-rtti \
+	-fno-exceptions \
+	-std=gnu++0x
+
+INCS_Release := \
+	-I$(srcdir)/deps/v8 \
+	-I$(srcdir)/deps/icu-small/source/i18n \
+	-I$(srcdir)/deps/icu-small/source/common
+
+OBJS := \
+	$(obj).target/$(TARGET)/deps/v8/src/snapshot/mksnapshot.o
+
+# Add to the list of files we specially track dependencies for.
+all_deps += $(OBJS)
+
+# Make sure our dependencies are built before any of us.
+$(OBJS): | $(builddir)/libv8_base.a $(builddir)/libv8_nosnapshot.a $(builddir)/libv8_libplatform.a $(builddir)/libicui18n.a $(obj).target/tools/icu/icuuc.stamp $(builddir)/libv8_libbase.a $(builddir)/libicuucx.a $(obj).target/tools/icu/icu_implementation.stamp $(obj).target/tools/icu/icu_uconfig.stamp $(obj).target/tools/icu/icu_uconfig_target.stamp $(builddir)/libicudata.a $(builddir)/libicustubdata.a $(obj).target/deps/v8/tools/gyp/js2c.stamp $(obj).target/deps/v8/tools/gyp/libv8_base.a $(obj).target/deps/v8/tools/gyp/libv8_nosnapshot.a $(obj).target/deps/v8/tools/gyp/libv8_libplatform.a $(obj).target/tools/icu/libicui18n.a $(obj).target/deps/v8/tools/gyp/libv8_libbase.a $(obj).target/tools/icu/libicuucx.a $(obj).target/tools/icu/libicudata.a $(obj).target/tools/icu/libicustubdata.a
+
+# CFLAGS et al overrides must be target-local.
+# See "Target-specific Variable Values" in the GNU Make manual.
+$(OBJS): TOOLSET := $(TOOLSET)
+$(OBJS): GYP_CFLAGS := $(DEFS_$(BUILDTYPE)) $(INCS_$(BUILDTYPE))  $(CFLAGS_$(BUILDTYPE)) $(CFLAGS_C_$(BUILDTYPE))
+$(OBJS): GYP_CXXFLAGS := $(DEFS_$(BUILDTYPE)) $(INCS_$(BUILDTYPE))  $(CFLAGS_$(BUILDTYPE)) $(CFLAGS_CC_$(BUILDTYPE))
+
+# Suffix rules, putting all outputs into $(obj).
+
+$(obj).$(TOOLSET)/$(TARGET)/%.o: $(srcdir)/%.cc FORCE_DO_CMD
+	@$(call do_cmd,cxx,1)
+
+# Try building from generated source, too.
+
+$(obj).$(TOOLSET)/$(TARGET)/%.o: $(obj).$(TOOLSET)/%.cc FORCE_DO_CMD
+	@$(call do_cmd,cxx,1)
+
+$(obj).$(TOOLSET)/$(TARGET)/%.o: $(obj)/%.cc FORCE_DO_CMD
+	@$(call do_cmd,cxx,1)
+
+# End of this set of suffix rules
+### Rules for final target.
+LDFLAGS_Debug := \
+	-pthread \
+	-rdynamic \
+	-m64 \
+	-pthread \
+	-rdynamic \
+	-m64 \
+	-m64
+
+LDFLAGS_Release := \
+	-pthread \
+	-rdynamic \
+	-m64 \
+	-pthread \
+	-rdynamic \
+	-m64 \
+	-m64
+
+LIBS := \
+	-ldl \
+	-lrt
+
+$(builddir)/mksnapshot: GYP_LDFLAGS := $(LDFLAGS_$(BUILDTYPE))
+$(builddir)/mksnapshot: LIBS := $(LIBS)
+$(builddir)/mksnapshot: LD_INPUTS := $(OBJS) $(obj).target/deps/v8/tools/gyp/libv8_base.a $(obj).target/deps/v8/tools/gyp/libv8_nosnapshot.a $(obj).target/deps/v8/tools/gyp/libv8_libplatform.a $(obj).target/tools/icu/libicui18n.a $(obj).target/deps/v8/tools/gyp/libv8_libbase.a $(obj).target/tools/icu/libicuucx.a $(obj).target/tools/icu/libicudata.a $(obj).target/tools/icu/libicustubdata.a
+$(builddir)/mksnapshot: TOOLSET := $(TOOLSET)
+$(builddir)/mksnapshot: $(OBJS) $(obj).target/deps/v8/tools/gyp/libv8_base.a $(obj).target/deps/v8/tools/gyp/libv8_nosnapshot.a $(obj).target/deps/v8/tools/gyp/libv8_libplatform.a $(obj).target/tools/icu/libicui18n.a $(obj).target/deps/v8/tools/gyp/libv8_libbase.a $(obj).target/tools/icu/libicuucx.a $(obj).target/tools/icu/libicudata.a $(obj).target/tools/icu/libicustubdata.a FORCE_DO_CMD
+	$(call do_cmd,link)
+
+all_deps += $(builddir)/mksnapshot
+# Add target alias
+.PHONY: mksnapshot
+mksnapshot: $(builddir)/mksnapshot
+
+# Add executable to "all" target.
+.PHONY: all
+all: $(builddir)/mksnapshot
+
@@ -0,0 +1,50 @@
+# This file is generated by gyp; do not edit.
+
+TOOLSET := target
+TARGET := v8_external_snapshot
+### Rules for final target.
+LDFLAGS_Debug := \
+	-pthread \
+	-rdynamic \
+	-m64 \
+	-pthread \
+	-rdynamic \
+	-m64 \
+	-m64
+
+LDFLAGS_Release := \
+	-pthread \
+	-rdynamic \
+	-m64 \
+	-pthread \
+	-rdynamic \
+	-m64 \
+	-m64
+
+LIBS :=
+
+$(obj).target/deps/v8/tools/gyp/libv8_external_snapshot.a: GYP_LDFLAGS := $(LDFLAGS_$(BUILDTYPE))
+$(obj).target/deps/v8/tools/gyp/libv8_external_snapshot.a: LIBS := $(LIBS)
+$(obj).target/deps/v8/tools/gyp/libv8_external_snapshot.a: TOOLSET := $(TOOLSET)
+$(obj).target/deps/v8/tools/gyp/libv8_external_snapshot.a:  FORCE_DO_CMD
+	$(call do_cmd,alink)
+
+all_deps += $(obj).target/deps/v8/tools/gyp/libv8_external_snapshot.a
+# Add target alias
+.PHONY: v8_external_snapshot
+v8_external_snapshot: $(obj).target/deps/v8/tools/gyp/libv8_external_snapshot.a
+
+# Add target alias
+.PHONY: v8_external_snapshot
+v8_external_snapshot: $(builddir)/libv8_external_snapshot.a
+
+# Copy this to the static library output path.
+$(builddir)/libv8_external_snapshot.a: TOOLSET := $(TOOLSET)
+$(builddir)/libv8_external_snapshot.a: $(obj).target/deps/v8/tools/gyp/libv8_external_snapshot.a FORCE_DO_CMD
+	$(call do_cmd,copy)
+
+all_deps += $(builddir)/libv8_external_snapshot.a
+# Short alias for building this static library.
+.PHONY: libv8_external_snapshot.a
+libv8_external_snapshot.a: $(obj).target/deps/v8/tools/gyp/libv8_external_snapshot.a $(builddir)/libv8_external_snapshot.a
+
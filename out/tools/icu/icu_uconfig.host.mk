@@ -0,0 +1,18 @@
+# This file is generated by gyp; do not edit.
+
+TOOLSET := host
+TARGET := icu_uconfig
+### Rules for final target.
+$(obj).host/tools/icu/icu_uconfig.stamp: TOOLSET := $(TOOLSET)
+$(obj).host/tools/icu/icu_uconfig.stamp:  FORCE_DO_CMD
+	$(call do_cmd,touch)
+
+all_deps += $(obj).host/tools/icu/icu_uconfig.stamp
+# Add target alias
+.PHONY: icu_uconfig
+icu_uconfig: $(obj).host/tools/icu/icu_uconfig.stamp
+
+# Add target alias to "all" target.
+.PHONY: all
+all: icu_uconfig
+
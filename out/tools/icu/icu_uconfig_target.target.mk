@@ -0,0 +1,18 @@
+# This file is generated by gyp; do not edit.
+
+TOOLSET := target
+TARGET := icu_uconfig_target
+### Rules for final target.
+$(obj).target/tools/icu/icu_uconfig_target.stamp: TOOLSET := $(TOOLSET)
+$(obj).target/tools/icu/icu_uconfig_target.stamp:  FORCE_DO_CMD
+	$(call do_cmd,touch)
+
+all_deps += $(obj).target/tools/icu/icu_uconfig_target.stamp
+# Add target alias
+.PHONY: icu_uconfig_target
+icu_uconfig_target: $(obj).target/tools/icu/icu_uconfig_target.stamp
+
+# Add target alias to "all" target.
+.PHONY: all
+all: icu_uconfig_target
+
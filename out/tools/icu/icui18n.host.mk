@@ -0,0 +1,14 @@
+# This file is generated by gyp; do not edit.
+
+TOOLSET := host
+TARGET := icui18n
+### Rules for final target.
+$(obj).host/tools/icu/icui18n.stamp: TOOLSET := $(TOOLSET)
+$(obj).host/tools/icu/icui18n.stamp: $(builddir)/libicutools.a $(obj).host/tools/icu/libicutools.a FORCE_DO_CMD
+	$(call do_cmd,touch)
+
+all_deps += $(obj).host/tools/icu/icui18n.stamp
+# Add target alias
+.PHONY: icui18n
+icui18n: $(obj).host/tools/icu/icui18n.stamp
+
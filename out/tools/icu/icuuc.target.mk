@@ -0,0 +1,18 @@
+# This file is generated by gyp; do not edit.
+
+TOOLSET := target
+TARGET := icuuc
+### Rules for final target.
+$(obj).target/tools/icu/icuuc.stamp: TOOLSET := $(TOOLSET)
+$(obj).target/tools/icu/icuuc.stamp: $(builddir)/libicuucx.a $(builddir)/libicudata.a $(obj).target/tools/icu/libicuucx.a $(obj).target/tools/icu/libicudata.a FORCE_DO_CMD
+	$(call do_cmd,touch)
+
+all_deps += $(obj).target/tools/icu/icuuc.stamp
+# Add target alias
+.PHONY: icuuc
+icuuc: $(obj).target/tools/icu/icuuc.stamp
+
+# Add target alias to "all" target.
+.PHONY: all
+all: icuuc
+
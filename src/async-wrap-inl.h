@@ -17,7 +17,7 @@ inline AsyncWrap::AsyncWrap(Environment* env,
                             v8::Local<v8::Object> object,
                             ProviderType provider,
                             AsyncWrap* parent)
-    : BaseObject(env, object), bits_(static_cast<uint32_t>(provider) << 1),
+    : BaseObject(env, object), bits_(static_cast<uint32_t>(provider) << 2),
       uid_(env->get_async_wrap_uid()) {
   CHECK_NE(provider, PROVIDER_NONE);
   CHECK_GE(object->InternalFieldCount(), 1);
@@ -25,6 +25,15 @@ inline AsyncWrap::AsyncWrap(Environment* env,
   // Shift provider value over to prevent id collision.
   persistent().SetWrapperClassId(NODE_ASYNC_ID_OFFSET + provider);
 
+  if (!env->native_async_hooks().empty()) {
+    const int64_t parent_uid = parent != nullptr ? parent->get_uid() : 0;
+    for (const NativeAsyncHooks* hooks : env->native_async_hooks()) {
+      if (hooks->init != nullptr)
+        hooks->init(get_uid(), provider, parent_uid, hooks->data);
+    }
+    bits_ |= 2;  // ran_native_init_callback() is true now.
+  }
+
   v8::Local<v8::Function> init_fn = env->async_hooks_init_function();
 
   // No init callback exists, no reason to go on.
@@ -66,21 +75,12 @@ inline AsyncWrap::AsyncWrap(Environment* env,
 
 
 inline AsyncWrap::~AsyncWrap() {
-  if (!ran_init_callback())
-    return;
-
-  v8::Local<v8::Function> fn = env()->async_hooks_destroy_function();
-  if (!fn.IsEmpty()) {
-    v8::HandleScope scope(env()->isolate());
-    v8::Local<v8::Value> uid = v8::Integer::New(env()->isolate(), get_uid());
-    v8::TryCatch try_catch(env()->isolate());
-    v8::MaybeLocal<v8::Value> ret =
-        fn->Call(env()->context(), v8::Null(env()->isolate()), 1, &uid);
-    if (ret.IsEmpty()) {
-      ClearFatalExceptionHandlers(env());
-      FatalException(env()->isolate(), try_catch);
-    }
-  }
+  // The destroy hooks are not necessarily safe to call from here, the
+  // destructor can run during garbage collection.  Queue the uid instead.
+  if (ran_native_init_callback())
+    env()->AddDestroyId(get_uid(), true);
+  if (ran_init_callback() && !env()->async_hooks_destroy_function().IsEmpty())
+    env()->AddDestroyId(get_uid(), false);
 }
 
 
@@ -89,8 +89,13 @@ inline bool AsyncWrap::ran_init_callback() const {
 }
 
 
+inline bool AsyncWrap::ran_native_init_callback() const {
+  return static_cast<bool>(bits_ & 2);
+}
+
+
 inline AsyncWrap::ProviderType AsyncWrap::provider_type() const {
-  return static_cast<ProviderType>(bits_ >> 1);
+  return static_cast<ProviderType>(bits_ >> 2);
 }
 
 
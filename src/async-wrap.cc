@@ -2,12 +2,15 @@
 #include "async-wrap-inl.h"
 #include "env.h"
 #include "env-inl.h"
+#include "node_dtrace.h"
 #include "util.h"
 #include "util-inl.h"
 
 #include "v8.h"
 #include "v8-profiler.h"
 
+#include <vector>
+
 using v8::Boolean;
 using v8::Context;
 using v8::Function;
@@ -18,6 +21,7 @@ using v8::Integer;
 using v8::Isolate;
 using v8::Local;
 using v8::MaybeLocal;
+using v8::Null;
 using v8::Object;
 using v8::RetainedObjectInfo;
 using v8::TryCatch;
@@ -151,6 +155,8 @@ static void SetupHooks(const FunctionCallbackInfo<Value>& args) {
     env->set_async_hooks_post_function(post_v.As<Function>());
   if (destroy_v->IsFunction())
     env->set_async_hooks_destroy_function(destroy_v.As<Function>());
+
+  env->UpdatePlainCallbacks();
 }
 
 
@@ -177,6 +183,59 @@ static void Initialize(Local<Object> target,
   env->set_async_hooks_pre_function(Local<Function>());
   env->set_async_hooks_post_function(Local<Function>());
   env->set_async_hooks_destroy_function(Local<Function>());
+  env->UpdatePlainCallbacks();
+}
+
+
+void AsyncWrap::DestroyIdsCb(uv_idle_t* handle) {
+  uv_idle_stop(handle);
+
+  Environment* env = Environment::from_destroy_ids_idle_handle(handle);
+
+  // Swap the lists out first, the hooks can destroy more resources.
+  std::vector<int64_t> native_ids;
+  native_ids.swap(*env->native_destroy_ids_list());
+  if (!native_ids.empty()) {
+    for (const NativeAsyncHooks* hooks : env->native_async_hooks()) {
+      if (hooks->destroy != nullptr)
+        hooks->destroy(native_ids.data(), native_ids.size(), hooks->data);
+    }
+  }
+
+  std::vector<int64_t> ids;
+  ids.swap(*env->destroy_ids_list());
+  if (ids.empty())
+    return;
+
+  HandleScope handle_scope(env->isolate());
+  Context::Scope context_scope(env->context());
+  Local<Function> fn = env->async_hooks_destroy_function();
+  if (fn.IsEmpty())
+    return;
+
+  TryCatch try_catch(env->isolate());
+  for (int64_t id : ids) {
+    Local<Value> uid = Integer::New(env->isolate(), id);
+    MaybeLocal<Value> ret =
+        fn->Call(env->context(), Null(env->isolate()), 1, &uid);
+    if (ret.IsEmpty()) {
+      ClearFatalExceptionHandlers(env);
+      FatalException(env->isolate(), try_catch);
+      return;
+    }
+  }
+}
+
+
+void AddNativeAsyncHooks(Local<Context> context,
+                         const NativeAsyncHooks* hooks) {
+  Environment::GetCurrent(context)->AddNativeAsyncHooks(hooks);
+}
+
+
+void RemoveNativeAsyncHooks(Local<Context> context,
+                            const NativeAsyncHooks* hooks) {
+  Environment::GetCurrent(context)->RemoveNativeAsyncHooks(hooks);
 }
 
 
@@ -190,11 +249,59 @@ void LoadAsyncWrapperInfo(Environment* env) {
 }
 
 
+// Runs the nextTick queue and the microtasks once the outermost callback
+// returned `ret`, which is returned unless the nextTick queue threw.
+static Local<Value> TickAfterCallback(
+    Environment* env,
+    Environment::AsyncCallbackScope* callback_scope,
+    Local<Value> ret) {
+  if (callback_scope->in_makecallback()) {
+    return ret;
+  }
+
+  if (env->in_tick_batch()) {
+    env->set_tick_batch_pending(true);
+    return ret;
+  }
+
+  Environment::TickInfo* tick_info = env->tick_info();
+
+  if (tick_info->length() == 0) {
+    env->isolate()->RunMicrotasks();
+  }
+
+  Local<Object> process = env->process_object();
+
+  if (tick_info->length() == 0) {
+    tick_info->set_index(0);
+    return ret;
+  }
+
+  if (env->tick_callback_function()->Call(process, 0, nullptr).IsEmpty()) {
+    return Local<Value>();
+  }
+
+  return ret;
+}
+
+
 Local<Value> AsyncWrap::MakeCallback(const Local<Function> cb,
                                      int argc,
                                      Local<Value>* argv) {
   CHECK(env()->context() == env()->isolate()->GetCurrentContext());
 
+  if (env()->plain_callbacks()) {
+    Environment::AsyncCallbackScope callback_scope(env());
+    if (NODE_CALLBACK_ENTER_ENABLED())
+      NODE_CALLBACK_ENTER(get_uid(), provider_type());
+    Local<Value> ret = cb->Call(object(), argc, argv);
+    if (NODE_CALLBACK_EXIT_ENABLED())
+      NODE_CALLBACK_EXIT(get_uid(), provider_type(), ret.IsEmpty());
+    if (ret.IsEmpty())
+      return ret;
+    return TickAfterCallback(env(), &callback_scope, ret);
+  }
+
   Local<Function> pre_fn = env()->async_hooks_pre_function();
   Local<Function> post_fn = env()->async_hooks_post_function();
   Local<Value> uid = Integer::New(env()->isolate(), get_uid());
@@ -234,8 +341,28 @@ Local<Value> AsyncWrap::MakeCallback(const Local<Function> cb,
     }
   }
 
+  if (ran_native_init_callback()) {
+    for (const NativeAsyncHooks* hooks : env()->native_async_hooks()) {
+      if (hooks->before != nullptr)
+        hooks->before(get_uid(), hooks->data);
+    }
+  }
+
+  if (NODE_CALLBACK_ENTER_ENABLED())
+    NODE_CALLBACK_ENTER(get_uid(), provider_type());
+
   Local<Value> ret = cb->Call(context, argc, argv);
 
+  if (NODE_CALLBACK_EXIT_ENABLED())
+    NODE_CALLBACK_EXIT(get_uid(), provider_type(), ret.IsEmpty());
+
+  if (ran_native_init_callback()) {
+    for (const NativeAsyncHooks* hooks : env()->native_async_hooks()) {
+      if (hooks->after != nullptr)
+        hooks->after(get_uid(), ret.IsEmpty(), hooks->data);
+    }
+  }
+
   if (ran_init_callback() && !post_fn.IsEmpty()) {
     Local<Value> did_throw = Boolean::New(env()->isolate(), ret.IsEmpty());
     Local<Value> vals[] = { uid, did_throw };
@@ -263,28 +390,7 @@ Local<Value> AsyncWrap::MakeCallback(const Local<Function> cb,
     }
   }
 
-  if (callback_scope.in_makecallback()) {
-    return ret;
-  }
-
-  Environment::TickInfo* tick_info = env()->tick_info();
-
-  if (tick_info->length() == 0) {
-    env()->isolate()->RunMicrotasks();
-  }
-
-  Local<Object> process = env()->process_object();
-
-  if (tick_info->length() == 0) {
-    tick_info->set_index(0);
-    return ret;
-  }
-
-  if (env()->tick_callback_function()->Call(process, 0, nullptr).IsEmpty()) {
-    return Local<Value>();
-  }
-
-  return ret;
+  return TickAfterCallback(env(), &callback_scope, ret);
 }
 
 }  // namespace node
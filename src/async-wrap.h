@@ -2,6 +2,7 @@
 #define SRC_ASYNC_WRAP_H_
 
 #include "base-object.h"
+#include "uv.h"
 #include "v8.h"
 
 #include <stdint.h>
@@ -17,7 +18,9 @@ namespace node {
   V(FSREQWRAP)                                                                \
   V(GETADDRINFOREQWRAP)                                                       \
   V(GETNAMEINFOREQWRAP)                                                       \
+  V(HTTP2SESSION)                                                             \
   V(HTTPPARSER)                                                               \
+  V(JSONPARSER)                                                               \
   V(JSSTREAM)                                                                 \
   V(PIPEWRAP)                                                                 \
   V(PIPECONNECTWRAP)                                                          \
@@ -26,6 +29,7 @@ namespace node {
   V(SHUTDOWNWRAP)                                                             \
   V(SIGNALWRAP)                                                               \
   V(STATWATCHER)                                                              \
+  V(STREAMPIPE)                                                               \
   V(TCPWRAP)                                                                  \
   V(TCPCONNECTWRAP)                                                           \
   V(TIMERWRAP)                                                                \
@@ -33,6 +37,8 @@ namespace node {
   V(TTYWRAP)                                                                  \
   V(UDPWRAP)                                                                  \
   V(UDPSENDWRAP)                                                              \
+  V(WEBSOCKET)                                                                \
+  V(WORKER)                                                                   \
   V(WRITEWRAP)                                                                \
   V(ZLIB)
 
@@ -71,13 +77,19 @@ class AsyncWrap : public BaseObject {
 
   virtual size_t self_size() const = 0;
 
+  // Calls the destroy hooks for the resources that have been destroyed since
+  // the last call.
+  static void DestroyIdsCb(uv_idle_t* handle);
+
  private:
   inline AsyncWrap();
   inline bool ran_init_callback() const;
+  inline bool ran_native_init_callback() const;
 
   // When the async hooks init JS function is called from the constructor it is
   // expected the context object will receive a _asyncQueue object property
-  // that will be used to call pre/post in MakeCallback.
+  // that will be used to call pre/post in MakeCallback.  The lowest bit is set
+  // when it ran, the next one when the native init hooks ran.
   uint32_t bits_;
   const int64_t uid_;
 };
@@ -0,0 +1,462 @@
+#include "buffer_arena.h"
+#include "util.h"
+#include "uv.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#ifndef MAP_NORESERVE
+#define MAP_NORESERVE 0
+#endif
+
+namespace node {
+
+namespace {
+
+struct FreeBlock {
+  FreeBlock* next;
+};
+
+struct FreeList {
+  FreeBlock* head;
+  size_t count;
+};
+
+// The counters are only written by the thread that owns the cache, and read
+// by GetStatistics().
+struct ThreadCache {
+  FreeList lists[BufferArena::kSizeClasses];
+  std::atomic<size_t> cached_bytes;
+  std::atomic<size_t> allocated_bytes;
+  std::atomic<size_t> freed_bytes;
+};
+
+}  // anonymous namespace
+
+// Enough for the arena not to run out before the malloc() fallback matters,
+// and address space is cheap on 64 bit systems.
+#if defined(_WIN64) || defined(_LP64)
+static const size_t kReservedSize = static_cast<size_t>(1) << 30;
+#else
+static const size_t kReservedSize = 64 << 20;
+#endif
+// Blocks are carved out in aligned runs of the largest size class, so that
+// the blocks of a page or more cover whole pages.
+static const size_t kRunSize = BufferArena::kMaxBlockSize;
+
+static uv_once_t init_once = UV_ONCE_INIT;
+static uv_mutex_t mutex;
+static size_t page_size;
+
+// Not a uv_key_t, the key needs a destructor.  It flushes the caches of the
+// threads that exit, such as the threadpool threads that go when the pool
+// shrinks.
+#ifdef _WIN32
+static DWORD thread_cache_key;
+#else
+static pthread_key_t thread_cache_key;
+#endif
+
+// Stays nullptr when the range could not be reserved.
+static char* arena_start;
+static char* arena_end;
+static char* arena_top;
+static char* arena_committed;
+
+// The free blocks of the arena, with their pages resident and given back.
+static FreeList dirty_lists[BufferArena::kSizeClasses];
+static FreeList clean_lists[BufferArena::kSizeClasses];
+static size_t dirty_bytes;
+static size_t clean_bytes;
+
+// Never deleted, libuv joins its threadpool threads after the static
+// destructors may have run.
+static std::vector<ThreadCache*>* thread_caches;
+// What the caches that were flushed and deleted counted.
+static size_t retired_allocated_bytes;
+static size_t retired_freed_bytes;
+
+
+static void RetireThreadCache(ThreadCache* cache);
+
+#ifdef _WIN32
+static void NTAPI OnThreadExit(void* data) {
+  if (data != nullptr)
+    RetireThreadCache(static_cast<ThreadCache*>(data));
+}
+#else
+static void OnThreadExit(void* data) {
+  if (data != nullptr)
+    RetireThreadCache(static_cast<ThreadCache*>(data));
+}
+#endif
+
+
+static void Init() {
+  CHECK_EQ(0, uv_mutex_init(&mutex));
+#ifdef _WIN32
+  thread_cache_key = FlsAlloc(OnThreadExit);
+  CHECK_NE(thread_cache_key, FLS_OUT_OF_INDEXES);
+#else
+  CHECK_EQ(0, pthread_key_create(&thread_cache_key, OnThreadExit));
+#endif
+  thread_caches = new std::vector<ThreadCache*>();
+
+#ifdef _WIN32
+  SYSTEM_INFO info;
+  GetSystemInfo(&info);
+  page_size = info.dwPageSize;
+  void* start = VirtualAlloc(nullptr, kReservedSize, MEM_RESERVE,
+                             PAGE_NOACCESS);
+#else
+  page_size = sysconf(_SC_PAGESIZE);
+  void* start = mmap(nullptr,
+                     kReservedSize,
+                     PROT_NONE,
+                     MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE,
+                     -1,
+                     0);
+  if (start == MAP_FAILED)
+    start = nullptr;
+#endif
+  if (start == nullptr)
+    return;
+
+  // Chunks are committed one after the other, so the start needs to be
+  // aligned to runs only.
+  const uintptr_t address = reinterpret_cast<uintptr_t>(start);
+  arena_start = static_cast<char*>(start) + (-address & (kRunSize - 1));
+  arena_end = static_cast<char*>(start) + kReservedSize;
+  arena_top = arena_start;
+  arena_committed = arena_start;
+}
+
+
+static inline void EnsureInitialized() {
+  uv_once(&init_once, Init);
+}
+
+
+static bool Commit(char* start, size_t size) {
+#ifdef _WIN32
+  return VirtualAlloc(start, size, MEM_COMMIT, PAGE_READWRITE) != nullptr;
+#else
+  return mprotect(start, size, PROT_READ | PROT_WRITE) == 0;
+#endif
+}
+
+
+static inline void Push(FreeList* list, FreeBlock* block) {
+  block->next = list->head;
+  list->head = block;
+  list->count += 1;
+}
+
+
+static inline FreeBlock* Pop(FreeList* list) {
+  FreeBlock* block = list->head;
+  list->head = block->next;
+  list->count -= 1;
+  return block;
+}
+
+
+// Only for counters that one thread writes, which need no atomic update.
+static inline void Add(std::atomic<size_t>* counter, size_t value) {
+  counter->store(counter->load(std::memory_order_relaxed) + value,
+                 std::memory_order_relaxed);
+}
+
+
+static inline void Subtract(std::atomic<size_t>* counter, size_t value) {
+  counter->store(counter->load(std::memory_order_relaxed) - value,
+                 std::memory_order_relaxed);
+}
+
+
+static size_t SizeClass(size_t size) {
+  size_t shift = BufferArena::kMinBlockShift;
+  while ((static_cast<size_t>(1) << shift) < size)
+    shift++;
+  return shift - BufferArena::kMinBlockShift;
+}
+
+
+static inline size_t ClassSize(size_t size_class) {
+  return static_cast<size_t>(1) << (size_class + BufferArena::kMinBlockShift);
+}
+
+
+// The blocks of a size class that a thread caches before it gives some of
+// them back.  At least a few, for the largest classes.
+static inline size_t CacheLimit(size_t size_class) {
+  return std::max<size_t>(BufferArena::kCacheBytes / ClassSize(size_class), 4);
+}
+
+
+static inline ThreadCache* CurrentThreadCache() {
+#ifdef _WIN32
+  return static_cast<ThreadCache*>(FlsGetValue(thread_cache_key));
+#else
+  return static_cast<ThreadCache*>(pthread_getspecific(thread_cache_key));
+#endif
+}
+
+
+static inline void SetCurrentThreadCache(ThreadCache* cache) {
+#ifdef _WIN32
+  CHECK(FlsSetValue(thread_cache_key, cache));
+#else
+  CHECK_EQ(0, pthread_setspecific(thread_cache_key, cache));
+#endif
+}
+
+
+static ThreadCache* GetThreadCache() {
+  ThreadCache* cache = CurrentThreadCache();
+  if (cache != nullptr)
+    return cache;
+
+  cache = new ThreadCache();
+  for (size_t i = 0; i < BufferArena::kSizeClasses; i++) {
+    cache->lists[i].head = nullptr;
+    cache->lists[i].count = 0;
+  }
+  cache->cached_bytes = 0;
+  cache->allocated_bytes = 0;
+  cache->freed_bytes = 0;
+  SetCurrentThreadCache(cache);
+
+  uv_mutex_lock(&mutex);
+  thread_caches->push_back(cache);
+  uv_mutex_unlock(&mutex);
+  return cache;
+}
+
+
+// Takes a run of free address space and cuts it into blocks.  Returns
+// nullptr when the reserved range is used up.
+static FreeBlock* Carve(size_t size_class) {
+  const size_t class_size = ClassSize(size_class);
+  if (static_cast<size_t>(arena_end - arena_top) < kRunSize)
+    return nullptr;
+  if (arena_top + kRunSize > arena_committed) {
+    const size_t size = std::min<size_t>(BufferArena::kChunkSize,
+                                         arena_end - arena_committed);
+    if (!Commit(arena_committed, size))
+      return nullptr;
+    arena_committed += size;
+  }
+
+  char* const run = arena_top;
+  arena_top += kRunSize;
+  FreeBlock* head = nullptr;
+  for (size_t offset = kRunSize; offset > 0; offset -= class_size) {
+    FreeBlock* block = reinterpret_cast<FreeBlock*>(run + offset - class_size);
+    block->next = head;
+    head = block;
+  }
+  return head;
+}
+
+
+// Must be called with the lock held.
+static void Refill(ThreadCache* cache, size_t size_class) {
+  const size_t class_size = ClassSize(size_class);
+  const size_t wanted = CacheLimit(size_class) / 2;
+  FreeList* const list = &cache->lists[size_class];
+  FreeList* const dirty = &dirty_lists[size_class];
+  FreeList* const clean = &clean_lists[size_class];
+
+  // Blocks with resident pages first, they cost no page faults.
+  while (list->count < wanted && dirty->count > 0) {
+    Push(list, Pop(dirty));
+    dirty_bytes -= class_size;
+  }
+  while (list->count < wanted && clean->count > 0) {
+    Push(list, Pop(clean));
+    clean_bytes -= class_size;
+  }
+  while (list->count < wanted) {
+    FreeBlock* block = Carve(size_class);
+    if (block == nullptr)
+      break;
+    while (block != nullptr) {
+      FreeBlock* next = block->next;
+      Push(list, block);
+      block = next;
+    }
+  }
+}
+
+
+// The contents are lost, the blocks stay usable.
+static void ReleasePages(void* data, size_t size) {
+#if defined(_WIN32)
+  VirtualAlloc(data, size, MEM_RESET, PAGE_READWRITE);
+#elif defined(__linux__)
+  madvise(data, size, MADV_DONTNEED);
+#elif defined(MADV_FREE)
+  madvise(data, size, MADV_FREE);
+#endif
+}
+
+
+// Must be called with the lock held.
+static void Release(ThreadCache* cache, size_t size_class, size_t count) {
+  const size_t class_size = ClassSize(size_class);
+  FreeList* const list = &cache->lists[size_class];
+  for (size_t i = 0; i < count && list->count > 0; i++) {
+    FreeBlock* block = Pop(list);
+    if (class_size >= page_size &&
+        dirty_bytes >= BufferArena::kMaxDirtyBytes) {
+      ReleasePages(block, class_size);
+      Push(&clean_lists[size_class], block);
+      clean_bytes += class_size;
+    } else {
+      Push(&dirty_lists[size_class], block);
+      dirty_bytes += class_size;
+    }
+  }
+}
+
+
+void* BufferArena::Allocate(size_t size, bool zero_fill) {
+  // Empty allocations go to malloc() too, so that Free() can tell the two
+  // apart by the address alone.
+  if (size == 0 || size > kMaxBlockSize)
+    return zero_fill ? calloc(size, 1) : malloc(size);
+
+  EnsureInitialized();
+  ThreadCache* const cache = GetThreadCache();
+  const size_t size_class = SizeClass(size);
+  const size_t class_size = ClassSize(size_class);
+  FreeList* const list = &cache->lists[size_class];
+  if (list->count == 0) {
+    uv_mutex_lock(&mutex);
+    Refill(cache, size_class);
+    uv_mutex_unlock(&mutex);
+    if (list->count == 0)
+      return zero_fill ? calloc(size, 1) : malloc(size);
+    Add(&cache->cached_bytes, list->count * class_size);
+  }
+
+  void* data = Pop(list);
+  Subtract(&cache->cached_bytes, class_size);
+  Add(&cache->allocated_bytes, class_size);
+  if (zero_fill)
+    memset(data, 0, size);
+  return data;
+}
+
+
+void BufferArena::Free(void* data, size_t size) {
+  if (data == nullptr || !Owns(data))
+    return free(data);
+  CHECK(size > 0 && size <= kMaxBlockSize);
+
+  ThreadCache* const cache = GetThreadCache();
+  const size_t size_class = SizeClass(size);
+  const size_t class_size = ClassSize(size_class);
+  FreeList* const list = &cache->lists[size_class];
+  Push(list, static_cast<FreeBlock*>(data));
+  Add(&cache->cached_bytes, class_size);
+  Add(&cache->freed_bytes, class_size);
+
+  // Down to half of the limit, so that the next frees don't take the lock.
+  const size_t limit = CacheLimit(size_class);
+  if (list->count > limit) {
+    const size_t count = list->count - limit / 2;
+    uv_mutex_lock(&mutex);
+    Release(cache, size_class, count);
+    uv_mutex_unlock(&mutex);
+    Subtract(&cache->cached_bytes, count * class_size);
+  }
+}
+
+
+bool BufferArena::Owns(const void* data) {
+  EnsureInitialized();
+  return data >= arena_start && data < arena_end && arena_start != nullptr;
+}
+
+
+// Gives the blocks of |cache| back to the arena and deletes it.
+static void RetireThreadCache(ThreadCache* cache) {
+  uv_mutex_lock(&mutex);
+  for (size_t i = 0; i < BufferArena::kSizeClasses; i++)
+    Release(cache, i, cache->lists[i].count);
+  retired_allocated_bytes += cache->allocated_bytes;
+  retired_freed_bytes += cache->freed_bytes;
+  thread_caches->erase(std::find(thread_caches->begin(),
+                                 thread_caches->end(),
+                                 cache));
+  uv_mutex_unlock(&mutex);
+  delete cache;
+}
+
+
+void BufferArena::FlushThreadCache() {
+  EnsureInitialized();
+  ThreadCache* cache = CurrentThreadCache();
+  if (cache == nullptr)
+    return;
+  SetCurrentThreadCache(nullptr);
+  RetireThreadCache(cache);
+}
+
+
+void BufferArena::Trim() {
+  FlushThreadCache();
+
+  uv_mutex_lock(&mutex);
+  for (size_t i = 0; i < kSizeClasses; i++) {
+    const size_t class_size = ClassSize(i);
+    if (class_size < page_size)
+      continue;
+    while (dirty_lists[i].count > 0) {
+      FreeBlock* block = Pop(&dirty_lists[i]);
+      ReleasePages(block, class_size);
+      Push(&clean_lists[i], block);
+      dirty_bytes -= class_size;
+      clean_bytes += class_size;
+    }
+  }
+  uv_mutex_unlock(&mutex);
+}
+
+
+void BufferArena::GetStatistics(Statistics* stats) {
+  EnsureInitialized();
+  uv_mutex_lock(&mutex);
+  // Blocks move between threads, so one cache can count more frees than
+  // allocations.  Only the sum means something.
+  size_t allocated = retired_allocated_bytes;
+  size_t freed = retired_freed_bytes;
+  size_t cached = 0;
+  for (const ThreadCache* cache : *thread_caches) {
+    allocated += cache->allocated_bytes.load(std::memory_order_relaxed);
+    freed += cache->freed_bytes.load(std::memory_order_relaxed);
+    cached += cache->cached_bytes.load(std::memory_order_relaxed);
+  }
+  stats->reserved_size = arena_start != nullptr ? arena_end - arena_start : 0;
+  stats->mapped_size = arena_top - arena_start;
+  stats->used_size = allocated > freed ? allocated - freed : 0;
+  stats->cached_size = cached;
+  stats->free_size = dirty_bytes;
+  stats->released_size = clean_bytes;
+  uv_mutex_unlock(&mutex);
+}
+
+}  // namespace node
@@ -0,0 +1,70 @@
+#ifndef SRC_BUFFER_ARENA_H_
+#define SRC_BUFFER_ARENA_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace node {
+
+// Keeps the backing stores of Buffers of up to kMaxBlockSize bytes apart
+// from the malloc() heap that V8 and OpenSSL share, so that Buffer churn does
+// not fragment it.  Sizes are rounded up to a power of two.  The blocks of a
+// size class are carved out of one range of address space that is reserved
+// once per process, which makes telling arena blocks from malloc() memory a
+// range check.
+//
+// Each thread that allocates or frees keeps a cache of free blocks per size
+// class, so that only every so many calls take the lock of the arena.  That
+// includes the threadpool threads, which can allocate a block on their own
+// and hand it to Buffer::New() on the main thread.  The pages of free blocks
+// of a page or more are given back to the system once the arena retains more
+// than kMaxDirtyBytes of them.
+//
+// Allocate() falls back to malloc() for empty and larger sizes and when the
+// reserved range is used up, Free() to free() for memory that is not from
+// the arena.
+class BufferArena {
+ public:
+  static const size_t kMinBlockShift = 6;  // 64 bytes
+  static const size_t kMaxBlockShift = 16;  // 64 KB
+  static const size_t kMaxBlockSize = 1 << kMaxBlockShift;
+  static const size_t kSizeClasses = kMaxBlockShift - kMinBlockShift + 1;
+  // Address space is committed in steps of kChunkSize.
+  static const size_t kChunkSize = 1 << 20;
+  // The bytes of the blocks of one size class that a thread keeps cached.
+  static const size_t kCacheBytes = 256 * 1024;
+  static const size_t kMaxDirtyBytes = 8 << 20;
+
+  struct Statistics {
+    size_t reserved_size;
+    // Address space that blocks have been carved out of.
+    size_t mapped_size;
+    // Blocks that are handed out.
+    size_t used_size;
+    // Free blocks in the caches of the threads.
+    size_t cached_size;
+    // Free blocks in the arena whose pages are still resident.
+    size_t free_size;
+    // Free blocks whose pages were given back to the system.
+    size_t released_size;
+  };
+
+  static void* Allocate(size_t size, bool zero_fill);
+  // |size| is the size that was passed to Allocate().
+  static void Free(void* data, size_t size);
+  static bool Owns(const void* data);
+
+  // Returns the blocks that the calling thread caches to the arena.  Threads
+  // that exit do that on their own, ArrayBufferAllocator calls it when it
+  // goes away.
+  static void FlushThreadCache();
+  // Flushes the cache of the calling thread and gives back the pages of all
+  // free blocks of a page or more.
+  static void Trim();
+
+  static void GetStatistics(Statistics* stats);
+};
+
+}  // namespace node
+
+#endif  // SRC_BUFFER_ARENA_H_
@@ -5,6 +5,9 @@
 #include "env.h"
 #include "env-inl.h"
 #include "node.h"
+#include "node_buffer.h"
+#include "node_dns_cache.h"
+#include "node_trace.h"
 #include "req-wrap.h"
 #include "req-wrap-inl.h"
 #include "tree.h"
@@ -15,6 +18,10 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include <string>
+#include <unordered_map>
+#include <vector>
+
 #if defined(__ANDROID__) || \
     defined(__MINGW32__) || \
     defined(__OpenBSD__) || \
@@ -33,6 +40,7 @@ namespace node {
 namespace cares_wrap {
 
 using v8::Array;
+using v8::ArrayBuffer;
 using v8::Context;
 using v8::EscapableHandleScope;
 using v8::Function;
@@ -40,10 +48,13 @@ using v8::FunctionCallbackInfo;
 using v8::FunctionTemplate;
 using v8::HandleScope;
 using v8::Integer;
+using v8::Isolate;
 using v8::Local;
 using v8::Null;
+using v8::Number;
 using v8::Object;
 using v8::String;
+using v8::Uint16Array;
 using v8::Value;
 
 
@@ -52,6 +63,9 @@ class GetAddrInfoReqWrap : public ReqWrap<uv_getaddrinfo_t> {
   GetAddrInfoReqWrap(Environment* env, Local<Object> req_wrap_obj);
 
   size_t self_size() const override { return sizeof(*this); }
+
+  // Set while the lookup goes through the cache.
+  std::string cache_key;
 };
 
 GetAddrInfoReqWrap::GetAddrInfoReqWrap(Environment* env,
@@ -102,13 +116,23 @@ static int cmp_ares_tasks(const ares_task_t* a, const ares_task_t* b) {
 RB_GENERATE_STATIC(ares_task_list, ares_task_t, node, cmp_ares_tasks)
 
 
+/* The sockets of all channels share the task list, a channel skips the */
+/* sockets that are not its own. */
+static void ares_process_channels(Environment* env,
+                                  ares_socket_t read_fd,
+                                  ares_socket_t write_fd) {
+  ares_process_fd(env->cares_channel(), read_fd, write_fd);
+  for (ares_channel channel : *env->cares_extra_channels())
+    ares_process_fd(channel, read_fd, write_fd);
+}
+
 
 /* This is called once per second by loop->timer. It is used to constantly */
 /* call back into c-ares for possibly processing timeouts. */
 static void ares_timeout(uv_timer_t* handle) {
   Environment* env = Environment::from_cares_timer_handle(handle);
   CHECK_EQ(false, RB_EMPTY(env->cares_task_list()));
-  ares_process_fd(env->cares_channel(), ARES_SOCKET_BAD, ARES_SOCKET_BAD);
+  ares_process_channels(env, ARES_SOCKET_BAD, ARES_SOCKET_BAD);
 }
 
 
@@ -122,14 +146,14 @@ static void ares_poll_cb(uv_poll_t* watcher, int status, int events) {
   if (status < 0) {
     /* An error happened. Just pretend that the socket is both readable and */
     /* writable. */
-    ares_process_fd(env->cares_channel(), task->sock, task->sock);
+    ares_process_channels(env, task->sock, task->sock);
     return;
   }
 
   /* Process DNS responses */
-  ares_process_fd(env->cares_channel(),
-                  events & UV_READABLE ? task->sock : ARES_SOCKET_BAD,
-                  events & UV_WRITABLE ? task->sock : ARES_SOCKET_BAD);
+  ares_process_channels(env,
+                        events & UV_READABLE ? task->sock : ARES_SOCKET_BAD,
+                        events & UV_WRITABLE ? task->sock : ARES_SOCKET_BAD);
 }
 
 
@@ -235,6 +259,25 @@ static Local<Array> HostentToAddresses(Environment* env, struct hostent* host) {
 }
 
 
+// The addresses back to back in network byte order, |size| bytes each.
+static Local<Value> HostentToPackedAddresses(Environment* env,
+                                             struct hostent* host,
+                                             size_t size) {
+  EscapableHandleScope scope(env->isolate());
+
+  size_t count = 0;
+  while (host->h_addr_list[count] != nullptr)
+    count++;
+
+  Local<Object> buffer = Buffer::New(env, count * size).ToLocalChecked();
+  char* data = Buffer::Data(buffer);
+  for (size_t i = 0; i < count; i++)
+    memcpy(data + i * size, host->h_addr_list[i], size);
+
+  return scope.Escape(buffer);
+}
+
+
 static Local<Array> HostentToNames(Environment* env, struct hostent* host) {
   EscapableHandleScope scope(env->isolate());
   Local<Array> names = Array::New(env->isolate());
@@ -251,14 +294,17 @@ static Local<Array> HostentToNames(Environment* env, struct hostent* host) {
 class QueryWrap : public AsyncWrap {
  public:
   QueryWrap(Environment* env, Local<Object> req_wrap_obj)
-      : AsyncWrap(env, req_wrap_obj, AsyncWrap::PROVIDER_QUERYWRAP) {
+      : AsyncWrap(env, req_wrap_obj, AsyncWrap::PROVIDER_QUERYWRAP),
+        packed_(false) {
     if (env->in_domain())
       req_wrap_obj->Set(env->domain_string(), env->domain_array()->Get(0));
+    *env->cares_query_count() += 1;
   }
 
   virtual ~QueryWrap() override {
     CHECK_EQ(false, persistent().IsEmpty());
     persistent().Reset();
+    *env()->cares_query_count() -= 1;
   }
 
   // Subclasses should implement the appropriate Send method.
@@ -272,6 +318,10 @@ class QueryWrap : public AsyncWrap {
     return 0;
   }
 
+  // Answers in typed arrays instead of JS strings and objects, for the
+  // queries that support it.
+  void set_packed(bool packed) { packed_ = packed; }
+
  protected:
   void* GetQueryArg() {
     return static_cast<void*>(this);
@@ -374,6 +424,8 @@ class QueryWrap : public AsyncWrap {
   virtual void Parse(struct hostent* host) {
     UNREACHABLE();
   };
+
+  bool packed_;
 };
 
 
@@ -384,7 +436,7 @@ class QueryAWrap: public QueryWrap {
   }
 
   int Send(const char* name) override {
-    ares_query(env()->cares_channel(),
+    ares_query(env()->cares_next_channel(),
                name,
                ns_c_in,
                ns_t_a,
@@ -408,7 +460,9 @@ class QueryAWrap: public QueryWrap {
       return;
     }
 
-    Local<Array> addresses = HostentToAddresses(env(), host);
+    Local<Value> addresses =
+        packed_ ? HostentToPackedAddresses(env(), host, 4) :
+                  HostentToAddresses(env(), host).As<Value>();
     ares_free_hostent(host);
 
     this->CallOnComplete(addresses);
@@ -423,7 +477,7 @@ class QueryAaaaWrap: public QueryWrap {
   }
 
   int Send(const char* name) override {
-    ares_query(env()->cares_channel(),
+    ares_query(env()->cares_next_channel(),
                name,
                ns_c_in,
                ns_t_aaaa,
@@ -447,7 +501,9 @@ class QueryAaaaWrap: public QueryWrap {
       return;
     }
 
-    Local<Array> addresses = HostentToAddresses(env(), host);
+    Local<Value> addresses =
+        packed_ ? HostentToPackedAddresses(env(), host, 16) :
+                  HostentToAddresses(env(), host).As<Value>();
     ares_free_hostent(host);
 
     this->CallOnComplete(addresses);
@@ -462,7 +518,7 @@ class QueryCnameWrap: public QueryWrap {
   }
 
   int Send(const char* name) override {
-    ares_query(env()->cares_channel(),
+    ares_query(env()->cares_next_channel(),
                name,
                ns_c_in,
                ns_t_cname,
@@ -503,7 +559,7 @@ class QueryMxWrap: public QueryWrap {
   }
 
   int Send(const char* name) override {
-    ares_query(env()->cares_channel(),
+    ares_query(env()->cares_next_channel(),
                name,
                ns_c_in,
                ns_t_mx,
@@ -554,7 +610,7 @@ class QueryNsWrap: public QueryWrap {
   }
 
   int Send(const char* name) override {
-    ares_query(env()->cares_channel(),
+    ares_query(env()->cares_next_channel(),
                name,
                ns_c_in,
                ns_t_ns,
@@ -592,7 +648,7 @@ class QueryTxtWrap: public QueryWrap {
   }
 
   int Send(const char* name) override {
-    ares_query(env()->cares_channel(),
+    ares_query(env()->cares_next_channel(),
                name,
                ns_c_in,
                ns_t_txt,
@@ -649,7 +705,7 @@ class QuerySrvWrap: public QueryWrap {
   }
 
   int Send(const char* name) override {
-    ares_query(env()->cares_channel(),
+    ares_query(env()->cares_next_channel(),
                name,
                ns_c_in,
                ns_t_srv,
@@ -672,6 +728,13 @@ class QuerySrvWrap: public QueryWrap {
       return;
     }
 
+    if (packed_) {
+      Local<Object> srv_records = PackSrvRecords(srv_start);
+      ares_free_data(srv_start);
+      this->CallOnComplete(srv_records);
+      return;
+    }
+
     Local<Array> srv_records = Array::New(env()->isolate());
     Local<String> name_symbol = env()->name_string();
     Local<String> port_symbol = env()->port_string();
@@ -696,6 +759,56 @@ class QuerySrvWrap: public QueryWrap {
 
     this->CallOnComplete(srv_records);
   }
+
+ private:
+  // { names, nameIndex, priority, weight, port }: the fields of record i are
+  // at index i of the Uint16Arrays, which share one ArrayBuffer, and its name
+  // is names[nameIndex[i]].  Every name is only a string once.  A reply is at
+  // most 64 KB, so the indices fit in 16 bits.
+  Local<Object> PackSrvRecords(ares_srv_reply* srv_start) {
+    Isolate* isolate = env()->isolate();
+    EscapableHandleScope scope(isolate);
+
+    size_t count = 0;
+    for (ares_srv_reply* current = srv_start;
+         current != nullptr;
+         current = current->next) {
+      count++;
+    }
+
+    Local<ArrayBuffer> ab = ArrayBuffer::New(isolate, 4 * count * 2);
+    Local<Uint16Array> name_index = Uint16Array::New(ab, 0, count);
+    Local<Uint16Array> priority = Uint16Array::New(ab, 2 * count, count);
+    Local<Uint16Array> weight = Uint16Array::New(ab, 4 * count, count);
+    Local<Uint16Array> port = Uint16Array::New(ab, 6 * count, count);
+    uint16_t* fields = static_cast<uint16_t*>(ab->GetContents().Data());
+
+    Local<Array> names = Array::New(isolate);
+    std::unordered_map<std::string, uint16_t> indices;
+    size_t i = 0;
+    for (ares_srv_reply* current = srv_start;
+         current != nullptr;
+         ++i, current = current->next) {
+      auto it = indices.find(current->host);
+      if (it == indices.end()) {
+        const uint16_t index = indices.size();
+        it = indices.emplace(current->host, index).first;
+        names->Set(index, OneByteString(isolate, current->host));
+      }
+      fields[i] = it->second;
+      fields[count + i] = current->priority;
+      fields[2 * count + i] = current->weight;
+      fields[3 * count + i] = current->port;
+    }
+
+    Local<Object> srv_records = Object::New(isolate);
+    srv_records->Set(FIXED_ONE_BYTE_STRING(isolate, "names"), names);
+    srv_records->Set(FIXED_ONE_BYTE_STRING(isolate, "nameIndex"), name_index);
+    srv_records->Set(env()->priority_string(), priority);
+    srv_records->Set(env()->weight_string(), weight);
+    srv_records->Set(env()->port_string(), port);
+    return scope.Escape(srv_records);
+  }
 };
 
 class QueryPtrWrap: public QueryWrap {
@@ -705,7 +818,7 @@ class QueryPtrWrap: public QueryWrap {
   }
 
   int Send(const char* name) override {
-    ares_query(env()->cares_channel(),
+    ares_query(env()->cares_next_channel(),
                name,
                ns_c_in,
                ns_t_ptr,
@@ -748,7 +861,7 @@ class QueryNaptrWrap: public QueryWrap {
   }
 
   int Send(const char* name) override {
-    ares_query(env()->cares_channel(),
+    ares_query(env()->cares_next_channel(),
                name,
                ns_c_in,
                ns_t_naptr,
@@ -812,7 +925,7 @@ class QuerySoaWrap: public QueryWrap {
   }
 
   int Send(const char* name) override {
-    ares_query(env()->cares_channel(),
+    ares_query(env()->cares_next_channel(),
                name,
                ns_c_in,
                ns_t_soa,
@@ -880,7 +993,7 @@ class GetHostByAddrWrap: public QueryWrap {
       return UV_EINVAL;  // So errnoException() reports a proper error.
     }
 
-    ares_gethostbyaddr(env()->cares_channel(),
+    ares_gethostbyaddr(env()->cares_next_channel(),
                        address_buffer,
                        length,
                        family,
@@ -907,7 +1020,7 @@ class GetHostByNameWrap: public QueryWrap {
   }
 
   int Send(const char* name, int family) override {
-    ares_gethostbyname(env()->cares_channel(),
+    ares_gethostbyname(env()->cares_next_channel(),
                        name,
                        family,
                        Callback,
@@ -915,6 +1028,8 @@ class GetHostByNameWrap: public QueryWrap {
     return 0;
   }
 
+  size_t self_size() const override { return sizeof(*this); }
+
  protected:
   void Parse(struct hostent* host) override {
     HandleScope scope(env()->isolate());
@@ -938,6 +1053,7 @@ static void Query(const FunctionCallbackInfo<Value>& args) {
   Local<Object> req_wrap_obj = args[0].As<Object>();
   Local<String> string = args[1].As<String>();
   Wrap* wrap = new Wrap(env, req_wrap_obj);
+  wrap->set_packed(args[2]->IsTrue());
 
   node::Utf8Value name(env->isolate(), string);
   int err = wrap->Send(*name);
@@ -948,94 +1064,69 @@ static void Query(const FunctionCallbackInfo<Value>& args) {
 }
 
 
-void AfterGetAddrInfo(uv_getaddrinfo_t* req, int status, struct addrinfo* res) {
-  GetAddrInfoReqWrap* req_wrap = static_cast<GetAddrInfoReqWrap*>(req->data);
-  Environment* env = req_wrap->env();
-
-  HandleScope handle_scope(env->isolate());
-  Context::Scope context_scope(env->context());
-
-  Local<Value> argv[] = {
-    Integer::New(env->isolate(), status),
-    Null(env->isolate())
-  };
-
-  if (status == 0) {
-    // Success
-    struct addrinfo *address;
-    int n = 0;
-
-    // Create the response array.
-    Local<Array> results = Array::New(env->isolate());
-
-    char ip[INET6_ADDRSTRLEN];
-    const char *addr;
+// Collects the IPv4 addresses first, then the IPv6 ones.
+static void AddressesFromAddrInfo(struct addrinfo* res,
+                                  DNSCache::Addresses* addresses) {
+  static const int families[] = { AF_INET, AF_INET6 };
+  char ip[INET6_ADDRSTRLEN];
 
-    // Iterate over the IPv4 responses again this time creating javascript
-    // strings for each IP and filling the results array.
-    address = res;
-    while (address) {
+  for (int family : families) {
+    for (struct addrinfo* address = res;
+         address != nullptr;
+         address = address->ai_next) {
       CHECK_EQ(address->ai_socktype, SOCK_STREAM);
 
       // Ignore random ai_family types.
-      if (address->ai_family == AF_INET) {
-        // Juggle pointers
+      if (address->ai_family != family)
+        continue;
+
+      // Juggle pointers
+      const char* addr;
+      if (family == AF_INET) {
         addr = reinterpret_cast<char*>(&(reinterpret_cast<struct sockaddr_in*>(
             address->ai_addr)->sin_addr));
-        int err = uv_inet_ntop(address->ai_family,
-                               addr,
-                               ip,
-                               INET6_ADDRSTRLEN);
-        if (err)
-          continue;
-
-        // Create JavaScript string
-        Local<String> s = OneByteString(env->isolate(), ip);
-        results->Set(n, s);
-        n++;
+      } else {
+        addr = reinterpret_cast<char*>(
+            &(reinterpret_cast<struct sockaddr_in6*>(
+                address->ai_addr)->sin6_addr));
       }
 
-      // Increment
-      address = address->ai_next;
+      if (uv_inet_ntop(family, addr, ip, INET6_ADDRSTRLEN) == 0)
+        addresses->push_back(ip);
     }
+  }
+}
 
-    // Iterate over the IPv6 responses putting them in the array.
-    address = res;
-    while (address) {
-      CHECK_EQ(address->ai_socktype, SOCK_STREAM);
 
-      // Ignore random ai_family types.
-      if (address->ai_family == AF_INET6) {
-        // Juggle pointers
-        addr = reinterpret_cast<char*>(&(reinterpret_cast<struct sockaddr_in6*>(
-            address->ai_addr)->sin6_addr));
-        int err = uv_inet_ntop(address->ai_family,
-                               addr,
-                               ip,
-                               INET6_ADDRSTRLEN);
-        if (err)
-          continue;
-
-        // Create JavaScript string
-        Local<String> s = OneByteString(env->isolate(), ip);
-        results->Set(n, s);
-        n++;
-      }
+static Local<Array> AddressesToArray(Environment* env,
+                                     const DNSCache::Addresses& addresses) {
+  Local<Array> results = Array::New(env->isolate(), addresses.size());
+  for (size_t i = 0; i < addresses.size(); i++)
+    results->Set(i, OneByteString(env->isolate(), addresses[i].c_str()));
+  return results;
+}
 
-      // Increment
-      address = address->ai_next;
-    }
 
+static void CompleteGetAddrInfo(GetAddrInfoReqWrap* req_wrap,
+                                int status,
+                                const DNSCache::Addresses& addresses) {
+  Environment* env = req_wrap->env();
+
+  HandleScope handle_scope(env->isolate());
+  Context::Scope context_scope(env->context());
+
+  Local<Value> argv[] = {
+    Integer::New(env->isolate(), status),
+    Null(env->isolate())
+  };
+
+  if (status == 0) {
     // No responses were found to return
-    if (n == 0) {
+    if (addresses.empty())
       argv[0] = Integer::New(env->isolate(), UV_EAI_NODATA);
-    }
-
-    argv[1] = results;
+    argv[1] = AddressesToArray(env, addresses);
   }
 
-  uv_freeaddrinfo(res);
-
   // Make the callback into JavaScript
   req_wrap->MakeCallback(env->oncomplete_string(), arraysize(argv), argv);
 
@@ -1043,6 +1134,30 @@ void AfterGetAddrInfo(uv_getaddrinfo_t* req, int status, struct addrinfo* res) {
 }
 
 
+void AfterGetAddrInfo(uv_getaddrinfo_t* req, int status, struct addrinfo* res) {
+  GetAddrInfoReqWrap* req_wrap = static_cast<GetAddrInfoReqWrap*>(req->data);
+  Environment* env = req_wrap->env();
+
+  NODE_TRACE_ASYNC_END0("node.dns", "getaddrinfo", req_wrap);
+
+  DNSCache::Addresses addresses;
+  if (status == 0)
+    AddressesFromAddrInfo(res, &addresses);
+  uv_freeaddrinfo(res);
+
+  // The requests that joined this one get the same result.
+  std::vector<DNSCache::Request*> waiting;
+  if (!req_wrap->cache_key.empty())
+    env->dns_cache()->Done(req_wrap->cache_key, status, addresses, &waiting);
+
+  CompleteGetAddrInfo(req_wrap, status, addresses);
+  for (DNSCache::Request* waiter : waiting)
+    CompleteGetAddrInfo(static_cast<GetAddrInfoReqWrap*>(waiter),
+                        status,
+                        addresses);
+}
+
+
 void AfterGetNameInfo(uv_getnameinfo_t* req,
                       int status,
                       const char* hostname,
@@ -1109,6 +1224,47 @@ static void IsIPv6(const FunctionCallbackInfo<Value>& args) {
   }
 }
 
+// Looks up the A or AAAA records of a host through the c-ares channel, which
+// consults the hosts file first, see dns.lookup().
+static void GetHostByName(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+
+  CHECK(args[0]->IsObject());
+  CHECK(args[1]->IsString());
+  CHECK(args[2]->IsInt32());
+
+  int family;
+  switch (args[2]->Int32Value()) {
+  case 4:
+    family = AF_INET;
+    break;
+  case 6:
+    family = AF_INET6;
+    break;
+  default:
+    CHECK(0 && "bad address family");
+    ABORT();
+  }
+
+  GetHostByNameWrap* wrap = new GetHostByNameWrap(env, args[0].As<Object>());
+
+  node::Utf8Value name(env->isolate(), args[1]);
+  int err = wrap->Send(*name, family);
+  if (err)
+    delete wrap;
+
+  args.GetReturnValue().Set(err);
+}
+
+
+// The same host can resolve differently depending on the family and flags.
+static std::string LookupCacheKey(const char* hostname,
+                                  int32_t family,
+                                  int32_t flags) {
+  return std::to_string(family) + ':' + std::to_string(flags) + ':' + hostname;
+}
+
+
 static void GetAddrInfo(const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args);
 
@@ -1138,6 +1294,17 @@ static void GetAddrInfo(const FunctionCallbackInfo<Value>& args) {
 
   GetAddrInfoReqWrap* req_wrap = new GetAddrInfoReqWrap(env, req_wrap_obj);
 
+  // Share the result of a lookup of the same host that is still in progress.
+  DNSCache* cache = env->dns_cache();
+  if (cache->enabled()) {
+    req_wrap->cache_key = LookupCacheKey(*hostname, family, flags);
+    if (cache->Join(req_wrap->cache_key, req_wrap)) {
+      req_wrap->Dispatched();
+      args.GetReturnValue().Set(0);
+      return;
+    }
+  }
+
   struct addrinfo hints;
   memset(&hints, 0, sizeof(struct addrinfo));
   hints.ai_family = family;
@@ -1151,13 +1318,69 @@ static void GetAddrInfo(const FunctionCallbackInfo<Value>& args) {
                            nullptr,
                            &hints);
   req_wrap->Dispatched();
-  if (err)
+  if (err == 0)
+    NODE_TRACE_ASYNC_BEGIN0("node.dns", "getaddrinfo", req_wrap);
+  if (err) {
+    if (!req_wrap->cache_key.empty()) {
+      std::vector<DNSCache::Request*> waiting;
+      cache->Done(req_wrap->cache_key, err, DNSCache::Addresses(), &waiting);
+      CHECK(waiting.empty());
+    }
     delete req_wrap;
+  }
 
   args.GetReturnValue().Set(err);
 }
 
 
+// Returns the cached addresses of a host or undefined.  Arguments are the
+// same as for getaddrinfo(), minus the request object.
+static void GetCachedAddrInfo(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+
+  CHECK(args[0]->IsString());
+  CHECK(args[1]->IsInt32());
+  node::Utf8Value hostname(env->isolate(), args[0]);
+  int32_t flags = (args[2]->IsInt32()) ? args[2]->Int32Value() : 0;
+  int32_t family = args[1]->Int32Value();
+  family = family == 4 ? AF_INET : family == 6 ? AF_INET6 : AF_UNSPEC;
+
+  const DNSCache::Addresses* addresses =
+      env->dns_cache()->Get(LookupCacheKey(*hostname, family, flags));
+  if (addresses != nullptr)
+    args.GetReturnValue().Set(AddressesToArray(env, *addresses));
+}
+
+
+static void EnableLookupCache(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  CHECK(args[0]->IsNumber());
+  CHECK(args[1]->IsUint32());
+  const double ttl = args[0]->NumberValue();
+  CHECK_GE(ttl, 0);
+  env->dns_cache()->Enable(static_cast<uint64_t>(ttl),
+                           args[1]->Uint32Value());
+}
+
+
+static void DisableLookupCache(const FunctionCallbackInfo<Value>& args) {
+  Environment::GetCurrent(args)->dns_cache()->Disable();
+}
+
+
+// Fills an array with the hits, misses, coalesced lookups and entries.
+static void GetLookupCacheStats(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  CHECK(args[0]->IsArray());
+  Local<Array> stats = args[0].As<Array>();
+  DNSCache* cache = env->dns_cache();
+  stats->Set(0, Number::New(env->isolate(), cache->hits()));
+  stats->Set(1, Number::New(env->isolate(), cache->misses()));
+  stats->Set(2, Number::New(env->isolate(), cache->coalesced()));
+  stats->Set(3, Number::New(env->isolate(), cache->size()));
+}
+
+
 static void GetNameInfo(const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args);
 
@@ -1216,6 +1439,17 @@ static void GetServers(const FunctionCallbackInfo<Value>& args) {
 }
 
 
+// The extra channels always use the servers of the default one.
+static int SetChannelServers(Environment* env, ares_addr_node* servers) {
+  int err = ares_set_servers(env->cares_channel(), servers);
+  for (ares_channel channel : *env->cares_extra_channels()) {
+    if (err == ARES_SUCCESS)
+      err = ares_set_servers(channel, servers);
+  }
+  return err;
+}
+
+
 static void SetServers(const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args);
 
@@ -1226,7 +1460,7 @@ static void SetServers(const FunctionCallbackInfo<Value>& args) {
   uint32_t len = arr->Length();
 
   if (len == 0) {
-    int rv = ares_set_servers(env->cares_channel(), nullptr);
+    int rv = SetChannelServers(env, nullptr);
     return args.GetReturnValue().Set(rv);
   }
 
@@ -1274,7 +1508,7 @@ static void SetServers(const FunctionCallbackInfo<Value>& args) {
   }
 
   if (err == 0)
-    err = ares_set_servers(env->cares_channel(), &servers[0]);
+    err = SetChannelServers(env, &servers[0]);
   else
     err = ARES_EBADSTR;
 
@@ -1284,6 +1518,80 @@ static void SetServers(const FunctionCallbackInfo<Value>& args) {
 }
 
 
+static int DefaultChannelOptions(Environment* env,
+                                 struct ares_options* options) {
+  memset(options, 0, sizeof(*options));
+  options->flags = ARES_FLAG_NOCHECKRESP;
+  options->sock_state_cb = ares_sockstate_cb;
+  options->sock_state_cb_data = env;
+  return ARES_OPT_FLAGS | ARES_OPT_SOCK_STATE_CB;
+}
+
+
+// Replaces the channels with |args[5]| new ones that use the options of
+// dns.setResolverOptions() and the current servers.  A negative timeout,
+// tries or EDNS size keeps the default of c-ares.  Returns false without
+// changing anything while queries are pending.
+static void SetResolverOptions(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+
+  // Also true in the callback of a query, c-ares still uses the channel.
+  if (*env->cares_query_count() > 0)
+    return args.GetReturnValue().Set(false);
+
+  const int32_t timeout = args[0]->Int32Value();
+  const int32_t tries = args[1]->Int32Value();
+  const bool rotate = args[2]->IsTrue();
+  const bool stay_open = args[3]->IsTrue();
+  const int32_t edns_size = args[4]->Int32Value();
+  const uint32_t count = args[5]->Uint32Value();
+  CHECK_GE(count, 1);
+
+  struct ares_options options;
+  int optmask = DefaultChannelOptions(env, &options);
+  if (timeout >= 0) {
+    options.timeout = timeout;
+    optmask |= ARES_OPT_TIMEOUTMS;
+  }
+  if (tries >= 0) {
+    options.tries = tries;
+    optmask |= ARES_OPT_TRIES;
+  }
+  if (rotate)
+    optmask |= ARES_OPT_ROTATE;
+  if (stay_open)
+    options.flags |= ARES_FLAG_STAYOPEN;
+  if (edns_size >= 0) {
+    options.flags |= ARES_FLAG_EDNS;
+    options.ednspsz = edns_size;
+    optmask |= ARES_OPT_EDNSPSZ;
+  }
+
+  ares_addr_node* servers;
+  int r = ares_get_servers(env->cares_channel(), &servers);
+  CHECK_EQ(r, ARES_SUCCESS);
+
+  std::vector<ares_channel> channels(count);
+  for (size_t i = 0; i < channels.size(); i++) {
+    r = ares_init_options(&channels[i], &options, optmask);
+    CHECK_EQ(r, ARES_SUCCESS);
+    r = ares_set_servers(channels[i], servers);
+    CHECK_EQ(r, ARES_SUCCESS);
+  }
+  ares_free_data(servers);
+
+  // Closes the sockets of the old channels, ares_sockstate_cb() drops their
+  // tasks and stops the timer.
+  ares_destroy(env->cares_channel());
+  for (ares_channel channel : *env->cares_extra_channels())
+    ares_destroy(channel);
+
+  *env->cares_channel_ptr() = channels[0];
+  env->cares_extra_channels()->assign(channels.begin() + 1, channels.end());
+  args.GetReturnValue().Set(true);
+}
+
+
 static void StrError(const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args);
   const char* errmsg = ares_strerror(args[0]->Int32Value());
@@ -1314,15 +1622,10 @@ static void Initialize(Local<Object> target,
   CHECK_EQ(r, ARES_SUCCESS);
 
   struct ares_options options;
-  memset(&options, 0, sizeof(options));
-  options.flags = ARES_FLAG_NOCHECKRESP;
-  options.sock_state_cb = ares_sockstate_cb;
-  options.sock_state_cb_data = env;
+  int optmask = DefaultChannelOptions(env, &options);
 
   /* We do the call to ares_init_option for caller. */
-  r = ares_init_options(env->cares_channel_ptr(),
-                        &options,
-                        ARES_OPT_FLAGS | ARES_OPT_SOCK_STATE_CB);
+  r = ares_init_options(env->cares_channel_ptr(), &options, optmask);
   CHECK_EQ(r, ARES_SUCCESS);
 
   /* Initialize the timeout timer. The timer won't be started until the */
@@ -1344,8 +1647,13 @@ static void Initialize(Local<Object> target,
   env->SetMethod(target, "queryNaptr", Query<QueryNaptrWrap>);
   env->SetMethod(target, "querySoa", Query<QuerySoaWrap>);
   env->SetMethod(target, "getHostByAddr", Query<GetHostByAddrWrap>);
+  env->SetMethod(target, "getHostByName", GetHostByName);
 
   env->SetMethod(target, "getaddrinfo", GetAddrInfo);
+  env->SetMethod(target, "getCachedAddrInfo", GetCachedAddrInfo);
+  env->SetMethod(target, "enableLookupCache", EnableLookupCache);
+  env->SetMethod(target, "disableLookupCache", DisableLookupCache);
+  env->SetMethod(target, "getLookupCacheStats", GetLookupCacheStats);
   env->SetMethod(target, "getnameinfo", GetNameInfo);
   env->SetMethod(target, "isIP", IsIP);
   env->SetMethod(target, "isIPv4", IsIPv4);
@@ -1354,6 +1662,7 @@ static void Initialize(Local<Object> target,
   env->SetMethod(target, "strerror", StrError);
   env->SetMethod(target, "getServers", GetServers);
   env->SetMethod(target, "setServers", SetServers);
+  env->SetMethod(target, "setResolverOptions", SetResolverOptions);
 
   target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "AF_INET"),
               Integer::New(env->isolate(), AF_INET));
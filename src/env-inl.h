@@ -2,7 +2,19 @@
 #define SRC_ENV_INL_H_
 
 #include "env.h"
+#include "async-wrap.h"
 #include "node.h"
+#include "node_async_accounting.h"
+#include "node_dns_cache.h"
+#include "node_gc_stats.h"
+#include "node_idle_scheduler.h"
+#include "node_loop_stats.h"
+#include "node_memory_pressure.h"
+#include "node_script_cache.h"
+#include "node_stat_watcher.h"
+#include "node_watchdog.h"
+#include "slab_allocator.h"
+#include "timer_wrap.h"
 #include "util.h"
 #include "util-inl.h"
 #include "uv.h"
@@ -10,6 +22,8 @@
 
 #include <stddef.h>
 #include <stdint.h>
+#include <string.h>
+#include <vector>
 
 namespace node {
 
@@ -103,7 +117,8 @@ inline void Environment::AsyncHooks::set_enable_callbacks(uint32_t flag) {
 
 inline Environment::AsyncCallbackScope::AsyncCallbackScope(Environment* env)
     : env_(env) {
-  env_->makecallback_cntr_++;
+  if (env_->makecallback_cntr_++ == 0)
+    env_->UpdateTimerInfo();
 }
 
 inline Environment::AsyncCallbackScope::~AsyncCallbackScope() {
@@ -155,6 +170,37 @@ inline void Environment::TickInfo::set_index(uint32_t value) {
   fields_[kIndex] = value;
 }
 
+inline Environment::TimerInfo::TimerInfo() {
+  for (int i = 0; i < kFieldsCount; ++i)
+    fields_[i] = 0;
+}
+
+inline double* Environment::TimerInfo::fields() {
+  return fields_;
+}
+
+inline int Environment::TimerInfo::fields_count() const {
+  return kFieldsCount;
+}
+
+inline Environment::WriteInfo::WriteInfo() {
+  for (int i = 0; i < kFieldsCount; ++i)
+    fields_[i] = 0;
+}
+
+inline double* Environment::WriteInfo::fields() {
+  return fields_;
+}
+
+inline int Environment::WriteInfo::fields_count() const {
+  return kFieldsCount;
+}
+
+inline void Environment::WriteInfo::set(size_t bytes, bool async) {
+  fields_[kBytesWritten] = static_cast<double>(bytes);
+  fields_[kLastWriteWasAsync] = async;
+}
+
 inline Environment::ArrayBufferAllocatorInfo::ArrayBufferAllocatorInfo() {
   for (int i = 0; i < kFieldsCount; ++i)
     fields_[i] = 0;
@@ -217,9 +263,14 @@ inline Environment::Environment(v8::Local<v8::Context> context,
     : isolate_(context->GetIsolate()),
       isolate_data_(IsolateData::GetOrCreate(context->GetIsolate(), loop)),
       timer_base_(uv_now(loop)),
+      cares_next_channel_(0),
+      cares_query_count_(0),
       using_domains_(false),
+      plain_callbacks_(true),
       printed_error_(false),
       trace_sync_io_(false),
+      in_tick_batch_(false),
+      tick_batch_pending_(false),
       makecallback_cntr_(0),
       async_wrap_uid_(0),
       debugger_agent_(this),
@@ -227,6 +278,22 @@ inline Environment::Environment(v8::Local<v8::Context> context,
       inspector_agent_(this),
 #endif
       http_parser_buffer_(nullptr),
+      read_slab_allocator_(nullptr),
+      shared_read_buffer_(nullptr),
+      timer_wheel_(nullptr),
+      loop_stats_(nullptr),
+      async_accounting_(nullptr),
+      stall_watchdog_(nullptr),
+      idle_scheduler_(nullptr),
+      memory_pressure_monitor_(nullptr),
+      gc_stats_(nullptr),
+      dns_cache_(nullptr),
+      script_cache_(nullptr),
+      env_vars_generation_(0),
+      stat_scheduler_(nullptr),
+      worker_(nullptr),
+      node_instance_(nullptr),
+      array_buffer_allocator_(nullptr),
       context_(context->GetIsolate(), context) {
   // We'll be creating new objects so make sure we've entered the context.
   v8::HandleScope handle_scope(isolate());
@@ -258,6 +325,18 @@ inline Environment::~Environment() {
   delete[] heap_statistics_buffer_;
   delete[] heap_space_statistics_buffer_;
   delete[] http_parser_buffer_;
+  delete read_slab_allocator_;
+  delete[] shared_read_buffer_;
+  delete timer_wheel_;
+  delete loop_stats_;
+  delete async_accounting_;
+  delete stall_watchdog_;
+  delete idle_scheduler_;
+  delete memory_pressure_monitor_;
+  delete gc_stats_;
+  delete dns_cache_;
+  delete script_cache_;
+  delete stat_scheduler_;
 }
 
 inline void Environment::CleanupHandles() {
@@ -320,6 +399,24 @@ inline uv_check_t* Environment::idle_check_handle() {
   return &idle_check_handle_;
 }
 
+inline Environment* Environment::from_tick_batch_prepare_handle(
+    uv_prepare_t* handle) {
+  return ContainerOf(&Environment::tick_batch_prepare_handle_, handle);
+}
+
+inline uv_prepare_t* Environment::tick_batch_prepare_handle() {
+  return &tick_batch_prepare_handle_;
+}
+
+inline Environment* Environment::from_tick_batch_check_handle(
+    uv_check_t* handle) {
+  return ContainerOf(&Environment::tick_batch_check_handle_, handle);
+}
+
+inline uv_check_t* Environment::tick_batch_check_handle() {
+  return &tick_batch_check_handle_;
+}
+
 inline void Environment::RegisterHandleCleanup(uv_handle_t* handle,
                                                HandleCleanupCb cb,
                                                void *arg) {
@@ -346,6 +443,19 @@ inline Environment::TickInfo* Environment::tick_info() {
   return &tick_info_;
 }
 
+inline Environment::TimerInfo* Environment::timer_info() {
+  return &timer_info_;
+}
+
+inline void Environment::UpdateTimerInfo() {
+  timer_info_.fields_[TimerInfo::kNow] =
+      static_cast<double>(uv_now(event_loop()) - timer_base());
+}
+
+inline Environment::WriteInfo* Environment::write_info() {
+  return &write_info_;
+}
+
 inline Environment::ArrayBufferAllocatorInfo*
     Environment::array_buffer_allocator_info() {
   return &array_buffer_allocator_info_;
@@ -361,6 +471,18 @@ inline bool Environment::using_domains() const {
 
 inline void Environment::set_using_domains(bool value) {
   using_domains_ = value;
+  UpdatePlainCallbacks();
+}
+
+inline bool Environment::plain_callbacks() const {
+  return plain_callbacks_;
+}
+
+inline void Environment::UpdatePlainCallbacks() {
+  plain_callbacks_ = !using_domains_ &&
+                     async_hooks_pre_function_.IsEmpty() &&
+                     async_hooks_post_function_.IsEmpty() &&
+                     native_async_hooks_.empty();
 }
 
 inline bool Environment::printed_error() const {
@@ -375,6 +497,22 @@ inline void Environment::set_trace_sync_io(bool value) {
   trace_sync_io_ = value;
 }
 
+inline bool Environment::in_tick_batch() const {
+  return in_tick_batch_;
+}
+
+inline void Environment::set_in_tick_batch(bool value) {
+  in_tick_batch_ = value;
+}
+
+inline bool Environment::tick_batch_pending() const {
+  return tick_batch_pending_;
+}
+
+inline void Environment::set_tick_batch_pending(bool value) {
+  tick_batch_pending_ = value;
+}
+
 inline int64_t Environment::get_async_wrap_uid() {
   return ++async_wrap_uid_;
 }
@@ -409,6 +547,271 @@ inline void Environment::set_http_parser_buffer(char* buffer) {
   http_parser_buffer_ = buffer;
 }
 
+inline Environment::HttpDate* Environment::http_date() {
+  return &http_date_;
+}
+
+inline Environment::BIOBufferPool* Environment::bio_buffer_pool() {
+  return &bio_buffer_pool_;
+}
+
+inline Environment::ReqStoragePool* Environment::req_storage_pool() {
+  return &req_storage_pool_;
+}
+
+template <size_t BlockSize, size_t MaxRetained>
+inline v8::Local<v8::Object> Environment::FreeListPoolStats(
+    const FreeListPool<BlockSize, MaxRetained>* pool) {
+  v8::Local<v8::Object> stats = v8::Object::New(isolate());
+  stats->Set(FIXED_ONE_BYTE_STRING(isolate(), "hits"),
+             v8::Number::New(isolate(), pool->hits()));
+  stats->Set(FIXED_ONE_BYTE_STRING(isolate(), "misses"),
+             v8::Number::New(isolate(), pool->misses()));
+  stats->Set(FIXED_ONE_BYTE_STRING(isolate(), "retained"),
+             v8::Number::New(isolate(), pool->retained_bytes()));
+  return stats;
+}
+
+inline Environment::RandomPool::~RandomPool() {
+  if (data_ != nullptr) {
+    memset(data_, 0, kSize);
+    delete[] data_;
+  }
+}
+
+inline bool Environment::RandomPool::Take(char* out, size_t length) {
+  if (length > available_)
+    return false;
+  // Bytes are taken from the end, and not left behind for later readers of
+  // the pool's memory.
+  available_ -= length;
+  memcpy(out, data_ + available_, length);
+  memset(data_ + available_, 0, length);
+  return true;
+}
+
+inline void Environment::RandomPool::Fill(char* data) {
+  if (data_ != nullptr) {
+    memset(data_, 0, kSize);
+    delete[] data_;
+  }
+  data_ = data;
+  available_ = kSize;
+}
+
+inline size_t Environment::RandomPool::available() const {
+  return available_;
+}
+
+inline bool Environment::RandomPool::refilling() const {
+  return refilling_;
+}
+
+inline void Environment::RandomPool::set_refilling(bool refilling) {
+  refilling_ = refilling;
+}
+
+inline Environment::RandomPool* Environment::random_pool() {
+  return &random_pool_;
+}
+
+inline SlabAllocator* Environment::read_slab_allocator() {
+  if (read_slab_allocator_ == nullptr)
+    read_slab_allocator_ = new SlabAllocator(isolate());
+  return read_slab_allocator_;
+}
+
+inline char* Environment::shared_read_buffer() {
+  if (shared_read_buffer_ == nullptr)
+    shared_read_buffer_ = new char[kSharedReadBufferSize];
+  return shared_read_buffer_;
+}
+
+inline TimerWheel* Environment::timer_wheel() {
+  if (timer_wheel_ == nullptr)
+    timer_wheel_ = new TimerWheel(this);
+  return timer_wheel_;
+}
+
+inline LoopStats* Environment::loop_stats() {
+  if (loop_stats_ == nullptr)
+    loop_stats_ = new LoopStats(this);
+  return loop_stats_;
+}
+
+inline AsyncAccounting* Environment::async_accounting() {
+  if (async_accounting_ == nullptr)
+    async_accounting_ = new AsyncAccounting(this);
+  return async_accounting_;
+}
+
+inline StallWatchdog* Environment::stall_watchdog() {
+  if (stall_watchdog_ == nullptr)
+    stall_watchdog_ = new StallWatchdog(this);
+  return stall_watchdog_;
+}
+
+inline IdleScheduler* Environment::idle_scheduler() {
+  if (idle_scheduler_ == nullptr)
+    idle_scheduler_ = new IdleScheduler(this);
+  return idle_scheduler_;
+}
+
+inline MemoryPressureMonitor* Environment::memory_pressure_monitor() {
+  if (memory_pressure_monitor_ == nullptr)
+    memory_pressure_monitor_ = new MemoryPressureMonitor(this);
+  return memory_pressure_monitor_;
+}
+
+inline GCStats* Environment::gc_stats() {
+  if (gc_stats_ == nullptr)
+    gc_stats_ = new GCStats(this);
+  return gc_stats_;
+}
+
+inline DNSCache* Environment::dns_cache() {
+  if (dns_cache_ == nullptr)
+    dns_cache_ = new DNSCache(event_loop());
+  return dns_cache_;
+}
+
+inline ScriptCache* Environment::script_cache() {
+  if (script_cache_ == nullptr)
+    script_cache_ = new ScriptCache(isolate());
+  return script_cache_;
+}
+
+inline uint32_t Environment::env_vars_generation() const {
+  return env_vars_generation_;
+}
+
+inline void Environment::set_env_vars_generation(uint32_t generation) {
+  env_vars_generation_ = generation;
+}
+
+inline StatScheduler* Environment::stat_scheduler() {
+  if (stat_scheduler_ == nullptr)
+    stat_scheduler_ = new StatScheduler(this);
+  return stat_scheduler_;
+}
+
+inline Worker* Environment::worker() const {
+  return worker_;
+}
+
+inline void Environment::set_worker(Worker* worker) {
+  worker_ = worker;
+}
+
+inline NodeInstance* Environment::node_instance() const {
+  return node_instance_;
+}
+
+inline void Environment::set_node_instance(NodeInstance* node_instance) {
+  node_instance_ = node_instance;
+}
+
+inline ArrayBufferAllocator* Environment::array_buffer_allocator() const {
+  return array_buffer_allocator_;
+}
+
+inline void Environment::set_array_buffer_allocator(
+    ArrayBufferAllocator* allocator) {
+  array_buffer_allocator_ = allocator;
+}
+
+inline const std::vector<const NativeAsyncHooks*>&
+    Environment::native_async_hooks() const {
+  return native_async_hooks_;
+}
+
+inline void Environment::AddNativeAsyncHooks(const NativeAsyncHooks* hooks) {
+  native_async_hooks_.push_back(hooks);
+  UpdatePlainCallbacks();
+}
+
+inline void Environment::RemoveNativeAsyncHooks(
+    const NativeAsyncHooks* hooks) {
+  for (auto it = native_async_hooks_.begin();
+       it != native_async_hooks_.end();
+       ++it) {
+    if (*it == hooks) {
+      native_async_hooks_.erase(it);
+      UpdatePlainCallbacks();
+      return;
+    }
+  }
+}
+
+inline Environment* Environment::from_destroy_ids_idle_handle(
+    uv_idle_t* handle) {
+  return ContainerOf(&Environment::destroy_ids_idle_handle_, handle);
+}
+
+inline uv_idle_t* Environment::destroy_ids_idle_handle() {
+  return &destroy_ids_idle_handle_;
+}
+
+inline Environment* Environment::from_accept_batch_check_handle(
+    uv_check_t* handle) {
+  return ContainerOf(&Environment::accept_batch_check_handle_, handle);
+}
+
+inline uv_check_t* Environment::accept_batch_check_handle() {
+  return &accept_batch_check_handle_;
+}
+
+inline std::vector<TCPWrap*>* Environment::accept_batch_servers() {
+  return &accept_batch_servers_;
+}
+
+inline Environment* Environment::from_signal_batch_check_handle(
+    uv_check_t* handle) {
+  return ContainerOf(&Environment::signal_batch_check_handle_, handle);
+}
+
+inline uv_check_t* Environment::signal_batch_check_handle() {
+  return &signal_batch_check_handle_;
+}
+
+inline std::vector<SignalWrap*>* Environment::pending_signals() {
+  return &pending_signals_;
+}
+
+inline Environment* Environment::from_fs_errors_check_handle(
+    uv_check_t* handle) {
+  return ContainerOf(&Environment::fs_errors_check_handle_, handle);
+}
+
+inline uv_check_t* Environment::fs_errors_check_handle() {
+  return &fs_errors_check_handle_;
+}
+
+inline std::vector<Environment::DetachedFSError>*
+    Environment::detached_fs_errors() {
+  return &detached_fs_errors_;
+}
+
+inline void Environment::AddDestroyId(int64_t uid, bool native) {
+  if (native)
+    native_destroy_ids_list_.push_back(uid);
+  else
+    destroy_ids_list_.push_back(uid);
+  // Resources that are destroyed during cleanup are not reported anymore.
+  uv_handle_t* handle =
+      reinterpret_cast<uv_handle_t*>(&destroy_ids_idle_handle_);
+  if (!uv_is_closing(handle))
+    uv_idle_start(&destroy_ids_idle_handle_, AsyncWrap::DestroyIdsCb);
+}
+
+inline std::vector<int64_t>* Environment::destroy_ids_list() {
+  return &destroy_ids_list_;
+}
+
+inline std::vector<int64_t>* Environment::native_destroy_ids_list() {
+  return &native_destroy_ids_list_;
+}
+
 inline Environment* Environment::from_cares_timer_handle(uv_timer_t* handle) {
   return ContainerOf(&Environment::cares_timer_handle_, handle);
 }
@@ -430,6 +833,22 @@ inline ares_task_list* Environment::cares_task_list() {
   return &cares_task_list_;
 }
 
+inline std::vector<ares_channel>* Environment::cares_extra_channels() {
+  return &cares_extra_channels_;
+}
+
+inline ares_channel Environment::cares_next_channel() {
+  if (cares_extra_channels_.empty())
+    return cares_channel_;
+  const size_t count = cares_extra_channels_.size() + 1;
+  const size_t index = cares_next_channel_++ % count;
+  return index == 0 ? cares_channel_ : cares_extra_channels_[index - 1];
+}
+
+inline uint32_t* Environment::cares_query_count() {
+  return &cares_query_count_;
+}
+
 inline Environment::IsolateData* Environment::isolate_data() const {
   return isolate_data_;
 }
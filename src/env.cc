@@ -19,20 +19,13 @@ using v8::StackFrame;
 using v8::StackTrace;
 using v8::Value;
 
-void Environment::PrintSyncTrace() const {
-  if (!trace_sync_io_)
-    return;
-
-  HandleScope handle_scope(isolate());
-  Local<v8::StackTrace> stack =
-      StackTrace::CurrentStackTrace(isolate(), 10, StackTrace::kDetailed);
-
-  fprintf(stderr, "(node:%d) WARNING: Detected use of sync API\n", getpid());
-
-  for (int i = 0; i < stack->GetFrameCount() - 1; i++) {
+static void PrintStackFrames(v8::Isolate* isolate,
+                             Local<StackTrace> stack,
+                             int count) {
+  for (int i = 0; i < count; i++) {
     Local<StackFrame> stack_frame = stack->GetFrame(i);
-    node::Utf8Value fn_name_s(isolate(), stack_frame->GetFunctionName());
-    node::Utf8Value script_name(isolate(), stack_frame->GetScriptName());
+    node::Utf8Value fn_name_s(isolate, stack_frame->GetFunctionName());
+    node::Utf8Value script_name(isolate, stack_frame->GetScriptName());
     const int line_number = stack_frame->GetLineNumber();
     const int column = stack_frame->GetColumn();
 
@@ -63,4 +56,30 @@ void Environment::PrintSyncTrace() const {
   fflush(stderr);
 }
 
+
+void Environment::PrintSyncTrace() const {
+  if (!trace_sync_io_)
+    return;
+
+  HandleScope handle_scope(isolate());
+  Local<v8::StackTrace> stack =
+      StackTrace::CurrentStackTrace(isolate(), 10, StackTrace::kDetailed);
+
+  fprintf(stderr, "(node:%d) WARNING: Detected use of sync API\n", getpid());
+  PrintStackFrames(isolate(), stack, stack->GetFrameCount() - 1);
+}
+
+
+void Environment::PrintStallTrace(uint64_t blocked_ms) const {
+  HandleScope handle_scope(isolate());
+  Local<v8::StackTrace> stack =
+      StackTrace::CurrentStackTrace(isolate(), 10, StackTrace::kDetailed);
+
+  fprintf(stderr,
+          "(node:%d) WARNING: The event loop has been blocked for %llu ms\n",
+          getpid(),
+          static_cast<unsigned long long>(blocked_ms));
+  PrintStackFrames(isolate(), stack, stack->GetFrameCount());
+}
+
 }  // namespace node
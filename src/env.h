@@ -14,6 +14,7 @@
 #include "v8.h"
 
 #include <stdint.h>
+#include <vector>
 
 // Caveat emptor: we're going slightly crazy with macros here but the end
 // hopefully justifies the means. We have a lot of per-context properties
@@ -22,7 +23,8 @@
 //
 // Make sure that any macros defined here are undefined again at the bottom
 // of context-inl.h. The exceptions are NODE_CONTEXT_EMBEDDER_DATA_INDEX
-// and NODE_ISOLATE_SLOT, they may have been defined externally.
+// and NODE_ISOLATE_SLOT, they may have been defined externally, and
+// PER_ISOLATE_HTTP_HEADER_STRING_PROPERTIES, which the HTTP parser uses.
 namespace node {
 
 // Pick an index that's hopefully out of the way when we're embedded inside
@@ -60,20 +62,89 @@ namespace node {
   V(processed_private_symbol, "node:processed")                               \
   V(selected_npn_buffer_private_symbol, "node:selectedNpnBuffer")             \
 
+// Well-known HTTP header names in their canonical and their lowercase
+// spelling.  The HTTP parser hands these out instead of creating a new
+// string when a header field matches one of them exactly.
+#define PER_ISOLATE_HTTP_HEADER_STRING_PROPERTIES(V)                          \
+  V(http_accept_string, "Accept")                                             \
+  V(http_accept_lc_string, "accept")                                          \
+  V(http_accept_encoding_string, "Accept-Encoding")                           \
+  V(http_accept_encoding_lc_string, "accept-encoding")                        \
+  V(http_accept_language_string, "Accept-Language")                           \
+  V(http_accept_language_lc_string, "accept-language")                        \
+  V(http_authorization_string, "Authorization")                               \
+  V(http_authorization_lc_string, "authorization")                            \
+  V(http_cache_control_string, "Cache-Control")                               \
+  V(http_cache_control_lc_string, "cache-control")                            \
+  V(http_connection_string, "Connection")                                     \
+  V(http_connection_lc_string, "connection")                                  \
+  V(http_content_encoding_string, "Content-Encoding")                         \
+  V(http_content_encoding_lc_string, "content-encoding")                      \
+  V(http_content_length_string, "Content-Length")                             \
+  V(http_content_length_lc_string, "content-length")                          \
+  V(http_content_type_string, "Content-Type")                                 \
+  V(http_content_type_lc_string, "content-type")                              \
+  V(http_cookie_string, "Cookie")                                             \
+  V(http_cookie_lc_string, "cookie")                                          \
+  V(http_date_string, "Date")                                                 \
+  V(http_date_lc_string, "date")                                              \
+  V(http_etag_string, "ETag")                                                 \
+  V(http_etag_lc_string, "etag")                                              \
+  V(http_expect_string, "Expect")                                             \
+  V(http_expect_lc_string, "expect")                                          \
+  V(http_expires_string, "Expires")                                           \
+  V(http_expires_lc_string, "expires")                                        \
+  V(http_host_string, "Host")                                                 \
+  V(http_host_lc_string, "host")                                              \
+  V(http_if_modified_since_string, "If-Modified-Since")                       \
+  V(http_if_modified_since_lc_string, "if-modified-since")                    \
+  V(http_if_none_match_string, "If-None-Match")                               \
+  V(http_if_none_match_lc_string, "if-none-match")                            \
+  V(http_keep_alive_string, "Keep-Alive")                                     \
+  V(http_keep_alive_lc_string, "keep-alive")                                  \
+  V(http_last_modified_string, "Last-Modified")                               \
+  V(http_last_modified_lc_string, "last-modified")                            \
+  V(http_location_string, "Location")                                         \
+  V(http_location_lc_string, "location")                                      \
+  V(http_origin_string, "Origin")                                             \
+  V(http_origin_lc_string, "origin")                                          \
+  V(http_pragma_string, "Pragma")                                             \
+  V(http_pragma_lc_string, "pragma")                                          \
+  V(http_range_string, "Range")                                               \
+  V(http_range_lc_string, "range")                                            \
+  V(http_referer_string, "Referer")                                           \
+  V(http_referer_lc_string, "referer")                                        \
+  V(http_server_string, "Server")                                             \
+  V(http_server_lc_string, "server")                                          \
+  V(http_set_cookie_string, "Set-Cookie")                                     \
+  V(http_set_cookie_lc_string, "set-cookie")                                  \
+  V(http_transfer_encoding_string, "Transfer-Encoding")                       \
+  V(http_transfer_encoding_lc_string, "transfer-encoding")                    \
+  V(http_upgrade_string, "Upgrade")                                           \
+  V(http_upgrade_lc_string, "upgrade")                                        \
+  V(http_user_agent_string, "User-Agent")                                     \
+  V(http_user_agent_lc_string, "user-agent")                                  \
+  V(http_vary_string, "Vary")                                                 \
+  V(http_vary_lc_string, "vary")                                              \
+  V(http_via_string, "Via")                                                   \
+  V(http_via_lc_string, "via")                                                \
+  V(http_x_forwarded_for_string, "X-Forwarded-For")                           \
+  V(http_x_forwarded_for_lc_string, "x-forwarded-for")                        \
+  V(http_x_requested_with_string, "X-Requested-With")                         \
+  V(http_x_requested_with_lc_string, "x-requested-with")                      \
+
 // Strings are per-isolate primitives but Environment proxies them
 // for the sake of convenience.  Strings should be ASCII-only.
 #define PER_ISOLATE_STRING_PROPERTIES(V)                                      \
   V(address_string, "address")                                                \
   V(args_string, "args")                                                      \
   V(argv_string, "argv")                                                      \
-  V(async, "async")                                                           \
   V(async_queue_string, "_asyncQueue")                                        \
   V(atime_string, "atime")                                                    \
   V(birthtime_string, "birthtime")                                            \
   V(blksize_string, "blksize")                                                \
   V(blocks_string, "blocks")                                                  \
   V(buffer_string, "buffer")                                                  \
-  V(bytes_string, "bytes")                                                    \
   V(bytes_parsed_string, "bytesParsed")                                       \
   V(bytes_read_string, "bytesRead")                                           \
   V(cached_data_string, "cachedData")                                         \
@@ -127,6 +198,7 @@ namespace node {
   V(heap_total_string, "heapTotal")                                           \
   V(heap_used_string, "heapUsed")                                             \
   V(homedir_string, "homedir")                                                \
+  V(huge_page_buffers_string, "hugePageBuffers")                              \
   V(hostmaster_string, "hostmaster")                                          \
   V(ignore_string, "ignore")                                                  \
   V(immediate_callback_string, "_immediateCallback")                          \
@@ -161,15 +233,19 @@ namespace node {
   V(ocsp_request_string, "OCSPRequest")                                       \
   V(offset_string, "offset")                                                  \
   V(onchange_string, "onchange")                                              \
+  V(onchanges_string, "onchanges")                                            \
   V(onclienthello_string, "onclienthello")                                    \
   V(oncomplete_string, "oncomplete")                                          \
   V(onconnection_string, "onconnection")                                      \
+  V(onconnections_string, "onconnections")                                    \
   V(ondone_string, "ondone")                                                  \
   V(onerror_string, "onerror")                                                \
   V(onexit_string, "onexit")                                                  \
   V(onhandshakedone_string, "onhandshakedone")                                \
   V(onhandshakestart_string, "onhandshakestart")                              \
+  V(onidletimeout_string, "onidletimeout")                                    \
   V(onmessage_string, "onmessage")                                            \
+  V(onmessages_string, "onmessages")                                          \
   V(onnewsession_string, "onnewsession")                                      \
   V(onnewsessiondone_string, "onnewsessiondone")                              \
   V(onocspresponse_string, "onocspresponse")                                  \
@@ -179,6 +255,7 @@ namespace node {
   V(onselect_string, "onselect")                                              \
   V(onshutdown_string, "onshutdown")                                          \
   V(onsignal_string, "onsignal")                                              \
+  V(onsplice_string, "onsplice")                                              \
   V(onstop_string, "onstop")                                                  \
   V(onwrite_string, "onwrite")                                                \
   V(output_string, "output")                                                  \
@@ -207,6 +284,7 @@ namespace node {
   V(serial_string, "serial")                                                  \
   V(scavenge_string, "scavenge")                                              \
   V(scopeid_string, "scopeid")                                                \
+  V(segment_size_string, "segmentSize")                                       \
   V(sent_shutdown_string, "sentShutdown")                                     \
   V(serial_number_string, "serialNumber")                                     \
   V(service_string, "service")                                                \
@@ -255,6 +333,7 @@ namespace node {
   V(write_queue_size_string, "writeQueueSize")                                \
   V(x_forwarded_string, "x-forwarded-for")                                    \
   V(zero_return_string, "ZERO_RETURN")                                        \
+  PER_ISOLATE_HTTP_HEADER_STRING_PROPERTIES(V)                                \
 
 #define ENVIRONMENT_STRONG_PERSISTENT_PROPERTIES(V)                           \
   V(as_external, v8::External)                                                \
@@ -268,9 +347,16 @@ namespace node {
   V(context, v8::Context)                                                     \
   V(domain_array, v8::Array)                                                  \
   V(domains_stack_array, v8::Array)                                           \
+  V(env_vars_cache_object, v8::Object)                                        \
+  V(fs_detached_errors_function, v8::Function)                                \
   V(fs_stats_constructor_function, v8::Function)                              \
+  V(fs_use_promises_symbol, v8::Symbol)                                       \
+  V(gc_events_function, v8::Function)                                         \
   V(generic_internal_field_template, v8::ObjectTemplate)                      \
+  V(idle_callbacks_function, v8::Function)                                    \
   V(jsstream_constructor_template, v8::FunctionTemplate)                      \
+  V(key_object_constructor_template, v8::FunctionTemplate)                    \
+  V(memory_pressure_function, v8::Function)                                   \
   V(module_load_list_array, v8::Array)                                        \
   V(pipe_constructor_template, v8::FunctionTemplate)                          \
   V(process_object, v8::Object)                                               \
@@ -287,7 +373,24 @@ namespace node {
   V(udp_constructor_function, v8::Function)                                   \
   V(write_wrap_constructor_function, v8::Function)                            \
 
+class ArrayBufferAllocator;
+class AsyncAccounting;
 class Environment;
+class SlabAllocator;
+class DNSCache;
+class ScriptCache;
+class SignalWrap;
+class StatScheduler;
+class TCPWrap;
+class Worker;
+class NodeInstance;
+class IdleScheduler;
+class MemoryPressureMonitor;
+class LoopStats;
+class StallWatchdog;
+class GCStats;
+class TimerWheel;
+struct NativeAsyncHooks;
 
 // TODO(bnoordhuis) Rename struct, the ares_ prefix implies it's part
 // of the c-ares API while the _t suffix implies it's a typedef.
@@ -380,6 +483,52 @@ class Environment {
     DISALLOW_COPY_AND_ASSIGN(TickInfo);
   };
 
+  // The loop time in milliseconds, relative to timer_base().  It is
+  // refreshed whenever the loop calls into JS so that lib/timers.js can read
+  // it without a call into the binding.
+  class TimerInfo {
+   public:
+    inline double* fields();
+    inline int fields_count() const;
+
+   private:
+    friend class Environment;  // So we can call the constructor.
+    inline TimerInfo();
+
+    enum Fields {
+      kNow,
+      kFieldsCount
+    };
+
+    double fields_[kFieldsCount];
+
+    DISALLOW_COPY_AND_ASSIGN(TimerInfo);
+  };
+
+  // How the last write from JS through a StreamBase went, so that writes
+  // that complete synchronously don't have to set properties on the write
+  // request object.
+  class WriteInfo {
+   public:
+    inline double* fields();
+    inline int fields_count() const;
+    inline void set(size_t bytes, bool async);
+
+   private:
+    friend class Environment;  // So we can call the constructor.
+    inline WriteInfo();
+
+    enum Fields {
+      kBytesWritten,
+      kLastWriteWasAsync,
+      kFieldsCount
+    };
+
+    double fields_[kFieldsCount];
+
+    DISALLOW_COPY_AND_ASSIGN(WriteInfo);
+  };
+
   class ArrayBufferAllocatorInfo {
    public:
     inline uint32_t* fields();
@@ -454,6 +603,13 @@ class Environment {
   static inline Environment* from_idle_check_handle(uv_check_t* handle);
   inline uv_check_t* idle_check_handle();
 
+  static inline Environment* from_tick_batch_prepare_handle(
+      uv_prepare_t* handle);
+  inline uv_prepare_t* tick_batch_prepare_handle();
+
+  static inline Environment* from_tick_batch_check_handle(uv_check_t* handle);
+  inline uv_check_t* tick_batch_check_handle();
+
   // Register clean-up cb to be called on env->Dispose()
   inline void RegisterHandleCleanup(uv_handle_t* handle,
                                     HandleCleanupCb cb,
@@ -463,6 +619,9 @@ class Environment {
   inline AsyncHooks* async_hooks();
   inline DomainFlag* domain_flag();
   inline TickInfo* tick_info();
+  inline TimerInfo* timer_info();
+  inline void UpdateTimerInfo();
+  inline WriteInfo* write_info();
   inline ArrayBufferAllocatorInfo* array_buffer_allocator_info();
   inline uint64_t timer_base() const;
 
@@ -471,16 +630,38 @@ class Environment {
   inline ares_channel cares_channel();
   inline ares_channel* cares_channel_ptr();
   inline ares_task_list* cares_task_list();
+  // The channels that dns.setResolverOptions() adds next to cares_channel().
+  inline std::vector<ares_channel>* cares_extra_channels();
+  // Spreads the queries over cares_channel() and the extra channels.
+  inline ares_channel cares_next_channel();
+  // The queries that have not called back yet, the channels cannot be
+  // replaced while there are any.
+  inline uint32_t* cares_query_count();
 
   inline bool using_domains() const;
   inline void set_using_domains(bool value);
 
+  // True while neither domains nor the pre/post callbacks of async hooks nor
+  // native async hooks are in use.  MakeCallback() then only calls the
+  // callback and runs the nextTick queue.  Updated when any of them changes.
+  inline bool plain_callbacks() const;
+  inline void UpdatePlainCallbacks();
+
   inline bool printed_error() const;
   inline void set_printed_error(bool value);
 
   void PrintSyncTrace() const;
+  // Prints the JS stack for --detect-stalls, from an interrupt.
+  void PrintStallTrace(uint64_t blocked_ms) const;
   inline void set_trace_sync_io(bool value);
 
+  // With --batch-ticks, the I/O callbacks of a poll phase leave the nextTick
+  // queue and the microtasks to the tick batch check handle.
+  inline bool in_tick_batch() const;
+  inline void set_in_tick_batch(bool value);
+  inline bool tick_batch_pending() const;
+  inline void set_tick_batch_pending(bool value);
+
   inline int64_t get_async_wrap_uid();
 
   inline uint32_t* heap_statistics_buffer() const;
@@ -492,6 +673,152 @@ class Environment {
   inline char* http_parser_buffer() const;
   inline void set_http_parser_buffer(char* buffer);
 
+  // Preformatted value of the HTTP Date header, refreshed at most once per
+  // second by node_http_headers.cc.
+  struct HttpDate {
+    int64_t second = -1;
+    char value[sizeof("Thu, 01 Jan 1970 00:00:00 GMT")];
+  };
+  inline HttpDate* http_date();
+
+  // NodeBIO buffers of kBlockSize bytes are recycled between TLS
+  // connections instead of being freed, see node_crypto_bio.cc.
+  typedef FreeListPool<16 * 1024, 256> BIOBufferPool;
+  inline BIOBufferPool* bio_buffer_pool();
+
+  // The memory of finished WriteWraps and FSReqWraps is kept for the next
+  // request instead of being freed.  Requests that need more than
+  // kBlockSize bytes, like writes of long strings, bypass the pool.
+  typedef FreeListPool<1024, 128> ReqStoragePool;
+  inline ReqStoragePool* req_storage_pool();
+
+  // The hits, misses and retained bytes of one of the pools above, for the
+  // stats methods of the bindings.
+  template <size_t BlockSize, size_t MaxRetained>
+  inline v8::Local<v8::Object> FreeListPoolStats(
+      const FreeListPool<BlockSize, MaxRetained>* pool);
+
+  // Random bytes that small crypto.randomBytes() calls are copied from.
+  // node_crypto.cc refills it in the threadpool, kSize bytes at a time.
+  class RandomPool {
+   public:
+    static const size_t kSize = 32 * 1024;
+    static const size_t kMaxRequest = 256;
+
+    inline ~RandomPool();
+
+    // Copies |length| bytes to |out| and wipes them from the pool.
+    // Returns false when fewer are left.
+    inline bool Take(char* out, size_t length);
+    // Replaces what is left with the kSize bytes of |data|, which must come
+    // from new char[kSize].
+    inline void Fill(char* data);
+
+    inline size_t available() const;
+    inline bool refilling() const;
+    inline void set_refilling(bool refilling);
+
+   private:
+    char* data_ = nullptr;
+    size_t available_ = 0;
+    bool refilling_ = false;
+  };
+  inline RandomPool* random_pool();
+
+  // Shared by the streams that opted into slab allocated reads.
+  inline SlabAllocator* read_slab_allocator();
+
+  // Read buffer of the streams in shared read buffer mode.  Reads are copied
+  // out before the next one can start so one buffer per loop is sufficient.
+  static const size_t kSharedReadBufferSize = 64 * 1024;
+  inline char* shared_read_buffer();
+
+  // Keeps the idle timeouts of the stream handles, see timer_wrap.h.
+  inline TimerWheel* timer_wheel();
+
+  // Event loop metrics for process.binding('loop_stats').
+  inline LoopStats* loop_stats();
+
+  // Per-root CPU time and heap growth for process.binding('async_accounting').
+  inline AsyncAccounting* async_accounting();
+
+  // Reports a blocked event loop for --detect-stalls.
+  inline StallWatchdog* stall_watchdog();
+
+  // Work that waits for the loop to be idle, see node_idle_scheduler.h.
+  inline IdleScheduler* idle_scheduler();
+
+  // Watches the cgroup memory limit for --memory-pressure-threshold.
+  inline MemoryPressureMonitor* memory_pressure_monitor();
+
+  // GC pause statistics for process.binding('v8'), see node_gc_stats.h.
+  inline GCStats* gc_stats();
+
+  // Results of dns.lookup(), see node_dns_cache.h.
+  inline DNSCache* dns_cache();
+
+  // Scripts that vm.Script compiled, see node_script_cache.h.
+  inline ScriptCache* script_cache();
+
+  // process.env keeps what it read in env_vars_cache_object() until the
+  // process-wide generation of the environment moves past this one.
+  inline uint32_t env_vars_generation() const;
+  inline void set_env_vars_generation(uint32_t generation);
+
+  // Polls the files of fs.watchFile(), see node_stat_watcher.h.
+  inline StatScheduler* stat_scheduler();
+
+  // The Worker that runs this environment on its own thread, nullptr on the
+  // main thread.  See node_worker.h.
+  inline Worker* worker() const;
+  inline void set_worker(Worker* worker);
+
+  // The embedder's instance this environment runs, if any.  See
+  // CreateInstance() in node.h.
+  inline NodeInstance* node_instance() const;
+  inline void set_node_instance(NodeInstance* node_instance);
+
+  // The allocator of the isolate when node created it, nullptr for the
+  // isolates of embedders.  See Buffer::Adopt().
+  inline ArrayBufferAllocator* array_buffer_allocator() const;
+  inline void set_array_buffer_allocator(ArrayBufferAllocator* allocator);
+
+  inline const std::vector<const NativeAsyncHooks*>& native_async_hooks() const;
+  inline void AddNativeAsyncHooks(const NativeAsyncHooks* hooks);
+  inline void RemoveNativeAsyncHooks(const NativeAsyncHooks* hooks);
+
+  // The destroy hooks are called in batches, from an idle handle.  |native|
+  // selects the native hooks, otherwise the uid is passed to the JS hook.
+  static inline Environment* from_destroy_ids_idle_handle(uv_idle_t* handle);
+  inline uv_idle_t* destroy_ids_idle_handle();
+
+  // Delivers the connections that servers with an accept batch size have
+  // accepted in the poll phase, see tcp_wrap.cc.
+  static inline Environment* from_accept_batch_check_handle(
+      uv_check_t* handle);
+  inline uv_check_t* accept_batch_check_handle();
+  inline std::vector<TCPWrap*>* accept_batch_servers();
+
+  // Calls the signal handlers once per loop iteration, with the number of
+  // signals of that kind that arrived, see signal_wrap.cc.
+  static inline Environment* from_signal_batch_check_handle(
+      uv_check_t* handle);
+  inline uv_check_t* signal_batch_check_handle();
+  inline std::vector<SignalWrap*>* pending_signals();
+
+  // Errors of fs requests that were made without a callback.  node_file.cc
+  // hands them to JS from a check handle, once per loop iteration.
+  struct DetachedFSError {
+    int code;
+    const char* syscall;
+  };
+  static inline Environment* from_fs_errors_check_handle(uv_check_t* handle);
+  inline uv_check_t* fs_errors_check_handle();
+  inline std::vector<DetachedFSError>* detached_fs_errors();
+  inline void AddDestroyId(int64_t uid, bool native);
+  inline std::vector<int64_t>* destroy_ids_list();
+  inline std::vector<int64_t>* native_destroy_ids_list();
+
   inline void ThrowError(const char* errmsg);
   inline void ThrowTypeError(const char* errmsg);
   inline void ThrowRangeError(const char* errmsg);
@@ -579,17 +906,31 @@ class Environment {
   uv_idle_t immediate_idle_handle_;
   uv_prepare_t idle_prepare_handle_;
   uv_check_t idle_check_handle_;
+  uv_prepare_t tick_batch_prepare_handle_;
+  uv_check_t tick_batch_check_handle_;
+  uv_idle_t destroy_ids_idle_handle_;
+  uv_check_t accept_batch_check_handle_;
+  uv_check_t signal_batch_check_handle_;
+  uv_check_t fs_errors_check_handle_;
   AsyncHooks async_hooks_;
   DomainFlag domain_flag_;
   TickInfo tick_info_;
+  TimerInfo timer_info_;
+  WriteInfo write_info_;
   ArrayBufferAllocatorInfo array_buffer_allocator_info_;
   const uint64_t timer_base_;
   uv_timer_t cares_timer_handle_;
   ares_channel cares_channel_;
   ares_task_list cares_task_list_;
+  std::vector<ares_channel> cares_extra_channels_;
+  size_t cares_next_channel_;
+  uint32_t cares_query_count_;
   bool using_domains_;
+  bool plain_callbacks_;
   bool printed_error_;
   bool trace_sync_io_;
+  bool in_tick_batch_;
+  bool tick_batch_pending_;
   size_t makecallback_cntr_;
   int64_t async_wrap_uid_;
   debugger::Agent debugger_agent_;
@@ -607,6 +948,32 @@ class Environment {
   uint32_t* heap_space_statistics_buffer_ = nullptr;
 
   char* http_parser_buffer_;
+  HttpDate http_date_;
+  SlabAllocator* read_slab_allocator_;
+  char* shared_read_buffer_;
+  TimerWheel* timer_wheel_;
+  LoopStats* loop_stats_;
+  AsyncAccounting* async_accounting_;
+  StallWatchdog* stall_watchdog_;
+  IdleScheduler* idle_scheduler_;
+  MemoryPressureMonitor* memory_pressure_monitor_;
+  GCStats* gc_stats_;
+  DNSCache* dns_cache_;
+  ScriptCache* script_cache_;
+  uint32_t env_vars_generation_;
+  StatScheduler* stat_scheduler_;
+  Worker* worker_;
+  NodeInstance* node_instance_;
+  ArrayBufferAllocator* array_buffer_allocator_;
+  std::vector<const NativeAsyncHooks*> native_async_hooks_;
+  std::vector<int64_t> destroy_ids_list_;
+  std::vector<int64_t> native_destroy_ids_list_;
+  std::vector<TCPWrap*> accept_batch_servers_;
+  std::vector<SignalWrap*> pending_signals_;
+  std::vector<DetachedFSError> detached_fs_errors_;
+  BIOBufferPool bio_buffer_pool_;
+  ReqStoragePool req_storage_pool_;
+  RandomPool random_pool_;
 
 #define V(PropertyName, TypeName)                                             \
   v8::Persistent<TypeName> PropertyName ## _;
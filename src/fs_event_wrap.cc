@@ -9,9 +9,26 @@
 #include "string_bytes.h"
 
 #include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// libuv watches whole directory trees itself with FSEvents on OS X and with
+// ReadDirectoryChangesW on Windows.  Everywhere else FSEventWrap adds a
+// watcher for every directory below the watched one, they all share the
+// inotify instance of the loop on Linux.  The directories are read and
+// lstat'ed on the threadpool, only the watchers are added on the loop thread.
+#if !defined(__APPLE__) && !defined(_WIN32)
+# define NODE_FS_EVENT_WATCH_TREE 1
+#endif
 
 namespace node {
 
+using v8::Array;
 using v8::Context;
 using v8::FunctionCallbackInfo;
 using v8::FunctionTemplate;
@@ -34,15 +51,80 @@ class FSEventWrap: public HandleWrap {
   size_t self_size() const override { return sizeof(*this); }
 
  private:
+  // Watches a directory below the watched one, |prefix| is its path relative
+  // to the watched directory followed by a slash.
+  struct SubWatcher {
+    uv_fs_event_t handle;
+    FSEventWrap* wrap;
+    std::string prefix;
+  };
+
+  // A pass over some directories of the tree on the threadpool, with paths
+  // relative to the watched directory and followed by a slash.  A scan reads
+  // |dirs|, which are watched already, and finds the directories below them.
+  // Otherwise |dirs| are lstat'ed, the ones that turn out to be directories
+  // are watched and then scanned in turn.  So every directory is watched
+  // before it's read and nothing that is created in between goes unnoticed.
+  struct TreeWalk {
+    uv_work_t work_req;
+    FSEventWrap* wrap;  // nullptr once the watcher is closed.
+    uv_loop_t* loop;
+    std::string root;
+    bool scan;
+    bool report;
+    std::vector<std::string> dirs;
+    // Results, filled in on the threadpool.
+    int err;
+    std::vector<std::string> found;
+    std::vector<std::string> gone;
+    std::vector<std::string> entries;
+  };
+
   FSEventWrap(Environment* env, Local<Object> object);
   virtual ~FSEventWrap() override;
 
   static void OnEvent(uv_fs_event_t* handle, const char* filename, int events,
     int status);
+  static void OnSubEvent(uv_fs_event_t* handle, const char* filename,
+                         int events, int status);
+  static void OnSubClose(uv_handle_t* handle);
+  static void OnTimer(uv_timer_t* handle);
+  static void OnTimerClose(uv_handle_t* handle);
+  static void OnWalkWork(uv_work_t* req);
+  static void OnWalkDone(uv_work_t* req, int status);
+
+  void QueueWalk(std::vector<std::string>* dirs, bool scan, bool report);
+  void ApplyWalk(TreeWalk* walk);
+  int WatchDirectory(const std::string& prefix);
+  void UnwatchTree(const std::string& prefix);
+  void UpdateTree(const std::string& filename);
+  void StopWatchers();
+
+  void Report(int status, int events, const char* filename);
+  void Emit(int status, int events, const char* filename);
+  void Flush();
 
   uv_fs_event_t handle_;
   bool initialized_;
+  bool persistent_;
   enum encoding encoding_;
+
+  // Set when the directories below the watched one are watched here.
+  bool watch_tree_;
+  std::string root_;
+  std::unordered_map<std::string, SubWatcher*> sub_watchers_;
+  std::vector<TreeWalk*> walks_;
+  // The entries that were renamed since the last lstat pass was queued, at
+  // most one pass is in flight.
+  std::vector<std::string> updates_;
+  bool updating_;
+
+  // With a coalescing window, the events that arrive within it are merged
+  // per filename and reported together when it ends.
+  uint64_t coalesce_;
+  uv_timer_t* timer_;
+  std::vector<std::pair<std::string, int>> pending_;
+  std::unordered_map<std::string, size_t> pending_index_;
 };
 
 
@@ -50,13 +132,22 @@ FSEventWrap::FSEventWrap(Environment* env, Local<Object> object)
     : HandleWrap(env,
                  object,
                  reinterpret_cast<uv_handle_t*>(&handle_),
-                 AsyncWrap::PROVIDER_FSEVENTWRAP) {
-  initialized_ = false;
+                 AsyncWrap::PROVIDER_FSEVENTWRAP),
+      initialized_(false),
+      persistent_(true),
+      encoding_(UTF8),
+      watch_tree_(false),
+      updating_(false),
+      coalesce_(0),
+      timer_(nullptr) {
 }
 
 
 FSEventWrap::~FSEventWrap() {
   CHECK_EQ(initialized_, false);
+  CHECK(sub_watchers_.empty());
+  CHECK(walks_.empty());
+  CHECK_EQ(timer_, nullptr);
 }
 
 
@@ -76,6 +167,23 @@ void FSEventWrap::Initialize(Local<Object> target,
 }
 
 
+// Symbolic links to directories aren't followed.
+static bool IsDirectory(uv_loop_t* loop, const std::string& path) {
+  uv_fs_t req;
+  int err = uv_fs_lstat(loop, &req, path.c_str(), nullptr);
+  const bool is_dir = err == 0 && (req.statbuf.st_mode & S_IFMT) == S_IFDIR;
+  uv_fs_req_cleanup(&req);
+  return is_dir;
+}
+
+
+// Errors that mean a directory went away or can't be watched, which isn't
+// worth an 'error' event.
+static bool IsSkippable(int err) {
+  return err == UV_ENOENT || err == UV_ENOTDIR || err == UV_EACCES;
+}
+
+
 void FSEventWrap::New(const FunctionCallbackInfo<Value>& args) {
   CHECK(args.IsConstructCall());
   Environment* env = Environment::GetCurrent(args);
@@ -100,7 +208,10 @@ void FSEventWrap::Start(const FunctionCallbackInfo<Value>& args) {
   if (args[2]->IsTrue())
     flags |= UV_FS_EVENT_RECURSIVE;
 
+  wrap->persistent_ = args[1]->IsTrue();
   wrap->encoding_ = ParseEncoding(env->isolate(), args[3], UTF8);
+  wrap->coalesce_ = args[4]->IsUint32() ? args[4]->Uint32Value() : 0;
+  wrap->root_ = *path;
 
   int err = uv_fs_event_init(wrap->env()->event_loop(), &wrap->handle_);
   if (err == 0) {
@@ -108,9 +219,27 @@ void FSEventWrap::Start(const FunctionCallbackInfo<Value>& args) {
 
     err = uv_fs_event_start(&wrap->handle_, OnEvent, *path, flags);
 
+#ifdef NODE_FS_EVENT_WATCH_TREE
+    if (err == 0 && (flags & UV_FS_EVENT_RECURSIVE) &&
+        IsDirectory(env->event_loop(), *path)) {
+      wrap->watch_tree_ = true;
+      std::vector<std::string> dirs(1, "");
+      wrap->QueueWalk(&dirs, true, false);
+    }
+#endif
+
+    if (err == 0 && wrap->coalesce_ > 0) {
+      wrap->timer_ = new uv_timer_t;
+      uv_timer_init(env->event_loop(), wrap->timer_);
+      wrap->timer_->data = wrap;
+      // The watcher keeps the loop alive if it's persistent, events that are
+      // pending when nothing else does are dropped.
+      uv_unref(reinterpret_cast<uv_handle_t*>(wrap->timer_));
+    }
+
     if (err == 0) {
       // Check for persistent argument
-      if (!args[1]->IsTrue()) {
+      if (!wrap->persistent_) {
         uv_unref(reinterpret_cast<uv_handle_t*>(&wrap->handle_));
       }
     } else {
@@ -122,15 +251,333 @@ void FSEventWrap::Start(const FunctionCallbackInfo<Value>& args) {
 }
 
 
+void FSEventWrap::QueueWalk(std::vector<std::string>* dirs,
+                            bool scan,
+                            bool report) {
+  TreeWalk* walk = new TreeWalk;
+  walk->wrap = this;
+  walk->loop = env()->event_loop();
+  walk->root = root_;
+  walk->scan = scan;
+  walk->report = report;
+  walk->dirs.swap(*dirs);
+  walk->err = 0;
+  walks_.push_back(walk);
+  uv_queue_work(env()->event_loop(), &walk->work_req, OnWalkWork, OnWalkDone);
+}
+
+
+// Runs on the threadpool, must not touch the FSEventWrap.  Directories that
+// vanish or can't be read are skipped.
+void FSEventWrap::OnWalkWork(uv_work_t* req) {
+  TreeWalk* walk = ContainerOf(&TreeWalk::work_req, req);
+
+  if (!walk->scan) {
+    for (const std::string& dir : walk->dirs) {
+      // Without the trailing slash, or lstat() follows a symbolic link.
+      const std::string path =
+          walk->root + "/" + dir.substr(0, dir.size() - 1);
+      if (IsDirectory(walk->loop, path))
+        walk->found.push_back(dir);
+      else
+        walk->gone.push_back(dir);
+    }
+    return;
+  }
+
+  for (const std::string& dir : walk->dirs) {
+    uv_fs_t fs_req;
+    int err = uv_fs_scandir(walk->loop, &fs_req,
+                            (walk->root + "/" + dir).c_str(), 0, nullptr);
+    if (err < 0) {
+      uv_fs_req_cleanup(&fs_req);
+      if (IsSkippable(err))
+        continue;
+      walk->err = err;
+      return;
+    }
+
+    uv_dirent_t ent;
+    while (uv_fs_scandir_next(&fs_req, &ent) != UV_EOF) {
+      if (walk->report)
+        walk->entries.push_back(dir + ent.name);
+      if (ent.type == UV_DIRENT_UNKNOWN &&
+          IsDirectory(walk->loop, walk->root + "/" + dir + ent.name)) {
+        ent.type = UV_DIRENT_DIR;
+      }
+      if (ent.type == UV_DIRENT_DIR)
+        walk->found.push_back(dir + ent.name + "/");
+    }
+    uv_fs_req_cleanup(&fs_req);
+  }
+}
+
+
+void FSEventWrap::OnWalkDone(uv_work_t* req, int status) {
+  TreeWalk* walk = ContainerOf(&TreeWalk::work_req, req);
+  FSEventWrap* wrap = walk->wrap;
+
+  if (wrap != nullptr) {
+    for (auto it = wrap->walks_.begin(); it != wrap->walks_.end(); ++it) {
+      if (*it == walk) {
+        wrap->walks_.erase(it);
+        break;
+      }
+    }
+    if (!walk->scan)
+      wrap->updating_ = false;
+    wrap->ApplyWalk(walk);
+  }
+
+  delete walk;
+}
+
+
+// Watches the directories that |walk| found and queues the scan of them.
+// The entries of directories that were created while the tree is watched are
+// reported as renamed.
+void FSEventWrap::ApplyWalk(TreeWalk* walk) {
+  for (const std::string& dir : walk->gone)
+    UnwatchTree(dir);
+
+  int err = walk->err;
+  std::vector<std::string> next;
+  for (const std::string& dir : walk->found) {
+    if (sub_watchers_.find(dir) != sub_watchers_.end())
+      continue;
+    int r = WatchDirectory(dir);
+    if (r == 0) {
+      next.push_back(dir);
+    } else if (!IsSkippable(r)) {
+      err = r;
+      break;
+    }
+  }
+
+  // JS land may close the watcher in between.
+  for (size_t i = 0; i < walk->entries.size() && initialized_; i++)
+    Report(0, UV_RENAME, walk->entries[i].c_str());
+  if (err != 0 && initialized_)
+    Report(err, 0, nullptr);
+  if (!initialized_)
+    return;
+
+  if (!next.empty())
+    QueueWalk(&next, true, walk->report);
+  if (!updating_ && !updates_.empty()) {
+    updating_ = true;
+    QueueWalk(&updates_, false, true);
+    updates_.clear();
+  }
+}
+
+
+int FSEventWrap::WatchDirectory(const std::string& prefix) {
+  if (sub_watchers_.find(prefix) != sub_watchers_.end())
+    return 0;
+
+  SubWatcher* sub = new SubWatcher;
+  sub->wrap = this;
+  sub->prefix = prefix;
+  uv_fs_event_init(env()->event_loop(), &sub->handle);
+  sub->handle.data = sub;
+
+  // Without the trailing slash, see OnSubEvent().
+  const std::string path = root_ + "/" + prefix.substr(0, prefix.size() - 1);
+  int err = uv_fs_event_start(&sub->handle, OnSubEvent, path.c_str(), 0);
+  if (err != 0) {
+    uv_close(reinterpret_cast<uv_handle_t*>(&sub->handle), OnSubClose);
+    return err;
+  }
+
+  if (!persistent_)
+    uv_unref(reinterpret_cast<uv_handle_t*>(&sub->handle));
+  sub_watchers_[prefix] = sub;
+  return 0;
+}
+
+
+// Stops watching the directory at |prefix| and the ones below it.
+void FSEventWrap::UnwatchTree(const std::string& prefix) {
+  auto it = sub_watchers_.begin();
+  while (it != sub_watchers_.end()) {
+    if (it->first.compare(0, prefix.size(), prefix) == 0) {
+      uv_close(reinterpret_cast<uv_handle_t*>(&it->second->handle),
+               OnSubClose);
+      it = sub_watchers_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+
+// Called for every 'rename' of an entry in the tree, |filename| is relative
+// to the watched directory.  The entry was either created, deleted or moved,
+// the next lstat pass finds out which.  What was put into a new directory
+// before it was watched is reported as renamed.
+void FSEventWrap::UpdateTree(const std::string& filename) {
+  updates_.push_back(filename + "/");
+  if (updating_)
+    return;
+  updating_ = true;
+  QueueWalk(&updates_, false, true);
+  updates_.clear();
+}
+
+
+void FSEventWrap::StopWatchers() {
+  UnwatchTree("");
+  // The walks in flight are freed when they're done.
+  for (TreeWalk* walk : walks_)
+    walk->wrap = nullptr;
+  walks_.clear();
+  updates_.clear();
+  updating_ = false;
+  if (timer_ != nullptr) {
+    uv_close(reinterpret_cast<uv_handle_t*>(timer_), OnTimerClose);
+    timer_ = nullptr;
+  }
+  pending_.clear();
+  pending_index_.clear();
+}
+
+
 void FSEventWrap::OnEvent(uv_fs_event_t* handle, const char* filename,
     int events, int status) {
   FSEventWrap* wrap = static_cast<FSEventWrap*>(handle->data);
-  Environment* env = wrap->env();
+
+  wrap->Report(status, events, filename);
+
+  // JS land may have closed the watcher.
+  if (wrap->initialized_ && wrap->watch_tree_ && status == 0 &&
+      filename != nullptr && (events & UV_RENAME)) {
+    wrap->UpdateTree(filename);
+  }
+}
+
+
+void FSEventWrap::OnSubEvent(uv_fs_event_t* handle, const char* filename,
+                             int events, int status) {
+  SubWatcher* sub = static_cast<SubWatcher*>(handle->data);
+  FSEventWrap* wrap = sub->wrap;
+
+  // libuv names the directory itself after the basename of handle->path when
+  // an event is about it rather than about an entry in it.  The watcher of
+  // its parent reports those already.
+  if (filename != nullptr &&
+      filename >= handle->path &&
+      filename < handle->path + strlen(handle->path)) {
+    return;
+  }
+
+  std::string path = sub->prefix;
+  if (filename == nullptr)
+    path.resize(path.size() - 1);
+  else
+    path += filename;
+
+  wrap->Report(status, events, path.c_str());
+
+  if (wrap->initialized_ && status == 0 && filename != nullptr &&
+      (events & UV_RENAME)) {
+    wrap->UpdateTree(path);
+  }
+}
+
+
+void FSEventWrap::OnSubClose(uv_handle_t* handle) {
+  delete static_cast<SubWatcher*>(handle->data);
+}
+
+
+void FSEventWrap::OnTimer(uv_timer_t* handle) {
+  static_cast<FSEventWrap*>(handle->data)->Flush();
+}
+
+
+void FSEventWrap::OnTimerClose(uv_handle_t* handle) {
+  delete reinterpret_cast<uv_timer_t*>(handle);
+}
+
+
+void FSEventWrap::Report(int status, int events, const char* filename) {
+  if (timer_ == nullptr) {
+    Emit(status, events, filename);
+    return;
+  }
+
+  if (status != 0) {
+    // Errors aren't coalesced, the events before them are reported first.
+    Flush();
+    if (initialized_)
+      Emit(status, events, filename);
+    return;
+  }
+
+  const std::string key = filename != nullptr ? filename : "";
+  auto it = pending_index_.find(key);
+  if (it != pending_index_.end()) {
+    pending_[it->second].second |= events;
+    return;
+  }
+  pending_index_[key] = pending_.size();
+  pending_.push_back(std::make_pair(key, events));
+
+  if (!uv_is_active(reinterpret_cast<uv_handle_t*>(timer_)))
+    uv_timer_start(timer_, OnTimer, coalesce_, 0);
+}
+
+
+// Hands the pending events over to JS land in one go, as an array of event
+// types and an array of filenames.
+void FSEventWrap::Flush() {
+  if (pending_.empty())
+    return;
+
+  Environment* env = this->env();
+  HandleScope handle_scope(env->isolate());
+  Context::Scope context_scope(env->context());
+
+  CHECK_EQ(persistent().IsEmpty(), false);
+  uv_timer_stop(timer_);
+
+  const size_t count = pending_.size();
+  Local<Array> event_types = Array::New(env->isolate(), count);
+  Local<Array> filenames = Array::New(env->isolate(), count);
+  for (size_t i = 0; i < count; i++) {
+    const std::string& filename = pending_[i].first;
+    const int events = pending_[i].second;
+    // As in Emit(), a rename implies a change.
+    event_types->Set(i, events & UV_RENAME ? env->rename_string()
+                                           : env->change_string());
+    Local<Value> fn = StringBytes::Encode(env->isolate(),
+                                          filename.data(),
+                                          filename.size(),
+                                          encoding_);
+    if (fn.IsEmpty()) {
+      fn = StringBytes::Encode(env->isolate(),
+                               filename.data(),
+                               filename.size(),
+                               BUFFER);
+    }
+    filenames->Set(i, fn);
+  }
+  pending_.clear();
+  pending_index_.clear();
+
+  Local<Value> argv[] = { event_types, filenames };
+  MakeCallback(env->onchanges_string(), arraysize(argv), argv);
+}
+
+
+void FSEventWrap::Emit(int status, int events, const char* filename) {
+  Environment* env = this->env();
 
   HandleScope handle_scope(env->isolate());
   Context::Scope context_scope(env->context());
 
-  CHECK_EQ(wrap->persistent().IsEmpty(), false);
+  CHECK_EQ(persistent().IsEmpty(), false);
 
   // We're in a bind here. libuv can set both UV_RENAME and UV_CHANGE but
   // the Node API only lets us pass a single event to JS land.
@@ -164,7 +611,7 @@ void FSEventWrap::OnEvent(uv_fs_event_t* handle, const char* filename,
   if (filename != nullptr) {
     Local<Value> fn = StringBytes::Encode(env->isolate(),
                                           filename,
-                                          wrap->encoding_);
+                                          encoding_);
     if (fn.IsEmpty()) {
       argv[0] = Integer::New(env->isolate(), UV_EINVAL);
       argv[2] = StringBytes::Encode(env->isolate(),
@@ -176,7 +623,7 @@ void FSEventWrap::OnEvent(uv_fs_event_t* handle, const char* filename,
     }
   }
 
-  wrap->MakeCallback(env->onchange_string(), arraysize(argv), argv);
+  MakeCallback(env->onchange_string(), arraysize(argv), argv);
 }
 
 
@@ -186,6 +633,7 @@ void FSEventWrap::Close(const FunctionCallbackInfo<Value>& args) {
   if (wrap == nullptr || wrap->initialized_ == false)
     return;
   wrap->initialized_ = false;
+  wrap->StopWatchers();
 
   HandleWrap::Close(args);
 }
@@ -40,24 +40,27 @@ void HandleWrap::Unrefed(const FunctionCallbackInfo<Value>& args) {
 
 
 void HandleWrap::Close(const FunctionCallbackInfo<Value>& args) {
-  Environment* env = Environment::GetCurrent(args);
-
   HandleWrap* wrap = Unwrap<HandleWrap>(args.Holder());
 
   // Guard against uninitialized handle or double close.
   if (!IsAlive(wrap))
     return;
 
-  if (wrap->state_ != kInitialized)
+  wrap->Close(args[0]);
+}
+
+
+void HandleWrap::Close(Local<Value> close_callback) {
+  if (state_ != kInitialized)
     return;
 
-  CHECK_EQ(false, wrap->persistent().IsEmpty());
-  uv_close(wrap->handle__, OnClose);
-  wrap->state_ = kClosing;
+  CHECK_EQ(false, persistent().IsEmpty());
+  uv_close(handle__, OnClose);
+  state_ = kClosing;
 
-  if (args[0]->IsFunction()) {
-    wrap->object()->Set(env->onclose_string(), args[0]);
-    wrap->state_ = kClosingWithCallback;
+  if (!close_callback.IsEmpty() && close_callback->IsFunction()) {
+    object()->Set(env()->onclose_string(), close_callback);
+    state_ = kClosingWithCallback;
   }
 }
 
@@ -9,6 +9,7 @@
 namespace node {
 
 class Environment;
+class StreamBase;
 
 // Rules:
 //
@@ -47,6 +48,13 @@ class HandleWrap : public AsyncWrap {
 
   inline uv_handle_t* GetHandle() const { return handle__; }
 
+  // Closes the handle unless it is closing already.  |close_callback| is
+  // called from the handle's onclose property when it is a function.
+  void Close(v8::Local<v8::Value> close_callback = v8::Local<v8::Value>());
+
+  // Returns the StreamBase of stream handles, nullptr for other handles.
+  virtual StreamBase* GetStream() { return nullptr; }
+
  protected:
   HandleWrap(Environment* env,
              v8::Local<v8::Object> object,
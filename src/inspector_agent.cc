@@ -9,6 +9,7 @@
 
 #include "platform/v8_inspector/public/V8Inspector.h"
 #include "platform/inspector_protocol/FrontendChannel.h"
+#include "platform/inspector_protocol/Parser.h"
 #include "platform/inspector_protocol/String16.h"
 #include "platform/inspector_protocol/Values.h"
 
@@ -23,6 +24,7 @@
 #include "util.h"
 
 #include <string.h>
+#include <string>
 
 // We need pid to use as ID with Chrome
 #if defined(_MSC_VER)
@@ -39,6 +41,7 @@ namespace inspector {
 
 using blink::protocol::DictionaryValue;
 using blink::protocol::String16;
+using blink::protocol::Value;
 
 static const char DEVTOOLS_PATH[] = "/node";
 
@@ -73,26 +76,16 @@ class ChannelImpl final : public blink::protocol::FrontendChannel {
   virtual void flush() override { }
 
   void sendMessageToFrontend(PassOwnPtr<DictionaryValue> message) {
-    agent_->write(message->toJSONString());
+    // Serializing big results like profiles is left to the inspector thread.
+    agent_->write(message.leakPtr());
   }
 
   Agent* const agent_;
 };
 
-class AsyncWriteRequest {
- public:
-  AsyncWriteRequest(Agent* agent, const String16& message) :
-                    agent_(agent), message_(message) {}
-  void perform() {
-    inspector_socket_t* socket = agent_->client_socket_;
-    if (socket) {
-      inspector_write(socket, message_.utf8().c_str(), message_.length());
-    }
-  }
- private:
-  Agent* const agent_;
-  const String16 message_;
-};
+ProtocolMessage::~ProtocolMessage() {
+  delete message_;
+}
 
 class SetConnectedTask : public v8::Task {
  public:
@@ -109,10 +102,6 @@ class SetConnectedTask : public v8::Task {
   bool connected_;
 };
 
-static void DisposeAsyncCb(uv_handle_t* handle) {
-  free(handle);
-}
-
 static void DisposeInspector(inspector_socket_t* socket, int status) {
   free(socket);
 }
@@ -198,9 +187,13 @@ Agent::Agent(Environment* env) : port_(5858),
 
 Agent::~Agent() {
   uv_mutex_destroy(&queue_lock_);
+  uv_mutex_destroy(&outgoing_lock_);
   uv_close(reinterpret_cast<uv_handle_t*>(&dataWritten_), nullptr);
 
-  while(MessageFromFrontend* message = message_queue_.PopFront()) {
+  while (ProtocolMessage* message = message_queue_.PopFront()) {
+    delete message;
+  }
+  while (ProtocolMessage* message = outgoing_queue_.PopFront()) {
     delete message;
   }
 }
@@ -226,7 +219,18 @@ bool Agent::Start(v8::Platform* platform, int port, bool wait) {
   if (err != 0)
     goto mutex_init_failed;
 
+  err = uv_mutex_init(&outgoing_lock_);
+  if (err != 0)
+    goto outgoing_mutex_init_failed;
+
+  // Initialized before the thread runs child_loop_.
+  err = uv_async_init(&child_loop_, &outgoing_async_, WriteCb);
+  if (err != 0)
+    goto outgoing_async_init_failed;
+  outgoing_async_.data = this;
+
   uv_unref(reinterpret_cast<uv_handle_t*>(&dataWritten_));
+  uv_unref(reinterpret_cast<uv_handle_t*>(&outgoing_async_));
 
   port_ = port;
   wait_ = wait;
@@ -241,6 +245,10 @@ bool Agent::Start(v8::Platform* platform, int port, bool wait) {
   return true;
 
  thread_create_failed:
+  uv_close(reinterpret_cast<uv_handle_t*>(&outgoing_async_), nullptr);
+ outgoing_async_init_failed:
+  uv_mutex_destroy(&outgoing_lock_);
+ outgoing_mutex_init_failed:
   uv_mutex_destroy(&queue_lock_);
  mutex_init_failed:
   uv_close(reinterpret_cast<uv_handle_t*>(&dataWritten_), nullptr);
@@ -265,9 +273,8 @@ void Agent::Stop() {
 
 void Agent::PostMessages() {
   if (!uv_mutex_trylock(&queue_lock_)) {
-    while(MessageFromFrontend* message = message_queue_.PopFront()) {
-      inspector_->dispatchMessageFromFrontend(
-          String16(message->message(), message->length()));
+    while (ProtocolMessage* message = message_queue_.PopFront()) {
+      inspector_->dispatchMessageFromFrontend(adoptPtr(message->release()));
       delete message;
     }
     uv_async_send(&dataWritten_);
@@ -284,8 +291,20 @@ void Agent::OnRemoteData(uv_stream_t* stream, ssize_t read, const uv_buf_t* b) {
       reinterpret_cast<inspector_socket_t*>(stream->data);
   Agent* agent = reinterpret_cast<Agent*>(socket->data);
   if (read > 0) {
+    // Parsed here so that the main thread only has to dispatch the message.
+    OwnPtr<Value> parsed = blink::protocol::parseJSON(String16(b->base,
+                                                               read - 1));
+    free(b->base);
+    OwnPtr<DictionaryValue> object = DictionaryValue::cast(parsed.release());
+    double id;
+    String16 method;
+    if (!object || !object->getNumber("id", &id) ||
+        !object->getString("method", &method)) {
+      fprintf(stderr, "Ignoring malformed inspector protocol message\n");
+      return;
+    }
     uv_mutex_lock(&agent->queue_lock_);
-    agent->message_queue_.PushBack(new MessageFromFrontend(b->base, read - 1));
+    agent->message_queue_.PushBack(new ProtocolMessage(object.leakPtr()));
     agent->platform_->CallOnForegroundThread(agent->parent_env()->isolate(),
         new DispatchOnInspectorBackendTask(agent));
     agent->parent_env()->isolate()
@@ -305,18 +324,31 @@ void Agent::OnRemoteData(uv_stream_t* stream, ssize_t read, const uv_buf_t* b) {
 }
 
 void Agent::WriteCb(uv_async_t* async) {
-  auto req = reinterpret_cast<AsyncWriteRequest*>(async->data);
-  req->perform();
-  delete req;
-  uv_close(reinterpret_cast<uv_handle_t*>(async), DisposeAsyncCb);
+  Agent* agent = reinterpret_cast<Agent*>(async->data);
+  ListHead<ProtocolMessage, &ProtocolMessage::listNode> messages;
+  uv_mutex_lock(&agent->outgoing_lock_);
+  agent->outgoing_queue_.MoveBack(&messages);
+  uv_mutex_unlock(&agent->outgoing_lock_);
+
+  while (ProtocolMessage* message = messages.PopFront()) {
+    OwnPtr<DictionaryValue> object = adoptPtr(message->release());
+    delete message;
+    inspector_socket_t* socket = agent->client_socket_;
+    if (socket == nullptr)
+      continue;
+    std::string json = object->toJSONString().utf8();
+    inspector_write(socket, json.data(), json.length());
+  }
 }
 
-void Agent::write(const String16& message) {
-  uv_async_t* async = reinterpret_cast<uv_async_t*>(malloc(sizeof(uv_async_t)));
-  ASSERT_NE(async, nullptr);
-  uv_async_init(&child_loop_, async, WriteCb);
-  async->data = new AsyncWriteRequest(this, message);
-  ASSERT_EQ(0, uv_async_send(async));
+void Agent::write(DictionaryValue* message) {
+  uv_mutex_lock(&outgoing_lock_);
+  const bool was_empty = outgoing_queue_.IsEmpty();
+  outgoing_queue_.PushBack(new ProtocolMessage(message));
+  uv_mutex_unlock(&outgoing_lock_);
+  // One wakeup per batch, the inspector thread takes the whole queue.
+  if (was_empty)
+    CHECK_EQ(0, uv_async_send(&outgoing_async_));
 }
 
 void Agent::OnInspectorConnection(inspector_socket_t* socket) {
@@ -413,6 +445,7 @@ void Agent::WorkerRun() {
   }
   uv_run(&child_loop_, UV_RUN_DEFAULT);
   uv_close(reinterpret_cast<uv_handle_t*>(&server), nullptr);
+  uv_close(reinterpret_cast<uv_handle_t*>(&outgoing_async_), nullptr);
   uv_run(&child_loop_, UV_RUN_NOWAIT);
 }
 
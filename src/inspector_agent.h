@@ -13,6 +13,7 @@
 namespace blink {
 class V8Inspector;
 namespace protocol {
+  class DictionaryValue;
   class String16;
 }
 }
@@ -27,22 +28,24 @@ namespace inspector {
 
 class ChannelImpl;
 
-class MessageFromFrontend {
-public:
-  MessageFromFrontend(char* message, size_t length) : message_(message),
-                                                          length_(length) {
+// A parsed protocol message on its way between the inspector thread and the
+// main thread.  JSON is only parsed and generated on the inspector thread.
+class ProtocolMessage {
+ public:
+  explicit ProtocolMessage(blink::protocol::DictionaryValue* message)
+      : message_(message) {
   }
-  ~MessageFromFrontend() {
-    free(message_);
+  ~ProtocolMessage();
+  // Transfers the ownership of the message to the caller.
+  blink::protocol::DictionaryValue* release() {
+    blink::protocol::DictionaryValue* message = message_;
     message_ = nullptr;
+    return message;
   }
-  const char* message() { return message_; }
-  size_t length() { return length_; }
 
-  ListNode<MessageFromFrontend> listNode;
-private:
-  char* message_;
-  const size_t length_;
+  ListNode<ProtocolMessage> listNode;
+ private:
+  blink::protocol::DictionaryValue* message_;
 };
 
 class Agent {
@@ -71,7 +74,10 @@ class Agent {
 
   uv_sem_t start_sem_;
   uv_mutex_t queue_lock_;
-  ListHead<MessageFromFrontend, &MessageFromFrontend::listNode> message_queue_;
+  ListHead<ProtocolMessage, &ProtocolMessage::listNode> message_queue_;
+  // Responses and notifications for the inspector thread to serialize.
+  uv_mutex_t outgoing_lock_;
+  ListHead<ProtocolMessage, &ProtocolMessage::listNode> outgoing_queue_;
 
   int port_;
   bool wait_;
@@ -83,6 +89,8 @@ class Agent {
 
   uv_tcp_t server_;
   uv_async_t dataWritten_;
+  // On child_loop_, signaled when outgoing_queue_ has messages.
+  uv_async_t outgoing_async_;
   // Currently it is simply the last inspector connection. Later we may consider
   // some sort of policy - e.g. closing a previous connection or supporting
   // multiple connections.
@@ -101,9 +109,10 @@ class Agent {
   bool RespondToGet(inspector_socket_t* socket, const char* path);
   bool AcceptsConnection(inspector_socket_t* socket, const char* path);
   void OnInspectorConnection(inspector_socket_t* socket);
-  void write(const blink::protocol::String16& message);
+  // Queues the message for the inspector thread, which serializes it and
+  // writes it to the client.
+  void write(blink::protocol::DictionaryValue* message);
 
-  friend class AsyncWriteRequest;
   friend class ChannelImpl;
   friend class SetConnectedTask;
 };
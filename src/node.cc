@@ -2,11 +2,15 @@
 #include "node_buffer.h"
 #include "node_constants.h"
 #include "node_file.h"
+#include "node_heap_sizer.h"
 #include "node_http_parser.h"
 #include "node_javascript.h"
 #include "node_version.h"
 #include "node_internals.h"
+#include "node_platform.h"
 #include "node_revert.h"
+#include "node_trace.h"
+#include "node_worker.h"
 
 #if defined HAVE_PERFCTR
 #include "node_counters.h"
@@ -31,11 +35,13 @@
 #include "ares.h"
 #include "async-wrap.h"
 #include "async-wrap-inl.h"
+#include "buffer_arena.h"
 #include "env.h"
 #include "env-inl.h"
 #include "handle_wrap.h"
 #include "req-wrap.h"
 #include "req-wrap-inl.h"
+#include "stream_base.h"
 #include "string_bytes.h"
 #include "util.h"
 #include "uv.h"
@@ -56,6 +62,8 @@
 #include <stdlib.h>
 #include <string.h>
 #include <sys/types.h>
+#include <atomic>
+#include <utility>
 #include <vector>
 
 #if defined(NODE_HAVE_I18N_SUPPORT)
@@ -78,6 +86,11 @@ typedef int mode_t;
 #include <unistd.h>  // setuid, getuid
 #endif
 
+#ifdef __linux__
+#include <fcntl.h>  // open()
+#include <sys/mman.h>  // mmap(), madvise()
+#endif
+
 #if defined(__POSIX__) && !defined(__ANDROID__)
 #include <pwd.h>  // getpwnam()
 #include <grp.h>  // getgrnam()
@@ -133,6 +146,8 @@ static bool syntax_check_only = false;
 static bool trace_deprecation = false;
 static bool throw_deprecation = false;
 static bool trace_sync_io = false;
+static bool batch_ticks = false;
+static bool trace_startup = false;
 static bool track_heap_objects = false;
 static const char* eval_string = nullptr;
 static unsigned int preload_module_count = 0;
@@ -145,6 +160,14 @@ static bool debug_wait_connect = false;
 static int debug_port = 5858;
 static const int v8_default_thread_pool_size = 4;
 static int v8_thread_pool_size = v8_default_thread_pool_size;
+static unsigned int poll_events = 0;
+static bool timer_wheel = false;
+static bool adaptive_heap = false;
+static uint64_t stall_threshold = 0;
+static uint64_t memory_pressure_threshold = 0;
+static bool v8_shared_threadpool = false;
+static bool trace_events_enabled = false;
+static const char* trace_event_categories = "v8,node";
 static bool prof_process = false;
 static bool v8_is_profiling = false;
 static bool node_is_initialized = false;
@@ -177,8 +200,13 @@ static bool debugger_running;
 static uv_async_t dispatch_debug_messages_async;
 
 static uv_mutex_t node_isolate_mutex;
+static uv_mutex_t at_exit_mutex;
 static v8::Isolate* node_isolate;
 static v8::Platform* default_platform;
+// Wraps default_platform with --v8-shared-threadpool.
+static v8::Platform* threadpool_platform;
+// Wraps the platform below it while --trace-events-enabled is in effect.
+static v8::Platform* tracing_platform;
 
 #ifdef __POSIX__
 static uv_sem_t debug_semaphore;
@@ -217,8 +245,47 @@ static void PrintErrorString(const char* format, ...) {
 }
 
 
+// Runs the nextTick queue and the microtasks that the I/O callbacks of the
+// last poll phase left behind.  Check handles run in the reverse order of
+// uv_check_start() calls, so CheckImmediate() calls this too before it
+// processes the immediates.
+static void DrainTickBatch(Environment* env) {
+  env->set_in_tick_batch(false);
+  if (!env->tick_batch_pending())
+    return;
+  env->set_tick_batch_pending(false);
+
+  HandleScope scope(env->isolate());
+  Context::Scope context_scope(env->context());
+  Environment::AsyncCallbackScope callback_scope(env);
+  Environment::TickInfo* tick_info = env->tick_info();
+
+  if (tick_info->length() == 0) {
+    env->isolate()->RunMicrotasks();
+  }
+
+  if (tick_info->length() == 0) {
+    tick_info->set_index(0);
+    return;
+  }
+
+  env->tick_callback_function()->Call(env->process_object(), 0, nullptr);
+}
+
+
+static void StartTickBatch(uv_prepare_t* handle) {
+  Environment::from_tick_batch_prepare_handle(handle)->set_in_tick_batch(true);
+}
+
+
+static void FinishTickBatch(uv_check_t* handle) {
+  DrainTickBatch(Environment::from_tick_batch_check_handle(handle));
+}
+
+
 static void CheckImmediate(uv_check_t* handle) {
   Environment* env = Environment::from_immediate_check_handle(handle);
+  DrainTickBatch(env);
   HandleScope scope(env->isolate());
   Context::Scope context_scope(env->context());
   MakeCallback(env, env->process_object(), env->immediate_callback_string());
@@ -965,15 +1032,109 @@ Local<Value> WinapiErrnoException(Isolate* isolate,
 #endif
 
 
+bool ArrayBufferAllocator::use_huge_pages = false;
+static std::atomic<size_t> huge_page_bytes(0);
+
+
+size_t ArrayBufferAllocator::HugePageBytes() {
+  return huge_page_bytes;
+}
+
+
+ArrayBufferAllocator::ArrayBufferAllocator() : env_(nullptr) {
+}
+
+
+// The isolate, and with it the backing stores, has gone away on this thread.
+ArrayBufferAllocator::~ArrayBufferAllocator() {
+  BufferArena::FlushThreadCache();
+}
+
+
+// The mapping is rounded up to whole huge pages.  mmap() only aligns to the
+// small page size, so one huge page more is mapped and what lies outside the
+// aligned range is unmapped again.  Fresh anonymous memory reads as zero.
+void* ArrayBufferAllocator::AllocateHuge(size_t size) {
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+  const size_t length = (size + kHugePageSize - 1) & ~(kHugePageSize - 1);
+  const size_t mapped = length + kHugePageSize;
+  char* base = static_cast<char*>(mmap(nullptr,
+                                       mapped,
+                                       PROT_READ | PROT_WRITE,
+                                       MAP_PRIVATE | MAP_ANONYMOUS,
+                                       -1,
+                                       0));
+  if (base == MAP_FAILED)
+    return nullptr;
+  const uintptr_t address = reinterpret_cast<uintptr_t>(base);
+  char* start = base + (-address & (kHugePageSize - 1));
+  char* end = start + length;
+  if (start != base)
+    munmap(base, start - base);
+  if (end != base + mapped)
+    munmap(end, base + mapped - end);
+  madvise(start, length, MADV_HUGEPAGE);
+  huge_.insert(start);
+  huge_page_bytes += length;
+  return start;
+#else
+  return nullptr;
+#endif
+}
+
+
+void ArrayBufferAllocator::FreeHuge(void* data, size_t size) {
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+  const size_t length = (size + kHugePageSize - 1) & ~(kHugePageSize - 1);
+  munmap(data, length);
+  huge_page_bytes -= length;
+#endif
+}
+
+
 void* ArrayBufferAllocator::Allocate(size_t size) {
-  if (env_ == nullptr ||
-      !env_->array_buffer_allocator_info()->no_zero_fill() ||
-      zero_fill_all_buffers)
-    return calloc(size, 1);
-  env_->array_buffer_allocator_info()->reset_fill_flag();
+  bool zero_fill = true;
+  if (env_ != nullptr &&
+      env_->array_buffer_allocator_info()->no_zero_fill() &&
+      !zero_fill_all_buffers) {
+    env_->array_buffer_allocator_info()->reset_fill_flag();
+    zero_fill = false;
+  }
+  if (size > 0 && size <= BufferArena::kMaxBlockSize)
+    return BufferArena::Allocate(size, zero_fill);
+  if (use_huge_pages && size >= kHugePageSize) {
+    if (void* data = AllocateHuge(size))
+      return data;
+  }
+  return zero_fill ? calloc(size, 1) : malloc(size);
+}
+
+
+void* ArrayBufferAllocator::AllocateUninitialized(size_t size) {
+  if (size > 0 && size <= BufferArena::kMaxBlockSize)
+    return BufferArena::Allocate(size, false);
+  if (use_huge_pages && size >= kHugePageSize) {
+    if (void* data = AllocateHuge(size))
+      return data;
+  }
   return malloc(size);
 }
 
+
+void ArrayBufferAllocator::Free(void* data, size_t size) {
+  if (!adopted_.empty()) {
+    auto it = adopted_.find(data);
+    if (it != adopted_.end()) {
+      const std::pair<FreeCallback, void*> adopted = it->second;
+      adopted_.erase(it);
+      return adopted.first(static_cast<char*>(data), adopted.second);
+    }
+  }
+  if (data != nullptr && size >= kHugePageSize && huge_.erase(data) != 0)
+    return FreeHuge(data, size);
+  BufferArena::Free(data, size);
+}
+
 static bool DomainHasErrorHandler(const Environment* env,
                                   const Local<Object>& domain) {
   HandleScope scope(env->isolate());
@@ -1152,6 +1313,43 @@ void SetupPromises(const FunctionCallbackInfo<Value>& args) {
 }
 
 
+// Runs the nextTick queue and the microtasks once the outermost callback
+// returned `ret`.  Unlike AsyncWrap::MakeCallback(), this calls the tick
+// callback even when the queue is empty, which also emits the pending
+// unhandled rejections.
+static Local<Value> TickAfterCallback(
+    Environment* env,
+    Environment::AsyncCallbackScope* callback_scope,
+    Local<Value> ret) {
+  if (callback_scope->in_makecallback()) {
+    return ret;
+  }
+
+  if (env->in_tick_batch()) {
+    env->set_tick_batch_pending(true);
+    return ret;
+  }
+
+  Environment::TickInfo* tick_info = env->tick_info();
+
+  if (tick_info->length() == 0) {
+    env->isolate()->RunMicrotasks();
+  }
+
+  Local<Object> process = env->process_object();
+
+  if (tick_info->length() == 0) {
+    tick_info->set_index(0);
+  }
+
+  if (env->tick_callback_function()->Call(process, 0, nullptr).IsEmpty()) {
+    return Undefined(env->isolate());
+  }
+
+  return ret;
+}
+
+
 Local<Value> MakeCallback(Environment* env,
                           Local<Value> recv,
                           const Local<Function> callback,
@@ -1160,6 +1358,16 @@ Local<Value> MakeCallback(Environment* env,
   // If you hit this assertion, you forgot to enter the v8::Context first.
   CHECK_EQ(env->context(), env->isolate()->GetCurrentContext());
 
+  if (env->plain_callbacks()) {
+    Environment::AsyncCallbackScope callback_scope(env);
+    Local<Value> ret = callback->Call(recv, argc, argv);
+    if (ret.IsEmpty()) {
+      return callback_scope.in_makecallback() ?
+          ret : Undefined(env->isolate()).As<Value>();
+    }
+    return TickAfterCallback(env, &callback_scope, ret);
+  }
+
   Local<Function> pre_fn = env->async_hooks_pre_function();
   Local<Function> post_fn = env->async_hooks_post_function();
   Local<Object> object, domain;
@@ -1243,27 +1451,7 @@ Local<Value> MakeCallback(Environment* env,
     }
   }
 
-  if (callback_scope.in_makecallback()) {
-    return ret;
-  }
-
-  Environment::TickInfo* tick_info = env->tick_info();
-
-  if (tick_info->length() == 0) {
-    env->isolate()->RunMicrotasks();
-  }
-
-  Local<Object> process = env->process_object();
-
-  if (tick_info->length() == 0) {
-    tick_info->set_index(0);
-  }
-
-  if (env->tick_callback_function()->Call(process, 0, nullptr).IsEmpty()) {
-    return Undefined(env->isolate());
-  }
-
-  return ret;
+  return TickAfterCallback(env, &callback_scope, ret);
 }
 
 
@@ -1744,6 +1932,55 @@ void GetActiveHandles(const FunctionCallbackInfo<Value>& args) {
 }
 
 
+// Lists the alive stream handles as a flat array of
+// [owner, bytesRead, bytesWritten, readCount, writeQueueHighWaterMark, ...].
+static void GetActiveHandleStats(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+
+  Local<Array> ary = Array::New(env->isolate());
+  Local<Context> ctx = env->context();
+  Local<Function> fn = env->push_values_to_array_function();
+  Local<Value> argv[NODE_PUSH_VAL_TO_ARRAY_MAX];
+  size_t idx = 0;
+
+  Local<String> owner_sym = env->owner_string();
+
+  for (auto w : *env->handle_wrap_queue()) {
+    StreamBase* stream = w->GetStream();
+    if (w->persistent().IsEmpty() || !HandleWrap::IsAlive(w) ||
+        stream == nullptr) {
+      continue;
+    }
+    Local<Object> object = w->object();
+    Local<Value> owner = object->Get(owner_sym);
+    if (owner->IsUndefined())
+      owner = object;
+
+    Local<Value> values[] = {
+      owner,
+      Number::New(env->isolate(), static_cast<double>(stream->bytes_read())),
+      Number::New(env->isolate(),
+                  static_cast<double>(stream->bytes_written())),
+      Number::New(env->isolate(), static_cast<double>(stream->read_count())),
+      Number::New(env->isolate(),
+                  static_cast<double>(stream->write_queue_high_water()))
+    };
+    for (size_t i = 0; i < arraysize(values); i++) {
+      argv[idx] = values[i];
+      if (++idx >= arraysize(argv)) {
+        fn->Call(ctx, ary, idx, argv).ToLocalChecked();
+        idx = 0;
+      }
+    }
+  }
+  if (idx > 0) {
+    fn->Call(ctx, ary, idx, argv).ToLocalChecked();
+  }
+
+  args.GetReturnValue().Set(ary);
+}
+
+
 static void Abort(const FunctionCallbackInfo<Value>& args) {
   ABORT();
 }
@@ -2143,8 +2380,19 @@ static void InitGroups(const FunctionCallbackInfo<Value>& args) {
 #endif  // __POSIX__ && !defined(__ANDROID__)
 
 
+// Ends the process, or only the current instance when it runs a Worker or
+// belongs to an embedder.
+static void ExitInstance(Environment* env, int exit_code) {
+  if (env->worker() != nullptr)
+    return env->worker()->ChildExit(exit_code);
+  if (env->node_instance() != nullptr)
+    return env->node_instance()->Stop(exit_code);
+  exit(exit_code);
+}
+
+
 void Exit(const FunctionCallbackInfo<Value>& args) {
-  exit(args[0]->Int32Value());
+  ExitInstance(Environment::GetCurrent(args), args[0]->Int32Value());
 }
 
 
@@ -2159,11 +2407,63 @@ static void Uptime(const FunctionCallbackInfo<Value>& args) {
 }
 
 
+#ifdef __linux__
+// /proc/self/statm is opened once and read again with pread() for each
+// reading.  It is also much shorter to parse than the /proc/self/stat that
+// uv_resident_set_memory() reads.  The pid is kept to reopen the file in a
+// child that was forked without exec.
+static int statm_fd = -1;
+static pid_t statm_pid;
+
+static bool ReadStatm(size_t* rss) {
+  static const size_t page_size = sysconf(_SC_PAGESIZE);
+
+  if (statm_fd == -1 || statm_pid != getpid()) {
+    if (statm_fd != -1)
+      close(statm_fd);
+    statm_fd = open("/proc/self/statm", O_RDONLY | O_CLOEXEC);
+    statm_pid = getpid();
+    if (statm_fd == -1)
+      return false;
+  }
+
+  char buf[128];
+  ssize_t n;
+  do {
+    n = pread(statm_fd, buf, sizeof(buf) - 1, 0);
+  } while (n == -1 && errno == EINTR);
+  if (n <= 0)
+    return false;
+  buf[n] = '\0';
+
+  // The second field is the resident set size in pages.
+  const char* field = strchr(buf, ' ');
+  if (field == nullptr)
+    return false;
+  char* end;
+  unsigned long pages = strtoul(field, &end, 10);  // NOLINT(runtime/int)
+  if (end == field)
+    return false;
+  *rss = pages * page_size;
+  return true;
+}
+#endif
+
+
+static int ResidentSetMemory(size_t* rss) {
+#ifdef __linux__
+  if (ReadStatm(rss))
+    return 0;
+#endif
+  return uv_resident_set_memory(rss);
+}
+
+
 void MemoryUsage(const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args);
 
   size_t rss;
-  int err = uv_resident_set_memory(&rss);
+  int err = ResidentSetMemory(&rss);
   if (err) {
     return env->ThrowUVException(err, "uv_resident_set_memory");
   }
@@ -2181,11 +2481,40 @@ void MemoryUsage(const FunctionCallbackInfo<Value>& args) {
   info->Set(env->rss_string(), Number::New(env->isolate(), rss));
   info->Set(env->heap_total_string(), heap_total);
   info->Set(env->heap_used_string(), heap_used);
+  info->Set(env->huge_page_buffers_string(),
+            Number::New(env->isolate(),
+                        ArrayBufferAllocator::HugePageBytes()));
 
   args.GetReturnValue().Set(info);
 }
 
 
+// process.memoryUsage.rss() and process.memoryUsage.heapUsed() return one of
+// the fields of process.memoryUsage() without building the object.
+static void ResidentSetSize(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+
+  size_t rss;
+  int err = ResidentSetMemory(&rss);
+  if (err) {
+    return env->ThrowUVException(err, "uv_resident_set_memory");
+  }
+
+  args.GetReturnValue().Set(static_cast<double>(rss));
+}
+
+
+static void HeapUsed(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+
+  HeapStatistics v8_heap_stats;
+  env->isolate()->GetHeapStatistics(&v8_heap_stats);
+
+  args.GetReturnValue().Set(
+      static_cast<double>(v8_heap_stats.used_heap_size()));
+}
+
+
 void Kill(const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args);
 
@@ -2253,6 +2582,140 @@ void CPUUsage(const FunctionCallbackInfo<Value>& args) {
   fields[1] = MICROS_PER_SEC * rusage.ru_stime.tv_sec + rusage.ru_stime.tv_usec;
 }
 
+// The queue arguments are uv_threadpool_queue values; the JS wrappers in
+// lib/internal/process.js validate them.  Both return the libuv result.
+void SetThreadpoolSize(const FunctionCallbackInfo<Value>& args) {
+  CHECK(args[0]->IsUint32());
+  CHECK(args[1]->IsUint32());
+  uv_threadpool_queue queue =
+      static_cast<uv_threadpool_queue>(args[0]->Uint32Value());
+  args.GetReturnValue().Set(
+      uv_threadpool_set_size(queue, args[1]->Uint32Value()));
+}
+
+void GetThreadpoolSize(const FunctionCallbackInfo<Value>& args) {
+  CHECK(args[0]->IsUint32());
+  uv_threadpool_queue queue =
+      static_cast<uv_threadpool_queue>(args[0]->Uint32Value());
+  args.GetReturnValue().Set(uv_threadpool_get_size(queue));
+}
+
+// Turns an array of CPU numbers into a mask of uv_cpumask_size() bytes.
+// Returns UV_EINVAL for a CPU that is out of range, or the libuv error of
+// uv_cpumask_size() where CPU affinity isn't supported.
+static int CpuMaskFromArray(Local<Array> cpus, std::vector<char>* mask) {
+  const int size = uv_cpumask_size();
+  if (size < 0)
+    return size;
+
+  mask->assign(size, 0);
+  for (uint32_t i = 0; i < cpus->Length(); i++) {
+    Local<Value> cpu = cpus->Get(i);
+    if (!cpu->IsUint32() || cpu->Uint32Value() >= static_cast<uint32_t>(size))
+      return UV_EINVAL;
+    (*mask)[cpu->Uint32Value()] = 1;
+  }
+
+  return 0;
+}
+
+// setAffinity(cpus) pins the main thread, getAffinity() returns its CPUs.
+// Both return the libuv error on failure; the JS wrappers in
+// lib/internal/process.js throw it.
+void SetAffinity(const FunctionCallbackInfo<Value>& args) {
+  CHECK(args[0]->IsArray());
+  std::vector<char> mask;
+  int err = CpuMaskFromArray(args[0].As<Array>(), &mask);
+  if (err == 0) {
+    uv_thread_t self = uv_thread_self();
+    err = uv_thread_setaffinity(&self, mask.data(), nullptr, mask.size());
+  }
+  args.GetReturnValue().Set(err);
+}
+
+void GetAffinity(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  const int size = uv_cpumask_size();
+  if (size < 0)
+    return args.GetReturnValue().Set(size);
+
+  std::vector<char> mask(size);
+  uv_thread_t self = uv_thread_self();
+  int err = uv_thread_getaffinity(&self, mask.data(), mask.size());
+  if (err != 0)
+    return args.GetReturnValue().Set(err);
+
+  Local<Array> cpus = Array::New(env->isolate());
+  uint32_t n = 0;
+  for (int i = 0; i < size; i++) {
+    if (mask[i])
+      cpus->Set(n++, Integer::New(env->isolate(), i));
+  }
+  args.GetReturnValue().Set(cpus);
+}
+
+// setThreadpoolAffinity(queue, cpus) with a uv_threadpool_queue value and an
+// array of CPU numbers, or null to reset it.  Returns the libuv result.
+void SetThreadpoolAffinity(const FunctionCallbackInfo<Value>& args) {
+  CHECK(args[0]->IsUint32());
+  CHECK(args[1]->IsArray() || args[1]->IsNull());
+  uv_threadpool_queue queue =
+      static_cast<uv_threadpool_queue>(args[0]->Uint32Value());
+
+  if (args[1]->IsNull()) {
+    return args.GetReturnValue().Set(
+        uv_threadpool_set_affinity(queue, nullptr, 0));
+  }
+
+  std::vector<char> mask;
+  int err = CpuMaskFromArray(args[1].As<Array>(), &mask);
+  if (err == 0)
+    err = uv_threadpool_set_affinity(queue, mask.data(), mask.size());
+  args.GetReturnValue().Set(err);
+}
+
+// The JS wrapper in lib/internal/process.js validates the time, in
+// microseconds.  Returns the libuv result, UV_ENOSYS on platforms without
+// busy polling.
+void SetBusyPoll(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  CHECK(args[0]->IsUint32());
+  args.GetReturnValue().Set(uv_loop_configure(env->event_loop(),
+                                              UV_LOOP_BUSY_POLL,
+                                              args[0]->Uint32Value()));
+}
+
+// Fills the Float64Array passed to the function with the uv_threadpool_stats_t
+// fields of each queue, in order, with the times in microseconds.
+void ThreadpoolStats(const FunctionCallbackInfo<Value>& args) {
+  static const uv_threadpool_queue queues[] = {
+    UV_THREADPOOL_CPU, UV_THREADPOOL_FS, UV_THREADPOOL_DNS,
+    UV_THREADPOOL_CRYPTO
+  };
+  static const size_t kFields = 9;
+
+  CHECK(args[0]->IsFloat64Array());
+  Local<Float64Array> array = args[0].As<Float64Array>();
+  CHECK_EQ(array->Length(), arraysize(queues) * kFields);
+  Local<ArrayBuffer> ab = array->Buffer();
+  double* fields = static_cast<double*>(ab->GetContents().Data());
+
+  for (size_t i = 0; i < arraysize(queues); i++) {
+    uv_threadpool_stats_t stats;
+    CHECK_EQ(0, uv_threadpool_get_stats(queues[i], &stats));
+    double* f = fields + i * kFields;
+    f[0] = stats.submitted;
+    f[1] = stats.completed;
+    f[2] = stats.queued;
+    f[3] = stats.max_queued;
+    f[4] = stats.running;
+    f[5] = stats.wait_time / 1e3;
+    f[6] = stats.max_wait_time / 1e3;
+    f[7] = stats.run_time / 1e3;
+    f[8] = stats.max_run_time / 1e3;
+  }
+}
+
 extern "C" void node_module_register(void* m) {
   struct node_module* mp = reinterpret_cast<struct node_module*>(m);
 
@@ -2413,7 +2876,7 @@ void FatalException(Isolate* isolate,
     // failed before the process._fatalException function was added!
     // this is probably pretty bad.  Nothing to do but report and exit.
     ReportException(env, error, message);
-    exit(6);
+    return ExitInstance(env, 6);
   }
 
   TryCatch fatal_try_catch(isolate);
@@ -2425,15 +2888,19 @@ void FatalException(Isolate* isolate,
   Local<Value> caught =
       fatal_exception_function->Call(process_object, 1, &error);
 
+  // The Worker that runs this environment is being stopped.
+  if (fatal_try_catch.HasTerminated())
+    return;
+
   if (fatal_try_catch.HasCaught()) {
     // the fatal exception function threw, so we must exit
     ReportException(env, fatal_try_catch);
-    exit(7);
+    return ExitInstance(env, 7);
   }
 
   if (false == caught->BooleanValue()) {
     ReportException(env, error, message);
-    exit(1);
+    ExitInstance(env, 1);
   }
 }
 
@@ -2513,6 +2980,10 @@ static void Binding(const FunctionCallbackInfo<Value>& args) {
     exports = Object::New(env->isolate());
     DefineJavaScript(env, exports);
     cache->Set(module, exports);
+  } else if (!strcmp(*module_v, "code_cache")) {
+    exports = Object::New(env->isolate());
+    DefineCodeCache(env, exports);
+    cache->Set(module, exports);
   } else {
     char errmsg[1024];
     snprintf(errmsg,
@@ -2587,14 +3058,45 @@ static void ProcessTitleSetter(Local<Name> property,
 }
 
 
+// Bumped by every write through process.env, in any instance of the process.
+// Changes that addons make with setenv() directly are not noticed.
+static std::atomic<uint32_t> env_vars_generation(1);
+
+
+// The values that process.env has read, and null for the variables that are
+// not set.  Looking them up is a property load instead of a getenv() and a
+// new string every time.
+static Local<Object> EnvVarsCache(Environment* env) {
+  const uint32_t generation = env_vars_generation.load();
+  if (env->env_vars_generation() != generation) {
+    Local<Object> cache = Object::New(env->isolate());
+    cache->SetPrototype(env->context(), Null(env->isolate())).FromJust();
+    env->set_env_vars_cache_object(cache);
+    env->set_env_vars_generation(generation);
+  }
+  return env->env_vars_cache_object();
+}
+
+
 static void EnvGetter(Local<String> property,
                       const PropertyCallbackInfo<Value>& info) {
+  Environment* env = Environment::GetCurrent(info);
   Isolate* isolate = info.GetIsolate();
+  Local<Object> cache = EnvVarsCache(env);
+  Local<Value> cached;
+  if (cache->GetRealNamedProperty(env->context(), property).ToLocal(&cached)) {
+    if (cached->IsString())
+      info.GetReturnValue().Set(cached);
+    return;
+  }
 #ifdef __POSIX__
   node::Utf8Value key(isolate, property);
   const char* val = getenv(*key);
   if (val) {
-    return info.GetReturnValue().Set(String::NewFromUtf8(isolate, val));
+    Local<String> rc =
+        String::NewFromUtf8(isolate, val, String::kInternalizedString);
+    cache->Set(env->context(), property, rc).FromJust();
+    return info.GetReturnValue().Set(rc);
   }
 #else  // _WIN32
   String::Value key(property);
@@ -2608,10 +3110,14 @@ static void EnvGetter(Local<String> property,
   if ((result > 0 || GetLastError() == ERROR_SUCCESS) &&
       result < arraysize(buffer)) {
     const uint16_t* two_byte_buffer = reinterpret_cast<const uint16_t*>(buffer);
-    Local<String> rc = String::NewFromTwoByte(isolate, two_byte_buffer);
+    Local<String> rc = String::NewFromTwoByte(isolate,
+                                              two_byte_buffer,
+                                              String::kInternalizedString);
+    cache->Set(env->context(), property, rc).FromJust();
     return info.GetReturnValue().Set(rc);
   }
 #endif
+  cache->Set(env->context(), property, Null(isolate)).FromJust();
 }
 
 
@@ -2631,6 +3137,7 @@ static void EnvSetter(Local<String> property,
     SetEnvironmentVariableW(key_ptr, reinterpret_cast<WCHAR*>(*val));
   }
 #endif
+  env_vars_generation++;
   // Whether it worked or not, always return rval.
   info.GetReturnValue().Set(value);
 }
@@ -2640,9 +3147,17 @@ static void EnvQuery(Local<String> property,
                      const PropertyCallbackInfo<Integer>& info) {
   int32_t rc = -1;  // Not found unless proven otherwise.
 #ifdef __POSIX__
-  node::Utf8Value key(info.GetIsolate(), property);
-  if (getenv(*key))
-    rc = 0;
+  Environment* env = Environment::GetCurrent(info);
+  Local<Value> cached;
+  if (EnvVarsCache(env)->GetRealNamedProperty(env->context(), property)
+          .ToLocal(&cached)) {
+    if (cached->IsString())
+      rc = 0;
+  } else {
+    node::Utf8Value key(info.GetIsolate(), property);
+    if (getenv(*key))
+      rc = 0;
+  }
 #else  // _WIN32
   String::Value key(property);
   WCHAR* key_ptr = reinterpret_cast<WCHAR*>(*key);
@@ -2680,6 +3195,7 @@ static void EnvDeleter(Local<String> property,
          GetLastError() != ERROR_SUCCESS;
   }
 #endif
+  env_vars_generation++;
   info.GetReturnValue().Set(rc);
 }
 
@@ -3180,6 +3696,11 @@ void SetupProcessObject(Environment* env,
     READONLY_PROPERTY(process, "traceDeprecation", True(env->isolate()));
   }
 
+  // --trace-startup
+  if (trace_startup) {
+    READONLY_PROPERTY(process, "_traceStartup", True(env->isolate()));
+  }
+
   // --debug-brk
   if (debug_wait_connect) {
     READONLY_PROPERTY(process, "_debugWaitConnect", True(env->isolate()));
@@ -3226,6 +3747,7 @@ void SetupProcessObject(Environment* env,
                  StopProfilerIdleNotifier);
   env->SetMethod(process, "_getActiveRequests", GetActiveRequests);
   env->SetMethod(process, "_getActiveHandles", GetActiveHandles);
+  env->SetMethod(process, "_getActiveHandleStats", GetActiveHandleStats);
   env->SetMethod(process, "reallyExit", Exit);
   env->SetMethod(process, "abort", Abort);
   env->SetMethod(process, "chdir", Chdir);
@@ -3259,10 +3781,23 @@ void SetupProcessObject(Environment* env,
 
   env->SetMethod(process, "cpuUsage", CPUUsage);
 
+  env->SetMethod(process, "setThreadpoolSize", SetThreadpoolSize);
+  env->SetMethod(process, "getThreadpoolSize", GetThreadpoolSize);
+  env->SetMethod(process, "threadpoolStats", ThreadpoolStats);
+  env->SetMethod(process, "setThreadpoolAffinity", SetThreadpoolAffinity);
+  env->SetMethod(process, "setAffinity", SetAffinity);
+  env->SetMethod(process, "getAffinity", GetAffinity);
+  env->SetMethod(process, "setBusyPoll", SetBusyPoll);
+
   env->SetMethod(process, "dlopen", DLOpen);
 
   env->SetMethod(process, "uptime", Uptime);
   env->SetMethod(process, "memoryUsage", MemoryUsage);
+  Local<Object> memory_usage =
+      process->Get(FIXED_ONE_BYTE_STRING(env->isolate(), "memoryUsage"))
+          .As<Object>();
+  env->SetMethod(memory_usage, "rss", ResidentSetSize);
+  env->SetMethod(memory_usage, "heapUsed", HeapUsed);
 
   env->SetMethod(process, "binding", Binding);
   env->SetMethod(process, "_linkedBinding", LinkedBinding);
@@ -3316,6 +3851,7 @@ static void RawDebug(const FunctionCallbackInfo<Value>& args) {
 
 void LoadEnvironment(Environment* env) {
   HandleScope handle_scope(env->isolate());
+  NODE_TRACE_EVENT0("node.bootstrap", "LoadEnvironment");
 
   env->isolate()->SetFatalErrorHandler(node::OnFatalError);
   env->isolate()->AddMessageListener(OnMessage);
@@ -3325,7 +3861,8 @@ void LoadEnvironment(Environment* env) {
   // source code.)
 
   // The node.js file returns a function 'f'
-  atexit(AtExit);
+  if (env->worker() == nullptr && env->node_instance() == nullptr)
+    atexit(AtExit);
 
   TryCatch try_catch(env->isolate());
 
@@ -3343,6 +3880,13 @@ void LoadEnvironment(Environment* env) {
   CHECK(f_value->IsFunction());
   Local<Function> f = Local<Function>::Cast(f_value);
 
+  // From here on the instance can be terminated, an exception in the code above
+  // would end the process.
+  if (env->worker() != nullptr)
+    env->worker()->ChildStarted(env);
+  if (env->node_instance() != nullptr)
+    env->node_instance()->Started(env);
+
   // Now we call 'f' with the 'process' variable that we've built up with
   // all our bindings. Inside node.js we'll take care of assigning things to
   // their places.
@@ -3452,14 +3996,39 @@ static void PrintHelp() {
          "  --trace-warnings      show stack traces on process warnings\n"
          "  --trace-sync-io       show stack trace when use of sync IO\n"
          "                        is detected after the first tick\n"
+         "  --batch-ticks         process the nextTick queue once after all\n"
+         "                        I/O callbacks of a loop iteration\n"
+         "  --trace-startup       print the time spent loading each core\n"
+         "                        module at startup\n"
          "  --track-heap-objects  track heap object allocations for heap "
          "snapshots\n"
          "  --prof-process        process v8 profiler output generated\n"
          "                        using --prof\n"
          "  --zero-fill-buffers   automatically zero-fill all newly allocated\n"
          "                        Buffer and SlowBuffer instances\n"
+         "  --huge-pages          back the code of v8 and large Buffers\n"
+         "                        with transparent huge pages\n"
          "  --v8-options          print v8 command line options\n"
          "  --v8-pool-size=num    set v8's thread pool size\n"
+         "  --v8-shared-threadpool\n"
+         "                        run v8's background tasks on the libuv\n"
+         "                        threadpool\n"
+         "  --poll-events=num     set how many I/O events one poll of the\n"
+         "                        event loop can return\n"
+         "  --timer-wheel         keep the timers of the event loop in a\n"
+         "                        timer wheel instead of a binary heap\n"
+         "  --adaptive-heap       grow the young generation faster while\n"
+         "                        scavenges take much of the time\n"
+         "  --detect-stalls=ms    print the JS stack when the event loop\n"
+         "                        is blocked for longer than ms\n"
+         "  --memory-pressure-threshold=percent\n"
+         "                        trim caches and pools when the cgroup\n"
+         "                        uses more than percent of its memory limit\n"
+         "  --trace-events-enabled\n"
+         "                        record trace events to node_trace.1.log\n"
+         "  --trace-event-categories categories\n"
+         "                        comma-separated list of the trace event\n"
+         "                        categories to record (default: v8,node)\n"
 #if HAVE_OPENSSL
          "  --tls-cipher-list=val use an alternative default TLS cipher list\n"
 #if NODE_FIPS_MODE
@@ -3596,6 +4165,10 @@ static void ParseArgs(int* argc,
       trace_deprecation = true;
     } else if (strcmp(arg, "--trace-sync-io") == 0) {
       trace_sync_io = true;
+    } else if (strcmp(arg, "--batch-ticks") == 0) {
+      batch_ticks = true;
+    } else if (strcmp(arg, "--trace-startup") == 0) {
+      trace_startup = true;
     } else if (strcmp(arg, "--track-heap-objects") == 0) {
       track_heap_objects = true;
     } else if (strcmp(arg, "--throw-deprecation") == 0) {
@@ -3608,11 +4181,35 @@ static void ParseArgs(int* argc,
       short_circuit = true;
     } else if (strcmp(arg, "--zero-fill-buffers") == 0) {
       zero_fill_all_buffers = true;
+    } else if (strcmp(arg, "--huge-pages") == 0) {
+      ArrayBufferAllocator::use_huge_pages = true;
     } else if (strcmp(arg, "--v8-options") == 0) {
       new_v8_argv[new_v8_argc] = "--help";
       new_v8_argc += 1;
     } else if (strncmp(arg, "--v8-pool-size=", 15) == 0) {
       v8_thread_pool_size = atoi(arg + 15);
+    } else if (strcmp(arg, "--v8-shared-threadpool") == 0) {
+      v8_shared_threadpool = true;
+    } else if (strncmp(arg, "--poll-events=", 14) == 0) {
+      poll_events = strtoul(arg + 14, nullptr, 10);
+    } else if (strcmp(arg, "--timer-wheel") == 0) {
+      timer_wheel = true;
+    } else if (strcmp(arg, "--adaptive-heap") == 0) {
+      adaptive_heap = true;
+    } else if (strncmp(arg, "--detect-stalls=", 16) == 0) {
+      stall_threshold = strtoull(arg + 16, nullptr, 10);
+    } else if (strncmp(arg, "--memory-pressure-threshold=", 28) == 0) {
+      memory_pressure_threshold = strtoull(arg + 28, nullptr, 10);
+    } else if (strcmp(arg, "--trace-events-enabled") == 0) {
+      trace_events_enabled = true;
+    } else if (strcmp(arg, "--trace-event-categories") == 0) {
+      const char* categories = argv[index + 1];
+      if (categories == nullptr) {
+        fprintf(stderr, "%s: %s requires an argument\n", argv[0], arg);
+        exit(9);
+      }
+      args_consumed += 1;
+      trace_event_categories = categories;
 #if HAVE_OPENSSL
     } else if (strncmp(arg, "--tls-cipher-list=", 18) == 0) {
       default_cipher_list = arg + 18;
@@ -4091,6 +4688,7 @@ void Init(int* argc,
   uv_disable_stdio_inheritance();
 
   CHECK_EQ(0, uv_mutex_init(&node_isolate_mutex));
+  CHECK_EQ(0, uv_mutex_init(&at_exit_mutex));
 
   // init async debug messages dispatching
   // Main thread uses uv_default_loop
@@ -4131,6 +4729,26 @@ void Init(int* argc,
   }
 #endif
 
+  if (poll_events != 0) {
+    int err = uv_loop_configure(uv_default_loop(),
+                                UV_LOOP_POLL_EVENTS,
+                                poll_events);
+    // Not an error on platforms where the size is fixed.
+    if (err != 0 && err != UV_ENOSYS) {
+      fprintf(stderr, "%s: --poll-events: %s\n", argv[0], uv_strerror(err));
+      exit(9);
+    }
+  }
+
+  if (timer_wheel) {
+    int err = uv_loop_configure(uv_default_loop(), UV_LOOP_TIMER_WHEEL);
+    // Windows only has the binary heap.
+    if (err != 0 && err != UV_ENOSYS) {
+      fprintf(stderr, "%s: --timer-wheel: %s\n", argv[0], uv_strerror(err));
+      exit(9);
+    }
+  }
+
 #if defined(NODE_HAVE_I18N_SUPPORT)
   if (icu_data_dir == nullptr) {
     // if the parameter isn't given, use the env variable.
@@ -4165,6 +4783,11 @@ void Init(int* argc,
   const char no_typed_array_heap[] = "--typed_array_max_size_in_heap=0";
   V8::SetFlagsFromString(no_typed_array_heap, sizeof(no_typed_array_heap) - 1);
 
+  if (ArrayBufferAllocator::use_huge_pages) {
+    const char huge_code_pages[] = "--huge_code_pages";
+    V8::SetFlagsFromString(huge_code_pages, sizeof(huge_code_pages) - 1);
+  }
+
   if (!use_debug_agent) {
     RegisterDebugSignalHandler();
   }
@@ -4187,8 +4810,10 @@ static AtExitCallback* at_exit_functions_;
 
 // TODO(bnoordhuis) Turn into per-context event.
 void RunAtExit(Environment* env) {
+  uv_mutex_lock(&at_exit_mutex);
   AtExitCallback* p = at_exit_functions_;
   at_exit_functions_ = nullptr;
+  uv_mutex_unlock(&at_exit_mutex);
 
   while (p) {
     AtExitCallback* q = p->next_;
@@ -4203,8 +4828,16 @@ void AtExit(void (*cb)(void* arg), void* arg) {
   AtExitCallback* p = new AtExitCallback;
   p->cb_ = cb;
   p->arg_ = arg;
+  // Addons can be loaded by several instances at the same time.
+  uv_mutex_lock(&at_exit_mutex);
   p->next_ = at_exit_functions_;
   at_exit_functions_ = p;
+  uv_mutex_unlock(&at_exit_mutex);
+}
+
+
+uv_loop_t* GetCurrentEventLoop(Isolate* isolate) {
+  return Environment::GetCurrent(isolate)->event_loop();
 }
 
 
@@ -4222,6 +4855,9 @@ void EmitBeforeExit(Environment* env) {
 
 
 int EmitExit(Environment* env) {
+  // Report the resources that were destroyed after the last flush.
+  AsyncWrap::DestroyIdsCb(env->destroy_ids_idle_handle());
+
   // process.emit('exit')
   HandleScope handle_scope(env->isolate());
   Context::Scope context_scope(env->context());
@@ -4327,6 +4963,27 @@ Environment* CreateEnvironment(Isolate* isolate,
   uv_unref(reinterpret_cast<uv_handle_t*>(env->idle_prepare_handle()));
   uv_unref(reinterpret_cast<uv_handle_t*>(env->idle_check_handle()));
 
+  // With --batch-ticks, the poll phase runs between these two.
+  uv_prepare_init(env->event_loop(), env->tick_batch_prepare_handle());
+  uv_check_init(env->event_loop(), env->tick_batch_check_handle());
+  uv_unref(reinterpret_cast<uv_handle_t*>(env->tick_batch_prepare_handle()));
+  uv_unref(reinterpret_cast<uv_handle_t*>(env->tick_batch_check_handle()));
+
+  // Only started while there are destroy hooks to call.
+  uv_idle_init(env->event_loop(), env->destroy_ids_idle_handle());
+
+  // Only started while there are accepted connections to deliver.
+  uv_check_init(env->event_loop(), env->accept_batch_check_handle());
+  uv_unref(reinterpret_cast<uv_handle_t*>(env->accept_batch_check_handle()));
+
+  // Only started while there are signals to deliver.
+  uv_check_init(env->event_loop(), env->signal_batch_check_handle());
+  uv_unref(reinterpret_cast<uv_handle_t*>(env->signal_batch_check_handle()));
+
+  // Only started while there are errors of detached fs requests to report.
+  uv_check_init(env->event_loop(), env->fs_errors_check_handle());
+  uv_unref(reinterpret_cast<uv_handle_t*>(env->fs_errors_check_handle()));
+
   // Register handle cleanups
   env->RegisterHandleCleanup(
       reinterpret_cast<uv_handle_t*>(env->immediate_check_handle()),
@@ -4344,6 +5001,34 @@ Environment* CreateEnvironment(Isolate* isolate,
       reinterpret_cast<uv_handle_t*>(env->idle_check_handle()),
       HandleCleanup,
       nullptr);
+  env->RegisterHandleCleanup(
+      reinterpret_cast<uv_handle_t*>(env->tick_batch_prepare_handle()),
+      HandleCleanup,
+      nullptr);
+  env->RegisterHandleCleanup(
+      reinterpret_cast<uv_handle_t*>(env->tick_batch_check_handle()),
+      HandleCleanup,
+      nullptr);
+  env->RegisterHandleCleanup(
+      reinterpret_cast<uv_handle_t*>(env->destroy_ids_idle_handle()),
+      HandleCleanup,
+      nullptr);
+  env->RegisterHandleCleanup(
+      reinterpret_cast<uv_handle_t*>(env->accept_batch_check_handle()),
+      HandleCleanup,
+      nullptr);
+  env->RegisterHandleCleanup(
+      reinterpret_cast<uv_handle_t*>(env->signal_batch_check_handle()),
+      HandleCleanup,
+      nullptr);
+  env->RegisterHandleCleanup(
+      reinterpret_cast<uv_handle_t*>(env->fs_errors_check_handle()),
+      HandleCleanup,
+      nullptr);
+
+  // Trims the buffer pools and gives V8 time for garbage collection while
+  // the loop has nothing else to do.
+  env->idle_scheduler();
 
   if (v8_is_profiling) {
     StartProfilerIdleNotifier(env);
@@ -4365,8 +5050,8 @@ Environment* CreateEnvironment(Isolate* isolate,
 
 // Entry point for new node instances, also called directly for the main
 // node instance.
-static void StartNodeInstance(void* arg) {
-  NodeInstanceData* instance_data = static_cast<NodeInstanceData*>(arg);
+void StartNodeInstance(NodeInstanceData* instance_data) {
+  Worker* worker = instance_data->worker();
   Isolate::CreateParams params;
   ArrayBufferAllocator* array_buffer_allocator = new ArrayBufferAllocator();
   params.array_buffer_allocator = array_buffer_allocator;
@@ -4386,6 +5071,10 @@ static void StartNodeInstance(void* arg) {
     isolate->GetHeapProfiler()->StartTrackingHeapObjects(true);
   }
 
+  if (adaptive_heap && instance_data->is_main()) {
+    HeapSizer::Start(isolate);
+  }
+
   {
     Locker locker(isolate);
     Isolate::Scope isolate_scope(isolate);
@@ -4393,8 +5082,12 @@ static void StartNodeInstance(void* arg) {
     Local<Context> context = Context::New(isolate);
     Environment* env = CreateEnvironment(isolate, context, instance_data);
     array_buffer_allocator->set_env(env);
+    env->set_array_buffer_allocator(array_buffer_allocator);
     Context::Scope context_scope(context);
 
+    env->set_worker(worker);
+    env->set_node_instance(instance_data->node_instance());
+
     isolate->SetAbortOnUncaughtExceptionCallback(
         ShouldAbortOnUncaughtException);
 
@@ -4409,10 +5102,22 @@ static void StartNodeInstance(void* arg) {
 
     env->set_trace_sync_io(trace_sync_io);
 
+    if (batch_ticks) {
+      uv_prepare_start(env->tick_batch_prepare_handle(), StartTickBatch);
+      uv_check_start(env->tick_batch_check_handle(), FinishTickBatch);
+    }
+
     // Enable debugger
     if (instance_data->use_debug_agent())
       EnableDebug(env);
 
+    if (stall_threshold > 0 && instance_data->is_main())
+      env->stall_watchdog()->Start(stall_threshold);
+
+    // Does nothing outside of a cgroup with a memory limit.
+    if (memory_pressure_threshold > 0 && instance_data->is_main())
+      env->memory_pressure_monitor()->Start(memory_pressure_threshold);
+
     {
       SealHandleScope seal(isolate);
       bool more;
@@ -4420,6 +5125,9 @@ static void StartNodeInstance(void* arg) {
         v8::platform::PumpMessageLoop(default_platform, isolate);
         more = uv_run(env->event_loop(), UV_RUN_ONCE);
 
+        if (instance_data->is_stopping())
+          break;
+
         if (more == false) {
           v8::platform::PumpMessageLoop(default_platform, isolate);
           EmitBeforeExit(env);
@@ -4443,10 +5151,24 @@ static void StartNodeInstance(void* arg) {
 
     env->set_trace_sync_io(false);
 
-    int exit_code = EmitExit(env);
-    if (instance_data->is_main())
+    NodeInstance* node_instance = instance_data->node_instance();
+    int exit_code;
+    if (worker != nullptr && worker->is_stopping())
+      exit_code = worker->exit_code();
+    else if (node_instance != nullptr && node_instance->is_stopping())
+      exit_code = node_instance->exit_code();
+    else
+      exit_code = EmitExit(env);
+    if (!instance_data->is_remote_debug_server())
       instance_data->set_exit_code(exit_code);
-    RunAtExit(env);
+    // The AtExit() callbacks belong to the process, not to a thread.
+    if (instance_data->is_main())
+      RunAtExit(env);
+
+    if (worker != nullptr)
+      worker->ChildStopped(env);
+    if (node_instance != nullptr)
+      node_instance->Stopped(env);
 
 #if defined(LEAK_SANITIZER)
     __lsan_do_leak_check();
@@ -4468,19 +5190,166 @@ static void StartNodeInstance(void* arg) {
   delete array_buffer_allocator;
 }
 
-int Start(int argc, char** argv) {
-  PlatformInit();
+bool NodeInstanceData::is_stopping() {
+  if (worker_ != nullptr)
+    return worker_->is_stopping();
+  if (node_instance_ != nullptr)
+    return node_instance_->is_stopping();
+  return false;
+}
 
-  CHECK_GT(argc, 0);
 
-  // Hack around with the argv pointer. Used for process.title = "blah".
-  argv = uv_setup_args(argc, argv);
+void CloseEnvironmentHandles(Environment* env) {
+  for (HandleWrap* wrap : *env->handle_wrap_queue())
+    wrap->Close();
+  env->CleanupHandles();
+  CloseTaskLoop(env->event_loop());
+  uv_walk(env->event_loop(), [](uv_handle_t* h, void* arg) {
+    if (!uv_is_closing(h))
+      uv_close(h, nullptr);
+  }, nullptr);
+  uv_run(env->event_loop(), UV_RUN_DEFAULT);
+}
+
+
+void FreeEnvironment(Environment* env) {
+  for (HandleWrap* wrap : *env->handle_wrap_queue())
+    wrap->Close();
+  env->CleanupHandles();
+  env->Dispose();
+}
+
+
+NodeInstance::NodeInstance(int argc, const char* const* argv)
+    : args_(argv, argv + argc),
+      isolate_(nullptr),
+      ran_(false),
+      stopping_(false),
+      exit_code_(0) {
+  CHECK_GE(argc, 2);
+  CHECK_EQ(0, uv_loop_init(&loop_));
+  CHECK_EQ(0, uv_mutex_init(&mutex_));
+}
+
+
+NodeInstance::~NodeInstance() {
+  CHECK_EQ(isolate_, nullptr);
+  CHECK_EQ(0, uv_loop_close(&loop_));
+  uv_mutex_destroy(&mutex_);
+}
+
+
+int NodeInstance::Run() {
+  CHECK(!ran_);
+  ran_ = true;
+
+  // Closed with the other handles of the loop, in Stopped().
+  CHECK_EQ(0, uv_async_init(&loop_, &stop_async_, OnStopAsync));
+  stop_async_.data = this;
+  uv_unref(reinterpret_cast<uv_handle_t*>(&stop_async_));
+
+  std::vector<const char*> argv;
+  for (const std::string& arg : args_)
+    argv.push_back(arg.c_str());
+
+  NodeInstanceData instance_data(NodeInstanceType::EMBEDDED,
+                                 &loop_,
+                                 argv.size(),
+                                 argv.data(),
+                                 0,
+                                 nullptr,
+                                 false);
+  instance_data.set_node_instance(this);
+  StartNodeInstance(&instance_data);
+  return instance_data.exit_code();
+}
+
+
+void NodeInstance::Stop(int exit_code) {
+  uv_mutex_lock(&mutex_);
+  if (!stopping_) {
+    stopping_ = true;
+    exit_code_ = exit_code;
+  }
+  // Before Started(), the instance terminates itself there.
+  if (isolate_ != nullptr) {
+    isolate_->TerminateExecution();
+    uv_async_send(&stop_async_);
+  }
+  uv_mutex_unlock(&mutex_);
+}
+
+
+bool NodeInstance::is_stopping() {
+  uv_mutex_lock(&mutex_);
+  bool stopping = stopping_;
+  uv_mutex_unlock(&mutex_);
+  return stopping;
+}
+
+
+int NodeInstance::exit_code() {
+  uv_mutex_lock(&mutex_);
+  int exit_code = exit_code_;
+  uv_mutex_unlock(&mutex_);
+  return exit_code;
+}
+
+
+void NodeInstance::Started(Environment* env) {
+  uv_mutex_lock(&mutex_);
+  isolate_ = env->isolate();
+  if (stopping_) {
+    isolate_->TerminateExecution();
+    uv_async_send(&stop_async_);
+  }
+  uv_mutex_unlock(&mutex_);
+}
+
+
+void NodeInstance::Stopped(Environment* env) {
+  uv_mutex_lock(&mutex_);
+  isolate_ = nullptr;
+  uv_mutex_unlock(&mutex_);
+
+  // Nobody can terminate the isolate anymore, let the close callbacks run.
+  env->isolate()->CancelTerminateExecution();
+  CloseEnvironmentHandles(env);
+}
+
+
+void NodeInstance::OnStopAsync(uv_async_t* handle) {
+  NodeInstance* instance = static_cast<NodeInstance*>(handle->data);
+  uv_stop(&instance->loop_);
+}
 
-  // This needs to run *before* V8::Initialize().  The const_cast is not
-  // optional, in case you're wondering.
-  int exec_argc;
-  const char** exec_argv;
-  Init(&argc, const_cast<const char**>(argv), &exec_argc, &exec_argv);
+
+NodeInstance* CreateInstance(int argc, const char* const* argv) {
+  return new NodeInstance(argc, argv);
+}
+
+
+int RunInstance(NodeInstance* instance) {
+  return instance->Run();
+}
+
+
+void StopInstance(NodeInstance* instance, int exit_code) {
+  instance->Stop(exit_code);
+}
+
+
+void FreeInstance(NodeInstance* instance) {
+  delete instance;
+}
+
+
+void InitializeProcess(int* argc,
+                       const char** argv,
+                       int* exec_argc,
+                       const char*** exec_argv) {
+  // This needs to run *before* V8::Initialize().
+  Init(argc, argv, exec_argc, exec_argv);
 
 #if HAVE_OPENSSL
 #ifdef NODE_FIPS_MODE
@@ -4493,9 +5362,65 @@ int Start(int argc, char** argv) {
   V8::SetEntropySource(crypto::EntropySource);
 #endif
 
-  default_platform = v8::platform::CreateDefaultPlatform(v8_thread_pool_size);
-  V8::InitializePlatform(default_platform);
+  // The default platform starts its threads right away.  With
+  // --v8-shared-threadpool its one thread is left idle.
+  default_platform = v8::platform::CreateDefaultPlatform(
+      v8_shared_threadpool ? 1 : v8_thread_pool_size);
+  v8::Platform* platform = default_platform;
+  if (v8_shared_threadpool) {
+    threadpool_platform = CreateThreadpoolPlatform(platform);
+    platform = threadpool_platform;
+  }
+  if (trace_events_enabled) {
+    if (tracing::StartTracing(trace_event_categories)) {
+      tracing_platform = tracing::CreateTracingPlatform(platform);
+      platform = tracing_platform;
+    } else {
+      fprintf(stderr, "%s: could not open the trace events file\n", argv[0]);
+    }
+  }
+  V8::InitializePlatform(platform);
   V8::Initialize();
+}
+
+
+double PlatformMonotonicTime() {
+  return default_platform->MonotonicallyIncreasingTime();
+}
+
+
+void TearDownProcess() {
+  V8::Dispose();
+
+  delete default_platform;
+  default_platform = nullptr;
+  delete threadpool_platform;
+  threadpool_platform = nullptr;
+
+  // The background threads of the platform are gone, nothing records now.
+  if (tracing_platform != nullptr) {
+    tracing::StopTracing();
+    delete tracing_platform;
+    tracing_platform = nullptr;
+  }
+}
+
+
+int Start(int argc, char** argv) {
+  PlatformInit();
+
+  CHECK_GT(argc, 0);
+
+  // Hack around with the argv pointer. Used for process.title = "blah".
+  argv = uv_setup_args(argc, argv);
+
+  // The const_cast is not optional, in case you're wondering.
+  int exec_argc;
+  const char** exec_argv;
+  InitializeProcess(&argc,
+                    const_cast<const char**>(argv),
+                    &exec_argc,
+                    &exec_argv);
 
   int exit_code = 1;
   {
@@ -4509,10 +5434,7 @@ int Start(int argc, char** argv) {
     StartNodeInstance(&instance_data);
     exit_code = instance_data.exit_code();
   }
-  V8::Dispose();
-
-  delete default_platform;
-  default_platform = nullptr;
+  TearDownProcess();
 
   delete[] exec_argv;
   exec_argv = nullptr;
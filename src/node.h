@@ -212,10 +212,39 @@ NODE_EXTERN Environment* CreateEnvironment(v8::Isolate* isolate,
                                            const char* const* exec_argv);
 
 
+// Closes the handles of `env` and frees it.  The event loop and the isolate
+// are left alone, they belong to the caller.
+NODE_EXTERN void FreeEnvironment(Environment* env);
+
 NODE_EXTERN void EmitBeforeExit(Environment* env);
 NODE_EXTERN int EmitExit(Environment* env);
 NODE_EXTERN void RunAtExit(Environment* env);
 
+// Embedders that run several node instances in one process use the functions
+// below instead of Start().  InitializeProcess() parses the command line and
+// sets up V8 once; every instance then has an isolate and an event loop of
+// its own, and can run on any thread, one thread at a time.
+NODE_EXTERN void InitializeProcess(int* argc,
+                                   const char** argv,
+                                   int* exec_argc,
+                                   const char*** exec_argv);
+// Call it after the last instance has been freed.
+NODE_EXTERN void TearDownProcess();
+
+class NodeInstance;
+
+// `argv` is the command line of the instance, without node's own options:
+// argv[0] is the name of the executable and argv[1] the script to run.
+NODE_EXTERN NodeInstance* CreateInstance(int argc, const char* const* argv);
+// Runs the instance on the calling thread until its event loop is done or
+// StopInstance() is called, and returns its exit code.  An instance runs once.
+// process.exit() in the instance only stops the instance.
+NODE_EXTERN int RunInstance(NodeInstance* instance);
+// Can be called from any thread, also before RunInstance().
+NODE_EXTERN void StopInstance(NodeInstance* instance, int exit_code);
+// The instance must not be running.
+NODE_EXTERN void FreeInstance(NodeInstance* instance);
+
 /* Converts a unixtime to V8 Date */
 #define NODE_UNIXTIME_V8(t) v8::Date::New(v8::Isolate::GetCurrent(),          \
     1000 * static_cast<double>(t))
@@ -484,6 +513,52 @@ extern "C" NODE_EXTERN void node_module_register(void* mod);
  */
 NODE_EXTERN void AtExit(void (*cb)(void* arg), void* arg = 0);
 
+/* Returns the event loop of the instance that runs in |isolate|, which is not
+ * uv_default_loop() in a worker.
+ */
+NODE_EXTERN struct uv_loop_s* GetCurrentEventLoop(v8::Isolate* isolate);
+
+typedef void (*task_work_cb)(void* data);
+typedef void (*task_done_cb)(void* data, int status);
+
+/* Runs |work| on a work-stealing pool of CPU threads, then |done| on the
+ * thread of |loop|.  Meant for short, CPU-bound tasks; blocking I/O belongs
+ * on the libuv threadpool.  Call it from the loop thread or from a task that
+ * was queued for the same loop.  Tasks queued from a task are run next by
+ * the same thread, unless an idle thread steals them first.
+ * Returns 0 or a libuv error code.
+ */
+NODE_EXTERN int QueueTask(struct uv_loop_s* loop,
+                          task_work_cb work,
+                          task_done_cb done,
+                          void* data);
+
+/* Native counterparts of the process.binding('async_wrap') hooks, for add-ons
+ * that want to observe async resources without calling into JS.  They are
+ * called on the loop thread, for the resources that are created after the
+ * hooks were added, whether or not the JS hooks are enabled.  All fields but
+ * |data| may be NULL.
+ *
+ * |destroy| is called with the ids of a batch of resources that have been
+ * destroyed since the last time it was called, once per loop iteration at
+ * most.
+ *
+ * The hooks must not add or remove hooks nor call into JS.
+ */
+struct NativeAsyncHooks {
+  void (*init)(int64_t uid, int provider, int64_t parent_uid, void* data);
+  void (*before)(int64_t uid, void* data);
+  void (*after)(int64_t uid, bool did_throw, void* data);
+  void (*destroy)(const int64_t* uids, size_t count, void* data);
+  void* data;
+};
+
+/* |hooks| must stay valid until they are removed again. */
+NODE_EXTERN void AddNativeAsyncHooks(v8::Local<v8::Context> context,
+                                     const NativeAsyncHooks* hooks);
+NODE_EXTERN void RemoveNativeAsyncHooks(v8::Local<v8::Context> context,
+                                        const NativeAsyncHooks* hooks);
+
 }  // namespace node
 
 #endif  // SRC_NODE_H_
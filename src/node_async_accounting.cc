@@ -0,0 +1,246 @@
+#include "node_async_accounting.h"
+#include "env.h"
+#include "env-inl.h"
+#include "util.h"
+#include "util-inl.h"
+#include "v8.h"
+
+#include <time.h>
+
+namespace node {
+
+using v8::ArrayBuffer;
+using v8::Context;
+using v8::Float64Array;
+using v8::FunctionCallbackInfo;
+using v8::HeapStatistics;
+using v8::Local;
+using v8::Number;
+using v8::Object;
+using v8::Uint32;
+using v8::Value;
+
+
+// The CPU time of the calling thread, in milliseconds.
+static double ThreadCPUTime() {
+#ifdef _WIN32
+  FILETIME creation, exit, kernel, user;
+  if (!GetThreadTimes(GetCurrentThread(), &creation, &exit, &kernel, &user))
+    return 0;
+  // In units of 100 nanoseconds.
+  const uint64_t kernel_time =
+      (static_cast<uint64_t>(kernel.dwHighDateTime) << 32) |
+      kernel.dwLowDateTime;
+  const uint64_t user_time =
+      (static_cast<uint64_t>(user.dwHighDateTime) << 32) | user.dwLowDateTime;
+  return (kernel_time + user_time) / 1e4;
+#else
+  struct timespec ts;
+  if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0)
+    return 0;
+  return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+#endif
+}
+
+
+static size_t UsedHeapSize(Environment* env) {
+  HeapStatistics stats;
+  env->isolate()->GetHeapStatistics(&stats);
+  return stats.used_heap_size();
+}
+
+
+AsyncAccounting::AsyncAccounting(Environment* env)
+    : env_(env),
+      started_(false),
+      segment_cpu_time_(0),
+      segment_heap_size_(0) {
+  hooks_.init = OnInit;
+  hooks_.before = OnBefore;
+  hooks_.after = OnAfter;
+  hooks_.destroy = OnDestroy;
+  hooks_.data = this;
+}
+
+
+AsyncAccounting::~AsyncAccounting() {
+  Stop();
+}
+
+
+void AsyncAccounting::Start() {
+  if (started_)
+    return;
+  started_ = true;
+  env_->AddNativeAsyncHooks(&hooks_);
+}
+
+
+void AsyncAccounting::Stop() {
+  if (!started_)
+    return;
+  started_ = false;
+  env_->RemoveNativeAsyncHooks(&hooks_);
+  roots_.clear();
+  totals_.clear();
+  stack_.clear();
+}
+
+
+int64_t AsyncAccounting::current_root() const {
+  return stack_.empty() ? 0 : stack_.back();
+}
+
+
+bool AsyncAccounting::GetTotals(int64_t root, double* fields) const {
+  auto it = totals_.find(root);
+  if (it == totals_.end())
+    return false;
+  fields[kCPUTime] = it->second.cpu_time;
+  fields[kAllocatedBytes] = it->second.allocated_bytes;
+  fields[kCallbacks] = it->second.callbacks;
+  fields[kResources] = it->second.resources;
+  return true;
+}
+
+
+int64_t AsyncAccounting::RootOf(int64_t uid) {
+  auto it = roots_.find(uid);
+  if (it != roots_.end())
+    return it->second;
+  roots_[uid] = uid;
+  Totals& totals = totals_[uid];
+  totals = Totals();
+  totals.resources = 1;
+  return uid;
+}
+
+
+void AsyncAccounting::ChargeSegment() {
+  const double cpu_time = ThreadCPUTime();
+  const size_t heap_size = UsedHeapSize(env_);
+  if (!stack_.empty()) {
+    Totals& totals = totals_[stack_.back()];
+    totals.cpu_time += cpu_time - segment_cpu_time_;
+    // What was collected in between is not seen, the growth is a lower bound.
+    if (heap_size > segment_heap_size_)
+      totals.allocated_bytes += heap_size - segment_heap_size_;
+  }
+  segment_cpu_time_ = cpu_time;
+  segment_heap_size_ = heap_size;
+}
+
+
+void AsyncAccounting::OnInit(int64_t uid,
+                             int provider,
+                             int64_t parent_uid,
+                             void* data) {
+  AsyncAccounting* self = static_cast<AsyncAccounting*>(data);
+  int64_t root = uid;
+  if (parent_uid == 0 && !self->stack_.empty())
+    root = self->stack_.back();
+  self->roots_[uid] = root;
+  Totals& totals = self->totals_[root];
+  if (root == uid)
+    totals = Totals();
+  totals.resources += 1;
+}
+
+
+void AsyncAccounting::OnBefore(int64_t uid, void* data) {
+  AsyncAccounting* self = static_cast<AsyncAccounting*>(data);
+  const int64_t root = self->RootOf(uid);
+  self->ChargeSegment();
+  self->stack_.push_back(root);
+  self->totals_[root].callbacks += 1;
+}
+
+
+void AsyncAccounting::OnAfter(int64_t uid, bool did_throw, void* data) {
+  AsyncAccounting* self = static_cast<AsyncAccounting*>(data);
+  // Stop() empties the stack when it is called from a callback.
+  if (self->stack_.empty())
+    return;
+  self->ChargeSegment();
+  self->stack_.pop_back();
+}
+
+
+void AsyncAccounting::OnDestroy(const int64_t* uids,
+                                size_t count,
+                                void* data) {
+  AsyncAccounting* self = static_cast<AsyncAccounting*>(data);
+  for (size_t i = 0; i < count; i++) {
+    auto it = self->roots_.find(uids[i]);
+    if (it == self->roots_.end())
+      continue;
+    auto totals = self->totals_.find(it->second);
+    self->roots_.erase(it);
+    if (totals != self->totals_.end() && --totals->second.resources <= 0)
+      self->totals_.erase(totals);
+  }
+}
+
+
+namespace asyncaccounting {
+
+static void Start(const FunctionCallbackInfo<Value>& args) {
+  Environment::GetCurrent(args)->async_accounting()->Start();
+}
+
+
+static void Stop(const FunctionCallbackInfo<Value>& args) {
+  Environment::GetCurrent(args)->async_accounting()->Stop();
+}
+
+
+static void CurrentRoot(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  const int64_t root = env->async_accounting()->current_root();
+  args.GetReturnValue().Set(static_cast<double>(root));
+}
+
+
+// Fills the Float64Array with the totals of a root, returns false when the
+// root is not known.
+static void GetTotals(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  CHECK(args[0]->IsNumber());
+  CHECK(args[1]->IsFloat64Array());
+  const int64_t root = static_cast<int64_t>(args[0].As<Number>()->Value());
+  Local<Float64Array> array = args[1].As<Float64Array>();
+  CHECK_GE(array->Length(), AsyncAccounting::kFieldsCount);
+  Local<ArrayBuffer> ab = array->Buffer();
+  double* fields = reinterpret_cast<double*>(
+      static_cast<char*>(ab->GetContents().Data()) + array->ByteOffset());
+  args.GetReturnValue().Set(
+      env->async_accounting()->GetTotals(root, fields));
+}
+
+
+void Initialize(Local<Object> target,
+                Local<Value> unused,
+                Local<Context> context) {
+  Environment* env = Environment::GetCurrent(context);
+
+  env->SetMethod(target, "start", Start);
+  env->SetMethod(target, "stop", Stop);
+  env->SetMethod(target, "currentRoot", CurrentRoot);
+  env->SetMethod(target, "getTotals", GetTotals);
+
+#define V(index, name)                                                        \
+  target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), #name),                   \
+              Uint32::NewFromUnsigned(env->isolate(), index));
+
+  ASYNC_ACCOUNTING_FIELDS(V)
+#undef V
+  target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "kFieldsCount"),
+              Uint32::NewFromUnsigned(env->isolate(),
+                                      AsyncAccounting::kFieldsCount));
+}
+
+}  // namespace asyncaccounting
+}  // namespace node
+
+NODE_MODULE_CONTEXT_AWARE_BUILTIN(async_accounting,
+                                  node::asyncaccounting::Initialize)
@@ -0,0 +1,85 @@
+#ifndef SRC_NODE_ASYNC_ACCOUNTING_H_
+#define SRC_NODE_ASYNC_ACCOUNTING_H_
+
+#include "node.h"
+#include "util.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <unordered_map>
+#include <vector>
+
+namespace node {
+
+class Environment;
+
+#define ASYNC_ACCOUNTING_FIELDS(V)                                            \
+  V(0, kCPUTime)                                                              \
+  V(1, kAllocatedBytes)                                                       \
+  V(2, kCallbacks)                                                            \
+  V(3, kResources)                                                            \
+
+// Adds up the thread CPU time and the heap growth of the callbacks of async
+// resources per root, from native async hooks, so no JS runs for it.  A
+// resource that is created with a parent, like the connection of a server,
+// is a root of its own; the other resources belong to the root of the
+// callback that was running when they were created.  The totals of a root
+// go away with the last of its resources.  CPU times are in milliseconds.
+class AsyncAccounting {
+ public:
+  enum Fields {
+#define V(index, name) name = index,
+    ASYNC_ACCOUNTING_FIELDS(V)
+#undef V
+    kFieldsCount
+  };
+
+  explicit AsyncAccounting(Environment* env);
+  ~AsyncAccounting();
+
+  void Start();
+  // Forgets everything that was collected.
+  void Stop();
+
+  // The root of the callback that is running, 0 outside of callbacks.
+  int64_t current_root() const;
+  // Copies the totals of |root| into |fields|, false if it is not known.
+  bool GetTotals(int64_t root, double* fields) const;
+
+ private:
+  struct Totals {
+    double cpu_time;
+    double allocated_bytes;
+    double callbacks;
+    double resources;
+  };
+
+  static void OnInit(int64_t uid, int provider, int64_t parent_uid,
+                     void* data);
+  static void OnBefore(int64_t uid, void* data);
+  static void OnAfter(int64_t uid, bool did_throw, void* data);
+  static void OnDestroy(const int64_t* uids, size_t count, void* data);
+
+  // Charges the time and the heap growth since the last call to the root on
+  // top of the stack, if any.
+  void ChargeSegment();
+  // The root of |uid|.  Resources that are older than Start() become roots.
+  int64_t RootOf(int64_t uid);
+
+  Environment* const env_;
+  NativeAsyncHooks hooks_;
+  bool started_;
+  // Resource to root, and the totals of every root.
+  std::unordered_map<int64_t, int64_t> roots_;
+  std::unordered_map<int64_t, Totals> totals_;
+  // The roots of the callbacks that are running, innermost last.
+  std::vector<int64_t> stack_;
+  double segment_cpu_time_;
+  size_t segment_heap_size_;
+
+  DISALLOW_COPY_AND_ASSIGN(AsyncAccounting);
+};
+
+}  // namespace node
+
+#endif  // SRC_NODE_ASYNC_ACCOUNTING_H_
@@ -0,0 +1,213 @@
+#include "node.h"
+#include "node_buffer.h"
+#include "node_internals.h"
+#include "base-object.h"
+#include "base-object-inl.h"
+#include "env.h"
+#include "env-inl.h"
+#include "util.h"
+#include "util-inl.h"
+#include "uv.h"
+#include "v8.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+// The bench binding has no-op versions of the primitives that most bindings
+// are built on, for the benchmarks in benchmark/binding that measure what
+// they cost: a call into C++, a MakeCallback() from the event loop and the
+// creation of a Buffer.
+
+namespace node {
+namespace bench {
+
+using v8::Context;
+using v8::Function;
+using v8::FunctionCallbackInfo;
+using v8::FunctionTemplate;
+using v8::HandleScope;
+using v8::Local;
+using v8::Object;
+using v8::Persistent;
+using v8::Value;
+
+enum BufferKind {
+  kAlloc,  // Buffer::New(isolate, length)
+  kCopy,   // Buffer::Copy(isolate, data, length)
+  kOwn     // Buffer::New(isolate, data, length), which takes the memory
+};
+
+
+static void Noop(const FunctionCallbackInfo<Value>& args) {
+}
+
+
+// An object with a prototype method that unwraps its receiver, the way the
+// methods of handles and streams do.
+class BenchObject : public BaseObject {
+ public:
+  static void Initialize(Environment* env, Local<Object> target) {
+    Local<FunctionTemplate> t = env->NewFunctionTemplate(New);
+    t->InstanceTemplate()->SetInternalFieldCount(1);
+    t->SetClassName(FIXED_ONE_BYTE_STRING(env->isolate(), "BenchObject"));
+    env->SetProtoMethod(t, "noop", Noop);
+    target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "BenchObject"),
+                t->GetFunction());
+  }
+
+ private:
+  BenchObject(Environment* env, Local<Object> wrap) : BaseObject(env, wrap) {
+    MakeWeak<BenchObject>(this);
+  }
+
+  static void New(const FunctionCallbackInfo<Value>& args) {
+    CHECK(args.IsConstructCall());
+    new BenchObject(Environment::GetCurrent(args), args.This());
+  }
+
+  static void Noop(const FunctionCallbackInfo<Value>& args) {
+    BenchObject* obj = Unwrap<BenchObject>(args.Holder());
+    CHECK_NE(obj, nullptr);
+  }
+};
+
+
+// Calls a function `count` times with MakeCallback() from a timer, so that
+// each call is the outermost one and runs the next tick queue and the
+// microtasks afterwards, as the callbacks of I/O do.  `done` is called the
+// same way at the end.
+class CallbackRunner {
+ public:
+  CallbackRunner(Environment* env,
+                 Local<Object> recv,
+                 Local<Function> callback,
+                 Local<Function> done,
+                 uint32_t count)
+      : env_(env),
+        recv_(env->isolate(), recv),
+        callback_(env->isolate(), callback),
+        done_(env->isolate(), done),
+        count_(count) {
+    CHECK_EQ(0, uv_timer_init(env->event_loop(), &timer_));
+    timer_.data = this;
+    CHECK_EQ(0, uv_timer_start(&timer_, OnTimeout, 0, 0));
+  }
+
+  ~CallbackRunner() {
+    recv_.Reset();
+    callback_.Reset();
+    done_.Reset();
+  }
+
+ private:
+  static void OnTimeout(uv_timer_t* handle) {
+    CallbackRunner* runner = static_cast<CallbackRunner*>(handle->data);
+    Environment* env = runner->env_;
+    HandleScope handle_scope(env->isolate());
+    Context::Scope context_scope(env->context());
+
+    Local<Object> recv = PersistentToLocal(env->isolate(), runner->recv_);
+    Local<Function> callback =
+        PersistentToLocal(env->isolate(), runner->callback_);
+    for (uint32_t i = 0; i < runner->count_; i++) {
+      HandleScope scope(env->isolate());
+      MakeCallback(env, recv.As<Value>(), callback);
+    }
+
+    Local<Function> done = PersistentToLocal(env->isolate(), runner->done_);
+    uv_close(reinterpret_cast<uv_handle_t*>(handle), OnClose);
+    MakeCallback(env, recv.As<Value>(), done);
+  }
+
+  static void OnClose(uv_handle_t* handle) {
+    delete static_cast<CallbackRunner*>(handle->data);
+  }
+
+  Environment* const env_;
+  uv_timer_t timer_;
+  Persistent<Object> recv_;
+  Persistent<Function> callback_;
+  Persistent<Function> done_;
+  const uint32_t count_;
+
+  DISALLOW_COPY_AND_ASSIGN(CallbackRunner);
+};
+
+
+// makeCallback(recv, callback, count, done)
+static void RunMakeCallback(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  CHECK(args[0]->IsObject());
+  CHECK(args[1]->IsFunction());
+  CHECK(args[2]->IsUint32());
+  CHECK(args[3]->IsFunction());
+  new CallbackRunner(env,
+                     args[0].As<Object>(),
+                     args[1].As<Function>(),
+                     args[3].As<Function>(),
+                     args[2]->Uint32Value());
+}
+
+
+// createBuffers(count, length, kind) creates `count` Buffers of `length`
+// bytes in C++, which are garbage right away.
+static void CreateBuffers(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  CHECK(args[0]->IsUint32());
+  CHECK(args[1]->IsUint32());
+  CHECK(args[2]->IsUint32());
+  const uint32_t count = args[0]->Uint32Value();
+  const size_t length = args[1]->Uint32Value();
+  const uint32_t kind = args[2]->Uint32Value();
+  CHECK_LE(kind, kOwn);
+
+  char* data = nullptr;
+  if (kind == kCopy) {
+    data = static_cast<char*>(malloc(length + 1));
+    CHECK_NE(data, nullptr);
+    memset(data, 'x', length);
+  }
+
+  for (uint32_t i = 0; i < count; i++) {
+    HandleScope scope(env->isolate());
+    switch (kind) {
+      case kAlloc:
+        Buffer::New(env->isolate(), length).ToLocalChecked();
+        break;
+      case kCopy:
+        Buffer::Copy(env->isolate(), data, length).ToLocalChecked();
+        break;
+      case kOwn: {
+        char* owned = static_cast<char*>(malloc(length + 1));
+        CHECK_NE(owned, nullptr);
+        Buffer::New(env->isolate(), owned, length).ToLocalChecked();
+        break;
+      }
+      default:
+        UNREACHABLE();
+    }
+  }
+
+  free(data);
+}
+
+
+void Initialize(Local<Object> target,
+                Local<Value> unused,
+                Local<Context> context) {
+  Environment* env = Environment::GetCurrent(context);
+
+  env->SetMethod(target, "noop", Noop);
+  env->SetMethod(target, "makeCallback", RunMakeCallback);
+  env->SetMethod(target, "createBuffers", CreateBuffers);
+  BenchObject::Initialize(env, target);
+
+  NODE_DEFINE_CONSTANT(target, kAlloc);
+  NODE_DEFINE_CONSTANT(target, kCopy);
+  NODE_DEFINE_CONSTANT(target, kOwn);
+}
+
+}  // namespace bench
+}  // namespace node
+
+NODE_MODULE_CONTEXT_AWARE_BUILTIN(bench, node::bench::Initialize)
@@ -0,0 +1,692 @@
+#include "node.h"
+#include "node_internals.h"
+#include "base-object.h"
+#include "base-object-inl.h"
+#include "env.h"
+#include "env-inl.h"
+#include "util.h"
+#include "util-inl.h"
+#include "uv.h"
+#include "v8.h"
+
+#include <errno.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+#ifndef _WIN32
+# include <poll.h>
+# include <sys/uio.h>
+# include <unistd.h>
+#endif
+
+namespace node {
+namespace binarylog {
+
+using v8::Context;
+using v8::FunctionCallbackInfo;
+using v8::FunctionTemplate;
+using v8::GCCallbackFlags;
+using v8::GCType;
+using v8::Int32;
+using v8::Integer;
+using v8::Isolate;
+using v8::Local;
+using v8::Number;
+using v8::Object;
+using v8::String;
+using v8::Value;
+
+static const size_t kMinCapacity = 4096;
+static const size_t kMaxCapacity = 1 << 30;
+
+// Every record starts with its length in bytes including this header, the
+// id of its format and the uv_hrtime() at which it was logged.  The typed
+// arguments follow, each one a tag byte and its value.  Everything is
+// little-endian.  Format 0 registers the others: its arguments are the id
+// and the format string, so the output describes itself.
+static const size_t kRecordHeaderSize = 16;
+static const uint32_t kFormatRegistration = 0;
+
+enum ArgumentTag {
+  kInt32 = 1,    // 4 bytes
+  kDouble = 2,   // 8 bytes
+  kString = 3,   // a 4 byte length and as many bytes of UTF-8
+  kTrue = 4,
+  kFalse = 5,
+  kNull = 6,     // null and undefined
+};
+
+
+// Serializes a record into a buffer on the stack that moves to the heap
+// when it runs out of space.
+class RecordBuilder {
+ public:
+  RecordBuilder(uint32_t id, uint64_t time)
+      : data_(stack_data_),
+        capacity_(sizeof(stack_data_)),
+        length_(kRecordHeaderSize) {
+    PutUint32(4, id);
+    PutUint32(8, static_cast<uint32_t>(time));
+    PutUint32(12, static_cast<uint32_t>(time >> 32));
+  }
+
+  ~RecordBuilder() {
+    if (data_ != stack_data_)
+      delete[] data_;
+  }
+
+  void AddTag(ArgumentTag tag) {
+    Reserve(1);
+    data_[length_++] = static_cast<char>(tag);
+  }
+
+  void AddInt32(int32_t value) {
+    AddTag(kInt32);
+    Reserve(4);
+    PutUint32(length_, static_cast<uint32_t>(value));
+    length_ += 4;
+  }
+
+  void AddDouble(double value) {
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    AddTag(kDouble);
+    Reserve(8);
+    PutUint32(length_, static_cast<uint32_t>(bits));
+    PutUint32(length_ + 4, static_cast<uint32_t>(bits >> 32));
+    length_ += 8;
+  }
+
+  void AddString(Local<String> string) {
+    const size_t max_length = 3 * static_cast<size_t>(string->Length());
+    AddTag(kString);
+    Reserve(4 + max_length);
+    const int written =
+        string->WriteUtf8(&data_[length_ + 4],
+                          max_length,
+                          nullptr,
+                          String::NO_NULL_TERMINATION |
+                              String::REPLACE_INVALID_UTF8);
+    PutUint32(length_, static_cast<uint32_t>(written));
+    length_ += 4 + written;
+  }
+
+  void AddUtf8(const char* data, size_t length) {
+    AddTag(kString);
+    Reserve(4 + length);
+    PutUint32(length_, static_cast<uint32_t>(length));
+    memcpy(&data_[length_ + 4], data, length);
+    length_ += 4 + length;
+  }
+
+  void AddValue(Isolate* isolate, Local<Value> value) {
+    if (value->IsInt32()) {
+      AddInt32(value.As<Int32>()->Value());
+    } else if (value->IsNumber()) {
+      AddDouble(value.As<Number>()->Value());
+    } else if (value->IsString()) {
+      AddString(value.As<String>());
+    } else if (value->IsBoolean()) {
+      AddTag(value->IsTrue() ? kTrue : kFalse);
+    } else if (value->IsNull() || value->IsUndefined()) {
+      AddTag(kNull);
+    } else {
+      Local<String> string;
+      if (value->ToString(isolate->GetCurrentContext()).ToLocal(&string))
+        AddString(string);
+      else
+        AddTag(kNull);
+    }
+  }
+
+  // Stores the length, call before data().
+  size_t Finish() {
+    PutUint32(0, static_cast<uint32_t>(length_));
+    return length_;
+  }
+
+  const char* data() const { return data_; }
+
+ private:
+  void Reserve(size_t length) {
+    if (length_ + length <= capacity_)
+      return;
+    capacity_ = 2 * (length_ + length);
+    char* data = new char[capacity_];
+    memcpy(data, data_, length_);
+    if (data_ != stack_data_)
+      delete[] data_;
+    data_ = data;
+  }
+
+  void PutUint32(size_t offset, uint32_t value) {
+    data_[offset] = static_cast<char>(value);
+    data_[offset + 1] = static_cast<char>(value >> 8);
+    data_[offset + 2] = static_cast<char>(value >> 16);
+    data_[offset + 3] = static_cast<char>(value >> 24);
+  }
+
+  char stack_data_[1024];
+  char* data_;
+  size_t capacity_;
+  size_t length_;
+};
+
+
+// Logs records to a file descriptor, which can be a file or a socket.  The
+// thread that owns the isolate serializes a record into the ring buffer
+// without taking a lock and returns, a thread of its own writes out what
+// has accumulated.  head_ and tail_ count the bytes that were written and
+// read so far, and are only stored by the logging thread and the writer
+// thread respectively.  A record that doesn't fit into the free space is
+// dropped and counted, so logging never waits for the disk.
+//
+// When asked to, it also logs the garbage collections of the isolate, from
+// the prologue and epilogue callbacks that the DTrace, ETW and LTTng
+// providers use for their gc__start and gc__done probes.
+class BinaryLogger : public BaseObject {
+ public:
+  ~BinaryLogger() override {
+    Stop();
+    uv_cond_destroy(&flushed_cond_);
+    uv_cond_destroy(&data_cond_);
+    uv_mutex_destroy(&mutex_);
+    delete[] data_;
+  }
+
+  static void Initialize(Environment* env, Local<Object> target);
+
+ private:
+  BinaryLogger(Environment* env,
+               Local<Object> wrap,
+               int fd,
+               size_t capacity)
+      : BaseObject(env, wrap),
+        fd_(fd),
+        data_(new char[capacity]),
+        capacity_(capacity),
+        next_format_(kFormatRegistration + 1),
+        gc_start_format_(0),
+        gc_done_format_(0),
+        closed_(false),
+        logging_gc_(false),
+        dropped_(0),
+        dropped_bytes_(0),
+        head_(0),
+        tail_(0),
+        consumer_waiting_(0),
+        flush_waiting_(0),
+        errors_(0),
+        last_error_(0),
+        stopping_(false),
+        running_(false) {
+    MakeWeak<BinaryLogger>(this);
+    CHECK_EQ(0, uv_mutex_init(&mutex_));
+    CHECK_EQ(0, uv_cond_init(&data_cond_));
+    CHECK_EQ(0, uv_cond_init(&flushed_cond_));
+  }
+
+  static void New(const FunctionCallbackInfo<Value>& args);
+  static void RegisterFormat(const FunctionCallbackInfo<Value>& args);
+  static void Log(const FunctionCallbackInfo<Value>& args);
+  static void Flush(const FunctionCallbackInfo<Value>& args);
+  static void Close(const FunctionCallbackInfo<Value>& args);
+  static void GetStats(const FunctionCallbackInfo<Value>& args);
+  static void Run(void* arg);
+  static void OnGCPrologue(Isolate* isolate,
+                           GCType type,
+                           GCCallbackFlags flags);
+  static void OnGCEpilogue(Isolate* isolate,
+                           GCType type,
+                           GCCallbackFlags flags);
+
+  // Returns the id of the new format, or 0 if the registration doesn't fit
+  // into the ring buffer even when it is empty.
+  uint32_t AddFormat(const char* format, size_t length);
+  // Returns false if there is no space for |length| bytes.
+  bool Push(const char* data, size_t length);
+  void Drop(size_t length) {
+    dropped_ += 1;
+    dropped_bytes_ += length;
+  }
+  void LogGC(uint32_t format, GCType type, GCCallbackFlags flags);
+  void StartLoggingGC();
+  void StopLoggingGC();
+  void WaitFlushed();
+  void Stop();
+  // Writes the |length| bytes at |start| and returns 0 or an error code.
+  int WriteOut(uint64_t start, size_t length);
+
+  const int fd_;
+  char* const data_;
+  const size_t capacity_;
+
+  // Only used by the thread of the isolate.
+  uint32_t next_format_;
+  uint32_t gc_start_format_;
+  uint32_t gc_done_format_;
+  bool closed_;
+  bool logging_gc_;
+  double dropped_;
+  double dropped_bytes_;
+
+  std::atomic<uint64_t> head_;
+  char head_padding_[64 - sizeof(uint64_t)];
+  std::atomic<uint64_t> tail_;
+  char tail_padding_[64 - sizeof(uint64_t)];
+  std::atomic<uint32_t> consumer_waiting_;
+  std::atomic<uint32_t> flush_waiting_;
+  std::atomic<uint32_t> errors_;
+  std::atomic<int> last_error_;
+
+  // Only for sleeping and waking up, and to guard stopping_.
+  uv_mutex_t mutex_;
+  uv_cond_t data_cond_;
+  uv_cond_t flushed_cond_;
+  bool stopping_;
+
+  bool running_;
+  uv_thread_t thread_;
+};
+
+
+// The instances that log the garbage collections of their isolate.  The
+// callbacks are added once per isolate and look up their instances here.
+static uv_mutex_t gc_loggers_mutex;
+static std::vector<BinaryLogger*> gc_loggers;
+
+static void InitGCLoggersMutex() {
+  CHECK_EQ(0, uv_mutex_init(&gc_loggers_mutex));
+}
+
+static uv_mutex_t* GCLoggersMutex() {
+  static uv_once_t init_once = UV_ONCE_INIT;
+  uv_once(&init_once, InitGCLoggersMutex);
+  return &gc_loggers_mutex;
+}
+
+
+void BinaryLogger::Initialize(Environment* env, Local<Object> target) {
+  Local<FunctionTemplate> t = env->NewFunctionTemplate(New);
+  t->InstanceTemplate()->SetInternalFieldCount(1);
+
+  env->SetProtoMethod(t, "registerFormat", RegisterFormat);
+  env->SetProtoMethod(t, "log", Log);
+  env->SetProtoMethod(t, "flush", Flush);
+  env->SetProtoMethod(t, "close", Close);
+  env->SetProtoMethod(t, "getStats", GetStats);
+
+  target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "BinaryLogger"),
+              t->GetFunction());
+}
+
+
+// new BinaryLogger(fd, capacity, logGC)
+void BinaryLogger::New(const FunctionCallbackInfo<Value>& args) {
+  CHECK(args.IsConstructCall());
+  CHECK(args[0]->IsInt32());
+  CHECK(args[1]->IsUint32());
+  Environment* env = Environment::GetCurrent(args);
+
+  size_t capacity = kMinCapacity;
+  while (capacity < args[1]->Uint32Value() && capacity < kMaxCapacity)
+    capacity *= 2;
+
+  BinaryLogger* logger =
+      new BinaryLogger(env, args.This(), args[0]->Int32Value(), capacity);
+  CHECK_EQ(0, uv_thread_create(&logger->thread_, Run, logger));
+  logger->running_ = true;
+
+  if (args[2]->IsTrue())
+    logger->StartLoggingGC();
+}
+
+
+bool BinaryLogger::Push(const char* data, size_t length) {
+  const uint64_t head = head_.load(std::memory_order_relaxed);
+  const uint64_t tail = tail_.load(std::memory_order_acquire);
+  if (closed_ || length > capacity_ - (head - tail))
+    return false;
+
+  const size_t end = head & (capacity_ - 1);
+  const size_t first = length < capacity_ - end ? length : capacity_ - end;
+  memcpy(data_ + end, data, first);
+  memcpy(data_, data + first, length - first);
+
+  // Pairs with the store of consumer_waiting_ in Run(): either the writer
+  // sees the new head, or this sees that it is about to sleep.
+  head_.store(head + length, std::memory_order_seq_cst);
+  if (consumer_waiting_.load(std::memory_order_seq_cst)) {
+    uv_mutex_lock(&mutex_);
+    uv_cond_signal(&data_cond_);
+    uv_mutex_unlock(&mutex_);
+  }
+  return true;
+}
+
+
+uint32_t BinaryLogger::AddFormat(const char* format, size_t length) {
+  RecordBuilder record(kFormatRegistration, uv_hrtime());
+  record.AddInt32(next_format_);
+  record.AddUtf8(format, length);
+  const size_t size = record.Finish();
+  if (closed_ || size > capacity_)
+    return 0;
+
+  // A record that uses a format that was never registered can't be read, so
+  // registrations wait for space instead of being dropped.
+  while (!Push(record.data(), size))
+    WaitFlushed();
+  return next_format_++;
+}
+
+
+// registerFormat(format) returns the id of |format|, or 0 if it is too long
+// for the buffer.
+void BinaryLogger::RegisterFormat(const FunctionCallbackInfo<Value>& args) {
+  BinaryLogger* logger = Unwrap<BinaryLogger>(args.Holder());
+  CHECK(args[0]->IsString());
+  Utf8Value format(logger->env()->isolate(), args[0]);
+  args.GetReturnValue().Set(logger->AddFormat(*format, format.length()));
+}
+
+
+// log(id, ...args) returns false if the record was dropped.
+void BinaryLogger::Log(const FunctionCallbackInfo<Value>& args) {
+  BinaryLogger* logger = Unwrap<BinaryLogger>(args.Holder());
+  Environment* env = logger->env();
+  CHECK(args[0]->IsUint32());
+  const uint32_t id = args[0]->Uint32Value();
+  if (id == kFormatRegistration || id >= logger->next_format_)
+    return env->ThrowRangeError("Unknown format id");
+
+  RecordBuilder record(id, uv_hrtime());
+  for (int i = 1; i < args.Length(); i++)
+    record.AddValue(env->isolate(), args[i]);
+  const size_t length = record.Finish();
+  const bool pushed = logger->Push(record.data(), length);
+  if (!pushed)
+    logger->Drop(length);
+  args.GetReturnValue().Set(pushed);
+}
+
+
+void BinaryLogger::LogGC(uint32_t format,
+                         GCType type,
+                         GCCallbackFlags flags) {
+  RecordBuilder record(format, uv_hrtime());
+  record.AddInt32(type);
+  record.AddInt32(flags);
+  const size_t length = record.Finish();
+  if (!Push(record.data(), length))
+    Drop(length);
+}
+
+
+void BinaryLogger::OnGCPrologue(Isolate* isolate,
+                                GCType type,
+                                GCCallbackFlags flags) {
+  uv_mutex_t* const mutex = GCLoggersMutex();
+  uv_mutex_lock(mutex);
+  for (BinaryLogger* logger : gc_loggers) {
+    if (logger->env()->isolate() == isolate)
+      logger->LogGC(logger->gc_start_format_, type, flags);
+  }
+  uv_mutex_unlock(mutex);
+}
+
+
+void BinaryLogger::OnGCEpilogue(Isolate* isolate,
+                                GCType type,
+                                GCCallbackFlags flags) {
+  uv_mutex_t* const mutex = GCLoggersMutex();
+  uv_mutex_lock(mutex);
+  for (BinaryLogger* logger : gc_loggers) {
+    if (logger->env()->isolate() == isolate)
+      logger->LogGC(logger->gc_done_format_, type, flags);
+  }
+  uv_mutex_unlock(mutex);
+}
+
+
+void BinaryLogger::StartLoggingGC() {
+  static const char kStart[] = "gc start type=%d flags=%d";
+  static const char kDone[] = "gc done type=%d flags=%d";
+  gc_start_format_ = AddFormat(kStart, sizeof(kStart) - 1);
+  gc_done_format_ = AddFormat(kDone, sizeof(kDone) - 1);
+  logging_gc_ = true;
+
+  Isolate* const isolate = env()->isolate();
+  uv_mutex_t* const mutex = GCLoggersMutex();
+  uv_mutex_lock(mutex);
+  const bool first = std::none_of(gc_loggers.begin(),
+                                  gc_loggers.end(),
+                                  [isolate](BinaryLogger* logger) {
+    return logger->env()->isolate() == isolate;
+  });
+  gc_loggers.push_back(this);
+  uv_mutex_unlock(mutex);
+
+  if (first) {
+    isolate->AddGCPrologueCallback(OnGCPrologue);
+    isolate->AddGCEpilogueCallback(OnGCEpilogue);
+  }
+}
+
+
+void BinaryLogger::StopLoggingGC() {
+  if (!logging_gc_)
+    return;
+  logging_gc_ = false;
+
+  Isolate* const isolate = env()->isolate();
+  uv_mutex_t* const mutex = GCLoggersMutex();
+  uv_mutex_lock(mutex);
+  gc_loggers.erase(std::find(gc_loggers.begin(), gc_loggers.end(), this));
+  const bool last = std::none_of(gc_loggers.begin(),
+                                 gc_loggers.end(),
+                                 [isolate](BinaryLogger* logger) {
+    return logger->env()->isolate() == isolate;
+  });
+  uv_mutex_unlock(mutex);
+
+  if (last) {
+    isolate->RemoveGCPrologueCallback(OnGCPrologue);
+    isolate->RemoveGCEpilogueCallback(OnGCEpilogue);
+  }
+}
+
+
+void BinaryLogger::WaitFlushed() {
+  if (!running_)
+    return;
+  const uint64_t head = head_.load(std::memory_order_relaxed);
+  uv_mutex_lock(&mutex_);
+  flush_waiting_.store(1);
+  while (tail_.load() < head)
+    uv_cond_wait(&flushed_cond_, &mutex_);
+  flush_waiting_.store(0);
+  uv_mutex_unlock(&mutex_);
+}
+
+
+// flush() waits until everything that was logged so far is written out.
+void BinaryLogger::Flush(const FunctionCallbackInfo<Value>& args) {
+  Unwrap<BinaryLogger>(args.Holder())->WaitFlushed();
+}
+
+
+void BinaryLogger::Stop() {
+  StopLoggingGC();
+  closed_ = true;
+  if (!running_)
+    return;
+  uv_mutex_lock(&mutex_);
+  stopping_ = true;
+  uv_cond_signal(&data_cond_);
+  uv_mutex_unlock(&mutex_);
+  CHECK_EQ(0, uv_thread_join(&thread_));
+  running_ = false;
+}
+
+
+// close() writes out what is left and stops the thread, later records are
+// dropped.
+void BinaryLogger::Close(const FunctionCallbackInfo<Value>& args) {
+  Unwrap<BinaryLogger>(args.Holder())->Stop();
+}
+
+
+// getStats(array) stores [dropped records, dropped bytes, write errors,
+// last error code] in |array|.
+void BinaryLogger::GetStats(const FunctionCallbackInfo<Value>& args) {
+  BinaryLogger* logger = Unwrap<BinaryLogger>(args.Holder());
+  Environment* env = logger->env();
+  CHECK(args[0]->IsArray());
+  Local<Object> stats = args[0].As<Object>();
+
+  Local<Context> context = env->context();
+  stats->Set(context, 0, Number::New(env->isolate(), logger->dropped_))
+      .FromJust();
+  stats->Set(context, 1, Number::New(env->isolate(), logger->dropped_bytes_))
+      .FromJust();
+  stats->Set(context, 2, Number::New(env->isolate(), logger->errors_.load()))
+      .FromJust();
+  stats->Set(context, 3, Integer::New(env->isolate(),
+                                      logger->last_error_.load()))
+      .FromJust();
+}
+
+
+void BinaryLogger::Run(void* arg) {
+  BinaryLogger* logger = static_cast<BinaryLogger*>(arg);
+
+  for (;;) {
+    const uint64_t tail = logger->tail_.load(std::memory_order_relaxed);
+    uint64_t head = logger->head_.load(std::memory_order_acquire);
+    if (head == tail) {
+      uv_mutex_lock(&logger->mutex_);
+      logger->consumer_waiting_.store(1, std::memory_order_seq_cst);
+      while ((head = logger->head_.load(std::memory_order_seq_cst)) == tail &&
+             !logger->stopping_) {
+        uv_cond_wait(&logger->data_cond_, &logger->mutex_);
+      }
+      logger->consumer_waiting_.store(0, std::memory_order_relaxed);
+      uv_mutex_unlock(&logger->mutex_);
+      // Only stops once everything is written out.
+      if (head == tail)
+        break;
+    }
+
+    // Everything that accumulated goes out in one batch.
+    const int err = logger->WriteOut(tail, head - tail);
+    if (err != 0) {
+      logger->errors_++;
+      logger->last_error_ = err;
+    }
+    logger->tail_.store(head, std::memory_order_seq_cst);
+
+    if (logger->flush_waiting_.load(std::memory_order_seq_cst)) {
+      uv_mutex_lock(&logger->mutex_);
+      uv_cond_broadcast(&logger->flushed_cond_);
+      uv_mutex_unlock(&logger->mutex_);
+    }
+  }
+}
+
+
+#ifndef _WIN32
+
+int BinaryLogger::WriteOut(uint64_t start, size_t length) {
+  size_t offset = start & (capacity_ - 1);
+  while (length > 0) {
+    struct iovec iov[2];
+    int iovcnt = 1;
+    const size_t first =
+        length < capacity_ - offset ? length : capacity_ - offset;
+    iov[0].iov_base = data_ + offset;
+    iov[0].iov_len = first;
+    if (first < length) {
+      iov[1].iov_base = data_;
+      iov[1].iov_len = length - first;
+      iovcnt = 2;
+    }
+
+    const ssize_t n = writev(fd_, iov, iovcnt);
+    if (n == -1) {
+      if (errno == EINTR)
+        continue;
+      if (errno == EAGAIN || errno == EWOULDBLOCK) {
+        // Sockets and pipes can be non-blocking.
+        struct pollfd pfd;
+        pfd.fd = fd_;
+        pfd.events = POLLOUT;
+        pfd.revents = 0;
+        if (poll(&pfd, 1, -1) == -1 && errno != EINTR)
+          return -errno;
+        continue;
+      }
+      return -errno;
+    }
+
+    offset = (offset + n) & (capacity_ - 1);
+    length -= n;
+  }
+  return 0;
+}
+
+#else  // _WIN32
+
+int BinaryLogger::WriteOut(uint64_t start, size_t length) {
+  // The synchronous requests only need a loop to belong to.
+  uv_loop_t loop;
+  int err = uv_loop_init(&loop);
+  if (err != 0)
+    return err;
+
+  size_t offset = start & (capacity_ - 1);
+  while (length > 0) {
+    uv_buf_t bufs[2];
+    unsigned int nbufs = 1;
+    const size_t first =
+        length < capacity_ - offset ? length : capacity_ - offset;
+    bufs[0] = uv_buf_init(data_ + offset, first);
+    if (first < length) {
+      bufs[1] = uv_buf_init(data_, length - first);
+      nbufs = 2;
+    }
+
+    uv_fs_t req;
+    const int n = uv_fs_write(&loop, &req, fd_, bufs, nbufs, -1, nullptr);
+    uv_fs_req_cleanup(&req);
+    if (n < 0) {
+      err = n;
+      break;
+    }
+
+    offset = (offset + n) & (capacity_ - 1);
+    length -= n;
+  }
+
+  uv_loop_close(&loop);
+  return err;
+}
+
+#endif  // _WIN32
+
+
+void Initialize(Local<Object> target,
+                Local<Value> unused,
+                Local<Context> context) {
+  Environment* env = Environment::GetCurrent(context);
+  BinaryLogger::Initialize(env, target);
+}
+
+}  // namespace binarylog
+}  // namespace node
+
+NODE_MODULE_CONTEXT_AWARE_BUILTIN(binary_log, node::binarylog::Initialize)
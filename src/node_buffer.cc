@@ -1,6 +1,8 @@
 #include "node.h"
 #include "node_buffer.h"
 
+#include "base-object.h"
+#include "base-object-inl.h"
 #include "env.h"
 #include "env-inl.h"
 #include "string_bytes.h"
@@ -12,6 +14,7 @@
 
 #include <string.h>
 #include <limits.h>
+#include <vector>
 
 #define BUFFER_ID 0xB0E4
 
@@ -65,12 +68,14 @@ bool zero_fill_all_buffers = false;
 
 namespace Buffer {
 
+using v8::Array;
 using v8::ArrayBuffer;
 using v8::ArrayBufferCreationMode;
 using v8::Context;
 using v8::EscapableHandleScope;
 using v8::Function;
 using v8::FunctionCallbackInfo;
+using v8::FunctionTemplate;
 using v8::HandleScope;
 using v8::Integer;
 using v8::Isolate;
@@ -214,15 +219,37 @@ MaybeLocal<Object> New(Isolate* isolate,
                        enum encoding enc) {
   EscapableHandleScope scope(isolate);
 
-  const size_t length = StringBytes::Size(isolate, string, enc);
   size_t actual = 0;
   char* data = nullptr;
 
+  // The UTF-8 of a one-byte string that is all ASCII, as JSON mostly is, is
+  // the string itself.  Try that with a single copy before counting bytes.
+  const size_t string_length = string->Length();
+  if (enc == UTF8 &&
+      string_length >= StringBytes::kAsciiFastPathLength &&
+      string->IsOneByte()) {
+    data = static_cast<char*>(BUFFER_MALLOC(string_length));
+    if (data == nullptr)
+      return Local<Object>();
+    const int flags = String::HINT_MANY_WRITES_EXPECTED |
+                      String::NO_NULL_TERMINATION;
+    string->WriteOneByte(reinterpret_cast<uint8_t*>(data), 0, -1, flags);
+    if (StringBytes::IsAscii(data, string_length)) {
+      actual = string_length;
+    } else {
+      free(data);
+      data = nullptr;
+    }
+  }
+
+  const size_t length =
+      data != nullptr ? actual : StringBytes::Size(isolate, string, enc);
+
   // malloc(0) and realloc(ptr, 0) have implementation-defined behavior in
   // that the standard allows them to either return a unique pointer or a
   // nullptr for zero-sized allocation requests.  Normalize by always using
   // a nullptr.
-  if (length > 0) {
+  if (length > 0 && data == nullptr) {
     data = static_cast<char*>(BUFFER_MALLOC(length));
 
     if (data == nullptr)
@@ -382,6 +409,43 @@ MaybeLocal<Object> New(Environment* env,
 }
 
 
+MaybeLocal<Object> Adopt(Environment* env,
+                         char* data,
+                         size_t length,
+                         FreeCallback callback,
+                         void* hint) {
+  EscapableHandleScope scope(env->isolate());
+
+  ArrayBufferAllocator* allocator = env->array_buffer_allocator();
+  if (allocator == nullptr || data == nullptr || length == 0) {
+    Local<Object> obj;
+    if (New(env, data, length, callback, hint).ToLocal(&obj))
+      return scope.Escape(obj);
+    callback(data, hint);
+    return Local<Object>();
+  }
+
+  if (length > kMaxLength) {
+    callback(data, hint);
+    return Local<Object>();
+  }
+
+  // From here on the allocator frees |data|, when the ArrayBuffer goes away.
+  allocator->Adopt(data, callback, hint);
+  Local<ArrayBuffer> ab =
+      ArrayBuffer::New(env->isolate(),
+                       data,
+                       length,
+                       ArrayBufferCreationMode::kInternalized);
+  Local<Uint8Array> ui = Uint8Array::New(ab, 0, length);
+  Maybe<bool> mb =
+      ui->SetPrototype(env->context(), env->buffer_prototype_object());
+  if (mb.FromMaybe(false))
+    return scope.Escape(ui);
+  return Local<Object>();
+}
+
+
 MaybeLocal<Object> New(Isolate* isolate, char* data, size_t length) {
   Environment* env = Environment::GetCurrent(isolate);
   EscapableHandleScope handle_scope(env->isolate());
@@ -548,6 +612,120 @@ void Base64Slice(const FunctionCallbackInfo<Value>& args) {
 }
 
 
+// A string that points into the memory of a Buffer instead of a copy, for
+// buffer.toStringExternal().  It keeps the Buffer, and with it the memory,
+// alive until V8 collects the string.
+template <typename ResourceType, typename TypeName>
+class ExternBufferString : public ResourceType {
+ public:
+  ExternBufferString(Isolate* isolate,
+                     Local<Object> buffer,
+                     const TypeName* data,
+                     size_t length)
+      : buffer_(isolate, buffer), data_(data), length_(length) {}
+
+  ~ExternBufferString() override {
+    buffer_.Reset();
+  }
+
+  const TypeName* data() const override {
+    return data_;
+  }
+
+  size_t length() const override {
+    return length_;
+  }
+
+ private:
+  Persistent<Object> buffer_;
+  const TypeName* const data_;
+  const size_t length_;
+
+  DISALLOW_COPY_AND_ASSIGN(ExternBufferString);
+};
+
+typedef ExternBufferString<String::ExternalOneByteStringResource,
+                           char> ExternBufferOneByteString;
+typedef ExternBufferString<String::ExternalStringResource,
+                           uint16_t> ExternBufferTwoByteString;
+
+
+static MaybeLocal<String> NewExternal(Isolate* isolate,
+                                      ExternBufferOneByteString* resource) {
+  return String::NewExternalOneByte(isolate, resource);
+}
+
+
+static MaybeLocal<String> NewExternal(Isolate* isolate,
+                                      ExternBufferTwoByteString* resource) {
+  return String::NewExternalTwoByte(isolate, resource);
+}
+
+
+template <typename ResourceType, typename TypeName>
+static void ReturnExternal(const FunctionCallbackInfo<Value>& args,
+                           const TypeName* data,
+                           size_t length) {
+  Environment* env = Environment::GetCurrent(args);
+  ResourceType* resource =
+      new ResourceType(env->isolate(), args.This(), data, length);
+  Local<String> str;
+  if (!NewExternal(env->isolate(), resource).ToLocal(&str)) {
+    delete resource;
+    return env->ThrowError("\"toStringExternal()\" failed");
+  }
+  args.GetReturnValue().Set(str);
+}
+
+
+// Latin-1 is what V8 makes of the bytes of a one byte string.  ASCII is
+// shared only when it doesn't need the high bits cleared and UCS-2 only when
+// V8 can read it in place, the other cases fall back to a copy.
+template <encoding encoding>
+void ExternalSlice(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+
+  THROW_AND_RETURN_UNLESS_BUFFER(env, args.This());
+  SPREAD_ARG(args.This(), ts_obj);
+
+  if (ts_obj_length == 0)
+    return args.GetReturnValue().SetEmptyString();
+
+  SLICE_START_END(args[0], args[1], ts_obj_length)
+
+  const char* data = ts_obj_data + start;
+
+  if (encoding == UCS2) {
+    const bool aligned = reinterpret_cast<uintptr_t>(data) % 2 == 0;
+    if (length < 2 || !aligned || !IsLittleEndian())
+      return StringSlice<UCS2>(args);
+    return ReturnExternal<ExternBufferTwoByteString>(
+        args, reinterpret_cast<const uint16_t*>(data), length / 2);
+  }
+
+  if (length == 0)
+    return args.GetReturnValue().SetEmptyString();
+  if (encoding == ASCII && !StringBytes::IsAscii(data, length))
+    return StringSlice<ASCII>(args);
+  ReturnExternal<ExternBufferOneByteString>(args, data, length);
+}
+
+
+void BinaryExternalSlice(const FunctionCallbackInfo<Value>& args) {
+  ExternalSlice<BINARY>(args);
+}
+
+
+void AsciiExternalSlice(const FunctionCallbackInfo<Value>& args) {
+  ExternalSlice<ASCII>(args);
+}
+
+
+void Ucs2ExternalSlice(const FunctionCallbackInfo<Value>& args) {
+  ExternalSlice<UCS2>(args);
+}
+
+
 // bytesCopied = buffer.copy(target[, targetStart][, sourceStart][, sourceEnd]);
 void Copy(const FunctionCallbackInfo<Value> &args) {
   Environment* env = Environment::GetCurrent(args);
@@ -865,8 +1043,9 @@ void WriteDoubleBE(const FunctionCallbackInfo<Value>& args) {
 void ByteLengthUtf8(const FunctionCallbackInfo<Value> &args) {
   CHECK(args[0]->IsString());
 
-  // Fast case: avoid StringBytes on UTF8 string. Jump to v8.
-  args.GetReturnValue().Set(args[0].As<String>()->Utf8Length());
+  // Fast case: avoid the encoding dispatch of StringBytes::Size().
+  const size_t length = StringBytes::Utf8Length(args[0].As<String>());
+  args.GetReturnValue().Set(static_cast<uint32_t>(length));
 }
 
 // Normalize val to be an integer in the range of [1, -1] since
@@ -1177,6 +1356,429 @@ void IndexOfNumber(const FunctionCallbackInfo<Value>& args) {
                                 : -1);
 }
 
+// splitLines(buffer, start, pending, lines) pushes the lines that end in
+// buffer[start:] onto `lines`, as UTF-8 strings.  A line ends in '\n', '\r\n'
+// or a '\r' that isn't followed by '\n', like in readline.  `pending` is an
+// Array of the Buffers with the start of the first line, from earlier
+// chunks.  Returns the offset after the last line ending, -1 for none.
+void SplitLines(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  THROW_AND_RETURN_UNLESS_BUFFER(env, args[0]);
+  CHECK(args[1]->IsUint32());
+  CHECK(args[2]->IsArray());
+  CHECK(args[3]->IsArray());
+  SPREAD_ARG(args[0], ts_obj);
+
+  size_t start = args[1]->Uint32Value();
+  Local<Array> pending = args[2].As<Array>();
+  Local<Array> lines = args[3].As<Array>();
+  CHECK_LE(start, ts_obj_length);
+
+  const char* p = ts_obj_data + start;
+  const char* const end = ts_obj_data + ts_obj_length;
+  // The next '\n' and '\r' at or after p, `end` when there is none.  Lines
+  // with '\r' are rare, scanning for both at once isn't worth it.
+  const char* nl = static_cast<const char*>(memchr(p, '\n', end - p));
+  const char* cr = static_cast<const char*>(memchr(p, '\r', end - p));
+  if (nl == nullptr)
+    nl = end;
+  if (cr == nullptr)
+    cr = end;
+
+  uint32_t count = 0;
+  while (nl != end || cr != end) {
+    const char* eol = nl < cr ? nl : cr;
+    const char* next = eol + 1;
+    if (eol == cr && next < end && *next == '\n')
+      next++;
+
+    Local<Value> line;
+    if (count == 0 && pending->Length() > 0) {
+      size_t length = eol - p;
+      for (uint32_t i = 0; i < pending->Length(); i++)
+        length += Buffer::Length(pending->Get(i));
+      MaybeStackBuffer<char> joined;
+      joined.AllocateSufficientStorage(length);
+      size_t offset = 0;
+      for (uint32_t i = 0; i < pending->Length(); i++) {
+        Local<Value> chunk = pending->Get(i);
+        memcpy(*joined + offset, Buffer::Data(chunk), Buffer::Length(chunk));
+        offset += Buffer::Length(chunk);
+      }
+      memcpy(*joined + offset, p, eol - p);
+      line = StringBytes::Encode(env->isolate(), *joined, length, UTF8);
+    } else {
+      line = StringBytes::Encode(env->isolate(), p, eol - p, UTF8);
+    }
+    if (line.IsEmpty())
+      return;  // Exception pending, the line is too long.
+    lines->Set(env->context(), count++, line).FromJust();
+
+    p = next;
+    if (nl < p) {
+      nl = static_cast<const char*>(memchr(p, '\n', end - p));
+      if (nl == nullptr)
+        nl = end;
+    }
+    if (cr < p) {
+      cr = static_cast<const char*>(memchr(p, '\r', end - p));
+      if (cr == nullptr)
+        cr = end;
+    }
+  }
+
+  if (count == 0)
+    return args.GetReturnValue().Set(-1);
+  args.GetReturnValue().Set(static_cast<uint32_t>(p - ts_obj_data));
+}
+
+// A pattern that is searched for in many buffers.  The pattern is copied
+// and the Boyer-Moore(-Horspool) tables are built once, when the searcher
+// is created, rather than on every indexOf() call.
+class BufferSearcher : public BaseObject {
+ public:
+  static void Init(Environment* env, Local<Object> target) {
+    Local<String> class_name =
+        FIXED_ONE_BYTE_STRING(env->isolate(), "BufferSearcher");
+    Local<FunctionTemplate> t = env->NewFunctionTemplate(New);
+    t->InstanceTemplate()->SetInternalFieldCount(1);
+    t->SetClassName(class_name);
+    env->SetProtoMethod(t, "findFirst", FindFirst);
+    env->SetProtoMethod(t, "findAll", FindAll);
+    target->Set(class_name, t->GetFunction());
+  }
+
+  ~BufferSearcher() override {
+    delete one_byte_;
+    delete two_byte_;
+    free(pattern_);
+  }
+
+ private:
+  // args: pattern, ucs2
+  static void New(const FunctionCallbackInfo<Value>& args) {
+    Environment* env = Environment::GetCurrent(args);
+    CHECK(args.IsConstructCall());
+    THROW_AND_RETURN_UNLESS_BUFFER(env, args[0]);
+    SPREAD_ARG(args[0], pattern);
+    const bool ucs2 = args[1]->IsTrue();
+    const size_t length = ucs2 ? pattern_length / 2 : pattern_length;
+    if (length == 0)
+      return env->ThrowRangeError("pattern must not be empty");
+    new BufferSearcher(env, args.This(), pattern_data, length, ucs2);
+  }
+
+  // args: buffer, byteOffset
+  static void FindFirst(const FunctionCallbackInfo<Value>& args) {
+    BufferSearcher* searcher = Unwrap<BufferSearcher>(args.Holder());
+    if (searcher->one_byte_ != nullptr)
+      Find(args, searcher->one_byte_, searcher->length_, false);
+    else
+      Find(args, searcher->two_byte_, searcher->length_, false);
+  }
+
+  // args: buffer, byteOffset
+  static void FindAll(const FunctionCallbackInfo<Value>& args) {
+    BufferSearcher* searcher = Unwrap<BufferSearcher>(args.Holder());
+    if (searcher->one_byte_ != nullptr)
+      Find(args, searcher->one_byte_, searcher->length_, true);
+    else
+      Find(args, searcher->two_byte_, searcher->length_, true);
+  }
+
+  // Returns the byte offset of the first match at or after byteOffset, or -1.
+  // With |all|, returns an array with the byte offsets of all the matches
+  // that don't overlap a previous one instead.
+  template <typename Char>
+  static void Find(const FunctionCallbackInfo<Value>& args,
+                   stringsearch::StringSearch<Char>* search,
+                   size_t pattern_length,
+                   bool all) {
+    Environment* env = Environment::GetCurrent(args);
+    THROW_AND_RETURN_UNLESS_BUFFER(env, args[0]);
+    SPREAD_ARG(args[0], ts_obj);
+    int64_t offset_i64 = args[1]->IntegerValue();
+
+    Local<Array> matches;
+    if (all)
+      matches = Array::New(env->isolate());
+
+    // Round down to the nearest multiple of 2 in case of UCS2.
+    const size_t haystack_length = ts_obj_length / sizeof(Char);
+    int64_t opt_offset =
+        IndexOfOffset(haystack_length * sizeof(Char), offset_i64, true);
+    if (opt_offset > -1 && pattern_length <= haystack_length) {
+      size_t index = static_cast<size_t>(opt_offset) / sizeof(Char);
+      Vector<const Char> subject(reinterpret_cast<const Char*>(ts_obj_data),
+                                 haystack_length,
+                                 true);
+      uint32_t count = 0;
+      while (index <= haystack_length - pattern_length) {
+        const size_t pos = search->Search(subject, index);
+        if (pos == haystack_length)
+          break;
+        const uint32_t byte_offset = static_cast<uint32_t>(pos * sizeof(Char));
+        if (!all)
+          return args.GetReturnValue().Set(byte_offset);
+        matches->Set(env->context(),
+                     count++,
+                     Integer::NewFromUnsigned(env->isolate(), byte_offset))
+            .FromJust();
+        index = pos + pattern_length;
+      }
+    }
+
+    if (all)
+      args.GetReturnValue().Set(matches);
+    else
+      args.GetReturnValue().Set(-1);
+  }
+
+  BufferSearcher(Environment* env,
+                 Local<Object> wrap,
+                 const char* pattern,
+                 size_t length,
+                 bool ucs2)
+      : BaseObject(env, wrap),
+        length_(length),
+        one_byte_(nullptr),
+        two_byte_(nullptr) {
+    const size_t size = ucs2 ? length * 2 : length;
+    pattern_ = static_cast<char*>(malloc(size));
+    CHECK_NE(pattern_, nullptr);
+    memcpy(pattern_, pattern, size);
+    if (ucs2) {
+      Vector<const uint16_t> v(
+          reinterpret_cast<const uint16_t*>(pattern_), length, true);
+      two_byte_ = new stringsearch::StringSearch<uint16_t>(v, &tables_);
+    } else {
+      Vector<const uint8_t> v(
+          reinterpret_cast<const uint8_t*>(pattern_), length, true);
+      one_byte_ = new stringsearch::StringSearch<uint8_t>(v, &tables_);
+    }
+    MakeWeak<BufferSearcher>(this);
+  }
+
+  char* pattern_;
+  // The length of the pattern in characters.
+  size_t length_;
+  stringsearch::StringSearchBase::Tables tables_;
+  stringsearch::StringSearch<uint8_t>* one_byte_;
+  stringsearch::StringSearch<uint16_t>* two_byte_;
+};
+
+// A struct layout, a list of named fields with their type and offset, that
+// is compiled once and then read from many Buffers with one call per struct
+// or per run of structs.
+class BufferLayout : public BaseObject {
+ public:
+  static void Init(Environment* env, Local<Object> target) {
+    Local<String> class_name =
+        FIXED_ONE_BYTE_STRING(env->isolate(), "BufferLayout");
+    Local<FunctionTemplate> t = env->NewFunctionTemplate(New);
+    t->InstanceTemplate()->SetInternalFieldCount(1);
+    t->SetClassName(class_name);
+    env->SetProtoMethod(t, "read", Read);
+    env->SetProtoMethod(t, "readArray", ReadArray);
+    target->Set(class_name, t->GetFunction());
+  }
+
+  ~BufferLayout() override {
+    for (size_t i = 0; i < fields_.size(); i++)
+      names_[i].Reset();
+    delete[] names_;
+  }
+
+ private:
+  enum FieldType {
+    kInt8, kUInt8, kInt16, kUInt16, kInt32, kUInt32, kFloat, kDouble
+  };
+
+  struct Field {
+    FieldType type;
+    Endianness endianness;
+    size_t offset;
+  };
+
+  // Sets |field| from a type name like "uint16le", returns false for names
+  // that aren't known.
+  static bool ParseType(const char* name, Field* field) {
+    static const struct {
+      const char* name;
+      FieldType type;
+      Endianness endianness;
+    } types[] = {
+      { "int8", kInt8, kLittleEndian },
+      { "uint8", kUInt8, kLittleEndian },
+      { "int16le", kInt16, kLittleEndian },
+      { "int16be", kInt16, kBigEndian },
+      { "uint16le", kUInt16, kLittleEndian },
+      { "uint16be", kUInt16, kBigEndian },
+      { "int32le", kInt32, kLittleEndian },
+      { "int32be", kInt32, kBigEndian },
+      { "uint32le", kUInt32, kLittleEndian },
+      { "uint32be", kUInt32, kBigEndian },
+      { "floatle", kFloat, kLittleEndian },
+      { "floatbe", kFloat, kBigEndian },
+      { "doublele", kDouble, kLittleEndian },
+      { "doublebe", kDouble, kBigEndian },
+    };
+    for (size_t i = 0; i < arraysize(types); i++) {
+      if (strcmp(name, types[i].name) == 0) {
+        field->type = types[i].type;
+        field->endianness = types[i].endianness;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // args: names, types, offsets, size
+  static void New(const FunctionCallbackInfo<Value>& args) {
+    Environment* env = Environment::GetCurrent(args);
+    CHECK(args.IsConstructCall());
+    CHECK(args[0]->IsArray());
+    CHECK(args[1]->IsArray());
+    CHECK(args[2]->IsArray());
+    CHECK(args[3]->IsUint32());
+    Local<Array> names = args[0].As<Array>();
+    Local<Array> types = args[1].As<Array>();
+    Local<Array> offsets = args[2].As<Array>();
+    const uint32_t count = names->Length();
+    CHECK_EQ(types->Length(), count);
+    CHECK_EQ(offsets->Length(), count);
+
+    std::vector<Field> fields(count);
+    for (uint32_t i = 0; i < count; i++) {
+      node::Utf8Value type(env->isolate(), types->Get(i));
+      if (!ParseType(*type, &fields[i]))
+        return env->ThrowTypeError("Unknown field type");
+      fields[i].offset = offsets->Get(i)->Uint32Value();
+    }
+
+    BufferLayout* layout = new BufferLayout(env, args.This(), &fields);
+    layout->size_ = args[3]->Uint32Value();
+    layout->names_ = new Persistent<String>[count];
+    for (uint32_t i = 0; i < count; i++) {
+      Local<String> name = names->Get(i)->ToString(env->isolate());
+      layout->names_[i].Reset(env->isolate(), name);
+    }
+  }
+
+  template <typename T>
+  static inline T Load(const char* data, Endianness endianness) {
+    union NoAlias {
+      T val;
+      char bytes[sizeof(T)];
+    };
+
+    union NoAlias na;
+    memcpy(na.bytes, data, sizeof(na.bytes));
+    if (sizeof(T) > 1 && endianness != GetEndianness())
+      Swizzle(na.bytes, sizeof(na.bytes));
+    return na.val;
+  }
+
+  static Local<Value> ReadField(Isolate* isolate,
+                                const char* data,
+                                const Field& field) {
+    data += field.offset;
+    switch (field.type) {
+      case kInt8:
+        return Integer::New(isolate, Load<int8_t>(data, field.endianness));
+      case kUInt8:
+        return Integer::New(isolate, Load<uint8_t>(data, field.endianness));
+      case kInt16:
+        return Integer::New(isolate, Load<int16_t>(data, field.endianness));
+      case kUInt16:
+        return Integer::New(isolate, Load<uint16_t>(data, field.endianness));
+      case kInt32:
+        return Integer::New(isolate, Load<int32_t>(data, field.endianness));
+      case kUInt32:
+        return Integer::NewFromUnsigned(isolate,
+                                        Load<uint32_t>(data, field.endianness));
+      case kFloat:
+        return Number::New(isolate, Load<float>(data, field.endianness));
+      case kDouble:
+        return Number::New(isolate, Load<double>(data, field.endianness));
+    }
+    UNREACHABLE();
+  }
+
+  Local<Object> ReadObject(Isolate* isolate, const char* data) {
+    Local<Context> context = isolate->GetCurrentContext();
+    Local<Object> object = Object::New(isolate);
+    for (size_t i = 0; i < fields_.size(); i++) {
+      Local<String> name = PersistentToLocal(isolate, names_[i]);
+      object->Set(context, name, ReadField(isolate, data, fields_[i]))
+          .FromJust();
+    }
+    return object;
+  }
+
+  // args: buffer, offset, count
+  // Reads |count| structs that follow each other, starting at |offset|, and
+  // returns them as an array of objects.  When |count| is -1, reads and
+  // returns a single object.
+  static void Read(const FunctionCallbackInfo<Value>& args) {
+    Environment* env = Environment::GetCurrent(args);
+    BufferLayout* layout = Unwrap<BufferLayout>(args.Holder());
+    THROW_AND_RETURN_UNLESS_BUFFER(env, args[0]);
+    SPREAD_ARG(args[0], ts_obj);
+    const size_t offset = args[1]->Uint32Value();
+    const int32_t count = args[2]->Int32Value();
+    const size_t size = layout->size_;
+
+    if (count == -1) {
+      CHECK_LE(offset + size, ts_obj_length);
+      return args.GetReturnValue().Set(
+          layout->ReadObject(env->isolate(), ts_obj_data + offset));
+    }
+
+    CHECK_GE(count, 0);
+    CHECK_LE(offset + size * count, ts_obj_length);
+    Local<Array> structs = Array::New(env->isolate(), count);
+    for (int32_t i = 0; i < count; i++) {
+      Local<Object> object =
+          layout->ReadObject(env->isolate(), ts_obj_data + offset + size * i);
+      structs->Set(env->context(), i, object).FromJust();
+    }
+    args.GetReturnValue().Set(structs);
+  }
+
+  // args: buffer, offset
+  // Returns the values of the fields of the struct at |offset| as an array.
+  static void ReadArray(const FunctionCallbackInfo<Value>& args) {
+    Environment* env = Environment::GetCurrent(args);
+    BufferLayout* layout = Unwrap<BufferLayout>(args.Holder());
+    THROW_AND_RETURN_UNLESS_BUFFER(env, args[0]);
+    SPREAD_ARG(args[0], ts_obj);
+    const size_t offset = args[1]->Uint32Value();
+    CHECK_LE(offset + layout->size_, ts_obj_length);
+
+    const std::vector<Field>& fields = layout->fields_;
+    Local<Array> values = Array::New(env->isolate(), fields.size());
+    for (size_t i = 0; i < fields.size(); i++) {
+      Local<Value> value =
+          ReadField(env->isolate(), ts_obj_data + offset, fields[i]);
+      values->Set(env->context(), i, value).FromJust();
+    }
+    args.GetReturnValue().Set(values);
+  }
+
+  BufferLayout(Environment* env, Local<Object> wrap, std::vector<Field>* fields)
+      : BaseObject(env, wrap), size_(0), names_(nullptr) {
+    fields_.swap(*fields);
+    MakeWeak<BufferLayout>(this);
+  }
+
+  std::vector<Field> fields_;
+  // The size of the struct in bytes, the distance between two structs that
+  // follow each other.
+  size_t size_;
+  Persistent<String>* names_;
+};
+
 void Swap16(const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args);
   THROW_AND_RETURN_UNLESS_BUFFER(env, args.This());
@@ -1215,6 +1817,10 @@ void SetupBufferJS(const FunctionCallbackInfo<Value>& args) {
   env->SetMethod(proto, "ucs2Slice", Ucs2Slice);
   env->SetMethod(proto, "utf8Slice", Utf8Slice);
 
+  env->SetMethod(proto, "asciiExternalSlice", AsciiExternalSlice);
+  env->SetMethod(proto, "binaryExternalSlice", BinaryExternalSlice);
+  env->SetMethod(proto, "ucs2ExternalSlice", Ucs2ExternalSlice);
+
   env->SetMethod(proto, "asciiWrite", AsciiWrite);
   env->SetMethod(proto, "base64Write", Base64Write);
   env->SetMethod(proto, "binaryWrite", BinaryWrite);
@@ -1255,6 +1861,9 @@ void Initialize(Local<Object> target,
   env->SetMethod(target, "indexOfBuffer", IndexOfBuffer);
   env->SetMethod(target, "indexOfNumber", IndexOfNumber);
   env->SetMethod(target, "indexOfString", IndexOfString);
+  env->SetMethod(target, "splitLines", SplitLines);
+  BufferSearcher::Init(env, target);
+  BufferLayout::Init(env, target);
 
   env->SetMethod(target, "readDoubleBE", ReadDoubleBE);
   env->SetMethod(target, "readDoubleLE", ReadDoubleLE);
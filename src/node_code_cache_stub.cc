@@ -0,0 +1,13 @@
+#include "node_javascript.h"
+#include "v8.h"
+#include "env.h"
+
+namespace node {
+
+// Used when node is built without an embedded code cache for the core
+// modules.  `./configure --code-cache-path=<file>` replaces this file with
+// one generated by tools/generate_code_cache.js.
+void DefineCodeCache(Environment* env, v8::Local<v8::Object> target) {
+}
+
+}  // namespace node
@@ -1,5 +1,6 @@
 #include "node.h"
 #include "node_internals.h"
+#include "node_script_cache.h"
 #include "node_watchdog.h"
 #include "base-object.h"
 #include "base-object-inl.h"
@@ -9,6 +10,10 @@
 #include "util-inl.h"
 #include "v8-debug.h"
 
+#include <algorithm>
+#include <string>
+#include <vector>
+
 namespace node {
 
 using v8::Array;
@@ -29,6 +34,7 @@ using v8::Maybe;
 using v8::MaybeLocal;
 using v8::Name;
 using v8::NamedPropertyHandlerConfiguration;
+using v8::Number;
 using v8::Object;
 using v8::ObjectTemplate;
 using v8::Persistent;
@@ -38,6 +44,7 @@ using v8::Script;
 using v8::ScriptCompiler;
 using v8::ScriptOrigin;
 using v8::String;
+using v8::True;
 using v8::TryCatch;
 using v8::Uint8Array;
 using v8::UnboundScript;
@@ -54,9 +61,22 @@ class ContextifyContext {
 
   Environment* const env_;
   Persistent<Context> context_;
+  // Only set for contexts that can be moved to another sandbox, see
+  // InitPooled().
+  Persistent<Function> get_own_property_names_;
+  std::vector<std::string> initial_globals_;
+  // The interceptors let V8 handle the real global object while it is being
+  // cleaned up.
+  bool resetting_;
+  // The sandbox was copied onto the global object when the context was made
+  // and the context has no interceptors, see CopySandbox().
+  const bool frozen_;
 
  public:
-  ContextifyContext(Environment* env, Local<Object> sandbox_obj) : env_(env) {
+  ContextifyContext(Environment* env, Local<Object> sandbox_obj, bool frozen)
+      : env_(env),
+        resetting_(false),
+        frozen_(frozen) {
     Local<Context> v8_context = CreateV8Context(env, sandbox_obj);
     context_.Reset(env->isolate(), v8_context);
 
@@ -65,10 +85,14 @@ class ContextifyContext {
       return;
     context_.SetWeak(this, WeakCallback, v8::WeakCallbackType::kParameter);
     context_.MarkIndependent();
+
+    if (frozen_)
+      CopySandbox();
   }
 
 
   ~ContextifyContext() {
+    get_own_property_names_.Reset();
     context_.Reset();
   }
 
@@ -92,6 +116,39 @@ class ContextifyContext {
     return Local<Object>::Cast(context()->GetEmbedderData(kSandboxObjectIndex));
   }
 
+
+  inline bool frozen() const {
+    return frozen_;
+  }
+
+
+  // Gives the global object of a frozen context the sandbox's properties.
+  // Scripts then use plain global lookups, without a call into the
+  // interceptors for every access.
+  void CopySandbox() {
+    HandleScope scope(env()->isolate());
+    Local<Context> context = this->context();
+    Context::Scope context_scope(context);
+    Local<Object> global = context->Global();
+    Local<Object> sandbox_obj = sandbox();
+
+    Local<Array> names;
+    if (!sandbox_obj->GetOwnPropertyNames(context).ToLocal(&names))
+      return;
+    for (uint32_t i = 0; i < names->Length(); i++) {
+      Local<Value> key;
+      Local<Value> value;
+      if (!names->Get(context, i).ToLocal(&key) ||
+          !sandbox_obj->Get(context, key).ToLocal(&value)) {
+        return;
+      }
+      if (value == sandbox_obj)
+        value = global;
+      if (global->Set(context, key, value).IsNothing())
+        return;
+    }
+  }
+
   // XXX(isaacs): This function only exists because of a shortcoming of
   // the V8 SetNamedPropertyHandler function.
   //
@@ -195,13 +252,16 @@ class ContextifyContext {
     Local<ObjectTemplate> object_template =
         function_template->InstanceTemplate();
 
-    NamedPropertyHandlerConfiguration config(GlobalPropertyGetterCallback,
-                                             GlobalPropertySetterCallback,
-                                             GlobalPropertyQueryCallback,
-                                             GlobalPropertyDeleterCallback,
-                                             GlobalPropertyEnumeratorCallback,
-                                             CreateDataWrapper(env));
-    object_template->SetHandler(config);
+    if (!frozen_) {
+      NamedPropertyHandlerConfiguration config(
+          GlobalPropertyGetterCallback,
+          GlobalPropertySetterCallback,
+          GlobalPropertyQueryCallback,
+          GlobalPropertyDeleterCallback,
+          GlobalPropertyEnumeratorCallback,
+          CreateDataWrapper(env));
+      object_template->SetHandler(config);
+    }
 
     Local<Context> ctx = Context::New(env->isolate(), nullptr, object_template);
 
@@ -225,6 +285,83 @@ class ContextifyContext {
   }
 
 
+  // The properties of the real global object, from the context's own
+  // Object.getOwnPropertyNames() as it was before any script ran.
+  MaybeLocal<Array> GlobalPropertyNames() {
+    Local<Context> context = this->context();
+    Local<Object> global = context->Global()->GetPrototype().As<Object>();
+    Local<Function> fn =
+        PersistentToLocal(env()->isolate(), get_own_property_names_);
+    Local<Value> argv[] = { global };
+    MaybeLocal<Value> names = fn->Call(context, global, arraysize(argv), argv);
+    if (names.IsEmpty() || !names.ToLocalChecked()->IsArray())
+      return MaybeLocal<Array>();
+    return names.ToLocalChecked().As<Array>();
+  }
+
+
+  // Remembers the builtins so that Reset() can tell them apart from the
+  // properties that scripts add to the global object.
+  void InitPooled() {
+    Isolate* isolate = env()->isolate();
+    HandleScope scope(isolate);
+    Local<Context> context = this->context();
+    Context::Scope context_scope(context);
+    Local<Object> global = context->Global()->GetPrototype().As<Object>();
+
+    resetting_ = true;
+    Local<Object> object_ctor =
+        global->Get(context, FIXED_ONE_BYTE_STRING(isolate, "Object"))
+            .ToLocalChecked().As<Object>();
+    Local<Function> fn =
+        object_ctor->Get(context,
+                         FIXED_ONE_BYTE_STRING(isolate, "getOwnPropertyNames"))
+            .ToLocalChecked().As<Function>();
+    get_own_property_names_.Reset(isolate, fn);
+
+    Local<Array> names = GlobalPropertyNames().ToLocalChecked();
+    for (uint32_t i = 0; i < names->Length(); i++) {
+      node::Utf8Value name(isolate, names->Get(context, i).ToLocalChecked());
+      initial_globals_.push_back(*name);
+    }
+    std::sort(initial_globals_.begin(), initial_globals_.end());
+    resetting_ = false;
+  }
+
+
+  // Deletes what scripts added to the real global object.  Returns false
+  // when some of it can't be deleted, like top-level var declarations.
+  bool Reset() {
+    Isolate* isolate = env()->isolate();
+    HandleScope scope(isolate);
+    Local<Context> context = this->context();
+    Context::Scope context_scope(context);
+    Local<Object> global = context->Global()->GetPrototype().As<Object>();
+    TryCatch try_catch(isolate);
+
+    resetting_ = true;
+    bool clean = true;
+    Local<Array> names;
+    if (!GlobalPropertyNames().ToLocal(&names)) {
+      clean = false;
+    } else {
+      for (uint32_t i = 0; i < names->Length(); i++) {
+        Local<Value> key = names->Get(context, i).ToLocalChecked();
+        node::Utf8Value name(isolate, key);
+        if (std::binary_search(initial_globals_.begin(),
+                               initial_globals_.end(),
+                               std::string(*name))) {
+          continue;
+        }
+        if (!global->Delete(context, key).FromMaybe(false))
+          clean = false;
+      }
+    }
+    resetting_ = false;
+    return clean && !try_catch.HasCaught();
+  }
+
+
   static void Init(Environment* env, Local<Object> target) {
     Local<FunctionTemplate> function_template =
         FunctionTemplate::New(env->isolate());
@@ -234,6 +371,8 @@ class ContextifyContext {
     env->SetMethod(target, "runInDebugContext", RunInDebugContext);
     env->SetMethod(target, "makeContext", MakeContext);
     env->SetMethod(target, "isContext", IsContext);
+    env->SetMethod(target, "detachContext", DetachContext);
+    env->SetMethod(target, "attachContext", AttachContext);
   }
 
 
@@ -266,6 +405,7 @@ class ContextifyContext {
   }
 
 
+  // makeContext(sandbox[, pooled[, frozen]])
   static void MakeContext(const FunctionCallbackInfo<Value>& args) {
     Environment* env = Environment::GetCurrent(args);
 
@@ -281,7 +421,8 @@ class ContextifyContext {
             env->contextify_context_private_symbol()).FromJust());
 
     TryCatch try_catch(env->isolate());
-    ContextifyContext* context = new ContextifyContext(env, sandbox);
+    ContextifyContext* context =
+        new ContextifyContext(env, sandbox, args[2]->IsTrue());
 
     if (try_catch.HasCaught()) {
       try_catch.ReThrow();
@@ -291,6 +432,11 @@ class ContextifyContext {
     if (context->context().IsEmpty())
       return;
 
+    if (args[1]->IsTrue()) {
+      CHECK_EQ(context->frozen(), false);
+      context->InitPooled();
+    }
+
     sandbox->SetPrivate(
         env->context(),
         env->contextify_context_private_symbol(),
@@ -298,6 +444,74 @@ class ContextifyContext {
   }
 
 
+  // detachContext(sandbox) turns the sandbox of a pooled context back into a
+  // plain object.  Returns an object that keeps the context alive for
+  // attachContext(), or undefined when the context couldn't be reset.
+  static void DetachContext(const FunctionCallbackInfo<Value>& args) {
+    Environment* env = Environment::GetCurrent(args);
+    CHECK(args[0]->IsObject());
+    Local<Object> sandbox = args[0].As<Object>();
+    ContextifyContext* context = ContextFromContextifiedSandbox(env, sandbox);
+    CHECK_NE(context, nullptr);
+    CHECK_EQ(context->get_own_property_names_.IsEmpty(), false);
+
+    Local<Context> v8_context = context->context();
+    Local<Object> global = v8_context->Global();
+    bool clean = context->Reset();
+
+    sandbox->DeletePrivate(env->context(),
+                           env->contextify_context_private_symbol())
+        .FromJust();
+    sandbox->DeletePrivate(env->context(),
+                           env->contextify_global_private_symbol())
+        .FromJust();
+    v8_context->SetEmbedderData(kSandboxObjectIndex,
+                                Object::New(env->isolate()));
+
+    if (!clean)
+      return;
+
+    Local<Object> holder =
+        env->script_data_constructor_function()
+            ->NewInstance(env->context()).ToLocalChecked();
+    Wrap(holder, context);
+    holder->SetPrivate(env->context(),
+                       env->contextify_global_private_symbol(),
+                       global).FromJust();
+    args.GetReturnValue().Set(holder);
+  }
+
+
+  // attachContext(holder, sandbox) gives a context from detachContext() a
+  // new sandbox.
+  static void AttachContext(const FunctionCallbackInfo<Value>& args) {
+    Environment* env = Environment::GetCurrent(args);
+    CHECK(args[0]->IsObject());
+    CHECK(args[1]->IsObject());
+    Local<Object> holder = args[0].As<Object>();
+    Local<Object> sandbox = args[1].As<Object>();
+    CHECK(
+        !sandbox->HasPrivate(
+            env->context(),
+            env->contextify_context_private_symbol()).FromJust());
+
+    ContextifyContext* context = Unwrap<ContextifyContext>(holder);
+    CHECK_NE(context, nullptr);
+    ClearWrap(holder);
+
+    Local<Context> v8_context = context->context();
+    v8_context->SetEmbedderData(kSandboxObjectIndex, sandbox);
+    sandbox->SetPrivate(env->context(),
+                        env->contextify_global_private_symbol(),
+                        v8_context->Global()).FromJust();
+    sandbox->SetPrivate(env->context(),
+                        env->contextify_context_private_symbol(),
+                        External::New(env->isolate(), context)).FromJust();
+    holder->DeletePrivate(env->context(),
+                          env->contextify_global_private_symbol()).FromJust();
+  }
+
+
   static void IsContext(const FunctionCallbackInfo<Value>& args) {
     Environment* env = Environment::GetCurrent(args);
 
@@ -343,7 +557,7 @@ class ContextifyContext {
         Unwrap<ContextifyContext>(args.Data().As<Object>());
 
     // Stil initializing
-    if (ctx->context_.IsEmpty())
+    if (ctx->context_.IsEmpty() || ctx->resetting_)
       return;
 
     Local<Context> context = ctx->context();
@@ -373,7 +587,7 @@ class ContextifyContext {
         Unwrap<ContextifyContext>(args.Data().As<Object>());
 
     // Stil initializing
-    if (ctx->context_.IsEmpty())
+    if (ctx->context_.IsEmpty() || ctx->resetting_)
       return;
 
     ctx->sandbox()->Set(property, value);
@@ -387,7 +601,7 @@ class ContextifyContext {
         Unwrap<ContextifyContext>(args.Data().As<Object>());
 
     // Stil initializing
-    if (ctx->context_.IsEmpty())
+    if (ctx->context_.IsEmpty() || ctx->resetting_)
       return;
 
     Local<Context> context = ctx->context();
@@ -414,7 +628,7 @@ class ContextifyContext {
         Unwrap<ContextifyContext>(args.Data().As<Object>());
 
     // Stil initializing
-    if (ctx->context_.IsEmpty())
+    if (ctx->context_.IsEmpty() || ctx->resetting_)
       return;
 
     Maybe<bool> success = ctx->sandbox()->Delete(ctx->context(), property);
@@ -430,7 +644,7 @@ class ContextifyContext {
         Unwrap<ContextifyContext>(args.Data().As<Object>());
 
     // Stil initializing
-    if (ctx->context_.IsEmpty())
+    if (ctx->context_.IsEmpty() || ctx->resetting_)
       return;
 
     args.GetReturnValue().Set(ctx->sandbox()->GetPropertyNames());
@@ -455,6 +669,8 @@ class ContextifyScript : public BaseObject {
 
     target->Set(class_name, script_tmpl->GetFunction());
     env->set_script_context_constructor_template(script_tmpl);
+
+    env->SetMethod(target, "scriptCacheStats", ScriptCacheStats);
   }
 
 
@@ -492,6 +708,17 @@ class ContextifyScript : public BaseObject {
     }
 
     ScriptOrigin origin(filename, lineOffset, columnOffset);
+
+    // A code cache that is passed in is still handed to V8, which reports
+    // whether it was rejected.
+    ScriptCache* script_cache = env->script_cache();
+    const uint64_t hash = ScriptCache::Hash(code, origin);
+    if (cached_data == nullptr &&
+        FromScriptCache(env, args.This(), contextify_script, hash, code,
+                        origin, produce_cached_data)) {
+      return;
+    }
+
     ScriptCompiler::Source source(code, origin, cached_data);
     ScriptCompiler::CompileOptions compile_options =
         ScriptCompiler::kNoCompileOptions;
@@ -516,14 +743,20 @@ class ContextifyScript : public BaseObject {
     contextify_script->script_.Reset(env->isolate(),
                                      v8_script.ToLocalChecked());
 
+    // The entry keeps a code cache that V8 accepted or produced.
+    const ScriptCompiler::CachedData* code_cache = nullptr;
     if (compile_options == ScriptCompiler::kConsumeCodeCache) {
+      bool rejected = source.GetCachedData()->rejected;
+      if (!rejected)
+        code_cache = source.GetCachedData();
       args.This()->Set(
           env->cached_data_rejected_string(),
-          Boolean::New(env->isolate(), source.GetCachedData()->rejected));
+          Boolean::New(env->isolate(), rejected));
     } else if (compile_options == ScriptCompiler::kProduceCodeCache) {
       const ScriptCompiler::CachedData* cached_data = source.GetCachedData();
       bool cached_data_produced = cached_data != nullptr;
       if (cached_data_produced) {
+        code_cache = cached_data;
         MaybeLocal<Object> buf = Buffer::Copy(
             env,
             reinterpret_cast<const char*>(cached_data->data),
@@ -534,6 +767,59 @@ class ContextifyScript : public BaseObject {
           env->cached_data_produced_string(),
           Boolean::New(env->isolate(), cached_data_produced));
     }
+
+    script_cache->Put(hash,
+                      code,
+                      origin,
+                      v8_script.ToLocalChecked(),
+                      code_cache != nullptr ? code_cache->data : nullptr,
+                      code_cache != nullptr ? code_cache->length : 0);
+  }
+
+
+  // Takes the script from the cache of the environment.  With
+  // produceCachedData it also needs the code cache of the entry, or else the
+  // script is compiled again to produce one.
+  static bool FromScriptCache(Environment* env,
+                              Local<Object> object,
+                              ContextifyScript* contextify_script,
+                              uint64_t hash,
+                              Local<String> code,
+                              const ScriptOrigin& origin,
+                              bool produce_cached_data) {
+    const std::vector<uint8_t>* code_cache;
+    Local<UnboundScript> script =
+        env->script_cache()->Get(hash, code, origin, &code_cache);
+    if (script.IsEmpty() || (produce_cached_data && code_cache == nullptr))
+      return false;
+
+    contextify_script->script_.Reset(env->isolate(), script);
+    if (produce_cached_data) {
+      MaybeLocal<Object> buf = Buffer::Copy(
+          env,
+          reinterpret_cast<const char*>(code_cache->data()),
+          code_cache->size());
+      object->Set(env->cached_data_string(), buf.ToLocalChecked());
+      object->Set(env->cached_data_produced_string(), True(env->isolate()));
+    }
+    return true;
+  }
+
+
+  static void ScriptCacheStats(const FunctionCallbackInfo<Value>& args) {
+    Environment* env = Environment::GetCurrent(args);
+    ScriptCache* script_cache = env->script_cache();
+    Local<Object> stats = Object::New(env->isolate());
+    stats->Set(env->context(),
+               FIXED_ONE_BYTE_STRING(env->isolate(), "size"),
+               Number::New(env->isolate(), script_cache->size())).FromJust();
+    stats->Set(env->context(),
+               FIXED_ONE_BYTE_STRING(env->isolate(), "hits"),
+               Number::New(env->isolate(), script_cache->hits())).FromJust();
+    stats->Set(env->context(),
+               FIXED_ONE_BYTE_STRING(env->isolate(), "misses"),
+               Number::New(env->isolate(), script_cache->misses())).FromJust();
+    args.GetReturnValue().Set(stats);
   }
 
 
@@ -602,7 +888,8 @@ class ContextifyScript : public BaseObject {
                       timeout,
                       display_errors,
                       args,
-                      try_catch)) {
+                      try_catch) &&
+          !contextify_context->frozen()) {
         contextify_context->CopyProperties();
       }
 
@@ -7,6 +7,7 @@
 
 #include "async-wrap.h"
 #include "async-wrap-inl.h"
+#include "buffer_arena.h"
 #include "env.h"
 #include "env-inl.h"
 #include "string_bytes.h"
@@ -23,6 +24,7 @@
 #include <math.h>
 #include <stdlib.h>
 #include <string.h>
+#include <vector>
 
 #define THROW_AND_RETURN_IF_NOT_STRING_OR_BUFFER(val, prefix)                  \
   do {                                                                         \
@@ -77,6 +79,7 @@ using v8::Integer;
 using v8::Isolate;
 using v8::Local;
 using v8::Null;
+using v8::Number;
 using v8::Object;
 using v8::Persistent;
 using v8::PropertyAttribute;
@@ -121,7 +124,9 @@ const char* const root_certs[] = {
 #include "node_root_certs.h"  // NOLINT(build/include_order)
 };
 
-X509_STORE* root_cert_store;
+// Parsed on first use, see GetRootCertStore().
+static X509_STORE* root_cert_store;
+static uv_once_t root_cert_store_once = UV_ONCE_INIT;
 
 // Just to generate static methods
 template class SSLWrap<TLSWrap>;
@@ -174,6 +179,21 @@ template int SSLWrap<TLSWrap>::SelectALPNCallback(
     void* arg);
 #endif  // TLSEXT_TYPE_application_layer_protocol_negotiation
 
+// Work of this module goes to the threadpool's crypto queue, which shares the
+// cpu threads unless it is given threads of its own.
+static int QueueCryptoWork(Environment* env,
+                           uv_work_t* req,
+                           uv_work_cb work_cb,
+                           uv_after_work_cb after_work_cb) {
+  return uv_queue_work_ex(env->event_loop(),
+                          req,
+                          work_cb,
+                          after_work_cb,
+                          UV_THREADPOOL_CRYPTO,
+                          UV_PRIORITY_NORMAL);
+}
+
+
 static void crypto_threadid_cb(CRYPTO_THREADID* tid) {
   static_assert(sizeof(uv_thread_t) <= sizeof(void*),  // NOLINT(runtime/sizeof)
                 "uv_thread_t does not fit in a pointer");
@@ -299,9 +319,17 @@ void SecureContext::Initialize(Environment* env, Local<Object> target) {
   env->SetProtoMethod(t, "getTicketKeys", SecureContext::GetTicketKeys);
   env->SetProtoMethod(t, "setTicketKeys", SecureContext::SetTicketKeys);
   env->SetProtoMethod(t, "setFreeListLength", SecureContext::SetFreeListLength);
+#ifndef OPENSSL_NO_ENGINE
+  env->SetProtoMethod(t, "setEngine", SecureContext::SetEngine);
+  env->SetProtoMethod(t, "getEngineStats", SecureContext::GetEngineStats);
+#endif  // !OPENSSL_NO_ENGINE
   env->SetProtoMethod(t,
                       "enableTicketKeyCallback",
                       SecureContext::EnableTicketKeyCallback);
+  env->SetProtoMethod(t, "rotateTicketKeys", SecureContext::RotateTicketKeys);
+  env->SetProtoMethod(t,
+                      "setStapledOCSPResponse",
+                      SecureContext::SetStapledOCSPResponse);
   env->SetProtoMethod(t, "getCertificate", SecureContext::GetCertificate<true>);
   env->SetProtoMethod(t, "getIssuer", SecureContext::GetCertificate<false>);
 
@@ -479,6 +507,11 @@ void SecureContext::SetKey(const FunctionCallbackInfo<Value>& args) {
       return env->ThrowError("SSL_CTX_use_PrivateKey");
     return ThrowCryptoError(env, err);
   }
+
+#ifndef OPENSSL_NO_ENGINE
+  if (sc->engine_binding_ != nullptr)
+    sc->engine_binding_->Bind(SSL_CTX_get0_privatekey(sc->ctx_));
+#endif  // !OPENSSL_NO_ENGINE
 }
 
 
@@ -744,36 +777,115 @@ void SecureContext::AddCRL(const FunctionCallbackInfo<Value>& args) {
 
 
 
-void SecureContext::AddRootCerts(const FunctionCallbackInfo<Value>& args) {
-  SecureContext* sc = Unwrap<SecureContext>(args.Holder());
-  ClearErrorOnReturn clear_error_on_return;
-  (void) &clear_error_on_return;  // Silence compiler warning.
+// Parsing the root certificates is costly, and most contexts that use them
+// never verify a peer, so it is only done when the first certificate is
+// looked up.  The store is shared by the instances of the process, which can
+// run on different threads.
+static void InitRootCertStore() {
+  root_cert_store = X509_STORE_new();
 
-  CHECK_EQ(sc->ca_store_, nullptr);
+  for (size_t i = 0; i < arraysize(root_certs); i++) {
+    BIO* bp = NodeBIO::NewFixed(root_certs[i], strlen(root_certs[i]));
+    if (bp == nullptr)
+      break;
+
+    X509 *x509 = PEM_read_bio_X509(bp, nullptr, CryptoPemCallback, nullptr);
+    BIO_free_all(bp);
+    if (x509 == nullptr)
+      break;
 
-  if (!root_cert_store) {
-    root_cert_store = X509_STORE_new();
+    X509_STORE_add_cert(root_cert_store, x509);
+    X509_free(x509);
+  }
+}
 
-    for (size_t i = 0; i < arraysize(root_certs); i++) {
-      BIO* bp = NodeBIO::NewFixed(root_certs[i], strlen(root_certs[i]));
-      if (bp == nullptr) {
-        return;
-      }
 
-      X509 *x509 = PEM_read_bio_X509(bp, nullptr, CryptoPemCallback, nullptr);
-      if (x509 == nullptr) {
-        BIO_free_all(bp);
-        return;
-      }
+static X509_STORE* GetRootCertStore() {
+  uv_once(&root_cert_store_once, InitRootCertStore);
+  return root_cert_store;
+}
 
-      X509_STORE_add_cert(root_cert_store, x509);
 
-      BIO_free_all(bp);
-      X509_free(x509);
+// Every context that uses the root certificates has a store of its own that
+// looks them up in the shared root store, so that the CRLs and certificates
+// that are added to a context don't leak into the other ones.  Found
+// certificates are added to the context's store, which OpenSSL searches
+// first.
+static int RootCertLookup(X509_LOOKUP* lookup,
+                          int type,
+                          X509_NAME* name,
+                          X509_OBJECT* ret) {
+  if (type != X509_LU_X509)
+    return X509_LU_FAIL;
+
+  X509_STORE* store = GetRootCertStore();
+  X509_OBJECT* found = nullptr;
+
+  // The lookup sorts the objects, hence the write lock.
+  CRYPTO_w_lock(CRYPTO_LOCK_X509_STORE);
+  int idx = X509_OBJECT_idx_by_subject(store->objs, type, name);
+  std::vector<X509*> certs;
+  if (idx >= 0) {
+    found = sk_X509_OBJECT_value(store->objs, idx);
+    // Certificates that share a subject are next to each other.
+    for (int i = idx; i < sk_X509_OBJECT_num(store->objs); i++) {
+      X509_OBJECT* obj = sk_X509_OBJECT_value(store->objs, i);
+      if (obj->type != type ||
+          X509_NAME_cmp(X509_get_subject_name(obj->data.x509), name) != 0) {
+        break;
+      }
+      certs.push_back(obj->data.x509);
     }
   }
+  CRYPTO_w_unlock(CRYPTO_LOCK_X509_STORE);
+
+  if (found == nullptr)
+    return X509_LU_FAIL;
+
+  // A certificate that is already in the store is not an error here.
+  ERR_set_mark();
+  for (X509* cert : certs)
+    X509_STORE_add_cert(lookup->store_ctx, cert);
+  ERR_pop_to_mark();
+
+  // The root store lives as long as the process, the reference is taken by
+  // the caller.
+  ret->type = found->type;
+  ret->data.x509 = found->data.x509;
+  return 1;
+}
+
+
+static X509_LOOKUP_METHOD root_cert_lookup_method = {
+  "node root certificates",
+  nullptr,  // new_item
+  nullptr,  // free
+  nullptr,  // init
+  nullptr,  // shutdown
+  nullptr,  // ctrl
+  RootCertLookup,
+  nullptr,  // get_by_issuer_serial
+  nullptr,  // get_by_fingerprint
+  nullptr   // get_by_alias
+};
+
+
+void SecureContext::AddRootCerts(const FunctionCallbackInfo<Value>& args) {
+  SecureContext* sc = Unwrap<SecureContext>(args.Holder());
+  ClearErrorOnReturn clear_error_on_return;
+  (void) &clear_error_on_return;  // Silence compiler warning.
+
+  CHECK_EQ(sc->ca_store_, nullptr);
+
+  X509_STORE* store = X509_STORE_new();
+  if (store == nullptr)
+    return;
+  if (X509_STORE_add_lookup(store, &root_cert_lookup_method) == nullptr) {
+    X509_STORE_free(store);
+    return;
+  }
 
-  sc->ca_store_ = root_cert_store;
+  sc->ca_store_ = store;
   SSL_CTX_set_cert_store(sc->ctx_, sc->ca_store_);
 }
 
@@ -993,6 +1105,10 @@ void SecureContext::LoadPKCS12(const FunctionCallbackInfo<Value>& args) {
       X509_STORE_add_cert(sc->ca_store_, ca);
       SSL_CTX_add_client_CA(sc->ctx_, ca);
     }
+#ifndef OPENSSL_NO_ENGINE
+    if (sc->engine_binding_ != nullptr)
+      sc->engine_binding_->Bind(SSL_CTX_get0_privatekey(sc->ctx_));
+#endif  // !OPENSSL_NO_ENGINE
     ret = true;
   }
 
@@ -1021,7 +1137,9 @@ void SecureContext::GetTicketKeys(const FunctionCallbackInfo<Value>& args) {
   SecureContext* wrap = Unwrap<SecureContext>(args.Holder());
 
   Local<Object> buff = Buffer::New(wrap->env(), 48).ToLocalChecked();
-  if (SSL_CTX_get_tlsext_ticket_keys(wrap->ctx_,
+  if (wrap->rotating_ticket_keys_) {
+    memcpy(Buffer::Data(buff), wrap->ticket_keys_, kTicketKeysLength);
+  } else if (SSL_CTX_get_tlsext_ticket_keys(wrap->ctx_,
                                      Buffer::Data(buff),
                                      Buffer::Length(buff)) != 1) {
     return wrap->env()->ThrowError("Failed to fetch tls ticket keys");
@@ -1053,11 +1171,98 @@ void SecureContext::SetTicketKeys(const FunctionCallbackInfo<Value>& args) {
     return env->ThrowError("Failed to fetch tls ticket keys");
   }
 
+  if (wrap->rotating_ticket_keys_)
+    memcpy(wrap->ticket_keys_, Buffer::Data(args[0]), kTicketKeysLength);
+
+  args.GetReturnValue().Set(true);
+#endif  // !def(OPENSSL_NO_TLSEXT) && def(SSL_CTX_get_tlsext_ticket_keys)
+}
+
+
+void SecureContext::RotateTicketKeys(const FunctionCallbackInfo<Value>& args) {
+#if !defined(OPENSSL_NO_TLSEXT) && defined(SSL_CTX_get_tlsext_ticket_keys)
+  SecureContext* wrap = Unwrap<SecureContext>(args.Holder());
+  Environment* env = wrap->env();
+
+  THROW_AND_RETURN_IF_NOT_BUFFER(args[0], "Ticket keys");
+
+  if (Buffer::Length(args[0]) != kTicketKeysLength) {
+    return env->ThrowTypeError("Ticket keys length must be 48 bytes");
+  }
+
+  if (wrap->rotating_ticket_keys_) {
+    memcpy(wrap->previous_ticket_keys_,
+           wrap->ticket_keys_,
+           kTicketKeysLength);
+  } else if (SSL_CTX_get_tlsext_ticket_keys(wrap->ctx_,
+                                            wrap->previous_ticket_keys_,
+                                            kTicketKeysLength) != 1) {
+    return env->ThrowError("Failed to fetch tls ticket keys");
+  }
+
+  memcpy(wrap->ticket_keys_, Buffer::Data(args[0]), kTicketKeysLength);
+  wrap->rotating_ticket_keys_ = true;
+  SSL_CTX_set_tlsext_ticket_key_cb(wrap->ctx_, RotatingTicketKeyCallback);
+
   args.GetReturnValue().Set(true);
 #endif  // !def(OPENSSL_NO_TLSEXT) && def(SSL_CTX_get_tlsext_ticket_keys)
 }
 
 
+// setStapledOCSPResponse(response, maxAge) staples `response` to the
+// handshakes of the clients that request the certificate status, for
+// `maxAge` milliseconds.  `null` removes the response.
+void SecureContext::SetStapledOCSPResponse(
+    const FunctionCallbackInfo<Value>& args) {
+  SecureContext* wrap = Unwrap<SecureContext>(args.Holder());
+  Environment* env = wrap->env();
+
+  if (args[0]->IsNull()) {
+    free(wrap->stapled_response_);
+    wrap->stapled_response_ = nullptr;
+    wrap->stapled_response_len_ = 0;
+    return;
+  }
+
+  THROW_AND_RETURN_IF_NOT_BUFFER(args[0], "OCSP response");
+  if (!args[1]->IsNumber() || !(args[1]->NumberValue() > 0))
+    return env->ThrowTypeError("maxAge must be a positive number");
+
+  size_t len = Buffer::Length(args[0]);
+  unsigned char* data = static_cast<unsigned char*>(malloc(len));
+  if (data == nullptr && len > 0)
+    return env->ThrowError("Out of memory");
+  memcpy(data, Buffer::Data(args[0]), len);
+
+  free(wrap->stapled_response_);
+  wrap->stapled_response_ = data;
+  wrap->stapled_response_len_ = len;
+  wrap->stapled_response_expiry_ =
+      uv_now(env->event_loop()) + static_cast<uint64_t>(args[1]->NumberValue());
+}
+
+
+bool SecureContext::CopyStapledOCSPResponse(unsigned char** data,
+                                            size_t* len) {
+  if (stapled_response_ == nullptr)
+    return false;
+
+  if (uv_now(env()->event_loop()) >= stapled_response_expiry_) {
+    free(stapled_response_);
+    stapled_response_ = nullptr;
+    stapled_response_len_ = 0;
+    return false;
+  }
+
+  *data = static_cast<unsigned char*>(malloc(stapled_response_len_));
+  if (*data == nullptr)
+    return false;
+  memcpy(*data, stapled_response_, stapled_response_len_);
+  *len = stapled_response_len_;
+  return true;
+}
+
+
 void SecureContext::SetFreeListLength(const FunctionCallbackInfo<Value>& args) {
   SecureContext* wrap = Unwrap<SecureContext>(args.Holder());
 
@@ -1065,6 +1270,199 @@ void SecureContext::SetFreeListLength(const FunctionCallbackInfo<Value>& args) {
 }
 
 
+#ifndef OPENSSL_NO_ENGINE
+// Returns a structural reference to the engine with the given id, which is
+// loaded as a shared library if it isn't built in, or throws and returns
+// nullptr.
+static ENGINE* LoadEngine(Environment* env, const char* engine_id) {
+  ENGINE* engine = ENGINE_by_id(engine_id);
+
+  // Engine not found, try loading dynamically
+  if (engine == nullptr) {
+    engine = ENGINE_by_id("dynamic");
+    if (engine != nullptr) {
+      if (!ENGINE_ctrl_cmd_string(engine, "SO_PATH", engine_id, 0) ||
+          !ENGINE_ctrl_cmd_string(engine, "LOAD", nullptr, 0)) {
+        ENGINE_free(engine);
+        engine = nullptr;
+      }
+    }
+  }
+
+  if (engine == nullptr) {
+    int err = ERR_get_error();
+    if (err == 0) {
+      char tmp[1024];
+      snprintf(tmp, sizeof(tmp), "Engine \"%s\" was not found", engine_id);
+      env->ThrowError(tmp);
+    } else {
+      ThrowCryptoError(env, err);
+    }
+  }
+
+  return engine;
+}
+
+
+EngineBinding::EngineBinding(ENGINE* engine)
+    : engine_(engine),
+      engine_rsa_(ENGINE_get_RSA(engine)),
+      rsa_(*engine_rsa_),
+      refs_(1),
+      private_encrypts_(0),
+      private_decrypts_(0),
+      signs_(0) {
+  rsa_.app_data = reinterpret_cast<char*>(this);
+  rsa_.init = Init;
+  rsa_.finish = Finish;
+  if (engine_rsa_->rsa_priv_enc != nullptr)
+    rsa_.rsa_priv_enc = PrivateEncrypt;
+  if (engine_rsa_->rsa_priv_dec != nullptr)
+    rsa_.rsa_priv_dec = PrivateDecrypt;
+  if (engine_rsa_->rsa_sign != nullptr)
+    rsa_.rsa_sign = Sign;
+}
+
+
+EngineBinding::~EngineBinding() {
+  ENGINE_finish(engine_);
+}
+
+
+void EngineBinding::Bind(EVP_PKEY* pkey) {
+  if (pkey == nullptr || EVP_PKEY_id(pkey) != EVP_PKEY_RSA)
+    return;
+  // The key is shared with the SSL_CTX, it switches over in place.
+  RSA* rsa = EVP_PKEY_get1_RSA(pkey);
+  RSA_set_method(rsa, &rsa_);
+  RSA_free(rsa);
+}
+
+
+Local<Object> EngineBinding::Stats(Environment* env) const {
+  Isolate* isolate = env->isolate();
+  Local<Object> stats = Object::New(isolate);
+  stats->Set(FIXED_ONE_BYTE_STRING(isolate, "engine"),
+             OneByteString(isolate, ENGINE_get_id(engine_)));
+  stats->Set(FIXED_ONE_BYTE_STRING(isolate, "rsaPrivateEncrypt"),
+             Number::New(isolate, private_encrypts_.load()));
+  stats->Set(FIXED_ONE_BYTE_STRING(isolate, "rsaPrivateDecrypt"),
+             Number::New(isolate, private_decrypts_.load()));
+  stats->Set(FIXED_ONE_BYTE_STRING(isolate, "rsaSign"),
+             Number::New(isolate, signs_.load()));
+  return stats;
+}
+
+
+EngineBinding* EngineBinding::From(const RSA* rsa) {
+  return reinterpret_cast<EngineBinding*>(RSA_get_method(rsa)->app_data);
+}
+
+
+// The RSA_METHOD callbacks run on whichever thread does the handshake, which
+// is a threadpool thread for servers with asyncHandshake.
+int EngineBinding::Init(RSA* rsa) {
+  EngineBinding* binding = From(rsa);
+  binding->Ref();
+  if (binding->engine_rsa_->init == nullptr)
+    return 1;
+  return binding->engine_rsa_->init(rsa);
+}
+
+
+int EngineBinding::Finish(RSA* rsa) {
+  EngineBinding* binding = From(rsa);
+  int r = 1;
+  if (binding->engine_rsa_->finish != nullptr)
+    r = binding->engine_rsa_->finish(rsa);
+  binding->Unref();
+  return r;
+}
+
+
+int EngineBinding::PrivateEncrypt(int flen,
+                                  const unsigned char* from,
+                                  unsigned char* to,
+                                  RSA* rsa,
+                                  int padding) {
+  EngineBinding* binding = From(rsa);
+  binding->private_encrypts_++;
+  return binding->engine_rsa_->rsa_priv_enc(flen, from, to, rsa, padding);
+}
+
+
+int EngineBinding::PrivateDecrypt(int flen,
+                                  const unsigned char* from,
+                                  unsigned char* to,
+                                  RSA* rsa,
+                                  int padding) {
+  EngineBinding* binding = From(rsa);
+  binding->private_decrypts_++;
+  return binding->engine_rsa_->rsa_priv_dec(flen, from, to, rsa, padding);
+}
+
+
+int EngineBinding::Sign(int type,
+                        const unsigned char* m,
+                        unsigned int m_length,
+                        unsigned char* sigret,
+                        unsigned int* siglen,
+                        const RSA* rsa) {
+  EngineBinding* binding = From(rsa);
+  binding->signs_++;
+  return binding->engine_rsa_->rsa_sign(type,
+                                        m,
+                                        m_length,
+                                        sigret,
+                                        siglen,
+                                        rsa);
+}
+
+
+void SecureContext::SetEngine(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  SecureContext* sc = Unwrap<SecureContext>(args.Holder());
+
+  THROW_AND_RETURN_IF_NOT_STRING(args[0], "Engine");
+  if (sc->engine_binding_ != nullptr)
+    return env->ThrowError("The engine is already set");
+  if (SSL_CTX_get0_privatekey(sc->ctx_) != nullptr)
+    return env->ThrowError("The engine must be set before the private key");
+
+  ClearErrorOnReturn clear_error_on_return;
+  (void) &clear_error_on_return;  // Silence compiler warning.
+
+  const node::Utf8Value engine_id(env->isolate(), args[0]);
+  ENGINE* engine = LoadEngine(env, *engine_id);
+  if (engine == nullptr)
+    return;
+
+  // A functional reference keeps the engine initialized while keys use it.
+  int initialized = ENGINE_init(engine);
+  ENGINE_free(engine);
+  if (!initialized)
+    return ThrowCryptoError(env, ERR_get_error(), "ENGINE_init");
+
+  if (ENGINE_get_RSA(engine) == nullptr) {
+    ENGINE_finish(engine);
+    return env->ThrowError("Engine does not implement RSA");
+  }
+
+  sc->engine_binding_ = new EngineBinding(engine);
+}
+
+
+void SecureContext::GetEngineStats(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  SecureContext* sc = Unwrap<SecureContext>(args.Holder());
+
+  if (sc->engine_binding_ == nullptr)
+    return args.GetReturnValue().SetNull();
+  args.GetReturnValue().Set(sc->engine_binding_->Stats(env));
+}
+#endif  // !OPENSSL_NO_ENGINE
+
+
 void SecureContext::EnableTicketKeyCallback(
     const FunctionCallbackInfo<Value>& args) {
   SecureContext* wrap = Unwrap<SecureContext>(args.Holder());
@@ -1152,6 +1550,58 @@ int SecureContext::TicketKeyCallback(SSL* ssl,
 }
 
 
+int SecureContext::RotatingTicketKeyCallback(SSL* ssl,
+                                             unsigned char* name,
+                                             unsigned char* iv,
+                                             EVP_CIPHER_CTX* ectx,
+                                             HMAC_CTX* hctx,
+                                             int enc) {
+  static const int kTicketPartSize = 16;
+
+  SecureContext* sc = static_cast<SecureContext*>(
+      SSL_CTX_get_app_data(ssl->ctx));
+
+  const unsigned char* keys = sc->ticket_keys_;
+  int r = 1;
+
+  if (enc) {
+    memcpy(name, keys, kTicketPartSize);
+    if (RAND_bytes(iv, kTicketPartSize) <= 0)
+      return -1;
+  } else if (memcmp(name, keys, kTicketPartSize) != 0) {
+    // Unknown keys mean a full handshake, tickets that were issued before
+    // the last rotation are accepted but replaced by a fresh one.
+    if (memcmp(name, sc->previous_ticket_keys_, kTicketPartSize) != 0)
+      return 0;
+    keys = sc->previous_ticket_keys_;
+    r = 2;
+  }
+
+  HMAC_Init_ex(hctx,
+               keys + kTicketPartSize,
+               kTicketPartSize,
+               EVP_sha256(),
+               nullptr);
+
+  const unsigned char* aes_key = keys + 2 * kTicketPartSize;
+  if (enc) {
+    EVP_EncryptInit_ex(ectx,
+                       EVP_aes_128_cbc(),
+                       nullptr,
+                       aes_key,
+                       iv);
+  } else {
+    EVP_DecryptInit_ex(ectx,
+                       EVP_aes_128_cbc(),
+                       nullptr,
+                       aes_key,
+                       iv);
+  }
+
+  return r;
+}
+
+
 
 
 void SecureContext::CtxGetter(Local<String> property,
@@ -1272,13 +1722,15 @@ SSL_SESSION* SSLWrap<Base>::GetSessionCallback(SSL* s,
 template <class Base>
 int SSLWrap<Base>::NewSessionCallback(SSL* s, SSL_SESSION* sess) {
   Base* w = static_cast<Base*>(SSL_get_app_data(s));
-  Environment* env = w->ssl_env();
-  HandleScope handle_scope(env->isolate());
-  Context::Scope context_scope(env->context());
 
+  // Checked before entering V8, this may run on the threadpool
   if (!w->session_callbacks_)
     return 0;
 
+  Environment* env = w->ssl_env();
+  HandleScope handle_scope(env->isolate());
+  Context::Scope context_scope(env->context());
+
   // Check if session is small enough to be stored
   int size = i2d_SSL_SESSION(sess, nullptr);
   if (size > SecureContext::kMaxSessionSize)
@@ -1989,6 +2441,14 @@ int SSLWrap<Base>::AdvertiseNextProtoCallback(SSL* s,
                                               unsigned int* len,
                                               void* arg) {
   Base* w = static_cast<Base*>(SSL_get_app_data(s));
+
+  // Offloaded handshakes are only used without NPN protocols
+  if (w->handshake_offloaded_) {
+    *data = reinterpret_cast<const unsigned char*>("");
+    *len = 0;
+    return SSL_TLSEXT_ERR_OK;
+  }
+
   Environment* env = w->env();
   HandleScope handle_scope(env->isolate());
   Context::Scope context_scope(env->context());
@@ -2136,6 +2596,11 @@ int SSLWrap<Base>::SelectALPNCallback(SSL* s,
                                       unsigned int inlen,
                                       void* arg) {
   Base* w = static_cast<Base*>(SSL_get_app_data(s));
+
+  // Offloaded handshakes are only used without ALPN protocols
+  if (w->handshake_offloaded_)
+    return SSL_TLSEXT_ERR_NOACK;
+
   Environment* env = w->env();
   HandleScope handle_scope(env->isolate());
   Context::Scope context_scope(env->context());
@@ -2222,6 +2687,11 @@ void SSLWrap<Base>::SetALPNProtocols(
 template <class Base>
 int SSLWrap<Base>::TLSExtStatusCallback(SSL* s, void* arg) {
   Base* w = static_cast<Base*>(SSL_get_app_data(s));
+
+  // Offloaded handshakes are only used without an OCSP response
+  if (w->handshake_offloaded_)
+    return SSL_TLSEXT_ERR_NOACK;
+
   Environment* env = w->env();
   HandleScope handle_scope(env->isolate());
 
@@ -2245,8 +2715,19 @@ int SSLWrap<Base>::TLSExtStatusCallback(SSL* s, void* arg) {
     return 1;
   } else {
     // Outgoing response
-    if (w->ocsp_response_.IsEmpty())
-      return SSL_TLSEXT_ERR_NOACK;
+    if (w->ocsp_response_.IsEmpty()) {
+      // The response that is cached by the context is stapled without
+      // calling into JS.
+      SecureContext* sc = static_cast<SecureContext*>(
+          SSL_CTX_get_app_data(SSL_get_SSL_CTX(s)));
+      unsigned char* data;
+      size_t len;
+      if (sc == nullptr || !sc->CopyStapledOCSPResponse(&data, &len))
+        return SSL_TLSEXT_ERR_NOACK;
+      if (!SSL_set_tlsext_status_ocsp_resp(s, data, len))
+        free(data);
+      return SSL_TLSEXT_ERR_OK;
+    }
 
     Local<Object> obj = PersistentToLocal(env->isolate(), w->ocsp_response_);
     char* resp = Buffer::Data(obj);
@@ -3118,6 +3599,7 @@ void CipherBase::Initialize(Environment* env, Local<Object> target) {
   env->SetProtoMethod(t, "init", Init);
   env->SetProtoMethod(t, "initiv", InitIv);
   env->SetProtoMethod(t, "update", Update);
+  env->SetProtoMethod(t, "updateAsync", UpdateAsync);
   env->SetProtoMethod(t, "final", Final);
   env->SetProtoMethod(t, "setAutoPadding", SetAutoPadding);
   env->SetProtoMethod(t, "getAuthTag", GetAuthTag);
@@ -3368,7 +3850,8 @@ bool CipherBase::Update(const char* data,
   }
 
   *out_len = len + EVP_CIPHER_CTX_block_size(&ctx_);
-  *out = new unsigned char[*out_len];
+  *out = static_cast<unsigned char*>(malloc(*out_len));
+  CHECK_NE(*out, nullptr);
   return EVP_CipherUpdate(&ctx_,
                           *out,
                           out_len,
@@ -3384,6 +3867,9 @@ void CipherBase::Update(const FunctionCallbackInfo<Value>& args) {
 
   THROW_AND_RETURN_IF_NOT_STRING_OR_BUFFER(args[0], "Cipher data");
 
+  if (cipher->update_pending_)
+    return env->ThrowError("Asynchronous update in progress");
+
   unsigned char* out = nullptr;
   bool r;
   int out_len = 0;
@@ -3401,7 +3887,7 @@ void CipherBase::Update(const FunctionCallbackInfo<Value>& args) {
   }
 
   if (!r) {
-    delete[] out;
+    free(out);
     return ThrowCryptoError(env,
                             ERR_get_error(),
                             "Trying to add data in unsupported state");
@@ -3409,33 +3895,144 @@ void CipherBase::Update(const FunctionCallbackInfo<Value>& args) {
 
   CHECK(out != nullptr || out_len == 0);
   Local<Object> buf =
-      Buffer::Copy(env, reinterpret_cast<char*>(out), out_len).ToLocalChecked();
-  if (out)
-    delete[] out;
+      Buffer::New(env, reinterpret_cast<char*>(out), out_len).ToLocalChecked();
 
   args.GetReturnValue().Set(buf);
 }
 
 
-bool CipherBase::SetAutoPadding(bool auto_padding) {
-  if (!initialised_)
-    return false;
-  return EVP_CIPHER_CTX_set_padding(&ctx_, auto_padding);
-}
+class CipherBase::UpdateRequest : public AsyncWrap {
+ public:
+  UpdateRequest(Environment* env,
+                Local<Object> object,
+                CipherBase* cipher,
+                const char* data,
+                int len)
+      : AsyncWrap(env, object, AsyncWrap::PROVIDER_CRYPTO),
+        cipher_(cipher),
+        data_(data),
+        len_(len),
+        out_(nullptr),
+        out_len_(0),
+        ok_(false),
+        error_(0) {
+    Wrap(object, this);
+  }
 
+  ~UpdateRequest() override {
+    free(out_);
+    persistent().Reset();
+  }
 
-void CipherBase::SetAutoPadding(const FunctionCallbackInfo<Value>& args) {
-  CipherBase* cipher = Unwrap<CipherBase>(args.Holder());
-  cipher->SetAutoPadding(args.Length() < 1 || args[0]->BooleanValue());
-}
+  static void Work(uv_work_t* work_req) {
+    UpdateRequest* req = ContainerOf(&UpdateRequest::work_req_, work_req);
+    req->ok_ = req->cipher_->Update(req->data_,
+                                    req->len_,
+                                    &req->out_,
+                                    &req->out_len_);
+    if (!req->ok_)
+      req->error_ = ERR_get_error();
+    ERR_clear_error();
+  }
 
+  static void After(uv_work_t* work_req, int status) {
+    CHECK_EQ(status, 0);
+    UpdateRequest* req = ContainerOf(&UpdateRequest::work_req_, work_req);
+    Environment* env = req->env();
+    HandleScope handle_scope(env->isolate());
+    Context::Scope context_scope(env->context());
 
-bool CipherBase::Final(unsigned char** out, int *out_len) {
-  if (!initialised_)
-    return false;
+    CipherBase* cipher = req->cipher_;
+    cipher->update_pending_ = false;
+    cipher->MakeWeak<CipherBase>(cipher);
 
-  *out = new unsigned char[EVP_CIPHER_CTX_block_size(&ctx_)];
-  int r = EVP_CipherFinal_ex(&ctx_, *out, out_len);
+    Local<Value> argv[2];
+    if (req->ok_) {
+      argv[0] = Null(env->isolate());
+      argv[1] = Buffer::New(env,
+                            reinterpret_cast<char*>(req->out_),
+                            req->out_len_).ToLocalChecked();
+      req->out_ = nullptr;
+    } else {
+      char errmsg[128] = "Trying to add data in unsupported state";
+      if (req->error_ != 0)
+        ERR_error_string_n(req->error_, errmsg, sizeof(errmsg));
+      argv[0] = Exception::Error(OneByteString(env->isolate(), errmsg));
+      argv[1] = Undefined(env->isolate());
+    }
+    req->MakeCallback(env->ondone_string(), arraysize(argv), argv);
+    delete req;
+  }
+
+  size_t self_size() const override { return sizeof(*this); }
+
+  uv_work_t work_req_;
+
+ private:
+  CipherBase* const cipher_;
+  const char* const data_;
+  const int len_;
+  unsigned char* out_;
+  int out_len_;
+  bool ok_;
+  unsigned long error_;
+};
+
+
+void CipherBase::UpdateAsync(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+
+  CipherBase* cipher = Unwrap<CipherBase>(args.Holder());
+
+  THROW_AND_RETURN_IF_NOT_BUFFER(args[0], "Cipher data");
+  CHECK(args[1]->IsFunction());
+
+  if (cipher->update_pending_)
+    return env->ThrowError("Asynchronous update in progress");
+
+  // The request references the data, it must stay alive until it is done
+  Local<Object> obj = env->NewInternalFieldObject();
+  obj->Set(env->buffer_string(), args[0]);
+  obj->Set(env->ondone_string(), args[1]);
+  if (env->in_domain())
+    obj->Set(env->domain_string(), env->domain_array()->Get(0));
+
+  UpdateRequest* req = new UpdateRequest(env,
+                                         obj,
+                                         cipher,
+                                         Buffer::Data(args[0]),
+                                         Buffer::Length(args[0]));
+
+  // So does the cipher, its context is used by the threadpool
+  cipher->update_pending_ = true;
+  cipher->ClearWeak();
+
+  QueueCryptoWork(env,
+                  &req->work_req_,
+                  UpdateRequest::Work,
+                  UpdateRequest::After);
+}
+
+
+bool CipherBase::SetAutoPadding(bool auto_padding) {
+  if (!initialised_)
+    return false;
+  return EVP_CIPHER_CTX_set_padding(&ctx_, auto_padding);
+}
+
+
+void CipherBase::SetAutoPadding(const FunctionCallbackInfo<Value>& args) {
+  CipherBase* cipher = Unwrap<CipherBase>(args.Holder());
+  cipher->SetAutoPadding(args.Length() < 1 || args[0]->BooleanValue());
+}
+
+
+bool CipherBase::Final(unsigned char** out, int *out_len) {
+  if (!initialised_)
+    return false;
+
+  *out = new unsigned char[EVP_CIPHER_CTX_block_size(&ctx_)];
+  int r = EVP_CipherFinal_ex(&ctx_, *out, out_len);
 
   if (r && kind_ == kCipher) {
     delete[] auth_tag_;
@@ -3463,6 +4060,9 @@ void CipherBase::Final(const FunctionCallbackInfo<Value>& args) {
 
   CipherBase* cipher = Unwrap<CipherBase>(args.Holder());
 
+  if (cipher->update_pending_)
+    return env->ThrowError("Asynchronous update in progress");
+
   unsigned char* out_value = nullptr;
   int out_len = -1;
   Local<Value> outString;
@@ -3493,6 +4093,65 @@ void CipherBase::Final(const FunctionCallbackInfo<Value>& args) {
 }
 
 
+// Digests everything that is read from a StreamBase without passing the data
+// through JavaScript.  `oncomplete` is called with UV_EOF or the read error
+// once the stream has ended.
+template <class Base, bool (Base::*Update)(const char* data, int len)>
+class StreamDigest {
+ public:
+  static void Consume(const FunctionCallbackInfo<Value>& args) {
+    Base* base = Unwrap<Base>(args.Holder());
+    Environment* env = base->env();
+
+    if (args.Length() < 1 || !args[0]->IsExternal())
+      return env->ThrowTypeError("First argument should be a stream");
+
+    StreamBase* stream =
+        static_cast<StreamBase*>(args[0].As<External>()->Value());
+    CHECK_NE(stream, nullptr);
+    if (stream->IsConsumed())
+      return env->ThrowError("Stream is already consumed");
+
+    stream->Consume();
+    stream->set_alloc_cb({ OnAlloc, base });
+    stream->set_read_cb({ OnRead, base });
+
+    // Stay alive until the stream has ended
+    base->ClearWeak();
+
+    int err = stream->ReadStart();
+    args.GetReturnValue().Set(err);
+  }
+
+ private:
+  static void OnAlloc(size_t suggested_size, uv_buf_t* buf, void* ctx) {
+    // Every chunk is digested before the next read
+    Base* base = static_cast<Base*>(ctx);
+    *buf = uv_buf_init(base->env()->shared_read_buffer(),
+                       Environment::kSharedReadBufferSize);
+  }
+
+  static void OnRead(ssize_t nread,
+                     const uv_buf_t* buf,
+                     uv_handle_type pending,
+                     void* ctx) {
+    Base* base = static_cast<Base*>(ctx);
+    if (nread > 0)
+      (base->*Update)(buf->base, nread);
+    if (nread >= 0)
+      return;
+
+    Environment* env = base->env();
+    HandleScope handle_scope(env->isolate());
+    Context::Scope context_scope(env->context());
+
+    base->MakeWeak(base);
+    Local<Value> arg = Integer::New(env->isolate(), nread);
+    MakeCallback(env, base->object(), env->oncomplete_string(), 1, &arg);
+  }
+};
+
+
 void Hmac::Initialize(Environment* env, v8::Local<v8::Object> target) {
   Local<FunctionTemplate> t = env->NewFunctionTemplate(New);
 
@@ -3501,6 +4160,8 @@ void Hmac::Initialize(Environment* env, v8::Local<v8::Object> target) {
   env->SetProtoMethod(t, "init", HmacInit);
   env->SetProtoMethod(t, "update", HmacUpdate);
   env->SetProtoMethod(t, "digest", HmacDigest);
+  env->SetProtoMethod(t, "consume",
+                      StreamDigest<Hmac, &Hmac::HmacUpdate>::Consume);
 
   target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "Hmac"), t->GetFunction());
 }
@@ -3634,6 +4295,8 @@ void Hash::Initialize(Environment* env, v8::Local<v8::Object> target) {
 
   env->SetProtoMethod(t, "update", HashUpdate);
   env->SetProtoMethod(t, "digest", HashDigest);
+  env->SetProtoMethod(t, "consume",
+                      StreamDigest<Hash, &Hash::HashUpdate>::Consume);
 
   target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "Hash"), t->GetFunction());
 }
@@ -3746,6 +4409,115 @@ void Hash::HashDigest(const FunctionCallbackInfo<Value>& args) {
 }
 
 
+// Reads a PKCS#8 or RSA public key, or the public key of an X.509
+// certificate.  Returns nullptr on failure.
+static EVP_PKEY* ReadPublicKey(const char* key_pem, int key_pem_len) {
+  EVP_PKEY* pkey = nullptr;
+  X509* x509 = nullptr;
+
+  BIO* bp = BIO_new_mem_buf(const_cast<char*>(key_pem), key_pem_len);
+  if (bp == nullptr)
+    return nullptr;
+
+  // Check if this is a PKCS#8 or RSA public key before trying as X.509.
+  if (strncmp(key_pem, PUBLIC_KEY_PFX, PUBLIC_KEY_PFX_LEN) == 0) {
+    pkey = PEM_read_bio_PUBKEY(bp, nullptr, CryptoPemCallback, nullptr);
+  } else if (strncmp(key_pem, PUBRSA_KEY_PFX, PUBRSA_KEY_PFX_LEN) == 0) {
+    RSA* rsa =
+        PEM_read_bio_RSAPublicKey(bp, nullptr, CryptoPemCallback, nullptr);
+    if (rsa) {
+      pkey = EVP_PKEY_new();
+      if (pkey)
+        EVP_PKEY_set1_RSA(pkey, rsa);
+      RSA_free(rsa);
+    }
+  } else {
+    // X.509 fallback
+    x509 = PEM_read_bio_X509(bp, nullptr, CryptoPemCallback, nullptr);
+    if (x509 != nullptr) {
+      pkey = X509_get_pubkey(x509);
+      X509_free(x509);
+    }
+  }
+
+  BIO_free_all(bp);
+  return pkey;
+}
+
+
+// Reads a private key, decrypting it with passphrase if needed.  Returns
+// nullptr on failure.
+static EVP_PKEY* ReadPrivateKey(const char* key_pem,
+                                int key_pem_len,
+                                const char* passphrase) {
+  BIO* bp = BIO_new_mem_buf(const_cast<char*>(key_pem), key_pem_len);
+  if (bp == nullptr)
+    return nullptr;
+
+  EVP_PKEY* pkey = PEM_read_bio_PrivateKey(bp,
+                                           nullptr,
+                                           CryptoPemCallback,
+                                           const_cast<char*>(passphrase));
+  BIO_free_all(bp);
+  return pkey;
+}
+
+
+void KeyObject::Initialize(Environment* env, Local<Object> target) {
+  Local<FunctionTemplate> t = env->NewFunctionTemplate(New);
+
+  t->InstanceTemplate()->SetInternalFieldCount(1);
+
+  target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "KeyObject"),
+              t->GetFunction());
+  env->set_key_object_constructor_template(t);
+}
+
+
+KeyObject* KeyObject::FromValue(Environment* env, Local<Value> value) {
+  if (!env->key_object_constructor_template()->HasInstance(value))
+    return nullptr;
+  return Unwrap<KeyObject>(value.As<Object>());
+}
+
+
+void KeyObject::New(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+
+  THROW_AND_RETURN_IF_NOT_BUFFER(args[1], "Key");
+  const char* key_pem = Buffer::Data(args[1]);
+  int key_pem_len = Buffer::Length(args[1]);
+  bool is_private = args[0]->IsTrue();
+
+  ClearErrorOnReturn clear_error_on_return;
+  (void) &clear_error_on_return;  // Silence compiler warning.
+
+  EVP_PKEY* pkey;
+  if (is_private) {
+    node::Utf8Value passphrase(env->isolate(), args[2]);
+    pkey = ReadPrivateKey(key_pem,
+                          key_pem_len,
+                          args[2]->IsNull() ? nullptr : *passphrase);
+    // See Sign::SignFinal() for why the error stack is checked, too.
+    if (pkey != nullptr && ERR_peek_error() != 0) {
+      EVP_PKEY_free(pkey);
+      pkey = nullptr;
+    }
+  } else {
+    pkey = ReadPublicKey(key_pem, key_pem_len);
+  }
+
+  if (pkey == nullptr) {
+    return ThrowCryptoError(env,
+                            ERR_get_error(),
+                            is_private ? "PEM_read_bio_PrivateKey failed" :
+                                         "PEM_read_bio_PUBKEY failed");
+  }
+
+  new KeyObject(env, args.This(), pkey, is_private);
+}
+
+
 void SignBase::CheckThrow(SignBase::Error error) {
   HandleScope scope(env()->isolate());
 
@@ -3868,31 +4640,15 @@ void Sign::SignUpdate(const FunctionCallbackInfo<Value>& args) {
 }
 
 
-SignBase::Error Sign::SignFinal(const char* key_pem,
-                                int key_pem_len,
-                                const char* passphrase,
+SignBase::Error Sign::SignFinal(EVP_PKEY* pkey,
                                 unsigned char** sig,
                                 unsigned int *sig_len) {
   if (!initialised_)
     return kSignNotInitialised;
 
-  BIO* bp = nullptr;
-  EVP_PKEY* pkey = nullptr;
   bool fatal = true;
 
-  bp = BIO_new_mem_buf(const_cast<char*>(key_pem), key_pem_len);
-  if (bp == nullptr)
-    goto exit;
-
-  pkey = PEM_read_bio_PrivateKey(bp,
-                                 nullptr,
-                                 CryptoPemCallback,
-                                 const_cast<char*>(passphrase));
-
-  // Errors might be injected into OpenSSL's error stack
-  // without `pkey` being set to nullptr;
-  // cf. the test of `test_bad_rsa_privkey.pem` for an example.
-  if (pkey == nullptr || 0 != ERR_peek_error())
+  if (pkey == nullptr)
     goto exit;
 
 #ifdef NODE_FIPS_MODE
@@ -3924,11 +4680,6 @@ SignBase::Error Sign::SignFinal(const char* key_pem,
   initialised_ = false;
 
  exit:
-  if (pkey != nullptr)
-    EVP_PKEY_free(pkey);
-  if (bp != nullptr)
-    BIO_free_all(bp);
-
   EVP_MD_CTX_cleanup(&mdctx_);
 
   if (fatal)
@@ -3956,22 +4707,35 @@ void Sign::SignFinal(const FunctionCallbackInfo<Value>& args) {
 
   node::Utf8Value passphrase(env->isolate(), args[2]);
 
-  THROW_AND_RETURN_IF_NOT_BUFFER(args[0], "Data");
-  size_t buf_len = Buffer::Length(args[0]);
-  char* buf = Buffer::Data(args[0]);
+  ClearErrorOnReturn clear_error_on_return;
+  (void) &clear_error_on_return;  // Silence compiler warning.
+
+  EVP_PKEY* pkey;
+  KeyObject* key = KeyObject::FromValue(env, args[0]);
+  if (key != nullptr) {
+    pkey = key->GetKey();
+  } else {
+    THROW_AND_RETURN_IF_NOT_BUFFER(args[0], "Data");
+    pkey = ReadPrivateKey(
+        Buffer::Data(args[0]),
+        Buffer::Length(args[0]),
+        len >= 3 && !args[2]->IsNull() ? *passphrase : nullptr);
+
+    // Errors might be injected into OpenSSL's error stack
+    // without `pkey` being set to nullptr;
+    // cf. the test of `test_bad_rsa_privkey.pem` for an example.
+    if (pkey != nullptr && 0 != ERR_peek_error()) {
+      EVP_PKEY_free(pkey);
+      pkey = nullptr;
+    }
+  }
 
   md_len = 8192;  // Maximum key size is 8192 bits
   md_value = new unsigned char[md_len];
 
-  ClearErrorOnReturn clear_error_on_return;
-  (void) &clear_error_on_return;  // Silence compiler warning.
-
-  Error err = sign->SignFinal(
-      buf,
-      buf_len,
-      len >= 3 && !args[2]->IsNull() ? *passphrase : nullptr,
-      &md_value,
-      &md_len);
+  Error err = sign->SignFinal(pkey, &md_value, &md_len);
+  if (pkey != nullptr)
+    EVP_PKEY_free(pkey);
   if (err != kSignOk) {
     delete[] md_value;
     md_value = nullptr;
@@ -4073,70 +4837,22 @@ void Verify::VerifyUpdate(const FunctionCallbackInfo<Value>& args) {
 }
 
 
-SignBase::Error Verify::VerifyFinal(const char* key_pem,
-                                    int key_pem_len,
+SignBase::Error Verify::VerifyFinal(EVP_PKEY* pkey,
                                     const char* sig,
                                     int siglen,
                                     bool* verify_result) {
   if (!initialised_)
     return kSignNotInitialised;
 
-  ClearErrorOnReturn clear_error_on_return;
-  (void) &clear_error_on_return;  // Silence compiler warning.
-
-  EVP_PKEY* pkey = nullptr;
-  BIO* bp = nullptr;
-  X509* x509 = nullptr;
-  bool fatal = true;
+  bool fatal = pkey == nullptr;
   int r = 0;
-
-  bp = BIO_new_mem_buf(const_cast<char*>(key_pem), key_pem_len);
-  if (bp == nullptr)
-    goto exit;
-
-  // Check if this is a PKCS#8 or RSA public key before trying as X.509.
-  // Split this out into a separate function once we have more than one
-  // consumer of public keys.
-  if (strncmp(key_pem, PUBLIC_KEY_PFX, PUBLIC_KEY_PFX_LEN) == 0) {
-    pkey = PEM_read_bio_PUBKEY(bp, nullptr, CryptoPemCallback, nullptr);
-    if (pkey == nullptr)
-      goto exit;
-  } else if (strncmp(key_pem, PUBRSA_KEY_PFX, PUBRSA_KEY_PFX_LEN) == 0) {
-    RSA* rsa =
-        PEM_read_bio_RSAPublicKey(bp, nullptr, CryptoPemCallback, nullptr);
-    if (rsa) {
-      pkey = EVP_PKEY_new();
-      if (pkey)
-        EVP_PKEY_set1_RSA(pkey, rsa);
-      RSA_free(rsa);
-    }
-    if (pkey == nullptr)
-      goto exit;
-  } else {
-    // X.509 fallback
-    x509 = PEM_read_bio_X509(bp, nullptr, CryptoPemCallback, nullptr);
-    if (x509 == nullptr)
-      goto exit;
-
-    pkey = X509_get_pubkey(x509);
-    if (pkey == nullptr)
-      goto exit;
+  if (!fatal) {
+    r = EVP_VerifyFinal(&mdctx_,
+                        reinterpret_cast<const unsigned char*>(sig),
+                        siglen,
+                        pkey);
   }
 
-  fatal = false;
-  r = EVP_VerifyFinal(&mdctx_,
-                      reinterpret_cast<const unsigned char*>(sig),
-                      siglen,
-                      pkey);
-
- exit:
-  if (pkey != nullptr)
-    EVP_PKEY_free(pkey);
-  if (bp != nullptr)
-    BIO_free_all(bp);
-  if (x509 != nullptr)
-    X509_free(x509);
-
   EVP_MD_CTX_cleanup(&mdctx_);
   initialised_ = false;
 
@@ -4153,9 +4869,9 @@ void Verify::VerifyFinal(const FunctionCallbackInfo<Value>& args) {
 
   Verify* verify = Unwrap<Verify>(args.Holder());
 
-  THROW_AND_RETURN_IF_NOT_BUFFER(args[0], "Key");
-  char* kbuf = Buffer::Data(args[0]);
-  ssize_t klen = Buffer::Length(args[0]);
+  KeyObject* key = KeyObject::FromValue(env, args[0]);
+  if (key == nullptr)
+    THROW_AND_RETURN_IF_NOT_BUFFER(args[0], "Key");
 
   THROW_AND_RETURN_IF_NOT_STRING_OR_BUFFER(args[1], "Hash");
 
@@ -4182,8 +4898,19 @@ void Verify::VerifyFinal(const FunctionCallbackInfo<Value>& args) {
     hbuf = Buffer::Data(args[1]);
   }
 
+  ClearErrorOnReturn clear_error_on_return;
+  (void) &clear_error_on_return;  // Silence compiler warning.
+
+  EVP_PKEY* pkey;
+  if (key != nullptr)
+    pkey = key->GetKey();
+  else
+    pkey = ReadPublicKey(Buffer::Data(args[0]), Buffer::Length(args[0]));
+
   bool verify_result;
-  Error err = verify->VerifyFinal(kbuf, klen, hbuf, hlen, &verify_result);
+  Error err = verify->VerifyFinal(pkey, hbuf, hlen, &verify_result);
+  if (pkey != nullptr)
+    EVP_PKEY_free(pkey);
   if (args[1]->IsString())
     delete[] hbuf;
   if (err != kSignOk)
@@ -4192,63 +4919,206 @@ void Verify::VerifyFinal(const FunctionCallbackInfo<Value>& args) {
 }
 
 
+// Verifies the signatures of many messages against the same public key.  A
+// single EVP_MD_CTX is reused for all messages of a slice, and the slices of
+// asynchronous requests are verified in parallel by the threadpool.
+class VerifyBatchRequest : public AsyncWrap {
+ public:
+  struct Item {
+    const unsigned char* data;
+    size_t data_len;
+    const unsigned char* sig;
+    unsigned int sig_len;
+  };
+
+  VerifyBatchRequest(Environment* env,
+                     Local<Object> object,
+                     const EVP_MD* md,
+                     EVP_PKEY* pkey,
+                     size_t count)
+      : AsyncWrap(env, object, AsyncWrap::PROVIDER_CRYPTO),
+        md_(md),
+        pkey_(pkey),
+        items_(new Item[count]),
+        results_(new bool[count]),
+        count_(count),
+        pending_(0) {
+    Wrap(object, this);
+  }
+
+  ~VerifyBatchRequest() override {
+    EVP_PKEY_free(pkey_);
+    delete[] items_;
+    delete[] results_;
+    persistent().Reset();
+  }
+
+  inline Item* items() const {
+    return items_;
+  }
+
+  void VerifyRange(size_t start, size_t end) {
+    EVP_MD_CTX ctx;
+    EVP_MD_CTX_init(&ctx);
+    for (size_t i = start; i < end; i++) {
+      const Item& item = items_[i];
+      results_[i] = EVP_VerifyInit_ex(&ctx, md_, nullptr) &&
+                    EVP_VerifyUpdate(&ctx, item.data, item.data_len) &&
+                    EVP_VerifyFinal(&ctx, item.sig, item.sig_len, pkey_) == 1;
+    }
+    EVP_MD_CTX_cleanup(&ctx);
+    ERR_clear_error();
+  }
+
+  Local<Array> Results() {
+    Local<Array> results = Array::New(env()->isolate(), count_);
+    for (size_t i = 0; i < count_; i++)
+      results->Set(i, Boolean::New(env()->isolate(), results_[i]));
+    return results;
+  }
+
+  void Queue() {
+    size_t slices = count_ / kMinSliceSize;
+    if (slices < 1)
+      slices = 1;
+    if (slices > kMaxSlices)
+      slices = kMaxSlices;
+    size_t slice_size = (count_ + slices - 1) / slices;
+
+    for (size_t i = 0; i < slices; i++) {
+      Slice* slice = &slices_[i];
+      slice->req = this;
+      slice->start = i * slice_size;
+      slice->end = slice->start + slice_size;
+      if (slice->end > count_)
+        slice->end = count_;
+      pending_++;
+      QueueCryptoWork(env(), &slice->work_req, Work, After);
+    }
+  }
+
+  size_t self_size() const override { return sizeof(*this); }
+
+ private:
+  static const size_t kMaxSlices = 4;
+  static const size_t kMinSliceSize = 16;
+
+  struct Slice {
+    uv_work_t work_req;
+    VerifyBatchRequest* req;
+    size_t start;
+    size_t end;
+  };
+
+  static void Work(uv_work_t* work_req) {
+    Slice* slice = ContainerOf(&Slice::work_req, work_req);
+    slice->req->VerifyRange(slice->start, slice->end);
+  }
+
+  static void After(uv_work_t* work_req, int status) {
+    CHECK_EQ(status, 0);
+    Slice* slice = ContainerOf(&Slice::work_req, work_req);
+    VerifyBatchRequest* req = slice->req;
+    if (--req->pending_ > 0)
+      return;
+
+    Environment* env = req->env();
+    HandleScope handle_scope(env->isolate());
+    Context::Scope context_scope(env->context());
+    Local<Value> argv[] = { Null(env->isolate()), req->Results() };
+    req->MakeCallback(env->ondone_string(), arraysize(argv), argv);
+    delete req;
+  }
+
+  const EVP_MD* md_;
+  EVP_PKEY* const pkey_;
+  Item* const items_;
+  bool* const results_;
+  const size_t count_;
+  size_t pending_;
+  Slice slices_[kMaxSlices];
+};
+
+
+void VerifyBatch(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+
+  THROW_AND_RETURN_IF_NOT_STRING(args[0], "Digest");
+  KeyObject* key = KeyObject::FromValue(env, args[1]);
+  if (key == nullptr)
+    THROW_AND_RETURN_IF_NOT_BUFFER(args[1], "Key");
+  if (!args[2]->IsArray())
+    return env->ThrowTypeError("Items must be an array");
+
+  const node::Utf8Value digest_name(env->isolate(), args[0]);
+  const EVP_MD* md = EVP_get_digestbyname(*digest_name);
+  if (md == nullptr)
+    return env->ThrowError("Unknown message digest");
+
+  ClearErrorOnReturn clear_error_on_return;
+  (void) &clear_error_on_return;  // Silence compiler warning.
+
+  EVP_PKEY* pkey;
+  if (key != nullptr)
+    pkey = key->GetKey();
+  else
+    pkey = ReadPublicKey(Buffer::Data(args[1]), Buffer::Length(args[1]));
+  if (pkey == nullptr) {
+    return ThrowCryptoError(env,
+                            ERR_get_error(),
+                            "PEM_read_bio_PUBKEY failed");
+  }
+
+  // Messages and signatures alternate in the items array
+  Local<Array> items = args[2].As<Array>();
+  size_t count = items->Length() / 2;
+  Local<Object> obj = env->NewInternalFieldObject();
+  VerifyBatchRequest* req =
+      new VerifyBatchRequest(env, obj, md, pkey, count);
+
+  for (size_t i = 0; i < count; i++) {
+    Local<Value> data = items->Get(2 * i);
+    Local<Value> sig = items->Get(2 * i + 1);
+    if (!Buffer::HasInstance(data) || !Buffer::HasInstance(sig)) {
+      delete req;
+      return env->ThrowTypeError("Messages and signatures must be buffers");
+    }
+
+    VerifyBatchRequest::Item* item = &req->items()[i];
+    item->data = reinterpret_cast<unsigned char*>(Buffer::Data(data));
+    item->data_len = Buffer::Length(data);
+    item->sig = reinterpret_cast<unsigned char*>(Buffer::Data(sig));
+    item->sig_len = Buffer::Length(sig);
+  }
+
+  if (args[3]->IsFunction()) {
+    // The items reference the buffers, keep them alive
+    obj->Set(env->buffer_string(), items);
+    obj->Set(env->ondone_string(), args[3]);
+
+    if (env->in_domain())
+      obj->Set(env->domain_string(), env->domain_array()->Get(0));
+    req->Queue();
+  } else {
+    req->VerifyRange(0, count);
+    args.GetReturnValue().Set(req->Results());
+    delete req;
+  }
+}
+
+
 template <PublicKeyCipher::Operation operation,
           PublicKeyCipher::EVP_PKEY_cipher_init_t EVP_PKEY_cipher_init,
           PublicKeyCipher::EVP_PKEY_cipher_t EVP_PKEY_cipher>
-bool PublicKeyCipher::Cipher(const char* key_pem,
-                             int key_pem_len,
-                             const char* passphrase,
+bool PublicKeyCipher::Cipher(EVP_PKEY* pkey,
                              int padding,
                              const unsigned char* data,
                              int len,
                              unsigned char** out,
                              size_t* out_len) {
-  EVP_PKEY* pkey = nullptr;
   EVP_PKEY_CTX* ctx = nullptr;
-  BIO* bp = nullptr;
-  X509* x509 = nullptr;
   bool fatal = true;
 
-  bp = BIO_new_mem_buf(const_cast<char*>(key_pem), key_pem_len);
-  if (bp == nullptr)
-    goto exit;
-
-  // Check if this is a PKCS#8 or RSA public key before trying as X.509 and
-  // private key.
-  if (operation == kPublic &&
-      strncmp(key_pem, PUBLIC_KEY_PFX, PUBLIC_KEY_PFX_LEN) == 0) {
-    pkey = PEM_read_bio_PUBKEY(bp, nullptr, nullptr, nullptr);
-    if (pkey == nullptr)
-      goto exit;
-  } else if (operation == kPublic &&
-             strncmp(key_pem, PUBRSA_KEY_PFX, PUBRSA_KEY_PFX_LEN) == 0) {
-    RSA* rsa = PEM_read_bio_RSAPublicKey(bp, nullptr, nullptr, nullptr);
-    if (rsa) {
-      pkey = EVP_PKEY_new();
-      if (pkey)
-        EVP_PKEY_set1_RSA(pkey, rsa);
-      RSA_free(rsa);
-    }
-    if (pkey == nullptr)
-      goto exit;
-  } else if (operation == kPublic &&
-             strncmp(key_pem, CERTIFICATE_PFX, CERTIFICATE_PFX_LEN) == 0) {
-    x509 = PEM_read_bio_X509(bp, nullptr, CryptoPemCallback, nullptr);
-    if (x509 == nullptr)
-      goto exit;
-
-    pkey = X509_get_pubkey(x509);
-    if (pkey == nullptr)
-      goto exit;
-  } else {
-    pkey = PEM_read_bio_PrivateKey(bp,
-                                   nullptr,
-                                   CryptoPemCallback,
-                                   const_cast<char*>(passphrase));
-    if (pkey == nullptr)
-      goto exit;
-  }
-
   ctx = EVP_PKEY_CTX_new(pkey, nullptr);
   if (!ctx)
     goto exit;
@@ -4268,12 +5138,6 @@ bool PublicKeyCipher::Cipher(const char* key_pem,
   fatal = false;
 
  exit:
-  if (x509 != nullptr)
-    X509_free(x509);
-  if (pkey != nullptr)
-    EVP_PKEY_free(pkey);
-  if (bp != nullptr)
-    BIO_free_all(bp);
   if (ctx != nullptr)
     EVP_PKEY_CTX_free(ctx);
 
@@ -4287,9 +5151,9 @@ template <PublicKeyCipher::Operation operation,
 void PublicKeyCipher::Cipher(const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args);
 
-  THROW_AND_RETURN_IF_NOT_BUFFER(args[0], "Key");
-  char* kbuf = Buffer::Data(args[0]);
-  ssize_t klen = Buffer::Length(args[0]);
+  KeyObject* key = KeyObject::FromValue(env, args[0]);
+  if (key == nullptr)
+    THROW_AND_RETURN_IF_NOT_BUFFER(args[0], "Key");
 
   THROW_AND_RETURN_IF_NOT_BUFFER(args[1], "Data");
   char* buf = Buffer::Data(args[1]);
@@ -4305,15 +5169,38 @@ void PublicKeyCipher::Cipher(const FunctionCallbackInfo<Value>& args) {
   ClearErrorOnReturn clear_error_on_return;
   (void) &clear_error_on_return;  // Silence compiler warning.
 
-  bool r = Cipher<operation, EVP_PKEY_cipher_init, EVP_PKEY_cipher>(
-      kbuf,
-      klen,
-      args.Length() >= 3 && !args[2]->IsNull() ? *passphrase : nullptr,
-      padding,
-      reinterpret_cast<const unsigned char*>(buf),
-      len,
-      &out_value,
-      &out_len);
+  EVP_PKEY* pkey;
+  if (key != nullptr) {
+    pkey = key->GetKey();
+  } else {
+    const char* key_pem = Buffer::Data(args[0]);
+    int key_pem_len = Buffer::Length(args[0]);
+
+    // Check if this is a PKCS#8 or RSA public key or a certificate before
+    // trying as private key.
+    if (operation == kPublic &&
+        (strncmp(key_pem, PUBLIC_KEY_PFX, PUBLIC_KEY_PFX_LEN) == 0 ||
+         strncmp(key_pem, PUBRSA_KEY_PFX, PUBRSA_KEY_PFX_LEN) == 0 ||
+         strncmp(key_pem, CERTIFICATE_PFX, CERTIFICATE_PFX_LEN) == 0)) {
+      pkey = ReadPublicKey(key_pem, key_pem_len);
+    } else {
+      pkey = ReadPrivateKey(
+          key_pem,
+          key_pem_len,
+          args.Length() >= 3 && !args[2]->IsNull() ? *passphrase : nullptr);
+    }
+  }
+
+  bool r = pkey != nullptr &&
+           Cipher<operation, EVP_PKEY_cipher_init, EVP_PKEY_cipher>(
+               pkey,
+               padding,
+               reinterpret_cast<const unsigned char*>(buf),
+               len,
+               &out_value,
+               &out_len);
+  if (pkey != nullptr)
+    EVP_PKEY_free(pkey);
 
   if (out_len == 0 || !r) {
     delete[] out_value;
@@ -4344,6 +5231,8 @@ void DiffieHellman::Initialize(Environment* env, Local<Object> target) {
 
   env->SetProtoMethod(t, "generateKeys", GenerateKeys);
   env->SetProtoMethod(t, "computeSecret", ComputeSecret);
+  env->SetProtoMethod(t, "generateKeysAsync", GenerateKeysAsync);
+  env->SetProtoMethod(t, "computeSecretAsync", ComputeSecretAsync);
   env->SetProtoMethod(t, "getPrime", GetPrime);
   env->SetProtoMethod(t, "getGenerator", GetGenerator);
   env->SetProtoMethod(t, "getPublicKey", GetPublicKey);
@@ -4368,6 +5257,8 @@ void DiffieHellman::Initialize(Environment* env, Local<Object> target) {
 
   env->SetProtoMethod(t2, "generateKeys", GenerateKeys);
   env->SetProtoMethod(t2, "computeSecret", ComputeSecret);
+  env->SetProtoMethod(t2, "generateKeysAsync", GenerateKeysAsync);
+  env->SetProtoMethod(t2, "computeSecretAsync", ComputeSecretAsync);
   env->SetProtoMethod(t2, "getPrime", GetPrime);
   env->SetProtoMethod(t2, "getGenerator", GetGenerator);
   env->SetProtoMethod(t2, "getPublicKey", GetPublicKey);
@@ -4562,17 +5453,241 @@ void DiffieHellman::GetPublicKey(const FunctionCallbackInfo<Value>& args) {
     return env->ThrowError("No public key - did you forget to generate one?");
   }
 
-  int dataSize = BN_num_bytes(diffieHellman->dh->pub_key);
-  char* data = new char[dataSize];
-  BN_bn2bin(diffieHellman->dh->pub_key,
-            reinterpret_cast<unsigned char*>(data));
+  int dataSize = BN_num_bytes(diffieHellman->dh->pub_key);
+  char* data = new char[dataSize];
+  BN_bn2bin(diffieHellman->dh->pub_key,
+            reinterpret_cast<unsigned char*>(data));
+
+  args.GetReturnValue().Set(Encode(env->isolate(), data, dataSize, BUFFER));
+  delete[] data;
+}
+
+
+void DiffieHellman::GetPrivateKey(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+
+  DiffieHellman* diffieHellman = Unwrap<DiffieHellman>(args.Holder());
+
+  if (!diffieHellman->initialised_) {
+    return ThrowCryptoError(env, ERR_get_error(), "Not initialized");
+  }
+
+  if (diffieHellman->dh->priv_key == nullptr) {
+    return env->ThrowError("No private key - did you forget to generate one?");
+  }
+
+  int dataSize = BN_num_bytes(diffieHellman->dh->priv_key);
+  char* data = new char[dataSize];
+  BN_bn2bin(diffieHellman->dh->priv_key,
+            reinterpret_cast<unsigned char*>(data));
+
+  args.GetReturnValue().Set(Encode(env->isolate(), data, dataSize, BUFFER));
+  delete[] data;
+}
+
+
+// Computes the secret shared with the owner of key into data, which must
+// hold DH_size(dh) bytes.  Returns nullptr on success or an error message;
+// check_failed is set when the key could not be checked, in which case the
+// reason is on OpenSSL's error stack.
+static const char* ComputeDHSecret(DH* dh,
+                                   const BIGNUM* key,
+                                   char* data,
+                                   bool* check_failed) {
+  int dataSize = DH_size(dh);
+  int size = DH_compute_key(reinterpret_cast<unsigned char*>(data), key, dh);
+
+  if (size == -1) {
+    int checkResult;
+    int checked = DH_check_pub_key(dh, key, &checkResult);
+
+    if (!checked) {
+      *check_failed = true;
+      return "Invalid Key";
+    } else if (checkResult) {
+      if (checkResult & DH_CHECK_PUBKEY_TOO_SMALL) {
+        return "Supplied key is too small";
+      } else if (checkResult & DH_CHECK_PUBKEY_TOO_LARGE) {
+        return "Supplied key is too large";
+      } else {
+        return "Invalid key";
+      }
+    } else {
+      return "Invalid key";
+    }
+  }
+
+  CHECK_GE(size, 0);
+
+  // DH_size returns number of bytes in a prime number
+  // DH_compute_key returns number of bytes in a remainder of exponent, which
+  // may have less bytes than a prime number. Therefore add 0-padding to the
+  // allocated buffer.
+  if (size != dataSize) {
+    CHECK(dataSize > size);
+    memmove(data + dataSize - size, data, size);
+    memset(data, 0, dataSize - size);
+  }
+
+  return nullptr;
+}
+
+
+void DiffieHellman::ComputeSecret(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+
+  DiffieHellman* diffieHellman = Unwrap<DiffieHellman>(args.Holder());
+
+  if (!diffieHellman->initialised_) {
+    return ThrowCryptoError(env, ERR_get_error(), "Not initialized");
+  }
+
+  ClearErrorOnReturn clear_error_on_return;
+  (void) &clear_error_on_return;  // Silence compiler warning.
+  BIGNUM* key = nullptr;
+
+  if (args.Length() == 0) {
+    return env->ThrowError("Other party's public key argument is mandatory");
+  } else {
+    THROW_AND_RETURN_IF_NOT_BUFFER(args[0], "Other party's public key");
+    key = BN_bin2bn(
+        reinterpret_cast<unsigned char*>(Buffer::Data(args[0])),
+        Buffer::Length(args[0]),
+        0);
+  }
+
+  int dataSize = DH_size(diffieHellman->dh);
+  char* data = new char[dataSize];
+
+  bool check_failed = false;
+  const char* error =
+      ComputeDHSecret(diffieHellman->dh, key, data, &check_failed);
+  BN_free(key);
+
+  if (error != nullptr) {
+    delete[] data;
+    if (check_failed)
+      return ThrowCryptoError(env, ERR_get_error(), error);
+    return env->ThrowError(error);
+  }
+
+  args.GetReturnValue().Set(Encode(env->isolate(), data, dataSize, BUFFER));
+  delete[] data;
+}
+
+
+// Generates keys or computes a secret in the threadpool.  The work is done on
+// a copy of the parameters and keys, so that the DiffieHellman object can be
+// used while the request is pending.  Generated keys are stored in the
+// DiffieHellman object when the request completes.
+class DiffieHellman::Request : public AsyncWrap {
+ public:
+  Request(Environment* env,
+          Local<Object> object,
+          DiffieHellman* diffie_hellman,
+          BIGNUM* peer_key)
+      : AsyncWrap(env, object, AsyncWrap::PROVIDER_CRYPTO),
+        diffie_hellman_(diffie_hellman),
+        dh_(DHparams_dup(diffie_hellman->dh)),
+        peer_key_(peer_key),
+        secret_(nullptr),
+        secret_len_(0),
+        error_message_(nullptr),
+        error_(0) {
+    Wrap(object, this);
+    CHECK_NE(dh_, nullptr);
+    DH* dh = diffie_hellman->dh;
+    if (dh->pub_key != nullptr)
+      dh_->pub_key = BN_dup(dh->pub_key);
+    if (dh->priv_key != nullptr)
+      dh_->priv_key = BN_dup(dh->priv_key);
+  }
+
+  ~Request() override {
+    DH_free(dh_);
+    BN_free(peer_key_);
+    BufferArena::Free(secret_, secret_len_);
+    persistent().Reset();
+  }
+
+  size_t self_size() const override { return sizeof(*this); }
+
+  static void Work(uv_work_t* work_req) {
+    Request* req = ContainerOf(&Request::work_req_, work_req);
+    if (req->peer_key_ == nullptr) {
+      if (!DH_generate_key(req->dh_)) {
+        req->error_message_ = "Key generation failed";
+        req->error_ = ERR_get_error();
+      }
+    } else {
+      req->secret_len_ = DH_size(req->dh_);
+      req->secret_ =
+          static_cast<char*>(BufferArena::Allocate(req->secret_len_, false));
+      CHECK_NE(req->secret_, nullptr);
+      bool check_failed = false;
+      req->error_message_ =
+          ComputeDHSecret(req->dh_, req->peer_key_, req->secret_,
+                          &check_failed);
+      if (check_failed)
+        req->error_ = ERR_get_error();
+    }
+    ERR_clear_error();
+  }
+
+  static void After(uv_work_t* work_req, int status) {
+    CHECK_EQ(status, 0);
+    Request* req = ContainerOf(&Request::work_req_, work_req);
+    Environment* env = req->env();
+    HandleScope handle_scope(env->isolate());
+    Context::Scope context_scope(env->context());
+
+    Local<Value> argv[2];
+    if (req->error_message_ != nullptr) {
+      char errmsg[128];
+      snprintf(errmsg, sizeof(errmsg), "%s", req->error_message_);
+      if (req->error_ != 0)
+        ERR_error_string_n(req->error_, errmsg, sizeof(errmsg));
+      argv[0] = Exception::Error(OneByteString(env->isolate(), errmsg));
+      argv[1] = Undefined(env->isolate());
+    } else if (req->peer_key_ == nullptr) {
+      DH* dh = req->diffie_hellman_->dh;
+      BN_free(dh->pub_key);
+      BN_free(dh->priv_key);
+      dh->pub_key = req->dh_->pub_key;
+      dh->priv_key = req->dh_->priv_key;
+      req->dh_->pub_key = nullptr;
+      req->dh_->priv_key = nullptr;
+
+      int size = BN_num_bytes(dh->pub_key);
+      char* data = static_cast<char*>(malloc(size));
+      CHECK_NE(data, nullptr);
+      BN_bn2bin(dh->pub_key, reinterpret_cast<unsigned char*>(data));
+      argv[0] = Null(env->isolate());
+      argv[1] = Buffer::New(env, data, size).ToLocalChecked();
+    } else {
+      argv[0] = Null(env->isolate());
+      argv[1] = Buffer::New(env, req->secret_, req->secret_len_)
+          .ToLocalChecked();
+      req->secret_ = nullptr;
+    }
+    req->MakeCallback(env->ondone_string(), arraysize(argv), argv);
+    delete req;
+  }
+
+  uv_work_t work_req_;
 
-  args.GetReturnValue().Set(Encode(env->isolate(), data, dataSize, BUFFER));
-  delete[] data;
-}
+ private:
+  DiffieHellman* const diffie_hellman_;
+  DH* const dh_;
+  BIGNUM* const peer_key_;
+  char* secret_;
+  size_t secret_len_;
+  const char* error_message_;
+  unsigned long error_;
+};
 
 
-void DiffieHellman::GetPrivateKey(const FunctionCallbackInfo<Value>& args) {
+void DiffieHellman::GenerateKeysAsync(const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args);
 
   DiffieHellman* diffieHellman = Unwrap<DiffieHellman>(args.Holder());
@@ -4581,21 +5696,25 @@ void DiffieHellman::GetPrivateKey(const FunctionCallbackInfo<Value>& args) {
     return ThrowCryptoError(env, ERR_get_error(), "Not initialized");
   }
 
-  if (diffieHellman->dh->priv_key == nullptr) {
-    return env->ThrowError("No private key - did you forget to generate one?");
-  }
+  CHECK(args[0]->IsFunction());
 
-  int dataSize = BN_num_bytes(diffieHellman->dh->priv_key);
-  char* data = new char[dataSize];
-  BN_bn2bin(diffieHellman->dh->priv_key,
-            reinterpret_cast<unsigned char*>(data));
+  // The request stores the keys in the DiffieHellman object, keep it alive
+  Local<Object> obj = env->NewInternalFieldObject();
+  obj->Set(env->handle_string(), args.Holder());
+  obj->Set(env->ondone_string(), args[0]);
+  if (env->in_domain())
+    obj->Set(env->domain_string(), env->domain_array()->Get(0));
 
-  args.GetReturnValue().Set(Encode(env->isolate(), data, dataSize, BUFFER));
-  delete[] data;
+  Request* req = new Request(env, obj, diffieHellman, nullptr);
+  QueueCryptoWork(env,
+                  &req->work_req_,
+                  Request::Work,
+                  Request::After);
 }
 
 
-void DiffieHellman::ComputeSecret(const FunctionCallbackInfo<Value>& args) {
+void DiffieHellman::ComputeSecretAsync(
+    const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args);
 
   DiffieHellman* diffieHellman = Unwrap<DiffieHellman>(args.Holder());
@@ -4604,65 +5723,25 @@ void DiffieHellman::ComputeSecret(const FunctionCallbackInfo<Value>& args) {
     return ThrowCryptoError(env, ERR_get_error(), "Not initialized");
   }
 
-  ClearErrorOnReturn clear_error_on_return;
-  (void) &clear_error_on_return;  // Silence compiler warning.
-  BIGNUM* key = nullptr;
-
-  if (args.Length() == 0) {
-    return env->ThrowError("Other party's public key argument is mandatory");
-  } else {
-    THROW_AND_RETURN_IF_NOT_BUFFER(args[0], "Other party's public key");
-    key = BN_bin2bn(
-        reinterpret_cast<unsigned char*>(Buffer::Data(args[0])),
-        Buffer::Length(args[0]),
-        0);
-  }
-
-  int dataSize = DH_size(diffieHellman->dh);
-  char* data = new char[dataSize];
-
-  int size = DH_compute_key(reinterpret_cast<unsigned char*>(data),
-                            key,
-                            diffieHellman->dh);
-
-  if (size == -1) {
-    int checkResult;
-    int checked;
-
-    checked = DH_check_pub_key(diffieHellman->dh, key, &checkResult);
-    BN_free(key);
-    delete[] data;
-
-    if (!checked) {
-      return ThrowCryptoError(env, ERR_get_error(), "Invalid Key");
-    } else if (checkResult) {
-      if (checkResult & DH_CHECK_PUBKEY_TOO_SMALL) {
-        return env->ThrowError("Supplied key is too small");
-      } else if (checkResult & DH_CHECK_PUBKEY_TOO_LARGE) {
-        return env->ThrowError("Supplied key is too large");
-      } else {
-        return env->ThrowError("Invalid key");
-      }
-    } else {
-      return env->ThrowError("Invalid key");
-    }
-  }
+  THROW_AND_RETURN_IF_NOT_BUFFER(args[0], "Other party's public key");
+  CHECK(args[1]->IsFunction());
 
-  BN_free(key);
-  CHECK_GE(size, 0);
+  BIGNUM* key = BN_bin2bn(
+      reinterpret_cast<unsigned char*>(Buffer::Data(args[0])),
+      Buffer::Length(args[0]),
+      0);
+  CHECK_NE(key, nullptr);
 
-  // DH_size returns number of bytes in a prime number
-  // DH_compute_key returns number of bytes in a remainder of exponent, which
-  // may have less bytes than a prime number. Therefore add 0-padding to the
-  // allocated buffer.
-  if (size != dataSize) {
-    CHECK(dataSize > size);
-    memmove(data + dataSize - size, data, size);
-    memset(data, 0, dataSize - size);
-  }
+  Local<Object> obj = env->NewInternalFieldObject();
+  obj->Set(env->ondone_string(), args[1]);
+  if (env->in_domain())
+    obj->Set(env->domain_string(), env->domain_array()->Get(0));
 
-  args.GetReturnValue().Set(Encode(env->isolate(), data, dataSize, BUFFER));
-  delete[] data;
+  Request* req = new Request(env, obj, diffieHellman, key);
+  QueueCryptoWork(env,
+                  &req->work_req_,
+                  Request::Work,
+                  Request::After);
 }
 
 
@@ -4737,6 +5816,8 @@ void ECDH::Initialize(Environment* env, Local<Object> target) {
 
   env->SetProtoMethod(t, "generateKeys", GenerateKeys);
   env->SetProtoMethod(t, "computeSecret", ComputeSecret);
+  env->SetProtoMethod(t, "generateKeysAsync", GenerateKeysAsync);
+  env->SetProtoMethod(t, "computeSecretAsync", ComputeSecretAsync);
   env->SetProtoMethod(t, "getPublicKey", GetPublicKey);
   env->SetProtoMethod(t, "getPrivateKey", GetPrivateKey);
   env->SetProtoMethod(t, "setPublicKey", SetPublicKey);
@@ -4840,6 +5921,150 @@ void ECDH::ComputeSecret(const FunctionCallbackInfo<Value>& args) {
 }
 
 
+// Like DiffieHellman::Request, works on a copy of the key pair and stores
+// generated keys in the ECDH object when the request completes.
+class ECDH::Request : public AsyncWrap {
+ public:
+  Request(Environment* env,
+          Local<Object> object,
+          ECDH* ecdh,
+          EC_POINT* peer_key)
+      : AsyncWrap(env, object, AsyncWrap::PROVIDER_CRYPTO),
+        ecdh_(ecdh),
+        key_(EC_KEY_dup(ecdh->key_)),
+        peer_key_(peer_key),
+        secret_(nullptr),
+        secret_len_(0),
+        ok_(false) {
+    Wrap(object, this);
+    CHECK_NE(key_, nullptr);
+  }
+
+  ~Request() override {
+    if (key_ != nullptr)
+      EC_KEY_free(key_);
+    if (peer_key_ != nullptr)
+      EC_POINT_free(peer_key_);
+    BufferArena::Free(secret_, secret_len_);
+    persistent().Reset();
+  }
+
+  size_t self_size() const override { return sizeof(*this); }
+
+  static void Work(uv_work_t* work_req) {
+    Request* req = ContainerOf(&Request::work_req_, work_req);
+    if (req->peer_key_ == nullptr) {
+      req->ok_ = EC_KEY_generate_key(req->key_) == 1;
+    } else {
+      // NOTE: field_size is in bits
+      int field_size = EC_GROUP_get_degree(EC_KEY_get0_group(req->key_));
+      req->secret_len_ = (field_size + 7) / 8;
+      req->secret_ =
+          static_cast<char*>(BufferArena::Allocate(req->secret_len_, false));
+      CHECK_NE(req->secret_, nullptr);
+      req->ok_ = ECDH_compute_key(req->secret_,
+                                  req->secret_len_,
+                                  req->peer_key_,
+                                  req->key_,
+                                  nullptr) != 0;
+    }
+    ERR_clear_error();
+  }
+
+  static void After(uv_work_t* work_req, int status) {
+    CHECK_EQ(status, 0);
+    Request* req = ContainerOf(&Request::work_req_, work_req);
+    Environment* env = req->env();
+    HandleScope handle_scope(env->isolate());
+    Context::Scope context_scope(env->context());
+
+    Local<Value> argv[2];
+    if (!req->ok_) {
+      const char* errmsg = req->peer_key_ == nullptr ?
+          "Failed to generate EC_KEY" : "Failed to compute ECDH key";
+      argv[0] = Exception::Error(OneByteString(env->isolate(), errmsg));
+      argv[1] = Undefined(env->isolate());
+    } else if (req->peer_key_ == nullptr) {
+      ECDH* ecdh = req->ecdh_;
+      EC_KEY_free(ecdh->key_);
+      ecdh->key_ = req->key_;
+      ecdh->group_ = EC_KEY_get0_group(ecdh->key_);
+      req->key_ = nullptr;
+      argv[0] = Null(env->isolate());
+      argv[1] = Undefined(env->isolate());
+    } else {
+      argv[0] = Null(env->isolate());
+      argv[1] = Buffer::New(env, req->secret_, req->secret_len_)
+          .ToLocalChecked();
+      req->secret_ = nullptr;
+    }
+    req->MakeCallback(env->ondone_string(), arraysize(argv), argv);
+    delete req;
+  }
+
+  uv_work_t work_req_;
+
+ private:
+  ECDH* const ecdh_;
+  EC_KEY* key_;
+  EC_POINT* const peer_key_;
+  char* secret_;
+  size_t secret_len_;
+  bool ok_;
+};
+
+
+void ECDH::GenerateKeysAsync(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+
+  ECDH* ecdh = Unwrap<ECDH>(args.Holder());
+
+  CHECK(args[0]->IsFunction());
+
+  // The request stores the keys in the ECDH object, keep it alive
+  Local<Object> obj = env->NewInternalFieldObject();
+  obj->Set(env->handle_string(), args.Holder());
+  obj->Set(env->ondone_string(), args[0]);
+  if (env->in_domain())
+    obj->Set(env->domain_string(), env->domain_array()->Get(0));
+
+  Request* req = new Request(env, obj, ecdh, nullptr);
+  QueueCryptoWork(env,
+                  &req->work_req_,
+                  Request::Work,
+                  Request::After);
+}
+
+
+void ECDH::ComputeSecretAsync(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+
+  THROW_AND_RETURN_IF_NOT_BUFFER(args[0], "Data");
+  CHECK(args[1]->IsFunction());
+
+  ECDH* ecdh = Unwrap<ECDH>(args.Holder());
+
+  if (!ecdh->IsKeyPairValid())
+    return env->ThrowError("Invalid key pair");
+
+  EC_POINT* pub = ecdh->BufferToPoint(Buffer::Data(args[0]),
+                                      Buffer::Length(args[0]));
+  if (pub == nullptr)
+    return;
+
+  Local<Object> obj = env->NewInternalFieldObject();
+  obj->Set(env->ondone_string(), args[1]);
+  if (env->in_domain())
+    obj->Set(env->domain_string(), env->domain_array()->Get(0));
+
+  Request* req = new Request(env, obj, ecdh, pub);
+  QueueCryptoWork(env,
+                  &req->work_req_,
+                  Request::Work,
+                  Request::After);
+}
+
+
 void ECDH::GetPublicKey(const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args);
 
@@ -5248,10 +6473,10 @@ void PBKDF2(const FunctionCallbackInfo<Value>& args) {
 
     if (env->in_domain())
       obj->Set(env->domain_string(), env->domain_array()->Get(0));
-    uv_queue_work(env->event_loop(),
-                  req->work_req(),
-                  EIO_PBKDF2,
-                  EIO_PBKDF2After);
+    QueueCryptoWork(env,
+                    req->work_req(),
+                    EIO_PBKDF2,
+                    EIO_PBKDF2After);
   } else {
     env->PrintSyncTrace();
     Local<Value> argv[2];
@@ -5274,6 +6499,246 @@ void PBKDF2(const FunctionCallbackInfo<Value>& args) {
 }
 
 
+// Derives the keys of many password and salt pairs in a single threadpool
+// job.  One HMAC_CTX is keyed once per password and then reset in place for
+// every iteration, where PKCS5_PBKDF2_HMAC() copies a fresh context (and
+// allocates its digest state) for each of them.
+class PBKDF2BatchRequest : public AsyncWrap {
+ public:
+  struct Item {
+    const char* pass;
+    int passlen;
+    const unsigned char* salt;
+    int saltlen;
+  };
+
+  PBKDF2BatchRequest(Environment* env,
+                     Local<Object> object,
+                     const EVP_MD* digest,
+                     int iter,
+                     int keylen,
+                     size_t count,
+                     size_t data_size)
+      : AsyncWrap(env, object, AsyncWrap::PROVIDER_CRYPTO),
+        digest_(digest),
+        iter_(iter),
+        keylen_(keylen),
+        count_(count),
+        data_size_(data_size),
+        items_(new Item[count]),
+        data_(new char[data_size]),
+        keys_(new unsigned char[count * keylen]),
+        ok_(false) {
+    Wrap(object, this);
+  }
+
+  ~PBKDF2BatchRequest() override {
+    OPENSSL_cleanse(data_, data_size_);
+    OPENSSL_cleanse(keys_, count_ * keylen_);
+    delete[] items_;
+    delete[] data_;
+    delete[] keys_;
+    persistent().Reset();
+  }
+
+  inline Item* items() const {
+    return items_;
+  }
+
+  inline char* data() const {
+    return data_;
+  }
+
+  void Derive() {
+    HMAC_CTX ctx;
+    HMAC_CTX_init(&ctx);
+    ok_ = true;
+    for (size_t i = 0; ok_ && i < count_; i++)
+      ok_ = DeriveKey(&ctx, items_[i], keys_ + i * keylen_);
+    HMAC_CTX_cleanup(&ctx);
+    OPENSSL_cleanse(data_, data_size_);
+    ERR_clear_error();
+  }
+
+  void Results(Local<Value> argv[2]) {
+    if (!ok_) {
+      argv[0] = Exception::Error(env()->pbkdf2_error_string());
+      argv[1] = Undefined(env()->isolate());
+      return;
+    }
+    Local<Array> keys = Array::New(env()->isolate(), count_);
+    for (size_t i = 0; i < count_; i++) {
+      char* key = reinterpret_cast<char*>(keys_ + i * keylen_);
+      keys->Set(i, Buffer::Copy(env(), key, keylen_).ToLocalChecked());
+    }
+    argv[0] = Null(env()->isolate());
+    argv[1] = keys;
+  }
+
+  void Queue() {
+    QueueCryptoWork(env(), &work_req_, Work, After);
+  }
+
+  size_t self_size() const override { return sizeof(*this); }
+
+ private:
+  // PBKDF2 as in RFC 2898, section 5.2.
+  bool DeriveKey(HMAC_CTX* ctx, const Item& item, unsigned char* out) {
+    const int mdlen = EVP_MD_size(digest_);
+    unsigned char u[EVP_MAX_MD_SIZE];
+    // HMAC_Init_ex() takes a null key to mean "keep the current one".
+    const char* pass = item.passlen > 0 ? item.pass : "";
+
+    if (mdlen <= 0 || !HMAC_Init_ex(ctx, pass, item.passlen, digest_, nullptr))
+      return false;
+
+    uint32_t block = 1;
+    for (int remaining = keylen_; remaining > 0; block++) {
+      const int n = remaining < mdlen ? remaining : mdlen;
+      const unsigned char counter[4] = {
+        static_cast<unsigned char>(block >> 24),
+        static_cast<unsigned char>(block >> 16),
+        static_cast<unsigned char>(block >> 8),
+        static_cast<unsigned char>(block)
+      };
+      if (!HMAC_Init_ex(ctx, nullptr, 0, nullptr, nullptr) ||
+          !HMAC_Update(ctx, item.salt, item.saltlen) ||
+          !HMAC_Update(ctx, counter, sizeof(counter)) ||
+          !HMAC_Final(ctx, u, nullptr)) {
+        return false;
+      }
+      memcpy(out, u, n);
+      for (int j = 1; j < iter_; j++) {
+        if (!HMAC_Init_ex(ctx, nullptr, 0, nullptr, nullptr) ||
+            !HMAC_Update(ctx, u, mdlen) ||
+            !HMAC_Final(ctx, u, nullptr)) {
+          return false;
+        }
+        for (int k = 0; k < n; k++)
+          out[k] ^= u[k];
+      }
+      out += n;
+      remaining -= n;
+    }
+    OPENSSL_cleanse(u, sizeof(u));
+    return true;
+  }
+
+  static void Work(uv_work_t* work_req) {
+    PBKDF2BatchRequest* req =
+        ContainerOf(&PBKDF2BatchRequest::work_req_, work_req);
+    req->Derive();
+  }
+
+  static void After(uv_work_t* work_req, int status) {
+    CHECK_EQ(status, 0);
+    PBKDF2BatchRequest* req =
+        ContainerOf(&PBKDF2BatchRequest::work_req_, work_req);
+    Environment* env = req->env();
+    HandleScope handle_scope(env->isolate());
+    Context::Scope context_scope(env->context());
+    Local<Value> argv[2];
+    req->Results(argv);
+    req->MakeCallback(env->ondone_string(), arraysize(argv), argv);
+    delete req;
+  }
+
+  uv_work_t work_req_;
+  const EVP_MD* const digest_;
+  const int iter_;
+  const int keylen_;
+  const size_t count_;
+  const size_t data_size_;
+  Item* const items_;
+  char* const data_;
+  unsigned char* const keys_;
+  bool ok_;
+};
+
+
+// pbkdf2Batch(items, iterations, keylen, digest[, callback]), where passwords
+// and salts alternate in the items array.
+void PBKDF2Batch(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+
+  if (!args[0]->IsArray())
+    return env->ThrowTypeError("Items must be an array");
+  if (!args[1]->IsInt32() || args[1]->Int32Value() < 0)
+    return env->ThrowTypeError("Bad iterations");
+  if (!args[2]->IsInt32() || args[2]->Int32Value() < 0)
+    return env->ThrowTypeError("Bad key length");
+  THROW_AND_RETURN_IF_NOT_STRING(args[3], "Digest");
+
+  const node::Utf8Value digest_name(env->isolate(), args[3]);
+  const EVP_MD* digest = EVP_get_digestbyname(*digest_name);
+  if (digest == nullptr)
+    return env->ThrowTypeError("Bad digest name");
+
+  Local<Array> items = args[0].As<Array>();
+  const size_t count = items->Length() / 2;
+  const int iter = args[1]->Int32Value();
+  const int keylen = args[2]->Int32Value();
+  if (keylen > 0 && count > Buffer::kMaxLength / keylen)
+    return env->ThrowRangeError("Bad key length");
+
+  size_t data_size = 0;
+  for (size_t i = 0; i < 2 * count; i++) {
+    Local<Value> value = items->Get(i);
+    if (!Buffer::HasInstance(value))
+      return env->ThrowTypeError("Passwords and salts must be buffers");
+    if (Buffer::Length(value) > INT_MAX)
+      return env->ThrowRangeError("Password or salt is too long");
+    data_size += Buffer::Length(value);
+  }
+
+  // The passwords and salts are copied, so they can be cleansed afterwards
+  // and the caller's buffers can change while the job runs.
+  Local<Object> obj = env->NewInternalFieldObject();
+  PBKDF2BatchRequest* req = new PBKDF2BatchRequest(env,
+                                                   obj,
+                                                   digest,
+                                                   iter,
+                                                   keylen,
+                                                   count,
+                                                   data_size);
+  char* data = req->data();
+  for (size_t i = 0; i < count; i++) {
+    Local<Value> pass = items->Get(2 * i);
+    Local<Value> salt = items->Get(2 * i + 1);
+    PBKDF2BatchRequest::Item* item = &req->items()[i];
+
+    item->pass = data;
+    item->passlen = Buffer::Length(pass);
+    memcpy(data, Buffer::Data(pass), item->passlen);
+    data += item->passlen;
+
+    item->salt = reinterpret_cast<unsigned char*>(data);
+    item->saltlen = Buffer::Length(salt);
+    memcpy(data, Buffer::Data(salt), item->saltlen);
+    data += item->saltlen;
+  }
+
+  if (args[4]->IsFunction()) {
+    obj->Set(env->ondone_string(), args[4]);
+
+    if (env->in_domain())
+      obj->Set(env->domain_string(), env->domain_array()->Get(0));
+    req->Queue();
+  } else {
+    env->PrintSyncTrace();
+    Local<Value> argv[2];
+    req->Derive();
+    req->Results(argv);
+    delete req;
+
+    if (argv[0]->IsObject())
+      env->isolate()->ThrowException(argv[0]);
+    else
+      args.GetReturnValue().Set(argv[1]);
+  }
+}
+
+
 // Only instantiate within a valid HandleScope.
 class RandomBytesRequest : public AsyncWrap {
  public:
@@ -5409,10 +6874,10 @@ void RandomBytes(const FunctionCallbackInfo<Value>& args) {
 
     if (env->in_domain())
       obj->Set(env->domain_string(), env->domain_array()->Get(0));
-    uv_queue_work(env->event_loop(),
-                  req->work_req(),
-                  RandomBytesWork,
-                  RandomBytesAfter);
+    QueueCryptoWork(env,
+                    req->work_req(),
+                    RandomBytesWork,
+                    RandomBytesAfter);
     args.GetReturnValue().Set(obj);
   } else {
     env->PrintSyncTrace();
@@ -5429,6 +6894,102 @@ void RandomBytes(const FunctionCallbackInfo<Value>& args) {
 }
 
 
+// Fills a buffer for Environment::RandomPool in the threadpool, so the
+// pool goes on serving what it has left in the meantime.
+class RandomPoolRefill {
+ public:
+  explicit RandomPoolRefill(Environment* env)
+      : env_(env),
+        data_(new char[Environment::RandomPool::kSize]),
+        ok_(false) {
+    work_req_.data = this;
+  }
+
+  ~RandomPoolRefill() {
+    delete[] data_;
+  }
+
+  static void Start(Environment* env) {
+    Environment::RandomPool* pool = env->random_pool();
+    if (pool->refilling())
+      return;
+    pool->set_refilling(true);
+    RandomPoolRefill* refill = new RandomPoolRefill(env);
+    QueueCryptoWork(env, &refill->work_req_, Work, After);
+  }
+
+  // Fills the pool right away, for synchronous calls that find it empty.
+  static bool FillSync(Environment* env) {
+    RandomPoolRefill refill(env);
+    refill.Fill();
+    if (refill.ok_)
+      refill.Commit();
+    return refill.ok_;
+  }
+
+ private:
+  void Fill() {
+    // Ensure that OpenSSL's PRNG is properly seeded.
+    CheckEntropy();
+    ok_ = RAND_bytes(reinterpret_cast<unsigned char*>(data_),
+                     Environment::RandomPool::kSize) == 1;
+  }
+
+  void Commit() {
+    env_->random_pool()->Fill(data_);
+    data_ = nullptr;
+  }
+
+  static void Work(uv_work_t* work_req) {
+    static_cast<RandomPoolRefill*>(work_req->data)->Fill();
+  }
+
+  static void After(uv_work_t* work_req, int status) {
+    CHECK_EQ(status, 0);
+    RandomPoolRefill* refill = static_cast<RandomPoolRefill*>(work_req->data);
+    refill->env_->random_pool()->set_refilling(false);
+    // On errors the pool runs dry, and randomBytes() reports them.
+    if (refill->ok_)
+      refill->Commit();
+    delete refill;
+  }
+
+  Environment* const env_;
+  char* data_;
+  bool ok_;
+  uv_work_t work_req_;
+};
+
+
+// randomBytesPooled(size, sync) returns |size| bytes from the environment's
+// RandomPool, or undefined when |size| is too large for the pool or the pool
+// is waiting to be refilled.  Synchronous callers fill an empty pool on the
+// spot, they would block for the bytes anyway.
+void RandomBytesPooled(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  Environment::RandomPool* pool = env->random_pool();
+  if (!args[0]->IsUint32())
+    return;
+  size_t size = args[0]->Uint32Value();
+  if (size > Environment::RandomPool::kMaxRequest)
+    return;
+
+  if (pool->available() < size) {
+    if (!args[1]->IsTrue() || pool->refilling() ||
+        !RandomPoolRefill::FillSync(env)) {
+      RandomPoolRefill::Start(env);
+      return;
+    }
+  }
+
+  Local<Object> buffer = Buffer::New(env, size).ToLocalChecked();
+  CHECK(pool->Take(Buffer::Data(buffer), size));
+  if (pool->available() < Environment::RandomPool::kSize / 2)
+    RandomPoolRefill::Start(env);
+  args.GetReturnValue().Set(buffer);
+}
+
+
 void GetSSLCiphers(const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args);
 
@@ -5526,6 +7087,12 @@ void GetCurves(const FunctionCallbackInfo<Value>& args) {
 }
 
 
+void GetBIOBufferPoolStats(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  args.GetReturnValue().Set(env->FreeListPoolStats(env->bio_buffer_pool()));
+}
+
+
 bool VerifySpkac(const char* data, unsigned int len) {
   bool i = 0;
   EVP_PKEY* pkey = nullptr;
@@ -5731,30 +7298,9 @@ void SetEngine(const FunctionCallbackInfo<Value>& args) {
   (void) &clear_error_on_return;  // Silence compiler warning.
 
   const node::Utf8Value engine_id(env->isolate(), args[0]);
-  ENGINE* engine = ENGINE_by_id(*engine_id);
-
-  // Engine not found, try loading dynamically
-  if (engine == nullptr) {
-    engine = ENGINE_by_id("dynamic");
-    if (engine != nullptr) {
-      if (!ENGINE_ctrl_cmd_string(engine, "SO_PATH", *engine_id, 0) ||
-          !ENGINE_ctrl_cmd_string(engine, "LOAD", nullptr, 0)) {
-        ENGINE_free(engine);
-        engine = nullptr;
-      }
-    }
-  }
-
-  if (engine == nullptr) {
-    int err = ERR_get_error();
-    if (err == 0) {
-      char tmp[1024];
-      snprintf(tmp, sizeof(tmp), "Engine \"%s\" was not found", *engine_id);
-      return env->ThrowError(tmp);
-    } else {
-      return ThrowCryptoError(env, err);
-    }
-  }
+  ENGINE* engine = LoadEngine(env, *engine_id);
+  if (engine == nullptr)
+    return;
 
   int r = ENGINE_set_default(engine, flags);
   ENGINE_free(engine);
@@ -5803,6 +7349,7 @@ void InitCrypto(Local<Object> target,
   ECDH::Initialize(env, target);
   Hmac::Initialize(env, target);
   Hash::Initialize(env, target);
+  KeyObject::Initialize(env, target);
   Sign::Initialize(env, target);
   Verify::Initialize(env, target);
 
@@ -5815,11 +7362,15 @@ void InitCrypto(Local<Object> target,
   env->SetMethod(target, "getFipsCrypto", GetFipsCrypto);
   env->SetMethod(target, "setFipsCrypto", SetFipsCrypto);
   env->SetMethod(target, "PBKDF2", PBKDF2);
+  env->SetMethod(target, "pbkdf2Batch", PBKDF2Batch);
+  env->SetMethod(target, "verifyBatch", VerifyBatch);
   env->SetMethod(target, "randomBytes", RandomBytes);
+  env->SetMethod(target, "randomBytesPooled", RandomBytesPooled);
   env->SetMethod(target, "getSSLCiphers", GetSSLCiphers);
   env->SetMethod(target, "getCiphers", GetCiphers);
   env->SetMethod(target, "getHashes", GetHashes);
   env->SetMethod(target, "getCurves", GetCurves);
+  env->SetMethod(target, "getBIOBufferPoolStats", GetBIOBufferPoolStats);
   env->SetMethod(target, "publicEncrypt",
                  PublicKeyCipher::Cipher<PublicKeyCipher::kPublic,
                                          EVP_PKEY_encrypt_init,
@@ -30,6 +30,8 @@
 #include <openssl/rand.h>
 #include <openssl/pkcs12.h>
 
+#include <atomic>
+
 #define EVP_F_EVP_DECRYPTFINAL 101
 
 #if !defined(OPENSSL_NO_TLSEXT) && defined(SSL_CTX_set_tlsext_status_cb)
@@ -61,11 +63,61 @@ enum CheckResult {
 
 extern int VerifyCallback(int preverify_ok, X509_STORE_CTX* ctx);
 
-extern X509_STORE* root_cert_store;
-
 // Forward declaration
 class Connection;
 
+#ifndef OPENSSL_NO_ENGINE
+// Binds the RSA private keys of a SecureContext to an engine, through a copy
+// of the engine's RSA_METHOD that counts the operations it is asked to do.
+// Keys can outlive their context in sessions that are still open, so every
+// key that uses the binding holds a reference to it, as does the context.
+class EngineBinding {
+ public:
+  // Takes over a functional reference to an engine that implements RSA.
+  explicit EngineBinding(ENGINE* engine);
+
+  void Bind(EVP_PKEY* pkey);
+  v8::Local<v8::Object> Stats(Environment* env) const;
+
+  inline void Ref() { refs_++; }
+  inline void Unref() {
+    if (--refs_ == 0)
+      delete this;
+  }
+
+ private:
+  ~EngineBinding();
+
+  static EngineBinding* From(const RSA* rsa);
+  static int Init(RSA* rsa);
+  static int Finish(RSA* rsa);
+  static int PrivateEncrypt(int flen,
+                            const unsigned char* from,
+                            unsigned char* to,
+                            RSA* rsa,
+                            int padding);
+  static int PrivateDecrypt(int flen,
+                            const unsigned char* from,
+                            unsigned char* to,
+                            RSA* rsa,
+                            int padding);
+  static int Sign(int type,
+                  const unsigned char* m,
+                  unsigned int m_length,
+                  unsigned char* sigret,
+                  unsigned int* siglen,
+                  const RSA* rsa);
+
+  ENGINE* const engine_;
+  const RSA_METHOD* const engine_rsa_;
+  RSA_METHOD rsa_;
+  std::atomic<uint32_t> refs_;
+  std::atomic<uint64_t> private_encrypts_;
+  std::atomic<uint64_t> private_decrypts_;
+  std::atomic<uint64_t> signs_;
+};
+#endif  // !OPENSSL_NO_ENGINE
+
 class SecureContext : public BaseObject {
  public:
   ~SecureContext() override {
@@ -88,6 +140,23 @@ class SecureContext : public BaseObject {
   static const int kTicketKeyNameIndex = 3;
   static const int kTicketKeyIVIndex = 4;
 
+  // Name, HMAC secret and AES key of the session ticket keys, 16 bytes each.
+  static const int kTicketKeysLength = 48;
+
+  // True if session tickets are encrypted by the JavaScript callback set up
+  // by EnableTicketKeyCallback.
+  inline bool has_ticket_key_callback() const {
+    return ctx_->tlsext_ticket_key_cb == TicketKeyCallback;
+  }
+
+  inline bool has_stapled_ocsp_response() const {
+    return stapled_response_ != nullptr;
+  }
+
+  // Copies the response that was set by SetStapledOCSPResponse, if it hasn't
+  // expired yet, into memory that OpenSSL can take over.
+  bool CopyStapledOCSPResponse(unsigned char** data, size_t* len);
+
  protected:
   static const int64_t kExternalSize = sizeof(SSL_CTX);
 
@@ -112,8 +181,16 @@ class SecureContext : public BaseObject {
   static void SetTicketKeys(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void SetFreeListLength(
       const v8::FunctionCallbackInfo<v8::Value>& args);
+#ifndef OPENSSL_NO_ENGINE
+  static void SetEngine(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void GetEngineStats(const v8::FunctionCallbackInfo<v8::Value>& args);
+#endif  // !OPENSSL_NO_ENGINE
   static void EnableTicketKeyCallback(
       const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void RotateTicketKeys(
+      const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void SetStapledOCSPResponse(
+      const v8::FunctionCallbackInfo<v8::Value>& args);
   static void CtxGetter(v8::Local<v8::String> property,
                         const v8::PropertyCallbackInfo<v8::Value>& info);
 
@@ -126,13 +203,26 @@ class SecureContext : public BaseObject {
                                EVP_CIPHER_CTX* ectx,
                                HMAC_CTX* hctx,
                                int enc);
+  static int RotatingTicketKeyCallback(SSL* ssl,
+                                       unsigned char* name,
+                                       unsigned char* iv,
+                                       EVP_CIPHER_CTX* ectx,
+                                       HMAC_CTX* hctx,
+                                       int enc);
 
   SecureContext(Environment* env, v8::Local<v8::Object> wrap)
       : BaseObject(env, wrap),
         ca_store_(nullptr),
         ctx_(nullptr),
         cert_(nullptr),
-        issuer_(nullptr) {
+        issuer_(nullptr),
+#ifndef OPENSSL_NO_ENGINE
+        engine_binding_(nullptr),
+#endif  // !OPENSSL_NO_ENGINE
+        rotating_ticket_keys_(false),
+        stapled_response_(nullptr),
+        stapled_response_len_(0),
+        stapled_response_expiry_(0) {
     MakeWeak<SecureContext>(this);
     env->isolate()->AdjustAmountOfExternalAllocatedMemory(kExternalSize);
   }
@@ -140,13 +230,6 @@ class SecureContext : public BaseObject {
   void FreeCTXMem() {
     if (ctx_) {
       env()->isolate()->AdjustAmountOfExternalAllocatedMemory(-kExternalSize);
-      if (ctx_->cert_store == root_cert_store) {
-        // SSL_CTX_free() will attempt to free the cert_store as well.
-        // Since we want our root_cert_store to stay around forever
-        // we just clear the field. Hopefully OpenSSL will not modify this
-        // struct in future versions.
-        ctx_->cert_store = nullptr;
-      }
       SSL_CTX_free(ctx_);
       if (cert_ != nullptr)
         X509_free(cert_);
@@ -159,7 +242,34 @@ class SecureContext : public BaseObject {
     } else {
       CHECK_EQ(ca_store_, nullptr);
     }
+#ifndef OPENSSL_NO_ENGINE
+    if (engine_binding_ != nullptr) {
+      engine_binding_->Unref();
+      engine_binding_ = nullptr;
+    }
+#endif  // !OPENSSL_NO_ENGINE
+    free(stapled_response_);
+    stapled_response_ = nullptr;
+    stapled_response_len_ = 0;
   }
+
+#ifndef OPENSSL_NO_ENGINE
+  // Set by SetEngine, the private keys that are set later are bound to it.
+  EngineBinding* engine_binding_;
+#endif  // !OPENSSL_NO_ENGINE
+
+  // Once RotateTicketKeys() has been called tickets are issued with
+  // ticket_keys_, tickets issued with previous_ticket_keys_ are accepted
+  // and renewed.
+  bool rotating_ticket_keys_;
+  unsigned char ticket_keys_[kTicketKeysLength];
+  unsigned char previous_ticket_keys_[kTicketKeysLength];
+
+  // OCSP response that is stapled to the handshakes of the clients that ask
+  // for one, until the loop time reaches stapled_response_expiry_.
+  unsigned char* stapled_response_;
+  size_t stapled_response_len_;
+  uint64_t stapled_response_expiry_;
 };
 
 // SSLWrap implicitly depends on the inheriting class' handle having an
@@ -180,7 +290,8 @@ class SSLWrap {
         new_session_wait_(false),
         cert_cb_(nullptr),
         cert_cb_arg_(nullptr),
-        cert_cb_running_(false) {
+        cert_cb_running_(false),
+        handshake_offloaded_(false) {
     ssl_ = SSL_new(sc->ctx_);
     env_->isolate()->AdjustAmountOfExternalAllocatedMemory(kExternalSize);
     CHECK_NE(ssl_, nullptr);
@@ -306,6 +417,10 @@ class SSLWrap {
   void* cert_cb_arg_;
   bool cert_cb_running_;
 
+  // Set while a handshake step runs on the threadpool, the OpenSSL callbacks
+  // must not enter V8 then.
+  bool handshake_offloaded_;
+
   ClientHelloParser hello_parser_;
 
 #ifdef NODE__HAVE_TLSEXT_STATUS_CB
@@ -448,9 +563,13 @@ class CipherBase : public BaseObject {
   static void Init(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void InitIv(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void Update(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void UpdateAsync(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void Final(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void SetAutoPadding(const v8::FunctionCallbackInfo<v8::Value>& args);
 
+  // Runs Update() in the threadpool, see UpdateAsync
+  class UpdateRequest;
+
   static void GetAuthTag(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void SetAuthTag(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void SetAAD(const v8::FunctionCallbackInfo<v8::Value>& args);
@@ -463,7 +582,8 @@ class CipherBase : public BaseObject {
         initialised_(false),
         kind_(kind),
         auth_tag_(nullptr),
-        auth_tag_len_(0) {
+        auth_tag_len_(0),
+        update_pending_(false) {
     MakeWeak<CipherBase>(this);
   }
 
@@ -474,6 +594,7 @@ class CipherBase : public BaseObject {
   CipherKind kind_;
   char* auth_tag_;
   unsigned int auth_tag_len_;
+  bool update_pending_;
 };
 
 class Hmac : public BaseObject {
@@ -541,6 +662,47 @@ class Hash : public BaseObject {
   bool finalized_;
 };
 
+// A public or private key that is parsed once so that it can be passed to
+// Sign, Verify and PublicKeyCipher instead of a PEM encoded key.
+class KeyObject : public BaseObject {
+ public:
+  ~KeyObject() override {
+    EVP_PKEY_free(pkey_);
+  }
+
+  static void Initialize(Environment* env, v8::Local<v8::Object> target);
+
+  // Returns the KeyObject wrapped by value, or nullptr.
+  static KeyObject* FromValue(Environment* env, v8::Local<v8::Value> value);
+
+  // Returns a new reference to the key, release it with EVP_PKEY_free().
+  inline EVP_PKEY* GetKey() const {
+    CRYPTO_add(&pkey_->references, 1, CRYPTO_LOCK_EVP_PKEY);
+    return pkey_;
+  }
+
+  inline bool is_private() const {
+    return is_private_;
+  }
+
+ protected:
+  static void New(const v8::FunctionCallbackInfo<v8::Value>& args);
+
+  KeyObject(Environment* env,
+            v8::Local<v8::Object> wrap,
+            EVP_PKEY* pkey,
+            bool is_private)
+      : BaseObject(env, wrap),
+        pkey_(pkey),
+        is_private_(is_private) {
+    MakeWeak<KeyObject>(this);
+  }
+
+ private:
+  EVP_PKEY* const pkey_;
+  const bool is_private_;
+};
+
 class SignBase : public BaseObject {
  public:
   typedef enum {
@@ -580,9 +742,7 @@ class Sign : public SignBase {
 
   Error SignInit(const char* sign_type);
   Error SignUpdate(const char* data, int len);
-  Error SignFinal(const char* key_pem,
-                  int key_pem_len,
-                  const char* passphrase,
+  Error SignFinal(EVP_PKEY* pkey,
                   unsigned char** sig,
                   unsigned int *sig_len);
 
@@ -603,8 +763,7 @@ class Verify : public SignBase {
 
   Error VerifyInit(const char* verify_type);
   Error VerifyUpdate(const char* data, int len);
-  Error VerifyFinal(const char* key_pem,
-                    int key_pem_len,
+  Error VerifyFinal(EVP_PKEY* pkey,
                     const char* sig,
                     int siglen,
                     bool* verify_result);
@@ -635,9 +794,7 @@ class PublicKeyCipher {
   template <Operation operation,
             EVP_PKEY_cipher_init_t EVP_PKEY_cipher_init,
             EVP_PKEY_cipher_t EVP_PKEY_cipher>
-  static bool Cipher(const char* key_pem,
-                     int key_pem_len,
-                     const char* passphrase,
+  static bool Cipher(EVP_PKEY* pkey,
                      int padding,
                      const unsigned char* data,
                      int len,
@@ -676,6 +833,10 @@ class DiffieHellman : public BaseObject {
   static void ComputeSecret(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void SetPublicKey(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void SetPrivateKey(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void GenerateKeysAsync(
+      const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void ComputeSecretAsync(
+      const v8::FunctionCallbackInfo<v8::Value>& args);
   static void VerifyErrorGetter(
       v8::Local<v8::String> property,
       const v8::PropertyCallbackInfo<v8::Value>& args);
@@ -689,6 +850,8 @@ class DiffieHellman : public BaseObject {
   }
 
  private:
+  class Request;
+
   bool VerifyContext();
 
   bool initialised_;
@@ -723,6 +886,12 @@ class ECDH : public BaseObject {
   static void SetPrivateKey(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void GetPublicKey(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void SetPublicKey(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void GenerateKeysAsync(
+      const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void ComputeSecretAsync(
+      const v8::FunctionCallbackInfo<v8::Value>& args);
+
+  class Request;
 
   EC_POINT* BufferToPoint(char* data, size_t len);
 
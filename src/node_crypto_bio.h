@@ -93,7 +93,8 @@ class NodeBIO {
 
   // Enough to handle the most of the client hellos
   static const size_t kInitialBufferLength = 1024;
-  static const size_t kThroughputBufferLength = 16384;
+  static const size_t kThroughputBufferLength =
+      Environment::BIOBufferPool::kBlockSize;
 
   static const BIO_METHOD method;
 
@@ -104,13 +105,19 @@ class NodeBIO {
                                            write_pos_(0),
                                            len_(len),
                                            next_(nullptr) {
-      data_ = new char[len];
+      if (env_ != nullptr && len_ == kThroughputBufferLength)
+        data_ = env_->bio_buffer_pool()->Allocate(len_);
+      else
+        data_ = new char[len];
       if (env_ != nullptr)
         env_->isolate()->AdjustAmountOfExternalAllocatedMemory(len);
     }
 
     ~Buffer() {
-      delete[] data_;
+      if (env_ != nullptr && len_ == kThroughputBufferLength)
+        env_->bio_buffer_pool()->Release(data_, len_);
+      else
+        delete[] data_;
       if (env_ != nullptr) {
         const int64_t len = static_cast<int64_t>(len_);
         env_->isolate()->AdjustAmountOfExternalAllocatedMemory(-len);
@@ -0,0 +1,111 @@
+#include "node_dns_cache.h"
+#include "util.h"
+#include "uv.h"
+
+namespace node {
+
+DNSCache::DNSCache(uv_loop_t* loop)
+    : loop_(loop),
+      enabled_(false),
+      ttl_(0),
+      max_entries_(0),
+      hits_(0),
+      misses_(0),
+      coalesced_(0) {
+}
+
+
+void DNSCache::Enable(uint64_t ttl, size_t max_entries) {
+  CHECK_GT(max_entries, 0);
+  enabled_ = true;
+  ttl_ = ttl;
+  max_entries_ = max_entries;
+  while (entries_.size() > max_entries_)
+    Evict();
+}
+
+
+void DNSCache::Disable() {
+  enabled_ = false;
+  entries_.clear();
+}
+
+
+void DNSCache::Clear() {
+  entries_.clear();
+}
+
+
+const DNSCache::Addresses* DNSCache::Get(const std::string& key) {
+  if (!enabled_)
+    return nullptr;
+
+  auto it = entries_.find(key);
+  if (it == entries_.end())
+    return nullptr;
+
+  if (it->second.expiry <= uv_now(loop_)) {
+    entries_.erase(it);
+    return nullptr;
+  }
+
+  hits_ += 1;
+  return &it->second.addresses;
+}
+
+
+bool DNSCache::Join(const std::string& key, Request* req) {
+  auto it = pending_.find(key);
+  if (it == pending_.end()) {
+    misses_ += 1;
+    pending_[key];
+    return false;
+  }
+
+  coalesced_ += 1;
+  it->second.push_back(req);
+  return true;
+}
+
+
+void DNSCache::Done(const std::string& key,
+                    int status,
+                    const Addresses& addresses,
+                    std::vector<Request*>* waiting) {
+  auto it = pending_.find(key);
+  CHECK(it != pending_.end());
+  waiting->swap(it->second);
+  pending_.erase(it);
+
+  if (!enabled_ || status != 0 || addresses.empty())
+    return;
+
+  if (entries_.find(key) == entries_.end() && entries_.size() >= max_entries_)
+    Evict();
+
+  Entry& entry = entries_[key];
+  entry.addresses = addresses;
+  entry.expiry = uv_now(loop_) + ttl_;
+}
+
+
+void DNSCache::Evict() {
+  const uint64_t now = uv_now(loop_);
+  auto oldest = entries_.end();
+
+  for (auto it = entries_.begin(); it != entries_.end();) {
+    if (it->second.expiry <= now) {
+      it = entries_.erase(it);
+      continue;
+    }
+    if (oldest == entries_.end() || it->second.expiry < oldest->second.expiry)
+      oldest = it;
+    ++it;
+  }
+
+  // Nothing had expired, drop the entry that expires first.
+  if (entries_.size() >= max_entries_ && oldest != entries_.end())
+    entries_.erase(oldest);
+}
+
+}  // namespace node
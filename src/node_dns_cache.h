@@ -0,0 +1,78 @@
+#ifndef SRC_NODE_DNS_CACHE_H_
+#define SRC_NODE_DNS_CACHE_H_
+
+#include "util.h"
+#include "uv.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace node {
+
+template <typename T>
+class ReqWrap;
+
+// Keeps the results of dns.lookup() for a fixed time while it is enabled and
+// lets concurrent lookups of the same host share one getaddrinfo() request.
+// getaddrinfo() doesn't report the TTL of the records, so the time is set by
+// the user.  Only successful lookups are cached.
+class DNSCache {
+ public:
+  typedef ReqWrap<uv_getaddrinfo_t> Request;
+  typedef std::vector<std::string> Addresses;
+
+  explicit DNSCache(uv_loop_t* loop);
+
+  // |ttl| is in milliseconds.
+  void Enable(uint64_t ttl, size_t max_entries);
+  // Drops the cached results.  Lookups in progress are still shared.
+  void Disable();
+  // Drops the cached results and stays enabled.
+  void Clear();
+
+  // Returns the addresses that are cached for |key| or nullptr.
+  const Addresses* Get(const std::string& key);
+  // Adds |req| to the lookup of |key| that is in progress and returns true,
+  // or returns false when there is none and |req| has to do the lookup.
+  bool Join(const std::string& key, Request* req);
+  // Called when the lookup of |key| is done.  Caches |addresses| when the
+  // lookup succeeded and moves the requests that joined it into |waiting|.
+  void Done(const std::string& key,
+            int status,
+            const Addresses& addresses,
+            std::vector<Request*>* waiting);
+
+  inline bool enabled() const { return enabled_; }
+  inline size_t size() const { return entries_.size(); }
+  inline double hits() const { return hits_; }
+  inline double misses() const { return misses_; }
+  inline double coalesced() const { return coalesced_; }
+
+ private:
+  struct Entry {
+    Addresses addresses;
+    uint64_t expiry;
+  };
+
+  // Makes room for one more entry.
+  void Evict();
+
+  uv_loop_t* const loop_;
+  bool enabled_;
+  uint64_t ttl_;
+  size_t max_entries_;
+  std::unordered_map<std::string, Entry> entries_;
+  std::unordered_map<std::string, std::vector<Request*>> pending_;
+  double hits_;
+  double misses_;
+  double coalesced_;
+
+  DISALLOW_COPY_AND_ASSIGN(DNSCache);
+};
+
+}  // namespace node
+
+#endif  // SRC_NODE_DNS_CACHE_H_
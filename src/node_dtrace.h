@@ -52,6 +52,34 @@ typedef struct {
 
 }  // extern "C"
 
+/*
+ * Probes on the hot paths.  Each call site tests NODE_*_ENABLED() first, that
+ * is a load of the probe's semaphore, so the arguments are only computed while
+ * a tracer is attached.  Builds without DTrace get macros that do nothing.
+ */
+#ifdef HAVE_DTRACE
+#include "node_provider.h"  // NOLINT(build/include_order)
+#else
+#define NODE_STREAM_READ(arg0, arg1, arg2) do {} while (0)
+#define NODE_STREAM_READ_ENABLED() (0)
+#define NODE_STREAM_WRITE(arg0, arg1) do {} while (0)
+#define NODE_STREAM_WRITE_ENABLED() (0)
+#define NODE_TIMER_FIRE(arg0) do {} while (0)
+#define NODE_TIMER_FIRE_ENABLED() (0)
+#define NODE_CALLBACK_ENTER(arg0, arg1) do {} while (0)
+#define NODE_CALLBACK_ENTER_ENABLED() (0)
+#define NODE_CALLBACK_EXIT(arg0, arg1, arg2) do {} while (0)
+#define NODE_CALLBACK_EXIT_ENABLED() (0)
+#define NODE_FS_START(arg0, arg1) do {} while (0)
+#define NODE_FS_START_ENABLED() (0)
+#define NODE_FS_DONE(arg0, arg1, arg2) do {} while (0)
+#define NODE_FS_DONE_ENABLED() (0)
+#define NODE_THREADPOOL_ENQUEUE(arg0) do {} while (0)
+#define NODE_THREADPOOL_ENQUEUE_ENABLED() (0)
+#define NODE_THREADPOOL_DEQUEUE(arg0) do {} while (0)
+#define NODE_THREADPOOL_DEQUEUE_ENABLED() (0)
+#endif
+
 namespace node {
 
 void InitDTrace(Environment* env, v8::Local<v8::Object> target);
@@ -1,8 +1,10 @@
 #include "node.h"
 #include "node_file.h"
 #include "node_buffer.h"
+#include "node_dtrace.h"
 #include "node_internals.h"
 #include "node_stat_watcher.h"
+#include "node_trace.h"
 
 #include "env.h"
 #include "env-inl.h"
@@ -20,15 +22,23 @@
 
 #if defined(__MINGW32__) || defined(_MSC_VER)
 # include <io.h>
+#else
+# include <sys/mman.h>
+# include <unistd.h>
 #endif
 
+#include <string>
+#include <unordered_map>
 #include <vector>
 
 namespace node {
 
 using v8::Array;
+using v8::ArrayBuffer;
 using v8::Context;
 using v8::EscapableHandleScope;
+using v8::Exception;
+using v8::Float64Array;
 using v8::Function;
 using v8::FunctionCallbackInfo;
 using v8::FunctionTemplate;
@@ -38,7 +48,9 @@ using v8::Isolate;
 using v8::Local;
 using v8::Number;
 using v8::Object;
+using v8::Promise;
 using v8::String;
+using v8::Symbol;
 using v8::Value;
 
 #ifndef MIN
@@ -69,9 +81,18 @@ class FSReqWrap: public ReqWrap<uv_fs_t> {
     }
   }
 
+  // Requests from fs.promises settle a promise instead of calling back.
+  void SetPromise(Local<Promise::Resolver> resolver) {
+    resolver_.Reset(env()->isolate(), resolver);
+  }
+  bool has_promise() const { return !resolver_.IsEmpty(); }
+  inline void Settle(int argc, Local<Value>* argv);
+
   const char* syscall() const { return syscall_; }
   const char* data() const { return data_; }
   const enum encoding encoding_;
+  bool with_types_;  // Report dirent types from scandir.
+  bool sync_;  // Failed before it was dispatched, After() runs from JS.
 
   size_t self_size() const override { return sizeof(*this); }
 
@@ -83,12 +104,18 @@ class FSReqWrap: public ReqWrap<uv_fs_t> {
             enum encoding encoding)
       : ReqWrap(env, req, AsyncWrap::PROVIDER_FSREQWRAP),
         encoding_(encoding),
+        with_types_(false),
+        sync_(false),
         syscall_(syscall),
-        data_(data) {
+        data_(data),
+        storage_size_(0) {
     Wrap(object(), this);
   }
 
-  ~FSReqWrap() { ReleaseEarly(); }
+  ~FSReqWrap() {
+    ReleaseEarly();
+    resolver_.Reset();
+  }
 
   void* operator new(size_t size) = delete;
   void* operator new(size_t size, char* storage) { return storage; }
@@ -96,10 +123,17 @@ class FSReqWrap: public ReqWrap<uv_fs_t> {
 
   const char* syscall_;
   const char* data_;
+  size_t storage_size_;
+  v8::Persistent<Promise::Resolver> resolver_;
 
   DISALLOW_COPY_AND_ASSIGN(FSReqWrap);
 };
 
+// Asynchronous calls take a request object, or kUsePromises from fs.promises.
+static inline bool IsAsyncRequest(Local<Value> req) {
+  return req->IsObject() || req->IsSymbol();
+}
+
 #define ASSERT_PATH(path)                                                   \
   if (*path == nullptr)                                                     \
     return TYPE_ERROR( #path " must be a string or Buffer");
@@ -113,17 +147,143 @@ FSReqWrap* FSReqWrap::New(Environment* env,
   const bool copy = (data != nullptr && ownership == COPY);
   const size_t size = copy ? 1 + strlen(data) : 0;
   FSReqWrap* that;
-  char* const storage = new char[sizeof(*that) + size];
+  const size_t storage_size = sizeof(*that) + size;
+  char* const storage = env->req_storage_pool()->Allocate(storage_size);
   that = new(storage) FSReqWrap(env, req, syscall, data, encoding);
+  that->storage_size_ = storage_size;
   if (copy)
     that->data_ = static_cast<char*>(memcpy(that->inline_data(), data, size));
   return that;
 }
 
 
+// Resolves the promise with the result, or rejects it with the error.  When
+// there is more than one result, it resolves to an array of them.  Like
+// MakeCallback(), the microtasks and the nextTick queue run afterwards unless
+// this was called from JS, so the await that waits for the request resumes
+// right away and without a callback of its own.
+void FSReqWrap::Settle(int argc, Local<Value>* argv) {
+  Environment* env = this->env();
+  Local<Context> context = env->context();
+  Local<Promise::Resolver> resolver =
+      PersistentToLocal(env->isolate(), resolver_);
+  Environment::AsyncCallbackScope callback_scope(env);
+
+  if (argc > 0 && !argv[0]->IsNull()) {
+    resolver->Reject(context, argv[0]).FromJust();
+  } else if (argc > 2) {
+    Local<Array> results = Array::New(env->isolate(), argc - 1);
+    for (int i = 1; i < argc; i++)
+      results->Set(context, i - 1, argv[i]).FromJust();
+    resolver->Resolve(context, results).FromJust();
+  } else {
+    Local<Value> result =
+        argc > 1 ? argv[1] : Undefined(env->isolate()).As<Value>();
+    resolver->Resolve(context, result).FromJust();
+  }
+
+  if (callback_scope.in_makecallback() || sync_)
+    return;
+  if (env->in_tick_batch())
+    return env->set_tick_batch_pending(true);
+
+  Environment::TickInfo* tick_info = env->tick_info();
+  if (tick_info->length() == 0)
+    env->isolate()->RunMicrotasks();
+  if (tick_info->length() == 0)
+    return tick_info->set_index(0);
+  env->tick_callback_function()->Call(env->process_object(), 0, nullptr);
+}
+
+
 void FSReqWrap::Dispose() {
+  Environment* env = this->env();
+  const size_t storage_size = storage_size_;
   this->~FSReqWrap();
-  delete[] reinterpret_cast<char*>(this);
+  env->req_storage_pool()->Release(reinterpret_cast<char*>(this),
+                                   storage_size);
+}
+
+
+// A request that was made without a callback.  Nothing in JS waits for it,
+// so it has no JS object and isn't a ReqWrap: it is recycled as soon as it
+// completes, and only an error is reported, by OnDetachedErrorsCheck.
+class DetachedFSReq {
+ public:
+  inline static DetachedFSReq* New(Environment* env, const char* syscall) {
+    DetachedFSReq* that;
+    char* const storage =
+        env->req_storage_pool()->Allocate(sizeof(*that));
+    that = new(storage) DetachedFSReq(env, syscall);
+    return that;
+  }
+
+  static void After(uv_fs_t* req) {
+    DetachedFSReq* that = ContainerOf(&DetachedFSReq::req_, req);
+    Environment* env = that->env_;
+
+    if (req->result < 0) {
+      std::vector<Environment::DetachedFSError>* errors =
+          env->detached_fs_errors();
+      if (errors->empty())
+        uv_check_start(env->fs_errors_check_handle(), OnDetachedErrorsCheck);
+      errors->push_back({ static_cast<int>(req->result), that->syscall_ });
+    }
+
+    uv_fs_req_cleanup(req);
+    that->~DetachedFSReq();
+    env->req_storage_pool()->Release(reinterpret_cast<char*>(that),
+                                     sizeof(*that));
+  }
+
+  uv_fs_t req_;
+
+ private:
+  DetachedFSReq(Environment* env, const char* syscall)
+      : env_(env), syscall_(syscall) {}
+
+  void* operator new(size_t size) = delete;
+  void* operator new(size_t size, char* storage) { return storage; }
+
+  static void OnDetachedErrorsCheck(uv_check_t* handle) {
+    Environment* env = Environment::from_fs_errors_check_handle(handle);
+    uv_check_stop(handle);
+
+    std::vector<Environment::DetachedFSError> errors;
+    errors.swap(*env->detached_fs_errors());
+
+    HandleScope handle_scope(env->isolate());
+    Context::Scope context_scope(env->context());
+    Local<Function> fn = env->fs_detached_errors_function();
+    if (fn.IsEmpty())
+      return;
+
+    Local<Array> exceptions = Array::New(env->isolate(), errors.size());
+    for (size_t i = 0; i < errors.size(); i++) {
+      exceptions->Set(i, UVException(env->isolate(),
+                                     errors[i].code,
+                                     errors[i].syscall));
+    }
+    Local<Value> argv[] = { exceptions };
+    MakeCallback(env, env->process_object().As<Value>(), fn,
+                 arraysize(argv), argv);
+  }
+
+  Environment* const env_;
+  const char* const syscall_;
+
+  DISALLOW_COPY_AND_ASSIGN(DetachedFSReq);
+};
+
+
+// setDetachedErrorsCallback(fn) sets the function that is called with an
+// array of the errors of the requests that were passed `true` instead of an
+// FSReqWrap object.
+static void SetDetachedErrorsCallback(
+    const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  CHECK(args[0]->IsFunction());
+  env->set_fs_detached_errors_function(args[0].As<Function>());
 }
 
 
@@ -141,6 +301,10 @@ static void After(uv_fs_t *req) {
   CHECK_EQ(&req_wrap->req_, req);
   req_wrap->ReleaseEarly();  // Free memory that's no longer used now.
 
+  if (NODE_FS_DONE_ENABLED())
+    NODE_FS_DONE(req, req_wrap->syscall(), static_cast<int>(req->result));
+  NODE_TRACE_ASYNC_END0("node.fs", req_wrap->syscall(), req_wrap);
+
   Environment* env = req_wrap->env();
   HandleScope handle_scope(env->isolate());
   Context::Scope context_scope(env->context());
@@ -148,9 +312,9 @@ static void After(uv_fs_t *req) {
   // there is always at least one argument. "error"
   int argc = 1;
 
-  // Allocate space for two args. We may only use one depending on the case.
+  // Allocate space for three args. We may only use one depending on the case.
   // (Feel free to increase this if you need more)
-  Local<Value> argv[2];
+  Local<Value> argv[3];
   Local<Value> link;
 
   if (req->result < 0) {
@@ -266,10 +430,14 @@ static void After(uv_fs_t *req) {
         {
           int r;
           Local<Array> names = Array::New(env->isolate(), 0);
+          Local<Array> types;
           Local<Function> fn = env->push_values_to_array_function();
           Local<Value> name_argv[NODE_PUSH_VAL_TO_ARRAY_MAX];
           size_t name_idx = 0;
 
+          if (req_wrap->with_types_)
+            types = Array::New(env->isolate(), 0);
+
           for (int i = 0; ; i++) {
             uv_dirent_t ent;
 
@@ -297,6 +465,8 @@ static void After(uv_fs_t *req) {
               break;
             }
             name_argv[name_idx++] = filename;
+            if (req_wrap->with_types_)
+              types->Set(i, Integer::New(env->isolate(), ent.type));
 
             if (name_idx >= arraysize(name_argv)) {
               fn->Call(env->context(), names, name_idx, name_argv)
@@ -311,6 +481,10 @@ static void After(uv_fs_t *req) {
           }
 
           argv[1] = names;
+          if (req_wrap->with_types_) {
+            argv[2] = types;
+            argc = 3;
+          }
         }
         break;
 
@@ -319,7 +493,10 @@ static void After(uv_fs_t *req) {
     }
   }
 
-  req_wrap->MakeCallback(env->oncomplete_string(), argc, argv);
+  if (req_wrap->has_promise())
+    req_wrap->Settle(argc, argv);
+  else
+    req_wrap->MakeCallback(env->oncomplete_string(), argc, argv);
 
   uv_fs_req_cleanup(&req_wrap->req_);
   req_wrap->Dispose();
@@ -335,11 +512,26 @@ struct fs_req_wrap {
 };
 
 
+// |req| is a request object, or kUsePromises.  Requests for the latter get an
+// object of their own and return its promise.
 #define ASYNC_DEST_CALL(func, req, dest, encoding, ...)                       \
   Environment* env = Environment::GetCurrent(args);                           \
-  CHECK(req->IsObject());                                                     \
-  FSReqWrap* req_wrap = FSReqWrap::New(env, req.As<Object>(),                 \
-                                       #func, dest, encoding);                \
+  const bool use_promise = req->IsSymbol();                                   \
+  CHECK(use_promise ? req->StrictEquals(env->fs_use_promises_symbol())        \
+                    : req->IsObject());                                       \
+  FSReqWrap* req_wrap =                                                       \
+      FSReqWrap::New(env,                                                     \
+                     use_promise ? env->NewInternalFieldObject()              \
+                                 : req.As<Object>(),                          \
+                     #func, dest, encoding);                                  \
+  Local<Promise::Resolver> resolver;                                          \
+  if (use_promise) {                                                          \
+    resolver = Promise::Resolver::New(env->context()).ToLocalChecked();       \
+    req_wrap->SetPromise(resolver);                                           \
+  }                                                                           \
+  if (NODE_FS_START_ENABLED())                                                \
+    NODE_FS_START(&req_wrap->req_, req_wrap->syscall());                      \
+  NODE_TRACE_ASYNC_BEGIN0("node.fs", req_wrap->syscall(), req_wrap);          \
   int err = uv_fs_ ## func(env->event_loop(),                                 \
                            &req_wrap->req_,                                   \
                            __VA_ARGS__,                                       \
@@ -349,15 +541,30 @@ struct fs_req_wrap {
     uv_fs_t* uv_req = &req_wrap->req_;                                        \
     uv_req->result = err;                                                     \
     uv_req->path = nullptr;                                                   \
+    req_wrap->sync_ = true;                                                   \
     After(uv_req);                                                            \
     req_wrap = nullptr;                                                       \
-  } else {                                                                    \
+  }                                                                           \
+  if (use_promise)                                                            \
+    args.GetReturnValue().Set(resolver->GetPromise());                        \
+  else if (err >= 0)                                                          \
     args.GetReturnValue().Set(req_wrap->persistent());                        \
-  }
 
 #define ASYNC_CALL(func, req, encoding, ...)                                  \
   ASYNC_DEST_CALL(func, req, nullptr, encoding, __VA_ARGS__)                  \
 
+#define DETACHED_CALL(func, ...)                                              \
+  Environment* env = Environment::GetCurrent(args);                           \
+  DetachedFSReq* detached = DetachedFSReq::New(env, #func);                   \
+  int err = uv_fs_ ## func(env->event_loop(),                                 \
+                           &detached->req_,                                   \
+                           __VA_ARGS__,                                       \
+                           DetachedFSReq::After);                             \
+  if (err < 0) {                                                              \
+    detached->req_.result = err;                                              \
+    DetachedFSReq::After(&detached->req_);                                    \
+  }                                                                           \
+
 #define SYNC_DEST_CALL(func, path, dest, ...)                                 \
   fs_req_wrap req_wrap;                                                       \
   env->PrintSyncTrace();                                                      \
@@ -390,7 +597,7 @@ static void Access(const FunctionCallbackInfo<Value>& args) {
 
   int mode = static_cast<int>(args[1]->Int32Value());
 
-  if (args[2]->IsObject()) {
+  if (IsAsyncRequest(args[2])) {
     ASYNC_CALL(access, args[2], UTF8, *path, mode);
   } else {
     SYNC_CALL(access, *path, *path, mode);
@@ -408,8 +615,10 @@ static void Close(const FunctionCallbackInfo<Value>& args) {
 
   int fd = args[0]->Int32Value();
 
-  if (args[1]->IsObject()) {
+  if (IsAsyncRequest(args[1])) {
     ASYNC_CALL(close, args[1], UTF8, fd)
+  } else if (args[1]->IsTrue()) {
+    DETACHED_CALL(close, fd)
   } else {
     SYNC_CALL(close, 0, fd)
   }
@@ -516,33 +725,27 @@ Local<Value> BuildStatsObject(Environment* env, const uv_stat_t* s) {
   return handle_scope.Escape(stats);
 }
 
-// Used to speed up module loading.  Returns the contents of the file as
-// a string or undefined when the file cannot be opened.  The speedup
-// comes from not creating Error objects on failure.
-static void InternalModuleReadFile(const FunctionCallbackInfo<Value>& args) {
-  Environment* env = Environment::GetCurrent(args);
-  uv_loop_t* loop = env->event_loop();
-
-  CHECK(args[0]->IsString());
-  node::Utf8Value path(env->isolate(), args[0]);
-
+// Reads the whole file into |chars|.  Returns false when the file cannot be
+// opened.
+static bool ReadModuleFile(uv_loop_t* loop,
+                           const char* path,
+                           std::vector<char>* chars) {
   uv_fs_t open_req;
-  const int fd = uv_fs_open(loop, &open_req, *path, O_RDONLY, 0, nullptr);
+  const int fd = uv_fs_open(loop, &open_req, path, O_RDONLY, 0, nullptr);
   uv_fs_req_cleanup(&open_req);
 
   if (fd < 0) {
-    return;
+    return false;
   }
 
-  std::vector<char> chars;
   int64_t offset = 0;
   for (;;) {
     const size_t kBlockSize = 32 << 10;
-    const size_t start = chars.size();
-    chars.resize(start + kBlockSize);
+    const size_t start = chars->size();
+    chars->resize(start + kBlockSize);
 
     uv_buf_t buf;
-    buf.base = &chars[start];
+    buf.base = &(*chars)[start];
     buf.len = kBlockSize;
 
     uv_fs_t read_req;
@@ -552,7 +755,7 @@ static void InternalModuleReadFile(const FunctionCallbackInfo<Value>& args) {
 
     CHECK_GE(numchars, 0);
     if (static_cast<size_t>(numchars) < kBlockSize) {
-      chars.resize(start + numchars);
+      chars->resize(start + numchars);
     }
     if (numchars == 0) {
       break;
@@ -563,38 +766,350 @@ static void InternalModuleReadFile(const FunctionCallbackInfo<Value>& args) {
   uv_fs_t close_req;
   CHECK_EQ(0, uv_fs_close(loop, &close_req, fd, nullptr));
   uv_fs_req_cleanup(&close_req);
+  return true;
+}
 
+static Local<String> ModuleFileToString(Isolate* isolate,
+                                        const std::vector<char>& chars) {
   size_t start = 0;
   if (chars.size() >= 3 && 0 == memcmp(&chars[0], "\xEF\xBB\xBF", 3)) {
     start = 3;  // Skip UTF-8 BOM.
   }
 
-  Local<String> chars_string =
-      String::NewFromUtf8(env->isolate(),
-                          &chars[start],
-                          String::kNormalString,
-                          chars.size() - start);
-  args.GetReturnValue().Set(chars_string);
+  return String::NewFromUtf8(isolate,
+                             chars.data() + start,
+                             String::kNormalString,
+                             chars.size() - start);
 }
 
-// Used to speed up module loading.  Returns 0 if the path refers to
-// a file, 1 when it's a directory or < 0 on error (usually -ENOENT.)
-// The speedup comes from not creating thousands of Stat and Error objects.
-static void InternalModuleStat(const FunctionCallbackInfo<Value>& args) {
+// Used to speed up module loading.  Returns the contents of the file as
+// a string or undefined when the file cannot be opened.  The speedup
+// comes from not creating Error objects on failure.
+static void InternalModuleReadFile(const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args);
 
   CHECK(args[0]->IsString());
   node::Utf8Value path(env->isolate(), args[0]);
 
+  std::vector<char> chars;
+  if (!ReadModuleFile(env->event_loop(), *path, &chars)) {
+    return;
+  }
+
+  args.GetReturnValue().Set(ModuleFileToString(env->isolate(), chars));
+}
+
+// Results of the file system lookups done by the module resolver.  The stat
+// and realpath results are only kept while the cache is enabled, which
+// lib/module.js does for the duration of a top-level require() or, with
+// NODE_PERSISTENT_MODULE_CACHE=1, for the lifetime of the process.  Like the
+// package.json cache in lib/module.js, the "main" fields of the package.json
+// files are always cached.  All of it is process-wide: module resolution
+// only ever happens on the main thread.
+struct PackageMain {
+  enum Status { kNone, kMain, kUnknown };
+  Status status;
+  std::string main;
+};
+
+static bool module_cache_enabled = false;
+static std::unordered_map<std::string, int> module_stat_cache;
+static std::unordered_map<std::string, std::string> module_realpath_cache;
+static std::unordered_map<std::string, PackageMain> module_package_cache;
+
+#ifdef _WIN32
+static const char kModulePathSep = '\\';
+static inline bool IsModulePathSep(char c) { return c == '\\' || c == '/'; }
+#else
+static const char kModulePathSep = '/';
+static inline bool IsModulePathSep(char c) { return c == '/'; }
+#endif
+
+static int ModuleStat(uv_loop_t* loop, const std::string& path) {
+  if (module_cache_enabled) {
+    auto it = module_stat_cache.find(path);
+    if (it != module_stat_cache.end())
+      return it->second;
+  }
+
   uv_fs_t req;
-  int rc = uv_fs_stat(env->event_loop(), &req, *path, nullptr);
+  int rc = uv_fs_stat(loop, &req, path.c_str(), nullptr);
   if (rc == 0) {
     const uv_stat_t* const s = static_cast<const uv_stat_t*>(req.ptr);
     rc = !!(s->st_mode & S_IFDIR);
   }
   uv_fs_req_cleanup(&req);
 
-  args.GetReturnValue().Set(rc);
+  if (module_cache_enabled)
+    module_stat_cache[path] = rc;
+  return rc;
+}
+
+// Used to speed up module loading.  Returns 0 if the path refers to
+// a file, 1 when it's a directory or < 0 on error (usually -ENOENT.)
+// The speedup comes from not creating thousands of Stat and Error objects.
+static void InternalModuleStat(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+
+  CHECK(args[0]->IsString());
+  node::Utf8Value path(env->isolate(), args[0]);
+
+  args.GetReturnValue().Set(ModuleStat(env->event_loop(), *path));
+}
+
+// Returns the realpath of |path| or undefined on error, in which case the
+// caller falls back to fs.realpathSync() to get a proper exception.
+static void InternalModuleRealpath(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+
+  CHECK(args[0]->IsString());
+  node::Utf8Value path_value(env->isolate(), args[0]);
+  const std::string path(*path_value, path_value.length());
+
+  std::string result;
+  auto it = module_realpath_cache.find(path);
+  if (it != module_realpath_cache.end()) {
+    result = it->second;
+  } else {
+    uv_fs_t req;
+    const int rc = uv_fs_realpath(env->event_loop(), &req, path.c_str(),
+                                  nullptr);
+    if (rc == 0)
+      result = static_cast<const char*>(req.ptr);
+    uv_fs_req_cleanup(&req);
+    if (rc != 0)
+      return;
+    if (module_cache_enabled)
+      module_realpath_cache[path] = result;
+  }
+
+  args.GetReturnValue().Set(
+      String::NewFromUtf8(env->isolate(), result.data(),
+                          String::kNormalString, result.size()));
+}
+
+// Turns the stat and realpath caches on or off.  Turning them off empties
+// them; passing true as the second argument empties all of the caches.
+static void SetModuleCacheEnabled(const FunctionCallbackInfo<Value>& args) {
+  const bool clear = args[1]->IsTrue();
+  module_cache_enabled = args[0]->IsTrue();
+  if (!module_cache_enabled || clear) {
+    module_stat_cache.clear();
+    module_realpath_cache.clear();
+  }
+  if (clear)
+    module_package_cache.clear();
+}
+
+// Joins |base| and |name| and normalizes the result like path.resolve()
+// does.  Returns false for the cases that are left to lib/module.js, like
+// an absolute |name| or a UNC path on Windows.
+static bool ResolveModulePath(const std::string& base,
+                              const std::string& name,
+                              std::string* result) {
+  if (!name.empty() && IsModulePathSep(name[0]))
+    return false;
+#ifdef _WIN32
+  if (name.size() >= 2 && name[1] == ':')
+    return false;
+  if (base.size() < 3 || base[1] != ':' || !IsModulePathSep(base[2]))
+    return false;
+  const size_t root = 3;
+#else
+  if (base.empty() || base[0] != '/')
+    return false;
+  const size_t root = 1;
+#endif
+
+  std::vector<std::string> parts;
+  const std::string path = base.substr(root) + kModulePathSep + name;
+  size_t start = 0;
+  while (start <= path.size()) {
+    size_t end = start;
+    while (end < path.size() && !IsModulePathSep(path[end]))
+      end += 1;
+    const std::string part = path.substr(start, end - start);
+    if (part == "..") {
+      if (!parts.empty())
+        parts.pop_back();
+    } else if (!part.empty() && part != ".") {
+      parts.push_back(part);
+    }
+    start = end + 1;
+  }
+
+  *result = base.substr(0, root);
+  for (size_t i = 0; i < parts.size(); i += 1) {
+    if (i > 0)
+      *result += kModulePathSep;
+    *result += parts[i];
+  }
+  return true;
+}
+
+static PackageMain::Status ReadPackageMain(Environment* env,
+                                           const std::string& dir,
+                                           std::string* main) {
+  auto it = module_package_cache.find(dir);
+  if (it != module_package_cache.end()) {
+    *main = it->second.main;
+    return it->second.status;
+  }
+
+  PackageMain entry;
+  entry.status = PackageMain::kNone;
+
+  std::vector<char> chars;
+  std::string json_path = dir;
+  if (json_path.empty() || !IsModulePathSep(json_path.back()))
+    json_path += kModulePathSep;
+  json_path += "package.json";
+
+  if (ReadModuleFile(env->event_loop(), json_path.c_str(), &chars)) {
+    // JSON.parse(json).main, as done by readPackage() in lib/module.js.
+    // Anything that doesn't produce a string or a falsy value is left to
+    // lib/module.js so it can throw the usual exceptions.
+    Isolate* isolate = env->isolate();
+    v8::TryCatch try_catch(isolate);
+    Local<String> json = ModuleFileToString(isolate, chars);
+    Local<Value> pkg;
+    Local<Value> value;
+    if (!v8::JSON::Parse(isolate, json).ToLocal(&pkg) ||
+        pkg->IsNull() || pkg->IsUndefined()) {
+      entry.status = PackageMain::kUnknown;
+    } else if (pkg->IsObject()) {
+      Local<String> key = FIXED_ONE_BYTE_STRING(isolate, "main");
+      if (!pkg.As<Object>()->Get(env->context(), key).ToLocal(&value)) {
+        entry.status = PackageMain::kUnknown;
+      } else if (value->IsString()) {
+        node::Utf8Value main_value(isolate, value);
+        entry.main.assign(*main_value, main_value.length());
+        if (!entry.main.empty())
+          entry.status = PackageMain::kMain;
+      } else if (value->BooleanValue()) {
+        entry.status = PackageMain::kUnknown;
+      }
+    }
+  }
+
+  // Parse errors aren't cached so that lib/module.js sees them every time.
+  if (entry.status != PackageMain::kUnknown)
+    module_package_cache[dir] = entry;
+  *main = entry.main;
+  return entry.status;
+}
+
+enum ModuleLookup { kModuleFound, kModuleNotFound, kModuleUnknown };
+
+static bool TryModuleExtensions(uv_loop_t* loop,
+                                const std::string& base,
+                                const std::vector<std::string>& exts,
+                                std::string* result) {
+  for (const std::string& ext : exts) {
+    const std::string filename = base + ext;
+    if (ModuleStat(loop, filename) == 0) {
+      *result = filename;
+      return true;
+    }
+  }
+  return false;
+}
+
+// Mirrors tryPackage() in lib/module.js.
+static ModuleLookup TryModulePackage(Environment* env,
+                                     const std::string& dir,
+                                     const std::vector<std::string>& exts,
+                                     std::string* result) {
+  uv_loop_t* loop = env->event_loop();
+  std::string main;
+  std::string filename;
+  std::string index;
+
+  switch (ReadPackageMain(env, dir, &main)) {
+    case PackageMain::kNone:
+      return kModuleNotFound;
+    case PackageMain::kUnknown:
+      return kModuleUnknown;
+    case PackageMain::kMain:
+      break;
+  }
+
+  if (!ResolveModulePath(dir, main, &filename) ||
+      !ResolveModulePath(filename, "index", &index)) {
+    return kModuleUnknown;
+  }
+
+  if (ModuleStat(loop, filename) == 0) {
+    *result = filename;
+    return kModuleFound;
+  }
+  if (TryModuleExtensions(loop, filename, exts, result) ||
+      TryModuleExtensions(loop, index, exts, result)) {
+    return kModuleFound;
+  }
+  return kModuleNotFound;
+}
+
+// Used to speed up module loading.  Does all the probing that
+// Module._findPath() in lib/module.js does for a single lookup path:
+// the path itself, the path with each of the extensions, the "main" field
+// of its package.json and its index file.  Returns the filename, false when
+// nothing was found or undefined when lib/module.js has to do the lookup
+// itself, for example because a package.json doesn't parse.
+static void InternalModuleResolve(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  uv_loop_t* loop = env->event_loop();
+
+  CHECK(args[0]->IsString());
+  CHECK(args[1]->IsArray());
+  node::Utf8Value base_value(env->isolate(), args[0]);
+  const std::string base(*base_value, base_value.length());
+  const bool trailing_slash = args[2]->IsTrue();
+
+  Local<Array> exts_array = args[1].As<Array>();
+  std::vector<std::string> exts;
+  for (uint32_t i = 0; i < exts_array->Length(); i += 1) {
+    node::Utf8Value ext(env->isolate(), exts_array->Get(i));
+    exts.emplace_back(*ext, ext.length());
+  }
+
+  std::string filename;
+  ModuleLookup lookup = kModuleNotFound;
+
+  if (!trailing_slash) {
+    // 0 for a file, 1 for a directory.
+    const int rc = ModuleStat(loop, base);
+    if (rc == 0) {
+      filename = base;
+      lookup = kModuleFound;
+    } else if (rc == 1) {
+      lookup = TryModulePackage(env, base, exts, &filename);
+    }
+
+    if (lookup == kModuleNotFound &&
+        TryModuleExtensions(loop, base, exts, &filename)) {
+      lookup = kModuleFound;
+    }
+  }
+
+  if (lookup == kModuleNotFound)
+    lookup = TryModulePackage(env, base, exts, &filename);
+
+  if (lookup == kModuleNotFound) {
+    std::string index;
+    if (!ResolveModulePath(base, "index", &index))
+      lookup = kModuleUnknown;
+    else if (TryModuleExtensions(loop, index, exts, &filename))
+      lookup = kModuleFound;
+  }
+
+  if (lookup == kModuleFound) {
+    args.GetReturnValue().Set(
+        String::NewFromUtf8(env->isolate(), filename.data(),
+                            String::kNormalString, filename.size()));
+  } else if (lookup == kModuleNotFound) {
+    args.GetReturnValue().Set(false);
+  }
 }
 
 static void Stat(const FunctionCallbackInfo<Value>& args) {
@@ -606,7 +1121,7 @@ static void Stat(const FunctionCallbackInfo<Value>& args) {
   BufferValue path(env->isolate(), args[0]);
   ASSERT_PATH(path)
 
-  if (args[1]->IsObject()) {
+  if (IsAsyncRequest(args[1])) {
     ASYNC_CALL(stat, args[1], UTF8, *path)
   } else {
     SYNC_CALL(stat, *path, *path)
@@ -624,7 +1139,7 @@ static void LStat(const FunctionCallbackInfo<Value>& args) {
   BufferValue path(env->isolate(), args[0]);
   ASSERT_PATH(path)
 
-  if (args[1]->IsObject()) {
+  if (IsAsyncRequest(args[1])) {
     ASYNC_CALL(lstat, args[1], UTF8, *path)
   } else {
     SYNC_CALL(lstat, *path, *path)
@@ -643,7 +1158,7 @@ static void FStat(const FunctionCallbackInfo<Value>& args) {
 
   int fd = args[0]->Int32Value();
 
-  if (args[1]->IsObject()) {
+  if (IsAsyncRequest(args[1])) {
     ASYNC_CALL(fstat, args[1], UTF8, fd)
   } else {
     SYNC_CALL(fstat, 0, fd)
@@ -652,6 +1167,528 @@ static void FStat(const FunctionCallbackInfo<Value>& args) {
   }
 }
 
+// Stats many paths with a handful of threadpool jobs instead of one request
+// per path.  The results are packed into a Float64Array, kStatsFields numbers
+// per path in the order BuildStatsObject() passes them to fs.Stats.  Paths
+// that could not be stat'ed get an exception at their index in a sparse
+// errors array instead.
+class StatManyRequest : public AsyncWrap {
+ public:
+  static const size_t kStatsFields = 14;
+
+  StatManyRequest(Environment* env,
+                  Local<Object> object,
+                  std::vector<std::string>* paths,
+                  bool lstat)
+      : AsyncWrap(env, object, AsyncWrap::PROVIDER_FSREQWRAP),
+        loop_(env->event_loop()),
+        lstat_(lstat),
+        fields_(paths->size() * kStatsFields),
+        errors_(paths->size()),
+        pending_(0) {
+    paths_.swap(*paths);
+    Wrap(object, this);
+  }
+
+  ~StatManyRequest() override {
+    persistent().Reset();
+  }
+
+  void Queue() {
+    const size_t count = paths_.size();
+    size_t slices = count / kMinSliceSize;
+    if (slices < 1)
+      slices = 1;
+    if (slices > kMaxSlices)
+      slices = kMaxSlices;
+    size_t slice_size = (count + slices - 1) / slices;
+
+    for (size_t i = 0; i < slices; i++) {
+      Slice* slice = &slices_[i];
+      slice->req = this;
+      slice->start = i * slice_size;
+      slice->end = slice->start + slice_size;
+      if (slice->end > count)
+        slice->end = count;
+      pending_++;
+      uv_queue_work(loop_, &slice->work_req, Work, After);
+    }
+  }
+
+  size_t self_size() const override { return sizeof(*this); }
+
+ private:
+  static const size_t kMaxSlices = 4;
+  static const size_t kMinSliceSize = 64;
+
+  struct Slice {
+    uv_work_t work_req;
+    StatManyRequest* req;
+    size_t start;
+    size_t end;
+  };
+
+  void StatRange(size_t start, size_t end) {
+    for (size_t i = start; i < end; i++) {
+      uv_fs_t req;
+      const char* path = paths_[i].c_str();
+      int err = lstat_ ? uv_fs_lstat(loop_, &req, path, nullptr)
+                       : uv_fs_stat(loop_, &req, path, nullptr);
+      errors_[i] = err;
+      if (err == 0)
+        Fill(&fields_[i * kStatsFields], static_cast<uv_stat_t*>(req.ptr));
+      uv_fs_req_cleanup(&req);
+    }
+  }
+
+  static void Fill(double* fields, const uv_stat_t* s) {
+#define X(name) static_cast<double>(s->st_##name)
+#define T(name)                                                               \
+  (static_cast<double>(s->st_##name.tv_sec) * 1000) +                         \
+  (static_cast<double>(s->st_##name.tv_nsec / 1000000))
+    fields[0] = X(dev);
+    fields[1] = X(mode);
+    fields[2] = X(nlink);
+    fields[3] = X(uid);
+    fields[4] = X(gid);
+    fields[5] = X(rdev);
+# if defined(__POSIX__)
+    fields[6] = X(blksize);
+# else
+    fields[6] = 0;  // Replaced with undefined in JS land.
+# endif
+    fields[7] = X(ino);
+    fields[8] = X(size);
+# if defined(__POSIX__)
+    fields[9] = X(blocks);
+# else
+    fields[9] = 0;
+# endif
+    fields[10] = T(atim);
+    fields[11] = T(mtim);
+    fields[12] = T(ctim);
+    fields[13] = T(birthtim);
+#undef T
+#undef X
+  }
+
+  static void Work(uv_work_t* work_req) {
+    Slice* slice = ContainerOf(&Slice::work_req, work_req);
+    slice->req->StatRange(slice->start, slice->end);
+  }
+
+  static void After(uv_work_t* work_req, int status) {
+    CHECK_EQ(status, 0);
+    Slice* slice = ContainerOf(&Slice::work_req, work_req);
+    StatManyRequest* req = slice->req;
+    if (--req->pending_ > 0)
+      return;
+
+    Environment* env = req->env();
+    HandleScope handle_scope(env->isolate());
+    Context::Scope context_scope(env->context());
+
+    const size_t count = req->paths_.size();
+    const size_t length = count * kStatsFields;
+    Local<ArrayBuffer> ab =
+        ArrayBuffer::New(env->isolate(), length * sizeof(req->fields_[0]));
+    if (length > 0)
+      memcpy(ab->GetContents().Data(), &req->fields_[0], ab->ByteLength());
+
+    const char* syscall = req->lstat_ ? "lstat" : "stat";
+    Local<Array> errors = Array::New(env->isolate(), count);
+    for (size_t i = 0; i < count; i++) {
+      if (req->errors_[i] == 0)
+        continue;
+      errors->Set(i, UVException(env->isolate(),
+                                 req->errors_[i],
+                                 syscall,
+                                 nullptr,
+                                 req->paths_[i].c_str()));
+    }
+
+    Local<Value> argv[] = {
+      Null(env->isolate()),
+      Float64Array::New(ab, 0, length),
+      errors
+    };
+    req->MakeCallback(env->oncomplete_string(), arraysize(argv), argv);
+    delete req;
+  }
+
+  uv_loop_t* const loop_;
+  const bool lstat_;
+  std::vector<std::string> paths_;
+  std::vector<double> fields_;
+  std::vector<int> errors_;
+  size_t pending_;
+  Slice slices_[kMaxSlices];
+};
+
+static void StatMany(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+
+  if (!args[0]->IsArray())
+    return TYPE_ERROR("paths must be an array");
+  CHECK(args[2]->IsObject());
+
+  Local<Array> array = args[0].As<Array>();
+  std::vector<std::string> paths;
+  paths.reserve(array->Length());
+  for (uint32_t i = 0; i < array->Length(); i++) {
+    BufferValue path(env->isolate(), array->Get(i));
+    if (*path == nullptr)
+      return TYPE_ERROR("paths must be strings or Buffers");
+    paths.push_back(*path);
+  }
+
+  StatManyRequest* req = new StatManyRequest(env,
+                                             args[2].As<Object>(),
+                                             &paths,
+                                             args[1]->IsTrue());
+  req->Queue();
+}
+
+// Strings of at least this many characters are transcoded on the threadpool,
+// shorter ones aren't worth the trip.
+static const size_t kOffThreadStringLength = 1024 * 1024;
+
+static bool CanTranscodeOffThread(enum encoding enc) {
+  return enc == UTF8 || enc == BASE64;
+}
+
+// Reads a whole file in a single threadpool job: open, fstat, as many reads
+// as it takes and close.  fs.readFile() used to make each of these a separate
+// request with its own trip through JS.  Large files that are read as UTF-8
+// or base64 are decoded in the same job.
+class ReadFileRequest : public AsyncWrap {
+ public:
+  ReadFileRequest(Environment* env,
+                  Local<Object> object,
+                  const char* path,
+                  int flags,
+                  enum encoding encoding)
+      : AsyncWrap(env, object, AsyncWrap::PROVIDER_FSREQWRAP),
+        loop_(env->event_loop()),
+        path_(path),
+        flags_(flags),
+        encoding_(encoding),
+        decoded_(false),
+        err_(0),
+        syscall_(nullptr),
+        too_large_(false),
+        close_err_(0),
+        data_(nullptr),
+        length_(0),
+        capacity_(0) {
+    Wrap(object, this);
+  }
+
+  ~ReadFileRequest() override {
+    free(data_);
+    persistent().Reset();
+  }
+
+  void Queue() {
+    uv_queue_work(loop_, &work_req_, Work, After);
+  }
+
+  size_t self_size() const override { return sizeof(*this); }
+
+ private:
+  // The chunk size when the size of the file is not known up front, e.g. for
+  // files in /proc.
+  static const size_t kChunkSize = 8 * 1024;
+
+  void Fail(int err, const char* syscall) {
+    err_ = err;
+    syscall_ = syscall;
+  }
+
+  void ReadFile() {
+    uv_fs_t req;
+    int fd = uv_fs_open(loop_, &req, path_.c_str(), flags_, 0666, nullptr);
+    uv_fs_req_cleanup(&req);
+    if (fd < 0)
+      return Fail(fd, "open");
+
+    ReadFd(fd);
+
+    int err = uv_fs_close(loop_, &req, fd, nullptr);
+    uv_fs_req_cleanup(&req);
+    if (err_ == 0)
+      close_err_ = err;
+
+    // Data that can't be decoded here, e.g. malformed UTF-8, is left to the
+    // main thread.
+    if (err_ == 0 && close_err_ == 0 && !too_large_ &&
+        CanTranscodeOffThread(encoding_) &&
+        length_ >= kOffThreadStringLength &&
+        chars_.Encode(data_, length_, encoding_)) {
+      decoded_ = true;
+      free(data_);
+      data_ = nullptr;
+      length_ = capacity_ = 0;
+    }
+  }
+
+  void ReadFd(int fd) {
+    uv_fs_t req;
+    int err = uv_fs_fstat(loop_, &req, fd, nullptr);
+    const uv_stat_t* s = static_cast<const uv_stat_t*>(req.ptr);
+    uint64_t size = err == 0 && (s->st_mode & S_IFMT) == S_IFREG ? s->st_size
+                                                                   : 0;
+    uv_fs_req_cleanup(&req);
+    if (err < 0)
+      return Fail(err, "fstat");
+
+    if (size > Buffer::kMaxLength) {
+      too_large_ = true;
+      return;
+    }
+
+    if (size > 0 && !Grow(size))
+      return Fail(UV_ENOMEM, "read");
+
+    for (;;) {
+      if (length_ == capacity_) {
+        // A regular file is read up to the size fstat() reported, like
+        // before.  Other files are read until EOF, in a growing buffer.
+        if (size > 0)
+          break;
+        if (length_ == Buffer::kMaxLength) {
+          too_large_ = true;
+          return;
+        }
+        size_t capacity = capacity_ == 0 ? kChunkSize : capacity_ * 2;
+        if (capacity > Buffer::kMaxLength)
+          capacity = Buffer::kMaxLength;
+        if (!Grow(capacity))
+          return Fail(UV_ENOMEM, "read");
+      }
+
+      const size_t room = capacity_ - length_;
+      uv_buf_t buf = uv_buf_init(data_ + length_,
+                                 static_cast<unsigned int>(room));
+      int bytes = uv_fs_read(loop_, &req, fd, &buf, 1, -1, nullptr);
+      uv_fs_req_cleanup(&req);
+      if (bytes < 0)
+        return Fail(bytes, "read");
+      if (bytes == 0)
+        break;
+      length_ += bytes;
+    }
+  }
+
+  bool Grow(size_t capacity) {
+    char* data = static_cast<char*>(realloc(data_, capacity));
+    if (data == nullptr)
+      return false;
+    data_ = data;
+    capacity_ = capacity;
+    return true;
+  }
+
+  static void Work(uv_work_t* work_req) {
+    ReadFileRequest* req = ContainerOf(&ReadFileRequest::work_req_, work_req);
+    req->ReadFile();
+  }
+
+  static void After(uv_work_t* work_req, int status) {
+    CHECK_EQ(status, 0);
+    ReadFileRequest* req = ContainerOf(&ReadFileRequest::work_req_, work_req);
+    Environment* env = req->env();
+    HandleScope handle_scope(env->isolate());
+    Context::Scope context_scope(env->context());
+
+    Local<Value> argv[] = {
+      Null(env->isolate()),
+      Undefined(env->isolate())
+    };
+
+    if (req->too_large_) {
+      char message[64];
+      snprintf(message,
+               sizeof(message),
+               "File size is greater than possible Buffer: 0x%x bytes",
+               Buffer::kMaxLength);
+      argv[0] = Exception::RangeError(OneByteString(env->isolate(), message));
+    } else if (req->err_ != 0) {
+      // Like the separate requests, only errors of open() have the path.
+      const bool open = strcmp(req->syscall_, "open") == 0;
+      const char* path = open ? req->path_.c_str() : nullptr;
+      argv[0] = UVException(env->isolate(), req->err_, req->syscall_,
+                            nullptr, path);
+    } else if (req->decoded_) {
+      Local<String> string;
+      if (req->chars_.ToString(env->isolate()).ToLocal(&string))
+        argv[1] = string;
+      else
+        argv[0] = Exception::Error(
+            FIXED_ONE_BYTE_STRING(env->isolate(), "\"toString()\" failed"));
+    } else {
+      argv[1] = req->TakeBuffer();
+      if (req->close_err_ != 0)
+        argv[0] = UVException(env->isolate(), req->close_err_, "close");
+    }
+
+    req->MakeCallback(env->oncomplete_string(), arraysize(argv), argv);
+    delete req;
+  }
+
+  Local<Object> TakeBuffer() {
+    if (length_ == 0)
+      return Buffer::New(env(), 0).ToLocalChecked();
+
+    // The Buffer takes the memory over, shrunk to the data that was read.
+    char* data = data_;
+    if (length_ < capacity_) {
+      data = static_cast<char*>(realloc(data_, length_));
+      if (data == nullptr)
+        data = data_;
+    }
+    data_ = nullptr;
+    return Buffer::New(env(), data, length_).ToLocalChecked();
+  }
+
+  uv_loop_t* const loop_;
+  uv_work_t work_req_;
+  const std::string path_;
+  const int flags_;
+  const enum encoding encoding_;
+  StringBytes::Chars chars_;
+  bool decoded_;
+  int err_;
+  const char* syscall_;
+  bool too_large_;
+  int close_err_;
+  char* data_;
+  size_t length_;
+  size_t capacity_;
+};
+
+// readFile(path, flags, encoding, req)
+// Calls back with a string if the encoding is UTF-8 or base64 and the file
+// was large enough to be decoded on the threadpool, with a Buffer otherwise.
+static void ReadFile(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+
+  BufferValue path(env->isolate(), args[0]);
+  ASSERT_PATH(path)
+  if (!args[1]->IsInt32())
+    return TYPE_ERROR("flags must be an int");
+  CHECK(args[3]->IsObject());
+
+  const enum encoding encoding = args[2]->IsString() ?
+      ParseEncoding(env->isolate(), args[2], BUFFER) : BUFFER;
+  ReadFileRequest* req = new ReadFileRequest(env,
+                                             args[3].As<Object>(),
+                                             *path,
+                                             args[1]->Int32Value(),
+                                             encoding);
+  req->Queue();
+}
+
+
+// Turns a large string into bytes on the threadpool.  Only taking the
+// characters out of the string has to happen on the main thread, and that is
+// a plain copy.
+class EncodeStringRequest : public AsyncWrap {
+ public:
+  EncodeStringRequest(Environment* env,
+                      Local<Object> object,
+                      enum encoding encoding)
+      : AsyncWrap(env, object, AsyncWrap::PROVIDER_FSREQWRAP),
+        encoding_(encoding),
+        data_(nullptr),
+        length_(0) {
+    Wrap(object, this);
+  }
+
+  ~EncodeStringRequest() override {
+    free(data_);
+    persistent().Reset();
+  }
+
+  bool CopyFrom(Local<String> string) {
+    return chars_.CopyFrom(string);
+  }
+
+  void Queue() {
+    uv_queue_work(env()->event_loop(), &work_req_, Work, After);
+  }
+
+  size_t self_size() const override { return sizeof(*this); }
+
+ private:
+  static void Work(uv_work_t* work_req) {
+    EncodeStringRequest* req =
+        ContainerOf(&EncodeStringRequest::work_req_, work_req);
+    const size_t storage = req->chars_.StorageSize(req->encoding_);
+    req->data_ = static_cast<char*>(malloc(storage == 0 ? 1 : storage));
+    if (req->data_ == nullptr)
+      return;
+    req->length_ = req->chars_.Write(req->data_, storage, req->encoding_);
+    if (req->length_ > 0 && req->length_ < storage) {
+      char* data = static_cast<char*>(realloc(req->data_, req->length_));
+      if (data != nullptr)
+        req->data_ = data;
+    }
+  }
+
+  static void After(uv_work_t* work_req, int status) {
+    CHECK_EQ(status, 0);
+    EncodeStringRequest* req =
+        ContainerOf(&EncodeStringRequest::work_req_, work_req);
+    Environment* env = req->env();
+    HandleScope handle_scope(env->isolate());
+    Context::Scope context_scope(env->context());
+
+    Local<Value> argv[] = {
+      Null(env->isolate()),
+      Undefined(env->isolate())
+    };
+    if (req->data_ == nullptr) {
+      argv[0] = UVException(env->isolate(), UV_ENOMEM, "write");
+    } else if (req->length_ == 0) {
+      argv[1] = Buffer::New(env, 0).ToLocalChecked();
+    } else {
+      // The Buffer takes the memory over.
+      argv[1] = Buffer::New(env, req->data_, req->length_).ToLocalChecked();
+      req->data_ = nullptr;
+    }
+
+    req->MakeCallback(env->oncomplete_string(), arraysize(argv), argv);
+    delete req;
+  }
+
+  uv_work_t work_req_;
+  const enum encoding encoding_;
+  StringBytes::Chars chars_;
+  char* data_;
+  size_t length_;
+};
+
+// encodeString(string, encoding, req)
+static void EncodeString(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+
+  if (!args[0]->IsString())
+    return TYPE_ERROR("First argument must be a string");
+  const enum encoding encoding = ParseEncoding(env->isolate(), args[1], UTF8);
+  if (!CanTranscodeOffThread(encoding))
+    return TYPE_ERROR("Unsupported encoding");
+  CHECK(args[2]->IsObject());
+
+  EncodeStringRequest* req =
+      new EncodeStringRequest(env, args[2].As<Object>(), encoding);
+  if (!req->CopyFrom(args[0].As<String>())) {
+    delete req;
+    return env->ThrowUVException(UV_ENOMEM, "write");
+  }
+  req->Queue();
+}
+
 static void Symlink(const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args);
 
@@ -679,7 +1716,7 @@ static void Symlink(const FunctionCallbackInfo<Value>& args) {
     }
   }
 
-  if (args[3]->IsObject()) {
+  if (IsAsyncRequest(args[3])) {
     ASYNC_DEST_CALL(symlink, args[3], *path, UTF8, *target, *path, flags)
   } else {
     SYNC_DEST_CALL(symlink, *target, *path, *target, *path, flags)
@@ -701,7 +1738,7 @@ static void Link(const FunctionCallbackInfo<Value>& args) {
   BufferValue dest(env->isolate(), args[1]);
   ASSERT_PATH(dest)
 
-  if (args[2]->IsObject()) {
+  if (IsAsyncRequest(args[2])) {
     ASYNC_DEST_CALL(link, args[2], *dest, UTF8, *src, *dest)
   } else {
     SYNC_DEST_CALL(link, *src, *dest, *src, *dest)
@@ -725,7 +1762,7 @@ static void ReadLink(const FunctionCallbackInfo<Value>& args) {
   if (argc == 3)
     callback = args[2];
 
-  if (callback->IsObject()) {
+  if (IsAsyncRequest(callback)) {
     ASYNC_CALL(readlink, callback, encoding, *path)
   } else {
     SYNC_CALL(readlink, *path, *path)
@@ -757,7 +1794,7 @@ static void Rename(const FunctionCallbackInfo<Value>& args) {
   BufferValue new_path(env->isolate(), args[1]);
   ASSERT_PATH(new_path)
 
-  if (args[2]->IsObject()) {
+  if (IsAsyncRequest(args[2])) {
     ASYNC_DEST_CALL(rename, args[2], *new_path, UTF8, *old_path, *new_path)
   } else {
     SYNC_DEST_CALL(rename, *old_path, *new_path, *old_path, *new_path)
@@ -786,8 +1823,10 @@ static void FTruncate(const FunctionCallbackInfo<Value>& args) {
 
   const int64_t len = len_v->IntegerValue();
 
-  if (args[2]->IsObject()) {
+  if (IsAsyncRequest(args[2])) {
     ASYNC_CALL(ftruncate, args[2], UTF8, fd, len)
+  } else if (args[2]->IsTrue()) {
+    DETACHED_CALL(ftruncate, fd, len)
   } else {
     SYNC_CALL(ftruncate, 0, fd, len)
   }
@@ -803,8 +1842,10 @@ static void Fdatasync(const FunctionCallbackInfo<Value>& args) {
 
   int fd = args[0]->Int32Value();
 
-  if (args[1]->IsObject()) {
+  if (IsAsyncRequest(args[1])) {
     ASYNC_CALL(fdatasync, args[1], UTF8, fd)
+  } else if (args[1]->IsTrue()) {
+    DETACHED_CALL(fdatasync, fd)
   } else {
     SYNC_CALL(fdatasync, 0, fd)
   }
@@ -820,8 +1861,10 @@ static void Fsync(const FunctionCallbackInfo<Value>& args) {
 
   int fd = args[0]->Int32Value();
 
-  if (args[1]->IsObject()) {
+  if (IsAsyncRequest(args[1])) {
     ASYNC_CALL(fsync, args[1], UTF8, fd)
+  } else if (args[1]->IsTrue()) {
+    DETACHED_CALL(fsync, fd)
   } else {
     SYNC_CALL(fsync, 0, fd)
   }
@@ -836,7 +1879,7 @@ static void Unlink(const FunctionCallbackInfo<Value>& args) {
   BufferValue path(env->isolate(), args[0]);
   ASSERT_PATH(path)
 
-  if (args[1]->IsObject()) {
+  if (IsAsyncRequest(args[1])) {
     ASYNC_CALL(unlink, args[1], UTF8, *path)
   } else {
     SYNC_CALL(unlink, *path, *path)
@@ -852,7 +1895,7 @@ static void RMDir(const FunctionCallbackInfo<Value>& args) {
   BufferValue path(env->isolate(), args[0]);
   ASSERT_PATH(path)
 
-  if (args[1]->IsObject()) {
+  if (IsAsyncRequest(args[1])) {
     ASYNC_CALL(rmdir, args[1], UTF8, *path)
   } else {
     SYNC_CALL(rmdir, *path, *path)
@@ -872,7 +1915,7 @@ static void MKDir(const FunctionCallbackInfo<Value>& args) {
 
   int mode = static_cast<int>(args[1]->Int32Value());
 
-  if (args[2]->IsObject()) {
+  if (IsAsyncRequest(args[2])) {
     ASYNC_CALL(mkdir, args[2], UTF8, *path, mode)
   } else {
     SYNC_CALL(mkdir, *path, *path, mode)
@@ -896,7 +1939,7 @@ static void RealPath(const FunctionCallbackInfo<Value>& args) {
   if (argc == 3)
     callback = args[2];
 
-  if (callback->IsObject()) {
+  if (IsAsyncRequest(callback)) {
     ASYNC_CALL(realpath, callback, encoding, *path);
   } else {
     SYNC_CALL(realpath, *path, *path);
@@ -928,21 +1971,28 @@ static void ReadDir(const FunctionCallbackInfo<Value>& args) {
   const enum encoding encoding = ParseEncoding(env->isolate(), args[1], UTF8);
 
   Local<Value> callback = Null(env->isolate());
-  if (argc == 3)
+  if (argc >= 3)
     callback = args[2];
+  const bool with_types = args[3]->IsTrue();
 
-  if (callback->IsObject()) {
+  if (IsAsyncRequest(callback)) {
     ASYNC_CALL(scandir, callback, encoding, *path, 0 /*flags*/)
+    if (req_wrap != nullptr)
+      req_wrap->with_types_ = with_types;
   } else {
     SYNC_CALL(scandir, *path, *path, 0 /*flags*/)
 
     CHECK_GE(SYNC_REQ.result, 0);
     int r;
     Local<Array> names = Array::New(env->isolate(), 0);
+    Local<Array> types;
     Local<Function> fn = env->push_values_to_array_function();
     Local<Value> name_v[NODE_PUSH_VAL_TO_ARRAY_MAX];
     size_t name_idx = 0;
 
+    if (with_types)
+      types = Array::New(env->isolate(), 0);
+
     for (int i = 0; ; i++) {
       uv_dirent_t ent;
 
@@ -963,6 +2013,8 @@ static void ReadDir(const FunctionCallbackInfo<Value>& args) {
       }
 
       name_v[name_idx++] = filename;
+      if (with_types)
+        types->Set(i, Integer::New(env->isolate(), ent.type));
 
       if (name_idx >= arraysize(name_v)) {
         fn->Call(env->context(), names, name_idx, name_v)
@@ -975,6 +2027,13 @@ static void ReadDir(const FunctionCallbackInfo<Value>& args) {
       fn->Call(env->context(), names, name_idx, name_v).ToLocalChecked();
     }
 
+    if (with_types) {
+      Local<Array> result = Array::New(env->isolate(), 2);
+      result->Set(0, names);
+      result->Set(1, types);
+      return args.GetReturnValue().Set(result);
+    }
+
     args.GetReturnValue().Set(names);
   }
 }
@@ -1000,7 +2059,7 @@ static void Open(const FunctionCallbackInfo<Value>& args) {
   int flags = args[1]->Int32Value();
   int mode = static_cast<int>(args[2]->Int32Value());
 
-  if (args[3]->IsObject()) {
+  if (IsAsyncRequest(args[3])) {
     ASYNC_CALL(open, args[3], UTF8, *path, flags, mode)
   } else {
     SYNC_CALL(open, *path, *path, flags, mode)
@@ -1048,7 +2107,7 @@ static void WriteBuffer(const FunctionCallbackInfo<Value>& args) {
 
   uv_buf_t uvbuf = uv_buf_init(const_cast<char*>(buf), len);
 
-  if (req->IsObject()) {
+  if (IsAsyncRequest(req)) {
     ASYNC_CALL(write, req, UTF8, fd, &uvbuf, 1, pos)
     return;
   }
@@ -1068,7 +2127,9 @@ static void WriteBuffer(const FunctionCallbackInfo<Value>& args) {
 static void WriteBuffers(const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args);
 
-  CHECK(args[0]->IsInt32());
+  if (!args[0]->IsInt32())
+    return env->ThrowTypeError("First argument must be file descriptor");
+
   CHECK(args[1]->IsArray());
 
   int fd = args[0]->Int32Value();
@@ -1098,7 +2159,7 @@ static void WriteBuffers(const FunctionCallbackInfo<Value>& args) {
     iovs[i] = uv_buf_init(Buffer::Data(chunk), Buffer::Length(chunk));
   }
 
-  if (req->IsObject()) {
+  if (IsAsyncRequest(req)) {
     ASYNC_CALL(write, req, UTF8, fd, iovs, chunkCount, pos)
     if (iovs != s_iovs)
       delete[] iovs;
@@ -1238,7 +2299,7 @@ static void Read(const FunctionCallbackInfo<Value>& args) {
 
   req = args[5];
 
-  if (req->IsObject()) {
+  if (IsAsyncRequest(req)) {
     ASYNC_CALL(read, req, UTF8, fd, &uvbuf, 1, pos);
   } else {
     SYNC_CALL(read, 0, fd, &uvbuf, 1, pos)
@@ -1263,7 +2324,7 @@ static void Chmod(const FunctionCallbackInfo<Value>& args) {
 
   int mode = static_cast<int>(args[1]->Int32Value());
 
-  if (args[2]->IsObject()) {
+  if (IsAsyncRequest(args[2])) {
     ASYNC_CALL(chmod, args[2], UTF8, *path, mode);
   } else {
     SYNC_CALL(chmod, *path, *path, mode);
@@ -1287,8 +2348,10 @@ static void FChmod(const FunctionCallbackInfo<Value>& args) {
   int fd = args[0]->Int32Value();
   int mode = static_cast<int>(args[1]->Int32Value());
 
-  if (args[2]->IsObject()) {
+  if (IsAsyncRequest(args[2])) {
     ASYNC_CALL(fchmod, args[2], UTF8, fd, mode);
+  } else if (args[2]->IsTrue()) {
+    DETACHED_CALL(fchmod, fd, mode);
   } else {
     SYNC_CALL(fchmod, 0, fd, mode);
   }
@@ -1319,7 +2382,7 @@ static void Chown(const FunctionCallbackInfo<Value>& args) {
   uv_uid_t uid = static_cast<uv_uid_t>(args[1]->Uint32Value());
   uv_gid_t gid = static_cast<uv_gid_t>(args[2]->Uint32Value());
 
-  if (args[3]->IsObject()) {
+  if (IsAsyncRequest(args[3])) {
     ASYNC_CALL(chown, args[3], UTF8, *path, uid, gid);
   } else {
     SYNC_CALL(chown, *path, *path, uid, gid);
@@ -1351,8 +2414,10 @@ static void FChown(const FunctionCallbackInfo<Value>& args) {
   uv_uid_t uid = static_cast<uv_uid_t>(args[1]->Uint32Value());
   uv_gid_t gid = static_cast<uv_gid_t>(args[2]->Uint32Value());
 
-  if (args[3]->IsObject()) {
+  if (IsAsyncRequest(args[3])) {
     ASYNC_CALL(fchown, args[3], UTF8, fd, uid, gid);
+  } else if (args[3]->IsTrue()) {
+    DETACHED_CALL(fchown, fd, uid, gid);
   } else {
     SYNC_CALL(fchown, 0, fd, uid, gid);
   }
@@ -1380,7 +2445,7 @@ static void UTimes(const FunctionCallbackInfo<Value>& args) {
   const double atime = static_cast<double>(args[1]->NumberValue());
   const double mtime = static_cast<double>(args[2]->NumberValue());
 
-  if (args[3]->IsObject()) {
+  if (IsAsyncRequest(args[3])) {
     ASYNC_CALL(utime, args[3], UTF8, *path, atime, mtime);
   } else {
     SYNC_CALL(utime, *path, *path, atime, mtime);
@@ -1408,8 +2473,10 @@ static void FUTimes(const FunctionCallbackInfo<Value>& args) {
   const double atime = static_cast<double>(args[1]->NumberValue());
   const double mtime = static_cast<double>(args[2]->NumberValue());
 
-  if (args[3]->IsObject()) {
+  if (IsAsyncRequest(args[3])) {
     ASYNC_CALL(futime, args[3], UTF8, fd, atime, mtime);
+  } else if (args[3]->IsTrue()) {
+    DETACHED_CALL(futime, fd, atime, mtime);
   } else {
     SYNC_CALL(futime, 0, fd, atime, mtime);
   }
@@ -1426,7 +2493,7 @@ static void Mkdtemp(const FunctionCallbackInfo<Value>& args) {
 
   const enum encoding encoding = ParseEncoding(env->isolate(), args[1], UTF8);
 
-  if (args[2]->IsObject()) {
+  if (IsAsyncRequest(args[2])) {
     ASYNC_CALL(mkdtemp, args[2], encoding, *tmpl);
   } else {
     SYNC_CALL(mkdtemp, *tmpl, *tmpl);
@@ -1442,6 +2509,268 @@ static void Mkdtemp(const FunctionCallbackInfo<Value>& args) {
   }
 }
 
+#ifndef _WIN32
+struct MappedRegion {
+  void* base;
+  size_t length;
+};
+
+
+static void Unmap(char* data, void* hint) {
+  MappedRegion* region = static_cast<MappedRegion*>(hint);
+  CHECK_EQ(0, munmap(region->base, region->length));
+  delete region;
+}
+#endif
+
+
+// mmap(fd, offset, length)
+// Maps part of a file into a Buffer.  The mapping is private (copy-on-write),
+// so clean pages are shared with the page cache and with every other process
+// that maps the same file.  It is unmapped when the Buffer is collected.
+static void MMap(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+
+  if (!args[0]->IsInt32())
+    return TYPE_ERROR("fd must be a file descriptor");
+  CHECK(args[1]->IsNumber());
+  CHECK(args[2]->IsNumber());
+
+  const int fd = args[0]->Int32Value();
+  const int64_t offset = args[1]->IntegerValue();
+  const int64_t length = args[2]->IntegerValue();
+
+  if (offset < 0)
+    return env->ThrowRangeError("offset out of bounds");
+  if (length <= 0 || length > Buffer::kMaxLength)
+    return env->ThrowRangeError("length out of bounds");
+
+#ifdef _WIN32
+  return env->ThrowUVException(UV_ENOSYS, "mmap");
+#else
+  // The offset passed to mmap() must be a multiple of the page size.
+  static const int64_t page_size = sysconf(_SC_PAGESIZE);
+  const int64_t delta = offset % page_size;
+  const size_t mapped = static_cast<size_t>(length + delta);
+
+  void* base = mmap(nullptr,
+                    mapped,
+                    PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE,
+                    fd,
+                    offset - delta);
+  if (base == MAP_FAILED)
+    return env->ThrowUVException(-errno, "mmap");
+
+  MappedRegion* region = new MappedRegion;
+  region->base = base;
+  region->length = mapped;
+  // Unmaps the region when it fails, too.
+  Local<Object> buffer;
+  if (Buffer::Adopt(env,
+                    static_cast<char*>(base) + delta,
+                    static_cast<size_t>(length),
+                    Unmap,
+                    region).ToLocal(&buffer)) {
+    args.GetReturnValue().Set(buffer);
+  }
+#endif
+}
+
+
+// fadviseSequential(fd)
+// Tells the kernel that the file will be read sequentially so it reads ahead
+// more aggressively.  It is only advice, failures are ignored.
+static void FAdviseSequential(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+
+  if (!args[0]->IsInt32())
+    return TYPE_ERROR("fd must be a file descriptor");
+
+#ifdef POSIX_FADV_SEQUENTIAL
+  posix_fadvise(args[0]->Int32Value(), 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+}
+
+
+// Walks a directory tree on the threadpool, one batch of entries per read()
+// call.  The entry types come from scandir (d_type on most file systems), so
+// only entries of unknown type need an extra lstat.  Symbolic links are
+// reported but not followed.
+class DirWalker : public AsyncWrap {
+ public:
+  static void Initialize(Environment* env, Local<Object> target) {
+    Local<FunctionTemplate> t = env->NewFunctionTemplate(New);
+    t->InstanceTemplate()->SetInternalFieldCount(1);
+    t->SetClassName(FIXED_ONE_BYTE_STRING(env->isolate(), "DirWalker"));
+
+    env->SetProtoMethod(t, "read", Read);
+
+    target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "DirWalker"),
+                t->GetFunction());
+  }
+
+  ~DirWalker() override {
+    if (dir_open_)
+      uv_fs_req_cleanup(&dir_req_);
+  }
+
+  size_t self_size() const override { return sizeof(*this); }
+
+ private:
+  DirWalker(Environment* env, Local<Object> wrap, const char* root)
+      : AsyncWrap(env, wrap, AsyncWrap::PROVIDER_FSREQWRAP),
+        dir_open_(false),
+        batch_size_(0),
+        err_(0) {
+    MakeWeak<DirWalker>(this);
+    dirs_.push_back(root);
+  }
+
+  static void New(const FunctionCallbackInfo<Value>& args) {
+    CHECK(args.IsConstructCall());
+    Environment* env = Environment::GetCurrent(args);
+    BufferValue root(env->isolate(), args[0]);
+    ASSERT_PATH(root)
+    new DirWalker(env, args.This(), *root);
+  }
+
+  static void Read(const FunctionCallbackInfo<Value>& args) {
+    DirWalker* wrap = Unwrap<DirWalker>(args.Holder());
+    CHECK(args[0]->IsUint32());
+    CHECK_EQ(wrap->persistent().IsWeak(), true);  // No read in progress.
+    wrap->batch_size_ = args[0]->Uint32Value();
+    wrap->ClearWeak();
+    uv_queue_work(wrap->env()->event_loop(), &wrap->work_req_, Work, After);
+  }
+
+  static int TypeFromMode(uint64_t mode) {
+    switch (mode & S_IFMT) {
+      case S_IFREG: return UV_DIRENT_FILE;
+      case S_IFDIR: return UV_DIRENT_DIR;
+      case S_IFCHR: return UV_DIRENT_CHAR;
+#ifdef S_IFLNK
+      case S_IFLNK: return UV_DIRENT_LINK;
+#endif
+#ifdef S_IFIFO
+      case S_IFIFO: return UV_DIRENT_FIFO;
+#endif
+#ifdef S_IFSOCK
+      case S_IFSOCK: return UV_DIRENT_SOCKET;
+#endif
+#ifdef S_IFBLK
+      case S_IFBLK: return UV_DIRENT_BLOCK;
+#endif
+      default: return UV_DIRENT_UNKNOWN;
+    }
+  }
+
+  // Runs on the threadpool, collects up to batch_size_ entries.
+  void Fill() {
+    uv_loop_t* loop = env()->event_loop();
+
+    while (paths_.size() < batch_size_) {
+      if (!dir_open_) {
+        if (dirs_.empty())
+          return;
+        dir_ = dirs_.back();
+        dirs_.pop_back();
+        int err = uv_fs_scandir(loop, &dir_req_, dir_.c_str(), 0, nullptr);
+        if (err < 0) {
+          uv_fs_req_cleanup(&dir_req_);
+          err_ = err;
+          err_path_ = dir_;
+          return;
+        }
+        dir_open_ = true;
+      }
+
+      uv_dirent_t ent;
+      if (uv_fs_scandir_next(&dir_req_, &ent) == UV_EOF) {
+        uv_fs_req_cleanup(&dir_req_);
+        dir_open_ = false;
+        continue;
+      }
+
+      std::string path = dir_;
+      if (path.empty() || (path.back() != '/' && path.back() != kPathSep))
+        path += kPathSep;
+      path += ent.name;
+
+      int type = ent.type;
+      if (type == UV_DIRENT_UNKNOWN) {
+        uv_fs_t req;
+        if (uv_fs_lstat(loop, &req, path.c_str(), nullptr) == 0)
+          type = TypeFromMode(static_cast<uv_stat_t*>(req.ptr)->st_mode);
+        uv_fs_req_cleanup(&req);
+      }
+
+      if (type == UV_DIRENT_DIR)
+        dirs_.push_back(path);
+      paths_.push_back(path);
+      types_.push_back(type);
+    }
+  }
+
+  static void Work(uv_work_t* work_req) {
+    DirWalker* wrap = ContainerOf(&DirWalker::work_req_, work_req);
+    wrap->Fill();
+  }
+
+  static void After(uv_work_t* work_req, int status) {
+    CHECK_EQ(status, 0);
+    DirWalker* wrap = ContainerOf(&DirWalker::work_req_, work_req);
+    Environment* env = wrap->env();
+    HandleScope handle_scope(env->isolate());
+    Context::Scope context_scope(env->context());
+
+    const size_t count = wrap->paths_.size();
+    Local<Array> paths = Array::New(env->isolate(), count);
+    Local<Array> types = Array::New(env->isolate(), count);
+    for (size_t i = 0; i < count; i++) {
+      paths->Set(i, String::NewFromUtf8(env->isolate(),
+                                        wrap->paths_[i].c_str(),
+                                        String::kNormalString,
+                                        wrap->paths_[i].size()));
+      types->Set(i, Integer::New(env->isolate(), wrap->types_[i]));
+    }
+    wrap->paths_.clear();
+    wrap->types_.clear();
+
+    // Entries found before the error are delivered with it.
+    Local<Value> err = Null(env->isolate());
+    if (wrap->err_ != 0) {
+      err = UVException(env->isolate(),
+                        wrap->err_,
+                        "scandir",
+                        nullptr,
+                        wrap->err_path_.c_str());
+      wrap->err_ = 0;
+    }
+
+    wrap->MakeWeak<DirWalker>(wrap);
+    Local<Value> argv[] = { err, paths, types };
+    wrap->MakeCallback(env->ondone_string(), arraysize(argv), argv);
+  }
+
+#ifdef _WIN32
+  static const char kPathSep = '\\';
+#else
+  static const char kPathSep = '/';
+#endif
+
+  uv_work_t work_req_;
+  std::vector<std::string> dirs_;
+  uv_fs_t dir_req_;
+  bool dir_open_;
+  std::string dir_;
+  std::vector<std::string> paths_;
+  std::vector<int> types_;
+  size_t batch_size_;
+  int err_;
+  std::string err_path_;
+};
+
 void FSInitialize(const FunctionCallbackInfo<Value>& args) {
   Local<Function> stats_constructor = args[0].As<Function>();
   CHECK(stats_constructor->IsFunction());
@@ -1460,10 +2789,20 @@ void InitFs(Local<Object> target,
   target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "FSInitialize"),
               env->NewFunctionTemplate(FSInitialize)->GetFunction());
 
+  Local<Symbol> use_promises =
+      Symbol::New(env->isolate(), FIXED_ONE_BYTE_STRING(env->isolate(),
+                                                        "fs_use_promises"));
+  env->set_fs_use_promises_symbol(use_promises);
+  target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "kUsePromises"),
+              use_promises);
+
+  env->SetMethod(target, "setDetachedErrorsCallback",
+                 SetDetachedErrorsCallback);
   env->SetMethod(target, "access", Access);
   env->SetMethod(target, "close", Close);
   env->SetMethod(target, "open", Open);
   env->SetMethod(target, "read", Read);
+  env->SetMethod(target, "readFile", ReadFile);
   env->SetMethod(target, "fdatasync", Fdatasync);
   env->SetMethod(target, "fsync", Fsync);
   env->SetMethod(target, "rename", Rename);
@@ -1473,9 +2812,13 @@ void InitFs(Local<Object> target,
   env->SetMethod(target, "readdir", ReadDir);
   env->SetMethod(target, "internalModuleReadFile", InternalModuleReadFile);
   env->SetMethod(target, "internalModuleStat", InternalModuleStat);
+  env->SetMethod(target, "internalModuleRealpath", InternalModuleRealpath);
+  env->SetMethod(target, "internalModuleResolve", InternalModuleResolve);
+  env->SetMethod(target, "setModuleCacheEnabled", SetModuleCacheEnabled);
   env->SetMethod(target, "stat", Stat);
   env->SetMethod(target, "lstat", LStat);
   env->SetMethod(target, "fstat", FStat);
+  env->SetMethod(target, "statMany", StatMany);
   env->SetMethod(target, "link", Link);
   env->SetMethod(target, "symlink", Symlink);
   env->SetMethod(target, "readlink", ReadLink);
@@ -1483,6 +2826,7 @@ void InitFs(Local<Object> target,
   env->SetMethod(target, "writeBuffer", WriteBuffer);
   env->SetMethod(target, "writeBuffers", WriteBuffers);
   env->SetMethod(target, "writeString", WriteString);
+  env->SetMethod(target, "encodeString", EncodeString);
   env->SetMethod(target, "realpath", RealPath);
 
   env->SetMethod(target, "chmod", Chmod);
@@ -1498,7 +2842,20 @@ void InitFs(Local<Object> target,
 
   env->SetMethod(target, "mkdtemp", Mkdtemp);
 
+  env->SetMethod(target, "mmap", MMap);
+  env->SetMethod(target, "fadviseSequential", FAdviseSequential);
+
   StatWatcher::Initialize(env, target);
+  DirWalker::Initialize(env, target);
+
+  NODE_DEFINE_CONSTANT(target, UV_DIRENT_UNKNOWN);
+  NODE_DEFINE_CONSTANT(target, UV_DIRENT_FILE);
+  NODE_DEFINE_CONSTANT(target, UV_DIRENT_DIR);
+  NODE_DEFINE_CONSTANT(target, UV_DIRENT_LINK);
+  NODE_DEFINE_CONSTANT(target, UV_DIRENT_FIFO);
+  NODE_DEFINE_CONSTANT(target, UV_DIRENT_SOCKET);
+  NODE_DEFINE_CONSTANT(target, UV_DIRENT_CHAR);
+  NODE_DEFINE_CONSTANT(target, UV_DIRENT_BLOCK);
 
   // Create FunctionTemplate for FSReqWrap
   Local<FunctionTemplate> fst =
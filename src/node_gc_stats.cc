@@ -0,0 +1,254 @@
+#include "node.h"
+#include "node_gc_stats.h"
+#include "node_internals.h"
+#include "env.h"
+#include "env-inl.h"
+#include "util.h"
+#include "util-inl.h"
+#include "v8.h"
+
+#include <algorithm>
+#include <string.h>
+
+namespace node {
+
+using v8::Array;
+using v8::Context;
+using v8::Function;
+using v8::GCCallbackFlags;
+using v8::GCType;
+using v8::HandleScope;
+using v8::HeapStatistics;
+using v8::Isolate;
+using v8::Local;
+using v8::Number;
+using v8::Value;
+
+static const double kNanosPerMilli = 1e6;
+
+// The started instances of all isolates.  The callbacks are added once per
+// isolate and look up their instances here.
+static uv_mutex_t started_mutex;
+static std::vector<GCStats*> started;
+
+static void InitStartedMutex() {
+  CHECK_EQ(0, uv_mutex_init(&started_mutex));
+}
+
+static uv_mutex_t* StartedMutex() {
+  static uv_once_t init_once = UV_ONCE_INIT;
+  uv_once(&init_once, InitStartedMutex);
+  return &started_mutex;
+}
+
+
+GCStats::GCStats(Environment* env)
+    : env_(env),
+      started_(false),
+      events_enabled_(false) {
+  memset(start_time_, 0, sizeof(start_time_));
+  memset(start_used_heap_size_, 0, sizeof(start_used_heap_size_));
+  memset(fields_, 0, sizeof(fields_));
+
+  CHECK_EQ(0, uv_idle_init(env->event_loop(), &idle_));
+  idle_.data = this;
+  env->RegisterHandleCleanup(reinterpret_cast<uv_handle_t*>(&idle_),
+                             OnClose,
+                             nullptr);
+}
+
+
+GCStats::~GCStats() {
+  Stop();
+}
+
+
+void GCStats::Start() {
+  if (started_)
+    return;
+  started_ = true;
+  memset(start_time_, 0, sizeof(start_time_));
+
+  Isolate* const isolate = env_->isolate();
+  uv_mutex_t* const mutex = StartedMutex();
+  uv_mutex_lock(mutex);
+  const bool first = std::none_of(started.begin(),
+                                  started.end(),
+                                  [isolate](GCStats* stats) {
+    return stats->env_->isolate() == isolate;
+  });
+  started.push_back(this);
+  uv_mutex_unlock(mutex);
+
+  if (first) {
+    isolate->AddGCPrologueCallback(OnPrologue);
+    isolate->AddGCEpilogueCallback(OnEpilogue);
+  }
+}
+
+
+void GCStats::Stop() {
+  if (!started_)
+    return;
+  started_ = false;
+
+  Isolate* const isolate = env_->isolate();
+  uv_mutex_t* const mutex = StartedMutex();
+  uv_mutex_lock(mutex);
+  started.erase(std::find(started.begin(), started.end(), this));
+  const bool last = std::none_of(started.begin(),
+                                 started.end(),
+                                 [isolate](GCStats* stats) {
+    return stats->env_->isolate() == isolate;
+  });
+  uv_mutex_unlock(mutex);
+
+  if (last) {
+    isolate->RemoveGCPrologueCallback(OnPrologue);
+    isolate->RemoveGCEpilogueCallback(OnEpilogue);
+  }
+}
+
+
+void GCStats::Reset() {
+  memset(fields_, 0, sizeof(fields_));
+}
+
+
+void GCStats::SetEventsEnabled(bool enabled) {
+  events_enabled_ = enabled;
+  if (!enabled)
+    pending_events_.clear();
+}
+
+
+int GCStats::TypeIndex(GCType type) {
+  switch (type) {
+#define V(index, _, gc_type) case gc_type: return index;
+    GC_TYPES(V)
+#undef V
+    default:
+      return -1;
+  }
+}
+
+
+void GCStats::OnPrologue(Isolate* isolate,
+                         GCType type,
+                         GCCallbackFlags flags) {
+  const int index = TypeIndex(type);
+  if (index < 0)
+    return;
+
+  HeapStatistics s;
+  isolate->GetHeapStatistics(&s);
+
+  uv_mutex_t* const mutex = StartedMutex();
+  uv_mutex_lock(mutex);
+  for (GCStats* stats : started) {
+    if (stats->env_->isolate() == isolate)
+      stats->Begin(index, s.used_heap_size());
+  }
+  uv_mutex_unlock(mutex);
+}
+
+
+void GCStats::OnEpilogue(Isolate* isolate,
+                         GCType type,
+                         GCCallbackFlags flags) {
+  const int index = TypeIndex(type);
+  if (index < 0)
+    return;
+
+  HeapStatistics s;
+  isolate->GetHeapStatistics(&s);
+
+  uv_mutex_t* const mutex = StartedMutex();
+  uv_mutex_lock(mutex);
+  for (GCStats* stats : started) {
+    if (stats->env_->isolate() == isolate)
+      stats->End(index, s.used_heap_size());
+  }
+  uv_mutex_unlock(mutex);
+}
+
+
+void GCStats::Begin(int index, size_t used_heap_size) {
+  start_time_[index] = uv_hrtime();
+  start_used_heap_size_[index] = used_heap_size;
+}
+
+
+void GCStats::End(int index, size_t used_heap_size) {
+  // Started while this kind of GC was running.
+  if (start_time_[index] == 0)
+    return;
+
+  const uint64_t start_time = start_time_[index];
+  const double duration = (uv_hrtime() - start_time) / kNanosPerMilli;
+  const size_t before = start_used_heap_size_[index];
+  const double freed = before > used_heap_size ?
+      static_cast<double>(before - used_heap_size) : 0;
+  start_time_[index] = 0;
+
+  double* const fields = fields_ + index * kFieldsPerType;
+  fields[kCount] += 1;
+  fields[kDuration] += duration;
+  if (duration > fields[kMaxDuration])
+    fields[kMaxDuration] = duration;
+  fields[kFreed] += freed;
+
+  if (!events_enabled_ ||
+      pending_events_.size() >= kMaxPendingEvents * kEventSize) {
+    return;
+  }
+  if (pending_events_.empty()) {
+    // Nothing is delivered once the environment is being torn down.
+    if (uv_is_closing(reinterpret_cast<uv_handle_t*>(&idle_)))
+      return;
+    uv_idle_start(&idle_, OnIdle);
+  }
+  pending_events_.push_back(index);
+  pending_events_.push_back(start_time / kNanosPerMilli);
+  pending_events_.push_back(duration);
+  pending_events_.push_back(freed);
+}
+
+
+void GCStats::OnIdle(uv_idle_t* handle) {
+  uv_idle_stop(handle);
+  static_cast<GCStats*>(handle->data)->DeliverEvents();
+}
+
+
+void GCStats::DeliverEvents() {
+  // The callback can cause more GCs, they are queued for the next delivery.
+  std::vector<double> events;
+  events.swap(pending_events_);
+  if (events.empty())
+    return;
+
+  HandleScope handle_scope(env_->isolate());
+  Context::Scope context_scope(env_->context());
+  Local<Function> fn = env_->gc_events_function();
+  if (fn.IsEmpty())
+    return;
+
+  Local<Array> array = Array::New(env_->isolate(), events.size());
+  for (size_t i = 0; i < events.size(); i++)
+    array->Set(i, Number::New(env_->isolate(), events[i]));
+
+  Local<Value> recv = env_->process_object();
+  Local<Value> arg = array;
+  MakeCallback(env_, recv, fn, 1, &arg);
+}
+
+
+void GCStats::OnClose(Environment* env, uv_handle_t* handle, void* arg) {
+  handle->data = env;
+  uv_close(handle, [](uv_handle_t* handle) {
+    static_cast<Environment*>(handle->data)->FinishHandleCleanup(handle);
+  });
+}
+
+}  // namespace node
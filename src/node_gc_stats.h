@@ -0,0 +1,96 @@
+#ifndef SRC_NODE_GC_STATS_H_
+#define SRC_NODE_GC_STATS_H_
+
+#include "util.h"
+#include "uv.h"
+#include "v8.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+namespace node {
+
+class Environment;
+
+#define GC_TYPES(V)                                                           \
+  V(0, kScavenge, v8::kGCTypeScavenge)                                        \
+  V(1, kMarkSweepCompact, v8::kGCTypeMarkSweepCompact)                        \
+  V(2, kIncrementalMarking, v8::kGCTypeIncrementalMarking)                    \
+  V(3, kProcessWeakCallbacks, v8::kGCTypeProcessWeakCallbacks)                \
+
+#define GC_STATS_FIELDS(V)                                                    \
+  V(0, kCount)                                                                \
+  V(1, kDuration)                                                             \
+  V(2, kMaxDuration)                                                          \
+  V(3, kFreed)                                                                \
+
+// Times the GC pauses of an Environment's isolate from GC prologue and
+// epilogue callbacks while started.  The count, the total and the longest
+// pause in milliseconds and the bytes freed are kept per GC type in fields(),
+// at type * kFieldsPerType + field.  When events are enabled every pause is
+// also queued, and the queue is handed to JS once per loop iteration from an
+// idle handle, never from inside the GC.
+class GCStats {
+ public:
+  enum Types {
+#define V(index, name, _) name = index,
+    GC_TYPES(V)
+#undef V
+    kTypesCount
+  };
+
+  enum Fields {
+#define V(index, name) name = index,
+    GC_STATS_FIELDS(V)
+#undef V
+    kFieldsPerType
+  };
+
+  // Every queued event is [type, start time, duration, bytes freed].
+  static const size_t kEventSize = 4;
+  // Pauses after this many are dropped until the queue is delivered.
+  static const size_t kMaxPendingEvents = 1024;
+
+  explicit GCStats(Environment* env);
+  ~GCStats();
+
+  void Start();
+  void Stop();
+  void Reset();
+  // Queues every pause for env()->gc_events_function() while enabled.
+  void SetEventsEnabled(bool enabled);
+
+  inline double* fields() { return fields_; }
+  inline int fields_count() const { return kTypesCount * kFieldsPerType; }
+
+ private:
+  static void OnPrologue(v8::Isolate* isolate,
+                         v8::GCType type,
+                         v8::GCCallbackFlags flags);
+  static void OnEpilogue(v8::Isolate* isolate,
+                         v8::GCType type,
+                         v8::GCCallbackFlags flags);
+  static void OnIdle(uv_idle_t* handle);
+  static void OnClose(Environment* env, uv_handle_t* handle, void* arg);
+  static int TypeIndex(v8::GCType type);
+
+  void Begin(int index, size_t used_heap_size);
+  void End(int index, size_t used_heap_size);
+  void DeliverEvents();
+
+  Environment* const env_;
+  uv_idle_t idle_;
+  bool started_;
+  bool events_enabled_;
+  uint64_t start_time_[kTypesCount];
+  size_t start_used_heap_size_[kTypesCount];
+  std::vector<double> pending_events_;
+  double fields_[kTypesCount * kFieldsPerType];
+
+  DISALLOW_COPY_AND_ASSIGN(GCStats);
+};
+
+}  // namespace node
+
+#endif  // SRC_NODE_GC_STATS_H_
@@ -0,0 +1,163 @@
+#include "node_heap_sizer.h"
+#include "util.h"
+#include "util-inl.h"
+#include "uv.h"
+#include "v8.h"
+
+#include <algorithm>
+#include <string.h>
+
+namespace node {
+
+using v8::GCCallbackFlags;
+using v8::GCType;
+using v8::HeapSpaceStatistics;
+using v8::Isolate;
+using v8::V8;
+
+// Weight of a scavenge in the moving averages, about the last eight count.
+static const double kWeight = 1.0 / 8;
+// Minimum scavenges before the averages are trusted.
+static const double kMinScavenges = 8;
+// The faster growth goes on above kHighOverhead of the time spent scavenging
+// while less than kLowPromotion of the young objects are promoted, and off
+// again below kLowOverhead or above kHighPromotion.
+static const double kHighOverhead = 0.05;
+static const double kLowOverhead = 0.02;
+static const double kLowPromotion = 0.3;
+static const double kHighPromotion = 0.5;
+
+static const char kFastGrowthFlags[] =
+    "--experimental-new-space-growth-heuristic --semi-space-growth-factor=4";
+static const char kDefaultGrowthFlags[] =
+    "--noexperimental-new-space-growth-heuristic --semi-space-growth-factor=2";
+
+HeapSizer* HeapSizer::instance_ = nullptr;
+double HeapSizer::fields_[HeapSizer::kFieldsCount];
+
+
+HeapSizer::HeapSizer(Isolate* isolate)
+    : isolate_(isolate),
+      new_space_(static_cast<size_t>(-1)),
+      old_space_(static_cast<size_t>(-1)),
+      start_time_(0),
+      last_end_time_(0),
+      start_new_used_(0),
+      start_old_used_(0) {
+  HeapSpaceStatistics s;
+  for (size_t i = 0; i < isolate->NumberOfHeapSpaces(); i++) {
+    if (!isolate->GetHeapSpaceStatistics(&s, i))
+      continue;
+    if (strcmp(s.space_name(), "new_space") == 0)
+      new_space_ = i;
+    else if (strcmp(s.space_name(), "old_space") == 0)
+      old_space_ = i;
+  }
+}
+
+
+void HeapSizer::Start(Isolate* isolate) {
+  if (instance_ != nullptr)
+    return;
+  memset(fields_, 0, sizeof(fields_));
+  instance_ = new HeapSizer(isolate);
+  isolate->AddGCPrologueCallback(OnPrologue, v8::kGCTypeScavenge);
+  isolate->AddGCEpilogueCallback(OnEpilogue, v8::kGCTypeScavenge);
+}
+
+
+void HeapSizer::OnPrologue(Isolate* isolate,
+                           GCType type,
+                           GCCallbackFlags flags) {
+  if (instance_ != nullptr && instance_->isolate_ == isolate)
+    instance_->Begin();
+}
+
+
+void HeapSizer::OnEpilogue(Isolate* isolate,
+                           GCType type,
+                           GCCallbackFlags flags) {
+  if (instance_ != nullptr && instance_->isolate_ == isolate)
+    instance_->End();
+}
+
+
+bool HeapSizer::SpaceStatistics(size_t index, HeapSpaceStatistics* s) {
+  return index != static_cast<size_t>(-1) &&
+         isolate_->GetHeapSpaceStatistics(s, index);
+}
+
+
+void HeapSizer::Begin() {
+  HeapSpaceStatistics s;
+  start_time_ = uv_hrtime();
+  start_new_used_ = SpaceStatistics(new_space_, &s) ? s.space_used_size() : 0;
+  start_old_used_ = SpaceStatistics(old_space_, &s) ? s.space_used_size() : 0;
+}
+
+
+void HeapSizer::End() {
+  if (start_time_ == 0)
+    return;
+
+  const uint64_t now = uv_hrtime();
+  HeapSpaceStatistics s;
+  if (SpaceStatistics(new_space_, &s))
+    fields_[kNewSpaceSize] = static_cast<double>(s.space_size());
+  const size_t old_used =
+      SpaceStatistics(old_space_, &s) ? s.space_used_size() : 0;
+
+  fields_[kScavengeCount] += 1;
+  const bool first = fields_[kScavengeCount] == 1;
+
+  // The time since the end of the previous scavenge is the time the program
+  // ran, so the first scavenge only starts the clock.
+  if (!first) {
+    const double pause = static_cast<double>(now - start_time_);
+    const double ran = static_cast<double>(start_time_ - last_end_time_);
+    const double overhead = pause / (pause + ran);
+    fields_[kScavengeOverhead] +=
+        kWeight * (overhead - fields_[kScavengeOverhead]);
+  }
+
+  if (start_new_used_ > 0) {
+    const double promoted = old_used > start_old_used_ ?
+        static_cast<double>(old_used - start_old_used_) : 0;
+    const double rate =
+        std::min(1.0, promoted / static_cast<double>(start_new_used_));
+    if (first)
+      fields_[kPromotionRate] = rate;
+    else
+      fields_[kPromotionRate] += kWeight * (rate - fields_[kPromotionRate]);
+  }
+
+  start_time_ = 0;
+  last_end_time_ = now;
+
+  if (fields_[kScavengeCount] < kMinScavenges)
+    return;
+
+  if (fields_[kFastGrowth] == 0) {
+    if (fields_[kScavengeOverhead] > kHighOverhead &&
+        fields_[kPromotionRate] < kLowPromotion) {
+      SetFastGrowth(true);
+    }
+  } else if (fields_[kScavengeOverhead] < kLowOverhead ||
+             fields_[kPromotionRate] > kHighPromotion) {
+    SetFastGrowth(false);
+  }
+}
+
+
+// V8 reads both flags when it decides whether to grow new space, after the
+// scavenges that follow.
+void HeapSizer::SetFastGrowth(bool enabled) {
+  fields_[kFastGrowth] = enabled ? 1 : 0;
+  if (enabled)
+    V8::SetFlagsFromString(kFastGrowthFlags, sizeof(kFastGrowthFlags) - 1);
+  else
+    V8::SetFlagsFromString(kDefaultGrowthFlags,
+                           sizeof(kDefaultGrowthFlags) - 1);
+}
+
+}  // namespace node
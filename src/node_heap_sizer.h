@@ -0,0 +1,84 @@
+#ifndef SRC_NODE_HEAP_SIZER_H_
+#define SRC_NODE_HEAP_SIZER_H_
+
+#include "util.h"
+#include "v8.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace node {
+
+#define HEAP_SIZER_FIELDS(V)                                                  \
+  V(0, kScavengeCount)                                                        \
+  V(1, kScavengeOverhead)                                                     \
+  V(2, kPromotionRate)                                                        \
+  V(3, kFastGrowth)                                                           \
+  V(4, kNewSpaceSize)                                                         \
+
+// Adapts the growth of the young generation of the main isolate to the
+// scavenges it sees, for --adaptive-heap.  V8 sizes new space on its own
+// between --min-semi-space-size and --max-semi-space-size, but only grows it
+// once as many bytes as it holds survived, which is slow for servers that
+// allocate a lot of short-lived objects.
+//
+// Every scavenge updates moving averages of the share of time spent in
+// scavenges and of the share of the young objects that were promoted.  When
+// scavenges take a lot of time and most of the objects still die young, a
+// larger new space means fewer of them, and V8 is switched to growing new
+// space after every scavenge that 10% survive, by a factor of 4.  When the
+// overhead drops or the objects mostly get promoted, which a larger new space
+// does not help with, V8's own heuristic is restored.  V8 still shrinks new
+// space when the allocation rate drops.
+//
+// The V8 flags are process wide, so there is a single instance.
+class HeapSizer {
+ public:
+  enum Fields {
+#define V(index, name) name = index,
+    HEAP_SIZER_FIELDS(V)
+#undef V
+    kFieldsCount
+  };
+
+  static void Start(v8::Isolate* isolate);
+  static bool started() { return instance_ != nullptr; }
+
+  // kScavengeCount is the number of scavenges seen, kScavengeOverhead and
+  // kPromotionRate are the moving averages, kFastGrowth is 1 while the faster
+  // growth is on and kNewSpaceSize the size of new space after the last
+  // scavenge.
+  static double* fields() { return fields_; }
+
+ private:
+  explicit HeapSizer(v8::Isolate* isolate);
+
+  static void OnPrologue(v8::Isolate* isolate,
+                         v8::GCType type,
+                         v8::GCCallbackFlags flags);
+  static void OnEpilogue(v8::Isolate* isolate,
+                         v8::GCType type,
+                         v8::GCCallbackFlags flags);
+
+  void Begin();
+  void End();
+  void SetFastGrowth(bool enabled);
+  bool SpaceStatistics(size_t index, v8::HeapSpaceStatistics* s);
+
+  static HeapSizer* instance_;
+  static double fields_[kFieldsCount];
+
+  v8::Isolate* const isolate_;
+  size_t new_space_;
+  size_t old_space_;
+  uint64_t start_time_;
+  uint64_t last_end_time_;
+  size_t start_new_used_;
+  size_t start_old_used_;
+
+  DISALLOW_COPY_AND_ASSIGN(HeapSizer);
+};
+
+}  // namespace node
+
+#endif  // SRC_NODE_HEAP_SIZER_H_
@@ -0,0 +1,596 @@
+#include "node.h"
+#include "node_buffer.h"
+#include "node_http2_core.h"
+
+#include "async-wrap.h"
+#include "async-wrap-inl.h"
+#include "env.h"
+#include "env-inl.h"
+#include "stream_base.h"
+#include "stream_base-inl.h"
+#include "util.h"
+#include "util-inl.h"
+#include "v8.h"
+
+#include <string.h>  // memcpy()
+
+// The binding of the HTTP/2 engine in node_http2_core.h.  A Http2Session
+// takes over the reads of a StreamBase, a TCPWrap or a TLSWrap, like the
+// HTTP parser does, and writes the frames back to it.  The events of the
+// streams go to JS through the indexed callbacks below.
+
+namespace node {
+namespace http2 {
+
+using v8::Array;
+using v8::Boolean;
+using v8::Context;
+using v8::External;
+using v8::Function;
+using v8::FunctionCallbackInfo;
+using v8::FunctionTemplate;
+using v8::HandleScope;
+using v8::Integer;
+using v8::Local;
+using v8::Object;
+using v8::String;
+using v8::Value;
+
+const uint32_t kOnHeaders = 0;
+const uint32_t kOnData = 1;
+const uint32_t kOnStreamEnd = 2;
+const uint32_t kOnStreamClose = 3;
+const uint32_t kOnStreamDrain = 4;
+const uint32_t kOnGoaway = 5;
+const uint32_t kOnError = 6;
+
+
+class Http2Session : public AsyncWrap, public Session::Listener {
+ public:
+  Http2Session(Environment* env,
+               Local<Object> object,
+               Session::Type type,
+               const Settings& settings)
+      : AsyncWrap(env, object, AsyncWrap::PROVIDER_HTTP2SESSION),
+        session_(new Session(type, this, settings)),
+        stream_(nullptr),
+        pending_bytes_(0),
+        pending_writes_(0),
+        depth_(0),
+        receiving_(false),
+        flush_pending_(false),
+        destroy_pending_(false) {
+    Wrap(object, this);
+  }
+
+  ~Http2Session() override {
+    CHECK_EQ(stream_, nullptr);
+    delete session_;
+  }
+
+  size_t self_size() const override { return sizeof(*this); }
+
+  static void New(const FunctionCallbackInfo<Value>& args) {
+    CHECK(args.IsConstructCall());
+    CHECK(args[0]->IsUint32());
+    CHECK(args[1]->IsArray());
+    Environment* env = Environment::GetCurrent(args);
+    Local<Array> values = args[1].As<Array>();
+    CHECK_EQ(values->Length(), 5);
+
+    // The order of lib/http2.js' settingsToArray().
+    Settings settings;
+    settings.header_table_size = values->Get(0)->Uint32Value();
+    settings.max_concurrent_streams = values->Get(1)->Uint32Value();
+    settings.initial_window_size = values->Get(2)->Uint32Value();
+    settings.max_frame_size = values->Get(3)->Uint32Value();
+    settings.max_header_list_size = values->Get(4)->Uint32Value();
+
+    Session::Type type = args[0]->Uint32Value() == 0 ? Session::kServer
+                                                     : Session::kClient;
+    new Http2Session(env, args.This(), type, settings);
+  }
+
+  // consume(socket._handle._externalStream)
+  static void Consume(const FunctionCallbackInfo<Value>& args) {
+    Http2Session* session = Unwrap<Http2Session>(args.Holder());
+    CHECK(args[0]->IsExternal());
+    CHECK_EQ(session->stream_, nullptr);
+    StreamBase* stream =
+        static_cast<StreamBase*>(args[0].As<External>()->Value());
+    CHECK_NE(stream, nullptr);
+
+    stream->Consume();
+    session->prev_alloc_cb_ = stream->alloc_cb();
+    session->prev_read_cb_ = stream->read_cb();
+    stream->set_alloc_cb({ OnAlloc, session });
+    stream->set_read_cb({ OnRead, session });
+    session->stream_ = stream;
+
+    args.GetReturnValue().Set(stream->ReadStart());
+    session->Flush();
+  }
+
+  // Gives the stream back, which JS does before the socket is closed.
+  static void Unconsume(const FunctionCallbackInfo<Value>& args) {
+    Http2Session* session = Unwrap<Http2Session>(args.Holder());
+    session->Detach();
+  }
+
+  // Data that the socket read before it was consumed.
+  static void Receive(const FunctionCallbackInfo<Value>& args) {
+    Http2Session* session = Unwrap<Http2Session>(args.Holder());
+    CHECK(Buffer::HasInstance(args[0]));
+    session->ReceiveData(Buffer::Data(args[0]), Buffer::Length(args[0]));
+  }
+
+  // request(headers, endStream), headers as [name, value, ...]
+  static void Request(const FunctionCallbackInfo<Value>& args) {
+    Http2Session* session = Unwrap<Http2Session>(args.Holder());
+    CHECK(args[0]->IsArray());
+    if (session->destroy_pending_)
+      return args.GetReturnValue().Set(0);
+
+    Headers headers;
+    ToHeaders(args[0].As<Array>(), &headers);
+    Scope scope(session);
+    uint32_t id = session->session_->SubmitRequest(headers, args[1]->IsTrue());
+    session->Flush();
+    args.GetReturnValue().Set(id);
+  }
+
+  // respond(id, headers, endStream), also for trailers.
+  static void Respond(const FunctionCallbackInfo<Value>& args) {
+    Http2Session* session = Unwrap<Http2Session>(args.Holder());
+    CHECK(args[0]->IsUint32());
+    CHECK(args[1]->IsArray());
+    if (session->destroy_pending_)
+      return args.GetReturnValue().Set(false);
+
+    Headers headers;
+    ToHeaders(args[1].As<Array>(), &headers);
+    Scope scope(session);
+    bool ok = session->session_->SubmitHeaders(args[0]->Uint32Value(),
+                                               headers,
+                                               args[2]->IsTrue());
+    session->Flush();
+    args.GetReturnValue().Set(ok);
+  }
+
+  // write(id, buffer, endStream).  ondrain(id) is called once everything
+  // has gone out.
+  static void Write(const FunctionCallbackInfo<Value>& args) {
+    Http2Session* session = Unwrap<Http2Session>(args.Holder());
+    CHECK(args[0]->IsUint32());
+    CHECK(Buffer::HasInstance(args[1]));
+    if (session->destroy_pending_)
+      return args.GetReturnValue().Set(false);
+
+    Scope scope(session);
+    bool ok = session->session_->SubmitData(args[0]->Uint32Value(),
+                                            Buffer::Data(args[1]),
+                                            Buffer::Length(args[1]),
+                                            args[2]->IsTrue());
+    session->Flush();
+    args.GetReturnValue().Set(ok);
+  }
+
+  // rstStream(id, code)
+  static void RstStream(const FunctionCallbackInfo<Value>& args) {
+    Http2Session* session = Unwrap<Http2Session>(args.Holder());
+    CHECK(args[0]->IsUint32());
+    CHECK(args[1]->IsUint32());
+    if (session->destroy_pending_)
+      return;
+
+    Scope scope(session);
+    session->session_->SubmitRstStream(args[0]->Uint32Value(),
+                                       args[1]->Uint32Value());
+    session->Flush();
+  }
+
+  // goaway(code)
+  static void Goaway(const FunctionCallbackInfo<Value>& args) {
+    Http2Session* session = Unwrap<Http2Session>(args.Holder());
+    CHECK(args[0]->IsUint32());
+    if (session->destroy_pending_)
+      return;
+
+    Scope scope(session);
+    session->session_->SubmitGoaway(args[0]->Uint32Value());
+    session->Flush();
+  }
+
+  // consumed(id, length), when JS has read that much of a stream's data.
+  static void Consumed(const FunctionCallbackInfo<Value>& args) {
+    Http2Session* session = Unwrap<Http2Session>(args.Holder());
+    CHECK(args[0]->IsUint32());
+    CHECK(args[1]->IsUint32());
+    if (session->destroy_pending_)
+      return;
+
+    Scope scope(session);
+    session->session_->Consume(args[0]->Uint32Value(),
+                               args[1]->Uint32Value());
+    session->Flush();
+  }
+
+  static void Destroy(const FunctionCallbackInfo<Value>& args) {
+    Http2Session* session = Unwrap<Http2Session>(args.Holder());
+    if (session->destroy_pending_)
+      return;
+    session->Detach();
+    session->destroy_pending_ = true;
+    session->MaybeRelease();
+  }
+
+  // Session::Listener
+  void OnHeaders(uint32_t id, Headers* headers, bool end_stream) override {
+    HandleScope scope(env()->isolate());
+    Local<Array> list = Array::New(env()->isolate(), headers->size() * 2);
+    for (size_t i = 0; i < headers->size(); i++) {
+      const Header& header = (*headers)[i];
+      list->Set(i * 2, OneByteString(env()->isolate(),
+                                     header.name.data(),
+                                     header.name.size()));
+      list->Set(i * 2 + 1, OneByteString(env()->isolate(),
+                                         header.value.data(),
+                                         header.value.size()));
+    }
+    Local<Value> argv[] = {
+      Integer::NewFromUnsigned(env()->isolate(), id),
+      list,
+      Boolean::New(env()->isolate(), end_stream)
+    };
+    Call(kOnHeaders, arraysize(argv), argv);
+  }
+
+  void OnData(uint32_t id, const char* data, size_t length) override {
+    HandleScope scope(env()->isolate());
+    Local<Value> argv[] = {
+      Integer::NewFromUnsigned(env()->isolate(), id),
+      Buffer::Copy(env(), data, length).ToLocalChecked()
+    };
+    Call(kOnData, arraysize(argv), argv);
+  }
+
+  void OnStreamEnd(uint32_t id) override {
+    HandleScope scope(env()->isolate());
+    Local<Value> argv[] = { Integer::NewFromUnsigned(env()->isolate(), id) };
+    Call(kOnStreamEnd, arraysize(argv), argv);
+  }
+
+  void OnStreamClose(uint32_t id, uint32_t code) override {
+    HandleScope scope(env()->isolate());
+    Local<Value> argv[] = {
+      Integer::NewFromUnsigned(env()->isolate(), id),
+      Integer::NewFromUnsigned(env()->isolate(), code)
+    };
+    Call(kOnStreamClose, arraysize(argv), argv);
+  }
+
+  void OnStreamDrain(uint32_t id) override {
+    HandleScope scope(env()->isolate());
+    Local<Value> argv[] = { Integer::NewFromUnsigned(env()->isolate(), id) };
+    Call(kOnStreamDrain, arraysize(argv), argv);
+  }
+
+  void OnGoaway(uint32_t code, uint32_t last_stream_id) override {
+    HandleScope scope(env()->isolate());
+    Local<Value> argv[] = {
+      Integer::NewFromUnsigned(env()->isolate(), code),
+      Integer::NewFromUnsigned(env()->isolate(), last_stream_id)
+    };
+    Call(kOnGoaway, arraysize(argv), argv);
+  }
+
+  // onerror(code) for connection errors, onerror(0, uvError) for failed
+  // writes.
+  void OnSessionError(uint32_t code) override {
+    HandleScope scope(env()->isolate());
+    Local<Value> argv[] = {
+      Integer::NewFromUnsigned(env()->isolate(), code),
+      Integer::New(env()->isolate(), 0)
+    };
+    Call(kOnError, arraysize(argv), argv);
+  }
+
+ private:
+  // Lives in the extra storage of the WriteWraps.
+  struct PendingWrite {
+    Http2Session* session;
+    size_t length;
+  };
+
+  // Keeps the engine alive while it is on the stack: destroy() from one of
+  // the callbacks only takes effect once the engine has returned, and the
+  // frames are written once, after all the input has been processed.
+  class Scope {
+   public:
+    explicit Scope(Http2Session* session) : session_(session) {
+      session_->depth_++;
+    }
+    ~Scope() {
+      session_->depth_--;
+      session_->MaybeRelease();
+    }
+
+   private:
+    Http2Session* const session_;
+  };
+
+  // DATA frames are produced while less than this is waiting to be
+  // written, the other frames go out regardless.
+  static const size_t kHighWaterMark = 256 * 1024;
+
+  static void ToHeaders(Local<Array> list, Headers* headers) {
+    const uint32_t length = list->Length();
+    CHECK_EQ(length % 2, 0);
+    headers->resize(length / 2);
+    for (uint32_t i = 0; i < length; i++) {
+      Local<String> string = list->Get(i).As<String>();
+      CHECK(string->IsString());
+      std::string* out = i % 2 == 0 ? &(*headers)[i / 2].name
+                                    : &(*headers)[i / 2].value;
+      out->resize(string->Length());
+      if (!out->empty()) {
+        string->WriteOneByte(reinterpret_cast<uint8_t*>(&(*out)[0]),
+                             0,
+                             out->size(),
+                             String::NO_NULL_TERMINATION);
+      }
+    }
+  }
+
+  void Call(uint32_t index, int argc, Local<Value>* argv) {
+    Local<Value> cb = object()->Get(index);
+    if (cb->IsFunction())
+      MakeCallback(cb.As<Function>(), argc, argv);
+  }
+
+  static void OnAlloc(size_t suggested_size, uv_buf_t* buf, void* ctx) {
+    // The engine copies what it keeps before the next read.
+    Http2Session* session = static_cast<Http2Session*>(ctx);
+    *buf = uv_buf_init(session->env()->shared_read_buffer(),
+                       Environment::kSharedReadBufferSize);
+  }
+
+  static void OnRead(ssize_t nread,
+                     const uv_buf_t* buf,
+                     uv_handle_type pending,
+                     void* ctx) {
+    Http2Session* session = static_cast<Http2Session*>(ctx);
+    if (nread > 0) {
+      session->ReceiveData(buf->base, nread);
+      return;
+    }
+    if (nread == 0)
+      return;
+
+    // The socket's JS object sees the EOF or the error with its own
+    // callbacks, lib/http2.js closes the session from there.
+    uv_buf_t empty = uv_buf_init(nullptr, 0);
+    StreamResource::Callback<StreamResource::ReadCb> read_cb =
+        session->prev_read_cb_;
+    session->Detach();
+    read_cb.fn(nread, &empty, pending, read_cb.ctx);
+  }
+
+  void ReceiveData(const char* data, size_t length) {
+    if (destroy_pending_)
+      return;
+    HandleScope handle_scope(env()->isolate());
+    Context::Scope context_scope(env()->context());
+    Scope scope(this);
+    // What the callbacks submit is written once all of the data has been
+    // processed.
+    receiving_ = true;
+    session_->Receive(reinterpret_cast<const uint8_t*>(data), length);
+    receiving_ = false;
+    Flush();
+  }
+
+  void Flush() {
+    // The callbacks of Serialize() can submit more, that is picked up by
+    // the loop below.
+    if (stream_ == nullptr || destroy_pending_ || receiving_ || flush_pending_)
+      return;
+    flush_pending_ = true;
+    Scope scope(this);
+    std::string out;
+    do {
+      out.clear();
+      size_t budget =
+          pending_bytes_ < kHighWaterMark ? kHighWaterMark - pending_bytes_
+                                          : 0;
+      session_->Serialize(&out, budget);
+      if (stream_ == nullptr || (!out.empty() && !WriteOut(&out)))
+        break;
+    } while (stream_ != nullptr &&
+             !destroy_pending_ &&
+             pending_bytes_ < kHighWaterMark &&
+             session_->WantsWrite());
+    flush_pending_ = false;
+  }
+
+  bool WriteOut(std::string* out) {
+    if (!stream_->IsAlive())
+      return false;
+    const size_t length = out->size();
+    uv_buf_t buf = uv_buf_init(&(*out)[0], length);
+    uv_buf_t* bufs = &buf;
+    size_t count = 1;
+
+    int err = stream_->DoTryWrite(&bufs, &count);
+    if (err == 0 && count == 0) {
+      stream_->OnBytesWritten(length);
+      return true;
+    }
+
+    if (err == 0) {
+      HandleScope handle_scope(env()->isolate());
+      Context::Scope context_scope(env()->context());
+
+      // What is left is copied behind the PendingWrite.
+      const size_t rest = bufs[0].len;
+      Local<Object> req_wrap_obj =
+          env()->write_wrap_constructor_function()
+              ->NewInstance(env()->context()).ToLocalChecked();
+      WriteWrap* req_wrap = WriteWrap::New(env(),
+                                           req_wrap_obj,
+                                           stream_,
+                                           OnWriteDone,
+                                           sizeof(PendingWrite) + rest);
+      PendingWrite* write =
+          reinterpret_cast<PendingWrite*>(req_wrap->Extra());
+      char* copy = req_wrap->Extra() + sizeof(PendingWrite);
+      memcpy(copy, bufs[0].base, rest);
+      write->session = this;
+      write->length = rest;
+      uv_buf_t copy_buf = uv_buf_init(copy, rest);
+
+      err = stream_->DoWrite(req_wrap, &copy_buf, 1, nullptr);
+      if (err) {
+        req_wrap->Dispose();
+      } else {
+        stream_->OnBytesWritten(length);
+        pending_bytes_ += rest;
+        pending_writes_++;
+      }
+    }
+
+    if (stream_->Error() != nullptr)
+      stream_->ClearError();
+
+    if (err) {
+      WriteFailed(err);
+      return false;
+    }
+    return true;
+  }
+
+  static void OnWriteDone(WriteWrap* req_wrap, int status) {
+    PendingWrite* write = reinterpret_cast<PendingWrite*>(req_wrap->Extra());
+    Http2Session* session = write->session;
+    StreamBase* stream = req_wrap->wrap();
+
+    session->pending_bytes_ -= write->length;
+    session->pending_writes_--;
+    stream->OnAfterWrite(req_wrap);
+    req_wrap->Dispose();
+
+    HandleScope handle_scope(session->env()->isolate());
+    Context::Scope context_scope(session->env()->context());
+    Scope scope(session);
+    if (status != 0 && status != UV_ECANCELED)
+      session->WriteFailed(status);
+    else if (status == 0)
+      session->Flush();
+  }
+
+  void WriteFailed(int status) {
+    HandleScope scope(env()->isolate());
+    Local<Value> argv[] = {
+      Integer::New(env()->isolate(), 0),
+      Integer::New(env()->isolate(), status)
+    };
+    Detach();
+    Call(kOnError, arraysize(argv), argv);
+  }
+
+  void Detach() {
+    if (stream_ == nullptr)
+      return;
+    stream_->set_alloc_cb(prev_alloc_cb_);
+    stream_->set_read_cb(prev_read_cb_);
+    prev_alloc_cb_.clear();
+    prev_read_cb_.clear();
+    stream_ = nullptr;
+  }
+
+  // The GC can have the session once JS destroyed it, nothing is on the
+  // stack and the last write is done.
+  void MaybeRelease() {
+    if (!destroy_pending_ || depth_ > 0 || pending_writes_ > 0 ||
+        persistent().IsWeak()) {
+      return;
+    }
+    MakeWeak<Http2Session>(this);
+  }
+
+  Session* const session_;
+  StreamBase* stream_;
+  StreamResource::Callback<StreamResource::AllocCb> prev_alloc_cb_;
+  StreamResource::Callback<StreamResource::ReadCb> prev_read_cb_;
+  size_t pending_bytes_;
+  size_t pending_writes_;
+  int depth_;
+  bool receiving_;
+  bool flush_pending_;
+  bool destroy_pending_;
+
+  DISALLOW_COPY_AND_ASSIGN(Http2Session);
+};
+
+
+void Initialize(Local<Object> target,
+                Local<Value> unused,
+                Local<Context> context) {
+  Environment* env = Environment::GetCurrent(context);
+  Local<FunctionTemplate> t = env->NewFunctionTemplate(Http2Session::New);
+  t->InstanceTemplate()->SetInternalFieldCount(1);
+  t->SetClassName(FIXED_ONE_BYTE_STRING(env->isolate(), "Http2Session"));
+
+#define V(name)                                                               \
+  t->Set(FIXED_ONE_BYTE_STRING(env->isolate(), #name),                        \
+         Integer::NewFromUnsigned(env->isolate(), name));
+  V(kOnHeaders)
+  V(kOnData)
+  V(kOnStreamEnd)
+  V(kOnStreamClose)
+  V(kOnStreamDrain)
+  V(kOnGoaway)
+  V(kOnError)
+#undef V
+
+  env->SetProtoMethod(t, "consume", Http2Session::Consume);
+  env->SetProtoMethod(t, "unconsume", Http2Session::Unconsume);
+  env->SetProtoMethod(t, "receive", Http2Session::Receive);
+  env->SetProtoMethod(t, "request", Http2Session::Request);
+  env->SetProtoMethod(t, "respond", Http2Session::Respond);
+  env->SetProtoMethod(t, "write", Http2Session::Write);
+  env->SetProtoMethod(t, "rstStream", Http2Session::RstStream);
+  env->SetProtoMethod(t, "goaway", Http2Session::Goaway);
+  env->SetProtoMethod(t, "consumed", Http2Session::Consumed);
+  env->SetProtoMethod(t, "destroy", Http2Session::Destroy);
+
+  target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "Http2Session"),
+              t->GetFunction());
+
+  Local<Object> codes = Object::New(env->isolate());
+#define V(name, value)                                                        \
+  codes->Set(FIXED_ONE_BYTE_STRING(env->isolate(), #name),                    \
+             Integer::NewFromUnsigned(env->isolate(), value));
+  HTTP2_ERROR_CODES(V)
+#undef V
+  target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "codes"), codes);
+
+  Local<Object> defaults = Object::New(env->isolate());
+  Settings settings;
+#define V(name, field)                                                        \
+  defaults->Set(FIXED_ONE_BYTE_STRING(env->isolate(), name),                  \
+                Integer::NewFromUnsigned(env->isolate(), settings.field));
+  V("headerTableSize", header_table_size)
+  V("maxConcurrentStreams", max_concurrent_streams)
+  V("initialWindowSize", initial_window_size)
+  V("maxFrameSize", max_frame_size)
+  V("maxHeaderListSize", max_header_list_size)
+#undef V
+  target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "defaultSettings"),
+              defaults);
+}
+
+}  // namespace http2
+}  // namespace node
+
+NODE_MODULE_CONTEXT_AWARE_BUILTIN(http2, node::http2::Initialize)
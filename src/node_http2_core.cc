@@ -0,0 +1,1379 @@
+#include "node_http2_core.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+
+namespace node {
+namespace http2 {
+
+namespace {
+
+const char kClientMagic[] = "PRI * HTTP/2.0\r\n\r\nSM\r\n\r\n";
+const size_t kClientMagicLength = sizeof(kClientMagic) - 1;
+
+const uint32_t kMaxStreamId = 0x7fffffff;
+
+// The connection's receive window is raised from the 64KB that RFC 7540
+// starts with, a single busy stream would otherwise stall the others.
+const uint32_t kConnectionWindowSize = 1024 * 1024;
+
+struct StaticEntry {
+  const char* name;
+  const char* value;
+};
+
+// RFC 7541 Appendix A.
+const StaticEntry kStaticTable[] = {
+  { ":authority", "" },
+  { ":method", "GET" },
+  { ":method", "POST" },
+  { ":path", "/" },
+  { ":path", "/index.html" },
+  { ":scheme", "http" },
+  { ":scheme", "https" },
+  { ":status", "200" },
+  { ":status", "204" },
+  { ":status", "206" },
+  { ":status", "304" },
+  { ":status", "400" },
+  { ":status", "404" },
+  { ":status", "500" },
+  { "accept-charset", "" },
+  { "accept-encoding", "gzip, deflate" },
+  { "accept-language", "" },
+  { "accept-ranges", "" },
+  { "accept", "" },
+  { "access-control-allow-origin", "" },
+  { "age", "" },
+  { "allow", "" },
+  { "authorization", "" },
+  { "cache-control", "" },
+  { "content-disposition", "" },
+  { "content-encoding", "" },
+  { "content-language", "" },
+  { "content-length", "" },
+  { "content-location", "" },
+  { "content-range", "" },
+  { "content-type", "" },
+  { "cookie", "" },
+  { "date", "" },
+  { "etag", "" },
+  { "expect", "" },
+  { "expires", "" },
+  { "from", "" },
+  { "host", "" },
+  { "if-match", "" },
+  { "if-modified-since", "" },
+  { "if-none-match", "" },
+  { "if-range", "" },
+  { "if-unmodified-since", "" },
+  { "last-modified", "" },
+  { "link", "" },
+  { "location", "" },
+  { "max-forwards", "" },
+  { "proxy-authenticate", "" },
+  { "proxy-authorization", "" },
+  { "range", "" },
+  { "referer", "" },
+  { "refresh", "" },
+  { "retry-after", "" },
+  { "server", "" },
+  { "set-cookie", "" },
+  { "strict-transport-security", "" },
+  { "transfer-encoding", "" },
+  { "user-agent", "" },
+  { "vary", "" },
+  { "via", "" },
+  { "www-authenticate", "" }
+};
+
+const size_t kStaticTableLength =
+    sizeof(kStaticTable) / sizeof(kStaticTable[0]);
+
+const std::vector<Header>& StaticHeaders() {
+  static std::vector<Header> headers;
+  if (headers.empty()) {
+    for (size_t i = 0; i < kStaticTableLength; i++)
+      headers.push_back(Header(kStaticTable[i].name, kStaticTable[i].value));
+  }
+  return headers;
+}
+
+struct HuffmanCode {
+  uint32_t code;
+  uint8_t bits;
+};
+
+// RFC 7541 Appendix B, indexed by symbol; 256 is EOS.
+const HuffmanCode kHuffmanTable[257] = {
+  { 0x00001ff8, 13 }, { 0x007fffd8, 23 }, { 0x0fffffe2, 28 },
+  { 0x0fffffe3, 28 }, { 0x0fffffe4, 28 }, { 0x0fffffe5, 28 },
+  { 0x0fffffe6, 28 }, { 0x0fffffe7, 28 }, { 0x0fffffe8, 28 },
+  { 0x00ffffea, 24 }, { 0x3ffffffc, 30 }, { 0x0fffffe9, 28 },
+  { 0x0fffffea, 28 }, { 0x3ffffffd, 30 }, { 0x0fffffeb, 28 },
+  { 0x0fffffec, 28 }, { 0x0fffffed, 28 }, { 0x0fffffee, 28 },
+  { 0x0fffffef, 28 }, { 0x0ffffff0, 28 }, { 0x0ffffff1, 28 },
+  { 0x0ffffff2, 28 }, { 0x3ffffffe, 30 }, { 0x0ffffff3, 28 },
+  { 0x0ffffff4, 28 }, { 0x0ffffff5, 28 }, { 0x0ffffff6, 28 },
+  { 0x0ffffff7, 28 }, { 0x0ffffff8, 28 }, { 0x0ffffff9, 28 },
+  { 0x0ffffffa, 28 }, { 0x0ffffffb, 28 }, { 0x00000014,  6 },
+  { 0x000003f8, 10 }, { 0x000003f9, 10 }, { 0x00000ffa, 12 },
+  { 0x00001ff9, 13 }, { 0x00000015,  6 }, { 0x000000f8,  8 },
+  { 0x000007fa, 11 }, { 0x000003fa, 10 }, { 0x000003fb, 10 },
+  { 0x000000f9,  8 }, { 0x000007fb, 11 }, { 0x000000fa,  8 },
+  { 0x00000016,  6 }, { 0x00000017,  6 }, { 0x00000018,  6 },
+  { 0x00000000,  5 }, { 0x00000001,  5 }, { 0x00000002,  5 },
+  { 0x00000019,  6 }, { 0x0000001a,  6 }, { 0x0000001b,  6 },
+  { 0x0000001c,  6 }, { 0x0000001d,  6 }, { 0x0000001e,  6 },
+  { 0x0000001f,  6 }, { 0x0000005c,  7 }, { 0x000000fb,  8 },
+  { 0x00007ffc, 15 }, { 0x00000020,  6 }, { 0x00000ffb, 12 },
+  { 0x000003fc, 10 }, { 0x00001ffa, 13 }, { 0x00000021,  6 },
+  { 0x0000005d,  7 }, { 0x0000005e,  7 }, { 0x0000005f,  7 },
+  { 0x00000060,  7 }, { 0x00000061,  7 }, { 0x00000062,  7 },
+  { 0x00000063,  7 }, { 0x00000064,  7 }, { 0x00000065,  7 },
+  { 0x00000066,  7 }, { 0x00000067,  7 }, { 0x00000068,  7 },
+  { 0x00000069,  7 }, { 0x0000006a,  7 }, { 0x0000006b,  7 },
+  { 0x0000006c,  7 }, { 0x0000006d,  7 }, { 0x0000006e,  7 },
+  { 0x0000006f,  7 }, { 0x00000070,  7 }, { 0x00000071,  7 },
+  { 0x00000072,  7 }, { 0x000000fc,  8 }, { 0x00000073,  7 },
+  { 0x000000fd,  8 }, { 0x00001ffb, 13 }, { 0x0007fff0, 19 },
+  { 0x00001ffc, 13 }, { 0x00003ffc, 14 }, { 0x00000022,  6 },
+  { 0x00007ffd, 15 }, { 0x00000003,  5 }, { 0x00000023,  6 },
+  { 0x00000004,  5 }, { 0x00000024,  6 }, { 0x00000005,  5 },
+  { 0x00000025,  6 }, { 0x00000026,  6 }, { 0x00000027,  6 },
+  { 0x00000006,  5 }, { 0x00000074,  7 }, { 0x00000075,  7 },
+  { 0x00000028,  6 }, { 0x00000029,  6 }, { 0x0000002a,  6 },
+  { 0x00000007,  5 }, { 0x0000002b,  6 }, { 0x00000076,  7 },
+  { 0x0000002c,  6 }, { 0x00000008,  5 }, { 0x00000009,  5 },
+  { 0x0000002d,  6 }, { 0x00000077,  7 }, { 0x00000078,  7 },
+  { 0x00000079,  7 }, { 0x0000007a,  7 }, { 0x0000007b,  7 },
+  { 0x00007ffe, 15 }, { 0x000007fc, 11 }, { 0x00003ffd, 14 },
+  { 0x00001ffd, 13 }, { 0x0ffffffc, 28 }, { 0x000fffe6, 20 },
+  { 0x003fffd2, 22 }, { 0x000fffe7, 20 }, { 0x000fffe8, 20 },
+  { 0x003fffd3, 22 }, { 0x003fffd4, 22 }, { 0x003fffd5, 22 },
+  { 0x007fffd9, 23 }, { 0x003fffd6, 22 }, { 0x007fffda, 23 },
+  { 0x007fffdb, 23 }, { 0x007fffdc, 23 }, { 0x007fffdd, 23 },
+  { 0x007fffde, 23 }, { 0x00ffffeb, 24 }, { 0x007fffdf, 23 },
+  { 0x00ffffec, 24 }, { 0x00ffffed, 24 }, { 0x003fffd7, 22 },
+  { 0x007fffe0, 23 }, { 0x00ffffee, 24 }, { 0x007fffe1, 23 },
+  { 0x007fffe2, 23 }, { 0x007fffe3, 23 }, { 0x007fffe4, 23 },
+  { 0x001fffdc, 21 }, { 0x003fffd8, 22 }, { 0x007fffe5, 23 },
+  { 0x003fffd9, 22 }, { 0x007fffe6, 23 }, { 0x007fffe7, 23 },
+  { 0x00ffffef, 24 }, { 0x003fffda, 22 }, { 0x001fffdd, 21 },
+  { 0x000fffe9, 20 }, { 0x003fffdb, 22 }, { 0x003fffdc, 22 },
+  { 0x007fffe8, 23 }, { 0x007fffe9, 23 }, { 0x001fffde, 21 },
+  { 0x007fffea, 23 }, { 0x003fffdd, 22 }, { 0x003fffde, 22 },
+  { 0x00fffff0, 24 }, { 0x001fffdf, 21 }, { 0x003fffdf, 22 },
+  { 0x007fffeb, 23 }, { 0x007fffec, 23 }, { 0x001fffe0, 21 },
+  { 0x001fffe1, 21 }, { 0x003fffe0, 22 }, { 0x001fffe2, 21 },
+  { 0x007fffed, 23 }, { 0x003fffe1, 22 }, { 0x007fffee, 23 },
+  { 0x007fffef, 23 }, { 0x000fffea, 20 }, { 0x003fffe2, 22 },
+  { 0x003fffe3, 22 }, { 0x003fffe4, 22 }, { 0x007ffff0, 23 },
+  { 0x003fffe5, 22 }, { 0x003fffe6, 22 }, { 0x007ffff1, 23 },
+  { 0x03ffffe0, 26 }, { 0x03ffffe1, 26 }, { 0x000fffeb, 20 },
+  { 0x0007fff1, 19 }, { 0x003fffe7, 22 }, { 0x007ffff2, 23 },
+  { 0x003fffe8, 22 }, { 0x01ffffec, 25 }, { 0x03ffffe2, 26 },
+  { 0x03ffffe3, 26 }, { 0x03ffffe4, 26 }, { 0x07ffffde, 27 },
+  { 0x07ffffdf, 27 }, { 0x03ffffe5, 26 }, { 0x00fffff1, 24 },
+  { 0x01ffffed, 25 }, { 0x0007fff2, 19 }, { 0x001fffe3, 21 },
+  { 0x03ffffe6, 26 }, { 0x07ffffe0, 27 }, { 0x07ffffe1, 27 },
+  { 0x03ffffe7, 26 }, { 0x07ffffe2, 27 }, { 0x00fffff2, 24 },
+  { 0x001fffe4, 21 }, { 0x001fffe5, 21 }, { 0x03ffffe8, 26 },
+  { 0x03ffffe9, 26 }, { 0x0ffffffd, 28 }, { 0x07ffffe3, 27 },
+  { 0x07ffffe4, 27 }, { 0x07ffffe5, 27 }, { 0x000fffec, 20 },
+  { 0x00fffff3, 24 }, { 0x000fffed, 20 }, { 0x001fffe6, 21 },
+  { 0x003fffe9, 22 }, { 0x001fffe7, 21 }, { 0x001fffe8, 21 },
+  { 0x007ffff3, 23 }, { 0x003fffea, 22 }, { 0x003fffeb, 22 },
+  { 0x01ffffee, 25 }, { 0x01ffffef, 25 }, { 0x00fffff4, 24 },
+  { 0x00fffff5, 24 }, { 0x03ffffea, 26 }, { 0x007ffff4, 23 },
+  { 0x03ffffeb, 26 }, { 0x07ffffe6, 27 }, { 0x03ffffec, 26 },
+  { 0x03ffffed, 26 }, { 0x07ffffe7, 27 }, { 0x07ffffe8, 27 },
+  { 0x07ffffe9, 27 }, { 0x07ffffea, 27 }, { 0x07ffffeb, 27 },
+  { 0x0ffffffe, 28 }, { 0x07ffffec, 27 }, { 0x07ffffed, 27 },
+  { 0x07ffffee, 27 }, { 0x07ffffef, 27 }, { 0x07fffff0, 27 },
+  { 0x03ffffee, 26 }, { 0x3fffffff, 30 }
+};
+
+const int kEos = 256;
+
+// The decoding tree, built on first use.  Every inner node has both
+// children because the code is complete.
+struct HuffmanNode {
+  int16_t children[2];
+  int16_t symbol;
+};
+
+const std::vector<HuffmanNode>& HuffmanTree() {
+  static std::vector<HuffmanNode> tree;
+  if (!tree.empty())
+    return tree;
+  const HuffmanNode empty = { { -1, -1 }, -1 };
+  tree.push_back(empty);
+  for (int symbol = 0; symbol <= kEos; symbol++) {
+    const HuffmanCode& code = kHuffmanTable[symbol];
+    size_t node = 0;
+    for (int bit = code.bits - 1; bit >= 0; bit--) {
+      const int branch = (code.code >> bit) & 1;
+      if (tree[node].children[branch] < 0) {
+        tree[node].children[branch] = static_cast<int16_t>(tree.size());
+        tree.push_back(empty);
+      }
+      node = tree[node].children[branch];
+    }
+    tree[node].symbol = static_cast<int16_t>(symbol);
+  }
+  return tree;
+}
+
+
+// Integers with an N-bit prefix, RFC 7541 5.1.  *data is the byte with
+// the prefix, the caller checks that there is one.
+bool DecodeInteger(const uint8_t** data,
+                   const uint8_t* end,
+                   int prefix_bits,
+                   uint32_t* value) {
+  const uint32_t mask = (1u << prefix_bits) - 1;
+  uint64_t result = **data & mask;
+  ++*data;
+  if (result < mask) {
+    *value = static_cast<uint32_t>(result);
+    return true;
+  }
+  for (int shift = 0; *data < end && shift <= 28; shift += 7) {
+    const uint8_t byte = **data;
+    ++*data;
+    result += static_cast<uint64_t>(byte & 0x7f) << shift;
+    if ((byte & 0x80) == 0) {
+      if (result > 0xffffffff)
+        return false;
+      *value = static_cast<uint32_t>(result);
+      return true;
+    }
+  }
+  return false;
+}
+
+void EncodeInteger(std::string* out,
+                   uint8_t flags,
+                   int prefix_bits,
+                   uint32_t value) {
+  const uint32_t mask = (1u << prefix_bits) - 1;
+  if (value < mask) {
+    out->push_back(static_cast<char>(flags | value));
+    return;
+  }
+  out->push_back(static_cast<char>(flags | mask));
+  value -= mask;
+  while (value >= 0x80) {
+    out->push_back(static_cast<char>((value & 0x7f) | 0x80));
+    value >>= 7;
+  }
+  out->push_back(static_cast<char>(value));
+}
+
+// String literals, RFC 7541 5.2.
+bool DecodeString(const uint8_t** data,
+                  const uint8_t* end,
+                  std::string* out) {
+  if (*data == end)
+    return false;
+  const bool huffman = (**data & 0x80) != 0;
+  uint32_t length;
+  if (!DecodeInteger(data, end, 7, &length) ||
+      length > static_cast<size_t>(end - *data)) {
+    return false;
+  }
+  out->clear();
+  if (huffman) {
+    if (!HuffmanDecode(*data, length, out))
+      return false;
+  } else {
+    out->assign(reinterpret_cast<const char*>(*data), length);
+  }
+  *data += length;
+  return true;
+}
+
+void EncodeString(std::string* out, const std::string& value) {
+  const size_t huffman_length = HuffmanEncodedLength(value);
+  if (huffman_length < value.size()) {
+    EncodeInteger(out, 0x80, 7, huffman_length);
+    HuffmanEncode(value, out);
+  } else {
+    EncodeInteger(out, 0, 7, value.size());
+    out->append(value);
+  }
+}
+
+uint32_t ReadUint32(const uint8_t* data) {
+  return (static_cast<uint32_t>(data[0]) << 24) |
+         (static_cast<uint32_t>(data[1]) << 16) |
+         (static_cast<uint32_t>(data[2]) << 8) |
+         static_cast<uint32_t>(data[3]);
+}
+
+void AppendUint32(std::string* out, uint32_t value) {
+  out->push_back(static_cast<char>(value >> 24));
+  out->push_back(static_cast<char>(value >> 16));
+  out->push_back(static_cast<char>(value >> 8));
+  out->push_back(static_cast<char>(value));
+}
+
+size_t FrameLength(const uint8_t* header) {
+  return (static_cast<size_t>(header[0]) << 16) |
+         (static_cast<size_t>(header[1]) << 8) |
+         static_cast<size_t>(header[2]);
+}
+
+}  // anonymous namespace
+
+
+size_t HuffmanEncodedLength(const std::string& value) {
+  size_t bits = 0;
+  for (size_t i = 0; i < value.size(); i++)
+    bits += kHuffmanTable[static_cast<uint8_t>(value[i])].bits;
+  return (bits + 7) / 8;
+}
+
+
+void HuffmanEncode(const std::string& value, std::string* out) {
+  uint64_t pending = 0;
+  int pending_bits = 0;
+  for (size_t i = 0; i < value.size(); i++) {
+    const HuffmanCode& code = kHuffmanTable[static_cast<uint8_t>(value[i])];
+    pending = (pending << code.bits) | code.code;
+    pending_bits += code.bits;
+    while (pending_bits >= 8) {
+      pending_bits -= 8;
+      out->push_back(static_cast<char>(pending >> pending_bits));
+    }
+    pending &= (1u << pending_bits) - 1;
+  }
+  // Padded with the most significant bits of EOS, which are all ones.
+  if (pending_bits > 0) {
+    out->push_back(static_cast<char>((pending << (8 - pending_bits)) |
+                                     (0xff >> pending_bits)));
+  }
+}
+
+
+bool HuffmanDecode(const uint8_t* data, size_t length, std::string* out) {
+  const std::vector<HuffmanNode>& tree = HuffmanTree();
+  size_t node = 0;
+  int depth = 0;
+  bool all_ones = true;
+  for (size_t i = 0; i < length; i++) {
+    for (int bit = 7; bit >= 0; bit--) {
+      const int branch = (data[i] >> bit) & 1;
+      node = tree[node].children[branch];
+      depth++;
+      all_ones = all_ones && branch == 1;
+      const int symbol = tree[node].symbol;
+      if (symbol >= 0) {
+        if (symbol == kEos)
+          return false;
+        out->push_back(static_cast<char>(symbol));
+        node = 0;
+        depth = 0;
+        all_ones = true;
+      }
+    }
+  }
+  // What is left has to be a prefix of EOS shorter than a byte.
+  return depth < 8 && all_ones;
+}
+
+
+const Header* HeaderTable::Get(size_t index) const {
+  if (index == 0)
+    return nullptr;
+  if (index <= kStaticTableLength)
+    return &StaticHeaders()[index - 1];
+  index -= kStaticTableLength + 1;
+  if (index >= entries_.size())
+    return nullptr;
+  return &entries_[index];
+}
+
+
+void HeaderTable::Add(const Header& header) {
+  const size_t size = header.size();
+  // An entry larger than the table empties it and is not added.
+  if (size > max_size_) {
+    entries_.clear();
+    size_ = 0;
+    return;
+  }
+  Evict(max_size_ - size);
+  entries_.push_front(header);
+  size_ += size;
+}
+
+
+void HeaderTable::SetMaxSize(size_t max_size) {
+  max_size_ = max_size;
+  Evict(max_size);
+}
+
+
+void HeaderTable::Evict(size_t size) {
+  while (size_ > size) {
+    size_ -= entries_.back().size();
+    entries_.pop_back();
+  }
+}
+
+
+size_t HeaderTable::Find(const Header& header, bool* value_matches) const {
+  const std::vector<Header>& statics = StaticHeaders();
+  size_t name_index = 0;
+  for (size_t i = 0; i < statics.size(); i++) {
+    if (statics[i].name != header.name)
+      continue;
+    if (statics[i].value == header.value) {
+      *value_matches = true;
+      return i + 1;
+    }
+    if (name_index == 0)
+      name_index = i + 1;
+  }
+  for (size_t i = 0; i < entries_.size(); i++) {
+    if (entries_[i].name != header.name)
+      continue;
+    if (entries_[i].value == header.value) {
+      *value_matches = true;
+      return kStaticTableLength + i + 1;
+    }
+    if (name_index == 0)
+      name_index = kStaticTableLength + i + 1;
+  }
+  *value_matches = false;
+  return name_index;
+}
+
+
+bool HpackDecoder::Decode(const uint8_t* data,
+                          size_t length,
+                          size_t max_list_size,
+                          Headers* headers) {
+  const uint8_t* const end = data + length;
+  size_t list_size = 0;
+  while (data < end) {
+    const uint8_t byte = *data;
+    uint32_t index;
+    Header header;
+
+    if (byte & 0x80) {
+      // Indexed header field.
+      if (!DecodeInteger(&data, end, 7, &index))
+        return false;
+      const Header* entry = table_.Get(index);
+      if (entry == nullptr)
+        return false;
+      header = *entry;
+    } else if ((byte & 0xe0) == 0x20) {
+      // Dynamic table size update, which only may come before the headers.
+      if (!DecodeInteger(&data, end, 5, &index) ||
+          index > limit_ ||
+          !headers->empty()) {
+        return false;
+      }
+      table_.SetMaxSize(index);
+      continue;
+    } else {
+      // A literal, with incremental indexing (01), without indexing (0000)
+      // or never indexed (0001).
+      const bool indexing = (byte & 0x40) != 0;
+      if (!DecodeInteger(&data, end, indexing ? 6 : 4, &index))
+        return false;
+      if (index != 0) {
+        const Header* entry = table_.Get(index);
+        if (entry == nullptr)
+          return false;
+        header.name = entry->name;
+      } else if (!DecodeString(&data, end, &header.name)) {
+        return false;
+      }
+      if (!DecodeString(&data, end, &header.value))
+        return false;
+      if (indexing)
+        table_.Add(header);
+    }
+
+    list_size += header.size();
+    if (list_size > max_list_size)
+      return false;
+    headers->push_back(header);
+  }
+  return true;
+}
+
+
+void HpackEncoder::SetMaxTableSize(size_t size) {
+  // The peer allows this much, the encoder never uses more than the
+  // default.
+  size = std::min<size_t>(size, kDefaultHeaderTableSize);
+  if (size == table_.max_size())
+    return;
+  table_.SetMaxSize(size);
+  pending_size_update_ = true;
+}
+
+
+void HpackEncoder::Encode(const Headers& headers, std::string* out) {
+  if (pending_size_update_) {
+    EncodeInteger(out, 0x20, 5, table_.max_size());
+    pending_size_update_ = false;
+  }
+  for (size_t i = 0; i < headers.size(); i++) {
+    const Header& header = headers[i];
+    bool value_matches;
+    const size_t index = table_.Find(header, &value_matches);
+    if (index != 0 && value_matches) {
+      EncodeInteger(out, 0x80, 7, index);
+      continue;
+    }
+    // Large entries would flush the table for a single use.
+    const bool indexing = header.size() <= table_.max_size() / 2;
+    if (indexing)
+      EncodeInteger(out, 0x40, 6, index);
+    else
+      EncodeInteger(out, 0, 4, index);
+    if (index == 0)
+      EncodeString(out, header.name);
+    EncodeString(out, header.value);
+    if (indexing)
+      table_.Add(header);
+  }
+}
+
+
+Session::Session(Type type, Listener* listener, const Settings& settings)
+    : type_(type),
+      listener_(listener),
+      local_settings_(settings),
+      preface_state_(type == kServer ? kPrefaceExpected : kSettingsExpected),
+      failed_(false),
+      goaway_sent_(false),
+      goaway_received_(false),
+      next_stream_id_(type == kClient ? 1 : 2),
+      last_remote_stream_id_(0),
+      goaway_last_stream_id_(kMaxStreamId),
+      next_data_stream_id_(0),
+      send_window_(kDefaultWindowSize),
+      recv_window_(kConnectionWindowSize),
+      recv_unacked_(0),
+      header_stream_id_(0),
+      header_end_stream_(false) {
+  // Until the peer's SETTINGS arrives, the defaults of RFC 7540 apply.
+  remote_settings_.enable_push = true;
+  remote_settings_.max_concurrent_streams = 0xffffffff;
+  remote_settings_.max_header_list_size = 0xffffffff;
+  decoder_.set_limit(local_settings_.header_table_size);
+  SendPreface();
+}
+
+
+Session::~Session() {
+  for (std::map<uint32_t, Stream*>::iterator it = streams_.begin();
+       it != streams_.end();
+       ++it) {
+    delete it->second;
+  }
+}
+
+
+void Session::SendPreface() {
+  if (type_ == kClient)
+    output_.append(kClientMagic, kClientMagicLength);
+  SendSettings();
+  WriteWindowUpdate(0, kConnectionWindowSize - kDefaultWindowSize);
+}
+
+
+void Session::SendSettings() {
+  std::string payload;
+  struct {
+    uint16_t id;
+    uint32_t value;
+  } entries[] = {
+    { kSettingsHeaderTableSize, local_settings_.header_table_size },
+    { kSettingsEnablePush, 0 },
+    { kSettingsMaxConcurrentStreams, local_settings_.max_concurrent_streams },
+    { kSettingsInitialWindowSize, local_settings_.initial_window_size },
+    { kSettingsMaxFrameSize, local_settings_.max_frame_size },
+    { kSettingsMaxHeaderListSize, local_settings_.max_header_list_size }
+  };
+  for (size_t i = 0; i < sizeof(entries) / sizeof(entries[0]); i++) {
+    // Only a client announces that it does not want pushes.
+    if (entries[i].id == kSettingsEnablePush && type_ == kServer)
+      continue;
+    payload.push_back(static_cast<char>(entries[i].id >> 8));
+    payload.push_back(static_cast<char>(entries[i].id));
+    AppendUint32(&payload, entries[i].value);
+  }
+  WriteFrameHeader(&output_, payload.size(), kSettings, 0, 0);
+  output_.append(payload);
+}
+
+
+void Session::WriteFrameHeader(std::string* out,
+                               size_t length,
+                               uint8_t type,
+                               uint8_t flags,
+                               uint32_t id) {
+  out->push_back(static_cast<char>(length >> 16));
+  out->push_back(static_cast<char>(length >> 8));
+  out->push_back(static_cast<char>(length));
+  out->push_back(static_cast<char>(type));
+  out->push_back(static_cast<char>(flags));
+  AppendUint32(out, id & kMaxStreamId);
+}
+
+
+void Session::WriteHeaderBlock(uint32_t id,
+                               const Headers& headers,
+                               bool end_stream) {
+  std::string block;
+  encoder_.Encode(headers, &block);
+  const size_t max_length = remote_settings_.max_frame_size;
+  size_t offset = 0;
+  uint8_t type = kHeaders;
+  do {
+    const size_t length = std::min(block.size() - offset, max_length);
+    uint8_t flags = 0;
+    if (type == kHeaders && end_stream)
+      flags |= kFlagEndStream;
+    if (offset + length == block.size())
+      flags |= kFlagEndHeaders;
+    WriteFrameHeader(&output_, length, type, flags, id);
+    output_.append(block, offset, length);
+    offset += length;
+    type = kContinuation;
+  } while (offset < block.size());
+}
+
+
+void Session::WriteWindowUpdate(uint32_t id, uint32_t increment) {
+  WriteFrameHeader(&output_, 4, kWindowUpdate, 0, id);
+  AppendUint32(&output_, increment);
+}
+
+
+void Session::WriteRstStream(uint32_t id, uint32_t code) {
+  WriteFrameHeader(&output_, 4, kRstStream, 0, id);
+  AppendUint32(&output_, code);
+}
+
+
+bool Session::Receive(const uint8_t* data, size_t length) {
+  const uint8_t* const end = data + length;
+
+  if (preface_state_ == kPrefaceExpected) {
+    const size_t take = std::min(kClientMagicLength - input_.size(), length);
+    input_.append(reinterpret_cast<const char*>(data), take);
+    data += take;
+    if (memcmp(input_.data(), kClientMagic, input_.size()) != 0)
+      return Fail(HTTP2_PROTOCOL_ERROR);
+    if (input_.size() < kClientMagicLength)
+      return true;
+    input_.clear();
+    preface_state_ = kSettingsExpected;
+  }
+
+  while (!failed_) {
+    const uint8_t* frame;
+    std::string buffered;
+
+    if (input_.empty()) {
+      const size_t available = end - data;
+      if (available < kFrameHeaderLength ||
+          available < kFrameHeaderLength + FrameLength(data)) {
+        if (available >= kFrameHeaderLength &&
+            FrameLength(data) > local_settings_.max_frame_size) {
+          return Fail(HTTP2_FRAME_SIZE_ERROR);
+        }
+        input_.assign(reinterpret_cast<const char*>(data), available);
+        return true;
+      }
+      frame = data;
+    } else {
+      // Completes the frame that an earlier read left partial, first its
+      // header and then its payload.
+      for (int pass = 0; pass < 2; pass++) {
+        size_t wanted = kFrameHeaderLength;
+        if (input_.size() >= kFrameHeaderLength) {
+          const uint8_t* header =
+              reinterpret_cast<const uint8_t*>(input_.data());
+          if (FrameLength(header) > local_settings_.max_frame_size)
+            return Fail(HTTP2_FRAME_SIZE_ERROR);
+          wanted += FrameLength(header);
+        }
+        const size_t take = std::min<size_t>(
+            wanted - std::min(wanted, input_.size()), end - data);
+        input_.append(reinterpret_cast<const char*>(data), take);
+        data += take;
+      }
+      if (input_.size() < kFrameHeaderLength ||
+          input_.size() < kFrameHeaderLength +
+              FrameLength(reinterpret_cast<const uint8_t*>(input_.data()))) {
+        return true;
+      }
+      buffered.swap(input_);
+      frame = reinterpret_cast<const uint8_t*>(buffered.data());
+    }
+
+    const size_t frame_length = FrameLength(frame);
+    if (frame_length > local_settings_.max_frame_size)
+      return Fail(HTTP2_FRAME_SIZE_ERROR);
+    if (frame == data)
+      data += kFrameHeaderLength + frame_length;
+
+    const uint8_t type = frame[3];
+    const uint8_t flags = frame[4];
+    const uint32_t id = ReadUint32(frame + 5) & kMaxStreamId;
+
+    if (preface_state_ == kSettingsExpected) {
+      if (type != kSettings || (flags & kFlagAck))
+        return Fail(HTTP2_PROTOCOL_ERROR);
+      preface_state_ = kPrefaceDone;
+    }
+    // Nothing may come between the frames of a header block.
+    if (header_stream_id_ != 0 &&
+        (type != kContinuation || id != header_stream_id_)) {
+      return Fail(HTTP2_PROTOCOL_ERROR);
+    }
+    if (!ProcessFrame(type, flags, id, frame + kFrameHeaderLength,
+                      frame_length)) {
+      return false;
+    }
+  }
+  return false;
+}
+
+
+bool Session::ProcessFrame(uint8_t type,
+                           uint8_t flags,
+                           uint32_t id,
+                           const uint8_t* payload,
+                           size_t length) {
+  switch (type) {
+    case kData:
+      if (id == 0)
+        return Fail(HTTP2_PROTOCOL_ERROR);
+      return OnDataFrame(flags, id, payload, length);
+
+    case kHeaders:
+      if (id == 0)
+        return Fail(HTTP2_PROTOCOL_ERROR);
+      return OnHeadersFrame(flags, id, payload, length);
+
+    case kPriority:
+      // Priorities are not implemented, all streams get the same share.
+      if (id == 0)
+        return Fail(HTTP2_PROTOCOL_ERROR);
+      if (length != 5)
+        ResetStream(id, HTTP2_FRAME_SIZE_ERROR);
+      return true;
+
+    case kRstStream: {
+      if (id == 0)
+        return Fail(HTTP2_PROTOCOL_ERROR);
+      if (length != 4)
+        return Fail(HTTP2_FRAME_SIZE_ERROR);
+      Stream* stream = FindStream(id);
+      if (stream != nullptr) {
+        CloseStream(stream, ReadUint32(payload));
+      } else if (IsIdleId(id)) {
+        // A stream that was never opened.
+        return Fail(HTTP2_PROTOCOL_ERROR);
+      }
+      return true;
+    }
+
+    case kSettings:
+      if (id != 0)
+        return Fail(HTTP2_PROTOCOL_ERROR);
+      return OnSettingsFrame(flags, payload, length);
+
+    case kPushPromise:
+      // Push is disabled through our SETTINGS, and clients never push.
+      return Fail(HTTP2_PROTOCOL_ERROR);
+
+    case kPing:
+      if (id != 0)
+        return Fail(HTTP2_PROTOCOL_ERROR);
+      if (length != 8)
+        return Fail(HTTP2_FRAME_SIZE_ERROR);
+      if ((flags & kFlagAck) == 0) {
+        WriteFrameHeader(&output_, 8, kPing, kFlagAck, 0);
+        output_.append(reinterpret_cast<const char*>(payload), 8);
+      }
+      return true;
+
+    case kGoaway:
+      if (id != 0)
+        return Fail(HTTP2_PROTOCOL_ERROR);
+      return OnGoawayFrame(payload, length);
+
+    case kWindowUpdate:
+      if (length != 4)
+        return Fail(HTTP2_FRAME_SIZE_ERROR);
+      return OnWindowUpdateFrame(id, payload, length);
+
+    case kContinuation:
+      if (header_stream_id_ == 0)
+        return Fail(HTTP2_PROTOCOL_ERROR);
+      header_block_.append(reinterpret_cast<const char*>(payload), length);
+      // The compressed block is bounded too, not only the decoded list.
+      if (header_block_.size() > 2 * local_settings_.max_header_list_size)
+        return Fail(HTTP2_ENHANCE_YOUR_CALM);
+      if (flags & kFlagEndHeaders)
+        return OnHeaderBlock();
+      return true;
+
+    default:
+      // Unknown frame types are ignored, RFC 7540 4.1.
+      return true;
+  }
+}
+
+
+bool Session::Unpad(uint8_t flags, const uint8_t** payload, size_t* length) {
+  if ((flags & kFlagPadded) == 0)
+    return true;
+  if (*length == 0)
+    return false;
+  const size_t padding = **payload;
+  if (padding >= *length)
+    return false;
+  ++*payload;
+  *length -= padding + 1;
+  return true;
+}
+
+
+bool Session::OnHeadersFrame(uint8_t flags,
+                             uint32_t id,
+                             const uint8_t* payload,
+                             size_t length) {
+  if (!Unpad(flags, &payload, &length))
+    return Fail(HTTP2_PROTOCOL_ERROR);
+  if (flags & kFlagPriority) {
+    if (length < 5)
+      return Fail(HTTP2_FRAME_SIZE_ERROR);
+    payload += 5;
+    length -= 5;
+  }
+  header_stream_id_ = id;
+  header_end_stream_ = (flags & kFlagEndStream) != 0;
+  header_block_.assign(reinterpret_cast<const char*>(payload), length);
+  if (flags & kFlagEndHeaders)
+    return OnHeaderBlock();
+  return true;
+}
+
+
+bool Session::OnHeaderBlock() {
+  const uint32_t id = header_stream_id_;
+  const bool end_stream = header_end_stream_;
+  header_stream_id_ = 0;
+
+  // Even a block that is dropped has to go through the decoder, it may
+  // have changed the dynamic table.
+  Headers headers;
+  const bool decoded = decoder_.Decode(
+      reinterpret_cast<const uint8_t*>(header_block_.data()),
+      header_block_.size(),
+      local_settings_.max_header_list_size,
+      &headers);
+  header_block_.clear();
+  if (!decoded)
+    return Fail(HTTP2_COMPRESSION_ERROR);
+
+  Stream* stream = FindStream(id);
+  if (stream == nullptr) {
+    if (IsLocalId(id)) {
+      if (id >= next_stream_id_)
+        return Fail(HTTP2_PROTOCOL_ERROR);
+      // A stream that was reset in the meantime.
+      return true;
+    }
+    // Clients only see streams that they opened, servers would push.
+    if (type_ == kClient)
+      return Fail(HTTP2_PROTOCOL_ERROR);
+    if (id <= last_remote_stream_id_)
+      return Fail(HTTP2_STREAM_CLOSED);
+    last_remote_stream_id_ = id;
+    // Streams after our GOAWAY are not processed.
+    if (goaway_sent_)
+      return true;
+    if (streams_.size() >= local_settings_.max_concurrent_streams) {
+      WriteRstStream(id, HTTP2_REFUSED_STREAM);
+      return true;
+    }
+    stream = AddStream(id);
+  } else if (stream->remote_closed) {
+    ResetStream(id, HTTP2_STREAM_CLOSED);
+    return true;
+  } else if (type_ == kServer && stream->headers_received && !end_stream) {
+    // The only second block of a request is its trailers.
+    ResetStream(id, HTTP2_PROTOCOL_ERROR);
+    return true;
+  }
+  stream->headers_received = true;
+
+  // The listener may reset the stream or submit frames, so the stream is
+  // looked up again after each call.
+  listener_->OnHeaders(id, &headers, end_stream);
+  if (end_stream && (stream = FindStream(id)) != nullptr) {
+    stream->remote_closed = true;
+    listener_->OnStreamEnd(id);
+    if ((stream = FindStream(id)) != nullptr)
+      MaybeCloseStream(stream);
+  }
+  return true;
+}
+
+
+bool Session::OnDataFrame(uint8_t flags,
+                          uint32_t id,
+                          const uint8_t* payload,
+                          size_t length) {
+  // The whole frame counts against the windows, padding included.
+  const size_t frame_length = length;
+  if (static_cast<int64_t>(frame_length) > recv_window_)
+    return Fail(HTTP2_FLOW_CONTROL_ERROR);
+  recv_window_ -= frame_length;
+
+  Stream* stream = FindStream(id);
+  if (stream == nullptr ||
+      stream->remote_closed ||
+      !stream->headers_received) {
+    Consume(0, frame_length);
+    if (stream == nullptr) {
+      if (IsIdleId(id))
+        return Fail(HTTP2_PROTOCOL_ERROR);
+      return true;
+    }
+    ResetStream(id, stream->headers_received ? HTTP2_STREAM_CLOSED
+                                             : HTTP2_PROTOCOL_ERROR);
+    return true;
+  }
+
+  if (static_cast<int64_t>(frame_length) > stream->recv_window) {
+    Consume(0, frame_length);
+    ResetStream(id, HTTP2_FLOW_CONTROL_ERROR);
+    return true;
+  }
+  stream->recv_window -= frame_length;
+
+  if (!Unpad(flags, &payload, &length))
+    return Fail(HTTP2_PROTOCOL_ERROR);
+  // Nobody consumes the padding, so it is given back right away.
+  if (frame_length != length)
+    Consume(id, frame_length - length);
+
+  if (length > 0)
+    listener_->OnData(id, reinterpret_cast<const char*>(payload), length);
+  if ((flags & kFlagEndStream) && (stream = FindStream(id)) != nullptr) {
+    stream->remote_closed = true;
+    listener_->OnStreamEnd(id);
+    if ((stream = FindStream(id)) != nullptr)
+      MaybeCloseStream(stream);
+  }
+  return true;
+}
+
+
+bool Session::OnSettingsFrame(uint8_t flags,
+                              const uint8_t* payload,
+                              size_t length) {
+  if (flags & kFlagAck) {
+    if (length != 0)
+      return Fail(HTTP2_FRAME_SIZE_ERROR);
+    return true;
+  }
+  if (length % 6 != 0)
+    return Fail(HTTP2_FRAME_SIZE_ERROR);
+
+  for (size_t offset = 0; offset < length; offset += 6) {
+    const uint16_t id = (payload[offset] << 8) | payload[offset + 1];
+    const uint32_t value = ReadUint32(payload + offset + 2);
+    switch (id) {
+      case kSettingsHeaderTableSize:
+        remote_settings_.header_table_size = value;
+        encoder_.SetMaxTableSize(value);
+        break;
+      case kSettingsEnablePush:
+        if (value > 1)
+          return Fail(HTTP2_PROTOCOL_ERROR);
+        remote_settings_.enable_push = value == 1;
+        break;
+      case kSettingsMaxConcurrentStreams:
+        remote_settings_.max_concurrent_streams = value;
+        break;
+      case kSettingsInitialWindowSize: {
+        if (value > kMaxWindowSize)
+          return Fail(HTTP2_FLOW_CONTROL_ERROR);
+        // The change applies to the windows of the open streams as well.
+        const int64_t delta = static_cast<int64_t>(value) -
+                              remote_settings_.initial_window_size;
+        for (std::map<uint32_t, Stream*>::iterator it = streams_.begin();
+             it != streams_.end();
+             ++it) {
+          it->second->send_window += delta;
+          if (it->second->send_window > kMaxWindowSize)
+            return Fail(HTTP2_FLOW_CONTROL_ERROR);
+        }
+        remote_settings_.initial_window_size = value;
+        break;
+      }
+      case kSettingsMaxFrameSize:
+        if (value < kDefaultFrameSize || value > kMaxFrameSize)
+          return Fail(HTTP2_PROTOCOL_ERROR);
+        remote_settings_.max_frame_size = value;
+        break;
+      case kSettingsMaxHeaderListSize:
+        remote_settings_.max_header_list_size = value;
+        break;
+      default:
+        // Unknown settings are ignored, RFC 7540 6.5.2.
+        break;
+    }
+  }
+
+  WriteFrameHeader(&output_, 0, kSettings, kFlagAck, 0);
+  return true;
+}
+
+
+bool Session::OnWindowUpdateFrame(uint32_t id,
+                                  const uint8_t* payload,
+                                  size_t length) {
+  const uint32_t increment = ReadUint32(payload) & kMaxWindowSize;
+  if (id == 0) {
+    if (increment == 0)
+      return Fail(HTTP2_PROTOCOL_ERROR);
+    send_window_ += increment;
+    if (send_window_ > kMaxWindowSize)
+      return Fail(HTTP2_FLOW_CONTROL_ERROR);
+    return true;
+  }
+
+  Stream* stream = FindStream(id);
+  if (stream == nullptr) {
+    if (IsIdleId(id))
+      return Fail(HTTP2_PROTOCOL_ERROR);
+    return true;
+  }
+  if (increment == 0) {
+    ResetStream(id, HTTP2_PROTOCOL_ERROR);
+    return true;
+  }
+  stream->send_window += increment;
+  if (stream->send_window > kMaxWindowSize)
+    ResetStream(id, HTTP2_FLOW_CONTROL_ERROR);
+  return true;
+}
+
+
+bool Session::OnGoawayFrame(const uint8_t* payload, size_t length) {
+  if (length < 8)
+    return Fail(HTTP2_FRAME_SIZE_ERROR);
+  const uint32_t last_stream_id = ReadUint32(payload) & kMaxStreamId;
+  const uint32_t code = ReadUint32(payload + 4);
+  goaway_received_ = true;
+  goaway_last_stream_id_ = last_stream_id;
+  listener_->OnGoaway(code, last_stream_id);
+
+  // The peer did not and will not process our streams after the last one,
+  // they can be retried on another connection.
+  std::vector<uint32_t> refused;
+  for (std::map<uint32_t, Stream*>::iterator it = streams_.begin();
+       it != streams_.end();
+       ++it) {
+    if (IsLocalId(it->first) && it->first > last_stream_id)
+      refused.push_back(it->first);
+  }
+  for (size_t i = 0; i < refused.size(); i++) {
+    Stream* stream = FindStream(refused[i]);
+    if (stream != nullptr)
+      CloseStream(stream, HTTP2_REFUSED_STREAM);
+  }
+  return true;
+}
+
+
+bool Session::Fail(uint32_t code) {
+  if (failed_)
+    return false;
+  failed_ = true;
+  if (!goaway_sent_) {
+    WriteFrameHeader(&output_, 8, kGoaway, 0, 0);
+    AppendUint32(&output_, last_remote_stream_id_);
+    AppendUint32(&output_, code);
+    goaway_sent_ = true;
+  }
+  listener_->OnSessionError(code);
+  return false;
+}
+
+
+void Session::ResetStream(uint32_t id, uint32_t code) {
+  WriteRstStream(id, code);
+  Stream* stream = FindStream(id);
+  if (stream != nullptr)
+    CloseStream(stream, code);
+}
+
+
+Session::Stream* Session::FindStream(uint32_t id) {
+  std::map<uint32_t, Stream*>::iterator it = streams_.find(id);
+  return it == streams_.end() ? nullptr : it->second;
+}
+
+
+Session::Stream* Session::AddStream(uint32_t id) {
+  Stream* stream = new Stream(id,
+                              remote_settings_.initial_window_size,
+                              local_settings_.initial_window_size);
+  streams_[id] = stream;
+  return stream;
+}
+
+
+void Session::CloseStream(Stream* stream, uint32_t code) {
+  const uint32_t id = stream->id;
+  streams_.erase(id);
+  delete stream;
+  listener_->OnStreamClose(id, code);
+}
+
+
+void Session::MaybeCloseStream(Stream* stream) {
+  if (stream->local_closed && stream->remote_closed)
+    CloseStream(stream, HTTP2_NO_ERROR);
+}
+
+
+uint32_t Session::SubmitRequest(const Headers& headers, bool end_stream) {
+  if (type_ != kClient || failed_ || goaway_sent_ || goaway_received_)
+    return 0;
+  if (next_stream_id_ > kMaxStreamId ||
+      streams_.size() >= remote_settings_.max_concurrent_streams) {
+    return 0;
+  }
+  const uint32_t id = next_stream_id_;
+  next_stream_id_ += 2;
+  Stream* stream = AddStream(id);
+  WriteHeaderBlock(id, headers, end_stream);
+  stream->local_closed = end_stream;
+  return id;
+}
+
+
+bool Session::SubmitHeaders(uint32_t id,
+                            const Headers& headers,
+                            bool end_stream) {
+  Stream* stream = FindStream(id);
+  if (failed_ || stream == nullptr || stream->local_closed ||
+      stream->end_queued) {
+    return false;
+  }
+  // Trailers wait for the data before them.
+  if (stream->queued() > 0) {
+    if (!end_stream)
+      return false;
+    stream->trailers = headers;
+    stream->end_queued = true;
+    return true;
+  }
+  WriteHeaderBlock(id, headers, end_stream);
+  if (end_stream) {
+    stream->local_closed = true;
+    MaybeCloseStream(stream);
+  }
+  return true;
+}
+
+
+bool Session::SubmitData(uint32_t id,
+                         const char* data,
+                         size_t length,
+                         bool end_stream) {
+  Stream* stream = FindStream(id);
+  if (failed_ || stream == nullptr || stream->local_closed ||
+      stream->end_queued) {
+    return false;
+  }
+  stream->queue.append(data, length);
+  if (length > 0)
+    stream->draining = true;
+  stream->end_queued = end_stream;
+  return true;
+}
+
+
+void Session::SubmitRstStream(uint32_t id, uint32_t code) {
+  Stream* stream = FindStream(id);
+  if (stream == nullptr)
+    return;
+  WriteRstStream(id, code);
+  streams_.erase(id);
+  delete stream;
+}
+
+
+void Session::SubmitGoaway(uint32_t code) {
+  if (goaway_sent_)
+    return;
+  WriteFrameHeader(&output_, 8, kGoaway, 0, 0);
+  AppendUint32(&output_, last_remote_stream_id_);
+  AppendUint32(&output_, code);
+  goaway_sent_ = true;
+}
+
+
+void Session::SubmitPing(const uint8_t payload[8]) {
+  WriteFrameHeader(&output_, 8, kPing, 0, 0);
+  output_.append(reinterpret_cast<const char*>(payload), 8);
+}
+
+
+void Session::Consume(uint32_t id, size_t length) {
+  if (failed_)
+    return;
+  // WINDOW_UPDATEs go out once half a window has been consumed, not for
+  // every read.
+  recv_unacked_ += length;
+  if (recv_unacked_ >= kConnectionWindowSize / 2) {
+    WriteWindowUpdate(0, recv_unacked_);
+    recv_window_ += recv_unacked_;
+    recv_unacked_ = 0;
+  }
+  Stream* stream = id == 0 ? nullptr : FindStream(id);
+  if (stream == nullptr || stream->remote_closed)
+    return;
+  stream->unacked += length;
+  if (stream->unacked >= local_settings_.initial_window_size / 2) {
+    WriteWindowUpdate(id, stream->unacked);
+    stream->recv_window += stream->unacked;
+    stream->unacked = 0;
+  }
+}
+
+
+size_t Session::SerializeData(Stream* stream, size_t budget) {
+  const size_t queued = stream->queued();
+  if (queued == 0) {
+    if (!stream->end_queued || stream->local_closed)
+      return 0;
+    if (stream->trailers.empty()) {
+      WriteFrameHeader(&output_, 0, kData, kFlagEndStream, stream->id);
+    } else {
+      WriteHeaderBlock(stream->id, stream->trailers, true);
+      stream->trailers.clear();
+    }
+    stream->local_closed = true;
+    return 0;
+  }
+
+  int64_t length = std::min<int64_t>(queued, remote_settings_.max_frame_size);
+  length = std::min(length, stream->send_window);
+  length = std::min(length, send_window_);
+  if (budget <= kFrameHeaderLength)
+    return 0;
+  length = std::min<int64_t>(length, budget - kFrameHeaderLength);
+  if (length <= 0)
+    return 0;
+
+  const bool end_stream = stream->end_queued &&
+                          static_cast<size_t>(length) == queued &&
+                          stream->trailers.empty();
+  WriteFrameHeader(&output_, length, kData,
+                   end_stream ? kFlagEndStream : 0, stream->id);
+  output_.append(stream->queue, stream->queue_offset, length);
+  stream->queue_offset += length;
+  stream->send_window -= length;
+  send_window_ -= length;
+  if (end_stream)
+    stream->local_closed = true;
+
+  if (stream->queue_offset == stream->queue.size()) {
+    stream->queue.clear();
+    stream->queue_offset = 0;
+  } else if (stream->queue_offset >= stream->queue.size() / 2) {
+    stream->queue.erase(0, stream->queue_offset);
+    stream->queue_offset = 0;
+  }
+  return kFrameHeaderLength + length;
+}
+
+
+void Session::Serialize(std::string* out, size_t budget) {
+  // One DATA frame per stream and round, so that a large body does not
+  // hold back the others.
+  std::vector<uint32_t> drained;
+  std::vector<uint32_t> ended;
+  bool progress = true;
+  while (progress) {
+    progress = false;
+    std::map<uint32_t, Stream*>::iterator it =
+        streams_.upper_bound(next_data_stream_id_);
+    for (size_t i = 0; i < streams_.size(); i++, ++it) {
+      if (it == streams_.end())
+        it = streams_.begin();
+      Stream* stream = it->second;
+      const bool was_closed = stream->local_closed;
+      const size_t written = SerializeData(stream, budget);
+      budget -= written;
+      if (written > 0) {
+        progress = true;
+        next_data_stream_id_ = stream->id;
+      }
+      if (stream->draining && stream->queued() == 0) {
+        stream->draining = false;
+        drained.push_back(stream->id);
+      }
+      if (!was_closed && stream->local_closed)
+        ended.push_back(stream->id);
+    }
+  }
+
+  out->append(output_);
+  output_.clear();
+
+  for (size_t i = 0; i < drained.size(); i++) {
+    if (FindStream(drained[i]) != nullptr)
+      listener_->OnStreamDrain(drained[i]);
+  }
+  for (size_t i = 0; i < ended.size(); i++) {
+    Stream* stream = FindStream(ended[i]);
+    if (stream != nullptr)
+      MaybeCloseStream(stream);
+  }
+}
+
+
+bool Session::WantsWrite() const {
+  if (!output_.empty())
+    return true;
+  for (std::map<uint32_t, Stream*>::const_iterator it = streams_.begin();
+       it != streams_.end();
+       ++it) {
+    const Stream* stream = it->second;
+    if (stream->queued() > 0) {
+      if (stream->send_window > 0 && send_window_ > 0)
+        return true;
+    } else if (stream->end_queued && !stream->local_closed) {
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace http2
+}  // namespace node
@@ -0,0 +1,364 @@
+#ifndef SRC_NODE_HTTP2_CORE_H_
+#define SRC_NODE_HTTP2_CORE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <deque>
+#include <map>
+#include <string>
+#include <vector>
+
+// The HTTP/2 framing engine (RFC 7540) and HPACK (RFC 7541).  This part
+// knows nothing of V8 or libuv: the bytes that are read from the
+// connection go into Session::Receive(), the events come out through a
+// Session::Listener, and Session::Serialize() produces the bytes that have
+// to be written.  node_http2.cc hooks it up to a StreamBase.
+
+namespace node {
+namespace http2 {
+
+enum FrameType {
+  kData = 0x0,
+  kHeaders = 0x1,
+  kPriority = 0x2,
+  kRstStream = 0x3,
+  kSettings = 0x4,
+  kPushPromise = 0x5,
+  kPing = 0x6,
+  kGoaway = 0x7,
+  kWindowUpdate = 0x8,
+  kContinuation = 0x9
+};
+
+enum FrameFlags {
+  kFlagEndStream = 0x1,
+  kFlagAck = 0x1,
+  kFlagEndHeaders = 0x4,
+  kFlagPadded = 0x8,
+  kFlagPriority = 0x20
+};
+
+#define HTTP2_ERROR_CODES(V)                                                  \
+  V(NO_ERROR, 0x0)                                                            \
+  V(PROTOCOL_ERROR, 0x1)                                                      \
+  V(INTERNAL_ERROR, 0x2)                                                      \
+  V(FLOW_CONTROL_ERROR, 0x3)                                                  \
+  V(SETTINGS_TIMEOUT, 0x4)                                                    \
+  V(STREAM_CLOSED, 0x5)                                                       \
+  V(FRAME_SIZE_ERROR, 0x6)                                                    \
+  V(REFUSED_STREAM, 0x7)                                                      \
+  V(CANCEL, 0x8)                                                              \
+  V(COMPRESSION_ERROR, 0x9)                                                   \
+  V(CONNECT_ERROR, 0xa)                                                       \
+  V(ENHANCE_YOUR_CALM, 0xb)                                                   \
+  V(INADEQUATE_SECURITY, 0xc)                                                 \
+  V(HTTP_1_1_REQUIRED, 0xd)
+
+enum ErrorCode {
+#define V(name, value) HTTP2_ ## name = value,
+  HTTP2_ERROR_CODES(V)
+#undef V
+};
+
+enum SettingsId {
+  kSettingsHeaderTableSize = 0x1,
+  kSettingsEnablePush = 0x2,
+  kSettingsMaxConcurrentStreams = 0x3,
+  kSettingsInitialWindowSize = 0x4,
+  kSettingsMaxFrameSize = 0x5,
+  kSettingsMaxHeaderListSize = 0x6
+};
+
+static const size_t kFrameHeaderLength = 9;
+static const uint32_t kDefaultWindowSize = 65535;
+static const uint32_t kMaxWindowSize = 0x7fffffff;
+static const uint32_t kDefaultFrameSize = 16384;
+static const uint32_t kMaxFrameSize = 0xffffff;
+static const uint32_t kDefaultHeaderTableSize = 4096;
+
+// The settings that one side announces, the defaults of RFC 7540 6.5.2
+// except for push, which this engine does not implement.
+struct Settings {
+  Settings() : header_table_size(kDefaultHeaderTableSize),
+               enable_push(false),
+               max_concurrent_streams(100),
+               initial_window_size(kDefaultWindowSize),
+               max_frame_size(kDefaultFrameSize),
+               max_header_list_size(64 * 1024) {}
+
+  uint32_t header_table_size;
+  bool enable_push;
+  uint32_t max_concurrent_streams;
+  uint32_t initial_window_size;
+  uint32_t max_frame_size;
+  uint32_t max_header_list_size;
+};
+
+struct Header {
+  Header() {}
+  Header(const std::string& name, const std::string& value)
+      : name(name), value(value) {}
+
+  // The size that counts against the limits of a header table.
+  size_t size() const { return name.size() + value.size() + 32; }
+
+  std::string name;
+  std::string value;
+};
+
+typedef std::vector<Header> Headers;
+
+
+// The dynamic table that both the encoder and the decoder keep, newest
+// entry first.
+class HeaderTable {
+ public:
+  HeaderTable() : size_(0), max_size_(kDefaultHeaderTableSize) {}
+
+  // `index` counts from 1, the static table comes first.
+  const Header* Get(size_t index) const;
+  void Add(const Header& header);
+  void SetMaxSize(size_t max_size);
+  // The index of an entry with the same name and value, or with the same
+  // name only, 0 if there is none.
+  size_t Find(const Header& header, bool* value_matches) const;
+
+  size_t max_size() const { return max_size_; }
+
+ private:
+  void Evict(size_t size);
+
+  std::deque<Header> entries_;
+  size_t size_;
+  size_t max_size_;
+};
+
+
+class HpackDecoder {
+ public:
+  HpackDecoder() : limit_(kDefaultHeaderTableSize) {}
+
+  // The table size that the peer may use at most, announced through our
+  // SETTINGS_HEADER_TABLE_SIZE.
+  void set_limit(size_t limit) { limit_ = limit; }
+
+  // Decodes a complete header block.  Returns false if it is malformed, or
+  // if its headers add up to more than max_list_size.
+  bool Decode(const uint8_t* data,
+              size_t length,
+              size_t max_list_size,
+              Headers* headers);
+
+ private:
+  HeaderTable table_;
+  size_t limit_;
+};
+
+
+class HpackEncoder {
+ public:
+  HpackEncoder() : pending_size_update_(false) {}
+
+  // The peer's SETTINGS_HEADER_TABLE_SIZE.  The change is announced at the
+  // start of the next header block.
+  void SetMaxTableSize(size_t size);
+
+  void Encode(const Headers& headers, std::string* out);
+
+ private:
+  HeaderTable table_;
+  bool pending_size_update_;
+};
+
+
+// The Huffman code of RFC 7541 Appendix B.  HpackEncoder uses a string's
+// Huffman form only where it is the shorter one.
+size_t HuffmanEncodedLength(const std::string& value);
+void HuffmanEncode(const std::string& value, std::string* out);
+bool HuffmanDecode(const uint8_t* data, size_t length, std::string* out);
+
+
+class Session {
+ public:
+  enum Type {
+    kServer,
+    kClient
+  };
+
+  class Listener {
+   public:
+    virtual ~Listener() {}
+
+    // The request or response headers, informational (1xx) responses or
+    // trailers, all in the order in which they arrive.
+    virtual void OnHeaders(uint32_t id, Headers* headers, bool end_stream) = 0;
+    virtual void OnData(uint32_t id, const char* data, size_t length) = 0;
+    // The peer has ended its side of the stream.
+    virtual void OnStreamEnd(uint32_t id) = 0;
+    // The stream is gone, when both sides ended it, when the peer reset it
+    // or when a GOAWAY left it unprocessed.  Not called for the streams
+    // that SubmitRstStream() resets.
+    virtual void OnStreamClose(uint32_t id, uint32_t code) = 0;
+    // All data that was submitted for the stream has been written out.
+    virtual void OnStreamDrain(uint32_t id) = 0;
+    virtual void OnGoaway(uint32_t code, uint32_t last_stream_id) = 0;
+    // A connection error.  A GOAWAY with `code` is queued and the session
+    // takes no more input.
+    virtual void OnSessionError(uint32_t code) = 0;
+  };
+
+  Session(Type type, Listener* listener, const Settings& settings);
+  ~Session();
+
+  // Feeds bytes that were read from the connection.  Returns false after a
+  // connection error.
+  bool Receive(const uint8_t* data, size_t length);
+
+  // Starts a stream from the client.  Returns its id, or 0 when no more
+  // streams can be opened.
+  uint32_t SubmitRequest(const Headers& headers, bool end_stream);
+  // Sends response headers, or trailers when data has been submitted, which
+  // then end the stream.  Returns false for a stream that cannot send.
+  bool SubmitHeaders(uint32_t id, const Headers& headers, bool end_stream);
+  // Queues data, which goes out within the flow control windows.
+  bool SubmitData(uint32_t id,
+                  const char* data,
+                  size_t length,
+                  bool end_stream);
+  void SubmitRstStream(uint32_t id, uint32_t code);
+  void SubmitGoaway(uint32_t code);
+  void SubmitPing(const uint8_t payload[8]);
+  // Tells the session that the application is done with `length` bytes of
+  // data of the stream, which opens the flow control windows again.
+  void Consume(uint32_t id, size_t length);
+
+  // Moves the frames that are ready to `out`.  DATA frames are added up to
+  // `budget` bytes, which is how the caller applies backpressure.
+  void Serialize(std::string* out, size_t budget);
+  // Whether Serialize() would produce anything with an unlimited budget.
+  bool WantsWrite() const;
+
+  bool IsStreamOpen(uint32_t id) const { return streams_.count(id) != 0; }
+  size_t stream_count() const { return streams_.size(); }
+  bool goaway_sent() const { return goaway_sent_; }
+  bool goaway_received() const { return goaway_received_; }
+  const Settings& remote_settings() const { return remote_settings_; }
+
+ private:
+  struct Stream {
+    Stream(uint32_t id, uint32_t send_window, uint32_t recv_window)
+        : id(id),
+          local_closed(false),
+          remote_closed(false),
+          headers_received(false),
+          end_queued(false),
+          send_window(send_window),
+          recv_window(recv_window),
+          unacked(0),
+          queue_offset(0),
+          draining(false) {}
+
+    size_t queued() const { return queue.size() - queue_offset; }
+
+    const uint32_t id;
+    bool local_closed;
+    bool remote_closed;
+    bool headers_received;
+    bool end_queued;      // END_STREAM goes out after the queued data.
+    int64_t send_window;
+    int64_t recv_window;
+    size_t unacked;       // Consumed bytes without a WINDOW_UPDATE yet.
+    std::string queue;
+    size_t queue_offset;
+    bool draining;        // Data went into the queue since the last drain.
+    Headers trailers;
+  };
+
+  enum PrefaceState {
+    kPrefaceExpected,     // The server waits for the client's magic.
+    kSettingsExpected,    // The first frame has to be a SETTINGS frame.
+    kPrefaceDone
+  };
+
+  void SendPreface();
+  void SendSettings();
+  void WriteFrameHeader(std::string* out,
+                        size_t length,
+                        uint8_t type,
+                        uint8_t flags,
+                        uint32_t id);
+  void WriteHeaderBlock(uint32_t id, const Headers& headers, bool end_stream);
+  void WriteWindowUpdate(uint32_t id, uint32_t increment);
+  void WriteRstStream(uint32_t id, uint32_t code);
+
+  bool ProcessFrame(uint8_t type,
+                    uint8_t flags,
+                    uint32_t id,
+                    const uint8_t* payload,
+                    size_t length);
+  bool OnHeadersFrame(uint8_t flags,
+                      uint32_t id,
+                      const uint8_t* payload,
+                      size_t length);
+  bool OnHeaderBlock();
+  bool OnDataFrame(uint8_t flags,
+                   uint32_t id,
+                   const uint8_t* payload,
+                   size_t length);
+  bool OnSettingsFrame(uint8_t flags, const uint8_t* payload, size_t length);
+  bool OnWindowUpdateFrame(uint32_t id, const uint8_t* payload, size_t length);
+  bool OnGoawayFrame(const uint8_t* payload, size_t length);
+
+  // Removes padding from the payload of DATA and HEADERS frames.
+  bool Unpad(uint8_t flags, const uint8_t** payload, size_t* length);
+  // A connection error, see Listener::OnSessionError().
+  bool Fail(uint32_t code);
+  // A stream error: the stream is reset and the listener told about it.
+  void ResetStream(uint32_t id, uint32_t code);
+
+  Stream* FindStream(uint32_t id);
+  Stream* AddStream(uint32_t id);
+  void CloseStream(Stream* stream, uint32_t code);
+  void MaybeCloseStream(Stream* stream);
+  bool IsLocalId(uint32_t id) const { return (id & 1) == (type_ == kClient); }
+  // A stream that neither side has opened yet.
+  bool IsIdleId(uint32_t id) const {
+    return IsLocalId(id) ? id >= next_stream_id_ : id > last_remote_stream_id_;
+  }
+  size_t SerializeData(Stream* stream, size_t budget);
+
+  const Type type_;
+  Listener* const listener_;
+  const Settings local_settings_;
+  Settings remote_settings_;
+  HpackEncoder encoder_;
+  HpackDecoder decoder_;
+
+  PrefaceState preface_state_;
+  std::string input_;       // A partial frame or the partial preface.
+  std::string output_;      // Frames other than DATA that are ready.
+  bool failed_;
+  bool goaway_sent_;
+  bool goaway_received_;
+
+  std::map<uint32_t, Stream*> streams_;
+  uint32_t next_stream_id_;        // Of the next local stream.
+  uint32_t last_remote_stream_id_;
+  uint32_t goaway_last_stream_id_;  // The last local stream of a GOAWAY.
+  uint32_t next_data_stream_id_;   // Where the round robin goes on.
+
+  int64_t send_window_;      // The connection's flow control windows.
+  int64_t recv_window_;
+  size_t recv_unacked_;
+
+  // The header block that HEADERS and CONTINUATION frames put together.
+  uint32_t header_stream_id_;   // 0 if no block is open.
+  bool header_end_stream_;
+  std::string header_block_;
+};
+
+}  // namespace http2
+}  // namespace node
+
+#endif  // SRC_NODE_HTTP2_CORE_H_
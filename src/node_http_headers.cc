@@ -0,0 +1,488 @@
+#include "node.h"
+#include "node_buffer.h"
+#include "node_internals.h"
+
+#include "env.h"
+#include "env-inl.h"
+#include "util.h"
+#include "util-inl.h"
+#include "v8.h"
+
+#include <stdio.h>  // snprintf()
+#include <stdlib.h>  // malloc(), free()
+#include <string.h>  // memcpy()
+#include <time.h>  // time()
+
+#include <string>
+#include <vector>
+
+// Serializes the header block of outgoing HTTP messages.  This used to be
+// done in OutgoingMessage.prototype._storeHeader with string concatenation
+// and one validation regex per header.  Here the header names and values are
+// validated while they are copied into a single Buffer, which can then be
+// written to the socket together with the first body chunk.
+
+namespace node {
+namespace http_headers {
+
+using v8::Array;
+using v8::Context;
+using v8::FunctionCallbackInfo;
+using v8::Integer;
+using v8::Local;
+using v8::Object;
+using v8::String;
+using v8::Uint32Array;
+using v8::Value;
+
+// Bits of the state that is passed in and out of storeHeader().  This list
+// needs to be kept in sync with OutgoingMessage.prototype._storeHeader in
+// lib/_http_outgoing.js.
+#define STORE_HEADER_FLAGS(V)                                                 \
+  V(kSendDate, 1 << 0)                                                        \
+  V(kShouldKeepAlive, 1 << 1)                                                 \
+  V(kUseChunkedEncodingByDefault, 1 << 2)                                     \
+  V(kHasAgent, 1 << 3)                                                        \
+  V(kRemovedConnection, 1 << 4)                                               \
+  V(kRemovedContentLength, 1 << 5)                                            \
+  V(kRemovedTransferEncoding, 1 << 6)                                         \
+  V(kHasBody, 1 << 7)                                                         \
+  V(kChunkedEncoding, 1 << 8)                                                 \
+  V(kLast, 1 << 9)                                                            \
+  V(kSentExpect, 1 << 10)                                                     \
+
+enum StoreHeaderFlags {
+#define V(name, value) name = value,
+  STORE_HEADER_FLAGS(V)
+#undef V
+};
+
+// Room for the headers that are added automatically; the longest variant is
+// "Content-Length: <number>\r\n" followed by "Connection: keep-alive\r\n".
+static const size_t kAutomaticHeadersSize = 128;
+
+
+// Tokens as defined in RFC 7230, section 3.2.6.
+static inline bool IsTokenChar(unsigned char c) {
+  if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+      (c >= '0' && c <= '9')) {
+    return true;
+  }
+  switch (c) {
+    case '!': case '#': case '$': case '%': case '&': case '\'':
+    case '*': case '+': case '-': case '.': case '^': case '_':
+    case '`': case '|': case '~':
+      return true;
+    default:
+      return false;
+  }
+}
+
+
+//  field-value    = *( field-content / obs-fold )
+//  field-content  = field-vchar [ 1*( SP / HTAB ) field-vchar ]
+//  field-vchar    = VCHAR / obs-text
+static inline bool IsInvalidHeaderChar(unsigned char c) {
+  return c != '\t' && (c <= 31 || c == 127);
+}
+
+
+static inline bool EqualsNoCase(const char* a, size_t n, const char* b) {
+  for (size_t i = 0; i < n; i++) {
+    if (b[i] == '\0' || ToLower(a[i]) != b[i])
+      return false;
+  }
+  return b[n] == '\0';
+}
+
+
+static inline bool ContainsNoCase(const char* a, size_t n, const char* b) {
+  const size_t m = strlen(b);
+  for (size_t i = 0; i + m <= n; i++) {
+    size_t j = 0;
+    while (j < m && ToLower(a[i + j]) == b[j])
+      j++;
+    if (j == m)
+      return true;
+  }
+  return false;
+}
+
+
+// Returns the current time in the IMF-fixdate format of RFC 7231, which is
+// what Date.prototype.toUTCString() produces as well.  The value is cached
+// per environment and only reformatted when the second changes, so this is
+// a time() call and a comparison per response.
+static const char* CurrentDate(Environment* env) {
+  static const char days[][4] = {
+    "Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat"
+  };
+  static const char months[][4] = {
+    "Jan", "Feb", "Mar", "Apr", "May", "Jun",
+    "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"
+  };
+
+  Environment::HttpDate* date = env->http_date();
+  const int64_t now = static_cast<int64_t>(time(nullptr));
+  if (now == date->second)
+    return date->value;
+
+  // Civil date from days since the epoch, see
+  // http://howardhinnant.github.io/date_algorithms.html#civil_from_days
+  const int64_t days_since_epoch = now / 86400;
+  const int64_t seconds = now % 86400;
+  const int64_t z = days_since_epoch + 719468;
+  const int64_t era = z / 146097;
+  const int64_t doe = z - era * 146097;
+  const int64_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+  const int64_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+  const int64_t mp = (5 * doy + 2) / 153;
+  const int day = static_cast<int>(doy - (153 * mp + 2) / 5 + 1);
+  const int month = static_cast<int>(mp < 10 ? mp + 2 : mp - 10);
+  const int year = static_cast<int>(yoe + era * 400 + (month <= 1));
+
+  snprintf(date->value,
+           sizeof(date->value),
+           "%s, %02d %s %04d %02d:%02d:%02d GMT",
+           days[(days_since_epoch + 4) % 7],
+           day,
+           months[month],
+           year,
+           static_cast<int>(seconds / 3600),
+           static_cast<int>(seconds / 60 % 60),
+           static_cast<int>(seconds % 60));
+  date->second = now;
+
+  return date->value;
+}
+
+
+class HeaderWriter {
+ public:
+  explicit HeaderWriter(size_t capacity)
+      : data_(static_cast<char*>(malloc(capacity))),
+        capacity_(capacity),
+        length_(0) {
+    CHECK_NE(data_, nullptr);
+  }
+
+  ~HeaderWriter() {
+    free(data_);
+  }
+
+  inline char* Append(Local<String> string) {
+    char* start = data_ + length_;
+    const int n = string->Length();
+    CHECK_LE(length_ + n, capacity_);
+    string->WriteOneByte(reinterpret_cast<uint8_t*>(start),
+                         0,
+                         n,
+                         String::NO_NULL_TERMINATION);
+    length_ += n;
+    return start;
+  }
+
+  inline void Append(const char* string, size_t n) {
+    CHECK_LE(length_ + n, capacity_);
+    memcpy(data_ + length_, string, n);
+    length_ += n;
+  }
+
+  template <size_t N>
+  inline void Append(const char (&string)[N]) {
+    Append(string, N - 1);
+  }
+
+  // Transfers ownership of the serialized data to a new Buffer.
+  Local<Object> ToBuffer(Environment* env) {
+    Local<Object> buffer =
+        Buffer::New(env, data_, length_).ToLocalChecked();
+    data_ = nullptr;
+    return buffer;
+  }
+
+ private:
+  char* data_;
+  size_t capacity_;
+  size_t length_;
+
+  DISALLOW_COPY_AND_ASSIGN(HeaderWriter);
+};
+
+
+static void ThrowInvalidToken(Environment* env, Local<Value> field) {
+  node::Utf8Value name(env->isolate(), field);
+  std::string message("Header name must be a valid HTTP Token [\"");
+  message += *name;
+  message += "\"]";
+  env->ThrowTypeError(message.c_str());
+}
+
+
+// Adds `value` or, when it is an array, each of its elements as a value for
+// header `field`.  Returns false if an exception is pending.
+static bool CollectHeader(Environment* env,
+                          Local<Value> field,
+                          Local<Value> value,
+                          std::vector<Local<String> >* strings,
+                          size_t* size) {
+  if (!field->IsString() || field.As<String>()->Length() == 0 ||
+      !field.As<String>()->ContainsOnlyOneByte()) {
+    ThrowInvalidToken(env, field);
+    return false;
+  }
+
+  Local<Context> context = env->context();
+  Local<Array> values;
+  uint32_t count = 1;
+  if (value->IsArray()) {
+    values = value.As<Array>();
+    count = values->Length();
+  }
+
+  for (uint32_t i = 0; i < count; i++) {
+    Local<Value> v = value;
+    if (!values.IsEmpty() && !values->Get(context, i).ToLocal(&v))
+      return false;
+
+    Local<String> string;
+    if (!v->ToString(context).ToLocal(&string))
+      return false;
+
+    if (!string->ContainsOnlyOneByte()) {
+      env->ThrowTypeError("The header content contains invalid characters");
+      return false;
+    }
+
+    strings->push_back(field.As<String>());
+    strings->push_back(string);
+    // "field: value\r\n"
+    *size += field.As<String>()->Length() + string->Length() + 4;
+  }
+
+  return true;
+}
+
+
+// var header = storeHeader(firstLine, headers, state, contentLength,
+//                          statusCode);
+//
+// `headers` is an object or an array of [field, value] pairs.  `state` is a
+// Uint32Array whose first element holds the StoreHeaderFlags; it is updated
+// to reflect the headers that were serialized.
+static void StoreHeader(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  Local<Context> context = env->context();
+
+  CHECK(args[0]->IsString());
+  CHECK(args[2]->IsUint32Array());
+
+  Local<String> first_line = args[0].As<String>();
+  Local<Uint32Array> state_array = args[2].As<Uint32Array>();
+  CHECK_GE(state_array->Length(), 1);
+  uint32_t* state = reinterpret_cast<uint32_t*>(
+      static_cast<char*>(state_array->Buffer()->GetContents().Data()) +
+      state_array->ByteOffset());
+  uint32_t flags = state[0];
+
+  std::vector<Local<String> > strings;
+  size_t size = first_line->Length() + kAutomaticHeadersSize;
+
+  if (args[1]->IsObject()) {
+    Local<Object> headers = args[1].As<Object>();
+    if (headers->IsArray()) {
+      Local<Array> list = headers.As<Array>();
+      const uint32_t length = list->Length();
+      strings.reserve(length * 2);
+      for (uint32_t i = 0; i < length; i++) {
+        Local<Value> entry;
+        if (!list->Get(context, i).ToLocal(&entry))
+          return;
+        Local<Object> pair;
+        Local<Value> field;
+        Local<Value> value;
+        if (!entry->ToObject(context).ToLocal(&pair) ||
+            !pair->Get(context, 0).ToLocal(&field) ||
+            !pair->Get(context, 1).ToLocal(&value) ||
+            !CollectHeader(env, field, value, &strings, &size)) {
+          return;
+        }
+      }
+    } else {
+      Local<Array> keys;
+      if (!headers->GetOwnPropertyNames(context).ToLocal(&keys))
+        return;
+      const uint32_t length = keys->Length();
+      strings.reserve(length * 2);
+      for (uint32_t i = 0; i < length; i++) {
+        Local<Value> field;
+        Local<Value> value;
+        if (!keys->Get(context, i).ToLocal(&field) ||
+            !headers->Get(context, field).ToLocal(&value)) {
+          return;
+        }
+        // Numeric keys are reported as numbers, Object.keys() turns them
+        // into strings.
+        if (field->IsNumber() && !field->ToString(context).ToLocal(&field))
+          return;
+        if (!CollectHeader(env, field, value, &strings, &size))
+          return;
+      }
+    }
+  }
+
+  const char* date = nullptr;
+  if (flags & kSendDate) {
+    date = CurrentDate(env);
+    size += sizeof(env->http_date()->value);
+  }
+
+  Local<String> content_length;
+  if (args[3]->IsNumber() &&
+      !args[3]->ToString(context).ToLocal(&content_length)) {
+    return;
+  }
+
+  HeaderWriter writer(size);
+  writer.Append(first_line);
+
+  bool sent_connection_header = false;
+  bool sent_content_length_header = false;
+  bool sent_transfer_encoding_header = false;
+  bool sent_date_header = false;
+  bool sent_trailer = false;
+
+  for (size_t i = 0; i < strings.size(); i += 2) {
+    const size_t field_length = strings[i]->Length();
+    const char* field = writer.Append(strings[i]);
+    for (size_t j = 0; j < field_length; j++) {
+      if (!IsTokenChar(field[j]))
+        return ThrowInvalidToken(env, strings[i]);
+    }
+
+    writer.Append(": ");
+
+    const size_t value_length = strings[i + 1]->Length();
+    const char* value = writer.Append(strings[i + 1]);
+    for (size_t j = 0; j < value_length; j++) {
+      if (IsInvalidHeaderChar(value[j])) {
+        return env->ThrowTypeError(
+            "The header content contains invalid characters");
+      }
+    }
+
+    writer.Append("\r\n");
+
+    if (EqualsNoCase(field, field_length, "connection")) {
+      sent_connection_header = true;
+      if (ContainsNoCase(value, value_length, "close"))
+        flags |= kLast;
+      else
+        flags |= kShouldKeepAlive;
+    } else if (EqualsNoCase(field, field_length, "transfer-encoding")) {
+      sent_transfer_encoding_header = true;
+      if (ContainsNoCase(value, value_length, "chunk"))
+        flags |= kChunkedEncoding;
+    } else if (EqualsNoCase(field, field_length, "content-length")) {
+      sent_content_length_header = true;
+    } else if (EqualsNoCase(field, field_length, "date")) {
+      sent_date_header = true;
+    } else if (EqualsNoCase(field, field_length, "expect")) {
+      flags |= kSentExpect;
+    } else if (EqualsNoCase(field, field_length, "trailer")) {
+      sent_trailer = true;
+    }
+  }
+
+  if (date != nullptr && !sent_date_header) {
+    writer.Append("Date: ");
+    writer.Append(date, strlen(date));
+    writer.Append("\r\n");
+  }
+
+  // Force the connection to close when the response is a 204 No Content or
+  // a 304 Not Modified and the user has set a "Transfer-Encoding: chunked"
+  // header.
+  //
+  // RFC 2616 mandates that 204 and 304 responses MUST NOT have a body but
+  // node.js used to send out a zero chunk anyway to accommodate clients
+  // that don't have special handling for those responses.
+  //
+  // It was pointed out that this might confuse reverse proxies to the point
+  // of creating security liabilities, so suppress the zero chunk and force
+  // the connection to close.
+  const int32_t status_code = args[4]->Int32Value(context).FromMaybe(0);
+  if ((status_code == 204 || status_code == 304) &&
+      (flags & kChunkedEncoding)) {
+    flags &= ~(kChunkedEncoding | kShouldKeepAlive);
+  }
+
+  // keep-alive logic
+  if (flags & kRemovedConnection) {
+    flags |= kLast;
+    flags &= ~kShouldKeepAlive;
+  } else if (!sent_connection_header) {
+    const bool should_send_keep_alive = (flags & kShouldKeepAlive) &&
+        (sent_content_length_header ||
+         (flags & kUseChunkedEncodingByDefault) ||
+         (flags & kHasAgent));
+    if (should_send_keep_alive) {
+      writer.Append("Connection: keep-alive\r\n");
+    } else {
+      flags |= kLast;
+      writer.Append("Connection: close\r\n");
+    }
+  }
+
+  if (!sent_content_length_header && !sent_transfer_encoding_header) {
+    if (!(flags & kHasBody)) {
+      // Make sure we don't end the 0\r\n\r\n at the end of the message.
+      flags &= ~kChunkedEncoding;
+    } else if (!(flags & kUseChunkedEncodingByDefault)) {
+      flags |= kLast;
+    } else if (!sent_trailer && !(flags & kRemovedContentLength) &&
+               !content_length.IsEmpty()) {
+      writer.Append("Content-Length: ");
+      writer.Append(content_length);
+      writer.Append("\r\n");
+    } else if (!(flags & kRemovedTransferEncoding)) {
+      writer.Append("Transfer-Encoding: chunked\r\n");
+      flags |= kChunkedEncoding;
+    }
+    // Else both Content-Length and Transfer-Encoding were removed by the
+    // user, see test/parallel/test-http-remove-header-stays-removed.js.
+  }
+
+  writer.Append("\r\n");
+
+  state[0] = flags;
+  args.GetReturnValue().Set(writer.ToBuffer(env));
+}
+
+
+// Exposes the cached Date header value, mostly for testing.
+static void UTCDate(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  args.GetReturnValue().Set(OneByteString(env->isolate(), CurrentDate(env)));
+}
+
+
+void Initialize(Local<Object> target,
+                Local<Value> unused,
+                Local<Context> context) {
+  Environment* env = Environment::GetCurrent(context);
+
+  env->SetMethod(target, "storeHeader", StoreHeader);
+  env->SetMethod(target, "utcDate", UTCDate);
+
+#define V(name, value)                                                        \
+  target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), #name),                   \
+              Integer::NewFromUnsigned(env->isolate(), name));
+  STORE_HEADER_FLAGS(V)
+#undef V
+}
+
+}  // namespace http_headers
+}  // namespace node
+
+NODE_MODULE_CONTEXT_AWARE_BUILTIN(http_headers, node::http_headers::Initialize)
@@ -1,19 +1,22 @@
 #include "node.h"
 #include "node_buffer.h"
 #include "node_http_parser.h"
+#include "node_trace.h"
 
 #include "async-wrap.h"
 #include "async-wrap-inl.h"
 #include "env.h"
 #include "env-inl.h"
+#include "slab_allocator.h"
 #include "stream_base.h"
 #include "stream_base-inl.h"
+#include "timer_wrap.h"
 #include "util.h"
 #include "util-inl.h"
 #include "v8.h"
 
 #include <stdlib.h>  // free()
-#include <string.h>  // strdup()
+#include <string.h>  // memcmp(), strdup()
 
 // This is a binding to http_parser (https://github.com/joyent/http-parser)
 // The goal is to decouple sockets from parsing for more javascript-level
@@ -30,10 +33,12 @@
 namespace node {
 
 using v8::Array;
+using v8::ArrayBuffer;
 using v8::Boolean;
 using v8::Context;
 using v8::EscapableHandleScope;
 using v8::Exception;
+using v8::Float64Array;
 using v8::Function;
 using v8::FunctionCallbackInfo;
 using v8::FunctionTemplate;
@@ -41,8 +46,10 @@ using v8::HandleScope;
 using v8::Integer;
 using v8::Local;
 using v8::Object;
+using v8::Persistent;
 using v8::String;
 using v8::Uint32;
+using v8::Uint32Array;
 using v8::Undefined;
 using v8::Value;
 
@@ -51,6 +58,34 @@ const uint32_t kOnHeadersComplete = 1;
 const uint32_t kOnBody = 2;
 const uint32_t kOnMessageComplete = 3;
 const uint32_t kOnExecute = 4;
+const uint32_t kOnBatch = 5;
+const uint32_t kOnTimeout = 6;
+
+// Number of arguments of the kOnHeadersComplete callback, see the
+// on_headers_complete_arg_index enum below.
+const size_t kHeadersCompleteArgs = 10;
+
+// The fields of the Float64Array behind http.Server#getStats().  The parser
+// keeps all but the first two, which lib/_http_server.js keeps.  The times
+// are in milliseconds.
+#define HTTP_SERVER_STATS_FIELDS(V)                                           \
+  V(0, kActiveConnections)                                                    \
+  V(1, kConnections)                                                          \
+  V(2, kRequests)                                                             \
+  V(3, kMaxRequestsPerConnection)                                             \
+  V(4, kParseErrors)                                                          \
+  V(5, kHeadersTime)                                                          \
+  V(6, kHandlerTime)                                                          \
+  V(7, kParseTime)                                                            \
+
+enum ServerStatsField {
+#define V(index, name) name = index,
+  HTTP_SERVER_STATS_FIELDS(V)
+#undef V
+  kStatsFieldsCount
+};
+
+const double kNanosPerMilli = 1e6;
 
 
 #define HTTP_CB(name)                                                         \
@@ -70,15 +105,24 @@ const uint32_t kOnExecute = 4;
 
 
 // helper class for the Parser
+//
+// The heap buffer that non-consecutive input is copied into outlives
+// Reset(), so that a pooled parser copies into the buffers it grew for
+// earlier messages and connections instead of allocating new ones.  Only
+// buffers up to kMaxRetainedSize are kept, so that an unusually large
+// header does not pin its memory in the parser pool.
 struct StringPtr {
-  StringPtr() {
-    on_heap_ = false;
-    Reset();
+  StringPtr()
+      : str_(nullptr),
+        size_(0),
+        on_heap_(false),
+        heap_(nullptr),
+        capacity_(0) {
   }
 
 
   ~StringPtr() {
-    Reset();
+    delete[] heap_;
   }
 
 
@@ -87,46 +131,79 @@ struct StringPtr {
   // to leak references. See issue #2438 and test-http-parser-bad-ref.js.
   void Save() {
     if (!on_heap_ && size_ > 0) {
-      char* s = new char[size_];
-      memcpy(s, str_, size_);
-      str_ = s;
+      Reserve(size_);
+      memcpy(heap_, str_, size_);
+      str_ = heap_;
       on_heap_ = true;
     }
   }
 
 
   void Reset() {
-    if (on_heap_) {
-      delete[] str_;
-      on_heap_ = false;
+    if (capacity_ > kMaxRetainedSize) {
+      delete[] heap_;
+      heap_ = nullptr;
+      capacity_ = 0;
     }
-
+    on_heap_ = false;
     str_ = nullptr;
     size_ = 0;
   }
 
 
   void Update(const char* str, size_t size) {
-    if (str_ == nullptr)
+    if (str_ == nullptr) {
       str_ = str;
-    else if (on_heap_ || str_ + size_ != str) {
-      // Non-consecutive input, make a copy on the heap.
-      // TODO(bnoordhuis) Use slab allocation, O(n) allocs is bad.
-      char* s = new char[size_ + size];
-      memcpy(s, str_, size_);
-      memcpy(s + size_, str, size);
-
-      if (on_heap_)
-        delete[] str_;
-      else
-        on_heap_ = true;
-
-      str_ = s;
+    } else if (on_heap_) {
+      Grow(size_ + size);
+      memcpy(heap_ + size_, str, size);
+    } else if (str_ + size_ != str) {
+      // Non-consecutive input, make a copy on the heap.  str_ is not in
+      // heap_ here, so Reserve() may replace it.
+      Reserve(size_ + size);
+      memcpy(heap_, str_, size_);
+      memcpy(heap_ + size_, str, size);
+      str_ = heap_;
+      on_heap_ = true;
     }
     size_ += size;
   }
 
 
+  // Makes heap_ hold at least |size| bytes, discarding its contents.
+  void Reserve(size_t size) {
+    if (size <= capacity_)
+      return;
+    delete[] heap_;
+    capacity_ = NewCapacity(size);
+    heap_ = new char[capacity_];
+  }
+
+
+  // Makes heap_ hold at least |size| bytes, keeping the size_ bytes of the
+  // string that is in it.
+  void Grow(size_t size) {
+    if (size <= capacity_)
+      return;
+    capacity_ = NewCapacity(size);
+    char* s = new char[capacity_];
+    memcpy(s, heap_, size_);
+    delete[] heap_;
+    heap_ = s;
+    str_ = s;
+  }
+
+
+  size_t NewCapacity(size_t size) const {
+    // Doubling keeps a string that arrives in many pieces from being
+    // copied O(n) times.
+    size_t capacity = capacity_ > kMinHeapSize ? capacity_ : kMinHeapSize;
+    while (capacity < size)
+      capacity *= 2;
+    return capacity;
+  }
+
+
   Local<String> ToString(Environment* env) const {
     if (str_)
       return OneByteString(env->isolate(), str_, size_);
@@ -135,9 +212,29 @@ struct StringPtr {
   }
 
 
+  // Like ToString() but returns the interned string for well-known header
+  // names.  The match is exact so that rawHeaders keeps the original case.
+  Local<String> ToHeaderFieldString(Environment* env) const {
+#define V(PropertyName, StringValue)                                          \
+    if (size_ == sizeof(StringValue) - 1 &&                                   \
+        str_[0] == StringValue[0] &&                                          \
+        memcmp(str_, StringValue, size_) == 0) {                              \
+      return env->PropertyName();                                             \
+    }
+    PER_ISOLATE_HTTP_HEADER_STRING_PROPERTIES(V)
+#undef V
+    return ToString(env);
+  }
+
+
+  static const size_t kMinHeapSize = 64;
+  static const size_t kMaxRetainedSize = 4096;
+
   const char* str_;
-  bool on_heap_;
   size_t size_;
+  bool on_heap_;
+  char* heap_;
+  size_t capacity_;
 };
 
 
@@ -146,7 +243,9 @@ class Parser : public AsyncWrap {
   Parser(Environment* env, Local<Object> wrap, enum http_parser_type type)
       : AsyncWrap(env, wrap, AsyncWrap::PROVIDER_HTTPPARSER),
         current_buffer_len_(0),
-        current_buffer_data_(nullptr) {
+        current_buffer_data_(nullptr),
+        headers_deadline_(OnDeadline, this),
+        body_deadline_(OnDeadline, this) {
     Wrap(object(), this);
     Init(type);
   }
@@ -155,6 +254,7 @@ class Parser : public AsyncWrap {
   ~Parser() override {
     ClearWrap(object());
     persistent().Reset();
+    stats_object_.Reset();
   }
 
 
@@ -167,6 +267,10 @@ class Parser : public AsyncWrap {
     num_fields_ = num_values_ = 0;
     url_.Reset();
     status_message_.Reset();
+    // The first byte came with the buffer that is being parsed.
+    message_start_ = execute_start_;
+    if (headers_timeout_ > 0)
+      headers_deadline_.Start(env()->timer_wheel(), headers_timeout_);
     return 0;
   }
 
@@ -235,8 +339,18 @@ class Parser : public AsyncWrap {
       A_STATUS_MESSAGE,
       A_UPGRADE,
       A_SHOULD_KEEP_ALIVE,
+      A_HEADER_BUFFER,
       A_MAX
     };
+    static_assert(A_MAX == kHeadersCompleteArgs,
+                  "kHeadersCompleteArgs out of sync");
+
+    if (stats_ != nullptr)
+      CountRequest();
+
+    headers_deadline_.Stop();
+    if (body_timeout_ > 0)
+      body_deadline_.Start(env()->timer_wheel(), body_timeout_);
 
     Local<Value> argv[A_MAX];
     Local<Object> obj = object();
@@ -252,6 +366,12 @@ class Parser : public AsyncWrap {
     if (have_flushed_) {
       // Slow case, flush remaining headers.
       Flush();
+    } else if (lazy_headers_ && HeadersInCurrentBuffer()) {
+      // Zero-copy case, pass the buffer and the header offsets to JS land.
+      argv[A_HEADERS] = CreateHeaderOffsets();
+      argv[A_HEADER_BUFFER] = current_buffer_;
+      if (parser_.type == HTTP_REQUEST)
+        argv[A_URL] = url_.ToString(env());
     } else {
       // Fast case, pass headers and URL to JS land.
       argv[A_HEADERS] = CreateHeaders();
@@ -284,10 +404,17 @@ class Parser : public AsyncWrap {
 
     argv[A_UPGRADE] = Boolean::New(env()->isolate(), parser_.upgrade);
 
+    // Batched parsers are request parsers, whose callback never asks to
+    // skip the body.
+    if (!batch_.IsEmpty()) {
+      Enqueue(kOnHeadersComplete, arraysize(argv), argv);
+      return 0;
+    }
+
     Environment::AsyncCallbackScope callback_scope(env());
 
     Local<Value> head_response =
-        MakeCallback(cb.As<Function>(), arraysize(argv), argv);
+        TimedCallback(cb.As<Function>(), arraysize(argv), argv);
 
     if (head_response.IsEmpty()) {
       got_exception_ = true;
@@ -310,10 +437,7 @@ class Parser : public AsyncWrap {
     // We came from consumed stream
     if (current_buffer_.IsEmpty()) {
       // Make sure Buffer will be in parent HandleScope
-      current_buffer_ = scope.Escape(Buffer::Copy(
-          env()->isolate(),
-          current_buffer_data_,
-          current_buffer_len_).ToLocalChecked());
+      current_buffer_ = scope.Escape(CopyCurrentBuffer());
     }
 
     Local<Value> argv[3] = {
@@ -322,7 +446,12 @@ class Parser : public AsyncWrap {
       Integer::NewFromUnsigned(env()->isolate(), length)
     };
 
-    Local<Value> r = MakeCallback(cb.As<Function>(), arraysize(argv), argv);
+    if (!batch_.IsEmpty()) {
+      Enqueue(kOnBody, arraysize(argv), argv);
+      return 0;
+    }
+
+    Local<Value> r = TimedCallback(cb.As<Function>(), arraysize(argv), argv);
 
     if (r.IsEmpty()) {
       got_exception_ = true;
@@ -336,6 +465,8 @@ class Parser : public AsyncWrap {
   HTTP_CB(on_message_complete) {
     HandleScope scope(env()->isolate());
 
+    body_deadline_.Stop();
+
     if (num_fields_)
       Flush();  // Flush trailing HTTP headers.
 
@@ -345,9 +476,14 @@ class Parser : public AsyncWrap {
     if (!cb->IsFunction())
       return 0;
 
+    if (!batch_.IsEmpty()) {
+      Enqueue(kOnMessageComplete, 0, nullptr);
+      return 0;
+    }
+
     Environment::AsyncCallbackScope callback_scope(env());
 
-    Local<Value> r = MakeCallback(cb.As<Function>(), 0, nullptr);
+    Local<Value> r = TimedCallback(cb.As<Function>(), 0, nullptr);
 
     if (r.IsEmpty()) {
       got_exception_ = true;
@@ -427,6 +563,9 @@ class Parser : public AsyncWrap {
       return;
 
     if (rv != 0) {
+      if (parser->stats_ != nullptr)
+        parser->stats_[kParseErrors] += 1;
+
       enum http_errno err = HTTP_PARSER_ERRNO(&parser->parser_);
 
       Local<Value> e = Exception::Error(env->parse_error_string());
@@ -502,6 +641,56 @@ class Parser : public AsyncWrap {
   }
 
 
+  static void SetBatched(const FunctionCallbackInfo<Value>& args) {
+    Parser* parser = Unwrap<Parser>(args.Holder());
+    parser->batched_ =
+        args[0]->IsTrue() && parser->parser_.type == HTTP_REQUEST;
+  }
+
+
+  static void SetLazyHeaders(const FunctionCallbackInfo<Value>& args) {
+    Parser* parser = Unwrap<Parser>(args.Holder());
+    parser->lazy_headers_ = args[0]->IsTrue();
+  }
+
+
+  static void SetReadSlab(const FunctionCallbackInfo<Value>& args) {
+    Parser* parser = Unwrap<Parser>(args.Holder());
+    parser->read_slab_ = args[0]->IsTrue();
+  }
+
+
+  // parser.setStats(float64array) makes the parser count into the array,
+  // anything else stops it.
+  static void SetStats(const FunctionCallbackInfo<Value>& args) {
+    Parser* parser = Unwrap<Parser>(args.Holder());
+    parser->ClearStats();
+    if (!args[0]->IsFloat64Array())
+      return;
+
+    Local<Float64Array> array = args[0].As<Float64Array>();
+    CHECK_GE(array->Length(), kStatsFieldsCount);
+    char* data = static_cast<char*>(array->Buffer()->GetContents().Data());
+    parser->stats_object_.Reset(parser->env()->isolate(), array);
+    parser->stats_ = reinterpret_cast<double*>(data + array->ByteOffset());
+  }
+
+
+  // parser.setTimeouts(headersMs, bodyMs), 0 turns one off.  The deadlines
+  // run from the first byte of a message to the end of its headers and from
+  // there to the end of its body.  They start with the next message, and
+  // the kOnTimeout callback gets 'headers' or 'body' when one passes.
+  static void SetTimeouts(const FunctionCallbackInfo<Value>& args) {
+    Parser* parser = Unwrap<Parser>(args.Holder());
+    const int64_t headers_timeout = args[0]->IntegerValue();
+    const int64_t body_timeout = args[1]->IntegerValue();
+    parser->headers_deadline_.Stop();
+    parser->body_deadline_.Stop();
+    parser->headers_timeout_ = headers_timeout > 0 ? headers_timeout : 0;
+    parser->body_timeout_ = body_timeout > 0 ? body_timeout : 0;
+  }
+
+
   static void GetCurrentBuffer(const FunctionCallbackInfo<Value>& args) {
     Parser* parser = Unwrap<Parser>(args.Holder());
 
@@ -532,6 +721,25 @@ class Parser : public AsyncWrap {
 
   static const size_t kAllocBufferSize = 64 * 1024;
 
+  // The deadlines are timeouts of the timer wheel that are never touched.
+  static void OnDeadline(IdleTimeout* timeout, void* ctx) {
+    Parser* parser = static_cast<Parser*>(ctx);
+    Environment* env = parser->env();
+    HandleScope handle_scope(env->isolate());
+    Context::Scope context_scope(env->context());
+    // The callback usually destroys the socket and frees the parser.
+    ScopedRetainParser retain(parser);
+
+    Local<Value> cb = parser->object()->Get(kOnTimeout);
+    if (!cb->IsFunction())
+      return;
+
+    Local<Value> arg = timeout == &parser->headers_deadline_ ?
+        FIXED_ONE_BYTE_STRING(env->isolate(), "headers") :
+        FIXED_ONE_BYTE_STRING(env->isolate(), "body");
+    parser->MakeCallback(cb.As<Function>(), 1, &arg);
+  }
+
   static void OnAllocImpl(size_t suggested_size, uv_buf_t* buf, void* ctx) {
     Parser* parser = static_cast<Parser*>(ctx);
     Environment* env = parser->env();
@@ -594,16 +802,38 @@ class Parser : public AsyncWrap {
 
   Local<Value> Execute(char* data, size_t len) {
     EscapableHandleScope scope(env()->isolate());
+    NODE_TRACE_EVENT0("node.http", "HTTPParser.Execute");
 
     current_buffer_len_ = len;
     current_buffer_data_ = data;
     got_exception_ = false;
 
+    const bool timed = stats_ != nullptr;
+    if (timed) {
+      execute_start_ = uv_hrtime();
+      callback_time_ = 0;
+    }
+
+    if (batched_) {
+      batch_ = Array::New(env()->isolate());
+      batch_length_ = 0;
+    }
+
     size_t nparsed =
       http_parser_execute(&parser_, &settings, data, len);
 
     Save();
 
+    if (batched_) {
+      DispatchBatch();
+      batch_.Clear();
+    }
+
+    if (timed && stats_ != nullptr) {
+      const uint64_t time = uv_hrtime() - execute_start_ - callback_time_;
+      stats_[kParseTime] += time / kNanosPerMilli;
+    }
+
     // Unassign the 'buffer_' variable
     current_buffer_.Clear();
     current_buffer_len_ = 0;
@@ -617,6 +847,9 @@ class Parser : public AsyncWrap {
     // If there was a parse error in one of the callbacks
     // TODO(bnoordhuis) What if there is an error on EOF?
     if (!parser_.upgrade && nparsed != len) {
+      if (stats_ != nullptr)
+        stats_[kParseErrors] += 1;
+
       enum http_errno err = HTTP_PARSER_ERRNO(&parser_);
 
       Local<Value> e = Exception::Error(env()->parse_error_string());
@@ -630,6 +863,69 @@ class Parser : public AsyncWrap {
     return scope.Escape(nparsed_obj);
   }
 
+  Local<Object> CopyCurrentBuffer() {
+    if (read_slab_) {
+      return env()->read_slab_allocator()->Copy(env(),
+                                                current_buffer_data_,
+                                                current_buffer_len_);
+    }
+    return Buffer::Copy(env()->isolate(),
+                        current_buffer_data_,
+                        current_buffer_len_).ToLocalChecked();
+  }
+
+
+  bool InCurrentBuffer(const StringPtr& s) const {
+    if (s.size_ == 0)
+      return true;
+    if (s.on_heap_)
+      return false;
+    return s.str_ >= current_buffer_data_ &&
+           s.str_ + s.size_ <= current_buffer_data_ + current_buffer_len_;
+  }
+
+
+  // True if none of the header fields and values had to be copied to the
+  // heap, i.e. they were all received in the buffer that is being parsed.
+  bool HeadersInCurrentBuffer() const {
+    if (current_buffer_data_ == nullptr)
+      return false;
+    for (size_t i = 0; i < num_values_; i++) {
+      if (!InCurrentBuffer(fields_[i]) || !InCurrentBuffer(values_[i]))
+        return false;
+    }
+    return true;
+  }
+
+
+  // Returns a Uint32Array of [field_start, field_len, value_start, value_len]
+  // quadruples that index into current_buffer_.  When the parser is consuming
+  // the stream, the read buffer is shared and will be overwritten by the next
+  // read, so it is copied into a Buffer once and then shared by the headers
+  // and the body chunks of every message in this read.
+  Local<Uint32Array> CreateHeaderOffsets() {
+    if (current_buffer_.IsEmpty())
+      current_buffer_ = CopyCurrentBuffer();
+
+    const size_t count = num_values_ * 4;
+    Local<ArrayBuffer> array_buffer =
+        ArrayBuffer::New(env()->isolate(), count * sizeof(uint32_t));
+    uint32_t* offsets =
+        static_cast<uint32_t*>(array_buffer->GetContents().Data());
+
+    for (size_t i = 0; i < num_values_; i++) {
+      const StringPtr& field = fields_[i];
+      const StringPtr& value = values_[i];
+      offsets[i * 4 + 0] = field.size_ ? field.str_ - current_buffer_data_ : 0;
+      offsets[i * 4 + 1] = field.size_;
+      offsets[i * 4 + 2] = value.size_ ? value.str_ - current_buffer_data_ : 0;
+      offsets[i * 4 + 3] = value.size_;
+    }
+
+    return Uint32Array::New(array_buffer, 0, count);
+  }
+
+
   Local<Array> CreateHeaders() {
     Local<Array> headers = Array::New(env()->isolate());
     Local<Function> fn = env()->push_values_to_array_function();
@@ -639,7 +935,7 @@ class Parser : public AsyncWrap {
     do {
       size_t j = 0;
       while (i < num_values_ && j < arraysize(argv) / 2) {
-        argv[j * 2] = fields_[i].ToString(env());
+        argv[j * 2] = fields_[i].ToHeaderFieldString(env());
         argv[j * 2 + 1] = values_[i].ToString(env());
         i++;
         j++;
@@ -653,10 +949,89 @@ class Parser : public AsyncWrap {
   }
 
 
+  // In batched mode, the kOnHeadersComplete, kOnBody and kOnMessageComplete
+  // callbacks for all messages in a buffer are collected into one array of
+  // [event, ...arguments] entries that is passed to the kOnBatch callback
+  // at the end of execute(), so pipelined requests cost a single call into
+  // JS land.
+  void Enqueue(uint32_t event, size_t argc, Local<Value>* argv) {
+    Local<Context> context = env()->context();
+    batch_->Set(context,
+                batch_length_++,
+                Integer::NewFromUnsigned(env()->isolate(), event)).FromJust();
+    for (size_t i = 0; i < argc; i++)
+      batch_->Set(context, batch_length_++, argv[i]).FromJust();
+  }
+
+
+  void DispatchBatch() {
+    if (batch_length_ == 0 || got_exception_)
+      return;
+
+    // The array is reused when the batch is dispatched early, see Flush(),
+    // hence the explicit length.
+    Local<Value> argv[2] = {
+      batch_,
+      Integer::NewFromUnsigned(env()->isolate(), batch_length_)
+    };
+    batch_length_ = 0;
+
+    Local<Value> cb = object()->Get(kOnBatch);
+    if (!cb->IsFunction())
+      return;
+
+    Environment::AsyncCallbackScope callback_scope(env());
+
+    Local<Value> r = TimedCallback(cb.As<Function>(), arraysize(argv), argv);
+
+    if (r.IsEmpty())
+      got_exception_ = true;
+  }
+
+
+  // Like MakeCallback(), adds the time spent in JS land to the handler time
+  // when the parser keeps stats.
+  Local<Value> TimedCallback(Local<Function> cb,
+                             int argc,
+                             Local<Value>* argv) {
+    if (stats_ == nullptr)
+      return MakeCallback(cb, argc, argv);
+
+    const uint64_t start = uv_hrtime();
+    Local<Value> ret = MakeCallback(cb, argc, argv);
+    const uint64_t time = uv_hrtime() - start;
+    callback_time_ += time;
+    // The callback may have stopped the stats.
+    if (stats_ != nullptr)
+      stats_[kHandlerTime] += time / kNanosPerMilli;
+    return ret;
+  }
+
+
+  void CountRequest() {
+    requests_ += 1;
+    stats_[kRequests] += 1;
+    if (requests_ > stats_[kMaxRequestsPerConnection])
+      stats_[kMaxRequestsPerConnection] = requests_;
+    stats_[kHeadersTime] += (uv_hrtime() - message_start_) / kNanosPerMilli;
+  }
+
+
+  void ClearStats() {
+    stats_object_.Reset();
+    stats_ = nullptr;
+    requests_ = 0;
+  }
+
+
   // spill headers and request path to JS land
   void Flush() {
     HandleScope scope(env()->isolate());
 
+    // Keep the callbacks in order.
+    if (!batch_.IsEmpty())
+      DispatchBatch();
+
     Local<Object> obj = object();
     Local<Value> cb = obj->Get(kOnHeaders);
 
@@ -668,7 +1043,7 @@ class Parser : public AsyncWrap {
       url_.ToString(env())
     };
 
-    Local<Value> r = MakeCallback(cb.As<Function>(), arraysize(argv), argv);
+    Local<Value> r = TimedCallback(cb.As<Function>(), arraysize(argv), argv);
 
     if (r.IsEmpty())
       got_exception_ = true;
@@ -682,10 +1057,24 @@ class Parser : public AsyncWrap {
     http_parser_init(&parser_, type);
     url_.Reset();
     status_message_.Reset();
+    // Drops what a previous connection left behind, the heap buffers stay
+    // for the next one.
+    for (size_t i = 0; i < arraysize(fields_); i++) {
+      fields_[i].Reset();
+      values_[i].Reset();
+    }
     num_fields_ = 0;
     num_values_ = 0;
     have_flushed_ = false;
     got_exception_ = false;
+    lazy_headers_ = false;
+    read_slab_ = false;
+    batched_ = false;
+    ClearStats();
+    headers_deadline_.Stop();
+    body_deadline_.Stop();
+    headers_timeout_ = 0;
+    body_timeout_ = 0;
   }
 
 
@@ -698,12 +1087,29 @@ class Parser : public AsyncWrap {
   size_t num_values_;
   bool have_flushed_;
   bool got_exception_;
+  bool lazy_headers_;
+  bool read_slab_;
+  bool batched_;
+  Local<Array> batch_;
+  uint32_t batch_length_ = 0;
   Local<Object> current_buffer_;
   size_t current_buffer_len_;
   char* current_buffer_data_;
   StreamResource::Callback<StreamResource::AllocCb> prev_alloc_cb_;
   StreamResource::Callback<StreamResource::ReadCb> prev_read_cb_;
   int refcount_ = 1;
+  Persistent<Float64Array> stats_object_;
+  double* stats_ = nullptr;
+  // Of the current connection.
+  uint32_t requests_ = 0;
+  uint64_t execute_start_ = 0;
+  uint64_t message_start_ = 0;
+  // Spent in TimedCallback() during the current execute().
+  uint64_t callback_time_ = 0;
+  IdleTimeout headers_deadline_;
+  IdleTimeout body_deadline_;
+  uint64_t headers_timeout_ = 0;
+  uint64_t body_timeout_ = 0;
   static const struct http_parser_settings settings;
 
   friend class ScopedRetainParser;
@@ -747,6 +1153,10 @@ void InitHttpParser(Local<Object> target,
          Integer::NewFromUnsigned(env->isolate(), kOnMessageComplete));
   t->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "kOnExecute"),
          Integer::NewFromUnsigned(env->isolate(), kOnExecute));
+  t->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "kOnBatch"),
+         Integer::NewFromUnsigned(env->isolate(), kOnBatch));
+  t->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "kOnTimeout"),
+         Integer::NewFromUnsigned(env->isolate(), kOnTimeout));
 
   Local<Array> methods = Array::New(env->isolate());
 #define V(num, name, string)                                                  \
@@ -763,10 +1173,23 @@ void InitHttpParser(Local<Object> target,
   env->SetProtoMethod(t, "resume", Parser::Pause<false>);
   env->SetProtoMethod(t, "consume", Parser::Consume);
   env->SetProtoMethod(t, "unconsume", Parser::Unconsume);
+  env->SetProtoMethod(t, "setBatched", Parser::SetBatched);
+  env->SetProtoMethod(t, "setLazyHeaders", Parser::SetLazyHeaders);
+  env->SetProtoMethod(t, "setReadSlab", Parser::SetReadSlab);
+  env->SetProtoMethod(t, "setStats", Parser::SetStats);
+  env->SetProtoMethod(t, "setTimeouts", Parser::SetTimeouts);
   env->SetProtoMethod(t, "getCurrentBuffer", Parser::GetCurrentBuffer);
 
   target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "HTTPParser"),
               t->GetFunction());
+
+#define V(index, name)                                                        \
+  target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), #name),                   \
+              Uint32::NewFromUnsigned(env->isolate(), index));
+  HTTP_SERVER_STATS_FIELDS(V)
+#undef V
+  target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "kStatsFieldsCount"),
+              Uint32::NewFromUnsigned(env->isolate(), kStatsFieldsCount));
 }
 
 }  // namespace node
@@ -23,7 +23,18 @@
 
 #if defined(NODE_HAVE_I18N_SUPPORT)
 
+#include "node_buffer.h"
+#include "base-object.h"
+#include "base-object-inl.h"
+#include "env.h"
+#include "env-inl.h"
+#include "util.h"
+#include "util-inl.h"
+#include "v8.h"
+
+#include <stdlib.h>
 #include <unicode/putil.h>
+#include <unicode/ucnv.h>
 #include <unicode/udata.h>
 
 #ifdef NODE_HAVE_SMALL_ICU
@@ -64,7 +75,258 @@ bool InitializeICUDirectory(const char* icu_data_path) {
   }
 }
 
+using v8::Context;
+using v8::FunctionCallbackInfo;
+using v8::FunctionTemplate;
+using v8::Local;
+using v8::Object;
+using v8::String;
+using v8::Value;
+
+// The bundled ICU is built without converters, see tools/icu/icu-generic.gyp.
+// transcode() and Transcoder are left out then.
+#if !UCONFIG_NO_CONVERSION
+namespace {
+
+// ucnv_convertEx() goes through UTF-16 in a buffer of this many code units.
+const size_t kPivotSize = 1024;
+
+// Converts |length| bytes with ucnv_convertEx() and appends the result to the
+// malloc()ed |*out|, which it grows as needed.  The pivot buffer keeps the
+// UTF-16 that was converted from the source but not yet to the target, so
+// that a stream can be converted chunk by chunk.
+UErrorCode ConvertEx(UConverter* to,
+                     UConverter* from,
+                     const char* data,
+                     size_t length,
+                     bool reset,
+                     bool flush,
+                     UChar* pivot_start,
+                     UChar** pivot_source,
+                     UChar** pivot_target,
+                     char** out,
+                     size_t* out_length) {
+  size_t capacity = length * ucnv_getMaxCharSize(to) + 16;
+  size_t used = 0;
+  char* output = nullptr;
+  const char* source = data;
+  UErrorCode status = U_ZERO_ERROR;
+
+  for (;;) {
+    char* grown = static_cast<char*>(realloc(output, capacity));
+    if (grown == nullptr) {
+      status = U_MEMORY_ALLOCATION_ERROR;
+      break;
+    }
+    output = grown;
+    char* target = output + used;
+    ucnv_convertEx(to, from,
+                   &target, output + capacity,
+                   &source, data + length,
+                   pivot_start, pivot_source, pivot_target,
+                   pivot_start + kPivotSize,
+                   reset, flush, &status);
+    used = target - output;
+    reset = false;
+    if (status != U_BUFFER_OVERFLOW_ERROR)
+      break;
+    status = U_ZERO_ERROR;
+    capacity *= 2;
+  }
+
+  if (U_FAILURE(status)) {
+    free(output);
+    return status;
+  }
+  *out = output;
+  *out_length = used;
+  return status;
+}
+
+
+// Opens the converters for |from| and |to|, closes both if either fails.
+UErrorCode OpenConverters(const char* from,
+                          const char* to,
+                          UConverter** from_cnv,
+                          UConverter** to_cnv) {
+  UErrorCode status = U_ZERO_ERROR;
+  *from_cnv = ucnv_open(from, &status);
+  if (U_FAILURE(status))
+    return status;
+  *to_cnv = ucnv_open(to, &status);
+  if (U_FAILURE(status)) {
+    ucnv_close(*from_cnv);
+    *from_cnv = nullptr;
+  }
+  return status;
+}
+
+
+Local<Object> NewBuffer(Environment* env, char* data, size_t length) {
+  if (length == 0) {
+    free(data);
+    return Buffer::New(env, 0).ToLocalChecked();
+  }
+  // The Buffer takes the memory over.
+  return Buffer::New(env, data, length).ToLocalChecked();
+}
+
+
+// transcode(source, fromEncoding, toEncoding)
+// Returns a new Buffer, or the (negative) ICU error code.
+void Transcode(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  if (!Buffer::HasInstance(args[0]))
+    return env->ThrowTypeError("argument should be a Buffer");
+  CHECK(args[1]->IsString());
+  CHECK(args[2]->IsString());
+
+  const Utf8Value from_name(env->isolate(), args[1]);
+  const Utf8Value to_name(env->isolate(), args[2]);
+  const char* source_data = Buffer::Data(args[0]);
+  const size_t source_length = Buffer::Length(args[0]);
+
+  UConverter* from;
+  UConverter* to;
+  UErrorCode status = OpenConverters(*from_name, *to_name, &from, &to);
+  if (U_FAILURE(status))
+    return args.GetReturnValue().Set(-status);
+
+  UChar pivot[kPivotSize];
+  UChar* pivot_source = pivot;
+  UChar* pivot_target = pivot;
+  char* out;
+  size_t out_length;
+  status = ConvertEx(to, from, source_data, source_length, true, true,
+                     pivot, &pivot_source, &pivot_target, &out, &out_length);
+  ucnv_close(from);
+  ucnv_close(to);
+
+  if (U_FAILURE(status))
+    return args.GetReturnValue().Set(-status);
+  args.GetReturnValue().Set(NewBuffer(env, out, out_length));
+}
+
+
+// icuErrName(code)
+void GetErrorName(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  CHECK(args[0]->IsInt32());
+  const UErrorCode status = static_cast<UErrorCode>(-args[0]->Int32Value());
+  args.GetReturnValue().Set(OneByteString(env->isolate(), u_errorName(status)));
+}
+
+
+// A conversion that is fed one chunk at a time.  Sequences that are split
+// across chunks are kept in the converters until the next one comes in.
+class Transcoder : public BaseObject {
+ public:
+  ~Transcoder() override {
+    ucnv_close(from_);
+    ucnv_close(to_);
+  }
+
+  static void Initialize(Environment* env, Local<Object> target) {
+    Local<FunctionTemplate> t = env->NewFunctionTemplate(New);
+    t->InstanceTemplate()->SetInternalFieldCount(1);
+    t->SetClassName(FIXED_ONE_BYTE_STRING(env->isolate(), "Transcoder"));
+    env->SetProtoMethod(t, "convert", Convert);
+    target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "Transcoder"),
+                t->GetFunction());
+  }
+
+ private:
+  Transcoder(Environment* env,
+             Local<Object> wrap,
+             UConverter* from,
+             UConverter* to)
+      : BaseObject(env, wrap),
+        from_(from),
+        to_(to),
+        pivot_source_(pivot_),
+        pivot_target_(pivot_),
+        reset_(true) {
+    MakeWeak<Transcoder>(this);
+  }
+
+  // new Transcoder(fromEncoding, toEncoding)
+  static void New(const FunctionCallbackInfo<Value>& args) {
+    Environment* env = Environment::GetCurrent(args);
+    CHECK(args.IsConstructCall());
+    CHECK(args[0]->IsString());
+    CHECK(args[1]->IsString());
+
+    const Utf8Value from_name(env->isolate(), args[0]);
+    const Utf8Value to_name(env->isolate(), args[1]);
+    UConverter* from;
+    UConverter* to;
+    UErrorCode status = OpenConverters(*from_name, *to_name, &from, &to);
+    if (U_FAILURE(status)) {
+      args.This()->Set(env->code_string(),
+                       OneByteString(env->isolate(), u_errorName(status)));
+      return;
+    }
+    new Transcoder(env, args.This(), from, to);
+  }
+
+  // convert(buffer, flush)
+  // Returns the converted Buffer, or the (negative) ICU error code.  After a
+  // flush, or an error, the next call starts a new conversion.
+  static void Convert(const FunctionCallbackInfo<Value>& args) {
+    Environment* env = Environment::GetCurrent(args);
+    Transcoder* transcoder = Unwrap<Transcoder>(args.Holder());
+    if (!Buffer::HasInstance(args[0]))
+      return env->ThrowTypeError("argument should be a Buffer");
+    const char* source_data = Buffer::Data(args[0]);
+    const size_t source_length = Buffer::Length(args[0]);
+    const bool flush = args[1]->IsTrue();
+
+    char* out;
+    size_t out_length;
+    UErrorCode status = ConvertEx(transcoder->to_,
+                                  transcoder->from_,
+                                  source_data,
+                                  source_length,
+                                  transcoder->reset_,
+                                  flush,
+                                  transcoder->pivot_,
+                                  &transcoder->pivot_source_,
+                                  &transcoder->pivot_target_,
+                                  &out,
+                                  &out_length);
+    transcoder->reset_ = flush || U_FAILURE(status);
+    if (U_FAILURE(status))
+      return args.GetReturnValue().Set(-status);
+    args.GetReturnValue().Set(NewBuffer(env, out, out_length));
+  }
+
+  UConverter* const from_;
+  UConverter* const to_;
+  UChar pivot_[kPivotSize];
+  UChar* pivot_source_;
+  UChar* pivot_target_;
+  bool reset_;
+};
+
+}  // anonymous namespace
+#endif  // !UCONFIG_NO_CONVERSION
+
+
+void Init(Local<Object> target,
+          Local<Value> unused,
+          Local<Context> context,
+          void* priv) {
+#if !UCONFIG_NO_CONVERSION
+  Environment* env = Environment::GetCurrent(context);
+  env->SetMethod(target, "transcode", Transcode);
+  env->SetMethod(target, "icuErrName", GetErrorName);
+  Transcoder::Initialize(env, target);
+#endif  // !UCONFIG_NO_CONVERSION
+}
+
 }  // namespace i18n
 }  // namespace node
 
+NODE_MODULE_CONTEXT_AWARE_BUILTIN(icu, node::i18n::Init)
+
 #endif  // NODE_HAVE_I18N_SUPPORT
@@ -0,0 +1,200 @@
+#include "node_idle_scheduler.h"
+#include "node_internals.h"
+#include "env.h"
+#include "env-inl.h"
+#include "util.h"
+#include "util-inl.h"
+#include "v8.h"
+
+namespace node {
+
+using v8::Context;
+using v8::Function;
+using v8::FunctionCallbackInfo;
+using v8::HandleScope;
+using v8::Local;
+using v8::Number;
+using v8::Object;
+using v8::Value;
+
+static const uint64_t kNanosPerMilli = 1000 * 1000;
+
+
+IdleScheduler::IdleScheduler(Environment* env)
+    : env_(env),
+      last_maintenance_(0),
+      v8_wants_idle_(false) {
+  CHECK_EQ(0, uv_prepare_init(env->event_loop(), &prepare_));
+  CHECK_EQ(0, uv_idle_init(env->event_loop(), &idle_));
+  uv_unref(reinterpret_cast<uv_handle_t*>(&prepare_));
+  uv_unref(reinterpret_cast<uv_handle_t*>(&idle_));
+  env->RegisterHandleCleanup(reinterpret_cast<uv_handle_t*>(&prepare_),
+                             OnClose,
+                             nullptr);
+  env->RegisterHandleCleanup(reinterpret_cast<uv_handle_t*>(&idle_),
+                             OnClose,
+                             nullptr);
+  CHECK_EQ(0, uv_prepare_start(&prepare_, OnPrepare));
+}
+
+
+void IdleScheduler::Post(Task task, void* data) {
+  tasks_.emplace_back(task, data);
+  uv_idle_start(&idle_, OnIdle);
+}
+
+
+bool IdleScheduler::IsPosted(Task task, void* data) const {
+  for (const std::pair<Task, void*>& posted : tasks_) {
+    if (posted.first == task && posted.second == data)
+      return true;
+  }
+  return false;
+}
+
+
+void IdleScheduler::Ref() {
+  uv_ref(reinterpret_cast<uv_handle_t*>(&prepare_));
+}
+
+
+void IdleScheduler::Unref() {
+  uv_unref(reinterpret_cast<uv_handle_t*>(&prepare_));
+}
+
+
+void IdleScheduler::OnPrepare(uv_prepare_t* handle) {
+  IdleScheduler* scheduler = ContainerOf(&IdleScheduler::prepare_, handle);
+  uv_loop_t* loop = scheduler->env_->event_loop();
+
+  // The idle handle of the scheduler itself makes the timeout 0.
+  uv_idle_stop(&scheduler->idle_);
+  const int timeout = uv_backend_timeout(loop);
+  if (timeout != 0) {
+    uint64_t budget = kMaxBudget;
+    if (timeout > 0 && static_cast<uint64_t>(timeout) < budget)
+      budget = timeout;
+    scheduler->RunIdlePeriod(budget);
+  }
+
+  if (!scheduler->tasks_.empty() || scheduler->v8_wants_idle_)
+    uv_idle_start(&scheduler->idle_, OnIdle);
+}
+
+
+void IdleScheduler::OnIdle(uv_idle_t* handle) {
+  // Only here to keep the loop from blocking, OnPrepare() does the work.
+}
+
+
+void IdleScheduler::RunIdlePeriod(uint64_t budget) {
+  uint64_t now = uv_hrtime();
+  const uint64_t deadline = now + budget * kNanosPerMilli;
+
+  if (v8_wants_idle_ ||
+      now - last_maintenance_ >= kMaintenanceInterval * kNanosPerMilli) {
+    v8_wants_idle_ = RunMaintenance(now, deadline);
+    now = uv_hrtime();
+  }
+
+  // The tasks that are posted by the ones that run wait for the next period.
+  std::vector<std::pair<Task, void*>> tasks;
+  tasks.swap(tasks_);
+  size_t i = 0;
+  for (; i < tasks.size() && now < deadline; i++) {
+    const bool again = tasks[i].first(env_, tasks[i].second, deadline);
+    if (again && !IsPosted(tasks[i].first, tasks[i].second))
+      tasks_.push_back(tasks[i]);
+    now = uv_hrtime();
+  }
+  tasks_.insert(tasks_.begin(), tasks.begin() + i, tasks.end());
+}
+
+
+bool IdleScheduler::RunMaintenance(uint64_t now, uint64_t deadline) {
+  // Memory that the last interval did not need goes back to the system.
+  if (!v8_wants_idle_) {
+    last_maintenance_ = now;
+    env_->bio_buffer_pool()->Trim();
+    env_->req_storage_pool()->Trim();
+  }
+
+  now = uv_hrtime();
+  if (now >= deadline)
+    return v8_wants_idle_;
+  const double remaining = static_cast<double>(deadline - now) / 1e9;
+  return !env_->isolate()->IdleNotificationDeadline(PlatformMonotonicTime() +
+                                                    remaining);
+}
+
+
+void IdleScheduler::OnClose(Environment* env, uv_handle_t* handle, void*) {
+  handle->data = env;
+  uv_close(handle, [](uv_handle_t* handle) {
+    static_cast<Environment*>(handle->data)->FinishHandleCleanup(handle);
+  });
+}
+
+
+// Calls the JS side, which runs idle callbacks until |deadline| and returns
+// whether some are left.
+static bool RunIdleCallbacks(Environment* env, void* data, uint64_t deadline) {
+  HandleScope handle_scope(env->isolate());
+  Context::Scope context_scope(env->context());
+  const double deadline_ms = static_cast<double>(deadline) / kNanosPerMilli;
+  Local<Value> arg = Number::New(env->isolate(), deadline_ms);
+  Local<Value> ret = MakeCallback(env,
+                                  env->process_object().As<Value>(),
+                                  env->idle_callbacks_function(),
+                                  1,
+                                  &arg);
+  return !ret.IsEmpty() && ret->IsTrue();
+}
+
+
+static void Setup(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  CHECK(args[0]->IsFunction());
+  env->set_idle_callbacks_function(args[0].As<Function>());
+}
+
+
+static void Schedule(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  IdleScheduler* scheduler = env->idle_scheduler();
+  if (!scheduler->IsPosted(RunIdleCallbacks, nullptr))
+    scheduler->Post(RunIdleCallbacks, nullptr);
+}
+
+
+static void Ref(const FunctionCallbackInfo<Value>& args) {
+  Environment::GetCurrent(args)->idle_scheduler()->Ref();
+}
+
+
+static void Unref(const FunctionCallbackInfo<Value>& args) {
+  Environment::GetCurrent(args)->idle_scheduler()->Unref();
+}
+
+
+// Milliseconds on the clock of the deadlines.
+static void Now(const FunctionCallbackInfo<Value>& args) {
+  args.GetReturnValue().Set(static_cast<double>(uv_hrtime()) / kNanosPerMilli);
+}
+
+
+void InitIdleScheduler(Local<Object> target,
+                       Local<Value> unused,
+                       Local<Context> context,
+                       void* priv) {
+  Environment* env = Environment::GetCurrent(context);
+  env->SetMethod(target, "setup", Setup);
+  env->SetMethod(target, "schedule", Schedule);
+  env->SetMethod(target, "ref", Ref);
+  env->SetMethod(target, "unref", Unref);
+  env->SetMethod(target, "now", Now);
+}
+
+}  // namespace node
+
+NODE_MODULE_CONTEXT_AWARE_BUILTIN(idle_scheduler, node::InitIdleScheduler)
@@ -0,0 +1,64 @@
+#ifndef SRC_NODE_IDLE_SCHEDULER_H_
+#define SRC_NODE_IDLE_SCHEDULER_H_
+
+#include "util.h"
+#include "uv.h"
+
+#include <stdint.h>
+#include <utility>
+#include <vector>
+
+namespace node {
+
+class Environment;
+
+// Runs work that is not urgent while the event loop is idle.  Before each
+// poll a prepare handle looks at the timeout that the loop is about to block
+// for.  When it is not 0 there is nothing to do right away and the period
+// until the next timer, at most kMaxBudget milliseconds, goes to the posted
+// tasks.  Once per kMaintenanceInterval an idle period starts with trimming
+// the buffer pools of the Environment and hands what is left to V8 for
+// garbage collection.  While tasks are left an idle handle keeps the loop
+// from blocking so that they go on in the next iteration.  The handles are
+// unref'd, posted tasks do not keep the loop alive unless Ref() was called.
+class IdleScheduler {
+ public:
+  static const uint64_t kMaxBudget = 20;
+  static const uint64_t kMaintenanceInterval = 1000;
+
+  // |deadline| is a uv_hrtime() in nanoseconds.  Returns true to be called
+  // again in the next idle period.
+  typedef bool (*Task)(Environment* env, void* data, uint64_t deadline);
+
+  explicit IdleScheduler(Environment* env);
+
+  void Post(Task task, void* data);
+  bool IsPosted(Task task, void* data) const;
+
+  // Keeps the loop alive while there is work that must not be dropped.
+  void Ref();
+  void Unref();
+
+ private:
+  static void OnPrepare(uv_prepare_t* handle);
+  static void OnIdle(uv_idle_t* handle);
+  static void OnClose(Environment* env, uv_handle_t* handle, void* arg);
+
+  void RunIdlePeriod(uint64_t budget);
+  // Returns false once V8 has nothing left to do.
+  bool RunMaintenance(uint64_t now, uint64_t deadline);
+
+  Environment* const env_;
+  uv_prepare_t prepare_;
+  uv_idle_t idle_;
+  std::vector<std::pair<Task, void*>> tasks_;
+  uint64_t last_maintenance_;
+  // V8 asked for more idle time after the last maintenance.
+  bool v8_wants_idle_;
+
+  DISALLOW_COPY_AND_ASSIGN(IdleScheduler);
+};
+
+}  // namespace node
+
+#endif  // SRC_NODE_IDLE_SCHEDULER_H_
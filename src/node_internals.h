@@ -9,6 +9,11 @@
 
 #include <stdint.h>
 #include <stdlib.h>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
 
 struct sockaddr;
 
@@ -193,18 +198,47 @@ void ThrowUVException(v8::Isolate* isolate,
                       const char* path = nullptr,
                       const char* dest = nullptr);
 
+// Backing stores of up to BufferArena::kMaxBlockSize bytes come from the
+// BufferArena, see src/buffer_arena.h, and the larger ones from malloc().
+// With --huge-pages, backing stores of at least kHugePageSize bytes are mapped
+// on their own, aligned to kHugePageSize and advised to use transparent huge
+// pages.  Only ever used from the isolate's thread.
 class ArrayBufferAllocator : public v8::ArrayBuffer::Allocator {
  public:
-  ArrayBufferAllocator() : env_(nullptr) { }
+  static const size_t kHugePageSize = 2 << 20;
+
+  ArrayBufferAllocator();
+  ~ArrayBufferAllocator();
 
   inline void set_env(Environment* env) { env_ = env; }
 
-  virtual void* Allocate(size_t size);  // Defined in src/node.cc
-  virtual void* AllocateUninitialized(size_t size) { return malloc(size); }
-  virtual void Free(void* data, size_t) { free(data); }
+  typedef void (*FreeCallback)(char* data, void* hint);
+  // Free() passes |data| to |callback| instead of freeing it, see
+  // Buffer::Adopt().
+  inline void Adopt(void* data, FreeCallback callback, void* hint) {
+    adopted_[data] = std::make_pair(callback, hint);
+  }
+
+  // Set by --huge-pages before the first isolate is created.
+  static bool use_huge_pages;
+  // Bytes that are mapped for backing stores with huge pages, in all the
+  // allocators of the process.
+  static size_t HugePageBytes();
+
+  // Defined in src/node.cc
+  virtual void* Allocate(size_t size);
+  virtual void* AllocateUninitialized(size_t size);
+  virtual void Free(void* data, size_t size);
 
  private:
+  // Returns nullptr when the mapping fails, or where there is no madvise().
+  void* AllocateHuge(size_t size);
+  void FreeHuge(void* data, size_t size);
+
   Environment* env_;
+  // Backing stores that AllocateHuge() mapped.
+  std::unordered_set<void*> huge_;
+  std::unordered_map<void*, std::pair<FreeCallback, void*>> adopted_;
 };
 
 // Clear any domain and/or uncaughtException handlers to force the error's
@@ -212,7 +246,53 @@ class ArrayBufferAllocator : public v8::ArrayBuffer::Allocator {
 // by clearing all callbacks that could handle the error.
 void ClearFatalExceptionHandlers(Environment* env);
 
-enum NodeInstanceType { MAIN, WORKER, REMOTE_DEBUG_SERVER };
+// Closes every handle on the event loop of `env`, for instances that own
+// their loop and end while the process goes on.
+void CloseEnvironmentHandles(Environment* env);
+
+// Waits for the QueueTask() tasks of `loop` and unregisters it from the task
+// pool.  Must be called on the loop thread before the loop is closed.
+void CloseTaskLoop(uv_loop_t* loop);
+
+// The clock of the V8 platform, in seconds.  Deadlines that are passed to
+// V8, like the one of Isolate::IdleNotificationDeadline(), are based on it.
+double PlatformMonotonicTime();
+
+enum NodeInstanceType { MAIN, WORKER, EMBEDDED, REMOTE_DEBUG_SERVER };
+
+class Worker;
+
+// An instance that an embedder runs, see CreateInstance() in node.h.
+class NodeInstance {
+  public:
+    NodeInstance(int argc, const char* const* argv);
+    ~NodeInstance();
+
+    int Run();
+    // Thread-safe.  The first exit code wins.
+    void Stop(int exit_code);
+    bool is_stopping();
+    int exit_code();
+
+    // Called on the thread of the instance once it can be terminated, and
+    // when it is done.
+    void Started(Environment* env);
+    void Stopped(Environment* env);
+
+  private:
+    static void OnStopAsync(uv_async_t* handle);
+
+    std::vector<std::string> args_;
+    uv_loop_t loop_;
+    uv_async_t stop_async_;
+    uv_mutex_t mutex_;
+    v8::Isolate* isolate_;
+    bool ran_;
+    bool stopping_;
+    int exit_code_;
+
+    DISALLOW_COPY_AND_ASSIGN(NodeInstance);
+};
 
 class NodeInstanceData {
   public:
@@ -230,7 +310,9 @@ class NodeInstanceData {
           argv_(argv),
           exec_argc_(exec_argc),
           exec_argv_(exec_argv),
-          use_debug_agent_flag_(use_debug_agent_flag) {
+          use_debug_agent_flag_(use_debug_agent_flag),
+          worker_(nullptr),
+          node_instance_(nullptr) {
       CHECK_NE(event_loop_, nullptr);
     }
 
@@ -239,12 +321,12 @@ class NodeInstanceData {
     }
 
     int exit_code() {
-      CHECK(is_main());
+      CHECK(is_main() || is_worker() || is_embedded());
       return exit_code_;
     }
 
     void set_exit_code(int exit_code) {
-      CHECK(is_main());
+      CHECK(is_main() || is_worker() || is_embedded());
       exit_code_ = exit_code;
     }
 
@@ -256,6 +338,10 @@ class NodeInstanceData {
       return node_instance_type_ == WORKER;
     }
 
+    bool is_embedded() {
+      return node_instance_type_ == EMBEDDED;
+    }
+
     bool is_remote_debug_server() {
       return node_instance_type_ == REMOTE_DEBUG_SERVER;
     }
@@ -280,6 +366,27 @@ class NodeInstanceData {
       return is_main() && use_debug_agent_flag_;
     }
 
+    Worker* worker() {
+      return worker_;
+    }
+
+    void set_worker(Worker* worker) {
+      CHECK(is_worker());
+      worker_ = worker;
+    }
+
+    NodeInstance* node_instance() {
+      return node_instance_;
+    }
+
+    void set_node_instance(NodeInstance* node_instance) {
+      CHECK(is_embedded());
+      node_instance_ = node_instance;
+    }
+
+    // Whether the Worker or the embedder asked the instance to stop.
+    bool is_stopping();
+
   private:
     const NodeInstanceType node_instance_type_;
     int exit_code_;
@@ -289,10 +396,15 @@ class NodeInstanceData {
     const int exec_argc_;
     const char** exec_argv_;
     const bool use_debug_agent_flag_;
+    Worker* worker_;
+    NodeInstance* node_instance_;
 
     DISALLOW_COPY_AND_ASSIGN(NodeInstanceData);
 };
 
+// Runs a node instance on the calling thread until its event loop is done.
+void StartNodeInstance(NodeInstanceData* instance_data);
+
 namespace Buffer {
 v8::MaybeLocal<v8::Object> Copy(Environment* env, const char* data, size_t len);
 v8::MaybeLocal<v8::Object> New(Environment* env, size_t size);
@@ -302,9 +414,23 @@ v8::MaybeLocal<v8::Object> New(Environment* env,
                                size_t length,
                                void (*callback)(char* data, void* hint),
                                void* hint);
-// Takes ownership of |data|.  Must allocate |data| with malloc() or realloc()
-// because ArrayBufferAllocator::Free() deallocates it again with free().
-// Mixing operator new and free() is undefined behavior so don't do that.
+// Like the New() above, but without a weak handle per Buffer.  The backing
+// store is internalized and ArrayBufferAllocator calls |callback| when V8
+// frees it, which also makes V8 count it as external memory.  An addon that
+// Externalize()s it takes the memory over and |callback| never runs, which is
+// why the public Buffer::New() with a callback keeps the weak handles.  Takes
+// ownership of |data| even when it fails.  Falls back to New() when the
+// isolate has no ArrayBufferAllocator of node.
+v8::MaybeLocal<v8::Object> Adopt(Environment* env,
+                                 char* data,
+                                 size_t length,
+                                 void (*callback)(char* data, void* hint),
+                                 void* hint);
+// Takes ownership of |data|.  Must allocate |data| with malloc() or realloc(),
+// or with BufferArena::Allocate() and |length| as the size, because
+// ArrayBufferAllocator::Free() deallocates it again with free() or
+// BufferArena::Free().  Mixing operator new and free() is undefined behavior
+// so don't do that.
 v8::MaybeLocal<v8::Object> New(Environment* env, char* data, size_t length);
 }  // namespace Buffer
 
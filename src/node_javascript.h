@@ -7,6 +7,7 @@
 namespace node {
 
 void DefineJavaScript(Environment* env, v8::Local<v8::Object> target);
+void DefineCodeCache(Environment* env, v8::Local<v8::Object> target);
 v8::Local<v8::String> MainSource(Environment* env);
 
 }  // namespace node
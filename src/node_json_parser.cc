@@ -0,0 +1,856 @@
+#include "node.h"
+#include "node_buffer.h"
+#include "node_internals.h"
+
+#include "async-wrap.h"
+#include "async-wrap-inl.h"
+#include "env.h"
+#include "env-inl.h"
+#include "util.h"
+#include "util-inl.h"
+#include "uv.h"
+#include "v8.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <string>
+#include <vector>
+
+// An incremental JSON parser for bodies that arrive in chunks, e.g. from the
+// 'data' events of an http.IncomingMessage.  Each chunk goes through two
+// stages: the scanner checks the grammar and turns the bytes into tokens,
+// which needs no V8 and can run on the threadpool, and the builder turns the
+// tokens into values on the main thread.  Both keep their state between
+// chunks, so that a chunk can end in the middle of any token.
+//
+// The values are the same as those of JSON.parse(buf.toString()): the raw
+// characters of strings are decoded by V8, which replaces invalid UTF-8 the
+// same way.  Error positions are byte offsets into the whole input.
+
+namespace node {
+namespace json_parser {
+
+using v8::Array;
+using v8::Context;
+using v8::Exception;
+using v8::False;
+using v8::FunctionCallbackInfo;
+using v8::FunctionTemplate;
+using v8::HandleScope;
+using v8::Isolate;
+using v8::Local;
+using v8::MaybeLocal;
+using v8::NewStringType;
+using v8::Null;
+using v8::Number;
+using v8::Object;
+using v8::Persistent;
+using v8::String;
+using v8::True;
+using v8::Undefined;
+using v8::Value;
+
+enum TokenType {
+  kBeginObject,
+  kEndObject,
+  kBeginArray,
+  kEndArray,
+  kKey,
+  kString,
+  kNumber,
+  kTrue,
+  kFalse,
+  kNull
+};
+
+struct Token {
+  TokenType type;
+  bool escaped;   // Whether a key or string has backslash escapes.
+  size_t offset;  // The raw characters of a key or string in the arena.
+  size_t length;
+  double number;
+};
+
+
+static inline bool IsWhitespace(uint8_t c) {
+  return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+
+static inline bool IsDigit(uint8_t c) {
+  return c >= '0' && c <= '9';
+}
+
+
+static inline int HexValue(uint8_t c) {
+  if (c >= '0' && c <= '9')
+    return c - '0';
+  if (c >= 'A' && c <= 'F')
+    return c - 'A' + 10;
+  if (c >= 'a' && c <= 'f')
+    return c - 'a' + 10;
+  return -1;
+}
+
+
+class Scanner {
+ public:
+  Scanner() : state_(kValue),
+              key_(false),
+              escape_(0),
+              escaped_(false),
+              string_start_(0),
+              literal_(nullptr),
+              number_state_(kNumberInteger),
+              position_(0),
+              error_position_(0),
+              error_byte_(-1) {}
+
+  // Appends the tokens of a chunk to tokens().  Returns false on a syntax
+  // error, after which the scanner takes no more input.
+  bool Scan(const uint8_t* data, size_t length);
+
+  // Ends the input.  Returns false if it is not a single complete value.
+  bool Finish();
+
+  // Drops the tokens that have been built.  The raw characters of a string
+  // that is still open move to the front of the arena.
+  void Clear() {
+    tokens_.clear();
+    if (state_ == kInString) {
+      arena_.erase(0, string_start_);
+      string_start_ = 0;
+    } else {
+      arena_.clear();
+    }
+  }
+
+  bool failed() const { return state_ == kError; }
+
+  // "Unexpected token x in JSON at position 12", like JSON.parse().
+  std::string ErrorMessage() const {
+    char message[96];
+    if (error_byte_ < 0) {
+      snprintf(message, sizeof(message), "Unexpected end of JSON input");
+    } else if (error_byte_ >= 0x20 && error_byte_ < 0x7f) {
+      snprintf(message, sizeof(message),
+               "Unexpected token %c in JSON at position %llu",
+               error_byte_, static_cast<unsigned long long>(error_position_));
+    } else {
+      snprintf(message, sizeof(message),
+               "Unexpected byte 0x%02x in JSON at position %llu",
+               error_byte_, static_cast<unsigned long long>(error_position_));
+    }
+    return message;
+  }
+
+  const std::vector<Token>& tokens() const { return tokens_; }
+  const char* arena() const { return arena_.data(); }
+
+ private:
+  enum State {
+    kValue,       // A value, after ':' or ',' in an array or at the start.
+    kFirstValue,  // A value or ']', after '['.
+    kFirstKey,    // A key or '}', after '{'.
+    kNextKey,     // A key, after ',' in an object.
+    kColon,       // The ':' after a key.
+    kNext,        // ',' or the end of the container, after a value.
+    kEnd,         // Nothing but whitespace, after the top level value.
+    kInString,    // Inside of a key or string.
+    kInNumber,
+    kLiteral,     // Inside of true, false or null.
+    kError
+  };
+
+  enum NumberState {
+    kNumberMinus,
+    kNumberZero,
+    kNumberInteger,
+    kNumberDot,
+    kNumberFraction,
+    kNumberExponent,
+    kNumberExponentSign,
+    kNumberExponentDigits
+  };
+
+  bool Fail(size_t index, int byte) {
+    state_ = kError;
+    error_position_ = position_ + index;
+    error_byte_ = byte;
+    return false;
+  }
+
+  void Push(TokenType type) {
+    Token token;
+    token.type = type;
+    token.escaped = false;
+    token.offset = 0;
+    token.length = 0;
+    token.number = 0;
+    tokens_.push_back(token);
+  }
+
+  void StartString(bool key) {
+    state_ = kInString;
+    key_ = key;
+    escape_ = 0;
+    escaped_ = false;
+    string_start_ = arena_.size();
+  }
+
+  void ValueDone() {
+    state_ = containers_.empty() ? kEnd : kNext;
+  }
+
+  bool StartValue(size_t index, uint8_t c);
+  bool ScanString(const uint8_t* data, size_t length, size_t* index);
+  bool ScanNumber(size_t* index, uint8_t c);
+  bool EndNumber(size_t index, int byte);
+
+  State state_;
+  bool key_;                // Whether the open string is a key.
+  int escape_;              // 1 after a backslash, 2 to 5 in a \u escape.
+  bool escaped_;
+  size_t string_start_;
+  std::vector<char> containers_;  // '{' and '[' of the open containers.
+  const char* literal_;     // The rest of true, false or null.
+  NumberState number_state_;
+  std::string number_;
+  std::vector<Token> tokens_;
+  std::string arena_;
+  uint64_t position_;       // Bytes before the current chunk.
+  uint64_t error_position_;
+  int error_byte_;          // -1 for the end of the input.
+};
+
+
+bool Scanner::StartValue(size_t index, uint8_t c) {
+  switch (c) {
+    case '{':
+      Push(kBeginObject);
+      containers_.push_back('{');
+      state_ = kFirstKey;
+      return true;
+    case '[':
+      Push(kBeginArray);
+      containers_.push_back('[');
+      state_ = kFirstValue;
+      return true;
+    case '"':
+      StartString(false);
+      return true;
+    case 't':
+      Push(kTrue);
+      literal_ = "rue";
+      state_ = kLiteral;
+      return true;
+    case 'f':
+      Push(kFalse);
+      literal_ = "alse";
+      state_ = kLiteral;
+      return true;
+    case 'n':
+      Push(kNull);
+      literal_ = "ull";
+      state_ = kLiteral;
+      return true;
+    case '-':
+      number_.assign(1, '-');
+      number_state_ = kNumberMinus;
+      state_ = kInNumber;
+      return true;
+    default:
+      if (!IsDigit(c))
+        return Fail(index, c);
+      number_.assign(1, c);
+      number_state_ = c == '0' ? kNumberZero : kNumberInteger;
+      state_ = kInNumber;
+      return true;
+  }
+}
+
+
+// Consumes the bytes of a string from data[*index], up to the end of the
+// chunk or the closing quote.
+bool Scanner::ScanString(const uint8_t* data, size_t length, size_t* index) {
+  size_t i = *index;
+  while (i < length && state_ == kInString) {
+    const uint8_t c = data[i];
+    if (escape_ == 0) {
+      // Copies the run of plain characters at once.
+      size_t end = i;
+      while (end < length && data[end] != '"' && data[end] != '\\' &&
+             data[end] >= 0x20) {
+        end++;
+      }
+      arena_.append(reinterpret_cast<const char*>(data + i), end - i);
+      i = end;
+      if (i == length)
+        break;
+      if (data[i] == '"') {
+        Push(key_ ? kKey : kString);
+        Token& token = tokens_.back();
+        token.escaped = escaped_;
+        token.offset = string_start_;
+        token.length = arena_.size() - string_start_;
+        if (key_)
+          state_ = kColon;
+        else
+          ValueDone();
+      } else if (data[i] == '\\') {
+        arena_.push_back('\\');
+        escape_ = 1;
+        escaped_ = true;
+      } else {
+        return Fail(i, data[i]);
+      }
+    } else if (escape_ == 1) {
+      if (c == 'u') {
+        escape_ = 2;
+      } else if (c == '"' || c == '\\' || c == '/' || c == 'b' ||
+                 c == 'f' || c == 'n' || c == 'r' || c == 't') {
+        escape_ = 0;
+      } else {
+        return Fail(i, c);
+      }
+      arena_.push_back(c);
+    } else {
+      if (HexValue(c) < 0)
+        return Fail(i, c);
+      arena_.push_back(c);
+      escape_ = escape_ == 5 ? 0 : escape_ + 1;
+    }
+    i++;
+  }
+  *index = i;
+  return true;
+}
+
+
+// Consumes the byte `c` at *index if it continues the number, or ends the
+// number before it otherwise.
+bool Scanner::ScanNumber(size_t* index, uint8_t c) {
+  bool more = true;
+  switch (number_state_) {
+    case kNumberMinus:
+      if (IsDigit(c))
+        number_state_ = c == '0' ? kNumberZero : kNumberInteger;
+      else
+        more = false;
+      break;
+    case kNumberZero:
+    case kNumberInteger:
+    case kNumberFraction:
+      if (IsDigit(c) && number_state_ != kNumberZero)
+        break;
+      if (c == '.' && number_state_ != kNumberFraction)
+        number_state_ = kNumberDot;
+      else if (c == 'e' || c == 'E')
+        number_state_ = kNumberExponent;
+      else
+        more = false;
+      break;
+    case kNumberDot:
+      if (IsDigit(c))
+        number_state_ = kNumberFraction;
+      else
+        more = false;
+      break;
+    case kNumberExponent:
+      if (c == '+' || c == '-')
+        number_state_ = kNumberExponentSign;
+      else if (IsDigit(c))
+        number_state_ = kNumberExponentDigits;
+      else
+        more = false;
+      break;
+    case kNumberExponentSign:
+    case kNumberExponentDigits:
+      if (IsDigit(c))
+        number_state_ = kNumberExponentDigits;
+      else
+        more = false;
+      break;
+  }
+  if (!more)
+    return EndNumber(*index, c);
+  number_.push_back(c);
+  *index += 1;
+  return true;
+}
+
+
+// Ends a number at the byte at `index`, or at the end of the input when
+// `byte` is -1.
+bool Scanner::EndNumber(size_t index, int byte) {
+  if (number_state_ != kNumberZero &&
+      number_state_ != kNumberInteger &&
+      number_state_ != kNumberFraction &&
+      number_state_ != kNumberExponentDigits) {
+    return Fail(index, byte);
+  }
+
+  Push(kNumber);
+  Token& token = tokens_.back();
+  // Integers that fit into the 53 bits of a double are exact either way.
+  const size_t digits = number_.size() - (number_[0] == '-');
+  if (number_state_ <= kNumberInteger && digits <= 15) {
+    int64_t value = 0;
+    for (size_t i = number_.size() - digits; i < number_.size(); i++)
+      value = value * 10 + (number_[i] - '0');
+    token.number = number_[0] == '-' ? -static_cast<double>(value) : value;
+  } else {
+    token.number = strtod(number_.c_str(), nullptr);
+  }
+  ValueDone();
+  return true;
+}
+
+
+bool Scanner::Scan(const uint8_t* data, size_t length) {
+  if (state_ == kError)
+    return false;
+
+  size_t i = 0;
+  while (i < length) {
+    const uint8_t c = data[i];
+    switch (state_) {
+      case kValue:
+        if (!IsWhitespace(c) && !StartValue(i, c))
+          return false;
+        i++;
+        break;
+
+      case kFirstValue:
+        if (c == ']') {
+          containers_.pop_back();
+          Push(kEndArray);
+          ValueDone();
+        } else if (!IsWhitespace(c) && !StartValue(i, c)) {
+          return false;
+        }
+        i++;
+        break;
+
+      case kFirstKey:
+      case kNextKey:
+        if (c == '"') {
+          StartString(true);
+        } else if (c == '}' && state_ == kFirstKey) {
+          containers_.pop_back();
+          Push(kEndObject);
+          ValueDone();
+        } else if (!IsWhitespace(c)) {
+          return Fail(i, c);
+        }
+        i++;
+        break;
+
+      case kColon:
+        if (c == ':')
+          state_ = kValue;
+        else if (!IsWhitespace(c))
+          return Fail(i, c);
+        i++;
+        break;
+
+      case kNext:
+        if (c == ',') {
+          state_ = containers_.back() == '{' ? kNextKey : kValue;
+        } else if (c == '}' || c == ']') {
+          if (containers_.back() != (c == '}' ? '{' : '['))
+            return Fail(i, c);
+          containers_.pop_back();
+          Push(c == '}' ? kEndObject : kEndArray);
+          ValueDone();
+        } else if (!IsWhitespace(c)) {
+          return Fail(i, c);
+        }
+        i++;
+        break;
+
+      case kEnd:
+        if (!IsWhitespace(c))
+          return Fail(i, c);
+        i++;
+        break;
+
+      case kInString:
+        if (!ScanString(data, length, &i))
+          return false;
+        break;
+
+      case kInNumber:
+        // The byte after the number is looked at again in the next state.
+        if (!ScanNumber(&i, c))
+          return false;
+        break;
+
+      case kLiteral:
+        if (c != static_cast<uint8_t>(*literal_))
+          return Fail(i, c);
+        if (*++literal_ == '\0')
+          ValueDone();
+        i++;
+        break;
+
+      case kError:
+        UNREACHABLE();
+    }
+  }
+
+  position_ += length;
+  return true;
+}
+
+
+bool Scanner::Finish() {
+  if (state_ == kError)
+    return false;
+  if (state_ == kInNumber && !EndNumber(0, -1))
+    return false;
+  if (state_ != kEnd)
+    return Fail(0, -1);
+  return true;
+}
+
+
+class JSONParser : public AsyncWrap {
+ public:
+  static void Initialize(Environment* env, Local<Object> target) {
+    Local<FunctionTemplate> t = env->NewFunctionTemplate(New);
+    t->InstanceTemplate()->SetInternalFieldCount(1);
+    t->SetClassName(FIXED_ONE_BYTE_STRING(env->isolate(), "JSONParser"));
+    env->SetProtoMethod(t, "push", Push);
+    env->SetProtoMethod(t, "pushAsync", PushAsync);
+    env->SetProtoMethod(t, "finish", Finish);
+    env->SetProtoMethod(t, "getValue", GetValue);
+    target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "JSONParser"),
+                t->GetFunction());
+  }
+
+  ~JSONParser() override {
+    CHECK_EQ(busy_, false);
+    stack_.Reset();
+    value_.Reset();
+  }
+
+  size_t self_size() const override { return sizeof(*this); }
+
+ private:
+  // Tokens that are built in one HandleScope.
+  static const size_t kBatchSize = 1024;
+
+  JSONParser(Environment* env, Local<Object> wrap)
+      : AsyncWrap(env, wrap, AsyncWrap::PROVIDER_JSONPARSER),
+        busy_(false),
+        string_error_(false),
+        data_(nullptr),
+        length_(0) {
+    MakeWeak<JSONParser>(this);
+  }
+
+  // The error of a parser that has failed.
+  Local<Value> Error() {
+    if (string_error_) {
+      return Exception::RangeError(
+          FIXED_ONE_BYTE_STRING(env()->isolate(), "Invalid string length"));
+    }
+    const std::string message = scanner_.ErrorMessage();
+    return Exception::SyntaxError(
+        OneByteString(env()->isolate(), message.data(), message.size()));
+  }
+
+  MaybeLocal<String> MakeString(const Token& token);
+  bool BuildBatch(size_t begin, size_t end);
+  bool Build();
+
+  static void New(const FunctionCallbackInfo<Value>& args) {
+    CHECK(args.IsConstructCall());
+    new JSONParser(Environment::GetCurrent(args), args.This());
+  }
+
+  // push(buffer) scans and builds a chunk.  Returns the error if the input
+  // is not valid.
+  static void Push(const FunctionCallbackInfo<Value>& args) {
+    JSONParser* parser = Unwrap<JSONParser>(args.Holder());
+    CHECK(Buffer::HasInstance(args[0]));
+    CHECK_EQ(parser->busy_, false);
+    const uint8_t* data =
+        reinterpret_cast<const uint8_t*>(Buffer::Data(args[0]));
+    if (parser->string_error_ ||
+        !parser->scanner_.Scan(data, Buffer::Length(args[0])) ||
+        !parser->Build()) {
+      args.GetReturnValue().Set(parser->Error());
+    }
+  }
+
+  // pushAsync(buffer) scans a chunk on the threadpool and builds it when
+  // done, then calls .oncomplete(err).  The caller keeps the buffer alive.
+  static void PushAsync(const FunctionCallbackInfo<Value>& args) {
+    JSONParser* parser = Unwrap<JSONParser>(args.Holder());
+    CHECK(Buffer::HasInstance(args[0]));
+    CHECK_EQ(parser->busy_, false);
+    parser->busy_ = true;
+    parser->data_ = reinterpret_cast<const uint8_t*>(Buffer::Data(args[0]));
+    parser->length_ = Buffer::Length(args[0]);
+    parser->ClearWeak();
+    CHECK_EQ(0, uv_queue_work(parser->env()->event_loop(),
+                              &parser->work_req_,
+                              Work,
+                              After));
+  }
+
+  static void Work(uv_work_t* work_req) {
+    JSONParser* parser = ContainerOf(&JSONParser::work_req_, work_req);
+    if (!parser->string_error_)
+      parser->scanner_.Scan(parser->data_, parser->length_);
+  }
+
+  static void After(uv_work_t* work_req, int status) {
+    CHECK_EQ(status, 0);
+    JSONParser* parser = ContainerOf(&JSONParser::work_req_, work_req);
+    Environment* env = parser->env();
+    HandleScope handle_scope(env->isolate());
+    Context::Scope context_scope(env->context());
+
+    parser->busy_ = false;
+    parser->data_ = nullptr;
+    parser->length_ = 0;
+    parser->MakeWeak<JSONParser>(parser);
+
+    Local<Value> err = Null(env->isolate());
+    if (parser->string_error_ || parser->scanner_.failed() || !parser->Build())
+      err = parser->Error();
+    parser->MakeCallback(env->oncomplete_string(), 1, &err);
+  }
+
+  // finish() ends the input.  Returns the error if it is not a single
+  // complete value.
+  static void Finish(const FunctionCallbackInfo<Value>& args) {
+    JSONParser* parser = Unwrap<JSONParser>(args.Holder());
+    CHECK_EQ(parser->busy_, false);
+    if (parser->string_error_ ||
+        !parser->scanner_.Finish() ||
+        !parser->Build()) {
+      args.GetReturnValue().Set(parser->Error());
+    }
+  }
+
+  static void GetValue(const FunctionCallbackInfo<Value>& args) {
+    JSONParser* parser = Unwrap<JSONParser>(args.Holder());
+    if (!parser->value_.IsEmpty())
+      args.GetReturnValue().Set(parser->value_);
+  }
+
+  uv_work_t work_req_;
+  Scanner scanner_;
+  // The open containers, outermost first, each followed by the key of its
+  // next value for objects or undefined for arrays.
+  Persistent<Array> stack_;
+  std::vector<uint32_t> indexes_;  // The next index of each open container.
+  Persistent<Value> value_;
+  bool busy_;
+  bool string_error_;
+  const uint8_t* data_;
+  size_t length_;
+};
+
+
+MaybeLocal<String> JSONParser::MakeString(const Token& token) {
+  Isolate* isolate = env()->isolate();
+  const char* data = scanner_.arena() + token.offset;
+  const size_t length = token.length;
+  if (length > static_cast<size_t>(String::kMaxLength))
+    return MaybeLocal<String>();
+  if (!token.escaped) {
+    return String::NewFromUtf8(isolate, data, NewStringType::kNormal,
+                               static_cast<int>(length));
+  }
+
+  // ASCII characters and escapes are gathered as UTF-16, runs of other
+  // characters are left to V8's UTF-8 decoder.  The scanner has checked the
+  // escapes.
+  Local<String> result = String::Empty(isolate);
+  std::vector<uint16_t> units;
+  size_t i = 0;
+  for (;;) {
+    while (i < length && static_cast<uint8_t>(data[i]) < 0x80) {
+      if (data[i] != '\\') {
+        units.push_back(data[i]);
+        i += 1;
+        continue;
+      }
+      uint16_t unit;
+      switch (data[i + 1]) {
+        case 'b': unit = '\b'; break;
+        case 'f': unit = '\f'; break;
+        case 'n': unit = '\n'; break;
+        case 'r': unit = '\r'; break;
+        case 't': unit = '\t'; break;
+        case 'u':
+          unit = HexValue(data[i + 2]) << 12 | HexValue(data[i + 3]) << 8 |
+                 HexValue(data[i + 4]) << 4 | HexValue(data[i + 5]);
+          i += 4;
+          break;
+        default: unit = data[i + 1]; break;
+      }
+      units.push_back(unit);
+      i += 2;
+    }
+
+    if (!units.empty()) {
+      Local<String> part;
+      if (!String::NewFromTwoByte(isolate, units.data(),
+                                  NewStringType::kNormal,
+                                  static_cast<int>(units.size()))
+               .ToLocal(&part)) {
+        return MaybeLocal<String>();
+      }
+      result = String::Concat(result, part);
+      units.clear();
+    }
+    if (i == length)
+      return result;
+
+    size_t end = i;
+    while (end < length && static_cast<uint8_t>(data[end]) >= 0x80)
+      end++;
+    Local<String> part;
+    if (!String::NewFromUtf8(isolate, data + i, NewStringType::kNormal,
+                             static_cast<int>(end - i)).ToLocal(&part)) {
+      return MaybeLocal<String>();
+    }
+    result = String::Concat(result, part);
+    i = end;
+  }
+}
+
+
+// Builds tokens [begin, end).  Returns false if a string is too long.
+bool JSONParser::BuildBatch(size_t begin, size_t end) {
+  Isolate* isolate = env()->isolate();
+  Local<Context> context = env()->context();
+  const std::vector<Token>& tokens = scanner_.tokens();
+
+  std::vector<Local<Object>> containers;
+  std::vector<Local<Value>> keys;
+  if (!stack_.IsEmpty()) {
+    Local<Array> stack = PersistentToLocal(isolate, stack_);
+    for (uint32_t i = 0; i < stack->Length(); i += 2) {
+      containers.push_back(stack->Get(i).As<Object>());
+      keys.push_back(stack->Get(i + 1));
+    }
+  }
+
+  for (size_t i = begin; i < end; i++) {
+    const Token& token = tokens[i];
+    Local<Value> value;
+    switch (token.type) {
+      case kBeginObject:
+        value = Object::New(isolate);
+        break;
+      case kBeginArray:
+        value = Array::New(isolate);
+        break;
+      case kEndObject:
+      case kEndArray:
+        containers.pop_back();
+        keys.pop_back();
+        indexes_.pop_back();
+        continue;
+      case kKey:
+      case kString: {
+        Local<String> string;
+        if (!MakeString(token).ToLocal(&string))
+          return false;
+        if (token.type == kKey) {
+          keys.back() = string;
+          continue;
+        }
+        value = string;
+        break;
+      }
+      case kNumber:
+        value = Number::New(isolate, token.number);
+        break;
+      case kTrue:
+        value = True(isolate);
+        break;
+      case kFalse:
+        value = False(isolate);
+        break;
+      case kNull:
+        value = Null(isolate);
+        break;
+    }
+
+    // CreateDataProperty() does not call the __proto__ setter, as in
+    // JSON.parse().
+    if (containers.empty()) {
+      value_.Reset(isolate, value);
+    } else if (keys.back()->IsString()) {
+      containers.back()->CreateDataProperty(
+          context, keys.back().As<String>(), value).FromJust();
+    } else {
+      containers.back()->CreateDataProperty(
+          context, indexes_.back()++, value).FromJust();
+    }
+
+    if (token.type == kBeginObject) {
+      containers.push_back(value.As<Object>());
+      keys.push_back(String::Empty(isolate));
+      indexes_.push_back(0);
+    } else if (token.type == kBeginArray) {
+      containers.push_back(value.As<Object>());
+      keys.push_back(Undefined(isolate));
+      indexes_.push_back(0);
+    }
+  }
+
+  if (containers.empty()) {
+    stack_.Reset();
+  } else {
+    Local<Array> stack = Array::New(isolate, containers.size() * 2);
+    for (uint32_t i = 0; i < containers.size(); i++) {
+      stack->Set(i * 2, containers[i]);
+      stack->Set(i * 2 + 1, keys[i]);
+    }
+    stack_.Reset(isolate, stack);
+  }
+  return true;
+}
+
+
+// Turns the scanned tokens into values.  Returns false if a string is too
+// long for V8, the parser is of no use after that.
+bool JSONParser::Build() {
+  const size_t count = scanner_.tokens().size();
+  for (size_t begin = 0; begin < count; begin += kBatchSize) {
+    HandleScope scope(env()->isolate());
+    const size_t end = begin + kBatchSize < count ? begin + kBatchSize : count;
+    if (!BuildBatch(begin, end)) {
+      string_error_ = true;
+      stack_.Reset();
+      value_.Reset();
+      break;
+    }
+  }
+  scanner_.Clear();
+  return !string_error_;
+}
+
+
+void Initialize(Local<Object> target,
+                Local<Value> unused,
+                Local<Context> context) {
+  Environment* env = Environment::GetCurrent(context);
+  JSONParser::Initialize(env, target);
+}
+
+}  // namespace json_parser
+}  // namespace node
+
+NODE_MODULE_CONTEXT_AWARE_BUILTIN(json_parser, node::json_parser::Initialize)
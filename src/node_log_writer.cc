@@ -0,0 +1,368 @@
+#include "node.h"
+#include "node_buffer.h"
+#include "node_internals.h"
+#include "base-object.h"
+#include "base-object-inl.h"
+#include "env.h"
+#include "env-inl.h"
+#include "util.h"
+#include "util-inl.h"
+#include "uv.h"
+#include "v8.h"
+
+#include <errno.h>
+#include <stdint.h>
+#include <string.h>
+
+#ifndef _WIN32
+# include <poll.h>
+# include <sys/uio.h>
+# include <unistd.h>
+#endif
+
+namespace node {
+namespace logwriter {
+
+using v8::Context;
+using v8::FunctionCallbackInfo;
+using v8::FunctionTemplate;
+using v8::Integer;
+using v8::Local;
+using v8::Number;
+using v8::Object;
+using v8::Value;
+
+static const size_t kMinCapacity = 4096;
+static const size_t kMaxCapacity = 1 << 30;
+
+
+// Writes to a file descriptor from a thread of its own.  write() copies the
+// data into a ring buffer of a fixed size and returns, the thread writes
+// everything that has accumulated with one writev() at a time.  A write
+// that does not fit into the free space is dropped as a whole and counted,
+// so the loop never waits for a slow reader and memory use stays bounded.
+// Write errors are counted too, and the data that failed is discarded.
+class LogWriter : public BaseObject {
+ public:
+  ~LogWriter() override {
+    Stop();
+    uv_cond_destroy(&flushed_cond_);
+    uv_cond_destroy(&data_cond_);
+    uv_mutex_destroy(&mutex_);
+    delete[] data_;
+  }
+
+  static void Initialize(Environment* env, Local<Object> target);
+
+ private:
+  LogWriter(Environment* env,
+            Local<Object> wrap,
+            int fd,
+            size_t capacity)
+      : BaseObject(env, wrap),
+        fd_(fd),
+        data_(new char[capacity]),
+        capacity_(capacity),
+        start_(0),
+        length_(0),
+        writing_(0),
+        dropped_(0),
+        dropped_bytes_(0),
+        errors_(0),
+        last_error_(0),
+        stopping_(false),
+        running_(false) {
+    MakeWeak<LogWriter>(this);
+    CHECK_EQ(0, uv_mutex_init(&mutex_));
+    CHECK_EQ(0, uv_cond_init(&data_cond_));
+    CHECK_EQ(0, uv_cond_init(&flushed_cond_));
+  }
+
+  static void New(const FunctionCallbackInfo<Value>& args);
+  static void Write(const FunctionCallbackInfo<Value>& args);
+  static void Flush(const FunctionCallbackInfo<Value>& args);
+  static void Close(const FunctionCallbackInfo<Value>& args);
+  static void GetStats(const FunctionCallbackInfo<Value>& args);
+  static void Run(void* arg);
+
+  bool Push(const char* data, size_t length);
+  void WaitFlushed();
+  void Stop();
+  // Writes the |length| bytes at |start| and returns 0 or an error code,
+  // without the lock.
+  int WriteOut(size_t start, size_t length);
+
+  const int fd_;
+  char* const data_;
+  const size_t capacity_;
+
+  // Guard everything below.  The thread owns [start_, start_ + writing_)
+  // while it writes, the bytes after it up to length_ are still queued.
+  uv_mutex_t mutex_;
+  uv_cond_t data_cond_;
+  uv_cond_t flushed_cond_;
+  size_t start_;
+  size_t length_;
+  size_t writing_;
+  double dropped_;
+  double dropped_bytes_;
+  double errors_;
+  int last_error_;
+  bool stopping_;
+
+  bool running_;
+  uv_thread_t thread_;
+};
+
+
+void LogWriter::Initialize(Environment* env, Local<Object> target) {
+  Local<FunctionTemplate> t = env->NewFunctionTemplate(New);
+  t->InstanceTemplate()->SetInternalFieldCount(1);
+
+  env->SetProtoMethod(t, "write", Write);
+  env->SetProtoMethod(t, "flush", Flush);
+  env->SetProtoMethod(t, "close", Close);
+  env->SetProtoMethod(t, "getStats", GetStats);
+
+  target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "LogWriter"),
+              t->GetFunction());
+}
+
+
+// new LogWriter(fd, capacity)
+void LogWriter::New(const FunctionCallbackInfo<Value>& args) {
+  CHECK(args.IsConstructCall());
+  CHECK(args[0]->IsInt32());
+  CHECK(args[1]->IsUint32());
+  Environment* env = Environment::GetCurrent(args);
+
+  size_t capacity = kMinCapacity;
+  while (capacity < args[1]->Uint32Value() && capacity < kMaxCapacity)
+    capacity *= 2;
+
+  LogWriter* writer =
+      new LogWriter(env, args.This(), args[0]->Int32Value(), capacity);
+  CHECK_EQ(0, uv_thread_create(&writer->thread_, Run, writer));
+  writer->running_ = true;
+}
+
+
+bool LogWriter::Push(const char* data, size_t length) {
+  uv_mutex_lock(&mutex_);
+  if (stopping_ || length > capacity_ - length_) {
+    dropped_ += 1;
+    dropped_bytes_ += length;
+    uv_mutex_unlock(&mutex_);
+    return false;
+  }
+
+  const size_t end = (start_ + length_) % capacity_;
+  const size_t first = length < capacity_ - end ? length : capacity_ - end;
+  memcpy(data_ + end, data, first);
+  memcpy(data_, data + first, length - first);
+  if (length_ == 0)
+    uv_cond_signal(&data_cond_);
+  length_ += length;
+  uv_mutex_unlock(&mutex_);
+  return true;
+}
+
+
+// write(chunk), where chunk is a string or a Buffer.  Returns false if it
+// was dropped.
+void LogWriter::Write(const FunctionCallbackInfo<Value>& args) {
+  LogWriter* writer = Unwrap<LogWriter>(args.Holder());
+  Environment* env = writer->env();
+
+  bool written;
+  if (Buffer::HasInstance(args[0])) {
+    written = writer->Push(Buffer::Data(args[0]), Buffer::Length(args[0]));
+  } else {
+    CHECK(args[0]->IsString());
+    Utf8Value chunk(env->isolate(), args[0]);
+    written = writer->Push(*chunk, chunk.length());
+  }
+  args.GetReturnValue().Set(written);
+}
+
+
+void LogWriter::WaitFlushed() {
+  uv_mutex_lock(&mutex_);
+  while (length_ > 0 && running_)
+    uv_cond_wait(&flushed_cond_, &mutex_);
+  uv_mutex_unlock(&mutex_);
+}
+
+
+// flush() waits until everything that was written so far is written out.
+void LogWriter::Flush(const FunctionCallbackInfo<Value>& args) {
+  Unwrap<LogWriter>(args.Holder())->WaitFlushed();
+}
+
+
+void LogWriter::Stop() {
+  if (!running_)
+    return;
+  uv_mutex_lock(&mutex_);
+  stopping_ = true;
+  uv_cond_signal(&data_cond_);
+  uv_mutex_unlock(&mutex_);
+  CHECK_EQ(0, uv_thread_join(&thread_));
+  running_ = false;
+}
+
+
+// close() writes out what is left and stops the thread, later writes are
+// dropped.
+void LogWriter::Close(const FunctionCallbackInfo<Value>& args) {
+  Unwrap<LogWriter>(args.Holder())->Stop();
+}
+
+
+// getStats(array) stores [dropped writes, dropped bytes, write errors,
+// last error code] in |array|.
+void LogWriter::GetStats(const FunctionCallbackInfo<Value>& args) {
+  LogWriter* writer = Unwrap<LogWriter>(args.Holder());
+  Environment* env = writer->env();
+  CHECK(args[0]->IsArray());
+  Local<Object> stats = args[0].As<Object>();
+
+  uv_mutex_lock(&writer->mutex_);
+  const double dropped = writer->dropped_;
+  const double dropped_bytes = writer->dropped_bytes_;
+  const double errors = writer->errors_;
+  const int last_error = writer->last_error_;
+  uv_mutex_unlock(&writer->mutex_);
+
+  Local<Context> context = env->context();
+  stats->Set(context, 0, Number::New(env->isolate(), dropped)).FromJust();
+  stats->Set(context, 1, Number::New(env->isolate(), dropped_bytes))
+      .FromJust();
+  stats->Set(context, 2, Number::New(env->isolate(), errors)).FromJust();
+  stats->Set(context, 3, Integer::New(env->isolate(), last_error)).FromJust();
+}
+
+
+void LogWriter::Run(void* arg) {
+  LogWriter* writer = static_cast<LogWriter*>(arg);
+
+  uv_mutex_lock(&writer->mutex_);
+  for (;;) {
+    while (writer->length_ == 0 && !writer->stopping_)
+      uv_cond_wait(&writer->data_cond_, &writer->mutex_);
+    if (writer->length_ == 0)
+      break;
+
+    // Everything that accumulated goes out in one batch.
+    const size_t start = writer->start_;
+    writer->writing_ = writer->length_;
+    uv_mutex_unlock(&writer->mutex_);
+
+    const int err = writer->WriteOut(start, writer->writing_);
+
+    uv_mutex_lock(&writer->mutex_);
+    if (err != 0) {
+      writer->errors_ += 1;
+      writer->last_error_ = err;
+    }
+    writer->start_ = (start + writer->writing_) % writer->capacity_;
+    writer->length_ -= writer->writing_;
+    writer->writing_ = 0;
+    if (writer->length_ == 0)
+      uv_cond_broadcast(&writer->flushed_cond_);
+  }
+  // Wake up the flush() that may wait for a thread that is going away.
+  uv_cond_broadcast(&writer->flushed_cond_);
+  uv_mutex_unlock(&writer->mutex_);
+}
+
+
+#ifndef _WIN32
+
+int LogWriter::WriteOut(size_t start, size_t length) {
+  while (length > 0) {
+    struct iovec iov[2];
+    int iovcnt = 1;
+    const size_t first =
+        length < capacity_ - start ? length : capacity_ - start;
+    iov[0].iov_base = data_ + start;
+    iov[0].iov_len = first;
+    if (first < length) {
+      iov[1].iov_base = data_;
+      iov[1].iov_len = length - first;
+      iovcnt = 2;
+    }
+
+    const ssize_t n = writev(fd_, iov, iovcnt);
+    if (n == -1) {
+      if (errno == EINTR)
+        continue;
+      if (errno == EAGAIN || errno == EWOULDBLOCK) {
+        // stdout can be a non-blocking pipe.
+        struct pollfd pfd;
+        pfd.fd = fd_;
+        pfd.events = POLLOUT;
+        pfd.revents = 0;
+        if (poll(&pfd, 1, -1) == -1 && errno != EINTR)
+          return -errno;
+        continue;
+      }
+      return -errno;
+    }
+
+    start = (start + n) % capacity_;
+    length -= n;
+  }
+  return 0;
+}
+
+#else  // _WIN32
+
+int LogWriter::WriteOut(size_t start, size_t length) {
+  // The synchronous requests only need a loop to belong to.
+  uv_loop_t loop;
+  int err = uv_loop_init(&loop);
+  if (err != 0)
+    return err;
+
+  while (length > 0) {
+    uv_buf_t bufs[2];
+    unsigned int nbufs = 1;
+    const size_t first =
+        length < capacity_ - start ? length : capacity_ - start;
+    bufs[0] = uv_buf_init(data_ + start, first);
+    if (first < length) {
+      bufs[1] = uv_buf_init(data_, length - first);
+      nbufs = 2;
+    }
+
+    uv_fs_t req;
+    const int n = uv_fs_write(&loop, &req, fd_, bufs, nbufs, -1, nullptr);
+    uv_fs_req_cleanup(&req);
+    if (n < 0) {
+      err = n;
+      break;
+    }
+
+    start = (start + n) % capacity_;
+    length -= n;
+  }
+
+  uv_loop_close(&loop);
+  return err;
+}
+
+#endif  // _WIN32
+
+
+void Initialize(Local<Object> target,
+                Local<Value> unused,
+                Local<Context> context) {
+  Environment* env = Environment::GetCurrent(context);
+  LogWriter::Initialize(env, target);
+}
+
+}  // namespace logwriter
+}  // namespace node
+
+NODE_MODULE_CONTEXT_AWARE_BUILTIN(log_writer, node::logwriter::Initialize)
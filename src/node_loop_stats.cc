@@ -0,0 +1,266 @@
+#include "node.h"
+#include "node_loop_stats.h"
+#include "env.h"
+#include "env-inl.h"
+#include "util.h"
+#include "util-inl.h"
+#include "v8.h"
+
+#include <math.h>
+#include <string.h>
+
+namespace node {
+
+using v8::ArrayBuffer;
+using v8::Context;
+using v8::Float64Array;
+using v8::FunctionCallbackInfo;
+using v8::Local;
+using v8::Number;
+using v8::Object;
+using v8::Uint32;
+using v8::Value;
+
+static const double kNanosPerMilli = 1e6;
+static const double kMicrosPerMilli = 1e3;
+
+
+Histogram::Histogram() {
+  Reset();
+}
+
+
+void Histogram::Reset() {
+  count_ = 0;
+  min_ = 0;
+  max_ = 0;
+  sum_ = 0;
+  memset(counts_, 0, sizeof(counts_));
+}
+
+
+size_t Histogram::Index(uint64_t value) {
+  if (value < kSubBuckets)
+    return value;
+
+  unsigned int shift = 1;
+  while ((value >> shift) >= kSubBuckets)
+    shift++;
+  if (shift > kMaxShift)
+    return kBuckets - 1;
+
+  // The mantissa is in [kSubBuckets / 2, kSubBuckets).
+  const uint64_t mantissa = value >> shift;
+  return kSubBuckets + (shift - 1) * (kSubBuckets / 2) +
+         (mantissa - kSubBuckets / 2);
+}
+
+
+uint64_t Histogram::HighestEquivalent(size_t index) {
+  if (index < kSubBuckets)
+    return index;
+
+  const size_t offset = index - kSubBuckets;
+  const unsigned int shift = offset / (kSubBuckets / 2) + 1;
+  const uint64_t mantissa = offset % (kSubBuckets / 2) + kSubBuckets / 2;
+  return ((mantissa + 1) << shift) - 1;
+}
+
+
+void Histogram::Record(uint64_t value) {
+  if (count_ == 0 || value < min_)
+    min_ = value;
+  if (value > max_)
+    max_ = value;
+  count_ += 1;
+  sum_ += value;
+  counts_[Index(value)] += 1;
+}
+
+
+uint64_t Histogram::Percentile(double percentile) const {
+  if (count_ == 0)
+    return 0;
+
+  if (percentile > 100)
+    percentile = 100;
+  uint64_t target = static_cast<uint64_t>(ceil(percentile / 100 * count_));
+  if (target < 1)
+    target = 1;
+
+  uint64_t seen = 0;
+  for (size_t i = 0; i < kBuckets; i++) {
+    seen += counts_[i];
+    if (seen >= target) {
+      const uint64_t value = HighestEquivalent(i);
+      return value < max_ ? value : max_;
+    }
+  }
+
+  return max_;
+}
+
+
+LoopStats::LoopStats(Environment* env)
+    : loop_(env->event_loop()),
+      started_(false),
+      iterations_(0) {
+  memset(&metrics_, 0, sizeof(metrics_));
+  memset(fields_, 0, sizeof(fields_));
+
+  CHECK_EQ(0, uv_prepare_init(loop_, &prepare_));
+  uv_unref(reinterpret_cast<uv_handle_t*>(&prepare_));
+  prepare_.data = this;
+  env->RegisterHandleCleanup(reinterpret_cast<uv_handle_t*>(&prepare_),
+                             OnClose,
+                             nullptr);
+}
+
+
+LoopStats::~LoopStats() {
+  Stop();
+}
+
+
+void LoopStats::Start() {
+  if (started_)
+    return;
+  started_ = true;
+  CHECK_EQ(0, uv_loop_configure(loop_, UV_LOOP_METRICS, &metrics_));
+  iterations_ = 0;
+  if (!uv_is_closing(reinterpret_cast<uv_handle_t*>(&prepare_)))
+    CHECK_EQ(0, uv_prepare_start(&prepare_, OnPrepare));
+}
+
+
+void LoopStats::Stop() {
+  if (!started_)
+    return;
+  started_ = false;
+  // Keeps the numbers that were collected, but stops adding to them.
+  CHECK_EQ(0, uv_loop_configure(loop_, UV_LOOP_METRICS, nullptr));
+  uv_prepare_stop(&prepare_);
+}
+
+
+void LoopStats::Reset() {
+  histogram_.Reset();
+  if (started_)
+    CHECK_EQ(0, uv_loop_configure(loop_, UV_LOOP_METRICS, &metrics_));
+  else
+    memset(&metrics_, 0, sizeof(metrics_));
+  iterations_ = 0;
+}
+
+
+void LoopStats::Update() {
+  uint64_t busy = 0;
+  for (int i = 0; i < UV_LOOP_PHASE_MAX; i++)
+    busy += metrics_.phase_time[i];
+
+  fields_[kIterations] = static_cast<double>(metrics_.iterations);
+  fields_[kUtilization] =
+      busy + metrics_.idle_time == 0 ?
+          0 : static_cast<double>(busy) / (busy + metrics_.idle_time);
+  fields_[kIdleTime] = metrics_.idle_time / kNanosPerMilli;
+  fields_[kTimersTime] =
+      metrics_.phase_time[UV_LOOP_PHASE_TIMERS] / kNanosPerMilli;
+  fields_[kPendingTime] =
+      metrics_.phase_time[UV_LOOP_PHASE_PENDING] / kNanosPerMilli;
+  fields_[kIdlePhaseTime] =
+      metrics_.phase_time[UV_LOOP_PHASE_IDLE] / kNanosPerMilli;
+  fields_[kPrepareTime] =
+      metrics_.phase_time[UV_LOOP_PHASE_PREPARE] / kNanosPerMilli;
+  fields_[kPollTime] = metrics_.phase_time[UV_LOOP_PHASE_POLL] / kNanosPerMilli;
+  fields_[kCheckTime] =
+      metrics_.phase_time[UV_LOOP_PHASE_CHECK] / kNanosPerMilli;
+  fields_[kClosingTime] =
+      metrics_.phase_time[UV_LOOP_PHASE_CLOSING] / kNanosPerMilli;
+  fields_[kLatencyCount] = static_cast<double>(histogram_.count());
+  fields_[kLatencyMin] = histogram_.min() / kMicrosPerMilli;
+  fields_[kLatencyMax] = histogram_.max() / kMicrosPerMilli;
+  fields_[kLatencyMean] = histogram_.mean() / kMicrosPerMilli;
+}
+
+
+// Runs once per iteration, so it sees every iteration that completes.
+void LoopStats::OnPrepare(uv_prepare_t* handle) {
+  LoopStats* stats = static_cast<LoopStats*>(handle->data);
+  if (stats->iterations_ == stats->metrics_.iterations)
+    return;
+  stats->iterations_ = stats->metrics_.iterations;
+  stats->histogram_.Record(stats->metrics_.last_iteration_time / 1000);
+}
+
+
+void LoopStats::OnClose(Environment* env, uv_handle_t* handle, void* arg) {
+  handle->data = env;
+  uv_close(handle, [](uv_handle_t* handle) {
+    static_cast<Environment*>(handle->data)->FinishHandleCleanup(handle);
+  });
+}
+
+
+namespace loopstats {
+
+static void Start(const FunctionCallbackInfo<Value>& args) {
+  Environment::GetCurrent(args)->loop_stats()->Start();
+}
+
+
+static void Stop(const FunctionCallbackInfo<Value>& args) {
+  Environment::GetCurrent(args)->loop_stats()->Stop();
+}
+
+
+static void Update(const FunctionCallbackInfo<Value>& args) {
+  Environment::GetCurrent(args)->loop_stats()->Update();
+}
+
+
+static void Reset(const FunctionCallbackInfo<Value>& args) {
+  Environment::GetCurrent(args)->loop_stats()->Reset();
+}
+
+
+// Returns the iteration latency at a percentile, in milliseconds.
+static void Percentile(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  CHECK(args[0]->IsNumber());
+  const double percentile = args[0].As<Number>()->Value();
+  const uint64_t value = env->loop_stats()->histogram()->Percentile(percentile);
+  args.GetReturnValue().Set(value / kMicrosPerMilli);
+}
+
+
+void Initialize(Local<Object> target,
+                Local<Value> unused,
+                Local<Context> context) {
+  Environment* env = Environment::GetCurrent(context);
+  LoopStats* stats = env->loop_stats();
+
+  env->SetMethod(target, "start", Start);
+  env->SetMethod(target, "stop", Stop);
+  env->SetMethod(target, "update", Update);
+  env->SetMethod(target, "reset", Reset);
+  env->SetMethod(target, "percentile", Percentile);
+
+  double* const fields = stats->fields();
+  const int fields_count = stats->fields_count();
+  Local<ArrayBuffer> array_buffer =
+      ArrayBuffer::New(env->isolate(), fields, sizeof(*fields) * fields_count);
+  target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "fields"),
+              Float64Array::New(array_buffer, 0, fields_count));
+
+#define V(index, name)                                                        \
+  target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), #name),                   \
+              Uint32::NewFromUnsigned(env->isolate(), index));
+
+  LOOP_STATS_FIELDS(V)
+#undef V
+}
+
+}  // namespace loopstats
+}  // namespace node
+
+NODE_MODULE_CONTEXT_AWARE_BUILTIN(loop_stats, node::loopstats::Initialize)
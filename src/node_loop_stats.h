@@ -0,0 +1,112 @@
+#ifndef SRC_NODE_LOOP_STATS_H_
+#define SRC_NODE_LOOP_STATS_H_
+
+#include "util.h"
+#include "uv.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace node {
+
+class Environment;
+
+// A log-linear histogram in the manner of HdrHistogram.  Values below
+// kSubBuckets are counted exactly, larger values in buckets that are within
+// 1 / (kSubBuckets / 2) of each other.
+class Histogram {
+ public:
+  static const unsigned int kSubBucketBits = 7;
+  static const uint64_t kSubBuckets = 1 << kSubBucketBits;
+  static const unsigned int kMaxShift = 36;
+  static const size_t kBuckets =
+      kSubBuckets + kMaxShift * (kSubBuckets / 2);
+
+  Histogram();
+
+  void Record(uint64_t value);
+  void Reset();
+  // The highest value that is equivalent to the one at |percentile|, 0 when
+  // the histogram is empty.
+  uint64_t Percentile(double percentile) const;
+
+  inline uint64_t count() const { return count_; }
+  inline uint64_t min() const { return count_ == 0 ? 0 : min_; }
+  inline uint64_t max() const { return max_; }
+  inline double mean() const {
+    return count_ == 0 ? 0 : static_cast<double>(sum_) / count_;
+  }
+
+ private:
+  static size_t Index(uint64_t value);
+  static uint64_t HighestEquivalent(size_t index);
+
+  uint64_t count_;
+  uint64_t min_;
+  uint64_t max_;
+  uint64_t sum_;
+  uint64_t counts_[kBuckets];
+
+  DISALLOW_COPY_AND_ASSIGN(Histogram);
+};
+
+#define LOOP_STATS_FIELDS(V)                                                  \
+  V(0, kIterations)                                                           \
+  V(1, kUtilization)                                                          \
+  V(2, kIdleTime)                                                             \
+  V(3, kTimersTime)                                                           \
+  V(4, kPendingTime)                                                          \
+  V(5, kIdlePhaseTime)                                                        \
+  V(6, kPrepareTime)                                                          \
+  V(7, kPollTime)                                                             \
+  V(8, kCheckTime)                                                            \
+  V(9, kClosingTime)                                                          \
+  V(10, kLatencyCount)                                                        \
+  V(11, kLatencyMin)                                                          \
+  V(12, kLatencyMax)                                                          \
+  V(13, kLatencyMean)                                                         \
+
+// Collects the uv_loop_metrics_t of an Environment's loop while started and
+// records the busy time of every loop iteration in a histogram, from a
+// prepare handle.  Times are exposed in milliseconds.
+class LoopStats {
+ public:
+  enum Fields {
+#define V(index, name) name = index,
+    LOOP_STATS_FIELDS(V)
+#undef V
+    kFieldsCount
+  };
+
+  explicit LoopStats(Environment* env);
+  ~LoopStats();
+
+  void Start();
+  void Stop();
+  // Copies the current numbers into fields().
+  void Update();
+  // Clears the metrics and the histogram.
+  void Reset();
+
+  inline double* fields() { return fields_; }
+  inline int fields_count() const { return kFieldsCount; }
+  inline const Histogram* histogram() const { return &histogram_; }
+
+ private:
+  static void OnPrepare(uv_prepare_t* handle);
+  static void OnClose(Environment* env, uv_handle_t* handle, void* arg);
+
+  uv_loop_t* const loop_;
+  uv_prepare_t prepare_;
+  bool started_;
+  uint64_t iterations_;
+  uv_loop_metrics_t metrics_;
+  Histogram histogram_;
+  double fields_[kFieldsCount];
+
+  DISALLOW_COPY_AND_ASSIGN(LoopStats);
+};
+
+}  // namespace node
+
+#endif  // SRC_NODE_LOOP_STATS_H_
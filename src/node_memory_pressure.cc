@@ -0,0 +1,179 @@
+#include "node_memory_pressure.h"
+#include "node_dns_cache.h"
+#include "node_internals.h"
+#include "buffer_arena.h"
+#include "env.h"
+#include "env-inl.h"
+#include "slab_allocator.h"
+#include "util.h"
+#include "util-inl.h"
+#include "v8.h"
+
+#include <inttypes.h>
+#include <stdio.h>
+
+namespace node {
+
+using v8::Boolean;
+using v8::Context;
+using v8::Function;
+using v8::FunctionCallbackInfo;
+using v8::HandleScope;
+using v8::Local;
+using v8::Object;
+using v8::Value;
+
+// cgroup v2 and v1.  The limit of v2 reads "max" and the one of v1 a number
+// close to INT64_MAX when there is none.
+static const char* const kUsageFiles[] = {
+  "/sys/fs/cgroup/memory.current",
+  "/sys/fs/cgroup/memory/memory.usage_in_bytes",
+};
+static const char* const kLimitFiles[] = {
+  "/sys/fs/cgroup/memory.max",
+  "/sys/fs/cgroup/memory/memory.limit_in_bytes",
+};
+static const uint64_t kNoLimit = static_cast<uint64_t>(1) << 62;
+
+
+MemoryPressureMonitor::MemoryPressureMonitor(Environment* env)
+    : env_(env),
+      threshold_(0),
+      level_(kNone) {
+  CHECK_EQ(0, uv_timer_init(env->event_loop(), &timer_));
+  uv_unref(reinterpret_cast<uv_handle_t*>(&timer_));
+  env->RegisterHandleCleanup(reinterpret_cast<uv_handle_t*>(&timer_),
+                             OnClose,
+                             nullptr);
+}
+
+
+bool MemoryPressureMonitor::Start(uint64_t threshold_percent) {
+  uint64_t usage;
+  uint64_t limit;
+  if (!ReadUsage(&usage, &limit))
+    return false;
+  threshold_ = threshold_percent;
+  level_ = kNone;
+  CHECK_EQ(0, uv_timer_start(&timer_, OnTimer, 0, kInterval));
+  return true;
+}
+
+
+void MemoryPressureMonitor::Stop() {
+  uv_timer_stop(&timer_);
+}
+
+
+void MemoryPressureMonitor::OnTimer(uv_timer_t* timer) {
+  MemoryPressureMonitor* monitor =
+      ContainerOf(&MemoryPressureMonitor::timer_, timer);
+
+  uint64_t usage;
+  uint64_t limit;
+  if (!ReadUsage(&usage, &limit))
+    return;
+
+  const uint64_t percent = usage / (limit / 100 + 1);
+  Level level = kNone;
+  if (percent >= kCriticalPercent)
+    level = kCritical;
+  else if (percent >= monitor->threshold_)
+    level = kModerate;
+
+  // Only a rise is reported, the memory that is given back at one level is
+  // not going to be there again right away.
+  const bool rise = level > monitor->level_;
+  monitor->level_ = level;
+  if (rise)
+    Notify(monitor->env_, level);
+}
+
+
+void MemoryPressureMonitor::Notify(Environment* env, Level level) {
+  HandleScope handle_scope(env->isolate());
+  Context::Scope context_scope(env->context());
+
+  Local<Function> fn = env->memory_pressure_function();
+  if (fn.IsEmpty())
+    return Trim(env, level);
+
+  Local<Value> arg = Boolean::New(env->isolate(), level == kCritical);
+  MakeCallback(env, env->process_object().As<Value>(), fn, 1, &arg);
+}
+
+
+void MemoryPressureMonitor::Trim(Environment* env, Level level) {
+  env->bio_buffer_pool()->Clear();
+  env->req_storage_pool()->Clear();
+  env->read_slab_allocator()->Trim();
+  env->dns_cache()->Clear();
+  BufferArena::Trim();
+
+  // After the caches above, so that what they dropped is collected too.
+  // V8 5.0 has no MemoryPressureNotification(), this is the closest.
+  if (level == kCritical)
+    env->isolate()->LowMemoryNotification();
+}
+
+
+bool MemoryPressureMonitor::ReadUsage(uint64_t* usage, uint64_t* limit) {
+#ifdef __linux__
+  for (size_t i = 0; i < arraysize(kUsageFiles); i++) {
+    FILE* usage_file = fopen(kUsageFiles[i], "r");
+    if (usage_file == nullptr)
+      continue;
+    const bool have_usage = fscanf(usage_file, "%" SCNu64, usage) == 1;
+    fclose(usage_file);
+
+    FILE* limit_file = fopen(kLimitFiles[i], "r");
+    if (limit_file == nullptr)
+      return false;
+    const bool have_limit = fscanf(limit_file, "%" SCNu64, limit) == 1;
+    fclose(limit_file);
+
+    return have_usage && have_limit && *limit > 0 && *limit < kNoLimit;
+  }
+#endif  // __linux__
+  return false;
+}
+
+
+void MemoryPressureMonitor::OnClose(Environment* env,
+                                    uv_handle_t* handle,
+                                    void*) {
+  handle->data = env;
+  uv_close(handle, [](uv_handle_t* handle) {
+    static_cast<Environment*>(handle->data)->FinishHandleCleanup(handle);
+  });
+}
+
+
+static void Setup(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  CHECK(args[0]->IsFunction());
+  env->set_memory_pressure_function(args[0].As<Function>());
+}
+
+
+static void Trim(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  MemoryPressureMonitor::Trim(env,
+                              args[0]->IsTrue() ?
+                                  MemoryPressureMonitor::kCritical :
+                                  MemoryPressureMonitor::kModerate);
+}
+
+
+void InitMemoryPressure(Local<Object> target,
+                        Local<Value> unused,
+                        Local<Context> context,
+                        void* priv) {
+  Environment* env = Environment::GetCurrent(context);
+  env->SetMethod(target, "setup", Setup);
+  env->SetMethod(target, "trim", Trim);
+}
+
+}  // namespace node
+
+NODE_MODULE_CONTEXT_AWARE_BUILTIN(memory_pressure, node::InitMemoryPressure)
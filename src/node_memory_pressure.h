@@ -0,0 +1,59 @@
+#ifndef SRC_NODE_MEMORY_PRESSURE_H_
+#define SRC_NODE_MEMORY_PRESSURE_H_
+
+#include "util.h"
+#include "uv.h"
+
+#include <stdint.h>
+
+namespace node {
+
+class Environment;
+
+// Watches the memory usage of the cgroup that the process runs in against
+// the limit of the cgroup, for --memory-pressure-threshold.  A timer samples
+// the usage every kInterval milliseconds.  When it rises past the threshold
+// or past kCriticalPercent of the limit, Notify() lets the JS caches, the
+// native pools and V8 give memory back, once per level until the usage
+// drops below it again.  The timer is unref'd.
+class MemoryPressureMonitor {
+ public:
+  enum Level {
+    kNone,
+    kModerate,
+    kCritical
+  };
+
+  static const uint64_t kInterval = 1000;
+  static const uint64_t kCriticalPercent = 95;
+
+  explicit MemoryPressureMonitor(Environment* env);
+
+  // Returns false when the cgroup has no memory limit or there is no cgroup
+  // to read it from.
+  bool Start(uint64_t threshold_percent);
+  void Stop();
+
+  // Calls env->memory_pressure_function(), which trims the JS side and then
+  // calls Trim().  Trim() runs on its own before the function is set up.
+  static void Notify(Environment* env, Level level);
+  // Frees the memory that the native pools and caches of |env| retain.  A
+  // full garbage collection also runs at kCritical.
+  static void Trim(Environment* env, Level level);
+
+ private:
+  static void OnTimer(uv_timer_t* timer);
+  static void OnClose(Environment* env, uv_handle_t* handle, void* arg);
+  static bool ReadUsage(uint64_t* usage, uint64_t* limit);
+
+  Environment* const env_;
+  uv_timer_t timer_;
+  uint64_t threshold_;
+  Level level_;
+
+  DISALLOW_COPY_AND_ASSIGN(MemoryPressureMonitor);
+};
+
+}  // namespace node
+
+#endif  // SRC_NODE_MEMORY_PRESSURE_H_
@@ -5,6 +5,8 @@
 #include "string_bytes.h"
 
 #include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 #ifdef __MINGW32__
@@ -28,8 +30,10 @@ namespace node {
 namespace os {
 
 using v8::Array;
+using v8::ArrayBuffer;
 using v8::Boolean;
 using v8::Context;
+using v8::Float64Array;
 using v8::FunctionCallbackInfo;
 using v8::Integer;
 using v8::Local;
@@ -150,6 +154,99 @@ static void GetCPUInfo(const FunctionCallbackInfo<Value>& args) {
 }
 
 
+// The fields that cpuTimes() has per CPU, in the units of os.cpus().
+enum CPUTimesField {
+  kCPUTimesUser,
+  kCPUTimesNice,
+  kCPUTimesSys,
+  kCPUTimesIdle,
+  kCPUTimesIrq,
+  kCPUTimesFieldCount
+};
+
+
+#ifdef __linux__
+// Reads the per-CPU lines at the start of /proc/stat, and nothing else of it.
+// Returns the number of CPUs, of which the first `max` are written to
+// `fields`, or a negative errno.
+static int ReadProcStatTimes(double* fields, size_t max) {
+  FILE* fp = fopen("/proc/stat", "r");
+  if (fp == nullptr)
+    return -errno;
+
+  // Scaled the way uv_cpu_info() does it, for numbers that compare with
+  // os.cpus().
+  const double clock_ticks = sysconf(_SC_CLK_TCK);
+  char line[512];
+  int count = 0;
+  // The first line is the total of all CPUs.
+  if (fgets(line, sizeof(line), fp) != nullptr) {
+    while (fgets(line, sizeof(line), fp) != nullptr) {
+      if (strncmp(line, "cpu", 3) != 0)
+        break;
+      // "cpu<n> user nice system idle iowait irq ...", in clock ticks.
+      char* p = line + 3;
+      strtoul(p, &p, 10);
+      double ticks[6];
+      for (size_t i = 0; i < arraysize(ticks); i++)
+        ticks[i] = strtoul(p, &p, 10);
+      if (static_cast<size_t>(count) < max) {
+        double* cpu = fields + count * kCPUTimesFieldCount;
+        cpu[kCPUTimesUser] = clock_ticks * ticks[0];
+        cpu[kCPUTimesNice] = clock_ticks * ticks[1];
+        cpu[kCPUTimesSys] = clock_ticks * ticks[2];
+        cpu[kCPUTimesIdle] = clock_ticks * ticks[3];
+        cpu[kCPUTimesIrq] = clock_ticks * ticks[5];
+      }
+      count++;
+    }
+  }
+
+  fclose(fp);
+  return count;
+}
+#endif  // __linux__
+
+
+// Fills the Float64Array with the times of as many CPUs as fit, and returns
+// the number of CPUs or a negative errno.  Unlike GetCPUInfo(), no object is
+// created, and on Linux neither the model nor the speed is read.
+static void GetCPUTimes(const FunctionCallbackInfo<Value>& args) {
+  CHECK(args[0]->IsFloat64Array());
+  Local<Float64Array> array = args[0].As<Float64Array>();
+  Local<ArrayBuffer> ab = array->Buffer();
+  double* fields = reinterpret_cast<double*>(
+      static_cast<char*>(ab->GetContents().Data()) + array->ByteOffset());
+  const size_t max = array->Length() / kCPUTimesFieldCount;
+
+#ifdef __linux__
+  int count = ReadProcStatTimes(fields, max);
+  if (count > 0)
+    return args.GetReturnValue().Set(count);
+  // No /proc, try libuv.
+#endif  // __linux__
+
+  uv_cpu_info_t* cpu_infos;
+  int cpu_count;
+  int err = uv_cpu_info(&cpu_infos, &cpu_count);
+  if (err)
+    return args.GetReturnValue().Set(err);
+
+  for (int i = 0; i < cpu_count && static_cast<size_t>(i) < max; i++) {
+    const uv_cpu_info_t* ci = cpu_infos + i;
+    double* cpu = fields + i * kCPUTimesFieldCount;
+    cpu[kCPUTimesUser] = ci->cpu_times.user;
+    cpu[kCPUTimesNice] = ci->cpu_times.nice;
+    cpu[kCPUTimesSys] = ci->cpu_times.sys;
+    cpu[kCPUTimesIdle] = ci->cpu_times.idle;
+    cpu[kCPUTimesIrq] = ci->cpu_times.irq;
+  }
+
+  uv_free_cpu_info(cpu_infos, cpu_count);
+  args.GetReturnValue().Set(cpu_count);
+}
+
+
 static void GetFreeMemory(const FunctionCallbackInfo<Value>& args) {
   double amount = uv_get_free_memory();
   if (amount < 0)
@@ -368,6 +465,7 @@ void Initialize(Local<Object> target,
   env->SetMethod(target, "getTotalMem", GetTotalMemory);
   env->SetMethod(target, "getFreeMem", GetFreeMemory);
   env->SetMethod(target, "getCPUs", GetCPUInfo);
+  env->SetMethod(target, "getCPUTimes", GetCPUTimes);
   env->SetMethod(target, "getOSType", GetOSType);
   env->SetMethod(target, "getOSRelease", GetOSRelease);
   env->SetMethod(target, "getInterfaceAddresses", GetInterfaceAddresses);
@@ -0,0 +1,149 @@
+#include "node.h"
+#include "node_internals.h"
+
+#include "env.h"
+#include "env-inl.h"
+#include "util.h"
+#include "util-inl.h"
+#include "v8.h"
+
+#include <stdint.h>
+
+#include <vector>
+
+// Native version of normalizeStringPosix() in lib/path.js, which
+// path.posix.normalize() and path.posix.resolve() use for long paths.  It
+// appends to one buffer instead of concatenating a string per segment.
+
+namespace node {
+namespace path {
+
+using v8::Context;
+using v8::FunctionCallbackInfo;
+using v8::Local;
+using v8::NewStringType;
+using v8::Object;
+using v8::String;
+using v8::Value;
+
+
+// Resolves the . and .. segments of `path` exactly like
+// normalizeStringPosix() does.
+template <typename T>
+static void NormalizeString(const T* path,
+                            size_t length,
+                            bool allow_above_root,
+                            std::vector<T>* res) {
+  ssize_t last_slash = -1;
+  int dots = 0;
+  uint32_t code = 0;
+  for (size_t i = 0; i <= length; ++i) {
+    if (i < length)
+      code = path[i];
+    else if (code == '/')
+      break;
+    else
+      code = '/';
+
+    if (code != '/') {
+      if (code == '.' && dots != -1)
+        ++dots;
+      else
+        dots = -1;
+      continue;
+    }
+
+    const ssize_t index = i;
+    if (last_slash == index - 1 || dots == 1) {
+      // NOOP
+    } else if (dots == 2) {
+      const size_t size = res->size();
+      if (size < 2 || (*res)[size - 1] != '.' || (*res)[size - 2] != '.') {
+        if (size > 2) {
+          const ssize_t start = size - 1;
+          ssize_t j = start;
+          for (; j >= 0; --j) {
+            if ((*res)[j] == '/')
+              break;
+          }
+          if (j != start) {
+            res->resize(j == -1 ? 0 : j);
+            last_slash = index;
+            dots = 0;
+            continue;
+          }
+        } else if (size == 2 || size == 1) {
+          res->clear();
+          last_slash = index;
+          dots = 0;
+          continue;
+        }
+      }
+      if (allow_above_root) {
+        if (!res->empty())
+          res->push_back('/');
+        res->push_back('.');
+        res->push_back('.');
+      }
+    } else {
+      if (!res->empty())
+        res->push_back('/');
+      res->insert(res->end(), path + last_slash + 1, path + i);
+    }
+    last_slash = index;
+    dots = 0;
+  }
+}
+
+
+// normalizeStringPosix(path, allowAboveRoot)
+static void NormalizeStringPosix(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  CHECK(args[0]->IsString());
+  Local<String> input = args[0].As<String>();
+  const bool allow_above_root = args[1]->IsTrue();
+
+  Local<String> result = String::Empty(env->isolate());
+  if (input->IsOneByte()) {
+    MaybeStackBuffer<uint8_t> data;
+    data.AllocateSufficientStorage(input->Length() + 1);
+    input->WriteOneByte(*data, 0, input->Length(),
+                        String::NO_NULL_TERMINATION);
+    std::vector<uint8_t> res;
+    res.reserve(input->Length());
+    NormalizeString(*data, input->Length(), allow_above_root, &res);
+    if (!res.empty() &&
+        !String::NewFromOneByte(env->isolate(),
+                                res.data(),
+                                NewStringType::kNormal,
+                                res.size()).ToLocal(&result)) {
+      return;
+    }
+  } else {
+    TwoByteValue data(env->isolate(), input);
+    std::vector<uint16_t> res;
+    res.reserve(data.length());
+    NormalizeString(*data, data.length(), allow_above_root, &res);
+    if (!res.empty() &&
+        !String::NewFromTwoByte(env->isolate(),
+                                res.data(),
+                                NewStringType::kNormal,
+                                res.size()).ToLocal(&result)) {
+      return;
+    }
+  }
+  args.GetReturnValue().Set(result);
+}
+
+
+void Initialize(Local<Object> target,
+                Local<Value> unused,
+                Local<Context> context) {
+  Environment* env = Environment::GetCurrent(context);
+  env->SetMethod(target, "normalizeStringPosix", NormalizeStringPosix);
+}
+
+}  // namespace path
+}  // namespace node
+
+NODE_MODULE_CONTEXT_AWARE_BUILTIN(path, node::path::Initialize)
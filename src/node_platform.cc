@@ -0,0 +1,109 @@
+#include "node_platform.h"
+#include "util.h"
+#include "util-inl.h"
+#include "uv.h"
+
+namespace node {
+
+namespace {
+
+struct BackgroundTask {
+  uv_threadpool_task_t req;
+  v8::Task* task;
+};
+
+
+void RunBackgroundTask(uv_threadpool_task_t* req) {
+  BackgroundTask* task = ContainerOf(&BackgroundTask::req, req);
+  task->task->Run();
+  delete task->task;
+  delete task;
+}
+
+
+class ThreadpoolPlatform : public v8::Platform {
+ public:
+  explicit ThreadpoolPlatform(v8::Platform* platform) : platform_(platform) {}
+
+  size_t NumberOfAvailableBackgroundThreads() override {
+    const int size = uv_threadpool_get_size(UV_THREADPOOL_CPU);
+    return size > 0 ? size : 1;
+  }
+
+  void CallOnBackgroundThread(v8::Task* task,
+                              ExpectedRuntime expected_runtime) override {
+    BackgroundTask* background_task = new BackgroundTask;
+    background_task->task = task;
+    const uv_work_priority priority =
+        expected_runtime == kShortRunningTask ? UV_PRIORITY_HIGH :
+                                                UV_PRIORITY_NORMAL;
+    CHECK_EQ(0, uv_threadpool_submit(&background_task->req,
+                                     RunBackgroundTask,
+                                     UV_THREADPOOL_CPU,
+                                     priority));
+  }
+
+  void CallOnForegroundThread(v8::Isolate* isolate, v8::Task* task) override {
+    platform_->CallOnForegroundThread(isolate, task);
+  }
+
+  void CallDelayedOnForegroundThread(v8::Isolate* isolate,
+                                     v8::Task* task,
+                                     double delay_in_seconds) override {
+    platform_->CallDelayedOnForegroundThread(isolate, task, delay_in_seconds);
+  }
+
+  void CallIdleOnForegroundThread(v8::Isolate* isolate,
+                                  v8::IdleTask* task) override {
+    platform_->CallIdleOnForegroundThread(isolate, task);
+  }
+
+  bool IdleTasksEnabled(v8::Isolate* isolate) override {
+    return platform_->IdleTasksEnabled(isolate);
+  }
+
+  double MonotonicallyIncreasingTime() override {
+    return platform_->MonotonicallyIncreasingTime();
+  }
+
+  const uint8_t* GetCategoryGroupEnabled(const char* name) override {
+    return platform_->GetCategoryGroupEnabled(name);
+  }
+
+  const char* GetCategoryGroupName(const uint8_t* enabled) override {
+    return platform_->GetCategoryGroupName(enabled);
+  }
+
+  uint64_t AddTraceEvent(char phase,
+                         const uint8_t* enabled,
+                         const char* name,
+                         uint64_t id,
+                         uint64_t bind_id,
+                         int32_t num_args,
+                         const char** arg_names,
+                         const uint8_t* arg_types,
+                         const uint64_t* arg_values,
+                         unsigned int flags) override {
+    return platform_->AddTraceEvent(phase, enabled, name, id, bind_id,
+                                    num_args, arg_names, arg_types,
+                                    arg_values, flags);
+  }
+
+  void UpdateTraceEventDuration(const uint8_t* enabled,
+                                const char* name,
+                                uint64_t handle) override {
+    platform_->UpdateTraceEventDuration(enabled, name, handle);
+  }
+
+ private:
+  v8::Platform* const platform_;
+};
+
+}  // anonymous namespace
+
+
+v8::Platform* CreateThreadpoolPlatform(v8::Platform* platform) {
+  return new ThreadpoolPlatform(platform);
+}
+
+}  // namespace node
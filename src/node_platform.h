@@ -0,0 +1,20 @@
+#ifndef SRC_NODE_PLATFORM_H_
+#define SRC_NODE_PLATFORM_H_
+
+#include "v8-platform.h"
+
+namespace node {
+
+// Wraps |platform| so that V8's background tasks, concurrent sweeping and
+// compilation for the most part, run on the cpu queue of the libuv
+// threadpool instead of on threads of the platform's own, for
+// --v8-shared-threadpool.  The number of threads of the process is then
+// bounded by the size of the threadpool.  Tasks that V8 expects to finish
+// soon are queued with high priority, since the main thread may be waiting
+// for them.  Everything else goes to |platform|, which the wrapper does not
+// own.
+v8::Platform* CreateThreadpoolPlatform(v8::Platform* platform);
+
+}  // namespace node
+
+#endif  // SRC_NODE_PLATFORM_H_
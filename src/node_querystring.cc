@@ -0,0 +1,394 @@
+#include "node.h"
+#include "node_buffer.h"
+#include "node_internals.h"
+
+#include "env.h"
+#include "env-inl.h"
+#include "util.h"
+#include "util-inl.h"
+#include "v8.h"
+
+#include <stdint.h>
+
+#include <string>
+#include <unordered_map>
+
+// Native versions of QueryString.parse(), unescapeBuffer() and escape() for
+// large inputs, e.g. form-encoded request bodies.  They behave exactly like
+// the JS implementations in lib/querystring.js, which are still used for
+// short strings, custom separators and custom decoders.
+
+namespace node {
+namespace querystring {
+
+using v8::Array;
+using v8::Context;
+using v8::FunctionCallbackInfo;
+using v8::Local;
+using v8::NewStringType;
+using v8::Number;
+using v8::Object;
+using v8::String;
+using v8::Value;
+
+
+static inline int HexValue(uint32_t c) {
+  if (c >= '0' && c <= '9')
+    return c - '0';
+  if (c >= 'A' && c <= 'F')
+    return c - 'A' + 10;
+  if (c >= 'a' && c <= 'f')
+    return c - 'a' + 10;
+  return -1;
+}
+
+
+// Appends the percent-decoding of `data` to `out`, like unescapeBuffer().
+// Invalid escapes are copied as they are, and the characters of a two-byte
+// string are truncated to their low byte.
+template <typename T>
+static void Unescape(const T* data,
+                     size_t length,
+                     bool decode_spaces,
+                     std::string* out) {
+  size_t i = 0;
+  while (i < length) {
+    const uint32_t c = data[i];
+    if (c != '%') {
+      out->push_back(c == '+' && decode_spaces ? ' ' : static_cast<char>(c));
+      i += 1;
+      continue;
+    }
+    if (i + 1 == length) {
+      out->push_back('%');
+      break;
+    }
+    const int high = HexValue(data[i + 1]);
+    if (high < 0 || i + 2 == length) {
+      out->push_back('%');
+      out->push_back(static_cast<char>(data[i + 1]));
+      i += 2;
+      continue;
+    }
+    const int low = HexValue(data[i + 2]);
+    if (low < 0) {
+      out->push_back('%');
+      out->push_back(static_cast<char>(data[i + 1]));
+      out->push_back(static_cast<char>(data[i + 2]));
+    } else {
+      out->push_back(static_cast<char>(high * 16 + low));
+    }
+    i += 3;
+  }
+}
+
+
+// Collects the pairs of a query string into an object with interned keys.
+// Values of keys that appear more than once are collected into an array.
+class Parser {
+ public:
+  Parser(Environment* env, Local<Object> target)
+      : env_(env), target_(target) {}
+
+  // The input is ASCII or UTF-8, `sep` and `eq` are ASCII characters.
+  // Returns false if an exception is pending.
+  bool Parse(const char* data,
+             size_t length,
+             char sep,
+             char eq,
+             double pairs) {
+    std::string key;
+    std::string value;
+    bool eq_found = false;
+    size_t last = 0;
+
+    for (size_t i = 0; i < length; i++) {
+      const char c = data[i];
+
+      if (c == sep) {
+        Append(eq_found ? &value : &key, data + last, i - last);
+        if (!AddPair(&key, &value))
+          return false;
+        if (--pairs == 0)
+          return true;
+        key.clear();
+        value.clear();
+        eq_found = false;
+        last = i + 1;
+        continue;
+      }
+
+      if (!eq_found && c == eq) {
+        Append(&key, data + last, i - last);
+        eq_found = true;
+        last = i + 1;
+        continue;
+      }
+
+      // QueryString.parse() replaces '+' with "%20" before decoding, which
+      // matters when it follows an incomplete escape.
+      if (c == '+') {
+        std::string* out = eq_found ? &value : &key;
+        Append(out, data + last, i - last);
+        out->append("%20");
+        last = i + 1;
+      }
+    }
+
+    if (pairs > 0 && (last < length || eq_found)) {
+      Append(eq_found ? &value : &key, data + last, length - last);
+      return AddPair(&key, &value);
+    }
+    return true;
+  }
+
+ private:
+  struct Entry {
+    Local<String> key;
+    Local<Value> first;
+    Local<Array> values;
+  };
+
+  static void Append(std::string* out, const char* data, size_t length) {
+    out->append(data, length);
+  }
+
+  bool AddPair(std::string* key, std::string* value) {
+    decoded_key_.clear();
+    decoded_value_.clear();
+    Unescape(reinterpret_cast<const uint8_t*>(key->data()),
+             key->size(),
+             false,
+             &decoded_key_);
+    Unescape(reinterpret_cast<const uint8_t*>(value->data()),
+             value->size(),
+             false,
+             &decoded_value_);
+
+    Local<Context> context = env_->context();
+    Local<String> value_string;
+    if (!String::NewFromUtf8(env_->isolate(),
+                             decoded_value_.data(),
+                             NewStringType::kNormal,
+                             decoded_value_.size()).ToLocal(&value_string)) {
+      return false;
+    }
+
+    auto it = entries_.find(decoded_key_);
+    if (it == entries_.end()) {
+      Local<String> key_string;
+      if (!String::NewFromUtf8(env_->isolate(),
+                               decoded_key_.data(),
+                               NewStringType::kInternalized,
+                               decoded_key_.size()).ToLocal(&key_string)) {
+        return false;
+      }
+      if (target_->Set(context, key_string, value_string).IsNothing())
+        return false;
+      Entry entry;
+      entry.key = key_string;
+      entry.first = value_string;
+      entries_.emplace(decoded_key_, entry);
+      return true;
+    }
+
+    Entry* entry = &it->second;
+    if (entry->values.IsEmpty()) {
+      entry->values = Array::New(env_->isolate(), 2);
+      if (entry->values->Set(context, 0, entry->first).IsNothing() ||
+          entry->values->Set(context, 1, value_string).IsNothing()) {
+        return false;
+      }
+      return !target_->Set(context, entry->key, entry->values).IsNothing();
+    }
+    return !entry->values->Set(context,
+                               entry->values->Length(),
+                               value_string).IsNothing();
+  }
+
+  Environment* const env_;
+  Local<Object> target_;
+  std::string decoded_key_;
+  std::string decoded_value_;
+  std::unordered_map<std::string, Entry> entries_;
+
+  DISALLOW_COPY_AND_ASSIGN(Parser);
+};
+
+
+// parse(obj, input, sep, eq, maxPairs)
+//
+// Adds the pairs of `input`, a Buffer or a string, to `obj`.  Returns false
+// without touching `obj` when `input` is a string with non-ASCII characters,
+// whose raw characters the JS implementation keeps as they are.
+static void Parse(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  CHECK(args[0]->IsObject());
+  CHECK(args[2]->IsString());
+  CHECK(args[3]->IsString());
+  CHECK(args[4]->IsNumber());
+
+  Utf8Value sep(env->isolate(), args[2]);
+  Utf8Value eq(env->isolate(), args[3]);
+  CHECK_EQ(sep.length(), 1);
+  CHECK_EQ(eq.length(), 1);
+  const double pairs = args[4].As<Number>()->Value();
+
+  Parser parser(env, args[0].As<Object>());
+
+  if (Buffer::HasInstance(args[1])) {
+    if (parser.Parse(Buffer::Data(args[1]),
+                     Buffer::Length(args[1]),
+                     (*sep)[0],
+                     (*eq)[0],
+                     pairs)) {
+      args.GetReturnValue().Set(true);
+    }
+    return;
+  }
+
+  CHECK(args[1]->IsString());
+  Local<String> input = args[1].As<String>();
+  if (!input->ContainsOnlyOneByte())
+    return args.GetReturnValue().Set(false);
+
+  MaybeStackBuffer<char> data;
+  data.AllocateSufficientStorage(input->Length() + 1);
+  input->WriteOneByte(reinterpret_cast<uint8_t*>(*data),
+                      0,
+                      input->Length(),
+                      String::NO_NULL_TERMINATION);
+  for (int i = 0; i < input->Length(); i++) {
+    if (static_cast<unsigned char>((*data)[i]) >= 0x80)
+      return args.GetReturnValue().Set(false);
+  }
+
+  if (parser.Parse(*data, input->Length(), (*sep)[0], (*eq)[0], pairs))
+    args.GetReturnValue().Set(true);
+}
+
+
+// unescapeBuffer(string, decodeSpaces)
+static void UnescapeBuffer(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  CHECK(args[0]->IsString());
+  Local<String> input = args[0].As<String>();
+  const bool decode_spaces = args[1]->BooleanValue();
+
+  std::string out;
+  out.reserve(input->Length());
+  if (input->IsOneByte()) {
+    MaybeStackBuffer<uint8_t> data;
+    data.AllocateSufficientStorage(input->Length() + 1);
+    input->WriteOneByte(*data, 0, input->Length(),
+                        String::NO_NULL_TERMINATION);
+    Unescape(*data, input->Length(), decode_spaces, &out);
+  } else {
+    TwoByteValue data(env->isolate(), input);
+    Unescape(*data, data.length(), decode_spaces, &out);
+  }
+
+  Local<Object> buffer;
+  if (Buffer::Copy(env, out.data(), out.size()).ToLocal(&buffer))
+    args.GetReturnValue().Set(buffer);
+}
+
+
+static inline bool IsUnreserved(uint32_t c) {
+  return c == '!' || c == '-' || c == '.' || c == '_' || c == '~' ||
+         (c >= '\'' && c <= '*') ||
+         (c >= '0' && c <= '9') ||
+         (c >= 'A' && c <= 'Z') ||
+         (c >= 'a' && c <= 'z');
+}
+
+
+static inline void AppendEscaped(std::string* out, uint32_t byte) {
+  static const char hex[] = "0123456789ABCDEF";
+  out->push_back('%');
+  out->push_back(hex[byte >> 4]);
+  out->push_back(hex[byte & 15]);
+}
+
+
+// Returns false for a surrogate at the end of the string, for which
+// QueryString.escape() throws a URIError.  Like the JS implementation, it
+// pairs any surrogate with the character that follows it.
+template <typename T>
+static bool Escape(const T* data, size_t length, std::string* out) {
+  for (size_t i = 0; i < length; i++) {
+    uint32_t c = data[i];
+    if (IsUnreserved(c)) {
+      out->push_back(static_cast<char>(c));
+    } else if (c < 0x80) {
+      AppendEscaped(out, c);
+    } else if (c < 0x800) {
+      AppendEscaped(out, 0xC0 | (c >> 6));
+      AppendEscaped(out, 0x80 | (c & 0x3F));
+    } else if (c < 0xD800 || c >= 0xE000) {
+      AppendEscaped(out, 0xE0 | (c >> 12));
+      AppendEscaped(out, 0x80 | ((c >> 6) & 0x3F));
+      AppendEscaped(out, 0x80 | (c & 0x3F));
+    } else {
+      if (++i == length)
+        return false;
+      c = 0x10000 + (((c & 0x3FF) << 10) | (data[i] & 0x3FF));
+      AppendEscaped(out, 0xF0 | (c >> 18));
+      AppendEscaped(out, 0x80 | ((c >> 12) & 0x3F));
+      AppendEscaped(out, 0x80 | ((c >> 6) & 0x3F));
+      AppendEscaped(out, 0x80 | (c & 0x3F));
+    }
+  }
+  return true;
+}
+
+
+// escape(string), returns undefined where QueryString.escape() throws.
+static void EscapeString(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  CHECK(args[0]->IsString());
+  Local<String> input = args[0].As<String>();
+
+  std::string out;
+  out.reserve(input->Length());
+  bool ok;
+  if (input->IsOneByte()) {
+    MaybeStackBuffer<uint8_t> data;
+    data.AllocateSufficientStorage(input->Length() + 1);
+    input->WriteOneByte(*data, 0, input->Length(),
+                        String::NO_NULL_TERMINATION);
+    ok = Escape(*data, input->Length(), &out);
+  } else {
+    TwoByteValue data(env->isolate(), input);
+    ok = Escape(*data, data.length(), &out);
+  }
+  if (!ok)
+    return;
+
+  // Nothing had to be escaped.
+  if (out.size() == static_cast<size_t>(input->Length()))
+    return args.GetReturnValue().Set(input);
+
+  Local<String> result;
+  if (String::NewFromOneByte(env->isolate(),
+                             reinterpret_cast<const uint8_t*>(out.data()),
+                             NewStringType::kNormal,
+                             out.size()).ToLocal(&result)) {
+    args.GetReturnValue().Set(result);
+  }
+}
+
+
+void Initialize(Local<Object> target,
+                Local<Value> unused,
+                Local<Context> context) {
+  Environment* env = Environment::GetCurrent(context);
+  env->SetMethod(target, "parse", Parse);
+  env->SetMethod(target, "unescapeBuffer", UnescapeBuffer);
+  env->SetMethod(target, "escape", EscapeString);
+}
+
+}  // namespace querystring
+}  // namespace node
+
+NODE_MODULE_CONTEXT_AWARE_BUILTIN(querystring, node::querystring::Initialize)
@@ -0,0 +1,141 @@
+#include "node_script_cache.h"
+#include "util.h"
+#include "util-inl.h"
+#include "v8.h"
+
+namespace node {
+
+using v8::Integer;
+using v8::Isolate;
+using v8::Local;
+using v8::ScriptOrigin;
+using v8::String;
+using v8::UnboundScript;
+using v8::Value;
+
+static const uint64_t kFNVOffsetBasis = 14695981039346656037ULL;
+static const uint64_t kFNVPrime = 1099511628211ULL;
+
+static uint64_t HashString(uint64_t hash, Local<String> string) {
+  String::Value value(string);
+  for (int i = 0; i < value.length(); i++) {
+    hash ^= (*value)[i];
+    hash *= kFNVPrime;
+  }
+  return hash;
+}
+
+static int64_t OffsetValue(Local<Integer> offset) {
+  return offset.IsEmpty() ? 0 : offset->Value();
+}
+
+
+ScriptCache::Entry::~Entry() {
+  source.Reset();
+  filename.Reset();
+  script.Reset();
+}
+
+
+ScriptCache::ScriptCache(Isolate* isolate)
+    : isolate_(isolate),
+      source_length_(0),
+      hits_(0),
+      misses_(0) {
+}
+
+
+uint64_t ScriptCache::Hash(Local<String> source, const ScriptOrigin& origin) {
+  uint64_t hash = HashString(kFNVOffsetBasis, source);
+  Local<Value> filename = origin.ResourceName();
+  if (!filename.IsEmpty() && filename->IsString())
+    hash = HashString(hash, filename.As<String>());
+  hash ^= OffsetValue(origin.ResourceLineOffset());
+  hash *= kFNVPrime;
+  hash ^= OffsetValue(origin.ResourceColumnOffset());
+  hash *= kFNVPrime;
+  return hash;
+}
+
+
+Local<UnboundScript> ScriptCache::Get(uint64_t hash,
+                                      Local<String> source,
+                                      const ScriptOrigin& origin,
+                                      const std::vector<uint8_t>** code_cache) {
+  *code_cache = nullptr;
+
+  auto it = index_.find(hash);
+  if (it == index_.end() || !Matches(*it->second, source, origin)) {
+    misses_ += 1;
+    return Local<UnboundScript>();
+  }
+
+  hits_ += 1;
+  entries_.splice(entries_.begin(), entries_, it->second);
+  const Entry& entry = entries_.front();
+  if (!entry.code_cache.empty())
+    *code_cache = &entry.code_cache;
+  return PersistentToLocal(isolate_, entry.script);
+}
+
+
+void ScriptCache::Put(uint64_t hash,
+                      Local<String> source,
+                      const ScriptOrigin& origin,
+                      Local<UnboundScript> script,
+                      const uint8_t* code_cache,
+                      size_t code_cache_length) {
+  const size_t length = source->Length();
+  // One source shouldn't push out all the others.
+  if (length > kMaxSourceLength / 8)
+    return;
+
+  auto it = index_.find(hash);
+  if (it != index_.end())
+    Erase(it->second);
+
+  entries_.emplace_front();
+  Entry& entry = entries_.front();
+  entry.hash = hash;
+  entry.source.Reset(isolate_, source);
+  entry.length = length;
+  entry.filename.Reset(isolate_, origin.ResourceName());
+  entry.line_offset = OffsetValue(origin.ResourceLineOffset());
+  entry.column_offset = OffsetValue(origin.ResourceColumnOffset());
+  entry.script.Reset(isolate_, script);
+  if (code_cache != nullptr)
+    entry.code_cache.assign(code_cache, code_cache + code_cache_length);
+  index_[hash] = entries_.begin();
+  source_length_ += length;
+
+  while (entries_.size() > kMaxEntries || source_length_ > kMaxSourceLength)
+    Erase(--entries_.end());
+}
+
+
+bool ScriptCache::Matches(const Entry& entry,
+                          Local<String> source,
+                          const ScriptOrigin& origin) const {
+  if (entry.line_offset != OffsetValue(origin.ResourceLineOffset()) ||
+      entry.column_offset != OffsetValue(origin.ResourceColumnOffset())) {
+    return false;
+  }
+
+  Local<Value> filename = origin.ResourceName();
+  Local<Value> entry_filename = PersistentToLocal(isolate_, entry.filename);
+  if (filename.IsEmpty() != entry_filename.IsEmpty())
+    return false;
+  if (!filename.IsEmpty() && !filename->StrictEquals(entry_filename))
+    return false;
+
+  return source->StrictEquals(PersistentToLocal(isolate_, entry.source));
+}
+
+
+void ScriptCache::Erase(EntryList::iterator it) {
+  source_length_ -= it->length;
+  index_.erase(it->hash);
+  entries_.erase(it);
+}
+
+}  // namespace node
@@ -0,0 +1,81 @@
+#ifndef SRC_NODE_SCRIPT_CACHE_H_
+#define SRC_NODE_SCRIPT_CACHE_H_
+
+#include "util.h"
+#include "v8.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+namespace node {
+
+// Keeps the scripts that vm.Script compiled, so that compiling the same
+// source with the same origin again is a lookup.  The least recently used
+// entry is dropped once there are more than kMaxEntries, or once the sources
+// together are longer than kMaxSourceLength characters.  An entry also keeps
+// the code cache of its script when one was produced or accepted.
+class ScriptCache {
+ public:
+  static const size_t kMaxEntries = 128;
+  static const size_t kMaxSourceLength = 4 * 1024 * 1024;
+
+  explicit ScriptCache(v8::Isolate* isolate);
+
+  // The key of |source| with |origin|, for Get() and Put().
+  static uint64_t Hash(v8::Local<v8::String> source,
+                       const v8::ScriptOrigin& origin);
+
+  // Returns an empty handle when nothing is cached.  |code_cache| is set to
+  // the code cache of the entry, or to nullptr when there is none.
+  v8::Local<v8::UnboundScript> Get(uint64_t hash,
+                                   v8::Local<v8::String> source,
+                                   const v8::ScriptOrigin& origin,
+                                   const std::vector<uint8_t>** code_cache);
+  void Put(uint64_t hash,
+           v8::Local<v8::String> source,
+           const v8::ScriptOrigin& origin,
+           v8::Local<v8::UnboundScript> script,
+           const uint8_t* code_cache,
+           size_t code_cache_length);
+
+  inline size_t size() const { return entries_.size(); }
+  inline double hits() const { return hits_; }
+  inline double misses() const { return misses_; }
+
+ private:
+  struct Entry {
+    uint64_t hash;
+    v8::Persistent<v8::String> source;
+    size_t length;
+    v8::Persistent<v8::Value> filename;
+    int64_t line_offset;
+    int64_t column_offset;
+    v8::Persistent<v8::UnboundScript> script;
+    std::vector<uint8_t> code_cache;
+
+    ~Entry();
+  };
+  typedef std::list<Entry> EntryList;
+
+  bool Matches(const Entry& entry,
+               v8::Local<v8::String> source,
+               const v8::ScriptOrigin& origin) const;
+  void Erase(EntryList::iterator it);
+
+  v8::Isolate* const isolate_;
+  // The most recently used entry comes first.
+  EntryList entries_;
+  std::unordered_map<uint64_t, EntryList::iterator> index_;
+  size_t source_length_;
+  double hits_;
+  double misses_;
+
+  DISALLOW_COPY_AND_ASSIGN(ScriptCache);
+};
+
+}  // namespace node
+
+#endif  // SRC_NODE_SCRIPT_CACHE_H_
@@ -0,0 +1,838 @@
+#include "node.h"
+#include "node_buffer.h"
+#include "node_internals.h"
+#include "node_serdes.h"
+#include "env.h"
+#include "env-inl.h"
+#include "util.h"
+#include "util-inl.h"
+#include "v8.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <unordered_map>
+#include <vector>
+
+namespace node {
+namespace serdes {
+
+using v8::Array;
+using v8::ArrayBuffer;
+using v8::ArrayBufferView;
+using v8::Context;
+using v8::DataView;
+using v8::Date;
+using v8::False;
+using v8::Float32Array;
+using v8::Float64Array;
+using v8::FunctionCallbackInfo;
+using v8::Int16Array;
+using v8::Int32Array;
+using v8::Int8Array;
+using v8::Integer;
+using v8::Local;
+using v8::Map;
+using v8::MaybeLocal;
+using v8::Null;
+using v8::Number;
+using v8::Object;
+using v8::RegExp;
+using v8::Set;
+using v8::String;
+using v8::True;
+using v8::Uint16Array;
+using v8::Uint32Array;
+using v8::Uint8Array;
+using v8::Uint8ClampedArray;
+using v8::Undefined;
+using v8::Value;
+
+// The wire format.  Every value starts with a tag byte.  Lengths and int32s
+// are little-endian uint32s.  Doubles and two-byte strings are in host byte
+// order: both ends of an IPC channel run on the same machine.
+//
+//   kInt32 <int32>                  kDouble <double>
+//   kOneByteString <length> <latin1 bytes>
+//   kTwoByteString <length> <utf-16 code units>
+//   kDate <double>                  kRegExp <string> <flags>
+//   kBuffer <length> <bytes>        kArrayBuffer <length> <bytes>
+//   kTypedArray <type> <length> <bytes>
+//   kArray <length> <values>        kObject <count> (<string> <value>)*
+//   kMap <count> (<value> <value>)* kSet <count> <values>
+//   kReference <id>
+//
+// Objects are numbered in the order in which they are first written,
+// kReference refers back to one of them, so that shared and cyclic
+// references survive the trip.
+enum Tag : uint8_t {
+  kUndefined = '_',
+  kNull = '0',
+  kTrue = 'T',
+  kFalse = 'F',
+  kInt32 = 'I',
+  kDouble = 'N',
+  kOneByteString = 's',
+  kTwoByteString = 'w',
+  kDate = 'D',
+  kRegExp = 'R',
+  kBuffer = 'B',
+  kArrayBuffer = 'X',
+  kTypedArray = 'V',
+  kArray = 'A',
+  kObject = 'o',
+  kMap = 'M',
+  kSet = 'S',
+  kReference = 'r',
+};
+
+enum TypedArrayType : uint8_t {
+  kArrayBufferType = 0,  // Only used internally, never written.
+  kInt8Array,
+  kUint8Array,
+  kUint8ClampedArray,
+  kInt16Array,
+  kUint16Array,
+  kInt32Array,
+  kUint32Array,
+  kFloat32Array,
+  kFloat64Array,
+  kDataView,
+};
+
+// Deeper values are rejected instead of overflowing the C++ stack.
+static const int kMaxDepth = 1000;
+
+
+static inline void WriteLE32(char* p, uint32_t value) {
+  p[0] = static_cast<char>(value);
+  p[1] = static_cast<char>(value >> 8);
+  p[2] = static_cast<char>(value >> 16);
+  p[3] = static_cast<char>(value >> 24);
+}
+
+
+static inline uint32_t ReadLE32(const char* p) {
+  const uint8_t* b = reinterpret_cast<const uint8_t*>(p);
+  return b[0] |
+         (b[1] << 8) |
+         (b[2] << 16) |
+         (static_cast<uint32_t>(b[3]) << 24);
+}
+
+
+class Serializer {
+ public:
+  explicit Serializer(Environment* env)
+      : env_(env), data_(nullptr), length_(0), capacity_(0) {
+    Reserve(kHeaderSize);
+    length_ = kHeaderSize;
+  }
+
+  ~Serializer() {
+    free(data_);
+  }
+
+  // Returns false with an exception pending if |value| can't be cloned.
+  bool WriteValue(Local<Value> value, int depth);
+
+  // Fills in the header and hands the data over to the caller.
+  char* Release(size_t* length) {
+    char* data = data_;
+    *length = length_;
+    WriteLE32(data, length_ - kHeaderSize);
+    data_ = nullptr;
+    length_ = capacity_ = 0;
+    return data;
+  }
+
+ private:
+  void Reserve(size_t extra) {
+    if (length_ + extra <= capacity_)
+      return;
+    size_t capacity = capacity_ == 0 ? 256 : capacity_;
+    while (capacity < length_ + extra)
+      capacity *= 2;
+    data_ = static_cast<char*>(realloc(data_, capacity));
+    CHECK_NE(data_, nullptr);
+    capacity_ = capacity;
+  }
+
+  void WriteTag(Tag tag) {
+    Reserve(1);
+    data_[length_++] = static_cast<char>(tag);
+  }
+
+  void WriteUint32(uint32_t value) {
+    Reserve(4);
+    WriteLE32(data_ + length_, value);
+    length_ += 4;
+  }
+
+  void WriteDouble(double value) {
+    WriteBytes(&value, sizeof(value));
+  }
+
+  void WriteBytes(const void* data, size_t length) {
+    Reserve(length);
+    if (length > 0)
+      memcpy(data_ + length_, data, length);
+    length_ += length;
+  }
+
+  void WriteString(Local<String> string);
+  bool WriteLength(size_t length);
+  bool WriteObjectBody(Local<Object> object, int depth);
+  bool WriteView(Local<ArrayBufferView> view);
+  // Writes a kReference and returns true if |object| was written before.
+  bool WriteReference(Local<Object> object);
+  bool ThrowUncloneable(const char* what);
+
+  Environment* const env_;
+  char* data_;
+  size_t length_;
+  size_t capacity_;
+  std::unordered_multimap<int, uint32_t> ids_;
+  std::vector<Local<Object>> objects_;
+};
+
+
+bool Serializer::WriteLength(size_t length) {
+  if (length > UINT32_MAX) {
+    env_->ThrowRangeError("Value is too large to be serialized");
+    return false;
+  }
+  WriteUint32(static_cast<uint32_t>(length));
+  return true;
+}
+
+
+void Serializer::WriteString(Local<String> string) {
+  const int length = string->Length();
+  if (string->IsOneByte()) {
+    WriteTag(kOneByteString);
+    WriteUint32(length);
+    Reserve(length);
+    string->WriteOneByte(reinterpret_cast<uint8_t*>(data_ + length_),
+                         0,
+                         length,
+                         String::NO_NULL_TERMINATION);
+    length_ += length;
+    return;
+  }
+
+  WriteTag(kTwoByteString);
+  WriteUint32(length);
+  // Write() wants aligned storage, data_ + length_ need not be.
+  MaybeStackBuffer<uint16_t> storage;
+  storage.AllocateSufficientStorage(length);
+  string->Write(*storage, 0, length, String::NO_NULL_TERMINATION);
+  WriteBytes(*storage, length * sizeof(**storage));
+}
+
+
+bool Serializer::WriteReference(Local<Object> object) {
+  const int hash = object->GetIdentityHash();
+  auto range = ids_.equal_range(hash);
+  for (auto it = range.first; it != range.second; ++it) {
+    if (objects_[it->second]->StrictEquals(object)) {
+      WriteTag(kReference);
+      WriteUint32(it->second);
+      return true;
+    }
+  }
+  ids_.insert(std::make_pair(hash, static_cast<uint32_t>(objects_.size())));
+  objects_.push_back(object);
+  return false;
+}
+
+
+bool Serializer::ThrowUncloneable(const char* what) {
+  char message[64];
+  snprintf(message, sizeof(message), "%s could not be cloned", what);
+  env_->ThrowTypeError(message);
+  return false;
+}
+
+
+bool Serializer::WriteView(Local<ArrayBufferView> view) {
+  TypedArrayType type;
+  if (view->IsDataView())
+    type = kDataView;
+  else if (view->IsInt8Array())
+    type = kInt8Array;
+  else if (view->IsUint8Array())
+    type = kUint8Array;
+  else if (view->IsUint8ClampedArray())
+    type = kUint8ClampedArray;
+  else if (view->IsInt16Array())
+    type = kInt16Array;
+  else if (view->IsUint16Array())
+    type = kUint16Array;
+  else if (view->IsInt32Array())
+    type = kInt32Array;
+  else if (view->IsUint32Array())
+    type = kUint32Array;
+  else if (view->IsFloat32Array())
+    type = kFloat32Array;
+  else if (view->IsFloat64Array())
+    type = kFloat64Array;
+  else
+    return ThrowUncloneable("ArrayBufferView");
+
+  const size_t length = view->ByteLength();
+  const bool is_buffer =
+      type == kUint8Array &&
+      view->GetPrototype()->StrictEquals(env_->buffer_prototype_object());
+  if (is_buffer) {
+    WriteTag(kBuffer);
+  } else {
+    WriteTag(kTypedArray);
+    Reserve(1);
+    data_[length_++] = static_cast<char>(type);
+  }
+  if (!WriteLength(length))
+    return false;
+  Reserve(length);
+  CHECK_EQ(length, view->CopyContents(data_ + length_, length));
+  length_ += length;
+  return true;
+}
+
+
+bool Serializer::WriteObjectBody(Local<Object> object, int depth) {
+  Local<Context> context = env_->context();
+
+  if (object->IsArray()) {
+    Local<Array> array = object.As<Array>();
+    const uint32_t length = array->Length();
+    WriteTag(kArray);
+    WriteUint32(length);
+    for (uint32_t i = 0; i < length; i++) {
+      Local<Value> element;
+      if (!array->Get(context, i).ToLocal(&element) ||
+          !WriteValue(element, depth + 1)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  if (object->IsMap() || object->IsSet()) {
+    const bool is_map = object->IsMap();
+    Local<Array> entries =
+        is_map ? object.As<Map>()->AsArray() : object.As<Set>()->AsArray();
+    const uint32_t length = entries->Length();
+    WriteTag(is_map ? kMap : kSet);
+    WriteUint32(is_map ? length / 2 : length);
+    for (uint32_t i = 0; i < length; i++) {
+      Local<Value> entry;
+      if (!entries->Get(context, i).ToLocal(&entry) ||
+          !WriteValue(entry, depth + 1)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // Like JSON.stringify(), only the own enumerable properties are written.
+  Local<Array> keys;
+  if (!object->GetOwnPropertyNames(context).ToLocal(&keys))
+    return false;
+  const uint32_t count = keys->Length();
+  WriteTag(kObject);
+  WriteUint32(count);
+  for (uint32_t i = 0; i < count; i++) {
+    Local<Value> key;
+    Local<String> name;
+    Local<Value> value;
+    if (!keys->Get(context, i).ToLocal(&key) ||
+        !key->ToString(context).ToLocal(&name) ||
+        !object->Get(context, key).ToLocal(&value)) {
+      return false;
+    }
+    WriteString(name);
+    if (!WriteValue(value, depth + 1))
+      return false;
+  }
+  return true;
+}
+
+
+bool Serializer::WriteValue(Local<Value> value, int depth) {
+  if (depth > kMaxDepth) {
+    env_->ThrowRangeError("Value is nested too deeply to be serialized");
+    return false;
+  }
+
+  if (value->IsUndefined()) {
+    WriteTag(kUndefined);
+  } else if (value->IsNull()) {
+    WriteTag(kNull);
+  } else if (value->IsTrue()) {
+    WriteTag(kTrue);
+  } else if (value->IsFalse()) {
+    WriteTag(kFalse);
+  } else if (value->IsInt32()) {
+    WriteTag(kInt32);
+    WriteUint32(static_cast<uint32_t>(value.As<Integer>()->Value()));
+  } else if (value->IsNumber()) {
+    WriteTag(kDouble);
+    WriteDouble(value.As<Number>()->Value());
+  } else if (value->IsString()) {
+    WriteString(value.As<String>());
+  } else if (value->IsSymbol()) {
+    return ThrowUncloneable("Symbol");
+  } else {
+    Local<Object> object = value.As<Object>();
+    if (object->IsFunction())
+      return ThrowUncloneable("Function");
+    if (object->IsPromise() || object->IsProxy() || object->IsWeakMap() ||
+        object->IsWeakSet() || object->IsExternal() ||
+        object->IsMapIterator() || object->IsSetIterator()) {
+      return ThrowUncloneable("Object");
+    }
+
+    if (WriteReference(object))
+      return true;
+
+    if (object->IsDate()) {
+      WriteTag(kDate);
+      WriteDouble(object.As<Date>()->ValueOf());
+    } else if (object->IsRegExp()) {
+      Local<RegExp> regexp = object.As<RegExp>();
+      WriteTag(kRegExp);
+      WriteString(regexp->GetSource());
+      WriteUint32(regexp->GetFlags());
+    } else if (object->IsArrayBufferView()) {
+      return WriteView(object.As<ArrayBufferView>());
+    } else if (object->IsArrayBuffer()) {
+      ArrayBuffer::Contents contents = object.As<ArrayBuffer>()->GetContents();
+      WriteTag(kArrayBuffer);
+      if (!WriteLength(contents.ByteLength()))
+        return false;
+      WriteBytes(contents.Data(), contents.ByteLength());
+    } else {
+      return WriteObjectBody(object, depth);
+    }
+  }
+
+  return true;
+}
+
+
+class Deserializer {
+ public:
+  // Reads from |length| bytes at |offset| into |buffer|.  Buffers in the
+  // result are views on |buffer| rather than copies.
+  Deserializer(Environment* env,
+               Local<ArrayBuffer> buffer,
+               size_t offset,
+               size_t length)
+      : env_(env),
+        buffer_(buffer),
+        data_(static_cast<const char*>(buffer->GetContents().Data())),
+        position_(offset),
+        end_(offset + length) {}
+
+  // Returns false with an exception pending on malformed input.
+  bool ReadValue(Local<Value>* value, int depth);
+
+  inline bool AtEnd() const { return position_ == end_; }
+
+ private:
+  bool ReadTag(uint8_t* tag) {
+    if (position_ >= end_)
+      return Invalid();
+    *tag = static_cast<uint8_t>(data_[position_++]);
+    return true;
+  }
+
+  bool ReadUint32(uint32_t* value) {
+    const char* p;
+    if (!ReadBytes(4, &p))
+      return false;
+    *value = ReadLE32(p);
+    return true;
+  }
+
+  bool ReadDouble(double* value) {
+    const char* p;
+    if (!ReadBytes(sizeof(*value), &p))
+      return false;
+    memcpy(value, p, sizeof(*value));
+    return true;
+  }
+
+  bool ReadBytes(size_t length, const char** data) {
+    if (length > end_ - position_)
+      return Invalid();
+    *data = data_ + position_;
+    position_ += length;
+    return true;
+  }
+
+  // Checks that |count| items of at least one byte each can follow.
+  bool CheckCount(uint32_t count) {
+    return count <= end_ - position_ || Invalid();
+  }
+
+  bool ReadString(Local<String>* string);
+  bool ReadStringBody(uint8_t tag, Local<String>* string);
+  bool ReadView(uint8_t tag, Local<Value>* value);
+  bool ReadContainer(uint8_t tag, Local<Value>* value, int depth);
+
+  void Remember(Local<Object> object) {
+    objects_.push_back(object);
+  }
+
+  bool Invalid() {
+    env_->ThrowError("Unable to deserialize cloned data");
+    return false;
+  }
+
+  Environment* const env_;
+  Local<ArrayBuffer> buffer_;
+  const char* const data_;
+  size_t position_;
+  const size_t end_;
+  std::vector<Local<Object>> objects_;
+};
+
+
+bool Deserializer::ReadString(Local<String>* string) {
+  uint8_t tag;
+  return ReadTag(&tag) && ReadStringBody(tag, string);
+}
+
+
+bool Deserializer::ReadStringBody(uint8_t tag, Local<String>* string) {
+  uint32_t length;
+  const char* data;
+  if (tag == kOneByteString) {
+    if (!ReadUint32(&length) || !ReadBytes(length, &data))
+      return false;
+    return String::NewFromOneByte(env_->isolate(),
+                                  reinterpret_cast<const uint8_t*>(data),
+                                  v8::NewStringType::kNormal,
+                                  length).ToLocal(string) || Invalid();
+  }
+
+  if (tag != kTwoByteString)
+    return Invalid();
+  if (!ReadUint32(&length) ||
+      length > (end_ - position_) / sizeof(uint16_t) ||
+      !ReadBytes(length * sizeof(uint16_t), &data)) {
+    return Invalid();
+  }
+  // The code units need not be aligned in the buffer.
+  MaybeStackBuffer<uint16_t> storage;
+  storage.AllocateSufficientStorage(length);
+  memcpy(*storage, data, length * sizeof(uint16_t));
+  return String::NewFromTwoByte(env_->isolate(),
+                                *storage,
+                                v8::NewStringType::kNormal,
+                                length).ToLocal(string) || Invalid();
+}
+
+
+bool Deserializer::ReadView(uint8_t tag, Local<Value>* value) {
+  uint8_t type = kUint8Array;
+  uint32_t length;
+  const char* data;
+  if (tag == kTypedArray && !ReadTag(&type))
+    return false;
+  if (!ReadUint32(&length) || !ReadBytes(length, &data))
+    return false;
+
+  Local<Object> object;
+  if (tag == kBuffer) {
+    // A view on the received data, so that payloads aren't copied again.
+    Local<Uint8Array> buffer =
+        Uint8Array::New(buffer_, data - data_, length);
+    if (!buffer->SetPrototype(env_->context(),
+                              env_->buffer_prototype_object())
+            .FromMaybe(false)) {
+      return false;
+    }
+    object = buffer;
+  } else {
+    Local<ArrayBuffer> ab = ArrayBuffer::New(env_->isolate(), length);
+    if (length > 0)
+      memcpy(ab->GetContents().Data(), data, length);
+
+    if (tag == kArrayBuffer)
+      type = kArrayBufferType;
+    switch (type) {
+#define V(Type, size)                                                         \
+      case k##Type:                                                           \
+        if (length % size != 0)                                               \
+          return Invalid();                                                   \
+        object = Type::New(ab, 0, length / size);                             \
+        break;
+      V(Int8Array, 1)
+      V(Uint8Array, 1)
+      V(Uint8ClampedArray, 1)
+      V(Int16Array, 2)
+      V(Uint16Array, 2)
+      V(Int32Array, 4)
+      V(Uint32Array, 4)
+      V(Float32Array, 4)
+      V(Float64Array, 8)
+#undef V
+      case kDataView:
+        object = DataView::New(ab, 0, length);
+        break;
+      case kArrayBufferType:
+        object = ab;
+        break;
+      default:
+        return Invalid();
+    }
+  }
+
+  Remember(object);
+  *value = object;
+  return true;
+}
+
+
+bool Deserializer::ReadContainer(uint8_t tag, Local<Value>* value, int depth) {
+  Local<Context> context = env_->context();
+  uint32_t count;
+  if (!ReadUint32(&count) || !CheckCount(count))
+    return false;
+
+  if (tag == kArray) {
+    Local<Array> array = Array::New(env_->isolate(), count);
+    Remember(array);
+    for (uint32_t i = 0; i < count; i++) {
+      Local<Value> element;
+      if (!ReadValue(&element, depth + 1) ||
+          !array->Set(context, i, element).FromMaybe(false)) {
+        return false;
+      }
+    }
+    *value = array;
+  } else if (tag == kMap) {
+    Local<Map> map = Map::New(env_->isolate());
+    Remember(map);
+    for (uint32_t i = 0; i < count; i++) {
+      Local<Value> key;
+      Local<Value> val;
+      if (!ReadValue(&key, depth + 1) ||
+          !ReadValue(&val, depth + 1) ||
+          map->Set(context, key, val).IsEmpty()) {
+        return false;
+      }
+    }
+    *value = map;
+  } else if (tag == kSet) {
+    Local<Set> set = Set::New(env_->isolate());
+    Remember(set);
+    for (uint32_t i = 0; i < count; i++) {
+      Local<Value> element;
+      if (!ReadValue(&element, depth + 1) ||
+          set->Add(context, element).IsEmpty()) {
+        return false;
+      }
+    }
+    *value = set;
+  } else {
+    Local<Object> object = Object::New(env_->isolate());
+    Remember(object);
+    for (uint32_t i = 0; i < count; i++) {
+      Local<String> key;
+      Local<Value> val;
+      if (!ReadString(&key) ||
+          !ReadValue(&val, depth + 1) ||
+          !object->Set(context, key, val).FromMaybe(false)) {
+        return false;
+      }
+    }
+    *value = object;
+  }
+
+  return true;
+}
+
+
+bool Deserializer::ReadValue(Local<Value>* value, int depth) {
+  if (depth > kMaxDepth)
+    return Invalid();
+
+  uint8_t tag;
+  if (!ReadTag(&tag))
+    return false;
+
+  switch (tag) {
+    case kUndefined:
+      *value = Undefined(env_->isolate());
+      return true;
+    case kNull:
+      *value = Null(env_->isolate());
+      return true;
+    case kTrue:
+      *value = True(env_->isolate());
+      return true;
+    case kFalse:
+      *value = False(env_->isolate());
+      return true;
+    case kInt32: {
+      uint32_t bits;
+      if (!ReadUint32(&bits))
+        return false;
+      *value = Integer::New(env_->isolate(), static_cast<int32_t>(bits));
+      return true;
+    }
+    case kDouble: {
+      double number;
+      if (!ReadDouble(&number))
+        return false;
+      *value = Number::New(env_->isolate(), number);
+      return true;
+    }
+    case kOneByteString:
+    case kTwoByteString: {
+      Local<String> string;
+      if (!ReadStringBody(tag, &string))
+        return false;
+      *value = string;
+      return true;
+    }
+    case kDate: {
+      double time;
+      Local<Value> date;
+      if (!ReadDouble(&time) ||
+          !Date::New(env_->context(), time).ToLocal(&date)) {
+        return false;
+      }
+      Remember(date.As<Object>());
+      *value = date;
+      return true;
+    }
+    case kRegExp: {
+      Local<String> source;
+      uint32_t flags;
+      Local<RegExp> regexp;
+      if (!ReadString(&source) || !ReadUint32(&flags))
+        return false;
+      if (!RegExp::New(env_->context(),
+                       source,
+                       static_cast<RegExp::Flags>(flags)).ToLocal(&regexp)) {
+        return false;
+      }
+      Remember(regexp);
+      *value = regexp;
+      return true;
+    }
+    case kBuffer:
+    case kArrayBuffer:
+    case kTypedArray:
+      return ReadView(tag, value);
+    case kArray:
+    case kObject:
+    case kMap:
+    case kSet:
+      return ReadContainer(tag, value, depth);
+    case kReference: {
+      uint32_t id;
+      if (!ReadUint32(&id))
+        return false;
+      if (id >= objects_.size())
+        return Invalid();
+      *value = objects_[id];
+      return true;
+    }
+    default:
+      return Invalid();
+  }
+}
+
+
+bool Serialize(Environment* env,
+               Local<Value> value,
+               char** data,
+               size_t* length) {
+  Serializer serializer(env);
+  if (!serializer.WriteValue(value, 0))
+    return false;
+  *data = serializer.Release(length);
+  return true;
+}
+
+
+MaybeLocal<Value> Deserialize(Environment* env,
+                              Local<Uint8Array> buffer,
+                              size_t offset,
+                              size_t length) {
+  CHECK_LE(offset, buffer->ByteLength());
+  CHECK_LE(length, buffer->ByteLength() - offset);
+
+  Deserializer deserializer(env,
+                            buffer->Buffer(),
+                            buffer->ByteOffset() + offset,
+                            length);
+  Local<Value> value;
+  if (!deserializer.ReadValue(&value, 0))
+    return MaybeLocal<Value>();
+  if (!deserializer.AtEnd()) {
+    env->ThrowError("Unable to deserialize cloned data");
+    return MaybeLocal<Value>();
+  }
+  return value;
+}
+
+
+// serialize(value) returns a Buffer with the serialized |value|, preceded by
+// its length as a little-endian uint32.
+static void Serialize(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  char* data;
+  size_t length;
+  if (Serialize(env, args[0], &data, &length))
+    args.GetReturnValue().Set(Buffer::New(env, data, length).ToLocalChecked());
+}
+
+
+// deserialize(buffer, offset, length) reads the value that serialize() wrote
+// at |offset| into |buffer|, without the length that preceded it.
+static void Deserialize(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  if (!args[0]->IsUint8Array())
+    return env->ThrowTypeError("argument must be a buffer");
+
+  Local<Uint8Array> buffer = args[0].As<Uint8Array>();
+  const size_t buffer_length = buffer->ByteLength();
+  const int64_t offset = args[1]->IntegerValue();
+  const int64_t length = args[2]->IntegerValue();
+  if (offset < 0 || length < 0 ||
+      static_cast<uint64_t>(offset) > buffer_length ||
+      static_cast<uint64_t>(length) > buffer_length - offset) {
+    return env->ThrowRangeError("out of range index");
+  }
+
+  Local<Value> value;
+  if (Deserialize(env, buffer, offset, length).ToLocal(&value))
+    args.GetReturnValue().Set(value);
+}
+
+
+void Initialize(Local<Object> target,
+                Local<Value> unused,
+                Local<Context> context) {
+  Environment* env = Environment::GetCurrent(context);
+
+  env->SetMethod(target, "serialize", Serialize);
+  env->SetMethod(target, "deserialize", Deserialize);
+
+  target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "kHeaderSize"),
+              Integer::NewFromUnsigned(env->isolate(), kHeaderSize));
+}
+
+}  // namespace serdes
+}  // namespace node
+
+NODE_MODULE_CONTEXT_AWARE_BUILTIN(serdes, node::serdes::Initialize)
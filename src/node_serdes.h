@@ -0,0 +1,35 @@
+#ifndef SRC_NODE_SERDES_H_
+#define SRC_NODE_SERDES_H_
+
+#include "v8.h"
+
+#include <stddef.h>
+
+namespace node {
+
+class Environment;
+
+namespace serdes {
+
+// Size of the length that precedes every serialized value.
+static const size_t kHeaderSize = 4;
+
+// Serializes |value| into memory from malloc() that the caller owns, preceded
+// by its length.  Returns false with an exception pending if |value| can't be
+// cloned.
+bool Serialize(Environment* env,
+               v8::Local<v8::Value> value,
+               char** data,
+               size_t* length);
+
+// Reads a value that Serialize() wrote at |offset| into |buffer|, without the
+// length that preceded it.  Buffers in the result are views on |buffer|.
+v8::MaybeLocal<v8::Value> Deserialize(Environment* env,
+                                      v8::Local<v8::Uint8Array> buffer,
+                                      size_t offset,
+                                      size_t length);
+
+}  // namespace serdes
+}  // namespace node
+
+#endif  // SRC_NODE_SERDES_H_
@@ -0,0 +1,747 @@
+#include "node.h"
+#include "node_buffer.h"
+#include "node_internals.h"
+#include "base-object.h"
+#include "base-object-inl.h"
+#include "env.h"
+#include "env-inl.h"
+#include "util.h"
+#include "util-inl.h"
+#include "uv.h"
+#include "v8.h"
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <string>
+
+#ifndef _WIN32
+# include <fcntl.h>
+# include <pthread.h>
+# include <sys/mman.h>
+# include <sys/stat.h>
+# include <unistd.h>
+#endif
+
+namespace node {
+namespace sharedcache {
+
+using v8::Context;
+using v8::FunctionCallbackInfo;
+using v8::FunctionTemplate;
+using v8::Local;
+using v8::Number;
+using v8::Object;
+using v8::Value;
+
+// The segment starts with a CacheHeader, followed by |shard_count| shards of
+// |shard_size| bytes each.  A shard is a ShardHeader, |bucket_count| hash
+// buckets and |block_count| blocks of |block_size| bytes.  Everything in a
+// shard is protected by the lock of that shard, so processes only contend
+// when they touch keys that hash to the same shard.
+struct CacheHeader {
+  uint32_t magic;
+  uint32_t shard_count;
+  uint32_t bucket_count;
+  uint32_t block_count;
+  uint32_t block_size;
+  uint32_t shard_size;
+  uint64_t size;
+};
+
+#ifndef _WIN32
+
+struct ShardHeader {
+  pthread_mutex_t lock;
+  uint32_t lru_head;  // The most recently used entry.
+  uint32_t lru_tail;  // The entry that is evicted next.
+  uint32_t free_head;
+  uint32_t free_count;
+  uint32_t entries;
+  uint64_t hits;
+  uint64_t misses;
+  uint64_t evictions;
+};
+
+// An entry is a chain of blocks that holds its key followed by its value.
+// Every block starts with the index of the next block in the chain, or of
+// the next free block.  The first block of an entry has the rest of this
+// header as well.
+struct Entry {
+  uint32_t next_block;
+  uint32_t bucket_next;
+  uint32_t lru_prev;
+  uint32_t lru_next;
+  uint32_t hash;
+  uint32_t key_length;
+  uint32_t value_length;
+};
+
+static const uint32_t kMagic = 0x4c525543;  // "LRUC"
+static const uint32_t kNil = 0xffffffff;
+static const size_t kHeaderSize = (sizeof(CacheHeader) + 63) & ~63;
+static const size_t kShardHeaderSize = (sizeof(ShardHeader) + 63) & ~63;
+static const uint32_t kBlockSize = 128;
+static const uint32_t kMaxShards = 16;
+static const size_t kFirstBlockData = kBlockSize - sizeof(Entry);
+static const size_t kNextBlockData = kBlockSize - sizeof(uint32_t);
+static const size_t kMinSize = 64 * 1024;
+static const size_t kMaxSize = 1 << 30;
+
+#endif  // _WIN32
+
+
+class SharedCache : public BaseObject {
+ public:
+  ~SharedCache() override {
+    Unmap();
+  }
+
+  static void Initialize(Environment* env, Local<Object> target);
+
+ private:
+  SharedCache(Environment* env, Local<Object> wrap)
+      : BaseObject(env, wrap),
+        header_(nullptr),
+        mapped_size_(0) {
+    MakeWeak<SharedCache>(this);
+  }
+
+  static void New(const FunctionCallbackInfo<Value>& args);
+  static void Create(const FunctionCallbackInfo<Value>& args);
+  static void Open(const FunctionCallbackInfo<Value>& args);
+  static void Unlink(const FunctionCallbackInfo<Value>& args);
+  static void Close(const FunctionCallbackInfo<Value>& args);
+  static void Get(const FunctionCallbackInfo<Value>& args);
+  static void Set(const FunctionCallbackInfo<Value>& args);
+  static void Delete(const FunctionCallbackInfo<Value>& args);
+  static void Stats(const FunctionCallbackInfo<Value>& args);
+  static void MaxEntrySize(const FunctionCallbackInfo<Value>& args);
+
+#ifndef _WIN32
+  struct Shard {
+    ShardHeader* header;
+    uint32_t* buckets;
+    char* blocks;
+  };
+
+  class ScopedLock;
+
+  int Map(int fd, size_t size);
+  Shard ShardFor(uint32_t index) const;
+  Shard ShardForHash(uint64_t hash) const;
+  Entry* EntryAt(const Shard& shard, uint32_t index) const;
+  uint32_t BlocksFor(size_t length) const;
+  void Reset(const Shard& shard) const;
+  uint32_t Find(const Shard& shard, uint32_t hash,
+                const char* key, size_t key_length) const;
+  void Remove(const Shard& shard, uint32_t index) const;
+  void Touch(const Shard& shard, uint32_t index) const;
+  template <typename Fn>
+  bool Walk(const Shard& shard, uint32_t index,
+            size_t offset, size_t length, Fn fn) const;
+#endif
+  void Unmap();
+
+  CacheHeader* header_;
+  size_t mapped_size_;
+  std::string name_;
+};
+
+
+void SharedCache::Initialize(Environment* env, Local<Object> target) {
+  Local<FunctionTemplate> t = env->NewFunctionTemplate(New);
+  t->InstanceTemplate()->SetInternalFieldCount(1);
+
+  env->SetProtoMethod(t, "create", Create);
+  env->SetProtoMethod(t, "open", Open);
+  env->SetProtoMethod(t, "unlink", Unlink);
+  env->SetProtoMethod(t, "close", Close);
+  env->SetProtoMethod(t, "get", Get);
+  env->SetProtoMethod(t, "set", Set);
+  env->SetProtoMethod(t, "delete", Delete);
+  env->SetProtoMethod(t, "stats", Stats);
+  env->SetProtoMethod(t, "maxEntrySize", MaxEntrySize);
+
+  target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "SharedCache"),
+              t->GetFunction());
+}
+
+
+void SharedCache::New(const FunctionCallbackInfo<Value>& args) {
+  CHECK(args.IsConstructCall());
+  Environment* env = Environment::GetCurrent(args);
+  new SharedCache(env, args.This());
+}
+
+
+#ifndef _WIN32
+
+// Locks a shard.  When the process that held the lock died with it, the
+// shard may be halfway through an update, so it is emptied.
+class SharedCache::ScopedLock {
+ public:
+  ScopedLock(const SharedCache* cache, const Shard& shard)
+      : lock_(&shard.header->lock) {
+    int err = pthread_mutex_lock(lock_);
+#ifdef __linux__
+    if (err == EOWNERDEAD) {
+      cache->Reset(shard);
+      err = pthread_mutex_consistent(lock_);
+    }
+#endif
+    CHECK_EQ(err, 0);
+  }
+
+  ~ScopedLock() {
+    CHECK_EQ(pthread_mutex_unlock(lock_), 0);
+  }
+
+ private:
+  pthread_mutex_t* lock_;
+  DISALLOW_COPY_AND_ASSIGN(ScopedLock);
+};
+
+
+// FNV-1a.  The low half picks the shard and the high half the bucket.
+static uint64_t Hash(const char* data, size_t length) {
+  uint64_t hash = 14695981039346656037ULL;
+  for (size_t i = 0; i < length; i++) {
+    hash ^= static_cast<uint8_t>(data[i]);
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+
+int SharedCache::Map(int fd, size_t size) {
+  void* address =
+      mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (address == MAP_FAILED)
+    return -errno;
+  header_ = static_cast<CacheHeader*>(address);
+  mapped_size_ = size;
+  return 0;
+}
+
+
+void SharedCache::Unmap() {
+  if (header_ == nullptr)
+    return;
+  munmap(header_, mapped_size_);
+  header_ = nullptr;
+}
+
+
+SharedCache::Shard SharedCache::ShardFor(uint32_t index) const {
+  char* base = reinterpret_cast<char*>(header_) + kHeaderSize +
+               static_cast<size_t>(index) * header_->shard_size;
+  Shard shard;
+  shard.header = reinterpret_cast<ShardHeader*>(base);
+  shard.buckets = reinterpret_cast<uint32_t*>(base + kShardHeaderSize);
+  shard.blocks = reinterpret_cast<char*>(shard.buckets + header_->bucket_count);
+  return shard;
+}
+
+
+SharedCache::Shard SharedCache::ShardForHash(uint64_t hash) const {
+  return ShardFor(static_cast<uint32_t>(hash) % header_->shard_count);
+}
+
+
+Entry* SharedCache::EntryAt(const Shard& shard, uint32_t index) const {
+  return reinterpret_cast<Entry*>(
+      shard.blocks + static_cast<size_t>(index) * header_->block_size);
+}
+
+
+uint32_t SharedCache::BlocksFor(size_t length) const {
+  if (length <= kFirstBlockData)
+    return 1;
+  return 1 + (length - kFirstBlockData + kNextBlockData - 1) / kNextBlockData;
+}
+
+
+void SharedCache::Reset(const Shard& shard) const {
+  ShardHeader* header = shard.header;
+  for (uint32_t i = 0; i < header_->bucket_count; i++)
+    shard.buckets[i] = kNil;
+  for (uint32_t i = 0; i < header_->block_count; i++)
+    EntryAt(shard, i)->next_block = i + 1 < header_->block_count ? i + 1 : kNil;
+  header->lru_head = kNil;
+  header->lru_tail = kNil;
+  header->free_head = 0;
+  header->free_count = header_->block_count;
+  header->entries = 0;
+}
+
+
+// Calls fn(data, length) for the bytes [offset, offset + length) of the entry
+// that starts at block |index|, until fn returns false.
+template <typename Fn>
+bool SharedCache::Walk(const Shard& shard, uint32_t index,
+                       size_t offset, size_t length, Fn fn) const {
+  if (length == 0)
+    return true;
+  char* data = reinterpret_cast<char*>(EntryAt(shard, index)) + sizeof(Entry);
+  size_t capacity = kFirstBlockData;
+  while (offset >= capacity) {
+    offset -= capacity;
+    index = EntryAt(shard, index)->next_block;
+    data = reinterpret_cast<char*>(EntryAt(shard, index)) + sizeof(uint32_t);
+    capacity = kNextBlockData;
+  }
+  while (length > 0) {
+    const size_t n = length < capacity - offset ? length : capacity - offset;
+    if (!fn(data + offset, n))
+      return false;
+    length -= n;
+    if (length == 0)
+      break;
+    index = EntryAt(shard, index)->next_block;
+    data = reinterpret_cast<char*>(EntryAt(shard, index)) + sizeof(uint32_t);
+    capacity = kNextBlockData;
+    offset = 0;
+  }
+  return true;
+}
+
+
+uint32_t SharedCache::Find(const Shard& shard, uint32_t hash,
+                           const char* key, size_t key_length) const {
+  uint32_t index = shard.buckets[hash % header_->bucket_count];
+  while (index != kNil) {
+    Entry* entry = EntryAt(shard, index);
+    if (entry->hash == hash && entry->key_length == key_length) {
+      const char* rest = key;
+      const bool equal = Walk(shard, index, 0, key_length,
+                              [&rest] (const char* data, size_t n) {
+        const bool same = memcmp(data, rest, n) == 0;
+        rest += n;
+        return same;
+      });
+      if (equal)
+        return index;
+    }
+    index = entry->bucket_next;
+  }
+  return kNil;
+}
+
+
+// Takes an entry out of its bucket and the LRU list and frees its blocks.
+void SharedCache::Remove(const Shard& shard, uint32_t index) const {
+  ShardHeader* header = shard.header;
+  Entry* entry = EntryAt(shard, index);
+
+  uint32_t* link = &shard.buckets[entry->hash % header_->bucket_count];
+  while (*link != index)
+    link = &EntryAt(shard, *link)->bucket_next;
+  *link = entry->bucket_next;
+
+  if (entry->lru_prev == kNil)
+    header->lru_head = entry->lru_next;
+  else
+    EntryAt(shard, entry->lru_prev)->lru_next = entry->lru_next;
+  if (entry->lru_next == kNil)
+    header->lru_tail = entry->lru_prev;
+  else
+    EntryAt(shard, entry->lru_next)->lru_prev = entry->lru_prev;
+
+  uint32_t last = index;
+  uint32_t count = 1;
+  while (EntryAt(shard, last)->next_block != kNil) {
+    last = EntryAt(shard, last)->next_block;
+    count += 1;
+  }
+  EntryAt(shard, last)->next_block = header->free_head;
+  header->free_head = index;
+  header->free_count += count;
+  header->entries -= 1;
+}
+
+
+// Moves an entry to the front of the LRU list.
+void SharedCache::Touch(const Shard& shard, uint32_t index) const {
+  ShardHeader* header = shard.header;
+  Entry* entry = EntryAt(shard, index);
+  if (header->lru_head == index)
+    return;
+
+  EntryAt(shard, entry->lru_prev)->lru_next = entry->lru_next;
+  if (entry->lru_next == kNil)
+    header->lru_tail = entry->lru_prev;
+  else
+    EntryAt(shard, entry->lru_next)->lru_prev = entry->lru_prev;
+
+  entry->lru_prev = kNil;
+  entry->lru_next = header->lru_head;
+  EntryAt(shard, header->lru_head)->lru_prev = index;
+  header->lru_head = index;
+}
+
+
+// create(size) creates and maps a new cache of about |size| bytes and returns
+// its name, or an error code.
+void SharedCache::Create(const FunctionCallbackInfo<Value>& args) {
+  SharedCache* cache = Unwrap<SharedCache>(args.Holder());
+  CHECK_EQ(cache->header_, nullptr);
+  CHECK(args[0]->IsNumber());
+
+  size_t size = static_cast<size_t>(args[0]->NumberValue());
+  if (size < kMinSize)
+    size = kMinSize;
+  if (size > kMaxSize)
+    size = kMaxSize;
+
+  // About one bucket for every two blocks.
+  const uint32_t shard_count =
+      size >= kMaxShards * kMinSize ? kMaxShards : size / kMinSize;
+  const size_t budget = (size - kHeaderSize) / shard_count - kShardHeaderSize;
+  const uint32_t block_count = budget / (kBlockSize + sizeof(uint32_t) / 2);
+  const uint32_t bucket_count = block_count / 2;
+  const size_t shard_size =
+      (kShardHeaderSize + bucket_count * sizeof(uint32_t) +
+       static_cast<size_t>(block_count) * kBlockSize + 63) & ~63;
+  size = kHeaderSize + shard_count * shard_size;
+
+  static unsigned int counter;
+  char name[64];
+  int fd;
+  do {
+    snprintf(name, sizeof(name), "/node-cache-%d-%u",
+             static_cast<int>(getpid()), counter++);
+    fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, S_IRUSR | S_IWUSR);
+  } while (fd == -1 && errno == EEXIST);
+  if (fd == -1)
+    return args.GetReturnValue().Set(-errno);
+
+  int err = 0;
+  if (ftruncate(fd, size) == -1)
+    err = -errno;
+  if (err == 0)
+    err = cache->Map(fd, size);
+  close(fd);
+  if (err != 0) {
+    shm_unlink(name);
+    return args.GetReturnValue().Set(err);
+  }
+
+  CacheHeader* header = cache->header_;
+  header->shard_count = shard_count;
+  header->bucket_count = bucket_count;
+  header->block_count = block_count;
+  header->block_size = kBlockSize;
+  header->shard_size = shard_size;
+  header->size = size;
+
+  pthread_mutexattr_t attr;
+  CHECK_EQ(pthread_mutexattr_init(&attr), 0);
+  CHECK_EQ(pthread_mutexattr_setpshared(&attr, PTHREAD_PROCESS_SHARED), 0);
+#ifdef __linux__
+  CHECK_EQ(pthread_mutexattr_setrobust(&attr, PTHREAD_MUTEX_ROBUST), 0);
+#endif
+  for (uint32_t i = 0; i < shard_count; i++) {
+    Shard shard = cache->ShardFor(i);
+    CHECK_EQ(pthread_mutex_init(&shard.header->lock, &attr), 0);
+    cache->Reset(shard);
+  }
+  pthread_mutexattr_destroy(&attr);
+  // Set last, open() refuses a cache that isn't initialized yet.
+  header->magic = kMagic;
+
+  cache->name_ = name;
+  args.GetReturnValue().Set(OneByteString(cache->env()->isolate(), name));
+}
+
+
+// open(name) maps a cache that another process created.
+void SharedCache::Open(const FunctionCallbackInfo<Value>& args) {
+  SharedCache* cache = Unwrap<SharedCache>(args.Holder());
+  CHECK_EQ(cache->header_, nullptr);
+  CHECK(args[0]->IsString());
+
+  node::Utf8Value name(cache->env()->isolate(), args[0]);
+  const int fd = shm_open(*name, O_RDWR, 0);
+  if (fd == -1)
+    return args.GetReturnValue().Set(-errno);
+
+  struct stat s;
+  int err = 0;
+  if (fstat(fd, &s) == -1)
+    err = -errno;
+  else if (static_cast<size_t>(s.st_size) < kHeaderSize + kShardHeaderSize)
+    err = UV_EINVAL;
+  if (err == 0)
+    err = cache->Map(fd, s.st_size);
+  close(fd);
+
+  if (err == 0 &&
+      (cache->header_->magic != kMagic ||
+       cache->header_->block_size != kBlockSize ||
+       cache->header_->size != cache->mapped_size_)) {
+    cache->Unmap();
+    err = UV_EINVAL;
+  }
+
+  args.GetReturnValue().Set(err);
+}
+
+
+// unlink() removes the name of a cache from create(), the mappings stay.
+void SharedCache::Unlink(const FunctionCallbackInfo<Value>& args) {
+  SharedCache* cache = Unwrap<SharedCache>(args.Holder());
+  if (cache->name_.empty())
+    return args.GetReturnValue().Set(0);
+  const int err = shm_unlink(cache->name_.c_str()) == -1 ? -errno : 0;
+  cache->name_.clear();
+  args.GetReturnValue().Set(err);
+}
+
+
+// The key is a string or a Buffer.
+#define KEY_ARG(cache, arg)                                                   \
+  node::Utf8Value key_string((cache)->env()->isolate(),                       \
+                             (arg)->IsString() ? (arg) : Local<Value>());     \
+  const char* key = Buffer::HasInstance(arg) ? Buffer::Data(arg)              \
+                                             : *key_string;                   \
+  const size_t key_length = Buffer::HasInstance(arg) ? Buffer::Length(arg)    \
+                                                     : key_string.length();
+
+
+// get(key) returns a copy of the value, or undefined.
+void SharedCache::Get(const FunctionCallbackInfo<Value>& args) {
+  SharedCache* cache = Unwrap<SharedCache>(args.Holder());
+  CHECK_NE(cache->header_, nullptr);
+  KEY_ARG(cache, args[0]);
+
+  const uint64_t hash = Hash(key, key_length);
+  const Shard shard = cache->ShardForHash(hash);
+  char* data = nullptr;
+  size_t length = 0;
+  {
+    ScopedLock lock(cache, shard);
+    const uint32_t index =
+        cache->Find(shard, hash >> 32, key, key_length);
+    if (index == kNil) {
+      shard.header->misses += 1;
+      return;
+    }
+    shard.header->hits += 1;
+    cache->Touch(shard, index);
+
+    // Copied out under the lock, but into memory from malloc() rather than
+    // a Buffer, so that nothing in here can start a garbage collection.
+    length = cache->EntryAt(shard, index)->value_length;
+    if (length > 0) {
+      data = static_cast<char*>(malloc(length));
+      CHECK_NE(data, nullptr);
+      char* out = data;
+      cache->Walk(shard, index, key_length, length,
+                  [&out] (const char* chunk, size_t n) {
+        memcpy(out, chunk, n);
+        out += n;
+        return true;
+      });
+    }
+  }
+
+  Local<Object> buffer;
+  if (data == nullptr)
+    buffer = Buffer::New(cache->env(), 0).ToLocalChecked();
+  else
+    buffer = Buffer::New(cache->env(), data, length).ToLocalChecked();
+  args.GetReturnValue().Set(buffer);
+}
+
+
+// set(key, value) stores a copy of |value|, evicting the least recently used
+// entries of the shard to make room.  Returns false if it's too large.
+void SharedCache::Set(const FunctionCallbackInfo<Value>& args) {
+  SharedCache* cache = Unwrap<SharedCache>(args.Holder());
+  CHECK_NE(cache->header_, nullptr);
+  CHECK(Buffer::HasInstance(args[1]));
+  KEY_ARG(cache, args[0]);
+
+  const char* value = Buffer::Data(args[1]);
+  const size_t value_length = Buffer::Length(args[1]);
+  const uint32_t needed = cache->BlocksFor(key_length + value_length);
+  if (needed > cache->header_->block_count)
+    return args.GetReturnValue().Set(false);
+
+  const uint64_t hash = Hash(key, key_length);
+  const Shard shard = cache->ShardForHash(hash);
+  ShardHeader* header = shard.header;
+  ScopedLock lock(cache, shard);
+
+  uint32_t index = cache->Find(shard, hash >> 32, key, key_length);
+  if (index != kNil)
+    cache->Remove(shard, index);
+  while (header->free_count < needed) {
+    cache->Remove(shard, header->lru_tail);
+    header->evictions += 1;
+  }
+
+  // Take the blocks off the free list.
+  index = header->free_head;
+  uint32_t last = index;
+  for (uint32_t i = 1; i < needed; i++)
+    last = cache->EntryAt(shard, last)->next_block;
+  header->free_head = cache->EntryAt(shard, last)->next_block;
+  header->free_count -= needed;
+  cache->EntryAt(shard, last)->next_block = kNil;
+
+  Entry* entry = cache->EntryAt(shard, index);
+  entry->hash = hash >> 32;
+  entry->key_length = key_length;
+  entry->value_length = value_length;
+  const char* in = key;
+  cache->Walk(shard, index, 0, key_length,
+              [&in] (char* chunk, size_t n) {
+    memcpy(chunk, in, n);
+    in += n;
+    return true;
+  });
+  in = value;
+  cache->Walk(shard, index, key_length, value_length,
+              [&in] (char* chunk, size_t n) {
+    memcpy(chunk, in, n);
+    in += n;
+    return true;
+  });
+
+  uint32_t* bucket = &shard.buckets[entry->hash % cache->header_->bucket_count];
+  entry->bucket_next = *bucket;
+  *bucket = index;
+  entry->lru_prev = kNil;
+  entry->lru_next = header->lru_head;
+  if (header->lru_head == kNil)
+    header->lru_tail = index;
+  else
+    cache->EntryAt(shard, header->lru_head)->lru_prev = index;
+  header->lru_head = index;
+  header->entries += 1;
+
+  args.GetReturnValue().Set(true);
+}
+
+
+// delete(key) returns true if there was an entry for |key|.
+void SharedCache::Delete(const FunctionCallbackInfo<Value>& args) {
+  SharedCache* cache = Unwrap<SharedCache>(args.Holder());
+  CHECK_NE(cache->header_, nullptr);
+  KEY_ARG(cache, args[0]);
+
+  const uint64_t hash = Hash(key, key_length);
+  const Shard shard = cache->ShardForHash(hash);
+  ScopedLock lock(cache, shard);
+  const uint32_t index = cache->Find(shard, hash >> 32, key, key_length);
+  if (index != kNil)
+    cache->Remove(shard, index);
+  args.GetReturnValue().Set(index != kNil);
+}
+
+#undef KEY_ARG
+
+
+// stats(array) fills |array| with the entries, hits, misses and evictions of
+// all shards together.
+void SharedCache::Stats(const FunctionCallbackInfo<Value>& args) {
+  SharedCache* cache = Unwrap<SharedCache>(args.Holder());
+  Environment* env = cache->env();
+  CHECK_NE(cache->header_, nullptr);
+  CHECK(args[0]->IsArray());
+
+  double totals[4] = { 0, 0, 0, 0 };
+  for (uint32_t i = 0; i < cache->header_->shard_count; i++) {
+    const Shard shard = cache->ShardFor(i);
+    ScopedLock lock(cache, shard);
+    totals[0] += shard.header->entries;
+    totals[1] += shard.header->hits;
+    totals[2] += shard.header->misses;
+    totals[3] += shard.header->evictions;
+  }
+
+  Local<Object> list = args[0].As<Object>();
+  for (uint32_t i = 0; i < arraysize(totals); i++) {
+    list->Set(env->context(), i,
+              Number::New(env->isolate(), totals[i])).FromJust();
+  }
+}
+
+
+void SharedCache::MaxEntrySize(const FunctionCallbackInfo<Value>& args) {
+  SharedCache* cache = Unwrap<SharedCache>(args.Holder());
+  CHECK_NE(cache->header_, nullptr);
+  args.GetReturnValue().Set(static_cast<double>(
+      kFirstBlockData + (cache->header_->block_count - 1) * kNextBlockData));
+}
+
+#else  // _WIN32
+
+void SharedCache::Unmap() {
+}
+
+
+void SharedCache::Create(const FunctionCallbackInfo<Value>& args) {
+  args.GetReturnValue().Set(UV_ENOSYS);
+}
+
+
+void SharedCache::Open(const FunctionCallbackInfo<Value>& args) {
+  args.GetReturnValue().Set(UV_ENOSYS);
+}
+
+
+void SharedCache::Unlink(const FunctionCallbackInfo<Value>& args) {
+  args.GetReturnValue().Set(UV_ENOSYS);
+}
+
+
+void SharedCache::Get(const FunctionCallbackInfo<Value>& args) {
+  UNREACHABLE();
+}
+
+
+void SharedCache::Set(const FunctionCallbackInfo<Value>& args) {
+  UNREACHABLE();
+}
+
+
+void SharedCache::Delete(const FunctionCallbackInfo<Value>& args) {
+  UNREACHABLE();
+}
+
+
+void SharedCache::Stats(const FunctionCallbackInfo<Value>& args) {
+  UNREACHABLE();
+}
+
+
+void SharedCache::MaxEntrySize(const FunctionCallbackInfo<Value>& args) {
+  UNREACHABLE();
+}
+
+#endif  // _WIN32
+
+
+void SharedCache::Close(const FunctionCallbackInfo<Value>& args) {
+  SharedCache* cache = Unwrap<SharedCache>(args.Holder());
+  cache->Unmap();
+}
+
+
+void Initialize(Local<Object> target,
+                Local<Value> unused,
+                Local<Context> context) {
+  Environment* env = Environment::GetCurrent(context);
+  SharedCache::Initialize(env, target);
+}
+
+}  // namespace sharedcache
+}  // namespace node
+
+NODE_MODULE_CONTEXT_AWARE_BUILTIN(shared_cache, node::sharedcache::Initialize)
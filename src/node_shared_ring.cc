@@ -0,0 +1,433 @@
+#include "node.h"
+#include "node_buffer.h"
+#include "node_internals.h"
+#include "base-object.h"
+#include "base-object-inl.h"
+#include "env.h"
+#include "env-inl.h"
+#include "util.h"
+#include "util-inl.h"
+#include "uv.h"
+#include "v8.h"
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <atomic>
+#include <new>
+#include <string>
+
+#ifndef _WIN32
+# include <fcntl.h>
+# include <sys/mman.h>
+# include <sys/socket.h>
+# include <sys/stat.h>
+# include <unistd.h>
+#endif
+
+namespace node {
+namespace sharedring {
+
+using v8::Array;
+using v8::Context;
+using v8::FunctionCallbackInfo;
+using v8::FunctionTemplate;
+using v8::Integer;
+using v8::Local;
+using v8::Object;
+using v8::String;
+using v8::Value;
+
+// The start of the shared memory segment.  head and tail count the bytes
+// that were written and read so far, and are only stored by the producer
+// and the consumer respectively.  They live on cache lines of their own.
+// A side that runs out of data or space sets its waiting flag and rechecks;
+// the other side wakes it up when it sees the flag.
+struct RingHeader {
+  std::atomic<uint64_t> head;
+  char head_padding[64 - sizeof(uint64_t)];
+  std::atomic<uint64_t> tail;
+  char tail_padding[64 - sizeof(uint64_t)];
+  std::atomic<uint32_t> consumer_waiting;
+  std::atomic<uint32_t> producer_waiting;
+  uint32_t capacity;
+  uint32_t magic;
+};
+
+static const uint32_t kMagic = 0x52494e47;  // "RING"
+static const size_t kDataOffset = (sizeof(RingHeader) + 63) & ~63;
+static const size_t kMinCapacity = 4096;
+static const size_t kMaxCapacity = 1 << 30;
+// Every message is preceded by its length.
+static const size_t kRecordHeaderSize = sizeof(uint32_t);
+
+enum WriteResult {
+  kWritten,
+  kWrittenWake,  // The consumer was waiting and must be woken up.
+  kFull,
+};
+
+
+class SharedRing : public BaseObject {
+ public:
+  ~SharedRing() override {
+    Unmap();
+  }
+
+  static void Initialize(Environment* env, Local<Object> target);
+
+ private:
+  SharedRing(Environment* env, Local<Object> wrap)
+      : BaseObject(env, wrap),
+        header_(nullptr),
+        data_(nullptr),
+        mapped_size_(0),
+        capacity_(0) {
+    MakeWeak<SharedRing>(this);
+  }
+
+  static void New(const FunctionCallbackInfo<Value>& args);
+  static void Create(const FunctionCallbackInfo<Value>& args);
+  static void Open(const FunctionCallbackInfo<Value>& args);
+  static void Unlink(const FunctionCallbackInfo<Value>& args);
+  static void Close(const FunctionCallbackInfo<Value>& args);
+  static void Write(const FunctionCallbackInfo<Value>& args);
+  static void Read(const FunctionCallbackInfo<Value>& args);
+  static void MaxMessageSize(const FunctionCallbackInfo<Value>& args);
+
+  int Map(int fd, size_t size);
+  void Unmap();
+  WriteResult Push(const char* data, uint32_t length);
+  void CopyIn(uint64_t position, const char* data, size_t length);
+  void CopyOut(uint64_t position, char* data, size_t length);
+
+  RingHeader* header_;
+  char* data_;
+  size_t mapped_size_;
+  uint64_t capacity_;
+  std::string name_;
+};
+
+
+void SharedRing::Initialize(Environment* env, Local<Object> target) {
+  Local<FunctionTemplate> t = env->NewFunctionTemplate(New);
+  t->InstanceTemplate()->SetInternalFieldCount(1);
+
+  env->SetProtoMethod(t, "create", Create);
+  env->SetProtoMethod(t, "open", Open);
+  env->SetProtoMethod(t, "unlink", Unlink);
+  env->SetProtoMethod(t, "close", Close);
+  env->SetProtoMethod(t, "write", Write);
+  env->SetProtoMethod(t, "read", Read);
+  env->SetProtoMethod(t, "maxMessageSize", MaxMessageSize);
+
+  target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "SharedRing"),
+              t->GetFunction());
+}
+
+
+void SharedRing::New(const FunctionCallbackInfo<Value>& args) {
+  CHECK(args.IsConstructCall());
+  Environment* env = Environment::GetCurrent(args);
+  new SharedRing(env, args.This());
+}
+
+
+#ifndef _WIN32
+
+int SharedRing::Map(int fd, size_t size) {
+  void* address =
+      mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (address == MAP_FAILED)
+    return -errno;
+  header_ = static_cast<RingHeader*>(address);
+  data_ = static_cast<char*>(address) + kDataOffset;
+  mapped_size_ = size;
+  return 0;
+}
+
+
+void SharedRing::Unmap() {
+  if (header_ == nullptr)
+    return;
+  munmap(header_, mapped_size_);
+  header_ = nullptr;
+  data_ = nullptr;
+}
+
+
+// create(size) creates and maps a new segment of at least |size| bytes and
+// returns its name, or an error code.
+void SharedRing::Create(const FunctionCallbackInfo<Value>& args) {
+  SharedRing* ring = Unwrap<SharedRing>(args.Holder());
+  CHECK_EQ(ring->header_, nullptr);
+  CHECK(args[0]->IsUint32());
+
+  size_t capacity = kMinCapacity;
+  while (capacity < args[0]->Uint32Value() && capacity < kMaxCapacity)
+    capacity *= 2;
+
+  static unsigned int counter;
+  char name[64];
+  int fd;
+  do {
+    snprintf(name, sizeof(name), "/node-ring-%d-%u",
+             static_cast<int>(getpid()), counter++);
+    fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, S_IRUSR | S_IWUSR);
+  } while (fd == -1 && errno == EEXIST);
+  if (fd == -1)
+    return args.GetReturnValue().Set(-errno);
+
+  const size_t size = kDataOffset + capacity;
+  int err = 0;
+  if (ftruncate(fd, size) == -1)
+    err = -errno;
+  if (err == 0)
+    err = ring->Map(fd, size);
+  close(fd);
+  if (err != 0) {
+    shm_unlink(name);
+    return args.GetReturnValue().Set(err);
+  }
+
+  RingHeader* header = new(ring->header_) RingHeader();
+  header->head.store(0);
+  header->tail.store(0);
+  // The first message wakes up the consumer.
+  header->consumer_waiting.store(1);
+  header->producer_waiting.store(0);
+  header->capacity = capacity;
+  header->magic = kMagic;
+
+  ring->capacity_ = capacity;
+  ring->name_ = name;
+  args.GetReturnValue().Set(OneByteString(ring->env()->isolate(), name));
+}
+
+
+// open(name) maps a segment that another process created.
+void SharedRing::Open(const FunctionCallbackInfo<Value>& args) {
+  SharedRing* ring = Unwrap<SharedRing>(args.Holder());
+  CHECK_EQ(ring->header_, nullptr);
+  CHECK(args[0]->IsString());
+
+  node::Utf8Value name(ring->env()->isolate(), args[0]);
+  const int fd = shm_open(*name, O_RDWR, 0);
+  if (fd == -1)
+    return args.GetReturnValue().Set(-errno);
+
+  struct stat s;
+  int err = 0;
+  if (fstat(fd, &s) == -1)
+    err = -errno;
+  else if (static_cast<size_t>(s.st_size) < kDataOffset + kMinCapacity)
+    err = UV_EINVAL;
+  if (err == 0)
+    err = ring->Map(fd, s.st_size);
+  close(fd);
+
+  if (err == 0 &&
+      (ring->header_->magic != kMagic ||
+       kDataOffset + ring->header_->capacity != ring->mapped_size_)) {
+    ring->Unmap();
+    err = UV_EINVAL;
+  }
+  if (err == 0)
+    ring->capacity_ = ring->header_->capacity;
+
+  args.GetReturnValue().Set(err);
+}
+
+
+// unlink() removes the name of a segment from create(), the mappings stay.
+void SharedRing::Unlink(const FunctionCallbackInfo<Value>& args) {
+  SharedRing* ring = Unwrap<SharedRing>(args.Holder());
+  if (ring->name_.empty())
+    return args.GetReturnValue().Set(0);
+  const int err = shm_unlink(ring->name_.c_str()) == -1 ? -errno : 0;
+  ring->name_.clear();
+  args.GetReturnValue().Set(err);
+}
+
+#else  // _WIN32
+
+int SharedRing::Map(int fd, size_t size) {
+  return UV_ENOSYS;
+}
+
+
+void SharedRing::Unmap() {
+}
+
+
+void SharedRing::Create(const FunctionCallbackInfo<Value>& args) {
+  args.GetReturnValue().Set(UV_ENOSYS);
+}
+
+
+void SharedRing::Open(const FunctionCallbackInfo<Value>& args) {
+  args.GetReturnValue().Set(UV_ENOSYS);
+}
+
+
+void SharedRing::Unlink(const FunctionCallbackInfo<Value>& args) {
+  args.GetReturnValue().Set(UV_ENOSYS);
+}
+
+#endif  // _WIN32
+
+
+void SharedRing::Close(const FunctionCallbackInfo<Value>& args) {
+  SharedRing* ring = Unwrap<SharedRing>(args.Holder());
+  ring->Unmap();
+}
+
+
+void SharedRing::MaxMessageSize(const FunctionCallbackInfo<Value>& args) {
+  SharedRing* ring = Unwrap<SharedRing>(args.Holder());
+  CHECK_NE(ring->header_, nullptr);
+  args.GetReturnValue().Set(
+      static_cast<double>(ring->capacity_ - kRecordHeaderSize));
+}
+
+
+void SharedRing::CopyIn(uint64_t position, const char* data, size_t length) {
+  const size_t offset = position & (capacity_ - 1);
+  const size_t room = capacity_ - offset;
+  const size_t first = length < room ? length : room;
+  memcpy(data_ + offset, data, first);
+  memcpy(data_, data + first, length - first);
+}
+
+
+void SharedRing::CopyOut(uint64_t position, char* data, size_t length) {
+  const size_t offset = position & (capacity_ - 1);
+  const size_t room = capacity_ - offset;
+  const size_t first = length < room ? length : room;
+  memcpy(data, data_ + offset, first);
+  memcpy(data + first, data_, length - first);
+}
+
+
+WriteResult SharedRing::Push(const char* data, uint32_t length) {
+  const uint64_t size = kRecordHeaderSize + length;
+  const uint64_t head = header_->head.load(std::memory_order_relaxed);
+  uint64_t tail = header_->tail.load(std::memory_order_acquire);
+
+  if (capacity_ - (head - tail) < size) {
+    header_->producer_waiting.store(1);
+    tail = header_->tail.load();
+    if (capacity_ - (head - tail) < size)
+      return kFull;
+    header_->producer_waiting.store(0, std::memory_order_relaxed);
+  }
+
+  CopyIn(head, reinterpret_cast<const char*>(&length), kRecordHeaderSize);
+  CopyIn(head + kRecordHeaderSize, data, length);
+  header_->head.store(head + size);
+
+  if (header_->consumer_waiting.load() != 0 &&
+      header_->consumer_waiting.exchange(0) != 0) {
+    return kWrittenWake;
+  }
+  return kWritten;
+}
+
+
+// write(buffer) returns a WriteResult.  Nothing is written when the ring is
+// full.
+void SharedRing::Write(const FunctionCallbackInfo<Value>& args) {
+  SharedRing* ring = Unwrap<SharedRing>(args.Holder());
+  CHECK_NE(ring->header_, nullptr);
+  CHECK(Buffer::HasInstance(args[0]));
+
+  const char* data = Buffer::Data(args[0]);
+  const size_t length = Buffer::Length(args[0]);
+  CHECK_LE(length, ring->capacity_ - kRecordHeaderSize);
+
+  args.GetReturnValue().Set(ring->Push(data, length));
+}
+
+
+// read(list) appends the messages that are in the ring to |list|, and arms
+// the wakeup when there are none.  Returns true if the producer was waiting
+// for space and must be woken up.
+void SharedRing::Read(const FunctionCallbackInfo<Value>& args) {
+  SharedRing* ring = Unwrap<SharedRing>(args.Holder());
+  Environment* env = ring->env();
+  CHECK_NE(ring->header_, nullptr);
+  CHECK(args[0]->IsArray());
+
+  Local<Array> list = args[0].As<Array>();
+  RingHeader* header = ring->header_;
+  uint64_t tail = header->tail.load(std::memory_order_relaxed);
+  uint64_t head = header->head.load(std::memory_order_acquire);
+
+  if (head == tail) {
+    header->consumer_waiting.store(1);
+    head = header->head.load();
+    if (head == tail)
+      return args.GetReturnValue().Set(false);
+    header->consumer_waiting.store(0, std::memory_order_relaxed);
+  }
+
+  uint32_t count = list->Length();
+  while (tail != head) {
+    uint32_t length;
+    ring->CopyOut(tail, reinterpret_cast<char*>(&length), kRecordHeaderSize);
+    CHECK_LE(length, head - tail - kRecordHeaderSize);
+
+    Local<Object> buffer = Buffer::New(env, length).ToLocalChecked();
+    ring->CopyOut(tail + kRecordHeaderSize, Buffer::Data(buffer), length);
+    list->Set(env->context(), count++, buffer).FromJust();
+    tail += kRecordHeaderSize + length;
+  }
+  header->tail.store(tail);
+
+  const bool wake = header->producer_waiting.load() != 0 &&
+                    header->producer_waiting.exchange(0) != 0;
+  args.GetReturnValue().Set(wake);
+}
+
+
+// socketpair(fds) creates a connected pair of sockets for the wakeups and
+// stores their file descriptors in |fds|.
+static void SocketPair(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  CHECK(args[0]->IsArray());
+#ifndef _WIN32
+  int fds[2];
+  if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == -1)
+    return args.GetReturnValue().Set(-errno);
+  for (int fd : fds)
+    fcntl(fd, F_SETFD, FD_CLOEXEC);
+
+  Local<Array> list = args[0].As<Array>();
+  list->Set(env->context(), 0, Integer::New(env->isolate(), fds[0])).FromJust();
+  list->Set(env->context(), 1, Integer::New(env->isolate(), fds[1])).FromJust();
+  args.GetReturnValue().Set(0);
+#else
+  args.GetReturnValue().Set(UV_ENOSYS);
+#endif
+}
+
+
+void Initialize(Local<Object> target,
+                Local<Value> unused,
+                Local<Context> context) {
+  Environment* env = Environment::GetCurrent(context);
+
+  SharedRing::Initialize(env, target);
+  env->SetMethod(target, "socketpair", SocketPair);
+
+  NODE_DEFINE_CONSTANT(target, kWritten);
+  NODE_DEFINE_CONSTANT(target, kWrittenWake);
+  NODE_DEFINE_CONSTANT(target, kFull);
+}
+
+}  // namespace sharedring
+}  // namespace node
+
+NODE_MODULE_CONTEXT_AWARE_BUILTIN(shared_ring, node::sharedring::Initialize)
@@ -21,6 +21,28 @@ using v8::Object;
 using v8::Value;
 
 
+static const uv_stat_t zero_statbuf = uv_stat_t();
+
+
+// The fields uv_fs_poll compares to tell whether a file changed.
+static bool StatEqual(const uv_stat_t* a, const uv_stat_t* b) {
+  return a->st_ctim.tv_nsec == b->st_ctim.tv_nsec
+      && a->st_mtim.tv_nsec == b->st_mtim.tv_nsec
+      && a->st_birthtim.tv_nsec == b->st_birthtim.tv_nsec
+      && a->st_ctim.tv_sec == b->st_ctim.tv_sec
+      && a->st_mtim.tv_sec == b->st_mtim.tv_sec
+      && a->st_birthtim.tv_sec == b->st_birthtim.tv_sec
+      && a->st_size == b->st_size
+      && a->st_mode == b->st_mode
+      && a->st_uid == b->st_uid
+      && a->st_gid == b->st_gid
+      && a->st_ino == b->st_ino
+      && a->st_dev == b->st_dev
+      && a->st_flags == b->st_flags
+      && a->st_gen == b->st_gen;
+}
+
+
 void StatWatcher::Initialize(Environment* env, Local<Object> target) {
   HandleScope scope(env->isolate());
 
@@ -36,33 +58,46 @@ void StatWatcher::Initialize(Environment* env, Local<Object> target) {
 }
 
 
-static void Delete(uv_handle_t* handle) {
-  delete reinterpret_cast<uv_fs_poll_t*>(handle);
-}
-
-
 StatWatcher::StatWatcher(Environment* env, Local<Object> wrap)
     : AsyncWrap(env, wrap, AsyncWrap::PROVIDER_STATWATCHER),
-      watcher_(new uv_fs_poll_t) {
+      scheduler_(nullptr),
+      interval_(1),
+      persistent_(true),
+      busy_polling_(0),
+      statbuf_(),
+      index_(0),
+      batch_index_(-1) {
   MakeWeak<StatWatcher>(this);
-  uv_fs_poll_init(env->event_loop(), watcher_);
-  watcher_->data = static_cast<void*>(this);
 }
 
 
 StatWatcher::~StatWatcher() {
   Stop();
-  uv_close(reinterpret_cast<uv_handle_t*>(watcher_), Delete);
 }
 
 
-void StatWatcher::Callback(uv_fs_poll_t* handle,
-                           int status,
+void StatWatcher::OnPoll(int status, const uv_stat_t* stat) {
+  if (status != 0) {
+    if (busy_polling_ == status)
+      return;
+    busy_polling_ = status;
+    return Callback(status, &statbuf_, &zero_statbuf);
+  }
+
+  const uv_stat_t prev = statbuf_;
+  const bool changed =
+      busy_polling_ < 0 || (busy_polling_ != 0 && !StatEqual(&prev, stat));
+  statbuf_ = *stat;
+  busy_polling_ = 1;
+  if (changed)
+    Callback(0, &prev, stat);
+}
+
+
+void StatWatcher::Callback(int status,
                            const uv_stat_t* prev,
                            const uv_stat_t* curr) {
-  StatWatcher* wrap = static_cast<StatWatcher*>(handle->data);
-  CHECK_EQ(wrap->watcher_, handle);
-  Environment* env = wrap->env();
+  Environment* env = this->env();
   HandleScope handle_scope(env->isolate());
   Context::Scope context_scope(env->context());
   Local<Value> argv[] = {
@@ -70,7 +105,7 @@ void StatWatcher::Callback(uv_fs_poll_t* handle,
     BuildStatsObject(env, prev),
     Integer::New(env->isolate(), status)
   };
-  wrap->MakeCallback(env->onchange_string(), arraysize(argv), argv);
+  MakeCallback(env->onchange_string(), arraysize(argv), argv);
 }
 
 
@@ -85,13 +120,18 @@ void StatWatcher::Start(const FunctionCallbackInfo<Value>& args) {
   CHECK_EQ(args.Length(), 3);
 
   StatWatcher* wrap = Unwrap<StatWatcher>(args.Holder());
+  if (wrap->scheduler_ != nullptr)
+    return;
+
   node::Utf8Value path(args.GetIsolate(), args[0]);
-  const bool persistent = args[1]->BooleanValue();
   const uint32_t interval = args[2]->Uint32Value();
 
-  if (!persistent)
-    uv_unref(reinterpret_cast<uv_handle_t*>(wrap->watcher_));
-  uv_fs_poll_start(wrap->watcher_, Callback, *path, interval);
+  wrap->path_ = *path;
+  wrap->persistent_ = args[1]->BooleanValue();
+  wrap->interval_ = interval > 0 ? interval : 1;
+  wrap->busy_polling_ = 0;
+  wrap->statbuf_ = zero_statbuf;
+  wrap->env()->stat_scheduler()->Add(wrap);
   wrap->ClearWeak();
 }
 
@@ -106,11 +146,256 @@ void StatWatcher::Stop(const FunctionCallbackInfo<Value>& args) {
 
 
 void StatWatcher::Stop() {
-  if (!uv_is_active(reinterpret_cast<uv_handle_t*>(watcher_)))
+  if (scheduler_ == nullptr)
     return;
-  uv_fs_poll_stop(watcher_);
+  scheduler_->Remove(this);
   MakeWeak<StatWatcher>(this);
 }
 
 
+StatScheduler::StatScheduler(Environment* env)
+    : loop_(env->event_loop()),
+      persistent_count_(0) {
+  CHECK_EQ(0, uv_timer_init(loop_, &timer_));
+  timer_.data = this;
+  uv_unref(reinterpret_cast<uv_handle_t*>(&timer_));
+  env->RegisterHandleCleanup(reinterpret_cast<uv_handle_t*>(&timer_),
+                             OnClose,
+                             nullptr);
+}
+
+
+StatScheduler::~StatScheduler() {
+  // The watchers can outlive the scheduler, detach them.
+  for (auto it = groups_.begin(); it != groups_.end(); ++it) {
+    Group* group = it->second;
+    for (size_t i = 0; i < group->watchers.size(); i++) {
+      group->watchers[i]->scheduler_ = nullptr;
+      group->watchers[i]->batch_index_ = -1;
+    }
+    // A batch that is still on the threadpool can't be taken back.
+    if (!group->polling)
+      delete group;
+  }
+}
+
+
+void StatScheduler::Add(StatWatcher* watcher) {
+  Group*& group = groups_[watcher->interval_];
+  if (group == nullptr) {
+    group = new Group();
+    group->interval = watcher->interval_;
+    group->start_time = uv_now(loop_);
+    group->next_tick = group->start_time + group->interval;
+    group->fresh = false;
+    group->full = false;
+    group->polling = false;
+    group->pending = 0;
+  }
+
+  watcher->scheduler_ = this;
+  watcher->index_ = group->watchers.size();
+  watcher->batch_index_ = -1;
+  group->watchers.push_back(watcher);
+
+  if (watcher->persistent_ && persistent_count_++ == 0)
+    UpdateRef();
+
+  // The first stat() of a file happens right away.
+  group->fresh = true;
+  if (!group->polling)
+    Schedule();
+}
+
+
+void StatScheduler::Remove(StatWatcher* watcher) {
+  CHECK_EQ(watcher->scheduler_, this);
+  auto it = groups_.find(watcher->interval_);
+  CHECK(it != groups_.end());
+  Group* group = it->second;
+
+  CHECK_EQ(group->watchers[watcher->index_], watcher);
+  StatWatcher* last = group->watchers.back();
+  group->watchers[watcher->index_] = last;
+  last->index_ = watcher->index_;
+  group->watchers.pop_back();
+
+  if (watcher->batch_index_ >= 0)
+    group->batch[watcher->batch_index_].watcher = nullptr;
+  watcher->batch_index_ = -1;
+  watcher->scheduler_ = nullptr;
+
+  if (watcher->persistent_ && --persistent_count_ == 0)
+    UpdateRef();
+
+  // A group that is being polled goes away when the batch is done.
+  if (group->watchers.empty() && !group->polling) {
+    groups_.erase(it);
+    delete group;
+    Schedule();
+  }
+}
+
+
+// Stats the files of all watchers of |group| if |full| is set, otherwise
+// only those that were added since the last time.
+void StatScheduler::Poll(Group* group, bool full) {
+  CHECK(!group->polling);
+  CHECK(group->batch.empty());
+
+  if (full)
+    group->start_time = uv_now(loop_);
+  group->full = full;
+  group->fresh = false;
+
+  for (size_t i = 0; i < group->watchers.size(); i++) {
+    StatWatcher* watcher = group->watchers[i];
+    if (!full && watcher->busy_polling_ != 0)
+      continue;
+    watcher->batch_index_ = group->batch.size();
+    Entry entry;
+    entry.watcher = watcher;
+    entry.path = watcher->path_;
+    entry.result = 0;
+    group->batch.push_back(entry);
+  }
+
+  const size_t count = group->batch.size();
+  if (count == 0)
+    return;
+
+  size_t slices = count / kMinSliceSize;
+  if (slices < 1)
+    slices = 1;
+  if (slices > kMaxSlices)
+    slices = kMaxSlices;
+  const size_t slice_size = (count + slices - 1) / slices;
+
+  group->polling = true;
+  for (size_t i = 0; i < slices; i++) {
+    Slice* slice = &group->slices[i];
+    slice->group = group;
+    slice->start = i * slice_size;
+    slice->end = slice->start + slice_size;
+    if (slice->end > count)
+      slice->end = count;
+    slice->work_req.data = this;
+    group->pending++;
+    uv_queue_work(loop_, &slice->work_req, Work, After);
+  }
+}
+
+
+void StatScheduler::Work(uv_work_t* req) {
+  Slice* slice = ContainerOf(&Slice::work_req, req);
+  std::vector<Entry>& batch = slice->group->batch;
+  for (size_t i = slice->start; i < slice->end; i++) {
+    uv_fs_t fs_req;
+    Entry* entry = &batch[i];
+    entry->result = uv_fs_stat(req->loop, &fs_req, entry->path.c_str(),
+                               nullptr);
+    if (entry->result == 0)
+      entry->stat = fs_req.statbuf;
+    uv_fs_req_cleanup(&fs_req);
+  }
+}
+
+
+void StatScheduler::After(uv_work_t* req, int status) {
+  Slice* slice = ContainerOf(&Slice::work_req, req);
+  Group* group = slice->group;
+  StatScheduler* scheduler = static_cast<StatScheduler*>(req->data);
+  CHECK_GT(group->pending, 0);
+  if (--group->pending == 0)
+    scheduler->Finish(group);
+}
+
+
+void StatScheduler::Finish(Group* group) {
+  // The callbacks may stop and start watchers, Remove() clears the entries
+  // of the ones that are stopped.  The group stays while |polling| is set.
+  for (size_t i = 0; i < group->batch.size(); i++) {
+    StatWatcher* watcher = group->batch[i].watcher;
+    if (watcher == nullptr)
+      continue;
+    watcher->batch_index_ = -1;
+    group->batch[i].watcher = nullptr;
+    watcher->OnPoll(group->batch[i].result, &group->batch[i].stat);
+  }
+  group->batch.clear();
+  group->polling = false;
+
+  if (group->watchers.empty()) {
+    groups_.erase(group->interval);
+    delete group;
+  } else if (group->full) {
+    // Like uv_fs_poll, subtract the time the stat() calls took.
+    const uint64_t now = uv_now(loop_);
+    group->next_tick = now + group->interval -
+                       (now - group->start_time) % group->interval;
+  }
+
+  Schedule();
+}
+
+
+// Starts the timer for the group that is due first.
+void StatScheduler::Schedule() {
+  const uint64_t now = uv_now(loop_);
+  uint64_t due = 0;
+  bool any = false;
+
+  for (auto it = groups_.begin(); it != groups_.end(); ++it) {
+    const Group* group = it->second;
+    if (group->polling)
+      continue;
+    const uint64_t tick = group->fresh ? now : group->next_tick;
+    if (!any || tick < due)
+      due = tick;
+    any = true;
+  }
+
+  if (!any) {
+    uv_timer_stop(&timer_);
+    return;
+  }
+  uv_timer_start(&timer_, OnTimeout, due > now ? due - now : 0, 0);
+}
+
+
+void StatScheduler::UpdateRef() {
+  if (persistent_count_ > 0)
+    uv_ref(reinterpret_cast<uv_handle_t*>(&timer_));
+  else
+    uv_unref(reinterpret_cast<uv_handle_t*>(&timer_));
+}
+
+
+void StatScheduler::OnTimeout(uv_timer_t* handle) {
+  StatScheduler* scheduler = static_cast<StatScheduler*>(handle->data);
+  const uint64_t now = uv_now(scheduler->loop_);
+
+  std::vector<Group*> due;
+  for (auto it = scheduler->groups_.begin();
+       it != scheduler->groups_.end();
+       ++it) {
+    Group* group = it->second;
+    if (!group->polling && (group->fresh || group->next_tick <= now))
+      due.push_back(group);
+  }
+  for (size_t i = 0; i < due.size(); i++)
+    scheduler->Poll(due[i], due[i]->next_tick <= now);
+
+  scheduler->Schedule();
+}
+
+
+void StatScheduler::OnClose(Environment* env, uv_handle_t* handle, void* arg) {
+  handle->data = env;
+  uv_close(handle, [](uv_handle_t* handle) {
+    static_cast<Environment*>(handle->data)->FinishHandleCleanup(handle);
+  });
+}
+
+
 }  // namespace node
@@ -4,11 +4,18 @@
 #include "node.h"
 #include "async-wrap.h"
 #include "env.h"
+#include "util.h"
 #include "uv.h"
 #include "v8.h"
 
+#include <map>
+#include <string>
+#include <vector>
+
 namespace node {
 
+class StatScheduler;
+
 class StatWatcher : public AsyncWrap {
  public:
   virtual ~StatWatcher() override;
@@ -25,13 +32,92 @@ class StatWatcher : public AsyncWrap {
   size_t self_size() const override { return sizeof(*this); }
 
  private:
-  static void Callback(uv_fs_poll_t* handle,
-                       int status,
-                       const uv_stat_t* prev,
-                       const uv_stat_t* curr);
+  friend class StatScheduler;
+
+  // Compares the result of a stat() with the previous one, like uv_fs_poll.
+  void OnPoll(int status, const uv_stat_t* stat);
+  void Callback(int status, const uv_stat_t* prev, const uv_stat_t* curr);
   void Stop();
 
-  uv_fs_poll_t* watcher_;
+  StatScheduler* scheduler_;
+  std::string path_;
+  uint32_t interval_;
+  bool persistent_;
+  // 0 before the first stat(), 1 after a successful one, the error of the
+  // last one otherwise.
+  int busy_polling_;
+  uv_stat_t statbuf_;
+  // The position of the watcher in its group, and in the batch of the group
+  // that is being stat'ed if it's part of it, -1 otherwise.
+  size_t index_;
+  ssize_t batch_index_;
+};
+
+// Polls the files of all StatWatchers of an Environment.  The watchers with
+// the same interval form a group whose files are stat'ed together in a few
+// threadpool jobs per interval, rather than in one job per file, and a single
+// timer wakes the loop up when the next group is due.
+class StatScheduler {
+ public:
+  explicit StatScheduler(Environment* env);
+  ~StatScheduler();
+
+  void Add(StatWatcher* watcher);
+  void Remove(StatWatcher* watcher);
+
+ private:
+  static const size_t kMaxSlices = 4;
+  static const size_t kMinSliceSize = 64;
+
+  struct Group;
+
+  struct Entry {
+    StatWatcher* watcher;
+    std::string path;
+    int result;
+    uv_stat_t stat;
+  };
+
+  struct Slice {
+    uv_work_t work_req;
+    Group* group;
+    size_t start;
+    size_t end;
+  };
+
+  struct Group {
+    uint32_t interval;
+    uint64_t start_time;
+    uint64_t next_tick;
+    std::vector<StatWatcher*> watchers;
+    // Set when watchers were added that haven't been stat'ed yet, they are
+    // right away instead of at the next tick.
+    bool fresh;
+    bool polling;
+    // Whether the batch has all watchers of the group.
+    bool full;
+    std::vector<Entry> batch;
+    Slice slices[kMaxSlices];
+    size_t pending;
+  };
+
+  void Poll(Group* group, bool full);
+  void Finish(Group* group);
+  void Schedule();
+  void UpdateRef();
+
+  static void OnTimeout(uv_timer_t* handle);
+  static void Work(uv_work_t* req);
+  static void After(uv_work_t* req, int status);
+  static void OnClose(Environment* env, uv_handle_t* handle, void* arg);
+
+  uv_loop_t* const loop_;
+  uv_timer_t timer_;
+  std::map<uint32_t, Group*> groups_;
+  // The timer keeps the loop alive while there are persistent watchers.
+  size_t persistent_count_;
+
+  DISALLOW_COPY_AND_ASSIGN(StatScheduler);
 };
 
 }  // namespace node
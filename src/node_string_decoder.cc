@@ -0,0 +1,278 @@
+#include "node.h"
+#include "node_buffer.h"
+#include "env.h"
+#include "env-inl.h"
+#include "string_bytes.h"
+#include "util.h"
+#include "util-inl.h"
+#include "v8.h"
+
+#include <stdint.h>
+#include <string.h>
+
+namespace node {
+namespace stringdecoder {
+
+using v8::Context;
+using v8::FunctionCallbackInfo;
+using v8::Integer;
+using v8::Isolate;
+using v8::Local;
+using v8::Object;
+using v8::String;
+using v8::Value;
+
+// Layout of the state Buffer of a decoder.  The bytes at the end of the
+// input that can't be decoded yet are kept at its start.
+enum StateField {
+  // A UTF-8 or CESU-8 character needs up to 6 bytes.
+  kBufferedBytesMax = 6,
+  kBufferedBytes = kBufferedBytesMax,
+  // The number of bytes that are missing from the buffered characters.
+  kMissingBytes,
+  kEncodingField,
+  kStateSize
+};
+
+
+static Local<Value> MakeString(Isolate* isolate,
+                               const char* data,
+                               size_t length,
+                               enum encoding encoding) {
+  if (length == 0)
+    return String::Empty(isolate);
+  if (encoding != UCS2)
+    return StringBytes::Encode(isolate, data, length, encoding);
+
+  // Like Buffer#ucs2Slice, the data is little-endian and may be unaligned.
+  length /= 2;
+  if (IsLittleEndian() &&
+      reinterpret_cast<uintptr_t>(data) % sizeof(uint16_t) == 0) {
+    return StringBytes::Encode(isolate,
+                               reinterpret_cast<const uint16_t*>(data),
+                               length);
+  }
+  MaybeStackBuffer<uint16_t> units;
+  units.AllocateSufficientStorage(length);
+  for (size_t i = 0; i < length; i++) {
+    const uint8_t lo = static_cast<uint8_t>(data[2 * i + 0]);
+    const uint8_t hi = static_cast<uint8_t>(data[2 * i + 1]);
+    units.out()[i] = lo | hi << 8;
+  }
+  return StringBytes::Encode(isolate, units.out(), length);
+}
+
+
+// Returns how many of the last bytes of the input have to wait for more,
+// given the last |n| bytes of it in |tail| and its length |total|.  These
+// are an incomplete character, and a lead surrogate before it that waits
+// for its trail surrogate, so that write() never returns half of a
+// surrogate pair.
+static size_t HeldBytes(enum encoding encoding,
+                        const uint8_t* tail,
+                        size_t n,
+                        size_t total,
+                        size_t* missing) {
+  size_t held = 0;
+  *missing = 0;
+
+  if (encoding == UTF8) {
+    // A lead byte among the last three that announces more bytes than
+    // there are, see http://en.wikipedia.org/wiki/UTF-8#Description.
+    for (size_t i = n < 3 ? n : 3; i > 0; i--) {
+      const uint8_t c = tail[n - i];
+      size_t length = 0;
+      if (i == 1 && c >> 5 == 0x06)
+        length = 2;
+      else if (i <= 2 && c >> 4 == 0x0E)
+        length = 3;
+      else if (c >> 3 == 0x1E)
+        length = 4;
+      if (length != 0) {
+        held = i;
+        *missing = length - i;
+        break;
+      }
+    }
+    // CESU-8 encodes each surrogate in 3 bytes, ED A0..AF xx is a lead one.
+    const size_t end = n - held;
+    if (end >= 3 &&
+        tail[end - 3] == 0xED &&
+        (tail[end - 2] & 0xF0) == 0xA0 &&
+        (tail[end - 1] & 0xC0) == 0x80) {
+      if (held == 0)
+        *missing = 3;
+      held += 3;
+    }
+  } else if (encoding == UCS2) {
+    held = total % 2;
+    *missing = held;
+    const size_t end = n - held;
+    if (end >= 2) {
+      const uint16_t unit = tail[end - 2] | tail[end - 1] << 8;
+      if (unit >= 0xD800 && unit <= 0xDBFF) {
+        if (held == 0)
+          *missing = 2;
+        held += 2;
+      }
+    }
+  } else {
+    CHECK_EQ(encoding, BASE64);
+    // Base64 stores 3 bytes in 4 characters and pads the remainder.
+    held = total % 3;
+    *missing = held == 0 ? 0 : 3 - held;
+  }
+
+  return held;
+}
+
+
+// Returns how many bytes at the start of |data| belong to the characters
+// that were buffered, so that what follows can be decoded on its own.
+static size_t CompletingBytes(enum encoding encoding,
+                              size_t buffered,
+                              const char* data,
+                              size_t length) {
+  size_t count;
+  if (encoding == UTF8) {
+    count = 0;
+    while (count < 3 && count < length &&
+           (static_cast<uint8_t>(data[count]) & 0xC0) == 0x80) {
+      count++;
+    }
+  } else if (encoding == UCS2) {
+    count = buffered % 2;
+  } else {
+    count = buffered % 3 == 0 ? 0 : 3 - buffered % 3;
+  }
+  return count < length ? count : length;
+}
+
+
+// Decodes the buffered bytes followed by the |length| bytes at |data| up to
+// the last complete character, and buffers the rest.
+static Local<Value> DecodeChunk(Isolate* isolate,
+                                uint8_t* state,
+                                const char* data,
+                                size_t length) {
+  const enum encoding encoding =
+      static_cast<enum encoding>(state[kEncodingField]);
+  const size_t buffered = state[kBufferedBytes];
+  const size_t total = buffered + length;
+
+  uint8_t tail[kBufferedBytesMax];
+  const size_t max = kBufferedBytesMax;
+  const size_t n = total < max ? total : max;
+  for (size_t i = 0; i < n; i++) {
+    const size_t pos = total - n + i;
+    tail[i] = pos < buffered ? state[pos] : data[pos - buffered];
+  }
+  size_t missing;
+  const size_t held = HeldBytes(encoding, tail, n, total, &missing);
+  const size_t boundary = total - held;
+
+  Local<Value> result;
+  if (boundary <= buffered) {
+    // Nothing of |data| is complete yet.
+    result = MakeString(isolate,
+                        reinterpret_cast<char*>(state),
+                        boundary,
+                        encoding);
+    memmove(state, state + boundary, buffered - boundary);
+    memcpy(state + buffered - boundary, data, length);
+  } else {
+    const size_t end = boundary - buffered;
+    size_t start = 0;
+    if (buffered > 0) {
+      // Only the characters that were split are copied, the rest is
+      // decoded in place and the two strings are concatenated.
+      char first[kBufferedBytesMax + 3];
+      start = CompletingBytes(encoding, buffered, data, end);
+      memcpy(first, state, buffered);
+      memcpy(first + buffered, data, start);
+      result = MakeString(isolate, first, buffered + start, encoding);
+    }
+    if (end > start) {
+      Local<Value> rest =
+          MakeString(isolate, data + start, end - start, encoding);
+      if (result.IsEmpty() || rest.IsEmpty())
+        result = rest;
+      else
+        result = String::Concat(result.As<String>(), rest.As<String>());
+    }
+    memcpy(state, data + end, length - end);
+  }
+
+  state[kBufferedBytes] = held;
+  state[kMissingBytes] = missing;
+  return result;
+}
+
+
+static uint8_t* GetState(Local<Value> value) {
+  CHECK(Buffer::HasInstance(value));
+  CHECK_EQ(Buffer::Length(value), kStateSize);
+  return reinterpret_cast<uint8_t*>(Buffer::Data(value));
+}
+
+
+// decode(state, buffer)
+void Decode(const FunctionCallbackInfo<Value>& args) {
+  uint8_t* state = GetState(args[0]);
+  CHECK(Buffer::HasInstance(args[1]));
+  Local<Value> result = DecodeChunk(args.GetIsolate(),
+                                    state,
+                                    Buffer::Data(args[1]),
+                                    Buffer::Length(args[1]));
+  if (!result.IsEmpty())
+    args.GetReturnValue().Set(result);
+}
+
+
+// flush(state) returns what is buffered, incomplete or not, and resets the
+// decoder.
+void Flush(const FunctionCallbackInfo<Value>& args) {
+  uint8_t* state = GetState(args[0]);
+  const enum encoding encoding =
+      static_cast<enum encoding>(state[kEncodingField]);
+  const size_t buffered = state[kBufferedBytes];
+  state[kBufferedBytes] = 0;
+  state[kMissingBytes] = 0;
+  Local<Value> result = MakeString(args.GetIsolate(),
+                                   reinterpret_cast<char*>(state),
+                                   buffered,
+                                   encoding);
+  if (!result.IsEmpty())
+    args.GetReturnValue().Set(result);
+}
+
+
+void Initialize(Local<Object> target,
+                Local<Value> unused,
+                Local<Context> context) {
+  Environment* env = Environment::GetCurrent(context);
+  Isolate* isolate = env->isolate();
+
+#define SET_CONSTANT(name, value)                                             \
+  target->Set(context,                                                        \
+              FIXED_ONE_BYTE_STRING(isolate, name),                           \
+              Integer::New(isolate, value)).FromJust()
+  SET_CONSTANT("kBufferedBytesMax", kBufferedBytesMax);
+  SET_CONSTANT("kBufferedBytes", kBufferedBytes);
+  SET_CONSTANT("kMissingBytes", kMissingBytes);
+  SET_CONSTANT("kEncodingField", kEncodingField);
+  SET_CONSTANT("kStateSize", kStateSize);
+  SET_CONSTANT("UTF8", UTF8);
+  SET_CONSTANT("UCS2", UCS2);
+  SET_CONSTANT("BASE64", BASE64);
+#undef SET_CONSTANT
+
+  env->SetMethod(target, "decode", Decode);
+  env->SetMethod(target, "flush", Flush);
+}
+
+}  // namespace stringdecoder
+}  // namespace node
+
+NODE_MODULE_CONTEXT_AWARE_BUILTIN(string_decoder,
+                                  node::stringdecoder::Initialize)
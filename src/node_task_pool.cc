@@ -0,0 +1,400 @@
+#include "node.h"
+#include "node_dtrace.h"
+#include "node_internals.h"
+#include "util.h"
+#include "util-inl.h"
+#include "uv.h"
+
+#include <deque>
+#include <vector>
+
+namespace node {
+
+/*
+ * A work-stealing pool for short, CPU-bound tasks.  Every worker thread owns
+ * a deque that is guarded by a mutex of its own: the owner pushes and pops at
+ * the back, idle workers steal from the front.  Tasks queued from the loop
+ * thread are spread over the deques round robin.  The pool mutex is only
+ * taken to pick a deque, to wake up idle workers and to go to sleep.
+ *
+ * Completed tasks go back to their loop through a uv_async_queue_t, which
+ * wakes the loop up once for a whole batch of them.  Instances that own their
+ * loop unregister it with CloseTaskLoop() before the loop is closed.
+ */
+
+class TaskLoop;
+
+struct Task {
+  task_work_cb work;
+  task_done_cb done;
+  void* data;
+  TaskLoop* loop;
+  uv_async_item_t item;
+};
+
+
+// The per-loop end of the pool.  Its async handle keeps the loop alive while
+// tasks are pending.
+class TaskLoop {
+ public:
+  static void Init();
+  static TaskLoop* Get(uv_loop_t* loop, bool create);
+  static void Close(uv_loop_t* loop);
+
+  // Called before a task is queued, on the loop thread or from a task of the
+  // same loop.
+  bool AddPending(bool on_loop_thread);
+  void Complete(Task* task);
+
+ private:
+  explicit TaskLoop(uv_loop_t* loop);
+  bool HasPending();
+  static void OnComplete(uv_async_queue_t* queue, uv_async_item_t* item);
+
+  uv_loop_t* const loop_;
+  uv_async_queue_t queue_;
+  uv_mutex_t mutex_;
+  unsigned int pending_;
+
+  static uv_mutex_t loops_mutex_;
+  static std::vector<TaskLoop*> loops_;
+};
+
+
+class TaskPool {
+ public:
+  static TaskPool* Get();
+
+  void Submit(Task* task);
+  // Returns true when the caller is one of the pool's threads.
+  bool OnWorkerThread();
+
+ private:
+  struct Worker {
+    TaskPool* pool;
+    size_t index;
+    uv_thread_t thread;
+    uv_mutex_t mutex;
+    std::deque<Task*> tasks;
+  };
+
+  explicit TaskPool(size_t nworkers);
+  static void Init();
+  static void Run(void* arg);
+
+  Task* Pop(Worker* self);
+  Task* Steal(Worker* self);
+  bool HasWork();
+
+  Worker* workers_;
+  size_t nworkers_;
+  size_t next_;
+  size_t idle_;
+  uv_mutex_t mutex_;
+  uv_cond_t cond_;
+  uv_key_t current_worker_;
+
+  static TaskPool* instance_;
+};
+
+
+uv_mutex_t TaskLoop::loops_mutex_;
+std::vector<TaskLoop*> TaskLoop::loops_;
+TaskPool* TaskPool::instance_;
+
+
+TaskLoop::TaskLoop(uv_loop_t* loop) : loop_(loop), pending_(0) {
+  CHECK_EQ(0, uv_mutex_init(&mutex_));
+  CHECK_EQ(0, uv_async_queue_init(loop, &queue_, OnComplete));
+  uv_unref(reinterpret_cast<uv_handle_t*>(&queue_.async));
+}
+
+
+void TaskLoop::Init() {
+  CHECK_EQ(0, uv_mutex_init(&loops_mutex_));
+}
+
+
+// The handles are unref'd while idle, loops stay registered until Close().
+TaskLoop* TaskLoop::Get(uv_loop_t* loop, bool create) {
+  TaskLoop* task_loop = nullptr;
+
+  uv_mutex_lock(&loops_mutex_);
+  for (TaskLoop* item : loops_) {
+    if (item->loop_ == loop) {
+      task_loop = item;
+      break;
+    }
+  }
+  if (task_loop == nullptr && create) {
+    task_loop = new TaskLoop(loop);
+    loops_.push_back(task_loop);
+  }
+  uv_mutex_unlock(&loops_mutex_);
+
+  return task_loop;
+}
+
+
+// Runs the loop until the tasks of the loop are done, then closes the handle.
+// Once pending_ is zero no task can queue another one for this loop, and the
+// mutex makes sure no thread is still inside Complete().
+void TaskLoop::Close(uv_loop_t* loop) {
+  TaskLoop* task_loop = Get(loop, false);
+  if (task_loop == nullptr)
+    return;
+
+  while (task_loop->HasPending())
+    uv_run(loop, UV_RUN_ONCE);
+
+  uv_mutex_lock(&loops_mutex_);
+  for (auto it = loops_.begin(); it != loops_.end(); ++it) {
+    if (*it == task_loop) {
+      loops_.erase(it);
+      break;
+    }
+  }
+  uv_mutex_unlock(&loops_mutex_);
+
+  uv_async_queue_close(&task_loop->queue_, [](uv_handle_t* handle) {
+    uv_async_queue_t* queue = reinterpret_cast<uv_async_queue_t*>(handle);
+    TaskLoop* task_loop = ContainerOf(&TaskLoop::queue_, queue);
+    uv_mutex_destroy(&task_loop->mutex_);
+    delete task_loop;
+  });
+}
+
+
+bool TaskLoop::HasPending() {
+  uv_mutex_lock(&mutex_);
+  bool pending = pending_ > 0;
+  uv_mutex_unlock(&mutex_);
+  return pending;
+}
+
+
+bool TaskLoop::AddPending(bool on_loop_thread) {
+  bool ok = true;
+
+  uv_mutex_lock(&mutex_);
+  if (on_loop_thread) {
+    if (pending_++ == 0)
+      uv_ref(reinterpret_cast<uv_handle_t*>(&queue_.async));
+  } else if (pending_ == 0) {
+    // A task of this loop would still be pending, the caller is not one.
+    ok = false;
+  } else {
+    pending_++;
+  }
+  uv_mutex_unlock(&mutex_);
+
+  return ok;
+}
+
+
+// The push can wake up the loop before uv_async_send() returns, OnComplete()
+// takes the same mutex before it lets pending_ drop to zero.
+void TaskLoop::Complete(Task* task) {
+  uv_mutex_lock(&mutex_);
+  uv_async_queue_push(&queue_, &task->item);
+  uv_mutex_unlock(&mutex_);
+}
+
+
+void TaskLoop::OnComplete(uv_async_queue_t* queue, uv_async_item_t* item) {
+  TaskLoop* task_loop = ContainerOf(&TaskLoop::queue_, queue);
+  Task* task = ContainerOf(&Task::item, item);
+
+  // Run the callback first, the tasks that it queues keep the loop alive.
+  task->done(task->data, 0);
+  delete task;
+
+  uv_mutex_lock(&task_loop->mutex_);
+  if (--task_loop->pending_ == 0)
+    uv_unref(reinterpret_cast<uv_handle_t*>(&task_loop->queue_.async));
+  uv_mutex_unlock(&task_loop->mutex_);
+}
+
+
+TaskPool::TaskPool(size_t nworkers)
+    : workers_(new Worker[nworkers]),
+      nworkers_(nworkers),
+      next_(0),
+      idle_(0) {
+  CHECK_EQ(0, uv_mutex_init(&mutex_));
+  CHECK_EQ(0, uv_cond_init(&cond_));
+  CHECK_EQ(0, uv_key_create(&current_worker_));
+}
+
+
+void TaskPool::Init() {
+  uv_cpu_info_t* cpus;
+  int ncpus;
+
+  if (uv_cpu_info(&cpus, &ncpus) == 0)
+    uv_free_cpu_info(cpus, ncpus);
+  else
+    ncpus = 1;
+  if (ncpus < 1)
+    ncpus = 1;
+
+  TaskLoop::Init();
+
+  TaskPool* pool = new TaskPool(ncpus);
+  for (size_t i = 0; i < pool->nworkers_; i++) {
+    Worker* worker = &pool->workers_[i];
+    worker->pool = pool;
+    worker->index = i;
+    CHECK_EQ(0, uv_mutex_init(&worker->mutex));
+  }
+  for (size_t i = 0; i < pool->nworkers_; i++) {
+    Worker* worker = &pool->workers_[i];
+    CHECK_EQ(0, uv_thread_create(&worker->thread, Run, worker));
+  }
+
+  instance_ = pool;
+}
+
+
+TaskPool* TaskPool::Get() {
+  static uv_once_t init_once = UV_ONCE_INIT;
+  uv_once(&init_once, Init);
+  return instance_;
+}
+
+
+bool TaskPool::OnWorkerThread() {
+  return uv_key_get(&current_worker_) != nullptr;
+}
+
+
+void TaskPool::Submit(Task* task) {
+  Worker* self = static_cast<Worker*>(uv_key_get(&current_worker_));
+
+  if (self != nullptr) {
+    uv_mutex_lock(&self->mutex);
+    self->tasks.push_back(task);
+    uv_mutex_unlock(&self->mutex);
+  }
+
+  uv_mutex_lock(&mutex_);
+  if (self == nullptr) {
+    Worker* worker = &workers_[next_++ % nworkers_];
+    uv_mutex_lock(&worker->mutex);
+    worker->tasks.push_back(task);
+    uv_mutex_unlock(&worker->mutex);
+  }
+  if (idle_ > 0)
+    uv_cond_signal(&cond_);
+  uv_mutex_unlock(&mutex_);
+}
+
+
+Task* TaskPool::Pop(Worker* self) {
+  Task* task = nullptr;
+
+  uv_mutex_lock(&self->mutex);
+  if (!self->tasks.empty()) {
+    task = self->tasks.back();
+    self->tasks.pop_back();
+  }
+  uv_mutex_unlock(&self->mutex);
+
+  return task;
+}
+
+
+Task* TaskPool::Steal(Worker* self) {
+  Task* task = nullptr;
+
+  for (size_t i = 1; i < nworkers_ && task == nullptr; i++) {
+    Worker* victim = &workers_[(self->index + i) % nworkers_];
+    uv_mutex_lock(&victim->mutex);
+    if (!victim->tasks.empty()) {
+      task = victim->tasks.front();
+      victim->tasks.pop_front();
+    }
+    uv_mutex_unlock(&victim->mutex);
+  }
+
+  return task;
+}
+
+
+// Must be called with the pool mutex held.
+bool TaskPool::HasWork() {
+  bool found = false;
+
+  for (size_t i = 0; i < nworkers_ && !found; i++) {
+    uv_mutex_lock(&workers_[i].mutex);
+    found = !workers_[i].tasks.empty();
+    uv_mutex_unlock(&workers_[i].mutex);
+  }
+
+  return found;
+}
+
+
+void TaskPool::Run(void* arg) {
+  Worker* self = static_cast<Worker*>(arg);
+  TaskPool* pool = self->pool;
+
+  uv_key_set(&pool->current_worker_, self);
+
+  for (;;) {
+    Task* task = pool->Pop(self);
+    if (task == nullptr)
+      task = pool->Steal(self);
+
+    if (task != nullptr) {
+      if (NODE_THREADPOOL_DEQUEUE_ENABLED())
+        NODE_THREADPOOL_DEQUEUE(task);
+      task->work(task->data);
+      task->loop->Complete(task);
+      continue;
+    }
+
+    // Submit() signals with the pool mutex held after pushing, looking at
+    // the deques again under the mutex means no wakeup is missed.
+    uv_mutex_lock(&pool->mutex_);
+    pool->idle_++;
+    while (!pool->HasWork())
+      uv_cond_wait(&pool->cond_, &pool->mutex_);
+    pool->idle_--;
+    uv_mutex_unlock(&pool->mutex_);
+  }
+}
+
+
+int QueueTask(uv_loop_t* loop,
+              task_work_cb work,
+              task_done_cb done,
+              void* data) {
+  if (loop == nullptr || work == nullptr || done == nullptr)
+    return UV_EINVAL;
+
+  TaskPool* pool = TaskPool::Get();
+  bool on_loop_thread = !pool->OnWorkerThread();
+
+  TaskLoop* task_loop = TaskLoop::Get(loop, on_loop_thread);
+  if (task_loop == nullptr || !task_loop->AddPending(on_loop_thread))
+    return UV_EINVAL;
+
+  Task* task = new Task;
+  task->work = work;
+  task->done = done;
+  task->data = data;
+  task->loop = task_loop;
+  if (NODE_THREADPOOL_ENQUEUE_ENABLED())
+    NODE_THREADPOOL_ENQUEUE(task);
+  pool->Submit(task);
+
+  return 0;
+}
+
+
+void CloseTaskLoop(uv_loop_t* loop) {
+  TaskLoop::Close(loop);
+}
+
+}  // namespace node
@@ -0,0 +1,505 @@
+#include "node_trace.h"
+#include "util.h"
+#include "uv.h"
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <process.h>
+#define getpid GetCurrentProcessId
+#else
+#include <unistd.h>
+#endif
+
+namespace node {
+namespace tracing {
+
+static const char kTraceFileName[] = "node_trace.1.log";
+// Events per chunk.  A thread takes the lock once per chunk.
+static const size_t kChunkSize = 256;
+static const size_t kMaxCategoryGroups = 256;
+static const size_t kMaxArgs = 2;
+// How often the background thread writes out the chunks that are full.
+static const uint64_t kFlushInterval = 1000 * 1000 * 1000;
+
+// The values of trace_event_common.h, it is not part of V8's public headers.
+enum ArgType {
+  kTypeBool = 1,
+  kTypeUint = 2,
+  kTypeInt = 3,
+  kTypeDouble = 4,
+  kTypePointer = 5,
+  kTypeString = 6,
+  kTypeCopyString = 7
+};
+
+static const unsigned int kFlagCopy = 1 << 0;
+static const unsigned int kFlagHasId = 1 << 1;
+
+struct TraceEvent {
+  char phase;
+  const uint8_t* category_group_enabled;
+  const char* name;
+  uint64_t id;
+  uint64_t timestamp;
+  unsigned int flags;
+  int num_args;
+  const char* arg_names[kMaxArgs];
+  uint8_t arg_types[kMaxArgs];
+  uint64_t arg_values[kMaxArgs];
+  // The names and the strings that had to be copied.
+  std::string copied_name;
+  std::string copied_args[kMaxArgs];
+};
+
+struct TraceChunk {
+  int tid;
+  size_t size;
+  TraceEvent events[kChunkSize];
+};
+
+// The chunk that a thread is recording into, only that thread touches it.
+struct ThreadBuffer {
+  int tid;
+  TraceChunk* chunk;
+};
+
+static uv_once_t init_once = UV_ONCE_INIT;
+static uv_mutex_t mutex;
+static uv_cond_t cond;
+static uv_key_t thread_buffer_key;
+static uv_thread_t flush_thread;
+
+static bool tracing;
+static bool stopping;
+static FILE* trace_file;
+static bool first_event;
+static int next_tid;
+static std::vector<std::string> enabled_categories;
+static std::vector<ThreadBuffer*> thread_buffers;
+// Full chunks that wait for the background thread, and spare ones.
+static std::vector<TraceChunk*> full_chunks;
+static std::vector<TraceChunk*> free_chunks;
+
+static const char* category_groups[kMaxCategoryGroups];
+static uint8_t category_group_enabled[kMaxCategoryGroups];
+static size_t category_group_count;
+
+
+static void Init() {
+  CHECK_EQ(0, uv_mutex_init(&mutex));
+  CHECK_EQ(0, uv_cond_init(&cond));
+  CHECK_EQ(0, uv_key_create(&thread_buffer_key));
+  // The last group is the one that every name gets once the table is full,
+  // it is never recorded.
+  category_groups[kMaxCategoryGroups - 1] = "__overflow";
+}
+
+
+static bool IsCategoryEnabled(const char* category, size_t length) {
+  for (const std::string& enabled : enabled_categories) {
+    if (enabled.size() > length)
+      continue;
+    if (enabled.compare(0, std::string::npos, category, enabled.size()) != 0)
+      continue;
+    // An exact match, or a category below |enabled|.
+    if (enabled.size() == length || category[enabled.size()] == '.')
+      return true;
+  }
+  return false;
+}
+
+
+// Must be called with the mutex held.
+static bool IsCategoryGroupEnabled(const char* group) {
+  for (;;) {
+    const char* comma = strchr(group, ',');
+    const size_t length = comma ? comma - group : strlen(group);
+    if (IsCategoryEnabled(group, length))
+      return true;
+    if (comma == nullptr)
+      return false;
+    group = comma + 1;
+  }
+}
+
+
+const uint8_t* GetCategoryGroupEnabled(const char* name) {
+  uv_once(&init_once, Init);
+  uv_mutex_lock(&mutex);
+
+  uint8_t* flag = &category_group_enabled[kMaxCategoryGroups - 1];
+  size_t i;
+  for (i = 0; i < category_group_count; i++) {
+    if (strcmp(category_groups[i], name) == 0)
+      break;
+  }
+  if (i < category_group_count) {
+    flag = &category_group_enabled[i];
+  } else if (category_group_count < kMaxCategoryGroups - 1) {
+    category_groups[i] = strdup(name);
+    category_group_enabled[i] = tracing && IsCategoryGroupEnabled(name);
+    category_group_count += 1;
+    flag = &category_group_enabled[i];
+  }
+
+  uv_mutex_unlock(&mutex);
+  return flag;
+}
+
+
+const char* GetCategoryGroupName(const uint8_t* enabled) {
+  const size_t index = enabled - category_group_enabled;
+  CHECK_LT(index, kMaxCategoryGroups);
+  return category_groups[index];
+}
+
+
+// Must be called with the mutex held.
+static TraceChunk* NewChunk(int tid) {
+  TraceChunk* chunk;
+  if (free_chunks.empty()) {
+    chunk = new TraceChunk;
+  } else {
+    chunk = free_chunks.back();
+    free_chunks.pop_back();
+  }
+  chunk->tid = tid;
+  chunk->size = 0;
+  return chunk;
+}
+
+
+static ThreadBuffer* GetThreadBuffer() {
+  ThreadBuffer* buffer =
+      static_cast<ThreadBuffer*>(uv_key_get(&thread_buffer_key));
+  if (buffer != nullptr)
+    return buffer;
+
+  buffer = new ThreadBuffer;
+  uv_mutex_lock(&mutex);
+  buffer->tid = ++next_tid;
+  buffer->chunk = NewChunk(buffer->tid);
+  thread_buffers.push_back(buffer);
+  uv_mutex_unlock(&mutex);
+  uv_key_set(&thread_buffer_key, buffer);
+  return buffer;
+}
+
+
+uint64_t AddTraceEvent(char phase,
+                       const uint8_t* enabled,
+                       const char* name,
+                       uint64_t id,
+                       int num_args,
+                       const char** arg_names,
+                       const uint8_t* arg_types,
+                       const uint64_t* arg_values,
+                       unsigned int flags) {
+  if (*enabled == 0)
+    return 0;
+
+  ThreadBuffer* buffer = GetThreadBuffer();
+  TraceChunk* chunk = buffer->chunk;
+  TraceEvent* event = &chunk->events[chunk->size];
+
+  // Complete events are recorded as a begin, UpdateTraceEventDuration() adds
+  // the end.  That way no event has to be found again later.
+  event->phase = phase == 'X' ? 'B' : phase;
+  event->category_group_enabled = enabled;
+  event->name = name;
+  event->id = id;
+  event->timestamp = uv_hrtime() / 1000;
+  event->flags = flags;
+  event->num_args = num_args < static_cast<int>(kMaxArgs) ? num_args :
+                                                             kMaxArgs;
+  if (flags & kFlagCopy) {
+    event->copied_name = name;
+    event->name = event->copied_name.c_str();
+  }
+  for (int i = 0; i < event->num_args; i++) {
+    event->arg_names[i] = arg_names[i];
+    event->arg_types[i] = arg_types[i];
+    event->arg_values[i] = arg_values[i];
+    if (arg_types[i] == kTypeCopyString) {
+      event->copied_args[i] = reinterpret_cast<const char*>(arg_values[i]);
+      event->arg_values[i] =
+          reinterpret_cast<uintptr_t>(event->copied_args[i].c_str());
+    }
+  }
+
+  if (++chunk->size == kChunkSize) {
+    uv_mutex_lock(&mutex);
+    full_chunks.push_back(chunk);
+    buffer->chunk = NewChunk(buffer->tid);
+    uv_mutex_unlock(&mutex);
+  }
+
+  return phase == 'X' ? 1 : 0;
+}
+
+
+void UpdateTraceEventDuration(const uint8_t* enabled,
+                              const char* name,
+                              uint64_t handle) {
+  if (handle != 0)
+    AddTraceEvent('E', enabled, name, 0, 0, nullptr, nullptr, nullptr, 0);
+}
+
+
+static void WriteString(FILE* file, const char* s) {
+  fputc('"', file);
+  for (; *s != '\0'; s++) {
+    const unsigned char c = *s;
+    if (c == '"' || c == '\\')
+      fprintf(file, "\\%c", c);
+    else if (c < 0x20)
+      fprintf(file, "\\u%04x", c);
+    else
+      fputc(c, file);
+  }
+  fputc('"', file);
+}
+
+
+static void WriteArg(FILE* file, uint8_t type, uint64_t value) {
+  switch (type) {
+    case kTypeBool:
+      fputs(value ? "true" : "false", file);
+      break;
+    case kTypeUint:
+      fprintf(file, "%" PRIu64, value);
+      break;
+    case kTypeInt:
+      fprintf(file, "%" PRId64, static_cast<int64_t>(value));
+      break;
+    case kTypeDouble: {
+      double number;
+      memcpy(&number, &value, sizeof(number));
+      if (number == number)
+        fprintf(file, "%.17g", number);
+      else
+        fputs("\"NaN\"", file);
+      break;
+    }
+    case kTypePointer:
+      fprintf(file, "\"0x%" PRIx64 "\"", value);
+      break;
+    case kTypeString:
+    case kTypeCopyString:
+      WriteString(file, reinterpret_cast<const char*>(value));
+      break;
+    default:
+      fputs("null", file);
+      break;
+  }
+}
+
+
+static void WriteChunk(FILE* file, const TraceChunk* chunk) {
+  const int pid = getpid();
+
+  for (size_t i = 0; i < chunk->size; i++) {
+    const TraceEvent& event = chunk->events[i];
+    fputs(first_event ? "\n" : ",\n", file);
+    first_event = false;
+    fprintf(file, "{\"pid\":%d,\"tid\":%d,\"ts\":%" PRIu64 ",\"ph\":\"%c\","
+                  "\"cat\":",
+            pid, chunk->tid, event.timestamp, event.phase);
+    WriteString(file, GetCategoryGroupName(event.category_group_enabled));
+    fputs(",\"name\":", file);
+    WriteString(file, event.name);
+    if ((event.flags & kFlagHasId) || event.phase == 'b' || event.phase == 'e')
+      fprintf(file, ",\"id\":\"0x%" PRIx64 "\"", event.id);
+    fputs(",\"args\":{", file);
+    for (int k = 0; k < event.num_args; k++) {
+      if (k > 0)
+        fputc(',', file);
+      WriteString(file, event.arg_names[k]);
+      fputc(':', file);
+      WriteArg(file, event.arg_types[k], event.arg_values[k]);
+    }
+    fputs("}}", file);
+  }
+}
+
+
+static void FlushThread(void* arg) {
+  std::vector<TraceChunk*> chunks;
+
+  uv_mutex_lock(&mutex);
+  for (;;) {
+    if (full_chunks.empty() && !stopping)
+      uv_cond_timedwait(&cond, &mutex, kFlushInterval);
+    chunks.swap(full_chunks);
+    const bool done = stopping;
+    uv_mutex_unlock(&mutex);
+
+    // Writing happens without the lock, the threads keep recording.
+    for (TraceChunk* chunk : chunks)
+      WriteChunk(trace_file, chunk);
+    fflush(trace_file);
+
+    uv_mutex_lock(&mutex);
+    for (TraceChunk* chunk : chunks) {
+      for (size_t i = 0; i < chunk->size; i++) {
+        chunk->events[i].copied_name.clear();
+        for (size_t k = 0; k < kMaxArgs; k++)
+          chunk->events[i].copied_args[k].clear();
+      }
+      free_chunks.push_back(chunk);
+    }
+    chunks.clear();
+    if (done && full_chunks.empty())
+      break;
+  }
+  uv_mutex_unlock(&mutex);
+}
+
+
+bool StartTracing(const char* categories) {
+  uv_once(&init_once, Init);
+
+  FILE* file = fopen(kTraceFileName, "w");
+  if (file == nullptr)
+    return false;
+  fputs("{\"traceEvents\":[", file);
+
+  uv_mutex_lock(&mutex);
+  CHECK(!tracing);
+  enabled_categories.clear();
+  for (const char* s = categories; *s != '\0';) {
+    const char* comma = strchr(s, ',');
+    const size_t length = comma ? comma - s : strlen(s);
+    if (length > 0)
+      enabled_categories.emplace_back(s, length);
+    s += length;
+    if (*s == ',')
+      s++;
+  }
+  trace_file = file;
+  first_event = true;
+  stopping = false;
+  tracing = true;
+  for (size_t i = 0; i < category_group_count; i++)
+    category_group_enabled[i] = IsCategoryGroupEnabled(category_groups[i]);
+  uv_mutex_unlock(&mutex);
+
+  CHECK_EQ(0, uv_thread_create(&flush_thread, FlushThread, nullptr));
+  return true;
+}
+
+
+void StopTracing() {
+  uv_mutex_lock(&mutex);
+  if (!tracing) {
+    uv_mutex_unlock(&mutex);
+    return;
+  }
+  for (size_t i = 0; i < category_group_count; i++)
+    category_group_enabled[i] = 0;
+  for (ThreadBuffer* buffer : thread_buffers) {
+    if (buffer->chunk->size > 0) {
+      full_chunks.push_back(buffer->chunk);
+      buffer->chunk = NewChunk(buffer->tid);
+    }
+  }
+  stopping = true;
+  uv_cond_signal(&cond);
+  uv_mutex_unlock(&mutex);
+
+  CHECK_EQ(0, uv_thread_join(&flush_thread));
+
+  fputs("\n]}\n", trace_file);
+  fclose(trace_file);
+  trace_file = nullptr;
+  tracing = false;
+}
+
+
+bool IsTracing() {
+  return tracing;
+}
+
+
+// Hands everything but tracing to the platform that it wraps.
+class TracingPlatform : public v8::Platform {
+ public:
+  explicit TracingPlatform(v8::Platform* platform) : platform_(platform) {}
+
+  size_t NumberOfAvailableBackgroundThreads() override {
+    return platform_->NumberOfAvailableBackgroundThreads();
+  }
+
+  void CallOnBackgroundThread(v8::Task* task,
+                              ExpectedRuntime expected_runtime) override {
+    platform_->CallOnBackgroundThread(task, expected_runtime);
+  }
+
+  void CallOnForegroundThread(v8::Isolate* isolate, v8::Task* task) override {
+    platform_->CallOnForegroundThread(isolate, task);
+  }
+
+  void CallDelayedOnForegroundThread(v8::Isolate* isolate,
+                                     v8::Task* task,
+                                     double delay_in_seconds) override {
+    platform_->CallDelayedOnForegroundThread(isolate, task, delay_in_seconds);
+  }
+
+  void CallIdleOnForegroundThread(v8::Isolate* isolate,
+                                  v8::IdleTask* task) override {
+    platform_->CallIdleOnForegroundThread(isolate, task);
+  }
+
+  bool IdleTasksEnabled(v8::Isolate* isolate) override {
+    return platform_->IdleTasksEnabled(isolate);
+  }
+
+  double MonotonicallyIncreasingTime() override {
+    return platform_->MonotonicallyIncreasingTime();
+  }
+
+  const uint8_t* GetCategoryGroupEnabled(const char* name) override {
+    return tracing::GetCategoryGroupEnabled(name);
+  }
+
+  const char* GetCategoryGroupName(const uint8_t* enabled) override {
+    return tracing::GetCategoryGroupName(enabled);
+  }
+
+  uint64_t AddTraceEvent(char phase,
+                         const uint8_t* enabled,
+                         const char* name,
+                         uint64_t id,
+                         uint64_t bind_id,
+                         int32_t num_args,
+                         const char** arg_names,
+                         const uint8_t* arg_types,
+                         const uint64_t* arg_values,
+                         unsigned int flags) override {
+    return tracing::AddTraceEvent(phase, enabled, name, id, num_args,
+                                  arg_names, arg_types, arg_values, flags);
+  }
+
+  void UpdateTraceEventDuration(const uint8_t* enabled,
+                                const char* name,
+                                uint64_t handle) override {
+    tracing::UpdateTraceEventDuration(enabled, name, handle);
+  }
+
+ private:
+  v8::Platform* const platform_;
+};
+
+
+v8::Platform* CreateTracingPlatform(v8::Platform* platform) {
+  return new TracingPlatform(platform);
+}
+
+}  // namespace tracing
+}  // namespace node
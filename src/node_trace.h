@@ -0,0 +1,110 @@
+#ifndef SRC_NODE_TRACE_H_
+#define SRC_NODE_TRACE_H_
+
+#include "v8-platform.h"
+
+#include <stdint.h>
+
+namespace node {
+namespace tracing {
+
+// Trace events in the format of Chrome's trace viewer.  Every thread records
+// into a chunk of its own without locking, full chunks go to a background
+// thread that appends them to node_trace.1.log.  V8 reaches the recorder
+// through the platform that CreateTracingPlatform() returns, node's own
+// events use the NODE_TRACE_* macros below.
+
+// Starts recording the comma-separated |categories|.  A category like "node"
+// also enables "node.fs" and the other categories below it.
+bool StartTracing(const char* categories);
+// Writes out everything that was recorded.  The threads that record must
+// be gone by now.
+void StopTracing();
+bool IsTracing();
+
+// Wraps |platform| so that V8's trace events end up in the recorder.  The
+// wrapper does not own |platform|.
+v8::Platform* CreateTracingPlatform(v8::Platform* platform);
+
+// The flag of a category group stays at the same address for the lifetime
+// of the process, call sites keep it in a static.  It is 0 while the group
+// is not recorded.
+const uint8_t* GetCategoryGroupEnabled(const char* name);
+const char* GetCategoryGroupName(const uint8_t* category_group_enabled);
+
+// |name| and the string arguments must outlive the recorder, unless they
+// are copied with TRACE_EVENT_FLAG_COPY and TRACE_VALUE_TYPE_COPY_STRING.
+uint64_t AddTraceEvent(char phase,
+                       const uint8_t* category_group_enabled,
+                       const char* name,
+                       uint64_t id,
+                       int num_args,
+                       const char** arg_names,
+                       const uint8_t* arg_types,
+                       const uint64_t* arg_values,
+                       unsigned int flags);
+void UpdateTraceEventDuration(const uint8_t* category_group_enabled,
+                              const char* name,
+                              uint64_t handle);
+
+class ScopedTraceEvent {
+ public:
+  ScopedTraceEvent(const uint8_t* category_group_enabled, const char* name)
+      : category_group_enabled_(category_group_enabled),
+        name_(name),
+        enabled_(*category_group_enabled != 0) {
+    if (enabled_) {
+      AddTraceEvent('B', category_group_enabled_, name_, 0,
+                    0, nullptr, nullptr, nullptr, 0);
+    }
+  }
+
+  ~ScopedTraceEvent() {
+    if (enabled_) {
+      AddTraceEvent('E', category_group_enabled_, name_, 0,
+                    0, nullptr, nullptr, nullptr, 0);
+    }
+  }
+
+ private:
+  const uint8_t* const category_group_enabled_;
+  const char* const name_;
+  const bool enabled_;
+};
+
+}  // namespace tracing
+}  // namespace node
+
+#define NODE_TRACE_CONCAT2(a, b) a ## b
+#define NODE_TRACE_CONCAT(a, b) NODE_TRACE_CONCAT2(a, b)
+#define NODE_TRACE_UID(name) NODE_TRACE_CONCAT(node_trace_ ## name, __LINE__)
+
+#define NODE_TRACE_CATEGORY(var, category)                                    \
+  static const uint8_t* const var =                                           \
+      node::tracing::GetCategoryGroupEnabled(category)
+
+// Records the time until the end of the enclosing scope.
+#define NODE_TRACE_EVENT0(category, name)                                     \
+  NODE_TRACE_CATEGORY(NODE_TRACE_UID(enabled), category);                     \
+  node::tracing::ScopedTraceEvent NODE_TRACE_UID(scope)(                      \
+      NODE_TRACE_UID(enabled), name)
+
+// The begin and the end of an asynchronous operation, they are matched
+// through |id|.
+#define NODE_TRACE_ASYNC_EVENT(phase, category, name, id)                     \
+  do {                                                                        \
+    NODE_TRACE_CATEGORY(enabled, category);                                   \
+    if (*enabled) {                                                           \
+      node::tracing::AddTraceEvent(phase, enabled, name,                      \
+                                   reinterpret_cast<uintptr_t>(id),           \
+                                   0, nullptr, nullptr, nullptr, 0);          \
+    }                                                                         \
+  } while (0)
+
+#define NODE_TRACE_ASYNC_BEGIN0(category, name, id)                           \
+  NODE_TRACE_ASYNC_EVENT('b', category, name, id)
+
+#define NODE_TRACE_ASYNC_END0(category, name, id)                             \
+  NODE_TRACE_ASYNC_EVENT('e', category, name, id)
+
+#endif  // SRC_NODE_TRACE_H_
@@ -0,0 +1,284 @@
+#include "node.h"
+#include "node_internals.h"
+
+#include "env.h"
+#include "env-inl.h"
+#include "util.h"
+#include "util-inl.h"
+#include "v8.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Native splitting of URLs for Url.prototype.parse() in lib/url.js.  Instead
+// of substrings, the parser stores the offsets of the components into an
+// Int32Array, and JS only slices the components it sets.  It handles the
+// common forms: paths like "/a/b?c#d" and "http://user@host:80/a?b#c" with
+// one of the protocols that always have slashes.  Anything that the JS parser
+// would escape, trim, decode or truncate is left to the JS parser.
+
+namespace node {
+namespace url {
+
+using v8::Context;
+using v8::FunctionCallbackInfo;
+using v8::Int32Array;
+using v8::Local;
+using v8::Object;
+using v8::String;
+using v8::Uint32;
+using v8::Value;
+
+// Offsets into the input, or -1 for a component that is not present.  The
+// auth ends right before kHostStart, the port starts right after
+// kHostnameEnd and the pathname starts at kHostEnd, or at 0 without a host.
+#define URL_OFFSETS(V)                                                        \
+  V(0, kProtocolEnd)                                                          \
+  V(1, kAuthStart)                                                            \
+  V(2, kHostStart)                                                            \
+  V(3, kHostnameEnd)                                                          \
+  V(4, kHostEnd)                                                              \
+  V(5, kSearchStart)                                                          \
+  V(6, kHashStart)                                                            \
+
+enum Offsets {
+#define V(index, name) name = index,
+  URL_OFFSETS(V)
+#undef V
+  kOffsetsCount
+};
+
+enum Flags {
+  kUpperCaseProtocol = 1,
+  kUpperCaseHostname = 2
+};
+
+static const int kFallback = -1;
+static const size_t kHostnameMaxLength = 255;
+static const size_t kLabelMaxLength = 63;
+
+
+static inline bool IsAlpha(uint8_t c) {
+  return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+}
+
+
+static inline bool IsDigit(uint8_t c) {
+  return c >= '0' && c <= '9';
+}
+
+
+static inline bool IsUpper(uint8_t c) {
+  return c >= 'A' && c <= 'Z';
+}
+
+
+// Characters that the JS parser trims, converts or escapes.
+static inline bool NeedsJS(uint8_t c) {
+  if (c <= ' ' || c >= 0x7F)
+    return true;
+  switch (c) {
+    case '"':
+    case '\'':
+    case '<':
+    case '>':
+    case '\\':
+    case '^':
+    case '`':
+    case '{':
+    case '|':
+    case '}':
+      return true;
+  }
+  return false;
+}
+
+
+// Characters that neither decodeURIComponent() nor encodeAuth() change.
+static inline bool IsPlainAuth(uint8_t c) {
+  return IsAlpha(c) || IsDigit(c) ||
+         c == '!' || c == '-' || c == '.' || c == '_' || c == '~' ||
+         (c >= '\'' && c <= '*') || c == ':';
+}
+
+
+static inline bool IsHostname(uint8_t c) {
+  return IsAlpha(c) || IsDigit(c) || c == '-' || c == '+' || c == '_';
+}
+
+
+static inline bool IsSlashedProtocol(const uint8_t* data, size_t length) {
+  static const char* const protocols[] = {
+    "http", "https", "ftp", "gopher", "file"
+  };
+  for (const char* protocol : protocols) {
+    size_t i = 0;
+    while (i < length && protocol[i] != '\0' &&
+           (data[i] | 0x20) == protocol[i]) {
+      i++;
+    }
+    if (i == length && protocol[i] == '\0')
+      return true;
+  }
+  return false;
+}
+
+
+// Fills `offsets` and returns the flags, or kFallback if the JS parser has
+// to parse the URL.
+static int Split(const uint8_t* data, size_t length, int32_t* offsets) {
+  for (size_t i = 0; i < length; i++) {
+    if (NeedsJS(data[i]))
+      return kFallback;
+  }
+
+  for (int i = 0; i < kOffsetsCount; i++)
+    offsets[i] = -1;
+
+  int flags = 0;
+  size_t path_start = 0;
+
+  if (length > 0 && data[0] == '/') {
+    // "//host/path" depends on slashesDenoteHost and the position of '@'.
+    if (length > 1 && data[1] == '/')
+      return kFallback;
+  } else {
+    size_t i = 0;
+    while (i < length &&
+           (IsAlpha(data[i]) || IsDigit(data[i]) ||
+            data[i] == '.' || data[i] == '+' || data[i] == '-')) {
+      if (IsUpper(data[i]))
+        flags |= kUpperCaseProtocol;
+      i++;
+    }
+
+    if (i > 0 && i < length && data[i] == ':') {
+      if (!IsSlashedProtocol(data, i) ||
+          i + 2 >= length || data[i + 1] != '/' || data[i + 2] != '/') {
+        return kFallback;
+      }
+      offsets[kProtocolEnd] = i + 1;
+
+      // The last '@' before the end of the host ends the auth, the first
+      // '/', '?' or '#' ends the host.
+      const size_t auth_start = i + 3;
+      size_t at_sign = length;
+      size_t host_end = length;
+      for (i = auth_start; i < length; i++) {
+        const uint8_t c = data[i];
+        if (c == '@') {
+          at_sign = i;
+        } else if (c == '/' || c == '?' || c == '#') {
+          host_end = i;
+          break;
+        }
+      }
+
+      size_t host_start = auth_start;
+      if (at_sign != length) {
+        for (i = auth_start; i < at_sign; i++) {
+          if (!IsPlainAuth(data[i]))
+            return kFallback;
+        }
+        offsets[kAuthStart] = auth_start;
+        host_start = at_sign + 1;
+      }
+
+      size_t hostname_end = host_end;
+      while (hostname_end > host_start && IsDigit(data[hostname_end - 1]))
+        hostname_end--;
+      if (hostname_end == host_start || data[hostname_end - 1] != ':')
+        hostname_end = host_end;
+      else
+        hostname_end--;
+
+      if (hostname_end == host_start ||
+          hostname_end - host_start > kHostnameMaxLength) {
+        return kFallback;
+      }
+      size_t label_length = 0;
+      for (i = host_start; i < hostname_end; i++) {
+        const uint8_t c = data[i];
+        if (c == '.') {
+          label_length = 0;
+          continue;
+        }
+        if (!IsHostname(c) || ++label_length > kLabelMaxLength)
+          return kFallback;
+        if (IsUpper(c))
+          flags |= kUpperCaseHostname;
+      }
+
+      offsets[kHostStart] = host_start;
+      offsets[kHostnameEnd] = hostname_end;
+      offsets[kHostEnd] = host_end;
+      path_start = host_end;
+    } else {
+      // A relative path, the protocol characters belong to the pathname.
+      flags = 0;
+    }
+  }
+
+  for (size_t i = path_start; i < length; i++) {
+    if (data[i] == '#') {
+      offsets[kHashStart] = i;
+      break;
+    }
+    if (data[i] == '?' && offsets[kSearchStart] == -1)
+      offsets[kSearchStart] = i;
+  }
+
+  return flags;
+}
+
+
+// parse(url, offsets)
+//
+// Returns the flags and fills the Int32Array `offsets`, or returns undefined
+// if lib/url.js has to parse `url` itself.
+static void Parse(const FunctionCallbackInfo<Value>& args) {
+  CHECK(args[0]->IsString());
+  CHECK(args[1]->IsInt32Array());
+  Local<String> input = args[0].As<String>();
+  Local<Int32Array> array = args[1].As<Int32Array>();
+  CHECK_GE(array->Length(), kOffsetsCount);
+
+  // Only strings with Latin-1 storage can be all ASCII.
+  if (!input->IsOneByte())
+    return;
+
+  int32_t* const offsets = reinterpret_cast<int32_t*>(
+      static_cast<char*>(array->Buffer()->GetContents().Data()) +
+      array->ByteOffset());
+
+  MaybeStackBuffer<uint8_t> data;
+  data.AllocateSufficientStorage(input->Length() + 1);
+  input->WriteOneByte(*data, 0, input->Length(), String::NO_NULL_TERMINATION);
+
+  const int flags = Split(*data, input->Length(), offsets);
+  if (flags != kFallback)
+    args.GetReturnValue().Set(flags);
+}
+
+
+void Initialize(Local<Object> target,
+                Local<Value> unused,
+                Local<Context> context) {
+  Environment* env = Environment::GetCurrent(context);
+  env->SetMethod(target, "parse", Parse);
+
+#define V(index, name)                                                        \
+  target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), #name),                   \
+              Uint32::NewFromUnsigned(env->isolate(), index));
+
+  URL_OFFSETS(V)
+  V(kOffsetsCount, kOffsetsCount)
+  V(kUpperCaseProtocol, kUpperCaseProtocol)
+  V(kUpperCaseHostname, kUpperCaseHostname)
+#undef V
+}
+
+}  // namespace url
+}  // namespace node
+
+NODE_MODULE_CONTEXT_AWARE_BUILTIN(url, node::url::Initialize)
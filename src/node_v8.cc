@@ -1,23 +1,40 @@
 #include "node.h"
+#include "node_buffer.h"
+#include "node_gc_stats.h"
+#include "node_heap_sizer.h"
+#include "buffer_arena.h"
 #include "env.h"
 #include "env-inl.h"
 #include "util.h"
 #include "util-inl.h"
 #include "v8.h"
+#include "v8-profiler.h"
+
+#include <stdio.h>
+#include <deque>
+#include <string>
 
 namespace node {
 
+using v8::AllocationProfile;
 using v8::Array;
 using v8::ArrayBuffer;
 using v8::Context;
+using v8::CpuProfile;
+using v8::CpuProfileNode;
+using v8::CpuProfiler;
+using v8::Float64Array;
 using v8::Function;
 using v8::FunctionCallbackInfo;
+using v8::HeapProfiler;
+using v8::HeapSnapshot;
 using v8::HeapSpaceStatistics;
 using v8::HeapStatistics;
 using v8::Isolate;
 using v8::Local;
 using v8::NewStringType;
 using v8::Object;
+using v8::OutputStream;
 using v8::String;
 using v8::Uint32;
 using v8::V8;
@@ -47,6 +64,19 @@ static const size_t kHeapSpaceStatisticsPropertiesCount =
     HEAP_SPACE_STATISTICS_PROPERTIES(V);
 #undef V
 
+#define BUFFER_ARENA_STATISTICS_PROPERTIES(V)                                 \
+  V(0, reserved_size, kArenaReservedSizeIndex)                                \
+  V(1, mapped_size, kArenaMappedSizeIndex)                                    \
+  V(2, used_size, kArenaUsedSizeIndex)                                        \
+  V(3, cached_size, kArenaCachedSizeIndex)                                    \
+  V(4, free_size, kArenaFreeSizeIndex)                                        \
+  V(5, released_size, kArenaReleasedSizeIndex)
+
+#define V(a, b, c) +1
+static const size_t kBufferArenaStatisticsPropertiesCount =
+    BUFFER_ARENA_STATISTICS_PROPERTIES(V);
+#undef V
+
 // Will be populated in InitializeV8Bindings.
 static size_t number_of_heap_spaces = 0;
 
@@ -79,6 +109,22 @@ void UpdateHeapSpaceStatisticsBuffer(const FunctionCallbackInfo<Value>& args) {
 }
 
 
+// updateBufferArenaStatistics(float64Array)
+void UpdateBufferArenaStatistics(const FunctionCallbackInfo<Value>& args) {
+  CHECK(args[0]->IsFloat64Array());
+  Local<Float64Array> array = args[0].As<Float64Array>();
+  CHECK_GE(array->Length(), kBufferArenaStatisticsPropertiesCount);
+  char* data = static_cast<char*>(array->Buffer()->GetContents().Data());
+  double* const buffer = reinterpret_cast<double*>(data + array->ByteOffset());
+
+  BufferArena::Statistics s;
+  BufferArena::GetStatistics(&s);
+#define V(index, name, _) buffer[index] = static_cast<double>(s.name);
+  BUFFER_ARENA_STATISTICS_PROPERTIES(V)
+#undef V
+}
+
+
 void SetFlagsFromString(const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args);
 
@@ -92,6 +138,367 @@ void SetFlagsFromString(const FunctionCallbackInfo<Value>& args) {
 }
 
 
+// All profiles are recorded under the same title, lib/v8.js makes sure that
+// only one runs at a time.
+static const char kProfileTitle[] = "node";
+
+
+// startCpuProfiling(samplingIntervalUs)
+void StartCpuProfiling(const FunctionCallbackInfo<Value>& args) {
+  Isolate* isolate = args.GetIsolate();
+  CHECK(args[0]->IsUint32());
+  CpuProfiler* profiler = isolate->GetCpuProfiler();
+  profiler->SetSamplingInterval(args[0]->Uint32Value());
+  profiler->StartProfiling(FIXED_ONE_BYTE_STRING(isolate, kProfileTitle),
+                           true);
+}
+
+
+static void AppendJSONString(std::string* out, Isolate* isolate,
+                             Local<String> value) {
+  node::Utf8Value utf8(isolate, value);
+  out->push_back('"');
+  for (const char* p = *utf8; *p != '\0'; p++) {
+    const unsigned char c = *p;
+    if (c == '"' || c == '\\') {
+      out->push_back('\\');
+      out->push_back(c);
+    } else if (c < 0x20) {
+      char escaped[8];
+      snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+      out->append(escaped);
+    } else {
+      out->push_back(c);
+    }
+  }
+  out->push_back('"');
+}
+
+
+static void AppendNumber(std::string* out, int64_t value) {
+  char buf[32];
+  snprintf(buf, sizeof(buf), "%lld", static_cast<long long>(value));  // NOLINT
+  out->append(buf);
+}
+
+
+static void AppendCallFrame(std::string* out,
+                            Isolate* isolate,
+                            Local<String> function_name,
+                            int script_id,
+                            Local<String> url,
+                            int line_number,
+                            int column_number) {
+  out->append("\"callFrame\":{\"functionName\":");
+  AppendJSONString(out, isolate, function_name);
+  out->append(",\"scriptId\":\"");
+  AppendNumber(out, script_id);
+  out->append("\",\"url\":");
+  AppendJSONString(out, isolate, url);
+  // The DevTools protocol counts lines and columns from zero.
+  out->append(",\"lineNumber\":");
+  AppendNumber(out, line_number - 1);
+  out->append(",\"columnNumber\":");
+  AppendNumber(out, column_number - 1);
+  out->push_back('}');
+}
+
+
+static void AppendProfileNode(std::string* out,
+                              Isolate* isolate,
+                              const CpuProfileNode* node) {
+  if (out->back() != '[')
+    out->push_back(',');
+  out->append("{\"id\":");
+  AppendNumber(out, node->GetNodeId());
+  out->push_back(',');
+  AppendCallFrame(out,
+                  isolate,
+                  node->GetFunctionName(),
+                  node->GetScriptId(),
+                  node->GetScriptResourceName(),
+                  node->GetLineNumber(),
+                  node->GetColumnNumber());
+  out->append(",\"hitCount\":");
+  AppendNumber(out, node->GetHitCount());
+  out->append(",\"children\":[");
+  const int count = node->GetChildrenCount();
+  for (int i = 0; i < count; i++) {
+    if (i > 0)
+      out->push_back(',');
+    AppendNumber(out, node->GetChild(i)->GetNodeId());
+  }
+  out->append("]}");
+
+  for (int i = 0; i < count; i++)
+    AppendProfileNode(out, isolate, node->GetChild(i));
+}
+
+
+// stopCpuProfiling() returns the profile as a Buffer with the JSON of a
+// DevTools protocol Profiler.Profile, what a .cpuprofile file contains.
+void StopCpuProfiling(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  Isolate* isolate = env->isolate();
+  CpuProfile* profile = isolate->GetCpuProfiler()->StopProfiling(
+      FIXED_ONE_BYTE_STRING(isolate, kProfileTitle));
+  if (profile == nullptr)
+    return;
+
+  std::string out;
+  out.append("{\"nodes\":[");
+  AppendProfileNode(&out, isolate, profile->GetTopDownRoot());
+  out.append("],\"startTime\":");
+  AppendNumber(&out, profile->GetStartTime());
+  out.append(",\"endTime\":");
+  AppendNumber(&out, profile->GetEndTime());
+
+  const int samples = profile->GetSamplesCount();
+  out.append(",\"samples\":[");
+  for (int i = 0; i < samples; i++) {
+    if (i > 0)
+      out.push_back(',');
+    AppendNumber(&out, profile->GetSample(i)->GetNodeId());
+  }
+  // The time of each sample, relative to the previous one or to startTime.
+  out.append("],\"timeDeltas\":[");
+  int64_t last = profile->GetStartTime();
+  for (int i = 0; i < samples; i++) {
+    if (i > 0)
+      out.push_back(',');
+    const int64_t timestamp = profile->GetSampleTimestamp(i);
+    AppendNumber(&out, timestamp - last);
+    last = timestamp;
+  }
+  out.append("]}");
+  profile->Delete();
+
+  Local<Object> buf;
+  if (Buffer::Copy(env, out.data(), out.size()).ToLocal(&buf))
+    args.GetReturnValue().Set(buf);
+}
+
+
+// startSamplingHeapProfiler(sampleInterval, stackDepth)
+void StartSamplingHeapProfiler(const FunctionCallbackInfo<Value>& args) {
+  CHECK(args[0]->IsUint32());
+  CHECK(args[1]->IsUint32());
+  HeapProfiler* profiler = args.GetIsolate()->GetHeapProfiler();
+  bool started = profiler->StartSamplingHeapProfiler(args[0]->Uint32Value(),
+                                                     args[1]->Uint32Value());
+  args.GetReturnValue().Set(started);
+}
+
+
+void StopSamplingHeapProfiler(const FunctionCallbackInfo<Value>& args) {
+  args.GetIsolate()->GetHeapProfiler()->StopSamplingHeapProfiler();
+}
+
+
+static void AppendAllocationNode(std::string* out,
+                                 Isolate* isolate,
+                                 const AllocationProfile::Node* node) {
+  size_t self_size = 0;
+  for (const AllocationProfile::Allocation& allocation : node->allocations)
+    self_size += allocation.size * allocation.count;
+
+  out->push_back('{');
+  AppendCallFrame(out,
+                  isolate,
+                  node->name,
+                  node->script_id,
+                  node->script_name,
+                  node->line_number,
+                  node->column_number);
+  out->append(",\"selfSize\":");
+  AppendNumber(out, self_size);
+  out->append(",\"children\":[");
+  for (size_t i = 0; i < node->children.size(); i++) {
+    if (i > 0)
+      out->push_back(',');
+    AppendAllocationNode(out, isolate, node->children[i]);
+  }
+  out->append("]}");
+}
+
+
+// getSamplingHeapProfile() returns the allocations that were sampled and are
+// still alive as a Buffer with the JSON of a DevTools protocol
+// HeapProfiler.SamplingHeapProfile, what a .heapprofile file contains.
+void GetSamplingHeapProfile(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  Isolate* isolate = env->isolate();
+  AllocationProfile* profile =
+      isolate->GetHeapProfiler()->GetAllocationProfile();
+  if (profile == nullptr)
+    return;
+
+  std::string out;
+  out.append("{\"head\":");
+  AppendAllocationNode(&out, isolate, profile->GetRootNode());
+  out.push_back('}');
+  delete profile;
+
+  Local<Object> buf;
+  if (Buffer::Copy(env, out.data(), out.size()).ToLocal(&buf))
+    args.GetReturnValue().Set(buf);
+}
+
+
+// Writes a heap snapshot to a file descriptor while V8 serializes it.  The
+// serializer runs on the main thread, which blocks the event loop until it
+// is done, so the chunks are handed to a thread of our own rather than to
+// the libuv threadpool.  At most kMaxPendingChunks are queued, the main thread
+// waits when the disk can't keep up, so the memory needed stays bounded
+// whatever the size of the heap.
+class FileOutputStream : public OutputStream {
+ public:
+  static const int kChunkSize = 64 * 1024;
+  static const size_t kMaxPendingChunks = 16;
+
+  FileOutputStream(uv_loop_t* loop, uv_file fd)
+      : loop_(loop), fd_(fd), error_(0), done_(false) {
+    CHECK_EQ(0, uv_mutex_init(&mutex_));
+    CHECK_EQ(0, uv_cond_init(&cond_));
+    CHECK_EQ(0, uv_thread_create(&thread_, Run, this));
+  }
+
+  ~FileOutputStream() override {
+    uv_cond_destroy(&cond_);
+    uv_mutex_destroy(&mutex_);
+  }
+
+  int GetChunkSize() override { return kChunkSize; }
+
+  WriteResult WriteAsciiChunk(char* data, int size) override {
+    uv_mutex_lock(&mutex_);
+    while (error_ == 0 && chunks_.size() == kMaxPendingChunks)
+      uv_cond_wait(&cond_, &mutex_);
+    const bool failed = error_ != 0;
+    if (!failed) {
+      chunks_.push_back(std::string(data, size));
+      uv_cond_broadcast(&cond_);
+    }
+    uv_mutex_unlock(&mutex_);
+    return failed ? kAbort : kContinue;
+  }
+
+  void EndOfStream() override {}
+
+  // Waits for the writes to finish, returns 0 or the error of the first one
+  // that failed.
+  int Finish() {
+    uv_mutex_lock(&mutex_);
+    done_ = true;
+    uv_cond_broadcast(&cond_);
+    uv_mutex_unlock(&mutex_);
+    CHECK_EQ(0, uv_thread_join(&thread_));
+    return error_;
+  }
+
+ private:
+  static void Run(void* arg) {
+    FileOutputStream* stream = static_cast<FileOutputStream*>(arg);
+    std::string chunk;
+    for (;;) {
+      uv_mutex_lock(&stream->mutex_);
+      while (stream->chunks_.empty() && !stream->done_)
+        uv_cond_wait(&stream->cond_, &stream->mutex_);
+      if (stream->chunks_.empty()) {
+        uv_mutex_unlock(&stream->mutex_);
+        return;
+      }
+      chunk.swap(stream->chunks_.front());
+      stream->chunks_.pop_front();
+      uv_cond_broadcast(&stream->cond_);
+      uv_mutex_unlock(&stream->mutex_);
+
+      int err = stream->Write(chunk.data(), chunk.size());
+      if (err != 0) {
+        uv_mutex_lock(&stream->mutex_);
+        stream->error_ = err;
+        stream->chunks_.clear();
+        uv_cond_broadcast(&stream->cond_);
+        uv_mutex_unlock(&stream->mutex_);
+        return;
+      }
+    }
+  }
+
+  int Write(const char* data, size_t size) {
+    while (size > 0) {
+      uv_fs_t req;
+      uv_buf_t buf = uv_buf_init(const_cast<char*>(data), size);
+      int written = uv_fs_write(loop_, &req, fd_, &buf, 1, -1, nullptr);
+      uv_fs_req_cleanup(&req);
+      if (written < 0)
+        return written;
+      data += written;
+      size -= written;
+    }
+    return 0;
+  }
+
+  uv_loop_t* const loop_;
+  const uv_file fd_;
+  uv_thread_t thread_;
+  uv_mutex_t mutex_;
+  uv_cond_t cond_;
+  std::deque<std::string> chunks_;
+  int error_;
+  bool done_;
+
+  DISALLOW_COPY_AND_ASSIGN(FileOutputStream);
+};
+
+
+// writeHeapSnapshot(fd)
+void WriteHeapSnapshot(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  CHECK(args[0]->IsInt32());
+  uv_file fd = args[0]->Int32Value();
+
+  HeapProfiler* profiler = env->isolate()->GetHeapProfiler();
+  const HeapSnapshot* snapshot = profiler->TakeHeapSnapshot();
+
+  FileOutputStream stream(env->event_loop(), fd);
+  snapshot->Serialize(&stream, HeapSnapshot::kJSON);
+  int err = stream.Finish();
+  const_cast<HeapSnapshot*>(snapshot)->Delete();
+
+  if (err != 0)
+    env->ThrowUVException(err, "write");
+}
+
+
+void StartGCTracking(const FunctionCallbackInfo<Value>& args) {
+  Environment::GetCurrent(args)->gc_stats()->Start();
+}
+
+
+void StopGCTracking(const FunctionCallbackInfo<Value>& args) {
+  Environment::GetCurrent(args)->gc_stats()->Stop();
+}
+
+
+void ResetGCStatistics(const FunctionCallbackInfo<Value>& args) {
+  Environment::GetCurrent(args)->gc_stats()->Reset();
+}
+
+
+// setGCEventsFunction(fn), the pauses are queued for fn while it is set.
+void SetGCEventsFunction(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  if (args[0]->IsFunction()) {
+    env->set_gc_events_function(args[0].As<Function>());
+    env->gc_stats()->SetEventsEnabled(true);
+  } else {
+    env->set_gc_events_function(Local<Function>());
+    env->gc_stats()->SetEventsEnabled(false);
+  }
+}
+
+
 void InitializeV8Bindings(Local<Object> target,
                           Local<Value> unused,
                           Local<Context> context) {
@@ -167,7 +574,86 @@ void InitializeV8Bindings(Local<Object> target,
   HEAP_SPACE_STATISTICS_PROPERTIES(V)
 #undef V
 
+  env->SetMethod(target,
+                 "updateBufferArenaStatistics",
+                 UpdateBufferArenaStatistics);
+
+  target->Set(FIXED_ONE_BYTE_STRING(env->isolate(),
+                                    "kBufferArenaStatisticsPropertiesCount"),
+              Uint32::NewFromUnsigned(env->isolate(),
+                                      kBufferArenaStatisticsPropertiesCount));
+
+#define V(i, _, name)                                                         \
+  target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), #name),                   \
+              Uint32::NewFromUnsigned(env->isolate(), i));
+
+  BUFFER_ARENA_STATISTICS_PROPERTIES(V)
+#undef V
+
   env->SetMethod(target, "setFlagsFromString", SetFlagsFromString);
+  env->SetMethod(target, "startCpuProfiling", StartCpuProfiling);
+  env->SetMethod(target, "stopCpuProfiling", StopCpuProfiling);
+  env->SetMethod(target,
+                 "startSamplingHeapProfiler",
+                 StartSamplingHeapProfiler);
+  env->SetMethod(target,
+                 "stopSamplingHeapProfiler",
+                 StopSamplingHeapProfiler);
+  env->SetMethod(target, "getSamplingHeapProfile", GetSamplingHeapProfile);
+  env->SetMethod(target, "writeHeapSnapshot", WriteHeapSnapshot);
+
+  env->SetMethod(target, "startGCTracking", StartGCTracking);
+  env->SetMethod(target, "stopGCTracking", StopGCTracking);
+  env->SetMethod(target, "resetGCStatistics", ResetGCStatistics);
+  env->SetMethod(target, "setGCEventsFunction", SetGCEventsFunction);
+
+  GCStats* const gc_stats = env->gc_stats();
+  double* const gc_fields = gc_stats->fields();
+  const int gc_fields_count = gc_stats->fields_count();
+  Local<ArrayBuffer> gc_array_buffer =
+      ArrayBuffer::New(env->isolate(),
+                       gc_fields,
+                       sizeof(*gc_fields) * gc_fields_count);
+  target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "gcStatisticsArray"),
+              Float64Array::New(gc_array_buffer, 0, gc_fields_count));
+
+#define V(index, name, _)                                                     \
+  target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), #name),                   \
+              Uint32::NewFromUnsigned(env->isolate(), index));
+
+  GC_TYPES(V)
+#undef V
+
+#define V(index, name)                                                        \
+  target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), #name),                   \
+              Uint32::NewFromUnsigned(env->isolate(), index));
+
+  GC_STATS_FIELDS(V)
+#undef V
+
+  target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "kGCFieldsPerType"),
+              Uint32::NewFromUnsigned(env->isolate(),
+                                      GCStats::kFieldsPerType));
+
+  // Only the main instance sizes its heap, see node_heap_sizer.h.
+  if (HeapSizer::started() && env->worker() == nullptr) {
+    double* const sizer_fields = HeapSizer::fields();
+    Local<ArrayBuffer> sizer_array_buffer =
+        ArrayBuffer::New(env->isolate(),
+                         sizer_fields,
+                         sizeof(*sizer_fields) * HeapSizer::kFieldsCount);
+    target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "heapSizerArray"),
+                Float64Array::New(sizer_array_buffer,
+                                  0,
+                                  HeapSizer::kFieldsCount));
+  }
+
+#define V(index, name)                                                        \
+  target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), #name),                   \
+              Uint32::NewFromUnsigned(env->isolate(), index));
+
+  HEAP_SIZER_FIELDS(V)
+#undef V
 }
 
 }  // namespace node
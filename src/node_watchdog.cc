@@ -1,4 +1,6 @@
 #include "node_watchdog.h"
+#include "env.h"
+#include "env-inl.h"
 #include "util.h"
 #include "util-inl.h"
 
@@ -84,4 +86,105 @@ void Watchdog::Timer(uv_timer_t* timer) {
 }
 
 
+StallWatchdog::StallWatchdog(Environment* env)
+    : env_(env),
+      started_(false),
+      threshold_(0),
+      last_beat_(0),
+      reported_(false) {
+  CHECK_EQ(0, uv_timer_init(env->event_loop(), &beat_timer_));
+  uv_unref(reinterpret_cast<uv_handle_t*>(&beat_timer_));
+  env->RegisterHandleCleanup(reinterpret_cast<uv_handle_t*>(&beat_timer_),
+                             OnClose,
+                             nullptr);
+}
+
+
+StallWatchdog::~StallWatchdog() {
+  Stop();
+}
+
+
+void StallWatchdog::Start(uint64_t threshold_ms) {
+  if (started_ || threshold_ms == 0)
+    return;
+
+  // The time between beats is not counted as blocked, a quarter of the
+  // threshold keeps what is taken for a stall close to the threshold.
+  const uint64_t interval = threshold_ms < 4 ? 1 : threshold_ms / 4;
+  threshold_ = threshold_ms * 1000 * 1000;
+  last_beat_ = uv_hrtime();
+  reported_ = false;
+  CHECK_EQ(0, uv_timer_start(&beat_timer_, OnBeat, interval, interval));
+
+  CHECK_EQ(0, uv_loop_init(&loop_));
+  CHECK_EQ(0, uv_async_init(&loop_, &stop_async_, OnStop));
+  CHECK_EQ(0, uv_timer_init(&loop_, &check_timer_));
+  CHECK_EQ(0, uv_timer_start(&check_timer_, OnCheck, interval, interval));
+  CHECK_EQ(0, uv_thread_create(&thread_, Run, this));
+  started_ = true;
+}
+
+
+void StallWatchdog::Stop() {
+  if (!started_)
+    return;
+
+  uv_async_send(&stop_async_);
+  CHECK_EQ(0, uv_thread_join(&thread_));
+  CHECK_EQ(0, uv_loop_close(&loop_));
+  uv_timer_stop(&beat_timer_);
+  started_ = false;
+}
+
+
+void StallWatchdog::Run(void* arg) {
+  StallWatchdog* w = static_cast<StallWatchdog*>(arg);
+  // Returns once OnStop() has closed both handles.
+  uv_run(&w->loop_, UV_RUN_DEFAULT);
+}
+
+
+void StallWatchdog::OnBeat(uv_timer_t* timer) {
+  StallWatchdog* w = ContainerOf(&StallWatchdog::beat_timer_, timer);
+  w->last_beat_ = uv_hrtime();
+  w->reported_ = false;
+}
+
+
+void StallWatchdog::OnCheck(uv_timer_t* timer) {
+  StallWatchdog* w = ContainerOf(&StallWatchdog::check_timer_, timer);
+  if (uv_hrtime() - w->last_beat_ <= w->threshold_)
+    return;
+  if (!w->reported_.exchange(true))
+    w->env_->isolate()->RequestInterrupt(OnInterrupt, w);
+}
+
+
+void StallWatchdog::OnStop(uv_async_t* async) {
+  StallWatchdog* w = ContainerOf(&StallWatchdog::stop_async_, async);
+  uv_close(reinterpret_cast<uv_handle_t*>(&w->stop_async_), nullptr);
+  uv_close(reinterpret_cast<uv_handle_t*>(&w->check_timer_), nullptr);
+}
+
+
+void StallWatchdog::OnInterrupt(v8::Isolate* isolate, void* data) {
+  StallWatchdog* w = static_cast<StallWatchdog*>(data);
+  // A beat in the meantime means that the loop came around before any JS
+  // ran, the stack would be one that has nothing to do with the stall.
+  if (!w->reported_)
+    return;
+  const uint64_t blocked = uv_hrtime() - w->last_beat_;
+  w->env_->PrintStallTrace(blocked / (1000 * 1000));
+}
+
+
+void StallWatchdog::OnClose(Environment* env, uv_handle_t* handle, void*) {
+  handle->data = env;
+  uv_close(handle, [](uv_handle_t* handle) {
+    static_cast<Environment*>(handle->data)->FinishHandleCleanup(handle);
+  });
+}
+
+
 }  // namespace node
@@ -1,11 +1,16 @@
 #ifndef SRC_NODE_WATCHDOG_H_
 #define SRC_NODE_WATCHDOG_H_
 
+#include "util.h"
 #include "v8.h"
 #include "uv.h"
 
+#include <atomic>
+
 namespace node {
 
+class Environment;
+
 class Watchdog {
  public:
   explicit Watchdog(v8::Isolate* isolate, uint64_t ms);
@@ -30,6 +35,45 @@ class Watchdog {
   bool destroyed_;
 };
 
+// Notices when the event loop of |env| has not come around for longer than
+// a threshold and prints the JS stack that is running at that point, the
+// process keeps going.  A timer on the watched loop beats at a fraction of
+// the threshold, so that an idle loop is not taken for a blocked one, and a
+// thread of its own checks the beats.  The stack comes from an interrupt,
+// so it is printed once JS runs, also when the loop is blocked in C++.
+class StallWatchdog {
+ public:
+  explicit StallWatchdog(Environment* env);
+  ~StallWatchdog();
+
+  void Start(uint64_t threshold_ms);
+  void Stop();
+
+ private:
+  static void Run(void* arg);
+  static void OnBeat(uv_timer_t* timer);
+  static void OnCheck(uv_timer_t* timer);
+  static void OnStop(uv_async_t* async);
+  static void OnInterrupt(v8::Isolate* isolate, void* data);
+  static void OnClose(Environment* env, uv_handle_t* handle, void* arg);
+
+  Environment* const env_;
+  bool started_;
+  uint64_t threshold_;
+  // uv_hrtime() of the last beat, and whether the stall since then was
+  // reported already.  Written by the watched loop and read by the thread.
+  std::atomic<uint64_t> last_beat_;
+  std::atomic<bool> reported_;
+  uv_timer_t beat_timer_;
+
+  uv_thread_t thread_;
+  uv_loop_t loop_;
+  uv_async_t stop_async_;
+  uv_timer_t check_timer_;
+
+  DISALLOW_COPY_AND_ASSIGN(StallWatchdog);
+};
+
 }  // namespace node
 
 #endif  // SRC_NODE_WATCHDOG_H_
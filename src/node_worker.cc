@@ -0,0 +1,442 @@
+#include "node_worker.h"
+#include "node.h"
+#include "node_buffer.h"
+#include "node_internals.h"
+#include "node_serdes.h"
+#include "async-wrap.h"
+#include "async-wrap-inl.h"
+#include "env.h"
+#include "env-inl.h"
+#include "util.h"
+#include "util-inl.h"
+#include "uv.h"
+#include "v8.h"
+
+#include <stdlib.h>
+
+namespace node {
+
+using v8::Boolean;
+using v8::Context;
+using v8::Function;
+using v8::FunctionCallbackInfo;
+using v8::FunctionTemplate;
+using v8::HandleScope;
+using v8::Integer;
+using v8::Local;
+using v8::MaybeLocal;
+using v8::Object;
+using v8::Uint8Array;
+using v8::Value;
+
+
+Worker::Worker(Environment* env,
+               Local<Object> wrap,
+               const std::vector<std::string>& argv)
+    : AsyncWrap(env, wrap, AsyncWrap::PROVIDER_WORKER),
+      argv_(argv),
+      started_(false),
+      joined_(false),
+      child_async_(nullptr),
+      child_isolate_(nullptr),
+      stopping_(false),
+      exited_(false),
+      exit_code_(0),
+      child_env_(nullptr) {
+  CHECK_EQ(0, uv_mutex_init(&mutex_));
+  CHECK_EQ(0, uv_async_init(env->event_loop(), &parent_async_, OnParentAsync));
+  parent_async_.data = this;
+}
+
+
+Worker::~Worker() {
+  CHECK(!started_ || joined_);
+  FreeMessages(&to_child_);
+  FreeMessages(&to_parent_);
+  uv_mutex_destroy(&mutex_);
+}
+
+
+void Worker::FreeMessages(std::deque<Message>* messages) {
+  for (const Message& message : *messages)
+    free(message.data);
+  messages->clear();
+}
+
+
+bool Worker::Serialize(Environment* env,
+                       Local<Value> value,
+                       bool is_error,
+                       Message* message) {
+  message->is_error = is_error;
+  return serdes::Serialize(env, value, &message->data, &message->length);
+}
+
+
+MaybeLocal<Value> Worker::Receive(Environment* env, const Message& message) {
+  // The buffer takes ownership of the data, the values that are read from it
+  // can be views on it.
+  Local<Object> buffer;
+  if (!Buffer::New(env, message.data, message.length).ToLocal(&buffer))
+    return MaybeLocal<Value>();
+  return serdes::Deserialize(env,
+                             buffer.As<Uint8Array>(),
+                             serdes::kHeaderSize,
+                             message.length - serdes::kHeaderSize);
+}
+
+
+void Worker::Run(void* arg) {
+  Worker* worker = static_cast<Worker*>(arg);
+
+  uv_loop_t loop;
+  CHECK_EQ(0, uv_loop_init(&loop));
+
+  const char* argv[] = { worker->argv_[0].c_str(), worker->argv_[1].c_str() };
+  int exit_code;
+  {
+    NodeInstanceData instance_data(NodeInstanceType::WORKER,
+                                   &loop,
+                                   arraysize(argv),
+                                   argv,
+                                   0,
+                                   nullptr,
+                                   false);
+    instance_data.set_worker(worker);
+    StartNodeInstance(&instance_data);
+    exit_code = instance_data.exit_code();
+  }
+
+  CHECK_EQ(0, uv_loop_close(&loop));
+
+  // The parent deletes the Worker once it has joined this thread, it's safe
+  // to use until this function returns.
+  uv_mutex_lock(&worker->mutex_);
+  worker->exit_code_ = exit_code;
+  worker->exited_ = true;
+  uv_async_send(&worker->parent_async_);
+  uv_mutex_unlock(&worker->mutex_);
+}
+
+
+void Worker::ChildStarted(Environment* env) {
+  child_env_ = env;
+  child_async_ = new uv_async_t;
+  CHECK_EQ(0, uv_async_init(env->event_loop(), child_async_, OnChildAsync));
+  child_async_->data = this;
+  // Only a message listener keeps the child alive, see ChildSetOnMessage().
+  uv_unref(reinterpret_cast<uv_handle_t*>(child_async_));
+
+  uv_mutex_lock(&mutex_);
+  child_isolate_ = env->isolate();
+  if (stopping_)
+    child_isolate_->TerminateExecution();
+  if (stopping_ || !to_child_.empty())
+    uv_async_send(child_async_);
+  uv_mutex_unlock(&mutex_);
+}
+
+
+void Worker::ChildStopped(Environment* env) {
+  uv_mutex_lock(&mutex_);
+  stopping_ = true;
+  child_isolate_ = nullptr;
+  uv_async_t* child_async = child_async_;
+  child_async_ = nullptr;
+  uv_mutex_unlock(&mutex_);
+
+  // Nobody can terminate the isolate anymore, let the close callbacks run.
+  env->isolate()->CancelTerminateExecution();
+  child_onmessage_.Reset();
+
+  uv_close(reinterpret_cast<uv_handle_t*>(child_async), [](uv_handle_t* h) {
+    delete reinterpret_cast<uv_async_t*>(h);
+  });
+
+  // The handles die with the thread, unlike in the main instance where the
+  // process exits.
+  CloseEnvironmentHandles(env);
+  child_env_ = nullptr;
+}
+
+
+void Worker::ChildExit(int exit_code) {
+  uv_mutex_lock(&mutex_);
+  if (!stopping_) {
+    stopping_ = true;
+    exit_code_ = exit_code;
+  }
+  uv_mutex_unlock(&mutex_);
+
+  child_env_->isolate()->TerminateExecution();
+  uv_stop(child_env_->event_loop());
+}
+
+
+bool Worker::is_stopping() {
+  uv_mutex_lock(&mutex_);
+  bool stopping = stopping_;
+  uv_mutex_unlock(&mutex_);
+  return stopping;
+}
+
+
+int Worker::exit_code() {
+  uv_mutex_lock(&mutex_);
+  int exit_code = exit_code_;
+  uv_mutex_unlock(&mutex_);
+  return exit_code;
+}
+
+
+void Worker::OnChildAsync(uv_async_t* handle) {
+  Worker* worker = static_cast<Worker*>(handle->data);
+  Environment* env = worker->child_env_;
+  HandleScope handle_scope(env->isolate());
+  Context::Scope context_scope(env->context());
+
+  std::deque<Message> messages;
+  uv_mutex_lock(&worker->mutex_);
+  bool stopping = worker->stopping_;
+  messages.swap(worker->to_child_);
+  uv_mutex_unlock(&worker->mutex_);
+
+  if (stopping) {
+    FreeMessages(&messages);
+    uv_stop(env->event_loop());
+    return;
+  }
+
+  while (!messages.empty()) {
+    Message message = messages.front();
+    messages.pop_front();
+
+    if (worker->child_onmessage_.IsEmpty() || worker->is_stopping()) {
+      free(message.data);
+      continue;
+    }
+
+    Local<Value> value;
+    if (!Receive(env, message).ToLocal(&value))
+      continue;
+    Local<Function> onmessage =
+        PersistentToLocal(env->isolate(), worker->child_onmessage_);
+    node::MakeCallback(env,
+                       env->process_object().As<Value>(),
+                       onmessage,
+                       1,
+                       &value);
+  }
+}
+
+
+void Worker::OnParentAsync(uv_async_t* handle) {
+  Worker* worker = ContainerOf(&Worker::parent_async_, handle);
+  Environment* env = worker->env();
+  HandleScope handle_scope(env->isolate());
+  Context::Scope context_scope(env->context());
+
+  std::deque<Message> messages;
+  uv_mutex_lock(&worker->mutex_);
+  messages.swap(worker->to_parent_);
+  bool exited = worker->exited_;
+  int exit_code = worker->exit_code_;
+  uv_mutex_unlock(&worker->mutex_);
+
+  while (!messages.empty()) {
+    Message message = messages.front();
+    messages.pop_front();
+
+    Local<Value> value;
+    if (!Receive(env, message).ToLocal(&value))
+      continue;
+    worker->MakeCallback(message.is_error ? env->onerror_string() :
+                                            env->onmessage_string(),
+                         1,
+                         &value);
+  }
+
+  if (!exited || worker->joined_)
+    return;
+
+  CHECK_EQ(0, uv_thread_join(&worker->thread_));
+  worker->joined_ = true;
+
+  Local<Value> arg = Integer::New(env->isolate(), exit_code);
+  worker->MakeCallback(env->onexit_string(), 1, &arg);
+
+  uv_close(reinterpret_cast<uv_handle_t*>(&worker->parent_async_), OnClose);
+}
+
+
+void Worker::OnClose(uv_handle_t* handle) {
+  Worker* worker = ContainerOf(&Worker::parent_async_,
+                               reinterpret_cast<uv_async_t*>(handle));
+  HandleScope handle_scope(worker->env()->isolate());
+  ClearWrap(worker->object());
+  delete worker;
+}
+
+
+void Worker::New(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  CHECK(args.IsConstructCall());
+  CHECK(args[0]->IsString());
+  CHECK(args[1]->IsString());
+
+  std::vector<std::string> argv;
+  argv.push_back(*node::Utf8Value(env->isolate(), args[0]));
+  argv.push_back(*node::Utf8Value(env->isolate(), args[1]));
+  new Worker(env, args.This(), argv);
+}
+
+
+void Worker::Start(const FunctionCallbackInfo<Value>& args) {
+  Worker* worker = Unwrap<Worker>(args.Holder());
+  if (worker == nullptr || worker->started_)
+    return;
+
+  int err = uv_thread_create(&worker->thread_, Run, worker);
+  if (err == 0) {
+    worker->started_ = true;
+  } else {
+    uv_close(reinterpret_cast<uv_handle_t*>(&worker->parent_async_), OnClose);
+  }
+  args.GetReturnValue().Set(err);
+}
+
+
+void Worker::PostMessage(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  Worker* worker = Unwrap<Worker>(args.Holder());
+  if (worker == nullptr)
+    return;
+
+  Message message;
+  if (!Serialize(env, args[0], false, &message))
+    return;
+
+  uv_mutex_lock(&worker->mutex_);
+  if (worker->stopping_ || worker->exited_) {
+    free(message.data);
+  } else {
+    worker->to_child_.push_back(message);
+    // Before the child started, ChildStarted() sends the wakeup.
+    if (worker->child_async_ != nullptr)
+      uv_async_send(worker->child_async_);
+  }
+  uv_mutex_unlock(&worker->mutex_);
+}
+
+
+void Worker::Terminate(const FunctionCallbackInfo<Value>& args) {
+  Worker* worker = Unwrap<Worker>(args.Holder());
+  if (worker == nullptr)
+    return;
+
+  uv_mutex_lock(&worker->mutex_);
+  if (!worker->stopping_ && !worker->exited_) {
+    worker->stopping_ = true;
+    worker->exit_code_ = 1;
+    if (worker->child_isolate_ != nullptr)
+      worker->child_isolate_->TerminateExecution();
+    if (worker->child_async_ != nullptr)
+      uv_async_send(worker->child_async_);
+  }
+  uv_mutex_unlock(&worker->mutex_);
+}
+
+
+void Worker::Ref(const FunctionCallbackInfo<Value>& args) {
+  Worker* worker = Unwrap<Worker>(args.Holder());
+  if (worker != nullptr)
+    uv_ref(reinterpret_cast<uv_handle_t*>(&worker->parent_async_));
+}
+
+
+void Worker::Unref(const FunctionCallbackInfo<Value>& args) {
+  Worker* worker = Unwrap<Worker>(args.Holder());
+  if (worker != nullptr)
+    uv_unref(reinterpret_cast<uv_handle_t*>(&worker->parent_async_));
+}
+
+
+void Worker::ChildPostMessage(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  Worker* worker = env->worker();
+  if (worker == nullptr)
+    return env->ThrowError("Not running in a worker");
+
+  Message message;
+  if (!Serialize(env, args[0], false, &message))
+    return;
+
+  uv_mutex_lock(&worker->mutex_);
+  worker->to_parent_.push_back(message);
+  uv_async_send(&worker->parent_async_);
+  uv_mutex_unlock(&worker->mutex_);
+}
+
+
+void Worker::ChildReportError(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  Worker* worker = env->worker();
+  CHECK_NE(worker, nullptr);
+
+  Message message;
+  if (!Serialize(env, args[0], true, &message))
+    return;
+
+  uv_mutex_lock(&worker->mutex_);
+  worker->to_parent_.push_back(message);
+  uv_async_send(&worker->parent_async_);
+  uv_mutex_unlock(&worker->mutex_);
+}
+
+
+void Worker::ChildSetOnMessage(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  Worker* worker = env->worker();
+  if (worker == nullptr)
+    return env->ThrowError("Not running in a worker");
+
+  uv_handle_t* handle = reinterpret_cast<uv_handle_t*>(worker->child_async_);
+  if (args[0]->IsFunction()) {
+    worker->child_onmessage_.Reset(env->isolate(), args[0].As<Function>());
+    uv_ref(handle);
+  } else {
+    worker->child_onmessage_.Reset();
+    uv_unref(handle);
+  }
+}
+
+
+void Worker::Initialize(Local<Object> target,
+                        Local<Value> unused,
+                        Local<Context> context) {
+  Environment* env = Environment::GetCurrent(context);
+
+  Local<FunctionTemplate> t = env->NewFunctionTemplate(New);
+  t->InstanceTemplate()->SetInternalFieldCount(1);
+  t->SetClassName(FIXED_ONE_BYTE_STRING(env->isolate(), "Worker"));
+
+  env->SetProtoMethod(t, "start", Start);
+  env->SetProtoMethod(t, "postMessage", PostMessage);
+  env->SetProtoMethod(t, "terminate", Terminate);
+  env->SetProtoMethod(t, "ref", Ref);
+  env->SetProtoMethod(t, "unref", Unref);
+
+  target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "Worker"),
+              t->GetFunction());
+
+  env->SetMethod(target, "postMessageToParent", ChildPostMessage);
+  env->SetMethod(target, "reportError", ChildReportError);
+  env->SetMethod(target, "setOnMessage", ChildSetOnMessage);
+
+  target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "isMainThread"),
+              Boolean::New(env->isolate(), env->worker() == nullptr));
+}
+
+}  // namespace node
+
+NODE_MODULE_CONTEXT_AWARE_BUILTIN(worker, node::Worker::Initialize)
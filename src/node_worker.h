@@ -0,0 +1,108 @@
+#ifndef SRC_NODE_WORKER_H_
+#define SRC_NODE_WORKER_H_
+
+#include "async-wrap.h"
+#include "util.h"
+#include "uv.h"
+#include "v8.h"
+
+#include <stddef.h>
+
+#include <deque>
+#include <string>
+#include <vector>
+
+namespace node {
+
+class Environment;
+
+// A node instance with an isolate, an Environment and an event loop of its
+// own, on a thread of its own.  The Worker object belongs to the parent's
+// Environment, the methods that start with "Child" are only called on the
+// worker thread.  Messages are passed in both directions as serialized
+// values, see node_serdes.h.
+class Worker : public AsyncWrap {
+ public:
+  ~Worker() override;
+
+  static void Initialize(v8::Local<v8::Object> target,
+                         v8::Local<v8::Value> unused,
+                         v8::Local<v8::Context> context);
+
+  // Called once the child's bootstrap code is compiled, before it runs.
+  void ChildStarted(Environment* env);
+  // Called when the child's event loop is done.  Closes the child's handles.
+  void ChildStopped(Environment* env);
+  // Stops the child with |exit_code|, for process.exit() and for uncaught
+  // exceptions in the child.
+  void ChildExit(int exit_code);
+  // Whether the child was asked to stop, by itself or by the parent.
+  bool is_stopping();
+  int exit_code();
+
+  size_t self_size() const override { return sizeof(*this); }
+
+ private:
+  struct Message {
+    char* data;
+    size_t length;
+    bool is_error;
+  };
+
+  Worker(Environment* env,
+         v8::Local<v8::Object> wrap,
+         const std::vector<std::string>& argv);
+
+  static void New(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void Start(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void PostMessage(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void Terminate(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void Ref(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void Unref(const v8::FunctionCallbackInfo<v8::Value>& args);
+
+  // Functions for the child's process.binding('worker').
+  static void ChildPostMessage(const v8::FunctionCallbackInfo<v8::Value>& a);
+  static void ChildReportError(const v8::FunctionCallbackInfo<v8::Value>& a);
+  static void ChildSetOnMessage(const v8::FunctionCallbackInfo<v8::Value>& a);
+
+  static void Run(void* arg);
+  static void OnParentAsync(uv_async_t* handle);
+  static void OnChildAsync(uv_async_t* handle);
+  static void OnClose(uv_handle_t* handle);
+
+  // Serializes |value| into |message|.  Returns false with an exception
+  // pending if |value| can't be cloned.
+  static bool Serialize(Environment* env,
+                        v8::Local<v8::Value> value,
+                        bool is_error,
+                        Message* message);
+  static v8::MaybeLocal<v8::Value> Receive(Environment* env,
+                                           const Message& message);
+  static void FreeMessages(std::deque<Message>* messages);
+
+  std::vector<std::string> argv_;
+  uv_thread_t thread_;
+  bool started_;
+  bool joined_;
+
+  // Guards the members that are shared between the threads.
+  uv_mutex_t mutex_;
+  std::deque<Message> to_child_;
+  std::deque<Message> to_parent_;
+  uv_async_t parent_async_;
+  uv_async_t* child_async_;
+  v8::Isolate* child_isolate_;
+  bool stopping_;
+  bool exited_;
+  int exit_code_;
+
+  // Only used on the worker thread.
+  Environment* child_env_;
+  v8::Persistent<v8::Function> child_onmessage_;
+
+  DISALLOW_COPY_AND_ASSIGN(Worker);
+};
+
+}  // namespace node
+
+#endif  // SRC_NODE_WORKER_H_
@@ -16,6 +16,8 @@
 #include <string.h>
 #include <sys/types.h>
 
+#include <unordered_map>
+
 namespace node {
 
 using v8::Array;
@@ -47,6 +49,92 @@ enum node_zlib_mode {
 void InitZlib(v8::Local<v8::Object> target);
 
 
+/**
+ * Preset dictionaries registered with zlib.registerDictionary().  Streams
+ * refer to them by id and share the bytes instead of holding a copy each.
+ * A dictionary is freed once it has been unregistered and the last stream
+ * that uses it is closed.  Only the main thread registers, looks up and
+ * releases dictionaries; the thread pool just reads the bytes.
+ */
+class SharedDictionary {
+ public:
+  static SharedDictionary* Lookup(uint32_t id) {
+    auto it = registry()->find(id);
+    if (it == registry()->end())
+      return nullptr;
+    it->second->refs_++;
+    return it->second;
+  }
+
+  void Unref() {
+    CHECK_GT(refs_, 0);
+    if (--refs_ == 0)
+      delete this;
+  }
+
+  const Bytef* data() const { return data_; }
+  size_t length() const { return length_; }
+
+  // registerDictionary(buffer)
+  static void Register(const FunctionCallbackInfo<Value>& args) {
+    CHECK(Buffer::HasInstance(args[0]));
+    SharedDictionary* dictionary =
+        new SharedDictionary(Buffer::Data(args[0]), Buffer::Length(args[0]));
+
+    static uint32_t next_id = 1;
+    uint32_t id = next_id++;
+    registry()->emplace(id, dictionary);
+    args.GetReturnValue().Set(id);
+  }
+
+  // unregisterDictionary(id)
+  static void Unregister(const FunctionCallbackInfo<Value>& args) {
+    CHECK(args[0]->IsUint32());
+    auto it = registry()->find(args[0]->Uint32Value());
+    if (it == registry()->end())
+      return args.GetReturnValue().Set(false);
+
+    it->second->Unref();
+    registry()->erase(it);
+    args.GetReturnValue().Set(true);
+  }
+
+ private:
+  typedef std::unordered_map<uint32_t, SharedDictionary*> Registry;
+
+  SharedDictionary(const char* data, size_t length)
+      : data_(new Bytef[length]),
+        length_(length),
+        refs_(1) {
+    memcpy(data_, data, length);
+  }
+
+  ~SharedDictionary() {
+    delete[] data_;
+  }
+
+  static Registry* registry() {
+    static Registry* registry = new Registry();
+    return registry;
+  }
+
+  Bytef* const data_;
+  const size_t length_;
+  int refs_;
+};
+
+
+// Thread pool priority of the asynchronous work, one of the UV_PRIORITY_*
+// constants.
+static uv_work_priority PriorityFromValue(Local<Value> value) {
+  uint32_t priority = value->Uint32Value();
+  CHECK((priority == UV_PRIORITY_HIGH ||
+         priority == UV_PRIORITY_NORMAL ||
+         priority == UV_PRIORITY_LOW) && "invalid priority");
+  return static_cast<uv_work_priority>(priority);
+}
+
+
 /**
  * Deflate/Inflate
  */
@@ -58,6 +146,7 @@ class ZCtx : public AsyncWrap {
         chunk_size_(0),
         dictionary_(nullptr),
         dictionary_len_(0),
+        shared_dictionary_(nullptr),
         err_(0),
         flush_(0),
         init_done_(false),
@@ -69,7 +158,10 @@ class ZCtx : public AsyncWrap {
         write_in_progress_(false),
         pending_close_(false),
         refs_(0),
-        gzip_id_bytes_read_(0) {
+        gzip_id_bytes_read_(0),
+        priority_(UV_PRIORITY_NORMAL),
+        scratch_(nullptr),
+        scratch_len_(0) {
     MakeWeak<ZCtx>(this);
   }
 
@@ -101,10 +193,17 @@ class ZCtx : public AsyncWrap {
     }
     mode_ = NONE;
 
-    if (dictionary_ != nullptr) {
+    if (shared_dictionary_ != nullptr) {
+      shared_dictionary_->Unref();
+      shared_dictionary_ = nullptr;
+    } else if (dictionary_ != nullptr) {
       delete[] dictionary_;
-      dictionary_ = nullptr;
     }
+    dictionary_ = nullptr;
+
+    free(scratch_);
+    scratch_ = nullptr;
+    scratch_len_ = 0;
   }
 
 
@@ -192,15 +291,91 @@ class ZCtx : public AsyncWrap {
     }
 
     // async version
-    uv_queue_work(ctx->env()->event_loop(),
-                  work_req,
-                  ZCtx::Process,
-                  ZCtx::After);
+    uv_queue_work_priority(ctx->env()->event_loop(),
+                           work_req,
+                           ZCtx::Process,
+                           ZCtx::After,
+                           ctx->priority_);
 
     args.GetReturnValue().Set(ctx->object());
   }
 
 
+  // compressSync(in, out, out_off)
+  // Compresses all of in at once and resets the stream for the next call.
+  // If out is a buffer, the output is written to it starting at out_off and
+  // the number of bytes written is returned, or -1 if they did not fit.
+  // Otherwise a copy of the output is returned; the memory it is compressed
+  // into is kept for the next call.
+  static void CompressSync(const FunctionCallbackInfo<Value>& args) {
+    ZCtx* ctx = Unwrap<ZCtx>(args.Holder());
+    Environment* env = ctx->env();
+    CHECK(ctx->init_done_ && "compress before init");
+    CHECK((ctx->mode_ == DEFLATE ||
+           ctx->mode_ == GZIP ||
+           ctx->mode_ == DEFLATERAW) && "not a compressor");
+    CHECK_EQ(false, ctx->write_in_progress_ && "write in progress");
+
+    CHECK(Buffer::HasInstance(args[0]));
+    Local<Object> in_buf = args[0].As<Object>();
+    size_t in_len = Buffer::Length(in_buf);
+
+    Bytef* out;
+    size_t out_len;
+    bool use_scratch = !Buffer::HasInstance(args[1]);
+    if (use_scratch) {
+      // Enough for deflate() to finish in a single call.
+      out_len = deflateBound(&ctx->strm_, in_len);
+      if (ctx->scratch_len_ < out_len) {
+        free(ctx->scratch_);
+        ctx->scratch_ = static_cast<Bytef*>(malloc(out_len));
+        CHECK_NE(ctx->scratch_, nullptr);
+        ctx->scratch_len_ = out_len;
+      }
+      out = ctx->scratch_;
+    } else {
+      Local<Object> out_buf = args[1].As<Object>();
+      size_t out_off = args[2]->Uint32Value();
+      CHECK_LE(out_off, Buffer::Length(out_buf));
+      out = reinterpret_cast<Bytef*>(Buffer::Data(out_buf)) + out_off;
+      out_len = Buffer::Length(out_buf) - out_off;
+    }
+
+    ctx->strm_.avail_in = in_len;
+    ctx->strm_.next_in = reinterpret_cast<Bytef*>(Buffer::Data(in_buf));
+    ctx->strm_.avail_out = out_len;
+    ctx->strm_.next_out = out;
+    ctx->flush_ = Z_FINISH;
+
+    env->PrintSyncTrace();
+    Process(&ctx->work_req_);
+
+    if (ctx->err_ != Z_STREAM_END &&
+        ctx->err_ != Z_OK &&
+        ctx->err_ != Z_BUF_ERROR) {
+      return ZCtx::Error(ctx, "Zlib error");
+    }
+
+    bool done = ctx->err_ == Z_STREAM_END;
+    size_t written = out_len - ctx->strm_.avail_out;
+
+    Reset(ctx);
+    SetDictionary(ctx);
+
+    if (use_scratch) {
+      CHECK(done);
+      Local<Object> result =
+          Buffer::Copy(env, reinterpret_cast<char*>(out), written)
+          .ToLocalChecked();
+      args.GetReturnValue().Set(result);
+    } else if (done) {
+      args.GetReturnValue().Set(static_cast<uint32_t>(written));
+    } else {
+      args.GetReturnValue().Set(-1);
+    }
+  }
+
+
   static void AfterSync(ZCtx* ctx, const FunctionCallbackInfo<Value>& args) {
     Environment* env = ctx->env();
     Local<Integer> avail_out = Integer::New(env->isolate(),
@@ -451,6 +626,7 @@ class ZCtx : public AsyncWrap {
 
     char* dictionary = nullptr;
     size_t dictionary_len = 0;
+    SharedDictionary* shared_dictionary = nullptr;
     if (args.Length() >= 5 && Buffer::HasInstance(args[4])) {
       Local<Object> dictionary_ = args[4]->ToObject(args.GetIsolate());
 
@@ -458,10 +634,18 @@ class ZCtx : public AsyncWrap {
       dictionary = new char[dictionary_len];
 
       memcpy(dictionary, Buffer::Data(dictionary_), dictionary_len);
+    } else if (args.Length() >= 5 && args[4]->IsUint32()) {
+      shared_dictionary = SharedDictionary::Lookup(args[4]->Uint32Value());
+      CHECK(shared_dictionary != nullptr && "unknown dictionary");
     }
 
     Init(ctx, level, windowBits, memLevel, strategy,
          dictionary, dictionary_len);
+    if (shared_dictionary != nullptr) {
+      ctx->shared_dictionary_ = shared_dictionary;
+      ctx->dictionary_ = shared_dictionary->data();
+      ctx->dictionary_len_ = shared_dictionary->length();
+    }
     SetDictionary(ctx);
   }
 
@@ -477,6 +661,12 @@ class ZCtx : public AsyncWrap {
     SetDictionary(ctx);
   }
 
+  // setPriority(priority)
+  static void SetPriority(const FunctionCallbackInfo<Value>& args) {
+    ZCtx* ctx = Unwrap<ZCtx>(args.Holder());
+    ctx->priority_ = PriorityFromValue(args[0]);
+  }
+
   static void Init(ZCtx *ctx, int level, int windowBits, int memLevel,
                    int strategy, char* dictionary, size_t dictionary_len) {
     ctx->level_ = level;
@@ -623,8 +813,9 @@ class ZCtx : public AsyncWrap {
   static const int kInflateContextSize = 10240;  // approximate
 
   int chunk_size_;
-  Bytef* dictionary_;
+  const Bytef* dictionary_;
   size_t dictionary_len_;
+  SharedDictionary* shared_dictionary_;
   int err_;
   int flush_;
   bool init_done_;
@@ -639,6 +830,195 @@ class ZCtx : public AsyncWrap {
   bool pending_close_;
   unsigned int refs_;
   unsigned int gzip_id_bytes_read_;
+  uv_work_priority priority_;
+  Bytef* scratch_;
+  size_t scratch_len_;
+};
+
+
+/**
+ * Compresses one block of a parallel gzip stream in the thread pool.  The
+ * block is primed with the end of the previous block as its dictionary and
+ * ends on a byte boundary, so that the raw deflate output of consecutive
+ * blocks can be concatenated into a single deflate stream.
+ */
+class DeflateBlock : public AsyncWrap {
+ public:
+  DeflateBlock(Environment* env,
+               Local<Object> wrap,
+               const Bytef* in,
+               size_t in_len,
+               const Bytef* dictionary,
+               size_t dictionary_len,
+               int level,
+               int memLevel,
+               int strategy,
+               bool last)
+      : AsyncWrap(env, wrap, AsyncWrap::PROVIDER_ZLIB),
+        in_(in),
+        in_len_(in_len),
+        dictionary_(dictionary),
+        dictionary_len_(dictionary_len),
+        level_(level),
+        memLevel_(memLevel),
+        strategy_(strategy),
+        last_(last),
+        err_(Z_OK),
+        crc_(0),
+        out_(nullptr),
+        out_len_(0) {
+    Wrap(wrap, this);
+  }
+
+  ~DeflateBlock() override {
+    free(out_);
+    persistent().Reset();
+  }
+
+  // deflateBlock(in, dictionary, level, memLevel, strategy, last, priority)
+  static void New(const FunctionCallbackInfo<Value>& args) {
+    Environment* env = Environment::GetCurrent(args);
+    CHECK_EQ(args.Length(), 7);
+    CHECK(Buffer::HasInstance(args[0]));
+
+    const Bytef* dictionary = nullptr;
+    size_t dictionary_len = 0;
+    if (Buffer::HasInstance(args[1])) {
+      dictionary = reinterpret_cast<Bytef*>(Buffer::Data(args[1]));
+      dictionary_len = Buffer::Length(args[1]);
+    }
+
+    int level = args[2]->Int32Value();
+    CHECK((level >= -1 && level <= 9) && "invalid compression level");
+    int memLevel = args[3]->Uint32Value();
+    CHECK((memLevel >= 1 && memLevel <= 9) && "invalid memlevel");
+
+    // The caller keeps the input and the dictionary alive until the
+    // request completes.
+    Local<Object> obj = env->NewInternalFieldObject();
+    DeflateBlock* req =
+        new DeflateBlock(env,
+                         obj,
+                         reinterpret_cast<Bytef*>(Buffer::Data(args[0])),
+                         Buffer::Length(args[0]),
+                         dictionary,
+                         dictionary_len,
+                         level,
+                         memLevel,
+                         args[4]->Uint32Value(),
+                         args[5]->IsTrue());
+    uv_queue_work_priority(env->event_loop(),
+                           &req->work_req_,
+                           DeflateBlock::Process,
+                           DeflateBlock::After,
+                           PriorityFromValue(args[6]));
+
+    args.GetReturnValue().Set(obj);
+  }
+
+  // crc32Combine(crc1, crc2, len2)
+  static void Crc32Combine(const FunctionCallbackInfo<Value>& args) {
+    uLong crc = crc32_combine(args[0]->Uint32Value(),
+                              args[1]->Uint32Value(),
+                              args[2]->IntegerValue());
+    args.GetReturnValue().Set(static_cast<uint32_t>(crc));
+  }
+
+  size_t self_size() const override { return sizeof(*this); }
+
+ private:
+  static const int kWindowBits = 15;
+
+  static void Process(uv_work_t* work_req) {
+    DeflateBlock* req = ContainerOf(&DeflateBlock::work_req_, work_req);
+
+    req->crc_ = crc32(0, req->in_, req->in_len_);
+
+    z_stream strm;
+    strm.zalloc = Z_NULL;
+    strm.zfree = Z_NULL;
+    strm.opaque = Z_NULL;
+
+    req->err_ = deflateInit2(&strm,
+                             req->level_,
+                             Z_DEFLATED,
+                             -kWindowBits,
+                             req->memLevel_,
+                             req->strategy_);
+    if (req->err_ != Z_OK)
+      return;
+
+    if (req->dictionary_len_ > 0) {
+      req->err_ = deflateSetDictionary(&strm,
+                                       req->dictionary_,
+                                       req->dictionary_len_);
+    }
+
+    // Z_SYNC_FLUSH aligns all but the last block to a byte boundary with an
+    // empty stored block, there is enough room for it after deflateBound().
+    size_t out_size = deflateBound(&strm, req->in_len_) + 16;
+    int flush = req->last_ ? Z_FINISH : Z_SYNC_FLUSH;
+    strm.next_in = const_cast<Bytef*>(req->in_);
+    strm.avail_in = req->in_len_;
+
+    while (req->err_ == Z_OK) {
+      req->out_ = static_cast<Bytef*>(realloc(req->out_, out_size));
+      CHECK_NE(req->out_, nullptr);
+      strm.next_out = req->out_ + req->out_len_;
+      strm.avail_out = out_size - req->out_len_;
+
+      req->err_ = deflate(&strm, flush);
+      req->out_len_ = out_size - strm.avail_out;
+
+      if (req->err_ == Z_STREAM_END || (!req->last_ && strm.avail_out != 0)) {
+        req->err_ = Z_OK;
+        break;
+      }
+      if (req->err_ == Z_BUF_ERROR)
+        req->err_ = Z_OK;
+      out_size *= 2;
+    }
+
+    (void)deflateEnd(&strm);
+  }
+
+  static void After(uv_work_t* work_req, int status) {
+    CHECK_EQ(status, 0);
+
+    DeflateBlock* req = ContainerOf(&DeflateBlock::work_req_, work_req);
+    Environment* env = req->env();
+
+    HandleScope handle_scope(env->isolate());
+    Context::Scope context_scope(env->context());
+
+    Local<Value> args[3] = {
+      Integer::New(env->isolate(), req->err_),
+      v8::Null(env->isolate()),
+      Integer::NewFromUnsigned(env->isolate(), req->crc_)
+    };
+    if (req->err_ == Z_OK) {
+      args[1] = Buffer::New(env,
+                            reinterpret_cast<char*>(req->out_),
+                            req->out_len_).ToLocalChecked();
+      req->out_ = nullptr;
+    }
+    req->MakeCallback(env->oncomplete_string(), arraysize(args), args);
+    delete req;
+  }
+
+  const Bytef* const in_;
+  const size_t in_len_;
+  const Bytef* const dictionary_;
+  const size_t dictionary_len_;
+  const int level_;
+  const int memLevel_;
+  const int strategy_;
+  const bool last_;
+  int err_;
+  uint32_t crc_;
+  Bytef* out_;
+  size_t out_len_;
+  uv_work_t work_req_;
 };
 
 
@@ -653,14 +1033,26 @@ void InitZlib(Local<Object> target,
 
   env->SetProtoMethod(z, "write", ZCtx::Write<true>);
   env->SetProtoMethod(z, "writeSync", ZCtx::Write<false>);
+  env->SetProtoMethod(z, "compressSync", ZCtx::CompressSync);
   env->SetProtoMethod(z, "init", ZCtx::Init);
   env->SetProtoMethod(z, "close", ZCtx::Close);
   env->SetProtoMethod(z, "params", ZCtx::Params);
   env->SetProtoMethod(z, "reset", ZCtx::Reset);
+  env->SetProtoMethod(z, "setPriority", ZCtx::SetPriority);
 
   z->SetClassName(FIXED_ONE_BYTE_STRING(env->isolate(), "Zlib"));
   target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "Zlib"), z->GetFunction());
 
+  env->SetMethod(target, "deflateBlock", DeflateBlock::New);
+  env->SetMethod(target, "crc32Combine", DeflateBlock::Crc32Combine);
+  env->SetMethod(target, "registerDictionary", SharedDictionary::Register);
+  env->SetMethod(target, "unregisterDictionary", SharedDictionary::Unregister);
+
+  // thread pool priorities.
+  NODE_DEFINE_CONSTANT(target, UV_PRIORITY_HIGH);
+  NODE_DEFINE_CONSTANT(target, UV_PRIORITY_NORMAL);
+  NODE_DEFINE_CONSTANT(target, UV_PRIORITY_LOW);
+
   // valid flush values.
   NODE_DEFINE_CONSTANT(target, Z_NO_FLUSH);
   NODE_DEFINE_CONSTANT(target, Z_PARTIAL_FLUSH);
@@ -9,12 +9,20 @@
 #include "node_wrap.h"
 #include "req-wrap.h"
 #include "req-wrap-inl.h"
+#include "stream_base-inl.h"
 #include "stream_wrap.h"
 #include "util-inl.h"
 #include "util.h"
 
+#ifndef _WIN32
+#include <errno.h>
+#include <string.h>
+#include <sys/socket.h>
+#endif
+
 namespace node {
 
+using v8::Array;
 using v8::Boolean;
 using v8::Context;
 using v8::EscapableHandleScope;
@@ -46,6 +54,11 @@ PipeConnectWrap::PipeConnectWrap(Environment* env, Local<Object> req_wrap_obj)
 }
 
 
+// The most handles that writeHandles() sends with one message, which is
+// also how many descriptors libuv takes in with one read.
+static const uint32_t kMaxHandles = 64;
+
+
 static void NewPipeConnectWrap(const FunctionCallbackInfo<Value>& args) {
   CHECK(args.IsConstructCall());
 }
@@ -88,11 +101,16 @@ void PipeWrap::Initialize(Local<Object> target,
   env->SetProtoMethod(t, "listen", Listen);
   env->SetProtoMethod(t, "connect", Connect);
   env->SetProtoMethod(t, "open", Open);
+  env->SetProtoMethod(t, "writeHandles", WriteHandles);
+  env->SetProtoMethod(t, "acceptPending", AcceptPending);
 
 #ifdef _WIN32
   env->SetProtoMethod(t, "setPendingInstances", SetPendingInstances);
 #endif
 
+  t->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "kMaxHandles"),
+         Integer::NewFromUnsigned(env->isolate(), kMaxHandles));
+
   target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "Pipe"), t->GetFunction());
   env->set_pipe_constructor_template(t);
 
@@ -164,6 +182,160 @@ void PipeWrap::Listen(const FunctionCallbackInfo<Value>& args) {
 }
 
 
+#ifndef _WIN32
+// Writes as much of the data as the socket takes right now, in one
+// sendmsg() call that passes all the descriptors in one SCM_RIGHTS message.
+// Returns the number of bytes written or a negative errno.
+static ssize_t SendWithDescriptors(int fd,
+                                   const char* data,
+                                   size_t length,
+                                   const int* fds,
+                                   size_t count) {
+  union {
+    char buf[CMSG_SPACE(kMaxHandles * sizeof(*fds))];
+    struct cmsghdr alignment;
+  } control;
+  struct iovec iov;
+  struct msghdr msg;
+
+  memset(&control, 0, sizeof(control));
+  memset(&msg, 0, sizeof(msg));
+  iov.iov_base = const_cast<char*>(data);
+  iov.iov_len = length;
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = control.buf;
+  msg.msg_controllen = CMSG_SPACE(count * sizeof(*fds));
+
+  struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+  cmsg->cmsg_level = SOL_SOCKET;
+  cmsg->cmsg_type = SCM_RIGHTS;
+  cmsg->cmsg_len = CMSG_LEN(count * sizeof(*fds));
+  memcpy(CMSG_DATA(cmsg), fds, count * sizeof(*fds));
+
+  ssize_t r;
+  do {
+    r = sendmsg(fd, &msg, 0);
+  } while (r == -1 && errno == EINTR);
+
+  return r == -1 ? -errno : r;
+}
+#endif
+
+
+// writeHandles(req, buffer, handles) writes the buffer with all the handles
+// attached to it.  With nothing else waiting to be written, that is a single
+// sendmsg() call; the other side's libuv queues the extra descriptors, see
+// AcceptPending().  Otherwise every handle goes with a write of its own, the
+// first ones with one byte of the buffer each so that they all come before
+// the end of the message.  Same return value and write_info() as
+// StreamBase::WriteBuffer().
+void PipeWrap::WriteHandles(const FunctionCallbackInfo<Value>& args) {
+#ifdef _WIN32
+  args.GetReturnValue().Set(UV_ENOSYS);
+#else
+  Environment* env = Environment::GetCurrent(args);
+  PipeWrap* wrap = Unwrap<PipeWrap>(args.Holder());
+  CHECK(args[0]->IsObject());
+  CHECK(Buffer::HasInstance(args[1]));
+  CHECK(args[2]->IsArray());
+
+  Local<Object> req_wrap_obj = args[0].As<Object>();
+  const char* data = Buffer::Data(args[1]);
+  size_t length = Buffer::Length(args[1]);
+  Local<Array> handles = args[2].As<Array>();
+  size_t count = handles->Length();
+
+  if (!wrap->IsAlive() || !wrap->is_named_pipe_ipc())
+    return args.GetReturnValue().Set(UV_EINVAL);
+  if (count == 0 || count > kMaxHandles || length < count)
+    return args.GetReturnValue().Set(UV_EINVAL);
+
+  int fds[kMaxHandles];
+  uv_stream_t* send_handles[kMaxHandles];
+  for (size_t i = 0; i < count; i++) {
+    Local<Value> value = handles->Get(i);
+    CHECK(value->IsObject());
+    HandleWrap* handle_wrap = Unwrap<HandleWrap>(value.As<Object>());
+    if (!HandleWrap::IsAlive(handle_wrap))
+      return args.GetReturnValue().Set(UV_EBADF);
+    uv_os_fd_t fd;
+    int err = uv_fileno(handle_wrap->GetHandle(), &fd);
+    if (err != 0)
+      return args.GetReturnValue().Set(err);
+    fds[i] = fd;
+    send_handles[i] = reinterpret_cast<uv_stream_t*>(handle_wrap->GetHandle());
+  }
+
+  uv_buf_t buf = uv_buf_init(const_cast<char*>(data), length);
+  bool sent = false;
+  bool async = false;
+  int err = 0;
+
+  // Writing directly is only in order when nothing is queued.
+  if (wrap->stream()->write_queue_size == 0) {
+    ssize_t r = SendWithDescriptors(wrap->GetFD(), data, length, fds, count);
+    if (r >= 0) {
+      sent = true;
+      buf.base += r;
+      buf.len -= r;
+    } else if (r != UV_EAGAIN) {
+      err = r;
+    }
+  }
+
+  if (err == 0 && buf.len > 0) {
+    async = true;
+    size_t pieces = sent ? 1 : count;
+    for (size_t i = 0; i < pieces && err == 0; i++) {
+      bool last = i + 1 == pieces;
+      uv_buf_t piece = uv_buf_init(buf.base, last ? buf.len : 1);
+      buf.base += piece.len;
+      buf.len -= piece.len;
+
+      Local<Object> obj = req_wrap_obj;
+      if (!last) {
+        obj = env->write_wrap_constructor_function()
+                  ->NewInstance(env->context()).ToLocalChecked();
+      }
+      WriteWrap* req_wrap =
+          WriteWrap::New(env, obj, wrap, StreamBase::AfterWrite);
+      uv_stream_t* send_handle = nullptr;
+      if (!sent) {
+        send_handle = send_handles[i];
+        // Keep the handle around until the write is done.
+        obj->Set(env->handle_string(), handles->Get(i));
+      }
+      err = wrap->DoWrite(req_wrap, &piece, 1, send_handle);
+      if (err)
+        req_wrap->Dispose();
+    }
+  }
+
+  const char* msg = wrap->Error();
+  if (msg != nullptr) {
+    req_wrap_obj->Set(env->error_string(), OneByteString(env->isolate(), msg));
+    wrap->ClearError();
+  }
+  env->write_info()->set(length, async);
+  if (err == 0)
+    wrap->OnBytesWritten(length);
+  args.GetReturnValue().Set(err);
+#endif
+}
+
+
+// acceptPending() returns the next handle that came in and that no read has
+// handed out yet, or undefined.  Every read hands out one of them, the
+// others of a message with several handles wait here.
+void PipeWrap::AcceptPending(const FunctionCallbackInfo<Value>& args) {
+  PipeWrap* wrap = Unwrap<PipeWrap>(args.Holder());
+  Local<Object> handle = wrap->AcceptPendingHandle();
+  if (!handle.IsEmpty())
+    args.GetReturnValue().Set(handle);
+}
+
+
 // TODO(bnoordhuis) maybe share with TCPWrap?
 void PipeWrap::OnConnection(uv_stream_t* handle, int status) {
   PipeWrap* pipe_wrap = static_cast<PipeWrap*>(handle->data);
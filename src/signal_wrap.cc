@@ -7,6 +7,9 @@
 #include "util-inl.h"
 #include "v8.h"
 
+#include <algorithm>
+#include <vector>
+
 namespace node {
 
 using v8::Context;
@@ -40,6 +43,12 @@ class SignalWrap : public HandleWrap {
                 constructor->GetFunction());
   }
 
+  ~SignalWrap() override {
+    std::vector<SignalWrap*>* pending = env()->pending_signals();
+    pending->erase(std::remove(pending->begin(), pending->end(), this),
+                   pending->end());
+  }
+
   size_t self_size() const override { return sizeof(*this); }
 
  private:
@@ -56,7 +65,9 @@ class SignalWrap : public HandleWrap {
       : HandleWrap(env,
                    object,
                    reinterpret_cast<uv_handle_t*>(&handle_),
-                   AsyncWrap::PROVIDER_SIGNALWRAP) {
+                   AsyncWrap::PROVIDER_SIGNALWRAP),
+        signum_(0),
+        pending_(0) {
     int r = uv_signal_init(env->event_loop(), &handle_);
     CHECK_EQ(r, 0);
   }
@@ -74,17 +85,42 @@ class SignalWrap : public HandleWrap {
     args.GetReturnValue().Set(err);
   }
 
+  // Signals that arrive in the same loop iteration are delivered together,
+  // from the check phase, as one call with their number.
   static void OnSignal(uv_signal_t* handle, int signum) {
     SignalWrap* wrap = ContainerOf(&SignalWrap::handle_, handle);
     Environment* env = wrap->env();
+    wrap->signum_ = signum;
+    if (wrap->pending_++ == 0) {
+      env->pending_signals()->push_back(wrap);
+      uv_check_start(env->signal_batch_check_handle(), OnSignalBatchCheck);
+    }
+  }
+
+  static void OnSignalBatchCheck(uv_check_t* handle) {
+    Environment* env = Environment::from_signal_batch_check_handle(handle);
+    uv_check_stop(handle);
+
     HandleScope handle_scope(env->isolate());
     Context::Scope context_scope(env->context());
 
-    Local<Value> arg = Integer::New(env->isolate(), signum);
-    wrap->MakeCallback(env->onsignal_string(), 1, &arg);
+    std::vector<SignalWrap*> wraps;
+    wraps.swap(*env->pending_signals());
+    for (SignalWrap* wrap : wraps) {
+      if (!IsAlive(wrap))
+        continue;
+      Local<Value> argv[] = {
+        Integer::New(env->isolate(), wrap->signum_),
+        Integer::NewFromUnsigned(env->isolate(), wrap->pending_)
+      };
+      wrap->pending_ = 0;
+      wrap->MakeCallback(env->onsignal_string(), arraysize(argv), argv);
+    }
   }
 
   uv_signal_t handle_;
+  int signum_;
+  uint32_t pending_;
 };
 
 
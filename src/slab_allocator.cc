@@ -0,0 +1,168 @@
+#include "slab_allocator.h"
+#include "node_buffer.h"
+#include "node_internals.h"
+
+#include "env.h"
+#include "env-inl.h"
+#include "util.h"
+#include "util-inl.h"
+#include "v8.h"
+
+#include <stdlib.h>  // malloc(), realloc(), free()
+#include <string.h>  // memcpy()
+
+namespace node {
+
+using v8::Isolate;
+using v8::Local;
+using v8::Object;
+
+struct SlabAllocator::Slab {
+  Isolate* isolate;
+  char* data;
+  size_t offset;
+  // One reference per Buffer plus one for the allocator while the slab is
+  // the current one.
+  size_t refs;
+};
+
+
+SlabAllocator::SlabAllocator(Isolate* isolate)
+    : isolate_(isolate),
+      slab_(nullptr),
+      reserved_(false) {
+}
+
+
+SlabAllocator::~SlabAllocator() {
+  if (slab_ != nullptr)
+    Unref(slab_);
+}
+
+
+uv_buf_t SlabAllocator::Allocate(size_t suggested_size) {
+  if (reserved_) {
+    char* base = static_cast<char*>(malloc(suggested_size));
+    if (base == nullptr && suggested_size > 0) {
+      FatalError("node::SlabAllocator::Allocate(size_t)", "Out Of Memory");
+    }
+    return uv_buf_init(base, suggested_size);
+  }
+
+  if (Available() < kMinReservation)
+    NewSlab();
+
+  size_t size = suggested_size;
+  if (size > Available())
+    size = Available();
+
+  reserved_ = true;
+  return uv_buf_init(slab_->data + slab_->offset, size);
+}
+
+
+Local<Object> SlabAllocator::Commit(Environment* env,
+                                    const uv_buf_t* buf,
+                                    size_t size) {
+  CHECK_GT(size, 0);
+  CHECK_LE(size, buf->len);
+
+  if (!IsReservation(buf)) {
+    char* base = static_cast<char*>(realloc(buf->base, size));
+    return Buffer::New(env, base, size).ToLocalChecked();
+  }
+
+  reserved_ = false;
+  return Carve(env, buf->base, size);
+}
+
+
+void SlabAllocator::Release(const uv_buf_t* buf) {
+  if (IsReservation(buf))
+    reserved_ = false;
+  else
+    free(buf->base);
+}
+
+
+Local<Object> SlabAllocator::Copy(Environment* env,
+                                  const char* data,
+                                  size_t size) {
+  // Don't pin a slab for large copies and don't touch the tail of the slab
+  // while it is handed out to a read.
+  if (size == 0 || size > kMinReservation || reserved_)
+    return Buffer::Copy(env, data, size).ToLocalChecked();
+
+  if (Available() < size)
+    NewSlab();
+
+  char* base = slab_->data + slab_->offset;
+  memcpy(base, data, size);
+  return Carve(env, base, size);
+}
+
+
+void SlabAllocator::Trim() {
+  // A read is about to fill the reservation.
+  if (slab_ == nullptr || reserved_)
+    return;
+  Unref(slab_);
+  slab_ = nullptr;
+}
+
+
+bool SlabAllocator::IsReservation(const uv_buf_t* buf) const {
+  return reserved_ && buf->base == slab_->data + slab_->offset;
+}
+
+
+size_t SlabAllocator::Available() const {
+  if (slab_ == nullptr)
+    return 0;
+  return kSlabSize - slab_->offset;
+}
+
+
+void SlabAllocator::NewSlab() {
+  char* data = static_cast<char*>(malloc(kSlabSize));
+  if (data == nullptr)
+    FatalError("node::SlabAllocator::NewSlab()", "Out Of Memory");
+
+  if (slab_ != nullptr)
+    Unref(slab_);
+
+  slab_ = new Slab;
+  slab_->isolate = isolate_;
+  slab_->data = data;
+  slab_->offset = 0;
+  slab_->refs = 1;
+  // The Buffers only report their own size to the garbage collector, tell it
+  // about the slab as a whole so that it doesn't underestimate the pressure.
+  isolate_->AdjustAmountOfExternalAllocatedMemory(kSlabSize);
+}
+
+
+Local<Object> SlabAllocator::Carve(Environment* env, char* data, size_t size) {
+  // Keep the next chunk 8 byte aligned for typed arrays that alias it.
+  slab_->offset += (size + 7) & ~static_cast<size_t>(7);
+  slab_->refs += 1;
+  return Buffer::Adopt(env, data, size, OnFree, slab_).ToLocalChecked();
+}
+
+
+void SlabAllocator::Unref(Slab* slab) {
+  CHECK_GT(slab->refs, 0);
+  if (--slab->refs > 0)
+    return;
+  slab->isolate->AdjustAmountOfExternalAllocatedMemory(
+      -static_cast<int64_t>(kSlabSize));
+  free(slab->data);
+  delete slab;
+}
+
+
+void SlabAllocator::OnFree(char* data, void* hint) {
+  Unref(static_cast<Slab*>(hint));
+}
+
+}  // namespace node
@@ -0,0 +1,59 @@
+#ifndef SRC_SLAB_ALLOCATOR_H_
+#define SRC_SLAB_ALLOCATOR_H_
+
+#include "uv.h"
+#include "v8.h"
+
+namespace node {
+
+class Environment;
+
+// Carves read buffers out of large shared slabs instead of malloc()ing a
+// fresh 64 KB chunk per read.  Allocate() reserves the unused tail of the
+// current slab, Commit() then turns the bytes that were actually read into a
+// Buffer and gives the rest of the reservation back.  A slab is freed once
+// the allocator has moved on to a new one and all Buffers that point into it
+// have been garbage collected.
+//
+// Only one reservation can be outstanding at a time.  Allocate() falls back
+// to malloc() when it is called again before Commit() or Release().
+class SlabAllocator {
+ public:
+  static const size_t kSlabSize = 1024 * 1024;
+  static const size_t kMinReservation = 16 * 1024;
+
+  explicit SlabAllocator(v8::Isolate* isolate);
+  ~SlabAllocator();
+
+  uv_buf_t Allocate(size_t suggested_size);
+  // Takes ownership of |buf|, which must have come from Allocate().
+  v8::Local<v8::Object> Commit(Environment* env,
+                               const uv_buf_t* buf,
+                               size_t size);
+  // Returns an unused reservation.
+  void Release(const uv_buf_t* buf);
+  // Like Buffer::Copy() but small copies are stored in the current slab.
+  v8::Local<v8::Object> Copy(Environment* env, const char* data, size_t size);
+  // Lets go of the current slab, it is freed with the last Buffer that points
+  // into it.  The next allocation starts a new one.
+  void Trim();
+
+ private:
+  struct Slab;
+
+  bool IsReservation(const uv_buf_t* buf) const;
+  size_t Available() const;
+  void NewSlab();
+  v8::Local<v8::Object> Carve(Environment* env, char* data, size_t size);
+
+  static void Unref(Slab* slab);
+  static void OnFree(char* data, void* hint);
+
+  v8::Isolate* const isolate_;
+  Slab* slab_;
+  bool reserved_;
+};
+
+}  // namespace node
+
+#endif  // SRC_SLAB_ALLOCATOR_H_
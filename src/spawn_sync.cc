@@ -3,6 +3,7 @@
 #include "string_bytes.h"
 #include "util.h"
 
+#include <limits.h>
 #include <string.h>
 #include <stdlib.h>
 
@@ -24,54 +25,6 @@ using v8::String;
 using v8::Value;
 
 
-SyncProcessOutputBuffer::SyncProcessOutputBuffer()
-    : used_(0),
-      next_(nullptr) {
-}
-
-
-void SyncProcessOutputBuffer::OnAlloc(size_t suggested_size,
-                                      uv_buf_t* buf) const {
-  if (used() == kBufferSize)
-    *buf = uv_buf_init(nullptr, 0);
-  else
-    *buf = uv_buf_init(data_ + used(), available());
-}
-
-
-void SyncProcessOutputBuffer::OnRead(const uv_buf_t* buf, size_t nread) {
-  // If we hand out the same chunk twice, this should catch it.
-  CHECK_EQ(buf->base, data_ + used());
-  used_ += static_cast<unsigned int>(nread);
-}
-
-
-size_t SyncProcessOutputBuffer::Copy(char* dest) const {
-  memcpy(dest, data_, used());
-  return used();
-}
-
-
-unsigned int SyncProcessOutputBuffer::available() const {
-  return sizeof data_ - used();
-}
-
-
-unsigned int SyncProcessOutputBuffer::used() const {
-  return used_;
-}
-
-
-SyncProcessOutputBuffer* SyncProcessOutputBuffer::next() const {
-  return next_;
-}
-
-
-void SyncProcessOutputBuffer::set_next(SyncProcessOutputBuffer* next) {
-  next_ = next;
-}
-
-
 SyncProcessStdioPipe::SyncProcessStdioPipe(SyncProcessRunner* process_handler,
                                            bool readable,
                                            bool writable,
@@ -81,8 +34,9 @@ SyncProcessStdioPipe::SyncProcessStdioPipe(SyncProcessRunner* process_handler,
       writable_(writable),
       input_buffer_(input_buffer),
 
-      first_output_buffer_(nullptr),
-      last_output_buffer_(nullptr),
+      output_(nullptr),
+      output_length_(0),
+      output_capacity_(0),
 
       uv_pipe_(),
       write_req_(),
@@ -95,14 +49,7 @@ SyncProcessStdioPipe::SyncProcessStdioPipe(SyncProcessRunner* process_handler,
 
 SyncProcessStdioPipe::~SyncProcessStdioPipe() {
   CHECK(lifecycle_ == kUninitialized || lifecycle_ == kClosed);
-
-  SyncProcessOutputBuffer* buf;
-  SyncProcessOutputBuffer* next;
-
-  for (buf = first_output_buffer_; buf != nullptr; buf = next) {
-    next = buf->next();
-    delete buf;
-  }
+  free(output_);
 }
 
 
@@ -164,11 +111,19 @@ void SyncProcessStdioPipe::Close() {
 }
 
 
-Local<Object> SyncProcessStdioPipe::GetOutputAsBuffer(Environment* env) const {
-  size_t length = OutputLength();
-  Local<Object> js_buffer = Buffer::New(env, length).ToLocalChecked();
-  CopyOutput(Buffer::Data(js_buffer));
-  return js_buffer;
+Local<Object> SyncProcessStdioPipe::GetOutputAsBuffer(Environment* env) {
+  if (output_length_ == 0)
+    return Buffer::New(env, 0).ToLocalChecked();
+
+  // The Buffer takes the memory over instead of a copy of it.  Shrinking a
+  // block doesn't move it with any allocator worth its salt.
+  char* data = static_cast<char*>(realloc(output_, output_length_));
+  if (data == nullptr)
+    data = output_;
+  const size_t length = output_length_;
+  output_ = nullptr;
+  output_length_ = output_capacity_ = 0;
+  return Buffer::New(env, data, length).ToLocalChecked();
 }
 
 
@@ -211,45 +166,33 @@ uv_handle_t* SyncProcessStdioPipe::uv_handle() const {
 }
 
 
-size_t SyncProcessStdioPipe::OutputLength() const {
-  SyncProcessOutputBuffer* buf;
-  size_t size = 0;
-
-  for (buf = first_output_buffer_; buf != nullptr; buf = buf->next())
-    size += buf->used();
-
-  return size;
-}
-
-
-void SyncProcessStdioPipe::CopyOutput(char* dest) const {
-  SyncProcessOutputBuffer* buf;
-  size_t offset = 0;
-
-  for (buf = first_output_buffer_; buf != nullptr; buf = buf->next())
-    offset += buf->Copy(dest + offset);
-}
-
-
 void SyncProcessStdioPipe::OnAlloc(size_t suggested_size, uv_buf_t* buf) {
   // This function assumes that libuv will never allocate two buffers for the
   // same stream at the same time. There's an assert in
-  // SyncProcessOutputBuffer::OnRead that would fail if this assumption was
-  // ever violated.
-
-  if (last_output_buffer_ == nullptr) {
-    // Allocate the first capture buffer.
-    first_output_buffer_ = new SyncProcessOutputBuffer();
-    last_output_buffer_ = first_output_buffer_;
-
-  } else if (last_output_buffer_->available() == 0) {
-    // The current capture buffer is full so get us a new one.
-    SyncProcessOutputBuffer* buf = new SyncProcessOutputBuffer();
-    last_output_buffer_->set_next(buf);
-    last_output_buffer_ = buf;
+  // SyncProcessStdioPipe::OnRead that would fail if this assumption was ever
+  // violated.
+
+  if (output_length_ == output_capacity_) {
+    // Grow geometrically so that large outputs are moved a few times at
+    // most, realloc() of big blocks usually remaps pages instead of copying.
+    size_t capacity = output_capacity_ == 0 ? kInitialOutputSize
+                                            : output_capacity_ * 2;
+    char* output = static_cast<char*>(realloc(output_, capacity));
+    if (output == nullptr) {
+      // libuv reports UV_ENOBUFS to OnRead.
+      *buf = uv_buf_init(nullptr, 0);
+      return;
+    }
+    output_ = output;
+    output_capacity_ = capacity;
   }
 
-  last_output_buffer_->OnAlloc(suggested_size, buf);
+  // Use unsigned int because that's what `uv_buf_init` takes.
+  size_t available = output_capacity_ - output_length_;
+  if (available > UINT_MAX)
+    available = UINT_MAX;
+  *buf = uv_buf_init(output_ + output_length_,
+                     static_cast<unsigned int>(available));
 }
 
 
@@ -263,7 +206,9 @@ void SyncProcessStdioPipe::OnRead(const uv_buf_t* buf, ssize_t nread) {
     uv_read_stop(uv_stream());
 
   } else {
-    last_output_buffer_->OnRead(buf, nread);
+    // If we hand out the same chunk twice, this should catch it.
+    CHECK_EQ(buf->base, output_ + output_length_);
+    output_length_ += nread;
     process_handler_->IncrementBufferSizeAndCheckOverflow(nread);
   }
 }
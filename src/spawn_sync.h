@@ -20,38 +20,14 @@ using v8::String;
 using v8::Value;
 
 
-class SyncProcessOutputBuffer;
 class SyncProcessStdioPipe;
 class SyncProcessRunner;
 
 
-class SyncProcessOutputBuffer {
-  static const unsigned int kBufferSize = 65536;
-
- public:
-  inline SyncProcessOutputBuffer();
-
-  inline void OnAlloc(size_t suggested_size, uv_buf_t* buf) const;
-  inline void OnRead(const uv_buf_t* buf, size_t nread);
-
-  inline size_t Copy(char* dest) const;
-
-  inline unsigned int available() const;
-  inline unsigned int used() const;
-
-  inline SyncProcessOutputBuffer* next() const;
-  inline void set_next(SyncProcessOutputBuffer* next);
-
- private:
-  // Use unsigned int because that's what `uv_buf_init` takes.
-  mutable char data_[kBufferSize];
-  unsigned int used_;
-
-  SyncProcessOutputBuffer* next_;
-};
-
-
 class SyncProcessStdioPipe {
+  // The output buffer starts at this size and doubles whenever it's full.
+  static const size_t kInitialOutputSize = 65536;
+
   enum Lifecycle {
     kUninitialized = 0,
     kInitialized,
@@ -71,7 +47,7 @@ class SyncProcessStdioPipe {
   int Start();
   void Close();
 
-  Local<Object> GetOutputAsBuffer(Environment* env) const;
+  Local<Object> GetOutputAsBuffer(Environment* env);
 
   inline bool readable() const;
   inline bool writable() const;
@@ -82,9 +58,6 @@ class SyncProcessStdioPipe {
   inline uv_handle_t* uv_handle() const;
 
  private:
-  inline size_t OutputLength() const;
-  inline void CopyOutput(char* dest) const;
-
   inline void OnAlloc(size_t suggested_size, uv_buf_t* buf);
   inline void OnRead(const uv_buf_t* buf, ssize_t nread);
   inline void OnWriteDone(int result);
@@ -109,8 +82,11 @@ class SyncProcessStdioPipe {
   bool writable_;
   uv_buf_t input_buffer_;
 
-  SyncProcessOutputBuffer* first_output_buffer_;
-  SyncProcessOutputBuffer* last_output_buffer_;
+  // What the child wrote, in a single malloc'ed block that is handed over
+  // to the resulting Buffer.
+  char* output_;
+  size_t output_length_;
+  size_t output_capacity_;
 
   mutable uv_pipe_t uv_pipe_;
   uv_write_t write_req_;
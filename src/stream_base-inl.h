@@ -52,6 +52,9 @@ void StreamBase::AddMethods(Environment* env,
 
   env->SetProtoMethod(t, "readStart", JSMethod<Base, &StreamBase::ReadStart>);
   env->SetProtoMethod(t, "readStop", JSMethod<Base, &StreamBase::ReadStop>);
+  env->SetProtoMethod(t,
+                      "setIdleTimeout",
+                      JSMethod<Base, &StreamBase::SetIdleTimeout>);
   if ((flags & kFlagNoShutdown) == 0)
     env->SetProtoMethod(t, "shutdown", JSMethod<Base, &StreamBase::Shutdown>);
   if ((flags & kFlagHasWritev) != 0)
@@ -59,6 +62,9 @@ void StreamBase::AddMethods(Environment* env,
   env->SetProtoMethod(t,
                       "writeBuffer",
                       JSMethod<Base, &StreamBase::WriteBuffer>);
+  env->SetProtoMethod(t,
+                      "writeChunked",
+                      JSMethod<Base, &StreamBase::WriteChunked>);
   env->SetProtoMethod(t,
                       "writeAsciiString",
                       JSMethod<Base, &StreamBase::WriteString<ASCII> >);
@@ -124,15 +130,18 @@ WriteWrap* WriteWrap::New(Environment* env,
                           DoneCb cb,
                           size_t extra) {
   size_t storage_size = ROUND_UP(sizeof(WriteWrap), kAlignSize) + extra;
-  char* storage = new char[storage_size];
+  char* storage = env->req_storage_pool()->Allocate(storage_size);
 
   return new(storage) WriteWrap(env, obj, wrap, cb, storage_size);
 }
 
 
 void WriteWrap::Dispose() {
+  Environment* env = this->env();
+  size_t storage_size = storage_size_;
   this->~WriteWrap();
-  delete[] reinterpret_cast<char*>(this);
+  env->req_storage_pool()->Release(reinterpret_cast<char*>(this),
+                                   storage_size);
 }
 
 
@@ -13,17 +13,19 @@
 #include "v8.h"
 
 #include <limits.h>  // INT_MAX
+#include <string.h>  // memcpy()
 
 namespace node {
 
 using v8::Array;
 using v8::Context;
+using v8::External;
 using v8::FunctionCallbackInfo;
 using v8::HandleScope;
 using v8::Integer;
 using v8::Local;
-using v8::Number;
 using v8::Object;
+using v8::Persistent;
 using v8::String;
 using v8::Value;
 
@@ -47,6 +49,17 @@ int StreamBase::ReadStop(const FunctionCallbackInfo<Value>& args) {
 }
 
 
+// setIdleTimeout(msecs), 0 stops the timeout.  The handle's onidletimeout()
+// is called when nothing has been read or written for |msecs|.
+int StreamBase::SetIdleTimeout(const FunctionCallbackInfo<Value>& args) {
+  int64_t timeout = args[0]->IntegerValue();
+  if (timeout < 0)
+    return UV_EINVAL;
+  idle_timeout_.Start(env_->timer_wheel(), timeout);
+  return 0;
+}
+
+
 int StreamBase::Shutdown(const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args);
 
@@ -93,6 +106,7 @@ void StreamBase::AfterShutdown(ShutdownWrap* req_wrap, int status) {
 
 int StreamBase::Writev(const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args);
+  idle_timeout_.Touch();
 
   CHECK(args[0]->IsObject());
   CHECK(args[1]->IsArray());
@@ -180,9 +194,7 @@ int StreamBase::Writev(const FunctionCallbackInfo<Value>& args) {
   if (bufs != bufs_)
     delete[] bufs;
 
-  req_wrap->object()->Set(env->async(), True(env->isolate()));
-  req_wrap->object()->Set(env->bytes_string(),
-                          Number::New(env->isolate(), bytes));
+  env->write_info()->set(bytes, true);
   const char* msg = Error();
   if (msg != nullptr) {
     req_wrap_obj->Set(env->error_string(), OneByteString(env->isolate(), msg));
@@ -191,6 +203,8 @@ int StreamBase::Writev(const FunctionCallbackInfo<Value>& args) {
 
   if (err)
     req_wrap->Dispose();
+  else
+    OnBytesWritten(bytes);
 
   return err;
 }
@@ -202,31 +216,109 @@ int StreamBase::WriteBuffer(const FunctionCallbackInfo<Value>& args) {
   CHECK(args[0]->IsObject());
   CHECK(Buffer::HasInstance(args[1]));
   Environment* env = Environment::GetCurrent(args);
+  idle_timeout_.Touch();
 
   Local<Object> req_wrap_obj = args[0].As<Object>();
   const char* data = Buffer::Data(args[1]);
   size_t length = Buffer::Length(args[1]);
+  Local<Object> send_handle_obj;
+  if (args[2]->IsObject())
+    send_handle_obj = args[2].As<Object>();
 
   WriteWrap* req_wrap;
+  uv_handle_t* send_handle = nullptr;
   uv_buf_t buf;
   buf.base = const_cast<char*>(data);
   buf.len = length;
 
-  // Try writing immediately without allocation
+  // Try writing immediately without allocation, unless a handle has to be
+  // sent along with the data.
   uv_buf_t* bufs = &buf;
   size_t count = 1;
-  int err = DoTryWrite(&bufs, &count);
-  if (err != 0)
-    goto done;
-  if (count == 0)
-    goto done;
-  CHECK_EQ(count, 1);
+  bool async = false;
+  int err;
+  if (!IsIPCPipe() || send_handle_obj.IsEmpty()) {
+    err = DoTryWrite(&bufs, &count);
+    if (err != 0)
+      goto done;
+    if (count == 0)
+      goto done;
+    CHECK_EQ(count, 1);
+  }
 
   // Allocate, or write rest
   req_wrap = WriteWrap::New(env, req_wrap_obj, this, AfterWrite);
 
+  if (IsIPCPipe() && !send_handle_obj.IsEmpty()) {
+    HandleWrap* wrap = Unwrap<HandleWrap>(send_handle_obj);
+    send_handle = wrap->GetHandle();
+    // Reference StreamWrap instance to prevent it from being garbage
+    // collected before `AfterWrite` is called.
+    req_wrap->object()->Set(env->handle_string(), send_handle_obj);
+  }
+
+  err = DoWrite(req_wrap,
+                bufs,
+                count,
+                reinterpret_cast<uv_stream_t*>(send_handle));
+  async = true;
+
+  if (err)
+    req_wrap->Dispose();
+
+ done:
+  const char* msg = Error();
+  if (msg != nullptr) {
+    req_wrap_obj->Set(env->error_string(), OneByteString(env->isolate(), msg));
+    ClearError();
+  }
+  env->write_info()->set(length, async);
+  if (err == 0)
+    OnBytesWritten(length);
+  return err;
+}
+
+
+// Writes the Buffer as one chunk of the chunked transfer coding: its size in
+// hex and a CRLF, the data and another CRLF, together in a single write.
+int StreamBase::WriteChunked(const FunctionCallbackInfo<Value>& args) {
+  CHECK(args[0]->IsObject());
+  CHECK(Buffer::HasInstance(args[1]));
+  Environment* env = Environment::GetCurrent(args);
+  idle_timeout_.Touch();
+
+  static char crlf[] = { '\r', '\n' };
+  static const size_t kSizeLineMax = 2 * sizeof(size_t) + sizeof(crlf);
+
+  Local<Object> req_wrap_obj = args[0].As<Object>();
+  const size_t length = Buffer::Length(args[1]);
+  char size_line[kSizeLineMax + 1];
+  const int size_line_length = snprintf(size_line, sizeof(size_line), "%zx\r\n",
+                                        length);
+
+  uv_buf_t parts[3];
+  parts[0] = uv_buf_init(size_line, size_line_length);
+  parts[1] = uv_buf_init(Buffer::Data(args[1]), length);
+  parts[2] = uv_buf_init(crlf, sizeof(crlf));
+  const size_t bytes = size_line_length + length + sizeof(crlf);
+
+  uv_buf_t* bufs = parts;
+  size_t count = arraysize(parts);
+  bool async = false;
+  WriteWrap* req_wrap;
+  int err = DoTryWrite(&bufs, &count);
+  if (err != 0 || count == 0)
+    goto done;
+
+  req_wrap = WriteWrap::New(env, req_wrap_obj, this, AfterWrite, kSizeLineMax);
+  // What is left of the size line has to outlive this function.  The data is
+  // kept alive by the request object, and the CRLF is static.
+  if (bufs == parts) {
+    bufs[0].base = static_cast<char*>(
+        memcpy(req_wrap->Extra(), bufs[0].base, bufs[0].len));
+  }
   err = DoWrite(req_wrap, bufs, count, nullptr);
-  req_wrap_obj->Set(env->async(), True(env->isolate()));
+  async = true;
 
   if (err)
     req_wrap->Dispose();
@@ -237,8 +329,9 @@ int StreamBase::WriteBuffer(const FunctionCallbackInfo<Value>& args) {
     req_wrap_obj->Set(env->error_string(), OneByteString(env->isolate(), msg));
     ClearError();
   }
-  req_wrap_obj->Set(env->bytes_string(),
-                    Integer::NewFromUnsigned(env->isolate(), length));
+  env->write_info()->set(bytes, async);
+  if (err == 0)
+    OnBytesWritten(bytes);
   return err;
 }
 
@@ -246,6 +339,7 @@ int StreamBase::WriteBuffer(const FunctionCallbackInfo<Value>& args) {
 template <enum encoding enc>
 int StreamBase::WriteString(const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args);
+  idle_timeout_.Touch();
   CHECK(args[0]->IsObject());
   CHECK(args[1]->IsString());
 
@@ -255,6 +349,7 @@ int StreamBase::WriteString(const FunctionCallbackInfo<Value>& args) {
   if (args[2]->IsObject())
     send_handle_obj = args[2].As<Object>();
 
+  bool async = false;
   int err;
 
   // Compute the size of the storage that the string will be flattened into.
@@ -344,7 +439,7 @@ int StreamBase::WriteString(const FunctionCallbackInfo<Value>& args) {
         reinterpret_cast<uv_stream_t*>(send_handle));
   }
 
-  req_wrap->object()->Set(env->async(), True(env->isolate()));
+  async = true;
 
   if (err)
     req_wrap->Dispose();
@@ -355,8 +450,9 @@ int StreamBase::WriteString(const FunctionCallbackInfo<Value>& args) {
     req_wrap_obj->Set(env->error_string(), OneByteString(env->isolate(), msg));
     ClearError();
   }
-  req_wrap_obj->Set(env->bytes_string(),
-                    Integer::NewFromUnsigned(env->isolate(), data_size));
+  env->write_info()->set(data_size, async);
+  if (err == 0)
+    OnBytesWritten(data_size);
   return err;
 }
 
@@ -365,6 +461,8 @@ void StreamBase::AfterWrite(WriteWrap* req_wrap, int status) {
   StreamBase* wrap = req_wrap->wrap();
   Environment* env = req_wrap->env();
 
+  wrap->idle_timeout_.Touch();
+
   HandleScope handle_scope(env->isolate());
   Context::Scope context_scope(env->context());
 
@@ -398,6 +496,113 @@ void StreamBase::AfterWrite(WriteWrap* req_wrap, int status) {
 }
 
 
+// The Buffer of a broadcast, kept alive until the last stream has written
+// it.
+struct StreamBase::SharedBuffer {
+  SharedBuffer(Environment* env, Local<Object> buffer)
+      : buffer(env->isolate(), buffer), refs(1) {
+  }
+
+  void Unref() {
+    if (--refs == 0) {
+      buffer.Reset();
+      delete this;
+    }
+  }
+
+  Persistent<Object> buffer;
+  size_t refs;
+};
+
+
+// Writes one Buffer to many streams.  What the streams can't take right
+// away is queued with a WriteWrap of their own that points into the shared
+// Buffer, nothing is copied.  Returns undefined, or [index, error, ...] for
+// the streams that failed.
+void StreamBase::Broadcast(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  CHECK(args[0]->IsArray());
+  CHECK(Buffer::HasInstance(args[1]));
+
+  Local<Array> streams = args[0].As<Array>();
+  const char* data = Buffer::Data(args[1]);
+  const size_t length = Buffer::Length(args[1]);
+  SharedBuffer* shared = new SharedBuffer(env, args[1].As<Object>());
+  Local<Array> errors;
+
+  const uint32_t count = streams->Length();
+  for (uint32_t i = 0; i < count; i++) {
+    Local<Value> external = streams->Get(i);
+    CHECK(external->IsExternal());
+    StreamBase* stream =
+        static_cast<StreamBase*>(external.As<External>()->Value());
+    int err = UV_EBADF;
+    if (stream->IsAlive() && !stream->IsClosing())
+      err = stream->WriteShared(shared, data, length);
+    if (err == 0)
+      continue;
+    if (errors.IsEmpty())
+      errors = Array::New(env->isolate());
+    errors->Set(errors->Length(), Integer::NewFromUnsigned(env->isolate(), i));
+    errors->Set(errors->Length(), Integer::New(env->isolate(), err));
+  }
+
+  shared->Unref();
+  if (!errors.IsEmpty())
+    args.GetReturnValue().Set(errors);
+}
+
+
+int StreamBase::WriteShared(SharedBuffer* shared,
+                            const char* data,
+                            size_t length) {
+  Environment* env = env_;
+  idle_timeout_.Touch();
+
+  uv_buf_t buf = uv_buf_init(const_cast<char*>(data), length);
+  uv_buf_t* bufs = &buf;
+  size_t count = 1;
+  int err = DoTryWrite(&bufs, &count);
+
+  if (err == 0 && count > 0) {
+    Local<Object> req_wrap_obj =
+        env->write_wrap_constructor_function()
+            ->NewInstance(env->context()).ToLocalChecked();
+    WriteWrap* req_wrap = WriteWrap::New(env,
+                                         req_wrap_obj,
+                                         this,
+                                         AfterSharedWrite,
+                                         sizeof(shared));
+    memcpy(req_wrap->Extra(), &shared, sizeof(shared));
+    err = DoWrite(req_wrap, bufs, count, nullptr);
+    if (err)
+      req_wrap->Dispose();
+    else
+      shared->refs++;
+  }
+
+  if (Error() != nullptr)
+    ClearError();
+  if (err == 0)
+    OnBytesWritten(length);
+  return err;
+}
+
+
+// Failed writes are not reported, the socket sees the error when it reads
+// or writes next.
+void StreamBase::AfterSharedWrite(WriteWrap* req_wrap, int status) {
+  StreamBase* wrap = req_wrap->wrap();
+  SharedBuffer* shared;
+  memcpy(&shared, req_wrap->Extra(), sizeof(shared));
+
+  wrap->idle_timeout_.Touch();
+  wrap->OnAfterWrite(req_wrap);
+  req_wrap->Dispose();
+  shared->Unref();
+}
+
+
 void StreamBase::EmitData(ssize_t nread,
                           Local<Object> buf,
                           Local<Object> handle) {
@@ -428,6 +633,23 @@ void StreamBase::EmitData(ssize_t nread,
 }
 
 
+void StreamBase::OnIdleTimeout() {
+  Environment* env = env_;
+  HandleScope handle_scope(env->isolate());
+  Context::Scope context_scope(env->context());
+
+  AsyncWrap* async = GetAsyncWrap();
+  if (async == nullptr)
+    node::MakeCallback(env,
+                       GetObject(),
+                       env->onidletimeout_string(),
+                       0,
+                       nullptr);
+  else
+    async->MakeCallback(env->onidletimeout_string(), 0, nullptr);
+}
+
+
 bool StreamBase::IsIPCPipe() {
   return false;
 }
@@ -454,6 +676,16 @@ int StreamResource::DoTryWrite(uv_buf_t** bufs, size_t* count) {
 }
 
 
+void StreamResource::IdleTimeoutCb(IdleTimeout* timeout, void* ctx) {
+  static_cast<StreamResource*>(ctx)->OnIdleTimeout();
+}
+
+
+void StreamResource::OnIdleTimeout() {
+  // No-op
+}
+
+
 const char* StreamResource::Error() const {
   return nullptr;
 }
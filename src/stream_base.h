@@ -6,6 +6,8 @@
 #include "req-wrap.h"
 #include "req-wrap-inl.h"
 #include "node.h"
+#include "node_dtrace.h"
+#include "timer_wrap.h"
 
 #include "v8.h"
 
@@ -136,7 +138,11 @@ class StreamResource {
                          uv_handle_type pending,
                          void* ctx);
 
-  StreamResource() : bytes_read_(0) {
+  StreamResource() : bytes_read_(0),
+                     bytes_written_(0),
+                     read_count_(0),
+                     write_queue_high_water_(0),
+                     idle_timeout_(IdleTimeoutCb, this) {
   }
   virtual ~StreamResource() = default;
 
@@ -165,6 +171,8 @@ class StreamResource {
                      uv_handle_type pending = UV_UNKNOWN_HANDLE) {
     if (nread > 0)
       bytes_read_ += static_cast<uint64_t>(nread);
+    read_count_++;
+    idle_timeout_.Touch();
     if (!read_cb_.is_empty())
       read_cb_.fn(nread, buf, pending, read_cb_.ctx);
   }
@@ -180,11 +188,43 @@ class StreamResource {
   inline Callback<AllocCb> alloc_cb() { return alloc_cb_; }
   inline Callback<ReadCb> read_cb() { return read_cb_; }
 
+  // Called by the write paths with the number of bytes that were accepted.
+  inline void OnBytesWritten(size_t bytes) {
+    bytes_written_ += bytes;
+    if (NODE_STREAM_WRITE_ENABLED())
+      NODE_STREAM_WRITE(this, static_cast<int64_t>(bytes));
+  }
+
+  // Called with the size of the write queue by streams that have one.
+  inline void OnWriteQueueSize(size_t size) {
+    if (size > write_queue_high_water_)
+      write_queue_high_water_ = size;
+  }
+
+  // Statistics for process._getActiveHandleStats().  Bytes are counted as
+  // written once the stream has accepted them.
+  inline uint64_t bytes_read() const { return bytes_read_; }
+  inline uint64_t bytes_written() const { return bytes_written_; }
+  inline uint64_t read_count() const { return read_count_; }
+  inline size_t write_queue_high_water() const {
+    return write_queue_high_water_;
+  }
+
+ protected:
+  // Called when the stream has been idle for longer than its idle timeout.
+  virtual void OnIdleTimeout();
+
  private:
+  static void IdleTimeoutCb(IdleTimeout* timeout, void* ctx);
+
   Callback<AfterWriteCb> after_write_cb_;
   Callback<AllocCb> alloc_cb_;
   Callback<ReadCb> read_cb_;
   uint64_t bytes_read_;
+  uint64_t bytes_written_;
+  uint64_t read_count_;
+  size_t write_queue_high_water_;
+  IdleTimeout idle_timeout_;
 
   friend class StreamBase;
 };
@@ -216,6 +256,10 @@ class StreamBase : public StreamResource {
     consumed_ = true;
   }
 
+  inline bool IsConsumed() const {
+    return consumed_;
+  }
+
   template <class Outer>
   inline Outer* Cast() { return static_cast<Outer*>(Cast()); }
 
@@ -223,6 +267,9 @@ class StreamBase : public StreamResource {
                 v8::Local<v8::Object> buf,
                 v8::Local<v8::Object> handle);
 
+  // broadcast([stream._externalStream, ...], buffer), for net.broadcast().
+  static void Broadcast(const v8::FunctionCallbackInfo<v8::Value>& args);
+
  protected:
   explicit StreamBase(Environment* env) : env_(env), consumed_(false) {
   }
@@ -233,16 +280,21 @@ class StreamBase : public StreamResource {
   virtual AsyncWrap* GetAsyncWrap();
   virtual v8::Local<v8::Object> GetObject();
 
+  void OnIdleTimeout() override;
+
   // Libuv callbacks
   static void AfterShutdown(ShutdownWrap* req, int status);
   static void AfterWrite(WriteWrap* req, int status);
+  static void AfterSharedWrite(WriteWrap* req, int status);
 
   // JS Methods
   int ReadStart(const v8::FunctionCallbackInfo<v8::Value>& args);
   int ReadStop(const v8::FunctionCallbackInfo<v8::Value>& args);
+  int SetIdleTimeout(const v8::FunctionCallbackInfo<v8::Value>& args);
   int Shutdown(const v8::FunctionCallbackInfo<v8::Value>& args);
   int Writev(const v8::FunctionCallbackInfo<v8::Value>& args);
   int WriteBuffer(const v8::FunctionCallbackInfo<v8::Value>& args);
+  int WriteChunked(const v8::FunctionCallbackInfo<v8::Value>& args);
   template <enum encoding enc>
   int WriteString(const v8::FunctionCallbackInfo<v8::Value>& args);
 
@@ -264,6 +316,11 @@ class StreamBase : public StreamResource {
   static void JSMethod(const v8::FunctionCallbackInfo<v8::Value>& args);
 
  private:
+  struct SharedBuffer;
+
+  // Writes data that other streams write as well, see Broadcast().
+  int WriteShared(SharedBuffer* shared, const char* data, size_t length);
+
   Environment* env_;
   bool consumed_;
 };
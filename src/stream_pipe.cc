@@ -0,0 +1,278 @@
+#include "stream_pipe.h"
+#include "stream_base.h"
+#include "stream_base-inl.h"
+
+#include "async-wrap.h"
+#include "async-wrap-inl.h"
+#include "env.h"
+#include "env-inl.h"
+#include "util.h"
+#include "util-inl.h"
+
+#include <stdlib.h>
+
+namespace node {
+
+using v8::Boolean;
+using v8::Context;
+using v8::External;
+using v8::FunctionCallbackInfo;
+using v8::FunctionTemplate;
+using v8::HandleScope;
+using v8::Integer;
+using v8::Local;
+using v8::Object;
+using v8::Value;
+
+
+StreamPipe::StreamPipe(Environment* env,
+                       Local<Object> object,
+                       StreamBase* source,
+                       StreamBase* sink)
+    : AsyncWrap(env, object, AsyncWrap::PROVIDER_STREAMPIPE),
+      source_(source),
+      sink_(sink),
+      pending_bytes_(0),
+      pending_writes_(0),
+      piping_(false),
+      paused_(false),
+      released_(false) {
+  Wrap(object, this);
+}
+
+
+StreamPipe::~StreamPipe() {
+  CHECK_EQ(piping_, false);
+  CHECK_EQ(pending_writes_, 0);
+}
+
+
+void StreamPipe::Initialize(Local<Object> target,
+                            Local<Value> unused,
+                            Local<Context> context) {
+  Environment* env = Environment::GetCurrent(context);
+
+  Local<FunctionTemplate> t = env->NewFunctionTemplate(New);
+  t->InstanceTemplate()->SetInternalFieldCount(1);
+  t->SetClassName(FIXED_ONE_BYTE_STRING(env->isolate(), "StreamPipe"));
+
+  env->SetProtoMethod(t, "start", Start);
+  env->SetProtoMethod(t, "unpipe", Unpipe);
+
+  target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "StreamPipe"),
+              t->GetFunction());
+}
+
+
+// new StreamPipe(source._externalStream, sink._externalStream)
+void StreamPipe::New(const FunctionCallbackInfo<Value>& args) {
+  CHECK(args.IsConstructCall());
+  CHECK(args[0]->IsExternal());
+  CHECK(args[1]->IsExternal());
+  Environment* env = Environment::GetCurrent(args);
+  StreamBase* source =
+      static_cast<StreamBase*>(args[0].As<External>()->Value());
+  StreamBase* sink =
+      static_cast<StreamBase*>(args[1].As<External>()->Value());
+  CHECK_NE(source, sink);
+  new StreamPipe(env, args.This(), source, sink);
+}
+
+
+void StreamPipe::Start(const FunctionCallbackInfo<Value>& args) {
+  StreamPipe* pipe = Unwrap<StreamPipe>(args.Holder());
+  CHECK_EQ(pipe->piping_, false);
+  CHECK_EQ(pipe->released_, false);
+
+  if (!pipe->source_->IsAlive() || !pipe->sink_->IsAlive())
+    return args.GetReturnValue().Set(UV_EINVAL);
+
+  pipe->source_alloc_cb_ = pipe->source_->alloc_cb();
+  pipe->source_read_cb_ = pipe->source_->read_cb();
+  pipe->source_->set_alloc_cb({ OnAlloc, pipe });
+  pipe->source_->set_read_cb({ OnRead, pipe });
+  pipe->piping_ = true;
+
+  int err = pipe->source_->ReadStart();
+  if (err) {
+    pipe->Unpipe();
+    pipe->MaybeRelease();
+  }
+  args.GetReturnValue().Set(err);
+}
+
+
+void StreamPipe::Unpipe(const FunctionCallbackInfo<Value>& args) {
+  StreamPipe* pipe = Unwrap<StreamPipe>(args.Holder());
+  pipe->Unpipe();
+  pipe->MaybeRelease();
+}
+
+
+void StreamPipe::OnAlloc(size_t size, uv_buf_t* buf, void* ctx) {
+  // The data is handed to the sink as it is, the buffer is freed once it
+  // has been written.
+  buf->base = static_cast<char*>(malloc(size));
+  buf->len = size;
+
+  if (buf->base == nullptr && size > 0) {
+    FatalError("node::StreamPipe::OnAlloc(size_t, uv_buf_t*, void*)",
+               "Out Of Memory");
+  }
+}
+
+
+void StreamPipe::OnRead(ssize_t nread,
+                        const uv_buf_t* buf,
+                        uv_handle_type pending,
+                        void* ctx) {
+  StreamPipe* pipe = static_cast<StreamPipe*>(ctx);
+
+  if (nread > 0) {
+    pipe->Write(buf->base, nread);
+    return;
+  }
+
+  if (buf != nullptr)
+    free(buf->base);
+
+  if (nread == 0)
+    return;
+
+  // Let the source see the EOF or the error with its own callbacks, before
+  // JS hears about the end of the pipe.
+  uv_buf_t empty = uv_buf_init(nullptr, 0);
+  pipe->Unpipe();
+  pipe->source_->OnRead(nread, &empty);
+  pipe->Finish(nread == UV_EOF ? 0 : nread, false);
+}
+
+
+void StreamPipe::Write(char* base, size_t length) {
+  uv_buf_t buf = uv_buf_init(base, length);
+  uv_buf_t* bufs = &buf;
+  size_t count = 1;
+
+  int err = sink_->DoTryWrite(&bufs, &count);
+  if (err == 0 && count == 0) {
+    sink_->OnBytesWritten(length);
+    free(base);
+    return;
+  }
+
+  if (err == 0) {
+    HandleScope handle_scope(env()->isolate());
+    Context::Scope context_scope(env()->context());
+
+    Local<Object> req_wrap_obj =
+        env()->write_wrap_constructor_function()
+            ->NewInstance(env()->context()).ToLocalChecked();
+    WriteWrap* req_wrap = WriteWrap::New(env(),
+                                         req_wrap_obj,
+                                         sink_,
+                                         OnWriteDone,
+                                         sizeof(PendingWrite));
+    PendingWrite* write = reinterpret_cast<PendingWrite*>(req_wrap->Extra());
+    write->pipe = this;
+    write->base = base;
+    write->length = bufs[0].len;
+
+    err = sink_->DoWrite(req_wrap, bufs, count, nullptr);
+    if (err) {
+      req_wrap->Dispose();
+    } else {
+      sink_->OnBytesWritten(length);
+      pending_bytes_ += write->length;
+      pending_writes_++;
+      if (!paused_ && pending_bytes_ > kHighWaterMark) {
+        paused_ = true;
+        source_->ReadStop();
+      }
+      base = nullptr;
+    }
+  }
+
+  if (sink_->Error() != nullptr)
+    sink_->ClearError();
+
+  if (err) {
+    free(base);
+    Fail(err);
+  }
+}
+
+
+void StreamPipe::OnWriteDone(WriteWrap* req_wrap, int status) {
+  PendingWrite* write = reinterpret_cast<PendingWrite*>(req_wrap->Extra());
+  StreamPipe* pipe = write->pipe;
+  StreamBase* sink = req_wrap->wrap();
+
+  free(write->base);
+  pipe->pending_bytes_ -= write->length;
+  pipe->pending_writes_--;
+  // Keeps the sink's writeQueueSize up to date.
+  sink->OnAfterWrite(req_wrap);
+  req_wrap->Dispose();
+
+  if (pipe->piping_) {
+    if (status != 0) {
+      pipe->Fail(status);
+    } else if (pipe->paused_ && pipe->pending_bytes_ < kLowWaterMark) {
+      pipe->paused_ = false;
+      pipe->source_->ReadStart();
+    }
+  }
+
+  pipe->MaybeRelease();
+}
+
+
+void StreamPipe::Unpipe() {
+  if (!piping_)
+    return;
+  piping_ = false;
+
+  source_->set_alloc_cb(source_alloc_cb_);
+  source_->set_read_cb(source_read_cb_);
+
+  // The source is left reading, like it was when the pipe was started.
+  if (paused_) {
+    paused_ = false;
+    source_->ReadStart();
+  }
+}
+
+
+void StreamPipe::Fail(int status) {
+  // Nothing more can be written, stop reading until JS decides what to do.
+  paused_ = false;
+  source_->ReadStop();
+  Finish(status, true);
+}
+
+
+void StreamPipe::Finish(int status, bool write_failed) {
+  Unpipe();
+
+  HandleScope handle_scope(env()->isolate());
+  Context::Scope context_scope(env()->context());
+  Local<Value> argv[] = {
+    Integer::New(env()->isolate(), status),
+    Boolean::New(env()->isolate(), write_failed)
+  };
+  MakeCallback(env()->oncomplete_string(), arraysize(argv), argv);
+
+  MaybeRelease();
+}
+
+
+void StreamPipe::MaybeRelease() {
+  if (piping_ || released_ || pending_writes_ > 0)
+    return;
+  released_ = true;
+  MakeWeak<StreamPipe>(this);
+}
+
+}  // namespace node
+
+NODE_MODULE_CONTEXT_AWARE_BUILTIN(stream_pipe, node::StreamPipe::Initialize)
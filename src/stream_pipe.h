@@ -0,0 +1,85 @@
+#ifndef SRC_STREAM_PIPE_H_
+#define SRC_STREAM_PIPE_H_
+
+#include "stream_base.h"
+
+#include "async-wrap.h"
+#include "env.h"
+#include "util.h"
+#include "uv.h"
+#include "v8.h"
+
+namespace node {
+
+// Forwards everything that is read from one StreamBase to another one,
+// without a trip to JS for every chunk.  Reading from the source stops
+// while too much data is waiting to be written to the sink.  JS is only
+// called, with oncomplete(status, writeFailed), when the source ends or
+// fails, or when a write fails.  An EOF or a read error is passed on to the
+// source's own read callback first, so that the source's JS object sees it
+// like it normally would.
+class StreamPipe : public AsyncWrap {
+ public:
+  ~StreamPipe() override;
+
+  static void Initialize(v8::Local<v8::Object> target,
+                         v8::Local<v8::Value> unused,
+                         v8::Local<v8::Context> context);
+
+  size_t self_size() const override { return sizeof(*this); }
+
+ private:
+  // Lives in the extra storage of the WriteWraps for the sink.
+  struct PendingWrite {
+    StreamPipe* pipe;
+    char* base;
+    size_t length;
+  };
+
+  // Reading stops above kHighWaterMark bytes of pending writes and starts
+  // again below kLowWaterMark.
+  static const size_t kHighWaterMark = 256 * 1024;
+  static const size_t kLowWaterMark = 64 * 1024;
+
+  StreamPipe(Environment* env,
+             v8::Local<v8::Object> object,
+             StreamBase* source,
+             StreamBase* sink);
+
+  static void New(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void Start(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void Unpipe(const v8::FunctionCallbackInfo<v8::Value>& args);
+
+  static void OnAlloc(size_t size, uv_buf_t* buf, void* ctx);
+  static void OnRead(ssize_t nread,
+                     const uv_buf_t* buf,
+                     uv_handle_type pending,
+                     void* ctx);
+  static void OnWriteDone(WriteWrap* req_wrap, int status);
+
+  void Write(char* base, size_t length);
+  // Restores the source's callbacks, no more data goes through the pipe.
+  void Unpipe();
+  // Unpipes and calls oncomplete(status, writeFailed) in JS.
+  void Finish(int status, bool write_failed);
+  // Finish() for a failed write, the source stops reading.
+  void Fail(int status);
+  // Lets the GC have the pipe once it's done and no writes are left.
+  void MaybeRelease();
+
+  StreamBase* source_;
+  StreamBase* sink_;
+  StreamResource::Callback<StreamResource::AllocCb> source_alloc_cb_;
+  StreamResource::Callback<StreamResource::ReadCb> source_read_cb_;
+  size_t pending_bytes_;
+  size_t pending_writes_;
+  bool piping_;
+  bool paused_;
+  bool released_;
+
+  DISALLOW_COPY_AND_ASSIGN(StreamPipe);
+};
+
+}  // namespace node
+
+#endif  // SRC_STREAM_PIPE_H_
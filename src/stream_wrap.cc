@@ -10,6 +10,7 @@
 #include "pipe_wrap.h"
 #include "req-wrap.h"
 #include "req-wrap-inl.h"
+#include "slab_allocator.h"
 #include "tcp_wrap.h"
 #include "udp_wrap.h"
 #include "util.h"
@@ -22,18 +23,26 @@
 
 namespace node {
 
+using v8::ArrayBuffer;
 using v8::Context;
 using v8::EscapableHandleScope;
+using v8::Float64Array;
 using v8::FunctionCallbackInfo;
 using v8::FunctionTemplate;
 using v8::HandleScope;
 using v8::Integer;
 using v8::Local;
 using v8::Object;
-using v8::True;
 using v8::Value;
 
 
+static void GetReqStoragePoolStats(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  args.GetReturnValue().Set(
+      env->FreeListPoolStats(env->req_storage_pool()));
+}
+
+
 void StreamWrap::Initialize(Local<Object> target,
                             Local<Value> unused,
                             Local<Context> context) {
@@ -53,6 +62,19 @@ void StreamWrap::Initialize(Local<Object> target,
   target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "WriteWrap"),
               ww->GetFunction());
   env->set_write_wrap_constructor_function(ww->GetFunction());
+
+  // The result of the last write, see Environment::WriteInfo.
+  double* const fields = env->write_info()->fields();
+  int const fields_count = env->write_info()->fields_count();
+  Local<ArrayBuffer> array_buffer =
+      ArrayBuffer::New(env->isolate(),
+                       fields,
+                       sizeof(*fields) * fields_count);
+  target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "writeInfo"),
+              Float64Array::New(array_buffer, 0, fields_count));
+
+  env->SetMethod(target, "getReqStoragePoolStats", GetReqStoragePoolStats);
+  env->SetMethod(target, "broadcast", StreamBase::Broadcast);
 }
 
 
@@ -67,7 +89,9 @@ StreamWrap::StreamWrap(Environment* env,
                  provider,
                  parent),
       StreamBase(env),
-      stream_(stream) {
+      stream_(stream),
+      read_slab_(false),
+      shared_read_buffer_(false) {
   set_after_write_cb({ OnAfterWriteImpl, this });
   set_alloc_cb({ OnAllocImpl, this });
   set_read_cb({ OnReadImpl, this });
@@ -78,6 +102,9 @@ void StreamWrap::AddMethods(Environment* env,
                             v8::Local<v8::FunctionTemplate> target,
                             int flags) {
   env->SetProtoMethod(target, "setBlocking", SetBlocking);
+  env->SetProtoMethod(target, "setReadSlab", SetReadSlab);
+  env->SetProtoMethod(target, "setSharedReadBuffer", SetSharedReadBuffer);
+  env->SetProtoMethod(target, "sendFile", SendFile);
   StreamBase::AddMethods<StreamWrap>(env, target, flags);
 }
 
@@ -118,6 +145,7 @@ bool StreamWrap::IsIPCPipe() {
 
 
 void StreamWrap::UpdateWriteQueueSize() {
+  OnWriteQueueSize(stream()->write_queue_size);
   HandleScope scope(env()->isolate());
   Local<Integer> write_queue_size =
       Integer::NewFromUnsigned(env()->isolate(), stream()->write_queue_size);
@@ -149,6 +177,18 @@ void StreamWrap::OnAlloc(uv_handle_t* handle,
 
 
 void StreamWrap::OnAllocImpl(size_t size, uv_buf_t* buf, void* ctx) {
+  StreamWrap* wrap = static_cast<StreamWrap*>(ctx);
+  if (wrap->shared_read_buffer_) {
+    buf->base = wrap->env()->shared_read_buffer();
+    buf->len = Environment::kSharedReadBufferSize;
+    return;
+  }
+
+  if (wrap->read_slab_) {
+    *buf = wrap->env()->read_slab_allocator()->Allocate(size);
+    return;
+  }
+
   buf->base = static_cast<char*>(malloc(size));
   buf->len = size;
 
@@ -180,6 +220,26 @@ static Local<Object> AcceptHandle(Environment* env, StreamWrap* parent) {
 }
 
 
+Local<Object> StreamWrap::AcceptPendingHandle() {
+  if (!IsAlive() || !is_named_pipe_ipc())
+    return Local<Object>();
+  uv_pipe_t* pipe = reinterpret_cast<uv_pipe_t*>(stream());
+  if (uv_pipe_pending_count(pipe) == 0)
+    return Local<Object>();
+
+  switch (uv_pipe_pending_type(pipe)) {
+    case UV_TCP:
+      return AcceptHandle<TCPWrap, uv_tcp_t>(env(), this);
+    case UV_NAMED_PIPE:
+      return AcceptHandle<PipeWrap, uv_pipe_t>(env(), this);
+    case UV_UDP:
+      return AcceptHandle<UDPWrap, uv_udp_t>(env(), this);
+    default:
+      return Local<Object>();
+  }
+}
+
+
 void StreamWrap::OnReadImpl(ssize_t nread,
                             const uv_buf_t* buf,
                             uv_handle_type pending,
@@ -191,22 +251,34 @@ void StreamWrap::OnReadImpl(ssize_t nread,
 
   Local<Object> pending_obj;
 
-  if (nread < 0)  {
-    if (buf->base != nullptr)
-      free(buf->base);
-    wrap->EmitData(nread, Local<Object>(), pending_obj);
+  if (nread <= 0) {
+    // The shared read buffer is owned by the environment.
+    if (!wrap->shared_read_buffer_) {
+      if (wrap->read_slab_)
+        env->read_slab_allocator()->Release(buf);
+      else if (buf->base != nullptr)
+        free(buf->base);
+    }
+    if (nread < 0)
+      wrap->EmitData(nread, Local<Object>(), pending_obj);
     return;
   }
 
-  if (nread == 0) {
-    if (buf->base != nullptr)
-      free(buf->base);
-    return;
+  Local<Object> obj;
+  if (wrap->shared_read_buffer_) {
+    CHECK_EQ(buf->base, env->shared_read_buffer());
+    if (wrap->read_slab_)
+      obj = env->read_slab_allocator()->Copy(env, buf->base, nread);
+    else
+      obj = Buffer::Copy(env, buf->base, nread).ToLocalChecked();
+  } else if (wrap->read_slab_) {
+    obj = env->read_slab_allocator()->Commit(env, buf, nread);
+  } else {
+    char* base = static_cast<char*>(realloc(buf->base, nread));
+    CHECK_LE(static_cast<size_t>(nread), buf->len);
+    obj = Buffer::New(env, base, nread).ToLocalChecked();
   }
 
-  char* base = static_cast<char*>(realloc(buf->base, nread));
-  CHECK_LE(static_cast<size_t>(nread), buf->len);
-
   if (pending == UV_TCP) {
     pending_obj = AcceptHandle<TCPWrap, uv_tcp_t>(env, wrap);
   } else if (pending == UV_NAMED_PIPE) {
@@ -217,7 +289,6 @@ void StreamWrap::OnReadImpl(ssize_t nread,
     CHECK_EQ(pending, UV_UNKNOWN_HANDLE);
   }
 
-  Local<Object> obj = Buffer::New(env, base, nread).ToLocalChecked();
   wrap->EmitData(nread, obj, pending_obj);
 }
 
@@ -242,6 +313,9 @@ void StreamWrap::OnReadCommon(uv_stream_t* handle,
     }
   }
 
+  if (NODE_STREAM_READ_ENABLED())
+    NODE_STREAM_READ(wrap, wrap->GetFD(), nread);
+
   static_cast<StreamBase*>(wrap)->OnRead(nread, buf, pending);
 }
 
@@ -273,6 +347,65 @@ void StreamWrap::SetBlocking(const FunctionCallbackInfo<Value>& args) {
 }
 
 
+void StreamWrap::SetReadSlab(const FunctionCallbackInfo<Value>& args) {
+  StreamWrap* wrap = Unwrap<StreamWrap>(args.Holder());
+  wrap->read_slab_ = args[0]->IsTrue();
+}
+
+
+void StreamWrap::SetSharedReadBuffer(const FunctionCallbackInfo<Value>& args) {
+  StreamWrap* wrap = Unwrap<StreamWrap>(args.Holder());
+  wrap->shared_read_buffer_ = args[0]->IsTrue();
+}
+
+
+// sendFile(req, fd, offset, length)
+// Queues a range of a file for writing with uv_sendfile(). The request is
+// a regular WriteWrap, so it completes through the usual oncomplete path.
+void StreamWrap::SendFile(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  StreamWrap* wrap = Unwrap<StreamWrap>(args.Holder());
+
+  CHECK(args[0]->IsObject());
+  CHECK(args[1]->IsInt32());
+  CHECK(args[2]->IsNumber());
+  CHECK(args[3]->IsNumber());
+
+  if (!wrap->IsAlive())
+    return args.GetReturnValue().Set(UV_EINVAL);
+
+  Local<Object> req_wrap_obj = args[0].As<Object>();
+  int fd = args[1]->Int32Value();
+  int64_t offset = args[2]->IntegerValue();
+  size_t length = args[3]->IntegerValue();
+
+  WriteWrap* req_wrap =
+      WriteWrap::New(env, req_wrap_obj, wrap, StreamBase::AfterWrite);
+  int err = uv_sendfile(&req_wrap->req_,
+                        wrap->stream(),
+                        fd,
+                        offset,
+                        length,
+                        AfterWrite);
+  req_wrap->Dispatched();
+
+  if (err) {
+    req_wrap->Dispose();
+  } else {
+    if (wrap->is_tcp()) {
+      NODE_COUNT_NET_BYTES_SENT(length);
+    } else if (wrap->is_named_pipe()) {
+      NODE_COUNT_PIPE_BYTES_SENT(length);
+    }
+    wrap->OnBytesWritten(length);
+    wrap->UpdateWriteQueueSize();
+  }
+
+  env->write_info()->set(length, true);
+  args.GetReturnValue().Set(err);
+}
+
+
 int StreamWrap::DoShutdown(ShutdownWrap* req_wrap) {
   int err;
   err = uv_shutdown(&req_wrap->req_, stream(), AfterShutdown);
@@ -24,6 +24,7 @@ class StreamWrap : public HandleWrap, public StreamBase {
   bool IsAlive() override;
   bool IsClosing() override;
   bool IsIPCPipe() override;
+  StreamBase* GetStream() override { return this; }
 
   // JavaScript functions
   int ReadStart() override;
@@ -66,6 +67,9 @@ class StreamWrap : public HandleWrap, public StreamBase {
 
   AsyncWrap* GetAsyncWrap() override;
   void UpdateWriteQueueSize();
+  // The next handle that came in over an IPC pipe and that no read has
+  // handed out yet, or an empty handle.
+  v8::Local<v8::Object> AcceptPendingHandle();
 
   static void AddMethods(Environment* env,
                          v8::Local<v8::FunctionTemplate> target,
@@ -73,6 +77,10 @@ class StreamWrap : public HandleWrap, public StreamBase {
 
  private:
   static void SetBlocking(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void SetReadSlab(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void SetSharedReadBuffer(
+      const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void SendFile(const v8::FunctionCallbackInfo<v8::Value>& args);
 
   // Callbacks for libuv
   static void OnAlloc(uv_handle_t* handle,
@@ -98,6 +106,8 @@ class StreamWrap : public HandleWrap, public StreamBase {
                          void* ctx);
 
   uv_stream_t* const stream_;
+  bool read_slab_;
+  bool shared_read_buffer_;
 };
 
 
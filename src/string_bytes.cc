@@ -8,6 +8,31 @@
 #include <string.h>  // memcpy
 #include <vector>
 
+// SSE2 is part of the x86_64 baseline and NEON of the arm64 one, so these
+// need no runtime detection.
+#if defined(__SSE2__) || defined(_M_X64)
+# include <emmintrin.h>
+# define STRING_BYTES_SSE2 1
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+# include <arm_neon.h>
+# define STRING_BYTES_NEON 1
+#endif
+
+// SSSE3 isn't, so the base64 code checks for it at runtime.  Older versions
+// of gcc can't compile SSSE3 intrinsics in a file built without -mssse3.
+#if defined(STRING_BYTES_SSE2) &&                                             \
+    (defined(_MSC_VER) || defined(__clang__) || __GNUC__ >= 5)
+# include <tmmintrin.h>
+# if defined(_MSC_VER)
+#  include <intrin.h>
+#  define STRING_BYTES_SSSE3_FUNCTION
+# else
+#  include <cpuid.h>
+#  define STRING_BYTES_SSSE3_FUNCTION __attribute__((target("ssse3")))
+# endif
+# define STRING_BYTES_SSSE3 1
+#endif
+
 // When creating strings >= this length v8's gc spins up and consumes
 // most of the execution time. For these cases it's more performant to
 // use external string resources.
@@ -121,6 +146,26 @@ MaybeLocal<String> ExternTwoByteString::NewExternal(
 }
 
 
+#if defined(STRING_BYTES_SSSE3)
+static bool DetectSSSE3() {
+#if defined(_MSC_VER)
+  int info[4];
+  __cpuid(info, 1);
+  return (info[2] & (1 << 9)) != 0;
+#else
+  unsigned eax, ebx, ecx, edx;
+  return __get_cpuid(1, &eax, &ebx, &ecx, &edx) && (ecx & bit_SSSE3) != 0;
+#endif
+}
+
+
+static bool HasSSSE3() {
+  static const bool has_ssse3 = DetectSSSE3();
+  return has_ssse3;
+}
+#endif
+
+
 //// Base 64 ////
 
 #define base64_encoded_size(size) ((size + 2 - ((size + 2) % 3)) / 3 * 4)
@@ -215,6 +260,88 @@ size_t base64_decode_slow(char* dst, size_t dstlen,
 }
 
 
+// Decodes 16 characters at a time, for as long as the input is valid
+// base64 without whitespace or padding, and advances |i| and |k| past what
+// it has decoded.  Two-byte strings are left to the scalar code.
+template <typename TypeName>
+static inline void base64_decode_vector(char* const dst, const size_t max_k,
+                                        const TypeName* const src,
+                                        const size_t max_i,
+                                        size_t* i, size_t* k) {
+}
+
+
+#if defined(STRING_BYTES_SSSE3)
+STRING_BYTES_SSSE3_FUNCTION
+static void base64_decode_ssse3(char* const dst, const size_t max_k,
+                                const char* const src, const size_t max_i,
+                                size_t* const pi, size_t* const pk) {
+  size_t i = *pi;
+  size_t k = *pk;
+
+  while (i + 16 <= max_i && k + 12 <= max_k) {
+    const __m128i c =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+
+    // Bytes >= 0x80 are negative and fall outside of all the ranges.
+#define IN_RANGE(lo, hi)                                                      \
+    _mm_and_si128(_mm_cmpgt_epi8(c, _mm_set1_epi8((lo) - 1)),                 \
+                  _mm_cmpgt_epi8(_mm_set1_epi8((hi) + 1), c))
+#define IS(ch) _mm_cmpeq_epi8(c, _mm_set1_epi8(ch))
+    const __m128i upper = IN_RANGE('A', 'Z');
+    const __m128i lower = IN_RANGE('a', 'z');
+    const __m128i digit = IN_RANGE('0', '9');
+    const __m128i plus = _mm_or_si128(IS('+'), IS('-'));
+    const __m128i slash = _mm_or_si128(IS('/'), IS('_'));
+#undef IN_RANGE
+#undef IS
+
+    const __m128i valid = _mm_or_si128(
+        _mm_or_si128(upper, lower),
+        _mm_or_si128(digit, _mm_or_si128(plus, slash)));
+    if (_mm_movemask_epi8(valid) != 0xFFFF)
+      break;
+
+    __m128i v = _mm_and_si128(upper, _mm_sub_epi8(c, _mm_set1_epi8('A')));
+    v = _mm_or_si128(v, _mm_and_si128(
+        lower, _mm_sub_epi8(c, _mm_set1_epi8('a' - 26))));
+    v = _mm_or_si128(v, _mm_and_si128(
+        digit, _mm_add_epi8(c, _mm_set1_epi8(52 - '0'))));
+    v = _mm_or_si128(v, _mm_and_si128(plus, _mm_set1_epi8(62)));
+    v = _mm_or_si128(v, _mm_and_si128(slash, _mm_set1_epi8(63)));
+
+    // Merge each group of four 6-bit values into 24 bits, then drop the
+    // fourth byte of every 32-bit lane.
+    v = _mm_maddubs_epi16(v, _mm_set1_epi32(0x01400140));
+    v = _mm_madd_epi16(v, _mm_set1_epi32(0x00011000));
+    v = _mm_shuffle_epi8(v, _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8,
+                                          14, 13, 12, -1, -1, -1, -1));
+
+    // Only write the 12 decoded bytes, the destination may be exactly that
+    // big.
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + k), v);
+    const int32_t tail = _mm_cvtsi128_si32(_mm_srli_si128(v, 8));
+    memcpy(dst + k + 8, &tail, sizeof(tail));
+
+    i += 16;
+    k += 12;
+  }
+
+  *pi = i;
+  *pk = k;
+}
+
+
+template <>
+inline void base64_decode_vector(char* const dst, const size_t max_k,
+                                 const char* const src, const size_t max_i,
+                                 size_t* i, size_t* k) {
+  if (HasSSSE3())
+    base64_decode_ssse3(dst, max_k, src, max_i, i, k);
+}
+#endif
+
+
 template <typename TypeName>
 size_t base64_decode_fast(char* const dst, const size_t dstlen,
                           const TypeName* const src, const size_t srclen,
@@ -224,6 +351,7 @@ size_t base64_decode_fast(char* const dst, const size_t dstlen,
   const size_t max_k = available / 3 * 3;
   size_t i = 0;
   size_t k = 0;
+  base64_decode_vector(dst, max_k, src, max_i, &i, &k);
   while (i < max_i && k < max_k) {
     const uint32_t v =
         unbase64(src[i + 0]) << 24 |
@@ -396,6 +524,18 @@ size_t StringBytes::Write(Isolate* isolate,
 
     case BUFFER:
     case UTF8:
+      // The UTF-8 of ASCII is the Latin-1 of it, which V8 copies instead of
+      // encoding every character.  Anything else is written over.
+      if (str->IsOneByte() &&
+          static_cast<size_t>(str->Length()) >= kAsciiFastPathLength) {
+        uint8_t* const dst = reinterpret_cast<uint8_t*>(buf);
+        nbytes = str->WriteOneByte(dst, 0, buflen, flags);
+        if (IsAscii(buf, nbytes)) {
+          if (chars_written != nullptr)
+            *chars_written = nbytes;
+          break;
+        }
+      }
       nbytes = str->WriteUtf8(buf, buflen, chars_written, flags);
       break;
 
@@ -502,10 +642,11 @@ size_t StringBytes::StorageSize(Isolate* isolate,
 
     case BUFFER:
     case UTF8:
-      // A single UCS2 codepoint never takes up more than 3 utf8 bytes.
+      // A single UCS2 codepoint never takes up more than 3 utf8 bytes,
+      // a Latin-1 one no more than 2.
       // It is an exercise for the caller to decide when a string is
       // long enough to justify calling Size() instead of StorageSize()
-      data_size = 3 * str->Length();
+      data_size = (str->IsOneByte() ? 2 : 3) * str->Length();
       break;
 
     case UCS2:
@@ -554,7 +695,7 @@ size_t StringBytes::Size(Isolate* isolate,
 
     case BUFFER:
     case UTF8:
-      data_size = str->Utf8Length();
+      data_size = Utf8Length(str);
       break;
 
     case UCS2:
@@ -582,54 +723,125 @@ size_t StringBytes::Size(Isolate* isolate,
 
 
 
-static bool contains_non_ascii_slow(const char* buf, size_t len) {
-  for (size_t i = 0; i < len; ++i) {
-    if (buf[i] & 0x80)
-      return true;
+// Returns the length of the run of ASCII characters that |src| starts with.
+static size_t ascii_prefix_length(const char* src, size_t len) {
+  size_t i = 0;
+
+#if defined(STRING_BYTES_SSE2)
+  for (; i + 32 <= len; i += 32) {
+    const __m128i a =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    const __m128i b =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 16));
+    if (_mm_movemask_epi8(_mm_or_si128(a, b)) != 0)
+      break;
   }
-  return false;
+#elif defined(STRING_BYTES_NEON)
+  for (; i + 32 <= len; i += 32) {
+    const uint8_t* p = reinterpret_cast<const uint8_t*>(src + i);
+    if (vmaxvq_u8(vorrq_u8(vld1q_u8(p), vld1q_u8(p + 16))) & 0x80)
+      break;
+  }
+#else
+  if (len >= 16) {
+    const unsigned bytes_per_word = sizeof(uintptr_t);
+    const unsigned align_mask = bytes_per_word - 1;
+    const unsigned unaligned = reinterpret_cast<uintptr_t>(src) & align_mask;
+
+    if (unaligned > 0) {
+      for (; i < bytes_per_word - unaligned; ++i) {
+        if (src[i] & 0x80)
+          return i;
+      }
+    }
+
+#if defined(_WIN64) || defined(_LP64)
+    const uintptr_t mask = 0x8080808080808080ll;
+#else
+    const uintptr_t mask = 0x80808080l;
+#endif
+
+    for (; i + bytes_per_word <= len; i += bytes_per_word) {
+      if (*reinterpret_cast<const uintptr_t*>(src + i) & mask)
+        break;
+    }
+  }
+#endif
+
+  // The vector and word loops stop at the chunk with the first non-ASCII
+  // character; find it in there, or check the tail of the buffer.
+  while (i < len && !(src[i] & 0x80))
+    ++i;
+  return i;
 }
 
 
 static bool contains_non_ascii(const char* src, size_t len) {
-  if (len < 16) {
-    return contains_non_ascii_slow(src, len);
-  }
+  return ascii_prefix_length(src, len) != len;
+}
+
+
+bool StringBytes::IsAscii(const char* buf, size_t buflen) {
+  return !contains_non_ascii(buf, buflen);
+}
 
-  const unsigned bytes_per_word = sizeof(uintptr_t);
-  const unsigned align_mask = bytes_per_word - 1;
-  const unsigned unaligned = reinterpret_cast<uintptr_t>(src) & align_mask;
 
-  if (unaligned > 0) {
-    const unsigned n = bytes_per_word - unaligned;
-    if (contains_non_ascii_slow(src, n))
-      return true;
-    src += n;
-    len -= n;
+size_t StringBytes::Utf8Length(Local<String> str) {
+  const size_t length = str->Length();
+  if (!str->IsOneByte() || length < kAsciiFastPathLength)
+    return str->Utf8Length();
+
+  // Every Latin-1 character above U+007F takes two bytes.  V8 counts them
+  // one character at a time, copying the characters out in chunks and
+  // skipping the runs of ASCII in them is a lot faster.
+  const int flags = String::HINT_MANY_WRITES_EXPECTED |
+                    String::NO_NULL_TERMINATION;
+  char chunk[16 * 1024];
+  size_t utf8_length = length;
+  for (size_t start = 0; start < length; start += sizeof(chunk)) {
+    const int n = str->WriteOneByte(reinterpret_cast<uint8_t*>(chunk),
+                                    start,
+                                    sizeof(chunk),
+                                    flags);
+    for (size_t i = ascii_prefix_length(chunk, n);
+         i < static_cast<size_t>(n);
+         i += 1 + ascii_prefix_length(chunk + i + 1, n - i - 1)) {
+      utf8_length++;
+    }
   }
+  return utf8_length;
+}
 
 
-#if defined(_WIN64) || defined(_LP64)
-  const uintptr_t mask = 0x8080808080808080ll;
-#else
-  const uintptr_t mask = 0x80808080l;
-#endif
+// Decodes UTF-8 into Latin-1, so that it can become a one-byte string
+// without going through V8's UTF-8 decoder.  That only works when |src| is
+// well-formed and doesn't encode code points above U+00FF, which means all
+// non-ASCII characters are two-byte sequences that start with 0xC2 or 0xC3.
+// Returns the length of the result, which is written to |dst|, or -1 when
+// |src| doesn't qualify.  |dst| must have room for |len| bytes.
+static ssize_t utf8_to_latin1(const char* src, size_t len, char* dst) {
+  size_t i = 0;
+  size_t k = 0;
 
-  const uintptr_t* srcw = reinterpret_cast<const uintptr_t*>(src);
+  while (i < len) {
+    const size_t ascii = ascii_prefix_length(src + i, len - i);
+    memcpy(dst + k, src + i, ascii);
+    i += ascii;
+    k += ascii;
 
-  for (size_t i = 0, n = len / bytes_per_word; i < n; ++i) {
-    if (srcw[i] & mask)
-      return true;
-  }
+    if (i == len)
+      break;
 
-  const unsigned remainder = len & align_mask;
-  if (remainder > 0) {
-    const size_t offset = len - remainder;
-    if (contains_non_ascii_slow(src + offset, remainder))
-      return true;
+    const unsigned char c = src[i];
+    if ((c != 0xC2 && c != 0xC3) || i + 1 == len ||
+        (src[i + 1] & 0xC0) != 0x80) {
+      return -1;
+    }
+    dst[k++] = static_cast<char>(((c & 0x03) << 6) | (src[i + 1] & 0x3F));
+    i += 2;
   }
 
-  return false;
+  return k;
 }
 
 
@@ -685,6 +897,52 @@ static void force_ascii(const char* src, char* dst, size_t len) {
 }
 
 
+#if defined(STRING_BYTES_SSSE3)
+// Encodes 12 bytes at a time into 16 characters.  Reads 16 bytes for each
+// block, so it stops when fewer than that are left.
+STRING_BYTES_SSSE3_FUNCTION
+static void base64_encode_ssse3(const char* const src, const size_t slen,
+                                char* const dst,
+                                unsigned* const pi, unsigned* const pk) {
+  size_t i = *pi;
+  size_t k = *pk;
+
+  while (i + 16 <= slen) {
+    __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+
+    // Spread each group of three bytes over a 32-bit lane and move the four
+    // 6-bit values into bytes of their own.
+    in = _mm_shuffle_epi8(in, _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7,
+                                           4, 5, 3, 4, 1, 2, 0, 1));
+    const __m128i t0 = _mm_and_si128(in, _mm_set1_epi32(0x0fc0fc00));
+    const __m128i t1 = _mm_mulhi_epu16(t0, _mm_set1_epi32(0x04000040));
+    const __m128i t2 = _mm_and_si128(in, _mm_set1_epi32(0x003f03f0));
+    const __m128i t3 = _mm_mullo_epi16(t2, _mm_set1_epi32(0x01000010));
+    const __m128i v = _mm_or_si128(t1, t3);
+
+    // Map 0-25, 26-51, 52-61, 62 and 63 to their characters by adding an
+    // offset that is looked up by range.
+    __m128i range = _mm_subs_epu8(v, _mm_set1_epi8(51));
+    const __m128i less = _mm_cmpgt_epi8(_mm_set1_epi8(26), v);
+    range = _mm_or_si128(range, _mm_and_si128(less, _mm_set1_epi8(13)));
+    const __m128i offsets = _mm_setr_epi8(
+        'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+        '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62,
+        '/' - 63, 'A', 0, 0);
+    const __m128i out =
+        _mm_add_epi8(_mm_shuffle_epi8(offsets, range), v);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + k), out);
+
+    i += 12;
+    k += 16;
+  }
+
+  *pi = i;
+  *pk = k;
+}
+#endif
+
+
 static size_t base64_encode(const char* src,
                             size_t slen,
                             char* dst,
@@ -710,6 +968,11 @@ static size_t base64_encode(const char* src,
   k = 0;
   n = slen / 3 * 3;
 
+#if defined(STRING_BYTES_SSSE3)
+  if (HasSSSE3())
+    base64_encode_ssse3(src, slen, dst, &i, &k);
+#endif
+
   while (i < n) {
     a = src[i + 0] & 0xff;
     b = src[i + 1] & 0xff;
@@ -755,7 +1018,31 @@ static size_t hex_encode(const char* src, size_t slen, char* dst, size_t dlen) {
       "not enough space provided for hex encode");
 
   dlen = slen * 2;
-  for (uint32_t i = 0, k = 0; k < dlen; i += 1, k += 2) {
+  uint32_t i = 0;
+  uint32_t k = 0;
+
+#if defined(STRING_BYTES_SSE2)
+  const __m128i nibble = _mm_set1_epi8(0x0f);
+  for (; i + 16 <= slen; i += 16, k += 32) {
+    const __m128i in =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    __m128i hi = _mm_and_si128(_mm_srli_epi16(in, 4), nibble);
+    __m128i lo = _mm_and_si128(in, nibble);
+    // '0' + n, plus the distance from '9' + 1 to 'a' for n > 9.
+    const __m128i nine = _mm_set1_epi8(9);
+    const __m128i letter = _mm_set1_epi8('a' - '0' - 10);
+    hi = _mm_add_epi8(_mm_add_epi8(hi, _mm_set1_epi8('0')),
+                      _mm_and_si128(_mm_cmpgt_epi8(hi, nine), letter));
+    lo = _mm_add_epi8(_mm_add_epi8(lo, _mm_set1_epi8('0')),
+                      _mm_and_si128(_mm_cmpgt_epi8(lo, nine), letter));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + k),
+                     _mm_unpacklo_epi8(hi, lo));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + k + 16),
+                     _mm_unpackhi_epi8(hi, lo));
+  }
+#endif
+
+  for (; k < dlen; i += 1, k += 2) {
     static const char hex[] = "0123456789abcdef";
     uint8_t val = static_cast<uint8_t>(src[i]);
     dst[k + 0] = hex[val >> 4];
@@ -808,12 +1095,45 @@ Local<Value> StringBytes::Encode(Isolate* isolate,
       }
       break;
 
-    case UTF8:
-      val = String::NewFromUtf8(isolate,
-                                buf,
-                                String::kNormalString,
-                                buflen);
+    case UTF8: {
+      const size_t ascii = ascii_prefix_length(buf, buflen);
+      if (ascii == buflen) {
+        if (buflen < EXTERN_APEX)
+          val = OneByteString(isolate, buf, buflen);
+        else
+          val = ExternOneByteString::NewFromCopy(isolate, buf, buflen);
+        break;
+      }
+
+      // Text that is mostly ASCII with a few accented characters still
+      // fits in a one-byte string, which uses half the memory of the
+      // two-byte string that String::NewFromUtf8() creates for it.
+      char* out = nullptr;
+      ssize_t outlen = -1;
+      if (buf[ascii] == '\xC2' || buf[ascii] == '\xC3') {
+        out = static_cast<char*>(malloc(buflen));
+        if (out != nullptr) {
+          memcpy(out, buf, ascii);
+          outlen = utf8_to_latin1(buf + ascii, buflen - ascii, out + ascii);
+          if (outlen >= 0)
+            outlen += ascii;
+        }
+      }
+
+      if (outlen < 0) {
+        free(out);
+        val = String::NewFromUtf8(isolate,
+                                  buf,
+                                  String::kNormalString,
+                                  buflen);
+      } else if (static_cast<size_t>(outlen) < EXTERN_APEX) {
+        val = OneByteString(isolate, out, outlen);
+        free(out);
+      } else {
+        val = ExternOneByteString::New(isolate, out, outlen);
+      }
       break;
+    }
 
     case BINARY:
       if (buflen < EXTERN_APEX)
@@ -924,4 +1244,283 @@ Local<Value> StringBytes::Encode(Isolate* isolate,
   return ret;
 }
 
+
+bool StringBytes::Chars::CopyFrom(Local<String> string) {
+  const int flags = String::HINT_MANY_WRITES_EXPECTED |
+                    String::NO_NULL_TERMINATION;
+  const size_t length = string->Length();
+  const bool one_byte = string->IsOneByte();
+  void* data = malloc(length == 0 ? 1 : length * (one_byte ? 1 : 2));
+  if (data == nullptr)
+    return false;
+
+  if (one_byte)
+    string->WriteOneByte(static_cast<uint8_t*>(data), 0, length, flags);
+  else
+    string->Write(static_cast<uint16_t*>(data), 0, length, flags);
+
+  free(data_);
+  data_ = data;
+  length_ = length;
+  one_byte_ = one_byte;
+  return true;
+}
+
+
+size_t StringBytes::Chars::StorageSize(enum encoding enc) const {
+  switch (enc) {
+    case UTF8:
+      // Every UTF-16 code unit takes up at most three bytes, a Latin-1
+      // character two.
+      return length_ * (one_byte_ ? 2 : 3);
+    case BASE64:
+      return base64_decoded_size_fast(length_);
+    case BINARY:
+      return length_;
+    default:
+      CHECK(0 && "unsupported encoding");
+      return 0;
+  }
+}
+
+
+static size_t latin1_to_utf8(const char* src, size_t len, char* dst) {
+  size_t k = 0;
+  for (size_t i = 0; i < len; i++) {
+    const uint8_t c = src[i];
+    if (c < 0x80) {
+      dst[k++] = c;
+    } else {
+      dst[k++] = 0xC0 | (c >> 6);
+      dst[k++] = 0x80 | (c & 0x3F);
+    }
+  }
+  return k;
+}
+
+
+// Like String::WriteUtf8() with REPLACE_INVALID_UTF8: unpaired surrogates
+// become U+FFFD.
+static size_t utf16_to_utf8(const uint16_t* src, size_t len, char* dst) {
+  size_t k = 0;
+  for (size_t i = 0; i < len; i++) {
+    uint32_t c = src[i];
+    if (c < 0x80) {
+      dst[k++] = c;
+      continue;
+    }
+    if (c < 0x800) {
+      dst[k++] = 0xC0 | (c >> 6);
+      dst[k++] = 0x80 | (c & 0x3F);
+      continue;
+    }
+    if (c >= 0xD800 && c <= 0xDFFF) {
+      if (c <= 0xDBFF && i + 1 < len &&
+          src[i + 1] >= 0xDC00 && src[i + 1] <= 0xDFFF) {
+        c = 0x10000 + ((c - 0xD800) << 10) + (src[++i] - 0xDC00);
+        dst[k++] = 0xF0 | (c >> 18);
+        dst[k++] = 0x80 | ((c >> 12) & 0x3F);
+        dst[k++] = 0x80 | ((c >> 6) & 0x3F);
+        dst[k++] = 0x80 | (c & 0x3F);
+        continue;
+      }
+      c = 0xFFFD;
+    }
+    dst[k++] = 0xE0 | (c >> 12);
+    dst[k++] = 0x80 | ((c >> 6) & 0x3F);
+    dst[k++] = 0x80 | (c & 0x3F);
+  }
+  return k;
+}
+
+
+size_t StringBytes::Chars::Write(char* buf,
+                                 size_t buflen,
+                                 enum encoding enc) const {
+  const char* latin1 = static_cast<const char*>(data_);
+  const uint16_t* utf16 = static_cast<const uint16_t*>(data_);
+
+  switch (enc) {
+    case UTF8:
+      CHECK_GE(buflen, StorageSize(UTF8));
+      return one_byte_ ? latin1_to_utf8(latin1, length_, buf)
+                       : utf16_to_utf8(utf16, length_, buf);
+    case BASE64:
+      return one_byte_ ? base64_decode(buf, buflen, latin1, length_)
+                       : base64_decode(buf, buflen, utf16, length_);
+    case BINARY: {
+      const size_t length = buflen < length_ ? buflen : length_;
+      if (one_byte_) {
+        memcpy(buf, latin1, length);
+      } else {
+        for (size_t i = 0; i < length; i++)
+          buf[i] = static_cast<char>(utf16[i]);
+      }
+      return length;
+    }
+    default:
+      CHECK(0 && "unsupported encoding");
+      return 0;
+  }
+}
+
+
+// The length of the UTF-8 sequence that |src| starts with, 0 if that isn't
+// well-formed: truncated, overlong, a surrogate or above U+10FFFF.
+static size_t utf8_sequence_length(const uint8_t* src, size_t len) {
+  const uint8_t c = src[0];
+  uint8_t lo = 0x80;
+  uint8_t hi = 0xBF;
+  size_t n;
+  if (c >= 0xC2 && c <= 0xDF) {
+    n = 2;
+  } else if (c >= 0xE0 && c <= 0xEF) {
+    n = 3;
+    if (c == 0xE0)
+      lo = 0xA0;
+    else if (c == 0xED)
+      hi = 0x9F;
+  } else if (c >= 0xF0 && c <= 0xF4) {
+    n = 4;
+    if (c == 0xF0)
+      lo = 0x90;
+    else if (c == 0xF4)
+      hi = 0x8F;
+  } else {
+    return 0;
+  }
+  if (n > len || src[1] < lo || src[1] > hi)
+    return 0;
+  for (size_t i = 2; i < n; i++) {
+    if ((src[i] & 0xC0) != 0x80)
+      return 0;
+  }
+  return n;
+}
+
+
+bool StringBytes::Chars::Encode(const char* buf,
+                                size_t buflen,
+                                enum encoding enc) {
+  const uint8_t* src = reinterpret_cast<const uint8_t*>(buf);
+  size_t length = 0;
+  bool one_byte = true;
+
+  switch (enc) {
+    case UTF8:
+      // Count the characters first, and find out whether they all fit in
+      // Latin-1.
+      for (size_t i = 0; i < buflen;) {
+        const size_t ascii = ascii_prefix_length(buf + i, buflen - i);
+        i += ascii;
+        length += ascii;
+        if (i == buflen)
+          break;
+        const size_t n = utf8_sequence_length(src + i, buflen - i);
+        if (n == 0)
+          return false;
+        one_byte = one_byte && n == 2 && src[i] <= 0xC3;
+        length += n == 4 ? 2 : 1;
+        i += n;
+      }
+      break;
+    case BASE64:
+      length = base64_encoded_size(buflen);
+      break;
+    case BINARY:
+      length = buflen;
+      break;
+    default:
+      CHECK(0 && "unsupported encoding");
+      return false;
+  }
+
+  if (length > static_cast<size_t>(String::kMaxLength))
+    return false;
+
+  void* data = malloc(length == 0 ? 1 : length * (one_byte ? 1 : 2));
+  if (data == nullptr)
+    return false;
+
+  if (enc == BASE64) {
+    base64_encode(buf, buflen, static_cast<char*>(data), length);
+  } else if (enc == BINARY) {
+    memcpy(data, buf, buflen);
+  } else if (one_byte) {
+    ssize_t outlen = utf8_to_latin1(buf, buflen, static_cast<char*>(data));
+    CHECK_EQ(static_cast<size_t>(outlen), length);
+  } else {
+    uint16_t* dst = static_cast<uint16_t*>(data);
+    size_t k = 0;
+    for (size_t i = 0; i < buflen;) {
+      const uint8_t c = src[i];
+      if (c < 0x80) {
+        dst[k++] = c;
+        i += 1;
+        continue;
+      }
+      const size_t n = utf8_sequence_length(src + i, buflen - i);
+      uint32_t cp = c & (0x7F >> n);
+      for (size_t j = 1; j < n; j++)
+        cp = (cp << 6) | (src[i + j] & 0x3F);
+      if (cp >= 0x10000) {
+        cp -= 0x10000;
+        dst[k++] = 0xD800 | (cp >> 10);
+        dst[k++] = 0xDC00 | (cp & 0x3FF);
+      } else {
+        dst[k++] = cp;
+      }
+      i += n;
+    }
+    CHECK_EQ(k, length);
+  }
+
+  free(data_);
+  data_ = data;
+  length_ = length;
+  one_byte_ = one_byte;
+  return true;
+}
+
+
+MaybeLocal<String> StringBytes::Chars::ToString(Isolate* isolate) {
+  void* data = data_;
+  const size_t length = length_;
+  data_ = nullptr;
+  length_ = 0;
+
+  if (length == 0 || length > static_cast<size_t>(String::kMaxLength)) {
+    free(data);
+    if (length == 0)
+      return String::Empty(isolate);
+    return MaybeLocal<String>();
+  }
+
+  Local<String> string;
+  if (length >= EXTERN_APEX) {
+    // The string owns the characters from here on, even if it can't be made.
+    if (one_byte_) {
+      string = ExternOneByteString::New(isolate,
+                                        static_cast<char*>(data),
+                                        length);
+    } else {
+      string = ExternTwoByteString::New(isolate,
+                                        static_cast<uint16_t*>(data),
+                                        length);
+    }
+    return string;
+  }
+
+  if (one_byte_) {
+    string = OneByteString(isolate, static_cast<char*>(data), length);
+  } else {
+    string = String::NewFromTwoByte(isolate,
+                                    static_cast<uint16_t*>(data),
+                                    String::kNormalString,
+                                    length);
+  }
+  free(data);
+  return string;
+}
+
 }  // namespace node
@@ -13,6 +13,9 @@ namespace node {
 
 class StringBytes {
  public:
+  // Shorter strings aren't worth a fast path for one-byte characters.
+  static const size_t kAsciiFastPathLength = 64;
+
   class InlineDecoder : public MaybeStackBuffer<char> {
    public:
     inline bool Decode(Environment* env,
@@ -96,6 +99,50 @@ class StringBytes {
                                      const char* buf,
                                      enum encoding encoding);
 
+  // True when none of the bytes has the high bit set, which makes their
+  // ASCII and Latin-1 decodings the same.
+  static bool IsAscii(const char* buf, size_t buflen);
+
+  // Like v8::String::Utf8Length() but a lot faster for long one-byte
+  // strings, which for the most part are ASCII.
+  static size_t Utf8Length(v8::Local<v8::String> str);
+
+  // The characters of a string outside of the V8 heap, as Latin-1 or UTF-16.
+  // Transcoding between them and bytes doesn't need the isolate, so it can
+  // run on the threadpool; only taking the characters out of a string and
+  // making a string of them have to happen on the main thread.  Supports the
+  // UTF8, BASE64 and BINARY encodings.
+  class Chars {
+   public:
+    Chars() : data_(nullptr), length_(0), one_byte_(true) {}
+    ~Chars() { free(data_); }
+
+    // Copies the characters of |string|, returns false when out of memory.
+    bool CopyFrom(v8::Local<v8::String> string);
+
+    // Like StringBytes::StorageSize() and StringBytes::Write().
+    size_t StorageSize(enum encoding enc) const;
+    size_t Write(char* buf, size_t buflen, enum encoding enc) const;
+
+    // Like StringBytes::Encode() but keeps the characters, returns false when
+    // a string can't be made of them: UTF-8 that isn't well-formed, which
+    // only V8's decoder knows how to replace, a result longer than
+    // v8::String::kMaxLength, or when out of memory.
+    bool Encode(const char* buf, size_t buflen, enum encoding enc);
+
+    // Creates a string that takes the characters over.
+    v8::MaybeLocal<v8::String> ToString(v8::Isolate* isolate);
+
+    inline size_t length() const { return length_; }
+
+   private:
+    void* data_;
+    size_t length_;
+    bool one_byte_;
+
+    DISALLOW_COPY_AND_ASSIGN(Chars);
+  };
+
  private:
   static size_t WriteUCS2(char* buf,
                           size_t buflen,
@@ -3,8 +3,6 @@
 namespace node {
 namespace stringsearch {
 
-int StringSearchBase::kBadCharShiftTable[kUC16AlphabetSize];
-int StringSearchBase::kGoodSuffixShiftTable[kBMMaxShift + 1];
-int StringSearchBase::kSuffixTable[kBMMaxShift + 1];
+StringSearchBase::Tables StringSearchBase::kSharedTables;
 }
 }  // namespace node::stringsearch
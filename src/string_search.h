@@ -8,6 +8,14 @@
 #include "node.h"
 #include <string.h>
 
+#if defined(__SSE2__) || defined(_M_X64)
+# include <emmintrin.h>
+# if defined(_MSC_VER)
+#  include <intrin.h>
+# endif
+# define STRING_SEARCH_SSE2 1
+#endif
+
 namespace node {
 namespace stringsearch {
 
@@ -82,20 +90,29 @@ class StringSearchBase {
   // to compensate for the algorithmic overhead compared to simple brute force.
   static const int kBMMinPatternLength = 8;
 
-  // Store for the BoyerMoore(Horspool) bad char shift table.
-  static int kBadCharShiftTable[kUC16AlphabetSize];
-  // Store for the BoyerMoore good suffix shift table.
-  static int kGoodSuffixShiftTable[kBMMaxShift + 1];
-  // Table used temporarily while building the BoyerMoore good suffix
-  // shift table.
-  static int kSuffixTable[kBMMaxShift + 1];
+ public:
+  // The Boyer-Moore(-Horspool) tables.  Single searches share one set of
+  // tables; a precompiled search owns its own, see StringSearch below.
+  struct Tables {
+    // Store for the BoyerMoore(Horspool) bad char shift table.
+    int bad_char_shift[kUC16AlphabetSize];
+    // Store for the BoyerMoore good suffix shift table.
+    int good_suffix_shift[kBMMaxShift + 1];
+    // Table used temporarily while building the BoyerMoore good suffix
+    // shift table.
+    int suffix[kBMMaxShift + 1];
+  };
+
+ protected:
+  static Tables kSharedTables;
 };
 
 template <typename Char>
 class StringSearch : private StringSearchBase {
  public:
   explicit StringSearch(Vector<const Char> pattern)
-      : pattern_(pattern), start_(0) {
+      : pattern_(pattern), tables_(&kSharedTables), precompiled_(false),
+        start_(0) {
     if (pattern.length() >= kBMMaxShift) {
       start_ = pattern.length() - kBMMaxShift;
     }
@@ -107,12 +124,27 @@ class StringSearch : private StringSearchBase {
         strategy_ = &SingleCharSearch;
         return;
       }
-      strategy_ = &LinearSearch;
+      strategy_ = pattern_.forward() ? &ShortPatternSearch : &LinearSearch;
       return;
     }
     strategy_ = &InitialSearch;
   }
 
+  // Precompiled search, for a pattern that is looked for in many subjects.
+  // The tables are built up front in |tables|, which must outlive the
+  // search object, instead of lazily in the shared tables on every search.
+  // |pattern| must outlive the search object as well.
+  StringSearch(Vector<const Char> pattern, Tables* tables)
+      : StringSearch(pattern) {
+    if (strategy_ != &InitialSearch)
+      return;
+    tables_ = tables;
+    precompiled_ = true;
+    PopulateBoyerMooreHorspoolTable();
+    PopulateBoyerMooreTable();
+    strategy_ = &BoyerMooreHorspoolSearch;
+  }
+
   size_t Search(Vector<const Char> subject, size_t index) {
     return strategy_(this, subject, index);
   }
@@ -151,6 +183,10 @@ class StringSearch : private StringSearchBase {
                              Vector<const Char> subject,
                              size_t start_index);
 
+  static size_t ShortPatternSearch(StringSearch<Char>* search,
+                                   Vector<const Char> subject,
+                                   size_t start_index);
+
   static size_t InitialSearch(StringSearch<Char>* search,
                               Vector<const Char> subject,
                               size_t start_index);
@@ -187,27 +223,31 @@ class StringSearch : private StringSearchBase {
   // Store for the BoyerMoore(Horspool) bad char shift table.
   // Return a table covering the last kBMMaxShift+1 positions of
   // pattern.
-  int* bad_char_table() { return kBadCharShiftTable; }
+  int* bad_char_table() { return tables_->bad_char_shift; }
 
   // Store for the BoyerMoore good suffix shift table.
   int* good_suffix_shift_table() {
     // Return biased pointer that maps the range  [start_..pattern_.length()
-    // to the kGoodSuffixShiftTable array.
-    return kGoodSuffixShiftTable - start_;
+    // to the good_suffix_shift array.
+    return tables_->good_suffix_shift - start_;
   }
 
   // Table used temporarily while building the BoyerMoore good suffix
   // shift table.
   int* suffix_table() {
     // Return biased pointer that maps the range  [start_..pattern_.length()
-    // to the kSuffixTable array.
-    return kSuffixTable - start_;
+    // to the suffix array.
+    return tables_->suffix - start_;
   }
 
   // The pattern to search for.
   Vector<const Char> pattern_;
   // Pointer to implementation of the search.
   SearchFunction strategy_;
+  // Where the Boyer-Moore(-Horspool) tables live.
+  Tables* tables_;
+  // True when the tables have been built up front.
+  bool precompiled_;
   // Cache value of Max(0, pattern_length() - kBMMaxShift)
   size_t start_;
 };
@@ -368,6 +408,70 @@ size_t StringSearch<Char>::LinearSearch(
   return subject.length();
 }
 
+//---------------------------------------------------------------------
+// Short Pattern Search Strategy
+//---------------------------------------------------------------------
+
+// Forward search for patterns that are too short for Boyer-Moore.  The
+// vectorized version below only exists for one-byte strings.
+template <typename Char>
+size_t StringSearch<Char>::ShortPatternSearch(
+    StringSearch<Char>* search,
+    Vector<const Char> subject,
+    size_t index) {
+  return LinearSearch(search, subject, index);
+}
+
+
+#if defined(STRING_SEARCH_SSE2)
+inline unsigned CountTrailingZeros(unsigned value) {
+#if defined(_MSC_VER)
+  unsigned long index;  // NOLINT(runtime/int)
+  _BitScanForward(&index, value);
+  return index;
+#else
+  return __builtin_ctz(value);
+#endif
+}
+
+
+// Compares the first and the last byte of the pattern against 16 candidate
+// positions at a time, and only looks at the rest of the pattern where both
+// match.  That filters out most positions even for very common first bytes,
+// like the '\r' in "\r\n".
+template <>
+inline size_t StringSearch<uint8_t>::ShortPatternSearch(
+    StringSearch<uint8_t>* search,
+    Vector<const uint8_t> subject,
+    size_t index) {
+  Vector<const uint8_t> pattern = search->pattern_;
+  const size_t pattern_length = pattern.length();
+  const uint8_t* const s = subject.start();
+  const uint8_t* const p = pattern.start();
+  const size_t n = subject.length();
+  const __m128i first = _mm_set1_epi8(static_cast<char>(p[0]));
+  const __m128i last = _mm_set1_epi8(static_cast<char>(p[pattern_length - 1]));
+
+  size_t i = index;
+  for (; i + pattern_length - 1 + 16 <= n; i += 16) {
+    const __m128i a =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i));
+    const __m128i b = _mm_loadu_si128(
+        reinterpret_cast<const __m128i*>(s + i + pattern_length - 1));
+    unsigned mask = _mm_movemask_epi8(
+        _mm_and_si128(_mm_cmpeq_epi8(a, first), _mm_cmpeq_epi8(b, last)));
+    while (mask != 0) {
+      const size_t pos = i + CountTrailingZeros(mask);
+      if (memcmp(s + pos + 1, p + 1, pattern_length - 2) == 0)
+        return pos;
+      mask &= mask - 1;
+    }
+  }
+
+  return LinearSearch(search, subject, i);
+}
+#endif
+
 //---------------------------------------------------------------------
 // Boyer-Moore string search
 //---------------------------------------------------------------------
@@ -540,7 +644,8 @@ size_t StringSearch<Char>::BoyerMooreHorspoolSearch(
     // compared to reading each character exactly once.
     badness += (pattern_length - j) - last_char_shift;
     if (badness > 0) {
-      search->PopulateBoyerMooreTable();
+      if (!search->precompiled_)
+        search->PopulateBoyerMooreTable();
       search->strategy_ = &BoyerMooreSearch;
       return BoyerMooreSearch(search, subject, index);
     }
@@ -13,9 +13,13 @@
 
 #include <stdlib.h>
 
+#include <algorithm>
+#include <vector>
+
 
 namespace node {
 
+using v8::Array;
 using v8::Boolean;
 using v8::Context;
 using v8::EscapableHandleScope;
@@ -81,6 +85,9 @@ void TCPWrap::Initialize(Local<Object> target,
   t->InstanceTemplate()->Set(String::NewFromUtf8(env->isolate(),
                                                  "onconnection"),
                              Null(env->isolate()));
+  t->InstanceTemplate()->Set(String::NewFromUtf8(env->isolate(),
+                                                 "onconnections"),
+                             Null(env->isolate()));
 
 
   env->SetProtoMethod(t, "close", HandleWrap::Close);
@@ -103,6 +110,10 @@ void TCPWrap::Initialize(Local<Object> target,
                       GetSockOrPeerName<TCPWrap, uv_tcp_getpeername>);
   env->SetProtoMethod(t, "setNoDelay", SetNoDelay);
   env->SetProtoMethod(t, "setKeepAlive", SetKeepAlive);
+  env->SetProtoMethod(t, "setBusyPoll", SetBusyPoll);
+  env->SetProtoMethod(t, "setAcceptBatch", SetAcceptBatch);
+  env->SetProtoMethod(t, "spliceStart", SpliceStart);
+  env->SetProtoMethod(t, "spliceStop", SpliceStop);
 
 #ifdef _WIN32
   env->SetProtoMethod(t, "setSimultaneousAccepts", SetSimultaneousAccepts);
@@ -150,7 +161,8 @@ TCPWrap::TCPWrap(Environment* env, Local<Object> object, AsyncWrap* parent)
                  object,
                  reinterpret_cast<uv_stream_t*>(&handle_),
                  AsyncWrap::PROVIDER_TCPWRAP,
-                 parent) {
+                 parent),
+      accept_batch_size_(0) {
   int r = uv_tcp_init(env->event_loop(), &handle_);
   CHECK_EQ(r, 0);  // How do we proxy this error up to javascript?
                    // Suggestion: uv_tcp_init() returns void.
@@ -160,6 +172,9 @@ TCPWrap::TCPWrap(Environment* env, Local<Object> object, AsyncWrap* parent)
 
 TCPWrap::~TCPWrap() {
   CHECK(persistent().IsEmpty());
+  std::vector<TCPWrap*>* servers = env()->accept_batch_servers();
+  servers->erase(std::remove(servers->begin(), servers->end(), this),
+                 servers->end());
 }
 
 
@@ -180,6 +195,14 @@ void TCPWrap::SetKeepAlive(const FunctionCallbackInfo<Value>& args) {
 }
 
 
+void TCPWrap::SetBusyPoll(const FunctionCallbackInfo<Value>& args) {
+  TCPWrap* wrap = Unwrap<TCPWrap>(args.Holder());
+  unsigned int usecs = args[0]->Uint32Value();
+  int err = uv_tcp_busy_poll(&wrap->handle_, usecs);
+  args.GetReturnValue().Set(err);
+}
+
+
 #ifdef _WIN32
 void TCPWrap::SetSimultaneousAccepts(const FunctionCallbackInfo<Value>& args) {
   TCPWrap* wrap = Unwrap<TCPWrap>(args.Holder());
@@ -201,12 +224,14 @@ void TCPWrap::Bind(const FunctionCallbackInfo<Value>& args) {
   TCPWrap* wrap = Unwrap<TCPWrap>(args.Holder());
   node::Utf8Value ip_address(args.GetIsolate(), args[0]);
   int port = args[1]->Int32Value();
+  // The third argument is the reusePort flag, see net.js.
+  unsigned int flags = args[2]->IsTrue() ? UV_TCP_REUSEPORT : 0;
   sockaddr_in addr;
   int err = uv_ip4_addr(*ip_address, port, &addr);
   if (err == 0) {
     err = uv_tcp_bind(&wrap->handle_,
                       reinterpret_cast<const sockaddr*>(&addr),
-                      0);
+                      flags);
   }
   args.GetReturnValue().Set(err);
 }
@@ -216,17 +241,79 @@ void TCPWrap::Bind6(const FunctionCallbackInfo<Value>& args) {
   TCPWrap* wrap = Unwrap<TCPWrap>(args.Holder());
   node::Utf8Value ip6_address(args.GetIsolate(), args[0]);
   int port = args[1]->Int32Value();
+  unsigned int flags = args[2]->IsTrue() ? UV_TCP_REUSEPORT : 0;
   sockaddr_in6 addr;
   int err = uv_ip6_addr(*ip6_address, port, &addr);
   if (err == 0) {
     err = uv_tcp_bind(&wrap->handle_,
                       reinterpret_cast<const sockaddr*>(&addr),
-                      0);
+                      flags);
   }
   args.GetReturnValue().Set(err);
 }
 
 
+// 0 and 1 deliver every connection separately, to onconnection().
+void TCPWrap::SetAcceptBatch(const FunctionCallbackInfo<Value>& args) {
+  TCPWrap* wrap = Unwrap<TCPWrap>(args.Holder());
+  CHECK(args[0]->IsUint32());
+  wrap->FlushAcceptBatch();
+  const uint32_t size = args[0]->Uint32Value();
+  wrap->accept_batch_size_ = size > 1 ? size : 0;
+}
+
+
+// handle.spliceStart(sink) hands the reading over to uv_splice_start(), the
+// data then goes from the handle to the sink TCP handle without leaving the
+// kernel. onsplice(status, writeFailed) is called when the splice is over.
+// The handle is left not reading when this fails.
+void TCPWrap::SpliceStart(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  TCPWrap* wrap = Unwrap<TCPWrap>(args.Holder());
+  CHECK(env->tcp_constructor_template()->HasInstance(args[0]));
+  TCPWrap* sink = Unwrap<TCPWrap>(args[0].As<Object>());
+  if (sink == nullptr)
+    return args.GetReturnValue().Set(UV_EBADF);
+
+  wrap->ReadStop();
+  int err = uv_splice_start(wrap->stream(), sink->stream(), OnSplice);
+  args.GetReturnValue().Set(err);
+}
+
+
+// Data that has been read already still goes to the sink.
+void TCPWrap::SpliceStop(const FunctionCallbackInfo<Value>& args) {
+  TCPWrap* wrap = Unwrap<TCPWrap>(args.Holder());
+  int err = uv_splice_stop(wrap->stream());
+  args.GetReturnValue().Set(err);
+}
+
+
+void TCPWrap::OnSplice(uv_stream_t* handle,
+                       int read_status,
+                       int write_status) {
+  TCPWrap* wrap = static_cast<TCPWrap*>(handle->data);
+  Environment* env = wrap->env();
+
+  HandleScope handle_scope(env->isolate());
+  Context::Scope context_scope(env->context());
+
+  // Let the socket see the EOF or the error like it would have without the
+  // splice, before JS hears about the end of it.
+  if (read_status != 0) {
+    uv_buf_t empty = uv_buf_init(nullptr, 0);
+    static_cast<StreamBase*>(wrap)->OnRead(read_status, &empty);
+  }
+
+  int status = read_status != 0 ? read_status : write_status;
+  Local<Value> argv[] = {
+    Integer::New(env->isolate(), status == UV_EOF ? 0 : status),
+    Boolean::New(env->isolate(), write_status != 0)
+  };
+  wrap->MakeCallback(env->onsplice_string(), arraysize(argv), argv);
+}
+
+
 void TCPWrap::Listen(const FunctionCallbackInfo<Value>& args) {
   TCPWrap* wrap = Unwrap<TCPWrap>(args.Holder());
   int backlog = args[0]->Int32Value();
@@ -265,14 +352,69 @@ void TCPWrap::OnConnection(uv_stream_t* handle, int status) {
     if (uv_accept(handle, client_handle))
       return;
 
+    if (tcp_wrap->accept_batch_size_ > 0) {
+      tcp_wrap->AddToAcceptBatch(wrap);
+      return;
+    }
+
     // Successful accept. Call the onconnection callback in JavaScript land.
     argv[1] = client_obj;
+  } else {
+    // Keep the connections in the order in which they were accepted.
+    tcp_wrap->FlushAcceptBatch();
   }
 
   tcp_wrap->MakeCallback(env->onconnection_string(), arraysize(argv), argv);
 }
 
 
+void TCPWrap::AddToAcceptBatch(TCPWrap* client) {
+  accepted_.push_back(client);
+
+  if (accepted_.size() >= accept_batch_size_) {
+    FlushAcceptBatch();
+    return;
+  }
+
+  if (accepted_.size() == 1) {
+    env()->accept_batch_servers()->push_back(this);
+    uv_check_start(env()->accept_batch_check_handle(), OnAcceptBatchCheck);
+  }
+}
+
+
+void TCPWrap::FlushAcceptBatch() {
+  if (accepted_.empty())
+    return;
+
+  Environment* env = this->env();
+  HandleScope handle_scope(env->isolate());
+  Context::Scope context_scope(env->context());
+
+  Local<Array> clients = Array::New(env->isolate(), accepted_.size());
+  for (size_t i = 0; i < accepted_.size(); i++)
+    clients->Set(i, accepted_[i]->object());
+  accepted_.clear();
+
+  Local<Value> argv[] = {
+    Integer::New(env->isolate(), 0),
+    clients
+  };
+  MakeCallback(env->onconnections_string(), arraysize(argv), argv);
+}
+
+
+void TCPWrap::OnAcceptBatchCheck(uv_check_t* handle) {
+  Environment* env = Environment::from_accept_batch_check_handle(handle);
+  uv_check_stop(handle);
+
+  std::vector<TCPWrap*> servers;
+  servers.swap(*env->accept_batch_servers());
+  for (TCPWrap* server : servers)
+    server->FlushAcceptBatch();
+}
+
+
 void TCPWrap::AfterConnect(uv_connect_t* req, int status) {
   TCPConnectWrap* req_wrap = static_cast<TCPConnectWrap*>(req->data);
   TCPWrap* wrap = static_cast<TCPWrap*>(req->handle->data);
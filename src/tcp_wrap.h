@@ -5,6 +5,8 @@
 #include "env.h"
 #include "stream_wrap.h"
 
+#include <vector>
+
 namespace node {
 
 class TCPWrap : public StreamWrap {
@@ -31,12 +33,16 @@ class TCPWrap : public StreamWrap {
   static void New(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void SetNoDelay(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void SetKeepAlive(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void SetBusyPoll(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void Bind(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void Bind6(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void Listen(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void Connect(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void Connect6(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void Open(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void SetAcceptBatch(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void SpliceStart(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void SpliceStop(const v8::FunctionCallbackInfo<v8::Value>& args);
 
 #ifdef _WIN32
   static void SetSimultaneousAccepts(
@@ -45,8 +51,18 @@ class TCPWrap : public StreamWrap {
 
   static void OnConnection(uv_stream_t* handle, int status);
   static void AfterConnect(uv_connect_t* req, int status);
+  static void OnSplice(uv_stream_t* handle, int read_status, int write_status);
+
+  // With an accept batch size, the connections that are accepted in the poll
+  // phase are passed to onconnections() in one call, from the check phase
+  // or as soon as there are accept_batch_size_ of them.
+  void AddToAcceptBatch(TCPWrap* client);
+  void FlushAcceptBatch();
+  static void OnAcceptBatchCheck(uv_check_t* handle);
 
   uv_tcp_t handle_;
+  size_t accept_batch_size_;
+  std::vector<TCPWrap*> accepted_;
 };
 
 
@@ -1,8 +1,10 @@
+#include "timer_wrap.h"
 #include "async-wrap.h"
 #include "async-wrap-inl.h"
 #include "env.h"
 #include "env-inl.h"
 #include "handle_wrap.h"
+#include "node_dtrace.h"
 #include "util.h"
 #include "util-inl.h"
 
@@ -10,7 +12,9 @@
 
 namespace node {
 
+using v8::ArrayBuffer;
 using v8::Context;
+using v8::Float64Array;
 using v8::Function;
 using v8::FunctionCallbackInfo;
 using v8::FunctionTemplate;
@@ -21,6 +25,261 @@ using v8::Object;
 using v8::Value;
 
 const uint32_t kOnTimeout = 0;
+static const uint64_t kNever = ~static_cast<uint64_t>(0);
+
+
+IdleTimeout::IdleTimeout(Callback cb, void* ctx)
+    : wheel_(nullptr),
+      timeout_(0),
+      last_active_(0),
+      level_(0),
+      slot_(0),
+      fired_(false),
+      cb_(cb),
+      ctx_(ctx) {
+}
+
+
+IdleTimeout::~IdleTimeout() {
+  Stop();
+}
+
+
+void IdleTimeout::Start(TimerWheel* wheel, uint64_t timeout) {
+  Stop();
+  if (timeout == 0)
+    return;
+
+  wheel_ = wheel;
+  timeout_ = timeout;
+  last_active_ = wheel->now();
+  fired_ = false;
+  wheel->Add(this, last_active_ + timeout);
+}
+
+
+void IdleTimeout::Stop() {
+  if (wheel_ == nullptr)
+    return;
+  wheel_->Remove(this);
+  wheel_ = nullptr;
+}
+
+
+void IdleTimeout::Rearm() {
+  wheel_node_.Remove();
+  fired_ = false;
+  wheel_->Add(this, last_active_ + timeout_);
+}
+
+
+static inline unsigned int CountTrailingZeros(uint64_t value) {
+#if defined(_MSC_VER)
+  unsigned long index;  // NOLINT(runtime/int)
+#if defined(_M_X64)
+  _BitScanForward64(&index, value);
+#else
+  if (_BitScanForward(&index, static_cast<uint32_t>(value)) == 0) {
+    _BitScanForward(&index, static_cast<uint32_t>(value >> 32));
+    index += 32;
+  }
+#endif
+  return index;
+#else
+  return __builtin_ctzll(value);
+#endif
+}
+
+
+TimerWheel::TimerWheel(Environment* env)
+    : loop_(env->event_loop()),
+      current_(uv_now(loop_)),
+      scheduled_(kNever) {
+  for (unsigned int level = 0; level < kLevels; level++)
+    occupied_[level] = 0;
+
+  CHECK_EQ(0, uv_timer_init(loop_, &timer_));
+  uv_unref(reinterpret_cast<uv_handle_t*>(&timer_));
+  env->RegisterHandleCleanup(reinterpret_cast<uv_handle_t*>(&timer_),
+                             OnClose,
+                             nullptr);
+}
+
+
+TimerWheel::~TimerWheel() {
+  // The handles can outlive the wheel, detach their timeouts.
+  for (unsigned int level = 0; level < kLevels; level++) {
+    for (unsigned int slot = 0; slot < kSlots; slot++) {
+      while (IdleTimeout* timeout = slots_[level][slot].PopFront())
+        timeout->wheel_ = nullptr;
+    }
+  }
+  while (IdleTimeout* timeout = fired_list_.PopFront())
+    timeout->wheel_ = nullptr;
+}
+
+
+void TimerWheel::Add(IdleTimeout* timeout, uint64_t expiry) {
+  if (NextTick() == kNever) {
+    // Nothing to keep in order, catch up with the loop.
+    current_ = now();
+  }
+  Insert(timeout, expiry);
+  Schedule();
+}
+
+
+void TimerWheel::Insert(IdleTimeout* timeout, uint64_t expiry) {
+  if (expiry < current_)
+    expiry = current_;
+
+  // Timeouts beyond the range of the wheel are filed in its last slot and
+  // filed again when that comes up.
+  const uint64_t range = static_cast<uint64_t>(1) << (kSlotBits * kLevels);
+  uint64_t delta = expiry - current_;
+  if (delta >= range) {
+    delta = range - 1;
+    expiry = current_ + delta;
+  }
+
+  unsigned int level = 0;
+  while (delta >= static_cast<uint64_t>(1) << (kSlotBits * (level + 1)))
+    level++;
+
+  unsigned int slot = (expiry >> (kSlotBits * level)) & (kSlots - 1);
+  timeout->level_ = level;
+  timeout->slot_ = slot;
+  slots_[level][slot].PushBack(timeout);
+  occupied_[level] |= static_cast<uint64_t>(1) << slot;
+}
+
+
+void TimerWheel::Remove(IdleTimeout* timeout) {
+  timeout->wheel_node_.Remove();
+  if (timeout->fired_)
+    return;
+
+  unsigned int level = timeout->level_;
+  unsigned int slot = timeout->slot_;
+  if (slots_[level][slot].IsEmpty())
+    occupied_[level] &= ~(static_cast<uint64_t>(1) << slot);
+}
+
+
+uint64_t TimerWheel::NextTick() const {
+  uint64_t next = kNever;
+
+  for (unsigned int level = 0; level < kLevels; level++) {
+    uint64_t occupied = occupied_[level];
+    if (occupied == 0)
+      continue;
+
+    // Rotate the bitmap so that bit 0 is the slot after the current one.
+    const unsigned int shift = kSlotBits * level;
+    const uint64_t block = current_ >> shift;
+    const unsigned int start = (block + 1) & (kSlots - 1);
+    if (start != 0)
+      occupied = (occupied >> start) | (occupied << (kSlots - start));
+
+    const uint64_t tick = (block + 1 + CountTrailingZeros(occupied)) << shift;
+    if (tick < next)
+      next = tick;
+  }
+
+  return next;
+}
+
+
+void TimerWheel::Cascade(unsigned int level) {
+  const unsigned int slot = (current_ >> (kSlotBits * level)) & (kSlots - 1);
+  Slot timeouts;
+  slots_[level][slot].MoveBack(&timeouts);
+  occupied_[level] &= ~(static_cast<uint64_t>(1) << slot);
+
+  while (IdleTimeout* timeout = timeouts.PopFront())
+    Insert(timeout, timeout->last_active_ + timeout->timeout_);
+}
+
+
+void TimerWheel::Advance(uint64_t now, Slot* expired) {
+  for (;;) {
+    const uint64_t next = NextTick();
+    if (next > now) {
+      current_ = now;
+      return;
+    }
+    current_ = next;
+
+    // Move the timeouts in the slots that start now one level down, from the
+    // top so that they end up in the right slot.
+    for (unsigned int level = kLevels - 1; level > 0; level--) {
+      const uint64_t mask =
+          (static_cast<uint64_t>(1) << (kSlotBits * level)) - 1;
+      if ((current_ & mask) == 0)
+        Cascade(level);
+    }
+
+    const unsigned int slot = current_ & (kSlots - 1);
+    Slot timeouts;
+    slots_[0][slot].MoveBack(&timeouts);
+    occupied_[0] &= ~(static_cast<uint64_t>(1) << slot);
+
+    while (IdleTimeout* timeout = timeouts.PopFront()) {
+      const uint64_t deadline = timeout->last_active_ + timeout->timeout_;
+      if (deadline > current_) {
+        // Touched since it was filed.
+        Insert(timeout, deadline);
+      } else {
+        timeout->fired_ = true;
+        expired->PushBack(timeout);
+      }
+    }
+  }
+}
+
+
+void TimerWheel::Schedule() {
+  const uint64_t next = NextTick();
+  if (next == kNever) {
+    if (scheduled_ != kNever)
+      uv_timer_stop(&timer_);
+    scheduled_ = kNever;
+    return;
+  }
+
+  if (next >= scheduled_)
+    return;
+
+  const uint64_t now = this->now();
+  scheduled_ = next;
+  uv_timer_start(&timer_, OnTimeout, next > now ? next - now : 0, 0);
+}
+
+
+void TimerWheel::OnTimeout(uv_timer_t* handle) {
+  TimerWheel* wheel = ContainerOf(&TimerWheel::timer_, handle);
+  Slot expired;
+
+  wheel->scheduled_ = kNever;
+  wheel->Advance(wheel->now(), &expired);
+  wheel->Schedule();
+
+  // The callbacks can stop and start any of the timeouts, including the ones
+  // that are still waiting in |expired|.
+  while (IdleTimeout* timeout = expired.PopFront()) {
+    wheel->fired_list_.PushBack(timeout);
+    timeout->cb_(timeout, timeout->ctx_);
+  }
+}
+
+
+void TimerWheel::OnClose(Environment* env, uv_handle_t* handle, void* arg) {
+  handle->data = env;
+  uv_close(handle, [](uv_handle_t* handle) {
+    static_cast<Environment*>(handle->data)->FinishHandleCleanup(handle);
+  });
+}
+
 
 class TimerWrap : public HandleWrap {
  public:
@@ -46,6 +305,16 @@ class TimerWrap : public HandleWrap {
 
     target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "Timer"),
                 constructor->GetFunction());
+
+    // The loop time as of the last call into JS, see Environment::TimerInfo.
+    double* const fields = env->timer_info()->fields();
+    int const fields_count = env->timer_info()->fields_count();
+    Local<ArrayBuffer> array_buffer =
+        ArrayBuffer::New(env->isolate(),
+                         fields,
+                         sizeof(*fields) * fields_count);
+    target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "timerInfo"),
+                Float64Array::New(array_buffer, 0, fields_count));
   }
 
   size_t self_size() const override { return sizeof(*this); }
@@ -94,12 +363,15 @@ class TimerWrap : public HandleWrap {
     Environment* env = wrap->env();
     HandleScope handle_scope(env->isolate());
     Context::Scope context_scope(env->context());
+    if (NODE_TIMER_FIRE_ENABLED())
+      NODE_TIMER_FIRE(wrap);
     wrap->MakeCallback(kOnTimeout, 0, nullptr);
   }
 
   static void Now(const FunctionCallbackInfo<Value>& args) {
     Environment* env = Environment::GetCurrent(args);
     uv_update_time(env->event_loop());
+    env->UpdateTimerInfo();
     uint64_t now = uv_now(env->event_loop());
     CHECK(now >= env->timer_base());
     now -= env->timer_base();
@@ -0,0 +1,106 @@
+#ifndef SRC_TIMER_WRAP_H_
+#define SRC_TIMER_WRAP_H_
+
+#include "util.h"
+#include "uv.h"
+
+#include <stdint.h>
+
+namespace node {
+
+class Environment;
+class TimerWheel;
+
+// An idle timeout that fires when it hasn't been touched for |timeout|
+// milliseconds.  Touch() only records the current loop time, the wheel
+// notices that the timeout was pushed back when its slot comes up and files
+// it again.  Once it has fired, the next Touch() arms it again, like the
+// timers that lib/timers.js re-inserts through _unrefActive().
+class IdleTimeout {
+ public:
+  typedef void (*Callback)(IdleTimeout* timeout, void* ctx);
+
+  IdleTimeout(Callback cb, void* ctx);
+  ~IdleTimeout();
+
+  // A |timeout| of 0 stops the timer.
+  void Start(TimerWheel* wheel, uint64_t timeout);
+  void Stop();
+
+  inline void Touch();
+  inline bool IsActive() const { return wheel_ != nullptr; }
+
+ private:
+  friend class TimerWheel;
+
+  void Rearm();
+
+  TimerWheel* wheel_;
+  uint64_t timeout_;
+  uint64_t last_active_;
+  unsigned int level_;
+  unsigned int slot_;
+  bool fired_;
+  Callback cb_;
+  void* ctx_;
+  ListNode<IdleTimeout> wheel_node_;
+
+  DISALLOW_COPY_AND_ASSIGN(IdleTimeout);
+};
+
+// A hierarchical timer wheel with millisecond ticks, kLevels levels of
+// kSlots slots each, that keeps the idle timeouts of the StreamBase handles
+// of an Environment.  Filing and removing a timeout is O(1), a single
+// uv_timer_t wakes the loop up when the next slot is due.
+class TimerWheel {
+ public:
+  static const unsigned int kSlotBits = 6;
+  static const unsigned int kSlots = 1 << kSlotBits;
+  static const unsigned int kLevels = 5;
+
+  explicit TimerWheel(Environment* env);
+  ~TimerWheel();
+
+  inline uint64_t now() const { return uv_now(loop_); }
+
+ private:
+  friend class IdleTimeout;
+
+  typedef ListHead<IdleTimeout, &IdleTimeout::wheel_node_> Slot;
+
+  // Files a timeout that is started or armed again and reschedules.
+  void Add(IdleTimeout* timeout, uint64_t expiry);
+  void Insert(IdleTimeout* timeout, uint64_t expiry);
+  void Remove(IdleTimeout* timeout);
+  // Returns the first tick after |current_| at which a slot is due.
+  uint64_t NextTick() const;
+  void Advance(uint64_t now, Slot* expired);
+  void Cascade(unsigned int level);
+  void Schedule();
+
+  static void OnTimeout(uv_timer_t* handle);
+  static void OnClose(Environment* env, uv_handle_t* handle, void* arg);
+
+  uv_loop_t* const loop_;
+  uv_timer_t timer_;
+  uint64_t current_;
+  uint64_t scheduled_;
+  uint64_t occupied_[kLevels];
+  Slot slots_[kLevels][kSlots];
+  // Timeouts that have fired and wait for their next Touch().
+  Slot fired_list_;
+
+  DISALLOW_COPY_AND_ASSIGN(TimerWheel);
+};
+
+void IdleTimeout::Touch() {
+  if (wheel_ == nullptr)
+    return;
+  last_active_ = wheel_->now();
+  if (fired_)
+    Rearm();
+}
+
+}  // namespace node
+
+#endif  // SRC_TIMER_WRAP_H_
@@ -13,6 +13,26 @@
 #include "util.h"
 #include "util-inl.h"
 
+#include <openssl/hmac.h>
+
+#ifdef __linux__
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+
+// From <linux/tls.h>, which older kernel headers don't have.
+#ifndef TCP_ULP
+#define TCP_ULP 31
+#endif
+#ifndef SOL_TLS
+#define SOL_TLS 282
+#endif
+#define NODE_KTLS_TX 1
+#define NODE_KTLS_VERSION_1_2 0x0303
+#define NODE_KTLS_CIPHER_AES_GCM_128 51
+#define NODE_KTLS_CIPHER_AES_GCM_256 52
+#endif  // __linux__
+
 namespace node {
 
 using crypto::SecureContext;
@@ -24,6 +44,7 @@ using v8::Exception;
 using v8::Function;
 using v8::FunctionCallbackInfo;
 using v8::FunctionTemplate;
+using v8::HandleScope;
 using v8::Local;
 using v8::Object;
 using v8::String;
@@ -50,6 +71,17 @@ TLSWrap::TLSWrap(Environment* env,
       shutdown_(false),
       error_(nullptr),
       cycle_depth_(0),
+      adaptive_record_size_(false),
+      record_bytes_written_(0),
+      last_record_time_(0),
+      async_handshake_(false),
+      destroy_pending_(false),
+      handshake_where_(0),
+      handshake_error_(nullptr),
+      handshake_backlog_(nullptr),
+      handshake_backlog_status_(0),
+      kernel_tls_(false),
+      kernel_tls_tx_(false),
       eof_(false) {
   node::Wrap(object(), this);
   MakeWeak(this);
@@ -75,6 +107,10 @@ TLSWrap::~TLSWrap() {
   enc_out_ = nullptr;
   delete clear_in_;
   clear_in_ = nullptr;
+  delete handshake_backlog_;
+  handshake_backlog_ = nullptr;
+  delete[] handshake_error_;
+  handshake_error_ = nullptr;
 
   sc_ = nullptr;
 
@@ -234,6 +270,13 @@ void TLSWrap::SSLInfoCallback(const SSL* ssl_, int where, int ret) {
   // a non-const SSL* in OpenSSL <= 0.9.7e.
   SSL* ssl = const_cast<SSL*>(ssl_);
   TLSWrap* c = static_cast<TLSWrap*>(SSL_get_app_data(ssl));
+
+  // Reported by AfterHandshakeWork
+  if (c->handshake_offloaded_) {
+    c->handshake_where_ |= where;
+    return;
+  }
+
   Environment* env = c->env();
   Local<Object> object = c->object();
 
@@ -267,6 +310,10 @@ void TLSWrap::EncOut() {
   if (is_waiting_new_session())
     return;
 
+  // enc_out_ is filled by the threadpool
+  if (handshake_offloaded_)
+    return;
+
   // Split-off queue
   if (established_ && !write_item_queue_.IsEmpty())
     MakePending();
@@ -274,10 +321,26 @@ void TLSWrap::EncOut() {
   if (ssl_ == nullptr)
     return;
 
+  // The kernel owns the write sequence, the records that OpenSSL produced
+  // since can't be sent.
+  if (kernel_tls_tx_ && BIO_pending(enc_out_) != 0) {
+    NodeBIO::FromBIO(enc_out_)->Reset();
+    if (!shutdown_) {
+      HandleScope handle_scope(env()->isolate());
+      Local<Value> arg = Exception::Error(FIXED_ONE_BYTE_STRING(
+          env()->isolate(),
+          "Renegotiation and alerts are not supported with kernel TLS"));
+      MakeCallback(env()->onerror_string(), 1, &arg);
+    }
+    return;
+  }
+
   // No data to write
   if (BIO_pending(enc_out_) == 0) {
-    if (clear_in_->Length() == 0)
+    if (clear_in_->Length() == 0) {
       InvokeQueued(0);
+      MaybeEnableKernelTLS();
+    }
     return;
   }
 
@@ -397,9 +460,12 @@ void TLSWrap::ClearOut() {
   if (eof_)
     return;
 
-  if (ssl_ == nullptr)
+  if (ssl_ == nullptr || handshake_offloaded_)
     return;
 
+  if (CanOffloadHandshake())
+    return OffloadHandshake();
+
   crypto::MarkPopErrorOnReturn mark_pop_error_on_return;
 
   char out[kClearOutChunkSize];
@@ -460,7 +526,7 @@ bool TLSWrap::ClearIn() {
   if (!hello_parser_.IsEnded())
     return false;
 
-  if (ssl_ == nullptr)
+  if (ssl_ == nullptr || handshake_offloaded_)
     return false;
 
   crypto::MarkPopErrorOnReturn mark_pop_error_on_return;
@@ -469,10 +535,14 @@ bool TLSWrap::ClearIn() {
   while (clear_in_->Length() > 0) {
     size_t avail = 0;
     char* data = clear_in_->Peek(&avail);
+    size_t record_size = RecordSize();
+    if (avail > record_size)
+      avail = record_size;
     written = SSL_write(ssl_, data, avail);
     CHECK(written == -1 || written == static_cast<int>(avail));
     if (written == -1)
       break;
+    RecordWritten(avail);
     clear_in_->Read(nullptr, avail);
   }
 
@@ -555,6 +625,18 @@ int TLSWrap::DoWrite(WriteWrap* w,
   CHECK_EQ(send_handle, nullptr);
   CHECK_NE(ssl_, nullptr);
 
+  if (kernel_tls_tx_)
+    return stream_->DoWrite(w, bufs, count, send_handle);
+
+  // The handshake owns `ssl_`, data is written once it is back
+  if (handshake_offloaded_) {
+    write_item_queue_.PushBack(new WriteItem(w));
+    w->Dispatched();
+    for (size_t i = 0; i < count; i++)
+      clear_in_->Write(bufs[i].base, bufs[i].len);
+    return 0;
+  }
+
   bool empty = true;
 
   // Empty writes should not go through encryption process
@@ -602,12 +684,41 @@ int TLSWrap::DoWrite(WriteWrap* w,
 
   crypto::MarkPopErrorOnReturn mark_pop_error_on_return;
 
+  // Every SSL_write() produces at least one record.  Gather small buffers
+  // into full size records instead of sending each one in its own record and
+  // split buffers that don't fit in one.  `i` and `offset` only advance past
+  // the data of a record once it has been written.
+  char record[kMaxRecordSize];
   int written = 0;
-  for (i = 0; i < count; i++) {
-    written = SSL_write(ssl_, bufs[i].base, bufs[i].len);
-    CHECK(written == -1 || written == static_cast<int>(bufs[i].len));
+  size_t offset = 0;
+  i = 0;
+  while (i < count) {
+    const size_t record_size = RecordSize();
+    const char* data = bufs[i].base + offset;
+    size_t len = bufs[i].len - offset;
+    size_t next = i + 1;
+    size_t next_offset = 0;
+
+    if (len > record_size) {
+      len = record_size;
+      next = i;
+      next_offset = offset + len;
+    } else if (next < count && len + bufs[next].len <= record_size) {
+      memcpy(record, data, len);
+      for (; next < count && len + bufs[next].len <= record_size; next++) {
+        memcpy(record + len, bufs[next].base, bufs[next].len);
+        len += bufs[next].len;
+      }
+      data = record;
+    }
+
+    written = SSL_write(ssl_, data, len);
+    CHECK(written == -1 || written == static_cast<int>(len));
     if (written == -1)
       break;
+    RecordWritten(len);
+    i = next;
+    offset = next_offset;
   }
 
   if (i != count) {
@@ -617,7 +728,8 @@ int TLSWrap::DoWrite(WriteWrap* w,
       return UV_EPROTO;
 
     // No errors, queue rest
-    for (; i < count; i++)
+    clear_in_->Write(bufs[i].base + offset, bufs[i].len - offset);
+    for (i++; i < count; i++)
       clear_in_->Write(bufs[i].base, bufs[i].len);
   }
 
@@ -641,8 +753,17 @@ void TLSWrap::OnAllocImpl(size_t suggested_size, uv_buf_t* buf, void* ctx) {
     return;
   }
 
+  NodeBIO* bio = NodeBIO::FromBIO(wrap->enc_in_);
+  if (wrap->handshake_offloaded_) {
+    if (wrap->handshake_backlog_ == nullptr) {
+      wrap->handshake_backlog_ = new NodeBIO();
+      wrap->handshake_backlog_->AssignEnvironment(wrap->env());
+    }
+    bio = wrap->handshake_backlog_;
+  }
+
   size_t size = 0;
-  buf->base = NodeBIO::FromBIO(wrap->enc_in_)->PeekWritable(&size);
+  buf->base = bio->PeekWritable(&size);
   buf->len = size;
 }
 
@@ -678,6 +799,15 @@ void TLSWrap::OnReadSelf(ssize_t nread,
 void TLSWrap::DoRead(ssize_t nread,
                      const uv_buf_t* buf,
                      uv_handle_type pending) {
+  // Keep everything for AfterHandshakeWork, `enc_in_` is in use
+  if (handshake_offloaded_) {
+    if (nread < 0)
+      handshake_backlog_status_ = nread;
+    else
+      handshake_backlog_->Commit(nread);
+    return;
+  }
+
   if (nread < 0)  {
     // Error should be emitted only after all data was read
     ClearOut();
@@ -719,8 +849,11 @@ void TLSWrap::DoRead(ssize_t nread,
 int TLSWrap::DoShutdown(ShutdownWrap* req_wrap) {
   crypto::MarkPopErrorOnReturn mark_pop_error_on_return;
 
-  if (ssl_ != nullptr && SSL_shutdown(ssl_) == 0)
+  // With kernel TLS, OpenSSL would encrypt close_notify with the wrong keys
+  if (ssl_ != nullptr && !handshake_offloaded_ && !kernel_tls_tx_ &&
+      SSL_shutdown(ssl_) == 0) {
     SSL_shutdown(ssl_);
+  }
 
   shutdown_ = true;
   EncOut();
@@ -779,17 +912,28 @@ void TLSWrap::EnableSessionCallbacks(
 void TLSWrap::DestroySSL(const FunctionCallbackInfo<Value>& args) {
   TLSWrap* wrap = Unwrap<TLSWrap>(args.Holder());
 
+  // Wait for the threadpool to release `ssl_`
+  if (wrap->handshake_offloaded_) {
+    wrap->destroy_pending_ = true;
+    return;
+  }
+
+  wrap->DoDestroySSL();
+}
+
+
+void TLSWrap::DoDestroySSL() {
   // Move all writes to pending
-  wrap->MakePending();
+  MakePending();
 
   // And destroy
-  wrap->InvokeQueued(UV_ECANCELED, "Canceled because of SSL destruction");
+  InvokeQueued(UV_ECANCELED, "Canceled because of SSL destruction");
 
   // Destroy the SSL structure and friends
-  wrap->SSLWrap<TLSWrap>::DestroySSL();
+  SSLWrap<TLSWrap>::DestroySSL();
 
-  delete wrap->clear_in_;
-  wrap->clear_in_ = nullptr;
+  delete clear_in_;
+  clear_in_ = nullptr;
 }
 
 
@@ -799,6 +943,333 @@ void TLSWrap::EnableCertCb(const FunctionCallbackInfo<Value>& args) {
 }
 
 
+void TLSWrap::EnableAdaptiveRecordSize(
+    const FunctionCallbackInfo<Value>& args) {
+  TLSWrap* wrap = Unwrap<TLSWrap>(args.Holder());
+  wrap->adaptive_record_size_ = true;
+}
+
+
+size_t TLSWrap::RecordSize() {
+  if (!adaptive_record_size_)
+    return kMaxRecordSize;
+
+  // Start over with small records after the connection has been idle, the
+  // congestion window may have shrunk in the meantime.
+  uint64_t now = uv_now(env()->event_loop());
+  if (now - last_record_time_ > kAdaptiveRecordIdleTimeout)
+    record_bytes_written_ = 0;
+  last_record_time_ = now;
+
+  if (record_bytes_written_ < kAdaptiveRecordThreshold)
+    return kSmallRecordSize;
+  return kMaxRecordSize;
+}
+
+
+void TLSWrap::RecordWritten(size_t len) {
+  if (record_bytes_written_ < kAdaptiveRecordThreshold)
+    record_bytes_written_ += len;
+}
+
+
+void TLSWrap::EnableAsyncHandshake(const FunctionCallbackInfo<Value>& args) {
+  TLSWrap* wrap = Unwrap<TLSWrap>(args.Holder());
+  wrap->async_handshake_ = wrap->is_server();
+}
+
+
+void TLSWrap::EnableKernelTLS(const FunctionCallbackInfo<Value>& args) {
+  TLSWrap* wrap = Unwrap<TLSWrap>(args.Holder());
+  wrap->kernel_tls_ = true;
+}
+
+
+void TLSWrap::IsKernelTLS(const FunctionCallbackInfo<Value>& args) {
+  TLSWrap* wrap = Unwrap<TLSWrap>(args.Holder());
+  args.GetReturnValue().Set(wrap->kernel_tls_tx_);
+}
+
+
+#ifdef __linux__
+// The TLS 1.2 PRF of RFC 5246, section 5.
+static void TLS12PRF(const EVP_MD* md,
+                     const unsigned char* secret,
+                     size_t secret_len,
+                     const unsigned char* seed,
+                     size_t seed_len,
+                     unsigned char* out,
+                     size_t out_len) {
+  unsigned char a[EVP_MAX_MD_SIZE];
+  unsigned int a_len;
+  HMAC(md, secret, secret_len, seed, seed_len, a, &a_len);
+
+  HMAC_CTX ctx;
+  HMAC_CTX_init(&ctx);
+  while (out_len > 0) {
+    unsigned char chunk[EVP_MAX_MD_SIZE];
+    unsigned int chunk_len;
+    HMAC_Init_ex(&ctx, secret, secret_len, md, nullptr);
+    HMAC_Update(&ctx, a, a_len);
+    HMAC_Update(&ctx, seed, seed_len);
+    HMAC_Final(&ctx, chunk, &chunk_len);
+
+    size_t len = chunk_len < out_len ? chunk_len : out_len;
+    memcpy(out, chunk, len);
+    out += len;
+    out_len -= len;
+
+    HMAC_Init_ex(&ctx, secret, secret_len, md, nullptr);
+    HMAC_Update(&ctx, a, a_len);
+    HMAC_Final(&ctx, a, &a_len);
+  }
+  HMAC_CTX_cleanup(&ctx);
+  OPENSSL_cleanse(a, sizeof(a));
+}
+
+
+// Hands the write keys of `ssl` to the kernel, which encrypts the records
+// that are written to `fd` from then on.  Only TLS 1.2 with AES-GCM is
+// supported.
+static bool EnableKernelTLSTx(SSL* ssl, int fd, bool is_server) {
+  if (SSL_version(ssl) != TLS1_2_VERSION ||
+      SSL_get_current_compression(ssl) != nullptr ||
+      ssl->enc_write_ctx == nullptr) {
+    return false;
+  }
+
+  size_t key_len;
+  uint16_t cipher_type;
+  switch (EVP_CIPHER_CTX_nid(ssl->enc_write_ctx)) {
+    case NID_aes_128_gcm:
+      key_len = 16;
+      cipher_type = NODE_KTLS_CIPHER_AES_GCM_128;
+      break;
+    case NID_aes_256_gcm:
+      key_len = 32;
+      cipher_type = NODE_KTLS_CIPHER_AES_GCM_256;
+      break;
+    default:
+      return false;
+  }
+
+  // The GCM suites use the PRF with SHA-384 when their name says so and with
+  // SHA-256 otherwise.
+  const char* name = SSL_get_cipher_name(ssl);
+  size_t name_len = strlen(name);
+  const EVP_MD* md = EVP_sha256();
+  if (name_len > 6 && strcmp(name + name_len - 6, "SHA384") == 0)
+    md = EVP_sha384();
+
+  SSL_SESSION* session = SSL_get_session(ssl);
+  if (session == nullptr)
+    return false;
+
+  // There are no MAC keys, the key block is the client and server keys
+  // followed by their 4 byte implicit nonces.
+  static const char label[] = "key expansion";
+  unsigned char seed[sizeof(label) - 1 + 2 * SSL3_RANDOM_SIZE];
+  memcpy(seed, label, sizeof(label) - 1);
+  memcpy(seed + sizeof(label) - 1, ssl->s3->server_random, SSL3_RANDOM_SIZE);
+  memcpy(seed + sizeof(label) - 1 + SSL3_RANDOM_SIZE,
+         ssl->s3->client_random,
+         SSL3_RANDOM_SIZE);
+  unsigned char key_block[2 * 32 + 2 * 4];
+  TLS12PRF(md,
+           session->master_key,
+           session->master_key_length,
+           seed,
+           sizeof(seed),
+           key_block,
+           2 * key_len + 2 * 4);
+
+  const unsigned char* key = key_block + (is_server ? key_len : 0);
+  const unsigned char* salt = key_block + 2 * key_len + (is_server ? 4 : 0);
+
+  // struct tls12_crypto_info_aes_gcm_{128,256}: the version and cipher type,
+  // the explicit nonce of the next record, the key, the implicit nonce and
+  // the sequence number of the next record.  The explicit nonce can be
+  // anything that isn't reused, the sequence number is.
+  unsigned char info[4 + 8 + 32 + 4 + 8];
+  const uint16_t version = NODE_KTLS_VERSION_1_2;
+  memcpy(info, &version, 2);
+  memcpy(info + 2, &cipher_type, 2);
+  memcpy(info + 4, ssl->s3->write_sequence, 8);
+  memcpy(info + 12, key, key_len);
+  memcpy(info + 12 + key_len, salt, 4);
+  memcpy(info + 16 + key_len, ssl->s3->write_sequence, 8);
+
+  bool ok =
+      setsockopt(fd, SOL_TCP, TCP_ULP, "tls", sizeof("tls")) == 0 &&
+      setsockopt(fd, SOL_TLS, NODE_KTLS_TX, info, 24 + key_len) == 0;
+
+  OPENSSL_cleanse(key_block, sizeof(key_block));
+  OPENSSL_cleanse(info, sizeof(info));
+  return ok;
+}
+#endif  // __linux__
+
+
+void TLSWrap::MaybeEnableKernelTLS() {
+  if (!kernel_tls_ || kernel_tls_tx_ || !established_ || shutdown_)
+    return;
+
+  // Everything that OpenSSL encrypted has to be written first
+  if (write_size_ != 0 || BIO_pending(enc_out_) != 0 ||
+      clear_in_->Length() != 0 || !write_item_queue_.IsEmpty() ||
+      !pending_write_items_.IsEmpty()) {
+    return;
+  }
+
+  // Tried once, whatever the outcome
+  kernel_tls_ = false;
+
+#ifdef __linux__
+  int fd = stream_->GetFD();
+  if (fd >= 0)
+    kernel_tls_tx_ = EnableKernelTLSTx(ssl_, fd, is_server());
+#endif  // __linux__
+}
+
+
+bool TLSWrap::CanOffloadHandshake() {
+  if (!async_handshake_ || established_ || SSL_is_init_finished(ssl_))
+    return false;
+
+  // Nothing to do yet, or `enc_out_` is being written to the socket
+  if (BIO_pending(enc_in_) == 0 || write_size_ != 0)
+    return false;
+
+  // These need to call into JS in the middle of the handshake
+  if (session_callbacks_ || is_waiting_cert_cb() ||
+      sc_->has_ticket_key_callback()) {
+    return false;
+  }
+#ifdef NODE__HAVE_TLSEXT_STATUS_CB
+  if (!ocsp_response_.IsEmpty() || sc_->has_stapled_ocsp_response())
+    return false;
+#endif  // NODE__HAVE_TLSEXT_STATUS_CB
+
+  HandleScope handle_scope(env()->isolate());
+  Local<Context> context = env()->context();
+  Local<Value> npn_buffer = object()->GetPrivate(
+      context, env()->npn_buffer_private_symbol()).ToLocalChecked();
+  Local<Value> alpn_buffer = object()->GetPrivate(
+      context, env()->alpn_buffer_private_symbol()).ToLocalChecked();
+  return npn_buffer->IsUndefined() && alpn_buffer->IsUndefined();
+}
+
+
+void TLSWrap::OffloadHandshake() {
+  // NodeBIO reports its memory to V8 and takes buffers from the
+  // environment's pool, neither may be done from the threadpool.
+  NodeBIO::FromBIO(enc_in_)->AssignEnvironment(nullptr);
+  NodeBIO::FromBIO(enc_out_)->AssignEnvironment(nullptr);
+
+  handshake_offloaded_ = true;
+  handshake_where_ = 0;
+  ClearWeak();
+
+  int r = uv_queue_work(env()->event_loop(),
+                        &handshake_req_,
+                        HandshakeWork,
+                        AfterHandshakeWork);
+  CHECK_EQ(r, 0);
+}
+
+
+void TLSWrap::HandshakeWork(uv_work_t* work_req) {
+  TLSWrap* wrap = ContainerOf(&TLSWrap::handshake_req_, work_req);
+
+  // The error queue is per thread, take the message along
+  ERR_clear_error();
+  int ret = SSL_do_handshake(wrap->ssl_);
+  int err = SSL_get_error(wrap->ssl_, ret);
+  if (ret != 1 && (err == SSL_ERROR_SSL || err == SSL_ERROR_SYSCALL)) {
+    BIO* bio = BIO_new(BIO_s_mem());
+    ERR_print_errors(bio);
+
+    BUF_MEM* mem;
+    BIO_get_mem_ptr(bio, &mem);
+
+    char* const buf = new char[mem->length + 1];
+    memcpy(buf, mem->data, mem->length);
+    buf[mem->length] = '\0';
+    wrap->handshake_error_ = buf;
+    BIO_free_all(bio);
+  }
+  ERR_clear_error();
+}
+
+
+void TLSWrap::AfterHandshakeWork(uv_work_t* work_req, int status) {
+  CHECK_EQ(status, 0);
+  TLSWrap* wrap = ContainerOf(&TLSWrap::handshake_req_, work_req);
+  Environment* env = wrap->env();
+  HandleScope handle_scope(env->isolate());
+  Context::Scope context_scope(env->context());
+
+  wrap->handshake_offloaded_ = false;
+  wrap->MakeWeak(wrap);
+  NodeBIO::FromBIO(wrap->enc_in_)->AssignEnvironment(env);
+  NodeBIO::FromBIO(wrap->enc_out_)->AssignEnvironment(env);
+
+  NodeBIO* backlog = wrap->handshake_backlog_;
+  ssize_t backlog_status = wrap->handshake_backlog_status_;
+  wrap->handshake_backlog_ = nullptr;
+  wrap->handshake_backlog_status_ = 0;
+
+  if (wrap->destroy_pending_) {
+    wrap->destroy_pending_ = false;
+    delete[] wrap->handshake_error_;
+    wrap->handshake_error_ = nullptr;
+    delete backlog;
+    return wrap->DoDestroySSL();
+  }
+
+  // Emit the `onhandshakestart` and `onhandshakedone` callbacks
+  if (wrap->handshake_where_ != 0)
+    SSLInfoCallback(wrap->ssl_, wrap->handshake_where_, 1);
+  wrap->handshake_where_ = 0;
+
+  if (wrap->handshake_error_ != nullptr) {
+    Local<Value> arg = Exception::Error(
+        OneByteString(env->isolate(), wrap->handshake_error_));
+    delete[] wrap->handshake_error_;
+    wrap->handshake_error_ = nullptr;
+    delete backlog;
+
+    if (wrap->ssl_ == nullptr)
+      return;
+
+    // Flush the alert before the socket gets destroyed
+    if (BIO_pending(wrap->enc_out_) != 0)
+      wrap->EncOut();
+    wrap->MakeCallback(env->onerror_string(), 1, &arg);
+    return;
+  }
+
+  if (backlog != nullptr) {
+    if (wrap->ssl_ != nullptr) {
+      NodeBIO* enc_in = NodeBIO::FromBIO(wrap->enc_in_);
+      while (backlog->Length() > 0) {
+        size_t avail = 0;
+        char* data = backlog->Peek(&avail);
+        enc_in->Write(data, avail);
+        backlog->Read(nullptr, avail);
+      }
+    }
+    delete backlog;
+  }
+
+  // Send the records of this step before the next one gets offloaded
+  wrap->EncOut();
+  wrap->Cycle();
+  if (backlog_status < 0)
+    wrap->DoRead(backlog_status, nullptr, UV_UNKNOWN_HANDLE);
+}
+
+
 void TLSWrap::OnClientHelloParseEnd(void* arg) {
   TLSWrap* c = static_cast<TLSWrap*>(arg);
   c->Cycle();
@@ -855,6 +1326,11 @@ int TLSWrap::SelectSNIContextCallback(SSL* s, int* ad, void* arg) {
   if (servername == nullptr)
     return SSL_TLSEXT_ERR_OK;
 
+  // `sni_context` is only set from the cert callback, which is never used
+  // with offloaded handshakes
+  if (p->handshake_offloaded_)
+    return SSL_TLSEXT_ERR_NOACK;
+
   // Call the SNI callback and use its return value as context
   Local<Object> object = p->object();
   Local<Value> ctx = object->Get(env->sni_context_string());
@@ -898,6 +1374,10 @@ void TLSWrap::Initialize(Local<Object> target,
   env->SetProtoMethod(t, "enableSessionCallbacks", EnableSessionCallbacks);
   env->SetProtoMethod(t, "destroySSL", DestroySSL);
   env->SetProtoMethod(t, "enableCertCb", EnableCertCb);
+  env->SetProtoMethod(t, "enableAdaptiveRecordSize", EnableAdaptiveRecordSize);
+  env->SetProtoMethod(t, "enableAsyncHandshake", EnableAsyncHandshake);
+  env->SetProtoMethod(t, "enableKernelTLS", EnableKernelTLS);
+  env->SetProtoMethod(t, "isKernelTLS", IsKernelTLS);
 
   StreamBase::AddMethods<TLSWrap>(env, t, StreamBase::kFlagHasWritev);
   SSLWrap<TLSWrap>::AddMethods(env, t);
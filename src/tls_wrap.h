@@ -55,6 +55,16 @@ class TLSWrap : public AsyncWrap,
  protected:
   static const int kClearOutChunkSize = 16384;
 
+  // Maximum amount of plaintext in a TLS record, SSL3_RT_MAX_PLAIN_LENGTH
+  static const size_t kMaxRecordSize = 16384;
+
+  // With adaptive record sizing, records fit in a single TCP segment until
+  // kAdaptiveRecordThreshold bytes have been written, and again after the
+  // connection has been idle for kAdaptiveRecordIdleTimeout milliseconds.
+  static const size_t kSmallRecordSize = 1400;
+  static const size_t kAdaptiveRecordThreshold = 1024 * 1024;
+  static const uint64_t kAdaptiveRecordIdleTimeout = 1000;
+
   // Maximum number of bytes for hello parser
   static const int kMaxHelloLength = 16384;
 
@@ -64,6 +74,22 @@ class TLSWrap : public AsyncWrap,
   // Maximum number of buffers passed to uv_write()
   static const int kSimultaneousBufferCount = 10;
 
+  // Returns the maximum amount of plaintext for the next record.
+  size_t RecordSize();
+  void RecordWritten(size_t len);
+
+  // With asynchronous handshakes, the steps of a server handshake run on the
+  // threadpool.  Data read meanwhile is kept in handshake_backlog_.
+  bool CanOffloadHandshake();
+  void OffloadHandshake();
+  static void HandshakeWork(uv_work_t* work_req);
+  static void AfterHandshakeWork(uv_work_t* work_req, int status);
+
+  // With kernel TLS, the records are encrypted by the kernel once the
+  // handshake is over, and writes go to `stream_` as they are.  Only the
+  // sending side is offloaded, OpenSSL still decrypts what is read.
+  void MaybeEnableKernelTLS();
+
   // Write callback queue's item
   class WriteItem {
    public:
@@ -134,7 +160,14 @@ class TLSWrap : public AsyncWrap,
       const v8::FunctionCallbackInfo<v8::Value>& args);
   static void EnableCertCb(
       const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void EnableAdaptiveRecordSize(
+      const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void EnableAsyncHandshake(
+      const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void EnableKernelTLS(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void IsKernelTLS(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void DestroySSL(const v8::FunctionCallbackInfo<v8::Value>& args);
+  void DoDestroySSL();
 
 #ifdef SSL_CTRL_SET_TLSEXT_SERVERNAME_CB
   static void GetServername(const v8::FunctionCallbackInfo<v8::Value>& args);
@@ -158,6 +191,20 @@ class TLSWrap : public AsyncWrap,
   const char* error_;
   int cycle_depth_;
 
+  bool adaptive_record_size_;
+  size_t record_bytes_written_;
+  uint64_t last_record_time_;
+
+  bool async_handshake_;
+  bool destroy_pending_;
+  int handshake_where_;
+  char* handshake_error_;
+  NodeBIO* handshake_backlog_;
+  ssize_t handshake_backlog_status_;
+  uv_work_t handshake_req_;
+  bool kernel_tls_;
+  bool kernel_tls_tx_;
+
   // If true - delivered EOF to the js-land, either after `close_notify`, or
   // after the `UV_EOF` on socket.
   bool eof_;
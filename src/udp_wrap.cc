@@ -9,6 +9,7 @@
 #include "util-inl.h"
 
 #include <stdlib.h>
+#include <string.h>
 
 
 namespace node {
@@ -31,6 +32,9 @@ using v8::Uint32;
 using v8::Undefined;
 using v8::Value;
 
+// The most datagrams that one recvmmsg() call receives.
+static const size_t kRecvBatchSize = 16;
+
 
 class SendWrap : public ReqWrap<uv_udp_send_t> {
  public:
@@ -57,21 +61,86 @@ inline bool SendWrap::have_callback() const {
 }
 
 
+// One uv_udp_send_t per datagram, the callback runs when the last of them
+// is done.
+class SendBatchWrap : public ReqWrap<uv_udp_send_t> {
+ public:
+  SendBatchWrap(Environment* env,
+                Local<Object> req_wrap_obj,
+                size_t count,
+                bool have_callback);
+  ~SendBatchWrap() override;
+  inline uv_udp_send_t* req(size_t index);
+  inline bool have_callback() const;
+  size_t msg_size;
+  size_t pending;
+  int status;
+  size_t self_size() const override { return sizeof(*this); }
+ private:
+  uv_udp_send_t* reqs_;
+  const bool have_callback_;
+};
+
+
+SendBatchWrap::SendBatchWrap(Environment* env,
+                             Local<Object> req_wrap_obj,
+                             size_t count,
+                             bool have_callback)
+    : ReqWrap(env, req_wrap_obj, AsyncWrap::PROVIDER_UDPSENDWRAP),
+      msg_size(0),
+      pending(0),
+      status(0),
+      reqs_(count > 1 ? new uv_udp_send_t[count - 1] : nullptr),
+      have_callback_(have_callback) {
+  Wrap(req_wrap_obj, this);
+}
+
+
+SendBatchWrap::~SendBatchWrap() {
+  delete[] reqs_;
+}
+
+
+inline uv_udp_send_t* SendBatchWrap::req(size_t index) {
+  return index == 0 ? &req_ : &reqs_[index - 1];
+}
+
+
+inline bool SendBatchWrap::have_callback() const {
+  return have_callback_;
+}
+
+
 static void NewSendWrap(const FunctionCallbackInfo<Value>& args) {
   CHECK(args.IsConstructCall());
 }
 
 
-UDPWrap::UDPWrap(Environment* env, Local<Object> object, AsyncWrap* parent)
+// With recv_batch, datagrams are received with recvmmsg() where that's
+// available, and all datagrams from one call go to JS in one callback.
+UDPWrap::UDPWrap(Environment* env,
+                 Local<Object> object,
+                 AsyncWrap* parent,
+                 bool recv_batch)
     : HandleWrap(env,
                  object,
                  reinterpret_cast<uv_handle_t*>(&handle_),
-                 AsyncWrap::PROVIDER_UDPWRAP) {
-  int r = uv_udp_init(env->event_loop(), &handle_);
+                 AsyncWrap::PROVIDER_UDPWRAP),
+      recv_buffer_(nullptr),
+      recv_buffer_size_(0) {
+  unsigned int flags = AF_UNSPEC;
+  if (recv_batch)
+    flags |= UV_UDP_RECVMMSG;
+  int r = uv_udp_init_ex(env->event_loop(), &handle_, flags);
   CHECK_EQ(r, 0);  // can't fail anyway
 }
 
 
+UDPWrap::~UDPWrap() {
+  free(recv_buffer_);
+}
+
+
 void UDPWrap::Initialize(Local<Object> target,
                          Local<Value> unused,
                          Local<Context> context) {
@@ -94,6 +163,8 @@ void UDPWrap::Initialize(Local<Object> target,
   env->SetProtoMethod(t, "send", Send);
   env->SetProtoMethod(t, "bind6", Bind6);
   env->SetProtoMethod(t, "send6", Send6);
+  env->SetProtoMethod(t, "sendBatch", SendBatch);
+  env->SetProtoMethod(t, "sendBatch6", SendBatch6);
   env->SetProtoMethod(t, "close", Close);
   env->SetProtoMethod(t, "recvStart", RecvStart);
   env->SetProtoMethod(t, "recvStop", RecvStop);
@@ -104,6 +175,8 @@ void UDPWrap::Initialize(Local<Object> target,
   env->SetProtoMethod(t, "setMulticastTTL", SetMulticastTTL);
   env->SetProtoMethod(t, "setMulticastLoopback", SetMulticastLoopback);
   env->SetProtoMethod(t, "setBroadcast", SetBroadcast);
+  env->SetProtoMethod(t, "setGRO", SetGRO);
+  env->SetProtoMethod(t, "setBusyPoll", SetBusyPoll);
   env->SetProtoMethod(t, "setTTL", SetTTL);
 
   env->SetProtoMethod(t, "ref", HandleWrap::Ref);
@@ -132,6 +205,9 @@ void UDPWrap::New(const FunctionCallbackInfo<Value>& args) {
     new UDPWrap(env,
                 args.This(),
                 static_cast<AsyncWrap*>(args[0].As<External>()->Value()));
+  } else if (args[0]->IsBoolean()) {
+    // new UDP(recvBatch)
+    new UDPWrap(env, args.This(), nullptr, args[0]->IsTrue());
   } else {
     UNREACHABLE();
   }
@@ -203,6 +279,8 @@ void UDPWrap::Bind6(const FunctionCallbackInfo<Value>& args) {
 
 X(SetTTL, uv_udp_set_ttl)
 X(SetBroadcast, uv_udp_set_broadcast)
+X(SetGRO, uv_udp_set_gro)
+X(SetBusyPoll, uv_udp_set_busy_poll)
 X(SetMulticastTTL, uv_udp_set_multicast_ttl)
 X(SetMulticastLoopback, uv_udp_set_multicast_loop)
 
@@ -246,7 +324,7 @@ void UDPWrap::DoSend(const FunctionCallbackInfo<Value>& args, int family) {
 
   UDPWrap* wrap = Unwrap<UDPWrap>(args.Holder());
 
-  // send(req, buffer, port, address, hasCallback)
+  // send(req, buffer, count, port, address, hasCallback[, segmentSize])
   CHECK(args[0]->IsObject());
   CHECK(args[1]->IsArray());
   CHECK(args[2]->IsUint32());
@@ -262,6 +340,10 @@ void UDPWrap::DoSend(const FunctionCallbackInfo<Value>& args, int family) {
   const unsigned short port = args[3]->Uint32Value();
   node::Utf8Value address(env->isolate(), args[4]);
   const bool have_callback = args[5]->IsTrue();
+  // With a segment size, the kernel splits the data up into datagrams.
+  unsigned int segment_size = 0;
+  if (args[6]->IsUint32())
+    segment_size = args[6]->Uint32Value();
 
   SendWrap* req_wrap = new SendWrap(env, req_wrap_obj, have_callback);
   size_t msg_size = 0;
@@ -301,7 +383,15 @@ void UDPWrap::DoSend(const FunctionCallbackInfo<Value>& args, int family) {
     ABORT();
   }
 
-  if (err == 0) {
+  if (err == 0 && segment_size != 0) {
+    err = uv_udp_send_gso(&req_wrap->req_,
+                          &wrap->handle_,
+                          bufs,
+                          count,
+                          reinterpret_cast<const sockaddr*>(&addr),
+                          segment_size,
+                          OnSend);
+  } else if (err == 0) {
     err = uv_udp_send(&req_wrap->req_,
                       &wrap->handle_,
                       bufs,
@@ -332,6 +422,100 @@ void UDPWrap::Send6(const FunctionCallbackInfo<Value>& args) {
 }
 
 
+void UDPWrap::DoSendBatch(const FunctionCallbackInfo<Value>& args,
+                          int family) {
+  Environment* env = Environment::GetCurrent(args);
+
+  UDPWrap* wrap = Unwrap<UDPWrap>(args.Holder());
+
+  // sendBatch(req, buffers, ports, addresses, hasCallback)
+  CHECK(args[0]->IsObject());
+  CHECK(args[1]->IsArray());
+  CHECK(args[2]->IsArray());
+  CHECK(args[3]->IsArray());
+  CHECK(args[4]->IsBoolean());
+
+  Local<Object> req_wrap_obj = args[0].As<Object>();
+  Local<Array> buffers = args[1].As<Array>();
+  Local<Array> ports = args[2].As<Array>();
+  Local<Array> addresses = args[3].As<Array>();
+  const bool have_callback = args[4]->IsTrue();
+  const size_t count = buffers->Length();
+  CHECK_GT(count, 0);
+  CHECK_EQ(ports->Length(), count);
+  CHECK_EQ(addresses->Length(), count);
+
+  // Parse all addresses first, so that a bad one doesn't send half a batch.
+  std::vector<sockaddr_storage> addrs(count);
+  for (size_t i = 0; i < count; i++) {
+    const unsigned short port = ports->Get(i)->Uint32Value();
+    node::Utf8Value address(env->isolate(), addresses->Get(i));
+    int err;
+    switch (family) {
+    case AF_INET:
+      err = uv_ip4_addr(*address,
+                        port,
+                        reinterpret_cast<sockaddr_in*>(&addrs[i]));
+      break;
+    case AF_INET6:
+      err = uv_ip6_addr(*address,
+                        port,
+                        reinterpret_cast<sockaddr_in6*>(&addrs[i]));
+      break;
+    default:
+      CHECK(0 && "unexpected address family");
+      ABORT();
+    }
+    if (err)
+      return args.GetReturnValue().Set(err);
+  }
+
+  SendBatchWrap* req_wrap =
+      new SendBatchWrap(env, req_wrap_obj, count, have_callback);
+  req_wrap->Dispatched();
+
+  // The datagrams that find the socket busy are queued in libuv and leave
+  // together with one sendmmsg() call where that's available.
+  int err = 0;
+  for (size_t i = 0; i < count; i++) {
+    Local<Value> buffer = buffers->Get(i);
+    uv_buf_t buf = uv_buf_init(Buffer::Data(buffer), Buffer::Length(buffer));
+    uv_udp_send_t* req = req_wrap->req(i);
+    req->data = req_wrap;
+    err = uv_udp_send(req,
+                      &wrap->handle_,
+                      &buf,
+                      1,
+                      reinterpret_cast<const sockaddr*>(&addrs[i]),
+                      OnSendBatch);
+    if (err)
+      break;
+    req_wrap->pending++;
+    req_wrap->msg_size += buf.len;
+  }
+
+  if (req_wrap->pending == 0) {
+    delete req_wrap;
+    return args.GetReturnValue().Set(err);
+  }
+
+  // The datagrams that were queued still go out, the error is reported
+  // once they're done.
+  req_wrap->status = err;
+  args.GetReturnValue().Set(0);
+}
+
+
+void UDPWrap::SendBatch(const FunctionCallbackInfo<Value>& args) {
+  DoSendBatch(args, AF_INET);
+}
+
+
+void UDPWrap::SendBatch6(const FunctionCallbackInfo<Value>& args) {
+  DoSendBatch(args, AF_INET6);
+}
+
+
 void UDPWrap::RecvStart(const FunctionCallbackInfo<Value>& args) {
   UDPWrap* wrap = Unwrap<UDPWrap>(args.Holder());
   int err = uv_udp_recv_start(&wrap->handle_, OnAlloc, OnRecv);
@@ -366,16 +550,51 @@ void UDPWrap::OnSend(uv_udp_send_t* req, int status) {
 }
 
 
+void UDPWrap::OnSendBatch(uv_udp_send_t* req, int status) {
+  SendBatchWrap* req_wrap = static_cast<SendBatchWrap*>(req->data);
+  if (status != 0 && req_wrap->status == 0)
+    req_wrap->status = status;
+  if (--req_wrap->pending > 0)
+    return;
+
+  if (req_wrap->have_callback()) {
+    Environment* env = req_wrap->env();
+    HandleScope handle_scope(env->isolate());
+    Context::Scope context_scope(env->context());
+    Local<Value> arg[] = {
+      Integer::New(env->isolate(), req_wrap->status),
+      Integer::New(env->isolate(), req_wrap->msg_size),
+    };
+    req_wrap->MakeCallback(env->oncomplete_string(), 2, arg);
+  }
+  delete req_wrap;
+}
+
+
 void UDPWrap::OnAlloc(uv_handle_t* handle,
                       size_t suggested_size,
                       uv_buf_t* buf) {
-  buf->base = static_cast<char*>(malloc(suggested_size));
-  buf->len = suggested_size;
+  UDPWrap* wrap = static_cast<UDPWrap*>(handle->data);
 
-  if (buf->base == nullptr && suggested_size > 0) {
-    FatalError("node::UDPWrap::OnAlloc(uv_handle_t*, size_t, uv_buf_t*)",
-               "Out Of Memory");
+  // Datagrams are received into a buffer that belongs to the handle and
+  // copied out into a Buffer of their own size in OnRecv(), so there's no
+  // allocation of |suggested_size| bytes per datagram.  With recvmmsg(),
+  // libuv splits the buffer into datagrams of |suggested_size|.
+  size_t size = suggested_size;
+  if (uv_udp_using_recvmmsg(&wrap->handle_))
+    size *= kRecvBatchSize;
+
+  if (size > wrap->recv_buffer_size_) {
+    char* base = static_cast<char*>(realloc(wrap->recv_buffer_, size));
+    if (base == nullptr) {
+      FatalError("node::UDPWrap::OnAlloc(uv_handle_t*, size_t, uv_buf_t*)",
+                 "Out Of Memory");
+    }
+    wrap->recv_buffer_ = base;
+    wrap->recv_buffer_size_ = size;
   }
+
+  *buf = uv_buf_init(wrap->recv_buffer_, size);
 }
 
 
@@ -384,13 +603,29 @@ void UDPWrap::OnRecv(uv_udp_t* handle,
                      const uv_buf_t* buf,
                      const struct sockaddr* addr,
                      unsigned int flags) {
-  if (nread == 0 && addr == nullptr) {
-    if (buf->base != nullptr)
-      free(buf->base);
+  UDPWrap* wrap = static_cast<UDPWrap*>(handle->data);
+
+  if (flags & UV_UDP_MMSG_CHUNK) {
+    RecvBatchEntry entry;
+    entry.data = buf->base;
+    entry.length = nread;
+    entry.segment_size = uv_udp_get_recv_segment_size(handle);
+    memcpy(&entry.addr,
+           addr,
+           addr->sa_family == AF_INET6 ? sizeof(sockaddr_in6) :
+                                         sizeof(sockaddr_in));
+    wrap->recv_batch_.push_back(entry);
     return;
   }
 
-  UDPWrap* wrap = static_cast<UDPWrap*>(handle->data);
+  if (flags & UV_UDP_MMSG_FREE) {
+    wrap->FlushRecvBatch();
+    return;
+  }
+
+  if (nread == 0 && addr == nullptr)
+    return;
+
   Environment* env = wrap->env();
 
   HandleScope handle_scope(env->isolate());
@@ -405,19 +640,54 @@ void UDPWrap::OnRecv(uv_udp_t* handle,
   };
 
   if (nread < 0) {
-    if (buf->base != nullptr)
-      free(buf->base);
     wrap->MakeCallback(env->onmessage_string(), arraysize(argv), argv);
     return;
   }
 
-  char* base = static_cast<char*>(realloc(buf->base, nread));
-  argv[2] = Buffer::New(env, base, nread).ToLocalChecked();
+  argv[2] = Buffer::Copy(env, buf->base, nread).ToLocalChecked();
   argv[3] = AddressToJS(env, addr);
+  // The buffer holds several datagrams when they were coalesced by GRO.
+  const unsigned int segment_size = uv_udp_get_recv_segment_size(handle);
+  if (segment_size != 0) {
+    argv[3].As<Object>()->Set(env->segment_size_string(),
+                              Integer::NewFromUnsigned(env->isolate(),
+                                                       segment_size));
+  }
   wrap->MakeCallback(env->onmessage_string(), arraysize(argv), argv);
 }
 
 
+void UDPWrap::FlushRecvBatch() {
+  if (recv_batch_.empty())
+    return;
+
+  HandleScope handle_scope(env()->isolate());
+  Context::Scope context_scope(env()->context());
+
+  const size_t count = recv_batch_.size();
+  Local<Array> buffers = Array::New(env()->isolate(), count);
+  Local<Array> addresses = Array::New(env()->isolate(), count);
+  for (size_t i = 0; i < count; i++) {
+    const RecvBatchEntry& entry = recv_batch_[i];
+    buffers->Set(i, Buffer::Copy(env(), entry.data, entry.length)
+                        .ToLocalChecked());
+    Local<Object> rinfo = AddressToJS(env(),
+                                      reinterpret_cast<const sockaddr*>(
+                                          &entry.addr));
+    if (entry.segment_size != 0) {
+      rinfo->Set(env()->segment_size_string(),
+                 Integer::NewFromUnsigned(env()->isolate(),
+                                          entry.segment_size));
+    }
+    addresses->Set(i, rinfo);
+  }
+  recv_batch_.clear();
+
+  Local<Value> argv[] = { object(), buffers, addresses };
+  MakeCallback(env()->onmessages_string(), arraysize(argv), argv);
+}
+
+
 Local<Object> UDPWrap::Instantiate(Environment* env, AsyncWrap* parent) {
   // If this assert fires then Initialize hasn't been called yet.
   CHECK_EQ(env->udp_constructor_function().IsEmpty(), false);
@@ -9,6 +9,8 @@
 #include "uv.h"
 #include "v8.h"
 
+#include <vector>
+
 namespace node {
 
 class UDPWrap: public HandleWrap {
@@ -23,6 +25,8 @@ class UDPWrap: public HandleWrap {
   static void Send(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void Bind6(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void Send6(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void SendBatch(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void SendBatch6(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void RecvStart(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void RecvStop(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void GetSockName(const v8::FunctionCallbackInfo<v8::Value>& args);
@@ -32,6 +36,8 @@ class UDPWrap: public HandleWrap {
   static void SetMulticastLoopback(
       const v8::FunctionCallbackInfo<v8::Value>& args);
   static void SetBroadcast(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void SetGRO(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void SetBusyPoll(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void SetTTL(const v8::FunctionCallbackInfo<v8::Value>& args);
 
   static v8::Local<v8::Object> Instantiate(Environment* env, AsyncWrap* parent);
@@ -42,16 +48,30 @@ class UDPWrap: public HandleWrap {
  private:
   typedef uv_udp_t HandleType;
 
+  // A datagram from a recvmmsg() call that OnRecv() hasn't delivered yet.
+  struct RecvBatchEntry {
+    const char* data;
+    size_t length;
+    sockaddr_storage addr;
+    unsigned int segment_size;
+  };
+
   template <typename T,
             int (*F)(const typename T::HandleType*, sockaddr*, int*)>
   friend void GetSockOrPeerName(const v8::FunctionCallbackInfo<v8::Value>&);
 
-  UDPWrap(Environment* env, v8::Local<v8::Object> object, AsyncWrap* parent);
+  UDPWrap(Environment* env,
+          v8::Local<v8::Object> object,
+          AsyncWrap* parent,
+          bool recv_batch = false);
+  ~UDPWrap() override;
 
   static void DoBind(const v8::FunctionCallbackInfo<v8::Value>& args,
                      int family);
   static void DoSend(const v8::FunctionCallbackInfo<v8::Value>& args,
                      int family);
+  static void DoSendBatch(const v8::FunctionCallbackInfo<v8::Value>& args,
+                          int family);
   static void SetMembership(const v8::FunctionCallbackInfo<v8::Value>& args,
                             uv_membership membership);
 
@@ -59,13 +79,21 @@ class UDPWrap: public HandleWrap {
                       size_t suggested_size,
                       uv_buf_t* buf);
   static void OnSend(uv_udp_send_t* req, int status);
+  static void OnSendBatch(uv_udp_send_t* req, int status);
   static void OnRecv(uv_udp_t* handle,
                      ssize_t nread,
                      const uv_buf_t* buf,
                      const struct sockaddr* addr,
                      unsigned int flags);
 
+  // Delivers the datagrams of a recvmmsg() call with one callback.
+  void FlushRecvBatch();
+
   uv_udp_t handle_;
+  // Receive buffer that is reused for every read, see OnAlloc().
+  char* recv_buffer_;
+  size_t recv_buffer_size_;
+  std::vector<RecvBatchEntry> recv_batch_;
 };
 
 }  // namespace node
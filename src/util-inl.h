@@ -198,6 +198,48 @@ TypeName* Unwrap(v8::Local<v8::Object> object) {
   return static_cast<TypeName*>(pointer);
 }
 
+template <size_t BlockSize, size_t MaxRetained>
+FreeListPool<BlockSize, MaxRetained>::~FreeListPool() {
+  Clear();
+}
+
+template <size_t BlockSize, size_t MaxRetained>
+char* FreeListPool<BlockSize, MaxRetained>::Allocate(size_t size) {
+  if (size > kBlockSize)
+    return new char[size];
+  if (count_ == 0) {
+    misses_++;
+    return new char[kBlockSize];
+  }
+  hits_++;
+  char* block = blocks_[--count_];
+  if (count_ < low_water_)
+    low_water_ = count_;
+  return block;
+}
+
+template <size_t BlockSize, size_t MaxRetained>
+void FreeListPool<BlockSize, MaxRetained>::Release(char* block, size_t size) {
+  if (size > kBlockSize || count_ == kMaxRetained)
+    delete[] block;
+  else
+    blocks_[count_++] = block;
+}
+
+template <size_t BlockSize, size_t MaxRetained>
+void FreeListPool<BlockSize, MaxRetained>::Trim() {
+  for (; low_water_ > 0; low_water_--)
+    delete[] blocks_[--count_];
+  low_water_ = count_;
+}
+
+template <size_t BlockSize, size_t MaxRetained>
+void FreeListPool<BlockSize, MaxRetained>::Clear() {
+  while (count_ > 0)
+    delete[] blocks_[--count_];
+  low_water_ = 0;
+}
+
 void SwapBytes(uint16_t* dst, const uint16_t* src, size_t buflen) {
   for (size_t i = 0; i < buflen; i += 1)
     dst[i] = (src[i] << 8) | (src[i] >> 8);
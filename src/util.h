@@ -282,6 +282,42 @@ class BufferValue : public MaybeStackBuffer<char> {
     explicit BufferValue(v8::Isolate* isolate, v8::Local<v8::Value> value);
 };
 
+// Keeps up to kMaxRetained freed blocks of kBlockSize bytes for the next
+// allocation instead of deleting them.  Allocations of more than kBlockSize
+// bytes bypass the pool.  Not thread-safe.
+template <size_t BlockSize, size_t MaxRetained>
+class FreeListPool {
+ public:
+  static const size_t kBlockSize = BlockSize;
+  static const size_t kMaxRetained = MaxRetained;
+
+  FreeListPool() = default;
+  inline ~FreeListPool();
+
+  inline char* Allocate(size_t size);
+  // |size| must be the same that was passed to Allocate().
+  inline void Release(char* block, size_t size);
+  // Frees the blocks that were not used since the last call, from the idle
+  // scheduler.
+  inline void Trim();
+  // Frees all blocks, under memory pressure.
+  inline void Clear();
+
+  inline size_t hits() const { return hits_; }
+  inline size_t misses() const { return misses_; }
+  inline size_t retained_bytes() const { return count_ * kBlockSize; }
+
+ private:
+  char* blocks_[kMaxRetained];
+  size_t count_ = 0;
+  // The fewest blocks that were left since the last Trim().
+  size_t low_water_ = 0;
+  size_t hits_ = 0;
+  size_t misses_ = 0;
+
+  DISALLOW_COPY_AND_ASSIGN(FreeListPool);
+};
+
 }  // namespace node
 
 #endif  // SRC_UTIL_H_
@@ -0,0 +1,941 @@
+#include "websocket_wrap.h"
+#include "stream_base.h"
+#include "stream_base-inl.h"
+
+#include "async-wrap.h"
+#include "async-wrap-inl.h"
+#include "env.h"
+#include "env-inl.h"
+#include "node_buffer.h"
+#include "util.h"
+#include "util-inl.h"
+
+#if HAVE_OPENSSL
+#include "node_crypto.h"  // EntropySource
+#endif
+
+#include <stdlib.h>  // realloc()
+#include <string.h>  // memcpy()
+
+namespace node {
+
+using v8::Boolean;
+using v8::Context;
+using v8::External;
+using v8::Function;
+using v8::FunctionCallbackInfo;
+using v8::FunctionTemplate;
+using v8::HandleScope;
+using v8::Integer;
+using v8::Local;
+using v8::MaybeLocal;
+using v8::NewStringType;
+using v8::Object;
+using v8::String;
+using v8::Undefined;
+using v8::Value;
+
+const uint32_t kOnMessage = 0;
+const uint32_t kOnPing = 1;
+const uint32_t kOnPong = 2;
+const uint32_t kOnClose = 3;
+const uint32_t kOnError = 4;
+const uint32_t kOnDrain = 5;
+
+
+// XORs `length` bytes of `src` with the masking key into `dst`, `offset`
+// bytes into the payload.  The key is repeated into a word so that eight
+// bytes are done at a time; compilers turn the loop into vector code.
+static void MaskCopy(char* dst,
+                     const char* src,
+                     size_t length,
+                     const uint8_t mask[4],
+                     uint64_t offset) {
+  uint8_t key[8];
+  for (size_t i = 0; i < sizeof(key); i++)
+    key[i] = mask[(offset + i) & 3];
+  uint64_t word;
+  memcpy(&word, key, sizeof(word));
+
+  size_t i = 0;
+  for (; i + sizeof(word) <= length; i += sizeof(word)) {
+    uint64_t chunk;
+    memcpy(&chunk, src + i, sizeof(chunk));
+    chunk ^= word;
+    memcpy(dst + i, &chunk, sizeof(chunk));
+  }
+  for (; i < length; i++)
+    dst[i] = src[i] ^ key[i & 7];
+}
+
+
+// Text messages and close reasons have to be UTF-8, RFC 3629 with neither
+// overlong forms nor surrogates.  Runs of ASCII are skipped eight bytes at
+// a time.
+static bool IsValidUtf8(const char* data, size_t length) {
+  const uint8_t* p = reinterpret_cast<const uint8_t*>(data);
+  const uint8_t* const end = p + length;
+  while (p < end) {
+    if (end - p >= 8) {
+      uint64_t chunk;
+      memcpy(&chunk, p, sizeof(chunk));
+      if ((chunk & 0x8080808080808080ull) == 0) {
+        p += 8;
+        continue;
+      }
+    }
+    const uint8_t c = *p;
+    if (c < 0x80) {
+      p++;
+      continue;
+    }
+
+    size_t n;
+    uint8_t min = 0x80;
+    uint8_t max = 0xbf;
+    if (c >= 0xc2 && c <= 0xdf) {
+      n = 1;
+    } else if (c >= 0xe0 && c <= 0xef) {
+      n = 2;
+      if (c == 0xe0)
+        min = 0xa0;  // Overlong.
+      else if (c == 0xed)
+        max = 0x9f;  // Surrogates.
+    } else if (c >= 0xf0 && c <= 0xf4) {
+      n = 3;
+      if (c == 0xf0)
+        min = 0x90;  // Overlong.
+      else if (c == 0xf4)
+        max = 0x8f;  // Above U+10FFFF.
+    } else {
+      return false;
+    }
+    if (static_cast<size_t>(end - p) <= n)
+      return false;
+    if (p[1] < min || p[1] > max)
+      return false;
+    for (size_t i = 2; i <= n; i++) {
+      if ((p[i] & 0xc0) != 0x80)
+        return false;
+    }
+    p += n + 1;
+  }
+  return true;
+}
+
+
+// The codes that may be sent in close frames, section 7.4 of RFC 6455.
+static bool IsValidCloseCode(uint16_t code) {
+  if (code >= 3000 && code <= 4999)
+    return true;
+  return (code >= 1000 && code <= 1003) || (code >= 1007 && code <= 1011);
+}
+
+
+static void NewMaskingKey(uint8_t key[4]) {
+#if HAVE_OPENSSL
+  if (crypto::EntropySource(key, 4))
+    return;
+#endif
+  // Without OpenSSL there is nothing better than the clock.
+  uint64_t seed = uv_hrtime() * 0x9e3779b97f4a7c15ull;
+  seed ^= seed >> 29;
+  memcpy(key, &seed, 4);
+}
+
+
+char* WebSocketWrap::Payload::Grow(size_t size) {
+  if (capacity - length < size) {
+    size_t new_capacity = length + size;
+    if (new_capacity < capacity * 2)
+      new_capacity = capacity * 2;
+    char* new_data = static_cast<char*>(realloc(data, new_capacity));
+    if (new_data == nullptr) {
+      FatalError("node::WebSocketWrap::Payload::Grow(size_t)",
+                 "Out Of Memory");
+    }
+    data = new_data;
+    capacity = new_capacity;
+  }
+  return data + length;
+}
+
+
+char* WebSocketWrap::Payload::Release() {
+  char* result = data;
+  data = nullptr;
+  length = 0;
+  capacity = 0;
+  return result;
+}
+
+
+WebSocketWrap::WebSocketWrap(Environment* env,
+                             Local<Object> object,
+                             bool client,
+                             size_t max_payload,
+                             bool deflate)
+    : AsyncWrap(env, object, AsyncWrap::PROVIDER_WEBSOCKET),
+      stream_(nullptr),
+      client_(client),
+      max_payload_(max_payload),
+      deflate_(deflate),
+      destroyed_(false),
+      depth_(0),
+      close_sent_(false),
+      pending_bytes_(0),
+      pending_writes_(0),
+      state_(kReadHeader),
+      header_length_(0),
+      header_needed_(2),
+      fin_(false),
+      compressed_(false),
+      opcode_(0),
+      masked_(false),
+      frame_length_(0),
+      frame_read_(0),
+      message_opcode_(0),
+      message_compressed_(false),
+      inflate_ready_(false),
+      deflate_ready_(false) {
+  memset(mask_, 0, sizeof(mask_));
+  memset(&inflate_stream_, 0, sizeof(inflate_stream_));
+  memset(&deflate_stream_, 0, sizeof(deflate_stream_));
+  Wrap(object, this);
+}
+
+
+WebSocketWrap::~WebSocketWrap() {
+  CHECK_EQ(stream_, nullptr);
+  CHECK_EQ(pending_writes_, 0);
+  if (inflate_ready_)
+    inflateEnd(&inflate_stream_);
+  if (deflate_ready_)
+    deflateEnd(&deflate_stream_);
+}
+
+
+void WebSocketWrap::Initialize(Local<Object> target,
+                               Local<Value> unused,
+                               Local<Context> context) {
+  Environment* env = Environment::GetCurrent(context);
+
+  Local<FunctionTemplate> t = env->NewFunctionTemplate(New);
+  t->InstanceTemplate()->SetInternalFieldCount(1);
+  t->SetClassName(FIXED_ONE_BYTE_STRING(env->isolate(), "WebSocketWrap"));
+
+#define V(name)                                                               \
+  t->Set(FIXED_ONE_BYTE_STRING(env->isolate(), #name),                        \
+         Integer::NewFromUnsigned(env->isolate(), name));
+  V(kOnMessage)
+  V(kOnPing)
+  V(kOnPong)
+  V(kOnClose)
+  V(kOnError)
+  V(kOnDrain)
+  V(kText)
+  V(kBinary)
+  V(kPing)
+  V(kPong)
+#undef V
+
+  env->SetProtoMethod(t, "consume", Consume);
+  env->SetProtoMethod(t, "receive", Receive);
+  env->SetProtoMethod(t, "send", Send);
+  env->SetProtoMethod(t, "close", Close);
+  env->SetProtoMethod(t, "destroy", Destroy);
+
+  target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "WebSocketWrap"),
+              t->GetFunction());
+}
+
+
+// new WebSocketWrap(isClient, maxPayload, perMessageDeflate)
+void WebSocketWrap::New(const FunctionCallbackInfo<Value>& args) {
+  CHECK(args.IsConstructCall());
+  CHECK(args[1]->IsNumber());
+  Environment* env = Environment::GetCurrent(args);
+  const double max_payload = args[1]->NumberValue();
+  CHECK(max_payload >= 0 && max_payload <= Buffer::kMaxLength);
+  new WebSocketWrap(env,
+                    args.This(),
+                    args[0]->IsTrue(),
+                    static_cast<size_t>(max_payload),
+                    args[2]->IsTrue());
+}
+
+
+// consume(socket._handle._externalStream)
+void WebSocketWrap::Consume(const FunctionCallbackInfo<Value>& args) {
+  WebSocketWrap* wrap = Unwrap<WebSocketWrap>(args.Holder());
+  CHECK(args[0]->IsExternal());
+  CHECK_EQ(wrap->stream_, nullptr);
+  CHECK_EQ(wrap->destroyed_, false);
+  StreamBase* stream =
+      static_cast<StreamBase*>(args[0].As<External>()->Value());
+  CHECK_NE(stream, nullptr);
+
+  stream->Consume();
+  wrap->prev_alloc_cb_ = stream->alloc_cb();
+  wrap->prev_read_cb_ = stream->read_cb();
+  stream->set_alloc_cb({ OnAlloc, wrap });
+  stream->set_read_cb({ OnRead, wrap });
+  wrap->stream_ = stream;
+
+  args.GetReturnValue().Set(stream->ReadStart());
+}
+
+
+// Data that the socket read before it was consumed, the `head` of an
+// upgrade for example.
+void WebSocketWrap::Receive(const FunctionCallbackInfo<Value>& args) {
+  WebSocketWrap* wrap = Unwrap<WebSocketWrap>(args.Holder());
+  CHECK(Buffer::HasInstance(args[0]));
+  wrap->ReceiveData(Buffer::Data(args[0]), Buffer::Length(args[0]));
+}
+
+
+// send(data, opcode, compress), data a Buffer or a string.  Returns how
+// much is waiting to be written.
+void WebSocketWrap::Send(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  WebSocketWrap* wrap = Unwrap<WebSocketWrap>(args.Holder());
+  CHECK(args[1]->IsUint32());
+  const uint32_t opcode = args[1]->Uint32Value();
+  CHECK(opcode == kText || opcode == kBinary ||
+        opcode == kPing || opcode == kPong);
+
+  if (wrap->destroyed_ || wrap->close_sent_ || wrap->stream_ == nullptr)
+    return args.GetReturnValue().Set(UV_EPIPE);
+
+  const bool compress = args[2]->IsTrue();
+  if (Buffer::HasInstance(args[0])) {
+    wrap->SendData(opcode,
+                   compress,
+                   Buffer::Data(args[0]),
+                   Buffer::Length(args[0]));
+  } else {
+    CHECK(args[0]->IsString());
+    Utf8Value string(env->isolate(), args[0]);
+    wrap->SendData(opcode, compress, *string, string.length());
+  }
+  args.GetReturnValue().Set(static_cast<double>(wrap->pending_bytes_));
+}
+
+
+// close(code, reason), reason a Buffer.  A code of 0 sends a close frame
+// without a body.
+void WebSocketWrap::Close(const FunctionCallbackInfo<Value>& args) {
+  WebSocketWrap* wrap = Unwrap<WebSocketWrap>(args.Holder());
+  CHECK(args[0]->IsUint32());
+  CHECK(Buffer::HasInstance(args[1]));
+  const size_t length = Buffer::Length(args[1]);
+  CHECK_LE(length, kMaxControlPayload - 2);
+  if (wrap->destroyed_)
+    return;
+  wrap->SendClose(args[0]->Uint32Value(), Buffer::Data(args[1]), length);
+}
+
+
+void WebSocketWrap::Destroy(const FunctionCallbackInfo<Value>& args) {
+  WebSocketWrap* wrap = Unwrap<WebSocketWrap>(args.Holder());
+  if (wrap->destroyed_)
+    return;
+  wrap->Detach();
+  wrap->destroyed_ = true;
+  wrap->state_ = kReadDone;
+  wrap->MaybeRelease();
+}
+
+
+void WebSocketWrap::OnAlloc(size_t suggested_size, uv_buf_t* buf, void* ctx) {
+  // Everything that is kept is copied out before the next read.
+  WebSocketWrap* wrap = static_cast<WebSocketWrap*>(ctx);
+  *buf = uv_buf_init(wrap->env()->shared_read_buffer(),
+                     Environment::kSharedReadBufferSize);
+}
+
+
+void WebSocketWrap::OnRead(ssize_t nread,
+                           const uv_buf_t* buf,
+                           uv_handle_type pending,
+                           void* ctx) {
+  WebSocketWrap* wrap = static_cast<WebSocketWrap*>(ctx);
+  if (nread > 0) {
+    wrap->ReceiveData(buf->base, nread);
+    return;
+  }
+  if (nread == 0)
+    return;
+
+  // The socket's JS object sees the EOF or the error with its own
+  // callbacks, lib/websocket.js closes the connection from there.
+  uv_buf_t empty = uv_buf_init(nullptr, 0);
+  StreamResource::Callback<StreamResource::ReadCb> read_cb =
+      wrap->prev_read_cb_;
+  wrap->Detach();
+  read_cb.fn(nread, &empty, pending, read_cb.ctx);
+}
+
+
+void WebSocketWrap::ReceiveData(const char* data, size_t length) {
+  if (state_ == kReadDone)
+    return;
+  HandleScope handle_scope(env()->isolate());
+  Context::Scope context_scope(env()->context());
+  // destroy() from one of the callbacks only takes effect once the parser
+  // has returned.
+  depth_++;
+  Parse(data, length);
+  depth_--;
+  MaybeRelease();
+}
+
+
+void WebSocketWrap::Call(uint32_t index, int argc, Local<Value>* argv) {
+  Local<Value> cb = object()->Get(index);
+  if (cb->IsFunction())
+    MakeCallback(cb.As<Function>(), argc, argv);
+}
+
+
+void WebSocketWrap::Parse(const char* data, size_t length) {
+  while (length > 0 && state_ != kReadDone) {
+    if (state_ == kReadHeader) {
+      size_t n = header_needed_ - header_length_;
+      if (n > length)
+        n = length;
+      memcpy(header_ + header_length_, data, n);
+      header_length_ += n;
+      data += n;
+      length -= n;
+
+      // The second byte tells how long the rest of the header is.
+      if (header_length_ == 2 && header_needed_ == 2) {
+        const uint8_t length_bits = header_[1] & 0x7f;
+        if (length_bits == 126)
+          header_needed_ += 2;
+        else if (length_bits == 127)
+          header_needed_ += 8;
+        if (header_[1] & 0x80)
+          header_needed_ += 4;
+      }
+      if (header_length_ < header_needed_)
+        continue;
+      if (!OnHeader())
+        return;
+      if (frame_length_ == 0 && !OnFrameEnd())
+        return;
+      continue;
+    }
+
+    // The payload, unmasked on its way out of the read buffer.
+    uint64_t n = frame_length_ - frame_read_;
+    if (n > length)
+      n = length;
+    Payload* payload = opcode_ >= kClose ? &control_ : &message_;
+    char* dst = payload->Grow(n);
+    if (masked_)
+      MaskCopy(dst, data, n, mask_, frame_read_);
+    else
+      memcpy(dst, data, n);
+    payload->length += n;
+    frame_read_ += n;
+    data += n;
+    length -= n;
+
+    if (frame_read_ == frame_length_ && !OnFrameEnd())
+      return;
+  }
+}
+
+
+bool WebSocketWrap::OnHeader() {
+  const uint8_t* header = header_;
+  fin_ = (header[0] & 0x80) != 0;
+  compressed_ = (header[0] & 0x40) != 0;
+  opcode_ = header[0] & 0x0f;
+  masked_ = (header[1] & 0x80) != 0;
+
+  size_t offset = 2;
+  frame_length_ = header[1] & 0x7f;
+  if (frame_length_ == 126) {
+    frame_length_ = (header[2] << 8) | header[3];
+    offset += 2;
+  } else if (frame_length_ == 127) {
+    frame_length_ = 0;
+    for (size_t i = 0; i < 8; i++)
+      frame_length_ = (frame_length_ << 8) | header[2 + i];
+    offset += 8;
+    if (frame_length_ >> 63) {
+      Fail(kProtocolError, "Invalid frame length");
+      return false;
+    }
+  }
+  if (masked_)
+    memcpy(mask_, header + offset, sizeof(mask_));
+  frame_read_ = 0;
+
+  if (header[0] & 0x30) {
+    Fail(kProtocolError, "Reserved bits are set");
+    return false;
+  }
+  // Clients mask what they send, servers don't.
+  if (masked_ == client_) {
+    Fail(kProtocolError, masked_ ? "Masked frame from the server"
+                                 : "Unmasked frame from the client");
+    return false;
+  }
+
+  if (opcode_ >= kClose) {
+    if (opcode_ != kClose && opcode_ != kPing && opcode_ != kPong) {
+      Fail(kProtocolError, "Unknown opcode");
+      return false;
+    }
+    if (!fin_ || compressed_ || frame_length_ > kMaxControlPayload) {
+      Fail(kProtocolError, "Invalid control frame");
+      return false;
+    }
+    control_.length = 0;
+    control_.Grow(frame_length_);
+    return true;
+  }
+
+  if (opcode_ == kContinuation) {
+    if (message_opcode_ == 0) {
+      Fail(kProtocolError, "Continuation frame without a message");
+      return false;
+    }
+    if (compressed_) {
+      Fail(kProtocolError, "Compression bit on a continuation frame");
+      return false;
+    }
+  } else if (opcode_ == kText || opcode_ == kBinary) {
+    if (message_opcode_ != 0) {
+      Fail(kProtocolError, "New message before the last one ended");
+      return false;
+    }
+    if (compressed_ && !deflate_) {
+      Fail(kProtocolError, "Compressed frame without permessage-deflate");
+      return false;
+    }
+    message_opcode_ = opcode_;
+    message_compressed_ = compressed_;
+  } else {
+    Fail(kProtocolError, "Unknown opcode");
+    return false;
+  }
+
+  if (frame_length_ > max_payload_ - message_.length) {
+    Fail(kMessageTooBig, "Message is too big");
+    return false;
+  }
+  message_.Grow(frame_length_);
+  return true;
+}
+
+
+bool WebSocketWrap::OnFrameEnd() {
+  state_ = kReadHeader;
+  header_length_ = 0;
+  header_needed_ = 2;
+
+  if (opcode_ == kClose)
+    return OnCloseFrame();
+
+  if (opcode_ == kPing || opcode_ == kPong) {
+    if (opcode_ == kPing && !close_sent_)
+      WriteFrame(kPong, false, control_.data, control_.length);
+    const uint32_t index = opcode_ == kPing ? kOnPing : kOnPong;
+    Local<Value> argv[] = {
+      Buffer::Copy(env(), control_.data, control_.length).ToLocalChecked()
+    };
+    control_.length = 0;
+    Call(index, arraysize(argv), argv);
+    return state_ != kReadDone;
+  }
+
+  if (!fin_)
+    return true;
+  return OnMessage();
+}
+
+
+bool WebSocketWrap::OnMessage() {
+  const bool binary = message_opcode_ == kBinary;
+  message_opcode_ = 0;
+
+  Payload inflated;
+  Payload* message = &message_;
+  if (message_compressed_) {
+    if (!Inflate(&inflated))
+      return false;
+    message_.Clear();
+    message = &inflated;
+  }
+
+  Local<Value> data;
+  if (binary) {
+    const size_t length = message->length;
+    data = Buffer::New(env(), message->Release(), length).ToLocalChecked();
+  } else {
+    if (!IsValidUtf8(message->data, message->length)) {
+      Fail(kInvalidPayload, "Invalid UTF-8 in a text message");
+      return false;
+    }
+    MaybeLocal<String> string =
+        String::NewFromUtf8(env()->isolate(),
+                            message->data,
+                            NewStringType::kNormal,
+                            message->length);
+    if (string.IsEmpty()) {
+      Fail(kMessageTooBig, "Message is too big for a string");
+      return false;
+    }
+    data = string.ToLocalChecked();
+    message->Clear();
+  }
+
+  Local<Value> argv[] = { data, Boolean::New(env()->isolate(), binary) };
+  Call(kOnMessage, arraysize(argv), argv);
+  return state_ != kReadDone;
+}
+
+
+bool WebSocketWrap::OnCloseFrame() {
+  uint16_t code = kNoStatus;
+  const char* reason = "";
+  size_t reason_length = 0;
+  if (control_.length == 1) {
+    Fail(kProtocolError, "Invalid close frame");
+    return false;
+  }
+  if (control_.length >= 2) {
+    const uint8_t* body = reinterpret_cast<const uint8_t*>(control_.data);
+    code = (body[0] << 8) | body[1];
+    reason = control_.data + 2;
+    reason_length = control_.length - 2;
+    if (!IsValidCloseCode(code)) {
+      Fail(kProtocolError, "Invalid close code");
+      return false;
+    }
+    if (!IsValidUtf8(reason, reason_length)) {
+      Fail(kInvalidPayload, "Invalid UTF-8 in the close reason");
+      return false;
+    }
+  }
+
+  // Anything after the close frame is ignored.  The code is echoed if
+  // the peer started the closing handshake.
+  state_ = kReadDone;
+  SendClose(code == kNoStatus ? 0 : code, nullptr, 0);
+
+  Local<Value> argv[] = {
+    Integer::NewFromUnsigned(env()->isolate(), code),
+    String::NewFromUtf8(env()->isolate(),
+                        reason,
+                        String::kNormalString,
+                        reason_length)
+  };
+  control_.length = 0;
+  Call(kOnClose, arraysize(argv), argv);
+  return false;
+}
+
+
+// onerror(closeCode, message) for protocol errors, onerror(uvError) for
+// failed writes.
+void WebSocketWrap::Fail(uint16_t code, const char* message) {
+  state_ = kReadDone;
+  SendClose(code, nullptr, 0);
+  Local<Value> argv[] = {
+    Integer::NewFromUnsigned(env()->isolate(), code),
+    OneByteString(env()->isolate(), message)
+  };
+  Call(kOnError, arraysize(argv), argv);
+}
+
+
+// Inflates message_ into `out`.  permessage-deflate is negotiated without
+// context takeover, so every message starts with a fresh window.
+bool WebSocketWrap::Inflate(Payload* out) {
+  if (!inflate_ready_) {
+    if (inflateInit2(&inflate_stream_, -15) != Z_OK) {
+      Fail(kInternalError, "Could not initialize zlib");
+      return false;
+    }
+    inflate_ready_ = true;
+  }
+
+  // The end of the flushed block that senders leave out, section 7.2.2 of
+  // RFC 7692.
+  static const char trailer[] = { 0x00, 0x00, '\xff', '\xff' };
+  memcpy(message_.Grow(sizeof(trailer)), trailer, sizeof(trailer));
+  message_.length += sizeof(trailer);
+
+  inflate_stream_.next_in = reinterpret_cast<Bytef*>(message_.data);
+  inflate_stream_.avail_in = message_.length;
+  uint16_t error = 0;
+  for (;;) {
+    char* next = out->Grow(kInflateChunk);
+    const size_t avail = out->capacity - out->length;
+    inflate_stream_.next_out = reinterpret_cast<Bytef*>(next);
+    inflate_stream_.avail_out = avail;
+    const int err = inflate(&inflate_stream_, Z_SYNC_FLUSH);
+    out->length += avail - inflate_stream_.avail_out;
+    if (err != Z_OK && err != Z_BUF_ERROR && err != Z_STREAM_END) {
+      error = kInvalidPayload;
+      break;
+    }
+    if (out->length > max_payload_) {
+      error = kMessageTooBig;
+      break;
+    }
+    if (err == Z_STREAM_END ||
+        (inflate_stream_.avail_in == 0 && inflate_stream_.avail_out > 0)) {
+      break;
+    }
+  }
+  inflateReset(&inflate_stream_);
+
+  if (error == kInvalidPayload) {
+    Fail(kInvalidPayload, "Invalid compressed data");
+    return false;
+  }
+  if (error == kMessageTooBig) {
+    Fail(kMessageTooBig, "Message is too big");
+    return false;
+  }
+  return true;
+}
+
+
+void WebSocketWrap::Deflate(const char* data, size_t length, Payload* out) {
+  if (!deflate_ready_) {
+    int err = deflateInit2(&deflate_stream_,
+                           Z_DEFAULT_COMPRESSION,
+                           Z_DEFLATED,
+                           -15,
+                           8,
+                           Z_DEFAULT_STRATEGY);
+    CHECK_EQ(err, Z_OK);
+    deflate_ready_ = true;
+  }
+
+  deflate_stream_.next_in =
+      reinterpret_cast<Bytef*>(const_cast<char*>(data));
+  deflate_stream_.avail_in = length;
+  size_t chunk = deflateBound(&deflate_stream_, length) + 16;
+  for (;;) {
+    char* next = out->Grow(chunk);
+    const size_t avail = out->capacity - out->length;
+    deflate_stream_.next_out = reinterpret_cast<Bytef*>(next);
+    deflate_stream_.avail_out = avail;
+    const int err = deflate(&deflate_stream_, Z_SYNC_FLUSH);
+    CHECK(err == Z_OK || err == Z_BUF_ERROR);
+    out->length += avail - deflate_stream_.avail_out;
+    if (deflate_stream_.avail_out > 0)
+      break;
+    chunk = kInflateChunk;
+  }
+  deflateReset(&deflate_stream_);
+
+  // The flush ends with 00 00 ff ff, which is not sent.
+  CHECK_GE(out->length, 4);
+  out->length -= 4;
+}
+
+
+void WebSocketWrap::SendData(uint8_t opcode,
+                             bool compress,
+                             const char* data,
+                             size_t length) {
+  if (opcode == kPing || opcode == kPong) {
+    CHECK_LE(length, kMaxControlPayload);
+    WriteFrame(opcode, false, data, length);
+  } else if (compress && deflate_) {
+    Payload compressed;
+    Deflate(data, length, &compressed);
+    WriteFrame(opcode, true, compressed.data, compressed.length);
+  } else {
+    WriteFrame(opcode, false, data, length);
+  }
+}
+
+
+void WebSocketWrap::SendClose(uint16_t code,
+                              const char* reason,
+                              size_t length) {
+  if (close_sent_)
+    return;
+  close_sent_ = true;
+  if (code == 0)
+    return WriteFrame(kClose, false, nullptr, 0);
+
+  char body[kMaxControlPayload];
+  CHECK_LE(length + 2, sizeof(body));
+  body[0] = code >> 8;
+  body[1] = code & 0xff;
+  if (length > 0)
+    memcpy(body + 2, reason, length);
+  WriteFrame(kClose, false, body, length + 2);
+}
+
+
+void WebSocketWrap::WriteFrame(uint8_t opcode,
+                               bool compressed,
+                               const char* data,
+                               size_t length) {
+  if (stream_ == nullptr || !stream_->IsAlive())
+    return;
+
+  uint8_t header[kMaxHeaderLength];
+  size_t header_length = 2;
+  header[0] = 0x80 | (compressed ? 0x40 : 0) | opcode;
+  if (length < 126) {
+    header[1] = length;
+  } else if (length <= 0xffff) {
+    header[1] = 126;
+    header[2] = length >> 8;
+    header[3] = length & 0xff;
+    header_length += 2;
+  } else {
+    header[1] = 127;
+    for (size_t i = 0; i < 8; i++)
+      header[2 + i] = static_cast<uint64_t>(length) >> (56 - i * 8);
+    header_length += 8;
+  }
+
+  Payload masked;
+  if (client_) {
+    uint8_t key[4];
+    NewMaskingKey(key);
+    header[1] |= 0x80;
+    memcpy(header + header_length, key, sizeof(key));
+    header_length += sizeof(key);
+    if (length > 0) {
+      MaskCopy(masked.Grow(length), data, length, key, 0);
+      data = masked.data;
+    }
+  }
+
+  const size_t total = header_length + length;
+  uv_buf_t storage[] = {
+    uv_buf_init(reinterpret_cast<char*>(header), header_length),
+    uv_buf_init(const_cast<char*>(data), length)
+  };
+  uv_buf_t* bufs = storage;
+  size_t count = length > 0 ? 2 : 1;
+
+  int err = stream_->DoTryWrite(&bufs, &count);
+  if (err == 0 && count == 0) {
+    stream_->OnBytesWritten(total);
+    return;
+  }
+
+  if (err == 0) {
+    HandleScope handle_scope(env()->isolate());
+    Context::Scope context_scope(env()->context());
+
+    // What is left is copied behind the PendingWrite.
+    size_t rest = 0;
+    for (size_t i = 0; i < count; i++)
+      rest += bufs[i].len;
+    Local<Object> req_wrap_obj =
+        env()->write_wrap_constructor_function()
+            ->NewInstance(env()->context()).ToLocalChecked();
+    WriteWrap* req_wrap = WriteWrap::New(env(),
+                                         req_wrap_obj,
+                                         stream_,
+                                         OnWriteDone,
+                                         sizeof(PendingWrite) + rest);
+    PendingWrite* write = reinterpret_cast<PendingWrite*>(req_wrap->Extra());
+    char* copy = req_wrap->Extra() + sizeof(PendingWrite);
+    size_t offset = 0;
+    for (size_t i = 0; i < count; i++) {
+      memcpy(copy + offset, bufs[i].base, bufs[i].len);
+      offset += bufs[i].len;
+    }
+    write->wrap = this;
+    write->length = rest;
+    uv_buf_t copy_buf = uv_buf_init(copy, rest);
+
+    err = stream_->DoWrite(req_wrap, &copy_buf, 1, nullptr);
+    if (err) {
+      req_wrap->Dispose();
+    } else {
+      stream_->OnBytesWritten(total);
+      pending_bytes_ += rest;
+      pending_writes_++;
+    }
+  }
+
+  if (stream_->Error() != nullptr)
+    stream_->ClearError();
+
+  if (err)
+    WriteFailed(err);
+}
+
+
+void WebSocketWrap::OnWriteDone(WriteWrap* req_wrap, int status) {
+  PendingWrite* write = reinterpret_cast<PendingWrite*>(req_wrap->Extra());
+  WebSocketWrap* wrap = write->wrap;
+  StreamBase* stream = req_wrap->wrap();
+
+  wrap->pending_bytes_ -= write->length;
+  wrap->pending_writes_--;
+  stream->OnAfterWrite(req_wrap);
+  req_wrap->Dispose();
+
+  if (!wrap->destroyed_) {
+    HandleScope handle_scope(wrap->env()->isolate());
+    Context::Scope context_scope(wrap->env()->context());
+    wrap->depth_++;
+    if (status != 0 && status != UV_ECANCELED)
+      wrap->WriteFailed(status);
+    else if (status == 0 && wrap->pending_bytes_ == 0)
+      wrap->Call(kOnDrain, 0, nullptr);
+    wrap->depth_--;
+  }
+  wrap->MaybeRelease();
+}
+
+
+void WebSocketWrap::WriteFailed(int status) {
+  HandleScope scope(env()->isolate());
+  Local<Value> argv[] = {
+    Integer::New(env()->isolate(), status),
+    Undefined(env()->isolate())
+  };
+  state_ = kReadDone;
+  Detach();
+  Call(kOnError, arraysize(argv), argv);
+}
+
+
+void WebSocketWrap::Detach() {
+  if (stream_ == nullptr)
+    return;
+  stream_->set_alloc_cb(prev_alloc_cb_);
+  stream_->set_read_cb(prev_read_cb_);
+  prev_alloc_cb_.clear();
+  prev_read_cb_.clear();
+  stream_ = nullptr;
+}
+
+
+// The GC can have the wrap once JS destroyed it, nothing is on the stack
+// and the last write is done.
+void WebSocketWrap::MaybeRelease() {
+  if (!destroyed_ || depth_ > 0 || pending_writes_ > 0 ||
+      persistent().IsWeak()) {
+    return;
+  }
+  MakeWeak<WebSocketWrap>(this);
+}
+
+}  // namespace node
+
+NODE_MODULE_CONTEXT_AWARE_BUILTIN(websocket_wrap,
+                                  node::WebSocketWrap::Initialize)
@@ -0,0 +1,165 @@
+#ifndef SRC_WEBSOCKET_WRAP_H_
+#define SRC_WEBSOCKET_WRAP_H_
+
+#include "stream_base.h"
+
+#include "async-wrap.h"
+#include "env.h"
+#include "util.h"
+#include "uv.h"
+#include "v8.h"
+#include "zlib.h"
+
+namespace node {
+
+// The WebSocket framing of RFC 6455, with permessage-deflate (RFC 7692),
+// on top of a StreamBase whose handshake is done.  Frames are unmasked and
+// fragments put together in C++; JS gets whole messages, as Buffers or, for
+// text messages, as strings.  Pings are answered with pongs right away.
+// Protocol errors close the connection with the matching close code.
+class WebSocketWrap : public AsyncWrap {
+ public:
+  ~WebSocketWrap() override;
+
+  static void Initialize(v8::Local<v8::Object> target,
+                         v8::Local<v8::Value> unused,
+                         v8::Local<v8::Context> context);
+
+  size_t self_size() const override { return sizeof(*this); }
+
+ private:
+  enum Opcode {
+    kContinuation = 0x0,
+    kText = 0x1,
+    kBinary = 0x2,
+    kClose = 0x8,
+    kPing = 0x9,
+    kPong = 0xa
+  };
+
+  enum CloseCode {
+    kNormalClosure = 1000,
+    kNoStatus = 1005,
+    kProtocolError = 1002,
+    kInvalidPayload = 1007,
+    kMessageTooBig = 1009,
+    kInternalError = 1011
+  };
+
+  // Lives in the extra storage of the WriteWraps, followed by the bytes
+  // that could not be written right away.
+  struct PendingWrite {
+    WebSocketWrap* wrap;
+    size_t length;
+  };
+
+  // A message that grows fragment by fragment, malloc()ed so that a Buffer
+  // can take it over.
+  struct Payload {
+    Payload() : data(nullptr), length(0), capacity(0) {}
+    ~Payload() { free(data); }
+
+    char* Grow(size_t size);
+    char* Release();
+    void Clear() { free(Release()); }
+
+    char* data;
+    size_t length;
+    size_t capacity;
+  };
+
+  enum ReadState {
+    kReadHeader,
+    kReadPayload,
+    kReadDone    // After a close frame or an error, the rest is ignored.
+  };
+
+  static const size_t kMaxHeaderLength = 14;
+  static const size_t kMaxControlPayload = 125;
+  static const size_t kInflateChunk = 16 * 1024;
+
+  WebSocketWrap(Environment* env,
+                v8::Local<v8::Object> object,
+                bool client,
+                size_t max_payload,
+                bool deflate);
+
+  static void New(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void Consume(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void Receive(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void Send(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void Close(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void Destroy(const v8::FunctionCallbackInfo<v8::Value>& args);
+
+  static void OnAlloc(size_t size, uv_buf_t* buf, void* ctx);
+  static void OnRead(ssize_t nread,
+                     const uv_buf_t* buf,
+                     uv_handle_type pending,
+                     void* ctx);
+  static void OnWriteDone(WriteWrap* req_wrap, int status);
+
+  void ReceiveData(const char* data, size_t length);
+  void Call(uint32_t index, int argc, v8::Local<v8::Value>* argv);
+  void Parse(const char* data, size_t length);
+  bool OnHeader();
+  bool OnFrameEnd();
+  bool OnMessage();
+  bool OnCloseFrame();
+  // Sends a close frame with `code`, tells JS and ignores the rest.
+  void Fail(uint16_t code, const char* message);
+
+  bool Inflate(Payload* out);
+  void Deflate(const char* data, size_t length, Payload* out);
+  void SendData(uint8_t opcode,
+                bool compress,
+                const char* data,
+                size_t length);
+  void SendClose(uint16_t code, const char* reason, size_t length);
+  void WriteFrame(uint8_t opcode,
+                  bool compressed,
+                  const char* data,
+                  size_t length);
+  void WriteFailed(int status);
+  void Detach();
+  void MaybeRelease();
+
+  StreamBase* stream_;
+  StreamResource::Callback<StreamResource::AllocCb> prev_alloc_cb_;
+  StreamResource::Callback<StreamResource::ReadCb> prev_read_cb_;
+  const bool client_;
+  const size_t max_payload_;
+  const bool deflate_;
+  bool destroyed_;
+  int depth_;
+  bool close_sent_;
+  size_t pending_bytes_;
+  size_t pending_writes_;
+
+  ReadState state_;
+  uint8_t header_[kMaxHeaderLength];
+  size_t header_length_;
+  size_t header_needed_;
+  bool fin_;
+  bool compressed_;
+  uint8_t opcode_;
+  uint8_t mask_[4];
+  bool masked_;
+  uint64_t frame_length_;
+  uint64_t frame_read_;
+
+  Payload control_;            // The payload of a control frame.
+  Payload message_;            // The fragments of a data message so far.
+  uint8_t message_opcode_;     // kText or kBinary, 0 between messages.
+  bool message_compressed_;
+
+  z_stream inflate_stream_;
+  z_stream deflate_stream_;
+  bool inflate_ready_;
+  bool deflate_ready_;
+
+  DISALLOW_COPY_AND_ASSIGN(WebSocketWrap);
+};
+
+}  // namespace node
+
+#endif  // SRC_WEBSOCKET_WRAP_H_
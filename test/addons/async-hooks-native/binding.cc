@@ -0,0 +1,77 @@
+#include <node.h>
+#include <v8.h>
+
+#include <assert.h>
+
+struct counters {
+  int init;
+  int before;
+  int after;
+  int destroy;
+  int batches;
+  int depth;
+};
+
+static counters counts;
+
+static void Init(int64_t uid, int provider, int64_t parent_uid, void* data) {
+  assert(data == &counts);
+  assert(uid > 0);
+  counts.init++;
+}
+
+static void Before(int64_t uid, void* data) {
+  assert(counts.depth == 0);
+  counts.depth++;
+  counts.before++;
+}
+
+static void After(int64_t uid, bool did_throw, void* data) {
+  assert(counts.depth == 1);
+  assert(!did_throw);
+  counts.depth--;
+  counts.after++;
+}
+
+static void Destroy(const int64_t* uids, size_t count, void* data) {
+  assert(count > 0);
+  for (size_t i = 0; i < count; i++)
+    assert(uids[i] > 0);
+  counts.destroy += static_cast<int>(count);
+  counts.batches++;
+}
+
+static node::NativeAsyncHooks hooks = {
+  Init, Before, After, Destroy, &counts
+};
+
+void Start(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  node::AddNativeAsyncHooks(args.GetIsolate()->GetCurrentContext(), &hooks);
+}
+
+void Stop(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  node::RemoveNativeAsyncHooks(args.GetIsolate()->GetCurrentContext(), &hooks);
+}
+
+void Counts(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  v8::Isolate* isolate = args.GetIsolate();
+  v8::Local<v8::Object> result = v8::Object::New(isolate);
+#define V(name)                                                               \
+  result->Set(v8::String::NewFromUtf8(isolate, #name),                        \
+              v8::Integer::New(isolate, counts.name));
+  V(init)
+  V(before)
+  V(after)
+  V(destroy)
+  V(batches)
+#undef V
+  args.GetReturnValue().Set(result);
+}
+
+void init(v8::Local<v8::Object> exports) {
+  NODE_SET_METHOD(exports, "start", Start);
+  NODE_SET_METHOD(exports, "stop", Stop);
+  NODE_SET_METHOD(exports, "counts", Counts);
+}
+
+NODE_MODULE(binding, init);
@@ -0,0 +1,35 @@
+'use strict';
+const common = require('../../common');
+const assert = require('assert');
+const fs = require('fs');
+const binding = require('./build/Release/binding');
+
+const requests = 10;
+
+binding.start();
+
+let pending = requests;
+for (let i = 0; i < requests; i++) {
+  fs.access(__filename, common.mustCall(function(err) {
+    assert.ifError(err);
+    if (--pending === 0)
+      setImmediate(waitForDestroy);
+  }));
+}
+
+// The destroyed requests are reported from the idle phase of the next turn
+// of the loop, before the immediates of that turn.
+function waitForDestroy() {
+  setImmediate(check);
+}
+
+function check() {
+  const counts = binding.counts();
+  assert.strictEqual(counts.init, requests);
+  assert.strictEqual(counts.before, requests);
+  assert.strictEqual(counts.after, requests);
+  assert.strictEqual(counts.destroy, requests);
+  assert(counts.batches >= 1);
+  assert(counts.batches <= requests);
+  binding.stop();
+}
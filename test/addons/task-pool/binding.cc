@@ -0,0 +1,101 @@
+#include <node.h>
+#include <v8.h>
+#include <uv.h>
+
+#include <assert.h>
+
+// Sums the integers below |limit|.  The task splits itself into subtasks
+// that are queued from the pool's threads and can be stolen.
+struct sum_req {
+  v8::Isolate* isolate;
+  v8::Persistent<v8::Function> callback;
+  uv_loop_t* loop;
+  int pending;
+  uint64_t parts[8];
+  uint32_t limit;
+};
+
+struct part_req {
+  sum_req* parent;
+  int index;
+};
+
+static void PartWork(void* data) {
+  part_req* part = static_cast<part_req*>(data);
+  sum_req* req = part->parent;
+  uint32_t begin = static_cast<uint64_t>(req->limit) * part->index / 8;
+  uint32_t end = static_cast<uint64_t>(req->limit) * (part->index + 1) / 8;
+  uint64_t sum = 0;
+  for (uint32_t i = begin; i < end; i++)
+    sum += i;
+  req->parts[part->index] = sum;
+}
+
+static void PartDone(void* data, int status) {
+  assert(status == 0);
+  part_req* part = static_cast<part_req*>(data);
+  sum_req* req = part->parent;
+  delete part;
+  if (--req->pending > 0)
+    return;
+
+  v8::Isolate* isolate = req->isolate;
+  v8::HandleScope scope(isolate);
+
+  uint64_t sum = 0;
+  for (int i = 0; i < 8; i++)
+    sum += req->parts[i];
+
+  v8::Local<v8::Value> argv[1] = {
+    v8::Number::New(isolate, static_cast<double>(sum))
+  };
+  v8::Local<v8::Function> callback =
+      v8::Local<v8::Function>::New(isolate, req->callback);
+  node::MakeCallback(isolate, isolate->GetCurrentContext()->Global(),
+                     callback, 1, argv);
+
+  req->callback.Reset();
+  delete req;
+}
+
+static void SplitWork(void* data) {
+  sum_req* req = static_cast<sum_req*>(data);
+  for (int i = 0; i < 8; i++) {
+    part_req* part = new part_req;
+    part->parent = req;
+    part->index = i;
+    int r = node::QueueTask(req->loop, PartWork, PartDone, part);
+    assert(r == 0);
+  }
+}
+
+static void SplitDone(void* data, int status) {
+  assert(status == 0);
+}
+
+void Sum(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  v8::Isolate* isolate = args.GetIsolate();
+
+  sum_req* req = new sum_req;
+  req->isolate = isolate;
+  req->callback.Reset(isolate, args[1].As<v8::Function>());
+  req->loop = node::GetCurrentEventLoop(isolate);
+  req->pending = 8;
+  req->limit = args[0]->Uint32Value();
+
+  int r = node::QueueTask(req->loop, SplitWork, SplitDone, req);
+  assert(r == 0);
+}
+
+void QueueInvalid(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  uv_loop_t* loop = node::GetCurrentEventLoop(args.GetIsolate());
+  int r = node::QueueTask(loop, nullptr, SplitDone, nullptr);
+  args.GetReturnValue().Set(r == UV_EINVAL);
+}
+
+void init(v8::Local<v8::Object> exports) {
+  NODE_SET_METHOD(exports, "sum", Sum);
+  NODE_SET_METHOD(exports, "queueInvalid", QueueInvalid);
+}
+
+NODE_MODULE(binding, init);
@@ -0,0 +1,18 @@
+'use strict';
+const common = require('../../common');
+const assert = require('assert');
+const worker = require('worker');
+
+// A worker that exits with tasks in flight waits for them before it closes
+// its loop, the pool must not complete them on a loop that is gone.
+if (!worker.isMainThread) {
+  const binding = require('./build/Release/binding');
+  for (let i = 0; i < 20; i++)
+    binding.sum(1000000 + i, function() {});
+  process.exit(0);
+}
+
+const w = new worker.Worker(__filename);
+w.on('exit', common.mustCall(function(code) {
+  assert.strictEqual(code, 0);
+}));
@@ -0,0 +1,13 @@
+'use strict';
+const common = require('../../common');
+const assert = require('assert');
+const binding = require('./build/Release/binding');
+
+assert.strictEqual(binding.queueInvalid(), true);
+
+for (let i = 0; i < 20; i++) {
+  const limit = 100000 + i;
+  binding.sum(limit, common.mustCall(function(sum) {
+    assert.strictEqual(sum, limit * (limit - 1) / 2);
+  }));
+}
@@ -465,6 +465,10 @@ exports.fail = function(msg) {
   assert.fail(null, null, msg);
 };
 
+exports.skip = function(msg) {
+  console.log(`1..0 # Skipped: ${msg}`);
+};
+
 
 // A stream to push an array into a REPL
 function ArrayStream() {
@@ -54,6 +54,30 @@ TEST(function test_resolve4(done) {
   checkWrap(req);
 });
 
+TEST(function test_resolve4_packed(done) {
+  dns.resolve4('www.google.com', function(err, expected) {
+    if (err) throw err;
+
+    var req = dns.resolve4('www.google.com', { packed: true }, (err, ips) => {
+      if (err) throw err;
+
+      assert.ok(ips instanceof Buffer);
+      assert.strictEqual(ips.length % 4, 0);
+      assert.ok(ips.length > 0);
+
+      // The same records as the unpacked query, four bytes each.
+      const addresses = [];
+      for (var i = 0; i < ips.length; i += 4)
+        addresses.push(Array.prototype.join.call(ips.slice(i, i + 4), '.'));
+      assert.deepStrictEqual(addresses.sort(), expected.sort());
+
+      done();
+    });
+
+    checkWrap(req);
+  });
+});
+
 TEST(function test_reverse_ipv4(done) {
   var req = dns.reverse('8.8.8.8', function(err, domains) {
     if (err) throw err;
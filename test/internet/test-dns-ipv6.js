@@ -59,6 +59,20 @@ TEST(function test_resolve6(done) {
   checkWrap(req);
 });
 
+TEST(function test_resolve6_packed(done) {
+  var req = dns.resolve6('ipv6.google.com', { packed: true }, (err, ips) => {
+    if (err) throw err;
+
+    assert.ok(ips instanceof Buffer);
+    assert.strictEqual(ips.length % 16, 0);
+    assert.ok(ips.length > 0);
+
+    done();
+  });
+
+  checkWrap(req);
+});
+
 TEST(function test_reverse_ipv6(done) {
   var req = dns.reverse('2001:4860:4860::8888', function(err, domains) {
     if (err) throw err;
@@ -153,6 +153,34 @@ TEST(function test_resolveSrv(done) {
   checkWrap(req);
 });
 
+TEST(function test_resolveSrv_packed(done) {
+  const name = '_jabber._tcp.google.com';
+  var req = dns.resolveSrv(name, { packed: true }, function(err, result) {
+    if (err) throw err;
+
+    const count = result.port.length;
+    assert.ok(count > 0);
+    assert.ok(result.port instanceof Uint16Array);
+    assert.ok(result.priority instanceof Uint16Array);
+    assert.ok(result.weight instanceof Uint16Array);
+    assert.ok(result.nameIndex instanceof Uint16Array);
+    assert.strictEqual(result.priority.length, count);
+    assert.strictEqual(result.weight.length, count);
+    assert.strictEqual(result.nameIndex.length, count);
+    assert.ok(result.names.length > 0 && result.names.length <= count);
+
+    for (var i = 0; i < count; i++) {
+      const target = result.names[result.nameIndex[i]];
+      assert.ok(typeof target === 'string' && target.length > 0);
+      assert.ok(result.port[i] > 0);
+    }
+
+    done();
+  });
+
+  checkWrap(req);
+});
+
 TEST(function test_resolveSrv_failure(done) {
   var req = dns.resolveSrv('something.invalid', function(err, result) {
     assert.ok(err instanceof Error);
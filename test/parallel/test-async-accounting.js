@@ -0,0 +1,55 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const net = require('net');
+const binding = process.binding('async_accounting');
+
+const totals = new Float64Array(binding.kFieldsCount);
+
+function busy(ms) {
+  const deadline = Date.now() + ms;
+  while (Date.now() < deadline);
+}
+
+binding.start();
+assert.strictEqual(binding.currentRoot(), 0);
+assert.strictEqual(binding.getTotals(0, totals), false);
+
+var serverRoot = 0;
+const server = net.createServer(common.mustCall((socket) => {
+  serverRoot = binding.currentRoot();
+  assert.notStrictEqual(serverRoot, 0);
+
+  socket.on('data', common.mustCall(() => {
+    // The connection is a root of its own, not part of the server's.
+    const root = binding.currentRoot();
+    assert.notStrictEqual(root, 0);
+    assert.notStrictEqual(root, serverRoot);
+
+    busy(50);
+    const garbage = [];
+    for (var i = 0; i < 1e5; i++)
+      garbage.push({ i });
+
+    setImmediate(common.mustCall(() => {
+      assert.strictEqual(binding.getTotals(root, totals), true);
+      assert(totals[binding.kCPUTime] >= 40, totals[binding.kCPUTime]);
+      assert(totals[binding.kAllocatedBytes] > 0);
+      assert(totals[binding.kCallbacks] >= 1);
+      assert(totals[binding.kResources] >= 1);
+
+      // The server's root did not pay for the connection's work.
+      assert.strictEqual(binding.getTotals(serverRoot, totals), true);
+      assert(totals[binding.kCPUTime] < 40, totals[binding.kCPUTime]);
+
+      socket.end();
+      server.close();
+      binding.stop();
+      assert.strictEqual(binding.getTotals(root, totals), false);
+    }));
+  }));
+}));
+
+server.listen(0, common.mustCall(() => {
+  net.connect(server.address().port).end('x');
+}));
@@ -62,6 +62,21 @@ new StreamWrap(new net.Socket());
 
 new (process.binding('tty_wrap').TTY)();
 
+{
+  const TCP = process.binding('tcp_wrap').TCP;
+  const StreamPipe = process.binding('stream_pipe').StreamPipe;
+  new StreamPipe(new TCP()._externalStream, new TCP()._externalStream).unpipe();
+}
+
+new (process.binding('json_parser').JSONParser)();
+
+new (process.binding('http2').Http2Session)(0, [4096, 100, 65535, 16384,
+                                                65536]).destroy();
+
+new (process.binding('websocket_wrap').WebSocketWrap)(false, 0).destroy();
+
+new (require('worker').Worker)(common.fixturesDir + '/empty.js');
+
 crypto.randomBytes(1, noop);
 
 common.refreshTmpDir();
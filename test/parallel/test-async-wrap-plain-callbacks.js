@@ -0,0 +1,46 @@
+'use strict';
+// Callbacks made while neither domains nor async hooks are in use take a
+// shorter path through MakeCallback(). Check that the hooks and the domains
+// that are set up later still see the callbacks that follow.
+
+const common = require('../common');
+const assert = require('assert');
+const net = require('net');
+const async_wrap = process.binding('async_wrap');
+
+const server = net.createServer(common.mustCall((socket) => {
+  socket.end('ok');
+}, 2));
+
+function request(cb) {
+  net.connect(server.address().port).on('data', common.mustCall(cb));
+}
+
+server.listen(0, common.mustCall(() => {
+  process.nextTick(common.mustCall(() => {}));
+  request(() => {
+    let pre = 0;
+    let post = 0;
+    async_wrap.setupHooks({
+      init() { this._asyncQueue = {}; },
+      pre() { pre++; },
+      post() { post++; }
+    });
+    async_wrap.enable();
+    request(() => {
+      async_wrap.disable();
+      assert(pre > 0);
+      assert.strictEqual(pre, post);
+
+      const domain = require('domain');
+      const d = domain.create();
+      d.on('error', common.mustCall((err) => {
+        assert.strictEqual(err.message, 'from a timer');
+        server.close();
+      }));
+      d.run(() => {
+        setTimeout(() => { throw new Error('from a timer'); }, 1);
+      });
+    });
+  });
+}));
@@ -0,0 +1,31 @@
+'use strict';
+// Flags: --batch-ticks
+
+const common = require('../common');
+const assert = require('assert');
+const fs = require('fs');
+
+const order = [];
+
+// Block the loop until both requests are done so that their callbacks are
+// called in the same turn of the loop.
+function stat(name) {
+  fs.stat(__filename, common.mustCall(function(err) {
+    assert.ifError(err);
+    order.push(name);
+    process.nextTick(() => order.push(`${name} tick`));
+    Promise.resolve().then(() => order.push(`${name} promise`));
+  }));
+}
+
+stat('a');
+stat('b');
+
+const deadline = Date.now() + 100;
+while (Date.now() < deadline);
+
+setImmediate(common.mustCall(function() {
+  assert.deepStrictEqual(order, [
+    'a', 'b', 'a tick', 'b tick', 'a promise', 'b promise'
+  ]);
+}));
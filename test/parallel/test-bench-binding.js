@@ -0,0 +1,29 @@
+'use strict';
+
+const common = require('../common');
+const assert = require('assert');
+const binding = process.binding('bench');
+
+assert.strictEqual(binding.noop(), undefined);
+assert.strictEqual(new binding.BenchObject().noop(), undefined);
+
+// Each callback is the outermost one, so the next tick queue runs after it.
+let calls = 0;
+let ticks = 0;
+const recv = {};
+binding.makeCallback(recv, function() {
+  assert.strictEqual(this, recv);
+  assert.strictEqual(ticks, calls);
+  calls++;
+  process.nextTick(() => ticks++);
+}, 100, common.mustCall(() => {
+  assert.strictEqual(calls, 100);
+  assert.strictEqual(ticks, 100);
+}));
+
+binding.makeCallback(recv, common.fail, 0, common.mustCall());
+
+[binding.kAlloc, binding.kCopy, binding.kOwn].forEach((kind) => {
+  binding.createBuffers(1000, 0, kind);
+  binding.createBuffers(1000, 1024, kind);
+});
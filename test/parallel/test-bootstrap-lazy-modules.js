@@ -0,0 +1,42 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const child_process = require('child_process');
+
+// The timers and stream modules are only loaded once they are used.
+const script = `
+  const fs = require('fs');
+  const loaded = (id) => process.moduleLoadList.includes('NativeModule ' + id);
+  const before = [loaded('timers'), loaded('stream')];
+  fs.createReadStream(process.execPath, { start: 0, end: 0 }).resume();
+  const descriptor = Object.getOwnPropertyDescriptor(global, 'setTimeout');
+  setTimeout(function() {}, 1);
+  process.stderr.write(JSON.stringify({
+    before: before,
+    after: [loaded('timers'), loaded('stream')],
+    enumerable: descriptor.enumerable
+  }));
+`;
+child_process.execFile(process.execPath, ['-e', script],
+                       common.mustCall(function(err, stdout, stderr) {
+                         assert.ifError(err);
+                         assert.deepStrictEqual(JSON.parse(stderr), {
+                           before: [false, false],
+                           after: [true, true],
+                           enumerable: true
+                         });
+                       }));
+
+// The timer globals are the functions from the timers module, and can
+// still be replaced.
+const timers = require('timers');
+assert.strictEqual(setTimeout, timers.setTimeout);
+assert.strictEqual(clearImmediate, timers.clearImmediate);
+assert.strictEqual(
+  Object.getOwnPropertyDescriptor(global, 'setTimeout').writable, true);
+
+const saved = global.setInterval;
+global.setInterval = common.fail;
+assert.strictEqual(setInterval, common.fail);
+global.setInterval = saved;
+assert.strictEqual(setInterval, timers.setInterval);
@@ -0,0 +1,59 @@
+'use strict';
+require('../common');
+const assert = require('assert');
+
+// Checks the vectorized base64 and hex code against simple reference
+// implementations, for lengths around the block sizes it works with.
+const alphabet =
+    'ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/';
+
+function base64(buf) {
+  var out = '';
+  for (var i = 0; i < buf.length; i += 3) {
+    const v = buf[i] << 16 | (buf[i + 1] | 0) << 8 | (buf[i + 2] | 0);
+    out += alphabet[v >> 18] + alphabet[v >> 12 & 63];
+    out += i + 1 < buf.length ? alphabet[v >> 6 & 63] : '=';
+    out += i + 2 < buf.length ? alphabet[v & 63] : '=';
+  }
+  return out;
+}
+
+function hex(buf) {
+  var out = '';
+  for (var i = 0; i < buf.length; i += 1)
+    out += (buf[i] < 16 ? '0' : '') + buf[i].toString(16);
+  return out;
+}
+
+for (let len = 0; len < 100; len += 1) {
+  const buf = Buffer.allocUnsafe(len);
+  for (let i = 0; i < len; i += 1)
+    buf[i] = (i * 89 + len) & 255;
+
+  const encoded = base64(buf);
+  assert.strictEqual(buf.toString('base64'), encoded);
+  assert.strictEqual(buf.toString('hex'), hex(buf));
+  assert.deepStrictEqual(Buffer.from(encoded, 'base64'), buf);
+  assert.deepStrictEqual(Buffer.from(hex(buf), 'hex'), buf);
+
+  // URL-safe characters, whitespace and missing padding are accepted.
+  const urlSafe = encoded.replace(/\+/g, '-').replace(/\//g, '_');
+  assert.deepStrictEqual(Buffer.from(urlSafe, 'base64'), buf);
+  assert.deepStrictEqual(
+    Buffer.from(encoded.replace(/=+$/, ''), 'base64'), buf);
+  const wrapped = encoded.replace(/(.{20})/g, '$1\n');
+  assert.deepStrictEqual(Buffer.from(wrapped, 'base64'), buf);
+
+  // Other characters are skipped, decoding stops at '=' and nothing is
+  // written past the decoded bytes.
+  if (len >= 24) {
+    const skipped = encoded.slice(0, 20) + '*' + encoded.slice(20);
+    assert.deepStrictEqual(Buffer.from(skipped, 'base64'), buf);
+
+    const target = Buffer.alloc(len + 16, 0xee);
+    const cut = encoded.slice(0, 24) + '=' + encoded.slice(24);
+    assert.strictEqual(target.write(cut, 'base64'), 18);
+    assert.deepStrictEqual(target.slice(0, 18), buf.slice(0, 18));
+    assert(target.slice(18).every((byte) => byte === 0xee));
+  }
+}
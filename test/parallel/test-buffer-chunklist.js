@@ -0,0 +1,92 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const fs = require('fs');
+const path = require('path');
+const stream = require('stream');
+const ChunkList = require('buffer').ChunkList;
+
+const hello = Buffer.from('hello ');
+const list = new ChunkList([hello, 'wörld']);
+assert.strictEqual(list.length, 12);
+assert.strictEqual(list.chunks.length, 2);
+assert.strictEqual(list.chunks[0], hello);  // Not copied.
+assert.strictEqual(list.append('!', 'binary'), list);
+assert.strictEqual(list.append(Buffer.alloc(0)).chunks.length, 3);
+assert.strictEqual(list.toBuffer().toString(), 'hello wörld!');
+assert.strictEqual(Buffer.concat(list).toString(), 'hello wörld!');
+assert.strictEqual(new ChunkList([list, list]).length, 26);
+assert.strictEqual(new ChunkList().toBuffer().length, 0);
+
+assert.throws(() => new ChunkList('abc'),
+              /^TypeError: "chunks" argument must be an Array$/);
+assert.throws(() => list.append(42),
+              /^TypeError: "chunk" argument must be a string, Buffer or/);
+
+// Writable streams that don't know about ChunkLists get its Buffers.
+{
+  const seen = [];
+  const writable = new stream.Writable({
+    write(chunk, encoding, cb) {
+      assert(chunk instanceof Buffer);
+      seen.push(chunk.toString());
+      cb();
+    }
+  });
+  writable.write(list, common.mustCall(function() {
+    assert.deepStrictEqual(seen, ['hello ', 'wörld', '!']);
+  }));
+  writable.end(new ChunkList(), common.mustCall());
+}
+
+// Object mode streams get the ChunkList itself.
+{
+  const writable = new stream.Writable({
+    objectMode: true,
+    write: common.mustCall(function(chunk, encoding, cb) {
+      assert.strictEqual(chunk, list);
+      cb();
+    })
+  });
+  writable.end(list);
+}
+
+common.refreshTmpDir();
+
+// fs.writev() and fs.writevSync().
+{
+  const file = path.join(common.tmpDir, 'writev.txt');
+  const fd = fs.openSync(file, 'w');
+  assert.strictEqual(fs.writevSync(fd, [hello, Buffer.from('a')]), 7);
+  assert.strictEqual(fs.writevSync(fd, list), 13);
+  assert.strictEqual(fs.writevSync(fd, []), 0);
+  fs.writev(fd, list, 0, common.mustCall(function(err, written, buffers) {
+    assert.ifError(err);
+    assert.strictEqual(written, 13);
+    assert.strictEqual(buffers, list);
+    fs.closeSync(fd);
+    assert.strictEqual(fs.readFileSync(file, 'utf8'), 'hello wörld!wörld!');
+  }));
+
+  assert.throws(() => fs.writevSync(fd, 'abc'),
+                /^TypeError: "buffers" argument must be an Array or/);
+  assert.throws(() => fs.writevSync('abc', []),
+                /^TypeError: First argument must be file descriptor$/);
+}
+
+// fs.WriteStream.
+{
+  const file = path.join(common.tmpDir, 'stream.txt');
+  const ws = fs.createWriteStream(file);
+  ws.write(list);
+  ws.cork();
+  ws.write('x');
+  ws.write(list);
+  ws.write(new ChunkList());
+  ws.uncork();
+  ws.end(common.mustCall(function() {
+    assert.strictEqual(ws.bytesWritten, 27);
+    assert.strictEqual(fs.readFileSync(file, 'utf8'),
+                       'hello wörld!xhello wörld!');
+  }));
+}
@@ -0,0 +1,43 @@
+'use strict';
+require('../common');
+const assert = require('assert');
+
+// Patterns shorter than 8 bytes are searched 16 positions at a time.
+// Compare against a naive search, with matches and near misses around the
+// block boundaries.
+function naiveIndexOf(haystack, needle, start) {
+  for (var i = start; i + needle.length <= haystack.length; i++) {
+    if (haystack.slice(i, i + needle.length).equals(needle))
+      return i;
+  }
+  return -1;
+}
+
+const haystack = Buffer.alloc(100, 'a');
+for (let i = 0; i < haystack.length; i += 7)
+  haystack[i] = 0x0d;  // '\r'
+for (let i = 3; i < haystack.length; i += 11)
+  haystack[i] = 0x0a;  // '\n'
+haystack.write('\r\n--', 90);
+
+const needles = ['\r\n', '\r\n--', 'a\r', 'aaaaaaa', '\ra', 'a\n', '--', 'xy',
+                 'aa\raaaa'];
+needles.forEach(function(str) {
+  const needle = Buffer.from(str);
+  for (let start = 0; start < haystack.length; start++) {
+    const expected = naiveIndexOf(haystack, needle, start);
+    assert.strictEqual(haystack.indexOf(needle, start), expected);
+    assert.strictEqual(haystack.indexOf(str, start), expected);
+    assert.strictEqual(haystack.indexOf(str, start, 'binary'), expected);
+  }
+});
+
+// A match that ends on the last byte of the buffer.
+for (let len = 2; len < 40; len++) {
+  const buf = Buffer.alloc(len, 'x');
+  buf.write('yz', len - 2);
+  assert.strictEqual(buf.indexOf('yz'), len - 2);
+  assert.strictEqual(buf.indexOf('xyz'), len - 3);
+  assert.strictEqual(buf.indexOf('yzx'), -1);
+  assert.strictEqual(buf.lastIndexOf('yz'), len - 2);
+}
@@ -0,0 +1,91 @@
+'use strict';
+require('../common');
+const assert = require('assert');
+const BufferLayout = require('buffer').BufferLayout;
+
+const fields = [
+  { name: 'i8', type: 'int8' },
+  { name: 'u8', type: 'uint8' },
+  { name: 'i16le', type: 'int16le' },
+  { name: 'i16be', type: 'int16be' },
+  { name: 'u16le', type: 'uint16le' },
+  { name: 'u16be', type: 'uint16be' },
+  { name: 'i32le', type: 'int32le' },
+  { name: 'i32be', type: 'int32be' },
+  { name: 'u32le', type: 'uint32le' },
+  { name: 'u32be', type: 'uint32be' },
+  { name: 'fle', type: 'floatle' },
+  { name: 'fbe', type: 'floatbe' },
+  { name: 'dle', type: 'doublele' },
+  { name: 'dbe', type: 'DoubleBE' }
+];
+const layout = new BufferLayout(fields, 64);
+assert.strictEqual(layout.size, 64);
+
+function readFields(buf, offset) {
+  return {
+    i8: buf.readInt8(offset),
+    u8: buf.readUInt8(offset + 1),
+    i16le: buf.readInt16LE(offset + 2),
+    i16be: buf.readInt16BE(offset + 4),
+    u16le: buf.readUInt16LE(offset + 6),
+    u16be: buf.readUInt16BE(offset + 8),
+    i32le: buf.readInt32LE(offset + 10),
+    i32be: buf.readInt32BE(offset + 14),
+    u32le: buf.readUInt32LE(offset + 18),
+    u32be: buf.readUInt32BE(offset + 22),
+    fle: buf.readFloatLE(offset + 26),
+    fbe: buf.readFloatBE(offset + 30),
+    dle: buf.readDoubleLE(offset + 34),
+    dbe: buf.readDoubleBE(offset + 42)
+  };
+}
+
+const buf = Buffer.allocUnsafe(64 * 10 + 3);
+for (let i = 0; i < buf.length; i++)
+  buf[i] = (i * 97 + 13) & 255;
+
+assert.deepStrictEqual(layout.read(buf), readFields(buf, 0));
+assert.deepStrictEqual(layout.read(buf, 3), readFields(buf, 3));
+assert.deepStrictEqual(layout.readArray(buf, 5),
+                       Object.keys(readFields(buf, 5))
+                         .map((key) => readFields(buf, 5)[key]));
+
+const many = layout.readMany(buf, 3);
+assert.strictEqual(many.length, 10);
+many.forEach((struct, i) => {
+  assert.deepStrictEqual(struct, readFields(buf, 3 + i * 64));
+});
+assert.strictEqual(layout.readMany(buf, 0, 2).length, 2);
+assert.deepStrictEqual(layout.readMany(buf, 0, 0), []);
+assert.deepStrictEqual(layout.readMany(buf.slice(0, 10)), []);
+
+// Explicit offsets, and a size that defaults to the end of the last field.
+{
+  const header = new BufferLayout([
+    { name: 'length', type: 'uint16be', offset: 2 },
+    { name: 'tag', type: 'uint8', offset: 0 }
+  ]);
+  assert.strictEqual(header.size, 4);
+  assert.deepStrictEqual(header.read(Buffer.from([7, 0, 1, 2])),
+                         { length: 258, tag: 7 });
+  assert.deepStrictEqual(header.readArray(new Uint8Array([7, 0, 1, 2])),
+                         [258, 7]);
+  assert.strictEqual(new BufferLayout([]).size, 0);
+}
+
+assert.throws(() => layout.read(buf, buf.length - 63),
+              /^RangeError: Index out of range$/);
+assert.throws(() => layout.readMany(buf, 0, 11),
+              /^RangeError: Index out of range$/);
+assert.throws(() => layout.read(buf, -1), /^RangeError: Index out of range$/);
+assert.throws(() => layout.read('abc'),
+              /^TypeError: argument should be a Buffer$/);
+assert.throws(() => new BufferLayout([{ name: 'a', type: 'int64' }]),
+              /^TypeError: Unknown field type: int64$/);
+assert.throws(() => new BufferLayout([{ name: 'a', type: 'int8' }], 0),
+              /^RangeError: "size" must be an integer that fits all fields$/);
+assert.throws(() => new BufferLayout([{ name: 'a', type: 'int8', offset: -1 }]),
+              /^RangeError: "offset" must be a non-negative integer$/);
+assert.throws(() => new BufferLayout('int8'),
+              /^TypeError: "fields" argument must be an Array$/);
@@ -0,0 +1,54 @@
+'use strict';
+// Long one-byte strings take a shortcut in Buffer.byteLength() and in the
+// UTF-8 writes, check them against a plain encoder.
+require('../common');
+const assert = require('assert');
+
+function utf8(str) {
+  const bytes = [];
+  for (var i = 0; i < str.length; i++) {
+    const c = str.charCodeAt(i);
+    if (c < 0x80)
+      bytes.push(c);
+    else
+      bytes.push(0xc0 | c >> 6, 0x80 | c & 0x3f);
+  }
+  return Buffer.from(bytes);
+}
+
+const json = JSON.stringify({ id: 1, name: 'x'.repeat(100), tags: [1, 2] });
+const latin1 = 'café '.repeat(20);
+const strings = [
+  json,
+  'a'.repeat(63),
+  'a'.repeat(64),
+  'a'.repeat(40000) + 'ÿ',
+  'é' + 'a'.repeat(40000),
+  latin1,
+  json + latin1,
+  // A cons string, flattened by the writes.
+  'b'.repeat(100) + json,
+  // Past the pool, created in one pass when it is ASCII.
+  json.repeat(50),
+  json.repeat(50) + latin1
+];
+
+strings.forEach((str) => {
+  const expected = utf8(str);
+  assert.strictEqual(Buffer.byteLength(str), expected.length);
+  assert.strictEqual(Buffer.byteLength(str, 'utf8'), expected.length);
+  assert.deepStrictEqual(Buffer.from(str), expected);
+
+  const buf = Buffer.alloc(expected.length + 8, 0xaa);
+  assert.strictEqual(buf.write(str), expected.length);
+  assert.deepStrictEqual(buf.slice(0, expected.length), expected);
+  assert.strictEqual(buf[expected.length], 0xaa);
+
+  // Truncated writes don't split characters.
+  const short = Buffer.alloc(65, 0xaa);
+  const written = short.write(str);
+  assert(written <= 65);
+  assert.deepStrictEqual(short.slice(0, written),
+                         expected.slice(0, written));
+  assert(written >= Math.min(64, expected.length));
+});
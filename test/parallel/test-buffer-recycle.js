@@ -0,0 +1,36 @@
+// Flags: --expose-gc
+'use strict';
+require('../common');
+const assert = require('assert');
+
+// The backing stores of small Buffers are recycled once they are garbage
+// collected.  Zero-filled allocations must never see the old contents.
+const sizes = [1, 63, 64, 65, 100, 4095, 4096, 8192, 40000, 65536, 65537];
+
+function isZero(buf) {
+  for (let i = 0; i < buf.length; i++) {
+    if (buf[i] !== 0)
+      return false;
+  }
+  return true;
+}
+
+for (let round = 0; round < 3; round++) {
+  sizes.forEach(function(size) {
+    for (let i = 0; i < 16; i++)
+      Buffer.allocUnsafeSlow(size).fill(0xff);
+  });
+  global.gc();
+
+  sizes.forEach(function(size) {
+    const buf = Buffer.alloc(size);
+    assert.strictEqual(buf.length, size);
+    assert(isZero(buf));
+    assert(isZero(new Uint8Array(size)));
+    assert(isZero(new Uint8Array(new ArrayBuffer(size))));
+
+    // Recycled memory is still writable up to the requested size.
+    const unsafe = Buffer.allocUnsafeSlow(size).fill(0x42);
+    assert.strictEqual(unsafe[size - 1], 0x42);
+  });
+}
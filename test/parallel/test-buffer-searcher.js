@@ -0,0 +1,74 @@
+'use strict';
+require('../common');
+const assert = require('assert');
+const BufferSearcher = require('buffer').BufferSearcher;
+
+const haystack = Buffer.from('abc--boundary--def--boundary--ghi--boundary');
+
+// Short patterns, and patterns long enough for the precomputed tables.
+const patterns = ['b', '--', '--boundary', '--boundary--ghi', 'nope',
+                  'x'.repeat(300)];
+patterns.forEach(function(str) {
+  const searcher = new BufferSearcher(str);
+  const expected = [];
+  for (let i = haystack.indexOf(str); i !== -1;
+       i = haystack.indexOf(str, i + str.length)) {
+    expected.push(i);
+  }
+  assert.deepStrictEqual(searcher.findAll(haystack), expected);
+
+  for (let offset = -50; offset < 50; offset++) {
+    assert.strictEqual(searcher.findFirst(haystack, offset),
+                       haystack.indexOf(str, offset));
+  }
+});
+
+// The same searcher is reused across many buffers.
+{
+  const searcher = new BufferSearcher(Buffer.from('\r\n--XyZ0123456789'));
+  for (let i = 0; i < 100; i++) {
+    const buf = Buffer.alloc(100 + i, 'x');
+    buf.write('\r\n--XyZ0123456789', i);
+    assert.strictEqual(searcher.findFirst(buf), i);
+    assert.deepStrictEqual(searcher.findAll(buf), [i]);
+    assert.strictEqual(searcher.findFirst(buf, i + 1), -1);
+  }
+  assert.strictEqual(searcher.findFirst(Buffer.alloc(0)), -1);
+  assert.deepStrictEqual(searcher.findAll(Buffer.alloc(0)), []);
+}
+
+// Overlapping matches are skipped by findAll().
+assert.deepStrictEqual(new BufferSearcher('aa').findAll(Buffer.from('aaaaa')),
+                       [0, 2]);
+assert.deepStrictEqual(
+    new BufferSearcher('aa').findAll(Buffer.from('aaaaa'), 1), [1, 3]);
+
+// Encodings.
+{
+  const ucs2 = Buffer.from('abc\u03a3\u03a3def\u03a3', 'ucs2');
+  const searcher = new BufferSearcher('\u03a3', 'ucs2');
+  assert.deepStrictEqual(searcher.findAll(ucs2), [6, 8, 16]);
+  for (let offset = 0; offset < ucs2.length; offset++) {
+    assert.strictEqual(searcher.findFirst(ucs2, offset),
+                       ucs2.indexOf('\u03a3', offset, 'ucs2'));
+  }
+
+  const hex = new BufferSearcher('2d2d', 'hex');
+  assert.deepStrictEqual(hex.findAll(haystack), [3, 13, 18, 28, 33]);
+  assert.strictEqual(new BufferSearcher('\u00e9', 'binary')
+                         .findFirst(Buffer.from([0x61, 0xe9])), 1);
+  assert.strictEqual(new BufferSearcher('\u00e9')
+                         .findFirst(Buffer.from('a\u00e9')), 1);
+}
+
+// Uint8Array patterns and subjects.
+assert.strictEqual(
+    new BufferSearcher(new Uint8Array([0x64, 0x65]))
+        .findFirst(new Uint8Array(haystack)), 15);
+
+assert.throws(() => new BufferSearcher(''),
+              /^RangeError: "pattern" argument must not be empty$/);
+assert.throws(() => new BufferSearcher(42),
+              /^TypeError: "pattern" argument must be a string, Buffer or/);
+assert.throws(() => new BufferSearcher('a').findFirst('abc'),
+              /^TypeError: argument should be a Buffer$/);
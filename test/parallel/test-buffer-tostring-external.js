@@ -0,0 +1,48 @@
+// Flags: --expose-gc
+'use strict';
+require('../common');
+const assert = require('assert');
+
+const latin1 = Buffer.alloc(1 << 20);
+for (var i = 0; i < latin1.length; i++)
+  latin1[i] = i % 256;
+const ascii = Buffer.from('abcdefghijklmnopqrstuvwxyz'.repeat(4096));
+
+[
+  [latin1, 'binary'],
+  [latin1, 'ascii'],
+  [ascii, 'ascii'],
+  [ascii, 'binary'],
+  [latin1, 'ucs2'],
+  [ascii, 'utf16le']
+].forEach(([buf, encoding]) => {
+  assert.strictEqual(buf.toStringExternal(encoding),
+                     buf.toString(encoding));
+  assert.strictEqual(buf.toStringExternal(encoding, 7, 4099),
+                     buf.toString(encoding, 7, 4099));
+  // Unaligned and odd lengths, which UCS-2 copies.
+  assert.strictEqual(buf.slice(1).toStringExternal(encoding, 0, 9),
+                     buf.slice(1).toString(encoding, 0, 9));
+  assert.strictEqual(buf.toStringExternal(encoding, 5, 5), '');
+  assert.strictEqual(buf.toStringExternal(encoding, 5, 6),
+                     buf.toString(encoding, 5, 6));
+});
+
+assert.strictEqual(latin1.toStringExternal(), latin1.toString('binary'));
+assert.strictEqual(Buffer.alloc(0).toStringExternal(), '');
+assert.strictEqual(ascii.toStringExternal('ASCII', -1, 1e9),
+                   ascii.toString('ascii'));
+assert.throws(() => ascii.toStringExternal('utf8'), TypeError);
+assert.throws(() => ascii.toStringExternal('hex'), TypeError);
+
+// The string keeps the memory of the Buffer alive.
+function external() {
+  return Buffer.from('x'.repeat(1 << 16) + 'end').toStringExternal('ascii');
+}
+const str = external();
+global.gc();
+Buffer.alloc(1 << 16, 'y');
+global.gc();
+assert.strictEqual(str.length, (1 << 16) + 3);
+assert.strictEqual(str.slice(-4), 'xend');
+assert.strictEqual(str.indexOf('y'), -1);
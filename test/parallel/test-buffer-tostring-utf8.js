@@ -0,0 +1,40 @@
+'use strict';
+require('../common');
+const assert = require('assert');
+
+// ASCII and Latin-1 text decodes to one-byte strings without going through
+// V8's UTF-8 decoder.  Make sure that gives the same results, including
+// around the boundaries of the vectorized ASCII scan.
+const samples = [
+  '',
+  'a',
+  'hello world',
+  'é',
+  '\u0080ÿ',
+  'naïve café',
+  'Ā',
+  'café €',
+  '你好',
+  '😀'
+];
+
+for (let pad = 0; pad < 70; pad++) {
+  const prefix = 'x'.repeat(pad);
+  samples.forEach(function(sample) {
+    const str = prefix + sample + prefix;
+    assert.strictEqual(Buffer.from(str).toString(), str);
+    assert.strictEqual(Buffer.from(str).toString('utf8', pad), sample + prefix);
+  });
+}
+
+// Large strings are externalized.
+const big = 'abcé'.repeat(1 << 18);
+assert.strictEqual(Buffer.from(big).toString(), big);
+const bigAscii = 'abcd'.repeat(1 << 18);
+assert.strictEqual(Buffer.from(bigAscii).toString(), bigAscii);
+
+// Malformed input still decodes to replacement characters.
+assert.strictEqual(Buffer.from([0x61, 0xc3]).toString(), 'a\ufffd');
+assert.strictEqual(Buffer.from([0xc3, 0x41]).toString(), '\ufffdA');
+assert.strictEqual(Buffer.from([0x80]).toString(), '\ufffd');
+assert.strictEqual(Buffer.from([0xc3, 0xa9, 0xff]).toString(), 'é\ufffd');
@@ -0,0 +1,52 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const buffer = require('buffer');
+
+if (buffer.transcode === undefined) {
+  common.skip('no ICU converters');
+  return;
+}
+
+const transcode = buffer.transcode;
+const Transcoder = buffer.Transcoder;
+
+const text = 'Dès Noël où un zéphyr haï me vêt de glaçons würmiens ' +
+             'je dîne d’exquis rôtis de bœuf au kir à l’aÿ d’âge mûr €';
+const utf8 = Buffer.from(text, 'utf8');
+const utf16 = Buffer.from(text, 'utf16le');
+
+assert.deepStrictEqual(transcode(utf8, 'utf8', 'ucs2'), utf16);
+assert.deepStrictEqual(transcode(utf16, 'utf16le', 'utf-8'), utf8);
+assert.deepStrictEqual(transcode(Buffer.alloc(0), 'utf8', 'ucs2'),
+                       Buffer.alloc(0));
+
+{
+  const latin1 = Buffer.from('aéÿ', 'latin1');
+  assert.deepStrictEqual(transcode(latin1, 'latin1', 'utf8'),
+                         Buffer.from('aéÿ', 'utf8'));
+}
+
+assert.throws(() => transcode(utf8, 'utf8', 'not an encoding'),
+              (err) => {
+                return /^Unable to transcode Buffer \[U_\w+\]$/
+                           .test(err.message) && /^U_\w+$/.test(err.code);
+              });
+assert.throws(() => transcode('string', 'utf8', 'ucs2'), TypeError);
+assert.throws(() => transcode(utf8, null, 'ucs2'), TypeError);
+
+{
+  // A sequence that is split between two chunks is completed by the next.
+  const transcoder = new Transcoder('utf8', 'ucs2');
+  const chunks = [];
+  for (let i = 0; i < utf8.length; i += 3)
+    chunks.push(transcoder.write(utf8.slice(i, i + 3)));
+  chunks.push(transcoder.end());
+  assert.deepStrictEqual(Buffer.concat(chunks), utf16);
+
+  // After end() the transcoder starts over.
+  assert.deepStrictEqual(transcoder.end(utf8), utf16);
+}
+
+assert.throws(() => new Transcoder('utf8', 'not an encoding'),
+              /^Error: Unable to transcode Buffer \[U_\w+\]$/);
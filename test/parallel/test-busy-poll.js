@@ -0,0 +1,49 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const dgram = require('dgram');
+const net = require('net');
+
+[-1, 1.5, 1e6 + 1, '10', null].forEach((usecs) => {
+  assert.throws(() => process.setBusyPoll(usecs), RangeError);
+});
+
+// Raising SO_BUSY_POLL above net.core.busy_read needs CAP_NET_ADMIN.
+function assertBusyPollError(err) {
+  if (process.platform === 'linux')
+    assert.strictEqual(err.code, 'EPERM');
+  else
+    assert.strictEqual(err.code, 'ENOTSUP');
+}
+
+const udp = dgram.createSocket('udp4');
+udp.bind(0, common.localhostIPv4, common.mustCall(() => {
+  assert.throws(() => udp.setBusyPoll(-1), TypeError);
+  try {
+    udp.setBusyPoll(50);
+  } catch (err) {
+    assertBusyPollError(err);
+  }
+  udp.close();
+}));
+
+process.setBusyPoll(100);
+
+const server = net.createServer(common.mustCall((socket) => {
+  socket.end('ok');
+}));
+
+server.listen(0, common.mustCall(() => {
+  const client = net.connect(server.address().port);
+  assert.throws(() => client.setBusyPoll(1.5), TypeError);
+  // Applied once connected.
+  assert.strictEqual(client.setBusyPoll(50), client);
+  var data = '';
+  client.setEncoding('utf8');
+  client.on('data', (chunk) => { data += chunk; });
+  client.on('end', common.mustCall(() => {
+    assert.strictEqual(data, 'ok');
+    process.setBusyPoll(0);
+    server.close();
+  }));
+}));
@@ -0,0 +1,108 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const fork = require('child_process').fork;
+
+if (process.argv[2] === 'child') {
+  // Echo every message, so that it crosses the channel in both directions.
+  process.on('message', function(message) {
+    if (message === 'done')
+      return process.disconnect();
+    process.send(message);
+  });
+  return;
+}
+
+assert.throws(function() {
+  fork(__filename, ['child'], { serialization: 'xml' });
+}, /"serialization" must be "json" or "binary"/);
+
+const cyclic = { name: 'cyclic' };
+cyclic.self = cyclic;
+const shared = [1, 2, 3];
+
+const messages = [
+  { a: 1, b: 'two', c: [3, null, true] },
+  'a string',
+  'ünïcödé ☃',
+  42,
+  -0,
+  NaN,
+  Infinity,
+  2.5,
+  null,
+  false,
+  [undefined, 1],
+  { missing: undefined },
+  new Date(1e12),
+  /ab+c/gi,
+  Buffer.from('hello'),
+  new Uint16Array([1, 2, 65535]),
+  new Float64Array([0.5, -1]),
+  new Map([['key', 'value'], [1, { x: 1 }]]),
+  new Set(['a', 'b', 3]),
+  cyclic,
+  { first: shared, second: shared },
+  // Larger than a single read, so that the frame arrives in pieces.
+  Buffer.alloc(256 * 1024, 'x')
+];
+
+const child = fork(__filename, ['child'], { serialization: 'binary' });
+
+assert.throws(function() {
+  child.send({ fn: function() {} });
+}, /^TypeError: Function could not be cloned$/);
+
+let received = 0;
+child.on('message', function(message) {
+  const sent = messages[received++];
+
+  if (sent === cyclic) {
+    assert.strictEqual(message.name, 'cyclic');
+    assert.strictEqual(message.self, message);
+  } else if (sent && sent.first === shared) {
+    assert.deepStrictEqual(message.first, shared);
+    assert.strictEqual(message.first, message.second);
+  } else if (Object.is(sent, -0) || Number.isNaN(sent)) {
+    assert(Object.is(message, sent));
+  } else if (sent instanceof Map || sent instanceof Set) {
+    assert.strictEqual(Object.getPrototypeOf(message),
+                       Object.getPrototypeOf(sent));
+    assert.deepStrictEqual(Array.from(message), Array.from(sent));
+  } else {
+    if (typeof sent === 'object' && sent !== null) {
+      assert.strictEqual(Object.getPrototypeOf(message),
+                         Object.getPrototypeOf(sent));
+    }
+    assert.deepStrictEqual(message, sent);
+  }
+
+  if (received === messages.length)
+    child.send('done');
+});
+
+messages.forEach((message) => child.send(message));
+
+// Many small messages are delivered in order.
+const count = 10000;
+let next = 0;
+const flood = fork(__filename, ['child'], { serialization: 'binary' });
+flood.on('message', function(message) {
+  assert.strictEqual(message.seq, next++);
+  if (next === count)
+    flood.send('done');
+});
+for (let i = 0; i < count; i++)
+  flood.send({ seq: i, payload: 'metrics' });
+
+child.on('exit', common.mustCall(function(code) {
+  assert.strictEqual(code, 0);
+}));
+flood.on('exit', common.mustCall(function(code) {
+  assert.strictEqual(code, 0);
+}));
+
+process.on('exit', function() {
+  assert.strictEqual(received, messages.length);
+  assert.strictEqual(next, count);
+});
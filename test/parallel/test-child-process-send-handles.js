@@ -0,0 +1,64 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const cp = require('child_process');
+const net = require('net');
+
+if (process.argv[2] === 'child') {
+  // Every socket is answered with the name of its batch and its place in it.
+  process.on('message', common.mustCall((msg, sockets) => {
+    assert(Array.isArray(sockets));
+    assert.strictEqual(sockets.length, msg.count);
+    sockets.forEach((socket, i) => {
+      assert(socket instanceof net.Socket);
+      socket.end(`${msg.batch}${i}`);
+    });
+  }, 2));
+  return;
+}
+
+const kClients = 5;
+const child = cp.fork(__filename, ['child']);
+const sockets = [];
+const received = [];
+
+child.on('exit', common.mustCall((exitCode, signalCode) => {
+  assert.strictEqual(exitCode, 0);
+  assert.strictEqual(signalCode, null);
+}));
+
+const server = net.createServer(common.mustCall((socket) => {
+  sockets.push(socket);
+  if (sockets.length < kClients)
+    return;
+
+  assert.throws(() => {
+    child.send({}, new Array(65).fill(sockets[0]));
+  }, RangeError);
+
+  // The second batch waits for the first one to be acknowledged.
+  child.send({ batch: 'a', count: 3 }, sockets.slice(0, 3),
+             common.mustCall(assert.ifError));
+  child.send({ batch: 'b', count: 2 }, sockets.slice(3),
+             common.mustCall(assert.ifError));
+}, kClients));
+
+server.listen(0, common.mustCall(() => {
+  for (var i = 0; i < kClients; i++) {
+    const client = net.connect(server.address().port);
+    const chunks = [];
+    client.setEncoding('utf8');
+    client.on('data', (chunk) => chunks.push(chunk));
+    client.on('end', common.mustCall(() => {
+      received.push(chunks.join(''));
+      if (received.length === kClients) {
+        server.close();
+        child.disconnect();
+      }
+    }));
+  }
+}));
+
+process.on('exit', () => {
+  assert.deepStrictEqual(received.sort(), ['a0', 'a1', 'a2', 'b0', 'b1']);
+});
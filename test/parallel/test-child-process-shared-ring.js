@@ -0,0 +1,68 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const fork = require('child_process').fork;
+
+if (common.isWindows) {
+  console.log('1..0 # Skipped: shared rings are not supported on Windows');
+  return;
+}
+
+const count = 5000;
+
+if (process.argv[2] === 'child') {
+  process.on('sharedRing', function(ring) {
+    let next = 0;
+    ring.on('data', function(data) {
+      assert.strictEqual(data.toString(), `message ${next++}`);
+    });
+    ring.on('end', function() {
+      // Answer through a ring of our own.
+      const reply = process.createSharedRing();
+      reply.write(`${next}`);
+      reply.on('close', () => process.disconnect());
+    });
+  });
+  return;
+}
+
+const child = fork(__filename, ['child']);
+
+assert.throws(function() {
+  child.createSharedRing({ size: -1 });
+}, /^RangeError: "size" must be a positive number$/);
+
+// Small enough to fill up, so that the writer has to wait for the reader.
+const ring = child.createSharedRing({ size: 4096 });
+assert.strictEqual(ring.maxMessageSize, 4096 - 4);
+
+assert.throws(function() {
+  ring.write(Buffer.alloc(4096));
+}, /^RangeError: "data" does not fit into the ring$/);
+
+let queued = false;
+for (let i = 0; i < count; i++) {
+  if (!ring.write(`message ${i}`))
+    queued = true;
+}
+assert.strictEqual(queued, true);
+
+ring.on('drain', common.mustCall(function() {
+  ring.close();
+}));
+ring.on('close', common.mustCall(function() {}));
+
+child.on('sharedRing', common.mustCall(function(reply) {
+  assert.throws(function() {
+    reply.write('nope');
+  }, /^Error: Only the end that created the ring can write to it$/);
+
+  reply.on('data', common.mustCall(function(data) {
+    assert.strictEqual(data.toString(), `${count}`);
+    reply.close();
+  }));
+}));
+
+child.on('exit', common.mustCall(function(code) {
+  assert.strictEqual(code, 0);
+}));
@@ -0,0 +1,63 @@
+'use strict';
+// The spawns that can't be done with posix_spawn() fall back to fork(), the
+// result is the same either way.
+const common = require('../common');
+const assert = require('assert');
+const cp = require('child_process');
+const fs = require('fs');
+const path = require('path');
+
+if (common.isWindows) {
+  common.skip('no fork() on Windows');
+  return;
+}
+
+common.refreshTmpDir();
+
+function run(file, args, options, expected) {
+  const child = cp.spawn(file, args, options);
+  let stdout = '';
+  child.stdout.setEncoding('utf8');
+  child.stdout.on('data', (chunk) => stdout += chunk);
+  child.on('close', common.mustCall((code) => {
+    assert.strictEqual(code, 0);
+    assert.strictEqual(stdout, expected);
+  }));
+}
+
+// posix_spawn().
+const env = Object.assign({}, process.env, { FOO: 'bar' });
+run('sh', ['-c', 'echo $FOO'], { env }, 'bar\n');
+run('sh', ['-c', 'pwd'], { cwd: common.tmpDir },
+    fs.realpathSync(common.tmpDir) + '\n');
+
+// A PATH of its own is searched by the child.
+const bin = path.join(common.tmpDir, 'bin');
+fs.mkdirSync(bin);
+const script = path.join(bin, 'no-shebang');
+// Without a #! line the file is run by /bin/sh, as execvp() does.
+fs.writeFileSync(script, 'echo no shebang\n');
+fs.chmodSync(script, 0o755);
+run('no-shebang', [], { env: { PATH: bin + ':/bin:/usr/bin' } },
+    'no shebang\n');
+run(script, [], {}, 'no shebang\n');
+
+// stderr goes to its own pipe.
+const child = cp.spawn('sh', ['-c', 'echo out; echo err >&2'], {
+  stdio: ['ignore', 'pipe', 'pipe']
+});
+let stderr = '';
+child.stderr.setEncoding('utf8');
+child.stderr.on('data', (chunk) => stderr += chunk);
+child.on('close', common.mustCall(() => {
+  assert.strictEqual(stderr, 'err\n');
+}));
+
+function expectENOENT(file) {
+  cp.spawn(file).on('error', common.mustCall((err) => {
+    assert.strictEqual(err.code, 'ENOENT');
+  }));
+}
+
+expectENOENT('command-that-does-not-exist');
+expectENOENT(path.join(common.tmpDir, 'missing'));
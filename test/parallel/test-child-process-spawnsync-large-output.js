@@ -0,0 +1,51 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const fs = require('fs');
+const path = require('path');
+const spawnSync = require('child_process').spawnSync;
+
+// Several times the size of the initial output buffer, in uneven writes.
+const size = 5 * 1024 * 1024 + 7;
+const script = `
+  const chunk = Buffer.alloc(${size});
+  for (let i = 0; i < chunk.length; i++)
+    chunk[i] = i % 251;
+  let offset = 0;
+  while (offset < chunk.length) {
+    const end = Math.min(offset + 100003, chunk.length);
+    process.stdout.write(chunk.slice(offset, end));
+    offset = end;
+  }
+`;
+
+function check(output) {
+  assert.strictEqual(output.length, size);
+  for (let i = 0; i < output.length; i++) {
+    if (output[i] !== i % 251)
+      assert.fail(output[i], i % 251, `byte ${i} differs`);
+  }
+}
+
+{
+  const ret = spawnSync(process.execPath, ['-e', script]);
+  assert.strictEqual(ret.status, 0);
+  assert.ifError(ret.error);
+  check(ret.stdout);
+  assert.strictEqual(ret.stderr.length, 0);
+  assert.strictEqual(ret.output[1], ret.stdout);
+}
+
+{
+  // Output that goes to a file descriptor isn't buffered at all.
+  common.refreshTmpDir();
+  const file = path.join(common.tmpDir, 'spawnsync-output');
+  const fd = fs.openSync(file, 'w');
+  const ret = spawnSync(process.execPath, ['-e', script], {
+    stdio: ['ignore', fd, 'pipe']
+  });
+  fs.closeSync(fd);
+  assert.strictEqual(ret.status, 0);
+  assert.strictEqual(ret.stdout, null);
+  check(fs.readFileSync(file));
+}
@@ -0,0 +1,63 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const childProcess = require('child_process');
+const fs = require('fs');
+
+if (process.argv[2] === 'child') {
+  process.send({
+    argv: process.argv.slice(2),
+    cwd: process.cwd(),
+    env: process.env.ZYGOTE_TEST,
+    zygote: process.env.NODE_ZYGOTE_CHILD
+  });
+  process.exitCode = 3;
+  return;
+}
+
+assert.throws(() => childProcess.createZygote(null), TypeError);
+assert.throws(() => childProcess.createZygote({ size: '1' }), TypeError);
+assert.throws(() => childProcess.createZygote({ size: -1 }), RangeError);
+assert.throws(() => childProcess.createZygote({ execArgv: '' }), TypeError);
+
+common.refreshTmpDir();
+const tmpDir = fs.realpathSync(common.tmpDir);
+
+const zygote = childProcess.createZygote({ size: 2 });
+assert.strictEqual(zygote.idle, 2);
+assert.throws(() => zygote.fork(1), TypeError);
+
+const first = zygote.fork(__filename, ['child', 'a'], {
+  cwd: tmpDir,
+  env: { ZYGOTE_TEST: 'x' }
+});
+assert.strictEqual(zygote.idle, 1);
+assert.deepStrictEqual(first.spawnargs.slice(-3), [__filename, 'child', 'a']);
+
+first.on('message', common.mustCall((message) => {
+  assert.deepStrictEqual(message, {
+    argv: ['child', 'a'],
+    cwd: tmpDir,
+    env: 'x'
+  });
+}));
+
+first.on('exit', common.mustCall((code) => {
+  assert.strictEqual(code, 3);
+  // The pool was refilled in the meantime.
+  assert.strictEqual(zygote.idle, 2);
+
+  const second = zygote.fork(__filename, ['child']);
+  second.on('message', common.mustCall((message) => {
+    assert.deepStrictEqual(message, {
+      argv: ['child'],
+      cwd: process.cwd()
+    });
+  }));
+  second.on('exit', common.mustCall((code) => {
+    assert.strictEqual(code, 3);
+    zygote.close();
+    assert.strictEqual(zygote.idle, 0);
+    assert.throws(() => zygote.fork(__filename), /^Error: Zygote is closed$/);
+  }));
+}));
@@ -0,0 +1,38 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const cluster = require('cluster');
+
+if (process.platform !== 'linux') {
+  common.skip('CPU affinity is only supported on Linux');
+  return;
+}
+
+if (cluster.isWorker) {
+  assert.strictEqual(process.env.NODE_CLUSTER_AFFINITY, undefined);
+  process.send(process.getAffinity());
+  return;
+}
+
+const allowed = process.getAffinity();
+const workers = Math.min(allowed.length + 1, 3);
+cluster.setupMaster({ affinity: true });
+assert.strictEqual(cluster.settings.affinity, true);
+
+const pinned = [];
+for (var i = 0; i < workers; i++) {
+  cluster.fork().on('message', common.mustCall(function(cpus) {
+    // A CPU of its own, one of the master's.
+    assert.strictEqual(cpus.length, 1);
+    assert.notStrictEqual(allowed.indexOf(cpus[0]), -1);
+    pinned.push(cpus[0]);
+    this.disconnect();
+  }));
+}
+
+process.on('exit', () => {
+  assert.strictEqual(pinned.length, workers);
+  // Workers only share a CPU once all of them have one.
+  const distinct = pinned.filter((cpu, j) => pinned.indexOf(cpu) === j);
+  assert.strictEqual(distinct.length, Math.min(workers, allowed.length));
+});
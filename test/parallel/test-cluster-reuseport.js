@@ -0,0 +1,57 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const cluster = require('cluster');
+const net = require('net');
+
+if (process.platform !== 'linux' && !common.isFreeBSD) {
+  console.log('1..0 # Skipped: SO_REUSEPORT does not balance connections');
+  return;
+}
+
+const workers = 2;
+const connections = 20;
+
+if (cluster.isWorker) {
+  const server = net.createServer(function(conn) {
+    conn.end(String(cluster.worker.id));
+  });
+  server.listen(0, '127.0.0.1', function() {
+    process.send({ port: server.address().port });
+  });
+  return;
+}
+
+cluster.schedulingPolicy = cluster.SCHED_REUSEPORT;
+
+const ports = [];
+for (let i = 0; i < workers; i++) {
+  const worker = cluster.fork();
+  worker.on('message', common.mustCall(function(message) {
+    ports.push(message.port);
+    if (ports.length === workers)
+      connect();
+  }));
+  worker.on('exit', common.mustCall(function(code) {
+    assert.strictEqual(code, 0);
+  }));
+}
+
+function connect() {
+  // Every worker listens on the port that the master picked.
+  assert.strictEqual(ports[0], ports[1]);
+
+  let done = 0;
+  for (let i = 0; i < connections; i++) {
+    net.connect(ports[0], '127.0.0.1', function() {
+      let id = '';
+      this.setEncoding('utf8');
+      this.on('data', (data) => id += data);
+      this.on('end', common.mustCall(function() {
+        assert(cluster.workers[id]);
+        if (++done === connections)
+          cluster.disconnect();
+      }));
+    });
+  }
+}
@@ -0,0 +1,71 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const cluster = require('cluster');
+const net = require('net');
+
+if (cluster.isWorker) {
+  // Connections stay open until the client closes them.
+  const server = net.createServer(function(conn) {
+    conn.write(String(cluster.worker.id));
+    conn.on('end', () => conn.end());
+  });
+  server.listen(0, '127.0.0.1', function() {
+    process.send({ port: server.address().port });
+  });
+  return;
+}
+
+cluster.schedulingPolicy = cluster.SCHED_LEAST;
+
+const workers = 2;
+var listening = 0;
+var port;
+for (var i = 0; i < workers; i++) {
+  const worker = cluster.fork();
+  worker.on('message', common.mustCall(function(message) {
+    port = message.port;
+    if (++listening === workers)
+      start();
+  }));
+  worker.on('exit', common.mustCall(function(code) {
+    assert.strictEqual(code, 0);
+  }));
+}
+
+// Opens `count` connections one after the other and passes them with the id
+// of the worker that got each of them to `cb`.
+function open(count, cb, conns) {
+  conns = conns || [];
+  if (conns.length === count)
+    return cb(conns);
+  const conn = net.connect(port, '127.0.0.1');
+  conn.setEncoding('utf8');
+  conn.once('data', common.mustCall((id) => {
+    conn.id = id;
+    conns.push(conn);
+    open(count, cb, conns);
+  }));
+}
+
+function start() {
+  open(4, common.mustCall((conns) => {
+    // The connections are spread evenly.
+    const ids = conns.map((conn) => conn.id).sort();
+    assert.strictEqual(ids[0], ids[1]);
+    assert.strictEqual(ids[2], ids[3]);
+    assert.notStrictEqual(ids[1], ids[2]);
+
+    // Once the first worker reports that its connections are closed, it gets
+    // the next ones.
+    const idle = conns[0].id;
+    conns.filter((conn) => conn.id === idle).forEach((conn) => conn.end());
+    setTimeout(common.mustCall(() => {
+      open(2, common.mustCall((more) => {
+        assert.deepStrictEqual(more.map((conn) => conn.id), [idle, idle]);
+        conns.concat(more).forEach((conn) => conn.end());
+        cluster.disconnect();
+      }));
+    }), common.platformTimeout(1500));
+  }));
+}
@@ -0,0 +1,70 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const cluster = require('cluster');
+
+if (common.isWindows) {
+  common.skip('shared memory caches are not supported on Windows');
+  return;
+}
+
+if (cluster.isWorker) {
+  const cache = cluster.sharedCache;
+  assert.strictEqual(cache.get('master').toString(), 'hello');
+  assert.strictEqual(cache.get(Buffer.from('master')).toString(), 'hello');
+  const id = cluster.worker.id;
+  assert.strictEqual(cache.set(`worker${id}`, Buffer.alloc(1000, id)), true);
+  process.send('done');
+  return;
+}
+
+assert.strictEqual(cluster.sharedCache, undefined);
+assert.throws(() => cluster.setupMaster({ sharedCacheSize: -1 }), RangeError);
+
+cluster.setupMaster({ sharedCacheSize: 64 * 1024 });
+const cache = cluster.sharedCache;
+assert.throws(() => cache.get(42), TypeError);
+assert.throws(() => cache.set('x', 42), TypeError);
+assert.strictEqual(cache.set('master', 'hello'), true);
+assert.strictEqual(cache.set('empty', ''), true);
+assert.strictEqual(cache.get('empty').length, 0);
+assert.strictEqual(cache.get('missing'), undefined);
+assert.strictEqual(cache.set('huge', Buffer.alloc(cache.maxEntrySize + 1)),
+                   false);
+
+const kWorkers = 2;
+var exited = 0;
+for (var i = 0; i < kWorkers; i++) {
+  const worker = cluster.fork();
+  worker.on('message', common.mustCall((msg) => {
+    assert.strictEqual(msg, 'done');
+    worker.disconnect();
+  }));
+  worker.on('exit', common.mustCall((code) => {
+    assert.strictEqual(code, 0);
+    if (++exited === kWorkers)
+      checkCache();
+  }));
+}
+
+function checkCache() {
+  for (var id = 1; id <= kWorkers; id++)
+    assert(cache.get(`worker${id}`).equals(Buffer.alloc(1000, id)));
+  assert.strictEqual(cache.delete('worker1'), true);
+  assert.strictEqual(cache.delete('worker1'), false);
+  assert.strictEqual(cache.get('worker1'), undefined);
+
+  // Filling the cache evicts the entries that were used least recently.
+  cache.get('master');
+  const before = cache.stats();
+  for (var n = 0; n < 1000; n++) {
+    assert.strictEqual(cache.set(`fill${n}`, Buffer.alloc(1000)), true);
+    cache.get('master');
+  }
+  const after = cache.stats();
+  assert(after.evictions > before.evictions);
+  assert(after.hits > before.hits);
+  assert.strictEqual(cache.get('master').toString(), 'hello');
+  assert.strictEqual(cache.get('fill0'), undefined);
+  assert(cache.get('fill999').equals(Buffer.alloc(1000)));
+}
@@ -0,0 +1,80 @@
+'use strict';
+// Flags: --expose-gc
+
+const common = require('../common');
+const assert = require('assert');
+const fs = require('fs');
+const path = require('path');
+const BinaryLogger = console.BinaryLogger;
+
+common.refreshTmpDir();
+
+{
+  const file = path.join(common.tmpDir, 'binary.log');
+  const fd = fs.openSync(file, 'w');
+  const logger = new BinaryLogger(fd);
+
+  const request = logger.register('request %s %d took %dms');
+  const flags = logger.register('flags %s %s %s %s %s');
+  assert.notStrictEqual(request, flags);
+
+  assert.strictEqual(logger.log(request, '/☃', 200, 1.5), true);
+  assert.strictEqual(logger.log(flags, true, false, null, undefined, {}), true);
+  assert.strictEqual(logger.log(request), true);
+  logger.flush();
+
+  const records = BinaryLogger.decode(fs.readFileSync(file));
+  assert.strictEqual(records.length, 3);
+  assert.strictEqual(records[0].id, request);
+  assert.strictEqual(records[0].format, 'request %s %d took %dms');
+  assert.deepStrictEqual(records[0].args, ['/☃', 200, 1.5]);
+  assert.strictEqual(records[1].format, 'flags %s %s %s %s %s');
+  assert.deepStrictEqual(records[1].args,
+                         [true, false, null, null, '[object Object]']);
+  assert.deepStrictEqual(records[2].args, []);
+  assert(records[0].time <= records[1].time);
+  assert(records[1].time <= records[2].time);
+
+  assert.throws(() => logger.log(flags + 1), RangeError);
+  assert.throws(() => logger.log('1'), TypeError);
+  assert.throws(() => logger.register(1), TypeError);
+
+  logger.end();
+  assert.strictEqual(logger.log(request, 'dropped'), false);
+  assert.throws(() => logger.register('x'), /^Error: The logger was ended$/);
+  assert.strictEqual(logger.getStats().dropped, 1);
+  fs.closeSync(fd);
+}
+
+{
+  // A full buffer drops records, registrations wait for space instead.
+  const file = path.join(common.tmpDir, 'binary-small.log');
+  const fd = fs.openSync(file, 'w');
+  const logger = new BinaryLogger(fd, { bufferSize: 1, gc: true });
+  const id = logger.register('%s');
+  let logged = 0;
+  for (let i = 0; i < 1000; i++) {
+    if (logger.log(id, 'x'.repeat(100)))
+      logged++;
+  }
+  const last = logger.register('last');
+  assert.throws(() => logger.register('x'.repeat(5000)), RangeError);
+  global.gc();
+  logger.end();
+
+  const stats = logger.getStats();
+  assert(logged > 0 && logged < 1000);
+  assert(stats.dropped >= 1000 - logged);
+  assert.strictEqual(stats.errors, 0);
+  assert.strictEqual(stats.lastError, null);
+
+  const records = BinaryLogger.decode(fs.readFileSync(file));
+  const gc = records.filter((record) => /^gc /.test(record.format));
+  assert(gc.length >= 2);
+  assert(records.every((record) => record.id !== last));
+  fs.closeSync(fd);
+}
+
+assert.throws(() => new BinaryLogger(-1), TypeError);
+assert.throws(() => new BinaryLogger(1, { bufferSize: 0 }), RangeError);
+assert.throws(() => BinaryLogger.decode('abc'), TypeError);
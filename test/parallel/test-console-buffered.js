@@ -0,0 +1,65 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const fs = require('fs');
+const path = require('path');
+const spawn = require('child_process').spawn;
+const BufferedWriter = console.BufferedWriter;
+
+const lines = 10000;
+
+if (process.argv[2] === 'child') {
+  const writer = console.enableBuffering();
+  assert.strictEqual(console.enableBuffering(), writer);
+  for (let i = 0; i < lines; i++)
+    console.log('line %d', i);
+  // Written out on exit.
+  return;
+}
+
+{
+  // Everything arrives in order through a pipe.
+  const child = spawn(process.execPath, [__filename, 'child']);
+  let output = '';
+  child.stdout.setEncoding('utf8');
+  child.stdout.on('data', (chunk) => output += chunk);
+  child.on('close', common.mustCall((code) => {
+    assert.strictEqual(code, 0);
+    const expected = [];
+    for (let i = 0; i < lines; i++)
+      expected.push(`line ${i}`);
+    assert.strictEqual(output, expected.join('\n') + '\n');
+  }));
+}
+
+{
+  common.refreshTmpDir();
+  const file = path.join(common.tmpDir, 'buffered.log');
+  const fd = fs.openSync(file, 'w');
+  const writer = new BufferedWriter(fd, { bufferSize: 1 });
+  const logger = new console.Console(writer);
+
+  logger.log('a %s', 'b');
+  assert.strictEqual(writer.write(Buffer.from('c\n')), true);
+  assert.strictEqual(writer.write('ZA==\n', 'base64'), true);
+  writer.flush();
+  assert.strictEqual(fs.readFileSync(file, 'utf8'), 'a b\nc\nd');
+
+  // Writes that don't fit are dropped as a whole.
+  assert.strictEqual(writer.write('x'.repeat(5000)), false);
+  writer.end('\ne\n');
+  assert.strictEqual(writer.write('f'), false);
+  assert.deepStrictEqual(writer.getStats(), {
+    dropped: 2,
+    droppedBytes: 5001,
+    errors: 0,
+    lastError: null
+  });
+  assert.strictEqual(fs.readFileSync(file, 'utf8'), 'a b\nc\nd\ne\n');
+  fs.closeSync(fd);
+}
+
+assert.throws(() => new BufferedWriter(-1), TypeError);
+assert.throws(() => new BufferedWriter('1'), TypeError);
+assert.throws(() => new BufferedWriter(1, { bufferSize: 0 }), RangeError);
+assert.throws(() => new BufferedWriter(1, { bufferSize: 1.5 }), RangeError);
@@ -0,0 +1,69 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+
+if (!common.hasCrypto) {
+  common.skip('missing crypto');
+  return;
+}
+const crypto = require('crypto');
+
+const key = Buffer.alloc(32, 'k');
+const iv = Buffer.alloc(16, 'i');
+
+// Mix of chunks below and above the threadpool threshold, all of them issued
+// before the first one completes.
+const chunks = [
+  Buffer.alloc(1024 * 1024, 'a'),
+  Buffer.alloc(100, 'b'),
+  'some string',
+  Buffer.alloc(256 * 1024, 'c'),
+  Buffer.alloc(3, 'd')
+];
+
+const expected = crypto.createCipheriv('aes-256-cbc', key, iv);
+const parts = chunks.map((chunk) => expected.update(chunk));
+parts.push(expected.final());
+const ciphertext = Buffer.concat(parts);
+
+const cipher = crypto.createCipheriv('aes-256-cbc', key, iv);
+const results = [];
+let completed = 0;
+
+assert.throws(function() {
+  cipher.updateAsync(chunks[0]);
+}, /^TypeError: "callback" argument must be a function$/);
+assert.throws(function() {
+  cipher.updateAsync(42, common.fail);
+}, /^TypeError: Cipher data must be a string or a buffer$/);
+
+chunks.forEach(function(chunk, i) {
+  cipher.updateAsync(chunk, common.mustCall(function(err, out) {
+    assert.ifError(err);
+    assert(Buffer.isBuffer(out));
+    assert.strictEqual(completed++, i);
+    results.push(out);
+    if (completed === chunks.length)
+      finish();
+  }));
+});
+
+assert.throws(function() {
+  cipher.update(chunks[0]);
+}, /^Error: Asynchronous update in progress$/);
+assert.throws(function() {
+  cipher.final();
+}, /^Error: Asynchronous update in progress$/);
+
+function finish() {
+  results.push(cipher.final());
+  assert.deepStrictEqual(Buffer.concat(results), ciphertext);
+
+  const decipher = crypto.createDecipheriv('aes-256-cbc', key, iv);
+  decipher.updateAsync(ciphertext, common.mustCall(function(err, out) {
+    assert.ifError(err);
+    const plaintext = Buffer.concat([out, decipher.final()]);
+    assert.deepStrictEqual(plaintext,
+                           Buffer.concat(chunks.map((c) => Buffer.from(c))));
+  }));
+}
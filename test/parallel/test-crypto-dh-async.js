@@ -0,0 +1,88 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+
+if (!common.hasCrypto) {
+  common.skip('missing crypto');
+  return;
+}
+const crypto = require('crypto');
+
+// Diffie-Hellman, keys generated in the threadpool on both sides.
+{
+  const alice = crypto.getDiffieHellman('modp5');
+  const bob = crypto.getDiffieHellman('modp5');
+
+  alice.generateKeysAsync(common.mustCall(function(err, aliceKey) {
+    assert.ifError(err);
+    assert(Buffer.isBuffer(aliceKey));
+    assert.deepStrictEqual(aliceKey, alice.getPublicKey());
+
+    bob.generateKeysAsync('hex', common.mustCall(function(err, bobKey) {
+      assert.ifError(err);
+      assert.strictEqual(bobKey, bob.getPublicKey('hex'));
+
+      const expected = alice.computeSecret(bobKey, 'hex', 'hex');
+      assert.strictEqual(bob.computeSecret(aliceKey, null, 'hex'), expected);
+
+      alice.computeSecretAsync(bobKey, 'hex', 'hex',
+                               common.mustCall(function(err, secret) {
+                                 assert.ifError(err);
+                                 assert.strictEqual(secret, expected);
+                               }));
+      bob.computeSecretAsync(aliceKey, common.mustCall(function(err, secret) {
+        assert.ifError(err);
+        assert.strictEqual(secret.toString('hex'), expected);
+      }));
+    }));
+  }));
+
+  // The object is usable while keys are being generated.
+  assert.strictEqual(alice.getPrime('hex'), bob.getPrime('hex'));
+
+  assert.throws(function() {
+    alice.generateKeysAsync();
+  }, /^TypeError: "callback" argument must be a function$/);
+  assert.throws(function() {
+    alice.computeSecretAsync(Buffer.alloc(1), 'hex', 'hex');
+  }, /^TypeError: "callback" argument must be a function$/);
+}
+
+// Invalid public keys are reported to the callback.
+{
+  const dh = crypto.getDiffieHellman('modp1');
+  dh.generateKeys();
+  dh.computeSecretAsync(Buffer.from([1]), common.mustCall(function(err) {
+    assert(/^Error: Supplied key is too small$/.test(err));
+  }));
+}
+
+// ECDH.
+{
+  const alice = crypto.createECDH('prime256v1');
+  const bob = crypto.createECDH('prime256v1');
+  bob.generateKeys();
+
+  alice.generateKeysAsync('hex', 'compressed',
+                          common.mustCall(function(err, aliceKey) {
+                            assert.ifError(err);
+                            onECDHKeys(aliceKey);
+                          }));
+
+  const onECDHKeys = function(aliceKey) {
+    assert.strictEqual(aliceKey, alice.getPublicKey('hex', 'compressed'));
+
+    const expected = bob.computeSecret(aliceKey, 'hex', 'hex');
+    alice.computeSecretAsync(bob.getPublicKey(),
+                             common.mustCall(function(err, secret) {
+                               assert.ifError(err);
+                               assert.strictEqual(secret.toString('hex'),
+                                                  expected);
+                             }));
+  };
+
+  assert.throws(function() {
+    crypto.createECDH('prime256v1').computeSecretAsync(bob.getPublicKey(),
+                                                       common.fail);
+  }, /^Error: Invalid key pair$/);
+}
@@ -0,0 +1,58 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+
+if (!common.hasCrypto) {
+  common.skip('missing crypto');
+  return;
+}
+const crypto = require('crypto');
+const net = require('net');
+const stream = require('stream');
+
+const payload = Buffer.alloc(4 * 1024 * 1024);
+for (let i = 0; i < payload.length; i++)
+  payload[i] = i % 251;
+
+const sha256 = crypto.createHash('sha256').update(payload).digest('hex');
+const hmac = crypto.createHmac('sha1', 'key').update(payload).digest('hex');
+
+assert.throws(function() {
+  crypto.createHash('sha256').digestStream(new stream.PassThrough());
+}, /^TypeError: "callback" argument must be a function$/);
+
+// Streams without a native handle are digested in JS.
+{
+  const input = new stream.PassThrough();
+  const hash = crypto.createHash('sha256');
+  hash.digestStream(input, 'hex', common.mustCall((err, digest) => {
+    assert.ifError(err);
+    assert.strictEqual(digest, sha256);
+  }));
+  input.end(payload);
+}
+
+// Sockets are digested natively, including the data that was read already.
+function digestSocket(createDigest, expected, cb) {
+  const server = net.createServer(function(socket) {
+    socket.once('data', common.mustCall(function(chunk) {
+      socket.unshift(chunk);
+      createDigest().digestStream(socket, common.mustCall((err, digest) => {
+        assert.ifError(err);
+        assert(Buffer.isBuffer(digest));
+        assert.strictEqual(digest.toString('hex'), expected);
+        server.close(cb);
+      }));
+    }));
+  });
+
+  server.listen(0, function() {
+    const client = net.connect(this.address().port, function() {
+      client.end(payload);
+    });
+  });
+}
+
+digestSocket(() => crypto.createHash('sha256'), sha256, common.mustCall(() => {
+  digestSocket(() => crypto.createHmac('sha1', 'key'), hmac, common.mustCall());
+}));
@@ -0,0 +1,86 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+
+if (!common.hasCrypto) {
+  common.skip('missing crypto');
+  return;
+}
+const crypto = require('crypto');
+const fs = require('fs');
+
+function readKey(name) {
+  return fs.readFileSync(common.fixturesDir + '/' + name, 'ascii');
+}
+
+const certPem = readKey('test_cert.pem');
+const keyPem = readKey('test_key.pem');
+const rsaPubPem = readKey('test_rsa_pubkey.pem');
+const rsaKeyPem = readKey('test_rsa_privkey.pem');
+const rsaKeyPemEncrypted = readKey('test_rsa_privkey_encrypted.pem');
+
+const privateKey = crypto.createPrivateKey(keyPem);
+const publicKey = crypto.createPublicKey(certPem);
+assert(privateKey instanceof crypto.KeyObject);
+assert.strictEqual(privateKey.type, 'private');
+assert.strictEqual(publicKey.type, 'public');
+
+// Keys can be reused and produce the same results as PEM encoded keys.
+for (let i = 0; i < 3; i++) {
+  const sign = crypto.createSign('RSA-SHA256').update('data ' + i);
+  const signature = sign.sign(privateKey);
+  assert.deepStrictEqual(signature, crypto.createSign('RSA-SHA256')
+                                          .update('data ' + i)
+                                          .sign(keyPem));
+
+  const verify = crypto.createVerify('RSA-SHA256').update('data ' + i);
+  assert.strictEqual(verify.verify(publicKey, signature), true);
+  assert.deepStrictEqual(
+    crypto.verifyBatch('RSA-SHA256', publicKey, [['data ' + i, signature],
+                                                 ['other', signature]]),
+    [true, false]);
+}
+
+// Private keys contain the public key.
+{
+  const signature = crypto.createSign('RSA-SHA1').update('x').sign(privateKey);
+  const verify = crypto.createVerify('RSA-SHA1').update('x');
+  assert.strictEqual(verify.verify(privateKey, signature), true);
+}
+
+// Public key encryption.
+{
+  const input = Buffer.from('I AM THE WALRUS');
+  const rsaPublic = crypto.createPublicKey(rsaPubPem);
+  const rsaPrivate = crypto.createPrivateKey({
+    key: rsaKeyPemEncrypted,
+    passphrase: 'password'
+  });
+
+  const encrypted = crypto.publicEncrypt(rsaPublic, input);
+  assert.deepStrictEqual(crypto.privateDecrypt(rsaPrivate, encrypted), input);
+  assert.deepStrictEqual(crypto.privateDecrypt(rsaKeyPem, encrypted), input);
+
+  const signed = crypto.privateEncrypt({ key: rsaPrivate }, input);
+  assert.deepStrictEqual(crypto.publicDecrypt(rsaPublic, signed), input);
+
+  assert.throws(function() {
+    crypto.privateDecrypt(rsaPublic, encrypted);
+  }, /^TypeError: A private key is required$/);
+}
+
+assert.throws(function() {
+  crypto.createSign('RSA-SHA256').update('x').sign(publicKey);
+}, /^TypeError: A private key is required$/);
+assert.throws(function() {
+  crypto.createPublicKey('not a key');
+}, /^Error: /);
+assert.throws(function() {
+  crypto.createPrivateKey(certPem);
+}, /^Error: /);
+assert.throws(function() {
+  crypto.createPrivateKey({ key: rsaKeyPemEncrypted, passphrase: 'wrong' });
+}, /^Error: /);
+assert.throws(function() {
+  crypto.createPublicKey(42);
+}, /^TypeError: Key must be a string or a buffer$/);
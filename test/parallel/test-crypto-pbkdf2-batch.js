@@ -0,0 +1,54 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+
+if (!common.hasCrypto) {
+  common.skip('missing crypto');
+  return;
+}
+
+const crypto = require('crypto');
+
+assert.throws(() => crypto.pbkdf2Batch({}, 1, 16, 'sha1'), TypeError);
+assert.throws(() => crypto.pbkdf2Batch([['a']], 1, 16, 'sha1'), TypeError);
+assert.throws(() => crypto.pbkdf2Batch([], 1, 16), TypeError);
+assert.throws(() => crypto.pbkdf2Batch([], -1, 16, 'sha1'), TypeError);
+assert.throws(() => crypto.pbkdf2Batch([], 1, 16, 'md55'), TypeError);
+
+// Keys longer than one digest, and passwords longer than one HMAC block.
+const items = [
+  ['password', 'salt'],
+  ['', 'salt'],
+  ['pass', ''],
+  [Buffer.from('p\u0000ss'), Buffer.alloc(33, 's')],
+  ['x'.repeat(200), 'salt']
+];
+
+function expected(iterations, keylen, digest) {
+  return items.map((item) => {
+    return crypto.pbkdf2Sync(item[0], item[1], iterations, keylen, digest);
+  });
+}
+
+[1, 2, 100].forEach((iterations) => {
+  ['sha1', 'sha256', 'sha512'].forEach((digest) => {
+    [0, 20, 77].forEach((keylen) => {
+      assert.deepStrictEqual(
+          crypto.pbkdf2Batch(items, iterations, keylen, digest),
+          expected(iterations, keylen, digest));
+    });
+  });
+});
+
+// The asynchronous version runs in the crypto queue.
+const before = process.threadpoolStats().crypto.submitted;
+crypto.pbkdf2Batch(items, 1000, 32, 'sha256', common.mustCall((err, keys) => {
+  assert.ifError(err);
+  assert.deepStrictEqual(keys, expected(1000, 32, 'sha256'));
+}));
+assert.strictEqual(process.threadpoolStats().crypto.submitted, before + 1);
+
+crypto.pbkdf2Batch([], 1, 16, 'sha1', common.mustCall((err, keys) => {
+  assert.ifError(err);
+  assert.deepStrictEqual(keys, []);
+}));
@@ -0,0 +1,49 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+
+if (!common.hasCrypto) {
+  common.skip('missing crypto');
+  return;
+}
+
+const crypto = require('crypto');
+
+// Enough small requests to go through the pool several times.  Bytes that
+// were handed out must never be handed out again.
+const seen = new Set();
+function check(buf, size) {
+  assert(buf instanceof Buffer);
+  assert.strictEqual(buf.length, size);
+  const hex = buf.toString('hex');
+  assert(!seen.has(hex), 'random bytes were repeated');
+  seen.add(hex);
+}
+
+for (var i = 0; i < 5000; i++)
+  check(crypto.randomBytes(16), 16);
+
+// Callbacks are called asynchronously, also when the pool has the bytes.
+const done = common.mustCall(() => {});
+var pending = 5000;
+function next() {
+  var called = false;
+  crypto.randomBytes(32, (err, buf) => {
+    called = true;
+    assert.ifError(err);
+    check(buf, 32);
+    if (--pending > 0)
+      next();
+    else
+      done();
+  });
+  assert.strictEqual(called, false);
+}
+next();
+
+// Larger requests bypass the pool.
+check(crypto.randomBytes(257), 257);
+crypto.randomBytes(4096, common.mustCall((err, buf) => {
+  assert.ifError(err);
+  check(buf, 4096);
+}));
@@ -0,0 +1,54 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+
+if (!common.hasCrypto) {
+  common.skip('missing crypto');
+  return;
+}
+const crypto = require('crypto');
+const fs = require('fs');
+
+const certPem = fs.readFileSync(common.fixturesDir + '/test_cert.pem', 'ascii');
+const keyPem = fs.readFileSync(common.fixturesDir + '/test_key.pem', 'ascii');
+
+// Every third signature is made for different data and must fail.
+const items = [];
+const expected = [];
+for (let i = 0; i < 100; i++) {
+  const data = 'message ' + i;
+  const signature = crypto.createSign('RSA-SHA256')
+                          .update(i % 3 === 0 ? 'other' : data)
+                          .sign(keyPem);
+  items.push([i % 2 ? Buffer.from(data) : data, signature]);
+  expected.push(i % 3 !== 0);
+}
+
+assert.deepStrictEqual(crypto.verifyBatch('RSA-SHA256', certPem, items),
+                       expected);
+assert.deepStrictEqual(crypto.verifyBatch('RSA-SHA256', certPem, []), []);
+
+const onverified = common.mustCall(function(err, results) {
+  assert.ifError(err);
+  assert.deepStrictEqual(results, expected);
+});
+crypto.verifyBatch('RSA-SHA256', certPem, items, onverified);
+
+assert.throws(function() {
+  crypto.verifyBatch('RSA-SHA256', certPem, {});
+}, /^TypeError: "items" argument must be an array$/);
+assert.throws(function() {
+  crypto.verifyBatch('RSA-SHA256', certPem, [['data']]);
+}, /^TypeError: Items must be \[data, signature\] pairs$/);
+assert.throws(function() {
+  crypto.verifyBatch('RSA-SHA256', certPem, [[1, 2]]);
+}, /^TypeError: Messages and signatures must be buffers$/);
+assert.throws(function() {
+  crypto.verifyBatch('nope', certPem, items);
+}, /^Error: Unknown message digest$/);
+assert.throws(function() {
+  crypto.verifyBatch('RSA-SHA256', 'not a key', items);
+}, /^Error: /);
+assert.throws(function() {
+  crypto.verifyBatch('RSA-SHA256', certPem, items, 'callback');
+}, /^TypeError: "callback" argument must be a function$/);
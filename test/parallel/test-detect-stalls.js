@@ -0,0 +1,31 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const child_process = require('child_process');
+
+const warning =
+    /^\(node:\d+\) WARNING: The event loop has been blocked for (\d+) ms$/m;
+
+// A callback that keeps the loop from coming around is reported once, with
+// its stack.
+const busy = 'setTimeout(function spin() {' +
+             '  const end = Date.now() + 1000;' +
+             '  while (Date.now() < end);' +
+             '}, 10);';
+child_process.execFile(process.execPath, ['--detect-stalls=100', '-e', busy],
+                       common.mustCall(function(err, stdout, stderr) {
+                         assert.ifError(err);
+                         const match = stderr.match(warning);
+                         assert(match, stderr);
+                         assert(+match[1] >= 100);
+                         assert(/^ +at spin \(/m.test(stderr), stderr);
+                         assert.strictEqual(stderr.split('WARNING').length, 2);
+                       }));
+
+// An idle loop is not blocked.
+const idle = 'setTimeout(() => {}, 500);';
+child_process.execFile(process.execPath, ['--detect-stalls=100', '-e', idle],
+                       common.mustCall(function(err, stdout, stderr) {
+                         assert.ifError(err);
+                         assert.strictEqual(stderr, '');
+                       }));
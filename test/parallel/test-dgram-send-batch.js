@@ -0,0 +1,47 @@
+'use strict';
+
+const common = require('../common');
+const assert = require('assert');
+const dgram = require('dgram');
+
+const messages = ['first', 'second', Buffer.from('third'), 'fourth'];
+const expected = messages.map(String);
+const received = [];
+
+const server = dgram.createSocket({ type: 'udp4', recvBatch: true });
+const client = dgram.createSocket('udp4');
+
+assert.throws(() => client.sendBatch('foo'), TypeError);
+assert.throws(() => client.sendBatch([null]), TypeError);
+assert.throws(() => client.sendBatch([{ msg: 42, port: 1 }]), TypeError);
+assert.throws(() => client.sendBatch([{ msg: 'a', port: 0 }]), RangeError);
+assert.throws(() => client.sendBatch([{ msg: 'a', port: 1, address: '::1' }]),
+              TypeError);
+assert.throws(() => {
+  client.sendBatch([{ msg: 'a', port: 1, address: 'localhost' }]);
+}, TypeError);
+
+client.sendBatch([], common.mustCall((err, bytes) => {
+  assert.strictEqual(err, null);
+  assert.strictEqual(bytes, 0);
+}));
+
+server.on('message', (msg, rinfo) => {
+  assert.strictEqual(rinfo.size, msg.length);
+  received.push(msg.toString());
+  if (received.length !== expected.length)
+    return;
+  assert.deepStrictEqual(received.sort(), expected.slice().sort());
+  server.close();
+  client.close();
+});
+
+server.bind(0, common.mustCall(() => {
+  const port = server.address().port;
+  const list = messages.map((msg) => ({ msg, port }));
+  list[0].address = '127.0.0.1';
+  client.sendBatch(list, common.mustCall((err, bytes) => {
+    assert.strictEqual(err, null);
+    assert.strictEqual(bytes, expected.join('').length);
+  }));
+}));
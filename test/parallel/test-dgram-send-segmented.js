@@ -0,0 +1,61 @@
+'use strict';
+
+const common = require('../common');
+const assert = require('assert');
+const dgram = require('dgram');
+
+if (process.platform !== 'linux') {
+  console.log('1..0 # Skipped: UDP segmentation offload is Linux-only');
+  return;
+}
+
+const segmentSize = 100;
+const payload = Buffer.alloc(segmentSize * 4 + 50);
+for (var i = 0; i < payload.length; i++)
+  payload[i] = i / segmentSize;
+
+const server = dgram.createSocket('udp4');
+const client = dgram.createSocket('udp4');
+const received = [];
+
+assert.throws(() => client.sendSegmented(42, segmentSize, 1), TypeError);
+assert.throws(() => client.sendSegmented(payload, 0, 1), RangeError);
+assert.throws(() => client.sendSegmented(payload, 65536, 1), RangeError);
+assert.throws(() => client.sendSegmented(payload, 1.5, 1), RangeError);
+assert.throws(() => client.sendSegmented(payload, segmentSize, 0), RangeError);
+
+server.on('message', (msg, rinfo) => {
+  if (rinfo.segmentSize !== undefined)
+    assert.strictEqual(rinfo.segmentSize, segmentSize);
+  else
+    assert(msg.length <= segmentSize);
+  received.push(msg);
+
+  const data = Buffer.concat(received);
+  if (data.length < payload.length)
+    return;
+  assert.deepStrictEqual(data, payload);
+  server.close();
+  client.close();
+});
+
+server.bind(0, common.mustCall(() => {
+  // Kernels older than 4.18 don't support GRO and GSO.
+  try {
+    server.setGRO(true);
+  } catch (e) {
+    assert.strictEqual(e.syscall, 'setGRO');
+  }
+
+  const port = server.address().port;
+  client.sendSegmented(payload, segmentSize, port, common.localhostIPv4,
+                       common.mustCall((err, bytes) => {
+                         if (err) {
+                           console.log('1..0 # Skipped: ' + err.message);
+                           server.close();
+                           client.close();
+                           return;
+                         }
+                         assert.strictEqual(bytes, payload.length);
+                       }));
+}));
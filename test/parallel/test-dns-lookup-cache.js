@@ -0,0 +1,72 @@
+'use strict';
+
+const common = require('../common');
+const assert = require('assert');
+const dns = require('dns');
+
+const concurrent = 5;
+
+assert.throws(() => dns.enableLookupCache(null), TypeError);
+assert.throws(() => dns.enableLookupCache({ ttl: -1 }), TypeError);
+assert.throws(() => dns.enableLookupCache({ ttl: Infinity }), TypeError);
+assert.throws(() => dns.enableLookupCache({ maxEntries: 0 }), TypeError);
+assert.throws(() => dns.enableLookupCache({ maxEntries: 1.5 }), TypeError);
+
+dns.enableLookupCache({ ttl: 60 * 1000 });
+
+let pending = concurrent;
+let first;
+for (let i = 0; i < concurrent; i++) {
+  dns.lookup('localhost', common.mustCall(function(err, address, family) {
+    assert.ifError(err);
+    if (first === undefined)
+      first = { address, family };
+    assert.deepStrictEqual({ address, family }, first);
+    if (--pending === 0)
+      lookupCached();
+  }));
+}
+
+// Only one of the lookups went to getaddrinfo().
+assert.deepStrictEqual(dns.getLookupCacheStats(), {
+  hits: 0,
+  misses: 1,
+  coalesced: concurrent - 1,
+  size: 0
+});
+
+function lookupCached() {
+  assert.strictEqual(dns.getLookupCacheStats().size, 1);
+
+  let sync = true;
+  dns.lookup('localhost', common.mustCall(function(err, address, family) {
+    assert.ifError(err);
+    assert.strictEqual(sync, false);
+    assert.deepStrictEqual({ address, family }, first);
+    assert.strictEqual(dns.getLookupCacheStats().hits, 1);
+
+    dns.lookup('localhost', { all: true }, common.mustCall(function(err, all) {
+      assert.ifError(err);
+      assert(all.length >= 1);
+      assert.deepStrictEqual(all[0], first);
+      assert.strictEqual(dns.getLookupCacheStats().hits, 2);
+      lookupUncached();
+    }));
+  }));
+  sync = false;
+}
+
+function lookupUncached() {
+  dns.disableLookupCache();
+  assert.strictEqual(dns.getLookupCacheStats().size, 0);
+
+  dns.lookup('localhost', common.mustCall(function(err) {
+    assert.ifError(err);
+    assert.deepStrictEqual(dns.getLookupCacheStats(), {
+      hits: 2,
+      misses: 1,
+      coalesced: concurrent - 1,
+      size: 0
+    });
+  }));
+}
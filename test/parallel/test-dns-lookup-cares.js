@@ -0,0 +1,49 @@
+'use strict';
+
+const common = require('../common');
+const assert = require('assert');
+const dns = require('dns');
+const net = require('net');
+
+assert.throws(() => dns.lookup('localhost', { resolver: 'nss' }, () => {}),
+              /resolver must be "getaddrinfo" or "cares"/);
+assert.throws(() => dns.setDefaultLookupResolver('nss'),
+              /resolver must be "getaddrinfo" or "cares"/);
+
+// localhost comes from the hosts file.
+let sync = true;
+dns.lookup('localhost', { family: 4, resolver: 'cares' },
+           common.mustCall(function(err, address, family) {
+             assert.ifError(err);
+             assert.strictEqual(sync, false);
+             assert.strictEqual(address, '127.0.0.1');
+             assert.strictEqual(family, 4);
+           }));
+sync = false;
+
+dns.lookup('localhost', { all: true, resolver: 'cares' },
+           common.mustCall(function(err, addresses) {
+             assert.ifError(err);
+             assert(addresses.length >= 1);
+             assert.deepStrictEqual(addresses[0],
+                                    { address: '127.0.0.1', family: 4 });
+           }));
+
+const server = net.createServer(function(conn) {
+  conn.end();
+});
+
+server.listen(0, '127.0.0.1', common.mustCall(function() {
+  dns.setDefaultLookupResolver('cares');
+  const socket = net.connect({ port: this.address().port, host: 'localhost' });
+  socket.on('lookup', common.mustCall(function(err, address, family, host) {
+    assert.ifError(err);
+    assert.strictEqual(address, '127.0.0.1');
+    assert.strictEqual(host, 'localhost');
+    dns.setDefaultLookupResolver('getaddrinfo');
+  }));
+  socket.on('end', common.mustCall(function() {
+    server.close();
+  }));
+  socket.resume();
+}));
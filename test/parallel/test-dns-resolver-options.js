@@ -0,0 +1,50 @@
+'use strict';
+
+const common = require('../common');
+const assert = require('assert');
+const dns = require('dns');
+
+assert.throws(() => dns.setResolverOptions(null), /must be an object/);
+assert.throws(() => dns.setResolverOptions({ timeout: 0 }),
+              /"timeout" must be an integer/);
+assert.throws(() => dns.setResolverOptions({ tries: 1.5 }),
+              /"tries" must be an integer/);
+assert.throws(() => dns.setResolverOptions({ ednsBufferSize: 100 }),
+              /"ednsBufferSize" must be an integer from 512 to 65535/);
+assert.throws(() => dns.setResolverOptions({ channels: 17 }),
+              /"channels" must be an integer from 1 to 16/);
+
+// The servers are kept, on every channel.
+dns.setServers(['127.0.0.1']);
+dns.setResolverOptions({
+  timeout: 100,
+  tries: 1,
+  rotate: true,
+  stayOpen: true,
+  ednsBufferSize: 1232,
+  channels: 4
+});
+assert.deepStrictEqual(dns.getServers(), ['127.0.0.1']);
+dns.setServers(['127.0.0.1', '::1']);
+assert.deepStrictEqual(dns.getServers(), ['127.0.0.1', '::1']);
+dns.setServers(['127.0.0.1']);
+
+// Whatever the answer is, the queries are spread over the channels and each
+// one calls back once the short timeout is over at the latest.
+const queries = 8;
+let pending = queries;
+for (let i = 0; i < queries; i++) {
+  dns.resolve4('resolver-options.invalid', common.mustCall(() => {
+    // Not from the callback of a query either.
+    assert.throws(() => dns.setResolverOptions({ channels: 2 }),
+                  /cannot be set while queries are pending/);
+    if (--pending > 0)
+      return;
+    setImmediate(common.mustCall(() => {
+      dns.setResolverOptions({});
+      assert.deepStrictEqual(dns.getServers(), ['127.0.0.1']);
+    }));
+  }));
+}
+assert.throws(() => dns.setResolverOptions({}),
+              /cannot be set while queries are pending/);
@@ -0,0 +1,87 @@
+'use strict';
+// Flags: --expose_internals
+
+const common = require('../common');
+const assert = require('assert');
+const EventEmitter = require('events');
+const domain = require('domain');
+const internalEvents = require('internal/events');
+
+{
+  const ee = new EventEmitter();
+  assert.strictEqual(internalEvents.emitNone(ee, 'foo'), false);
+  assert.strictEqual(internalEvents.emitOne(ee, 'foo', 1), false);
+
+  ee.on('foo', common.mustCall(function(arg) {
+    assert.strictEqual(this, ee);
+    assert.strictEqual(arg, 1);
+  }));
+  assert.strictEqual(internalEvents.emitOne(ee, 'foo', 1), true);
+}
+
+{
+  // A listener added or removed while emitting doesn't change who is called.
+  const ee = new EventEmitter();
+  const calls = [];
+  function a() {
+    calls.push('a');
+    ee.removeListener('foo', b);
+    ee.on('foo', c);
+  }
+  function b() {
+    calls.push('b');
+  }
+  function c() {
+    calls.push('c');
+  }
+  ee.on('foo', a);
+  ee.on('foo', b);
+  internalEvents.emitNone(ee, 'foo');
+  assert.deepStrictEqual(calls, ['a', 'b']);
+  internalEvents.emitNone(ee, 'foo');
+  assert.deepStrictEqual(calls, ['a', 'b', 'a', 'c']);
+
+  calls.length = 0;
+  ee.emit('foo');
+  assert.deepStrictEqual(calls, ['a', 'c', 'c']);
+  assert.strictEqual(ee.listenerCount('foo'), 4);
+
+  ee.removeAllListeners('foo');
+  assert.strictEqual(ee.listenerCount('foo'), 0);
+}
+
+{
+  // An emit() of their own still sees every event.
+  const ee = new EventEmitter();
+  const events = [];
+  ee.emit = function(type, arg) {
+    events.push([type, arg]);
+    return EventEmitter.prototype.emit.apply(this, arguments);
+  };
+  ee.on('foo', common.mustCall(() => {}, 2));
+  internalEvents.emitNone(ee, 'foo');
+  internalEvents.emitOne(ee, 'foo', 2);
+  assert.deepStrictEqual(events, [['foo', undefined], ['foo', 2]]);
+}
+
+{
+  // Emitters bound to a domain enter it.
+  const d = domain.create();
+  const ee = new EventEmitter();
+  d.add(ee);
+  ee.on('foo', common.mustCall(() => {
+    assert.strictEqual(process.domain, d);
+  }));
+  internalEvents.emitOne(ee, 'foo', 1);
+}
+
+{
+  // The leak warning is still only printed once per event.
+  const ee = new EventEmitter();
+  ee.setMaxListeners(1);
+  process.on('warning', common.mustCall(() => {}));
+  for (let i = 0; i < 4; i++)
+    ee.on('foo', () => {});
+  ee.removeListener('foo', ee.listeners('foo')[0]);
+  ee.on('foo', () => {});
+}
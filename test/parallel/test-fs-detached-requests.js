@@ -0,0 +1,29 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const fs = require('fs');
+const path = require('path');
+
+common.refreshTmpDir();
+
+// Requests without a callback still report their errors.
+process.on('uncaughtException', common.mustCall((err) => {
+  assert.strictEqual(err.code, 'EBADF');
+  assert(err.syscall === 'close' || err.syscall === 'fsync');
+}, 2));
+
+const fd = fs.openSync(path.join(common.tmpDir, 'detached'), 'w');
+fs.ftruncate(fd, 4);
+fs.futimes(fd, 0, 0);
+fs.fsync(fd);
+
+// Give the requests above the time to complete before their fd is bad.
+setTimeout(common.mustCall(() => {
+  const stats = fs.fstatSync(fd);
+  assert.strictEqual(stats.size, 4);
+  assert.strictEqual(stats.mtime.getTime(), 0);
+  fs.closeSync(fd);
+
+  fs.close(fd);
+  fs.fsync(fd);
+}), common.platformTimeout(100));
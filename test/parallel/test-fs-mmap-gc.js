@@ -0,0 +1,40 @@
+'use strict';
+// Flags: --expose-gc
+const common = require('../common');
+const assert = require('assert');
+const fs = require('fs');
+const path = require('path');
+
+// The Buffers of fs.mmap() are unmapped through the ArrayBuffer allocator
+// when they are collected, without a weak handle each.
+
+if (process.platform !== 'linux') {
+  common.skip('/proc/self/maps is only available on Linux');
+  return;
+}
+
+common.refreshTmpDir();
+
+const file = path.join(common.tmpDir, 'mmap-gc.dat');
+fs.writeFileSync(file, Buffer.alloc(64 * 1024, 'x'));
+
+function countMappings() {
+  return fs.readFileSync('/proc/self/maps', 'latin1')
+           .split('\n')
+           .filter((line) => line.endsWith(file))
+           .length;
+}
+
+const fd = fs.openSync(file, 'r');
+let buffers = [];
+for (let i = 0; i < 100; i++)
+  buffers.push(fs.mmap(fd, i * 100, 4096));
+fs.closeSync(fd);
+
+// Neighbouring mappings of the file may be merged.
+assert(countMappings() > 0);
+assert.strictEqual(buffers[99][0], 'x'.charCodeAt(0));
+
+buffers = null;
+global.gc();
+assert.strictEqual(countMappings(), 0);
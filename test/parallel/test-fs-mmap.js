@@ -0,0 +1,57 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const fs = require('fs');
+const path = require('path');
+
+if (common.isWindows) {
+  common.skip('fs.mmap() is not supported on Windows');
+  return;
+}
+
+common.refreshTmpDir();
+
+const file = path.join(common.tmpDir, 'mmap.dat');
+const data = Buffer.alloc(3 * 4096 + 100);
+for (let i = 0; i < data.length; i++)
+  data[i] = i % 251;
+fs.writeFileSync(file, data);
+
+const fd = fs.openSync(file, 'r');
+
+// Whole file.
+const whole = fs.mmap(fd);
+assert(whole instanceof Buffer);
+assert(whole.equals(data));
+
+// Offsets don't have to be page aligned.
+assert(fs.mmap(fd, 4097, 5000).equals(data.slice(4097, 4097 + 5000)));
+assert(fs.mmap(fd, 100).equals(data.slice(100)));
+assert.strictEqual(fs.mmap(fd, data.length).length, 0);
+assert.strictEqual(fs.mmap(fd, 0, 0).length, 0);
+
+// The mapping outlives the file descriptor and writes stay private.
+const mapped = fs.mmap(fd, 0, 10);
+fs.closeSync(fd);
+mapped[0] = 42;
+assert.strictEqual(mapped[0], 42);
+assert.strictEqual(fs.readFileSync(file)[0], 0);
+
+assert.throws(function() {
+  fs.mmap(fd);
+}, /EBADF/);
+
+const fd2 = fs.openSync(file, 'r');
+assert.throws(function() {
+  fs.mmap(fd2, data.length + 1);
+}, /^RangeError: "offset" is beyond the end of the file$/);
+assert.throws(function() {
+  fs.mmap(fd2, 10, data.length);
+}, /^RangeError: "length" extends beyond the end of the file$/);
+assert.throws(function() {
+  fs.mmap(fd2, -1);
+}, /^TypeError: "offset" argument must be a non-negative integer$/);
+assert.throws(function() {
+  fs.mmap(fd2, 0, 1.5);
+}, /^TypeError: "length" argument must be a non-negative integer$/);
+fs.closeSync(fd2);
@@ -0,0 +1,70 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const fs = require('fs');
+const path = require('path');
+
+const promises = fs.promises;
+common.refreshTmpDir();
+const dir = path.join(common.tmpDir, 'promises');
+const file = path.join(dir, 'file.txt');
+const renamed = path.join(dir, 'renamed.txt');
+var fd;
+
+// Errors reject, also when they happen before the request is dispatched.
+const missing = promises.stat(path.join(common.tmpDir, 'missing'));
+assert(missing instanceof Promise);
+missing.then(common.fail, common.mustCall((err) => {
+  assert.strictEqual(err.code, 'ENOENT');
+  assert.strictEqual(err.syscall, 'stat');
+}));
+promises.close(-1).then(common.fail, common.mustCall((err) => {
+  assert.strictEqual(err.code, 'EBADF');
+}));
+promises.open('foo\u0000bar').then(common.fail, common.mustCall((err) => {
+  assert.strictEqual(err.code, 'ENOENT');
+}));
+
+promises.mkdir(dir).then((result) => {
+  assert.strictEqual(result, undefined);
+  return promises.open(file, 'w+');
+}).then((result) => {
+  assert.strictEqual(typeof result, 'number');
+  fd = result;
+  return promises.write(fd, Buffer.from('hello '));
+}).then((written) => {
+  assert.strictEqual(written, 6);
+  return promises.write(fd, 'wörld', 6);
+}).then((written) => {
+  assert.strictEqual(written, 6);
+  return promises.fstat(fd);
+}).then((stats) => {
+  assert(stats instanceof fs.Stats);
+  assert.strictEqual(stats.size, 12);
+  const buffer = Buffer.alloc(12);
+  return promises.read(fd, buffer, 0, 12, 0).then((bytesRead) => {
+    assert.strictEqual(bytesRead, 12);
+    assert.strictEqual(buffer.toString(), 'hello wörld');
+  });
+}).then(() => {
+  return promises.close(fd);
+}).then(() => {
+  return promises.rename(file, renamed);
+}).then(() => {
+  return promises.readdir(dir, { withFileTypes: true });
+}).then((entries) => {
+  assert.strictEqual(entries.length, 1);
+  assert.strictEqual(entries[0].name, 'renamed.txt');
+  assert(entries[0].isFile());
+  return promises.readFile(renamed, 'utf8');
+}).then((data) => {
+  assert.strictEqual(data, 'hello wörld');
+  return promises.unlink(renamed);
+}).then(() => {
+  return promises.readdir(dir);
+}).then((names) => {
+  assert.deepStrictEqual(names, []);
+  return promises.rmdir(dir);
+}).then(common.mustCall(() => {
+  assert.throws(() => fs.accessSync(dir));
+}));
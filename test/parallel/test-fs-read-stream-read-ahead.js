@@ -0,0 +1,47 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const fs = require('fs');
+const path = require('path');
+
+assert.throws(() => fs.createReadStream(__filename, { readAhead: -1 }),
+              /"readAhead" option must be a non-negative integer/);
+assert.throws(() => fs.createReadStream(__filename, { readAhead: 1.5 }),
+              /"readAhead" option must be a non-negative integer/);
+
+common.refreshTmpDir();
+
+// Several chunks and an uneven tail.
+const file = path.join(common.tmpDir, 'read-ahead.bin');
+const content = Buffer.alloc(10 * 1024 + 17);
+for (let i = 0; i < content.length; i++)
+  content[i] = i % 253;
+fs.writeFileSync(file, content);
+
+function check(options, expected) {
+  const chunks = [];
+  const stream = fs.createReadStream(file, Object.assign({
+    highWaterMark: 1024,
+    readAhead: 4
+  }, options));
+  stream.on('data', function(chunk) {
+    chunks.push(chunk);
+    // A slow consumer, the reads ahead complete in the meantime.
+    stream.pause();
+    setTimeout(() => stream.resume(), 1);
+  });
+  stream.on('end', common.mustCall(function() {
+    assert.deepStrictEqual(Buffer.concat(chunks), expected);
+  }));
+}
+
+check({}, content);
+check({ start: 1000, end: 5000 }, content.slice(1000, 5001));
+check({ start: 0, end: 0 }, content.slice(0, 1));
+check({ readAhead: 1 }, content);
+
+{
+  // An explicit position is needed to read ahead from an fd.
+  const fd = fs.openSync(file, 'r');
+  check({ fd: fd, start: 3 }, content.slice(3));
+}
@@ -0,0 +1,60 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const fs = require('fs');
+const path = require('path');
+
+common.refreshTmpDir();
+
+const files = ['empty', 'file.txt', 'other.js'];
+const dirs = ['dir', 'dir2'];
+for (const name of files)
+  fs.writeFileSync(path.join(common.tmpDir, name), name);
+for (const name of dirs)
+  fs.mkdirSync(path.join(common.tmpDir, name));
+
+function check(dirents) {
+  assert(Array.isArray(dirents));
+  const names = dirents.map((dirent) => dirent.name).sort();
+  assert.deepStrictEqual(names, dirs.concat(files).sort());
+  for (const dirent of dirents) {
+    assert(dirent instanceof fs.Dirent);
+    const isDir = dirs.indexOf(dirent.name) !== -1;
+    assert.strictEqual(dirent.isDirectory(), isDir);
+    assert.strictEqual(dirent.isFile(), !isDir);
+    assert.strictEqual(dirent.isSymbolicLink(), false);
+    assert.strictEqual(dirent.isFIFO(), false);
+    assert.strictEqual(dirent.isSocket(), false);
+    assert.strictEqual(dirent.isCharacterDevice(), false);
+    assert.strictEqual(dirent.isBlockDevice(), false);
+  }
+}
+
+check(fs.readdirSync(common.tmpDir, { withFileTypes: true }));
+
+fs.readdir(common.tmpDir, { withFileTypes: true },
+           common.mustCall(function(err, dirents) {
+             assert.ifError(err);
+             check(dirents);
+           }));
+
+// Names keep the requested encoding.
+{
+  const dirents = fs.readdirSync(common.tmpDir, {
+    encoding: 'buffer',
+    withFileTypes: true
+  });
+  assert(dirents.every((dirent) => Buffer.isBuffer(dirent.name)));
+}
+
+// Without the option, plain names are returned as before.
+assert.deepStrictEqual(fs.readdirSync(common.tmpDir).sort(),
+                       dirs.concat(files).sort());
+
+fs.readdir(path.join(common.tmpDir, 'missing'), { withFileTypes: true },
+           common.mustCall(function(err) {
+             assert.strictEqual(err.code, 'ENOENT');
+           }));
+assert.throws(function() {
+  fs.readdirSync(path.join(common.tmpDir, 'missing'), { withFileTypes: true });
+}, /^Error: ENOENT: no such file or directory, scandir/);
@@ -0,0 +1,36 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const fs = require('fs');
+const path = require('path');
+
+common.refreshTmpDir();
+
+const missing = path.join(common.tmpDir, 'does-not-exist');
+fs.readFile(missing, common.mustCall(function(err, data) {
+  assert.strictEqual(err.code, 'ENOENT');
+  assert.strictEqual(err.syscall, 'open');
+  assert.strictEqual(err.path, missing);
+  assert.strictEqual(data, undefined);
+}));
+
+if (!common.isWindows) {
+  fs.readFile(common.tmpDir, common.mustCall(function(err, data) {
+    assert.strictEqual(err.code, 'EISDIR');
+    assert.strictEqual(err.syscall, 'read');
+  }));
+}
+
+[0, 1, 8 * 1024, 100 * 1024 + 3].forEach(function(size) {
+  const file = path.join(common.tmpDir, `readfile-${size}`);
+  const content = Buffer.alloc(size, 'x');
+  fs.writeFileSync(file, content);
+  fs.readFile(file, common.mustCall(function(err, data) {
+    assert.ifError(err);
+    assert.deepStrictEqual(data, content);
+  }));
+  fs.readFile(file, 'binary', common.mustCall(function(err, data) {
+    assert.ifError(err);
+    assert.strictEqual(data, content.toString('binary'));
+  }));
+});
@@ -0,0 +1,43 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const fs = require('fs');
+const path = require('path');
+
+// Large enough for fs.readFile() and fs.writeFile() to convert on the
+// threadpool.
+const length = 1024 * 1024 + 1;
+
+common.refreshTmpDir();
+
+function check(name, string, encoding) {
+  const file = path.join(common.tmpDir, name);
+  fs.writeFile(file, string, encoding, common.mustCall(function(err) {
+    assert.ifError(err);
+    const expected = Buffer.from(string, encoding);
+    const buffer = fs.readFileSync(file);
+    assert.ok(buffer.equals(expected), `${name} was written differently`);
+    fs.readFile(file, encoding, common.mustCall(function(err, data) {
+      assert.ifError(err);
+      assert.strictEqual(data, expected.toString(encoding));
+    }));
+  }));
+}
+
+check('ascii', 'a'.repeat(length), 'utf8');
+check('latin1', 'aé'.repeat(length / 2), 'utf8');
+check('two-byte', 'a€😀'.repeat(length / 3), 'utf8');
+// Unpaired surrogates are written as U+FFFD.
+check('surrogates', '\udc00a\ud800'.repeat(length / 3), 'utf8');
+check('base64', Buffer.alloc(length, 'xyz').toString('base64'), 'base64');
+
+{
+  // Malformed UTF-8 is decoded like Buffer#toString() does it.
+  const file = path.join(common.tmpDir, 'malformed');
+  const buffer = Buffer.alloc(length, 'a\xff\xc3', 'binary');
+  fs.writeFileSync(file, buffer);
+  fs.readFile(file, 'utf8', common.mustCall(function(err, data) {
+    assert.ifError(err);
+    assert.strictEqual(data, buffer.toString('utf8'));
+  }));
+}
@@ -0,0 +1,77 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const fs = require('fs');
+const path = require('path');
+
+common.refreshTmpDir();
+
+const file = path.join(common.tmpDir, 'file');
+const link = path.join(common.tmpDir, 'link');
+const missing = path.join(common.tmpDir, 'missing');
+fs.writeFileSync(file, 'hello');
+
+let haveLink = true;
+try {
+  fs.symlinkSync(file, link);
+} catch (e) {
+  haveLink = false;
+}
+
+function compare(actual, expected) {
+  assert(actual instanceof fs.Stats);
+  assert.deepStrictEqual(actual, expected);
+}
+
+// Enough paths to be split across several threadpool jobs.
+const paths = [];
+for (let i = 0; i < 300; i++)
+  paths.push(i % 3 === 0 ? common.tmpDir : i % 3 === 1 ? file : missing);
+paths.push(Buffer.from(file));
+
+fs.statMany(paths, common.mustCall(function(err, results) {
+  assert.ifError(err);
+  assert.strictEqual(results.length, paths.length);
+  const dirStats = fs.statSync(common.tmpDir);
+  const fileStats = fs.statSync(file);
+  for (let i = 0; i < 300; i++) {
+    if (i % 3 === 0) {
+      compare(results[i], dirStats);
+      assert(results[i].isDirectory());
+    } else if (i % 3 === 1) {
+      compare(results[i], fileStats);
+      assert.strictEqual(results[i].size, 5);
+    } else {
+      assert(results[i] instanceof Error);
+      assert.strictEqual(results[i].code, 'ENOENT');
+      assert.strictEqual(results[i].syscall, 'stat');
+      assert.strictEqual(results[i].path, missing);
+    }
+  }
+  compare(results[300], fileStats);
+}));
+
+if (haveLink) {
+  fs.lstatMany([link, file], common.mustCall(function(err, results) {
+    assert.ifError(err);
+    compare(results[0], fs.lstatSync(link));
+    assert(results[0].isSymbolicLink());
+    compare(results[1], fs.lstatSync(file));
+  }));
+}
+
+fs.statMany([], common.mustCall(function(err, results) {
+  assert.ifError(err);
+  assert.deepStrictEqual(results, []);
+}));
+
+fs.statMany([file, 'foo\u0000bar'], common.mustCall(function(err) {
+  assert.strictEqual(err.code, 'ENOENT');
+}));
+
+assert.throws(function() {
+  fs.statMany('not an array', common.fail);
+}, /^TypeError: "paths" argument must be an array$/);
+assert.throws(function() {
+  fs.statMany([file, 42], common.fail);
+}, /^TypeError: paths must be strings or Buffers$/);
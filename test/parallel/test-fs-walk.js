@@ -0,0 +1,91 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const fs = require('fs');
+const path = require('path');
+
+common.refreshTmpDir();
+
+const root = path.join(common.tmpDir, 'walk');
+const expected = {};
+
+function mkdir(name) {
+  fs.mkdirSync(path.join(root, name));
+  expected[path.join(root, name)] = 'dir';
+}
+
+function touch(name) {
+  fs.writeFileSync(path.join(root, name), name);
+  expected[path.join(root, name)] = 'file';
+}
+
+fs.mkdirSync(root);
+mkdir('a');
+mkdir('a/b');
+mkdir('a/b/c');
+mkdir('empty');
+for (let i = 0; i < 100; i++)
+  touch(`a/b/file-${i}`);
+touch('a/b/c/deep');
+touch('top');
+
+try {
+  fs.symlinkSync(path.join(root, 'a'), path.join(root, 'link'));
+  expected[path.join(root, 'link')] = 'link';
+} catch (e) {
+  // Creating symlinks may require privileges on Windows.
+}
+
+function type(dirent) {
+  if (dirent.isDirectory()) return 'dir';
+  if (dirent.isFile()) return 'file';
+  if (dirent.isSymbolicLink()) return 'link';
+  return 'other';
+}
+
+function walk(options) {
+  const seen = {};
+  fs.walk(root, options)
+    .on('data', function(dirent) {
+      assert(dirent instanceof fs.Dirent);
+      assert.strictEqual(dirent.name, path.basename(dirent.path));
+      assert.strictEqual(seen[dirent.path], undefined);
+      seen[dirent.path] = type(dirent);
+    })
+    .on('end', common.mustCall(function() {
+      // Symbolic links are not followed.
+      assert.deepStrictEqual(seen, expected);
+    }));
+}
+
+walk();
+walk({ batchSize: 1 });
+walk({ batchSize: 7 });
+
+// A directory is reported before the entries below it.
+{
+  const order = [];
+  fs.walk(root)
+    .on('data', (dirent) => order.push(dirent.path))
+    .on('end', common.mustCall(function() {
+      assert(order.indexOf(path.join(root, 'a')) <
+             order.indexOf(path.join(root, 'a', 'b', 'c', 'deep')));
+    }));
+}
+
+fs.walk(path.join(common.tmpDir, 'missing'))
+  .on('data', common.fail)
+  .on('error', common.mustCall(function(err) {
+    assert.strictEqual(err.code, 'ENOENT');
+    assert.strictEqual(err.syscall, 'scandir');
+  }));
+
+assert.throws(function() {
+  fs.walk(root, { batchSize: 0 });
+}, /^RangeError: "batchSize" must be a positive integer$/);
+assert.throws(function() {
+  fs.walk(root, { batchSize: 1.5 });
+}, /^RangeError: "batchSize" must be a positive integer$/);
+assert.throws(function() {
+  fs.walk(42);
+}, /^TypeError: root must be a string or Buffer$/);
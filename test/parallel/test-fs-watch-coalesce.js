@@ -0,0 +1,49 @@
+'use strict';
+
+const common = require('../common');
+
+if (common.isAix) {
+  console.log('1..0 # Skipped: fs.watch is not supported on AIX');
+  return;
+}
+
+const assert = require('assert');
+const path = require('path');
+const fs = require('fs');
+
+assert.throws(() => fs.watch(common.tmpDir, { coalesce: -1 }), TypeError);
+assert.throws(() => fs.watch(common.tmpDir, { coalesce: 1.5 }), TypeError);
+assert.throws(() => fs.watch(common.tmpDir, { coalesce: '10' }), TypeError);
+
+common.refreshTmpDir();
+
+const filename = 'coalesced.txt';
+const filepath = path.join(common.tmpDir, filename);
+fs.writeFileSync(filepath, '');
+
+const watcher = fs.watch(common.tmpDir, { coalesce: 100 });
+const changes = [];
+
+watcher.on('changes', common.mustCall(function(list) {
+  // Each filename appears once per window however often it changed.
+  const names = list.map((change) => change.filename);
+  names.forEach((name, i) => assert.strictEqual(names.indexOf(name), i));
+  list.forEach((change) => {
+    assert.ok(change.eventType === 'change' || change.eventType === 'rename');
+  });
+  assert.ok(names.indexOf(filename) !== -1);
+  watcher.close();
+}));
+
+watcher.on('change', function(event, name) {
+  changes.push(name);
+});
+
+for (let i = 0; i < 10; i++)
+  fs.appendFileSync(filepath, 'x');
+
+process.on('exit', function() {
+  // The 'change' events of a batch follow its 'changes' event, and stop
+  // when the watcher is closed.
+  assert.deepStrictEqual(changes, []);
+});
@@ -2,8 +2,8 @@
 
 const common = require('../common');
 
-if (!(process.platform === 'darwin' || common.isWindows)) {
-  console.log('1..0 # Skipped: recursive option is darwin/windows specific');
+if (common.isAix) {
+  console.log('1..0 # Skipped: fs.watch is not supported on AIX');
   return;
 }
 
@@ -17,6 +17,10 @@ const testsubdirName = 'testsubdir';
 const testsubdir = path.join(testDir, testsubdirName);
 const relativePathOne = path.join('testsubdir', filenameOne);
 const filepathOne = path.join(testsubdir, filenameOne);
+// Created while watching, with a file in it right away.
+const newdir = path.join(testDir, 'newdir', 'deep');
+const relativePathTwo = path.join('newdir', 'deep', 'new.txt');
+const filepathTwo = path.join(newdir, 'new.txt');
 
 common.refreshTmpDir();
 
@@ -25,18 +29,28 @@ fs.mkdirSync(testsubdir, 0o700);
 const watcher = fs.watch(testDir, {recursive: true});
 
 var watcherClosed = false;
+var sawNewFile = false;
 watcher.on('change', function(event, filename) {
   assert.ok('change' === event || 'rename' === event);
 
   // Ignore stale events generated by mkdir and other tests
-  if (filename !== relativePathOne)
-    return;
-
-  watcher.close();
-  watcherClosed = true;
+  if (filename === relativePathOne && !sawNewFile) {
+    sawNewFile = true;
+    clearInterval(interval);
+    fs.mkdirSync(path.dirname(newdir));
+    fs.mkdirSync(newdir);
+    fs.writeFileSync(filepathTwo, 'new');
+  } else if (filename === relativePathTwo && !watcherClosed) {
+    watcher.close();
+    watcherClosed = true;
+  }
 });
 
-fs.writeFileSync(filepathOne, 'world');
+// The directories below testDir are watched once the threadpool has read
+// them, write until the change shows up.
+const interval = setInterval(function() {
+  fs.writeFileSync(filepathOne, 'world');
+}, 50);
 
 process.on('exit', function() {
   assert(watcherClosed, 'watcher Object was not closed');
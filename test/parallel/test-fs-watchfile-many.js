@@ -0,0 +1,36 @@
+'use strict';
+
+const common = require('../common');
+const assert = require('assert');
+const fs = require('fs');
+const path = require('path');
+
+// Enough files with the same interval to be stat'ed in several batches.
+const count = 300;
+const files = [];
+
+common.refreshTmpDir();
+
+for (let i = 0; i < count; i++) {
+  const file = path.join(common.tmpDir, `watchfile-many-${i}.txt`);
+  fs.writeFileSync(file, 'a');
+  files.push(file);
+}
+
+const changed = files[count - 1];
+
+files.forEach(function(file) {
+  if (file === changed)
+    return;
+  fs.watchFile(file, {interval: 20}, common.fail);
+});
+
+fs.watchFile(changed, {interval: 20}, common.mustCall(function(curr, prev) {
+  assert.strictEqual(prev.size, 1);
+  assert.strictEqual(curr.size, 2);
+  files.forEach((file) => fs.unwatchFile(file));
+}));
+
+setTimeout(function() {
+  fs.appendFileSync(changed, 'b');
+}, 100);
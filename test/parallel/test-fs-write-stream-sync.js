@@ -0,0 +1,50 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const fs = require('fs');
+const path = require('path');
+
+common.refreshTmpDir();
+
+const file = path.join(common.tmpDir, 'write-stream-sync.txt');
+const stream = fs.createWriteStream(file);
+const records = 100;
+
+assert.throws(() => stream.sync(), /"callback" argument must be a function/);
+
+const fdatasync = fs.fdatasync;
+var syncs = 0;
+fs.fdatasync = function(fd, callback) {
+  syncs++;
+  assert.strictEqual(fd, stream.fd);
+  // What was written before a sync() is in the file by the time it runs.
+  const written = fs.readFileSync(file, 'utf8').split('\n').length - 1;
+  assert.ok(written >= synced);
+  fdatasync(fd, callback);
+};
+
+var synced = 0;
+function onsync(i) {
+  return common.mustCall(function(err) {
+    assert.ifError(err);
+    synced = Math.max(synced, i + 1);
+  });
+}
+
+for (var i = 0; i < records; i++) {
+  stream.write(`record ${i}\n`);
+  stream.sync(onsync(i));
+}
+stream.end();
+
+stream.on('close', common.mustCall(function() {
+  // The file is only closed once the last sync is done.
+  assert.strictEqual(synced, records);
+  // The sync() calls made while an fdatasync() ran share the next one.
+  assert.ok(syncs < records, `${syncs} syncs for ${records} records`);
+  const lines = fs.readFileSync(file, 'utf8').split('\n');
+  assert.strictEqual(lines.length, records + 1);
+  lines.slice(0, -1).forEach((line, i) => {
+    assert.strictEqual(line, `record ${i}`);
+  });
+}));
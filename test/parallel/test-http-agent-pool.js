@@ -0,0 +1,110 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const http = require('http');
+
+assert.throws(() => new http.Agent({ scheduling: 'random' }), TypeError);
+
+const server = http.createServer((req, res) => {
+  res.end(req.url);
+});
+
+function get(agent, host, path) {
+  return new Promise((resolve) => {
+    http.get({ host, port: common.PORT, agent, path }, (res) => {
+      const socket = res.socket;
+      res.resume();
+      res.on('end', () => process.nextTick(() => resolve(socket)));
+    });
+  });
+}
+
+function lifo() {
+  // The socket that was freed last is reused first.
+  const agent = new http.Agent({ keepAlive: true });
+  return Promise.all([
+    get(agent, 'localhost', '/1'),
+    get(agent, 'localhost', '/2')
+  ]).then(() => {
+    const name = agent.getName({ host: 'localhost', port: common.PORT });
+    const free = agent.freeSockets[name];
+    assert.strictEqual(free.length, 2);
+    const last = free[1];
+    return get(agent, 'localhost', '/3').then((socket) => {
+      assert.strictEqual(socket, last);
+      assert.deepStrictEqual(agent.getStats(), {
+        sockets: 0,
+        freeSockets: 2,
+        pendingRequests: 0,
+        created: 2,
+        reused: 1,
+        queued: 0,
+        timedOut: 0
+      });
+      agent.destroy();
+    });
+  });
+}
+
+function fifo() {
+  const agent = new http.Agent({ keepAlive: true, scheduling: 'fifo' });
+  return Promise.all([
+    get(agent, 'localhost', '/1'),
+    get(agent, 'localhost', '/2')
+  ]).then(() => {
+    const name = agent.getName({ host: 'localhost', port: common.PORT });
+    const first = agent.freeSockets[name][0];
+    return get(agent, 'localhost', '/3').then((socket) => {
+      assert.strictEqual(socket, first);
+      agent.destroy();
+    });
+  });
+}
+
+function freeSocketTimeout() {
+  const agent = new http.Agent({ keepAlive: true, freeSocketTimeout: 50 });
+  return get(agent, 'localhost', '/').then((socket) => {
+    assert.strictEqual(agent.getStats().freeSockets, 1);
+    return new Promise((resolve) => {
+      socket.on('close', common.mustCall(() => {
+        assert.deepStrictEqual(agent.freeSockets, {});
+        const stats = agent.getStats();
+        assert.strictEqual(stats.timedOut, 1);
+        assert.strictEqual(stats.freeSockets, 0);
+        assert.strictEqual(agent.totalSocketCount, 0);
+        resolve();
+      }));
+    });
+  });
+}
+
+function maxTotalSockets() {
+  // Requests of one origin wait for the sockets of another to be freed.
+  const agent = new http.Agent({ keepAlive: true, maxTotalSockets: 1 });
+  return get(agent, 'localhost', '/a').then((first) => {
+    assert.strictEqual(agent.getStats().freeSockets, 1);
+    return Promise.all([
+      get(agent, '127.0.0.1', '/b'),
+      get(agent, '127.0.0.1', '/c')
+    ]).then((sockets) => {
+      assert(first.destroyed);
+      assert.notStrictEqual(sockets[0], first);
+      assert.strictEqual(sockets[0], sockets[1]);
+      const stats = agent.getStats();
+      assert.strictEqual(stats.created, 2);
+      assert.strictEqual(stats.queued, 2);
+      assert.strictEqual(stats.pendingRequests, 0);
+      assert(agent.totalSocketCount <= 1);
+      agent.destroy();
+    });
+  });
+}
+
+server.listen(common.PORT, common.mustCall(() => {
+  lifo()
+    .then(fifo)
+    .then(freeSocketTimeout)
+    .then(maxTotalSockets)
+    .then(common.mustCall(() => server.close()))
+    .catch((err) => process.nextTick(() => { throw err; }));
+}));
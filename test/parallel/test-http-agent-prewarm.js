@@ -0,0 +1,55 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const http = require('http');
+
+assert.throws(() => new http.Agent().prewarm({}, -1), TypeError);
+
+let connections = 0;
+const server = http.createServer((req, res) => {
+  res.end(req.url);
+});
+server.on('connection', () => connections++);
+
+server.listen(common.PORT, common.mustCall(() => {
+  const agent = new http.Agent({ keepAlive: true, minFreeSockets: 2 });
+  const options = { host: 'localhost', port: common.PORT };
+  const name = agent.getName(options);
+  agent.prewarm(options);
+  assert.strictEqual(agent.freeSockets[name].length, 2);
+  assert.strictEqual(agent.totalSocketCount, 2);
+  const warm = agent.freeSockets[name].slice();
+
+  http.get({ host: 'localhost', port: common.PORT, agent, path: '/' },
+           common.mustCall((res) => {
+             assert.notStrictEqual(warm.indexOf(res.socket), -1);
+             res.resume();
+             res.on('end', common.mustCall(onEnd));
+           }));
+
+  function onEnd() {
+    // The socket that was taken is replaced.
+    setImmediate(common.mustCall(() => {
+      const stats = agent.getStats();
+      assert.strictEqual(stats.created, 3);
+      assert.strictEqual(stats.reused, 1);
+      assert.strictEqual(stats.freeSockets, 3);
+      const replacement = agent.freeSockets[name].filter((socket) => {
+        return warm.indexOf(socket) === -1;
+      })[0];
+      if (replacement.connecting)
+        replacement.on('connect', common.mustCall(done));
+      else
+        done();
+    }));
+  }
+
+  function done() {
+    agent.destroy();
+    server.close();
+  }
+}));
+
+process.on('exit', () => {
+  assert.strictEqual(connections, 3);
+});
@@ -0,0 +1,40 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const http = require('http');
+const net = require('net');
+
+// Buffers written to a chunked response are framed by the socket.  Check the
+// exact bytes on the wire, for writes that go out one by one as well as for
+// the ones that are queued up behind each other.
+const sizes = [1, 15, 16, 255, 256, 4096, 65537];
+var expected = '';
+for (var i = 0; i < sizes.length; i++)
+  expected += sizes[i].toString(16) + '\r\n' + 'x'.repeat(sizes[i]) + '\r\n';
+expected += '2\r\nab\r\n';
+expected += '0\r\n\r\n';
+
+const server = http.createServer(common.mustCall((req, res) => {
+  res.writeHead(200);
+  res.write(Buffer.alloc(sizes[0], 'x'), common.mustCall(() => {
+    for (var i = 1; i < sizes.length; i++)
+      res.write(Buffer.alloc(sizes[i], 'x'));
+    res.write('6162', 'hex');
+    res.write('', 'hex');
+    res.end();
+  }));
+}));
+
+server.listen(0, common.mustCall(() => {
+  const client = net.connect(server.address().port);
+  var response = '';
+  client.setEncoding('latin1');
+  client.on('data', (data) => response += data);
+  client.on('end', common.mustCall(() => {
+    const body = response.slice(response.indexOf('\r\n\r\n') + 4);
+    assert(/transfer-encoding: chunked/i.test(response));
+    assert.strictEqual(body, expected);
+    server.close();
+  }));
+  client.end('GET / HTTP/1.1\r\nHost: localhost\r\nConnection: close\r\n\r\n');
+}));
@@ -0,0 +1,35 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const http = require('http');
+
+// The Date header is formatted natively and cached per second.  It must be
+// identical to what Date.prototype.toUTCString() produces.
+
+const utcDate = process.binding('http_headers').utcDate;
+const imfFixdate =
+    /^(Sun|Mon|Tue|Wed|Thu|Fri|Sat), \d\d (Jan|Feb|Mar|Apr|May|Jun|Jul|Aug|Sep|Oct|Nov|Dec) \d{4} \d\d:\d\d:\d\d GMT$/;  // eslint-disable-line max-len
+
+function assertCurrentDate(value) {
+  assert(imfFixdate.test(value), value);
+  const delta = Math.abs(Date.parse(value) - Date.now());
+  assert(delta <= 2000, value);
+}
+
+const before = new Date().toUTCString();
+const value = utcDate();
+const after = new Date().toUTCString();
+assert(value === before || value === after, value);
+assertCurrentDate(value);
+
+const server = http.createServer(function(req, res) {
+  res.end();
+});
+
+server.listen(0, common.mustCall(function() {
+  http.get({ port: this.address().port }, common.mustCall(function(res) {
+    assertCurrentDate(res.headers.date);
+    res.resume();
+    server.close();
+  }));
+}));
@@ -0,0 +1,45 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const http = require('http');
+
+// The headers object is built from rawHeaders on first access, and
+// getHeader() works without building it.
+const server = http.createServer(common.mustCall((req, res) => {
+  assert.strictEqual(req._headersPending, true);
+  assert.strictEqual(req.getHeader('X-Dup'), 'a, b');
+  assert.deepStrictEqual(req.getHeader('set-cookie'), ['c=1', 'd=2']);
+  assert.strictEqual(req.getHeader('missing'), undefined);
+  assert.strictEqual(req._headersPending, true);
+
+  const raw = req.rawHeaders;
+  assert.strictEqual(raw[raw.indexOf('X-Dup') + 1], 'a');
+  assert.strictEqual(req._headersPending, true);
+
+  assert.strictEqual(req.headers['x-dup'], 'a, b');
+  assert.deepStrictEqual(req.headers['set-cookie'], ['c=1', 'd=2']);
+  assert.strictEqual(req.headers.host, `localhost:${server.address().port}`);
+  assert.strictEqual(req._headersPending, false);
+  assert.strictEqual(req.rawHeaders, raw);
+
+  res.end();
+}));
+
+server.listen(0, common.mustCall(() => {
+  http.get({
+    port: server.address().port,
+    headers: [
+      ['Host', `localhost:${server.address().port}`],
+      ['X-Dup', 'a'],
+      ['X-Dup', 'b'],
+      ['Set-Cookie', 'c=1'],
+      ['Set-Cookie', 'd=2']
+    ]
+  }, common.mustCall((res) => {
+    // Assigning the headers object replaces the one that is pending.
+    res.headers = { replaced: 'yes' };
+    assert.deepStrictEqual(res.headers, { replaced: 'yes' });
+    res.resume();
+    server.close();
+  }));
+}));
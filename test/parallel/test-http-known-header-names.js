@@ -0,0 +1,47 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const http = require('http');
+const net = require('net');
+
+// Well-known header names are interned by the parser.  Make sure that the
+// spelling that was received is preserved in rawHeaders and that all
+// spellings end up under the same key in headers.
+
+const server = http.createServer(common.mustCall(function(req, res) {
+  assert.deepStrictEqual(req.rawHeaders, [
+    'Host', 'localhost',
+    'user-agent', 'test',
+    'CONTENT-TYPE', 'text/plain',
+    'Content-Type', 'text/html',
+    'cookie', 'a=1',
+    'Cookie', 'b=2',
+    'X-Custom', 'c'
+  ]);
+  assert.deepStrictEqual(req.headers, {
+    'host': 'localhost',
+    'user-agent': 'test',
+    'content-type': 'text/plain',
+    'cookie': 'a=1, b=2',
+    'x-custom': 'c'
+  });
+  res.end();
+}));
+
+server.listen(0, common.mustCall(function() {
+  const client = net.connect(this.address().port, function() {
+    client.end('GET / HTTP/1.1\r\n' +
+               'Host: localhost\r\n' +
+               'user-agent: test\r\n' +
+               'CONTENT-TYPE: text/plain\r\n' +
+               'Content-Type: text/html\r\n' +
+               'cookie: a=1\r\n' +
+               'Cookie: b=2\r\n' +
+               'X-Custom: c\r\n' +
+               '\r\n');
+  });
+  client.resume();
+  client.on('end', function() {
+    server.close();
+  });
+}));
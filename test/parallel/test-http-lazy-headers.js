@@ -0,0 +1,66 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const http = require('http');
+const net = require('net');
+
+// Requests parsed with server.lazyHeaders must expose the same headers as
+// eagerly parsed ones, through both getHeader() and the headers object.
+
+const server = http.createServer(common.mustCall(function(req, res) {
+  assert.strictEqual(req._lazyHeaders !== null, true);
+  assert.strictEqual(req.getHeader('HOST'), 'example.com');
+  assert.strictEqual(req.getHeader('x-multi'), 'a, b');
+  assert.deepStrictEqual(req.getHeader('set-cookie'), ['c=1', 'd=2']);
+  assert.strictEqual(req.getHeader('content-type'), 'text/plain');
+  assert.strictEqual(req.getHeader('x-missing'), undefined);
+  assert.strictEqual(req.getHeader('x-empty'), '');
+  assert.throws(function() { req.getHeader(1); }, TypeError);
+
+  // getHeader() must not have materialized the headers.
+  assert.strictEqual(req._lazyHeaders !== null, true);
+
+  assert.deepStrictEqual(req.headers, {
+    'host': 'example.com',
+    'x-multi': 'a, b',
+    'set-cookie': ['c=1', 'd=2'],
+    'content-type': 'text/plain',
+    'x-empty': ''
+  });
+  assert.deepStrictEqual(req.rawHeaders, [
+    'Host', 'example.com',
+    'X-Multi', 'a',
+    'Set-Cookie', 'c=1',
+    'X-Multi', 'b',
+    'Content-Type', 'text/plain',
+    'Content-Type', 'text/html',
+    'Set-Cookie', 'd=2',
+    'X-Empty', ''
+  ]);
+  assert.strictEqual(req._lazyHeaders, null);
+  assert.strictEqual(req.getHeader('Host'), 'example.com');
+
+  res.end();
+}, 2));
+server.lazyHeaders = true;
+
+server.listen(0, common.mustCall(function() {
+  const request = 'GET / HTTP/1.1\r\n' +
+                  'Host: example.com\r\n' +
+                  'X-Multi: a\r\n' +
+                  'Set-Cookie: c=1\r\n' +
+                  'X-Multi: b\r\n' +
+                  'Content-Type: text/plain\r\n' +
+                  'Content-Type: text/html\r\n' +
+                  'Set-Cookie: d=2\r\n' +
+                  'X-Empty:\r\n' +
+                  '\r\n';
+  const client = net.connect(this.address().port, function() {
+    // Two pipelined requests in a single write share one receive buffer.
+    client.end(request + request);
+  });
+  client.resume();
+  client.on('end', function() {
+    server.close();
+  });
+}));
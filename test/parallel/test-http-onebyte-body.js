@@ -0,0 +1,35 @@
+'use strict';
+// String bodies of one-byte characters are written with a tighter bound on
+// their UTF-8 size, check that nothing is cut off.
+const common = require('../common');
+const assert = require('assert');
+const http = require('http');
+
+const bodies = [
+  JSON.stringify({ items: 'x'.repeat(6000) }),
+  'ñ'.repeat(7000),
+  'a'.repeat(3000) + 'ÿ'.repeat(3000),
+  JSON.stringify({ items: 'y'.repeat(100000) })
+];
+
+const server = http.createServer(common.mustCall((req, res) => {
+  const body = bodies[+req.url.slice(1)];
+  res.writeHead(200, { 'Content-Length': Buffer.byteLength(body) });
+  res.end(body);
+}, bodies.length));
+
+server.listen(0, common.mustCall(() => {
+  var pending = bodies.length;
+  bodies.forEach((body, i) => {
+    const options = { port: server.address().port, path: `/${i}` };
+    http.get(options, common.mustCall((res) => {
+      const chunks = [];
+      res.on('data', (chunk) => chunks.push(chunk));
+      res.on('end', common.mustCall(() => {
+        assert.strictEqual(Buffer.concat(chunks).toString(), body);
+        if (--pending === 0)
+          server.close();
+      }));
+    }));
+  });
+}));
@@ -0,0 +1,95 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const http = require('http');
+const net = require('net');
+
+const HTTPParser = process.binding('http_parser').HTTPParser;
+
+const kOnHeadersComplete = HTTPParser.kOnHeadersComplete | 0;
+const kOnBody = HTTPParser.kOnBody | 0;
+const kOnMessageComplete = HTTPParser.kOnMessageComplete | 0;
+const kOnBatch = HTTPParser.kOnBatch | 0;
+
+// A batched parser delivers the events of all pipelined requests in a
+// buffer with a single kOnBatch call.
+{
+  const parser = new HTTPParser(HTTPParser.REQUEST);
+  parser.setBatched(true);
+
+  parser[kOnHeadersComplete] = common.fail;
+  parser[kOnBody] = common.fail;
+  parser[kOnMessageComplete] = common.fail;
+  parser[kOnBatch] = common.mustCall(function(events, length) {
+    assert.strictEqual(events[0], kOnHeadersComplete);
+    assert.deepStrictEqual(events[3], ['Host', 'a']);
+    assert.strictEqual(events[5], '/one');
+    assert.strictEqual(events[11], kOnMessageComplete);
+    assert.strictEqual(events[12], kOnHeadersComplete);
+    assert.strictEqual(events[17], '/two');
+    assert.strictEqual(events[23], kOnBody);
+    assert.strictEqual(events[24].toString('utf8', events[25],
+                                           events[25] + events[26]), 'hi');
+    assert.strictEqual(events[27], kOnMessageComplete);
+    assert.strictEqual(length, 28);
+  });
+
+  const request = Buffer.from('GET /one HTTP/1.1\r\nHost: a\r\n\r\n' +
+                              'POST /two HTTP/1.1\r\nContent-Length: 2\r\n' +
+                              '\r\nhi');
+  assert.strictEqual(parser.execute(request), request.length);
+}
+
+// Response parsers are never batched since the kOnHeadersComplete return
+// value decides whether a body follows.
+{
+  const parser = new HTTPParser(HTTPParser.RESPONSE);
+  parser.setBatched(true);
+  parser[kOnHeadersComplete] = common.mustCall(function() {});
+  parser[kOnMessageComplete] = common.mustCall(function() {});
+  parser[kOnBatch] = common.fail;
+  const response = Buffer.from('HTTP/1.1 204 No Content\r\n\r\n');
+  assert.strictEqual(parser.execute(response), response.length);
+}
+
+// End to end, with the headers and the bodies of all requests in one write.
+{
+  const bodies = [];
+  const server = http.createServer(function(req, res) {
+    let body = '';
+    req.setEncoding('utf8');
+    req.on('data', function(chunk) {
+      body += chunk;
+    });
+    req.on('end', function() {
+      bodies.push(req.url + ' ' + body);
+      res.end(req.url);
+    });
+  });
+  server.batchPipelinedRequests = true;
+
+  server.listen(0, common.mustCall(function() {
+    const client = net.connect(this.address().port, function() {
+      let request = '';
+      for (let i = 0; i < 10; i++) {
+        request += 'POST /' + i + ' HTTP/1.1\r\n' +
+                   'Content-Length: 1\r\n' +
+                   '\r\n' + i;
+      }
+      client.end(request);
+    });
+    let response = '';
+    client.setEncoding('utf8');
+    client.on('data', function(chunk) {
+      response += chunk;
+    });
+    client.on('end', common.mustCall(function() {
+      assert.strictEqual(bodies.length, 10);
+      for (let i = 0; i < 10; i++) {
+        assert.strictEqual(bodies[i], '/' + i + ' ' + i);
+        assert.notStrictEqual(response.indexOf('\r\n\r\n/' + i), -1);
+      }
+      server.close();
+    }));
+  }));
+}
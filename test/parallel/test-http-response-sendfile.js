@@ -0,0 +1,55 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const fs = require('fs');
+const http = require('http');
+const path = require('path');
+
+common.refreshTmpDir();
+
+const file = path.join(common.tmpDir, 'sendfile.html');
+const body = '<html>' + 'x'.repeat(100 * 1024) + '</html>';
+fs.writeFileSync(file, body);
+const fd = fs.openSync(file, 'r');
+
+const server = http.createServer(function(req, res) {
+  if (req.url === '/length') {
+    res.writeHead(200, { 'Content-Length': body.length + 1 });
+    res.sendFile(fd, 0, body.length, common.mustCall());
+    res.end('!');
+  } else {
+    // Without a Content-Length, the file becomes a chunk of the body.
+    res.sendFile(fd, 6, 10);
+    res.sendFile(fd, 0, 0);
+    res.end('end');
+  }
+});
+
+server.listen(0, common.mustCall(function() {
+  const port = this.address().port;
+  let pending = 2;
+
+  function get(path, check) {
+    http.get({ port, path }, common.mustCall(function(res) {
+      let data = '';
+      res.setEncoding('utf8');
+      res.on('data', (chunk) => data += chunk);
+      res.on('end', common.mustCall(function() {
+        check(res, data);
+        if (--pending === 0) {
+          fs.closeSync(fd);
+          server.close();
+        }
+      }));
+    }));
+  }
+
+  get('/length', function(res, data) {
+    assert.strictEqual(res.headers['content-length'], `${body.length + 1}`);
+    assert.strictEqual(data, body + '!');
+  });
+  get('/chunked', function(res, data) {
+    assert.strictEqual(res.headers['transfer-encoding'], 'chunked');
+    assert.strictEqual(data, 'xxxxxxxxxxend');
+  });
+}));
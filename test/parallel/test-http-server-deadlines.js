@@ -0,0 +1,59 @@
+'use strict';
+
+const common = require('../common');
+const assert = require('assert');
+const http = require('http');
+const net = require('net');
+
+const timeout = common.platformTimeout(100);
+const codes = [];
+
+const server = http.createServer(common.mustCall((req, res) => {
+  if (req.method === 'GET')
+    return res.end('ok');
+  // The body never completes.
+  req.resume();
+}, 2));
+server.headersTimeout = timeout;
+server.bodyTimeout = timeout;
+
+server.on('clientError', common.mustCall((err, socket) => {
+  codes.push(err.code);
+  socket.destroy();
+}, 2));
+
+// Writes |head| and then |chunk| over and over, often enough to keep the
+// socket from going idle, until the server closes the connection.
+function trickle(port, head, chunk, cb) {
+  const socket = net.connect(port, () => {
+    socket.write(head);
+    const interval = setInterval(() => socket.write(chunk),
+                                 common.platformTimeout(10));
+    socket.on('close', common.mustCall(() => {
+      clearInterval(interval);
+      cb();
+    }));
+  });
+  socket.on('error', () => {});
+  socket.resume();
+}
+
+server.listen(0, common.mustCall(() => {
+  const port = server.address().port;
+
+  trickle(port, 'GET / HTTP/1.1\r\nHost: localhost\r\n', 'X', () => {
+    assert.deepStrictEqual(codes, ['HEADERS_TIMEOUT']);
+
+    const head = 'POST / HTTP/1.1\r\nHost: localhost\r\n' +
+                 'Content-Length: 100000\r\n\r\n';
+    trickle(port, head, 'a', () => {
+      assert.deepStrictEqual(codes, ['HEADERS_TIMEOUT', 'BODY_TIMEOUT']);
+
+      // A request that is on time does not time out.
+      http.get({ port }, common.mustCall((res) => {
+        res.resume();
+        res.on('end', common.mustCall(() => server.close()));
+      }));
+    });
+  });
+}));
@@ -0,0 +1,57 @@
+'use strict';
+
+const common = require('../common');
+const assert = require('assert');
+const http = require('http');
+const net = require('net');
+
+const server = http.createServer(common.mustCall((req, res) => {
+  assert.strictEqual(server.getStats().activeConnections, 1);
+  res.end('ok');
+}, 3));
+
+assert.deepStrictEqual(server.getStats(), {
+  activeConnections: 0,
+  connections: 0,
+  requests: 0,
+  maxRequestsPerConnection: 0,
+  parseErrors: 0,
+  headersTime: 0,
+  handlerTime: 0,
+  parseTime: 0
+});
+
+server.listen(0, common.mustCall(() => {
+  const port = server.address().port;
+
+  // Three requests on one connection, the last one closes it.
+  const request = 'GET / HTTP/1.1\r\nHost: localhost\r\n';
+  const last = `${request}Connection: close\r\n\r\n`;
+  const socket = net.connect(port, () => {
+    socket.end(`${request}\r\n${request}\r\n${last}`);
+  });
+  socket.resume();
+  socket.on('close', common.mustCall(() => {
+    // Not HTTP.
+    const bad = net.connect(port, () => bad.end('NOT HTTP\r\n\r\n'));
+    bad.resume();
+    bad.on('close', common.mustCall(() => {
+      setImmediate(check);
+    }));
+  }));
+}));
+
+function check() {
+  const stats = server.getStats();
+  // Until the server has seen both sockets close.
+  if (stats.activeConnections !== 0)
+    return setImmediate(check);
+  assert.strictEqual(stats.connections, 2);
+  assert.strictEqual(stats.requests, 3);
+  assert.strictEqual(stats.maxRequestsPerConnection, 3);
+  assert.strictEqual(stats.parseErrors, 1);
+  assert(stats.headersTime >= 0);
+  assert(stats.handlerTime > 0);
+  assert(stats.parseTime > 0);
+  server.close();
+}
@@ -0,0 +1,82 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const http = require('http');
+const net = require('net');
+
+// The header block is serialized natively.  Check the exact bytes that end up
+// on the wire for the different ways of passing headers to writeHead(), and
+// that _header still holds them as a string.
+
+const expected = [
+  'HTTP/1.1 200 OK\r\n' +
+  'X-Number: 42\r\n' +
+  'Set-Cookie: a=1\r\n' +
+  'Set-Cookie: b=2\r\n' +
+  'X-Latin1: Düsseldorf\r\n' +
+  'Content-Length: 2\r\n' +
+  'Connection: keep-alive\r\n' +
+  '\r\n' +
+  'ok',
+
+  'HTTP/1.1 201 Created\r\n' +
+  'X-First: 1\r\n' +
+  'x-first: 2\r\n' +
+  'Connection: close\r\n' +
+  'Transfer-Encoding: chunked\r\n' +
+  '\r\n' +
+  '2\r\nok\r\n' +
+  '0\r\n\r\n'
+];
+
+let requests = 0;
+const server = http.createServer(common.mustCall(function(req, res) {
+  res.sendDate = false;
+
+  assert.throws(function() {
+    res.writeHead(200, { 'X-Bad': 'a\r\nb' });
+  }, /^TypeError: The header content contains invalid characters$/);
+  assert.throws(function() {
+    res.writeHead(200, { 'X Bad': 'a' });
+  }, /^TypeError: Header name must be a valid HTTP Token \["X Bad"\]$/);
+  assert.throws(function() {
+    res.writeHead(200, [['X-Wide', 'Ā']]);
+  }, /^TypeError: The header content contains invalid characters$/);
+  assert.strictEqual(res.headersSent, false);
+
+  if (requests++ === 0) {
+    res.writeHead(200, {
+      'X-Number': 42,
+      'Set-Cookie': ['a=1', 'b=2'],
+      'X-Latin1': 'Düsseldorf',
+      'Content-Length': 2
+    });
+  } else {
+    res.writeHead(201, [
+      ['X-First', '1'],
+      ['x-first', '2'],
+      ['Connection', 'close']
+    ]);
+  }
+  assert.strictEqual(res.headersSent, true);
+  // _header stays a string even though the header block is a Buffer.
+  const head = expected[requests - 1];
+  assert.strictEqual(res._header, head.slice(0, head.indexOf('\r\n\r\n') + 4));
+  res.end('ok');
+}, 2));
+
+server.listen(0, common.mustCall(function() {
+  const client = net.connect(this.address().port, function() {
+    client.write('GET / HTTP/1.1\r\n\r\n' +
+                 'GET / HTTP/1.1\r\n\r\n');
+  });
+  const chunks = [];
+  client.on('data', function(chunk) {
+    chunks.push(chunk);
+  });
+  client.on('end', common.mustCall(function() {
+    assert.strictEqual(Buffer.concat(chunks).toString('binary'),
+                       expected.join(''));
+    server.close();
+  }));
+}));
@@ -0,0 +1,59 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+
+if (!common.hasCrypto) {
+  common.skip('missing crypto');
+  return;
+}
+if (!process.features.tls_alpn) {
+  common.skip('missing ALPN support');
+  return;
+}
+
+const fs = require('fs');
+const http2 = require('http2');
+const tls = require('tls');
+
+const options = {
+  key: fs.readFileSync(common.fixturesDir + '/keys/agent1-key.pem'),
+  cert: fs.readFileSync(common.fixturesDir + '/keys/agent1-cert.pem')
+};
+
+const server = http2.createSecureServer(options, common.mustCall((stream) => {
+  assert.strictEqual(stream.session.socket.alpnProtocol, 'h2');
+  stream.respond({ 'content-type': 'text/plain' });
+  stream.end('secure');
+}));
+
+// Clients that don't choose h2 are turned away.
+server.on('unknownProtocol', common.mustCall((socket) => {
+  socket.destroy();
+}));
+
+server.listen(0, common.mustCall(() => {
+  const port = server.address().port;
+  const session = http2.connect(`https://localhost:${port}`, {
+    rejectUnauthorized: false
+  });
+  const req = session.request({ ':path': '/' });
+  req.on('response', common.mustCall((headers) => {
+    assert.strictEqual(headers[':status'], '200');
+    assert.strictEqual(headers['content-type'], 'text/plain');
+  }));
+  let body = '';
+  req.setEncoding('utf8');
+  req.on('data', (chunk) => { body += chunk; });
+  req.on('end', common.mustCall(() => {
+    assert.strictEqual(body, 'secure');
+    session.close();
+
+    const http1 = tls.connect({
+      port: port,
+      rejectUnauthorized: false,
+      ALPNProtocols: ['http/1.1']
+    });
+    http1.on('close', common.mustCall(() => server.close()));
+    http1.resume();
+  }));
+}));
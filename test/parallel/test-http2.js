@@ -0,0 +1,122 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const http2 = require('http2');
+
+assert.throws(() => http2.createServer({ settings: { maxFrameSize: 100 } }),
+              RangeError);
+assert.throws(() => http2.createServer({ settings: { headerTableSize: -1 } }),
+              TypeError);
+
+// Larger than all the windows, it only gets through if they are opened
+// again as it is read.
+const big = Buffer.alloc(3 * 1024 * 1024, 'x');
+const kRequests = 20;
+
+const server = http2.createServer(common.mustCall((stream, headers) => {
+  assert.strictEqual(headers[':scheme'], 'http');
+  switch (headers[':path']) {
+    case '/echo': {
+      assert.strictEqual(headers[':method'], 'POST');
+      const chunks = [];
+      stream.on('data', (chunk) => chunks.push(chunk));
+      stream.on('trailers', common.mustCall((trailers) => {
+        assert.strictEqual(trailers['x-sum'], 'abc');
+      }));
+      stream.on('end', common.mustCall(() => {
+        stream.respond({ 'content-type': 'text/plain' });
+        stream.write(Buffer.concat(chunks));
+        stream.sendTrailers({ 'x-length': Buffer.concat(chunks).length });
+      }));
+      break;
+    }
+    case '/big':
+      stream.respond({ ':status': 200 });
+      stream.end(big);
+      break;
+    case '/reset':
+      stream.on('aborted', common.mustCall((code) => {
+        assert.strictEqual(code, http2.codes.CANCEL);
+      }));
+      stream.respond({ ':status': 200 });
+      stream.write('some');
+      break;
+    case '/empty':
+      stream.respond({ ':status': 204 }, { endStream: true });
+      break;
+    default:
+      stream.end(`path ${headers[':path']} ${headers.cookie}`);
+  }
+}, kRequests + 4));
+
+server.listen(0, common.mustCall(() => {
+  const session = http2.connect(`http://localhost:${server.address().port}`);
+  session.on('connect', common.mustCall());
+  var pending = kRequests + 4;
+  function done() {
+    if (--pending === 0)
+      session.close(common.mustCall(() => server.close()));
+  }
+
+  // Many requests on one connection.
+  for (var i = 0; i < kRequests; i++) {
+    const path = `/get/${i}`;
+    const req = session.request({
+      ':path': path,
+      cookie: ['a=1', 'b=2']
+    });
+    req.on('response', common.mustCall((headers) => {
+      assert.strictEqual(headers[':status'], '200');
+    }));
+    let body = '';
+    req.setEncoding('utf8');
+    req.on('data', (chunk) => { body += chunk; });
+    req.on('end', common.mustCall(() => {
+      assert.strictEqual(body, `path ${path} a=1; b=2`);
+      done();
+    }));
+  }
+
+  const echo = session.request({ ':method': 'POST', ':path': '/echo' });
+  echo.write('hello ');
+  echo.sendTrailers({ 'x-sum': 'abc' });
+  let echoed = '';
+  echo.setEncoding('utf8');
+  echo.on('data', (chunk) => { echoed += chunk; });
+  echo.on('trailers', common.mustCall((trailers) => {
+    assert.strictEqual(trailers['x-length'], '6');
+  }));
+  echo.on('end', common.mustCall(() => {
+    assert.strictEqual(echoed, 'hello ');
+    done();
+  }));
+
+  const bigReq = session.request({ ':path': '/big' });
+  let received = 0;
+  bigReq.on('data', (chunk) => {
+    received += chunk.length;
+    // A slow reader holds the server back without stalling the others.
+    bigReq.pause();
+    setImmediate(() => bigReq.resume());
+  });
+  bigReq.on('end', common.mustCall(() => {
+    assert.strictEqual(received, big.length);
+    done();
+  }));
+
+  const reset = session.request({ ':path': '/reset' });
+  reset.on('data', common.mustCall(() => {
+    reset.rstStream();
+  }));
+  reset.on('close', common.mustCall((code) => {
+    assert.strictEqual(code, http2.codes.CANCEL);
+    done();
+  }));
+
+  const empty = session.request({ ':path': '/empty' });
+  empty.on('response', common.mustCall((headers) => {
+    assert.strictEqual(headers[':status'], '204');
+  }));
+  empty.resume();
+  empty.on('end', common.mustCall(done));
+}));
@@ -0,0 +1,32 @@
+'use strict';
+// Flags: --huge-pages
+
+require('../common');
+const assert = require('assert');
+
+const kHugePageSize = 2 * 1024 * 1024;
+
+// Buffers below the huge page size keep coming from malloc().
+const before = process.memoryUsage().hugePageBuffers;
+const small = Buffer.alloc(kHugePageSize - 1);
+assert.strictEqual(process.memoryUsage().hugePageBuffers, before);
+
+const large = Buffer.alloc(kHugePageSize + 1);
+const unsafe = Buffer.allocUnsafe(kHugePageSize * 2);
+const after = process.memoryUsage().hugePageBuffers;
+
+if (process.platform === 'linux') {
+  // Rounded up to whole huge pages.
+  assert.strictEqual(after - before, kHugePageSize * 4);
+} else {
+  assert.strictEqual(after, 0);
+}
+
+for (let i = 0; i < large.length; i += 4096)
+  assert.strictEqual(large[i], 0);
+assert.strictEqual(large[large.length - 1], 0);
+
+unsafe.fill(0xab);
+assert.strictEqual(unsafe[0], 0xab);
+assert.strictEqual(unsafe[unsafe.length - 1], 0xab);
+assert.strictEqual(small.length, kHugePageSize - 1);
@@ -0,0 +1,58 @@
+'use strict';
+
+const common = require('../common');
+const assert = require('assert');
+const binding = process.binding('loop_stats');
+const fields = binding.fields;
+
+assert(fields instanceof Float64Array);
+
+function busy(ms) {
+  const deadline = Date.now() + ms;
+  while (Date.now() < deadline);
+}
+
+binding.start();
+
+// Nothing has been collected before the loop runs.
+binding.update();
+assert.strictEqual(fields[binding.kIterations], 0);
+assert.strictEqual(binding.percentile(50), 0);
+
+let ticks = 0;
+const timer = setInterval(common.mustCall(function() {
+  busy(20);
+  if (++ticks < 5)
+    return;
+  clearInterval(timer);
+
+  // Let the last iteration complete.
+  setTimeout(common.mustCall(function() {
+    binding.update();
+    assert(fields[binding.kIterations] >= 5);
+    assert(fields[binding.kTimersTime] >= 5 * 20);
+    assert(fields[binding.kIdleTime] > 0);
+    assert(fields[binding.kUtilization] > 0);
+    assert(fields[binding.kUtilization] < 1);
+    assert(fields[binding.kLatencyCount] >= 5);
+    assert(fields[binding.kLatencyMax] >= 20);
+    assert(fields[binding.kLatencyMin] <= fields[binding.kLatencyMean]);
+    assert(fields[binding.kLatencyMean] <= fields[binding.kLatencyMax]);
+    assert(binding.percentile(100) >= 20);
+    assert(binding.percentile(100) <= fields[binding.kLatencyMax]);
+    assert(binding.percentile(0) <= binding.percentile(100));
+
+    // Nothing is collected while stopped.
+    binding.stop();
+    const iterations = fields[binding.kIterations];
+    setImmediate(common.mustCall(function() {
+      binding.update();
+      assert.strictEqual(fields[binding.kIterations], iterations);
+
+      binding.reset();
+      binding.update();
+      assert.strictEqual(fields[binding.kIterations], 0);
+      assert.strictEqual(fields[binding.kLatencyCount], 0);
+    }));
+  }), 10);
+}, 30));
@@ -0,0 +1,22 @@
+'use strict';
+
+require('../common');
+const assert = require('assert');
+
+const usage = process.memoryUsage();
+const rss = process.memoryUsage.rss();
+const heapUsed = process.memoryUsage.heapUsed();
+
+assert.strictEqual(typeof rss, 'number');
+assert.strictEqual(typeof heapUsed, 'number');
+assert.ok(rss > 0);
+assert.ok(heapUsed > 0);
+
+// The readings are close to the ones of process.memoryUsage() taken just
+// before, which means they measure the same thing in the same unit.
+assert.ok(Math.abs(rss - usage.rss) < usage.rss / 2);
+assert.ok(Math.abs(heapUsed - usage.heapUsed) < usage.heapTotal);
+
+// Repeated readings reuse the same descriptor.
+for (let i = 0; i < 1000; i++)
+  assert.ok(process.memoryUsage.rss() > 0);
@@ -0,0 +1,131 @@
+// Flags: --expose-internals
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const child_process = require('child_process');
+const fs = require('fs');
+const path = require('path');
+const zlib = require('zlib');
+const moduleArchive = require('internal/module_archive');
+
+common.refreshTmpDir();
+
+function crc32(data) {
+  var crc = -1;
+  for (var i = 0; i < data.length; i++) {
+    crc ^= data[i];
+    for (var k = 0; k < 8; k++)
+      crc = (crc >>> 1) ^ (0xedb88320 & -(crc & 1));
+  }
+  return (crc ^ -1) >>> 0;
+}
+
+// Writes a zip file with the given entries.  Entries whose name ends in
+// ".json" are deflated, the others are stored.
+function writeZip(filename, entries) {
+  const local = [];
+  const central = [];
+  var offset = 0;
+  Object.keys(entries).forEach(function(name) {
+    const data = Buffer.from(entries[name]);
+    const method = /\.json$/.test(name) ? 8 : 0;
+    const compressed = method === 8 ? zlib.deflateRawSync(data) : data;
+    const nameBuffer = Buffer.from(name);
+
+    const header = Buffer.alloc(30);
+    header.writeUInt32LE(0x04034b50, 0);
+    header.writeUInt16LE(20, 4);
+    header.writeUInt16LE(method, 8);
+    header.writeUInt32LE(crc32(data), 14);
+    header.writeUInt32LE(compressed.length, 18);
+    header.writeUInt32LE(data.length, 22);
+    header.writeUInt16LE(nameBuffer.length, 26);
+    local.push(header, nameBuffer, compressed);
+
+    const entry = Buffer.alloc(46);
+    entry.writeUInt32LE(0x02014b50, 0);
+    entry.writeUInt16LE(20, 4);
+    entry.writeUInt16LE(20, 6);
+    entry.writeUInt16LE(method, 10);
+    entry.writeUInt32LE(crc32(data), 16);
+    entry.writeUInt32LE(compressed.length, 20);
+    entry.writeUInt32LE(data.length, 24);
+    entry.writeUInt16LE(nameBuffer.length, 28);
+    entry.writeUInt32LE(offset, 42);
+    central.push(entry, nameBuffer);
+
+    offset += header.length + nameBuffer.length + compressed.length;
+  });
+
+  const centralDirectory = Buffer.concat(central);
+  const end = Buffer.alloc(22);
+  end.writeUInt32LE(0x06054b50, 0);
+  end.writeUInt16LE(Object.keys(entries).length, 8);
+  end.writeUInt16LE(Object.keys(entries).length, 10);
+  end.writeUInt32LE(centralDirectory.length, 12);
+  end.writeUInt32LE(offset, 16);
+  fs.writeFileSync(filename,
+                   Buffer.concat(local.concat([centralDirectory, end])));
+}
+
+const outside = path.join(common.tmpDir, 'outside.js');
+fs.writeFileSync(outside, 'module.exports = "outside";');
+
+const zip = path.join(common.tmpDir, 'bundle.zip');
+writeZip(zip, {
+  'main.js': `
+    console.log(JSON.stringify({
+      filename: __filename,
+      lib: require('./lib'),
+      data: require('./data'),
+      dep: require('dep'),
+      outside: require(${JSON.stringify(outside)}),
+      resolved: require.resolve('./lib')
+    }));`,
+  'lib/': '',
+  'lib/package.json': '{"main": "./src/entry"}',
+  'lib/src/entry.js': '\ufeffmodule.exports = "lib";',
+  'data.json': JSON.stringify({ answer: 42 }),
+  'node_modules/dep/index.js': 'module.exports = "dep";',
+  '../escape.js': 'module.exports = "escape";'
+});
+
+// The archive can be inspected without mounting it in the module loader.
+moduleArchive.mount(zip);
+assert.strictEqual(moduleArchive.mounted, true);
+assert.strictEqual(moduleArchive.stat(zip), 1);
+assert.strictEqual(moduleArchive.stat(path.join(zip, 'main.js')), 0);
+assert.strictEqual(moduleArchive.stat(path.join(zip, 'lib')), 1);
+assert.strictEqual(moduleArchive.stat(path.join(zip, 'lib', 'src')), 1);
+assert(moduleArchive.stat(path.join(zip, 'missing.js')) < 0);
+assert(moduleArchive.stat(path.join(common.tmpDir, 'escape.js')) === undefined);
+assert.strictEqual(moduleArchive.stat(outside), undefined);
+assert.strictEqual(moduleArchive.readFile(path.join(zip, 'data.json')),
+                   '{"answer":42}');
+assert.strictEqual(moduleArchive.readFile(path.join(zip, 'missing.js')),
+                   undefined);
+assert.strictEqual(moduleArchive.contains(path.join(zip, 'missing.js')), true);
+assert.strictEqual(moduleArchive.contains(outside), false);
+
+const notZip = path.join(common.tmpDir, 'not.zip');
+fs.writeFileSync(notZip, 'not a zip file');
+assert.throws(function() {
+  moduleArchive.mount(notZip);
+}, /^Error: Invalid module archive .*: end of central directory not found$/);
+
+// Modules are loaded from the archive when it is listed in
+// NODE_MODULE_ARCHIVE.
+const env = Object.assign({}, process.env, { NODE_MODULE_ARCHIVE: zip });
+const main = path.join(zip, 'main.js');
+child_process.execFile(process.execPath, [main], { env: env },
+                       common.mustCall(function(err, stdout) {
+                         assert.ifError(err);
+                         assert.deepStrictEqual(JSON.parse(stdout), {
+                           filename: main,
+                           lib: 'lib',
+                           data: { answer: 42 },
+                           dep: 'dep',
+                           outside: 'outside',
+                           resolved: path.join(zip, 'lib', 'src', 'entry.js')
+                         });
+                       }));
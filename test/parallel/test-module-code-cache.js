@@ -0,0 +1,71 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const child_process = require('child_process');
+const fs = require('fs');
+const path = require('path');
+
+common.refreshTmpDir();
+
+const cacheDir = path.join(common.tmpDir, 'code-cache');
+const dep = path.join(common.tmpDir, 'dep.js');
+const main = path.join(common.tmpDir, 'main.js');
+fs.writeFileSync(dep, 'module.exports = 1;');
+fs.writeFileSync(main,
+                 'const dep = require("./dep");\n' +
+                 'console.log(dep + 41);\n');
+
+const env = Object.assign({}, process.env, { NODE_CODE_CACHE_DIR: cacheDir });
+
+function run() {
+  const output = child_process.execFileSync(process.execPath, [main], { env });
+  return output.toString().trim();
+}
+
+const coreCache = path.join(cacheDir,
+                            `node-${process.version}-${process.arch}.cache`);
+
+// Entries for user modules, the core modules share a single file.
+function entries() {
+  return fs.readdirSync(cacheDir)
+           .filter((f) => path.join(cacheDir, f) !== coreCache)
+           .sort();
+}
+
+// The first run fills the cache, one entry per module.
+assert.strictEqual(run(), '42');
+const files = entries();
+assert.strictEqual(files.length, 2);
+const contents = files.map((f) => fs.readFileSync(path.join(cacheDir, f)));
+contents.forEach(function(data) {
+  const keyLength = data.readUInt32LE(0);
+  const key = JSON.parse(data.toString('utf8', 4, 4 + keyLength));
+  assert(key[0] === main || key[0] === dep);
+  assert.strictEqual(key[3], process.versions.v8);
+  assert(data.length > 4 + keyLength);
+});
+
+// The core modules that were loaded are in the cache as well.
+const core = fs.readFileSync(coreCache);
+assert(core.includes('internal/module'));
+assert(core.includes('fs'));
+
+// The second run uses it and leaves it alone.
+assert.strictEqual(run(), '42');
+assert.deepStrictEqual(entries(), files);
+files.forEach(function(f, i) {
+  assert(fs.readFileSync(path.join(cacheDir, f)).equals(contents[i]));
+});
+
+// Editing a module replaces its entry.
+fs.writeFileSync(dep, 'module.exports = 2;  // changed');
+assert.strictEqual(run(), '43');
+assert.deepStrictEqual(entries(), files);
+
+// A corrupt entry is ignored and rewritten.
+files.forEach((f) => fs.writeFileSync(path.join(cacheDir, f), 'garbage'));
+assert.strictEqual(run(), '43');
+files.forEach(function(f) {
+  assert.notStrictEqual(fs.readFileSync(path.join(cacheDir, f)).toString(),
+                        'garbage');
+});
@@ -0,0 +1,97 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const child_process = require('child_process');
+const fs = require('fs');
+const path = require('path');
+
+common.refreshTmpDir();
+
+function write(name, contents) {
+  const filename = path.join(common.tmpDir, name);
+  let dir = path.dirname(filename);
+  const dirs = [];
+  while (!common.fileExists(dir)) {
+    dirs.unshift(dir);
+    dir = path.dirname(dir);
+  }
+  dirs.forEach((dir) => fs.mkdirSync(dir));
+  fs.writeFileSync(filename, contents);
+  return filename;
+}
+
+function dir(name) {
+  return path.join(common.tmpDir, name);
+}
+
+const exportName = 'module.exports = __filename;';
+
+const plain = write('plain.js', exportName);
+const main = write('main/lib/entry.js', exportName);
+write('main/package.json', '{"main": "lib/entry"}');
+const dotted = write('dotted/y.js', exportName);
+write('dotted/package.json', '\ufeff{"main": "./x/../y.js"}');
+const index = write('index/index.js', exportName);
+const noMain = write('nomain/index.js', exportName);
+write('nomain/package.json', '{"name": "nomain"}');
+write('bad/package.json', '{"main": ');
+write('bad/index.js', exportName);
+
+assert.strictEqual(require(dir('plain')), plain);
+assert.strictEqual(require(dir('plain.js')), plain);
+assert.strictEqual(require(dir('main')), main);
+assert.strictEqual(require(dir('main') + '/'), main);
+assert.strictEqual(require(dir('dotted')), dotted);
+assert.strictEqual(require(dir('index')), index);
+assert.strictEqual(require(dir('nomain')), noMain);
+assert.strictEqual(require.resolve(dir('main/lib/entry')), main);
+
+assert.throws(function() {
+  require(dir('bad'));
+}, /^SyntaxError: Error parsing .*package\.json: /);
+assert.throws(function() {
+  require(dir('plain.js') + '/');
+}, /^Error: Cannot find module/);
+
+// Relative lookups go through the same path.
+const nested = write('node_modules/nested/index.js', exportName);
+const fromParent = write('parent.js', 'module.exports = require("nested");');
+assert.strictEqual(require(fromParent), nested);
+
+// The lookups are cached while the main module runs.  Afterwards, new files
+// are found.
+const later = dir('later.js');
+assert.throws(function() {
+  require(later);
+}, /^Error: Cannot find module/);
+fs.writeFileSync(later, exportName);
+setImmediate(common.mustCall(function() {
+  assert.strictEqual(require(later), later);
+}));
+
+// With NODE_PERSISTENT_MODULE_CACHE=1 they stay cached until
+// _clearStatCache() is called.
+const script = write('persistent.js', `
+  const assert = require('assert');
+  const fs = require('fs');
+  const Module = require('module');
+  const filename = ${JSON.stringify(dir('persistent-later.js'))};
+  setImmediate(function() {
+    assert.throws(() => require(filename), /Cannot find module/);
+    fs.writeFileSync(filename, '');
+    setImmediate(function() {
+      assert.throws(() => require(filename), /Cannot find module/);
+      Module._clearStatCache();
+      require(filename);
+      console.log('ok');
+    });
+  });
+`);
+const env = Object.assign({}, process.env, {
+  NODE_PERSISTENT_MODULE_CACHE: '1'
+});
+child_process.execFile(process.execPath, [script], { env: env },
+                       common.mustCall(function(err, stdout) {
+                         assert.ifError(err);
+                         assert.strictEqual(stdout, 'ok\n');
+                       }));
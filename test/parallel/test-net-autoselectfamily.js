@@ -0,0 +1,33 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const net = require('net');
+
+assert.throws(() => {
+  net.connect({ port: common.PORT, host: 'localhost', autoSelectFamily: true,
+                autoSelectFamilyAttemptTimeout: -1 });
+}, TypeError);
+
+// Whichever addresses localhost resolves to, one of them reaches a server
+// that only listens on IPv4.
+const server = net.createServer(common.mustCall((socket) => {
+  socket.end('ok');
+}));
+
+server.listen(common.PORT, '127.0.0.1', common.mustCall(() => {
+  const socket = net.connect({
+    port: common.PORT,
+    host: 'localhost',
+    autoSelectFamily: true,
+    autoSelectFamilyAttemptTimeout: 10
+  });
+  socket.on('lookup', common.mustCall());
+  socket.setEncoding('utf8');
+  let data = '';
+  socket.on('data', (chunk) => data += chunk);
+  socket.on('end', common.mustCall(() => {
+    assert.strictEqual(socket.remoteAddress, '127.0.0.1');
+    assert.strictEqual(data, 'ok');
+    server.close();
+  }));
+}));
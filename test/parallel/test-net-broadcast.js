@@ -0,0 +1,57 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const net = require('net');
+
+assert.throws(() => net.broadcast({}, 'x'), TypeError);
+assert.throws(() => net.broadcast([{}], 'x'), TypeError);
+assert.throws(() => net.broadcast([], 42), TypeError);
+
+const kClients = 5;
+// Larger than the socket buffers, so that the sockets queue the rest.
+const big = Buffer.alloc(4 * 1024 * 1024, 'x');
+const expected = kClients * (big.length + 'head'.length + 'tail'.length);
+const sockets = [];
+var received = 0;
+
+const server = net.createServer(common.mustCall((socket) => {
+  sockets.push(socket);
+  if (sockets.length < kClients)
+    return;
+
+  // The first socket has a write waiting in JS, the broadcast goes after it.
+  sockets[0].cork();
+  sockets[0].write('he');
+  sockets[0].write('ad');
+  sockets.slice(1).forEach((socket) => socket.write('head'));
+
+  net.broadcast(sockets, big);
+  sockets[0].uncork();
+  net.broadcast(sockets, 'tail', 'latin1');
+  sockets.forEach((socket) => socket.end());
+}, kClients));
+
+server.listen(0, common.mustCall(() => {
+  for (var i = 0; i < kClients; i++) {
+    const client = net.connect(server.address().port);
+    const chunks = [];
+    client.on('data', (chunk) => chunks.push(chunk));
+    client.on('end', common.mustCall(() => {
+      const data = Buffer.concat(chunks);
+      assert.strictEqual(data.length, big.length + 8);
+      assert.strictEqual(data.toString('latin1', 0, 4), 'head');
+      assert(data.slice(4, 4 + big.length).equals(big));
+      assert.strictEqual(data.toString('latin1', 4 + big.length), 'tail');
+      received += data.length;
+      if (received === expected)
+        server.close();
+    }));
+  }
+}));
+
+process.on('exit', () => {
+  assert.strictEqual(received, expected);
+  sockets.forEach((socket) => {
+    assert.strictEqual(socket.bytesWritten, big.length + 8);
+  });
+});
@@ -0,0 +1,39 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const net = require('net');
+
+const server = net.createServer({ coalesceWrites: true });
+server.on('connection', common.mustCall((socket) => {
+  const handle = socket._handle;
+  const writev = handle.writev;
+  let writevCalls = 0;
+  handle.writev = function(req, chunks) {
+    writevCalls++;
+    assert.strictEqual(chunks.length, 6);
+    return writev.apply(this, arguments);
+  };
+
+  const order = [];
+  socket.write('a', common.mustCall(() => order.push(1)));
+  socket.write(Buffer.from('b'), common.mustCall(() => order.push(2)));
+  socket.write('c', common.mustCall(() => {
+    order.push(3);
+    assert.deepStrictEqual(order, [1, 2, 3]);
+    assert.strictEqual(writevCalls, 1);
+    socket.end('d');
+  }));
+  // Nothing goes out before the end of the tick.
+  assert.strictEqual(socket._writableState.bufferedRequestCount, 3);
+}));
+
+server.listen(0, common.mustCall(() => {
+  const client = net.connect(server.address().port);
+  let received = '';
+  client.setEncoding('utf8');
+  client.on('data', (data) => received += data);
+  client.on('end', common.mustCall(() => {
+    assert.strictEqual(received, 'abcd');
+    server.close();
+  }));
+}));
@@ -0,0 +1,49 @@
+'use strict';
+
+const common = require('../common');
+const assert = require('assert');
+const net = require('net');
+
+// A proxy that forwards both directions natively, in front of an echo
+// server.  Enough data is sent for the pipes to apply backpressure.  The
+// proxy's sockets are half-open, so that one direction can end before the
+// other one.
+const payload = Buffer.alloc(4 * 1024 * 1024);
+for (var i = 0; i < payload.length; i++)
+  payload[i] = i % 251;
+
+const backend = net.createServer((c) => {
+  c.pipe(c);
+});
+
+const proxy = net.createServer({ allowHalfOpen: true });
+proxy.on('connection', common.mustCall((client) => {
+  assert.throws(() => client.pipeNative({}), TypeError);
+  assert.throws(() => client.pipeNative(client), Error);
+
+  const upstream = net.connect({
+    port: backend.address().port,
+    allowHalfOpen: true
+  });
+  client.pipeNative(upstream, common.mustCall((err) => {
+    assert.strictEqual(err, null);
+  }));
+  upstream.pipeNative(client, common.mustCall((err) => {
+    assert.strictEqual(err, null);
+  }));
+  assert.throws(() => client.pipeNative(upstream), Error);
+}));
+
+backend.listen(0, common.mustCall(() => {
+  proxy.listen(0, common.mustCall(() => {
+    const client = net.connect(proxy.address().port);
+    const received = [];
+    client.on('data', (chunk) => received.push(chunk));
+    client.on('end', common.mustCall(() => {
+      assert(Buffer.concat(received).equals(payload));
+      proxy.close();
+      backend.close();
+    }));
+    client.end(payload);
+  }));
+}));
@@ -0,0 +1,41 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const net = require('net');
+
+const batchSize = 4;
+const clients = 10;
+
+let accepted = 0;
+let connections = 0;
+
+const server = net.createServer({ acceptBatch: batchSize }, function(conn) {
+  conn.end();
+  if (++connections === clients)
+    server.close();
+});
+
+assert.strictEqual(server.acceptBatch, batchSize);
+
+server.listen(common.PORT, common.mustCall(function() {
+  const handle = server._handle;
+  const onconnections = handle.onconnections;
+
+  // Connections are only passed in batches.
+  handle.onconnection = common.fail;
+  handle.onconnections = function(err, clientHandles) {
+    assert.strictEqual(err, 0);
+    assert(clientHandles.length >= 1);
+    assert(clientHandles.length <= batchSize);
+    accepted += clientHandles.length;
+    return onconnections.apply(this, arguments);
+  };
+
+  for (let i = 0; i < clients; i++)
+    net.connect(common.PORT).resume();
+}));
+
+process.on('exit', function() {
+  assert.strictEqual(accepted, clients);
+  assert.strictEqual(connections, clients);
+});
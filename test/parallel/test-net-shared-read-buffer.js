@@ -0,0 +1,54 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const net = require('net');
+
+// All connections of a server with sharedReadBuffer enabled receive into the
+// same buffer.  The chunks that are emitted must be copies that stay intact
+// while later reads reuse the buffer.
+
+const CONNECTIONS = 8;
+
+function test(options, cb) {
+  const received = [];
+  let ended = 0;
+  const server = net.createServer(options, function(socket) {
+    socket.on('data', function(chunk) {
+      received.push(chunk);
+    });
+    socket.on('end', function() {
+      socket.end();
+      if (++ended === CONNECTIONS) {
+        // Every chunk must still hold the bytes of the connection it was
+        // received on even though the later reads overwrote the buffer.
+        let total = 0;
+        for (const chunk of received) {
+          assert(chunk.every((c) => c === chunk[0]));
+          total += chunk.length;
+        }
+        assert.strictEqual(total, CONNECTIONS * 3 * 4096);
+        server.close(cb);
+      }
+    });
+  });
+  assert.strictEqual(server.sharedReadBuffer, true);
+
+  server.listen(0, common.mustCall(function() {
+    for (let i = 0; i < CONNECTIONS; i++) {
+      const client = net.connect(this.address().port, function() {
+        const chunk = Buffer.alloc(4096, 'abcdefgh'[i]);
+        client.write(chunk);
+        setImmediate(function() {
+          client.write(chunk);
+          client.end(chunk);
+        });
+      });
+      client.resume();
+    }
+  }));
+}
+
+assert.strictEqual(net.createServer().sharedReadBuffer, false);
+test({ sharedReadBuffer: true }, common.mustCall(function() {
+  test({ sharedReadBuffer: true, slabReads: true }, common.mustCall());
+}));
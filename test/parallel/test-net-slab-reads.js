@@ -0,0 +1,48 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const net = require('net');
+
+// Reads on connections of a server with slabReads enabled are carved out of
+// shared slabs.  Make sure that the data of consecutive reads and of several
+// connections doesn't get mixed up.
+
+const CONNECTIONS = 4;
+const CHUNKS = 64;
+
+const server = net.createServer({ slabReads: true }, function(socket) {
+  const chunks = [];
+  socket.on('data', function(chunk) {
+    chunks.push(chunk);
+  });
+  socket.on('end', function() {
+    socket.end(Buffer.concat(chunks));
+  });
+});
+assert.strictEqual(server.slabReads, true);
+assert.strictEqual(net.createServer().slabReads, false);
+
+server.listen(0, common.mustCall(function() {
+  let pending = CONNECTIONS;
+  for (let i = 0; i < CONNECTIONS; i++) {
+    const expected = [];
+    const client = net.connect(this.address().port, function() {
+      for (let j = 0; j < CHUNKS; j++) {
+        // Odd sizes so that reads don't end on an alignment boundary.
+        const chunk = Buffer.alloc(1000 + 333 * j, 'abcdefgh'[(i + j) % 8]);
+        expected.push(chunk);
+        client.write(chunk);
+      }
+      client.end();
+    });
+    const received = [];
+    client.on('data', function(chunk) {
+      received.push(chunk);
+    });
+    client.on('end', common.mustCall(function() {
+      assert(Buffer.concat(received).equals(Buffer.concat(expected)));
+      if (--pending === 0)
+        server.close();
+    }));
+  }
+}));
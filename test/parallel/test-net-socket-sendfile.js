@@ -0,0 +1,64 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const fs = require('fs');
+const net = require('net');
+const path = require('path');
+
+common.refreshTmpDir();
+
+const file = path.join(common.tmpDir, 'sendfile.txt');
+const data = Buffer.alloc(256 * 1024);
+for (let i = 0; i < data.length; i++)
+  data[i] = i % 251;
+fs.writeFileSync(file, data);
+const fd = fs.openSync(file, 'r');
+
+const expected = Buffer.concat([
+  Buffer.from('head'),
+  data.slice(3),
+  Buffer.from('middle'),
+  data.slice(0, 10),
+  Buffer.from('tail')
+]);
+
+const server = net.createServer(function(socket) {
+  const chunks = [];
+  socket.on('data', (chunk) => chunks.push(chunk));
+  socket.on('end', common.mustCall(function() {
+    assert(Buffer.concat(chunks).equals(expected));
+    socket.end();
+  }));
+});
+
+server.listen(0, common.mustCall(function() {
+  const client = net.connect(this.address().port);
+  client.write('head');
+  client.sendFile(fd, 3, data.length - 3, common.mustCall(function() {
+    // Files can be corked along with regular writes.
+    client.cork();
+    client.write('middle');
+    client.sendFile(fd, 0, 10);
+    client.write('tail');
+    client.uncork();
+    client.end();
+  }));
+  client.resume();
+  client.on('close', common.mustCall(function() {
+    assert.strictEqual(client.bytesWritten, expected.length);
+    // The file position is left alone.
+    assert.strictEqual(fs.readSync(fd, Buffer.alloc(4), 0, 4, null), 4);
+    fs.closeSync(fd);
+    server.close();
+  }));
+}));
+
+assert.throws(function() {
+  new net.Socket().sendFile(-1, 0, 1);
+}, /^TypeError: "fd" argument must be a file descriptor$/);
+assert.throws(function() {
+  new net.Socket().sendFile(fd, 1.5, 1);
+}, /^TypeError: "offset" argument must be a non-negative integer$/);
+assert.throws(function() {
+  new net.Socket().sendFile(fd, 0, '1');
+}, /^TypeError: "length" argument must be a non-negative integer$/);
@@ -0,0 +1,61 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const net = require('net');
+
+// Socket timeouts are kept by the handle, which refreshes them on every read
+// and write without calling into JS.
+
+const server = net.createServer(function(socket) {
+  socket.on('data', () => {});
+  socket.on('end', () => socket.end());
+});
+
+server.listen(0, common.mustCall(function() {
+  const port = this.address().port;
+
+  // Set before the handle exists, moves to the handle on connect().
+  const client = new net.Socket();
+  client.setTimeout(100);
+  assert.strictEqual(client._idleTimeout, 100);
+  client.connect(port);
+  assert.strictEqual(client._idleTimeout, -1);
+  assert.strictEqual(typeof client._handle.setIdleTimeout, 'function');
+
+  let timeouts = 0;
+  let writes = 0;
+  client.on('timeout', function() {
+    timeouts++;
+    if (timeouts === 1) {
+      // Nothing was written for 100 ms after the last write.
+      assert.strictEqual(writes, 10);
+      // Activity arms the timeout again.
+      client.write('again');
+    } else {
+      assert.strictEqual(timeouts, 2);
+      client.setTimeout(0);
+      setTimeout(function() {
+        assert.strictEqual(timeouts, 2);
+        client.end();
+      }, 200);
+    }
+  });
+
+  client.on('connect', function() {
+    // Writing every 20 ms keeps the timeout from firing.
+    const interval = setInterval(function() {
+      client.write('ping');
+      if (++writes === 10)
+        clearInterval(interval);
+    }, 20);
+  });
+
+  client.on('close', common.mustCall(function() {
+    assert.strictEqual(timeouts, 2);
+    server.close();
+  }));
+}));
+
+assert.throws(function() {
+  new net.Socket().setTimeout(-1);
+}, /^RangeError: "msecs" argument must be a non-negative finite number$/);
@@ -0,0 +1,68 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const http = require('http');
+const net = require('net');
+const ChunkList = require('buffer').ChunkList;
+
+function body() {
+  return new ChunkList(['abc', Buffer.from('def'), Buffer.alloc(1000, 'g')]);
+}
+const expected = body().toBuffer().toString();
+
+// net.Socket writes the Buffers of a ChunkList with one writev().
+{
+  const server = net.createServer(common.mustCall(function(socket) {
+    socket.write(body());
+    socket.cork();
+    socket.write('-');
+    socket.write(body());
+    socket.write(new ChunkList());
+    socket.uncork();
+    socket.end(body());
+    assert.strictEqual(socket.bytesWritten, 3 * expected.length + 1);
+  }));
+  server.listen(0, common.mustCall(function() {
+    const client = net.connect(this.address().port);
+    let received = '';
+    client.setEncoding('utf8');
+    client.on('data', (data) => received += data);
+    client.on('end', common.mustCall(function() {
+      assert.strictEqual(received, expected + '-' + expected + expected);
+      server.close();
+    }));
+  }));
+}
+
+// HTTP bodies, with and without chunked encoding.
+{
+  const server = http.createServer(common.mustCall(function(req, res) {
+    if (req.url === '/chunked') {
+      res.write(body());
+      res.end(body());
+    } else {
+      res.end(body());
+    }
+  }, 2));
+  server.listen(0, common.mustCall(function() {
+    let pending = 2;
+    ['/chunked', '/'].forEach((url) => {
+      http.get({ port: this.address().port, path: url }, (res) => {
+        if (url === '/')
+          assert.strictEqual(res.headers['content-length'], '1006');
+        let received = '';
+        res.setEncoding('utf8');
+        res.on('data', (data) => received += data);
+        res.on('end', common.mustCall(function() {
+          assert.strictEqual(received,
+                             url === '/' ? expected : expected + expected);
+          if (--pending === 0)
+            server.close();
+        }));
+      });
+    });
+  }));
+}
+
+assert.throws(() => new net.Socket().write({}),
+              /^TypeError: Invalid data, chunk must be a string or buffer/);
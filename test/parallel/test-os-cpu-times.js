@@ -0,0 +1,31 @@
+'use strict';
+require('../common');
+const assert = require('assert');
+const os = require('os');
+
+const cpus = os.cpus();
+const times = os.cpuTimes();
+assert(times instanceof Float64Array);
+assert.strictEqual(times.length, cpus.length * 5);
+for (var i = 0; i < times.length; i++)
+  assert(times[i] >= 0);
+
+// The times only grow, and are counted the same way os.cpus() counts them.
+const idle = times[3];
+assert(idle >= cpus[0].times.idle);
+assert.strictEqual(os.cpuTimes(times), times);
+assert(times[3] >= idle);
+assert(times[3] <= os.cpus()[0].times.idle);
+
+// Arrays that are too small are replaced.
+const small = new Float64Array(1);
+const filled = os.cpuTimes(small);
+assert.notStrictEqual(filled, small);
+assert.strictEqual(filled.length, times.length);
+
+// Larger ones are filled from the start.
+const large = new Float64Array(times.length + 5).fill(-1);
+assert.strictEqual(os.cpuTimes(large).length, times.length);
+assert.strictEqual(large[times.length], -1);
+
+assert.throws(() => os.cpuTimes([]), TypeError);
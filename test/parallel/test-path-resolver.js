@@ -0,0 +1,63 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const path = require('path');
+
+// Long paths are normalized natively.
+{
+  const segment = 'abcdefghij';
+  const long = '/' + segment.repeat(10);
+  assert.strictEqual(path.posix.normalize(long + '/./x/../y//z/'),
+                     long + '/y/z/');
+  assert.strictEqual(path.posix.normalize('a/../../' + segment.repeat(10)),
+                     '../' + segment.repeat(10));
+  assert.strictEqual(path.posix.normalize('/../'.repeat(30)), '/');
+  assert.strictEqual(path.posix.normalize('./'.repeat(40)), './');
+  assert.strictEqual(path.posix.resolve(long, '..', 'é', 'x'.repeat(70)),
+                     '/é/' + 'x'.repeat(70));
+  assert.strictEqual(path.posix.normalize('/\u2603/'.repeat(40)),
+                     '/' + Array(41).join('\u2603/'));
+}
+
+{
+  const resolve = path.posix.createResolver(2);
+  const cases = [
+    ['/foo/bar', './baz'],
+    ['/foo/bar', '/tmp/file/'],
+    ['/var/lib', '../', 'file/'],
+    ['a', '/b', ''],
+    ['/', '..', '..'],
+    ['relative', '../other'],
+    [],
+    ['']
+  ];
+  for (let i = 0; i < 3; i++) {
+    for (const args of cases) {
+      assert.strictEqual(resolve.apply(null, args),
+                         path.posix.resolve.apply(null, args));
+    }
+  }
+  assert.strictEqual(resolve('a\u0000b'), path.posix.resolve('a\u0000b'));
+  assert.throws(() => resolve('/a', null), TypeError);
+}
+
+if (!common.isWindows) {
+  // Relative paths are cached per working directory.
+  const resolve = path.createResolver();
+  const cwd = process.cwd();
+  assert.strictEqual(resolve('x'), path.join(cwd, 'x'));
+  process.chdir(common.fixturesDir);
+  assert.strictEqual(resolve('x'), path.join(process.cwd(), 'x'));
+  process.chdir(cwd);
+  assert.strictEqual(resolve('x'), path.join(cwd, 'x'));
+}
+
+{
+  const resolve = path.win32.createResolver(10);
+  assert.strictEqual(resolve('c:/ignore', 'd:\\a/b\\c/d', '\\e.exe'),
+                     'd:\\e.exe');
+}
+
+[0, -1, 1.5, '10', null].forEach((maxEntries) => {
+  assert.throws(() => path.createResolver(maxEntries), TypeError);
+});
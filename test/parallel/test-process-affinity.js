@@ -0,0 +1,38 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const fs = require('fs');
+
+if (process.platform !== 'linux') {
+  assert.throws(() => process.getAffinity(), /ENOTSUP/);
+  assert.throws(() => process.setAffinity([0]), /ENOTSUP/);
+  assert.throws(() => process.setThreadpoolAffinity([0]), /ENOTSUP/);
+  common.skip('CPU affinity is only supported on Linux');
+  return;
+}
+
+const cpus = process.getAffinity();
+assert(Array.isArray(cpus));
+assert(cpus.length > 0);
+cpus.forEach((cpu) => assert(Number.isInteger(cpu) && cpu >= 0));
+
+assert.throws(() => process.setAffinity(0), TypeError);
+assert.throws(() => process.setAffinity([-1]), /EINVAL/);
+assert.throws(() => process.setAffinity([1e6]), /EINVAL/);
+assert.throws(() => process.setAffinity([]), /EINVAL/);
+assert.throws(() => process.setThreadpoolAffinity(0), TypeError);
+assert.throws(() => process.setThreadpoolAffinity([0], 'gpu'), TypeError);
+
+process.setAffinity([cpus[0]]);
+assert.deepStrictEqual(process.getAffinity(), [cpus[0]]);
+
+// Work keeps running while the threadpool is pinned and unpinned.
+process.setThreadpoolAffinity([cpus[cpus.length - 1]]);
+process.setThreadpoolAffinity(cpus, 'fs');
+fs.stat(__filename, common.mustCall((err) => {
+  assert.ifError(err);
+  process.setThreadpoolAffinity(null);
+  process.setThreadpoolAffinity(null, 'fs');
+  process.setAffinity(cpus);
+  assert.deepStrictEqual(process.getAffinity(), cpus);
+}));
@@ -0,0 +1,25 @@
+'use strict';
+require('../common');
+const assert = require('assert');
+
+// Reads of process.env are cached, writes and deletes must be seen at once.
+const key = 'NODE_TEST_ENV_CACHE';
+assert.strictEqual(process.env[key], undefined);
+assert.strictEqual(key in process.env, false);
+
+process.env[key] = 'first';
+assert.strictEqual(process.env[key], 'first');
+assert.strictEqual(process.env[key], 'first');
+assert.strictEqual(key in process.env, true);
+
+process.env[key] = 42;
+assert.strictEqual(process.env[key], '42');
+
+delete process.env[key];
+assert.strictEqual(process.env[key], undefined);
+assert.strictEqual(key in process.env, false);
+assert.strictEqual(Object.keys(process.env).indexOf(key), -1);
+
+// A name that is also an Object.prototype property.
+assert.strictEqual(typeof process.env.hasOwnProperty, 'function');
+assert.strictEqual(typeof process.env.hasOwnProperty, 'function');
@@ -0,0 +1,57 @@
+'use strict';
+
+const common = require('../common');
+const assert = require('assert');
+const net = require('net');
+
+const kStride = 5;
+const payload = Buffer.alloc(1024, 'x');
+const writes = 16;
+
+function statsOf(handle) {
+  const list = process._getActiveHandleStats();
+  assert.strictEqual(list.length % kStride, 0);
+  for (let i = 0; i < list.length; i += kStride) {
+    if (list[i] === handle) {
+      return {
+        bytesRead: list[i + 1],
+        bytesWritten: list[i + 2],
+        readCount: list[i + 3],
+        writeQueueHighWaterMark: list[i + 4]
+      };
+    }
+  }
+  return null;
+}
+
+const server = net.createServer(common.mustCall(function(conn) {
+  let received = 0;
+  conn.on('data', function(data) {
+    received += data.length;
+    if (received < payload.length * writes)
+      return;
+
+    const stats = statsOf(conn);
+    assert.strictEqual(stats.bytesRead, payload.length * writes);
+    assert.strictEqual(stats.bytesWritten, 0);
+    assert(stats.readCount >= 1);
+
+    conn.end('done');
+  });
+}));
+
+server.listen(0, common.mustCall(function() {
+  const client = net.connect(this.address().port, common.mustCall(function() {
+    for (let i = 0; i < writes; i++)
+      client.write(payload);
+    client.on('data', common.mustCall(function() {
+      const stats = statsOf(client);
+      assert.strictEqual(stats.bytesWritten, payload.length * writes);
+      assert.strictEqual(stats.bytesRead, 4);
+      assert(stats.readCount >= 1);
+      assert(stats.writeQueueHighWaterMark >= 0);
+      client.destroy();
+      server.close();
+    }));
+  }));
+}));
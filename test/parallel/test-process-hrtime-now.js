@@ -0,0 +1,40 @@
+'use strict';
+
+require('../common');
+const assert = require('assert');
+
+// process.hrtime.now() is monotonic and agrees with process.hrtime().
+const before = process.hrtime();
+const now = process.hrtime.now();
+const after = process.hrtime();
+assert.strictEqual(typeof now, 'number');
+assert.ok(now >= before[0] * 1e6 + before[1] / 1e3);
+assert.ok(now <= after[0] * 1e6 + after[1] / 1e3);
+
+let last = process.hrtime.now();
+for (let i = 0; i < 1000; i++) {
+  const t = process.hrtime.now();
+  assert.ok(t >= last);
+  last = t;
+}
+
+// process.hrtime.into() writes [seconds, nanoseconds] at the given index.
+const u32 = new Uint32Array(4);
+assert.strictEqual(process.hrtime.into(u32, 2), u32);
+assert.strictEqual(u32[0], 0);
+assert.strictEqual(u32[1], 0);
+assert.ok(u32[2] > 0 || u32[3] > 0);
+assert.ok(u32[3] < 1e9);
+
+const f64 = new Float64Array(2);
+process.hrtime.into(f64);
+const diff = process.hrtime([f64[0], f64[1]]);
+assert.ok(diff[0] >= 0 && diff[1] >= 0);
+assert.ok(f64[0] * 1e6 + f64[1] / 1e3 <= process.hrtime.now());
+
+assert.throws(() => process.hrtime.into([0, 0]), TypeError);
+assert.throws(() => process.hrtime.into(new DataView(new ArrayBuffer(16))),
+              TypeError);
+assert.throws(() => process.hrtime.into(new Uint32Array(2), 1), RangeError);
+assert.throws(() => process.hrtime.into(new Uint32Array(2), -1), RangeError);
+assert.throws(() => process.hrtime.into(new Uint32Array(4), 0.5), RangeError);
@@ -0,0 +1,27 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const dns = require('dns');
+
+const levels = [];
+process.on('memoryPressure', common.mustCall(function(level) {
+  levels.push(level);
+}, 2));
+
+// A pooled Buffer from before keeps its contents, new ones still work.
+const before = Buffer.from('before');
+process.notifyMemoryPressure();
+assert.strictEqual(before.toString(), 'before');
+assert.strictEqual(Buffer.from('after').toString(), 'after');
+
+process.notifyMemoryPressure('critical');
+assert.deepStrictEqual(levels, ['moderate', 'critical']);
+
+assert.throws(() => process.notifyMemoryPressure('low'), TypeError);
+assert.throws(() => process.notifyMemoryPressure(1), TypeError);
+
+// The native caches are usable after they were trimmed.
+dns.lookup('127.0.0.1', common.mustCall(function(err, address) {
+  assert.ifError(err);
+  assert.strictEqual(address, '127.0.0.1');
+}));
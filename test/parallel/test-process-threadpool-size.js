@@ -0,0 +1,45 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const fs = require('fs');
+
+assert.strictEqual(process.getThreadpoolSize('fs'), 0);
+assert.strictEqual(process.getThreadpoolSize('dns'), 0);
+assert.strictEqual(process.getThreadpoolSize('crypto'), 0);
+assert.strictEqual(process.getThreadpoolSize(),
+                   process.getThreadpoolSize('cpu'));
+
+process.setThreadpoolSize(2);
+assert.strictEqual(process.getThreadpoolSize(), 2);
+process.setThreadpoolSize(3, 'fs');
+assert.strictEqual(process.getThreadpoolSize('fs'), 3);
+
+// Work keeps running while the queues are resized.
+let pending = 20;
+for (let i = 0; i < 20; i++) {
+  fs.stat(__filename, common.mustCall(function(err, stats) {
+    assert.ifError(err);
+    assert(stats.isFile());
+    if (--pending === 10) {
+      process.setThreadpoolSize(1, 'fs');
+      process.setThreadpoolSize(0, 'fs');
+      process.setThreadpoolSize(6);
+    }
+  }));
+}
+
+assert.throws(function() {
+  process.setThreadpoolSize(0);
+}, /^RangeError: Invalid threadpool size: 0$/);
+assert.throws(function() {
+  process.setThreadpoolSize(129, 'dns');
+}, /^RangeError: Invalid threadpool size: 129$/);
+assert.throws(function() {
+  process.setThreadpoolSize(1.5);
+}, /^RangeError: Invalid threadpool size: 1.5$/);
+assert.throws(function() {
+  process.setThreadpoolSize(1, 'network');
+}, /^TypeError: Unknown threadpool queue: network$/);
+assert.throws(function() {
+  process.getThreadpoolSize('network');
+}, /^TypeError: Unknown threadpool queue: network$/);
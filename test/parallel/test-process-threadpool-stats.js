@@ -0,0 +1,36 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const fs = require('fs');
+
+const fields = ['submitted', 'completed', 'queued', 'maxQueued', 'running',
+                'waitTime', 'maxWaitTime', 'runTime', 'maxRunTime'];
+
+const before = process.threadpoolStats();
+assert.deepStrictEqual(Object.keys(before), ['cpu', 'fs', 'dns', 'crypto']);
+for (const queue of Object.keys(before))
+  assert.deepStrictEqual(Object.keys(before[queue]), fields);
+
+const count = 10;
+let pending = count;
+for (let i = 0; i < count; i++) {
+  fs.stat(__filename, common.mustCall(function(err) {
+    assert.ifError(err);
+    if (--pending === 0)
+      setImmediate(check);
+  }));
+}
+
+const queued = process.threadpoolStats().fs;
+assert.strictEqual(queued.submitted, before.fs.submitted + count);
+
+function check() {
+  const after = process.threadpoolStats().fs;
+  assert.strictEqual(after.completed, before.fs.completed + count);
+  assert.strictEqual(after.queued, 0);
+  assert.strictEqual(after.running, 0);
+  assert(after.maxQueued >= 1);
+  assert(after.runTime > before.fs.runTime);
+  assert(after.maxRunTime <= after.runTime);
+  assert(after.maxWaitTime <= after.waitTime);
+}
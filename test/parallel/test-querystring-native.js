@@ -0,0 +1,77 @@
+'use strict';
+require('../common');
+const assert = require('assert');
+const qs = require('querystring');
+
+// Long strings and Buffers are handled natively and have to come out like
+// short strings, which are parsed in JS.
+const pairs = [
+  'a=1', 'b=%41%42', 'c=x+y', 'a=2', 'd', 'e=', '=f', 'g=%E9', 'h=%C3%A9',
+  'i=%4', 'j=%zz%41', 'k=%2+', 'l=1=2', '%61=3', 'a=5'
+];
+
+function parseEach(str) {
+  const result = {};
+  for (const pair of str.split('&')) {
+    const parsed = qs.parse(pair);
+    for (const key of Object.keys(parsed)) {
+      if (!(key in result))
+        result[key] = parsed[key];
+      else if (Array.isArray(result[key]))
+        result[key].push(parsed[key]);
+      else
+        result[key] = [result[key], parsed[key]];
+    }
+  }
+  return result;
+}
+
+let long = '';
+for (let i = 0; i < 20; i++)
+  long += pairs.join('&') + '&';
+long = long.slice(0, -1);
+assert(long.length >= 256);
+
+const reference = parseEach(long);
+assert.deepStrictEqual(Object.assign({}, qs.parse(long)), reference);
+assert.deepStrictEqual(Object.assign({}, qs.parse(Buffer.from(long))),
+                       reference);
+assert.deepStrictEqual(
+  Object.assign({}, qs.parse(Buffer.from(long.replace(/&/g, ';')), ';')),
+  reference);
+
+// maxKeys counts every pair.
+assert.strictEqual(
+  Object.keys(qs.parse(Buffer.from(long), null, null, { maxKeys: 2 })).length,
+  2);
+assert.strictEqual(qs.parse(long, null, null, { maxKeys: 0 }).a.length, 80);
+
+// Raw UTF-8 in a Buffer, and non-ASCII strings that go through the JS code.
+assert.deepStrictEqual(
+  Object.assign({}, qs.parse(Buffer.from('ключ=значение&k=%D0%B7'))),
+  { 'ключ': 'значение', k: 'з' });
+const nonAscii = 'é='.repeat(200) + '&x=%41';
+assert.strictEqual(qs.parse(nonAscii).x, 'A');
+assert.deepStrictEqual(Object.assign({}, qs.parse(Buffer.alloc(0))), {});
+
+// A custom decoder also works for Buffers.
+assert.deepStrictEqual(
+  Object.assign({}, qs.parse(Buffer.from('a=b'), null, null, {
+    decodeURIComponent: (s) => s.toUpperCase()
+  })),
+  { A: 'B' });
+
+// unescapeBuffer() and escape() of long strings.
+const escaped = '%41+%4%zz%C3%A9'.repeat(40);
+assert.deepStrictEqual(qs.unescapeBuffer(escaped, true),
+                       Buffer.from('A %4%zzé'.repeat(40)));
+assert.deepStrictEqual(qs.unescapeBuffer(escaped),
+                       Buffer.from('A+%4%zzé'.repeat(40)));
+
+const raw = 'a b&c=é😀~*'.repeat(40);
+assert.strictEqual(qs.escape(raw), encodeURIComponent(raw));
+assert.strictEqual(qs.unescape(qs.escape(raw)), raw);
+const plain = 'abc'.repeat(100);
+assert.strictEqual(qs.escape(plain), plain);
+assert.throws(() => qs.escape('a'.repeat(300) + '\ud800'), URIError);
+assert.strictEqual(qs.stringify({ k: raw }), 'k=' + encodeURIComponent(raw));
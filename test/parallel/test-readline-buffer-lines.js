@@ -0,0 +1,38 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const readline = require('readline');
+const PassThrough = require('stream').PassThrough;
+
+// Buffers are split into lines natively.  Line endings and UTF-8 sequences
+// that are cut in two by chunk boundaries must come out the same as when the
+// whole input is decoded at once.
+const text = 'first\r\nsecönd\rthird\n\nf€urth\r\n€\rlast';
+const expected = ['first', 'secönd', 'third', '', 'f€urth',
+                  '€', 'last'];
+const bytes = Buffer.from(text);
+
+for (var size = 1; size <= bytes.length; size++) {
+  const input = new PassThrough();
+  const rl = readline.createInterface({ input: input, terminal: false });
+  const lines = [];
+  rl.on('line', (line) => lines.push(line));
+  rl.on('close', common.mustCall(() => {
+    assert.deepStrictEqual(lines, expected);
+  }));
+  for (var i = 0; i < bytes.length; i += size)
+    input.write(bytes.slice(i, i + size));
+  input.end();
+}
+
+// A line that starts in a Buffer and ends in a string.
+{
+  const input = new PassThrough({ objectMode: true });
+  const rl = readline.createInterface({ input: input, terminal: false });
+  rl.on('line', common.mustCall((line) => {
+    assert.strictEqual(line, 'héllo');
+  }));
+  input.write(Buffer.from('hél'));
+  input.write('lo\n');
+  input.end();
+}
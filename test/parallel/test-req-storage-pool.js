@@ -0,0 +1,26 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const fs = require('fs');
+const binding = process.binding('stream_wrap');
+
+// The memory of finished fs and write requests is reused for the next ones.
+// Requests that run one after the other should be served from the pool.
+
+const before = binding.getReqStoragePoolStats();
+assert.strictEqual(typeof before.hits, 'number');
+assert.strictEqual(typeof before.misses, 'number');
+assert.strictEqual(typeof before.retained, 'number');
+
+function stat(n) {
+  fs.stat(__filename, common.mustCall((err) => {
+    assert.ifError(err);
+    if (n > 1)
+      return stat(n - 1);
+    const after = binding.getReqStoragePoolStats();
+    assert(after.hits >= before.hits + 9);
+    assert(after.retained <= 128 * 1024);
+  }));
+}
+
+stat(10);
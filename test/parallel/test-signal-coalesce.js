@@ -0,0 +1,32 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+
+if (common.isWindows) {
+  common.skip('SIGUSR2 is not supported');
+  return;
+}
+
+// Signals that arrive together are emitted once, with their number.
+var calls = 0;
+var total = 0;
+process.on('SIGUSR2', (count) => {
+  calls++;
+  total += count;
+});
+
+process.kill(process.pid, 'SIGUSR2');
+process.kill(process.pid, 'SIGUSR2');
+process.kill(process.pid, 'SIGUSR2');
+
+setTimeout(common.mustCall(() => {
+  assert.strictEqual(total, 3);
+  assert.strictEqual(calls, 1);
+
+  process.kill(process.pid, 'SIGUSR2');
+  setTimeout(common.mustCall(() => {
+    assert.strictEqual(total, 4);
+    assert.strictEqual(calls, 2);
+    process.removeAllListeners('SIGUSR2');
+  }), common.platformTimeout(100));
+}), common.platformTimeout(100));
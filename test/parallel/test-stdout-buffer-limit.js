@@ -0,0 +1,47 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const spawn = require('child_process').spawn;
+
+if (process.argv[2] === 'child') {
+  const stdout = process.stdout;
+  assert.throws(() => stdout.setBufferLimit(-1), TypeError);
+  assert.throws(() => stdout.setBufferLimit(1, 'block'), TypeError);
+
+  // Nobody reads yet, so most of this is dropped once the pipe is full.
+  stdout.setBufferLimit(256 * 1024);
+  const chunk = Buffer.alloc(16 * 1024, 'x');
+  var written = 0;
+  for (var i = 0; i < 200; i++) {
+    assert.strictEqual(stdout.write(chunk), true);
+    written += chunk.length;
+  }
+  assert(stdout.droppedBytes > 0);
+
+  const dropped = stdout.droppedBytes;
+  stdout.setBufferLimit(0, 'backpressure');
+  assert.strictEqual(stdout.write('y'), false);
+  assert.strictEqual(stdout.droppedBytes, dropped);
+  written += 1;
+
+  process.stderr.write(`${written} ${dropped}\n`);
+  return;
+}
+
+const child = spawn(process.execPath, [__filename, 'child']);
+var received = 0;
+var report = '';
+
+child.stderr.setEncoding('utf8');
+child.stderr.on('data', (data) => {
+  report += data;
+  // Start reading once the child is done writing.
+  if (report.endsWith('\n'))
+    child.stdout.on('data', (data) => received += data.length);
+});
+
+child.on('close', common.mustCall((code) => {
+  assert.strictEqual(code, 0);
+  const numbers = report.trim().split(' ').map(Number);
+  assert.strictEqual(received, numbers[0] - numbers[1]);
+}));
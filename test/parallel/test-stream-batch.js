@@ -0,0 +1,100 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const stream = require('stream');
+
+{
+  // Object mode, enough items to make the buffer grow a few times.
+  const items = [];
+  for (let i = 0; i < 1000; i++)
+    items.push({ i });
+
+  const r = new stream.Readable({ objectMode: true, read() {} });
+  assert.strictEqual(r.pushBatch(items.slice(0, 10)), true);
+  assert.strictEqual(r.pushBatch(items.slice(10)), false);
+  assert.strictEqual(r._readableState.length, 1000);
+
+  // unshift() puts an item back in front.
+  const first = r.read();
+  r.unshift(first);
+
+  const seen = [];
+  r.on('data', (item) => seen.push(item));
+  r.on('end', common.mustCall(() => {
+    assert.deepStrictEqual(seen, items);
+  }));
+  r.pushBatch([null]);
+}
+
+{
+  // Buffers, strings and an EOF in the middle of the batch come out like
+  // separate push() calls.
+  const r = new stream.Readable({ read() {} });
+  r.pushBatch([Buffer.from('ab'), Buffer.alloc(0), 'cd', Buffer.from('ef'),
+               null]);
+  assert.strictEqual(r._readableState.ended, true);
+
+  const chunks = [];
+  r.on('data', (chunk) => chunks.push(chunk));
+  r.on('end', common.mustCall(() => {
+    assert.strictEqual(Buffer.concat(chunks).toString(), 'abcdef');
+  }));
+}
+
+{
+  // While flowing, the chunks are emitted right away.
+  const r = new stream.Readable({ objectMode: true, read() {} });
+  const seen = [];
+  r.on('data', (item) => seen.push(item));
+  setImmediate(common.mustCall(() => {
+    r.pushBatch([1, 2, 3]);
+    assert.deepStrictEqual(seen, [1, 2, 3]);
+    assert.strictEqual(r._readableState.length, 0);
+  }));
+}
+
+assert.throws(() => new stream.Readable().pushBatch('abc'), TypeError);
+
+{
+  // A batch goes to _writev() in one call, with one callback at the end.
+  const writes = [];
+  const w = new stream.Writable({
+    objectMode: true,
+    write(chunk, encoding, cb) {
+      writes.push([chunk]);
+      setImmediate(cb);
+    },
+    writev(chunks, cb) {
+      writes.push(chunks.map((entry) => entry.chunk));
+      setImmediate(cb);
+    }
+  });
+
+  w.write(0);
+  w.writeBatch([1, 2, 3], common.mustCall(() => {
+    w.writeBatch([4, 5], common.mustCall(() => {
+      assert.deepStrictEqual(writes, [[0], [1, 2, 3], [4, 5]]);
+      assert.strictEqual(w._writableState.getBuffer().length, 0);
+    }));
+  }));
+  assert.deepStrictEqual(w._writableState.getBuffer().map((entry) => {
+    return entry.chunk;
+  }), [1, 2, 3]);
+}
+
+{
+  // Without _writev(), the chunks are written one by one.
+  const written = [];
+  const w = new stream.Writable({
+    write(chunk, encoding, cb) {
+      written.push(chunk.toString());
+      process.nextTick(cb);
+    }
+  });
+  w.writeBatch(['a', Buffer.from('b'), 'c'], common.mustCall(() => {
+    assert.deepStrictEqual(written, ['a', 'b', 'c']);
+  }));
+  w.writeBatch([], common.mustCall(() => {}));
+}
+
+assert.throws(() => new stream.Writable().writeBatch('abc'), TypeError);
@@ -26,7 +26,7 @@ s.read(0);
 // ACTUALLY [1, 3, 5, 6, 4, 2]
 
 process.on('exit', function() {
-  assert.deepStrictEqual(s._readableState.buffer,
+  assert.deepStrictEqual(s._readableState.buffer.toArray(),
                          ['1', '2', '3', '4', '5', '6']);
   console.log('ok');
 });
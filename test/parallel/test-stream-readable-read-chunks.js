@@ -0,0 +1,67 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const net = require('net');
+const stream = require('stream');
+
+// Everything that was pushed in the meantime comes out as one batch of the
+// original chunks.
+{
+  const readable = new stream.Readable({ read() {} });
+  const a = Buffer.from('a');
+  const b = Buffer.from('bc');
+  readable.push(a);
+  readable.push(b);
+
+  readable.readChunks().then(common.mustCall((chunks) => {
+    assert.strictEqual(chunks.length, 2);
+    assert.strictEqual(chunks[0], a);
+    assert.strictEqual(chunks[1], b);
+    const pending = readable.readChunks();
+    assert.throws(() => readable.readChunks(), /pending/);
+    readable.push('d');
+    readable.push(null);
+    return pending;
+  })).then(common.mustCall((chunks) => {
+    assert.deepStrictEqual(chunks.map(String), ['d']);
+    return readable.readChunks();
+  })).then(common.mustCall((chunks) => {
+    assert.strictEqual(chunks, null);
+  }));
+}
+
+// Errors reject the pending call and the ones after it.
+{
+  const readable = new stream.Readable({ read() {} });
+  const error = new Error('boom');
+  readable.readChunks().then(common.fail, common.mustCall((err) => {
+    assert.strictEqual(err, error);
+    return readable.readChunks();
+  })).then(common.fail, common.mustCall((err) => {
+    assert.strictEqual(err, error);
+  }));
+  setImmediate(() => readable.emit('error', error));
+}
+
+// A socket delivers everything that was read, until the end.
+{
+  const payload = Buffer.alloc(256 * 1024, 'x');
+  const server = net.createServer((socket) => socket.end(payload));
+  server.listen(0, common.mustCall(() => {
+    const client = net.connect(server.address().port);
+    var received = 0;
+    function next() {
+      return client.readChunks().then((chunks) => {
+        if (chunks === null)
+          return;
+        assert(chunks.length > 0);
+        chunks.forEach((chunk) => received += chunk.length);
+        return next();
+      });
+    }
+    next().then(common.mustCall(() => {
+      assert.strictEqual(received, payload.length);
+      server.close();
+    }));
+  }));
+}
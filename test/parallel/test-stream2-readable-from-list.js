@@ -1,7 +1,17 @@
+// Flags: --expose_internals
 'use strict';
 require('../common');
 var assert = require('assert');
 var fromList = require('_stream_readable')._fromList;
+var RingBuffer = require('internal/streams/ring_buffer');
+
+function ringOf(items) {
+  var ring = new RingBuffer();
+  items.forEach(function(item) {
+    ring.push(item);
+  });
+  return ring;
+}
 
 // tiny node-tap lookalike.
 var tests = [];
@@ -39,10 +49,10 @@ process.nextTick(run);
 
 
 test('buffers', function(t) {
-  var list = [ Buffer.from('foog'),
-               Buffer.from('bark'),
-               Buffer.from('bazy'),
-               Buffer.from('kuel') ];
+  var list = ringOf([ Buffer.from('foog'),
+                      Buffer.from('bark'),
+                      Buffer.from('bazy'),
+                      Buffer.from('kuel') ]);
 
   // read more than the first element.
   var ret = fromList(6, { buffer: list, length: 16 });
@@ -61,16 +71,16 @@ test('buffers', function(t) {
   t.equal(ret.toString(), 'zykuel');
 
   // all consumed.
-  t.same(list, []);
+  t.same(list.toArray(), []);
 
   t.end();
 });
 
 test('strings', function(t) {
-  var list = [ 'foog',
-               'bark',
-               'bazy',
-               'kuel' ];
+  var list = ringOf([ 'foog',
+                      'bark',
+                      'bazy',
+                      'kuel' ]);
 
   // read more than the first element.
   var ret = fromList(6, { buffer: list, length: 16, decoder: true });
@@ -89,7 +99,7 @@ test('strings', function(t) {
   t.equal(ret, 'zykuel');
 
   // all consumed.
-  t.same(list, []);
+  t.same(list.toArray(), []);
 
   t.end();
 });
@@ -28,9 +28,29 @@ test('ucs2', Buffer.from('ababc', 'ucs2'), 'ababc');
 
 // UTF-16LE
 test('ucs2', Buffer.from('3DD84DDC', 'hex'),  '\ud83d\udc4d'); // thumbs up
+test('ucs2', Buffer.from('41004200' + '3DD84DDC', 'hex'), 'AB\ud83d\udc4d');
+
+// Base64
+test('base64', Buffer.from('abcdefg'), 'YWJjZGVm');
 
 console.log(' crayon!');
 
+{
+  // The bytes of an incomplete character are kept until it is complete.
+  const decoder = new StringDecoder('utf8');
+  assert.strictEqual(decoder.write(Buffer.from('41E282', 'hex')), 'A');
+  assert.strictEqual(decoder.charReceived, 2);
+  assert.strictEqual(decoder.charLength, 3);
+  assert.strictEqual(decoder.charBuffer.slice(0, 2).toString('hex'), 'e282');
+  assert.strictEqual(decoder.write(Buffer.from('AC', 'hex')), '\u20ac');
+  assert.strictEqual(decoder.charReceived, 0);
+  assert.strictEqual(decoder.write(Buffer.from('E2', 'hex')), '');
+  assert.strictEqual(decoder.end(), '\ufffd');
+  assert.strictEqual(decoder.charReceived, 0);
+  assert.strictEqual(decoder.write(Buffer.from('42', 'hex')), 'B');
+  assert.throws(() => decoder.write(null), TypeError);
+}
+
 // test verifies that StringDecoder will correctly decode the given input
 // buffer with the given encoding to the expected output. It will attempt all
 // possible ways to write() the input buffer, see writeSequences(). The
@@ -4,6 +4,10 @@ var assert = require('assert');
 
 var TCP = process.binding('tcp_wrap').TCP;
 var WriteWrap = process.binding('stream_wrap').WriteWrap;
+var writeInfo = process.binding('stream_wrap').writeInfo;
+// Indexes into writeInfo, see Environment::WriteInfo.
+const kBytesWritten = 0;
+const kLastWriteWasAsync = 1;
 
 var server = new TCP();
 
@@ -37,16 +41,16 @@ server.onconnection = function(err, client) {
       assert.equal(0, client.writeQueueSize);
 
       var req = new WriteWrap();
-      req.async = false;
       const returnCode = client.writeBuffer(req, buffer);
       assert.equal(returnCode, 0);
+      assert.strictEqual(writeInfo[kBytesWritten], buffer.length);
       client.pendingWrites.push(req);
 
       console.log('client.writeQueueSize: ' + client.writeQueueSize);
       // 11 bytes should flush
       assert.equal(0, client.writeQueueSize);
 
-      if (req.async)
+      if (writeInfo[kLastWriteWasAsync] === 1)
         req.oncomplete = done;
       else
         process.nextTick(done.bind(null, 0, client, req));
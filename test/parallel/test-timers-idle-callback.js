@@ -0,0 +1,44 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const timers = require('timers');
+
+const order = [];
+
+timers.setIdleCallback(common.mustCall(function(deadline) {
+  order.push(1);
+  const remaining = deadline.timeRemaining();
+  assert.strictEqual(typeof remaining, 'number');
+  assert(remaining >= 0 && remaining <= 5, `${remaining} ms remaining`);
+}), { budgetMs: 5 });
+
+timers.setIdleCallback(common.mustCall(function(deadline) {
+  order.push(2);
+  assert(deadline.timeRemaining() <= 20);
+
+  // Scheduled from an idle callback, runs in a later idle period.
+  timers.setIdleCallback(common.mustCall(function() {
+    order.push(4);
+  }));
+}));
+
+const cleared = timers.setIdleCallback(common.fail);
+
+timers.setIdleCallback(common.mustCall(function() {
+  order.push(3);
+}));
+
+timers.clearIdleCallback(cleared);
+
+process.on('exit', function() {
+  assert.deepStrictEqual(order, [1, 2, 3, 4]);
+});
+
+assert.throws(() => timers.setIdleCallback(), TypeError);
+assert.throws(() => timers.setIdleCallback('foo'), TypeError);
+assert.throws(() => timers.setIdleCallback(() => {}, { budgetMs: -1 }),
+              RangeError);
+assert.throws(() => timers.setIdleCallback(() => {}, { budgetMs: 'a' }),
+              RangeError);
+assert.throws(() => timers.setIdleCallback(() => {}, { budgetMs: NaN }),
+              RangeError);
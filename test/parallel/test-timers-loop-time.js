@@ -0,0 +1,33 @@
+'use strict';
+
+const common = require('../common');
+const assert = require('assert');
+const timers = require('timers');
+const binding = process.binding('timer_wrap');
+const Timer = binding.Timer;
+const timerInfo = binding.timerInfo;
+
+assert(timerInfo instanceof Float64Array);
+assert.strictEqual(timerInfo.length, 1);
+
+// Timer.now() refreshes the shared loop time.
+assert.strictEqual(timerInfo[0], Timer.now());
+
+// The loop time doesn't move while JS runs.
+const start = timerInfo[0];
+const deadline = Date.now() + 50;
+while (Date.now() < deadline);
+assert.strictEqual(timerInfo[0], start);
+
+// Unrefed timers are stamped with the loop time.
+const item = {};
+timers.enroll(item, 1000);
+timers._unrefActive(item);
+assert.strictEqual(item._idleStart, start);
+timers.unenroll(item);
+
+// The loop refreshes it before it calls into JS.
+setTimeout(common.mustCall(function() {
+  assert(timerInfo[0] >= start + 50);
+  assert(timerInfo[0] <= Timer.now());
+}), 1);
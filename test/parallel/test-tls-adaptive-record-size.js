@@ -0,0 +1,60 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+
+if (!common.hasCrypto) {
+  common.skip('missing crypto');
+  return;
+}
+const tls = require('tls');
+const fs = require('fs');
+
+// With adaptiveRecordSize the server starts out with records of at most 1400
+// bytes and switches to full size records after the first megabyte.  Every
+// record is decrypted separately so the size of the chunks received by the
+// client reflects the size of the records.
+
+const SMALL = 1400;
+const THRESHOLD = 1024 * 1024;
+const payload = Buffer.alloc(2 * THRESHOLD, 'x');
+
+function test(adaptiveRecordSize, cb) {
+  const options = {
+    key: fs.readFileSync(common.fixturesDir + '/keys/agent1-key.pem'),
+    cert: fs.readFileSync(common.fixturesDir + '/keys/agent1-cert.pem'),
+    adaptiveRecordSize: adaptiveRecordSize
+  };
+  const server = tls.createServer(options, function(socket) {
+    socket.end(payload);
+  });
+  assert.strictEqual(server.adaptiveRecordSize, adaptiveRecordSize);
+
+  server.listen(0, common.mustCall(function() {
+    const client = tls.connect({
+      port: this.address().port,
+      rejectUnauthorized: false
+    });
+    let received = 0;
+    let maxBeforeThreshold = 0;
+    let max = 0;
+    client.on('data', function(chunk) {
+      if (received < THRESHOLD)
+        maxBeforeThreshold = Math.max(maxBeforeThreshold, chunk.length);
+      max = Math.max(max, chunk.length);
+      received += chunk.length;
+    });
+    client.on('end', common.mustCall(function() {
+      assert.strictEqual(received, payload.length);
+      if (adaptiveRecordSize)
+        assert(maxBeforeThreshold <= SMALL);
+      else
+        assert(maxBeforeThreshold > SMALL);
+      assert(max > SMALL);
+      server.close(cb);
+    }));
+  }));
+}
+
+test(true, common.mustCall(function() {
+  test(false, common.mustCall());
+}));
@@ -0,0 +1,66 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+
+if (!common.hasCrypto) {
+  common.skip('missing crypto');
+  return;
+}
+const tls = require('tls');
+const fs = require('fs');
+
+// With asyncHandshake the server handshakes in the threadpool.  Several
+// clients connecting at once must complete their handshakes and exchange
+// data, and handshake errors must still be reported.
+
+const CLIENTS = 10;
+
+const options = {
+  key: fs.readFileSync(common.fixturesDir + '/keys/agent1-key.pem'),
+  cert: fs.readFileSync(common.fixturesDir + '/keys/agent1-cert.pem'),
+  asyncHandshake: true
+};
+
+const server = tls.createServer(options, common.mustCall(function(socket) {
+  socket.pipe(socket);
+}, CLIENTS));
+assert.strictEqual(server.asyncHandshake, true);
+
+server.on('tlsClientError', common.mustCall(function(err) {
+  assert(err instanceof Error);
+}));
+
+server.listen(0, common.mustCall(function() {
+  const port = this.address().port;
+  let done = 0;
+
+  for (let i = 0; i < CLIENTS; i++) {
+    const client = tls.connect({
+      port: port,
+      rejectUnauthorized: false
+    }, common.mustCall(function() {
+      client.end('hello ' + i);
+    }));
+    let data = '';
+    client.setEncoding('utf8');
+    client.on('data', function(chunk) {
+      data += chunk;
+    });
+    client.on('end', common.mustCall(function() {
+      assert.strictEqual(data, 'hello ' + i);
+      if (++done === CLIENTS)
+        connectWithBadCiphers(port);
+    }));
+  }
+}));
+
+function connectWithBadCiphers(port) {
+  const client = tls.connect({
+    port: port,
+    ciphers: 'RC4',
+    rejectUnauthorized: false
+  }, common.fail);
+  client.on('error', common.mustCall(function() {
+    server.close();
+  }));
+}
@@ -0,0 +1,54 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+
+if (!common.hasCrypto) {
+  common.skip('missing crypto');
+  return;
+}
+const tls = require('tls');
+const fs = require('fs');
+const binding = process.binding('crypto');
+
+// The 16 KB buffers of the TLS BIOs are recycled between connections.  After
+// the first connection has been closed the following ones should mostly be
+// served from the pool.
+
+const CONNECTIONS = 5;
+
+const options = {
+  key: fs.readFileSync(common.fixturesDir + '/keys/agent1-key.pem'),
+  cert: fs.readFileSync(common.fixturesDir + '/keys/agent1-cert.pem')
+};
+
+const before = binding.getBIOBufferPoolStats();
+assert.strictEqual(typeof before.hits, 'number');
+assert.strictEqual(typeof before.misses, 'number');
+assert.strictEqual(typeof before.retained, 'number');
+
+const server = tls.createServer(options, function(socket) {
+  socket.end(Buffer.alloc(64 * 1024, 'x'));
+});
+
+function connect(n) {
+  const client = tls.connect({
+    port: server.address().port,
+    rejectUnauthorized: false
+  });
+  client.resume();
+  client.on('close', common.mustCall(function() {
+    // Give the server side a chance to release its buffers as well.
+    setImmediate(function() {
+      if (n > 1)
+        return connect(n - 1);
+      server.close();
+      const after = binding.getBIOBufferPoolStats();
+      assert(after.hits > before.hits);
+      assert(after.retained <= 256 * 16 * 1024);
+    });
+  }));
+}
+
+server.listen(0, common.mustCall(function() {
+  connect(CONNECTIONS);
+}));
@@ -0,0 +1,49 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+
+if (!common.hasCrypto) {
+  common.skip('missing crypto');
+  return;
+}
+
+const tls = require('tls');
+const fs = require('fs');
+const path = require('path');
+
+function loadKey(name) {
+  return fs.readFileSync(path.join(common.fixturesDir, 'keys', name));
+}
+
+const server = tls.createServer({
+  key: loadKey('agent1-key.pem'),
+  cert: loadKey('agent1-cert.pem')
+}, (socket) => socket.end());
+
+// Each entry gives the options of a connection and whether it resumes the
+// session of an earlier one.
+const connections = [
+  [{ sessionCache: true }, false],
+  [{ sessionCache: true }, true],
+  [{ sessionCache: true, ciphers: 'AES128-SHA256' }, false],
+  [{}, false],
+  [{ sessionCache: true }, true]
+];
+
+function connect(i) {
+  if (i === connections.length)
+    return server.close();
+
+  const options = Object.assign({
+    port: server.address().port,
+    rejectUnauthorized: false
+  }, connections[i][0]);
+
+  const socket = tls.connect(options, common.mustCall(() => {
+    assert.strictEqual(socket.isSessionReused(), connections[i][1]);
+  }));
+  socket.on('close', common.mustCall(() => connect(i + 1)));
+  socket.resume();
+}
+
+server.listen(0, common.mustCall(() => connect(0)));
@@ -0,0 +1,29 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+
+if (!common.hasCrypto) {
+  common.skip('missing crypto');
+  return;
+}
+
+const tls = require('tls');
+const fs = require('fs');
+
+const key = fs.readFileSync(common.fixturesDir + '/keys/agent1-key.pem');
+const cert = fs.readFileSync(common.fixturesDir + '/keys/agent1-cert.pem');
+
+// OpenSSL reports why it could not load the engine as a shared library.
+assert.throws(() => {
+  tls.createSecureContext({ key, cert, engine: 'no-such-engine' });
+}, Error);
+
+// The engine has to come before the key.
+const context = tls.createSecureContext({ key, cert });
+assert.strictEqual(context.context.getEngineStats(), null);
+assert.throws(() => {
+  context.context.setEngine('no-such-engine');
+}, /Error: The engine must be set before the private key/);
+
+const server = tls.createServer({ key, cert });
+assert.strictEqual(server.getEngineStats(), null);
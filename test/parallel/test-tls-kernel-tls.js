@@ -0,0 +1,57 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+
+if (!common.hasCrypto) {
+  common.skip('missing crypto');
+  return;
+}
+
+const tls = require('tls');
+const fs = require('fs');
+const path = require('path');
+
+function loadKey(name) {
+  return fs.readFileSync(path.join(common.fixturesDir, 'keys', name));
+}
+
+// Whether the kernel does the encryption or not, the data has to arrive
+// intact in both directions.
+const big = Buffer.alloc(1024 * 1024);
+for (var i = 0; i < big.length; i++)
+  big[i] = i % 251;
+
+function collect(socket, cb) {
+  const chunks = [];
+  socket.on('data', (chunk) => chunks.push(chunk));
+  socket.on('end', common.mustCall(() => cb(Buffer.concat(chunks))));
+}
+
+const server = tls.createServer({
+  key: loadKey('agent1-key.pem'),
+  cert: loadKey('agent1-cert.pem'),
+  ciphers: 'ECDHE-RSA-AES128-GCM-SHA256',
+  kernelTLS: true
+}, common.mustCall((socket) => {
+  socket.write(big.slice(0, 1000));
+  socket.end(big.slice(1000));
+  collect(socket, (data) => {
+    assert(data.equals(big));
+    if (process.platform !== 'linux')
+      assert.strictEqual(socket.isKernelTLS(), false);
+    server.close();
+  });
+}));
+
+server.listen(0, common.mustCall(() => {
+  const client = tls.connect({
+    port: server.address().port,
+    rejectUnauthorized: false,
+    kernelTLS: true
+  }, common.mustCall(() => {
+    client.end(big);
+  }));
+  collect(client, (data) => {
+    assert(data.equals(big));
+  });
+}));
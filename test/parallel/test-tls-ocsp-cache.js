@@ -0,0 +1,59 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+
+if (!process.features.tls_ocsp) {
+  common.skip('node compiled without OpenSSL or with old OpenSSL version.');
+  return;
+}
+
+if (!common.hasCrypto) {
+  common.skip('missing crypto');
+  return;
+}
+
+const tls = require('tls');
+const fs = require('fs');
+const path = require('path');
+
+function loadKey(name) {
+  return fs.readFileSync(path.join(common.fixturesDir, 'keys', name));
+}
+
+assert.throws(() => tls.createServer({ fetchOCSP: 'x' }), TypeError);
+
+// The response is fetched once and stapled to every handshake that asks for
+// it.
+const server = tls.createServer({
+  key: loadKey('agent1-key.pem'),
+  cert: loadKey('agent1-cert.pem'),
+  ca: loadKey('ca1-cert.pem'),
+  fetchOCSP: common.mustCall((cert, issuer, callback) => {
+    assert(Buffer.isBuffer(cert));
+    assert(Buffer.isBuffer(issuer));
+    setImmediate(() => callback(null, Buffer.from('cached'), 60 * 1000));
+  })
+}, (socket) => socket.end());
+
+function connect(count) {
+  const socket = tls.connect({
+    port: server.address().port,
+    requestOCSP: true,
+    rejectUnauthorized: false
+  });
+  socket.on('OCSPResponse', common.mustCall((response) => {
+    assert.strictEqual(response.toString(), 'cached');
+  }));
+  socket.on('close', common.mustCall(() => {
+    if (count > 1)
+      connect(count - 1);
+    else
+      server.close();
+  }));
+  socket.resume();
+}
+
+server.listen(0, common.mustCall(() => {
+  // Wait for the response to be in the cache.
+  setTimeout(() => connect(3), common.platformTimeout(50));
+}));
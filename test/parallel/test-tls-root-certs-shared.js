@@ -0,0 +1,43 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+
+if (!common.hasCrypto) {
+  common.skip('missing crypto');
+  return;
+}
+
+const tls = require('tls');
+const fs = require('fs');
+const path = require('path');
+
+function loadKey(name) {
+  return fs.readFileSync(path.join(common.fixturesDir, 'keys', name));
+}
+
+// The CA certificate in the PFX is added to the store of the server's
+// context, which also uses the root certificates.  The other contexts that
+// use the root certificates must not trust it too.
+const server = tls.createServer({
+  pfx: loadKey('agent1-pfx.pem'),
+  passphrase: 'sample'
+}, (socket) => socket.end());
+
+server.listen(0, common.mustCall(() => {
+  const port = server.address().port;
+
+  tls.connect({ port: port, servername: 'agent1' })
+    .on('secureConnect', common.fail)
+    .on('error', common.mustCall((err) => {
+      assert.strictEqual(err.code, 'UNABLE_TO_VERIFY_LEAF_SIGNATURE');
+
+      const socket = tls.connect({
+        port: port,
+        servername: 'agent1',
+        ca: loadKey('ca1-cert.pem')
+      }, common.mustCall(() => {
+        socket.end();
+        server.close();
+      }));
+    }));
+}));
@@ -0,0 +1,83 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+
+if (!common.hasCrypto) {
+  common.skip('missing crypto');
+  return;
+}
+const tls = require('tls');
+const fs = require('fs');
+const crypto = require('crypto');
+const constants = require('constants');
+
+const options = {
+  key: fs.readFileSync(common.fixturesDir + '/keys/agent1-key.pem'),
+  cert: fs.readFileSync(common.fixturesDir + '/keys/agent1-cert.pem')
+};
+
+function connect(server, session, cb) {
+  const client = tls.connect({
+    port: server.address().port,
+    rejectUnauthorized: false,
+    session: session
+  }, function() {
+    const reused = client.isSessionReused();
+    const newSession = client.getSession();
+    client.end();
+    client.on('close', function() {
+      cb(reused, newSession);
+    });
+  });
+  client.resume();
+}
+
+assert.throws(function() {
+  tls.createServer(Object.assign({ ticketKeyRotation: 'x' }, options));
+}, /^TypeError: ticketKeyRotation must be a number$/);
+
+// Session ID based resumption through the built-in cache.
+{
+  const server = tls.createServer(Object.assign({
+    sessionCache: true,
+    secureOptions: constants.SSL_OP_NO_TICKET
+  }, options), function(socket) {
+    socket.end();
+  });
+  server.listen(0, common.mustCall(function() {
+    connect(server, undefined, common.mustCall(function(reused, session) {
+      assert.strictEqual(reused, false);
+      connect(server, session, common.mustCall(function(reused) {
+        assert.strictEqual(reused, true);
+        server.close();
+      }));
+    }));
+  }));
+}
+
+// Tickets issued with the previous keys are accepted after a rotation, older
+// ones are not.
+{
+  const server = tls.createServer(Object.assign({
+    ticketKeyRotation: 60 * 60 * 1000
+  }, options), function(socket) {
+    socket.end();
+  });
+  const context = server._sharedCreds.context;
+  server.listen(0, common.mustCall(function() {
+    connect(server, undefined, common.mustCall(function(reused, session) {
+      const keys = server.getTicketKeys();
+      context.rotateTicketKeys(crypto.randomBytes(48));
+      assert(!server.getTicketKeys().equals(keys));
+      connect(server, session, common.mustCall(function(reused) {
+        assert.strictEqual(reused, true);
+        context.rotateTicketKeys(crypto.randomBytes(48));
+        context.rotateTicketKeys(crypto.randomBytes(48));
+        connect(server, session, common.mustCall(function(reused) {
+          assert.strictEqual(reused, false);
+          server.close();
+        }));
+      }));
+    }));
+  }));
+}
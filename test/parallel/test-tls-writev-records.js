@@ -0,0 +1,55 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+
+if (!common.hasCrypto) {
+  common.skip('missing crypto');
+  return;
+}
+const tls = require('tls');
+const fs = require('fs');
+
+// The buffers of a writev() are gathered into as few TLS records as
+// possible.  Every record is decrypted separately on the receiving side so
+// the number of 'data' events on the server is an upper bound for the number
+// of records that the client sent.
+
+const CHUNKS = 1000;
+
+const options = {
+  key: fs.readFileSync(common.fixturesDir + '/keys/agent1-key.pem'),
+  cert: fs.readFileSync(common.fixturesDir + '/keys/agent1-cert.pem')
+};
+
+const expected = [];
+for (let i = 0; i < CHUNKS; i++)
+  expected.push(Buffer.from(`${i},`));
+// One buffer that is larger than a record on its own.
+expected.push(Buffer.alloc(40000, 'x'));
+
+const server = tls.createServer(options, common.mustCall(function(socket) {
+  const received = [];
+  socket.on('data', function(chunk) {
+    received.push(chunk);
+  });
+  socket.on('end', common.mustCall(function() {
+    assert(Buffer.concat(received).equals(Buffer.concat(expected)));
+    assert(received.length < CHUNKS / 10);
+    socket.end();
+    server.close();
+  }));
+}));
+
+server.listen(0, common.mustCall(function() {
+  const client = tls.connect({
+    port: this.address().port,
+    rejectUnauthorized: false
+  }, common.mustCall(function() {
+    client.cork();
+    for (const chunk of expected)
+      client.write(chunk);
+    client.uncork();
+    client.end();
+  }));
+  client.resume();
+}));
@@ -0,0 +1,57 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const child_process = require('child_process');
+const fs = require('fs');
+const path = require('path');
+
+common.refreshTmpDir();
+const traceFile = path.join(common.tmpDir, 'node_trace.1.log');
+
+const code = 'require("fs").stat(".", () => {}); ' +
+             'for (var i = 0; i < 1e5; i++) new Array(100);';
+
+// node.dns and node.http are left out.
+const args = ['--trace-events-enabled',
+              '--trace-event-categories', 'v8,node.fs,node.bootstrap',
+              '-e', code];
+const options = { cwd: common.tmpDir };
+child_process.execFile(process.execPath, args, options,
+                       common.mustCall(function(err, stdout, stderr) {
+                         assert.ifError(err);
+                         checkTrace();
+                         checkDisabled();
+                       }));
+
+function checkTrace() {
+  const events = JSON.parse(fs.readFileSync(traceFile)).traceEvents;
+  assert(events.length > 0);
+  events.forEach(function(event) {
+    assert.strictEqual(typeof event.pid, 'number');
+    assert.strictEqual(typeof event.tid, 'number');
+    assert.strictEqual(typeof event.ts, 'number');
+    assert.strictEqual(typeof event.name, 'string');
+    assert.notStrictEqual(event.cat, 'node.dns');
+  });
+
+  const bootstrap = events.filter((e) => e.cat === 'node.bootstrap');
+  assert.deepStrictEqual(bootstrap.map((e) => e.ph), ['B', 'E']);
+  assert(bootstrap[0].ts <= bootstrap[1].ts);
+
+  const stat = events.filter((e) => e.cat === 'node.fs' && e.name === 'stat');
+  assert.deepStrictEqual(stat.map((e) => e.ph), ['b', 'e']);
+  assert.strictEqual(stat[0].id, stat[1].id);
+
+  // The allocations above are enough for V8 to collect garbage.
+  assert(events.some((e) => /\bv8\b/.test(e.cat)));
+}
+
+// No file without --trace-events-enabled.
+function checkDisabled() {
+  fs.unlinkSync(traceFile);
+  child_process.execFile(process.execPath, ['-e', code], options,
+                         common.mustCall(function(err) {
+                           assert.ifError(err);
+                           assert.throws(() => fs.statSync(traceFile));
+                         }));
+}
@@ -0,0 +1,37 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const child_process = require('child_process');
+
+const time = '-?\\d+\\.\\d{3} ms';
+const moduleLine = new RegExp(
+  `^\\[startup\\] +([\\w/]+): compile ${time}, evaluate ${time}$`);
+const bootstrapLine = new RegExp(
+  `^\\[startup\\] bootstrap: ${time}, \\d+ modules and bindings$`);
+
+const args = ['--trace-startup', '-e', 'require("fs")'];
+child_process.execFile(process.execPath, args, common.mustCall(onexit));
+
+function onexit(err, stdout, stderr) {
+  assert.ifError(err);
+  const lines = stderr.trim().split('\n');
+  const modules = [];
+  lines.forEach(function(line) {
+    if (bootstrapLine.test(line)) return;
+    const match = line.match(moduleLine);
+    assert(match, `unexpected line: ${line}`);
+    modules.push(match[1]);
+  });
+  assert.strictEqual(lines.filter((l) => bootstrapLine.test(l)).length, 1);
+  assert.notStrictEqual(modules.indexOf('events'), -1);
+  assert.notStrictEqual(modules.indexOf('fs'), -1);
+  // Each module is only reported once.
+  assert.strictEqual(new Set(modules).size, modules.length);
+}
+
+// Nothing is printed without the flag.
+child_process.execFile(process.execPath, ['-e', 'require("fs")'],
+                       common.mustCall(function(err, stdout, stderr) {
+                         assert.ifError(err);
+                         assert.strictEqual(stderr, '');
+                       }));
@@ -0,0 +1,131 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const http = require('http');
+const util = require('util');
+
+const doc = {
+  string: 'a"b\\c/\n\té\u2028\ud83d\ude00\u0001',
+  numbers: [0, -0, 1, -12, 3.25, 1e300, -2.5e-7, 123456789012345678, 0.1],
+  literals: [true, false, null],
+  nested: { a: [{ b: [] }, {}], '0': 'zero', '': 'empty' }
+};
+Object.defineProperty(doc, '__proto__', {
+  value: { own: true },
+  enumerable: true
+});
+const text = JSON.stringify(doc, null, 1) + '\n';
+const expected = JSON.parse(text);
+
+function parse(chunks, options, cb) {
+  const parser = new util.JSONParser(options);
+  parser.on('value', common.mustCall((value) => {
+    assert.strictEqual(parser.value, value);
+    cb(null, value);
+  }));
+  parser.on('error', cb);
+  chunks.forEach((chunk) => parser.write(chunk));
+  parser.end();
+}
+
+function check(value) {
+  assert.deepStrictEqual(value, expected);
+  assert.strictEqual(Object.getPrototypeOf(value), Object.prototype);
+  assert(Object.prototype.hasOwnProperty.call(value, '__proto__'));
+  assert.strictEqual(1 / value.numbers[1], -Infinity);
+}
+
+// Every chunk size, so that each token is split somewhere.
+const bytes = Buffer.from(text);
+[1, 2, 3, 7, bytes.length].forEach((size) => {
+  const chunks = [];
+  for (var i = 0; i < bytes.length; i += size)
+    chunks.push(bytes.slice(i, i + size));
+  parse(chunks, {}, common.mustCall((err, value) => {
+    assert.ifError(err);
+    check(value);
+  }));
+});
+
+// Strings are written as UTF-8.
+parse(['[1, "é', '"]'], {}, common.mustCall((err, value) => {
+  assert.ifError(err);
+  assert.deepStrictEqual(value, [1, 'é']);
+}));
+
+// Escapes, also of lone surrogates, mixed with other characters.
+parse(['"é\\u00e9\\ud83d\\ude00\\ud800\\n\ud83d\ude00"'], {},
+      common.mustCall((err, value) => {
+        assert.ifError(err);
+        assert.strictEqual(value, 'éé\ud83d\ude00\ud800\n\ud83d\ude00');
+      }));
+
+// A number at the top level ends with the input.
+parse(['12', '34'], {}, common.mustCall((err, value) => {
+  assert.ifError(err);
+  assert.strictEqual(value, 1234);
+}));
+
+[
+  ['{"a":1,}', 'Unexpected token } in JSON at position 7'],
+  ['[1 2]', 'Unexpected token 2 in JSON at position 3'],
+  ['01', 'Unexpected token 1 in JSON at position 1'],
+  ['"\\x"', 'Unexpected token x in JSON at position 2'],
+  ['"a\nb"', 'Unexpected byte 0x0a in JSON at position 2'],
+  ['[1] [2]', 'Unexpected token [ in JSON at position 4'],
+  ['[tru', 'Unexpected end of JSON input'],
+  ['1.', 'Unexpected end of JSON input'],
+  ['', 'Unexpected end of JSON input']
+].forEach((test) => {
+  const parser = new util.JSONParser();
+  parser.on('value', common.fail);
+  parser.on('error', common.mustCall((err) => {
+    assert(err instanceof SyntaxError);
+    assert.strictEqual(err.message, test[1]);
+  }));
+  for (var i = 0; i < test[0].length; i++)
+    parser.write(test[0][i]);
+  parser.end();
+});
+
+// Large chunks are scanned on the threadpool.
+const big = [];
+for (var i = 0; i < 2000; i++)
+  big.push({ id: i, name: `item ${i} é`, tags: ['a', 'b'], doc: doc });
+const bigText = Buffer.from(JSON.stringify(big));
+parse([bigText.slice(0, 40000), bigText.slice(40000)], { threadpool: true },
+      common.mustCall((err, value) => {
+        assert.ifError(err);
+        assert.deepStrictEqual(value, JSON.parse(bigText.toString()));
+      }));
+
+const badText = Buffer.concat([bigText.slice(0, 30000), Buffer.from([1])]);
+parse([badText, bigText.slice(30000)], { threadpool: true },
+      common.mustCall((err) => {
+        assert(err instanceof SyntaxError);
+        assert.strictEqual(err.message,
+                           'Unexpected byte 0x01 in JSON at position 30000');
+      }));
+
+// Request bodies can be piped into the parser.
+const server = http.createServer(common.mustCall((req, res) => {
+  const parser = new util.JSONParser({ threadpool: true });
+  parser.on('value', common.mustCall((value) => {
+    check(value);
+    res.end('ok');
+  }));
+  req.pipe(parser);
+}));
+
+server.listen(0, common.mustCall(() => {
+  const req = http.request({
+    port: server.address().port,
+    method: 'POST'
+  }, common.mustCall((res) => {
+    res.resume();
+    res.on('end', common.mustCall(() => server.close()));
+  }));
+  for (var i = 0; i < bytes.length; i += 5)
+    req.write(bytes.slice(i, i + 5));
+  req.end();
+}));
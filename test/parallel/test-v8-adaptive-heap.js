@@ -0,0 +1,31 @@
+// Flags: --adaptive-heap
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const execFile = require('child_process').execFile;
+const v8 = require('v8');
+
+const initial = v8.getAdaptiveHeapStatistics();
+assert.strictEqual(typeof initial.fastGrowth, 'boolean');
+
+// Enough short-lived garbage, with a bit that survives, for many scavenges.
+const kept = [];
+for (var i = 0; i < 2e6; i++) {
+  const obj = { index: i, payload: [i, i + 1, i + 2] };
+  if (i % 1000 === 0)
+    kept.push(obj);
+}
+assert.strictEqual(kept.length, 2000);
+
+const stats = v8.getAdaptiveHeapStatistics();
+assert(stats.scavenges > initial.scavenges);
+assert(stats.scavengeOverhead >= 0 && stats.scavengeOverhead <= 1);
+assert(stats.promotionRate >= 0 && stats.promotionRate <= 1);
+assert(stats.newSpaceSize > 0);
+
+execFile(process.execPath, [
+  '-p', 'require("v8").getAdaptiveHeapStatistics()'
+], common.mustCall((err, stdout) => {
+  assert.ifError(err);
+  assert.strictEqual(stdout.trim(), 'null');
+}));
@@ -0,0 +1,34 @@
+'use strict';
+require('../common');
+const assert = require('assert');
+const v8 = require('v8');
+
+const keys = [
+  'cached_size',
+  'free_size',
+  'mapped_size',
+  'released_size',
+  'reserved_size',
+  'used_size'
+];
+
+const before = v8.getBufferArenaStatistics();
+assert.deepStrictEqual(Object.keys(before).sort(), keys);
+keys.forEach((key) => assert.strictEqual(typeof before[key], 'number'));
+
+// The address space can be reserved on all the platforms that run the tests.
+assert(before.reserved_size > 0);
+
+// Backing stores of up to 64 KB come from the arena, rounded up to a power
+// of two.  Larger ones do not.
+const buffers = [];
+for (let i = 0; i < 100; i++)
+  buffers.push(Buffer.alloc(1000));
+buffers.push(Buffer.alloc(1024 * 1024));
+
+const after = v8.getBufferArenaStatistics();
+assert(after.used_size - before.used_size >= 100 * 1024);
+assert(after.used_size - before.used_size < 1024 * 1024);
+assert(after.mapped_size >= after.used_size + after.cached_size);
+assert(after.mapped_size <= after.reserved_size);
+assert.strictEqual(buffers[0].length, 1000);
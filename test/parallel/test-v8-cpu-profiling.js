@@ -0,0 +1,45 @@
+'use strict';
+require('../common');
+const assert = require('assert');
+const v8 = require('v8');
+
+assert.throws(() => v8.stopProfiling(), /not running/);
+assert.throws(() => v8.startProfiling(0), TypeError);
+assert.throws(() => v8.startProfiling(1.5), TypeError);
+assert.throws(() => v8.startProfiling('100'), TypeError);
+
+function fib(n) {
+  return n < 2 ? n : fib(n - 1) + fib(n - 2);
+}
+
+v8.startProfiling(100);
+assert.throws(() => v8.startProfiling(), /already running/);
+
+const end = Date.now() + 100;
+while (Date.now() < end)
+  fib(20);
+
+const buffer = v8.stopProfiling();
+assert(buffer instanceof Buffer);
+const profile = JSON.parse(buffer.toString());
+
+assert(profile.endTime >= profile.startTime);
+assert.strictEqual(profile.samples.length, profile.timeDeltas.length);
+assert(profile.samples.length > 0);
+
+const ids = new Set();
+for (const node of profile.nodes) {
+  assert.strictEqual(typeof node.id, 'number');
+  assert.strictEqual(typeof node.hitCount, 'number');
+  assert(Array.isArray(node.children));
+  assert.strictEqual(typeof node.callFrame.functionName, 'string');
+  ids.add(node.id);
+}
+assert.strictEqual(profile.nodes[0].callFrame.functionName, '(root)');
+for (const id of profile.samples)
+  assert(ids.has(id));
+assert(profile.nodes.some((node) => node.callFrame.functionName === 'fib'));
+
+// A new profile can be started after the previous one was stopped.
+v8.startProfiling();
+assert(JSON.parse(v8.stopProfiling()).nodes.length > 0);
@@ -0,0 +1,66 @@
+// Flags: --expose-gc
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const v8 = require('v8');
+
+const types = [
+  'scavenge',
+  'markSweepCompact',
+  'incrementalMarking',
+  'processWeakCallbacks'
+];
+
+assert.throws(() => v8.stopGCTracking(), /not running/);
+assert.throws(() => v8.startGCTracking('abc'), TypeError);
+
+v8.resetGCStatistics();
+assert.deepStrictEqual(Object.keys(v8.getGCStatistics()), types);
+
+// Nothing is counted while tracking is stopped.
+global.gc();
+assert.strictEqual(v8.getGCStatistics().markSweepCompact.count, 0);
+
+const pauses = [];
+v8.startGCTracking((batch) => {
+  assert(batch.length > 0);
+  pauses.push(...batch);
+});
+assert.throws(() => v8.startGCTracking(), /already running/);
+
+let garbage = [];
+for (let i = 0; i < 1e5; i++)
+  garbage.push({ i });
+garbage = null;
+global.gc();
+
+const stats = v8.getGCStatistics();
+const full = stats.markSweepCompact;
+assert(full.count >= 1);
+assert(full.duration >= full.maxDuration);
+assert(full.maxDuration >= 0);
+assert(full.freed > 0);
+
+// The pauses are delivered later, in one batch, never from inside the GC.
+assert.strictEqual(pauses.length, 0);
+
+setImmediate(common.mustCall(() => {
+  assert(pauses.length > 0);
+  let total = 0;
+  for (const pause of pauses) {
+    assert(types.includes(pause.type));
+    assert(pause.startTime > 0);
+    assert(pause.duration >= 0);
+    assert(pause.freed >= 0);
+    total += pause.type === 'markSweepCompact' ? 1 : 0;
+  }
+  assert.strictEqual(total, full.count);
+
+  v8.stopGCTracking();
+  global.gc();
+  assert.strictEqual(v8.getGCStatistics().markSweepCompact.count, full.count);
+
+  v8.resetGCStatistics();
+  for (const type of types)
+    assert.strictEqual(v8.getGCStatistics()[type].count, 0);
+}));
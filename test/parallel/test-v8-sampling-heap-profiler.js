@@ -0,0 +1,38 @@
+'use strict';
+require('../common');
+const assert = require('assert');
+const v8 = require('v8');
+
+assert.throws(() => v8.getSamplingHeapProfile(), /not running/);
+assert.throws(() => v8.stopSamplingHeapProfiler(), /not running/);
+assert.throws(() => v8.startSamplingHeapProfiler(0), TypeError);
+assert.throws(() => v8.startSamplingHeapProfiler(1024, -1), TypeError);
+
+v8.startSamplingHeapProfiler(1024);
+assert.throws(() => v8.startSamplingHeapProfiler(), /already running/);
+
+const retained = [];
+function allocate() {
+  for (let i = 0; i < 1e4; i++)
+    retained.push({ i, s: 'x' + i });
+}
+allocate();
+
+function selfSizes(node, sizes) {
+  assert.strictEqual(typeof node.selfSize, 'number');
+  assert.strictEqual(typeof node.callFrame.functionName, 'string');
+  assert(Array.isArray(node.children));
+  sizes[node.callFrame.functionName] =
+      (sizes[node.callFrame.functionName] || 0) + node.selfSize;
+  for (const child of node.children)
+    selfSizes(child, sizes);
+  return sizes;
+}
+
+const running = JSON.parse(v8.getSamplingHeapProfile());
+assert(selfSizes(running.head, {}).allocate > 0);
+
+const final = JSON.parse(v8.stopSamplingHeapProfiler());
+assert(selfSizes(final.head, {}).allocate > 0);
+assert.throws(() => v8.getSamplingHeapProfile(), /not running/);
+assert(retained.length > 0);
@@ -0,0 +1,24 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const child_process = require('child_process');
+
+// Garbage collections hand sweeping to background tasks while file system
+// requests use the same, single, thread.
+const code = 'const fs = require("fs");' +
+             'var pending = 100;' +
+             'for (var i = 0; i < 100; i++) {' +
+             '  fs.stat(".", function() {' +
+             '    for (var j = 0; j < 1e4; j++) new Array(100);' +
+             '    gc();' +
+             '    if (--pending === 0) console.log("done");' +
+             '  });' +
+             '}';
+const args = ['--v8-shared-threadpool', '--expose-gc', '-e', code];
+const env = Object.assign({}, process.env, { UV_THREADPOOL_SIZE: '1' });
+child_process.execFile(process.execPath, args, { env: env },
+                       common.mustCall(function(err, stdout, stderr) {
+                         assert.ifError(err);
+                         assert.strictEqual(stdout, 'done\n');
+                         assert.strictEqual(stderr, '');
+                       }));
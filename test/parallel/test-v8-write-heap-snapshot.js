@@ -0,0 +1,31 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const fs = require('fs');
+const path = require('path');
+const v8 = require('v8');
+
+common.refreshTmpDir();
+const file = path.join(common.tmpDir, 'test.heapsnapshot');
+
+class HeapSnapshotMarker {}
+const marker = new HeapSnapshotMarker();
+
+const fd = fs.openSync(file, 'w');
+v8.writeHeapSnapshot(fd);
+fs.closeSync(fd);
+
+const snapshot = JSON.parse(fs.readFileSync(file, 'utf8'));
+assert(snapshot.snapshot.meta);
+assert(snapshot.snapshot.node_count > 0);
+assert(Array.isArray(snapshot.nodes));
+assert(snapshot.strings.includes('HeapSnapshotMarker'));
+assert(marker);
+
+assert.throws(() => v8.writeHeapSnapshot('1'), TypeError);
+assert.throws(() => v8.writeHeapSnapshot(-1), TypeError);
+
+// Errors while writing are thrown.
+const readOnly = fs.openSync(file, 'r');
+assert.throws(() => v8.writeHeapSnapshot(readOnly), /EBADF|EACCES|EPERM/);
+fs.closeSync(readOnly);
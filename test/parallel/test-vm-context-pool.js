@@ -0,0 +1,45 @@
+'use strict';
+require('../common');
+const assert = require('assert');
+const vm = require('vm');
+
+const pool = new vm.ContextPool({ max: 1 });
+const script = new vm.Script('(function() { x = a + 1; })()');
+
+// A released context is used again for the next sandbox.
+const first = pool.acquire({ a: 1 });
+assert(vm.isContext(first));
+script.runInContext(first);
+assert.strictEqual(first.x, 2);
+const firstArray = vm.runInContext('Array', first);
+const defineHidden =
+    'Object.defineProperty(this, "hidden", { value: 1, configurable: true })';
+vm.runInContext(defineHidden, first);
+pool.release(first);
+assert.strictEqual(vm.isContext(first), false);
+assert.strictEqual(first.x, 2);
+
+const second = pool.acquire({ a: 5 });
+assert.strictEqual(vm.runInContext('Array', second), firstArray);
+assert.strictEqual(vm.runInContext('typeof x', second), 'undefined');
+assert.strictEqual(vm.runInContext('typeof hidden', second), 'undefined');
+script.runInContext(second);
+assert.strictEqual(second.x, 6);
+
+// A top-level var can't be deleted, so the context is not reused.
+vm.runInContext('var leaked = 1', second);
+pool.release(second);
+const third = pool.acquire();
+assert.notStrictEqual(vm.runInContext('Array', third), firstArray);
+assert.strictEqual(vm.runInContext('typeof leaked', third), 'undefined');
+
+// A released sandbox can be contextified again.
+pool.release(third);
+vm.createContext(third);
+assert.strictEqual(vm.runInContext('typeof Array', third), 'function');
+
+assert.throws(() => pool.release({}), TypeError);
+assert.throws(() => pool.release(third), TypeError);
+assert.throws(() => pool.acquire(third), /already a context/);
+assert.throws(() => pool.acquire(42), TypeError);
+assert.throws(() => new vm.ContextPool({ max: -1 }), TypeError);
@@ -0,0 +1,31 @@
+'use strict';
+require('../common');
+const assert = require('assert');
+const vm = require('vm');
+
+const sandbox = { n: 2, list: [1, 2] };
+sandbox.self = sandbox;
+assert.strictEqual(vm.createContext(sandbox, { frozen: true }), sandbox);
+assert(vm.isContext(sandbox));
+
+// The sandbox's properties were copied, the objects are shared.
+assert.strictEqual(vm.runInContext('n', sandbox), 2);
+assert.strictEqual(vm.runInContext('list', sandbox), sandbox.list);
+assert.strictEqual(vm.runInContext('self === this', sandbox), true);
+assert.strictEqual(vm.runInContext('typeof Array', sandbox), 'function');
+
+// Writes stay in the context.
+vm.runInContext('n = 3; var declared = 4; created = 5', sandbox);
+assert.strictEqual(sandbox.n, 2);
+assert.strictEqual(sandbox.declared, undefined);
+assert.strictEqual(sandbox.created, undefined);
+assert.strictEqual(vm.runInContext('n + declared + created', sandbox), 12);
+
+// Later changes to the sandbox are not seen.
+sandbox.late = true;
+assert.strictEqual(vm.runInContext('typeof late', sandbox), 'undefined');
+
+// Without the option, writes are copied back as before.
+const plain = vm.createContext({ n: 2 }, { frozen: false });
+vm.runInContext('n = 3', plain);
+assert.strictEqual(plain.n, 3);
@@ -0,0 +1,54 @@
+'use strict';
+require('../common');
+const assert = require('assert');
+const vm = require('vm');
+const binding = process.binding('contextify');
+
+function stats() {
+  return binding.scriptCacheStats();
+}
+
+const code = 'typeof x === "number" ? x * 2 : "no x"';
+
+// The second compilation is a lookup and runs the same in every context.
+const before = stats();
+const first = new vm.Script(code, { filename: 'cached.js' });
+const second = new vm.Script(code, { filename: 'cached.js' });
+assert.strictEqual(stats().hits, before.hits + 1);
+assert.notStrictEqual(first, second);
+assert.strictEqual(first.runInNewContext({ x: 2 }), 4);
+assert.strictEqual(second.runInNewContext({ x: 3 }), 6);
+assert.strictEqual(second.runInNewContext({}), 'no x');
+
+// A different origin is a separate entry, so that stack traces are right.
+const hits = stats().hits;
+const other = new vm.Script('throw new Error()', { filename: 'other.js',
+                                                  lineOffset: 10 });
+new vm.Script('throw new Error()', { filename: 'other.js' });
+new vm.Script(code, { filename: 'cached.js', columnOffset: 1 });
+assert.strictEqual(stats().hits, hits);
+assert.throws(() => other.runInThisContext(), function(err) {
+  return /other\.js:11/.test(err.stack);
+});
+
+// The code cache is produced once and then comes from the cache.
+const source = 'function f() { return 42; } f()';
+const produced = new vm.Script(source, { produceCachedData: true });
+assert.strictEqual(produced.cachedDataProduced, true);
+const again = new vm.Script(source, { produceCachedData: true });
+assert.strictEqual(again.cachedDataProduced, true);
+assert.deepStrictEqual(again.cachedData, produced.cachedData);
+assert.strictEqual(again.runInThisContext(), 42);
+
+// Passed in code caches still go through V8.
+const consumed = new vm.Script(source, { cachedData: produced.cachedData });
+assert.strictEqual(consumed.cachedDataRejected, false);
+
+// Syntax errors aren't cached.
+assert.throws(() => new vm.Script('{'), SyntaxError);
+assert.throws(() => new vm.Script('{'), SyntaxError);
+
+// The cache is bounded.
+for (var i = 0; i < 1000; i++)
+  new vm.Script(`${i}`);
+assert(stats().size <= 128);
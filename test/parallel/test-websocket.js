@@ -0,0 +1,172 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+
+if (!common.hasCrypto) {
+  common.skip('missing crypto');
+  return;
+}
+
+const crypto = require('crypto');
+const http = require('http');
+const net = require('net');
+const websocket = require('websocket');
+
+const text = 'h\u00e9llo w\u00f6rld';
+// Sent as it is, with a 64-bit length, and echoed compressed.
+const big = Buffer.alloc(300 * 1024, 'abc');
+
+const server = http.createServer(common.fail);
+server.on('upgrade', common.mustCall((req, socket, head) => {
+  const ws = websocket.upgrade(req, socket, head, {
+    perMessageDeflate: true,
+    maxPayload: 1024 * 1024
+  });
+  if (req.url === '/raw') {
+    assert.strictEqual(ws.perMessageDeflate, false);
+    ws.on('message', common.mustCall((data, isBinary) => {
+      assert.strictEqual(data, 'Hello');
+      assert.strictEqual(isBinary, false);
+      ws.send(data);
+    }));
+    ws.on('ping', common.mustCall((data) => {
+      assert.strictEqual(data.toString(), 'p');
+    }));
+    // The client doesn't mask its last frame.
+    ws.on('error', common.mustCall((err) => {
+      assert.strictEqual(err.closeCode, 1002);
+    }));
+    ws.on('close', common.mustCall((code) => {
+      assert.strictEqual(code, 1002);
+    }));
+    return;
+  }
+
+  assert.strictEqual(ws.perMessageDeflate, true);
+  ws.on('message', common.mustCall((data, isBinary) => {
+    if (data === 'close')
+      return ws.close(4000, 'bye');
+    ws.send(data, { binary: isBinary });
+  }, 3));
+  ws.on('close', common.mustCall((code, reason) => {
+    assert.strictEqual(code, 4000);
+    assert.strictEqual(reason, 'bye');
+  }));
+}, 2));
+
+server.listen(0, common.mustCall(() => {
+  const port = server.address().port;
+  connectClient(port);
+  connectRaw(port);
+}));
+
+var pending = 2;
+function done() {
+  if (--pending === 0)
+    server.close();
+}
+
+function connectClient(port) {
+  const key = crypto.randomBytes(16).toString('base64');
+  const req = http.request({
+    port: port,
+    headers: {
+      'Connection': 'Upgrade',
+      'Upgrade': 'websocket',
+      'Sec-WebSocket-Version': '13',
+      'Sec-WebSocket-Key': key,
+      'Sec-WebSocket-Extensions': 'permessage-deflate; client_max_window_bits'
+    }
+  });
+  req.on('upgrade', common.mustCall((res, socket, head) => {
+    const accept = crypto.createHash('sha1')
+        .update(key + '258EAFA5-E914-47DA-95CA-C5AB0DC85B11')
+        .digest('base64');
+    assert.strictEqual(res.headers['sec-websocket-accept'], accept);
+    assert(/^permessage-deflate/.test(res.headers['sec-websocket-extensions']));
+
+    const ws = new websocket.WebSocket(socket, {
+      client: true,
+      perMessageDeflate: true,
+      head: head
+    });
+    const received = [];
+    ws.on('message', (data, isBinary) => {
+      received.push(data);
+      if (received.length === 2) {
+        assert.strictEqual(received[0], text);
+        assert.strictEqual(isBinary, true);
+        assert(received[1].equals(big));
+        ws.ping('are you there');
+      }
+    });
+    ws.on('pong', common.mustCall((data) => {
+      assert.strictEqual(data.toString(), 'are you there');
+      ws.send('close');
+    }));
+    ws.on('close', common.mustCall((code, reason) => {
+      assert.strictEqual(code, 4000);
+      assert.strictEqual(reason, 'bye');
+      assert.strictEqual(received.length, 2);
+      done();
+    }));
+    ws.send(text);
+    ws.send(big, { compress: false });
+  }));
+  req.end();
+}
+
+function frame(opcode, payload, fin, mask) {
+  payload = Buffer.from(payload);
+  const header = Buffer.from([(fin ? 0x80 : 0) | opcode, payload.length]);
+  if (!mask)
+    return Buffer.concat([header, payload]);
+  header[1] |= 0x80;
+  const key = crypto.randomBytes(4);
+  const masked = Buffer.alloc(payload.length);
+  for (var i = 0; i < payload.length; i++)
+    masked[i] = payload[i] ^ key[i % 4];
+  return Buffer.concat([header, key, masked]);
+}
+
+// Fragments with a ping in between, then a protocol error.
+function connectRaw(port) {
+  const socket = net.connect(port, common.mustCall(() => {
+    socket.write('GET /raw HTTP/1.1\r\n' +
+                 'Connection: Upgrade\r\n' +
+                 'Upgrade: websocket\r\n' +
+                 'Sec-WebSocket-Version: 13\r\n' +
+                 'Sec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\n\r\n');
+    socket.write(Buffer.concat([
+      frame(0x1, 'Hel', false, true),
+      frame(0x9, 'p', true, true),
+      frame(0x0, 'lo', true, true),
+      frame(0x2, 'unmasked', true, false)
+    ]));
+  }));
+  const chunks = [];
+  socket.on('data', (chunk) => chunks.push(chunk));
+  socket.on('end', common.mustCall(() => {
+    const data = Buffer.concat(chunks);
+    const start = data.indexOf('\r\n\r\n') + 4;
+    const head = data.slice(0, start).toString();
+    assert(/^HTTP\/1\.1 101 /.test(head));
+    assert(/Sec-WebSocket-Accept: s3pPLMBiTxaQ9kYGzzhZRbK\+xOo=/.test(head));
+
+    const frames = [];
+    for (var i = start; i < data.length;) {
+      assert.strictEqual(data[i + 1] & 0x80, 0);
+      const length = data[i + 1];
+      frames.push({
+        opcode: data[i] & 0x0f,
+        payload: data.slice(i + 2, i + 2 + length)
+      });
+      i += 2 + length;
+    }
+    assert.deepStrictEqual(frames.map((f) => f.opcode), [0xa, 0x1, 0x8]);
+    assert.strictEqual(frames[0].payload.toString(), 'p');
+    assert.strictEqual(frames[1].payload.toString(), 'Hello');
+    assert.strictEqual(frames[2].payload.readUInt16BE(0), 1002);
+    done();
+  }));
+}
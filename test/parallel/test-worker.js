@@ -0,0 +1,89 @@
+'use strict';
+
+const common = require('../common');
+const assert = require('assert');
+const worker = require('worker');
+
+if (!worker.isMainThread) {
+  assert.notStrictEqual(worker.parentPort, null);
+  worker.parentPort.on('message', function(message) {
+    switch (message.cmd) {
+      case 'echo':
+        worker.parentPort.postMessage(message.value);
+        break;
+      case 'throw':
+        throw new TypeError(message.value);
+      case 'exit':
+        process.exit(message.value);
+        break;
+      case 'spin':
+        worker.parentPort.postMessage('spinning');
+        for (;;);
+    }
+  });
+  return;
+}
+
+assert.strictEqual(worker.parentPort, null);
+
+assert.throws(() => new worker.Worker(42), TypeError);
+
+function start() {
+  const w = new worker.Worker(__filename);
+  w.on('exit', common.mustCall(function() {}));
+  return w;
+}
+
+// Values are copied in both directions.
+{
+  const w = start();
+  const value = {
+    buffer: Buffer.from('hello'),
+    date: new Date(0),
+    list: [1, 'two', null],
+    map: new Map([['a', 1]])
+  };
+  value.self = value;
+  w.on('message', common.mustCall(function(echo) {
+    assert.notStrictEqual(echo, value);
+    assert.strictEqual(echo.self, echo);
+    assert(echo.buffer.equals(value.buffer));
+    assert.strictEqual(echo.date.getTime(), 0);
+    assert.deepStrictEqual(echo.list, value.list);
+    assert.strictEqual(echo.map.get('a'), 1);
+    w.postMessage({ cmd: 'exit', value: 7 });
+  }));
+  w.on('exit', common.mustCall(function(code) {
+    assert.strictEqual(code, 7);
+  }));
+  w.postMessage({ cmd: 'echo', value });
+  assert.throws(() => w.postMessage(function() {}), TypeError);
+}
+
+// An uncaught exception becomes an 'error' event.
+{
+  const w = start();
+  w.on('error', common.mustCall(function(err) {
+    assert(err instanceof Error);
+    assert.strictEqual(err.name, 'TypeError');
+    assert.strictEqual(err.message, 'boom');
+  }));
+  w.on('exit', common.mustCall(function(code) {
+    assert.strictEqual(code, 1);
+  }));
+  w.postMessage({ cmd: 'throw', value: 'boom' });
+}
+
+// A worker that doesn't return to its event loop can be terminated.
+{
+  const w = start();
+  w.on('message', common.mustCall(function(message) {
+    assert.strictEqual(message, 'spinning');
+    w.terminate(common.mustCall(function(code) {
+      assert.strictEqual(code, 1);
+      // Posting to a worker that is gone is a no-op.
+      w.postMessage('ignored');
+    }));
+  }));
+  w.postMessage({ cmd: 'spin' });
+}
@@ -0,0 +1,63 @@
+'use strict';
+require('../common');
+const assert = require('assert');
+const zlib = require('zlib');
+
+const payload = JSON.stringify({ items: new Array(200).fill('item') });
+
+for (const format of ['deflate', 'deflateRaw', 'gzip']) {
+  const compressor = zlib.createCompressor(format, { level: 9 });
+  // chunkSize bypasses the pooled compressors.
+  const expected = zlib[format + 'Sync'](payload,
+                                         { level: 9, chunkSize: 1024 });
+  const inflate = format === 'deflateRaw' ? zlib.inflateRawSync :
+                  format === 'gzip' ? zlib.gunzipSync : zlib.inflateSync;
+
+  // The compressor is reset between calls.
+  for (let i = 0; i < 3; i++)
+    assert.deepStrictEqual(compressor.compress(payload), expected);
+
+  const output = Buffer.alloc(expected.length + 10);
+  assert.strictEqual(compressor.compress(payload, output, 10), expected.length);
+  assert.deepStrictEqual(output.slice(10), expected);
+  assert.strictEqual(inflate(output.slice(10)).toString(), payload);
+
+  // Too small for the output.
+  assert.strictEqual(compressor.compress(payload, Buffer.alloc(10)), -1);
+  assert.deepStrictEqual(compressor.compress(payload), expected);
+
+  compressor.close();
+  assert.throws(function() {
+    compressor.compress(payload);
+  }, /^Error: zlib binding closed$/);
+}
+
+// The pooled convenience methods give the same results as the streams.
+for (let i = 0; i < 3; i++) {
+  assert.strictEqual(zlib.gunzipSync(zlib.gzipSync('abc')).toString(), 'abc');
+  assert.strictEqual(zlib.inflateSync(zlib.deflateSync('')).toString(), '');
+}
+assert.deepStrictEqual(zlib.gzipSync(payload, { level: 1 }),
+                       zlib.gzipSync(payload, { level: 1, chunkSize: 64 }));
+
+const dictionary = Buffer.from('items item');
+{
+  const compressor = zlib.createCompressor('deflate', { dictionary });
+  const compressed = compressor.compress(payload);
+  assert.deepStrictEqual(compressor.compress(payload), compressed);
+  assert.strictEqual(zlib.inflateSync(compressed, { dictionary }).toString(),
+                     payload);
+}
+
+assert.throws(function() {
+  zlib.createCompressor('gunzip');
+}, /^TypeError: Unknown format: gunzip$/);
+assert.throws(function() {
+  zlib.createCompressor('gzip', { level: 42 });
+}, /^Error: Invalid compression level: 42$/);
+assert.throws(function() {
+  zlib.createCompressor('gzip').compress(42);
+}, /^TypeError: Not a string or buffer$/);
+assert.throws(function() {
+  zlib.createCompressor('gzip').compress('x', 'y');
+}, /^TypeError: "output" argument must be a Buffer$/);
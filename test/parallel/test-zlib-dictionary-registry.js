@@ -0,0 +1,53 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const zlib = require('zlib');
+
+const dictionary = Buffer.from('{"id":,"name":"","email":"@example.com",' +
+                               '"active":true,"roles":["admin","user"]}');
+const input = Buffer.from('{"id":42,"name":"Jane","email":"jane@example.com",' +
+                          '"active":true,"roles":["user"]}');
+
+const id = zlib.registerDictionary(dictionary);
+assert.strictEqual(typeof id, 'number');
+
+// The output is the same as with the dictionary buffer itself.
+for (let i = 0; i < 3; i++) {
+  const compressed = zlib.deflateSync(input, { dictionary: id });
+  assert.deepStrictEqual(compressed,
+                         zlib.deflateSync(input, { dictionary: dictionary }));
+  assert(compressed.length < zlib.deflateSync(input).length);
+  assert.deepStrictEqual(zlib.inflateSync(compressed, { dictionary: id }),
+                         input);
+
+  const raw = zlib.deflateRawSync(input, { dictionary: id });
+  assert.deepStrictEqual(zlib.inflateRawSync(raw, { dictionary: id }), input);
+}
+
+// Streams.
+{
+  const deflate = zlib.createDeflate({ dictionary: id });
+  const inflate = zlib.createInflate({ dictionary: id });
+  const output = [];
+  inflate.on('data', (chunk) => output.push(chunk));
+  inflate.on('end', common.mustCall(function() {
+    assert.deepStrictEqual(Buffer.concat(output), input);
+  }));
+  deflate.pipe(inflate);
+  deflate.end(input);
+}
+
+const other = zlib.registerDictionary(Buffer.from('something else'));
+assert.notStrictEqual(other, id);
+assert.strictEqual(zlib.unregisterDictionary(other), true);
+assert.strictEqual(zlib.unregisterDictionary(other), false);
+
+assert.throws(function() {
+  zlib.deflateSync(input, { dictionary: other });
+}, new RegExp('^Error: Unknown dictionary: ' + other + '$'));
+assert.throws(function() {
+  zlib.createInflate({ dictionary: other });
+}, /^Error: Unknown dictionary: /);
+assert.throws(function() {
+  zlib.registerDictionary('dictionary');
+}, /^TypeError: "dictionary" argument must be a Buffer$/);
@@ -0,0 +1,61 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const zlib = require('zlib');
+
+const input = Buffer.allocUnsafe(3 * 1024 * 1024 + 12345);
+for (let i = 0; i < input.length; i++)
+  input[i] = (i * 7 + (i >> 10)) % 251 & (i % 3 ? 0xff : 0x0f);
+
+function compress(data, options, chunkSizes, cb) {
+  const gzip = zlib.createParallelGzip(options);
+  const output = [];
+  gzip.on('data', (chunk) => output.push(chunk));
+  gzip.on('end', common.mustCall(function() {
+    const compressed = Buffer.concat(output);
+    assert.deepStrictEqual(zlib.gunzipSync(compressed), data);
+    cb(compressed);
+  }));
+
+  let offset = 0;
+  for (const size of chunkSizes) {
+    gzip.write(data.slice(offset, offset + size));
+    offset += size;
+  }
+  gzip.end(data.slice(offset));
+}
+
+// Writes that do not line up with the blocks.
+compress(input, {}, [1000, 500000, 70000], common.mustCall((compressed) => {
+  const serial = zlib.gzipSync(input);
+  assert(compressed.length < serial.length * 1.05);
+}));
+
+compress(input, { blockSize: 32 * 1024, parallel: 2, level: 1 }, [],
+         common.mustCall(() => {}));
+compress(Buffer.alloc(0), {}, [], common.mustCall(() => {}));
+compress(Buffer.alloc(128 * 1024, 'a'), {}, [], common.mustCall(() => {}));
+compress(Buffer.from('hello'), {}, [1, 1], common.mustCall(() => {}));
+
+// The output can be piped through gunzip.
+{
+  const gunzip = zlib.createGunzip();
+  const output = [];
+  gunzip.on('data', (chunk) => output.push(chunk));
+  gunzip.on('end', common.mustCall(function() {
+    assert.deepStrictEqual(Buffer.concat(output), input);
+  }));
+  const gzip = zlib.createParallelGzip();
+  gzip.pipe(gunzip);
+  gzip.end(input);
+}
+
+assert.throws(function() {
+  zlib.createParallelGzip({ blockSize: 1024 });
+}, /^Error: Invalid block size: 1024$/);
+assert.throws(function() {
+  zlib.createParallelGzip({ parallel: 1.5 });
+}, /^Error: Invalid parallel: 1.5$/);
+assert.throws(function() {
+  zlib.createParallelGzip({ level: 10 });
+}, /^Error: Invalid compression level: 10$/);
@@ -0,0 +1,34 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const zlib = require('zlib');
+
+const input = Buffer.alloc(256 * 1024, 'priority');
+
+['high', 'normal', 'low'].forEach(function(priority) {
+  zlib.gzip(input, { priority: priority }, common.mustCall(function(err, out) {
+    assert.ifError(err);
+    zlib.gunzip(out, { priority: priority },
+                common.mustCall(function(err, result) {
+                  assert.ifError(err);
+                  assert.deepStrictEqual(result, input);
+                }));
+  }));
+});
+
+{
+  const gzip = zlib.createParallelGzip({ priority: 'low' });
+  const output = [];
+  gzip.on('data', (chunk) => output.push(chunk));
+  gzip.on('end', common.mustCall(function() {
+    assert.deepStrictEqual(zlib.gunzipSync(Buffer.concat(output)), input);
+  }));
+  gzip.end(input);
+}
+
+assert.throws(function() {
+  zlib.createDeflate({ priority: 'urgent' });
+}, /^Error: Invalid priority: urgent$/);
+assert.throws(function() {
+  zlib.createParallelGzip({ priority: 0 });
+}, /^Error: Invalid priority: 0$/);
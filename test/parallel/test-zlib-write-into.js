@@ -0,0 +1,58 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const zlib = require('zlib');
+
+const input = Buffer.allocUnsafe(200000);
+for (let i = 0; i < input.length; i++)
+  input[i] = (i * 7 + (i >> 9)) % 251;
+const deflated = zlib.deflateSync(input);
+
+// A single output buffer.
+{
+  const output = Buffer.alloc(input.length + 1);
+  assert.strictEqual(zlib.inflateSync(deflated, { output: output }),
+                     input.length);
+  assert.deepStrictEqual(output.slice(0, input.length), input);
+}
+
+// The output is spread over several buffers, in order.
+{
+  const output = [Buffer.alloc(70000), Buffer.alloc(70000),
+                  Buffer.alloc(70000)];
+  assert.strictEqual(zlib.inflateSync(deflated, { output: output }),
+                     input.length);
+  assert.deepStrictEqual(Buffer.concat(output).slice(0, input.length), input);
+}
+
+// Compression.
+{
+  const output = Buffer.alloc(deflated.length * 2);
+  const length = zlib.gzipSync(input, { output: output });
+  assert.deepStrictEqual(zlib.gunzipSync(output.slice(0, length)), input);
+}
+
+assert.throws(function() {
+  zlib.inflateSync(deflated, { output: Buffer.alloc(1000) });
+}, /^RangeError: Output buffers are too small$/);
+assert.throws(function() {
+  zlib.createInflate({ output: [] });
+}, /^TypeError: Invalid output: /);
+assert.throws(function() {
+  zlib.createInflate({ output: 'buffer' });
+}, /^TypeError: Invalid output: /);
+
+// Streams cycle through the output buffers.
+{
+  const ring = [Buffer.alloc(1024), Buffer.alloc(1024)];
+  const inflate = zlib.createInflate({ output: ring });
+  const chunks = [];
+  inflate.on('data', function(chunk) {
+    assert(chunk.buffer === ring[0].buffer || chunk.buffer === ring[1].buffer);
+    chunks.push(Buffer.from(chunk));
+  });
+  inflate.on('end', common.mustCall(function() {
+    assert.deepStrictEqual(Buffer.concat(chunks), input);
+  }));
+  inflate.end(deflated);
+}
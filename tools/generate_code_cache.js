@@ -0,0 +1,93 @@
+'use strict';
+
+// Generates a C++ file with V8 code cache for the core modules, to be
+// compiled into node with `./configure --code-cache-path=<file>`.  It has to
+// be run by a node binary built from the same sources and with the same V8,
+// otherwise V8 rejects the data at startup and compiles from source as usual.
+//
+// Usage: node tools/generate_code_cache.js <output.cc>
+
+const fs = require('fs');
+const vm = require('vm');
+const Module = require('module');
+
+const output = process.argv[2];
+if (!output) {
+  console.error('Usage: node tools/generate_code_cache.js <output.cc>');
+  process.exit(1);
+}
+
+const natives = process.binding('natives');
+const entries = [];
+
+Object.keys(natives).sort().forEach(function(id) {
+  var script;
+  try {
+    script = new vm.Script(Module.wrap(natives[id]), {
+      filename: `${id}.js`,
+      produceCachedData: true
+    });
+  } catch (e) {
+    // Not every native source is a module, `config` for example.
+    return;
+  }
+  if (script.cachedDataProduced)
+    entries.push({ id, data: script.cachedData });
+});
+
+function toArray(data) {
+  const lines = [];
+  for (var i = 0; i < data.length; i += 16) {
+    lines.push('  ' + Array.prototype.join.call(data.slice(i, i + 16), ','));
+  }
+  return lines.join(',\n');
+}
+
+const out = [
+  `// This file is generated by tools/generate_code_cache.js for ${
+    process.version} (V8 ${process.versions.v8}).  Do not edit.`,
+  '',
+  '#include "node_javascript.h"',
+  '#include "v8.h"',
+  '#include "env.h"',
+  '#include "env-inl.h"',
+  '',
+  'namespace node {',
+  '',
+  'using v8::ArrayBuffer;',
+  'using v8::Local;',
+  'using v8::Object;',
+  'using v8::Uint8Array;',
+  ''
+];
+
+entries.forEach(function(entry, i) {
+  out.push(`// ${entry.id}`);
+  out.push(`static uint8_t code_cache_${i}[] = {`);
+  out.push(toArray(entry.data));
+  out.push('};', '');
+});
+
+out.push('static const struct {');
+out.push('  const char* id;');
+out.push('  uint8_t* data;');
+out.push('  size_t length;');
+out.push('} code_cache[] = {');
+entries.forEach(function(entry, i) {
+  out.push(`  { "${entry.id}", code_cache_${i}, sizeof(code_cache_${i}) },`);
+});
+out.push('};', '');
+
+out.push('void DefineCodeCache(Environment* env, Local<Object> target) {');
+out.push('  for (auto entry : code_cache) {');
+out.push('    // The data is static, the ArrayBuffers never own it.');
+out.push('    Local<ArrayBuffer> ab =');
+out.push('        ArrayBuffer::New(env->isolate(), entry.data, entry.length);');
+out.push('    target->Set(OneByteString(env->isolate(), entry.id),');
+out.push('                Uint8Array::New(ab, 0, entry.length));');
+out.push('  }');
+out.push('}', '');
+out.push('}  // namespace node', '');
+
+fs.writeFileSync(output, out.join('\n'));
+console.log(`Wrote ${entries.length} entries to ${output}`);